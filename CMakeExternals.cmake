@@ -137,9 +137,12 @@ function(require_external NAME)
     if(WIN32)
       set(ADIOS2_IMPORT_LIB "lib/adios2.lib")
       set(ADIOS2_LIB "bin/adios2.dll")
+      set(ADIOS2_USE_SST OFF)
     else()
       include(GNUInstallDirs)
       set(ADIOS2_LIB "${CMAKE_INSTALL_LIBDIR}/libadios2.so")
+      # streaming from running simulations
+      set(ADIOS2_USE_SST ON)
     endif()
 
     add_external_project(adios2 SHARED
@@ -152,7 +155,7 @@ function(require_external NAME)
         -DADIOS2_USE_Fortran=OFF
         -DADIOS2_USE_HDF5=OFF 
         -DADIOS2_USE_Python=OFF
-        -DADIOS2_USE_SST=OFF 
+        -DADIOS2_USE_SST=${ADIOS2_USE_SST}
         -DADIOS2_USE_SZ=OFF
         -DADIOS2_USE_SysVShMem=OFF 
         -DADIOS2_USE_ZFP=OFF
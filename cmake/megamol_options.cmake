@@ -46,6 +46,9 @@ endif()
 # GLFW
 option(USE_GLFW "Use GLFW" ON)
 
+# EGL
+option(USE_EGL "Use EGL for headless rendering in the console" OFF)
+
 # MPI
 option(ENABLE_MPI "Enable MPI support" OFF)
 set(MPI_GUESS_LIBRARY_NAME "undef" CACHE STRING "Override MPI library name, e.g., MSMPI, MPICH2")
@@ -394,6 +394,12 @@ void setupCore(megamol::console::utility::CmdLineParser *& parser) {
         }
     }
 
+    if (parser->Headless()) {
+        if (!::mmcSetConfigurationValue(hCore, MMC_CFGID_VARIABLE, _T("headless"), _T("true"))) {
+            vislib::sys::Log::DefaultLog.WriteWarn("Failed to set headless parameter");
+        }
+    }
+
     // Quickstarts
     // warn on deprecated quickstart arguments
     vislib::SingleLinkedList<vislib::TString> quickstarts;
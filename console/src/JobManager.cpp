@@ -8,6 +8,8 @@
 #include "stdafx.h"
 #include "JobManager.h"
 #include "mmcore/api/MegaMolCore.h"
+#include "vislib/CharTraits.h"
+#include "vislib/sys/Log.h"
 #include <cassert>
 #include <algorithm>
 #include <chrono>
@@ -32,7 +34,8 @@ megamol::console::JobManager::~JobManager(void) {
 /*
  * megamol::console::JobManager::JobManager
  */
-megamol::console::JobManager::JobManager(void) : jobs(), terminating(false) {
+megamol::console::JobManager::JobManager(void) : jobs(), terminating(false), maxRunning(0),
+        lastReport(std::chrono::system_clock::now()) {
     // intentionally empty
 }
 
@@ -50,17 +53,33 @@ void megamol::console::JobManager::Update(bool force) {
 
     bool cleaning = false;
 
+    unsigned int running = 0;
     for (std::shared_ptr<Job> j : jobs) {
-        if (!j->started && !terminating) j->Start();
-        if (!j->IsRunning()) cleaning = true;
+        if (j->started && j->IsRunning()) ++running;
+    }
+    for (std::shared_ptr<Job> j : jobs) {
+        if (!j->started && !terminating && ((maxRunning == 0) || (running < maxRunning))) {
+            j->Start();
+            if (j->IsRunning()) ++running;
+        }
+        // jobs waiting for a free slot are not finished
+        if (!j->IsRunning() && (j->started || terminating)) cleaning = true;
+    }
+
+    if (now - lastReport >= std::chrono::seconds(10)) {
+        lastReport = now;
+        for (std::shared_ptr<Job> j : jobs) {
+            if (j->started && j->IsRunning()) j->ReportProgress(false);
+        }
     }
 
     if (!cleaning) return;
 
     std::vector<std::shared_ptr<Job> >::iterator e = jobs.end();
     for (std::vector<std::shared_ptr<Job> >::iterator i = jobs.begin(); i != e; ) {
-        if ((*i)->IsRunning()) ++i;
+        if ((*i)->IsRunning() || (!(*i)->started && !terminating)) ++i;
         else {
+            if ((*i)->started) (*i)->ReportProgress(true);
             i = jobs.erase(i);
             e = jobs.end(); // because we potentially changed everything.
         }
@@ -82,6 +101,37 @@ bool megamol::console::JobManager::InstantiatePendingJob(void *hCore) {
     bool succ = ::mmcInstantiatePendingJob(hCore, job->hJob);
     if (!succ) return false;
 
+    char name[1024];
+    unsigned int len = sizeof(name);
+    ::mmcGetInstanceIDA(job->hJob, name, &len);
+    job->name = name;
+
+    ::mmcValueType maxDataType = MMC_TYPE_VOIDP;
+    const void* maxData = ::mmcGetConfigurationValue(hCore, MMC_CFGID_VARIABLE, _T("maxjobs"), &maxDataType);
+    if (maxData != nullptr) {
+        int maxJobs = -1;
+        try {
+            switch (maxDataType) {
+            case MMC_TYPE_INT32:
+                maxJobs = *static_cast<const int32_t*>(maxData);
+                break;
+            case MMC_TYPE_UINT32:
+                maxJobs = static_cast<int>(*static_cast<const uint32_t*>(maxData));
+                break;
+            case MMC_TYPE_CSTR:
+                maxJobs = vislib::CharTraitsA::ParseInt(static_cast<const char*>(maxData));
+                break;
+            case MMC_TYPE_WSTR:
+                maxJobs = vislib::CharTraitsW::ParseInt(static_cast<const wchar_t*>(maxData));
+                break;
+            default:
+                break;
+            }
+        } catch (...) {
+        }
+        if (maxJobs >= 0) maxRunning = static_cast<unsigned int>(maxJobs);
+    }
+
     jobs.push_back(job);
     return true;
 
@@ -94,7 +144,7 @@ bool megamol::console::JobManager::InstantiatePendingJob(void *hCore) {
 
 }
 
-megamol::console::JobManager::Job::Job() : hJob(), started(false) {
+megamol::console::JobManager::Job::Job() : hJob(), name(), started(false), startTime() {
     // intentionally empty
 }
 
@@ -108,6 +158,28 @@ bool megamol::console::JobManager::Job::IsRunning() {
 
 void megamol::console::JobManager::Job::Start() {
     if (!started) {
-        started = ::mmcStartJob(hJob);
-    }    
+        // a job failing to start is not retried, but removed as finished
+        started = true;
+        startTime = std::chrono::system_clock::now();
+        if (::mmcStartJob(hJob)) {
+            vislib::sys::Log::DefaultLog.WriteInfo("Job \"%s\" started", name.c_str());
+        } else {
+            vislib::sys::Log::DefaultLog.WriteError("Job \"%s\" failed to start", name.c_str());
+        }
+    }
+}
+
+void megamol::console::JobManager::Job::ReportProgress(bool finished) {
+    const double secs = std::chrono::duration<double>(std::chrono::system_clock::now() - startTime).count();
+    float progress = 0.0f;
+    unsigned long long bytes = 0;
+    if (::mmcGetJobProgress(hJob, &progress, &bytes)) {
+        const double mb = static_cast<double>(bytes) / (1024.0 * 1024.0);
+        const double rate = (secs > 0.0) ? mb / secs : 0.0;
+        vislib::sys::Log::DefaultLog.WriteInfo("Job \"%s\" %s after %.1f s: %.1f%% done, %.1f MB (%.1f MB/s)",
+            name.c_str(), finished ? "finished" : "running", secs, progress * 100.0f, mb, rate);
+    } else {
+        vislib::sys::Log::DefaultLog.WriteInfo(
+            "Job \"%s\" %s after %.1f s", name.c_str(), finished ? "finished" : "running", secs);
+    }
 }
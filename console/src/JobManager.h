@@ -11,12 +11,19 @@
 
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <string>
 #include "CoreHandle.h"
 
 
 namespace megamol {
 namespace console {
 
+    /**
+     * Runs the jobs of the core. Jobs are independent of each other and are
+     * started in the order of their instantiation, at most 'maxjobs' (as set
+     * in the configuration, zero for no limit) at a time.
+     */
     class JobManager {
     public:
 
@@ -44,9 +51,12 @@ namespace console {
             ~Job();
             bool IsRunning();
             void Start();
+            void ReportProgress(bool finished);
 
             CoreHandle hJob;
+            std::string name;
             bool started;
+            std::chrono::system_clock::time_point startTime;
         };
 
         /** Private ctor. */
@@ -58,6 +68,12 @@ namespace console {
         /** whether shutdown has been requested. do not start jobs again. */
         bool terminating;
 
+        /** The maximum number of jobs running at the same time, zero for no limit */
+        unsigned int maxRunning;
+
+        /** The time the progress of the running jobs has been reported last */
+        std::chrono::system_clock::time_point lastReport;
+
     };
 
 } /* end namespace console */
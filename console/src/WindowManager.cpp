@@ -13,6 +13,8 @@
 #include "mmcore/api/MegaMolCore.h"
 #include "utility/ConfigHelper.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
+#include "vislib/StringConverter.h"
+#include "vislib/StringTokeniser.h"
 #include "vislib/sys/Log.h"
 #include "JobManager.h"
 #include "utility/HotFixFileName.h"
@@ -193,14 +195,97 @@ bool megamol::console::WindowManager::InstantiatePendingView(void *hCore) {
         }
     }
 
-    // get an existing window to share context resources
-    GLFWwindow* share = nullptr;
-    if (!windows.empty()) share = windows[0]->WindowHandle();
-    // TODO: share GL context from outside? no GL at all? responsibility of WindowManager?
+    // render into offscreen surfaces instead of windows, e.g. for jobs on render nodes without an X server
+    bool headless = false;
+    ::mmcValueType headlessDataType = MMC_TYPE_VOIDP;
+    const void* headlessData = ::mmcGetConfigurationValue(hCore, MMC_CFGID_VARIABLE, _T("headless"), &headlessDataType);
+    if (headlessData != nullptr) {
+        try {
+            switch (headlessDataType) {
+            case MMC_TYPE_BOOL:
+                headless = *static_cast<const bool*>(headlessData);
+                break;
+            case MMC_TYPE_CSTR:
+                headless = vislib::CharTraitsA::ParseBool(static_cast<const char*>(headlessData));
+                break;
+            case MMC_TYPE_WSTR:
+                headless = vislib::CharTraitsW::ParseBool(static_cast<const wchar_t*>(headlessData));
+                break;
+            default:
+                break;
+            }
+        } catch (...) {
+        }
+    }
 
     // prepare window object
-    std::shared_ptr<gl::Window> w =
-        std::make_shared<gl::Window>((vislib::StringA(TitlePrefix) + pendInstName).PeekBuffer(), wp, share);
+    std::shared_ptr<gl::Window> w;
+    vislib::StringA title = vislib::StringA(TitlePrefix) + pendInstName;
+    if (headless) {
+#ifdef USE_EGL
+        // all headless views render on the same device by default. A list of devices, e.g. "0,1,2,3",
+        // places the views round robin on them, so the views of one process render on several GPUs
+        std::vector<int> devices;
+        ::mmcValueType deviceDataType = MMC_TYPE_VOIDP;
+        const void* deviceData =
+            ::mmcGetConfigurationValue(hCore, MMC_CFGID_VARIABLE, _T("egldevice"), &deviceDataType);
+        if (deviceData != nullptr) {
+            try {
+                vislib::StringA deviceList;
+                switch (deviceDataType) {
+                case MMC_TYPE_INT32:
+                    devices.push_back(*static_cast<const int32_t*>(deviceData));
+                    break;
+                case MMC_TYPE_CSTR:
+                    deviceList = static_cast<const char*>(deviceData);
+                    break;
+                case MMC_TYPE_WSTR:
+                    deviceList = W2A(static_cast<const wchar_t*>(deviceData));
+                    break;
+                default:
+                    break;
+                }
+                vislib::StringTokeniserA tokens(deviceList, ',');
+                while (tokens.HasNext()) {
+                    vislib::StringA token = tokens.Next();
+                    token.TrimSpaces();
+                    if (!token.IsEmpty()) devices.push_back(vislib::CharTraitsA::ParseInt(token.PeekBuffer()));
+                }
+            } catch (...) {
+                vislib::sys::Log::DefaultLog.WriteWarn("Unable to parse \"egldevice\", using device 0");
+                devices.clear();
+            }
+        }
+        if (devices.empty()) devices.push_back(0);
+
+        // the view is instantiated with the new context current, so its modules only need the resources of it.
+        // Share them with the first view on the same device, as contexts on different devices cannot share
+        size_t headlessCnt = 0;
+        for (const std::shared_ptr<gl::Window>& other : windows) {
+            if (other->IsHeadless()) headlessCnt++;
+        }
+        const int device = devices[headlessCnt % devices.size()];
+        const gl::Window* share = nullptr;
+        for (const std::shared_ptr<gl::Window>& other : windows) {
+            if (other->IsHeadless() && (other->EGLDevice() == device)) {
+                share = other.get();
+                break;
+            }
+        }
+        vislib::sys::Log::DefaultLog.WriteInfo("Headless view \"%s\" renders on EGL device %d", pendInstName, device);
+        w = std::make_shared<gl::Window>(title.PeekBuffer(), wp, device, share);
+#else
+        vislib::sys::Log::DefaultLog.WriteError("Headless rendering requires a console built with USE_EGL");
+        return false;
+#endif
+    } else {
+        // get an existing window to share context resources
+        GLFWwindow* share = nullptr;
+        if (!windows.empty()) share = windows[0]->WindowHandle();
+        // TODO: share GL context from outside? no GL at all? responsibility of WindowManager?
+
+        w = std::make_shared<gl::Window>(title.PeekBuffer(), wp, share);
+    }
     if (!w || !w->IsAlive()) {
         vislib::sys::Log::DefaultLog.WriteError("Unable to create window");
         return false;
@@ -20,6 +20,9 @@
 #define GLFW_EXPOSE_NATIVE_WIN32 
 #include "GLFW/glfw3native.h" 
 #endif
+#ifdef USE_EGL
+#include <EGL/eglext.h>
+#endif
 
 //#include "HotKeyButtonParam.h"
 //#include "vislib/RawStorage.h"
@@ -32,24 +35,48 @@
 using namespace megamol;
 using namespace megamol::console;
 
+#ifdef USE_EGL
+namespace {
+
+/**
+ * Answers the EGL display of the device with the given index. Falls back to
+ * the default display if the driver cannot enumerate its devices.
+ */
+EGLDisplay getDeviceDisplay(int device) {
+    auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(::eglGetProcAddress("eglQueryDevicesEXT"));
+    auto getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(::eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if ((queryDevices != nullptr) && (getPlatformDisplay != nullptr)) {
+        const EGLint maxDevices = 16;
+        EGLDeviceEXT devices[maxDevices];
+        EGLint cnt = 0;
+        if (queryDevices(maxDevices, devices, &cnt) && (cnt > 0)) {
+            if ((device < 0) || (device >= cnt)) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    "EGL device %d is not available, using device 0 of %d", device, static_cast<int>(cnt));
+                device = 0;
+            }
+            return getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[device], nullptr);
+        }
+    }
+    vislib::sys::Log::DefaultLog.WriteWarn("EGL device enumeration is not supported, using the default display");
+    return ::eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+} // namespace
+#endif
+
 gl::Window::Window(const char* title, const utility::WindowPlacement & placement, GLFWwindow* share)
         : glfw(), 
         hView(), hWnd(nullptr), width(-1), height(-1), renderContext(), uiLayers(), mouseCapture(),
         name(title), fpsCntr(), fps(1000.0f), fpsList(), showFpsInTitle(true), fpsSyncTime(), topMost(false),
-        fragmentQuery(0), showFragmentsInTitle(false), showPrimsInTitle(false) {
-
-    if (::memcmp(name.c_str(), WindowManager::TitlePrefix, WindowManager::TitlePrefixLength) == 0) {
-        name = name.substr(WindowManager::TitlePrefixLength);
-    }
-    for (float& f : fpsList) f = 0.0f;
+        fragmentQuery(0), showFragmentsInTitle(false), showPrimsInTitle(false), headless(false), closeRequested(false)
+#ifdef USE_EGL
+        , eglDisplay(EGL_NO_DISPLAY), eglSurface(EGL_NO_SURFACE), eglContext(EGL_NO_CONTEXT), eglDevice(-1)
+#endif
+        {
 
-    memset(&renderContext, 0, sizeof(mmcRenderViewContext));
-    renderContext.Size = sizeof(mmcRenderViewContext);
-    renderContext.ContinuousRedraw = true;
-    renderContext.GpuAffinity = nullptr;
-    renderContext.Direct3DRenderTarget = nullptr;
-    renderContext.InstanceTime = 0.0; // will be generated by core
-    renderContext.Time = 0.0; // will be generated by core
+    init_render_context();
 
     glfw = glfwInst::Instance(); // we use glfw
     if (glfw->OK()) {
@@ -144,8 +171,78 @@ gl::Window::Window(const char* title, const utility::WindowPlacement & placement
     }
 }
 
+#ifdef USE_EGL
+gl::Window::Window(const char* title, const utility::WindowPlacement& placement, int device, const Window* share)
+        : glfw(), hView(), hWnd(nullptr), width(1920), height(1080), renderContext(), uiLayers(), mouseCapture(),
+        name(title), fpsCntr(), fps(1000.0f), fpsList(), showFpsInTitle(true), fpsSyncTime(), topMost(false),
+        fragmentQuery(0), showFragmentsInTitle(false), showPrimsInTitle(false), headless(true), closeRequested(false),
+        eglDisplay(EGL_NO_DISPLAY), eglSurface(EGL_NO_SURFACE), eglContext(EGL_NO_CONTEXT), eglDevice(device) {
+
+    init_render_context();
+
+    if (placement.fullScreen) vislib::sys::Log::DefaultLog.WriteWarn("Ignoring fullscreen for headless window.");
+    if (placement.size && (placement.w > 0) && (placement.h > 0)) {
+        width = placement.w;
+        height = placement.h;
+    }
+
+    eglDisplay = getDeviceDisplay(device);
+    EGLint major = 0, minor = 0;
+    if ((eglDisplay == EGL_NO_DISPLAY) || !::eglInitialize(eglDisplay, &major, &minor)) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to initialize EGL display");
+        return;
+    }
+    if (!::eglBindAPI(EGL_OPENGL_API)) {
+        vislib::sys::Log::DefaultLog.WriteError("EGL display does not support desktop OpenGL");
+        return;
+    }
+
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 24,
+        EGL_STENCIL_SIZE, 8, EGL_NONE};
+    EGLConfig config;
+    EGLint configCnt = 0;
+    if (!::eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCnt) || (configCnt < 1)) {
+        vislib::sys::Log::DefaultLog.WriteError("No EGL config for OpenGL pbuffers available");
+        return;
+    }
+
+    // pbuffers are back-buffered only, thus views rendering to GL_BACK work unchanged
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    eglSurface = ::eglCreatePbufferSurface(eglDisplay, config, surfaceAttribs);
+    if (eglSurface == EGL_NO_SURFACE) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to create EGL pbuffer of size %d x %d", width, height);
+        return;
+    }
+
+    EGLContext shareContext = EGL_NO_CONTEXT;
+    if ((share != nullptr) && share->headless) {
+        if (share->eglDisplay == eglDisplay) {
+            shareContext = share->eglContext;
+        } else {
+            vislib::sys::Log::DefaultLog.WriteWarn("Headless window on other EGL device does not share resources");
+        }
+    }
+    eglContext = ::eglCreateContext(eglDisplay, config, shareContext, nullptr);
+    if ((eglContext == EGL_NO_CONTEXT) || !::eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to create EGL context");
+        destroy_headless();
+        return;
+    }
+    vislib::sys::Log::DefaultLog.WriteInfo(
+        "Console::Window: Create headless window with size w: %d, h: %d (EGL %d.%d)\n", width, height, major, minor);
+
+    // LoadAllGL resolves the functions via GLX, which needs an X server
+    ::gladLoadGLLoader(reinterpret_cast<GLADloadproc>(::eglGetProcAddress));
+
+    glGenQueries(1, &fragmentQuery);
+    glGenQueries(1, &primsQuery);
+    fpsSyncTime = std::chrono::system_clock::now();
+}
+#endif
+
 gl::Window::~Window() {
-    assert(hWnd == nullptr);
+    assert(!IsAlive());
     glDeleteQueries(1, &fragmentQuery);
     glDeleteQueries(1, &primsQuery);
 }
@@ -167,32 +264,40 @@ void gl::Window::RemoveUILayer(std::shared_ptr<AbstractUILayer> uiLayer) {
 
 void gl::Window::SetShowFPSinTitle(bool show) {
     showFpsInTitle = show;
-    if (!showFpsInTitle && !showFragmentsInTitle) {
+    if (!showFpsInTitle && !showFragmentsInTitle && (hWnd != nullptr)) {
         ::glfwSetWindowTitle(hWnd, (std::string(WindowManager::TitlePrefix) + name).c_str());
     }
 }
 
 void gl::Window::SetShowSamplesinTitle(bool show) {
     showFragmentsInTitle = show;
-    if (!showFpsInTitle && !showFragmentsInTitle) {
+    if (!showFpsInTitle && !showFragmentsInTitle && (hWnd != nullptr)) {
         ::glfwSetWindowTitle(hWnd, (std::string(WindowManager::TitlePrefix) + name).c_str());
     }
 }
 
 void gl::Window::SetShowPrimsinTitle(bool show) {
     showPrimsInTitle = show;
-    if (!showFpsInTitle && !showFragmentsInTitle && !showPrimsInTitle) {
+    if (!showFpsInTitle && !showFragmentsInTitle && !showPrimsInTitle && (hWnd != nullptr)) {
         ::glfwSetWindowTitle(hWnd, (std::string(WindowManager::TitlePrefix) + name).c_str());
     }
 }
 
 void gl::Window::RequestClose() {
-    if (hWnd != nullptr) {
+    if (headless) {
+        closeRequested = true;
+    } else if (hWnd != nullptr) {
         ::glfwSetWindowShouldClose(hWnd, true);
     }
 }
 
 void gl::Window::Update() {
+#ifdef USE_EGL
+    if (headless) {
+        update_headless();
+        return;
+    }
+#endif
     if (hWnd == nullptr) return;
 
     // this also issues the callbacks, which might close this window
@@ -219,15 +324,7 @@ void gl::Window::Update() {
     }
 
     fpsCntr.FrameBegin();
-    if ((width > 0) && (height > 0)) {
-        if (showFragmentsInTitle) glBeginQuery(GL_SAMPLES_PASSED, fragmentQuery);
-        if (showPrimsInTitle) glBeginQuery(GL_PRIMITIVES_GENERATED, primsQuery);
-        ::mmcRenderView(hView, &renderContext);
-        if (showFragmentsInTitle) glEndQuery(GL_SAMPLES_PASSED);
-        if (showPrimsInTitle) glEndQuery(GL_PRIMITIVES_GENERATED);
-    }
-
-	this->uiLayers.OnDraw();
+    render_frame();
 
     // done rendering. swap and next turn
     ::glfwSwapBuffers(hWnd);
@@ -248,6 +345,39 @@ void gl::Window::Update() {
 
 }
 
+#ifdef USE_EGL
+void gl::Window::update_headless() {
+    if (eglSurface == EGL_NO_SURFACE) return;
+    make_current();
+    if (closeRequested) {
+        uiLayers.ClearUILayers();
+        hView.DestroyHandle();
+        destroy_headless();
+        return;
+    }
+
+    fpsCntr.FrameBegin();
+    render_frame();
+    ::eglSwapBuffers(eglDisplay, eglSurface);
+    fpsCntr.FrameEnd();
+
+    std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+    if (now - fpsSyncTime > std::chrono::seconds(1)) {
+        on_fps_value(fpsCntr.FPS());
+        fpsSyncTime = now;
+    }
+}
+
+void gl::Window::destroy_headless() {
+    ::eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (eglContext != EGL_NO_CONTEXT) ::eglDestroyContext(eglDisplay, eglContext);
+    if (eglSurface != EGL_NO_SURFACE) ::eglDestroySurface(eglDisplay, eglSurface);
+    eglContext = EGL_NO_CONTEXT;
+    eglSurface = EGL_NO_SURFACE;
+    // the display is not terminated, as the other headless windows on the same device use the same one
+}
+#endif
+
 void gl::Window::glfw_onKey_func(GLFWwindow* wnd, int k, int s, int a, int m) {
     ::glfwMakeContextCurrent(wnd);
     Window* that = static_cast<Window*>(::glfwGetWindowUserPointer(wnd));
@@ -335,8 +465,45 @@ void gl::Window::glfw_onMouseWheel_func(GLFWwindow* wnd, double x, double y) {
     }
 }
 
-void gl::Window::on_resize(int w, int h) {
+void gl::Window::init_render_context() {
+    if (::memcmp(name.c_str(), WindowManager::TitlePrefix, WindowManager::TitlePrefixLength) == 0) {
+        name = name.substr(WindowManager::TitlePrefixLength);
+    }
+    for (float& f : fpsList) f = 0.0f;
+
+    memset(&renderContext, 0, sizeof(mmcRenderViewContext));
+    renderContext.Size = sizeof(mmcRenderViewContext);
+    renderContext.ContinuousRedraw = true;
+    renderContext.GpuAffinity = nullptr;
+    renderContext.Direct3DRenderTarget = nullptr;
+    renderContext.InstanceTime = 0.0; // will be generated by core
+    renderContext.Time = 0.0; // will be generated by core
+}
+
+void gl::Window::make_current() {
+#ifdef USE_EGL
+    if (headless) {
+        ::eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext);
+        return;
+    }
+#endif
     ::glfwMakeContextCurrent(hWnd);
+}
+
+void gl::Window::render_frame() {
+    if ((width > 0) && (height > 0)) {
+        if (showFragmentsInTitle) glBeginQuery(GL_SAMPLES_PASSED, fragmentQuery);
+        if (showPrimsInTitle) glBeginQuery(GL_PRIMITIVES_GENERATED, primsQuery);
+        ::mmcRenderView(hView, &renderContext);
+        if (showFragmentsInTitle) glEndQuery(GL_SAMPLES_PASSED);
+        if (showPrimsInTitle) glEndQuery(GL_PRIMITIVES_GENERATED);
+    }
+
+	this->uiLayers.OnDraw();
+}
+
+void gl::Window::on_resize(int w, int h) {
+    make_current();
     if ((w > 0) && (h > 0)) {
         ::glViewport(0, 0, w, h);
         ::mmcResizeView(hView, w, h);
@@ -387,6 +554,6 @@ void gl::Window::on_fps_value(float fps_val) {
         title << prims << " primitives ";
     }
     if (showFpsInTitle || showFragmentsInTitle || showPrimsInTitle) title << "]";
-    ::glfwSetWindowTitle(hWnd, title.str().c_str());
+    if (hWnd != nullptr) ::glfwSetWindowTitle(hWnd, title.str().c_str());
 }
 
@@ -14,6 +14,9 @@
 #include <vector>
 #include "vislib/graphics/gl/IncludeAllGL.h"
 #include "GLFW/glfw3.h"
+#ifdef USE_EGL
+#include <EGL/egl.h>
+#endif
 #include "gl/glfwInst.h"
 #include "utility/ConfigHelper.h"
 #include "mmcore/api/MegaMolCore.h"
@@ -39,6 +42,20 @@ namespace gl {
         }
 
         Window(const char* title, const utility::WindowPlacement & placement, GLFWwindow* share);
+#ifdef USE_EGL
+        /**
+         * Creates a headless window rendering into an EGL pbuffer, which
+         * needs no window system and thus works on render nodes without an
+         * X server.
+         *
+         * @param title The name of the window
+         * @param placement The placement, of which only the size is used
+         * @param device The index of the EGL device to render on
+         * @param share The headless window to share context resources with,
+         *              or nullptr
+         */
+        Window(const char* title, const utility::WindowPlacement& placement, int device, const Window* share);
+#endif
         virtual ~Window();
 
         void EnableVSync();
@@ -89,7 +106,20 @@ namespace gl {
         }
         void SetShowPrimsinTitle(bool show);
 
+        inline bool IsHeadless() const {
+            return headless;
+        }
+#ifdef USE_EGL
+        /** Answers the EGL device of a headless window, or -1 */
+        inline int EGLDevice() const {
+            return eglDevice;
+        }
+#endif
+
         inline bool IsAlive() const {
+#ifdef USE_EGL
+            if (headless) return eglSurface != EGL_NO_SURFACE;
+#endif
             return hWnd != nullptr;
         }
         void RequestClose();
@@ -104,8 +134,15 @@ namespace gl {
         static void glfw_onMouseButton_func(GLFWwindow* wnd, int b, int a, int m);
         static void glfw_onMouseWheel_func(GLFWwindow* wnd, double x, double y);
 
+        void init_render_context();
+        void make_current();
+        void render_frame();
         void on_resize(int w, int h);
         void on_fps_value(float fps_val);
+#ifdef USE_EGL
+        void update_headless();
+        void destroy_headless();
+#endif
 
         CoreHandle hView; // Handle to the core view instance
         
@@ -126,6 +163,14 @@ namespace gl {
         GLuint primsQuery;
         bool showFragmentsInTitle;
         bool showPrimsInTitle;
+        bool headless;
+        bool closeRequested;
+#ifdef USE_EGL
+        EGLDisplay eglDisplay;
+        EGLSurface eglSurface;
+        EGLContext eglContext;
+        int eglDevice;
+#endif
     };
 
 } /* end namespace gl */
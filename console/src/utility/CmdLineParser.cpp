@@ -69,6 +69,7 @@ megamol::console::utility::CmdLineParser::CmdLineParser(void)
     useKHR(0, _T("useKHRdebug"), _T("Option to de-/activate the KHR debugger"), ParserOption::FLAG_UNIQUE,
     ParserValueDesc::ValueList(ParserOption::BOOL_VALUE, _T("switch"), _T("'True' activates KHR debugging, 'False' deactivates KHR debugging"))),
     quadBuffer(0, _T("quadbuffer"), _T("Enables OpenGL Quad-Buffer support, if the viewer is started")),
+    headless(0, _T("headless"), _T("Renders all views into offscreen EGL surfaces instead of windows (requires a console built with EGL support)")),
     quickstart(_T('q'), _T("quickstart"), _T("(DEPRECATED!) Performs a quickstart for the specified data set"), ParserOption::FLAG_NULL,
         ParserValueDesc::ValueList(ParserOption::STRING_VALUE, _T("file"), _T("Path to the data file to quickstart"))),
     quickstartRegistry(0, _T("quickstartreg"), _T("(DEPRECATED!) Registers data file types for quickstart is supported by the OS"), ParserOption::FLAG_NULL,
@@ -100,6 +101,7 @@ megamol::console::utility::CmdLineParser::CmdLineParser(void)
     this->parser.AddOption(&this->showGUI);
     this->parser.AddOption(&this->useKHR);
     this->parser.AddOption(&this->quadBuffer);
+    this->parser.AddOption(&this->headless);
 
     this->parser.AddOption(&this->projectFile);
     this->parser.AddOption(&this->instJobView);
@@ -359,6 +359,16 @@ namespace utility {
             return this->quadBuffer.GetFirstOccurrence() != NULL;
         }
 
+        /**
+         * Answer if the views should be rendered headless, i.e. without
+         * windows.
+         *
+         * @return true if the views should be rendered headless.
+         */
+        inline bool Headless(void) const {
+            return this->headless.GetFirstOccurrence() != NULL;
+        }
+
         /**
          * Answers if any quickstarts have been specified
          *
@@ -509,6 +519,9 @@ namespace utility {
         /** Flag to request quad-buffer support */
         ParserOption quadBuffer;
 
+        /** Flag to request headless rendering */
+        ParserOption headless;
+
         /** Perform a data set quickstart */
         ParserOption quickstart;
 
@@ -57,6 +57,15 @@ namespace core {
          */
         virtual bool abort(void);
 
+        /**
+         * Reports the progress of the run function to the controlling job.
+         * May be called from any thread while run is executed.
+         *
+         * @param progress The fraction of the data written, in [0, 1]
+         * @param bytesWritten The number of bytes written so far
+         */
+        void setProgress(float progress, UINT64 bytesWritten);
+
     private:
 
         /**
@@ -99,6 +108,9 @@ namespace core {
         /** Triggers execution of the 'run' method */
         param::ParamSlot manualRunSlot;
 
+        /** The control call of the running run function, if any */
+        DataWriterCtrlCall *runningCall;
+
 
 
     };
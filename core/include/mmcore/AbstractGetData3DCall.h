@@ -82,6 +82,19 @@ namespace core {
             return this->forceFrame;
         }
 
+        /**
+         * Answer if the requested frame is still being loaded. Data providers
+         * set this flag if they answer a request that is not forced with the
+         * closest available frame instead, which is then reported by
+         * 'FrameID'. Callers can keep repeating the request without blocking
+         * until the flag is cleared.
+         *
+         * @return The flag if the requested frame is pending
+         */
+        inline bool IsFramePending(void) const {
+            return this->framePending;
+        }
+
         /**
          * Sets the extents of the data.
          * Called modules uses this method to output their data.
@@ -138,6 +151,18 @@ namespace core {
         inline void SetFrameID(unsigned int frameID, bool force = false) {
             this->forceFrame = force;
             this->frameID = frameID;
+            this->framePending = false;
+        }
+
+        /**
+         * Sets the flag whether the requested frame is still being loaded.
+         * Called modules use this method after reporting the answered frame
+         * via 'SetFrameID'.
+         *
+         * @param pending The flag if the requested frame is pending
+         */
+        inline void SetFramePending(bool pending) {
+            this->framePending = pending;
         }
 
         /**
@@ -188,6 +213,9 @@ namespace core {
         /** The requested/stored frameID */
         unsigned int frameID;
 
+        /** Flag whether the requested frame is still being loaded */
+        bool framePending;
+
         /** the coordinate extents */
         BoundingBoxes bboxs;
 
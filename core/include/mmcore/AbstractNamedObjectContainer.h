@@ -15,6 +15,8 @@
 #include "mmcore/AbstractNamedObject.h"
 #include <list>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include "vislib/macro_utils.h"
 
 
@@ -39,6 +41,9 @@ namespace core {
         /** Type of single linked list of children. */
         typedef std::list<AbstractNamedObject::ptr_type> child_list_type;
 
+        /** Type of the index of children by their names. */
+        typedef std::unordered_map<std::string, AbstractNamedObject::ptr_type> child_index_type;
+
         /**
          * Utility function to dynamically cast to a shared_ptr of this type
          *
@@ -145,6 +150,15 @@ namespace core {
             return this->children.end();
         }
 
+        /**
+         * Answer the version of the structure of all module graphs, which
+         * changes whenever a child is added to, removed from, or renamed
+         * in any container. Can be used to invalidate cached lookups.
+         *
+         * @return The current structure version
+         */
+        static unsigned int StructureVersion(void);
+
         /**
          * Sets the cleanup mark and all marks of all children
          */
@@ -212,10 +226,36 @@ namespace core {
 
     private:
 
+        /* Allow children to update the index when they are renamed */
+        friend class AbstractNamedObject;
+
+        /**
+         * Updates the index after a child has been renamed.
+         *
+         * @param oldName The previous name of the child.
+         * @param newName The new name of the child.
+         */
+        void renameChild(const vislib::StringA& oldName, const vislib::StringA& newName);
+
+        /**
+         * Indexes the first child with the given name, or removes the name
+         * from the index if there is no such child.
+         *
+         * @param name The name to index.
+         */
+        void reindexChild(const vislib::StringA& name);
+
         /** The children of the container */
 VISLIB_MSVC_SUPPRESS_WARNING(4251)
         child_list_type children;
 
+        /**
+         * The first child of each name, for lookups without iterating the
+         * children
+         */
+VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        child_index_type childIndex;
+
     };
 
 } /* end namespace core */
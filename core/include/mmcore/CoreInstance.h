@@ -37,6 +37,7 @@
 #include "mmcore/utility/Configuration.h"
 #include "mmcore/utility/LogEchoTarget.h"
 #include "mmcore/utility/ShaderSourceFactory.h"
+#include "mmcore/utility/TaskScheduler.h"
 
 #include "vislib/Array.h"
 #include "vislib/IllegalStateException.h"
@@ -53,8 +54,12 @@
 #include "vislib/sys/Log.h"
 
 #include <functional>
+#include <future>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace megamol {
 namespace core {
@@ -123,6 +128,9 @@ public:
     /** return the contained LuaState */
     inline LuaState* GetLuaState(void) { return this->lua; }
 
+    /** return the scheduler modules use for their parallel work */
+    inline utility::TaskScheduler& GetTaskScheduler(void) { return utility::TaskScheduler::Instance(); }
+
     /** return whether loaded project files are Lua-based or legacy */
     inline bool IsLuaProject() const { return this->loadedLuaProjects.Count() > 0; }
 
@@ -287,6 +295,19 @@ public:
     //** do everything that is queued w.r.t. modules and calls */
     void PerformGraphUpdates();
 
+    /**
+     * Starts a batch of graph updates. Requests queued before the matching
+     * call of EndGraphUpdateBatch are not performed earlier, so
+     * PerformGraphUpdates applies a batch in one go and never half of it.
+     * Batches may be nested. A LuaState runs every script as one batch.
+     */
+    void BeginGraphUpdateBatch(void);
+
+    /**
+     * Ends a batch of graph updates started by BeginGraphUpdateBatch.
+     */
+    void EndGraphUpdateBatch(void);
+
     /**
      * Answer whether the core has pending requests of instantiations of
      * views.
@@ -1042,6 +1063,18 @@ private:
     vislib::StringA findParameterName(
         ModuleNamespace::const_ptr_type path, const vislib::SmartPtr<param::AbstractParam>& param) const;
 
+    /**
+     * Resolves the parameter slot with the given name in the module graph.
+     * The caller must hold the module graph lock.
+     *
+     * @param name The full name of the parameter slot.
+     * @param quiet Flag controlling the error output if the slot is not
+     *              found.
+     *
+     * @return The found slot or NULL if no slot with this name exists.
+     */
+    param::ParamSlot* findParameterSlot(const vislib::StringA& name, bool quiet);
+
     /**
      * Closes a view or job handle (the corresponding instance object will
      * be deleted by the caller.
@@ -1059,12 +1092,27 @@ private:
     void applyConfigParams(
         const vislib::StringA& root, const InstanceDescription* id, const ParamValueSetRequest* params);
 
+    /**
+     * Performs the queued graph updates. The caller must hold the
+     * graphUpdateLock.
+     */
+    void performGraphUpdates(void);
+
+    /**
+     * Notifies the param update listeners
+     *
+     * @param slot The updated parameter
+     */
+    void notifyParamUpdateListeners(param::ParamSlot& slot);
+
     /**
      * Loads the plugin 'filename'
      *
      * @param filename The plugin to load
+     * @param lib The library of the plugin, which is loaded asynchronously
      */
-    void loadPlugin(const vislib::TString& filename);
+    void loadPlugin(
+        const vislib::TString& filename, std::future<std::shared_ptr<vislib::sys::DynamicLinkLibrary>>& lib);
 
     /**
      * Compares two maps storing the association between
@@ -1253,9 +1301,29 @@ private:
      */
     mutable vislib::sys::CriticalSection graphUpdateLock;
 
+    /** The number of open graph update batches, guarded by graphUpdateLock */
+    unsigned int graphUpdateBatchDepth;
+
+    /**
+     * Whether param update listeners are notified after the graph updates
+     * only, guarded by graphUpdateLock
+     */
+    bool deferParamUpdates;
+
+    /** The parameters updated while deferParamUpdates is set, each once */
+    std::vector<param::ParamSlot*> deferredParamUpdates;
+    std::unordered_set<param::ParamSlot*> deferredParamUpdateSet;
+
     /** The module namespace root */
     RootModuleNamespace::ptr_type namespaceRoot;
 
+    /**
+     * The parameter slots resolved by FindParameter, guarded by the module
+     * graph lock and valid for the stored structure version only
+     */
+    std::unordered_map<std::string, std::weak_ptr<AbstractNamedObject>> paramSlotCache;
+    unsigned int paramSlotCacheVersion;
+
     /** the time offset */
     double timeOffset;
 
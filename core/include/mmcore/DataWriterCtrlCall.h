@@ -12,6 +12,8 @@
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
 #include "mmcore/Call.h"
+#include "vislib/types.h"
+#include <atomic>
 
 
 namespace megamol {
@@ -99,6 +101,39 @@ namespace core {
             this->abortable = abortable;
         }
 
+        /**
+         * Answer the progress of the running writer. May be called from
+         * other threads while the writer runs.
+         *
+         * @return The fraction of the data written, in [0, 1], or a
+         *         negative value if the writer does not report its progress
+         */
+        inline float Progress(void) const {
+            return this->progress.load();
+        }
+
+        /**
+         * Answer the number of bytes written by the running writer
+         *
+         * @return The number of bytes written so far
+         */
+        inline UINT64 BytesWritten(void) const {
+            return this->bytesWritten.load();
+        }
+
+        /**
+         * Sets the progress of the running writer. May be called from any
+         * thread of the writer.
+         *
+         * @param progress The fraction of the data written, in [0, 1], or a
+         *                 negative value if unknown
+         * @param bytesWritten The number of bytes written so far
+         */
+        inline void SetProgress(float progress, UINT64 bytesWritten) {
+            this->progress.store(progress);
+            this->bytesWritten.store(bytesWritten);
+        }
+
         /**
          * Assignment operator.
          *
@@ -113,6 +148,12 @@ namespace core {
         /** Flag indicate the capability of being abortable */
         bool abortable;
 
+        /** The progress of the running writer */
+        std::atomic<float> progress;
+
+        /** The number of bytes written by the running writer */
+        std::atomic<UINT64> bytesWritten;
+
     };
 
 } /* end namespace core */
@@ -118,16 +118,85 @@ public:
         if (f && f->size() != count) {
             f->resize(count, init);
             ++version;
+            this->invalidateDirtyRanges();
         }
     }
 
+    /**
+     * Reports that the flags in [begin, end) were changed. Writers that report all their
+     * changes before returning the flags with a new version allow consumers to update
+     * incrementally. Only valid while the flags are mapped.
+     */
+    void MarkDirty(size_t begin, size_t end);
+
+    /**
+     * Answers the index ranges changed after version 'since', merged and sorted.
+     * Only valid while the flags are mapped, and before changing them.
+     *
+     * @param since  The version the consumer's copy of the flags corresponds to.
+     * @param ranges Receives the changed ranges.
+     *
+     * @return 'true' if the changes are known, 'false' if the consumer needs to fetch all flags.
+     */
+    bool GetChangesSince(FlagStorage::FlagVersionType since, std::vector<FlagStorage::FlagRangeType>& ranges) const;
+
+    /**
+     * Answers the shader storage buffer of the storage holding the flags, which is shared by all
+     * consumers and updated with the changed ranges only. Only valid while the flags are mapped and
+     * contained in the call, i.e. before GetFlags or after SetFlags, and on the GL thread. Consumers
+     * should ask for the buffer on every mapping instead of keeping its name.
+     *
+     * @return The GL name of the buffer, or 0 if the flags are not available.
+     */
+    unsigned int GetFlagsBuffer(void);
+
+    /**
+     * Reports that the shared buffer holds the flags contained in the call, e.g. after writing the
+     * buffer on the GPU and downloading it into the flags. Only valid while the flags are mapped and
+     * contained in the call.
+     */
+    void MarkFlagsBufferCurrent(void);
+
 
     FlagCall(void);
     virtual ~FlagCall(void);
 
 private:
+    friend class FlagStorage;
+
+    /** Sets the change log of the storage while the flags are mapped */
+    inline void setChangeLog(const FlagStorage::FlagChangeLogType* log, FlagStorage::FlagVersionType base) {
+        this->changeLog = log;
+        this->changeLogBase = base;
+        this->dirtyRanges.clear();
+        this->dirtyValid = true;
+    }
+
+    /** Sets the shared GL buffer of the storage while the flags are mapped */
+    inline void setBuffer(FlagStorage::FlagBufferType* b) { this->buffer = b; }
+
+    /** Marks the changes of the current mapping as unknown */
+    inline void invalidateDirtyRanges(void) {
+        this->dirtyRanges.clear();
+        this->dirtyValid = false;
+    }
+
+    /** Moves the merged ranges reported via MarkDirty to 'ranges', answering whether they are complete */
+    bool takeDirtyRanges(std::vector<FlagStorage::FlagRangeType>& ranges);
+
     std::shared_ptr<FlagStorage::FlagVectorType> flags;
     FlagStorage::FlagVersionType version;
+
+    /** The change log of the storage, only valid while mapped */
+    const FlagStorage::FlagChangeLogType* changeLog;
+    FlagStorage::FlagVersionType changeLogBase;
+
+    /** The ranges changed during the current mapping */
+    std::vector<FlagStorage::FlagRangeType> dirtyRanges;
+    bool dirtyValid;
+
+    /** The shared GL buffer of the storage, only valid while mapped */
+    FlagStorage::FlagBufferType* buffer;
 };
 
 /** Description class typedef */
@@ -11,6 +11,7 @@
 #    pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include <deque>
 #include <mutex>
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/Module.h"
@@ -28,6 +29,16 @@ namespace core {
  * Class storing a stream of uints which contain flags that say something
  * about a synchronized other piece of data (index equality).
  * Can be used for storing selection etc.
+ *
+ * Besides the version, the storage keeps a log of the index ranges changed
+ * by recent versions, such that consumers can patch their copies instead of
+ * transferring all flags again (see FlagCall::GetChangesSince). Writers that
+ * do not report their changes invalidate the whole log.
+ *
+ * The storage also owns an OpenGL shader storage buffer holding the flags,
+ * which all renderers on the same context can bind instead of uploading
+ * their own copies (see FlagCall::GetFlagsBuffer). It is updated lazily
+ * from the change log when it is requested, i.e. only once per change.
  */
 class MEGAMOLCORE_API FlagStorage : public core::Module {
 public:
@@ -38,6 +49,27 @@ public:
 
     typedef std::vector<FlagItemType> FlagVectorType;
 
+    /** A half-open range [first, second) of flag indices */
+    typedef std::pair<size_t, size_t> FlagRangeType;
+
+    /** The ranges changed by one version */
+    struct FlagChangeType {
+        FlagVersionType version;
+        std::vector<FlagRangeType> ranges;
+    };
+
+    typedef std::deque<FlagChangeType> FlagChangeLogType;
+
+    /** The shared GL buffer of the flags */
+    struct FlagBufferType {
+        /** The GL name of the buffer, 0 if not created yet */
+        unsigned int name;
+        /** The version of the flags the buffer holds */
+        FlagVersionType version;
+        /** The number of flags the buffer holds */
+        size_t size;
+    };
+
     /**
      * Answer the name of this module.
      *
@@ -107,6 +139,15 @@ private:
 
     FlagVersionType version;
 
+    /** The changes of the versions following 'changesBase', oldest first */
+    FlagChangeLogType changes;
+
+    /** The shared GL buffer */
+    FlagBufferType buffer;
+
+    /** The oldest version from which on all changes are logged */
+    FlagVersionType changesBase;
+
     // std::recursive_mutex mut;
     std::mutex mut;
 };
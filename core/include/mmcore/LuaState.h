@@ -224,6 +224,10 @@ protected:
     int Flush(lua_State* L);
     int CurrentScriptPath(lua_State* L);
 
+    int ProfilerSelect(lua_State* L);
+    int ProfilerReport(lua_State* L);
+    int ProfilerWriteTrace(lua_State* L);
+
 private:
 
     /** answer whether LuaState is instanced for configuration */
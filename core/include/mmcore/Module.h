@@ -14,6 +14,10 @@
 #include "mmcore/api/MegaMolCore.std.h"
 #include "mmcore/AbstractNamedObjectContainer.h"
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 
 namespace megamol {
 namespace core {
@@ -21,6 +25,9 @@ namespace core {
     /** forward declaration */
     class CoreInstance;
     class AbstractSlot;
+    namespace param {
+        class ParamSlot;
+    }
     namespace factories {
         class ModuleDescription;
     }
@@ -45,6 +52,7 @@ namespace core {
     class MEGAMOLCORE_API Module: public AbstractNamedObjectContainer {
     public:
         friend class ::megamol::core::factories::ModuleDescription;
+        friend class ::megamol::core::param::ParamSlot;
 
         /** Shared ptr type alias */
         typedef ::std::shared_ptr<Module> ptr_type;
@@ -156,6 +164,30 @@ namespace core {
             return this->className;
         }
 
+        /**
+         * Answers the generation of the parameters of this module, which is
+         * incremented whenever one of its parameters is set. Remembering the
+         * generation allows for skipping all checks of the parameters with a
+         * single comparison as long as none of them changed.
+         *
+         * @return The generation of the parameters of this module.
+         */
+        inline size_t ParamGeneration(void) const {
+            return this->paramGeneration.load();
+        }
+
+        /**
+         * Answers whether the callbacks of this module may be called from
+         * worker threads of the task scheduler, e.g. by a
+         * utility::CallGraphExecutor. This is false unless the module opted
+         * in by calling 'setCallableFromWorkerThreads'.
+         *
+         * @return Whether the callbacks may be called from worker threads.
+         */
+        inline bool IsCallableFromWorkerThreads(void) const {
+            return this->callableFromWorkerThreads;
+        }
+
     protected:
 
         /**
@@ -203,8 +235,63 @@ namespace core {
         void MakeSlotAvailable(AbstractSlot *slot);
         void SetSlotUnavailable(AbstractSlot *slot);
 
+        /**
+         * Registers a callback which is called once whenever one of a group
+         * of parameters is set, e.g. for parameters that are only meaningful
+         * together. Unlike the update callback of a single slot, the callback
+         * does not touch the dirty flags. Register group callbacks in the ctor
+         * or in 'create' only.
+         *
+         * Be aware that the callback might be called from within another
+         * thread.
+         *
+         * @param slots The parameter slots of the group.
+         * @param callback The callback, receiving the slot that was set.
+         */
+        void AddParamGroupCallback(const std::vector<param::ParamSlot*>& slots,
+            const std::function<void(param::ParamSlot&)>& callback);
+
+        /**
+         * Answers the sum of the generations of the given parameters, which
+         * changes whenever one of them is set.
+         *
+         * @param slots The parameter slots.
+         *
+         * @return The combined generation of the parameters.
+         */
+        static size_t paramGroupGeneration(const std::vector<const param::ParamSlot*>& slots);
+
+        /**
+         * Declares that the callbacks of this module may be called from
+         * worker threads of the task scheduler. Only opt in if the callbacks
+         * neither use OpenGL nor lock the module graph, and do not depend on
+         * the thread calling them. A module is still never called
+         * concurrently by a utility::CallGraphExecutor. Call this in the
+         * ctor only.
+         *
+         * @param callable Whether the callbacks may be called from worker
+         *                 threads.
+         */
+        inline void setCallableFromWorkerThreads(bool callable) {
+            this->callableFromWorkerThreads = callable;
+        }
+
     private:
 
+        /** A callback for a group of parameters */
+        struct ParamGroupCallback {
+            std::vector<const param::ParamSlot*> slots;
+            std::function<void(param::ParamSlot&)> callback;
+        };
+
+        /**
+         * Increments the parameter generation and calls the group callbacks
+         * for a parameter that was set.
+         *
+         * @param slot The slot of the parameter.
+         */
+        void paramUpdated(param::ParamSlot& slot);
+
         /** Sets the name of the module */
         void setModuleName(const vislib::StringA& name);
 
@@ -213,6 +300,21 @@ namespace core {
 
         const char *className;
 
+        /** Whether the callbacks may be called from worker threads */
+        bool callableFromWorkerThreads;
+
+#ifdef _WIN32
+#pragma warning (disable: 4251)
+#endif /* _WIN32 */
+        /** The generation of the parameters of this module */
+        std::atomic<size_t> paramGeneration;
+
+        /** The callbacks for groups of parameters */
+        std::vector<ParamGroupCallback> paramGroupCallbacks;
+#ifdef _WIN32
+#pragma warning (default: 4251)
+#endif /* _WIN32 */
+
         /* Allow the container to access the internal create flag */
         friend class ::megamol::core::AbstractNamedObjectContainer;
 
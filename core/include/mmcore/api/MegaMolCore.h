@@ -719,6 +719,18 @@ MEGAMOLCORE_API bool MEGAMOLCORE_CALL mmcStartJob(void *hJob);
  */
 MEGAMOLCORE_API void MEGAMOLCORE_CALL mmcTerminateJob(void *hJob);
 
+/**
+ * Gets the progress of a running job.
+ *
+ * @param hJob The job to be queried.
+ * @param progress Receives the fraction of the work done, in [0, 1].
+ * @param bytes Receives the number of bytes processed so far.
+ *
+ * @return 'true' if the job reports its progress, 'false' otherwise.
+ */
+MEGAMOLCORE_API bool MEGAMOLCORE_CALL mmcGetJobProgress(void *hJob,
+    float *progress, unsigned long long *bytes);
+
 /**
  * Sets a parameter to a value.
  *
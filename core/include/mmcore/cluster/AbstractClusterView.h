@@ -184,6 +184,9 @@ namespace cluster {
         /** Data received from the network to setup the module graph */
         vislib::net::SimpleMessage *graphInitData;
 
+        /** The version of the last parameter values received */
+        UINT64 paramVersion;
+
     };
 
 
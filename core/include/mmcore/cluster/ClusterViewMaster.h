@@ -14,6 +14,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/cluster/ClusterControllerClient.h"
 #include "mmcore/cluster/CommChannelServer.h"
+#include "mmcore/cluster/ParamReplicationLog.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/param/ParamUpdateListener.h"
@@ -242,9 +243,12 @@ namespace cluster {
         /** Performs a sanitycheck of the times on all cluster nodes */
         param::ParamSlot sanityCheckTimeSlot;
 
-        /** The thread to update the camera settings */
+        /** The thread to update the camera settings and parameter values */
         vislib::sys::Thread camUpdateThread;
 
+        /** The parameter values to be replicated to the cluster */
+        ParamReplicationLog paramLog;
+
         /** The slot to enter view pause */
         param::ParamSlot pauseRemoteViewSlot;
 
@@ -91,6 +91,12 @@ namespace netmessages {
     /** Message with verbatim lua code for graph setup from master */
     const UINT32 MSG_GRAPHSETUP_LUA = 21;
 
+    /**
+     * Message containing a versioned batch of parameter value pairs, see
+     * ParamReplicationLog
+     */
+    const UINT32 MSG_SET_PARAMVALUES = 22;
+
     /************************************************************************/
 
     /** The number of pings used for time syncing */
@@ -0,0 +1,119 @@
+/*
+ * ParamReplicationLog.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_PARAMREPLICATIONLOG_H_INCLUDED
+#define MEGAMOLCORE_PARAMREPLICATIONLOG_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "vislib/String.h"
+#include "vislib/types.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace megamol {
+namespace core {
+namespace cluster {
+
+    /**
+     * Log of the parameter values to be replicated to the cluster nodes.
+     *
+     * Changed values are recorded as they happen, but only sent once per
+     * frame, such that a slider drag results in one value per frame instead
+     * of one message per intermediate value. Every batch of changes gets a
+     * new version. All values recorded so far form the snapshot sent to
+     * nodes joining late.
+     */
+    class ParamReplicationLog {
+    public:
+
+        /** A parameter name and its value */
+        typedef std::pair<vislib::StringA, vislib::StringA> Entry;
+
+        /** Ctor. */
+        ParamReplicationLog(void);
+
+        /** Dtor. */
+        ~ParamReplicationLog(void);
+
+        /**
+         * Records the new value of a parameter, replacing a value of the
+         * same parameter which has not been taken yet.
+         *
+         * @param name The full name of the parameter slot
+         * @param value The value string
+         */
+        void Record(const vislib::StringA& name, const vislib::StringA& value);
+
+        /**
+         * Takes the values changed since the last call.
+         *
+         * @param outVersion Receives the version of the changes
+         * @param outChanges Receives the changed values
+         *
+         * @return True if there are changes, false otherwise
+         */
+        bool TakeChanges(UINT64& outVersion, std::vector<Entry>& outChanges);
+
+        /**
+         * Answers all values recorded so far.
+         *
+         * @param outValues Receives the values
+         *
+         * @return The version of the snapshot, i.e. of the last changes taken
+         */
+        UINT64 Snapshot(std::vector<Entry>& outValues) const;
+
+        /**
+         * Serialises a version and values into a message body of the layout
+         * UINT64 version, followed by zero-terminated name and value strings.
+         *
+         * @param version The version
+         * @param values The values
+         * @param outBody Receives the message body
+         */
+        static void Serialise(UINT64 version, const std::vector<Entry>& values, std::vector<char>& outBody);
+
+        /**
+         * Deserialises a message body written by Serialise.
+         *
+         * @param body The message body
+         * @param size The size of the body in bytes
+         * @param outVersion Receives the version
+         * @param outValues Receives the values
+         *
+         * @return True on success, false if the body is malformed
+         */
+        static bool Deserialise(const void *body, SIZE_T size, UINT64& outVersion, std::vector<Entry>& outValues);
+
+    private:
+
+        /** The lock for all members */
+        mutable std::mutex lock;
+
+        /** The version of the last changes taken */
+        UINT64 version;
+
+        /** The latest values of all parameters recorded */
+        std::map<std::string, std::string> values;
+
+        /** The parameters changed since the last changes taken */
+        std::map<std::string, std::string> changes;
+
+    };
+
+
+} /* end namespace cluster */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_PARAMREPLICATIONLOG_H_INCLUDED */
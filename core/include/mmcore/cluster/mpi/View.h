@@ -13,6 +13,7 @@
 
 #include <atomic>
 #include <climits>
+#include <vector>
 
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -32,6 +33,7 @@
 #include "mmcore/param/ParamUpdateListener.h"
 #include "mmcore/cluster/SyncDataSourcesCall.h"
 
+#include "vislib/graphics/gl/FramebufferObject.h"
 #include "vislib/net/AbstractSimpleMessage.h"
 #include "vislib/sys/CriticalSection.h"
 #include "vislib/RawStorage.h"
@@ -183,9 +185,28 @@ namespace mpi {
             double InstanceTime;
             bool InvalidateMaster;
             bool InitSwapGroup;
+            bool DataParallel;
             size_t RelaySize;
         } FrameState;
 
+        /** A pixel of the sort-last composite. */
+        typedef struct CompositePixel {
+            float Depth;
+            UINT32 Colour;
+        } CompositePixel;
+
+        /** The tile of a rank as needed by all other ranks for compositing. */
+        typedef struct CompositeTile {
+            float VirtWidth;
+            float VirtHeight;
+            float TileX;
+            float TileY;
+            float TileW;
+            float TileH;
+            UINT32 Width;
+            UINT32 Height;
+        } CompositeTile;
+
         /** Defines the state that the view is in. */
         typedef enum ViewState {
             CREATED,
@@ -193,6 +214,15 @@ namespace mpi {
             FORCE_UINT = UINT_MAX
         } ViewState;
 
+#ifdef WITH_MPI
+        /**
+         * The MPI reduction operation keeping the nearer of two
+         * 'CompositePixel's. Ties are resolved by the colour value, such that
+         * the operation is commutative.
+         */
+        static void compositePixels(void* in, void* inout, int* len, MPI_Datatype* type);
+#endif /* WITH_MPI */
+
         /**
          * Implementation of 'Create'.
          *
@@ -291,6 +321,24 @@ namespace mpi {
          */
         virtual void release(void);
 
+        /**
+         * Renders the view in data-parallel mode.
+         *
+         * Every rank only holds a spatial partition of the data, but the
+         * views on all ranks must report the bounding box of the whole data
+         * set, e.g. by using MPIDomainDecomposition, such that the depth
+         * values of all ranks are comparable. Every rank renders its
+         * partition into the tiles of all ranks, which are then depth
+         * composited onto the rank owning the tile.
+         *
+         * This method must be called collectively by all ranks.
+         *
+         * @param crv The call to the view to be rendered.
+         *
+         * @return true if the composite was drawn, false otherwise.
+         */
+        bool renderDataParallel(view::CallRenderView& crv);
+
         /**
          * Store the given message for relay to other nodes.
          *
@@ -324,8 +372,23 @@ namespace mpi {
 #ifdef WITH_MPI
         /** The communicator that the view uses. */
         MPI_Comm comm;
+
+        /** The reduction operation depth compositing 'CompositePixel's. */
+        MPI_Op compositeOp;
+
+        /** The MPI type of 'CompositePixel'. */
+        MPI_Datatype compositeType;
 #endif /* WITH_MPI */
 
+        /** The pixels of the local partition for the tile being composited. */
+        std::vector<CompositePixel> compositeBuffer;
+
+        /** The framebuffer the local partition is rendered to. */
+        vislib::graphics::gl::FramebufferObject compositeFbo;
+
+        /** The composited pixels of the own tile. */
+        std::vector<CompositePixel> compositeResult;
+
         /**
          * The buffer that is acutually transmitted. This buffer contains
          * filtered messages only to prevent superseded data from being
@@ -357,6 +420,12 @@ namespace mpi {
          */
         bool mustNegotiateMaster;
 
+        /**
+         * Configures whether every rank renders only its partition of the
+         * data, which is composited by depth.
+         */
+        param::ParamSlot paramDataParallel;
+
         /** Configures whether the view should try to enable GSync. */
         param::ParamSlot paramUseGsync;
 
@@ -12,6 +12,7 @@
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
 #include "mmcore/utility/Configuration.h"
+#include <cstddef>
 
 
 namespace megamol {
@@ -63,6 +64,43 @@ namespace simple {
 #define MSG_TCUPDATE 12
 #define MSG_MODULGRAPH_LUA 13
 
+#define MSG_HEARTBEAT_READY 14
+#define MSG_HEARTBEAT_GO 15
+#define HEARTBEATPAYLOADSIZE 1400
+
+    /**
+     * Struct layout of a multicast heartbeat datagram. Tiles announce that
+     * they reached a barrier with MSG_HEARTBEAT_READY to the heartbeat
+     * server, which releases all of them with a single multicast
+     * MSG_HEARTBEAT_GO. A tile not released in time resends its
+     * MSG_HEARTBEAT_READY, which the server answers by resending the last
+     * MSG_HEARTBEAT_GO to that tile only.
+     */
+    typedef struct _heartbeatdatagram_t {
+
+        /** "MMB" */
+        char magic[3];
+
+        /** The datagram message */
+        unsigned char msg;
+
+        /** The synchronisation tier */
+        unsigned char tier;
+
+        /** The number of the barrier, counting from 1 */
+        UINT32 seq;
+
+        /** The number of valid payload bytes */
+        UINT16 size;
+
+        /** The payload data, i.e. the heartbeat time and camera data */
+        char payload[HEARTBEATPAYLOADSIZE];
+
+    } HeartbeatDatagram;
+
+/** The number of bytes of a HeartbeatDatagram to be sent */
+#define HEARTBEATDATAGRAMSIZE(dg) (offsetof(HeartbeatDatagram, payload) + (dg).size)
+
     /**
      * Struct layout a simple cluster datagram
      */
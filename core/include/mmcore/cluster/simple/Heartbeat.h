@@ -15,8 +15,12 @@
 #include "mmcore/Module.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/cluster/simple/CommUtil.h"
+#include "vislib/Array.h"
 #include "vislib/net/CommServer.h"
 #include "vislib/net/CommServerListener.h"
+#include "vislib/net/IPEndPoint.h"
+#include "vislib/net/Socket.h"
 #include "vislib/sys/CriticalSection.h"
 #include "vislib/sys/Event.h"
 #include "vislib/RawStorage.h"
@@ -309,6 +313,25 @@ namespace simple {
          */
         void connWaiting(Connection *con);
 
+        /**
+         * (Re-)Opens the multicast heartbeat as specified by the parameters
+         */
+        void openMulticast(void);
+
+        /**
+         * Closes the multicast heartbeat
+         */
+        void closeMulticast(void);
+
+        /**
+         * The thread receiving the announcements of the multicast tiles
+         *
+         * @param userData Points to this object
+         *
+         * @return 0
+         */
+        static DWORD udpReceive(void *userData);
+
         /** The slot registering this view */
         CallerSlot registerSlot;
 
@@ -342,6 +365,27 @@ namespace simple {
         /** The current synchronization tier */
         unsigned char tier;
 
+        /** The multicast group releasing the tiles, empty for TCP only */
+        param::ParamSlot heartBeatMulticastSlot;
+
+        /** Flag letting the multicast receiver run */
+        bool udpRun;
+
+        /** The socket receiving the announcements and sending the releases */
+        vislib::net::Socket udpSocket;
+
+        /** The thread receiving the announcements */
+        vislib::sys::Thread udpReceiver;
+
+        /** The multicast group the releases are sent to */
+        vislib::net::IPEndPoint udpGroup;
+
+        /** The multicast tiles waiting on the current barrier */
+        vislib::Array<vislib::net::IPEndPoint> udpWaiting;
+
+        /** The last release, resent to tiles which missed it */
+        HeartbeatDatagram udpLast;
+
 
         ///**
         // * Renders this AbstractView3D in the currently active OpenGL context.
@@ -14,6 +14,8 @@
 #include "vislib/RawStorage.h"
 #include "vislib/SmartRef.h"
 #include "vislib/String.h"
+#include "vislib/net/IPEndPoint.h"
+#include "vislib/net/Socket.h"
 #include "vislib/net/TcpCommChannel.h"
 #include "vislib/sys/Thread.h"
 
@@ -42,8 +44,12 @@ namespace simple {
          *
          * @param server The server of the heartbeat to connect to
          * @param port The port of the heartbeat to connect to
+         * @param multicastGroup The multicast group of the heartbeat server
+         *                       releasing the tiles, or empty to
+         *                       synchronise via TCP
          */
-        void Connect(vislib::StringW server, unsigned int port);
+        void Connect(vislib::StringW server, unsigned int port,
+            const vislib::StringA& multicastGroup = vislib::StringA::EMPTY);
 
         /**
          * Closes the connection and shuts the client down.
@@ -76,6 +82,16 @@ namespace simple {
          */
         static DWORD connector(void *userData);
 
+        /**
+         * Synchronises to the heartbeat via multicast
+         *
+         * @param tier The synchronization tier
+         * @param outPayload The data received from the heartbeat server
+         *
+         * @return True if the payload is valid
+         */
+        bool syncMulticast(unsigned char tier, vislib::RawStorage& outPayload);
+
         /** The communication channel */
         vislib::SmartRef<vislib::net::TcpCommChannel> chan;
 
@@ -88,6 +104,18 @@ namespace simple {
         /* The server of the heartbeat to connect to */
         vislib::StringW server;
 
+        /* The multicast group of the heartbeat, empty for TCP only */
+        vislib::StringA group;
+
+        /** The socket announcing to and receiving from the heartbeat via multicast */
+        vislib::net::Socket udpSocket;
+
+        /** The end point the announcements are sent to */
+        vislib::net::IPEndPoint udpServer;
+
+        /** The number of the last barrier passed via multicast */
+        UINT32 udpSeq;
+
     };
 
 
@@ -16,6 +16,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/param/ParamUpdateListener.h"
+#include "mmcore/cluster/ParamReplicationLog.h"
 #include "mmcore/cluster/simple/CommUtil.h"
 #include "vislib/net/CommServer.h"
 #include "vislib/net/CommServerListener.h"
@@ -405,6 +406,14 @@ namespace simple {
          */
         static DWORD cameraUpdateThread(void *userData);
 
+        /**
+         * Builds the MSG_PARAMUPDATE message of a parameter value
+         *
+         * @param entry The parameter name and value
+         * @param outMsg Receives the message
+         */
+        static void makeParamMessage(const ParamReplicationLog::Entry& entry, vislib::net::SimpleMessage& outMsg);
+
         /** The parameter slot holding the name of the view module to be use */
         param::ParamSlot viewnameSlot;
 
@@ -473,6 +482,9 @@ namespace simple {
         /** Use the force luke */
         bool camUpdateThreadForce;
 
+        /** The parameter values to be sent to the clients */
+        ParamReplicationLog paramLog;
+
         /** Client receivers have access */
         friend class Client;
 
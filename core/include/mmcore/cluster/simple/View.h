@@ -268,6 +268,9 @@ namespace simple {
         /** The address of the heartbeat server */
         param::ParamSlot heartBeatServerSlot;
 
+        /** The multicast group of the heartbeat server */
+        param::ParamSlot heartBeatMulticastSlot;
+
         /** Flag controlling whether or not this view directly syncs it's camera without using the heartbeat server */
         param::ParamSlot directCamSyncSlot;
 
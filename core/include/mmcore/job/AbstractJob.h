@@ -18,6 +18,7 @@
 #include "vislib/SmartPtr.h"
 #include "vislib/String.h"
 #include "vislib/SingleLinkedList.h"
+#include "vislib/types.h"
 
 
 namespace megamol {
@@ -69,6 +70,17 @@ namespace job {
          */
         virtual bool Terminate(void) = 0;
 
+        /**
+         * Answers the progress of the job. May be called from other threads
+         * while the job runs.
+         *
+         * @param outProgress Receives the fraction of the work done, in [0, 1]
+         * @param outBytes Receives the number of bytes processed so far
+         *
+         * @return 'true' if the job reports its progress, 'false' if not.
+         */
+        virtual bool GetProgress(float& outProgress, UINT64& outBytes);
+
     protected:
 
         /**
@@ -0,0 +1,217 @@
+/*
+ * DataSourceBenchmarkJob.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_DATASOURCEBENCHMARKJOB_H_INCLUDED
+#define MEGAMOLCORE_DATASOURCEBENCHMARKJOB_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/Call.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include "vislib/String.h"
+
+#include <string>
+#include <vector>
+
+
+namespace megamol {
+namespace core {
+namespace job {
+
+
+    /**
+     * Threaded job measuring the I/O throughput of a data source module.
+     *
+     * The data source is connected through any call, and its file name
+     * parameter is set to each of the benchmarked files in turn. For every
+     * file, the open latency is measured with a cold and a warm file system
+     * cache, followed by sequential and random frame seeks through the
+     * (AnimDataModule based) frames of 3D data calls. The bytes per frame
+     * are taken from the particle lists or volumes where known, and
+     * estimated from the file size otherwise. Optionally, a synthetic MMPLD
+     * file of configurable size is generated and benchmarked first.
+     */
+    class DataSourceBenchmarkJob : public AbstractThreadedJob, public Module {
+    public:
+
+        /**
+         * Answer the name of this module.
+         *
+         * @return The name of this module.
+         */
+        static const char *ClassName(void) {
+            return "DataSourceBenchmarkJob";
+        }
+
+        /**
+         * Answer a human readable description of this module.
+         *
+         * @return A human readable description of this module.
+         */
+        static const char *Description(void) {
+            return "Threaded job measuring open latency and frame throughput of a data source";
+        }
+
+        /**
+         * Answers whether this module is available on the current system.
+         *
+         * @return 'true' if the module is available, 'false' otherwise.
+         */
+        static bool IsAvailable(void) {
+            return true;
+        }
+
+        /**
+         * Disallow usage in quickstarts
+         *
+         * @return false
+         */
+        static bool SupportQuickstart(void) {
+            return false;
+        }
+
+        /**
+         * Ctor
+         */
+        DataSourceBenchmarkJob();
+
+        /**
+         * Dtor
+         */
+        virtual ~DataSourceBenchmarkJob();
+
+    protected:
+
+        /**
+         * Implementation of 'Create'.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        virtual bool create(void);
+
+        /**
+         * Implementation of 'Release'.
+         */
+        virtual void release(void);
+
+    private:
+
+        /** Measurement of one access pattern */
+        struct Result {
+            std::string file;
+            double fileMB;
+            unsigned int frameCount;
+            std::string measurement;
+            bool cold;
+            unsigned int count;
+            double seconds;
+            double megabytes;
+        };
+
+        /**
+         * Perform the work of a thread.
+         *
+         * @param userData A pointer to user data that are passed to the thread,
+         *                 if it started.
+         *
+         * @return The application dependent return code of the thread. This
+         *         must not be STILL_ACTIVE (259).
+         */
+        virtual DWORD Run(void *userData);
+
+        /**
+         * (Re-)open the file in the data source, optionally evicting it from the cache first.
+         *
+         * @param fileSlot The file name parameter of the data source
+         * @param file     The file to open
+         * @param cold     Evict the file from the file system cache
+         * @param call     The call to the data source
+         * @param outFrameCount Receives the number of frames
+         *
+         * @return The time in seconds until the first frame was available, or a negative value on failure
+         */
+        double open(param::ParamSlot& fileSlot, const std::string& file, bool cold, Call& call,
+            unsigned int& outFrameCount);
+
+        /**
+         * Read one frame from the data source.
+         *
+         * @param call  The call to the data source
+         * @param frame The frame to read
+         * @param outBytes Receives the bytes of the frame, or 0 if not known for the type of call
+         *
+         * @return 'true' on success, 'false' otherwise
+         */
+        bool readFrame(Call& call, unsigned int frame, UINT64& outBytes);
+
+        /**
+         * Write a synthetic MMPLD file with random particles.
+         *
+         * @param file      The file to write
+         * @param particles The number of particles per frame
+         * @param frames    The number of frames
+         *
+         * @return 'true' on success, 'false' otherwise
+         */
+        static bool writeSyntheticMMPLD(const std::string& file, unsigned int particles, unsigned int frames);
+
+        /**
+         * Evict a file from the file system cache. Only supported on Linux.
+         *
+         * @param file The file to evict
+         *
+         * @return 'true' on success, 'false' otherwise
+         */
+        static bool dropFileCache(const std::string& file);
+
+        /**
+         * Write the results to the output file.
+         *
+         * @param results The measurements
+         *
+         * @return 'true' on success, 'false' otherwise
+         */
+        bool writeResults(const std::vector<Result>& results) const;
+
+        /** Slot connecting to the benchmarked data source */
+        CallerSlot dataSlot;
+
+        /** Full name of the file name parameter of the data source */
+        param::ParamSlot fileParamNameSlot;
+
+        /** Files to benchmark */
+        param::ParamSlot filesSlot;
+
+        /** Synthetic MMPLD file */
+        param::ParamSlot syntheticParticlesSlot;
+        param::ParamSlot syntheticFramesSlot;
+        param::ParamSlot syntheticFileSlot;
+
+        /** Access patterns */
+        param::ParamSlot warmRunsSlot;
+        param::ParamSlot maxFramesSlot;
+
+        /** Call functions for the extent and the data */
+        param::ParamSlot getExtentFunctionSlot;
+        param::ParamSlot getDataFunctionSlot;
+
+        /** Output of the results */
+        param::ParamSlot outputFileSlot;
+
+    };
+
+
+} /* end namespace job */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_DATASOURCEBENCHMARKJOB_H_INCLUDED */
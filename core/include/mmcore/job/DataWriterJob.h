@@ -81,6 +81,16 @@ namespace job {
          */
         virtual bool Terminate(void);
 
+        /**
+         * Answers the progress reported by the controlled writer.
+         *
+         * @param outProgress Receives the fraction of the data written
+         * @param outBytes Receives the number of bytes written so far
+         *
+         * @return 'true' if the writer reports its progress, 'false' if not.
+         */
+        virtual bool GetProgress(float& outProgress, UINT64& outBytes);
+
     protected:
 
         /**
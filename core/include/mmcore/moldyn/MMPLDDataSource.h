@@ -18,7 +18,9 @@
 #include "vislib/math/Cuboid.h"
 #include "vislib/sys/File.h"
 #include "vislib/RawStorage.h"
+#include "vislib/String.h"
 #include "vislib/types.h"
+#include <vector>
 
 
 namespace megamol {
@@ -118,6 +120,8 @@ namespace moldyn {
              */
             inline void Clear(void) {
                 this->dat.EnforceSize(0);
+                this->mapped = NULL;
+                this->mappedSize = 0;
             }
 
             /**
@@ -133,6 +137,18 @@ namespace moldyn {
              */
             bool LoadFrame(vislib::sys::File *file, unsigned int idx, UINT64 size, unsigned int version);
 
+            /**
+             * Exposes a frame from a memory mapping of the file without
+             * copying it. The memory must stay mapped as long as this frame
+             * references it.
+             *
+             * @param data Pointer to the first byte of the frame data
+             * @param idx The zero-based index of the frame
+             * @param size The size of the frame data in bytes
+             * @param version File version (100 = standard, 101 with clusterInfos)
+             */
+            void MapFrame(const unsigned char *data, unsigned int idx, UINT64 size, unsigned int version);
+
             /**
              * Sets the data into the call
              *
@@ -142,12 +158,55 @@ namespace moldyn {
 
         private:
 
+            /**
+             * Answer a pointer to the frame data at the given offset, either
+             * in the mapped memory or in the loaded copy.
+             *
+             * @param offset The offset in bytes
+             *
+             * @return Pointer to the frame data
+             */
+            inline const void *At(SIZE_T offset) const {
+                return (this->mapped != NULL)
+                    ? static_cast<const void*>(this->mapped + offset)
+                    : this->dat.At(offset);
+            }
+
+            /**
+             * Answer a typed pointer to the frame data at the given offset.
+             *
+             * @param offset The offset in bytes
+             *
+             * @return Pointer to the frame data
+             */
+            template<class T> inline const T *AsAt(SIZE_T offset) const {
+                return static_cast<const T*>(this->At(offset));
+            }
+
+            /**
+             * Answer the size of the frame data in bytes.
+             *
+             * @return The size of the frame data
+             */
+            inline UINT64 Size(void) const {
+                return (this->mapped != NULL) ? this->mappedSize : this->dat.GetSize();
+            }
+
             /** position data per type */
             vislib::RawStorage dat;
 
+            /** the frame data in the memory mapped file, or NULL if loaded into 'dat' */
+            const unsigned char *mapped;
+
+            /** the size of the mapped frame data in bytes */
+            UINT64 mappedSize;
+
             /** file version */
             unsigned int fileVersion;
 
+            /** the cell indices of the sorted lists, referencing the frame data */
+            std::vector<SimpleSphericalParticles::CellIndex> cellIndices;
+
         };
 
         /**
@@ -215,6 +274,21 @@ namespace moldyn {
          */
         bool getExtentCallback(Call& caller);
 
+        /**
+         * Maps the whole data file into memory.
+         *
+         * @param path The path to the data file
+         *
+         * @return 'true' on success, 'false' if the file cannot be mapped.
+         */
+        bool mapFile(const vislib::TString& path);
+
+        /**
+         * Unmaps the data file, if mapped. Must not be called while frames
+         * still reference the mapped memory.
+         */
+        void unmapFile(void);
+
         /** The file name */
         param::ParamSlot filename;
 
@@ -227,6 +301,9 @@ namespace moldyn {
         /** Override local bbox */
         param::ParamSlot overrideBBoxSlot;
 
+        /** Exposes the frames directly from a memory mapping of the file */
+        param::ParamSlot memoryMappedSlot;
+
         /** The slot for requesting data */
         CalleeSlot getData;
 
@@ -236,6 +313,21 @@ namespace moldyn {
         /** The frame index table */
         UINT64 *frameIdx;
 
+        /** The memory mapping of the data file, or NULL if not mapped */
+        const unsigned char *mapping;
+
+        /** The size of the memory mapping in bytes */
+        UINT64 mappingSize;
+
+#ifdef _WIN32
+        /** The native handles of the mapped file and its mapping */
+        void *mappingFile;
+        void *mappingHandle;
+#else
+        /** The native handle of the mapped file */
+        int mappingFile;
+#endif /* _WIN32 */
+
         /** The data set bounding box */
         vislib::math::Cuboid<float> bbox;
 
@@ -15,7 +15,9 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/param/ParamSlot.h"
+#include "vislib/RawStorage.h"
 #include "vislib/sys/File.h"
+#include <vector>
 
 
 namespace megamol {
@@ -103,6 +105,49 @@ namespace moldyn {
 
     private:
 
+        /** The number of frames buffered in memory for writing */
+        static const unsigned int bufferCount = 3;
+
+        /** A serialised frame waiting to be written */
+        struct PendingFrame {
+            /** The index of the frame */
+            UINT32 index;
+
+            /** The serialised frame */
+            vislib::RawStorage* data;
+
+            /** The length of the serialised frame in bytes */
+            UINT64 size;
+        };
+
+        /** The cell index of a sorted list, as written to the file */
+        struct ListCellIndex {
+            /** The number of cells per axis is 2^level, 0 for unsorted lists */
+            UINT8 level;
+
+            /** The bounds divided into cells */
+            vislib::math::Cuboid<float> bounds;
+
+            /** The Morton codes of the non-empty cells */
+            std::vector<UINT32> cells;
+
+            /** The index of the first particle of each non-empty cell */
+            std::vector<UINT64> begins;
+        };
+
+        /**
+         * Sorts the particles of a list along the Morton curve through the
+         * bounds of the list into an interleaved copy.
+         *
+         * @param src The list to be sorted
+         * @param level The level of the cell index, i.e. 2^level cells per axis
+         * @param outSorted Receives the sorted list referencing outData
+         * @param outData Receives the sorted particles
+         * @param outIndex Receives the cell index
+         */
+        static void sortParticles(const MultiParticleDataCall::Particles& src, unsigned int level,
+            MultiParticleDataCall::Particles& outSorted, vislib::RawStorage& outData, ListCellIndex& outIndex);
+
         /**
          * Writes the data of one frame to the file
          *
@@ -119,6 +164,12 @@ namespace moldyn {
         /** The file format version to be written */
         param::ParamSlot versionSlot;
 
+        /** The space-filling curve the particles of each list are sorted along */
+        param::ParamSlot localitySortSlot;
+
+        /** The level of the cell index stored with sorted lists */
+        param::ParamSlot cellIndexLevelSlot;
+
         /** The slot asking for data */
         CallerSlot dataSlot;
 
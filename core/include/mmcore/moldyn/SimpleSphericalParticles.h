@@ -53,6 +53,13 @@ public:
     /** possible values for the id data */
     enum IDDataType { IDDATA_NONE = 0, IDDATA_UINT32 = 1, IDDATA_UINT64 = 2 };
 
+    /**
+     * Shared ownership of a data stream. Its pointer is the start of the
+     * data, so the aliasing constructor of std::shared_ptr can be used to
+     * point into a larger buffer.
+     */
+    typedef std::shared_ptr<const void> SharedBuffer;
+
     /**
      * This class holds the accessors to the current data.
      */
@@ -273,6 +280,15 @@ public:
      */
     inline const void* GetColourData(void) const { return this->colPtr; }
 
+    /**
+     * Answer the owner of the colour data. Holding it keeps the data alive
+     * beyond the call, so filters may pass the data on instead of copying it.
+     *
+     * @return The owner of the colour data, or an empty pointer if the data is
+     *         only valid as long as the call is not unlocked
+     */
+    inline const SharedBuffer& GetColourDataOwner(void) const { return this->colOwner; }
+
     /**
      * Answer the colour data stride.
      * It represents the distance to the succeeding colour.
@@ -297,6 +313,15 @@ public:
      */
     inline const void* GetDirData(void) const { return this->dirPtr; }
 
+    /**
+     * Answer the owner of the direction data. Holding it keeps the data alive
+     * beyond the call, so filters may pass the data on instead of copying it.
+     *
+     * @return The owner of the direction data, or an empty pointer if the data is
+     *         only valid as long as the call is not unlocked
+     */
+    inline const SharedBuffer& GetDirDataOwner(void) const { return this->dirOwner; }
+
     /**
      * Answer the direction data stride
      *
@@ -363,6 +388,15 @@ public:
      */
     inline const void* GetVertexData(void) const { return this->vertPtr; }
 
+    /**
+     * Answer the owner of the vertex data. Holding it keeps the data alive
+     * beyond the call, so filters may pass the data on instead of copying it.
+     *
+     * @return The owner of the vertex data, or an empty pointer if the data is
+     *         only valid as long as the call is not unlocked
+     */
+    inline const SharedBuffer& GetVertexDataOwner(void) const { return this->vertOwner; }
+
     /**
      * Answer the vertex data stride.
      * It represents the distance to the succeeding vertex.
@@ -387,6 +421,15 @@ public:
      */
     inline const void* GetIDData(void) const { return this->idPtr; }
 
+    /**
+     * Answer the owner of the id data. Holding it keeps the data alive
+     * beyond the call, so filters may pass the data on instead of copying it.
+     *
+     * @return The owner of the id data, or an empty pointer if the data is
+     *         only valid as long as the call is not unlocked
+     */
+    inline const SharedBuffer& GetIDDataOwner(void) const { return this->idOwner; }
+
     /**
      * Answer the id data stride.
      * It represents the distance to the succeeding id.
@@ -407,6 +450,7 @@ public:
      */
     void SetColourData(ColourDataType t, const void* p, unsigned int s = 0) {
         //    ASSERT((p != NULL) || (t == COLDATA_NONE));
+        this->colOwner.reset();
         this->colDataType = t;
         this->colPtr = p;
         this->colStride = s == 0 ? ColorDataSize[t] : s;
@@ -415,6 +459,19 @@ public:
             this->col[2], this->col[3]);
     }
 
+    /**
+     * Sets the colour data and shares its ownership
+     *
+     * @param t The type of the colour data
+     * @param data The colour data, which is kept alive by this object and by
+     *             all of its copies
+     * @param s The stride of the colour data
+     */
+    void SetColourData(ColourDataType t, SharedBuffer data, unsigned int s = 0) {
+        this->SetColourData(t, data.get(), s);
+        this->colOwner = std::move(data);
+    }
+
     /**
      * Sets the colour map index values
      *
@@ -436,6 +493,7 @@ public:
      */
     void SetDirData(DirDataType t, const void* p, unsigned int s = 0) {
         ASSERT((p != NULL) || (t == DIRDATA_NONE));
+        this->dirOwner.reset();
         this->dirDataType = t;
         this->dirPtr = p;
         this->dirStride = s == 0 ? DirDataSize[t] : s;
@@ -443,6 +501,19 @@ public:
         this->par_store_->SetDirData(t, reinterpret_cast<char const*>(p), this->dirStride);
     }
 
+    /**
+     * Sets the direction data and shares its ownership
+     *
+     * @param t The type of the direction data
+     * @param data The direction data, which is kept alive by this object and by
+     *             all of its copies
+     * @param s The stride of the direction data
+     */
+    void SetDirData(DirDataType t, SharedBuffer data, unsigned int s = 0) {
+        this->SetDirData(t, data.get(), s);
+        this->dirOwner = std::move(data);
+    }
+
     /**
      * Sets the number of objects stored and resets all data pointers!
      *
@@ -457,6 +528,10 @@ public:
         this->dirPtr = nullptr; // DO NOT DELETE
         this->idDataType = IDDATA_NONE;
         this->idPtr = nullptr; // DO NOT DELETE
+        this->colOwner.reset();
+        this->vertOwner.reset();
+        this->dirOwner.reset();
+        this->idOwner.reset();
 
         this->par_store_->SetVertexData(VERTDATA_NONE, nullptr);
         this->par_store_->SetColorData(COLDATA_NONE, nullptr);
@@ -512,6 +587,7 @@ public:
      */
     void SetVertexData(VertexDataType t, const void* p, unsigned int s = 0) {
         ASSERT(this->disabledNullChecks || (p != NULL) || (t == VERTDATA_NONE));
+        this->vertOwner.reset();
         this->vertDataType = t;
         this->vertPtr = p;
         this->vertStride = s == 0 ? VertexDataSize[t] : s;
@@ -519,6 +595,19 @@ public:
         this->par_store_->SetVertexData(t, reinterpret_cast<char const*>(p), this->vertStride, this->radius);
     }
 
+    /**
+     * Sets the vertex data and shares its ownership
+     *
+     * @param t The type of the vertex data
+     * @param data The vertex data, which is kept alive by this object and by
+     *             all of its copies
+     * @param s The stride of the vertex data
+     */
+    void SetVertexData(VertexDataType t, SharedBuffer data, unsigned int s = 0) {
+        this->SetVertexData(t, data.get(), s);
+        this->vertOwner = std::move(data);
+    }
+
     /**
      * Sets the ID data
      *
@@ -529,6 +618,7 @@ public:
      */
     void SetIDData(IDDataType t, const void* p, unsigned int s = 0) {
         ASSERT(this->disabledNullChecks || (p != NULL) || (t == IDDATA_NONE));
+        this->idOwner.reset();
         this->idDataType = t;
         this->idPtr = p;
         this->idStride = s == 0 ? IDDataSize[t] : s;
@@ -536,6 +626,19 @@ public:
         this->par_store_->SetIDData(t, reinterpret_cast<char const*>(p), this->idStride);
     }
 
+    /**
+     * Sets the ID data and shares its ownership
+     *
+     * @param t The type of the ID data
+     * @param data The ID data, which is kept alive by this object and by
+     *             all of its copies
+     * @param s The stride of the ID data
+     */
+    void SetIDData(IDDataType t, SharedBuffer data, unsigned int s = 0) {
+        this->SetIDData(t, data.get(), s);
+        this->idOwner = std::move(data);
+    }
+
     /**
      * Reports existence of IDs.
      *
@@ -611,6 +714,41 @@ public:
      */
     ClusterInfos* GetClusterInfos() { return this->clusterInfos; }
 
+    /**
+     * Index of a list sorted along the Morton curve through its bounds. The
+     * bounds are divided into 2^level cells per axis, and the particles of
+     * each non-empty cell form a contiguous range of the list. The arrays
+     * are owned by the data source.
+     */
+    struct CellIndex {
+        /** the number of cells per axis is 2^level */
+        unsigned int level;
+        /** the bounds divided into cells */
+        vislib::math::Cuboid<float> bounds;
+        /** number of non-empty cells */
+        UINT32 cellCount;
+        /** the Morton codes of the non-empty cells in ascending order */
+        const UINT32* cells;
+        /** the index of the first particle of each non-empty cell */
+        const UINT64* begins;
+        CellIndex() : level(0), bounds(), cellCount(0), cells(nullptr), begins(nullptr){};
+
+        /** Answer the end of the particle range of the i-th non-empty cell of a list of count particles */
+        inline UINT64 End(UINT32 i, UINT64 count) const {
+            return (i + 1 < this->cellCount) ? this->begins[i + 1] : count;
+        }
+    };
+
+    /**
+     * Sets the cell index of the list, or nullptr if the list is unsorted
+     */
+    void SetCellIndex(const CellIndex* index) { this->cellIndex = index; }
+
+    /**
+     * Gets the cell index of the list, or nullptr if the list is unsorted
+     */
+    const CellIndex* GetCellIndex() const { return this->cellIndex; }
+
     /**
      * Sets the VertexArrayObject, VertexBuffer and ColorBuffer used
      */
@@ -699,6 +837,9 @@ private:
     /** local Cluster Infos*/
     ClusterInfos* clusterInfos;
 
+    /** The cell index of a sorted list */
+    const CellIndex* cellIndex;
+
     /** The particle ID type */
     IDDataType idDataType;
 
@@ -708,6 +849,18 @@ private:
     /** The particle ID stride */
     unsigned int idStride;
 
+#ifdef _WIN32
+#pragma warning(disable : 4251)
+#endif /* _WIN32 */
+    /** The owners of the data streams, empty if the data is not shared */
+    SharedBuffer colOwner;
+    SharedBuffer dirOwner;
+    SharedBuffer vertOwner;
+    SharedBuffer idOwner;
+#ifdef _WIN32
+#pragma warning(default : 4251)
+#endif /* _WIN32 */
+
 protected:
     /** Instance of the particle store */
     std::shared_ptr<ParticleStore> par_store_ = std::make_shared<ParticleStore>();
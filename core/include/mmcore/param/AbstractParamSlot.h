@@ -43,6 +43,17 @@ namespace param {
             return this->dirty;
         }
 
+        /**
+         * Answers the generation of the parameter, which is incremented
+         * whenever the parameter is set. Unlike the dirty flag, the generation
+         * can be compared by any number of observers.
+         *
+         * @return The generation of the parameter.
+         */
+        inline size_t Generation(void) const {
+            return this->generation;
+        }
+
         /**
          * Gets a pointer to the parameter of the slot casted to the specified
          * class 'C'. Do not free the returned pointer!
@@ -158,6 +169,9 @@ namespace param {
         /** The slots dirty flag */
         bool dirty;
 
+        /** The number of updates of the parameter */
+        size_t generation;
+
 #ifdef _WIN32
 #pragma warning (disable: 4251)
 #endif /* _WIN32 */
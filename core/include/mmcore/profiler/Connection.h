@@ -83,6 +83,26 @@ namespace profiler {
          */
         double get_mean(void) const;
 
+        /**
+         * Answer the number of valid samples in the log
+         *
+         * @return The number of valid samples
+         */
+        inline SIZE_T get_sample_count(void) const {
+            return this->values_cnt;
+        }
+
+        /**
+         * Answers a sample of the log
+         *
+         * @param idx      The index of the sample, smaller than 'get_sample_count'
+         * @param start    Receives the start time of the call (in seconds)
+         * @param duration Receives the duration of the call (in seconds),
+         *                 or a negative value if the call is still running
+         * @param thread   Receives the id of the thread which invoked the call
+         */
+        void get_sample(SIZE_T idx, double& start, double& duration, unsigned int& thread) const;
+
     private:
 
         /** The log size */
@@ -97,6 +117,9 @@ namespace profiler {
         /** The measured performance values */
         vislib::Pair<double, double> *values;
 
+        /** The invoking threads of the measured values */
+        unsigned int *threads;
+
         /** The count of valid values */
         SIZE_T values_cnt;
 
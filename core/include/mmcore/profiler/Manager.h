@@ -36,6 +36,10 @@ namespace profiler {
      * Add to megamol.mmprj:
      *    <call ... profile="true" />
      * The value of 'profile' must be interpretable as boolean 'true' to select this call for profiling.
+     *
+     * The recorded samples can be queried at runtime from Lua:
+     *    mmProfilerReport()                 returns the aggregated timings per module
+     *    mmProfilerWriteTrace("trace.json") writes a Chrome trace (chrome://tracing)
      */
     class Manager {
     public:
@@ -122,6 +126,26 @@ namespace profiler {
          */
         void Report(void);
 
+        /**
+         * Builds a textual report of the recorded samples. The timings of
+         * all profiled calls are aggregated per called module, followed by
+         * the individual calls. Durations are inclusive, i.e. a module's time
+         * contains the time spent in the calls it issues itself.
+         *
+         * @return The report
+         */
+        vislib::StringA MakeReport(void);
+
+        /**
+         * Writes all recorded samples as Chrome trace event file, which can
+         * be loaded in chrome://tracing or compatible viewers.
+         *
+         * @param filename The path of the file to be written
+         *
+         * @return 'true' on success, 'false' if the file could not be written
+         */
+        bool WriteChromeTrace(const vislib::StringA& filename);
+
     private:
 
         /** Hidden ctor */
@@ -0,0 +1,108 @@
+/*
+ * CallGraphExecutor.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_CALLGRAPHEXECUTOR_H_INCLUDED
+#define MEGAMOLCORE_CALLGRAPHEXECUTOR_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include "mmcore/Call.h"
+#include "mmcore/utility/TaskScheduler.h"
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+namespace megamol {
+namespace core {
+
+    class Module;
+
+namespace utility {
+
+    /// Issues a set of calls, e.g. the get-extent or get-data calls of the
+    /// inputs of a module, and runs the independent ones concurrently on the
+    /// TaskScheduler.
+    ///
+    /// The modules reachable from the callee of a call through connected
+    /// caller slots form the subtree of the call. A call runs on a worker if
+    /// every module of its subtree opted in with
+    /// Module::IsCallableFromWorkerThreads and the subtree shares no module
+    /// with the subtree of any other call. All other calls, e.g. those
+    /// reaching a module using OpenGL, run on the calling thread in the order
+    /// they were added. The calling thread holds the module graph lock until
+    /// all calls are done, so the graph does not change while the workers
+    /// run on its behalf.
+    class MEGAMOLCORE_API CallGraphExecutor {
+    public:
+
+        /// Ctor.
+        CallGraphExecutor(void);
+
+        /// Dtor.
+        ~CallGraphExecutor(void);
+
+        /// Adds a call. A call must not be added twice.
+        /// @param call the call to issue
+        /// @param func the function to call
+        void Add(Call& call, unsigned int func);
+
+        /// Removes all calls
+        void Clear(void);
+
+        /// Issues all calls and waits for them. As with CallerSlot::Call, a
+        /// call throwing an exception fails.
+        /// @returns whether all calls succeeded
+        bool Run(void);
+
+        /// @param idx the index of the call, in the order of adding
+        /// @returns whether the call succeeded in the last run
+        inline bool Succeeded(size_t idx) const {
+            return (idx < this->entries.size()) && this->entries[idx].succeeded;
+        }
+
+        /// @returns the number of calls that ran on workers in the last run
+        inline size_t GetConcurrentCount(void) const {
+            return this->concurrent;
+        }
+
+    private:
+
+        /// a call to issue
+        struct Entry {
+            Call* call;
+            unsigned int func;
+            bool succeeded;
+        };
+
+        /// collects the modules of the subtree of a call
+        /// @param call the call
+        /// @param modules the modules found so far, extended by the subtree
+        /// @returns whether all modules of the subtree may be called from workers
+        static bool collectSubtree(const Call& call, std::set<const Module*>& modules);
+
+        /// issues a call on the current thread
+        static bool issue(Entry& entry);
+
+#ifdef _WIN32
+#pragma warning(disable : 4251)
+#endif /* _WIN32 */
+        std::vector<Entry> entries;
+#ifdef _WIN32
+#pragma warning(default : 4251)
+#endif /* _WIN32 */
+
+        size_t concurrent;
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_CALLGRAPHEXECUTOR_H_INCLUDED */
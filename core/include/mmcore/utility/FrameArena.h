@@ -0,0 +1,185 @@
+/*
+ * FrameArena.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_FRAMEARENA_H_INCLUDED
+#define MEGAMOLCORE_FRAMEARENA_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /// Bump allocator for the temporary buffers a module computes per frame.
+    ///
+    /// Allocations are carved out of large blocks and are never freed one by
+    /// one. Instead, all of them are released when the arena enters a new
+    /// generation, e.g. when the module computes the data of another frame or
+    /// data hash. The memory of the blocks is kept, and after a generation that
+    /// needed more than one block the blocks are merged, so the arena settles
+    /// on a single block large enough for a frame and stops allocating.
+    ///
+    /// The arena is not thread-safe; it is meant to be owned by one module.
+    class MEGAMOLCORE_API FrameArena {
+    public:
+
+        /// Ctor.
+        /// @param blockSize the minimum size of a block in bytes
+        FrameArena(size_t blockSize = 1 << 20);
+
+        /// Dtor. Invalidates all allocations.
+        ~FrameArena(void);
+
+        /// Enters a generation. If it differs from the current one, all
+        /// allocations of the current generation are released.
+        /// @param generation the generation, e.g. a frame id or data hash
+        /// @returns true if the allocations have been released
+        bool Reset(uint64_t generation);
+
+        /// Releases all allocations and enters the next generation
+        void Reset(void);
+
+        /// Allocates memory valid until the next reset
+        /// @param size the number of bytes
+        /// @param alignment the alignment, a power of two
+        /// @returns the memory
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /// Allocates an array valid until the next reset. The elements are
+        /// not initialised and never destroyed.
+        /// @param count the number of elements
+        /// @returns the array
+        template<class T> inline T* Allocate(size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value, "arena allocations are never destroyed");
+            return static_cast<T*>(this->Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        /// @returns the current generation
+        inline uint64_t Generation(void) const {
+            return this->generation;
+        }
+
+        /// @returns the number of bytes allocated in the current generation
+        inline size_t Used(void) const {
+            return this->used;
+        }
+
+        /// @returns the number of bytes held by the arena
+        size_t Capacity(void) const;
+
+    private:
+
+        /// a block of memory
+        struct Block {
+            std::unique_ptr<uint8_t[]> memory;
+            size_t size;
+        };
+
+        /// deleted copy ctor
+        FrameArena(const FrameArena& src) = delete;
+
+        /// deleted assignment operator
+        FrameArena& operator=(const FrameArena& rhs) = delete;
+
+        const size_t blockSize;
+
+#ifdef _WIN32
+#pragma warning(disable : 4251)
+#endif /* _WIN32 */
+        std::vector<Block> blocks;
+#ifdef _WIN32
+#pragma warning(default : 4251)
+#endif /* _WIN32 */
+
+        /// the block allocations are taken from and the offset into it
+        size_t current;
+        size_t offset;
+
+        /// the bytes allocated in the current generation
+        size_t used;
+
+        uint64_t generation;
+    };
+
+
+    /// Pool of vectors to be handed out as shared data of calls.
+    ///
+    /// An acquired buffer is an empty vector which, unlike a new one, may
+    /// already have the capacity of a previous frame. When the last reference
+    /// to it is dropped, by the module or by the receivers of the call, it
+    /// returns to the pool instead of being freed. Buffers may be dropped on
+    /// any thread and may outlive the pool.
+    template<class T> class BufferPool {
+    public:
+
+        /// the type of the buffers
+        typedef std::shared_ptr<std::vector<T>> buffer_type;
+
+        /// Ctor.
+        /// @param maxFree the maximum number of buffers kept for reuse
+        BufferPool(size_t maxFree = 8) : state(std::make_shared<State>()) {
+            this->state->maxFree = maxFree;
+        }
+
+        /// @returns an empty buffer
+        buffer_type Acquire(void) {
+            std::unique_ptr<std::vector<T>> buffer;
+            {
+                std::lock_guard<std::mutex> guard(this->state->lock);
+                if (!this->state->free.empty()) {
+                    buffer = std::move(this->state->free.back());
+                    this->state->free.pop_back();
+                }
+            }
+            if (!buffer) buffer.reset(new std::vector<T>());
+
+            std::weak_ptr<State> owner = this->state;
+            return buffer_type(buffer.release(), [owner](std::vector<T>* b) {
+                std::unique_ptr<std::vector<T>> buffer(b);
+                auto state = owner.lock();
+                if (!state) return;
+                buffer->clear();
+                std::lock_guard<std::mutex> guard(state->lock);
+                if (state->free.size() < state->maxFree) {
+                    state->free.push_back(std::move(buffer));
+                }
+            });
+        }
+
+        /// @returns the number of buffers waiting for reuse
+        size_t Available(void) const {
+            std::lock_guard<std::mutex> guard(this->state->lock);
+            return this->state->free.size();
+        }
+
+    private:
+
+        /// the buffers shared with the deleters of the handed out buffers
+        struct State {
+            std::mutex lock;
+            std::vector<std::unique_ptr<std::vector<T>>> free;
+            size_t maxFree;
+        };
+
+        std::shared_ptr<State> state;
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_FRAMEARENA_H_INCLUDED */
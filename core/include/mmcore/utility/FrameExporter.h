@@ -0,0 +1,121 @@
+/*
+ * FrameExporter.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_FRAMEEXPORTER_H_INCLUDED
+#define MEGAMOLCORE_FRAMEEXPORTER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "vislib/graphics/gl/FramebufferObject.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /// Writes rendered frames to png files without stalling the rendering.
+    ///
+    /// The colour attachment of a frame buffer object is read back into a ring
+    /// of pixel pack buffers, so the read of a frame runs on the GPU while the
+    /// next frame is rendered. A frame whose read has finished is encoded by a
+    /// background task of the TaskScheduler, several frames being encoded in
+    /// parallel. The number of frames in flight is limited: if too many frames
+    /// wait for their encoding, Export blocks until the oldest one is written,
+    /// which keeps the memory bounded.
+    ///
+    /// All methods must be called from the thread owning the OpenGL context.
+    class MEGAMOLCORE_API FrameExporter {
+    public:
+
+        /// Ctor.
+        /// @param ringSize the number of pixel pack buffers, i.e. the number of
+        ///                 frames whose read-back may be in flight
+        /// @param maxEncoding the number of frames which may wait for or be in
+        ///                    their encoding
+        FrameExporter(unsigned int ringSize = 3, unsigned int maxEncoding = 8);
+
+        /// Dtor. Waits for all frames to be written.
+        ~FrameExporter(void);
+
+        /// Starts the export of the colour attachment of a frame buffer object.
+        /// The frame buffer object may be rendered to right after this returns.
+        /// @param fbo the frame buffer object; it must not be enabled
+        /// @param filename the png file to write
+        /// @param alpha whether the alpha channel is written
+        /// @returns false if the frame could not be read or if writing one of
+        ///          the previous frames failed
+        bool Export(vislib::graphics::gl::FramebufferObject& fbo, const std::string& filename, bool alpha = false);
+
+        /// Hands the frames whose read-back has finished over to the encoders.
+        /// Call this once per frame if no further frames are exported, so the
+        /// last frames do not wait for the next call of Export or Finish.
+        void Poll(void);
+
+        /// Waits for all frames to be written and releases the buffers.
+        /// @returns true if all frames since the last call have been written
+        bool Finish(void);
+
+        /// @returns the number of frames which are being read or encoded
+        size_t Pending(void) const;
+
+    private:
+
+        /// a frame being read back
+        struct Readback {
+            GLuint buffer;
+            GLsync fence;
+            std::string filename;
+            unsigned int width;
+            unsigned int height;
+            bool alpha;
+        };
+
+        /// deleted copy ctor
+        FrameExporter(const FrameExporter& src) = delete;
+
+        /// deleted assignment operator
+        FrameExporter& operator=(const FrameExporter& rhs) = delete;
+
+        /// maps a finished read-back and schedules the encoding of its frame
+        void encode(Readback& rb);
+
+        /// waits for the oldest encodings until at most 'count' are left
+        void limitEncodings(size_t count);
+
+        const unsigned int ringSize;
+        const unsigned int maxEncoding;
+
+        /// the read-backs in order of submission
+        std::deque<Readback> reading;
+
+        /// the pixel pack buffers which are not in use
+        std::vector<GLuint> freeBuffers;
+
+        /// the size of the pixel pack buffers in bytes
+        size_t bufferSize;
+
+        /// the encodings in order of submission
+        std::deque<TaskScheduler::TaskHandle> encoding;
+
+        /// set by the encoders if writing a frame failed
+        std::shared_ptr<std::atomic<bool>> failed;
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_FRAMEEXPORTER_H_INCLUDED */
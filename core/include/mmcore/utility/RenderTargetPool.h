@@ -0,0 +1,147 @@
+/*
+ * RenderTargetPool.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_RENDERTARGETPOOL_H_INCLUDED
+#define MEGAMOLCORE_RENDERTARGETPOOL_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
+
+#include "glowl/FramebufferObject.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /// Pool of framebuffer objects shared by all modules rendering to textures.
+    ///
+    /// A framebuffer object is leased for a size and a set of attachments.
+    /// When the last reference to the lease is dropped, by the module or by
+    /// the receivers of a call, the framebuffer object returns to the pool
+    /// instead of being deleted, and the next lease with the same size and
+    /// attachments reuses it. A module that needs a render target only for an
+    /// intermediate pass drops its lease at the end of the pass, so the passes
+    /// of a frame share their render targets. A module handing out its render
+    /// target keeps the lease until the size changes.
+    ///
+    /// Returned framebuffer objects are kept up to a maximum amount of memory,
+    /// the least recently returned ones are deleted first. The content of a
+    /// leased framebuffer object is undefined.
+    ///
+    /// The pool must only be used, and leases must only be dropped, on the
+    /// thread of the OpenGL context.
+    class MEGAMOLCORE_API RenderTargetPool {
+    public:
+
+        /// a colour attachment as passed to glowl::FramebufferObject::createColorAttachment
+        struct Attachment {
+            GLenum internalFormat;
+            GLenum format;
+            GLenum type;
+
+            inline bool operator==(const Attachment& rhs) const {
+                return (this->internalFormat == rhs.internalFormat) && (this->format == rhs.format)
+                    && (this->type == rhs.type);
+            }
+        };
+
+        /// the type of the leases
+        typedef std::shared_ptr<glowl::FramebufferObject> lease_type;
+
+        /// @returns the pool shared by all modules
+        static RenderTargetPool& Instance(void);
+
+        /// Leases a framebuffer object.
+        /// @param width the width in pixels
+        /// @param height the height in pixels
+        /// @param attachments the colour attachments
+        /// @param depth whether the framebuffer object has a depth buffer
+        /// @returns the framebuffer object
+        lease_type Acquire(int width, int height, const std::vector<Attachment>& attachments, bool depth = false);
+
+        /// Deletes all framebuffer objects waiting for reuse
+        void Trim(void);
+
+        /// Sets the maximum amount of memory kept for reuse.
+        /// @param bytes the number of bytes
+        void SetMaxFreeBytes(size_t bytes);
+
+        /// @returns the estimated memory of the leased framebuffer objects
+        size_t LeasedBytes(void) const;
+
+        /// @returns the estimated memory of the framebuffer objects waiting for reuse
+        size_t FreeBytes(void) const;
+
+    private:
+
+        /// the properties a framebuffer object is reused for
+        struct Key {
+            int width, height;
+            std::vector<Attachment> attachments;
+            bool depth;
+
+            inline bool operator==(const Key& rhs) const {
+                return (this->width == rhs.width) && (this->height == rhs.height)
+                    && (this->attachments == rhs.attachments) && (this->depth == rhs.depth);
+            }
+        };
+
+        /// a framebuffer object waiting for reuse
+        struct Entry {
+            Key key;
+            std::unique_ptr<glowl::FramebufferObject> fbo;
+            size_t bytes;
+        };
+
+        /// the state shared with the deleters of the leases
+        struct State {
+            std::mutex lock;
+            std::vector<Entry> free;
+            size_t freeBytes, leasedBytes, maxFreeBytes;
+
+            /// deletes the oldest entries until at most the given amount is kept, assumes the lock being held
+            void Shrink(size_t maxBytes);
+        };
+
+        /// @returns the estimated memory of a framebuffer object
+        static size_t estimateBytes(const Key& key);
+
+        /// Ctor.
+        RenderTargetPool(void);
+
+        /// Dtor. The OpenGL context may already be gone, so the framebuffer
+        /// objects waiting for reuse are left to the driver.
+        ~RenderTargetPool(void);
+
+        /// deleted copy ctor
+        RenderTargetPool(const RenderTargetPool& src) = delete;
+
+        /// deleted assignment operator
+        RenderTargetPool& operator=(const RenderTargetPool& rhs) = delete;
+
+#ifdef _WIN32
+#pragma warning(disable : 4251)
+#endif /* _WIN32 */
+        std::shared_ptr<State> state;
+#ifdef _WIN32
+#pragma warning(default : 4251)
+#endif /* _WIN32 */
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_RENDERTARGETPOOL_H_INCLUDED */
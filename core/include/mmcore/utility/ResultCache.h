@@ -0,0 +1,127 @@
+/*
+ * ResultCache.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_RESULTCACHE_H_INCLUDED
+#define MEGAMOLCORE_RESULTCACHE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /// Bounded cache for the results of expensive computations of filter modules,
+    /// shared by all modules of a core instance. Results are opaque byte blobs
+    /// addressed by a key derived from the owning module, the data hash and frame
+    /// of its input, and the values of the parameters the result depends on, so
+    /// returning to a previous time step or parameter setting becomes a lookup.
+    ///
+    /// The least recently used results are evicted once the memory budget is
+    /// exceeded. If a spill directory is set, evicted results are written there
+    /// instead and loaded again on demand, bounded by a separate disk budget.
+    ///
+    /// Configuration values (megamol.cfg / megamolconfig.lua):
+    ///    resultCacheSize       memory budget in MiB (default 256, 0 disables the cache)
+    ///    resultCacheDir        spill directory (default none)
+    ///    resultCacheDiskSize   disk budget in MiB (default 4096)
+    class MEGAMOLCORE_API ResultCache {
+    public:
+
+        /// the cache key
+        typedef uint64_t key_type;
+
+        /// a cached result, which stays valid after it has been evicted
+        typedef std::shared_ptr<const std::vector<unsigned char>> value_type;
+
+        /// @returns the only instance of this class
+        static ResultCache& Instance(void);
+
+        /// Computes the key of a result
+        /// @param owner the full name of the module computing the result
+        /// @param dataHash the data hash of the module's input
+        /// @param frameID the frame of the module's input
+        /// @param params the parameters the result depends on
+        /// @returns the key
+        static key_type MakeKey(const vislib::StringA& owner, size_t dataHash, unsigned int frameID,
+            std::initializer_list<const param::ParamSlot*> params);
+
+        /// Looks up a result, from memory or from the spill directory
+        /// @param key the key of the result
+        /// @returns the result, or nullptr if it is not cached
+        value_type Find(key_type key);
+
+        /// Stores a result, replacing any previous result with the same key
+        /// @param key the key of the result
+        /// @param data the result
+        void Store(key_type key, std::vector<unsigned char>&& data);
+
+        /// Drops all results held in memory and in the spill directory
+        void Clear(void);
+
+        /// Sets the memory budget in bytes, evicting results if necessary.
+        /// A budget of zero disables the cache.
+        void SetBudget(size_t bytes);
+
+        /// Sets the spill directory. An empty path disables spilling.
+        /// @param dir the directory, which must exist
+        /// @param bytes the disk budget in bytes
+        void SetSpillDirectory(const std::string& dir, size_t bytes);
+
+        /// @returns the number of lookups answered from memory or disk, and the number of misses
+        void GetStatistics(size_t& hits, size_t& misses) const;
+
+    private:
+
+        /// an entry of the memory or disk lru list
+        typedef std::pair<key_type, value_type> entry_type;
+
+        ResultCache(void);
+        ~ResultCache(void);
+
+        /// evicts results until the budgets are met, lock must be held
+        void enforceBudgets(void);
+
+        /// @returns the spill file of a key
+        std::string spillFile(key_type key) const;
+
+        /// memory lru list, most recently used first
+        std::list<entry_type> resident;
+        std::unordered_map<key_type, std::list<entry_type>::iterator> residentLookup;
+        size_t residentBytes;
+        size_t budget;
+
+        /// disk lru list (sizes only), most recently written first
+        std::list<std::pair<key_type, size_t>> spilled;
+        std::unordered_map<key_type, std::list<std::pair<key_type, size_t>>::iterator> spilledLookup;
+        size_t spilledBytes;
+        size_t spillBudget;
+        std::string spillDir;
+
+        size_t hits;
+        size_t misses;
+
+        mutable std::mutex lock;
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_RESULTCACHE_H_INCLUDED */
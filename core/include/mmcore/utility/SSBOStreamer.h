@@ -32,9 +32,25 @@ namespace utility {
     /// Note that the user must SignalCompletion after the rendering command if
     /// the buffer can be freed afterwards (or re-upload of data will be performed)
     /// See NG render mode of SphereRenderer for a usage example.
+    /// Optionally, the ring length and chunk size adapt to the fence stalls and
+    /// the upload bandwidth measured in the previous frames (see SetAutoSizing).
     class MEGAMOLCORE_API SSBOStreamer {
     public:
 
+        /// counters of the uploads within one frame (see NewFrame)
+        struct Statistics {
+            /// number of uploaded chunks
+            unsigned int numUploads = 0;
+            /// number of uploads that had to wait for the GPU to release their ring element
+            unsigned int numStalls = 0;
+            /// time spent waiting for fences in milliseconds
+            double stallTime = 0.0;
+            /// number of bytes copied into the mapped buffer
+            size_t numBytes = 0;
+            /// time spent copying in milliseconds
+            double copyTime = 0.0;
+        };
+
          SSBOStreamer(const std::string& debugLabel = std::string());
         ~SSBOStreamer();
 
@@ -78,6 +94,30 @@ namespace utility {
         /// @param sync the abstract sync object to signal as done
         void SignalCompletion(unsigned int sync);
 
+        /// lets the following SetData* calls adapt the ring and chunk size. The ring grows
+        /// by one buffer per frame in which uploads stalled on fences, and chunks are sized
+        /// such that copying one takes about targetChunkTime at the measured upload bandwidth,
+        /// which is bounded by the PCIe bandwidth for device memory. The sizes given to
+        /// SetData* stay the lower bound for the ring length and the upper bound for the chunk size.
+        /// @param enable whether to adapt the sizes
+        /// @param maxNumBuffers the maximum length of the ring
+        /// @param targetChunkTime the desired time for copying a chunk in milliseconds
+        void SetAutoSizing(bool enable, GLuint maxNumBuffers = 8, double targetChunkTime = 2.0);
+
+        /// closes the statistics of the current frame and updates the automatic sizes;
+        /// call once per frame before the first SetData*
+        void NewFrame();
+
+        /// @returns the counters of the frame last closed by NewFrame
+        const Statistics& GetFrameStatistics() const {
+            return lastFrame;
+        }
+
+        /// @returns the smoothed bandwidth of copying into the mapped buffer in bytes per second, 0 if not yet measured
+        double GetUploadBandwidth() const {
+            return uploadBandwidth;
+        }
+
 		/// @param numItemsPerChunk the minimum number of items per chunk
 		/// @param up rounds up if true, otherwise rounds down.
 		/// @returns the alignment-friendly (rounded) number of items per chunk
@@ -95,10 +135,17 @@ namespace utility {
             return numItemsPerChunk;
         }
 
+        GLuint GetNumBuffers(void) const {
+            return numBuffers;
+        }
+
     private:
         static void queueSignal(GLsync &syncObj);
-        static void waitSignal(GLsync &syncObj);
+        /// @returns true if the fence was not yet signaled, i.e., the caller stalled
+        static bool waitSignal(GLsync &syncObj);
         void genBufferAndMap(GLuint numBuffers, GLuint bufferSize);
+        /// copies on all threads, split into ranges aligned to cache lines of dst
+        void parallelCopy(char* dst, const char* src, size_t numBytes) const;
 
         GLuint theSSBO;
         /// in bytes!
@@ -117,6 +164,17 @@ namespace utility {
         int numThr;
         std::string debugLabel;
         int offsetAlignment = 0;
+
+        /// automatic sizing, where 0 means not yet determined
+        bool autoSizing = false;
+        GLuint maxNumBuffers = 8;
+        double targetChunkTime = 2.0;
+        GLuint autoNumBuffers = 0;
+        GLuint autoBufferSize = 0;
+        double uploadBandwidth = 0.0;
+
+        Statistics currentFrame;
+        Statistics lastFrame;
     };
 
 } /* end namespace utility */
@@ -0,0 +1,258 @@
+/*
+ * TaskScheduler.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_TASKSCHEDULER_H_INCLUDED
+#define MEGAMOLCORE_TASKSCHEDULER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /// Work-stealing scheduler for the tasks of all modules of a core instance,
+    /// so their parallel work shares the cores of the host instead of every
+    /// module starting threads of its own.
+    ///
+    /// Every worker owns one deque per priority. It runs its own tasks newest
+    /// first and steals the oldest tasks of the other workers when it runs dry.
+    /// Tasks submitted by threads outside of the scheduler go to a shared queue.
+    /// Interactive tasks are always preferred over background tasks. The workers
+    /// are started on first use and stopped when the last user, i.e. core
+    /// instance, is removed.
+    ///
+    /// Configuration value (megamol.cfg / megamolconfig.lua):
+    ///    taskSchedulerThreads   number of workers (default 0, i.e. one per hardware thread)
+    class MEGAMOLCORE_API TaskScheduler {
+    public:
+
+        /// the priority of a task
+        enum class Priority : unsigned int {
+            INTERACTIVE = 0, ///< work someone is waiting for, e.g. the next frame
+            BACKGROUND = 1   ///< long-running jobs
+        };
+
+        class Task;
+
+        /// The exception thrown by ParallelFor if several chunks failed
+        class MEGAMOLCORE_API ParallelForException : public std::runtime_error {
+        public:
+
+            /// Ctor.
+            /// @param errors the exceptions thrown by the chunks
+            explicit ParallelForException(std::vector<std::exception_ptr>&& errors);
+
+            /// @returns the exceptions thrown by the chunks
+            inline const std::vector<std::exception_ptr>& GetErrors(void) const {
+                return this->errors;
+            }
+
+        private:
+
+#ifdef _WIN32
+#pragma warning(disable : 4251)
+#endif /* _WIN32 */
+            std::vector<std::exception_ptr> errors;
+#ifdef _WIN32
+#pragma warning(default : 4251)
+#endif /* _WIN32 */
+        };
+
+        /// a scheduled task, which may be waited for or cancelled
+        typedef std::shared_ptr<Task> TaskHandle;
+
+        /// the work of a task, receiving its task to poll for cancellation
+        typedef std::function<void(const Task&)> work_type;
+
+        /// A task, its state and its continuations
+        class MEGAMOLCORE_API Task {
+        public:
+
+            /// @returns whether the task has finished running or was cancelled
+            bool IsDone(void) const;
+
+            /// @returns whether the cancellation of the task was requested
+            inline bool IsCancelled(void) const {
+                return this->cancelled.load();
+            }
+
+            /// Requests the cancellation of the task. A task that has not yet
+            /// started will not be run, a running task may poll IsCancelled.
+            /// The continuations of a cancelled task are cancelled, too.
+            void Cancel(void);
+
+            /// Waits for the task. Workers of the scheduler run other tasks in
+            /// the meantime, so tasks may wait for each other.
+            /// @param timeoutMillis the maximum time to wait, negative for no limit
+            /// @returns whether the task is done
+            bool Wait(int timeoutMillis = -1);
+
+        private:
+
+            friend class TaskScheduler;
+
+            Task(TaskScheduler& owner, work_type&& work, Priority prio);
+
+            TaskScheduler& owner;
+            work_type work;
+            const Priority prio;
+
+            /// the number of unfinished predecessors, plus one while being submitted
+            std::atomic<int> pending;
+            std::atomic<bool> cancelled;
+            bool done;
+
+            /// tasks waiting for this one, guarded by 'lock'
+            std::vector<TaskHandle> continuations;
+
+            mutable std::mutex lock;
+            std::condition_variable finished;
+        };
+
+        /// @returns the only instance of this class
+        static TaskScheduler& Instance(void);
+
+        /// Schedules a task
+        /// @param work the work to do
+        /// @param prio the priority of the task
+        /// @param after the tasks that must be done before this task may run
+        /// @returns the task
+        TaskHandle Submit(work_type work, Priority prio = Priority::BACKGROUND,
+            const std::vector<TaskHandle>& after = std::vector<TaskHandle>());
+
+        /// Schedules a continuation which runs after a task is done
+        /// @param task the task to continue
+        /// @param work the work to do
+        /// @param prio the priority of the continuation
+        /// @returns the continuation
+        inline TaskHandle Then(const TaskHandle& task, work_type work, Priority prio = Priority::BACKGROUND) {
+            return this->Submit(std::move(work), prio, std::vector<TaskHandle>(1, task));
+        }
+
+        /// Runs a function on the scheduler
+        /// @param f the function
+        /// @param prio the priority of the task
+        /// @returns the future result of the function, which reports a broken
+        ///          promise if the scheduler shuts down before running it
+        template<class F>
+        std::future<typename std::result_of<F()>::type> Async(F f, Priority prio = Priority::INTERACTIVE) {
+            typedef typename std::result_of<F()>::type result_type;
+            auto pt = std::make_shared<std::packaged_task<result_type()>>(std::move(f));
+            auto result = pt->get_future();
+            this->Submit([pt](const Task&) { (*pt)(); }, prio);
+            return result;
+        }
+
+        /// Runs a loop body for chunks of a range on all workers and the calling
+        /// thread, and waits for all of them. If one chunk throws, its exception
+        /// is rethrown; if several chunks throw, a ParallelForException holding
+        /// all of their exceptions is thrown.
+        /// @param begin the first index
+        /// @param end the index after the last one
+        /// @param body the loop body, called with the range of indices of a chunk
+        /// @param grain the size of the chunks, 0 for a few chunks per worker
+        /// @param prio the priority of the chunks
+        void ParallelFor(int64_t begin, int64_t end, const std::function<void(int64_t, int64_t)>& body,
+            int64_t grain = 0, Priority prio = Priority::INTERACTIVE);
+
+        /// Sets the number of workers. If the number changes, running workers
+        /// finish all queued tasks and are restarted on the next submission.
+        /// @param count the number of workers, 0 for one per hardware thread
+        void SetThreadCount(unsigned int count);
+
+        /// @returns the number of workers
+        unsigned int GetThreadCount(void) const;
+
+        /// @returns whether the calling thread is a worker of the scheduler
+        bool IsWorkerThread(void) const;
+
+        /// Registers a user of the scheduler, e.g. a core instance
+        void AddUser(void);
+
+        /// Removes a user of the scheduler. When the last user is removed, all
+        /// queued tasks are finished and the workers are stopped.
+        void RemoveUser(void);
+
+        /// Finishes all queued tasks and stops the workers
+        void Shutdown(void);
+
+    private:
+
+        /// the queues of a worker
+        struct Worker {
+            std::mutex lock;
+            std::deque<TaskHandle> queues[2];
+            std::thread thread;
+        };
+
+        TaskScheduler(void);
+        ~TaskScheduler(void);
+
+        /// starts the workers if they are not running
+        void start(void);
+
+        /// the main loop of a worker
+        void work(unsigned int self);
+
+        /// takes the most urgent task for a worker
+        bool take(unsigned int self, TaskHandle& task);
+
+        /// runs a task which has been taken from a queue
+        void run(const TaskHandle& task);
+
+        /// queues a task whose predecessors are done
+        void enqueue(const TaskHandle& task);
+
+        /// marks a predecessor of a task as done
+        void release(const TaskHandle& task);
+
+        /// completes a task and releases its continuations
+        void finish(const TaskHandle& task);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        /// the tasks submitted by other threads
+        std::deque<TaskHandle> shared[2];
+        std::mutex sharedLock;
+
+        /// the number of queued tasks, workers sleep while it is zero
+        std::atomic<size_t> queued;
+        std::mutex sleepLock;
+        std::condition_variable wake;
+        bool stopping;
+
+        unsigned int threadCount;
+
+        /// the number of registered users, guarded by 'stateLock'
+        unsigned int users;
+
+        /// guards starting and stopping the workers
+        mutable std::mutex stateLock;
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_TASKSCHEDULER_H_INCLUDED */
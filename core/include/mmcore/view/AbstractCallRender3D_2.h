@@ -107,6 +107,23 @@ public:
      */
     inline void SetLastFrameTime(double time) { this->lastFrameTime = time; }
 
+    /**
+     * Gets the rendering quality requested by the view, in the range (0, 1]. A quality of 1 requests the full
+     * quality, lower values allow the callee to decimate its output, e.g. by rendering only a corresponding
+     * fraction of its particles or by using fewer samples, in order to keep the view interactive.
+     *
+     * @return The requested rendering quality
+     */
+    inline float RenderQuality(void) const { return this->renderQuality; }
+
+    /**
+     * Sets the requested rendering quality. This has to be set by the
+     * caller before calling 'Render'.
+     *
+     * @param quality The requested rendering quality, in the range (0, 1]
+     */
+    inline void SetRenderQuality(float quality) { this->renderQuality = quality; }
+
     /**
      * Assignment operator
      *
@@ -135,6 +152,9 @@ private:
 
     /** The number of milliseconds required to render the last frame */
     double lastFrameTime;
+
+    /** The requested rendering quality */
+    float renderQuality;
 };
 
 } // namespace view
@@ -13,6 +13,7 @@
 
 #include <atomic>
 
+#include "mmcore/AbstractGetData3DCall.h"
 #include "mmcore/Module.h"
 #include "vislib/sys/CriticalSection.h"
 #include "vislib/sys/Thread.h"
@@ -177,6 +178,20 @@ namespace view {
         Frame * requestLockedFrame(unsigned int idx);
         Frame * requestLockedFrame(unsigned int idx, bool forceIdx);
 
+        /**
+         * Requests the frame asked for by a data call, see
+         * 'requestLockedFrame'. The answered frame is reported back to the
+         * call. If the request is not forced and the frame is still being
+         * loaded, the call is answered with the closest available frame and
+         * flagged as pending, such that the caller does not block.
+         *
+         * @param call The data call requesting the frame.
+         *
+         * @return The frame most suitable to the request, or NULL if no
+         *         frame has been loaded yet.
+         */
+        Frame * requestLockedFrame(AbstractGetData3DCall& call);
+
         /**
          * Resets the whole module to the same state as directly after the
          * 'ctor' returned. You must call 'setFrameCount' and 'initFrameCache'
@@ -237,6 +252,13 @@ namespace view {
         /** The frame number requested the last time 'requestLockedFrame' was called */
         unsigned int lastRequested;
 
+        /**
+         * The playback direction derived from the last two distinct requests
+         * (1 for forward, -1 for backward). The loader prefetches frames in
+         * this direction and evicts the frames behind the requested one first.
+         */
+        std::atomic_int requestDirection;
+
 		/** TODO: The Mueller shalt document his stuff */
 		std::atomic_bool isRunning;
 #ifdef _WIN32
@@ -36,6 +36,7 @@
 #include "vislib/graphics/Cursor2D.h"
 #include "vislib/graphics/InputModifiers.h"
 #include "vislib/graphics/gl/CameraOpenGL.h"
+#include "vislib/graphics/gl/FramebufferObject.h"
 #include "vislib/graphics/gl/OpenGLTexture2D.h"
 #include "vislib/graphics/gl/ShaderSource.h"
 #include "vislib/graphics/graphicstypes.h"
@@ -259,6 +260,14 @@ protected:
      */
     void handleCameraMovement(void);
 
+    /**
+     * Adapts the rendering quality to the target frame time while the camera moves, and refines it towards the
+     * full quality while the camera is still
+     *
+     * @param cameraMoved Flag whether the camera moved since the last frame
+     */
+    void updateRenderQuality(bool cameraMoved);
+
 #ifdef _WIN32
 #    pragma warning(disable : 4251)
 #endif /* _WIN32 */
@@ -407,6 +416,34 @@ protected:
     std::chrono::time_point<std::chrono::high_resolution_clock> lastFrameTime;
 
     std::chrono::microseconds lastFrameDuration;
+
+    /** Target frame time in milliseconds for the adaptive quality, zero disables it */
+    param::ParamSlot targetFrameTimeSlot;
+
+    /** Lower bound of the adaptive quality */
+    param::ParamSlot minQualitySlot;
+
+    /** Flag whether the resolution is reduced along with the quality */
+    param::ParamSlot dynamicResolutionSlot;
+
+    /** Flag whether the quality is refined over several frames when the camera stops */
+    param::ParamSlot progressiveRefinementSlot;
+
+    /** The current rendering quality, in the range (0, 1] */
+    float renderQuality;
+
+    /** Camera matrices of the last frame, for detecting camera motion */
+    glm::mat4 lastViewMx;
+    glm::mat4 lastProjMx;
+
+#ifdef _WIN32
+#    pragma warning(disable : 4251)
+#endif /* _WIN32 */
+    /** Framebuffer for rendering at reduced resolution */
+    vislib::graphics::gl::FramebufferObject scaledFbo;
+#ifdef _WIN32
+#    pragma warning(default : 4251)
+#endif /* _WIN32 */
 };
 
 } // namespace view
@@ -19,7 +19,7 @@ using namespace megamol::core;
  */
 AbstractDataWriter::AbstractDataWriter(void) : Module(),
         controlSlot("control", "Slot for incoming control commands"),
-        manualRunSlot("manualRun", "Slot fopr manual triggering of the run method.") {
+        manualRunSlot("manualRun", "Slot fopr manual triggering of the run method."), runningCall(NULL) {
 
     this->controlSlot.SetCallback(DataWriterCtrlCall::ClassName(),
         DataWriterCtrlCall::FunctionName(DataWriterCtrlCall::CALL_RUN),
@@ -58,7 +58,19 @@ bool AbstractDataWriter::abort(void) {
  * AbstractDataWriter::onCallRun
  */
 bool AbstractDataWriter::onCallRun(Call &call) {
-    return this->run();
+    this->runningCall = dynamic_cast<DataWriterCtrlCall*>(&call);
+    if (this->runningCall != NULL) this->runningCall->SetProgress(-1.0f, 0);
+    bool retval = this->run();
+    this->runningCall = NULL;
+    return retval;
+}
+
+
+/*
+ * AbstractDataWriter::setProgress
+ */
+void AbstractDataWriter::setProgress(float progress, UINT64 bytesWritten) {
+    if (this->runningCall != NULL) this->runningCall->SetProgress(progress, bytesWritten);
 }
 
 
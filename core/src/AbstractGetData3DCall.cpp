@@ -15,7 +15,7 @@ using namespace megamol::core;
  * AbstractGetData3DCall::AbstractGetData3DCall
  */
 AbstractGetData3DCall::AbstractGetData3DCall(void) : AbstractGetDataCall(),
-        forceFrame(false), frameCnt(0), frameID(0), bboxs() {
+        forceFrame(false), frameCnt(0), frameID(0), framePending(false), bboxs() {
     // intentionally empty
 }
 
@@ -37,6 +37,7 @@ AbstractGetData3DCall& AbstractGetData3DCall::operator=(
     this->forceFrame = rhs.forceFrame;
     this->frameCnt = rhs.frameCnt;
     this->frameID = rhs.frameID;
+    this->framePending = rhs.framePending;
     this->bboxs = rhs.bboxs;
     return *this;
 }
@@ -6,6 +6,7 @@
  */
 #include "stdafx.h"
 #include "mmcore/AbstractNamedObject.h"
+#include "mmcore/AbstractNamedObjectContainer.h"
 #include "vislib/assert.h"
 #include "vislib/sys/AutoLock.h"
 #include "vislib/sys/Log.h"
@@ -196,7 +197,14 @@ void AbstractNamedObject::SetOwner(void *owner) {
  * AbstractNamedObject::setName
  */
 void AbstractNamedObject::setName(const vislib::StringA& name) {
+    vislib::StringA oldName(this->name);
     this->name = name;
+    // keep the name index of the parent up to date
+    AbstractNamedObjectContainer::ptr_type container
+        = std::dynamic_pointer_cast<AbstractNamedObjectContainer>(this->parent.lock());
+    if (container && !oldName.Equals(name)) {
+        container->renameChild(oldName, name);
+    }
 }
 
 
@@ -11,11 +11,20 @@
 #include "vislib/sys/Log.h"
 #include "vislib/String.h"
 #include <algorithm>
+#include <atomic>
 #include "mmcore/Module.h"
 
 using namespace megamol::core;
 
 
+namespace {
+
+    /** The structure version of all module graphs */
+    std::atomic<unsigned int> structureVersion(0);
+
+}
+
+
 /*
  * AbstractNamedObjectContainer::~AbstractNamedObjectContainer
  */
@@ -33,6 +42,7 @@ AbstractNamedObjectContainer::~AbstractNamedObjectContainer(void) {
         msg.Format("Possible memory problem detected: NamedObjectContainer (%s) with children destructed", name.PeekBuffer());
         vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, msg.PeekBuffer());
         this->children.clear();
+        this->childIndex.clear();
     }
     // The child list should already be empty at this time
 }
@@ -42,7 +52,7 @@ AbstractNamedObjectContainer::~AbstractNamedObjectContainer(void) {
  * AbstractNamedObjectContainer::AbstractNamedObjectContainer
  */
 AbstractNamedObjectContainer::AbstractNamedObjectContainer(void)
-        : AbstractNamedObject(), children() {
+        : AbstractNamedObject(), children(), childIndex() {
     // intentionally empty
 }
 
@@ -54,6 +64,9 @@ void AbstractNamedObjectContainer::addChild(AbstractNamedObject::ptr_type child)
     if (!child) return;
     ASSERT(!child->Parent());
     this->children.push_back(child);
+    // a child added earlier keeps precedence when names are duplicated
+    this->childIndex.emplace(child->Name().PeekBuffer(), child);
+    ++structureVersion;
     Module* mod = dynamic_cast<Module *>(this);
     if (mod) {
         // for modules, calling "shared_from_this" is illegal if they have not been created!
@@ -73,6 +86,11 @@ void AbstractNamedObjectContainer::removeChild(AbstractNamedObject::ptr_type chi
     if (!child) return;
     //ASSERT(child->Parent().get() == this);
     this->children.remove(child);
+    child_index_type::iterator indexed = this->childIndex.find(child->Name().PeekBuffer());
+    if ((indexed != this->childIndex.end()) && (indexed->second == child)) {
+        this->reindexChild(child->Name());
+    }
+    ++structureVersion;
     child->setParent(AbstractNamedObject::ptr_type(nullptr));
 }
 
@@ -82,14 +100,8 @@ void AbstractNamedObjectContainer::removeChild(AbstractNamedObject::ptr_type chi
  */
 AbstractNamedObject::ptr_type AbstractNamedObjectContainer::findChild(
         const vislib::StringA& name) {
-    child_list_type::iterator end = this->children.end();
-    child_list_type::iterator found = std::find_if(
-        this->children.begin(), 
-        end,
-        [&](AbstractNamedObject::ptr_type c) {
-            return c->Name().Equals(name);
-        });
-    return (found != end) ? *found : AbstractNamedObject::ptr_type(nullptr);
+    child_index_type::const_iterator found = this->childIndex.find(name.PeekBuffer());
+    return (found != this->childIndex.end()) ? found->second : AbstractNamedObject::ptr_type(nullptr);
 }
 
 
@@ -148,6 +160,14 @@ AbstractNamedObject::ptr_type AbstractNamedObjectContainer::FindNamedObject(cons
 }
 
 
+/*
+ * AbstractNamedObjectContainer::StructureVersion
+ */
+unsigned int AbstractNamedObjectContainer::StructureVersion(void) {
+    return structureVersion;
+}
+
+
 /*
  * AbstractNamedObjectContainer::SetAllCleanupMarks
  */
@@ -237,4 +257,33 @@ void AbstractNamedObjectContainer::fixParentBackreferences(void) {
             i->setParent(this->shared_from_this());
         }
     }
-}
\ No newline at end of file
+}
+
+
+/*
+ * AbstractNamedObjectContainer::renameChild
+ */
+void AbstractNamedObjectContainer::renameChild(const vislib::StringA& oldName, const vislib::StringA& newName) {
+    this->reindexChild(oldName);
+    this->reindexChild(newName);
+    ++structureVersion;
+}
+
+
+/*
+ * AbstractNamedObjectContainer::reindexChild
+ */
+void AbstractNamedObjectContainer::reindexChild(const vislib::StringA& name) {
+    child_list_type::iterator end = this->children.end();
+    child_list_type::iterator found = std::find_if(
+        this->children.begin(),
+        end,
+        [&](AbstractNamedObject::ptr_type c) {
+            return c->Name().Equals(name);
+        });
+    if (found != end) {
+        this->childIndex[name.PeekBuffer()] = *found;
+    } else {
+        this->childIndex.erase(name.PeekBuffer());
+    }
+}
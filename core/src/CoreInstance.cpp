@@ -14,6 +14,8 @@
 #    pragma warning(default : 4996)
 #endif /* (_MSC_VER > 1000) */
 
+#include <algorithm>
+#include <future>
 #include <string>
 
 #include "job/PluginsStateFileGeneratorJob.h"
@@ -34,6 +36,7 @@
 #include "mmcore/profiler/Manager.h"
 #include "mmcore/utility/APIValueUtil.h"
 #include "mmcore/utility/ProjectParser.h"
+#include "mmcore/utility/ResultCache.h"
 #include "mmcore/utility/xml/XmlReader.h"
 #include "mmcore/versioninfo.h"
 #include "vislib/GUID.h"
@@ -43,10 +46,12 @@
 #include "vislib/Trace.h"
 #include "vislib/UTF8Encoder.h"
 #include "vislib/functioncast.h"
+#include "vislib/graphics/gl/GLSLShader.h"
 #include "vislib/net/AbstractSimpleMessage.h"
 #include "vislib/net/NetworkInformation.h"
 #include "vislib/net/Socket.h"
 #include "vislib/sys/AutoLock.h"
+#include "vislib/sys/File.h"
 #include "vislib/sys/Log.h"
 #include "vislib/sys/PerformanceCounter.h"
 #include "vislib/sys/RegistryKey.h"
@@ -139,12 +144,18 @@ megamol::core::CoreInstance::CoreInstance(void)
     , pendingViewInstRequests()
     , pendingJobInstRequests()
     , namespaceRoot()
+    , paramSlotCache()
+    , paramSlotCacheVersion(0)
     , pendingCallInstRequests()
     , pendingCallDelRequests()
     , pendingModuleInstRequests()
     , pendingModuleDelRequests()
     , pendingParamSetRequests()
     , graphUpdateLock()
+    , graphUpdateBatchDepth(0)
+    , deferParamUpdates(false)
+    , deferredParamUpdates()
+    , deferredParamUpdateSet()
     , loadedLuaProjects()
     , timeOffset(0.0)
     , paramUpdateListeners()
@@ -168,12 +179,15 @@ megamol::core::CoreInstance::CoreInstance(void)
     vislib::sys::Log::DefaultLog.SetLevel(vislib::sys::Log::LEVEL_NONE);
     vislib::sys::Log::DefaultLog.SetEchoLevel(vislib::sys::Log::LEVEL_ALL);
     vislib::sys::Log::DefaultLog.SetEchoTarget(new vislib::sys::Log::RedirectTarget(&this->log));
+    // modules log from worker threads and render loops, keep them off the targets
+    vislib::sys::Log::DefaultLog.SetAsynchronous(true);
 
 #ifdef ULTRA_SOCKET_STARTUP
     vislib::net::Socket::Startup();
 #endif /* ULTRA_SOCKET_STARTUP */
     this->plugins = new utility::plugins::PluginManager();
     this->services = new utility::ServiceManager(*this);
+    utility::TaskScheduler::Instance().AddUser();
 
 #ifdef _WIN32
     WCHAR dll_path[MAX_PATH] = {0};
@@ -238,9 +252,15 @@ megamol::core::CoreInstance::~CoreInstance(void) {
         }
     }
 
+    // the workers may still run tasks of the modules; other instances keep the scheduler running
+    utility::TaskScheduler::Instance().RemoveUser();
+
     delete this->services;
     this->services = nullptr;
 
+    // write all pending messages while the instance log still exists
+    vislib::sys::Log::DefaultLog.SetAsynchronous(false);
+
     // we need to manually clean up all data structures in the right order!
     // first view- and job-descriptions
     this->builtinViewDescs.Shutdown();
@@ -370,6 +390,16 @@ void megamol::core::CoreInstance::Initialise(void) {
     // register services? TODO: right place?
     megamol::core::utility::LuaHostService::ID = this->InstallService<megamol::core::utility::LuaHostService>();
 
+    // set up the scheduler for the parallel work of modules
+    if (this->config.IsConfigValueSet("taskSchedulerThreads")) {
+        try {
+            int cnt = vislib::CharTraitsW::ParseInt(this->config.ConfigValue("taskSchedulerThreads").PeekBuffer());
+            utility::TaskScheduler::Instance().SetThreadCount(static_cast<unsigned int>(std::max(cnt, 0)));
+        } catch (...) {
+            vislib::sys::Log::DefaultLog.WriteWarn("Unable to parse configuration value \"taskSchedulerThreads\"");
+        }
+    }
+
     // loading plugins
     // printf("Log: %d:\n", (long)(&vislib::sys::Log::DefaultLog));
     // printf("\tAutoflush: %s\n", vislib::sys::Log::DefaultLog.IsAutoFlushEnabled() ? "enabled" : "disabled");
@@ -378,9 +408,21 @@ void megamol::core::CoreInstance::Initialise(void) {
     // printf("\tEcho-Target: %d\n", (long)(vislib::sys::Log::DefaultLog.GetEchoOutTarget()));
     vislib::SingleLinkedList<vislib::TString> plugins_paths;
     this->config.ListPluginsToLoad(plugins_paths);
-    vislib::SingleLinkedList<vislib::TString>::Iterator iter = plugins_paths.GetIterator();
-    while (iter.HasNext()) {
-        this->loadPlugin(iter.Next());
+    {
+        // The libraries are loaded in parallel, but the plugins are registered
+        // in the configured order, so naming conflicts are resolved as before.
+        std::vector<vislib::TString> files;
+        std::vector<std::future<std::shared_ptr<vislib::sys::DynamicLinkLibrary>>> libs;
+        vislib::SingleLinkedList<vislib::TString>::Iterator iter = plugins_paths.GetIterator();
+        while (iter.HasNext()) {
+            files.push_back(iter.Next());
+            const std::basic_string<TCHAR> filename(files.back().PeekBuffer());
+            libs.push_back(utility::TaskScheduler::Instance().Async(
+                [filename]() { return utility::plugins::PluginManager::OpenLibrary(filename); }));
+        }
+        for (size_t i = 0; i < files.size(); ++i) {
+            this->loadPlugin(files[i], libs[i]);
+        }
     }
     // printf("Log: %d:\n", (long)(&vislib::sys::Log::DefaultLog));
     // printf("\tAutoflush: %s\n", vislib::sys::Log::DefaultLog.IsAutoFlushEnabled() ? "enabled" : "disabled");
@@ -414,6 +456,39 @@ void megamol::core::CoreInstance::Initialise(void) {
         profiler::Manager::Instance().SetMode(profiler::Manager::PROFILE_NONE);
     }
 
+    // set up the result cache of filter modules
+    if (this->config.IsConfigValueSet("resultCacheSize")) {
+        try {
+            int mb = vislib::CharTraitsW::ParseInt(this->config.ConfigValue("resultCacheSize").PeekBuffer());
+            utility::ResultCache::Instance().SetBudget(static_cast<size_t>(std::max(mb, 0)) << 20);
+        } catch (...) {
+            vislib::sys::Log::DefaultLog.WriteWarn("Unable to parse configuration value \"resultCacheSize\"");
+        }
+    }
+    if (this->config.IsConfigValueSet("resultCacheDir")) {
+        size_t diskBytes = static_cast<size_t>(4096) << 20;
+        if (this->config.IsConfigValueSet("resultCacheDiskSize")) {
+            try {
+                int mb = vislib::CharTraitsW::ParseInt(this->config.ConfigValue("resultCacheDiskSize").PeekBuffer());
+                diskBytes = static_cast<size_t>(std::max(mb, 0)) << 20;
+            } catch (...) {
+                vislib::sys::Log::DefaultLog.WriteWarn("Unable to parse configuration value \"resultCacheDiskSize\"");
+            }
+        }
+        vislib::StringA dir(this->config.ConfigValue("resultCacheDir"));
+        utility::ResultCache::Instance().SetSpillDirectory(dir.PeekBuffer(), diskBytes);
+    }
+
+    // set up the cache of linked shader programs
+    if (this->config.IsConfigValueSet("shaderCacheDir")) {
+        vislib::StringA dir(this->config.ConfigValue("shaderCacheDir"));
+        if (vislib::sys::File::IsDirectory(dir)) {
+            vislib::graphics::gl::GLSLShader::SetProgramCacheDirectory(dir);
+        } else {
+            vislib::sys::Log::DefaultLog.WriteWarn("Shader cache directory \"%s\" does not exist", dir.PeekBuffer());
+        }
+    }
+
 
     //////////////////////////////////////////////////////////////////////
     // register builtin descriptions
@@ -917,7 +992,61 @@ bool megamol::core::CoreInstance::FlushGraphUpdates() {
 
 
 void megamol::core::CoreInstance::PerformGraphUpdates() {
+    std::vector<param::ParamSlot*> updated;
+    {
+        vislib::sys::AutoLock u(this->graphUpdateLock);
+        if (this->graphUpdateBatchDepth > 0) {
+            // the batch is not complete yet
+            return;
+        }
+
+        // listeners hear about each parameter once, as projects and sweeps set many of them
+        this->deferParamUpdates = true;
+        try {
+            this->performGraphUpdates();
+        } catch (...) {
+            this->deferParamUpdates = false;
+            this->deferredParamUpdates.clear();
+            this->deferredParamUpdateSet.clear();
+            throw;
+        }
+        this->deferParamUpdates = false;
+        updated.swap(this->deferredParamUpdates);
+        this->deferredParamUpdateSet.clear();
+    }
+
+    for (param::ParamSlot* slot : updated) {
+        this->notifyParamUpdateListeners(*slot);
+    }
+}
+
+
+/*
+ * megamol::core::CoreInstance::BeginGraphUpdateBatch
+ */
+void megamol::core::CoreInstance::BeginGraphUpdateBatch(void) {
+    vislib::sys::AutoLock u(this->graphUpdateLock);
+    ++this->graphUpdateBatchDepth;
+}
+
+
+/*
+ * megamol::core::CoreInstance::EndGraphUpdateBatch
+ */
+void megamol::core::CoreInstance::EndGraphUpdateBatch(void) {
     vislib::sys::AutoLock u(this->graphUpdateLock);
+    if (this->graphUpdateBatchDepth == 0) {
+        vislib::sys::Log::DefaultLog.WriteError("EndGraphUpdateBatch: no batch has been started");
+        return;
+    }
+    --this->graphUpdateBatchDepth;
+}
+
+
+/*
+ * megamol::core::CoreInstance::performGraphUpdates
+ */
+void megamol::core::CoreInstance::performGraphUpdates(void) {
     vislib::sys::AutoLock m(this->ModuleGraphRoot()->ModuleGraphLock());
 
     AbstractNamedObject::ptr_type ano = this->namespaceRoot;
@@ -1827,6 +1956,75 @@ vislib::SmartPtr<megamol::core::param::AbstractParam> megamol::core::CoreInstanc
     using vislib::sys::Log;
     vislib::sys::AutoLock lock(this->namespaceRoot->ModuleGraphLock());
 
+    // resolved slots stay valid until the structure of the module graph changes
+    if (this->paramSlotCacheVersion != AbstractNamedObjectContainer::StructureVersion()) {
+        this->paramSlotCache.clear();
+        this->paramSlotCacheVersion = AbstractNamedObjectContainer::StructureVersion();
+    }
+
+    param::ParamSlot* slot = NULL;
+    AbstractNamedObject::ptr_type cached;
+    std::unordered_map<std::string, std::weak_ptr<AbstractNamedObject>>::iterator cacheEntry =
+        this->paramSlotCache.find(name.PeekBuffer());
+    if (cacheEntry != this->paramSlotCache.end()) {
+        cached = cacheEntry->second.lock();
+        slot = dynamic_cast<param::ParamSlot*>(cached.get());
+    }
+    if (slot == NULL) {
+        slot = this->findParameterSlot(name, quiet);
+        if (slot == NULL) {
+            return NULL;
+        }
+        this->paramSlotCache[name.PeekBuffer()] = slot->shared_from_this();
+    }
+
+    if (slot->GetStatus() == AbstractSlot::STATUS_UNAVAILABLE) {
+        /*    if(create)
+            {
+                param::ParamSlot *slotNew = new param::ParamSlot(slotName, "newly inserted");
+                *slotNew << new param::StringParam("");
+                slotNew->MakeAvailable();
+                this->namespaceRoot.AddChild(slotNew);
+                slot = slotNew;
+            }
+            else*/
+        {
+            if (!quiet)
+                Log::DefaultLog.WriteMsg(
+                    Log::LEVEL_ERROR, "Cannot find parameter \"%s\": slot is not available", name.PeekBuffer());
+            return NULL;
+        }
+    }
+    if (slot->Parameter().IsNull()) {
+        /*    if(create)
+            {
+                param::ParamSlot *slotNew = new param::ParamSlot(slotName, "newly inserted");
+                *slotNew << new param::StringParam("");
+                slotNew->MakeAvailable();
+                this->namespaceRoot.AddChild(slotNew);
+                slot = slotNew;
+            }
+            else*/
+        {
+            if (!quiet)
+                Log::DefaultLog.WriteMsg(
+                    Log::LEVEL_ERROR, "Cannot find parameter \"%s\": slot has no parameter", name.PeekBuffer());
+            return NULL;
+        }
+    }
+
+
+    return slot->Parameter();
+}
+
+
+/*
+ * megamol::core::CoreInstance::findParameterSlot
+ */
+megamol::core::param::ParamSlot* megamol::core::CoreInstance::findParameterSlot(
+    const vislib::StringA& name, bool quiet) {
+    using vislib::sys::Log;
+
     vislib::Array<vislib::StringA> path = vislib::StringTokeniserA::Split(name, "::", true);
     vislib::StringA slotName("");
     if (path.Count() > 0) {
@@ -1905,43 +2103,8 @@ vislib::SmartPtr<megamol::core::param::AbstractParam> megamol::core::CoreInstanc
             return NULL;
         }
     }
-    if (slot->GetStatus() == AbstractSlot::STATUS_UNAVAILABLE) {
-        /*    if(create)
-            {
-                param::ParamSlot *slotNew = new param::ParamSlot(slotName, "newly inserted");
-                *slotNew << new param::StringParam("");
-                slotNew->MakeAvailable();
-                this->namespaceRoot.AddChild(slotNew);
-                slot = slotNew;
-            }
-            else*/
-        {
-            if (!quiet)
-                Log::DefaultLog.WriteMsg(
-                    Log::LEVEL_ERROR, "Cannot find parameter \"%s\": slot is not available", name.PeekBuffer());
-            return NULL;
-        }
-    }
-    if (slot->Parameter().IsNull()) {
-        /*    if(create)
-            {
-                param::ParamSlot *slotNew = new param::ParamSlot(slotName, "newly inserted");
-                *slotNew << new param::StringParam("");
-                slotNew->MakeAvailable();
-                this->namespaceRoot.AddChild(slotNew);
-                slot = slotNew;
-            }
-            else*/
-        {
-            if (!quiet)
-                Log::DefaultLog.WriteMsg(
-                    Log::LEVEL_ERROR, "Cannot find parameter \"%s\": slot has no parameter", name.PeekBuffer());
-            return NULL;
-        }
-    }
-
 
-    return slot->Parameter();
+    return slot;
 }
 
 
@@ -2481,6 +2644,24 @@ void megamol::core::CoreInstance::SetupGraphFromNetwork(const void* data) {
  * megamol::core::CoreInstance::ParameterValueUpdate
  */
 void megamol::core::CoreInstance::ParameterValueUpdate(megamol::core::param::ParamSlot& slot) {
+    {
+        vislib::sys::AutoLock u(this->graphUpdateLock);
+        if (this->deferParamUpdates) {
+            // PerformGraphUpdates notifies the listeners when it is done
+            if (this->deferredParamUpdateSet.insert(&slot).second) {
+                this->deferredParamUpdates.push_back(&slot);
+            }
+            return;
+        }
+    }
+    this->notifyParamUpdateListeners(slot);
+}
+
+
+/*
+ * megamol::core::CoreInstance::notifyParamUpdateListeners
+ */
+void megamol::core::CoreInstance::notifyParamUpdateListeners(megamol::core::param::ParamSlot& slot) {
     vislib::SingleLinkedList<param::ParamUpdateListener*>::Iterator i = this->paramUpdateListeners.GetIterator();
     while (i.HasNext()) {
         i.Next()->ParamUpdated(slot);
@@ -3452,7 +3633,8 @@ void megamol::core::CoreInstance::applyConfigParams(
 /*
  * megamol::core::CoreInstance::loadPlugin
  */
-void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
+void megamol::core::CoreInstance::loadPlugin(
+    const vislib::TString& filename, std::future<std::shared_ptr<vislib::sys::DynamicLinkLibrary>>& lib) {
 
     // select log level for plugin loading errors
     unsigned int loadFailedLevel = vislib::sys::Log::LEVEL_ERROR;
@@ -3476,7 +3658,7 @@ void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
     try {
 
         utility::plugins::PluginManager::collection_type new_plugins =
-            this->plugins->LoadPlugin(filename.PeekBuffer(), *this);
+            this->plugins->LoadPlugin(filename.PeekBuffer(), lib.get(), *this);
 
         for (auto new_plugin : new_plugins) {
             this->log.WriteMsg(vislib::sys::Log::LEVEL_INFO,
@@ -14,7 +14,7 @@ using namespace megamol::core;
 /*
  * DataWriterCtrlCall::DataWriterCtrlCall
  */
-DataWriterCtrlCall::DataWriterCtrlCall(void) : Call(), abortable(false) {
+DataWriterCtrlCall::DataWriterCtrlCall(void) : Call(), abortable(false), progress(-1.0f), bytesWritten(0) {
     // intentionally empty
 }
 
@@ -32,5 +32,6 @@ DataWriterCtrlCall::~DataWriterCtrlCall(void) {
  */
 DataWriterCtrlCall& DataWriterCtrlCall::operator=(const DataWriterCtrlCall& rhs) {
     this->abortable = rhs.abortable;
+    this->SetProgress(rhs.Progress(), rhs.BytesWritten());
     return *this;
 }
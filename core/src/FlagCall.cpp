@@ -1,6 +1,9 @@
 #include "stdafx.h"
 #include "mmcore/FlagCall.h"
 
+#include <algorithm>
+#include "vislib/graphics/gl/IncludeAllGL.h"
+
 using namespace megamol;
 using namespace megamol::core;
 
@@ -18,9 +21,122 @@ const unsigned int FlagCall::CallUnmapFlags = 1;
 /*
  *	IntSelectionCall:IntSelectionCall
  */
-FlagCall::FlagCall(void) : flags() {}
+FlagCall::FlagCall(void)
+    : flags(), version(0), changeLog(nullptr), changeLogBase(0), dirtyRanges(), dirtyValid(false), buffer(nullptr) {}
 
 /*
  *	IntSelectionCall::~IntSelectionCall
  */
 FlagCall::~FlagCall(void) { flags = nullptr; }
+
+
+namespace {
+
+/** Sorts ranges and merges overlapping or adjacent ones */
+void mergeRanges(std::vector<FlagStorage::FlagRangeType>& ranges) {
+    if (ranges.empty()) return;
+    std::sort(ranges.begin(), ranges.end());
+    size_t out = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].first <= ranges[out].second) {
+            ranges[out].second = std::max(ranges[out].second, ranges[i].second);
+        } else {
+            ranges[++out] = ranges[i];
+        }
+    }
+    ranges.resize(out + 1);
+}
+
+} // namespace
+
+
+/*
+ * FlagCall::MarkDirty
+ */
+void FlagCall::MarkDirty(size_t begin, size_t end) {
+    if (!this->dirtyValid || (begin >= end)) return;
+    if (!this->dirtyRanges.empty() && (this->dirtyRanges.back().second == begin)) {
+        this->dirtyRanges.back().second = end; // the common case of consecutive indices
+    } else {
+        this->dirtyRanges.emplace_back(begin, end);
+    }
+}
+
+
+/*
+ * FlagCall::GetChangesSince
+ */
+bool FlagCall::GetChangesSince(
+    FlagStorage::FlagVersionType since, std::vector<FlagStorage::FlagRangeType>& ranges) const {
+    ranges.clear();
+    if ((this->changeLog == nullptr) || !this->dirtyValid || (since == 0) || (since < this->changeLogBase) || (since > this->version)) {
+        return false;
+    }
+    for (const auto& c : *this->changeLog) {
+        if (c.version > since) ranges.insert(ranges.end(), c.ranges.begin(), c.ranges.end());
+    }
+    mergeRanges(ranges);
+    return true;
+}
+
+
+/*
+ * FlagCall::takeDirtyRanges
+ */
+bool FlagCall::takeDirtyRanges(std::vector<FlagStorage::FlagRangeType>& ranges) {
+    if (!this->dirtyValid || this->dirtyRanges.empty()) return false;
+    ranges.swap(this->dirtyRanges);
+    this->dirtyRanges.clear();
+    mergeRanges(ranges);
+    return true;
+}
+
+
+/*
+ * FlagCall::GetFlagsBuffer
+ */
+unsigned int FlagCall::GetFlagsBuffer(void) {
+    if ((this->buffer == nullptr) || !this->flags) return 0;
+    auto& b = *this->buffer;
+    const size_t size = this->flags->size();
+    if ((b.name != 0) && (b.version == this->version) && (b.size == size) && (b.version != 0)) return b.name;
+
+    // the log covers the versions up to the one of the storage, the rest is reported via MarkDirty
+    const FlagStorage::FlagVersionType logged = (this->changeLog == nullptr || this->changeLog->empty())
+                                                    ? this->changeLogBase
+                                                    : this->changeLog->back().version;
+    std::vector<FlagStorage::FlagRangeType> ranges;
+    bool incremental = (b.name != 0) && (b.size == size) && this->GetChangesSince(b.version, ranges);
+    if (incremental && (this->version != logged)) {
+        incremental = !this->dirtyRanges.empty();
+        ranges.insert(ranges.end(), this->dirtyRanges.begin(), this->dirtyRanges.end());
+        mergeRanges(ranges);
+    }
+
+    if (b.name == 0) glGenBuffers(1, &b.name);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, b.name);
+    if (incremental) {
+        for (const auto& r : ranges) {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, r.first * sizeof(FlagStorage::FlagItemType),
+                (r.second - r.first) * sizeof(FlagStorage::FlagItemType), this->flags->data() + r.first);
+        }
+    } else {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size * sizeof(FlagStorage::FlagItemType), this->flags->data(),
+            GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    b.version = this->version;
+    b.size = size;
+
+    return b.name;
+}
+
+
+/*
+ * FlagCall::MarkFlagsBufferCurrent
+ */
+void FlagCall::MarkFlagsBufferCurrent(void) {
+    if ((this->buffer == nullptr) || !this->flags) return;
+    this->buffer->version = this->version;
+    this->buffer->size = this->flags->size();
+}
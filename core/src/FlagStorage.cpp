@@ -1,16 +1,27 @@
 #include "stdafx.h"
 #include "mmcore/FlagStorage.h"
 #include "mmcore/FlagCall.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
 
 using namespace megamol;
 using namespace megamol::core;
 
 
+/** Number of versions kept in the change log */
+#define FLAGSTORAGE_CHANGE_LOG_SIZE 64
+
+
 FlagStorage::FlagStorage(void)
     : getFlagsSlot("getFlags", "Provides flag data to clients.")
     , flags(std::make_shared<FlagVectorType>())
-    , mut()
-    , version(0) {
+    , version(0)
+    , changes()
+    , changesBase(0)
+    , mut() {
+
+    this->buffer.name = 0;
+    this->buffer.version = 0;
+    this->buffer.size = 0;
 
     this->getFlagsSlot.SetCallback(
         FlagCall::ClassName(), FlagCall::FunctionName(FlagCall::CallMapFlags), &FlagStorage::mapFlagsCallback);
@@ -27,7 +38,10 @@ bool FlagStorage::create(void) { return true; }
 
 
 void FlagStorage::release(void) {
-    // intentionally empty
+    if (this->buffer.name != 0) {
+        glDeleteBuffers(1, &this->buffer.name);
+        this->buffer.name = 0;
+    }
 }
 
 
@@ -37,6 +51,8 @@ bool FlagStorage::mapFlagsCallback(core::Call& caller) {
 
     mut.lock();
     fc->SetFlags(this->flags, this->version);
+    fc->setChangeLog(&this->changes, this->changesBase);
+    fc->setBuffer(&this->buffer);
 
     return true;
 }
@@ -47,7 +63,26 @@ bool FlagStorage::unmapFlagsCallback(core::Call& caller) {
     if (fc == nullptr) return false;
 
     this->flags = fc->GetFlags();
-    this->version = fc->GetVersion();
+    const FlagVersionType newVersion = fc->GetVersion();
+
+    if (newVersion != this->version) {
+        FlagChangeType change;
+        change.version = newVersion;
+        if ((newVersion > this->version) && fc->takeDirtyRanges(change.ranges)) {
+            this->changes.push_back(std::move(change));
+            while (this->changes.size() > FLAGSTORAGE_CHANGE_LOG_SIZE) {
+                this->changesBase = this->changes.front().version;
+                this->changes.pop_front();
+            }
+        } else {
+            // unknown changes, consumers need to fetch everything
+            this->changes.clear();
+            this->changesBase = newVersion;
+        }
+        this->version = newVersion;
+    }
+    fc->setChangeLog(nullptr, 0);
+    fc->setBuffer(nullptr);
     mut.unlock();
 
     return true;
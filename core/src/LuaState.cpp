@@ -22,6 +22,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/LuaState.h"
+#include "mmcore/profiler/Manager.h"
 #include "mmcore/utility/Configuration.h"
 #include "vislib/UTF8Encoder.h"
 #include "vislib/sys/AutoLock.h"
@@ -92,6 +93,9 @@ bool iequals(const std::string& one, const std::string& other) {
 #define MMC_LUA_MMFLUSH "mmFlush"
 #define MMC_LUA_MMCURRENTSCRIPTPATH "mmCurrentScriptPath"
 #define MMC_LUA_MMLISTPARAMETERS "mmListParameters"
+#define MMC_LUA_MMPROFILERSELECT "mmProfilerSelect"
+#define MMC_LUA_MMPROFILERREPORT "mmProfilerReport"
+#define MMC_LUA_MMPROFILERWRITETRACE "mmProfilerWriteTrace"
 
 
 bool megamol::core::LuaState::checkConfiguring(const std::string where) {
@@ -178,6 +182,10 @@ void megamol::core::LuaState::commonInit() {
 
     theLua.RegisterCallback<LuaState, &LuaState::Flush>(MMC_LUA_MMFLUSH, "()\n\tInserts a flush event into graph manipulation queues.");
     theLua.RegisterCallback<LuaState, &LuaState::CurrentScriptPath>(MMC_LUA_MMCURRENTSCRIPTPATH, "()\n\tReturns the path of the currently running script, if possible. Empty string otherwise.");
+
+    theLua.RegisterCallback<LuaState, &LuaState::ProfilerSelect>(MMC_LUA_MMPROFILERSELECT, "(string caller)\n\tSelect the call connected to CallerSlot <caller> for profiling.");
+    theLua.RegisterCallback<LuaState, &LuaState::ProfilerReport>(MMC_LUA_MMPROFILERREPORT, "()\n\tReturn the timings of the profiled calls, aggregated per module.");
+    theLua.RegisterCallback<LuaState, &LuaState::ProfilerWriteTrace>(MMC_LUA_MMPROFILERWRITETRACE, "(string fileName)\n\tWrite the samples of the profiled calls as Chrome trace file.");
 }
 
 
@@ -241,7 +249,21 @@ bool megamol::core::LuaState::RunString(
     // no two threads can touch L at the same time
     std::lock_guard<std::mutex> stateGuard(this->stateLock);
     this->currentScriptPath = scriptPath;
-    return theLua.RunString(envName, script, result);
+    if (this->coreInst == nullptr) {
+        return theLua.RunString(envName, script, result);
+    }
+
+    // all graph updates requested by the script are performed together
+    this->coreInst->BeginGraphUpdateBatch();
+    bool ok = false;
+    try {
+        ok = theLua.RunString(envName, script, result);
+    } catch (...) {
+        this->coreInst->EndGraphUpdateBatch();
+        throw;
+    }
+    this->coreInst->EndGraphUpdateBatch();
+    return ok;
 }
 
 
@@ -1253,3 +1275,43 @@ int megamol::core::LuaState::CurrentScriptPath(struct lua_State* L) {
     lua_pushstring(L, this->currentScriptPath.c_str());
     return 1;
 }
+
+
+int megamol::core::LuaState::ProfilerSelect(lua_State* L) {
+    if (this->checkRunning(MMC_LUA_MMPROFILERSELECT)) {
+        const auto caller = luaL_checkstring(L, 1);
+
+        vislib::sys::AutoLock l(this->coreInst->ModuleGraphRoot()->ModuleGraphLock());
+        profiler::Manager& man = profiler::Manager::Instance();
+        if (man.GetMode() == profiler::Manager::PROFILE_NONE) {
+            man.SetMode(profiler::Manager::PROFILE_SELECTED);
+        }
+        man.Select(caller);
+    }
+    return 0;
+}
+
+
+int megamol::core::LuaState::ProfilerReport(lua_State* L) {
+    if (this->checkRunning(MMC_LUA_MMPROFILERREPORT)) {
+        vislib::StringA report = profiler::Manager::Instance().MakeReport();
+        lua_pushstring(L, report.PeekBuffer());
+        return 1;
+    }
+    return 0;
+}
+
+
+int megamol::core::LuaState::ProfilerWriteTrace(lua_State* L) {
+    if (this->checkRunning(MMC_LUA_MMPROFILERWRITETRACE)) {
+        const auto fileName = luaL_checkstring(L, 1);
+        if (!profiler::Manager::Instance().WriteChromeTrace(fileName)) {
+            std::string err = MMC_LUA_MMPROFILERWRITETRACE ": cannot write file '";
+            err += fileName;
+            err += "'.";
+            lua_pushstring(L, err.c_str());
+            lua_error(L);
+        }
+    }
+    return 0;
+}
@@ -819,6 +819,24 @@ MEGAMOLCORE_API void MEGAMOLCORE_CALL mmcTerminateJob(void *hJob) {
 }
 
 
+/*
+ * mmcGetJobProgress
+ */
+MEGAMOLCORE_API bool MEGAMOLCORE_CALL mmcGetJobProgress(void *hJob,
+        float *progress, unsigned long long *bytes) {
+    megamol::core::JobInstance *job
+        = megamol::core::ApiHandle::InterpretHandle<
+        megamol::core::JobInstance>(hJob);
+    if ((job == NULL) || (job->Job() == NULL)) return false;
+    float p = 0.0f;
+    UINT64 b = 0;
+    if (!job->Job()->GetProgress(p, b)) return false;
+    if (progress != NULL) *progress = p;
+    if (bytes != NULL) *bytes = static_cast<unsigned long long>(b);
+    return true;
+}
+
+
 /*
  * mmcSetParameterA
  */
@@ -10,6 +10,8 @@
 #include "mmcore/Module.h"
 #include "mmcore/AbstractSlot.h"
 #include "mmcore/CoreInstance.h"
+#include "mmcore/param/ParamSlot.h"
+#include <algorithm>
 #include <typeinfo>
 #include "vislib/assert.h"
 #include "vislib/sys/AutoLock.h"
@@ -29,7 +31,8 @@ using namespace megamol::core;
 /*
  * Module::Module
  */
-Module::Module(void) : AbstractNamedObjectContainer(), created(false) {
+Module::Module(void) : AbstractNamedObjectContainer(), created(false), className(nullptr),
+        callableFromWorkerThreads(false), paramGeneration(0), paramGroupCallbacks() {
     // intentionally empty ATM
 }
 
@@ -231,6 +234,46 @@ void Module::SetSlotUnavailable(AbstractSlot *slot) {
 
 
 
+/*
+ * Module::AddParamGroupCallback
+ */
+void Module::AddParamGroupCallback(const std::vector<param::ParamSlot*>& slots,
+        const std::function<void(param::ParamSlot&)>& callback) {
+    if (!callback) {
+        throw vislib::IllegalParamException("callback", __FILE__, __LINE__);
+    }
+    ParamGroupCallback group;
+    group.slots.assign(slots.begin(), slots.end());
+    group.callback = callback;
+    this->paramGroupCallbacks.push_back(group);
+}
+
+
+/*
+ * Module::paramGroupGeneration
+ */
+size_t Module::paramGroupGeneration(const std::vector<const param::ParamSlot*>& slots) {
+    size_t generation = 0;
+    for (const param::ParamSlot* slot : slots) {
+        generation += slot->Generation();
+    }
+    return generation;
+}
+
+
+/*
+ * Module::paramUpdated
+ */
+void Module::paramUpdated(param::ParamSlot& slot) {
+    ++this->paramGeneration;
+    for (const ParamGroupCallback& group : this->paramGroupCallbacks) {
+        if (std::find(group.slots.begin(), group.slots.end(), &slot) != group.slots.end()) {
+            group.callback(slot);
+        }
+    }
+}
+
+
 /*
  * Module::setModuleName
  */
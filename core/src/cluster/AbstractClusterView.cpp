@@ -10,9 +10,11 @@
 #include "mmcore/CoreInstance.h"
 #include "mmcore/cluster/InfoIconRenderer.h"
 #include "mmcore/cluster/NetMessages.h"
+#include "mmcore/cluster/ParamReplicationLog.h"
 #include "mmcore/param/StringParam.h"
 #include "mmcore/view/AbstractView.h"
 #include "vislib/RawStorageSerialiser.h"
+#include "vislib/UTF8Encoder.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
 #include "vislib/net/IPCommEndPoint.h"
 #include "vislib/net/IPEndPoint.h"
@@ -80,7 +82,8 @@ cluster::AbstractClusterView::AbstractClusterView(void)
     , lastPingTime(0)
     , serverAddressSlot("serverAddress", "The TCP/IP address of the server including the port")
     , setupState(SETUP_UNKNOWN)
-    , graphInitData(NULL) {
+    , graphInitData(NULL)
+    , paramVersion(0) {
 
     this->ccc.AddListener(this);
     this->MakeSlotAvailable(&this->ccc.RegisterSlot());
@@ -359,6 +362,7 @@ void cluster::AbstractClusterView::OnCommChannelMessage(
             this->GetCoreInstance()->CleanupModuleGraph();
 
             this->graphInitData = new vislib::net::SimpleMessage(msg);
+            this->paramVersion = 0;
 
         } else {
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to setup module graph: still pending init data\n");
@@ -405,6 +409,25 @@ void cluster::AbstractClusterView::OnCommChannelMessage(
         }
     } break;
 
+    case cluster::netmessages::MSG_SET_PARAMVALUES: {
+        UINT64 version;
+        std::vector<ParamReplicationLog::Entry> values;
+        if (!ParamReplicationLog::Deserialise(msg.GetBody(), msg.GetHeader().GetBodySize(), version, values)) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Malformed parameter values message ignored\n");
+            break;
+        }
+        if (version <= this->paramVersion) break; // already contained in a snapshot
+        this->paramVersion = version;
+        for (const auto& v : values) {
+            AbstractNamedObject::ptr_type p = this->FindNamedObject(v.first, true);
+            param::ParamSlot* ps = dynamic_cast<param::ParamSlot*>(p.get());
+            vislib::TString value;
+            if ((ps != NULL) && vislib::UTF8Encoder::Decode(value, v.second)) {
+                ps->Parameter()->ParseValue(value);
+            }
+        }
+    } break;
+
     default:
         Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Unhandled message received: %u\n",
             static_cast<unsigned int>(msg.GetHeader().GetMessageID()));
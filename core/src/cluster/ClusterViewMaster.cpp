@@ -50,6 +50,7 @@ cluster::ClusterViewMaster::ClusterViewMaster(void)
     , serverEndPoint()
     , sanityCheckTimeSlot("RemoteView::sanityCheckTime", "Runs a time sync sanity check on all cluster nodes.")
     , camUpdateThread(&ClusterViewMaster::cameraUpdateThread)
+    , paramLog()
     , pauseRemoteViewSlot("RemoteView::Pause", "Enters remote view pause mode")
     , resumeRemoteViewSlot("RemoteView::Resume", "Resumes from remote view pause mode")
     , forceNetVSyncOnSlot("RemoteView::NetVSyncOn", "Forces network v-sync on")
@@ -409,6 +410,17 @@ void cluster::ClusterViewMaster::OnCommChannelMessage(
             channel.SendMessage(cmsg);
         }
 
+        // the graph of a joining node has the initial values only
+        std::vector<ParamReplicationLog::Entry> values;
+        UINT64 version = this->paramLog.Snapshot(values);
+        if (!values.empty()) {
+            std::vector<char> body;
+            ParamReplicationLog::Serialise(version, values, body);
+            outMsg.GetHeader().SetMessageID(cluster::netmessages::MSG_SET_PARAMVALUES);
+            outMsg.SetBody(body.data(), body.size());
+            channel.SendMessage(outMsg);
+        }
+
     } break;
 
     case cluster::netmessages::MSG_NETVSYNC_JOIN: {
@@ -426,23 +438,10 @@ void cluster::ClusterViewMaster::OnCommChannelMessage(
  * cluster::ClusterViewMaster::ParamUpdated
  */
 void cluster::ClusterViewMaster::ParamUpdated(param::ParamSlot& slot) {
-    if (!this->ctrlServer.IsRunning()) return;
-
-    vislib::net::SimpleMessage msg;
-    msg.GetHeader().SetMessageID(cluster::netmessages::MSG_SET_PARAMVALUE);
-    vislib::StringA name = slot.FullName();
-    vislib::StringA::Size nameL = name.Length() + 1;
+    // sent coalesced by the camera update thread, and as snapshot to joining nodes
     vislib::StringA value;
-    vislib::StringA::Size valueL;
     vislib::UTF8Encoder::Encode(value, slot.Parameter()->ValueString());
-    valueL = value.Length() + 1;
-
-    msg.GetHeader().SetBodySize(nameL + valueL);
-    msg.AssertBodySize();
-    ::memcpy(msg.GetBody(), name.PeekBuffer(), nameL);
-    ::memcpy(msg.GetBodyAsAt<void>(nameL), value.PeekBuffer(), valueL);
-
-    this->ctrlServer.MultiSendMessage(msg);
+    this->paramLog.Record(slot.FullName(), value);
 }
 
 
@@ -460,6 +459,9 @@ DWORD cluster::ClusterViewMaster::cameraUpdateThread(void* userData) {
     mem.AssertSize(sizeof(vislib::net::SimpleMessageHeaderData));
     vislib::RawStorageSerialiser serialiser(&mem, sizeof(vislib::net::SimpleMessageHeaderData));
     vislib::net::ShallowSimpleMessage msg(mem);
+    std::vector<ParamReplicationLog::Entry> changes;
+    std::vector<char> changesBody;
+    UINT64 changesVersion;
 
     while (true) {
         av = NULL;
@@ -488,6 +490,14 @@ DWORD cluster::ClusterViewMaster::cameraUpdateThread(void* userData) {
             This->ctrlServer.MultiSendMessage(msg);
         }
 
+        if (This->ctrlServer.IsRunning() && This->paramLog.TakeChanges(changesVersion, changes)) {
+            ParamReplicationLog::Serialise(changesVersion, changes, changesBody);
+            vislib::net::SimpleMessage pmsg;
+            pmsg.GetHeader().SetMessageID(cluster::netmessages::MSG_SET_PARAMVALUES);
+            pmsg.SetBody(changesBody.data(), changesBody.size());
+            This->ctrlServer.MultiSendMessage(pmsg);
+        }
+
         vislib::sys::Thread::Sleep(1000 / 60); // ~60 fps
     }
 
@@ -0,0 +1,118 @@
+/*
+ * ParamReplicationLog.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/cluster/ParamReplicationLog.h"
+#include <cstring>
+
+using namespace megamol::core;
+
+
+/*
+ * cluster::ParamReplicationLog::ParamReplicationLog
+ */
+cluster::ParamReplicationLog::ParamReplicationLog(void) : lock(), version(0), values(), changes() {
+    // intentionally empty
+}
+
+
+/*
+ * cluster::ParamReplicationLog::~ParamReplicationLog
+ */
+cluster::ParamReplicationLog::~ParamReplicationLog(void) {
+    // intentionally empty
+}
+
+
+/*
+ * cluster::ParamReplicationLog::Record
+ */
+void cluster::ParamReplicationLog::Record(const vislib::StringA& name, const vislib::StringA& value) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    std::string n(name.PeekBuffer());
+    std::string v(value.PeekBuffer());
+    this->values[n] = v;
+    this->changes[n] = v;
+}
+
+
+/*
+ * cluster::ParamReplicationLog::TakeChanges
+ */
+bool cluster::ParamReplicationLog::TakeChanges(UINT64& outVersion, std::vector<Entry>& outChanges) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    outChanges.clear();
+    if (this->changes.empty()) return false;
+    outChanges.reserve(this->changes.size());
+    for (const auto& c : this->changes) {
+        outChanges.push_back(Entry(c.first.c_str(), c.second.c_str()));
+    }
+    this->changes.clear();
+    outVersion = ++this->version;
+    return true;
+}
+
+
+/*
+ * cluster::ParamReplicationLog::Snapshot
+ */
+UINT64 cluster::ParamReplicationLog::Snapshot(std::vector<Entry>& outValues) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    outValues.clear();
+    outValues.reserve(this->values.size());
+    for (const auto& v : this->values) {
+        outValues.push_back(Entry(v.first.c_str(), v.second.c_str()));
+    }
+    // changes not taken yet are part of the snapshot, so sending them later is redundant only
+    return this->version;
+}
+
+
+/*
+ * cluster::ParamReplicationLog::Serialise
+ */
+void cluster::ParamReplicationLog::Serialise(
+        UINT64 version, const std::vector<Entry>& values, std::vector<char>& outBody) {
+    SIZE_T size = sizeof(UINT64);
+    for (const Entry& e : values) {
+        size += e.first.Length() + e.second.Length() + 2;
+    }
+    outBody.resize(size);
+    ::memcpy(outBody.data(), &version, sizeof(UINT64));
+    char *p = outBody.data() + sizeof(UINT64);
+    for (const Entry& e : values) {
+        ::memcpy(p, e.first.PeekBuffer(), e.first.Length() + 1);
+        p += e.first.Length() + 1;
+        ::memcpy(p, e.second.PeekBuffer(), e.second.Length() + 1);
+        p += e.second.Length() + 1;
+    }
+}
+
+
+/*
+ * cluster::ParamReplicationLog::Deserialise
+ */
+bool cluster::ParamReplicationLog::Deserialise(
+        const void *body, SIZE_T size, UINT64& outVersion, std::vector<Entry>& outValues) {
+    outValues.clear();
+    if ((body == NULL) || (size < sizeof(UINT64))) return false;
+    const char *p = static_cast<const char*>(body);
+    const char *end = p + size;
+    ::memcpy(&outVersion, p, sizeof(UINT64));
+    p += sizeof(UINT64);
+    while (p < end) {
+        const char *name = p;
+        const char *nameEnd = static_cast<const char*>(::memchr(name, 0, end - name));
+        if (nameEnd == NULL) return false;
+        const char *value = nameEnd + 1;
+        const char *valueEnd = static_cast<const char*>(::memchr(value, 0, end - value));
+        if ((value >= end) || (valueEnd == NULL)) return false;
+        outValues.push_back(Entry(name, value));
+        p = valueEnd + 1;
+    }
+    return true;
+}
@@ -100,10 +100,13 @@ megamol::core::cluster::mpi::View::View(void)
     , mpiRank(-1)
     , mpiSize(-1)
     , mustNegotiateMaster(true)
+    , paramDataParallel("dataParallel", "Render only the local partition of the data and composite by depth.")
     , paramUseGsync("useGsync", "Try to synchronise buffer swaps if possible.")
     , relayOffset(0) {
 #ifdef WITH_MPI
     this->comm = MPI_COMM_NULL;
+    this->compositeOp = MPI_OP_NULL;
+    this->compositeType = MPI_DATATYPE_NULL;
 #endif /* WITH_MPI */
 
     this->callRequestMpi.SetCompatibleCall<MpiCallDescription>();
@@ -114,6 +117,9 @@ megamol::core::cluster::mpi::View::View(void)
 
     this->hasMasterConnection.store(false);
 
+    this->paramDataParallel << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->paramDataParallel);
+
     this->paramUseGsync << new param::BoolParam(false);
     this->MakeSlotAvailable(&this->paramUseGsync);
 }
@@ -197,6 +203,7 @@ void megamol::core::cluster::mpi::View::Render(const mmcRenderViewContext& conte
     ::ZeroMemory(&state, sizeof(state));
     state.Time = context.Time;
     state.InstanceTime = context.InstanceTime;
+    state.DataParallel = this->paramDataParallel.Param<param::BoolParam>()->Value();
 
     /* Ensure that we know where to get the status from. */
     if (!this->knowsBcastMaster()) {
@@ -274,6 +281,9 @@ void megamol::core::cluster::mpi::View::Render(const mmcRenderViewContext& conte
 #endif /* WITH_MPI */
     }  /* if (this->knowsBcastMaster() && (this->mpiSize > 1)) */
 
+    // The mode of the master is used everywhere, as compositing is collective.
+    const bool dataParallel = state.DataParallel && this->knowsBcastMaster() && (this->mpiSize > 1);
+
 
     // Post-process status
     if (state.RelaySize > 0) {
@@ -422,7 +432,13 @@ void megamol::core::cluster::mpi::View::Render(const mmcRenderViewContext& conte
                 this->getTileW(), this->getTileH());
         }
 
-        crv->SetOutputBuffer(GL_BACK, this->getViewportWidth(), this->getViewportHeight());
+        if (dataParallel) {
+            if (!this->renderDataParallel(*crv)) {
+                this->renderFallbackView();
+            }
+
+        } else {
+            crv->SetOutputBuffer(GL_BACK, this->getViewportWidth(), this->getViewportHeight());
 
         // view::AbstractView *view = NULL;
         // if (crv->PeekCalleeSlot() != NULL) view = dynamic_cast<view::AbstractView*>(
@@ -436,8 +452,9 @@ void megamol::core::cluster::mpi::View::Render(const mmcRenderViewContext& conte
         //{
         //    vislib::sys::AutoLock lock(renderLock);
 
-        if (!(*crv)(view::CallRenderView::CALL_RENDER)) {
-            this->renderFallbackView();
+            if (!(*crv)(view::CallRenderView::CALL_RENDER)) {
+                this->renderFallbackView();
+            }
         }
 
         //::glFlush();
@@ -599,6 +616,22 @@ megamol::core::cluster::mpi::View::SwapGroupApi::SwapGroupApi(void) : isAvailabl
 }
 
 
+#ifdef WITH_MPI
+/*
+ * megamol::core::cluster::mpi::View::compositePixels
+ */
+void megamol::core::cluster::mpi::View::compositePixels(void* in, void* inout, int* len, MPI_Datatype* type) {
+    const CompositePixel* src = static_cast<const CompositePixel*>(in);
+    CompositePixel* dst = static_cast<CompositePixel*>(inout);
+    for (int i = 0; i < *len; ++i) {
+        if ((src[i].Depth < dst[i].Depth) || ((src[i].Depth == dst[i].Depth) && (src[i].Colour < dst[i].Colour))) {
+            dst[i] = src[i];
+        }
+    }
+}
+#endif /* WITH_MPI */
+
+
 /*
  * megamol::core::cluster::mpi::View::create
  */
@@ -850,11 +883,112 @@ void megamol::core::cluster::mpi::View::release(void) {
         SwapGroupApi::GetInstance().BindSwapBarrier(1, 0);
         SwapGroupApi::GetInstance().JoinSwapGroup(0);
     }
+    this->compositeFbo.Release();
+#ifdef WITH_MPI
+    if (this->compositeOp != MPI_OP_NULL) {
+        ::MPI_Op_free(&this->compositeOp);
+        ::MPI_Type_free(&this->compositeType);
+    }
+#endif /* WITH_MPI */
     this->finaliseMpi();
     Base1::release();
 }
 
 
+/*
+ * megamol::core::cluster::mpi::View::renderDataParallel
+ */
+bool megamol::core::cluster::mpi::View::renderDataParallel(view::CallRenderView& crv) {
+    bool retval = false;
+#ifdef WITH_MPI
+    CompositeTile local;
+    local.Width = this->getViewportWidth();
+    local.Height = this->getViewportHeight();
+    if (this->hasTile()) {
+        local.VirtWidth = this->getVirtWidth();
+        local.VirtHeight = this->getVirtHeight();
+        local.TileX = this->getTileX();
+        local.TileY = this->getTileY();
+        local.TileW = this->getTileW();
+        local.TileH = this->getTileH();
+    } else {
+        local.VirtWidth = local.TileW = static_cast<float>(local.Width);
+        local.VirtHeight = local.TileH = static_cast<float>(local.Height);
+        local.TileX = local.TileY = 0.0f;
+    }
+
+    std::vector<CompositeTile> tiles(this->mpiSize);
+    ::MPI_Allgather(&local, sizeof(CompositeTile), MPI_BYTE, tiles.data(), sizeof(CompositeTile), MPI_BYTE,
+        this->comm);
+
+    if (this->compositeOp == MPI_OP_NULL) {
+        ::MPI_Type_contiguous(sizeof(CompositePixel), MPI_BYTE, &this->compositeType);
+        ::MPI_Type_commit(&this->compositeType);
+        ::MPI_Op_create(&View::compositePixels, 1, &this->compositeOp);
+    }
+
+    // Every rank renders its partition into all tiles, one after the other,
+    // and the partial images are reduced onto the owner of the tile.
+    for (int r = 0; r < this->mpiSize; ++r) {
+        const CompositeTile& t = tiles[r];
+        const size_t cnt = static_cast<size_t>(t.Width) * t.Height;
+        if (cnt == 0) continue;
+
+        if (!this->compositeFbo.IsValid() || (this->compositeFbo.GetWidth() != t.Width) ||
+            (this->compositeFbo.GetHeight() != t.Height)) {
+            this->compositeFbo.Release();
+            if (!this->compositeFbo.Create(t.Width, t.Height)) {
+                vislib::sys::Log::DefaultLog.WriteError(
+                    "Rank %d could not create the %ux%u compositing framebuffer.\n", this->mpiRank, t.Width, t.Height);
+            }
+        }
+
+        std::vector<UINT32> colours(cnt, 0);
+        std::vector<float> depths(cnt, 1.0f);
+        if (this->compositeFbo.IsValid()) {
+            crv.SetTile(t.VirtWidth, t.VirtHeight, t.TileX, t.TileY, t.TileW, t.TileH);
+            crv.SetOutputBuffer(&this->compositeFbo);
+            if (crv(view::CallRenderView::CALL_RENDER)) {
+                this->compositeFbo.Enable();
+                ::glPixelStorei(GL_PACK_ALIGNMENT, 1);
+                ::glReadPixels(0, 0, t.Width, t.Height, GL_RGBA, GL_UNSIGNED_BYTE, colours.data());
+                ::glReadPixels(0, 0, t.Width, t.Height, GL_DEPTH_COMPONENT, GL_FLOAT, depths.data());
+                this->compositeFbo.Disable();
+            }
+        }
+        // A rank that could not render contributes background at the far plane.
+
+        this->compositeBuffer.resize(cnt);
+        for (size_t i = 0; i < cnt; ++i) {
+            this->compositeBuffer[i].Depth = depths[i];
+            this->compositeBuffer[i].Colour = colours[i];
+        }
+        if (r == this->mpiRank) {
+            this->compositeResult.resize(cnt);
+        }
+        ::MPI_Reduce(this->compositeBuffer.data(), (r == this->mpiRank) ? this->compositeResult.data() : nullptr,
+            static_cast<int>(cnt), this->compositeType, this->compositeOp, r, this->comm);
+    }
+
+    const size_t localCnt = static_cast<size_t>(local.Width) * local.Height;
+    if ((localCnt > 0) && (this->compositeResult.size() == localCnt)) {
+        std::vector<UINT32> colours(this->compositeResult.size());
+        for (size_t i = 0; i < colours.size(); ++i) {
+            colours[i] = this->compositeResult[i].Colour;
+        }
+        ::glDrawBuffer(GL_BACK);
+        ::glViewport(0, 0, local.Width, local.Height);
+        ::glDisable(GL_DEPTH_TEST);
+        ::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        ::glWindowPos2i(0, 0);
+        ::glDrawPixels(local.Width, local.Height, GL_RGBA, GL_UNSIGNED_BYTE, colours.data());
+        retval = true;
+    }
+#endif /* WITH_MPI */
+    return retval;
+}
+
+
 /*
  * megamol::core::cluster::mpi::View::storeMessageForRelay
  */
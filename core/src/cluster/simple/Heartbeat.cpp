@@ -10,11 +10,13 @@
 #include "mmcore/cluster/simple/ClientViewRegistration.h"
 #include "mmcore/cluster/simple/Client.h"
 #include "mmcore/param/IntParam.h"
+#include "mmcore/param/StringParam.h"
 #include "mmcore/CoreInstance.h"
 #include "vislib/assert.h"
 #include "vislib/sys/AutoLock.h"
 #include "vislib/sys/Log.h"
 #include "vislib/net/IPCommEndPoint.h"
+#include "vislib/net/SocketException.h"
 #include "vislib/net/TcpCommChannel.h"
 #include "vislib/Trace.h"
 #include <climits>
@@ -133,7 +135,9 @@ cluster::simple::Heartbeat::Heartbeat(void)
         : job::AbstractThreadedJob(), Module(),
         registerSlot("register", "The slot registering this view"), client(NULL), run(false), mainlock(),
         heartBeatPortSlot("heartbeat::port", "The port the heartbeat server communicates on"),
-        tcBuf(), tcBufIdx(0), server(), connLock(), connList(), tier(1) {
+        tcBuf(), tcBufIdx(0), server(), connLock(), connList(), tier(1),
+        heartBeatMulticastSlot("heartbeat::multicast", "The multicast group releasing the tiles (empty for TCP only)"),
+        udpRun(false), udpSocket(), udpReceiver(&Heartbeat::udpReceive), udpGroup(), udpWaiting() {
     vislib::net::Socket::Startup();
 
     this->registerSlot.SetCompatibleCall<ClientViewRegistrationDescription>();
@@ -142,8 +146,17 @@ cluster::simple::Heartbeat::Heartbeat(void)
     this->heartBeatPortSlot << new param::IntParam(0, 0, USHRT_MAX);
     this->MakeSlotAvailable(&this->heartBeatPortSlot);
 
+    this->heartBeatMulticastSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->heartBeatMulticastSlot);
+
     this->server.AddListener(this);
 
+    ::memcpy(this->udpLast.magic, "MMB", 3);
+    this->udpLast.msg = MSG_HEARTBEAT_GO;
+    this->udpLast.tier = 0;
+    this->udpLast.seq = 0;
+    this->udpLast.size = 0;
+
     this->tcBuf[0].isValid = false;
     this->tcBuf[1].isValid = false;
 
@@ -168,6 +181,7 @@ bool cluster::simple::Heartbeat::Terminate(void) {
         this->server.Terminate();
         this->server.Join();
     }
+    this->closeMulticast();
     this->mainlock.Set();
     return true; // will terminate as soon as possible
 }
@@ -297,6 +311,10 @@ bool cluster::simple::Heartbeat::create(void) {
                 "Failed to load heartbeat port configuration: Unknown exception\n");
         }
     }
+    if (this->GetCoreInstance()->Configuration().IsConfigValueSet("scv-heartbeat-multicast")) {
+        this->heartBeatMulticastSlot.Param<param::StringParam>()->SetValue(
+            this->GetCoreInstance()->Configuration().ConfigValue("scv-heartbeat-multicast"));
+    }
 
     return true;
 }
@@ -310,6 +328,7 @@ void cluster::simple::Heartbeat::release(void) {
         this->server.Terminate();
         this->server.Join();
     }
+    this->closeMulticast();
 
     if (this->client != NULL) {
         this->client->Unregister(this);
@@ -358,8 +377,9 @@ DWORD cluster::simple::Heartbeat::Run(void *userData) {
     while (this->run) {
         if (this->client == NULL) break;
 
-        if (this->heartBeatPortSlot.IsDirty()) {
+        if (this->heartBeatPortSlot.IsDirty() || this->heartBeatMulticastSlot.IsDirty()) {
             this->heartBeatPortSlot.ResetDirty();
+            this->heartBeatMulticastSlot.ResetDirty();
 
             if (this->server.IsRunning()) {
                 this->server.Terminate();
@@ -378,6 +398,8 @@ DWORD cluster::simple::Heartbeat::Run(void *userData) {
             this->server.Start(&cfg);
             vislib::sys::Thread::Sleep(100);
 
+            this->openMulticast();
+
         }
 
         if (!this->client->RequestTCUpdate()) {
@@ -453,37 +475,62 @@ void cluster::simple::Heartbeat::connWaiting(Connection *con) {
         if (iter.Next()->IsWaiting()) w++;
     }
 
+    // tiles synchronising via multicast keep their connection, but do not wait on it
+    w += this->udpWaiting.Count();
+
     VLTRACE(VISLIB_TRCELVL_INFO, "Heartbeat connections waiting: %u/%u\n", w, a);
 
     if ((w >= a) && (a > 0)) {
 
         // two-tier sync
+        unsigned char releasedTier = this->tier;
         this->tier = 3 - this->tier;
 
-        iter = this->connList.GetIterator();
-
+        vislib::RawStorage payload;
         {
             TCBuffer& buf = this->tcBuf[this->tcBufIdx];
             vislib::sys::AutoLock(buf.lock);
 
-            while (iter.HasNext()) {
-                vislib::RawStorage& data = iter.Next()->Data();
-                if (buf.isValid) {
-                    data.AssertSize(1 + sizeof(double) + sizeof(float) + buf.camera.GetSize());
-                    *data.As<unsigned char>() = 1; // Do a two-tier sync
-                    *data.AsAt<double>(1) = buf.instTime;
-                    *data.AsAt<float>(1 + sizeof(double)) = buf.time;
-                    ::memcpy(data.At(1 + sizeof(double) + sizeof(float)), buf.camera, buf.camera.GetSize());
-                } else {
-                    data.AssertSize(1 + sizeof(double) + sizeof(float));
-                    *data.As<unsigned char>() = 1; // Do a two-tier sync
-                    *data.AsAt<double>(1) = this->GetCoreInstance()->GetCoreInstanceTime();
-                    *data.AsAt<float>(1 + sizeof(double)) = 0.0f;
-                }
+            if (buf.isValid) {
+                payload.AssertSize(1 + sizeof(double) + sizeof(float) + buf.camera.GetSize());
+                *payload.As<unsigned char>() = 1; // Do a two-tier sync
+                *payload.AsAt<double>(1) = buf.instTime;
+                *payload.AsAt<float>(1 + sizeof(double)) = buf.time;
+                ::memcpy(payload.At(1 + sizeof(double) + sizeof(float)), buf.camera, buf.camera.GetSize());
+            } else {
+                payload.AssertSize(1 + sizeof(double) + sizeof(float));
+                *payload.As<unsigned char>() = 1; // Do a two-tier sync
+                *payload.AsAt<double>(1) = this->GetCoreInstance()->GetCoreInstanceTime();
+                *payload.AsAt<float>(1 + sizeof(double)) = 0.0f;
             }
 
         }
 
+        iter = this->connList.GetIterator();
+        while (iter.HasNext()) {
+            iter.Next()->Data() = payload;
+        }
+
+        if (this->udpSocket.IsValid()) {
+            SIZE_T size = payload.GetSize();
+            if (size > HEARTBEATPAYLOADSIZE) {
+                // drop the camera, the tiles keep their last one
+                size = 1 + sizeof(double) + sizeof(float);
+                vislib::sys::Log::DefaultLog.WriteWarn("Heartbeat: camera data too large for multicast");
+            }
+            this->udpLast.tier = releasedTier;
+            this->udpLast.seq++;
+            this->udpLast.size = static_cast<UINT16>(size);
+            ::memcpy(this->udpLast.payload, payload, size);
+            this->udpWaiting.Clear();
+            try {
+                this->udpSocket.Send(this->udpGroup, &this->udpLast, HEARTBEATDATAGRAMSIZE(this->udpLast));
+            } catch(vislib::Exception ex) {
+                vislib::sys::Log::DefaultLog.WriteError("Heartbeat: multicast failed: %s [%s, %d]",
+                    ex.GetMsgA(), ex.GetFile(), ex.GetLine());
+            }
+        }
+
         iter = this->connList.GetIterator();
         while (iter.HasNext()) {
             iter.Next()->Continue();
@@ -492,3 +539,120 @@ void cluster::simple::Heartbeat::connWaiting(Connection *con) {
     }
 
 }
+
+
+/*
+ * cluster::simple::Heartbeat::openMulticast
+ */
+void cluster::simple::Heartbeat::openMulticast(void) {
+    this->closeMulticast();
+
+    vislib::StringA group(this->heartBeatMulticastSlot.Param<param::StringParam>()->Value());
+    int port = this->heartBeatPortSlot.Param<param::IntParam>()->Value();
+    if (group.IsEmpty() || (port <= 0) || (port >= USHRT_MAX)) return;
+
+    try {
+        vislib::net::IPAddress addr;
+        if (!addr.Lookup(group)) {
+            throw vislib::Exception("Cannot resolve multicast group", __FILE__, __LINE__);
+        }
+        // the releases are sent to the port above the heartbeat port, see HeartbeatClient
+        this->udpGroup = vislib::net::IPEndPoint(addr, static_cast<unsigned short>(port + 1));
+
+        this->udpSocket.Create(vislib::net::Socket::FAMILY_INET,
+            vislib::net::Socket::TYPE_DGRAM,
+            vislib::net::Socket::PROTOCOL_UDP);
+        this->udpSocket.SetReuseAddr(true);
+        this->udpSocket.Bind(vislib::net::IPEndPoint(vislib::net::IPAddress::ANY, static_cast<unsigned short>(port)));
+        this->udpRun = true;
+        this->udpReceiver.Start(static_cast<void*>(this));
+        vislib::sys::Log::DefaultLog.WriteInfo("Heartbeat multicast to %s",
+            this->udpGroup.ToStringA().PeekBuffer());
+
+    } catch(vislib::Exception ex) {
+        vislib::sys::Log::DefaultLog.WriteError("Failed to start heartbeat multicast: %s [%s, %d]",
+            ex.GetMsgA(), ex.GetFile(), ex.GetLine());
+        this->closeMulticast();
+    } catch(...) {
+        vislib::sys::Log::DefaultLog.WriteError("Failed to start heartbeat multicast: Unexpected Exception");
+        this->closeMulticast();
+    }
+}
+
+
+/*
+ * cluster::simple::Heartbeat::closeMulticast
+ */
+void cluster::simple::Heartbeat::closeMulticast(void) {
+    this->udpRun = false;
+    try {
+        this->udpSocket.Close();
+    } catch(...) {
+    }
+    if (this->udpReceiver.IsRunning()) {
+        this->udpReceiver.Join();
+    }
+    vislib::sys::AutoLock lock(this->connLock);
+    this->udpWaiting.Clear();
+}
+
+
+/*
+ * cluster::simple::Heartbeat::udpReceive
+ */
+DWORD cluster::simple::Heartbeat::udpReceive(void *userData) {
+    Heartbeat *that = static_cast<Heartbeat *>(userData);
+    HeartbeatDatagram dg;
+    vislib::net::IPEndPoint from;
+
+    vislib::net::Socket::Startup();
+    try {
+        while (that->udpRun && that->udpSocket.IsValid()) {
+            SIZE_T size = 0;
+            try {
+                // poll, as closing the socket does not end a blocking receive everywhere
+                size = that->udpSocket.Receive(from, &dg, sizeof(dg), 500);
+            } catch(vislib::net::SocketException sex) {
+                if (sex.IsTimeout()) continue;
+                throw;
+            }
+            if ((size < offsetof(HeartbeatDatagram, payload)) || (::memcmp(dg.magic, "MMB", 3) != 0)
+                    || (dg.msg != MSG_HEARTBEAT_READY)) {
+                continue;
+            }
+
+            vislib::sys::AutoLock lock(that->connLock);
+            if (dg.seq <= that->udpLast.seq) {
+                // the tile missed the release, the others ignore it by its number
+                that->udpSocket.Send(that->udpGroup, &that->udpLast, HEARTBEATDATAGRAMSIZE(that->udpLast));
+
+            } else if (dg.tier != that->tier) {
+                // wrong tier, reject with an empty release of the tier waited on
+                HeartbeatDatagram reject;
+                ::memcpy(reject.magic, "MMB", 3);
+                reject.msg = MSG_HEARTBEAT_GO;
+                reject.tier = that->tier;
+                reject.seq = that->udpLast.seq + 1;
+                reject.size = 0;
+                that->udpSocket.Send(that->udpGroup, &reject, HEARTBEATDATAGRAMSIZE(reject));
+
+            } else if (!that->udpWaiting.Contains(from)) {
+                that->udpWaiting.Add(from);
+                that->connWaiting(NULL);
+            }
+        }
+    } catch(vislib::net::SocketException sex) {
+        // closing the socket ends the thread
+        if (that->udpRun) {
+            vislib::sys::Log::DefaultLog.WriteError("Heartbeat multicast receiver: %s", sex.GetMsgA());
+        }
+    } catch(vislib::Exception ex) {
+        vislib::sys::Log::DefaultLog.WriteError("Heartbeat multicast receiver: %s [%s, %d]",
+            ex.GetMsgA(), ex.GetFile(), ex.GetLine());
+    } catch(...) {
+        vislib::sys::Log::DefaultLog.WriteError("Heartbeat multicast receiver: Unexpected Exception");
+    }
+    vislib::net::Socket::Cleanup();
+
+    return 0;
+}
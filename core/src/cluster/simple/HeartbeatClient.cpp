@@ -7,10 +7,12 @@
 
 #include "stdafx.h"
 #include "mmcore/cluster/simple/HeartbeatClient.h"
+#include "mmcore/cluster/simple/CommUtil.h"
 #include "vislib/assert.h"
 #include "vislib/net/IPCommEndPoint.h"
 #include "vislib/sys/Log.h"
 #include "vislib/net/Socket.h"
+#include "vislib/net/SocketException.h"
 
 using namespace megamol::core;
 
@@ -19,7 +21,7 @@ using namespace megamol::core;
  * cluster::simple::HeartbeatClient::HeartbeatClient
  */
 cluster::simple::HeartbeatClient::HeartbeatClient(void) : chan(),
-        conn(&HeartbeatClient::connector), port(0), server() {
+        conn(&HeartbeatClient::connector), port(0), server(), group(), udpSocket(), udpServer(), udpSeq(0) {
     vislib::net::Socket::Startup();
 }
 
@@ -36,10 +38,12 @@ cluster::simple::HeartbeatClient::~HeartbeatClient(void) {
 /*
  * cluster::simple::HeartbeatClient::Connect
  */
-void cluster::simple::HeartbeatClient::Connect(vislib::StringW server, unsigned int port) {
+void cluster::simple::HeartbeatClient::Connect(vislib::StringW server, unsigned int port,
+        const vislib::StringA& multicastGroup) {
     this->Shutdown();
     this->server = server;
     this->port = port;
+    this->group = multicastGroup;
     this->conn.Start(static_cast<void*>(this));
 }
 
@@ -48,6 +52,10 @@ void cluster::simple::HeartbeatClient::Connect(vislib::StringW server, unsigned
  * cluster::simple::HeartbeatClient::Shutdown
  */
 void cluster::simple::HeartbeatClient::Shutdown(void) {
+    try {
+        this->udpSocket.Close();
+    } catch(...) {
+    }
     if (!this->chan.IsNull()) {
         this->chan->Close();
         if (this->conn.IsRunning()) {
@@ -66,7 +74,10 @@ bool cluster::simple::HeartbeatClient::Sync(unsigned char tier, vislib::RawStora
     const_cast<char *>(outData)[3] = static_cast<char>(tier);
 
     try {
-        if (!this->chan.IsNull()) {
+        if (!this->chan.IsNull() && this->udpSocket.IsValid()) {
+            return this->syncMulticast(tier, outPayload);
+
+        } else if (!this->chan.IsNull()) {
 
             if (this->chan->Send(outData, 4) != 4) throw vislib::Exception("heart attack", __FILE__, __LINE__);
             if (this->chan->Receive(&inSize, 4) != 4) throw vislib::Exception("heart attack", __FILE__, __LINE__);
@@ -121,18 +132,88 @@ DWORD cluster::simple::HeartbeatClient::connector(void *userData) {
         c->Connect(endPoint);
 
         Log::DefaultLog.WriteInfo("Connection to heartbeat server established\n");
+
+        if (!that->group.IsEmpty()) {
+            // the connection remains open to count this tile in the barriers
+            vislib::net::IPAddress groupAddr, serverAddr;
+            if (!groupAddr.Lookup(that->group) || !serverAddr.Lookup(vislib::StringA(server))) {
+                throw vislib::Exception("Cannot resolve the multicast heartbeat", __FILE__, __LINE__);
+            }
+            that->udpServer = vislib::net::IPEndPoint(serverAddr, port);
+            that->udpSeq = 0;
+            that->udpSocket.Create(vislib::net::Socket::FAMILY_INET,
+                vislib::net::Socket::TYPE_DGRAM,
+                vislib::net::Socket::PROTOCOL_UDP);
+            that->udpSocket.SetReuseAddr(true); // all tiles of a node receive the releases
+            that->udpSocket.Bind(vislib::net::IPEndPoint(vislib::net::IPAddress::ANY, port + 1));
+            that->udpSocket.JoinMulticastGroup(groupAddr);
+            Log::DefaultLog.WriteInfo("Synchronising to heartbeat multicast group %s\n", that->group.PeekBuffer());
+        }
+
         that->chan = c;
 
     } catch(vislib::Exception ex) {
         Log::DefaultLog.WriteError("Failed to connect to heartbeat server: %s [%s; %d]\n",
             ex.GetMsgA(), ex.GetFile(), ex.GetLine());
         that->chan = NULL;
+        try {
+            that->udpSocket.Close();
+        } catch(...) {
+        }
 
     } catch(...) {
         Log::DefaultLog.WriteError("Failed to connect to heartbeat server: unexpected exception\n");
         that->chan = NULL;
+        try {
+            that->udpSocket.Close();
+        } catch(...) {
+        }
 
     }
 
     return 0;
 }
+
+
+/*
+ * cluster::simple::HeartbeatClient::syncMulticast
+ */
+bool cluster::simple::HeartbeatClient::syncMulticast(unsigned char tier, vislib::RawStorage& outPayload) {
+    HeartbeatDatagram ready, go;
+    vislib::net::IPEndPoint from;
+    ::memcpy(ready.magic, "MMB", 3);
+    ready.msg = MSG_HEARTBEAT_READY;
+    ready.tier = tier;
+    ready.seq = this->udpSeq + 1;
+    ready.size = 0;
+
+    // a lost announcement or release is recovered by announcing again
+    for (unsigned int retry = 0; retry < 50; retry++) {
+        this->udpSocket.Send(this->udpServer, &ready, HEARTBEATDATAGRAMSIZE(ready));
+        try {
+            while (true) {
+                SIZE_T size = this->udpSocket.Receive(from, &go, sizeof(go), 100);
+                if ((size < offsetof(HeartbeatDatagram, payload)) || (::memcmp(go.magic, "MMB", 3) != 0)
+                        || (go.msg != MSG_HEARTBEAT_GO) || (size < HEARTBEATDATAGRAMSIZE(go))) {
+                    continue;
+                }
+                if (go.seq < ready.seq) continue; // resent for another tile
+                if (go.size == 0) {
+                    // rejects the tiles waiting on the other tier
+                    if (go.tier == tier) continue;
+                    return false;
+                }
+
+                this->udpSeq = go.seq;
+                if (go.tier != tier) return false;
+                outPayload.EnforceSize(go.size);
+                ::memcpy(outPayload, go.payload, go.size);
+                return (go.size > 12);
+            }
+        } catch(vislib::net::SocketException sex) {
+            if (!sex.IsTimeout()) throw;
+        }
+    }
+
+    return false;
+}
@@ -173,6 +173,14 @@ bool cluster::simple::Server::Client::OnMessageReceived(
         this->send(answer);
         this->parent.camUpdateThreadForce = true;
 
+        // the graph of the client has the initial values only
+        std::vector<ParamReplicationLog::Entry> values;
+        this->parent.paramLog.Snapshot(values);
+        for (const auto& v : values) {
+            Server::makeParamMessage(v, answer);
+            this->send(answer);
+        }
+
         /*          ** does not really work
                     const view::AbstractView *av = NULL;
                     Call *call = NULL;
@@ -307,7 +315,8 @@ cluster::simple::Server::Server(void)
     , clientsLock()
     , clients()
     , camUpdateThread(&Server::cameraUpdateThread)
-    , camUpdateThreadForce(false) {
+    , camUpdateThreadForce(false)
+    , paramLog() {
     vislib::net::Socket::Startup();
     this->udpTarget.SetPort(0); // marks illegal endpoint
 
@@ -481,18 +490,23 @@ bool cluster::simple::Server::OnNewConnection(
  * cluster::simple::Server::ParamUpdated
  */
 void cluster::simple::Server::ParamUpdated(param::ParamSlot& slot) {
-    vislib::net::SimpleMessage msg;
-    msg.GetHeader().SetMessageID(MSG_PARAMUPDATE);
-    vislib::StringA name = slot.FullName();
+    // sent coalesced by the camera update thread, and to newly connected views
     vislib::StringA value;
     vislib::UTF8Encoder::Encode(value, slot.Param<param::AbstractParam>()->ValueString());
-    name.Append("=");
-    name.Append(value);
-    msg.SetBody(name, name.Length());
-    for (SIZE_T i = 0; i < this->clients.Count(); i++) {
-        if (!this->clients[i]->IsRunning()) continue;
-        this->clients[i]->Send(msg);
-    }
+    this->paramLog.Record(slot.FullName(), value);
+}
+
+
+/*
+ * cluster::simple::Server::makeParamMessage
+ */
+void cluster::simple::Server::makeParamMessage(
+    const ParamReplicationLog::Entry& entry, vislib::net::SimpleMessage& outMsg) {
+    vislib::StringA body = entry.first;
+    body.Append("=");
+    body.Append(entry.second);
+    outMsg.GetHeader().SetMessageID(MSG_PARAMUPDATE);
+    outMsg.SetBody(body, body.Length());
 }
 
 
@@ -790,6 +804,8 @@ DWORD cluster::simple::Server::cameraUpdateThread(void* userData) {
     mem.AssertSize(sizeof(vislib::net::SimpleMessageHeaderData));
     vislib::RawStorageSerialiser serialiser(&mem, sizeof(vislib::net::SimpleMessageHeaderData));
     vislib::net::ShallowSimpleMessage msg(mem);
+    std::vector<ParamReplicationLog::Entry> changes;
+    UINT64 changesVersion;
 
     while (true) {
         {
@@ -825,6 +841,20 @@ DWORD cluster::simple::Server::cameraUpdateThread(void* userData) {
             This->clientsLock.Unlock();
         }
 
+        if (This->paramLog.TakeChanges(changesVersion, changes)) {
+            vislib::net::SimpleMessage pmsg;
+            This->clientsLock.Lock();
+            for (const auto& c : changes) {
+                Server::makeParamMessage(c, pmsg);
+                for (SIZE_T i = 0; i < This->clients.Count(); i++) {
+                    if (This->clients[i]->IsRunning()) {
+                        This->clients[i]->Send(pmsg);
+                    }
+                }
+            }
+            This->clientsLock.Unlock();
+        }
+
         vislib::sys::Thread::Sleep(1000 / 60); // ~60 fps
     }
 
@@ -38,6 +38,7 @@ cluster::simple::View::View(void) : view::AbstractTileView(),
         isFirstInitMsg(false),
         heartBeatPortSlot("heartbeat::port", "The port the heartbeat server communicates on"),
         heartBeatServerSlot("heartbeat::server", "The machine the heartbeat server runs on"),
+        heartBeatMulticastSlot("heartbeat::multicast", "The multicast group of the heartbeat server (empty for TCP only)"),
         directCamSyncSlot("directCamSyn", "Flag controlling whether or not this view directly syncs it's camera without using the heartbeat server. It is not recommended to change this setting!"),
         heartbeat(), heartbeatPayload() {
 
@@ -51,6 +52,9 @@ cluster::simple::View::View(void) : view::AbstractTileView(),
     this->MakeSlotAvailable(&this->heartBeatServerSlot);
     this->heartBeatServerSlot.ForceSetDirty();
 
+    this->heartBeatMulticastSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->heartBeatMulticastSlot);
+
     this->directCamSyncSlot << new param::BoolParam(true);
     this->directCamSyncSlot.SetUpdateCallback(&View::directCamSyncUpdated);
     this->MakeSlotAvailable(&this->directCamSyncSlot);
@@ -101,19 +105,26 @@ void cluster::simple::View::Render(const mmcRenderViewContext& context) {
             this->heartBeatServerSlot.Param<param::StringParam>()->SetValue(
                 this->GetCoreInstance()->Configuration().ConfigValue("scv-heartbeat-server"));
         }
+        if (this->GetCoreInstance()->Configuration().IsConfigValueSet("scv-heartbeat-multicast")) {
+            this->heartBeatMulticastSlot.Param<param::StringParam>()->SetValue(
+                this->GetCoreInstance()->Configuration().ConfigValue("scv-heartbeat-multicast"));
+        }
     }
 
     this->processInitialisationMessage();
     this->registerClient();
 
-    if (this->heartBeatPortSlot.IsDirty() || this->heartBeatServerSlot.IsDirty()) {
+    if (this->heartBeatPortSlot.IsDirty() || this->heartBeatServerSlot.IsDirty()
+            || this->heartBeatMulticastSlot.IsDirty()) {
         this->heartBeatPortSlot.ResetDirty();
         this->heartBeatServerSlot.ResetDirty();
+        this->heartBeatMulticastSlot.ResetDirty();
 
         try {
             this->heartbeat.Connect(
                 this->heartBeatServerSlot.Param<param::StringParam>()->Value(),
-                static_cast<unsigned int>(this->heartBeatPortSlot.Param<param::IntParam>()->Value()));
+                static_cast<unsigned int>(this->heartBeatPortSlot.Param<param::IntParam>()->Value()),
+                vislib::StringA(this->heartBeatMulticastSlot.Param<param::StringParam>()->Value()));
 
         } catch(vislib::Exception e) {
             vislib::sys::Log::DefaultLog.WriteError(
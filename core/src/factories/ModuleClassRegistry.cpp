@@ -57,6 +57,7 @@
 #include "mmcore/view/HeadView.h"
 #include "mmcore/view/SharedCameraParameters.h"
 #include "mmcore/view/LinkedView3D.h"
+#include "mmcore/job/DataSourceBenchmarkJob.h"
 #include "mmcore/job/DataWriterJob.h"
 #include "mmcore/job/JobThread.h"
 #include "mmcore/moldyn/VolumeDataCall.h"
@@ -133,6 +134,7 @@ void factories::register_module_classes(factories::ModuleDescriptionManager& ins
     instance.RegisterAutoDescription<view::SharedCameraParameters>();
     instance.RegisterAutoDescription<view::LinkedView3D>();
     instance.RegisterAutoDescription<view::RendererRegistration>();
+    instance.RegisterAutoDescription<job::DataSourceBenchmarkJob>();
     instance.RegisterAutoDescription<job::DataWriterJob>();
     instance.RegisterAutoDescription<job::JobThread>();
     instance.RegisterAutoDescription<moldyn::AddClusterColours>();
@@ -30,6 +30,14 @@ job::AbstractJob::~AbstractJob(void) {
 }
 
 
+/*
+ * job::AbstractJob::GetProgress
+ */
+bool job::AbstractJob::GetProgress(float& outProgress, UINT64& outBytes) {
+    return false;
+}
+
+
 /*
  * job::AbstractJob::IsParamRelevant
  */
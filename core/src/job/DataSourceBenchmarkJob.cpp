@@ -0,0 +1,436 @@
+/*
+ * DataSourceBenchmarkJob.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/job/DataSourceBenchmarkJob.h"
+#include "mmcore/AbstractGetData3DCall.h"
+#include "mmcore/AbstractGetDataCall.h"
+#include "mmcore/AbstractNamedObjectContainer.h"
+#include "mmcore/CoreInstance.h"
+#include "mmcore/misc/VolumetricDataCall.h"
+#include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/StringParam.h"
+#include "vislib/sys/AutoLock.h"
+#include "vislib/sys/File.h"
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+using namespace megamol::core;
+
+
+/*
+ * job::DataSourceBenchmarkJob::DataSourceBenchmarkJob
+ */
+job::DataSourceBenchmarkJob::DataSourceBenchmarkJob() : AbstractThreadedJob(), Module(),
+        dataSlot("data", "Slot to the benchmarked data source, compatible with any call"),
+        fileParamNameSlot("fileParam", "Full name of the file name parameter of the data source, "
+            "e.g. '::inst::MMPLDDataSource1::filename'"),
+        filesSlot("files", "Files to benchmark, separated by ';' (empty for the current file of the data source)"),
+        syntheticParticlesSlot("synthetic::particles", "Particles per frame of a synthetic MMPLD file (0 to disable)"),
+        syntheticFramesSlot("synthetic::frames", "Frames of the synthetic MMPLD file"),
+        syntheticFileSlot("synthetic::filename", "The path the synthetic MMPLD file is written to"),
+        warmRunsSlot("warmRuns", "Number of repetitions with a warm file system cache"),
+        maxFramesSlot("maxFrames", "Maximum number of frames read per sequential and random pass (0 for all)"),
+        getExtentFunctionSlot("getExtentFunction", "Index of the call function for getting the extent"),
+        getDataFunctionSlot("getDataFunction", "Index of the call function for getting the data"),
+        outputFileSlot("outputFile", "The CSV file the results are written to") {
+
+    this->MakeSlotAvailable(&this->dataSlot);
+
+    this->fileParamNameSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->fileParamNameSlot);
+
+    this->filesSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->filesSlot);
+
+    this->syntheticParticlesSlot << new param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->syntheticParticlesSlot);
+
+    this->syntheticFramesSlot << new param::IntParam(10, 1);
+    this->MakeSlotAvailable(&this->syntheticFramesSlot);
+
+    this->syntheticFileSlot << new param::FilePathParam("synthetic.mmpld");
+    this->MakeSlotAvailable(&this->syntheticFileSlot);
+
+    this->warmRunsSlot << new param::IntParam(3, 1);
+    this->MakeSlotAvailable(&this->warmRunsSlot);
+
+    this->maxFramesSlot << new param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->maxFramesSlot);
+
+    this->getExtentFunctionSlot << new param::IntParam(1, 0);
+    this->MakeSlotAvailable(&this->getExtentFunctionSlot);
+
+    this->getDataFunctionSlot << new param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->getDataFunctionSlot);
+
+    this->outputFileSlot << new param::FilePathParam("io_benchmark.csv");
+    this->MakeSlotAvailable(&this->outputFileSlot);
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::~DataSourceBenchmarkJob
+ */
+job::DataSourceBenchmarkJob::~DataSourceBenchmarkJob() {
+    this->Release();
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::create
+ */
+bool job::DataSourceBenchmarkJob::create(void) {
+    // Data sources of all plugins are supported, thus accept every call known by now
+    for (const auto& desc : this->GetCoreInstance()->GetCallDescriptionManager()) {
+        this->dataSlot.SetCompatibleCall(desc);
+    }
+    return true;
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::release
+ */
+void job::DataSourceBenchmarkJob::release(void) {
+    // intentionally empty ATM
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::Run
+ */
+DWORD job::DataSourceBenchmarkJob::Run(void *userData) {
+    using vislib::sys::Log;
+
+    Call *call = this->dataSlot.CallAs<Call>();
+    if (call == nullptr) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Data source benchmark job not connected to any data source\n");
+        return -1;
+    }
+
+    vislib::StringA fileParamName(this->fileParamNameSlot.Param<param::StringParam>()->Value());
+    param::ParamSlot *fileSlot = nullptr;
+    {
+        vislib::sys::AutoLock lock(this->ModuleGraphLock());
+        AbstractNamedObjectContainer *anoc = dynamic_cast<AbstractNamedObjectContainer*>(this->RootModule().get());
+        if (anoc != nullptr && !fileParamName.IsEmpty()) {
+            fileSlot = dynamic_cast<param::ParamSlot*>(anoc->FindNamedObject(fileParamName).get());
+        }
+    }
+    if (fileSlot == nullptr) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to find file name parameter \"%s\"",
+            fileParamName.PeekBuffer());
+        return -1;
+    }
+    const vislib::TString originalFile = fileSlot->Parameter()->ValueString();
+
+    // Files to benchmark, starting with the synthetic one
+    std::vector<std::string> files;
+
+    const int syntheticParticles = this->syntheticParticlesSlot.Param<param::IntParam>()->Value();
+    if (syntheticParticles > 0) {
+        const std::string synthetic(
+            vislib::StringA(this->syntheticFileSlot.Param<param::FilePathParam>()->Value()).PeekBuffer());
+        if (writeSyntheticMMPLD(synthetic, static_cast<unsigned int>(syntheticParticles),
+                static_cast<unsigned int>(this->syntheticFramesSlot.Param<param::IntParam>()->Value()))) {
+            files.push_back(synthetic);
+        } else {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to write synthetic MMPLD file \"%s\"", synthetic.c_str());
+        }
+    }
+
+    const std::string list(vislib::StringA(this->filesSlot.Param<param::StringParam>()->Value()).PeekBuffer());
+    for (std::size_t begin = 0, end = 0; begin <= list.size(); begin = end + 1) {
+        end = std::min(list.find(';', begin), list.size());
+        if (end > begin) {
+            files.push_back(list.substr(begin, end - begin));
+        }
+    }
+    if (files.empty()) {
+        files.push_back(std::string(vislib::StringA(originalFile).PeekBuffer()));
+    }
+
+    const int warmRuns = this->warmRunsSlot.Param<param::IntParam>()->Value();
+    const unsigned int maxFrames = static_cast<unsigned int>(this->maxFramesSlot.Param<param::IntParam>()->Value());
+
+#ifdef _WIN32
+    Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Evicting files from the file system cache is not supported, "
+        "cold measurements are likely served from the cache");
+#endif /* _WIN32 */
+
+    std::vector<Result> results;
+    std::mt19937 rng(42);
+
+    for (const auto &file : files) {
+        if (this->shouldTerminate()) break;
+
+        const double fileMB = static_cast<double>(vislib::sys::File::GetSize(file.c_str())) / (1024.0 * 1024.0);
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Benchmarking data source with \"%s\" (%.1f MB)", file.c_str(),
+            fileMB);
+
+        // Open latency with a cold and a warm cache
+        unsigned int frameCount = 0;
+        const double coldOpen = this->open(*fileSlot, file, true, *call, frameCount);
+        if (coldOpen < 0.0) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to load \"%s\"", file.c_str());
+            continue;
+        }
+        results.push_back(Result{file, fileMB, frameCount, "open", true, 1, coldOpen, 0.0});
+
+        double warmOpen = 0.0;
+        for (int run = 0; run < warmRuns; ++run) {
+            warmOpen += std::max(0.0, this->open(*fileSlot, file, false, *call, frameCount));
+        }
+        results.push_back(Result{file, fileMB, frameCount, "open", false, static_cast<unsigned int>(warmRuns),
+            warmOpen, 0.0});
+
+        // Sequential and random frame seeks, without known sizes assuming the frames fill the file evenly
+        std::vector<unsigned int> sequential(frameCount);
+        std::iota(sequential.begin(), sequential.end(), 0u);
+        if (maxFrames > 0 && sequential.size() > maxFrames) {
+            sequential.resize(maxFrames);
+        }
+
+        std::vector<unsigned int> random(frameCount);
+        std::iota(random.begin(), random.end(), 0u);
+        std::shuffle(random.begin(), random.end(), rng);
+        if (maxFrames > 0 && random.size() > maxFrames) {
+            random.resize(maxFrames);
+        }
+
+        const double estimatedFrameMB = fileMB / std::max(frameCount, 1u);
+
+        for (int pattern = 0; pattern < 2; ++pattern) {
+            const auto &frames = (pattern == 0) ? sequential : random;
+
+            for (int cache = 0; cache < 2; ++cache) {
+                if (this->shouldTerminate()) break;
+
+                const bool cold = (cache == 0);
+                if (cold) {
+                    this->open(*fileSlot, file, true, *call, frameCount);
+                }
+
+                Result result{file, fileMB, frameCount, (pattern == 0) ? "sequential" : "random", cold, 0, 0.0, 0.0};
+
+                const auto start = std::chrono::high_resolution_clock::now();
+                for (const auto frame : frames) {
+                    UINT64 bytes = 0;
+                    if (!this->readFrame(*call, frame, bytes)) {
+                        Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Unable to read frame %u of \"%s\"", frame,
+                            file.c_str());
+                        continue;
+                    }
+                    result.megabytes += (bytes != 0) ? static_cast<double>(bytes) / (1024.0 * 1024.0) : estimatedFrameMB;
+                    ++result.count;
+                }
+                result.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+                Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "%s %s: %u frames in %.3f s, %.1f MB/s",
+                    result.measurement.c_str(), cold ? "cold" : "warm", result.count, result.seconds,
+                    (result.seconds > 0.0) ? result.megabytes / result.seconds : 0.0);
+
+                results.push_back(result);
+            }
+        }
+    }
+
+    // Restore the original file of the data source
+    fileSlot->Parameter()->ParseValue(originalFile);
+
+    if (!this->writeResults(results)) {
+        return -2;
+    }
+
+    Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "DataSourceBenchmarkJob \"%s\" complete", this->FullName().PeekBuffer());
+
+    return 0;
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::open
+ */
+double job::DataSourceBenchmarkJob::open(param::ParamSlot& fileSlot, const std::string& file, bool cold, Call& call,
+        unsigned int& outFrameCount) {
+
+    if (cold && !dropFileCache(file)) {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+            "Unable to evict \"%s\" from the file system cache", file.c_str());
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // Re-opening the same file requires the parameter to be set dirty explicitly
+    const vislib::TString value(vislib::StringA(file.c_str()));
+    if (fileSlot.Parameter()->ValueString() != value) {
+        fileSlot.Parameter()->ParseValue(value);
+    } else {
+        fileSlot.ForceSetDirty();
+    }
+
+    UINT64 bytes = 0;
+    if (!this->readFrame(call, 0, bytes)) {
+        return -1.0;
+    }
+
+    AbstractGetData3DCall *gd3d = dynamic_cast<AbstractGetData3DCall*>(&call);
+    outFrameCount = (gd3d != nullptr) ? gd3d->FrameCount() : 1;
+
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::readFrame
+ */
+bool job::DataSourceBenchmarkJob::readFrame(Call& call, unsigned int frame, UINT64& outBytes) {
+    const unsigned int extentFunction = static_cast<unsigned int>(this->getExtentFunctionSlot.Param<param::IntParam>()->Value());
+    const unsigned int dataFunction = static_cast<unsigned int>(this->getDataFunctionSlot.Param<param::IntParam>()->Value());
+
+    AbstractGetData3DCall *gd3d = dynamic_cast<AbstractGetData3DCall*>(&call);
+
+    // Force loading the requested frame, as asynchronous sources might return another one otherwise
+    if (gd3d != nullptr) gd3d->SetFrameID(frame, true);
+    if (!call(extentFunction)) return false;
+    if (gd3d != nullptr) gd3d->SetFrameID(frame, true);
+    if (!call(dataFunction)) return false;
+
+    outBytes = 0;
+    if (auto mpdc = dynamic_cast<moldyn::MultiParticleDataCall*>(&call)) {
+        for (unsigned int i = 0; i < mpdc->GetParticleListCount(); ++i) {
+            const auto &parts = mpdc->AccessParticles(i);
+            const unsigned int vertBytes = std::max(parts.GetVertexDataStride(),
+                moldyn::MultiParticleDataCall::Particles::VertexDataSize[parts.GetVertexDataType()]);
+            const unsigned int colBytes = std::max(parts.GetColourDataStride(),
+                moldyn::MultiParticleDataCall::Particles::ColorDataSize[parts.GetColourDataType()]);
+            const bool interleaved = (parts.GetColourDataStride() == parts.GetVertexDataStride()) &&
+                (parts.GetColourDataType() != moldyn::MultiParticleDataCall::Particles::COLDATA_NONE);
+            outBytes += parts.GetCount() * (interleaved ? vertBytes : (vertBytes + colBytes));
+        }
+    } else if (auto vdc = dynamic_cast<misc::VolumetricDataCall*>(&call)) {
+        outBytes = vdc->GetFrameSize();
+    }
+
+    if (auto gdc = dynamic_cast<AbstractGetDataCall*>(&call)) gdc->Unlock();
+
+    return true;
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::writeSyntheticMMPLD
+ */
+bool job::DataSourceBenchmarkJob::writeSyntheticMMPLD(const std::string& file, unsigned int particles,
+        unsigned int frames) {
+
+    std::ofstream out(file, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good()) return false;
+
+    // Version 1.0 with a single list of FLOAT_XYZ positions and a global radius and colour
+    const float radius = 0.5f / std::cbrt(static_cast<float>(particles));
+    const float bbox[6] = {-radius, -radius, -radius, 1.0f + radius, 1.0f + radius, 1.0f + radius};
+    const std::uint16_t version = 100;
+    const std::uint32_t frameCount = frames;
+    const std::uint64_t frameSize = 4 + 1 + 1 + 4 + 4 + 8 + 12 * static_cast<std::uint64_t>(particles);
+
+    out.write("MMPLD", 6);
+    out.write(reinterpret_cast<const char*>(&version), 2);
+    out.write(reinterpret_cast<const char*>(&frameCount), 4);
+    out.write(reinterpret_cast<const char*>(bbox), 6 * 4);
+    out.write(reinterpret_cast<const char*>(bbox), 6 * 4);
+
+    std::vector<std::uint64_t> seekTable(frames + 1);
+    seekTable[0] = 6 + 2 + 4 + 2 * 6 * 4 + 8 * static_cast<std::uint64_t>(frames + 1);
+    for (unsigned int i = 1; i <= frames; ++i) {
+        seekTable[i] = seekTable[i - 1] + frameSize;
+    }
+    out.write(reinterpret_cast<const char*>(seekTable.data()), 8 * seekTable.size());
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> positions(3 * static_cast<std::size_t>(particles));
+
+    for (unsigned int i = 0; i < frames && out.good(); ++i) {
+        const std::uint32_t listCount = 1;
+        const std::uint8_t vertType = 1, colType = 0;
+        const std::uint8_t colour[4] = {192, 192, 192, 255};
+        const std::uint64_t count = particles;
+
+        out.write(reinterpret_cast<const char*>(&listCount), 4);
+        out.write(reinterpret_cast<const char*>(&vertType), 1);
+        out.write(reinterpret_cast<const char*>(&colType), 1);
+        out.write(reinterpret_cast<const char*>(&radius), 4);
+        out.write(reinterpret_cast<const char*>(colour), 4);
+        out.write(reinterpret_cast<const char*>(&count), 8);
+
+        std::generate(positions.begin(), positions.end(), [&]() { return dist(rng); });
+        out.write(reinterpret_cast<const char*>(positions.data()), 4 * positions.size());
+    }
+
+    return out.good();
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::dropFileCache
+ */
+bool job::DataSourceBenchmarkJob::dropFileCache(const std::string& file) {
+#ifdef _WIN32
+    return false;
+#else /* _WIN32 */
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ::fdatasync(fd);
+    const bool dropped = (::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+    ::close(fd);
+    return dropped;
+#endif /* _WIN32 */
+}
+
+
+/*
+ * job::DataSourceBenchmarkJob::writeResults
+ */
+bool job::DataSourceBenchmarkJob::writeResults(const std::vector<Result>& results) const {
+    using vislib::sys::Log;
+
+    const vislib::StringA filename(this->outputFileSlot.Param<param::FilePathParam>()->Value());
+    std::ofstream out(filename.PeekBuffer(), std::ios::out | std::ios::trunc);
+    if (!out.good()) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to open output file \"%s\"", filename.PeekBuffer());
+        return false;
+    }
+
+    out << "file,file_mb,frames,measurement,cache,count,seconds,latency_ms,frames_per_s,mb_per_s" << std::endl;
+    for (const auto &result : results) {
+        const double seconds = std::max(result.seconds, 1.0e-9);
+        out << "\"" << result.file << "\"," << result.fileMB << "," << result.frameCount << "," << result.measurement
+            << "," << (result.cold ? "cold" : "warm") << "," << result.count << "," << result.seconds << ","
+            << (1000.0 * result.seconds / std::max(result.count, 1u)) << "," << (result.count / seconds) << ","
+            << (result.megabytes / seconds) << std::endl;
+    }
+
+    Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "I/O benchmark results written to \"%s\"", filename.PeekBuffer());
+
+    return out.good();
+}
@@ -63,6 +63,18 @@ bool job::DataWriterJob::Terminate(void) {
 }
 
 
+/*
+ * job::DataWriterJob::GetProgress
+ */
+bool job::DataWriterJob::GetProgress(float& outProgress, UINT64& outBytes) {
+    DataWriterCtrlCall *dwcc = this->writerSlot.CallAs<DataWriterCtrlCall>();
+    if ((dwcc == NULL) || (dwcc->Progress() < 0.0f)) return false;
+    outProgress = dwcc->Progress();
+    outBytes = dwcc->BytesWritten();
+    return true;
+}
+
+
 /*
  * job::DataWriterJob::Run
  */
@@ -16,6 +16,16 @@
 #include "vislib/sys/FastFile.h"
 #include "vislib/String.h"
 #include "vislib/sys/SystemInformation.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else /* _WIN32 */
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
 
 using namespace megamol::core;
 
@@ -34,7 +44,7 @@ using namespace megamol::core;
  * moldyn::MMPLDDataSource::Frame::Frame
  */
 moldyn::MMPLDDataSource::Frame::Frame(view::AnimDataModule& owner)
-        : view::AnimDataModule::Frame(owner), dat() {
+        : view::AnimDataModule::Frame(owner), dat(), mapped(NULL), mappedSize(0) {
     // intentionally empty
 }
 
@@ -53,16 +63,30 @@ moldyn::MMPLDDataSource::Frame::~Frame() {
 bool moldyn::MMPLDDataSource::Frame::LoadFrame(vislib::sys::File *file, unsigned int idx, UINT64 size, unsigned int version) {
     this->frame = idx;
     this->fileVersion = version;
+    this->mapped = NULL;
+    this->mappedSize = 0;
     this->dat.EnforceSize(static_cast<SIZE_T>(size));
     return (file->Read(this->dat, size) == size);
 }
 
 
+/*
+ * moldyn::MMPLDDataSource::Frame::MapFrame
+ */
+void moldyn::MMPLDDataSource::Frame::MapFrame(const unsigned char *data, unsigned int idx, UINT64 size, unsigned int version) {
+    this->frame = idx;
+    this->fileVersion = version;
+    this->dat.EnforceSize(0);
+    this->mapped = data;
+    this->mappedSize = size;
+}
+
+
 /*
  * moldyn::MMPLDDataSource::Frame::SetData
  */
 void moldyn::MMPLDDataSource::Frame::SetData(MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox) {
-    if (this->dat.IsEmpty()) {
+    if ((this->mapped == NULL) ? this->dat.IsEmpty() : (this->mappedSize == 0)) {
         call.SetParticleListCount(0);
         return;
     }
@@ -70,17 +94,18 @@ void moldyn::MMPLDDataSource::Frame::SetData(MultiParticleDataCall& call, vislib
     SIZE_T p = 0;
     float timestamp = static_cast<float>(call.FrameID());
     if (this->fileVersion == 102) {
-        timestamp = *this->dat.AsAt<float>(p);
+        timestamp = *this->AsAt<float>(p);
         p += sizeof(float);
     }
-    UINT32 plc = *this->dat.AsAt<UINT32>(p);
+    UINT32 plc = *this->AsAt<UINT32>(p);
     p += sizeof(UINT32);
     call.SetParticleListCount(plc);
     for (UINT32 i = 0; i < plc; i++) {
         MultiParticleDataCall::Particles &pts = call.AccessParticles(i);
+        pts.SetCellIndex(NULL);
 
-        UINT8 vrtType = *this->dat.AsAt<UINT8>(p); p += 1;
-        UINT8 colType = *this->dat.AsAt<UINT8>(p); p += 1;
+        UINT8 vrtType = *this->AsAt<UINT8>(p); p += 1;
+        UINT8 colType = *this->AsAt<UINT8>(p); p += 1;
         MultiParticleDataCall::Particles::VertexDataType vrtDatType;
         MultiParticleDataCall::Particles::ColourDataType colDatType;
         SIZE_T vrtSize = 0;
@@ -113,56 +138,79 @@ void moldyn::MMPLDDataSource::Frame::SetData(MultiParticleDataCall& call, vislib
         unsigned int stride = static_cast<unsigned int>(vrtSize + colSize);
 
         if ((vrtType == 1) || (vrtType == 3) || (vrtType == 4)) {
-            pts.SetGlobalRadius(*this->dat.AsAt<float>(p)); p += 4;
+            pts.SetGlobalRadius(*this->AsAt<float>(p)); p += 4;
         } else {
             pts.SetGlobalRadius(0.05f);
         }
 
         if (colType == 0) {
-            pts.SetGlobalColour(*this->dat.AsAt<UINT8>(p),
-                *this->dat.AsAt<UINT8>(p + 1),
-                *this->dat.AsAt<UINT8>(p + 2));
+            pts.SetGlobalColour(*this->AsAt<UINT8>(p),
+                *this->AsAt<UINT8>(p + 1),
+                *this->AsAt<UINT8>(p + 2));
             p += 4;
         } else {
             pts.SetGlobalColour(192, 192, 192);
             if (colType == 3 || colType == 7) {
                 pts.SetColourMapIndexValues(
-                    *this->dat.AsAt<float>(p),
-                    *this->dat.AsAt<float>(p + 4));
+                    *this->AsAt<float>(p),
+                    *this->AsAt<float>(p + 4));
                 p += 8;
             } else {
                 pts.SetColourMapIndexValues(0.0f, 1.0f);
             }
         }
 
-        pts.SetCount(*this->dat.AsAt<UINT64>(p)); p += 8;
+        pts.SetCount(*this->AsAt<UINT64>(p)); p += 8;
 
-        if (this->fileVersion == 103 && !overrideBBox) {
-            auto const box = this->dat.AsAt<float>(p);
-            vislib::math::Cuboid<float> bbox;
-            bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
-            pts.SetBBox(bbox);
+        if (this->fileVersion >= 103) {
+            // quantised positions are relative to the stored bounds, which therefore cannot be overridden
+            if (!overrideBBox || (vrtType == 3)) {
+                auto const box = this->AsAt<float>(p);
+                vislib::math::Cuboid<float> bbox;
+                bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
+                pts.SetBBox(bbox);
+            } else {
+                pts.SetBBox(bbox);
+            }
             p += 24;
         } else {
             pts.SetBBox(bbox);
         }
 
-        pts.SetVertexData(vrtDatType, this->dat.At(p), stride);
-        pts.SetColourData(colDatType, this->dat.At(p + vrtSize), stride);
+        pts.SetVertexData(vrtDatType, this->At(p), stride);
+        pts.SetColourData(colDatType, this->At(p + vrtSize), stride);
 
         p += static_cast<SIZE_T>(stride * pts.GetCount());
 
         if (this->fileVersion == 101) {
             // TODO: who deletes this?
             SimpleSphericalParticles::ClusterInfos *ci = new SimpleSphericalParticles::ClusterInfos();
-            ci->numClusters = *this->dat.AsAt<unsigned int>(p); p += sizeof(unsigned int);
-            ci->sizeofPlainData = *this->dat.AsAt<size_t>(p); p += sizeof(size_t);
+            ci->numClusters = *this->AsAt<unsigned int>(p); p += sizeof(unsigned int);
+            ci->sizeofPlainData = *this->AsAt<size_t>(p); p += sizeof(size_t);
             ci->plainData = (unsigned int*)malloc(ci->sizeofPlainData);
-            memcpy(ci->plainData, this->dat.At(p), ci->sizeofPlainData); p += ci->sizeofPlainData;
+            memcpy(ci->plainData, this->At(p), ci->sizeofPlainData); p += ci->sizeofPlainData;
             pts.SetClusterInfos(ci);
         }
     }
 
+    // optional cell indices of lists sorted by MMPLDWriter, trailing the lists
+    this->cellIndices.clear();
+    const UINT64 size = this->Size();
+    if ((p + 8 > size) || (::memcmp(this->At(p), "MMCI", 4) != 0) || (*this->AsAt<UINT32>(p + 4) != plc)) return;
+    p += 8;
+    this->cellIndices.resize(plc);
+    for (UINT32 i = 0; i < plc; i++) {
+        SimpleSphericalParticles::CellIndex &ci = this->cellIndices[i];
+        if (p + 29 > size) break;
+        ci.level = *this->AsAt<UINT8>(p); p += 1;
+        auto const box = this->AsAt<float>(p); p += 24;
+        ci.bounds.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
+        ci.cellCount = *this->AsAt<UINT32>(p); p += 4;
+        if (p + 12 * static_cast<UINT64>(ci.cellCount) > size) break;
+        ci.cells = this->AsAt<UINT32>(p); p += 4 * ci.cellCount;
+        ci.begins = this->AsAt<UINT64>(p); p += 8 * ci.cellCount;
+        if (ci.cellCount > 0) call.AccessParticles(i).SetCellIndex(&ci);
+    }
 }
 
 /*****************************************************************************/
@@ -176,8 +224,15 @@ moldyn::MMPLDDataSource::MMPLDDataSource(void) : view::AnimDataModule(),
         limitMemorySlot("limitMemory", "Limits the memory cache size"),
         limitMemorySizeSlot("limitMemorySize", "Specifies the size limit (in MegaBytes) of the memory cache"),
         overrideBBoxSlot("overrideLocalBBox", "Override local bbox"),
+        memoryMappedSlot("memoryMapped", "Exposes the frames directly from a memory mapping of the file instead of copying them into the cache"),
         getData("getdata", "Slot to request data from this data source."),
-        file(NULL), frameIdx(NULL), bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
+        file(NULL), frameIdx(NULL), mapping(NULL), mappingSize(0),
+#ifdef _WIN32
+        mappingFile(INVALID_HANDLE_VALUE), mappingHandle(NULL),
+#else /* _WIN32 */
+        mappingFile(-1),
+#endif /* _WIN32 */
+        bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
         clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f), data_hash(0) {
 
     this->filename.SetParameter(new param::FilePathParam(""));
@@ -199,12 +254,19 @@ moldyn::MMPLDDataSource::MMPLDDataSource(void) : view::AnimDataModule(),
     this->overrideBBoxSlot << new param::BoolParam(false);
     this->MakeSlotAvailable(&this->overrideBBoxSlot);
 
+    this->memoryMappedSlot << new param::BoolParam(false);
+    this->memoryMappedSlot.SetUpdateCallback(&MMPLDDataSource::filenameChanged);
+    this->MakeSlotAvailable(&this->memoryMappedSlot);
+
     this->getData.SetCallback("MultiParticleDataCall", "GetData", &MMPLDDataSource::getDataCallback);
     this->getData.SetCallback("MultiParticleDataCall", "GetExtent", &MMPLDDataSource::getExtentCallback);
     this->MakeSlotAvailable(&this->getData);
 
     this->setFrameCount(1);
     this->initFrameCache(1);
+
+    // Only reads files, so independent inputs of a module may be loaded concurrently
+    this->setCallableFromWorkerThreads(true);
 }
 
 
@@ -249,6 +311,18 @@ void moldyn::MMPLDDataSource::loadFrame(view::AnimDataModule::Frame *frame,
     //printf("Requesting frame %u of %u frames\n", idx, this->FrameCount());
     //Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Requesting frame %u of %u frames\n", idx, this->FrameCount());
     ASSERT(idx < this->FrameCount());
+    if (this->mapping != NULL) {
+        const UINT64 size = this->frameIdx[idx + 1] - this->frameIdx[idx];
+        f->MapFrame(this->mapping + this->frameIdx[idx], idx, size, this->fileVersion);
+#ifndef _WIN32
+        // ask the OS to page in the prefetched frame asynchronously
+        const UINT64 pageSize = static_cast<UINT64>(::sysconf(_SC_PAGESIZE));
+        const UINT64 begin = this->frameIdx[idx] - this->frameIdx[idx] % pageSize;
+        ::madvise(const_cast<unsigned char*>(this->mapping + begin),
+            static_cast<size_t>(this->frameIdx[idx + 1] - begin), MADV_WILLNEED);
+#endif /* !_WIN32 */
+        return;
+    }
     this->file->Seek(this->frameIdx[idx]);
     if (!f->LoadFrame(this->file, idx, this->frameIdx[idx + 1] - this->frameIdx[idx], this->fileVersion)) {
         // failed
@@ -262,6 +336,7 @@ void moldyn::MMPLDDataSource::loadFrame(view::AnimDataModule::Frame *frame,
  */
 void moldyn::MMPLDDataSource::release(void) {
     this->resetFrameCache();
+    this->unmapFile();
     if (this->file != NULL) {
         vislib::sys::File *f = this->file;
         this->file = NULL;
@@ -272,6 +347,85 @@ void moldyn::MMPLDDataSource::release(void) {
 }
 
 
+/*
+ * moldyn::MMPLDDataSource::mapFile
+ */
+bool moldyn::MMPLDDataSource::mapFile(const vislib::TString& path) {
+    this->unmapFile();
+
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(vislib::StringW(path).PeekBuffer(), GENERIC_READ,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || (size.QuadPart == 0)) {
+        ::CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        ::CloseHandle(file);
+        return false;
+    }
+    const void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return false;
+    }
+    this->mappingFile = file;
+    this->mappingHandle = mapping;
+    this->mappingSize = static_cast<UINT64>(size.QuadPart);
+
+#else /* _WIN32 */
+    int file = ::open(vislib::StringA(path).PeekBuffer(), O_RDONLY);
+    if (file == -1) {
+        return false;
+    }
+    struct stat fileStat;
+    if ((::fstat(file, &fileStat) == -1) || (fileStat.st_size == 0)
+            || (static_cast<UINT64>(fileStat.st_size) > static_cast<UINT64>(SIZE_MAX))) {
+        ::close(file);
+        return false;
+    }
+    void *data = ::mmap(NULL, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED) {
+        ::close(file);
+        return false;
+    }
+    this->mappingFile = file;
+    this->mappingSize = static_cast<UINT64>(fileStat.st_size);
+
+#endif /* _WIN32 */
+    this->mapping = static_cast<const unsigned char*>(data);
+    return true;
+}
+
+
+/*
+ * moldyn::MMPLDDataSource::unmapFile
+ */
+void moldyn::MMPLDDataSource::unmapFile(void) {
+    if (this->mapping == NULL) return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(this->mapping);
+    ::CloseHandle(this->mappingHandle);
+    ::CloseHandle(this->mappingFile);
+    this->mappingHandle = NULL;
+    this->mappingFile = INVALID_HANDLE_VALUE;
+#else /* _WIN32 */
+    ::munmap(const_cast<unsigned char*>(this->mapping), static_cast<size_t>(this->mappingSize));
+    ::close(this->mappingFile);
+    this->mappingFile = -1;
+#endif /* _WIN32 */
+    this->mapping = NULL;
+    this->mappingSize = 0;
+}
+
+
 
 /*
  * moldyn::MMPLDDataSource::filenameChanged
@@ -280,6 +434,7 @@ bool moldyn::MMPLDDataSource::filenameChanged(param::ParamSlot& slot) {
     using vislib::sys::Log;
     using vislib::sys::File;
     this->resetFrameCache();
+    this->unmapFile();
     this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
     this->clipbox = this->bbox;
     this->data_hash++;
@@ -304,6 +459,7 @@ bool moldyn::MMPLDDataSource::filenameChanged(param::ParamSlot& slot) {
 
 #define _ERROR_OUT(MSG) Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, MSG); \
         SAFE_DELETE(this->file); \
+        this->unmapFile(); \
         this->setFrameCount(1); \
         this->initFrameCache(1); \
         this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f); \
@@ -320,7 +476,7 @@ bool moldyn::MMPLDDataSource::filenameChanged(param::ParamSlot& slot) {
     }
     unsigned short ver;
     _ASSERT_READFILE(&ver, 2);
-    if (ver < 100 || ver > 103) {
+    if (ver < 100 || ver > 104) {
         _ERROR_OUT("MMPLD file header version wrong");
     }
     this->fileVersion = ver;
@@ -341,19 +497,24 @@ bool moldyn::MMPLDDataSource::filenameChanged(param::ParamSlot& slot) {
     this->frameIdx = new UINT64[frmCnt + 1];
     _ASSERT_READFILE(this->frameIdx, 8 * (frmCnt + 1));
     double size = 0.0;
+    UINT64 maxSize = 1;
     for (UINT32 i = 0; i < frmCnt; i++) {
         size += static_cast<double>(this->frameIdx[i + 1] - this->frameIdx[i]);
+        maxSize = vislib::math::Max(maxSize, this->frameIdx[i + 1] - this->frameIdx[i]);
     }
     size /= static_cast<double>(frmCnt);
     size *= CACHE_FRAME_FACTOR;
 
     UINT64 mem = vislib::sys::SystemInformation::AvailableMemorySize();
+    unsigned int cacheSize = static_cast<unsigned int>(mem / size);
     if (this->limitMemorySlot.Param<param::BoolParam>()->Value()) {
-        mem = vislib::math::Min(mem, 
-            (UINT64)(this->limitMemorySizeSlot.Param<param::IntParam>()->Value())
-            * (UINT64)(1024u * 1024u));
+        // each cached frame keeps a buffer of the size of the largest frame
+        // loaded into it, thus the largest frame bounds the memory in use
+        UINT64 limit = (UINT64)(this->limitMemorySizeSlot.Param<param::IntParam>()->Value())
+            * (UINT64)(1024u * 1024u);
+        cacheSize = static_cast<unsigned int>(vislib::math::Min<UINT64>(cacheSize,
+            vislib::math::Min<UINT64>(limit / maxSize, CACHE_SIZE_MAX)));
     }
-    unsigned int cacheSize = static_cast<unsigned int>(mem / size);
 
     if (cacheSize > CACHE_SIZE_MAX) {
         cacheSize = CACHE_SIZE_MAX;
@@ -370,6 +531,14 @@ bool moldyn::MMPLDDataSource::filenameChanged(param::ParamSlot& slot) {
         this->GetCoreInstance()->Log().WriteMsg(vislib::sys::Log::LEVEL_INFO, msg);
     }
 
+    if (this->memoryMappedSlot.Param<param::BoolParam>()->Value()) {
+        if (!this->mapFile(this->filename.Param<param::FilePathParam>()->Value())) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Unable to map MMPLD file into memory. Falling back to reading the frames.");
+        } else if (this->mappingSize < this->frameIdx[frmCnt]) {
+            _ERROR_OUT("MMPLD file is truncated");
+        }
+    }
+
     this->setFrameCount(frmCnt);
     this->initFrameCache(cacheSize);
 
@@ -389,10 +558,9 @@ bool moldyn::MMPLDDataSource::getDataCallback(Call& caller) {
 
     Frame *f = NULL;
     if (c2 != NULL) {
-        f = dynamic_cast<Frame *>(this->requestLockedFrame(c2->FrameID(), c2->IsFrameForced()));
+        f = dynamic_cast<Frame *>(this->requestLockedFrame(*c2));
         if (f == NULL) return false;
         c2->SetUnlocker(new Unlocker(*f));
-        c2->SetFrameID(f->FrameNumber());
         c2->SetDataHash(this->data_hash);
         auto overrideBBox = this->overrideBBoxSlot.Param<param::BoolParam>()->Value();
         f->SetData(*c2, this->bbox, overrideBBox);
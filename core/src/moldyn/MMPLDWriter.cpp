@@ -7,12 +7,22 @@
 
 #include "stdafx.h"
 #include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "mmcore/BoundingBoxes.h"
 #include "mmcore/moldyn/MMPLDWriter.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
 #include "vislib/String.h"
 #include "vislib/sys/FastFile.h"
+#include "vislib/sys/MemoryFile.h"
 #include "vislib/sys/Log.h"
 #include "vislib/sys/Thread.h"
 
@@ -20,6 +30,25 @@ using namespace megamol::core;
 
 //#define WITH_CLUSTERINFO
 
+namespace {
+
+/** The number of bits per axis of the Morton codes used for sorting */
+const unsigned int mortonBits = 21;
+
+/** Spreads the lower 21 bits of v to every third bit */
+UINT64 spreadBits(UINT64 v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffffull;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+} // namespace
+
+
 /*
  * moldyn::MMPLDWriter::MMPLDWriter
  */
@@ -27,6 +56,9 @@ moldyn::MMPLDWriter::MMPLDWriter(void)
     : AbstractDataWriter()
     , filenameSlot("filename", "The path to the MMPLD file to be written")
     , versionSlot("version", "The file format version to be written")
+    , localitySortSlot("localitySort", "Sorts the particles of each list along a space-filling curve")
+    , cellIndexLevelSlot("cellIndexLevel",
+          "Sorted lists store an index of 2^level cells per axis to their particle ranges, 0 stores no index")
     , dataSlot("data", "The slot requesting the data to be written") {
 
     this->filenameSlot << new param::FilePathParam("");
@@ -39,9 +71,19 @@ moldyn::MMPLDWriter::MMPLDWriter(void)
 #endif
     verPar->SetTypePair(102, "1.2");
     verPar->SetTypePair(103, "1.3");
+    verPar->SetTypePair(104, "1.4 (quantised)");
     this->versionSlot.SetParameter(verPar);
     this->MakeSlotAvailable(&this->versionSlot);
 
+    param::EnumParam* sortPar = new param::EnumParam(0);
+    sortPar->SetTypePair(0, "None");
+    sortPar->SetTypePair(1, "Morton");
+    this->localitySortSlot.SetParameter(sortPar);
+    this->MakeSlotAvailable(&this->localitySortSlot);
+
+    this->cellIndexLevelSlot << new param::IntParam(4, 0, 10);
+    this->MakeSlotAvailable(&this->cellIndexLevelSlot);
+
     this->dataSlot.SetCompatibleCall<MultiParticleDataCallDescription>();
     this->MakeSlotAvailable(&this->dataSlot);
 }
@@ -150,18 +192,57 @@ bool moldyn::MMPLDWriter::run(void) {
     ASSERT_WRITEOUT(cbox.PeekBounds(), 6 * 4);
 
     UINT64 seekTable = static_cast<UINT64>(file.Tell());
-    UINT64 frameOffset = 0;
-    for (UINT32 i = 0; i <= frameCnt; i++) {
-        ASSERT_WRITEOUT(&frameOffset, 8);
+    std::vector<UINT64> frameOffsets(frameCnt + 1, 0);
+    ASSERT_WRITEOUT(frameOffsets.data(), 8 * frameOffsets.size());
+
+    // Frames are serialised into memory on this thread, while a writer thread
+    // puts the previous ones to disk in one piece each. The data call only
+    // provides one frame at a time, so fetching frames is not parallelised.
+    std::vector<vislib::RawStorage> buffers(bufferCount);
+    std::vector<vislib::RawStorage*> freeBuffers;
+    for (auto& b : buffers) {
+        freeBuffers.push_back(&b);
     }
+    std::deque<PendingFrame> pending;
+    std::mutex lock;
+    std::condition_variable changed;
+    bool finished = false;
+    bool writeFailed = false;
+    frameOffsets[0] = static_cast<UINT64>(file.Tell());
+
+    std::thread writer([&]() {
+        while (true) {
+            PendingFrame f;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&]() { return finished || !pending.empty(); });
+                if (pending.empty()) return;
+                f = pending.front();
+                pending.pop_front();
+            }
+            const bool ok = (file.Write(f.data->As<void>(), f.size) == f.size);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                frameOffsets[f.index + 1] = frameOffsets[f.index] + f.size;
+                writeFailed = writeFailed || !ok;
+                freeBuffers.push_back(f.data);
+            }
+            this->setProgress(static_cast<float>(f.index + 1) / static_cast<float>(frameCnt),
+                frameOffsets[f.index + 1]);
+            changed.notify_all();
+        }
+    });
+    auto stopWriter = [&]() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished = true;
+        }
+        changed.notify_all();
+        writer.join();
+    };
 
     mpdc->Unlock();
     for (UINT32 i = 0; i < frameCnt; i++) {
-        frameOffset = static_cast<UINT64>(file.Tell());
-        file.Seek(seekTable + i * 8);
-        ASSERT_WRITEOUT(&frameOffset, 8);
-        file.Seek(frameOffset);
-
         Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Started writing data frame %u\n", i);
 
         int missCnt = -9;
@@ -170,11 +251,13 @@ bool moldyn::MMPLDWriter::run(void) {
             mpdc->SetFrameID(i, true);
             if (!(*mpdc)(1)) {
                 Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot request frame %u. Abort.\n", i);
+                stopWriter();
                 file.Close();
                 return false;
             }
             if (!(*mpdc)(0)) {
                 Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot get data frame %u. Abort.\n", i);
+                stopWriter();
                 file.Close();
                 return false;
             }
@@ -188,24 +271,56 @@ bool moldyn::MMPLDWriter::run(void) {
             }
         } while (mpdc->FrameID() != i);
 
-        if (!this->writeFrame(file, *mpdc)) {
-            mpdc->Unlock();
+        vislib::RawStorage* buffer = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]() { return writeFailed || !freeBuffers.empty(); });
+            if (!writeFailed) {
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+        }
+        bool ok = (buffer != nullptr);
+        if (ok) {
+            // reserve for the largest particle format, as the memory file grows by each write
+            SIZE_T reserve = 64;
+            for (unsigned int li = 0; li < mpdc->GetParticleListCount(); li++) {
+                reserve += 64 + static_cast<SIZE_T>(mpdc->AccessParticles(li).GetCount()) * 40;
+            }
+            buffer->AssertSize(reserve);
+            vislib::sys::MemoryFile mem;
+            mem.Open(*buffer, vislib::sys::File::WRITE_ONLY);
+            ok = this->writeFrame(mem, *mpdc);
+            if (ok) {
+                std::lock_guard<std::mutex> guard(lock);
+                pending.push_back(PendingFrame{i, buffer, static_cast<UINT64>(mem.Tell())});
+            }
+            mem.Close();
+        }
+        mpdc->Unlock();
+        if (!ok) {
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot write data frame %u. Abort.\n", i);
+            stopWriter();
             file.Close();
             return false;
         }
-        mpdc->Unlock();
+        changed.notify_all();
+    }
+    stopWriter();
+    if (writeFailed) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot write data frames. Abort.\n");
+        file.Close();
+        return false;
     }
 
-    frameOffset = static_cast<UINT64>(file.Tell());
-    file.Seek(seekTable + frameCnt * 8);
-    ASSERT_WRITEOUT(&frameOffset, 8);
+    file.Seek(seekTable);
+    ASSERT_WRITEOUT(frameOffsets.data(), 8 * frameOffsets.size());
 
     file.Seek(6); // set correct version to show that file is complete
     version = this->versionSlot.Param<param::EnumParam>()->Value();
     ASSERT_WRITEOUT(&version, 2);
 
-    file.Seek(frameOffset);
+    file.Seek(frameOffsets[frameCnt]);
 
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Completed writing data\n");
     file.Close();
@@ -224,6 +339,76 @@ bool moldyn::MMPLDWriter::getCapabilities(DataWriterCtrlCall& call) {
 }
 
 
+/*
+ * moldyn::MMPLDWriter::sortParticles
+ */
+void moldyn::MMPLDWriter::sortParticles(const MultiParticleDataCall::Particles& src, unsigned int level,
+    MultiParticleDataCall::Particles& outSorted, vislib::RawStorage& outData, ListCellIndex& outIndex) {
+    const UINT64 cnt = src.GetCount();
+    const auto& store = src.GetParticleStore();
+    const auto& xAcc = store.GetXAcc();
+    const auto& yAcc = store.GetYAcc();
+    const auto& zAcc = store.GetZAcc();
+
+    vislib::math::Cuboid<float> box;
+    for (UINT64 i = 0; i < cnt; ++i) {
+        const float x = xAcc->Get_f(i), y = yAcc->Get_f(i), z = zAcc->Get_f(i);
+        if (i == 0) {
+            box.Set(x, y, z, x, y, z);
+        } else {
+            box.GrowToPoint(x, y, z);
+        }
+    }
+
+    // codes of 21 bits per axis relative to the tight bounds, sorted with the particle indices
+    const float maxCell = static_cast<float>((1u << mortonBits) - 1);
+    const float sx = (box.Width() > 0.0f) ? maxCell / box.Width() : 0.0f;
+    const float sy = (box.Height() > 0.0f) ? maxCell / box.Height() : 0.0f;
+    const float sz = (box.Depth() > 0.0f) ? maxCell / box.Depth() : 0.0f;
+    std::vector<std::pair<UINT64, UINT64>> order(static_cast<size_t>(cnt));
+    for (UINT64 i = 0; i < cnt; ++i) {
+        const UINT64 cx = static_cast<UINT64>(std::min((xAcc->Get_f(i) - box.Left()) * sx, maxCell));
+        const UINT64 cy = static_cast<UINT64>(std::min((yAcc->Get_f(i) - box.Bottom()) * sy, maxCell));
+        const UINT64 cz = static_cast<UINT64>(std::min((zAcc->Get_f(i) - box.Back()) * sz, maxCell));
+        order[i] = std::make_pair(spreadBits(cx) | (spreadBits(cy) << 1) | (spreadBits(cz) << 2), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    const unsigned int vs = MultiParticleDataCall::Particles::VertexDataSize[src.GetVertexDataType()];
+    const unsigned int cs = MultiParticleDataCall::Particles::ColorDataSize[src.GetColourDataType()];
+    const unsigned int vo = std::max(src.GetVertexDataStride(), vs);
+    const unsigned int co = std::max(src.GetColourDataStride(), cs);
+    const unsigned int stride = vs + cs;
+    const unsigned char* vp = static_cast<const unsigned char*>(src.GetVertexData());
+    const unsigned char* cp = static_cast<const unsigned char*>(src.GetColourData());
+    outData.AssertSize(static_cast<SIZE_T>(cnt) * stride);
+    unsigned char* dst = outData.As<unsigned char>();
+    for (UINT64 i = 0; i < cnt; ++i, dst += stride) {
+        const UINT64 s = order[i].second;
+        ::memcpy(dst, vp + s * vo, vs);
+        if (cs > 0) ::memcpy(dst + vs, cp + s * co, cs);
+    }
+    outSorted = src;
+    outSorted.SetVertexData(src.GetVertexDataType(), outData.As<unsigned char>(), stride);
+    outSorted.SetColourData(src.GetColourDataType(), outData.As<unsigned char>() + vs, stride);
+
+    // the particles of a cell are contiguous, as the cell is given by the upper bits of the codes
+    outIndex.level = static_cast<UINT8>(level);
+    outIndex.bounds = box;
+    outIndex.cells.clear();
+    outIndex.begins.clear();
+    if (level == 0) return;
+    const unsigned int shift = 3 * (mortonBits - level);
+    for (UINT64 i = 0; i < cnt; ++i) {
+        const UINT32 cell = static_cast<UINT32>(order[i].first >> shift);
+        if (outIndex.cells.empty() || (outIndex.cells.back() != cell)) {
+            outIndex.cells.push_back(cell);
+            outIndex.begins.push_back(i);
+        }
+    }
+}
+
+
 /*
  * moldyn::MMPLDWriter::writeFrame
  */
@@ -246,8 +431,21 @@ bool moldyn::MMPLDWriter::writeFrame(vislib::sys::File& file, moldyn::MultiParti
     UINT32 listCnt = data.GetParticleListCount();
     ASSERT_WRITEOUT(&listCnt, 4);
 
+    const bool sort = (this->localitySortSlot.Param<param::EnumParam>()->Value() != 0);
+    const unsigned int level = static_cast<unsigned int>(this->cellIndexLevelSlot.Param<param::IntParam>()->Value());
+    std::vector<ListCellIndex> cellIndices(listCnt);
+    MultiParticleDataCall::Particles sorted;
+    vislib::RawStorage sortedData;
+
     for (UINT32 li = 0; li < listCnt; li++) {
-        MultiParticleDataCall::Particles& points = data.AccessParticles(li);
+        MultiParticleDataCall::Particles* list = &data.AccessParticles(li);
+        cellIndices[li].level = 0;
+        if (sort && (list->GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_NONE) &&
+            (list->GetCount() > 1)) {
+            sortParticles(*list, level, sorted, sortedData, cellIndices[li]);
+            list = &sorted;
+        }
+        MultiParticleDataCall::Particles& points = *list;
         UINT8 vt = 0, ct = 0;
         unsigned int vs = 0, vo = 0, cs = 0, co = 0;
         switch (points.GetVertexDataType()) {
@@ -276,6 +474,8 @@ bool moldyn::MMPLDWriter::writeFrame(vislib::sys::File& file, moldyn::MultiParti
             vs = 0;
             break;
         }
+        // version 1.4 stores float and double positions as SHORT_XYZ relative to the list bounds
+        const bool quantise = (ver == 104) && ((vt == 1) || (vt == 4));
         if (vt != 0) {
             switch (points.GetColourDataType()) {
             case MultiParticleDataCall::Particles::COLDATA_NONE:
@@ -318,6 +518,8 @@ bool moldyn::MMPLDWriter::writeFrame(vislib::sys::File& file, moldyn::MultiParti
         } else {
             ct = 0;
         }
+        const UINT8 srcVt = vt;
+        if (quantise) vt = 3;
         ASSERT_WRITEOUT(&vt, 1);
         if (ct == 1) ct = 2; // UINT8_RGB is unaligned and will never be written again.
         if (vt == 4 && ct < 5) { // TODO: fragile if we add another color type beyond DOUBLE_I!
@@ -361,13 +563,50 @@ bool moldyn::MMPLDWriter::writeFrame(vislib::sys::File& file, moldyn::MultiParti
         if (vt == 0) cnt = 0;
         ASSERT_WRITEOUT(&cnt, 8);
 
-        if (ver == 103) {
+        const unsigned char* vp = static_cast<const unsigned char*>(points.GetVertexData());
+        const unsigned char* cp = static_cast<const unsigned char*>(points.GetColourData());
+        if (quantise) {
+            // the tight bounds of the list define the quantisation
+            std::vector<float> pos(3 * static_cast<size_t>(cnt));
+            vislib::math::Cuboid<float> box;
+            for (UINT64 i = 0; i < cnt; ++i) {
+                float* p = pos.data() + 3 * i;
+                for (int c = 0; c < 3; ++c) {
+                    p[c] = (srcVt == 4) ? static_cast<float>(reinterpret_cast<const double*>(vp + i * vo)[c])
+                                        : reinterpret_cast<const float*>(vp + i * vo)[c];
+                }
+                if (i == 0) {
+                    box.Set(p[0], p[1], p[2], p[0], p[1], p[2]);
+                } else {
+                    box.GrowToPoint(p[0], p[1], p[2]);
+                }
+            }
+            ASSERT_WRITEOUT(box.PeekBounds(), 24);
+
+            const float edge = box.LongestEdge();
+            const float scale = (edge > 0.0f) ? static_cast<float>(SHRT_MAX) / edge : 0.0f;
+            const unsigned int stride = 6 + ((ct == 0) ? 0 : ((cs == 3) ? 4 : cs));
+            std::vector<unsigned char> buf(stride * static_cast<size_t>(cnt));
+            for (UINT64 i = 0; i < cnt; ++i) {
+                unsigned char* dst = buf.data() + stride * i;
+                short* q = reinterpret_cast<short*>(dst);
+                q[0] = static_cast<short>(std::min((pos[3 * i] - box.Left()) * scale, float(SHRT_MAX)) + 0.5f);
+                q[1] = static_cast<short>(std::min((pos[3 * i + 1] - box.Bottom()) * scale, float(SHRT_MAX)) + 0.5f);
+                q[2] = static_cast<short>(std::min((pos[3 * i + 2] - box.Back()) * scale, float(SHRT_MAX)) + 0.5f);
+                if (ct != 0) {
+                    memcpy(dst + 6, cp + i * co, cs);
+                    if (cs == 3) dst[9] = alpha;
+                }
+            }
+            ASSERT_WRITEOUT(buf.data(), buf.size());
+            continue;
+        }
+
+        if (ver >= 103) {
             ASSERT_WRITEOUT(points.GetBBox().PeekBounds(), 24);
         }
 
         if (vt == 0) continue;
-        const unsigned char* vp = static_cast<const unsigned char*>(points.GetVertexData());
-        const unsigned char* cp = static_cast<const unsigned char*>(points.GetColourData());
         if (vt == 4 && ct < 5) {
             switch (points.GetColourDataType()) {
             case MultiParticleDataCall::Particles::COLDATA_NONE:
@@ -470,6 +709,20 @@ bool moldyn::MMPLDWriter::writeFrame(vislib::sys::File& file, moldyn::MultiParti
 #endif
     }
 
+    if (sort && (level > 0)) {
+        // optional trailing section, which readers not knowing it ignore
+        ASSERT_WRITEOUT("MMCI", 4);
+        ASSERT_WRITEOUT(&listCnt, 4);
+        for (const ListCellIndex& ci : cellIndices) {
+            ASSERT_WRITEOUT(&ci.level, 1);
+            ASSERT_WRITEOUT(ci.bounds.PeekBounds(), 24);
+            const UINT32 cellCnt = static_cast<UINT32>(ci.cells.size());
+            ASSERT_WRITEOUT(&cellCnt, 4);
+            ASSERT_WRITEOUT(ci.cells.data(), 4 * cellCnt);
+            ASSERT_WRITEOUT(ci.begins.data(), 8 * cellCnt);
+        }
+    }
+
     return true;
 #undef ASSERT_WRITEOUT
 }
@@ -36,6 +36,7 @@ moldyn::SimpleSphericalParticles::SimpleSphericalParticles(void)
     , disabledNullChecks(false)
     , isVAO(false)
     , clusterInfos(nullptr)
+    , cellIndex(nullptr)
     , idDataType{IDDATA_NONE}
     , idPtr{nullptr}
     , idStride{0} {
@@ -70,6 +71,10 @@ moldyn::SimpleSphericalParticles::~SimpleSphericalParticles(void) {
     this->dirPtr = nullptr; // DO NOT DELETE
     this->idDataType = IDDATA_NONE;
     this->idPtr = nullptr;
+    this->colOwner.reset();
+    this->dirOwner.reset();
+    this->vertOwner.reset();
+    this->idOwner.reset();
 }
 
 
@@ -95,13 +100,19 @@ moldyn::SimpleSphericalParticles& moldyn::SimpleSphericalParticles::operator=(
     this->vertStride = rhs.vertStride;
     this->disabledNullChecks = rhs.disabledNullChecks;
     this->clusterInfos = rhs.clusterInfos;
+    this->cellIndex = rhs.cellIndex;
     this->dirDataType = rhs.dirDataType;
     this->dirPtr = rhs.dirPtr;
     this->dirStride = rhs.dirStride;
     this->idDataType = rhs.idDataType;
     this->idPtr = rhs.idPtr;
     this->idStride = rhs.idStride;
-    this->par_store_ = rhs.par_store_;
+    this->colOwner = rhs.colOwner;
+    this->dirOwner = rhs.dirOwner;
+    this->vertOwner = rhs.vertOwner;
+    this->idOwner = rhs.idOwner;
+    // the accessors are immutable, but the copy must not change those of 'rhs' when its data is replaced
+    this->par_store_ = std::make_shared<ParticleStore>(*rhs.par_store_);
     this->wsBBox = rhs.wsBBox;
     return *this;
 }
@@ -117,6 +128,7 @@ bool moldyn::SimpleSphericalParticles::operator==(const moldyn::SimpleSphericalP
             (this->minColI == rhs.minColI) && (this->radius == rhs.radius) &&
             (this->vertDataType == rhs.vertDataType) && (this->vertPtr == rhs.vertPtr) &&
             (this->vertStride == rhs.vertStride) && (this->clusterInfos == rhs.clusterInfos) &&
+            (this->cellIndex == rhs.cellIndex) &&
             (this->dirDataType == rhs.dirDataType) && (this->dirPtr == rhs.dirPtr) &&
             (this->dirStride == rhs.dirStride) &&
             (this->idDataType == rhs.idDataType) && (this->idPtr == rhs.idPtr) && (this->idStride == rhs.idStride) &&
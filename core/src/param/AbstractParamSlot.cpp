@@ -16,7 +16,7 @@ using namespace megamol::core::param;
 /*
  * AbstractParamSlot::AbstractParamSlot
  */
-AbstractParamSlot::AbstractParamSlot(void) : dirty(false), param() {
+AbstractParamSlot::AbstractParamSlot(void) : dirty(false), generation(0), param() {
     // intentionally empty
 }
 
@@ -62,4 +62,5 @@ void AbstractParamSlot::SetParameter(AbstractParam *param) {
  */
 void AbstractParamSlot::update(void) {
     this->dirty = true;
+    ++this->generation;
 }
@@ -72,8 +72,11 @@ void param::ParamSlot::update(void) {
     AbstractParamSlot::update();
 
     Module *m = dynamic_cast<Module*>(this->Parent().get());
-    if ((m != nullptr) && (m->GetCoreInstance() != nullptr)) {
-        m->GetCoreInstance()->ParameterValueUpdate(*this);
+    if (m != nullptr) {
+        m->paramUpdated(*this);
+        if (m->GetCoreInstance() != nullptr) {
+            m->GetCoreInstance()->ParameterValueUpdate(*this);
+        }
     }
 
     if (oldDirty != this->IsDirty()) {
@@ -8,6 +8,7 @@
 #include "mmcore/profiler/Connection.h"
 #include "mmcore/profiler/Manager.h"
 #include "vislib/memutils.h"
+#include "vislib/sys/Thread.h"
 
 using namespace megamol;
 using namespace megamol::core;
@@ -22,8 +23,9 @@ const SIZE_T profiler::Connection::log_size = 1000;
 /*
  * profiler::Connection::Connection
  */
-profiler::Connection::Connection(void) : call(nullptr), func(0), values(nullptr), values_cnt(0), values_pos(-1) {
+profiler::Connection::Connection(void) : call(nullptr), func(0), values(nullptr), threads(nullptr), values_cnt(0), values_pos(-1) {
     this->values = new vislib::Pair<double, double>[log_size];
+    this->threads = new unsigned int[log_size];
 }
 
 
@@ -33,6 +35,7 @@ profiler::Connection::Connection(void) : call(nullptr), func(0), values(nullptr)
 profiler::Connection::~Connection(void) {
     this->call = nullptr; // do not delete
     ARY_SAFE_DELETE(this->values);
+    ARY_SAFE_DELETE(this->threads);
 }
 
 
@@ -43,6 +46,7 @@ void profiler::Connection::begin_measure(void) {
     this->values_pos = (this->values_pos + 1) % log_size;
     this->values[this->values_pos].SetFirst(Manager::Instance().Now());
     this->values[this->values_pos].SetSecond(-1.0);
+    this->threads[this->values_pos] = static_cast<unsigned int>(vislib::sys::Thread::CurrentID());
 }
 
 
@@ -61,9 +65,22 @@ void profiler::Connection::end_measure(void) {
  */
 double profiler::Connection::get_mean(void) const {
     double m = 0.0;
-    for (unsigned int i = 0; i < this->values_cnt; i++) {
+    SIZE_T cnt = 0;
+    for (SIZE_T i = 0; i < this->values_cnt; i++) {
+        if (this->values[i].Second() < 0.0) continue; // still running
         m += this->values[i].Second();
+        cnt++;
     }
-    m /= static_cast<double>(this->values_cnt);
-    return m;
+    return (cnt > 0) ? (m / static_cast<double>(cnt)) : 0.0;
+}
+
+
+/*
+ * profiler::Connection::get_sample
+ */
+void profiler::Connection::get_sample(SIZE_T idx, double& start, double& duration, unsigned int& thread) const {
+    ASSERT(idx < this->values_cnt);
+    start = this->values[idx].First();
+    duration = this->values[idx].Second();
+    thread = this->threads[idx];
 }
@@ -9,10 +9,19 @@
 #include "vislib/sys/Log.h"
 #include "vislib/Stack.h"
 #include "mmcore/AbstractNamedObjectContainer.h"
+#include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/AbstractNamedObject.h"
 #include "mmcore/Call.h"
 #include "vislib/sys/PerformanceCounter.h"
+#include "vislib/sys/Process.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::core;
@@ -174,27 +183,167 @@ double profiler::Manager::Now(void) const {
  * profiler::Manager::Report
  */
 void profiler::Manager::Report(void) {
+    vislib::StringA report = this->MakeReport();
+    if (!report.IsEmpty()) {
+        printf("%s", report.PeekBuffer());
+    }
+}
+
+
+namespace {
+
+    /** Answers the name of the module owning the callee slot of a call */
+    std::string calleeModuleName(const megamol::core::Call *call) {
+        const megamol::core::CalleeSlot *callee = call->PeekCalleeSlot();
+        if ((callee == nullptr) || !callee->Parent()) return "unknown";
+        return callee->Parent()->FullName().PeekBuffer();
+    }
+
+    /** Escapes a string for a JSON string literal */
+    std::string jsonEscape(const std::string& str) {
+        std::string rv;
+        rv.reserve(str.size());
+        for (char c : str) {
+            if ((c == '"') || (c == '\\')) rv += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            rv += c;
+        }
+        return rv;
+    }
+
+}
+
+
+/*
+ * profiler::Manager::MakeReport
+ */
+vislib::StringA profiler::Manager::MakeReport(void) {
+    struct Stats {
+        SIZE_T count = 0;
+        double total = 0.0;
+        double max = 0.0;
+        double first = 0.0;
+        double last = 0.0;
+
+        void add(double start, double duration) {
+            if (this->count == 0 || start < this->first) this->first = start;
+            if (this->count == 0 || start + duration > this->last) this->last = start + duration;
+            this->count++;
+            this->total += duration;
+            if (duration > this->max) this->max = duration;
+        }
+    };
+    std::map<std::string, Stats> modules;
+    std::vector<std::pair<std::string, Stats> > calls;
+
     this->connections.Lock();
     try {
+        for (SIZE_T i = 0; i < this->connections.Count(); i++) {
+            Connection::ptr_type conn = this->connections[i];
+            std::stringstream name;
+            name << conn->get_call()->PeekCallerSlot()->FullName().PeekBuffer()
+                << "(" << conn->get_function_id() << ")";
+            Stats& module = modules[calleeModuleName(conn->get_call())];
+            Stats call;
+            for (SIZE_T j = 0; j < conn->get_sample_count(); j++) {
+                double start, duration;
+                unsigned int thread;
+                conn->get_sample(j, start, duration, thread);
+                if (duration < 0.0) continue; // still running
+                module.add(start, duration);
+                call.add(start, duration);
+            }
+            calls.push_back(std::make_pair(name.str(), call));
+        }
+        this->connections.Unlock();
+    } catch(...) {
+        this->connections.Unlock();
+        throw;
+    }
+
+    if (calls.empty()) return vislib::StringA();
+
+    // Share of the wall clock time spanned by the samples spent in the module,
+    // which is independent of the number of calls issued per frame
+    auto line = [](std::stringstream& out, const std::string& name, const Stats& s) {
+        const double span = s.last - s.first;
+        out << "\t" << std::setw(8) << s.count << " calls "
+            << std::setw(10) << ((s.count > 0) ? (s.total * 1000.0 / static_cast<double>(s.count)) : 0.0) << " ms mean "
+            << std::setw(10) << (s.max * 1000.0) << " ms max "
+            << std::setw(6) << ((span > 0.0) ? (100.0 * s.total / span) : 0.0) << " % load  "
+            << name << "\n";
+    };
 
-        // TODO: Implement some better reporting:
+    std::vector<std::pair<std::string, Stats> > sorted(modules.begin(), modules.end());
+    auto byTotal = [](const std::pair<std::string, Stats>& l, const std::pair<std::string, Stats>& r) {
+        return l.second.total > r.second.total;
+    };
+    std::sort(sorted.begin(), sorted.end(), byTotal);
+    std::sort(calls.begin(), calls.end(), byTotal);
 
-        if (!this->connections.IsEmpty()) {
-            printf("Call Performance Profile:\n");
-            for (SIZE_T i = 0; i < this->connections.Count(); i++) {
-                Connection::ptr_type conn = this->connections[i];
-                printf("\t%s(%u) = %f\n",
-                    conn->get_call()->PeekCallerSlot()->FullName().PeekBuffer(),
-                    conn->get_function_id(),
-                    conn->get_mean());
+    std::stringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "Module Performance Profile:\n";
+    for (const auto& m : sorted) line(out, m.first, m.second);
+    out << "Call Performance Profile:\n";
+    for (const auto& c : calls) line(out, c.first, c.second);
+
+    return vislib::StringA(out.str().c_str());
+}
+
+
+/*
+ * profiler::Manager::WriteChromeTrace
+ */
+bool profiler::Manager::WriteChromeTrace(const vislib::StringA& filename) {
+    std::ofstream file(filename.PeekBuffer(), std::ios::out | std::ios::trunc);
+    if (!file.good()) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to write profiler trace \"%s\"", filename.PeekBuffer());
+        return false;
+    }
+
+    const unsigned int pid = static_cast<unsigned int>(vislib::sys::Process::CurrentID());
+    SIZE_T events = 0;
+
+    file << "{\"traceEvents\":[";
+    this->connections.Lock();
+    try {
+        for (SIZE_T i = 0; i < this->connections.Count(); i++) {
+            Connection::ptr_type conn = this->connections[i];
+            std::stringstream name;
+            name << conn->get_call()->PeekCallerSlot()->FullName().PeekBuffer()
+                << "(" << conn->get_function_id() << ")";
+            const std::string eventName = jsonEscape(name.str());
+            const std::string moduleName = jsonEscape(calleeModuleName(conn->get_call()));
+
+            for (SIZE_T j = 0; j < conn->get_sample_count(); j++) {
+                double start, duration;
+                unsigned int thread;
+                conn->get_sample(j, start, duration, thread);
+                if (duration < 0.0) continue; // still running
+                file << ((events++ == 0) ? "\n" : ",\n")
+                    << "{\"name\":\"" << eventName << "\",\"cat\":\"call\",\"ph\":\"X\""
+                    << ",\"ts\":" << static_cast<UINT64>(start * 1000000.0)
+                    << ",\"dur\":" << static_cast<UINT64>(duration * 1000000.0)
+                    << ",\"pid\":" << pid << ",\"tid\":" << thread
+                    << ",\"args\":{\"module\":\"" << moduleName << "\"}}";
             }
         }
-
         this->connections.Unlock();
     } catch(...) {
         this->connections.Unlock();
         throw;
     }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.close();
+
+    if (file.fail()) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to write profiler trace \"%s\"", filename.PeekBuffer());
+        return false;
+    }
+    vislib::sys::Log::DefaultLog.WriteInfo("Wrote %u profiler samples to \"%s\"",
+        static_cast<unsigned int>(events), filename.PeekBuffer());
+    return true;
 }
 
 
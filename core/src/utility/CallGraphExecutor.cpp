@@ -0,0 +1,169 @@
+/*
+ * CallGraphExecutor.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/CallGraphExecutor.h"
+
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "vislib/sys/AutoLock.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace megamol::core;
+
+
+/*
+ * utility::CallGraphExecutor::CallGraphExecutor
+ */
+utility::CallGraphExecutor::CallGraphExecutor(void) : entries(), concurrent(0) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::CallGraphExecutor::~CallGraphExecutor
+ */
+utility::CallGraphExecutor::~CallGraphExecutor(void) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::CallGraphExecutor::Add
+ */
+void utility::CallGraphExecutor::Add(Call& call, unsigned int func) {
+    Entry e;
+    e.call = &call;
+    e.func = func;
+    e.succeeded = false;
+    this->entries.push_back(e);
+}
+
+
+/*
+ * utility::CallGraphExecutor::Clear
+ */
+void utility::CallGraphExecutor::Clear(void) {
+    this->entries.clear();
+    this->concurrent = 0;
+}
+
+
+/*
+ * utility::CallGraphExecutor::Run
+ */
+bool utility::CallGraphExecutor::Run(void) {
+    this->concurrent = 0;
+    if (this->entries.empty()) return true;
+
+    const CalleeSlot* anyCallee = nullptr;
+    for (const Entry& e : this->entries) {
+        if (e.call->PeekCalleeSlot() != nullptr) anyCallee = e.call->PeekCalleeSlot();
+    }
+    if (anyCallee == nullptr) {
+        for (Entry& e : this->entries) e.succeeded = false;
+        return false;
+    }
+    // On workers the thread which issued the outer run already holds the lock for its whole duration
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    std::unique_ptr<vislib::sys::AutoLock> lock;
+    if (!scheduler.IsWorkerThread()) {
+        lock.reset(new vislib::sys::AutoLock(anyCallee->ModuleGraphLock()));
+    }
+
+    // Subtrees sharing a module stay on this thread, as modules are not reentrant
+    const size_t cnt = this->entries.size();
+    std::vector<std::set<const Module*>> subtrees(cnt);
+    std::vector<bool> onWorker(cnt, false);
+    for (size_t i = 0; i < cnt; ++i) {
+        onWorker[i] = collectSubtree(*this->entries[i].call, subtrees[i]);
+    }
+    for (size_t i = 0; i < cnt; ++i) {
+        for (size_t j = i + 1; j < cnt; ++j) {
+            const bool shared = std::any_of(subtrees[i].begin(), subtrees[i].end(),
+                [&subtrees, j](const Module* m) { return subtrees[j].count(m) > 0; });
+            if (shared) {
+                onWorker[i] = false;
+                onWorker[j] = false;
+            }
+        }
+    }
+
+    // This thread runs its own calls, or one of the others, instead of idling
+    std::vector<size_t> local;
+    std::vector<size_t> remote;
+    for (size_t i = 0; i < cnt; ++i) {
+        (onWorker[i] ? remote : local).push_back(i);
+    }
+    if (local.empty()) {
+        local.push_back(remote.back());
+        remote.pop_back();
+    }
+
+    std::vector<TaskScheduler::TaskHandle> tasks;
+    tasks.reserve(remote.size());
+    for (size_t i : remote) {
+        Entry* e = &this->entries[i];
+        tasks.push_back(scheduler.Submit([e](const TaskScheduler::Task&) { issue(*e); },
+            TaskScheduler::Priority::INTERACTIVE));
+    }
+    this->concurrent = tasks.size();
+
+    for (size_t i : local) {
+        issue(this->entries[i]);
+    }
+    for (const TaskScheduler::TaskHandle& t : tasks) {
+        t->Wait();
+    }
+
+    return std::all_of(this->entries.begin(), this->entries.end(), [](const Entry& e) { return e.succeeded; });
+}
+
+
+/*
+ * utility::CallGraphExecutor::collectSubtree
+ */
+bool utility::CallGraphExecutor::collectSubtree(const Call& call, std::set<const Module*>& modules) {
+    bool callable = true;
+    std::vector<const Call*> stack(1, &call);
+    while (!stack.empty()) {
+        const Call* c = stack.back();
+        stack.pop_back();
+        if (c->PeekCalleeSlot() == nullptr) continue;
+        const Module* mod = dynamic_cast<const Module*>(c->PeekCalleeSlot()->Parent().get());
+        if (mod == nullptr) {
+            callable = false;
+            continue;
+        }
+        if (!modules.insert(mod).second) continue;
+        callable = callable && mod->IsCallableFromWorkerThreads();
+
+        for (auto child = mod->ChildList_Begin(); child != mod->ChildList_End(); ++child) {
+            CallerSlot* caller = dynamic_cast<CallerSlot*>(child->get());
+            if (caller == nullptr) continue;
+            const Call* next = caller->CallAs<Call>();
+            if (next != nullptr) stack.push_back(next);
+        }
+    }
+    return callable;
+}
+
+
+/*
+ * utility::CallGraphExecutor::issue
+ */
+bool utility::CallGraphExecutor::issue(Entry& entry) {
+    entry.succeeded = false;
+    try {
+        entry.succeeded = (*entry.call)(entry.func);
+    } catch (...) {
+    }
+    return entry.succeeded;
+}
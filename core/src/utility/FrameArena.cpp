@@ -0,0 +1,108 @@
+/*
+ * FrameArena.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/FrameArena.h"
+
+#include "vislib/IllegalParamException.h"
+
+#include <algorithm>
+
+using namespace megamol::core;
+
+
+/*
+ * utility::FrameArena::FrameArena
+ */
+utility::FrameArena::FrameArena(size_t blockSize)
+    : blockSize(std::max<size_t>(blockSize, 64)), blocks(), current(0), offset(0), used(0), generation(0) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::FrameArena::~FrameArena
+ */
+utility::FrameArena::~FrameArena(void) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::FrameArena::Reset
+ */
+bool utility::FrameArena::Reset(uint64_t generation) {
+    if (generation == this->generation) return false;
+    this->Reset();
+    this->generation = generation;
+    return true;
+}
+
+
+/*
+ * utility::FrameArena::Reset
+ */
+void utility::FrameArena::Reset(void) {
+    if (this->current > 0) {
+        // the generation did not fit into one block, so the next one gets a block for all of it
+        Block merged;
+        merged.size = this->Capacity();
+        merged.memory.reset(new uint8_t[merged.size]);
+        this->blocks.clear();
+        this->blocks.push_back(std::move(merged));
+    }
+    this->current = 0;
+    this->offset = 0;
+    this->used = 0;
+    ++this->generation;
+}
+
+
+/*
+ * utility::FrameArena::Allocate
+ */
+void* utility::FrameArena::Allocate(size_t size, size_t alignment) {
+    if ((alignment == 0) || ((alignment & (alignment - 1)) != 0)) {
+        throw vislib::IllegalParamException("alignment", __FILE__, __LINE__);
+    }
+    if (size == 0) size = 1;
+
+    while (this->current < this->blocks.size()) {
+        Block& b = this->blocks[this->current];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(b.memory.get());
+        const uintptr_t aligned = (base + this->offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        const size_t start = static_cast<size_t>(aligned - base);
+        if (start + size <= b.size) {
+            this->offset = start + size;
+            this->used += size;
+            return b.memory.get() + start;
+        }
+        if (this->current + 1 == this->blocks.size()) break;
+        ++this->current;
+        this->offset = 0;
+    }
+
+    Block b;
+    b.size = std::max(this->blockSize, size + alignment);
+    b.memory.reset(new uint8_t[b.size]);
+    if (!this->blocks.empty()) ++this->current;
+    this->blocks.push_back(std::move(b));
+    this->offset = 0;
+    return this->Allocate(size, alignment);
+}
+
+
+/*
+ * utility::FrameArena::Capacity
+ */
+size_t utility::FrameArena::Capacity(void) const {
+    size_t capacity = 0;
+    for (const Block& b : this->blocks) {
+        capacity += b.size;
+    }
+    return capacity;
+}
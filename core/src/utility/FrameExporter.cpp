@@ -0,0 +1,282 @@
+/*
+ * FrameExporter.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/FrameExporter.h"
+
+#include "png.h"
+#include "vislib/Exception.h"
+#include "vislib/sys/FastFile.h"
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace megamol::core;
+
+
+namespace {
+
+    void PNGAPI pngError(png_structp pngPtr, png_const_charp msg) {
+        throw vislib::Exception(msg, __FILE__, __LINE__);
+    }
+
+    void PNGAPI pngWarn(png_structp pngPtr, png_const_charp msg) {
+        vislib::sys::Log::DefaultLog.WriteWarn("FrameExporter: Png-Warning: %s", msg);
+    }
+
+    void PNGAPI pngWrite(png_structp pngPtr, png_bytep buf, png_size_t size) {
+        vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
+        if (f->Write(buf, size) != size) {
+            png_error(pngPtr, "Cannot write to file");
+        }
+    }
+
+    void PNGAPI pngFlush(png_structp pngPtr) {
+        vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
+        f->Flush();
+    }
+
+    /** Writes a frame stored bottom up to a png file */
+    bool writePng(const std::string& filename, const std::vector<png_byte>& pixels, unsigned int width,
+        unsigned int height, bool alpha) {
+        vislib::sys::FastFile file;
+        if (!file.Open(filename.c_str(), vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE,
+                vislib::sys::File::CREATE_OVERWRITE)) {
+            vislib::sys::Log::DefaultLog.WriteError("FrameExporter: cannot open \"%s\"", filename.c_str());
+            return false;
+        }
+
+        png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, &pngError, &pngWarn);
+        png_infop infoPtr = (pngPtr != nullptr) ? png_create_info_struct(pngPtr) : nullptr;
+        bool ok = (infoPtr != nullptr);
+        if (ok) {
+            try {
+                const size_t rowSize = static_cast<size_t>(width) * (alpha ? 4 : 3);
+                std::vector<png_bytep> rows(height);
+                for (unsigned int i = 0; i < height; ++i) {
+                    rows[height - (1 + i)] = const_cast<png_bytep>(pixels.data()) + i * rowSize;
+                }
+                png_set_write_fn(pngPtr, static_cast<void*>(&file), &pngWrite, &pngFlush);
+                png_set_IHDR(pngPtr, infoPtr, width, height, 8, alpha ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB,
+                    PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+                png_set_rows(pngPtr, infoPtr, rows.data());
+                png_write_png(pngPtr, infoPtr, PNG_TRANSFORM_IDENTITY, nullptr);
+            } catch (const vislib::Exception& ex) {
+                vislib::sys::Log::DefaultLog.WriteError(
+                    "FrameExporter: cannot write \"%s\": %s", filename.c_str(), ex.GetMsgA());
+                ok = false;
+            }
+        } else {
+            vislib::sys::Log::DefaultLog.WriteError("FrameExporter: cannot create png structure");
+        }
+        if (pngPtr != nullptr) {
+            png_destroy_write_struct(&pngPtr, (infoPtr != nullptr) ? &infoPtr : nullptr);
+        }
+
+        try {
+            file.Close();
+        } catch (...) {
+            ok = false;
+        }
+        if (!ok) {
+            try {
+                vislib::sys::File::Delete(filename.c_str());
+            } catch (...) {
+            }
+        }
+        return ok;
+    }
+
+}
+
+
+/*
+ * utility::FrameExporter::FrameExporter
+ */
+utility::FrameExporter::FrameExporter(unsigned int ringSize, unsigned int maxEncoding)
+    : ringSize(std::max(1u, ringSize))
+    , maxEncoding(std::max(1u, maxEncoding))
+    , reading()
+    , freeBuffers()
+    , bufferSize(0)
+    , encoding()
+    , failed(std::make_shared<std::atomic<bool>>(false)) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::FrameExporter::~FrameExporter
+ */
+utility::FrameExporter::~FrameExporter(void) {
+    this->Finish();
+}
+
+
+/*
+ * utility::FrameExporter::Export
+ */
+bool utility::FrameExporter::Export(
+    vislib::graphics::gl::FramebufferObject& fbo, const std::string& filename, bool alpha) {
+    const unsigned int width = fbo.GetWidth();
+    const unsigned int height = fbo.GetHeight();
+    const size_t size = static_cast<size_t>(width) * height * (alpha ? 4 : 3);
+    if (size == 0) return false;
+
+    if (size != this->bufferSize) {
+        // the buffers are only reused for frames of the same size
+        while (!this->reading.empty()) {
+            this->encode(this->reading.front());
+            this->reading.pop_front();
+        }
+        if (!this->freeBuffers.empty()) {
+            glDeleteBuffers(static_cast<GLsizei>(this->freeBuffers.size()), this->freeBuffers.data());
+            this->freeBuffers.clear();
+        }
+        this->bufferSize = size;
+    }
+
+    if (this->freeBuffers.empty()) {
+        if (this->reading.size() >= this->ringSize) {
+            // the ring is full, the oldest frame has to leave
+            this->encode(this->reading.front());
+            this->reading.pop_front();
+        } else {
+            GLuint buffer = 0;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            this->freeBuffers.push_back(buffer);
+        }
+    }
+
+    Readback rb;
+    rb.buffer = this->freeBuffers.back();
+    this->freeBuffers.pop_back();
+    rb.filename = filename;
+    rb.width = width;
+    rb.height = height;
+    rb.alpha = alpha;
+
+    GLint oldAlignment = 4;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &oldAlignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.buffer);
+    // with a pack buffer bound, this only starts the read
+    GLenum err = fbo.GetColourTexture(nullptr, 0, alpha ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, oldAlignment);
+    if (err != GL_NO_ERROR) {
+        vislib::sys::Log::DefaultLog.WriteError("FrameExporter: cannot read frame for \"%s\"", filename.c_str());
+        this->freeBuffers.push_back(rb.buffer);
+        return false;
+    }
+    rb.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->reading.push_back(rb);
+
+    this->Poll();
+    return !this->failed->load();
+}
+
+
+/*
+ * utility::FrameExporter::Poll
+ */
+void utility::FrameExporter::Poll(void) {
+    while (!this->reading.empty()) {
+        GLenum state = glClientWaitSync(this->reading.front().fence, 0, 0);
+        if (state == GL_TIMEOUT_EXPIRED) break;
+        this->encode(this->reading.front());
+        this->reading.pop_front();
+    }
+}
+
+
+/*
+ * utility::FrameExporter::Finish
+ */
+bool utility::FrameExporter::Finish(void) {
+    while (!this->reading.empty()) {
+        this->encode(this->reading.front());
+        this->reading.pop_front();
+    }
+    this->limitEncodings(0);
+    if (!this->freeBuffers.empty()) {
+        glDeleteBuffers(static_cast<GLsizei>(this->freeBuffers.size()), this->freeBuffers.data());
+        this->freeBuffers.clear();
+    }
+    this->bufferSize = 0;
+    return !this->failed->exchange(false);
+}
+
+
+/*
+ * utility::FrameExporter::Pending
+ */
+size_t utility::FrameExporter::Pending(void) const {
+    size_t cnt = this->reading.size();
+    for (const auto& task : this->encoding) {
+        if (!task->IsDone()) ++cnt;
+    }
+    return cnt;
+}
+
+
+/*
+ * utility::FrameExporter::encode
+ */
+void utility::FrameExporter::encode(Readback& rb) {
+    // backpressure: the copy below is what an encoding holds on to
+    this->limitEncodings(this->maxEncoding - 1);
+
+    // mapping waits for the read if it has not finished yet
+    auto pixels = std::make_shared<std::vector<png_byte>>(this->bufferSize);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.buffer);
+    const void* ptr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    bool mapped = (ptr != nullptr);
+    if (mapped) {
+        ::memcpy(pixels->data(), ptr, pixels->size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteSync(rb.fence);
+    rb.fence = nullptr;
+    this->freeBuffers.push_back(rb.buffer);
+
+    if (!mapped) {
+        vislib::sys::Log::DefaultLog.WriteError("FrameExporter: cannot map frame for \"%s\"", rb.filename.c_str());
+        this->failed->store(true);
+        return;
+    }
+
+    auto failed = this->failed;
+    const std::string filename = rb.filename;
+    const unsigned int width = rb.width;
+    const unsigned int height = rb.height;
+    const bool alpha = rb.alpha;
+    this->encoding.push_back(TaskScheduler::Instance().Submit(
+        [failed, pixels, filename, width, height, alpha](const TaskScheduler::Task&) {
+            if (!writePng(filename, *pixels, width, height, alpha)) failed->store(true);
+        },
+        TaskScheduler::Priority::BACKGROUND));
+}
+
+
+/*
+ * utility::FrameExporter::limitEncodings
+ */
+void utility::FrameExporter::limitEncodings(size_t count) {
+    while (!this->encoding.empty() && this->encoding.front()->IsDone()) {
+        this->encoding.pop_front();
+    }
+    while (this->encoding.size() > count) {
+        this->encoding.front()->Wait();
+        this->encoding.pop_front();
+    }
+}
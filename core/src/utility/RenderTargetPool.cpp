@@ -0,0 +1,167 @@
+/*
+ * RenderTargetPool.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/RenderTargetPool.h"
+
+#include <algorithm>
+
+using namespace megamol::core;
+
+
+/*
+ * utility::RenderTargetPool::Instance
+ */
+utility::RenderTargetPool& utility::RenderTargetPool::Instance(void) {
+    static RenderTargetPool instance;
+    return instance;
+}
+
+
+/*
+ * utility::RenderTargetPool::Acquire
+ */
+utility::RenderTargetPool::lease_type utility::RenderTargetPool::Acquire(
+        int width, int height, const std::vector<Attachment>& attachments, bool depth) {
+    Key key;
+    key.width = std::max(width, 1);
+    key.height = std::max(height, 1);
+    key.attachments = attachments;
+    key.depth = depth;
+    const size_t bytes = estimateBytes(key);
+
+    std::unique_ptr<glowl::FramebufferObject> fbo;
+    {
+        std::lock_guard<std::mutex> guard(this->state->lock);
+        // Search from the back to reuse the most recently returned one
+        auto hit = std::find_if(this->state->free.rbegin(), this->state->free.rend(),
+            [&key](const Entry& e) { return e.key == key; });
+        if (hit != this->state->free.rend()) {
+            fbo = std::move(hit->fbo);
+            this->state->freeBytes -= hit->bytes;
+            this->state->free.erase(std::next(hit).base());
+        }
+        this->state->leasedBytes += bytes;
+    }
+    if (!fbo) {
+        fbo.reset(new glowl::FramebufferObject(key.width, key.height, key.depth));
+        for (const Attachment& a : key.attachments) {
+            fbo->createColorAttachment(a.internalFormat, a.format, a.type);
+        }
+    }
+
+    std::weak_ptr<State> owner = this->state;
+    return lease_type(fbo.release(), [owner, key, bytes](glowl::FramebufferObject* f) {
+        std::unique_ptr<glowl::FramebufferObject> fbo(f);
+        auto state = owner.lock();
+        if (!state) return;
+        std::lock_guard<std::mutex> guard(state->lock);
+        state->leasedBytes -= bytes;
+        // A lessee may have resized the framebuffer object
+        if ((fbo->getWidth() != key.width) || (fbo->getHeight() != key.height)) return;
+        Entry e;
+        e.key = key;
+        e.fbo = std::move(fbo);
+        e.bytes = bytes;
+        state->free.push_back(std::move(e));
+        state->freeBytes += bytes;
+        state->Shrink(state->maxFreeBytes);
+    });
+}
+
+
+/*
+ * utility::RenderTargetPool::Trim
+ */
+void utility::RenderTargetPool::Trim(void) {
+    std::lock_guard<std::mutex> guard(this->state->lock);
+    this->state->Shrink(0);
+}
+
+
+/*
+ * utility::RenderTargetPool::SetMaxFreeBytes
+ */
+void utility::RenderTargetPool::SetMaxFreeBytes(size_t bytes) {
+    std::lock_guard<std::mutex> guard(this->state->lock);
+    this->state->maxFreeBytes = bytes;
+    this->state->Shrink(bytes);
+}
+
+
+/*
+ * utility::RenderTargetPool::LeasedBytes
+ */
+size_t utility::RenderTargetPool::LeasedBytes(void) const {
+    std::lock_guard<std::mutex> guard(this->state->lock);
+    return this->state->leasedBytes;
+}
+
+
+/*
+ * utility::RenderTargetPool::FreeBytes
+ */
+size_t utility::RenderTargetPool::FreeBytes(void) const {
+    std::lock_guard<std::mutex> guard(this->state->lock);
+    return this->state->freeBytes;
+}
+
+
+/*
+ * utility::RenderTargetPool::State::Shrink
+ */
+void utility::RenderTargetPool::State::Shrink(size_t maxBytes) {
+    size_t cnt = 0;
+    while ((this->freeBytes > maxBytes) && (cnt < this->free.size())) {
+        this->freeBytes -= this->free[cnt].bytes;
+        cnt++;
+    }
+    this->free.erase(this->free.begin(), this->free.begin() + cnt);
+}
+
+
+/*
+ * utility::RenderTargetPool::estimateBytes
+ */
+size_t utility::RenderTargetPool::estimateBytes(const Key& key) {
+    size_t bpp = key.depth ? 4 : 0;
+    for (const Attachment& a : key.attachments) {
+        switch (a.internalFormat) {
+        case GL_R8: bpp += 1; break;
+        case GL_RG8: case GL_R16F: bpp += 2; break;
+        case GL_RGB16F: bpp += 6; break;
+        case GL_RG16F: case GL_R32F: case GL_RGBA8: case GL_RGB10_A2: case GL_R11F_G11F_B10F: bpp += 4; break;
+        case GL_RGBA16F: case GL_RG32F: bpp += 8; break;
+        case GL_RGB32F: bpp += 12; break;
+        case GL_RGBA32F: bpp += 16; break;
+        default: bpp += 4; break;
+        }
+    }
+    return static_cast<size_t>(key.width) * static_cast<size_t>(key.height) * bpp;
+}
+
+
+/*
+ * utility::RenderTargetPool::RenderTargetPool
+ */
+utility::RenderTargetPool::RenderTargetPool(void) : state(std::make_shared<State>()) {
+    this->state->freeBytes = 0;
+    this->state->leasedBytes = 0;
+    this->state->maxFreeBytes = static_cast<size_t>(256) << 20;
+}
+
+
+/*
+ * utility::RenderTargetPool::~RenderTargetPool
+ */
+utility::RenderTargetPool::~RenderTargetPool(void) {
+    std::lock_guard<std::mutex> guard(this->state->lock);
+    for (Entry& e : this->state->free) {
+        e.fbo.release();
+    }
+    this->state->free.clear();
+}
@@ -0,0 +1,261 @@
+/*
+ * ResultCache.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/ResultCache.h"
+
+#include "mmcore/param/AbstractParam.h"
+#include "vislib/sys/Log.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace megamol::core;
+
+
+namespace {
+
+    /** 64 bit FNV-1a, continuing from 'hash' */
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+}
+
+
+/*
+ * utility::ResultCache::Instance
+ */
+utility::ResultCache& utility::ResultCache::Instance(void) {
+    static ResultCache cache;
+    return cache;
+}
+
+
+/*
+ * utility::ResultCache::MakeKey
+ */
+utility::ResultCache::key_type utility::ResultCache::MakeKey(const vislib::StringA& owner, size_t dataHash,
+    unsigned int frameID, std::initializer_list<const param::ParamSlot*> params) {
+    const uint64_t hash64 = static_cast<uint64_t>(dataHash);
+    key_type key = fnv1a(owner.PeekBuffer(), owner.Length());
+    key = fnv1a(&hash64, sizeof(hash64), key);
+    key = fnv1a(&frameID, sizeof(frameID), key);
+    for (const param::ParamSlot* slot : params) {
+        const param::AbstractParam* p = (slot != nullptr) ? slot->Param<param::AbstractParam>() : nullptr;
+        if (p == nullptr) continue;
+        const vislib::StringA value(p->ValueString());
+        key = fnv1a(value.PeekBuffer(), value.Length() + 1, key); // including the terminator as separator
+    }
+    return key;
+}
+
+
+/*
+ * utility::ResultCache::Find
+ */
+utility::ResultCache::value_type utility::ResultCache::Find(key_type key) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    auto it = this->residentLookup.find(key);
+    if (it != this->residentLookup.end()) {
+        this->resident.splice(this->resident.begin(), this->resident, it->second);
+        ++this->hits;
+        return it->second->second;
+    }
+
+    auto sit = this->spilledLookup.find(key);
+    if (sit != this->spilledLookup.end()) {
+        const std::string path = this->spillFile(key);
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        auto data = std::make_shared<std::vector<unsigned char>>(sit->second->second);
+        if (file.good() && file.read(reinterpret_cast<char*>(data->data()), data->size())) {
+            // back to memory; the spill file is written again when evicted
+            this->spilledBytes -= sit->second->second;
+            this->spilled.erase(sit->second);
+            this->spilledLookup.erase(sit);
+            file.close();
+            std::remove(path.c_str());
+
+            this->resident.emplace_front(key, data);
+            this->residentLookup[key] = this->resident.begin();
+            this->residentBytes += data->size();
+            this->enforceBudgets();
+            ++this->hits;
+            return data;
+        }
+        vislib::sys::Log::DefaultLog.WriteWarn("Result cache: unable to read spill file \"%s\"", path.c_str());
+        this->spilledBytes -= sit->second->second;
+        this->spilled.erase(sit->second);
+        this->spilledLookup.erase(sit);
+    }
+
+    ++this->misses;
+    return nullptr;
+}
+
+
+/*
+ * utility::ResultCache::Store
+ */
+void utility::ResultCache::Store(key_type key, std::vector<unsigned char>&& data) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if (this->budget == 0) return;
+
+    auto it = this->residentLookup.find(key);
+    if (it != this->residentLookup.end()) {
+        this->residentBytes -= it->second->second->size();
+        this->resident.erase(it->second);
+        this->residentLookup.erase(it);
+    }
+
+    auto value = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+    this->resident.emplace_front(key, value);
+    this->residentLookup[key] = this->resident.begin();
+    this->residentBytes += value->size();
+    this->enforceBudgets();
+}
+
+
+/*
+ * utility::ResultCache::Clear
+ */
+void utility::ResultCache::Clear(void) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->resident.clear();
+    this->residentLookup.clear();
+    this->residentBytes = 0;
+    for (const auto& s : this->spilled) {
+        std::remove(this->spillFile(s.first).c_str());
+    }
+    this->spilled.clear();
+    this->spilledLookup.clear();
+    this->spilledBytes = 0;
+}
+
+
+/*
+ * utility::ResultCache::SetBudget
+ */
+void utility::ResultCache::SetBudget(size_t bytes) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->budget = bytes;
+    this->enforceBudgets();
+}
+
+
+/*
+ * utility::ResultCache::SetSpillDirectory
+ */
+void utility::ResultCache::SetSpillDirectory(const std::string& dir, size_t bytes) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    for (const auto& s : this->spilled) {
+        std::remove(this->spillFile(s.first).c_str());
+    }
+    this->spilled.clear();
+    this->spilledLookup.clear();
+    this->spilledBytes = 0;
+
+    this->spillDir = dir;
+    if (!this->spillDir.empty() && (this->spillDir.back() != '/') && (this->spillDir.back() != '\\')) {
+        this->spillDir += '/';
+    }
+    this->spillBudget = bytes;
+}
+
+
+/*
+ * utility::ResultCache::GetStatistics
+ */
+void utility::ResultCache::GetStatistics(size_t& hits, size_t& misses) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    hits = this->hits;
+    misses = this->misses;
+}
+
+
+/*
+ * utility::ResultCache::ResultCache
+ */
+utility::ResultCache::ResultCache(void)
+    : resident()
+    , residentLookup()
+    , residentBytes(0)
+    , budget(256ull << 20)
+    , spilled()
+    , spilledLookup()
+    , spilledBytes(0)
+    , spillBudget(0)
+    , spillDir()
+    , hits(0)
+    , misses(0)
+    , lock() {
+    // intentionally empty
+}
+
+
+/*
+ * utility::ResultCache::~ResultCache
+ */
+utility::ResultCache::~ResultCache(void) {
+    // spill files are only meaningful for this process
+    for (const auto& s : this->spilled) {
+        std::remove(this->spillFile(s.first).c_str());
+    }
+}
+
+
+/*
+ * utility::ResultCache::enforceBudgets
+ */
+void utility::ResultCache::enforceBudgets(void) {
+    while ((this->residentBytes > this->budget) && !this->resident.empty()) {
+        const entry_type& victim = this->resident.back();
+        const size_t size = victim.second->size();
+
+        if (!this->spillDir.empty() && (size <= this->spillBudget)) {
+            const std::string path = this->spillFile(victim.first);
+            std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (file.write(reinterpret_cast<const char*>(victim.second->data()), size)) {
+                this->spilled.emplace_front(victim.first, size);
+                this->spilledLookup[victim.first] = this->spilled.begin();
+                this->spilledBytes += size;
+            } else {
+                vislib::sys::Log::DefaultLog.WriteWarn("Result cache: unable to write spill file \"%s\"", path.c_str());
+                file.close();
+                std::remove(path.c_str());
+            }
+        }
+
+        this->residentBytes -= size;
+        this->residentLookup.erase(victim.first);
+        this->resident.pop_back();
+    }
+
+    while ((this->spilledBytes > this->spillBudget) && !this->spilled.empty()) {
+        const auto& victim = this->spilled.back();
+        std::remove(this->spillFile(victim.first).c_str());
+        this->spilledBytes -= victim.second;
+        this->spilledLookup.erase(victim.first);
+        this->spilled.pop_back();
+    }
+}
+
+
+/*
+ * utility::ResultCache::spillFile
+ */
+std::string utility::ResultCache::spillFile(key_type key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.mmcache", static_cast<unsigned long long>(key));
+    return this->spillDir + name;
+}
@@ -9,6 +9,10 @@
 #include "mmcore/utility/SSBOStreamer.h"
 #include <algorithm>
 #include "vislib/assert.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -42,6 +46,15 @@ GLuint SSBOStreamer::SetDataWithSize(const void *data, GLuint srcStride, GLuint
         return 0;
     }
 
+    if (this->autoSizing) {
+        numBuffers = std::max(numBuffers, this->autoNumBuffers);
+        if (this->autoBufferSize != 0) {
+            // keep at least one aligned item per chunk
+            bufferSize = std::max(std::min(bufferSize, this->autoBufferSize),
+                GetNumItemsPerChunkAligned(1, true) * dstStride);
+        }
+    }
+
     genBufferAndMap(numBuffers, bufferSize);
 
     this->dstStride = dstStride;
@@ -79,9 +92,26 @@ void SSBOStreamer::genBufferAndMap(GLuint numBuffers, GLuint bufferSize) {
     }
     if (bufferSize != this->bufferSize || numBuffers != this->numBuffers) {
         if (this->mappedMem != nullptr && this->theSSBO != 0) {
+            // the storage is immutable, so resizing needs a new buffer. The old one is only
+            // released once the GPU is done with it, and its fences are not needed anymore.
             glUnmapNamedBuffer(this->theSSBO);
+            glDeleteBuffers(1, &this->theSSBO);
+            glGenBuffers(1, &this->theSSBO);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->theSSBO);
+#if _DEBUG
+            glObjectLabel(GL_BUFFER, this->theSSBO, debugLabel.length(), debugLabel.c_str());
+#endif
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            this->mappedMem = nullptr;
+            this->currIdx = 0;
+        }
+        for (auto &x : fences) {
+            if (x) {
+                glDeleteSync(x);
+            }
         }
-        const size_t mapSize = bufferSize * numBuffers;
+        this->fences.clear();
+        const size_t mapSize = static_cast<size_t>(bufferSize) * numBuffers;
         glNamedBufferStorage(this->theSSBO, mapSize, nullptr,
                              GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT);
         this->mappedMem = glMapNamedBufferRange(this->theSSBO, 0,
@@ -107,6 +137,10 @@ GLuint SSBOStreamer::SetDataWithItems(const void *data, GLuint srcStride, GLuint
 
     const GLuint bufferSize = numItemsPerChunk * dstStride;
 
+    if (this->autoSizing) {
+        numBuffers = std::max(numBuffers, this->autoNumBuffers);
+    }
+
     genBufferAndMap(numBuffers, bufferSize);
 
     this->dstStride = dstStride;
@@ -137,19 +171,29 @@ void SSBOStreamer::UploadChunk(unsigned int idx, GLuint& numItems, unsigned int&
     //printf("going to upload %llu x %u bytes to offset %lld from %lld\n", itemsThisTime,
     //    this->dstStride, dstOffset, srcOffset);
 
-    waitSignal(this->fences[currIdx]);
+    const auto beforeWait = std::chrono::steady_clock::now();
+    if (waitSignal(this->fences[currIdx])) {
+        ++this->currentFrame.numStalls;
+        this->currentFrame.stallTime +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beforeWait).count();
+    }
 
     // either we can grab all the data at once or we need the copyOp to re-arrange stuff for us
     ASSERT(this->srcStride == this->dstStride || copyOp);
 
+    const auto beforeCopy = std::chrono::steady_clock::now();
     if (copyOp) {
 #pragma omp parallel for
         for (int64_t i = 0; i < itemsThisTime; ++i) {
             copyOp(dst + i * this->dstStride, src + i * this->srcStride);
         }
     } else {
-        memcpy(dst, src, itemsThisTime * this->srcStride);
+        parallelCopy(dst, src, itemsThisTime * this->srcStride);
     }
+    ++this->currentFrame.numUploads;
+    this->currentFrame.numBytes += itemsThisTime * this->dstStride;
+    this->currentFrame.copyTime +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beforeCopy).count();
 
     glFlushMappedNamedBufferRange(this->theSSBO, 
         dstOffset, itemsThisTime * this->dstStride);
@@ -163,6 +207,76 @@ void SSBOStreamer::SignalCompletion(unsigned int sync) {
     queueSignal(this->fences[sync]);
 }
 
+void SSBOStreamer::SetAutoSizing(bool enable, GLuint maxNumBuffers, double targetChunkTime) {
+    this->autoSizing = enable;
+    this->maxNumBuffers = std::max(maxNumBuffers, 1u);
+    this->targetChunkTime = targetChunkTime;
+    this->autoNumBuffers = 0;
+    this->autoBufferSize = 0;
+}
+
+void SSBOStreamer::NewFrame() {
+    this->lastFrame = this->currentFrame;
+    this->currentFrame = Statistics();
+
+    // smooth the bandwidth over frames, measuring only frames with a reasonable amount of data
+    if (this->lastFrame.copyTime > 0.0 && this->lastFrame.numBytes >= 1024 * 1024) {
+        const double bandwidth = this->lastFrame.numBytes / (this->lastFrame.copyTime / 1000.0);
+        this->uploadBandwidth =
+            this->uploadBandwidth == 0.0 ? bandwidth : 0.8 * this->uploadBandwidth + 0.2 * bandwidth;
+    }
+
+    if (!this->autoSizing) return;
+
+    // a longer ring lets the GPU work on more chunks before the CPU has to wait
+    if (this->lastFrame.numStalls > 0) {
+        this->autoNumBuffers = std::min(std::max(this->autoNumBuffers, this->numBuffers) + 1, this->maxNumBuffers);
+    }
+
+    // chunks in multiples of 1 MB, only changing the size if it is off by more than a factor of two,
+    // as every change reallocates the buffer
+    if (this->uploadBandwidth > 0.0) {
+        const double megabyte = 1024.0 * 1024.0;
+        const double targetSize = std::min(this->uploadBandwidth * this->targetChunkTime / 1000.0, 1024.0 * megabyte);
+        const auto size = static_cast<GLuint>(std::max(1.0, std::round(targetSize / megabyte)) * megabyte);
+        if (this->autoBufferSize == 0 || size > 2 * this->autoBufferSize || 2 * size < this->autoBufferSize) {
+            this->autoBufferSize = size;
+        }
+    }
+}
+
+void SSBOStreamer::parallelCopy(char* dst, const char* src, size_t numBytes) const {
+    // below this size per thread, the threading overhead outweighs the gain
+    const size_t minBytesPerThread = 256 * 1024;
+    const size_t cacheLine = 64;
+
+    const auto numRanges =
+        static_cast<int>(std::max<size_t>(1, std::min<size_t>(this->numThr, numBytes / minBytesPerThread)));
+    if (numRanges == 1) {
+        memcpy(dst, src, numBytes);
+        return;
+    }
+
+    // range boundaries are aligned to the cache lines of the destination, such
+    // that no two threads write to the same line of the write-combined memory
+    const uintptr_t base = reinterpret_cast<uintptr_t>(dst);
+    const size_t rangeSize = numBytes / numRanges;
+    const auto boundary = [&](int r) -> size_t {
+        if (r == numRanges) return numBytes;
+        const uintptr_t aligned = (base + r * rangeSize + cacheLine - 1) / cacheLine * cacheLine;
+        return std::min<size_t>(aligned - base, numBytes);
+    };
+
+#pragma omp parallel for num_threads(numRanges)
+    for (int r = 0; r < numRanges; ++r) {
+        const size_t begin = boundary(r);
+        const size_t end = boundary(r + 1);
+        if (end > begin) {
+            memcpy(dst + begin, src + begin, end - begin);
+        }
+    }
+}
+
 
 void SSBOStreamer::queueSignal(GLsync& syncObj) {
     if (syncObj) {
@@ -171,14 +285,18 @@ void SSBOStreamer::queueSignal(GLsync& syncObj) {
     syncObj = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
 
-void SSBOStreamer::waitSignal(GLsync& syncObj) {
+bool SSBOStreamer::waitSignal(GLsync& syncObj) {
     if (syncObj) {
+        if (glClientWaitSync(syncObj, 0, 0) == GL_ALREADY_SIGNALED) {
+            return false;
+        }
         //XXX: Spinlocks in user code are a really bad idea.
         while (true) {
             const GLenum wait = glClientWaitSync(syncObj, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
             if (wait == GL_ALREADY_SIGNALED || wait == GL_CONDITION_SATISFIED) {
-                return;
+                return true;
             }
         }
     }
+    return false;
 }
@@ -0,0 +1,429 @@
+/*
+ * TaskScheduler.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/TaskScheduler.h"
+
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+using namespace megamol::core;
+
+
+namespace {
+
+    /** The scheduler and index of the worker running on this thread */
+    thread_local const utility::TaskScheduler* currentScheduler = nullptr;
+    thread_local int currentWorker = -1;
+
+}
+
+
+/*
+ * utility::TaskScheduler::Task::Task
+ */
+utility::TaskScheduler::Task::Task(TaskScheduler& owner, work_type&& work, Priority prio)
+    : owner(owner), work(std::move(work)), prio(prio), pending(1), cancelled(false), done(false), continuations() {
+    // intentionally empty
+}
+
+
+/*
+ * utility::TaskScheduler::Task::IsDone
+ */
+bool utility::TaskScheduler::Task::IsDone(void) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->done;
+}
+
+
+/*
+ * utility::TaskScheduler::Task::Cancel
+ */
+void utility::TaskScheduler::Task::Cancel(void) {
+    this->cancelled = true;
+}
+
+
+/*
+ * utility::TaskScheduler::Task::Wait
+ */
+bool utility::TaskScheduler::Task::Wait(int timeoutMillis) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMillis, 0));
+
+    if ((currentScheduler == &this->owner) && (currentWorker >= 0)) {
+        // blocking a worker could starve the task we are waiting for, so help instead
+        while (!this->IsDone()) {
+            if ((timeoutMillis >= 0) && (std::chrono::steady_clock::now() >= deadline)) return false;
+            TaskHandle other;
+            if (this->owner.take(static_cast<unsigned int>(currentWorker), other)) {
+                this->owner.run(other);
+                continue;
+            }
+            std::unique_lock<std::mutex> l(this->lock);
+            if (!this->done) this->finished.wait_for(l, std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    std::unique_lock<std::mutex> l(this->lock);
+    if (timeoutMillis < 0) {
+        this->finished.wait(l, [this]() { return this->done; });
+        return true;
+    }
+    return this->finished.wait_until(l, deadline, [this]() { return this->done; });
+}
+
+
+/*
+ * utility::TaskScheduler::ParallelForException::ParallelForException
+ */
+utility::TaskScheduler::ParallelForException::ParallelForException(std::vector<std::exception_ptr>&& errors)
+    : std::runtime_error("several chunks of a parallel loop failed"), errors(std::move(errors)) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::TaskScheduler::Instance
+ */
+utility::TaskScheduler& utility::TaskScheduler::Instance(void) {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+
+/*
+ * utility::TaskScheduler::Submit
+ */
+utility::TaskScheduler::TaskHandle utility::TaskScheduler::Submit(
+    work_type work, Priority prio, const std::vector<TaskHandle>& after) {
+    TaskHandle task(new Task(*this, std::move(work), prio));
+
+    for (const TaskHandle& pred : after) {
+        if (!pred) continue;
+        std::lock_guard<std::mutex> guard(pred->lock);
+        if (!pred->done) {
+            pred->continuations.push_back(task);
+            ++task->pending;
+        } else if (pred->cancelled) {
+            task->cancelled = true;
+        }
+    }
+
+    this->release(task); // the submission itself
+    return task;
+}
+
+
+/*
+ * utility::TaskScheduler::ParallelFor
+ */
+void utility::TaskScheduler::ParallelFor(int64_t begin, int64_t end,
+    const std::function<void(int64_t, int64_t)>& body, int64_t grain, Priority prio) {
+    if (end <= begin) return;
+    if (grain <= 0) {
+        grain = std::max<int64_t>(1, (end - begin) / (4 * static_cast<int64_t>(this->GetThreadCount())));
+    }
+
+    // the tasks would only log the exceptions, so they are collected here
+    std::mutex errorLock;
+    std::vector<std::exception_ptr> errors;
+    auto chunk = [&body, &errorLock, &errors](int64_t b, int64_t e) {
+        try {
+            body(b, e);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(errorLock);
+            errors.push_back(std::current_exception());
+        }
+    };
+
+    std::vector<TaskHandle> chunks;
+    for (int64_t b = begin + grain; b < end; b += grain) {
+        const int64_t e = std::min(end, b + grain);
+        chunks.push_back(this->Submit([&chunk, b, e](const Task&) { chunk(b, e); }, prio));
+    }
+
+    // the first chunk is ours, the others reference the locals and must be done before we leave
+    chunk(begin, std::min(end, begin + grain));
+    for (const TaskHandle& c : chunks) c->Wait();
+
+    if (errors.size() == 1) std::rethrow_exception(errors.front());
+    if (errors.size() > 1) throw ParallelForException(std::move(errors));
+}
+
+
+/*
+ * utility::TaskScheduler::SetThreadCount
+ */
+void utility::TaskScheduler::SetThreadCount(unsigned int count) {
+    {
+        std::lock_guard<std::mutex> guard(this->stateLock);
+        if (this->threadCount == count) return;
+    }
+    this->Shutdown();
+    std::lock_guard<std::mutex> guard(this->stateLock);
+    this->threadCount = count;
+}
+
+
+/*
+ * utility::TaskScheduler::GetThreadCount
+ */
+unsigned int utility::TaskScheduler::GetThreadCount(void) const {
+    std::lock_guard<std::mutex> guard(this->stateLock);
+    if (this->threadCount > 0) return this->threadCount;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/*
+ * utility::TaskScheduler::IsWorkerThread
+ */
+bool utility::TaskScheduler::IsWorkerThread(void) const {
+    return (currentScheduler == this) && (currentWorker >= 0);
+}
+
+
+/*
+ * utility::TaskScheduler::AddUser
+ */
+void utility::TaskScheduler::AddUser(void) {
+    std::lock_guard<std::mutex> guard(this->stateLock);
+    ++this->users;
+}
+
+
+/*
+ * utility::TaskScheduler::RemoveUser
+ */
+void utility::TaskScheduler::RemoveUser(void) {
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> guard(this->stateLock);
+        if (this->users > 0) --this->users;
+        last = (this->users == 0);
+    }
+    if (last) this->Shutdown();
+}
+
+
+/*
+ * utility::TaskScheduler::Shutdown
+ */
+void utility::TaskScheduler::Shutdown(void) {
+    if (this->IsWorkerThread()) {
+        vislib::sys::Log::DefaultLog.WriteError("TaskScheduler: workers cannot shut down the scheduler");
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(this->stateLock);
+    if (this->workers.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> sleepGuard(this->sleepLock);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (auto& w : this->workers) {
+        w->thread.join();
+    }
+    this->workers.clear();
+}
+
+
+/*
+ * utility::TaskScheduler::TaskScheduler
+ */
+utility::TaskScheduler::TaskScheduler(void)
+    : workers(), sharedLock(), queued(0), sleepLock(), wake(), stopping(false), threadCount(0), users(0), stateLock() {
+    // intentionally empty
+}
+
+
+/*
+ * utility::TaskScheduler::~TaskScheduler
+ */
+utility::TaskScheduler::~TaskScheduler(void) {
+    this->Shutdown();
+}
+
+
+/*
+ * utility::TaskScheduler::start
+ */
+void utility::TaskScheduler::start(void) {
+    std::lock_guard<std::mutex> guard(this->stateLock);
+    if (!this->workers.empty()) return;
+
+    const unsigned int cnt = (this->threadCount > 0) ? this->threadCount
+                                                     : std::max(1u, std::thread::hardware_concurrency());
+    {
+        std::lock_guard<std::mutex> sleepGuard(this->sleepLock);
+        this->stopping = false;
+    }
+
+    // all queues must exist before the first worker tries to steal
+    for (unsigned int i = 0; i < cnt; ++i) {
+        this->workers.emplace_back(new Worker());
+    }
+    for (unsigned int i = 0; i < cnt; ++i) {
+        this->workers[i]->thread = std::thread(&TaskScheduler::work, this, i);
+    }
+    vislib::sys::Log::DefaultLog.WriteInfo("TaskScheduler: started %u workers", cnt);
+}
+
+
+/*
+ * utility::TaskScheduler::work
+ */
+void utility::TaskScheduler::work(unsigned int self) {
+    currentScheduler = this;
+    currentWorker = static_cast<int>(self);
+
+    while (true) {
+        TaskHandle task;
+        if (this->take(self, task)) {
+            this->run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> l(this->sleepLock);
+        if (this->stopping && (this->queued.load() == 0)) break;
+        this->wake.wait(l, [this]() { return this->stopping || (this->queued.load() > 0); });
+    }
+
+    currentScheduler = nullptr;
+    currentWorker = -1;
+}
+
+
+/*
+ * utility::TaskScheduler::take
+ */
+bool utility::TaskScheduler::take(unsigned int self, TaskHandle& task) {
+    const size_t cnt = this->workers.size();
+
+    for (unsigned int p = 0; p < 2; ++p) {
+        {
+            // own work, newest first as it is most likely still in the cache
+            Worker& w = *this->workers[self];
+            std::lock_guard<std::mutex> guard(w.lock);
+            if (!w.queues[p].empty()) {
+                task = std::move(w.queues[p].back());
+                w.queues[p].pop_back();
+                --this->queued;
+                return true;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(this->sharedLock);
+            if (!this->shared[p].empty()) {
+                task = std::move(this->shared[p].front());
+                this->shared[p].pop_front();
+                --this->queued;
+                return true;
+            }
+        }
+        for (size_t i = 1; i < cnt; ++i) {
+            // steal the oldest work, which tends to be the largest
+            Worker& v = *this->workers[(self + i) % cnt];
+            std::lock_guard<std::mutex> guard(v.lock);
+            if (!v.queues[p].empty()) {
+                task = std::move(v.queues[p].front());
+                v.queues[p].pop_front();
+                --this->queued;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/*
+ * utility::TaskScheduler::run
+ */
+void utility::TaskScheduler::run(const TaskHandle& task) {
+    if (!task->cancelled) {
+        try {
+            task->work(*task);
+        } catch (std::exception& ex) {
+            vislib::sys::Log::DefaultLog.WriteError("TaskScheduler: task failed: %s", ex.what());
+        } catch (...) {
+            vislib::sys::Log::DefaultLog.WriteError("TaskScheduler: task failed with an unknown exception");
+        }
+    }
+    task->work = nullptr; // release whatever the work holds on to
+    this->finish(task);
+}
+
+
+/*
+ * utility::TaskScheduler::enqueue
+ */
+void utility::TaskScheduler::enqueue(const TaskHandle& task) {
+    if (task->cancelled) {
+        // never runs, but waiters and continuations must learn about it
+        this->finish(task);
+        return;
+    }
+
+    const unsigned int p = static_cast<unsigned int>(task->prio);
+    const bool worker = this->IsWorkerThread();
+    if (!worker) this->start();
+
+    // count the task before publishing it, so a worker taking it at once
+    // cannot decrement the counter below zero
+    {
+        std::lock_guard<std::mutex> guard(this->sleepLock);
+        ++this->queued;
+    }
+
+    if (worker) {
+        Worker& w = *this->workers[currentWorker];
+        std::lock_guard<std::mutex> guard(w.lock);
+        w.queues[p].push_back(task);
+    } else {
+        std::lock_guard<std::mutex> guard(this->sharedLock);
+        this->shared[p].push_back(task);
+    }
+    this->wake.notify_one();
+}
+
+
+/*
+ * utility::TaskScheduler::release
+ */
+void utility::TaskScheduler::release(const TaskHandle& task) {
+    if (--task->pending == 0) {
+        this->enqueue(task);
+    }
+}
+
+
+/*
+ * utility::TaskScheduler::finish
+ */
+void utility::TaskScheduler::finish(const TaskHandle& task) {
+    std::vector<TaskHandle> continuations;
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        task->done = true;
+        continuations.swap(task->continuations);
+    }
+    task->finished.notify_all();
+
+    for (const TaskHandle& c : continuations) {
+        if (task->cancelled) c->cancelled = true;
+        this->release(c);
+    }
+}
@@ -54,16 +54,18 @@ PluginManager::~PluginManager(void) {
 PluginManager::collection_type PluginManager::LoadPlugin(
         const std::basic_string<TCHAR>& filename,
         ::megamol::core::CoreInstance& coreInst) {
-    PluginManager::collection_type rv;
+    return this->LoadPlugin(filename, OpenLibrary(filename), coreInst);
+}
 
-    // load plugin assembly
-    std::shared_ptr<vislib::sys::DynamicLinkLibrary> plugin_asm = std::make_shared<vislib::sys::DynamicLinkLibrary>();
-    if (!plugin_asm->Load(filename.c_str())) {
-        vislib::StringA msg;
-        msg.Format("Cannot load plugin \"%s\"",
-            plugin_asm->LastLoadErrorMessage().PeekBuffer());
-        throw vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
-    }
+
+/*
+ * PluginManager::LoadPlugin
+ */
+PluginManager::collection_type PluginManager::LoadPlugin(
+        const std::basic_string<TCHAR>& filename,
+        std::shared_ptr<vislib::sys::DynamicLinkLibrary> plugin_asm,
+        ::megamol::core::CoreInstance& coreInst) {
+    PluginManager::collection_type rv;
 
     // search for api entry
     int (*mmplgPluginAPIVersion)(void) = function_cast<int (*)()>(plugin_asm->GetProcAddress("mmplgPluginAPIVersion"));
@@ -98,6 +100,22 @@ PluginManager::collection_type PluginManager::LoadPlugin(
 }
 
 
+/*
+ * PluginManager::OpenLibrary
+ */
+std::shared_ptr<vislib::sys::DynamicLinkLibrary> PluginManager::OpenLibrary(
+        const std::basic_string<TCHAR>& filename) {
+    std::shared_ptr<vislib::sys::DynamicLinkLibrary> plugin_asm = std::make_shared<vislib::sys::DynamicLinkLibrary>();
+    if (!plugin_asm->Load(filename.c_str())) {
+        vislib::StringA msg;
+        msg.Format("Cannot load plugin \"%s\"",
+            plugin_asm->LastLoadErrorMessage().PeekBuffer());
+        throw vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
+    }
+    return plugin_asm;
+}
+
+
 namespace {
     void throw_exception(const char *msg, const char *file, unsigned int line) {
         throw vislib::Exception(msg, file, line);
@@ -61,6 +61,37 @@ namespace plugins {
         collection_type LoadPlugin(const std::basic_string<TCHAR>& filename,
             ::megamol::core::CoreInstance& coreInst);
 
+        /**
+         * Loads a plugin from a library which already has been loaded using
+         * 'OpenLibrary'.
+         *
+         * @param filename The path to the plugin file
+         * @param lib The loaded library of the plugin
+         * @param coreInst The CoreInstance calling. This must always be the
+         *                 same object!
+         *
+         * @return A collection of pointers to all newly loaded plugins.
+         *
+         * @throw std::exception in case of an error.
+         */
+        collection_type LoadPlugin(const std::basic_string<TCHAR>& filename,
+            std::shared_ptr<vislib::sys::DynamicLinkLibrary> lib,
+            ::megamol::core::CoreInstance& coreInst);
+
+        /**
+         * Loads the library of a plugin file without initialising the
+         * plugin. This does not touch any state of the core and thus may be
+         * called for several plugins concurrently.
+         *
+         * @param filename The path to the plugin file to load
+         *
+         * @return The loaded library
+         *
+         * @throw vislib::Exception in case of an error.
+         */
+        static std::shared_ptr<vislib::sys::DynamicLinkLibrary> OpenLibrary(
+            const std::basic_string<TCHAR>& filename);
+
         /**
          * Answer the collection of loaded plugins
          *
@@ -25,13 +25,15 @@ view::AbstractCallRender3D_2& view::AbstractCallRender3D_2::operator=(const view
     this->minCamState = rhs.minCamState;
     this->bboxs = rhs.bboxs;
     this->lastFrameTime = rhs.lastFrameTime;
+    this->renderQuality = rhs.renderQuality;
     return *this;
 }
 
 /*
  * view::AbstractCallRender3D::AbstractCallRender3D_2
  */
-view::AbstractCallRender3D_2::AbstractCallRender3D_2(void) : AbstractCallRender(), bboxs(), lastFrameTime(0.0) {
+view::AbstractCallRender3D_2::AbstractCallRender3D_2(void)
+    : AbstractCallRender(), bboxs(), lastFrameTime(0.0), renderQuality(1.0f) {
     // intentionally empty
     // TODO init camera parameters
 }
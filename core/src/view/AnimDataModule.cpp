@@ -23,6 +23,7 @@ using namespace megamol::core;
 view::AnimDataModule::AnimDataModule(void) : Module(), frameCnt(0),
         loader(loaderFunction), frameCache(NULL), cacheSize(0),
         stateLock(), lastRequested(0) {
+    this->requestDirection.store(1);
     this->isRunning.store(false);
 }
 
@@ -87,6 +88,7 @@ void view::AnimDataModule::initFrameCache(unsigned int cacheSize) {
         this->loadFrame(this->frameCache[0], 0); // load first frame directly.
         this->frameCache[0]->state = Frame::STATE_AVAILABLE;
         this->lastRequested = 0;
+        this->requestDirection.store(1);
 
         this->isRunning.store(true);
         this->loader.Start(this);
@@ -107,7 +109,12 @@ view::AnimDataModule::Frame * view::AnimDataModule::requestLockedFrame(unsigned
     static bool deadlockwarning = true;
 
     this->stateLock.Lock();
-    this->lastRequested = idx; // TODO: choose better caching strategy!!!
+    if ((idx != this->lastRequested) && (idx < this->frameCnt)) {
+        // the shorter way around the (looping) animation tells the direction
+        unsigned int forward = (idx + this->frameCnt - this->lastRequested) % this->frameCnt;
+        this->requestDirection.store((forward <= this->frameCnt - forward) ? 1 : -1);
+    }
+    this->lastRequested = idx;
     for (unsigned int i = 0; i < this->cacheSize; i++) {
         if ((this->frameCache[i]->state == Frame::STATE_AVAILABLE)
                 || (this->frameCache[i]->state == Frame::STATE_INUSE)) {
@@ -158,19 +165,19 @@ view::AnimDataModule::Frame * view::AnimDataModule::requestLockedFrame(unsigned
  */
 view::AnimDataModule::Frame * view::AnimDataModule::requestLockedFrame(unsigned int idx, bool forceIdx) {
     Frame *f = this->requestLockedFrame(idx);
-    if ((f->FrameNumber() == idx) || (!forceIdx)) return f;
+    if (!forceIdx || ((f != NULL) && (f->FrameNumber() == idx))) return f;
     // wrong frame number and frame is forced
 
     // clamp idx
     if (idx >= this->frameCnt) {
         idx = this->frameCnt - 1;
-        f->Unlock();
+        if (f != NULL) f->Unlock();
         f = this->requestLockedFrame(idx);
     }
 
     // wait for the new frame
-    while (idx != f->FrameNumber()) {
-        f->Unlock();
+    while ((f == NULL) || (idx != f->FrameNumber())) {
+        if (f != NULL) f->Unlock();
 
         // HAZARD: This will wait for all eternity if the requested frame is never loaded
 
@@ -182,6 +189,20 @@ view::AnimDataModule::Frame * view::AnimDataModule::requestLockedFrame(unsigned
 }
 
 
+/*
+ * view::AnimDataModule::requestLockedFrame
+ */
+view::AnimDataModule::Frame * view::AnimDataModule::requestLockedFrame(AbstractGetData3DCall& call) {
+    const unsigned int idx = call.FrameID();
+    Frame *f = this->requestLockedFrame(idx, call.IsFrameForced());
+    if (f != NULL) {
+        call.SetFrameID(f->FrameNumber(), call.IsFrameForced());
+        call.SetFramePending((f->FrameNumber() != idx) && (idx < this->frameCnt));
+    }
+    return f;
+}
+
+
 /*
  * view::AnimDataModule::resetFrameCache
  */
@@ -202,6 +223,7 @@ void view::AnimDataModule::resetFrameCache(void) {
     this->frameCnt = 0;
     this->cacheSize = 0;
     this->lastRequested = 0;
+    this->requestDirection.store(1);
 }
 
 
@@ -222,6 +244,7 @@ DWORD view::AnimDataModule::loaderFunction(void *userData) {
     AnimDataModule *This = static_cast<AnimDataModule*>(userData);
     ASSERT(This != NULL);
     unsigned int index, i, j, req;
+    int dir;
 #ifdef _LOADING_REPORTING
     unsigned int l;
 #endif /* _LOADING_REPORTING */
@@ -248,6 +271,10 @@ DWORD view::AnimDataModule::loaderFunction(void *userData) {
         // state now, and the different states that can be set outside this
         // thread are aquivalent for us.
         index = req = This->lastRequested;
+        dir = This->requestDirection.load();
+        if (req >= This->frameCnt) {
+            index = req = This->frameCnt - 1;
+        }
         for (j = 0; j < This->cacheSize; j++) {
             for (i = 0; i < This->cacheSize; i++) {
                 if (!This->isRunning.load()) break;
@@ -261,7 +288,8 @@ DWORD view::AnimDataModule::loaderFunction(void *userData) {
             if (i >= This->cacheSize) {
                 break;
             }
-            index = (index + 1) % This->frameCnt;
+            index = (dir > 0) ? ((index + 1) % This->frameCnt)
+                : ((index + This->frameCnt - 1) % This->frameCnt);
         }
         if (!This->isRunning.load()) break;
         if (j >= This->cacheSize) {
@@ -278,7 +306,9 @@ DWORD view::AnimDataModule::loaderFunction(void *userData) {
         // Note: We now need to lock, because we must synchronise against 
         // frames changing from 'STATE_AVAILABLE' to 'STATE_INUSE'.
         This->stateLock.Lock();
-        // core idea: search for the frame with the largest distance to the requested frame
+        // core idea: search for the frame with the largest distance to the
+        // requested frame, measured in playback direction. Thus, the frames
+        // just behind the requested one will be overwritten first.
         frame = NULL; // the frame to be overwritten
         j = 0; // the distance to the found frame to be overwritten
         for (i = 0; i < This->cacheSize; i++) {
@@ -290,20 +320,14 @@ DWORD view::AnimDataModule::loaderFunction(void *userData) {
 #endif /* _LOADING_REPORTING */
                 break;
             } else if (This->frameCache[i]->state == Frame::STATE_AVAILABLE) {
-                // distance to the frame[i];
-                long ld = static_cast<long>(This->frameCache[i]->frame) - static_cast<long>(req);
-                if (ld < 0) {
-                    if (ld < (static_cast<long>(This->frameCnt)) / 10) {
-                        ld += static_cast<long>(This->frameCnt);
-                        if (ld < 0) ld = 0; // should never happen
-                    } else {
-                        ld = -10 * ld;
-                    }
-                }
+                // distance to the frame[i] in playback direction
+                unsigned int ld = (dir > 0)
+                    ? ((This->frameCache[i]->frame + This->frameCnt - req) % This->frameCnt)
+                    : ((req + This->frameCnt - This->frameCache[i]->frame) % This->frameCnt);
 
-                if (j < static_cast<unsigned int>(ld)) {
+                if (j < ld) {
                     frame = This->frameCache[i];
-                    j = static_cast<unsigned int>(ld);
+                    j = ld;
 #ifdef _LOADING_REPORTING
                     l = i;
 #endif /* _LOADING_REPORTING */
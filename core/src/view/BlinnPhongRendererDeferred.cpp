@@ -260,12 +260,14 @@ bool view::BlinnPhongRendererDeferred::Render(Call& call) {
 bool view::BlinnPhongRendererDeferred::createFBO(UINT width, UINT height) {
 
     vislib::graphics::gl::FramebufferObject::ColourAttachParams cap[2];
-    cap[0].internalFormat = GL_RGBA32F;
+    // Compact G-buffer: 8 bit colour and half precision normals, the
+    // position is reconstructed from the depth texture
+    cap[0].internalFormat = GL_RGBA8;
     cap[0].format =  GL_RGBA;
-    cap[0].type = GL_FLOAT;
-    cap[1].internalFormat = GL_RGB32F;
-    cap[1].format =  GL_RGBA;
-    cap[1].type = GL_FLOAT;
+    cap[0].type = GL_UNSIGNED_BYTE;
+    cap[1].internalFormat = GL_RGB16F;
+    cap[1].format =  GL_RGB;
+    cap[1].type = GL_HALF_FLOAT;
 
     vislib::graphics::gl::FramebufferObject::DepthAttachParams dap;
     dap.state = vislib::graphics::gl::FramebufferObject::ATTACHMENT_TEXTURE;
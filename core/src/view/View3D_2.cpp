@@ -11,7 +11,9 @@
 #ifdef _WIN32
 #    include <windows.h>
 #endif /* _WIN32 */
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include "mmcore/CoreInstance.h"
 #include "mmcore/misc/PngBitmapCodec.h"
@@ -101,7 +103,21 @@ View3D_2::View3D_2(void)
     , cameraCenterOffsetParam("cam::centeroffset", "")
     , cameraHalfApertureRadiansParam("cam::halfapertureradians", "")
     , cameraHalfDisparityParam("cam::halfdisparity", "")
-    , valuesFromOutside(false) {
+    , valuesFromOutside(false)
+    , targetFrameTimeSlot("adaptive::targetFrameTime",
+          "Target frame time in milliseconds. While the camera moves, the rendering quality is reduced to meet it, "
+          "0 disables the adaptive quality")
+    , minQualitySlot("adaptive::minQuality", "Lower bound of the adaptive rendering quality")
+    , dynamicResolutionSlot(
+          "adaptive::dynamicResolution", "Reduces the resolution along with the quality, renderers are told the "
+                                         "quality in any case and may decimate their output accordingly")
+    , progressiveRefinementSlot("adaptive::progressive",
+          "Refines the quality over several frames when the camera stops, instead of rendering the next frame at "
+          "full quality")
+    , renderQuality(1.0f)
+    , lastViewMx(1.0f)
+    , lastProjMx(1.0f)
+    , scaledFbo() {
 
     using vislib::sys::KeyCode;
 
@@ -201,6 +217,18 @@ View3D_2::View3D_2(void)
     this->hookOnChangeOnlySlot.SetParameter(new param::BoolParam(false));
     this->MakeSlotAvailable(&this->hookOnChangeOnlySlot);
 
+    this->targetFrameTimeSlot.SetParameter(new param::FloatParam(0.0f, 0.0f));
+    this->MakeSlotAvailable(&this->targetFrameTimeSlot);
+
+    this->minQualitySlot.SetParameter(new param::FloatParam(0.1f, 0.01f, 1.0f));
+    this->MakeSlotAvailable(&this->minQualitySlot);
+
+    this->dynamicResolutionSlot.SetParameter(new param::BoolParam(true));
+    this->MakeSlotAvailable(&this->dynamicResolutionSlot);
+
+    this->progressiveRefinementSlot.SetParameter(new param::BoolParam(true));
+    this->MakeSlotAvailable(&this->progressiveRefinementSlot);
+
     const bool camparamvisibility = true;
 
     auto camposparam = new param::Vector3fParam(vislib::math::Vector<float, 3>());
@@ -482,9 +510,54 @@ void View3D_2::Render(const mmcRenderViewContext& context) {
     glm::mat4 proj = projCam;
     glm::mat4 mvp = projCam * viewCam;
 
+    this->updateRenderQuality((view != this->lastViewMx) || (proj != this->lastProjMx));
+    this->lastViewMx = view;
+    this->lastProjMx = proj;
+
     if (cr3d != nullptr) {
+        cr3d->SetRenderQuality(this->renderQuality);
+
+        // render to a framebuffer with fewer pixels according to the quality, in steps of 1/8 of the resolution to
+        // avoid recreating it every frame, and scale it up to the back buffer afterwards
+        const auto camRes = this->cam.resolution_gate();
+        const auto camTile = this->cam.image_tile();
+        float scale = 1.0f;
+        if ((this->overrideCall == nullptr) && this->dynamicResolutionSlot.Param<param::BoolParam>()->Value()) {
+            scale = std::ceil(std::sqrt(this->renderQuality) * 8.0f) / 8.0f;
+        }
+        const int scaledWidth = std::max(1, static_cast<int>(camRes.width() * scale));
+        const int scaledHeight = std::max(1, static_cast<int>(camRes.height() * scale));
+        const bool scaled = (scale < 1.0f);
+
+        if (scaled) {
+            if (!this->scaledFbo.IsValid() || (static_cast<int>(this->scaledFbo.GetWidth()) != scaledWidth) ||
+                (static_cast<int>(this->scaledFbo.GetHeight()) != scaledHeight)) {
+                this->scaledFbo.Release();
+                this->scaledFbo.Create(scaledWidth, scaledHeight);
+            }
+            this->scaledFbo.Enable();
+            cr3d->SetOutputBuffer(&this->scaledFbo, scaledWidth, scaledHeight);
+            this->cam.resolution_gate(
+                cam_type::screen_size_type(static_cast<LONG>(scaledWidth), static_cast<LONG>(scaledHeight)));
+            this->cam.image_tile(cam_type::screen_rectangle_type(std::array<int, 4>{0, scaledHeight, scaledWidth, 0}));
+        }
+
         cr3d->SetCameraState(this->cam);
         (*cr3d)(view::AbstractCallRender::FnRender);
+
+        if (scaled) {
+            this->scaledFbo.Disable();
+            this->cam.resolution_gate(camRes);
+            this->cam.image_tile(camTile);
+            cr3d->SetOutputBuffer(GL_BACK);
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, this->scaledFbo.GetID());
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, scaledWidth, scaledHeight, 0, 0, camRes.width(), camRes.height(),
+                GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, camRes.width(), camRes.height());
+        }
     }
 
     this->setCameraValues(this->cam);
@@ -498,6 +571,36 @@ void View3D_2::Render(const mmcRenderViewContext& context) {
     }
 }
 
+/*
+ * View3D_2::updateRenderQuality
+ */
+void View3D_2::updateRenderQuality(bool cameraMoved) {
+    const float targetFrameTime = this->targetFrameTimeSlot.Param<param::FloatParam>()->Value();
+
+    // offscreen rendering, e.g. screenshots, always gets the full quality
+    if ((targetFrameTime <= 0.0f) || (this->overrideCall != nullptr)) {
+        this->renderQuality = 1.0f;
+        return;
+    }
+
+    if (cameraMoved) {
+        // the costs of a frame are assumed to be roughly proportional to the quality, the correction is damped
+        // to avoid oscillations
+        const float frameTime = static_cast<float>(this->lastFrameDuration.count()) / 1000.0f;
+        if (frameTime > 0.0f) {
+            const float factor = std::min(std::max(targetFrameTime / frameTime, 0.25f), 4.0f);
+            this->renderQuality *= std::sqrt(factor);
+        }
+    } else if (this->progressiveRefinementSlot.Param<param::BoolParam>()->Value()) {
+        this->renderQuality *= 2.0f;
+    } else {
+        this->renderQuality = 1.0f;
+    }
+
+    this->renderQuality = std::min(
+        std::max(this->renderQuality, this->minQualitySlot.Param<param::FloatParam>()->Value()), 1.0f);
+}
+
 /*
  * View3D_2::ResetView
  */
@@ -32,6 +32,11 @@
 #include "vislib/sys/File.h"
 #include "vislib/sys/Log.h"
 #include "vislib/sys/Thread.h"
+#include "zlib.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 
 namespace megamol {
@@ -116,12 +121,147 @@ typedef struct _shooterdata_t {
     /** Bytes per pixel */
     unsigned int bpp;
 
+    /** The final image file the image data is written to */
+    vislib::sys::File* file;
+
+    /** The zlib compression level of the image data */
+    int compressionLevel;
+
+    /** Set by the writer thread if the image data could not be written */
+    bool writeFailed;
+
 } ShooterData;
 
+/**
+ * Writes a chunk of a png file
+ *
+ * @param f The file to write to
+ * @param type The four character code of the chunk
+ * @param buf The chunk data
+ * @param size The number of bytes of the chunk data
+ *
+ * @return true on success
+ */
+static bool myPngWriteChunk(vislib::sys::File* f, const char* type, const BYTE* buf, size_t size) {
+    BYTE head[8];
+    head[0] = static_cast<BYTE>(size >> 24);
+    head[1] = static_cast<BYTE>(size >> 16);
+    head[2] = static_cast<BYTE>(size >> 8);
+    head[3] = static_cast<BYTE>(size);
+    ::memcpy(head + 4, type, 4);
+    uLong crc = ::crc32(0L, Z_NULL, 0);
+    crc = ::crc32(crc, head + 4, 4);
+    if (size > 0) crc = ::crc32(crc, buf, static_cast<uInt>(size));
+    BYTE tail[4];
+    tail[0] = static_cast<BYTE>(crc >> 24);
+    tail[1] = static_cast<BYTE>(crc >> 16);
+    tail[2] = static_cast<BYTE>(crc >> 8);
+    tail[3] = static_cast<BYTE>(crc);
+    return (f->Write(head, 8) == 8) && ((size == 0) || (f->Write(buf, size) == size)) && (f->Write(tail, 4) == 4);
+}
+
+/**
+ * The paeth predictor of png
+ */
+static inline BYTE myPngPaeth(BYTE a, BYTE b, BYTE c) {
+    int p = static_cast<int>(a) + static_cast<int>(b) - static_cast<int>(c);
+    int pa = std::abs(p - static_cast<int>(a));
+    int pb = std::abs(p - static_cast<int>(b));
+    int pc = std::abs(p - static_cast<int>(c));
+    if ((pa <= pb) && (pa <= pc)) return a;
+    return (pb <= pc) ? b : c;
+}
+
+/**
+ * Applies the png filter to a scanline. Like libpng, the filter type
+ * producing the smallest sum of absolute (signed) residuals is chosen.
+ *
+ * @param out Receives the filter type byte and the filtered scanline
+ * @param row The scanline
+ * @param prev The previous scanline or NULL for the first one
+ * @param len The number of bytes of the scanline
+ * @param bpp The number of bytes per pixel
+ * @param adaptive If false, the scanline is not filtered at all
+ */
+static void myPngFilterRow(BYTE* out, const BYTE* row, const BYTE* prev, size_t len, unsigned int bpp, bool adaptive) {
+    out[0] = 0;
+    ::memcpy(out + 1, row, len);
+    if (!adaptive) return;
+
+    unsigned long sums[5] = {0, 0, 0, 0, 0};
+    for (size_t i = 0; i < len; i++) {
+        BYTE a = (i >= bpp) ? row[i - bpp] : 0;
+        BYTE b = (prev != NULL) ? prev[i] : 0;
+        BYTE c = ((prev != NULL) && (i >= bpp)) ? prev[i - bpp] : 0;
+        sums[0] += std::abs(static_cast<signed char>(row[i]));
+        sums[1] += std::abs(static_cast<signed char>(row[i] - a));
+        sums[2] += std::abs(static_cast<signed char>(row[i] - b));
+        sums[3] += std::abs(static_cast<signed char>(row[i] - ((static_cast<int>(a) + static_cast<int>(b)) >> 1)));
+        sums[4] += std::abs(static_cast<signed char>(row[i] - myPngPaeth(a, b, c)));
+    }
+    BYTE filter = static_cast<BYTE>(std::min_element(sums, sums + 5) - sums);
+    if (filter == 0) return;
+
+    out[0] = filter;
+    for (size_t i = 0; i < len; i++) {
+        BYTE a = (i >= bpp) ? row[i - bpp] : 0;
+        BYTE b = (prev != NULL) ? prev[i] : 0;
+        BYTE c = ((prev != NULL) && (i >= bpp)) ? prev[i - bpp] : 0;
+        switch (filter) {
+        case 1: out[i + 1] = row[i] - a; break;
+        case 2: out[i + 1] = row[i] - b; break;
+        case 3: out[i + 1] = row[i] - static_cast<BYTE>((static_cast<int>(a) + static_cast<int>(b)) >> 1); break;
+        default: out[i + 1] = row[i] - myPngPaeth(a, b, c); break;
+        }
+    }
+}
+
+/**
+ * Compresses a part of the png image data as raw deflate stream, which can
+ * be concatenated with the streams of the other parts. As for pigz, the end
+ * of the preceding data is used as dictionary to keep the compression ratio.
+ *
+ * @param out Receives the compressed data
+ * @param in The filtered image data
+ * @param len The number of bytes to compress
+ * @param dict The dictionary
+ * @param dictLen The number of bytes of the dictionary
+ * @param level The compression level
+ * @param last Whether this is the last part of the image data
+ *
+ * @return true on success
+ */
+static bool myPngDeflate(std::vector<BYTE>& out, const BYTE* in, size_t len, const BYTE* dict, size_t dictLen,
+    int level, bool last) {
+    z_stream zs;
+    ::memset(&zs, 0, sizeof(zs));
+    if (::deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    if ((dictLen > 0) && (::deflateSetDictionary(&zs, dict, static_cast<uInt>(dictLen)) != Z_OK)) {
+        ::deflateEnd(&zs);
+        return false;
+    }
+    // the bound does not include the marker of the sync flush
+    out.resize(::deflateBound(&zs, static_cast<uLong>(len)) + 16);
+    zs.next_in = const_cast<Bytef*>(in);
+    zs.avail_in = static_cast<uInt>(len);
+    zs.next_out = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    int r = ::deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    bool ok = last ? (r == Z_STREAM_END) : ((r == Z_OK) && (zs.avail_in == 0) && (zs.avail_out > 0));
+    out.resize(zs.total_out);
+    ::deflateEnd(&zs);
+    return ok;
+}
+
 /**
  * The second thread to load the tile data from the temporary files and
  * create the final output
  *
+ * The image data is streamed to the file row band by row band, i.e. only
+ * one row of tiles is held in memory. The scanlines of a band are filtered
+ * and deflated in parallel and written as IDAT chunks. The header chunks
+ * must have been written before, the IEND chunk is written afterwards.
+ *
  * @param d Pointer to the common ShooterData structure
  *
  * @return 0
@@ -131,12 +271,21 @@ static DWORD myPngStoreData(void* d) {
     int xSteps = (data->imgWidth / data->tileWidth) + (((data->imgWidth % data->tileWidth) != 0) ? 1 : 0);
     int ySteps = (data->imgHeight / data->tileHeight) + (((data->imgHeight % data->tileHeight) != 0) ? 1 : 0);
     int tmpid = ySteps % 2;
-    BYTE* buffer = new BYTE[data->imgWidth * data->bpp]; // 1 scanline at a time
-
-    if (buffer == NULL) {
-        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to allocate scanline buffer");
-        return -1;
-    }
+    const size_t rowLen = static_cast<size_t>(data->imgWidth) * data->bpp;
+    const bool adaptive = (data->compressionLevel != 0);
+
+    // the rows of one band, and the last row of the previous band
+    std::vector<BYTE> band(rowLen * data->tileHeight);
+    std::vector<BYTE> prevRow(rowLen);
+    std::vector<BYTE> filtered((rowLen + 1) * data->tileHeight);
+    // the window of zlib is 32k, so this is all the dictionary a part needs
+    const size_t dictMax = 32768;
+    std::vector<BYTE> dict;
+    // a part is deflated by one thread; pigz uses 128k
+    const int partRows = static_cast<int>(std::max<size_t>(1, (128 * 1024) / (rowLen + 1)));
+    std::vector<std::vector<BYTE>> parts;
+    uLong adler = ::adler32(0L, Z_NULL, 0);
+    bool first = true;
 
     data->tmpFileLocks[tmpid].Lock();
     VLTRACE(VISLIB_TRCELVL_INFO, "Writer locked tmp[%d]\n", tmpid);
@@ -156,22 +305,82 @@ static DWORD myPngStoreData(void* d) {
         data->switchLock.Lock();
         data->switchLock.Unlock();
 
+        // the tiles are stored bottom up
         for (int yo = tileH - 1; yo >= 0; yo--) {
+            BYTE* row = band.data() + (tileH - 1 - yo) * rowLen;
             for (int xi = 0; xi < xSteps; xi++) {
                 data->tmpFiles[tmpid]->Seek(
                     xi * data->tileWidth * data->tileHeight * data->bpp + yo * data->tileWidth * data->bpp);
-                data->tmpFiles[tmpid]->Read(buffer + (xi * data->tileWidth * data->bpp),
+                data->tmpFiles[tmpid]->Read(row + (xi * data->tileWidth * data->bpp),
                     vislib::math::Min(data->tileWidth, data->imgWidth - xi * data->tileWidth) * data->bpp);
             }
-            png_write_row(data->pngPtr, buffer);
+        }
+        if (data->writeFailed) continue; // keep the renderer running until it notices
+
+#pragma omp parallel for
+        for (int r = 0; r < tileH; r++) {
+            const BYTE* prev = (r > 0) ? (band.data() + (r - 1) * rowLen) : (first ? NULL : prevRow.data());
+            myPngFilterRow(filtered.data() + r * (rowLen + 1), band.data() + r * rowLen, prev, rowLen, data->bpp,
+                adaptive);
+        }
+        ::memcpy(prevRow.data(), band.data() + (tileH - 1) * rowLen, rowLen);
+
+        const int partCnt = (tileH + partRows - 1) / partRows;
+        const size_t filteredLen = (rowLen + 1) * tileH;
+        parts.resize(partCnt);
+        int failedParts = 0;
+#pragma omp parallel for reduction(+ : failedParts)
+        for (int pi = 0; pi < partCnt; pi++) {
+            const size_t begin = static_cast<size_t>(pi) * partRows * (rowLen + 1);
+            const size_t end = vislib::math::Min(begin + partRows * (rowLen + 1), filteredLen);
+            const BYTE* in = filtered.data() + begin;
+            // the dictionary of the first part is the end of the previous band
+            const BYTE* dictPtr = (pi > 0) ? (in - vislib::math::Min(begin, dictMax)) : dict.data();
+            const size_t dictLen = (pi > 0) ? vislib::math::Min(begin, dictMax) : dict.size();
+            if (!myPngDeflate(parts[pi], in, end - begin, dictPtr, dictLen, data->compressionLevel,
+                    (yi == 0) && (pi == partCnt - 1))) {
+                failedParts++;
+            }
+        }
+        if (failedParts > 0) {
+            vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to compress image data");
+            data->writeFailed = true;
+            continue;
+        }
+
+        const size_t dictLen = vislib::math::Min(filteredLen, dictMax);
+        if (dictLen < dictMax) {
+            dict.insert(dict.end(), filtered.data() + filteredLen - dictLen, filtered.data() + filteredLen);
+            if (dict.size() > dictMax) dict.erase(dict.begin(), dict.begin() + (dict.size() - dictMax));
+        } else {
+            dict.assign(filtered.data() + filteredLen - dictLen, filtered.data() + filteredLen);
+        }
+        adler = ::adler32(adler, filtered.data(), static_cast<uInt>(filteredLen));
+
+        if (first) {
+            // the zlib header
+            const BYTE head[2] = {0x78, 0x9c};
+            parts.front().insert(parts.front().begin(), head, head + 2);
+            first = false;
+        }
+        if (yi == 0) {
+            const BYTE tail[4] = {static_cast<BYTE>(adler >> 24), static_cast<BYTE>(adler >> 16),
+                static_cast<BYTE>(adler >> 8), static_cast<BYTE>(adler)};
+            parts.back().insert(parts.back().end(), tail, tail + 4);
+        }
+        for (const std::vector<BYTE>& part : parts) {
+            if (part.empty()) continue;
+            if (!myPngWriteChunk(data->file, "IDAT", part.data(), part.size())) {
+                vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to write image data");
+                data->writeFailed = true;
+                break;
+            }
         }
     }
 
     VLTRACE(VISLIB_TRCELVL_INFO, "Writer unlocks tmp[%d]\n", tmpid);
     data->tmpFileLocks[tmpid].Unlock();
 
-    delete[] buffer;
-
     return 0;
 }
 
@@ -375,6 +584,9 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
     data.bpp = (bkgndMode == 1) ? 4 : 3;
     data.pngInfoPtr = NULL;
     data.pngPtr = NULL;
+    data.file = NULL;
+    data.compressionLevel = this->disableCompressionSlot.Param<param::BoolParam>()->Value() ? 0 : Z_DEFAULT_COMPRESSION;
+    data.writeFailed = false;
 
     if ((data.tileWidth == 0) || (data.tileHeight == 0)) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to create Screenshot: Illegal tile size %u x %u",
@@ -414,6 +626,8 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
 
     view::CallRenderView crv;
     BYTE* buffer = NULL;
+    GLuint pbos[2] = {0, 0};
+    GLint oldPackAlignment = 4;
     vislib::sys::FastFile file;
     bool rollback = false;
     vislib::graphics::gl::FramebufferObject* overlayfbo = NULL;
@@ -425,6 +639,7 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
                 vislib::sys::File::CREATE_OVERWRITE)) {
             throw vislib::Exception("Cannot open output file", __FILE__, __LINE__);
         }
+        data.file = &file;
 
         // init png lib
         data.pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, &myPngError, &myPngWarn);
@@ -562,6 +777,56 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
                 throw vislib::Exception("Unable to create image framebuffer object.", __FILE__, __LINE__);
             }
 
+            // the tiles are read back asynchronously while the next tile is rendered
+            const size_t tileSize = static_cast<size_t>(data.tileWidth) * data.tileHeight * data.bpp;
+            glGetIntegerv(GL_PACK_ALIGNMENT, &oldPackAlignment);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glGenBuffers(2, pbos);
+            for (int i = 0; i < 2; i++) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+                glBufferData(GL_PIXEL_PACK_BUFFER, tileSize, NULL, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            int pendingTile = -1;
+            int pendingPbo = 0;
+
+            // stores a tile which has been read back to the temporary file of its row
+            auto storeTile = [&](int xi, int tmpid, GLuint pbo) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+                const BYTE* pixels = static_cast<const BYTE*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+                if (pixels == NULL) {
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                    throw vislib::Exception("Failed to create Screenshot: Cannot read image data", __FILE__, __LINE__);
+                }
+                ::memcpy(buffer, pixels, tileSize);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+                if (bkgndMode == 1) {
+                    // fixing alpha from premultiplied to postmultiplied
+#pragma omp parallel for
+                    for (int y = 0; y < static_cast<int>(data.tileHeight); y++) {
+                        for (UINT x = 0; x < data.tileWidth; x++) {
+                            BYTE* cptr = buffer + 4 * (x + y * data.tileWidth);
+                            if (cptr[3] == 0) continue;
+                            float r = static_cast<float>(cptr[0]) / 255.0f;
+                            float g = static_cast<float>(cptr[1]) / 255.0f;
+                            float b = static_cast<float>(cptr[2]) / 255.0f;
+                            float a = static_cast<float>(cptr[3]) / 255.0f;
+                            r /= a;
+                            g /= a;
+                            b /= a;
+                            cptr[0] = static_cast<BYTE>(vislib::math::Clamp(r * 255.0f, 0.0f, 255.0f));
+                            cptr[1] = static_cast<BYTE>(vislib::math::Clamp(g * 255.0f, 0.0f, 255.0f));
+                            cptr[2] = static_cast<BYTE>(vislib::math::Clamp(b * 255.0f, 0.0f, 255.0f));
+                        }
+                    }
+                }
+
+                data.tmpFiles[tmpid]->Seek(xi * data.tileWidth * data.tileHeight * data.bpp);
+                data.tmpFiles[tmpid]->Write(buffer, data.tileWidth * data.tileHeight * data.bpp);
+            };
+
             int xSteps = (data.imgWidth / data.tileWidth) + (((data.imgWidth % data.tileWidth) != 0) ? 1 : 0);
             int ySteps = (data.imgHeight / data.tileHeight) + (((data.imgHeight % data.tileHeight) != 0) ? 1 : 0);
             if (xSteps * ySteps == 0) {
@@ -718,33 +983,18 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
                     glFlush();
                     fbo.Disable();
 
-                    if (fbo.GetColourTexture(buffer, 0, (bkgndMode == 1) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE) !=
-                        GL_NO_ERROR) {
+                    // the read back into the buffer object returns immediately
+                    const int pbo = 1 - pendingPbo;
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo]);
+                    GLenum readErr = fbo.GetColourTexture(NULL, 0, (bkgndMode == 1) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                    if (readErr != GL_NO_ERROR) {
                         throw vislib::Exception(
                             "Failed to create Screenshot: Cannot read image data", __FILE__, __LINE__);
                     }
-                    if (bkgndMode == 1) {
-                        // fixing alpha from premultiplied to postmultiplied
-                        for (UINT x = 0; x < data.tileWidth; x++) {
-                            for (UINT y = 0; y < data.tileHeight; y++) {
-                                BYTE* cptr = buffer + 4 * (x + y * data.tileWidth);
-                                if (cptr[3] == 0) continue;
-                                float r = static_cast<float>(cptr[0]) / 255.0f;
-                                float g = static_cast<float>(cptr[1]) / 255.0f;
-                                float b = static_cast<float>(cptr[2]) / 255.0f;
-                                float a = static_cast<float>(cptr[3]) / 255.0f;
-                                r /= a;
-                                g /= a;
-                                b /= a;
-                                cptr[0] = static_cast<BYTE>(vislib::math::Clamp(r * 255.0f, 0.0f, 255.0f));
-                                cptr[1] = static_cast<BYTE>(vislib::math::Clamp(g * 255.0f, 0.0f, 255.0f));
-                                cptr[2] = static_cast<BYTE>(vislib::math::Clamp(b * 255.0f, 0.0f, 255.0f));
-                            }
-                        }
-                    }
-
-                    data.tmpFiles[tmpid]->Seek(xi * data.tileWidth * data.tileHeight * data.bpp);
-                    data.tmpFiles[tmpid]->Write(buffer, data.tileWidth * data.tileHeight * data.bpp);
+                    if (pendingTile >= 0) storeTile(pendingTile, tmpid, pbos[pendingPbo]);
+                    pendingTile = xi;
+                    pendingPbo = pbo;
 
                     if (overlayfbo != NULL) {
                         float tx, ty, tw, th;
@@ -797,6 +1047,10 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
 
                 } /* end for xi */
 
+                // the writer must get the complete row of tiles
+                if (pendingTile >= 0) storeTile(pendingTile, tmpid, pbos[pendingPbo]);
+                pendingTile = -1;
+
                 VLTRACE(VISLIB_TRCELVL_INFO, "Renderer unlocks tmp[%d]\n", tmpid);
                 data.tmpFileLocks[tmpid].Unlock();
 
@@ -804,7 +1058,13 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
 
             t2.Join();
 
-            png_write_end(data.pngPtr, data.pngInfoPtr);
+            if (data.writeFailed) {
+                throw vislib::Exception("Failed to write the image data", __FILE__, __LINE__);
+            }
+            // the image data has been written by the writer thread, bypassing libpng
+            if (!myPngWriteChunk(&file, "IEND", NULL, 0)) {
+                throw vislib::Exception("Failed to write the image data", __FILE__, __LINE__);
+            }
 
         } /* end if */
 
@@ -866,6 +1126,11 @@ void view::special::ScreenShooter::BeforeRender(view::AbstractView* view) {
         delete data.tmpFiles[1];
     }
     delete[] buffer;
+    if (pbos[0] != 0) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glDeleteBuffers(2, pbos);
+        glPixelStorei(GL_PACK_ALIGNMENT, oldPackAlignment);
+    }
     fbo.Release();
 
     vislib::sys::Log::DefaultLog.WriteInfo("Screen shot stored");
@@ -82,6 +82,8 @@ public:
     std::shared_ptr<std::vector<float>> zData;
     std::shared_ptr<megamol::core::BoundingBoxes> boundingBox; //< TODO data duplicate to extent container ... however,
                                                                // this makes access more concise in the renderer
+    std::shared_ptr<vislib::math::Cuboid<float>> localBounds; //< extent of the data of this rank, used as region
+                                                              // by the distributed renderer
 
     std::pair<std::vector<void*>,structureTypeEnum> ospStructures;
 
@@ -626,87 +626,115 @@ void AbstractOSPRayRenderer::writePPM(const char* fileName, const osp::vec2i& si
 
 void AbstractOSPRayRenderer::changeMaterial() {
 
-    for (auto entry : this->structureMap) {
-        auto const& element = entry.second;
+    for (auto& entry : this->structureCache) {
+        auto const element = this->structureMap.find(entry.first);
+        if (element == this->structureMap.end() || !element->second.materialChanged) continue;
+        this->applyMaterial(element->second, entry.second);
+    }
+}
 
-        // custom material settings
-        OSPMaterial material;
-        material = NULL;
-        if (element.materialContainer != NULL) {
-            switch (element.materialContainer->materialType) {
-            case OBJMATERIAL:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "OBJMaterial");
-                ospSet3fv(material, "Kd", element.materialContainer->Kd.data());
-                ospSet3fv(material, "Ks", element.materialContainer->Ks.data());
-                ospSet1f(material, "Ns", element.materialContainer->Ns);
-                ospSet1f(material, "d", element.materialContainer->d);
-                ospSet3fv(material, "Tf", element.materialContainer->Tf.data());
-                break;
-            case LUMINOUS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Luminous");
-                ospSet3fv(material, "color", element.materialContainer->lumColor.data());
-                ospSet1f(material, "intensity", element.materialContainer->lumIntensity);
-                ospSet1f(material, "transparency", element.materialContainer->lumTransparency);
-                break;
-            case GLASS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Glass");
-                ospSet1f(material, "etaInside", element.materialContainer->glassEtaInside);
-                ospSet1f(material, "etaOutside", element.materialContainer->glassEtaOutside);
-                ospSet3fv(
-                    material, "attenuationColorInside", element.materialContainer->glassAttenuationColorInside.data());
-                ospSet3fv(material, "attenuationColorOutside",
-                    element.materialContainer->glassAttenuationColorOutside.data());
-                ospSet1f(material, "attenuationDistance", element.materialContainer->glassAttenuationDistance);
-                break;
-            case MATTE:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Matte");
-                ospSet3fv(material, "reflectance", element.materialContainer->matteReflectance.data());
-                break;
-            case METAL:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Metal");
-                ospSet3fv(material, "reflectance", element.materialContainer->metalReflectance.data());
-                ospSet3fv(material, "eta", element.materialContainer->metalEta.data());
-                ospSet3fv(material, "k", element.materialContainer->metalK.data());
-                ospSet1f(material, "roughness", element.materialContainer->metalRoughness);
-                break;
-            case METALLICPAINT:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "MetallicPaint");
-                ospSet3fv(material, "shadeColor", element.materialContainer->metallicShadeColor.data());
-                ospSet3fv(material, "glitterColor", element.materialContainer->metallicGlitterColor.data());
-                ospSet1f(material, "glitterSpread", element.materialContainer->metallicGlitterSpread);
-                ospSet1f(material, "eta", element.materialContainer->metallicEta);
-                break;
-            case PLASTIC:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Plastic");
-                ospSet3fv(material, "pigmentColor", element.materialContainer->plasticPigmentColor.data());
-                ospSet1f(material, "eta", element.materialContainer->plasticEta);
-                ospSet1f(material, "roughness", element.materialContainer->plasticRoughness);
-                ospSet1f(material, "thickness", element.materialContainer->plasticThickness);
-                break;
-            case THINGLASS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "ThinGlass");
-                ospSet3fv(material, "transmission", element.materialContainer->thinglassTransmission.data());
-                ospSet1f(material, "eta", element.materialContainer->thinglassEta);
-                ospSet1f(material, "thickness", element.materialContainer->thinglassThickness);
-                break;
-            case VELVET:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Velvet");
-                ospSet3fv(material, "reflectance", element.materialContainer->velvetReflectance.data());
-                ospSet3fv(
-                    material, "horizonScatteringColor", element.materialContainer->velvetHorizonScatteringColor.data());
-                ospSet1f(material, "backScattering", element.materialContainer->velvetBackScattering);
-                ospSet1f(
-                    material, "horizonScatteringFallOff", element.materialContainer->velvetHorizonScatteringFallOff);
-                break;
-            }
-            ospCommit(material);
-        }
 
-        if (material != NULL) {
-            ospSetMaterial(geo.back(), material);
+OSPMaterial AbstractOSPRayRenderer::createMaterial(OSPRayStructureContainer const& element) {
+
+    // custom material settings
+    OSPMaterial material = NULL;
+    if (element.materialContainer != NULL &&
+        this->rd_type.Param<megamol::core::param::EnumParam>()->Value() != MPI_RAYCAST) {
+        switch (element.materialContainer->materialType) {
+        case OBJMATERIAL:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "OBJMaterial");
+            ospSet3fv(material, "Kd", element.materialContainer->Kd.data());
+            ospSet3fv(material, "Ks", element.materialContainer->Ks.data());
+            ospSet1f(material, "Ns", element.materialContainer->Ns);
+            ospSet1f(material, "d", element.materialContainer->d);
+            ospSet3fv(material, "Tf", element.materialContainer->Tf.data());
+            break;
+        case LUMINOUS:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Luminous");
+            ospSet3fv(material, "color", element.materialContainer->lumColor.data());
+            ospSet1f(material, "intensity", element.materialContainer->lumIntensity);
+            ospSet1f(material, "transparency", element.materialContainer->lumTransparency);
+            break;
+        case GLASS:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Glass");
+            ospSet1f(material, "etaInside", element.materialContainer->glassEtaInside);
+            ospSet1f(material, "etaOutside", element.materialContainer->glassEtaOutside);
+            ospSet3fv(
+                material, "attenuationColorInside", element.materialContainer->glassAttenuationColorInside.data());
+            ospSet3fv(material, "attenuationColorOutside",
+                element.materialContainer->glassAttenuationColorOutside.data());
+            ospSet1f(material, "attenuationDistance", element.materialContainer->glassAttenuationDistance);
+            break;
+        case MATTE:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Matte");
+            ospSet3fv(material, "reflectance", element.materialContainer->matteReflectance.data());
+            break;
+        case METAL:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Metal");
+            ospSet3fv(material, "reflectance", element.materialContainer->metalReflectance.data());
+            ospSet3fv(material, "eta", element.materialContainer->metalEta.data());
+            ospSet3fv(material, "k", element.materialContainer->metalK.data());
+            ospSet1f(material, "roughness", element.materialContainer->metalRoughness);
+            break;
+        case METALLICPAINT:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "MetallicPaint");
+            ospSet3fv(material, "shadeColor", element.materialContainer->metallicShadeColor.data());
+            ospSet3fv(material, "glitterColor", element.materialContainer->metallicGlitterColor.data());
+            ospSet1f(material, "glitterSpread", element.materialContainer->metallicGlitterSpread);
+            ospSet1f(material, "eta", element.materialContainer->metallicEta);
+            break;
+        case PLASTIC:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Plastic");
+            ospSet3fv(material, "pigmentColor", element.materialContainer->plasticPigmentColor.data());
+            ospSet1f(material, "eta", element.materialContainer->plasticEta);
+            ospSet1f(material, "roughness", element.materialContainer->plasticRoughness);
+            ospSet1f(material, "thickness", element.materialContainer->plasticThickness);
+            break;
+        case THINGLASS:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "ThinGlass");
+            ospSet3fv(material, "transmission", element.materialContainer->thinglassTransmission.data());
+            ospSet1f(material, "eta", element.materialContainer->thinglassEta);
+            ospSet1f(material, "thickness", element.materialContainer->thinglassThickness);
+            break;
+        case VELVET:
+            material = ospNewMaterial2(this->rd_type_string.c_str(), "Velvet");
+            ospSet3fv(material, "reflectance", element.materialContainer->velvetReflectance.data());
+            ospSet3fv(
+                material, "horizonScatteringColor", element.materialContainer->velvetHorizonScatteringColor.data());
+            ospSet1f(material, "backScattering", element.materialContainer->velvetBackScattering);
+            ospSet1f(
+                material, "horizonScatteringFallOff", element.materialContainer->velvetHorizonScatteringFallOff);
+            break;
         }
-        ospCommit(geo.back());
+        ospCommit(material);
+    }
+    return material;
+}
+
+
+void AbstractOSPRayRenderer::applyMaterial(OSPRayStructureContainer const& element, structureCacheEntry& cached) {
+    OSPMaterial material = this->createMaterial(element);
+    if (material == NULL) return;
+
+    for (auto g : cached.geo) {
+        ospSetMaterial(g, material);
+        ospCommit(g);
+    }
+    ospRelease(material);
+}
+
+
+void AbstractOSPRayRenderer::releaseStructure(structureCacheEntry& cached) {
+    for (auto element : cached.geo) {
+        if (this->world != NULL) ospRemoveGeometry(this->world, element);
+        ospRelease(element);
+    }
+    for (auto element : cached.vol) {
+        if (this->world != NULL) ospRemoveVolume(this->world, element);
+        ospRelease(element);
     }
+    cached.geo.clear();
+    cached.vol.clear();
 }
 
 
@@ -714,104 +742,55 @@ bool AbstractOSPRayRenderer::fillWorld() {
 
     bool returnValue = true;
 
-    if (this->geo.size() != 0) {
-        for (auto element : this->geo) {
-            ospRemoveGeometry(this->world, element);
-            ospRelease(element);
-        }
-        this->geo.clear();
-    }
-    if (this->vol.size() != 0) {
-        for (auto element : this->vol) {
-            ospRemoveVolume(this->world, element);
-            ospRelease(element);
+    // drop the structures of modules that are no longer connected
+    for (auto it = this->structureCache.begin(); it != this->structureCache.end();) {
+        if (this->structureMap.find(it->first) == this->structureMap.end()) {
+            this->releaseStructure(it->second);
+            it = this->structureCache.erase(it);
+        } else {
+            ++it;
         }
-        this->vol.clear();
     }
+    this->geo.clear();
+    this->vol.clear();
     // ospRelease(this->world);
 
 
-    ospcommon::box3f worldBounds;
+    ospcommon::box3f worldBounds(ospcommon::empty);
     std::vector<ospcommon::box3f> ghostRegions;
     std::vector<ospcommon::box3f> regions;
 
-    for (auto entry : this->structureMap) {
+    for (auto const& entry : this->structureMap) {
 
         numCreateGeo = 1;
         auto const& element = entry.second;
 
-        // custom material settings
-        OSPMaterial material = NULL;
-        if (element.materialContainer != NULL &&
-            this->rd_type.Param<megamol::core::param::EnumParam>()->Value() != MPI_RAYCAST) {
-            switch (element.materialContainer->materialType) {
-            case OBJMATERIAL:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "OBJMaterial");
-                ospSet3fv(material, "Kd", element.materialContainer->Kd.data());
-                ospSet3fv(material, "Ks", element.materialContainer->Ks.data());
-                ospSet1f(material, "Ns", element.materialContainer->Ns);
-                ospSet1f(material, "d", element.materialContainer->d);
-                ospSet3fv(material, "Tf", element.materialContainer->Tf.data());
-                break;
-            case LUMINOUS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Luminous");
-                ospSet3fv(material, "color", element.materialContainer->lumColor.data());
-                ospSet1f(material, "intensity", element.materialContainer->lumIntensity);
-                ospSet1f(material, "transparency", element.materialContainer->lumTransparency);
-                break;
-            case GLASS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Glass");
-                ospSet1f(material, "etaInside", element.materialContainer->glassEtaInside);
-                ospSet1f(material, "etaOutside", element.materialContainer->glassEtaOutside);
-                ospSet3fv(
-                    material, "attenuationColorInside", element.materialContainer->glassAttenuationColorInside.data());
-                ospSet3fv(material, "attenuationColorOutside",
-                    element.materialContainer->glassAttenuationColorOutside.data());
-                ospSet1f(material, "attenuationDistance", element.materialContainer->glassAttenuationDistance);
-                break;
-            case MATTE:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Matte");
-                ospSet3fv(material, "reflectance", element.materialContainer->matteReflectance.data());
-                break;
-            case METAL:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Metal");
-                ospSet3fv(material, "reflectance", element.materialContainer->metalReflectance.data());
-                ospSet3fv(material, "eta", element.materialContainer->metalEta.data());
-                ospSet3fv(material, "k", element.materialContainer->metalK.data());
-                ospSet1f(material, "roughness", element.materialContainer->metalRoughness);
-                break;
-            case METALLICPAINT:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "MetallicPaint");
-                ospSet3fv(material, "shadeColor", element.materialContainer->metallicShadeColor.data());
-                ospSet3fv(material, "glitterColor", element.materialContainer->metallicGlitterColor.data());
-                ospSet1f(material, "glitterSpread", element.materialContainer->metallicGlitterSpread);
-                ospSet1f(material, "eta", element.materialContainer->metallicEta);
-                break;
-            case PLASTIC:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Plastic");
-                ospSet3fv(material, "pigmentColor", element.materialContainer->plasticPigmentColor.data());
-                ospSet1f(material, "eta", element.materialContainer->plasticEta);
-                ospSet1f(material, "roughness", element.materialContainer->plasticRoughness);
-                ospSet1f(material, "thickness", element.materialContainer->plasticThickness);
-                break;
-            case THINGLASS:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "ThinGlass");
-                ospSet3fv(material, "transmission", element.materialContainer->thinglassTransmission.data());
-                ospSet1f(material, "eta", element.materialContainer->thinglassEta);
-                ospSet1f(material, "thickness", element.materialContainer->thinglassThickness);
-                break;
-            case VELVET:
-                material = ospNewMaterial2(this->rd_type_string.c_str(), "Velvet");
-                ospSet3fv(material, "reflectance", element.materialContainer->velvetReflectance.data());
-                ospSet3fv(
-                    material, "horizonScatteringColor", element.materialContainer->velvetHorizonScatteringColor.data());
-                ospSet1f(material, "backScattering", element.materialContainer->velvetBackScattering);
-                ospSet1f(
-                    material, "horizonScatteringFallOff", element.materialContainer->velvetHorizonScatteringFallOff);
-                break;
+        // for data-parallel rendering, each rank owns the region covered by its local data
+        if (this->rd_type.Param<megamol::core::param::EnumParam>()->Value() == MPI_RAYCAST &&
+            element.localBounds != nullptr && !element.localBounds->IsEmpty()) {
+            auto const& b = *element.localBounds;
+            auto const r = element.globalRadius;
+            regions.emplace_back(ospcommon::vec3f(b.Left() - r, b.Bottom() - r, b.Back() - r),
+                ospcommon::vec3f(b.Right() + r, b.Top() + r, b.Front() + r));
+            worldBounds.extend(regions.back());
+        }
+
+        // unchanged data is still referenced by the committed objects, at most the material has to be updated
+        auto cached = this->structureCache.find(entry.first);
+        if (cached != this->structureCache.end()) {
+            if (!element.dataChanged) {
+                if (element.materialChanged) this->applyMaterial(element, cached->second);
+                this->geo.insert(this->geo.end(), cached->second.geo.begin(), cached->second.geo.end());
+                this->vol.insert(this->vol.end(), cached->second.vol.begin(), cached->second.vol.end());
+                continue;
             }
-            ospCommit(material);
+            this->releaseStructure(cached->second);
+            this->structureCache.erase(cached);
         }
+        auto const firstGeo = this->geo.size();
+        auto const firstVol = this->vol.size();
+
+        OSPMaterial material = this->createMaterial(element);
 
         OSPData vertexData = NULL;
         OSPData colorData = NULL;
@@ -986,9 +965,9 @@ bool AbstractOSPRayRenderer::fillWorld() {
 
                 {
 
-                    xData = ospNewData(element.partCount, OSP_FLOAT, element.xData->data());
-                    yData = ospNewData(element.partCount, OSP_FLOAT, element.yData->data());
-                    zData = ospNewData(element.partCount, OSP_FLOAT, element.zData->data());
+                    xData = ospNewData(element.partCount, OSP_FLOAT, element.xData->data(), OSP_DATA_SHARED_BUFFER);
+                    yData = ospNewData(element.partCount, OSP_FLOAT, element.yData->data(), OSP_DATA_SHARED_BUFFER);
+                    zData = ospNewData(element.partCount, OSP_FLOAT, element.zData->data(), OSP_DATA_SHARED_BUFFER);
 
                     ospCommit(xData);
                     ospCommit(yData);
@@ -1227,25 +1206,39 @@ bool AbstractOSPRayRenderer::fillWorld() {
             break;
         }
 
+        auto& created = this->structureCache[entry.first];
+        created.geo.assign(this->geo.begin() + firstGeo, this->geo.end());
+        created.vol.assign(this->vol.begin() + firstVol, this->vol.end());
+        if (material != NULL) ospRelease(material);
+
     } // for element loop
 
-    if (this->rd_type.Param<megamol::core::param::EnumParam>()->Value() == MPI_RAYCAST && ghostRegions.size() > 0 &&
-        regions.size() > 0) {
-        for (auto const& el : regions) {
-            ghostRegions.push_back(worldBounds);
-        }
+    if (this->rd_type.Param<megamol::core::param::EnumParam>()->Value() == MPI_RAYCAST && regions.size() > 0) {
+        // the local data already contains the ghost particles of the neighbours, so the bounds of all
+        // local structures are both the region of this rank and its ghost region
+        regions.assign(1, worldBounds);
+        ghostRegions = regions;
         auto ghostRegionData = ospNewData(2 * ghostRegions.size(), OSP_FLOAT3, ghostRegions.data());
-        auto regionData = ospNewData(2 * regions.size(), OSP_FLOAT3, ghostRegions.data());
+        auto regionData = ospNewData(2 * regions.size(), OSP_FLOAT3, regions.data());
         ospCommit(ghostRegionData);
         ospCommit(regionData);
         ospSetData(world, "ghostRegions", ghostRegionData);
-        ospSetData(world, "regions", ghostRegionData);
+        ospSetData(world, "regions", regionData);
+        ospRelease(ghostRegionData);
+        ospRelease(regionData);
     }
 
     return returnValue;
 }
 
-void AbstractOSPRayRenderer::releaseOSPRayStuff() {}
+void AbstractOSPRayRenderer::releaseOSPRayStuff() {
+    for (auto& entry : this->structureCache) {
+        this->releaseStructure(entry.second);
+    }
+    this->structureCache.clear();
+    this->geo.clear();
+    this->vol.clear();
+}
 
 } // end namespace ospray
 } // end namespace megamol
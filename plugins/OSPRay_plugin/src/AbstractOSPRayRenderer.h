@@ -106,6 +106,10 @@ protected:
      */
     bool fillWorld();
 
+    /**
+     * Applies the changed materials to the committed geometries.
+     *
+     */
     void changeMaterial();
 
     /**
@@ -114,6 +118,35 @@ protected:
      */
     void releaseOSPRayStuff();
 
+    /** The OSPRay objects committed for one structure, which are kept until its data changes */
+    struct structureCacheEntry {
+        std::vector<OSPGeometry> geo;
+        std::vector<OSPVolume> vol;
+    };
+
+    /**
+     * Creates and commits the material of a structure.
+     *
+     * @param element the structure
+     * @return the material, or NULL if the structure has none
+     */
+    OSPMaterial createMaterial(OSPRayStructureContainer const& element);
+
+    /**
+     * Sets the material of a structure on its committed geometries.
+     *
+     * @param element the structure
+     * @param cached the committed objects of the structure
+     */
+    void applyMaterial(OSPRayStructureContainer const& element, structureCacheEntry& cached);
+
+    /**
+     * Removes the committed objects of a structure from the world and releases them.
+     *
+     * @param cached the committed objects of the structure
+     */
+    void releaseStructure(structureCacheEntry& cached);
+
     // Interface Variables
     core::param::ParamSlot AOtransparencyEnabled;
     core::param::ParamSlot AOsamples;
@@ -161,6 +194,9 @@ protected:
     std::vector<OSPGeometry> geo;
     std::vector<OSPVolume> vol;
 
+    // committed objects per structure
+    std::map<CallOSPRayStructure*, structureCacheEntry> structureCache;
+
     // Structure map
     OSPRayStrcutrureMap structureMap;
     // extend map
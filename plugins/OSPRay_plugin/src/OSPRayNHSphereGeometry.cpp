@@ -73,6 +73,7 @@ bool OSPRayNHSphereGeometry::readData(megamol::core::Call &call) {
 
     unsigned int partCount = parts.GetCount();
     float globalRadius = parts.GetGlobalRadius();
+    this->structureContainer.localBounds = std::make_shared<vislib::math::Cuboid<float>>(parts.GetBBox());
 
     size_t vertexLength;
     size_t colorLength;
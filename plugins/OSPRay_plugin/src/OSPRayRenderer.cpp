@@ -8,6 +8,8 @@
 #include "OSPRayRenderer.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
 #include "vislib/graphics/CameraParamsStore.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
 #include "vislib/graphics/gl/ShaderSource.h"
@@ -16,7 +18,9 @@
 
 #include "mmcore/CoreInstance.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
 
 #include "ospcommon/vec.h"
@@ -35,11 +39,32 @@ OSPRayRenderer::OSPRayRenderer(void)
 	, cam()
     , osprayShader()
     , getStructureSlot("getStructure", "Connects to an OSPRay structure")
+    , adaptiveSlot("adaptive::enable",
+          "Renders at reduced resolution with one sample per pixel while the scene changes, and at full resolution "
+          "with accumulation when idle")
+    , targetFrameTimeSlot("adaptive::targetFrameTime", "Frame time in milliseconds targeted during interaction")
+    , minScaleSlot("adaptive::minScale", "Minimum resolution scale during interaction")
+    , denoiseSlot("adaptive::denoise", "Denoises the interactive and the first accumulated frames (requires OIDN)")
+    , denoiseFramesSlot("adaptive::denoiseFrames", "Number of accumulated frames after which denoising stops")
+    , renderScale(1.0f)
+    , accumFrames(0)
+    , denoiserWarned(false)
 
 {
     this->getStructureSlot.SetCompatibleCall<CallOSPRayStructureDescription>();
     this->MakeSlotAvailable(&this->getStructureSlot);
 
+    this->adaptiveSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->adaptiveSlot);
+    this->targetFrameTimeSlot << new core::param::FloatParam(50.0f, 1.0f);
+    this->MakeSlotAvailable(&this->targetFrameTimeSlot);
+    this->minScaleSlot << new core::param::FloatParam(0.25f, 0.05f, 1.0f);
+    this->MakeSlotAvailable(&this->minScaleSlot);
+    this->denoiseSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->denoiseSlot);
+    this->denoiseFramesSlot << new core::param::IntParam(32, 0);
+    this->MakeSlotAvailable(&this->denoiseFramesSlot);
+
 
     imgSize.x = 0;
     imgSize.y = 0;
@@ -111,6 +136,7 @@ bool OSPRayRenderer::create() {
 ospray::OSPRayRenderer::release
 */
 void OSPRayRenderer::release() {
+    this->releaseOSPRayStuff();
     if (camera != NULL) ospRelease(camera);
     if (world != NULL) ospRelease(world);
     if (renderer != NULL) ospRelease(renderer);
@@ -129,6 +155,8 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
 
     // if user wants to switch renderer
     if (this->rd_type.IsDirty()) {
+        // the committed structures belong to the old world
+        this->releaseOSPRayStuff();
         ospRelease(camera);
         ospRelease(world);
         ospRelease(renderer);
@@ -198,15 +226,26 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
 
     // glDisable(GL_CULL_FACE);
 
+    // while the scene changes, adaptive rendering uses a reduced resolution and one sample per pixel
+    const bool interactive = this->adaptiveSlot.Param<core::param::BoolParam>()->Value() &&
+                             (data_has_changed || material_has_changed || light_has_changed || cam_has_changed ||
+                                 renderer_has_changed || frameID != static_cast<size_t>(cr.Time()) ||
+                                 this->InterfaceIsDirty());
+    osp::vec2i renderSize;
+    renderSize.x = cam.resolution_gate().width();
+    renderSize.y = cam.resolution_gate().height();
+    if (interactive) {
+        renderSize.x = std::max(1, static_cast<int>(renderSize.x * this->renderScale));
+        renderSize.y = std::max(1, static_cast<int>(renderSize.y * this->renderScale));
+    }
+
     // new framebuffer at resize action
     // bool triggered = false;
-    if (imgSize.x != cam.resolution_gate().width() ||
-        imgSize.y != cam.resolution_gate().height() || accumulateSlot.IsDirty()) {
+    if (imgSize.x != renderSize.x || imgSize.y != renderSize.y || accumulateSlot.IsDirty()) {
         // triggered = true;
         // Breakpoint for Screenshooter debugging
         if (framebuffer != NULL) ospFreeFrameBuffer(framebuffer);
-        imgSize.x = cam.resolution_gate().width();
-        imgSize.y = cam.resolution_gate().height();
+        imgSize = renderSize;
         framebuffer = newFrameBuffer(imgSize, OSP_FB_RGBA8, OSP_FB_COLOR | OSP_FB_DEPTH | OSP_FB_ACCUM);
         db.resize(imgSize.x * imgSize.y);
         ospCommit(framebuffer);
@@ -264,6 +303,9 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
             this->maxDepthTexture = getOSPDepthTextureFromOpenGLPerspective(*cr);
         */
         RendererSettings(renderer);
+        if (interactive) {
+            ospSet1i(renderer, "spp", 1);
+        }
 
 
         // Enable Lights
@@ -295,6 +337,16 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
             accum_time.amount = 0;
         }
 
+        // the render time scales with the number of pixels, i.e. the square of the resolution scale
+        if (interactive && duration.count() > 0) {
+            const float target = this->targetFrameTimeSlot.Param<core::param::FloatParam>()->Value() * 1000.0f;
+            const float factor = std::sqrt(target / static_cast<float>(duration.count()));
+            this->renderScale *= std::min(std::max(factor, 0.5f), 2.0f);
+            this->renderScale = std::min(
+                std::max(this->renderScale, this->minScaleSlot.Param<core::param::FloatParam>()->Value()), 1.0f);
+        }
+        this->accumFrames = 1;
+
         if (this->useDB.Param<core::param::BoolParam>()->Value()) {
             getOpenGLDepthFromOSPPerspective(db.data());
         }
@@ -313,7 +365,15 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
         //    this->number++;
         //}
 
-        this->renderTexture2D(osprayShader, fb, db.data(), imgSize.x, imgSize.y, cr);
+        // with the distributed device, only the master rank receives the composited image
+        if (fb == nullptr) {
+            // nothing to show on this rank
+        } else if (this->denoiseSlot.Param<core::param::BoolParam>()->Value() &&
+                   this->denoise(fb, imgSize.x, imgSize.y)) {
+            this->renderTexture2D(osprayShader, this->denoised.data(), db.data(), imgSize.x, imgSize.y, cr);
+        } else {
+            this->renderTexture2D(osprayShader, fb, db.data(), imgSize.x, imgSize.y, cr);
+        }
 
         // clear stuff
         ospUnmapFrameBuffer(fb, framebuffer);
@@ -325,8 +385,17 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
     } else {
         ospRenderFrame(framebuffer, renderer, OSP_FB_COLOR | OSP_FB_DEPTH | OSP_FB_ACCUM);
         fb = (uint32_t*)ospMapFrameBuffer(framebuffer, OSP_FB_COLOR);
-
-        this->renderTexture2D(osprayShader, fb, db.data(), imgSize.x, imgSize.y, cr);
+        this->accumFrames++;
+
+        if (fb == nullptr) {
+            // nothing to show on this rank
+        } else if (this->denoiseSlot.Param<core::param::BoolParam>()->Value() &&
+            this->accumFrames <= static_cast<unsigned int>(this->denoiseFramesSlot.Param<core::param::IntParam>()->Value()) &&
+            this->denoise(fb, imgSize.x, imgSize.y)) {
+            this->renderTexture2D(osprayShader, this->denoised.data(), db.data(), imgSize.x, imgSize.y, cr);
+        } else {
+            this->renderTexture2D(osprayShader, fb, db.data(), imgSize.x, imgSize.y, cr);
+        }
         ospUnmapFrameBuffer(fb, framebuffer);
     }
 
@@ -339,7 +408,7 @@ bool OSPRayRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
 ospray::OSPRayRenderer::InterfaceIsDirty()
 */
 bool OSPRayRenderer::InterfaceIsDirty() {
-    if (this->AbstractIsDirty()) {
+    if (this->AbstractIsDirty() || this->adaptiveSlot.IsDirty() || this->denoiseSlot.IsDirty()) {
         return true;
     } else {
         return false;
@@ -349,7 +418,70 @@ bool OSPRayRenderer::InterfaceIsDirty() {
 /*
 ospray::OSPRayRenderer::InterfaceResetDirty()
 */
-void OSPRayRenderer::InterfaceResetDirty() { this->AbstractResetDirty(); }
+void OSPRayRenderer::InterfaceResetDirty() {
+    this->AbstractResetDirty();
+    this->adaptiveSlot.ResetDirty();
+    this->denoiseSlot.ResetDirty();
+}
+
+
+/*
+ospray::OSPRayRenderer::denoise
+*/
+bool OSPRayRenderer::denoise(const uint32_t* color, int width, int height) {
+#ifdef WITH_OIDN
+    if (!this->oidnDevice) {
+        this->oidnDevice = oidn::newDevice();
+        this->oidnDevice.commit();
+        this->oidnFilter = this->oidnDevice.newFilter("RT");
+    }
+
+    const size_t pixels = static_cast<size_t>(width) * height;
+    this->denoiseIn.resize(3 * pixels);
+    this->denoiseOut.resize(3 * pixels);
+    this->denoised.resize(pixels);
+
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(color);
+#pragma omp parallel for
+    for (long long i = 0; i < static_cast<long long>(pixels); ++i) {
+        for (int c = 0; c < 3; ++c) {
+            this->denoiseIn[3 * i + c] = in[4 * i + c] / 255.0f;
+        }
+    }
+
+    this->oidnFilter.setImage("color", this->denoiseIn.data(), oidn::Format::Float3, width, height);
+    this->oidnFilter.setImage("output", this->denoiseOut.data(), oidn::Format::Float3, width, height);
+    this->oidnFilter.commit();
+    this->oidnFilter.execute();
+
+    const char* msg;
+    if (this->oidnDevice.getError(msg) != oidn::Error::None) {
+        if (!this->denoiserWarned) {
+            vislib::sys::Log::DefaultLog.WriteWarn("OSPRayRenderer: Denoising failed: %s", msg);
+            this->denoiserWarned = true;
+        }
+        return false;
+    }
+
+    unsigned char* out = reinterpret_cast<unsigned char*>(this->denoised.data());
+#pragma omp parallel for
+    for (long long i = 0; i < static_cast<long long>(pixels); ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const float v = std::min(std::max(this->denoiseOut[3 * i + c], 0.0f), 1.0f);
+            out[4 * i + c] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+        }
+        out[4 * i + 3] = in[4 * i + 3];
+    }
+    return true;
+#else
+    if (!this->denoiserWarned) {
+        vislib::sys::Log::DefaultLog.WriteWarn(
+            "OSPRayRenderer: Denoising is not available, the plugin was built without OpenImageDenoise");
+        this->denoiserWarned = true;
+    }
+    return false;
+#endif
+}
 
 
 /*
@@ -428,6 +560,7 @@ void OSPRayRenderer::getOpenGLDepthFromOSPPerspective(float* db) {
 
     // map OSPRay depth buffer from provided frame buffer
     const float* ospDepthBuffer = (const float*)ospMapFrameBuffer(this->framebuffer, OSP_FB_DEPTH);
+    if (ospDepthBuffer == nullptr) return;
 
     const size_t ospDepthBufferWidth = (size_t)this->imgSize.x;
     const size_t ospDepthBufferHeight = (size_t)this->imgSize.y;
@@ -13,6 +13,10 @@
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include <chrono>
 
+#ifdef WITH_OIDN
+#include <OpenImageDenoise/oidn.hpp>
+#endif
+
 
 namespace megamol {
 namespace ospray {
@@ -123,6 +127,38 @@ private:
         unsigned long long int count;
         unsigned long long int amount;
     } accum_time;
+
+    /**
+    * Denoises the color of the current frame into 'denoised'.
+    *
+    * @param color The RGBA8 color of the frame
+    * @param width The width of the frame
+    * @param height The height of the frame
+    *
+    * @return 'true' if the frame was denoised, 'false' if no denoiser is available
+    */
+    bool denoise(const uint32_t* color, int width, int height);
+
+    // adaptive progressive rendering
+    core::param::ParamSlot adaptiveSlot;
+    core::param::ParamSlot targetFrameTimeSlot;
+    core::param::ParamSlot minScaleSlot;
+    core::param::ParamSlot denoiseSlot;
+    core::param::ParamSlot denoiseFramesSlot;
+
+    // resolution scale of the interactive frames, adapted to the target frame time
+    float renderScale;
+    // number of frames accumulated since the last reset
+    unsigned int accumFrames;
+    std::vector<uint32_t> denoised;
+    bool denoiserWarned;
+
+#ifdef WITH_OIDN
+    oidn::DeviceRef oidnDevice;
+    oidn::FilterRef oidnFilter;
+    std::vector<float> denoiseIn;
+    std::vector<float> denoiseOut;
+#endif
 };
 
 } /*end namespace ospray*/
@@ -92,6 +92,7 @@ bool OSPRaySphereGeometry::readData(megamol::core::Call &call) {
 
     unsigned int partCount = parts.GetCount();
     float globalRadius = parts.GetGlobalRadius();
+    this->structureContainer.localBounds = std::make_shared<vislib::math::Cuboid<float>>(parts.GetBBox());
 
     size_t vertexLength;
     size_t colorLength;
@@ -102,6 +103,30 @@ bool OSPRaySphereGeometry::readData(megamol::core::Call &call) {
     } else if (parts.GetVertexDataType() == core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
         vertexLength = 4;
     }
+
+    // float positions interleaved with float colours can be shared with OSPRay without copying
+    auto const colType = parts.GetColourDataType();
+    if ((parts.GetVertexDataType() == core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ ||
+            parts.GetVertexDataType() == core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) &&
+        (colType == core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB ||
+            colType == core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA) &&
+        parts.GetVertexDataStride() != 0 && parts.GetVertexDataStride() == parts.GetColourDataStride() &&
+        static_cast<const char*>(parts.GetColourData()) ==
+            static_cast<const char*>(parts.GetVertexData()) + vertexLength * sizeof(float)) {
+        this->structureContainer.type = structureTypeEnum::GEOMETRY;
+        this->structureContainer.geometryType = geometryTypeEnum::NHSPHERES;
+        this->structureContainer.raw = parts.GetVertexData();
+        this->structureContainer.vertexLength = vertexLength;
+        this->structureContainer.vertexStride = parts.GetVertexDataStride();
+        this->structureContainer.colorLength =
+            (colType == core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB) ? 3 : 4;
+        this->structureContainer.colorStride = parts.GetColourDataStride();
+        this->structureContainer.partCount = partCount;
+        this->structureContainer.globalRadius = globalRadius;
+        this->structureContainer.mmpldColor = colType;
+        return true;
+    }
+
     // reserve space for vertex data object
     vd.reserve(parts.GetCount() * vertexLength);
 
@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "Pkd.h"
+#include "mmcore/utility/ResultCache.h"
+#include <algorithm>
 #include <iostream>
 #include <stdint.h>
 #include <thread>
@@ -14,8 +16,11 @@ ospray::PkdBuilder::PkdBuilder()
     : megamol::stdplugin::datatools::AbstractParticleManipulator("outData", "inData")
     , inDataHash(0)
     , outDataHash(0)
+    , frameID(0)
     , numParticles(0)
-    , numInnerNodes(0) {
+    , numInnerNodes(0)
+    , numLevels(0)
+    , parallelDepth(0) {
     model = std::make_shared<ParticleModel>();
 }
 
@@ -24,7 +29,9 @@ ospray::PkdBuilder::~PkdBuilder() { Release(); }
 bool ospray::PkdBuilder::manipulateData(
     core::moldyn::MultiParticleDataCall& outData, core::moldyn::MultiParticleDataCall& inData) {
 
-    if ((inData.DataHash() != inDataHash) || (inData.FrameID() != frameID) || (inData.DataHash() == 0)) {
+    const bool changed =
+        (inData.DataHash() != inDataHash) || (inData.FrameID() != frameID) || (inData.DataHash() == 0);
+    if (changed) {
         inDataHash = inData.DataHash();
         outDataHash++;
         frameID = inData.FrameID();
@@ -35,25 +42,83 @@ bool ospray::PkdBuilder::manipulateData(
     outData.SetFrameID(frameID);
     outData.SetDataHash(outDataHash);
 
+    // the trees only depend on the input data, so unchanged data is not sorted again
+    if (changed || (this->trees.size() != inData.GetParticleListCount())) {
+        this->buildTrees(inData);
+    }
+
     for (unsigned int i = 0; i < inData.GetParticleListCount(); i++) {
-        auto& parts = inData.AccessParticles(i);
         auto& out = outData.AccessParticles(i);
+        const float* tree = (this->trees[i] != nullptr) ? &this->trees[i]->x : nullptr;
+
+        out.SetVertexData(megamol::core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ, tree, 16);
+        out.SetColourData(megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I,
+            (tree != nullptr) ? tree + 3 : nullptr, 16);
+    }
+
+    return true;
+}
 
-        // empty the model
-        this->model->position.clear();
+
+void ospray::PkdBuilder::buildTrees(core::moldyn::MultiParticleDataCall& inData) {
+    const unsigned int listCount = inData.GetParticleListCount();
+    const size_t headerSize = (1 + listCount) * sizeof(uint64_t);
+    this->trees.assign(listCount, nullptr);
+    this->models.clear();
+    this->cachedTrees.reset();
+
+    // Trees are cached as [list count, particle count of each list..., particles of all lists...]
+    auto& cache = core::utility::ResultCache::Instance();
+    const auto key = core::utility::ResultCache::MakeKey(this->FullName(), this->inDataHash, this->frameID, {});
+    // A data hash of zero does not identify the data, so the result must not be shared
+    auto cached = (this->inDataHash != 0) ? cache.Find(key) : nullptr;
+    if (cached && (cached->size() >= headerSize)) {
+        const uint64_t* header = reinterpret_cast<const uint64_t*>(cached->data());
+        bool valid = (header[0] == listCount);
+        uint64_t total = 0;
+        for (unsigned int i = 0; valid && (i < listCount); i++) {
+            valid = (header[1 + i] == inData.AccessParticles(i).GetCount());
+            total += header[1 + i];
+        }
+        if (valid && (cached->size() == headerSize + total * sizeof(ospcommon::vec4f))) {
+            const ospcommon::vec4f* particles = reinterpret_cast<const ospcommon::vec4f*>(header + 1 + listCount);
+            for (unsigned int i = 0; i < listCount; i++) {
+                if (header[1 + i] > 0) this->trees[i] = particles;
+                particles += header[1 + i];
+            }
+            this->cachedTrees = cached;
+            return;
+        }
+    }
+
+    size_t total = 0;
+    for (unsigned int i = 0; i < listCount; i++) {
+        auto& parts = inData.AccessParticles(i);
+        this->models.push_back(std::make_shared<ParticleModel>());
+        if (parts.GetCount() == 0) continue;
 
         // put data the data into the model
         // and build the pkd tree
+        this->model = this->models.back();
         this->model->fill(parts);
+        if (this->model->position.empty()) continue;
         this->build();
 
-
-        out.SetVertexData(
-            megamol::core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ, &this->model->position[0].x, 16);
-        out.SetColourData(megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I, &this->model->position[0].w, 16);
+        this->trees[i] = this->model->position.data();
+        total += this->model->position.size();
     }
 
-    return true;
+    if (this->inDataHash == 0) return;
+    std::vector<unsigned char> result(headerSize + total * sizeof(ospcommon::vec4f));
+    uint64_t* header = reinterpret_cast<uint64_t*>(result.data());
+    ospcommon::vec4f* particles = reinterpret_cast<ospcommon::vec4f*>(header + 1 + listCount);
+    header[0] = listCount;
+    for (unsigned int i = 0; i < listCount; i++) {
+        const auto& position = this->models[i]->position;
+        header[1 + i] = position.size();
+        particles = std::copy(position.begin(), position.end(), particles);
+    }
+    cache.Store(key, std::move(result));
 }
 
 
@@ -119,6 +184,12 @@ void ospray::PkdBuilder::build() {
     }
     // PRINT(numLevels);
 
+    // subtrees are built concurrently down to a depth giving about four subtrees per thread,
+    // so that uneven splits still keep all threads busy without spawning a thread per node
+    const size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    parallelDepth = 2;
+    while ((1ULL << (parallelDepth - 2)) < numThreads) ++parallelDepth;
+
     const ospcommon::box3f& bounds = model->getBounds();
     std::cout << "#osp:pkd: bounds of model " << bounds << std::endl;
     std::cout << "#osp:pkd: number of input particles " << numParticles << std::endl;
@@ -227,7 +298,7 @@ void ospray::PkdBuilder::buildRec(const size_t nodeID, const ospcommon::box3f& b
 
     lBounds.upper[dim] = rBounds.lower[dim] = pos(nodeID, dim);
 
-    if ((numLevels - depth) > 20) {
+    if ((depth < parallelDepth) && ((numLevels - depth) > 10)) {
         std::thread lThread(&pkdBuildThread, new PKDBuildJob(this, leftChildOf(nodeID), lBounds, depth + 1));
         buildRec(rightChildOf(nodeID), rBounds, depth + 1);
         lThread.join();
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <vector>
 #include "mmcore/CallerSlot.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmstd_datatools/AbstractParticleManipulator.h"
@@ -46,6 +48,16 @@ private:
     size_t numInnerNodes;
     size_t numLevels;
 
+    //! subtrees above this depth are built concurrently
+    size_t parallelDepth;
+
+    //! the trees built for the current frame, one model per particle list
+    std::vector<std::shared_ptr<ParticleModel>> models;
+    //! the trees of the current frame taken from the result cache
+    std::shared_ptr<const std::vector<unsigned char>> cachedTrees;
+    //! the sorted particles of each list, pointing into 'models' or 'cachedTrees'
+    std::vector<const ospcommon::vec4f*> trees;
+
     __forceinline size_t isInnerNode(const size_t nodeID) const { return nodeID < numInnerNodes; }
     __forceinline size_t isLeafNode(const size_t nodeID) const { return nodeID >= numInnerNodes; }
     __forceinline size_t isValidNode(const size_t nodeID) const { return nodeID < numParticles; }
@@ -66,6 +78,9 @@ private:
 
     //! build particle tree over given model. WILL REORDER THE MODEL'S ELEMENTS
     void build();
+
+    //! fetch the trees of all lists from the result cache, or build and cache them
+    void buildTrees(megamol::core::moldyn::MultiParticleDataCall& inData);
 };
 
 
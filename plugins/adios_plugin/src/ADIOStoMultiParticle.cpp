@@ -10,13 +10,73 @@
 #include "CallADIOSData.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "vislib/sys/Log.h"
+#include <cstdint>
 #include <numeric>
-#include <complex.h>
-#include <complex.h>
 
 namespace megamol {
 namespace adios {
 
+namespace {
+
+/**
+ * Shares the ownership of a column for a pointer to one of its elements.
+ *
+ * @param column The column.
+ * @param index The index of the element.
+ * @param components The number of values per element.
+ */
+core::moldyn::SimpleSphericalParticles::SharedBuffer shareColumn(
+    const std::shared_ptr<abstractContainer>& column, size_t index, size_t components) {
+    return core::moldyn::SimpleSphericalParticles::SharedBuffer(
+        column, static_cast<const char*>(column->getDataPtr()) + index * components * column->getTypeSize());
+}
+
+/**
+ * Converts strided values in parallel. The loop only consists of the conversion, so it can be vectorised.
+ */
+template <class T, class S> void convertStrided(const S* src, size_t srcStride, T* dst, size_t dstStride, int64_t cnt) {
+#pragma omp parallel for
+    for (int64_t i = 0; i < cnt; ++i) {
+        dst[i * dstStride] = static_cast<T>(src[i * srcStride]);
+    }
+}
+
+/**
+ * Converts one component of the elements of a column and writes it to the strided destination.
+ *
+ * @param column The column.
+ * @param first The index of the first element.
+ * @param components The number of values per element.
+ * @param component The component to convert.
+ * @param dst The first destination value.
+ * @param dstStride The distance between two destination values.
+ * @param cnt The number of elements.
+ */
+template <class T>
+void gatherColumn(abstractContainer& column, size_t first, size_t components, size_t component, T* dst,
+    size_t dstStride, int64_t cnt) {
+    const size_t offset = first * components + component;
+    const auto type = column.getType();
+    if (type == "float") {
+        convertStrided(static_cast<const float*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    } else if (type == "double") {
+        convertStrided(static_cast<const double*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    } else if (type == "int") {
+        convertStrided(static_cast<const int*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    } else if (type == "unsigned int") {
+        convertStrided(
+            static_cast<const unsigned int*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    } else if (type == "unsigned long long int") {
+        convertStrided(
+            static_cast<const unsigned long long int*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    } else if (type == "unsigned char") {
+        convertStrided(
+            static_cast<const unsigned char*>(column.getDataPtr()) + offset, components, dst, dstStride, cnt);
+    }
+}
+
+} // namespace
+
 ADIOStoMultiParticle::ADIOStoMultiParticle(void)
     : core::Module()
     , mpSlot("mpSlot", "Slot to send multi particle data.")
@@ -113,32 +173,22 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
             return false;
         }
 
-        std::vector<char> X;
-        std::vector<char> Y;
-        std::vector<char> Z;
-
-        stride = 0;
+        // Columns, which are passed on without copying wherever their layout allows it
+        std::shared_ptr<abstractContainer> pos[3], radius, col[4], intensity, id;
         if (cad->isInVars("xyz")) {
-            X = cad->getData("xyz")->GetAsChar();
-            stride += 3 * cad->getData("xyz")->getTypeSize();
+            pos[0] = cad->getData("xyz");
         } else if (cad->isInVars("x") && cad->isInVars("y") && cad->isInVars("z")) {
-            X = cad->getData("x")->GetAsChar();
-            Y = cad->getData("y")->GetAsChar();
-            Z = cad->getData("z")->GetAsChar();
-            stride += 3 * cad->getData("x")->getTypeSize();
+            pos[0] = cad->getData("x");
+            pos[1] = cad->getData("y");
+            pos[2] = cad->getData("z");
         } else {
             vislib::sys::Log::DefaultLog.WriteError("ADIOStoMultiParticle: No particle positions found");
             return false;
         }
         auto box = cad->getData("global_box")->GetAsFloat();
         std::vector<unsigned long long int> p_count = cad->getData("count")->GetAsUInt64();
-        std::vector<char> radius;
-        std::vector<char> r;
-        std::vector<char> g;
-        std::vector<char> b;
-        std::vector<char> a;
-        std::vector<char> id;
-        std::vector<char> intensity;
+        std::vector<float> global_radius;
+        std::vector<float> global_col[4];
 
         // list_box
         if (cad->isInVars("list_box")) {
@@ -146,39 +196,27 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
         }
         // Radius
         if (cad->isInVars("radius")) {
-            radius = cad->getData("radius")->GetAsChar();
-            stride += 3 * cad->getData("radius")->getTypeSize();
+            radius = cad->getData("radius");
         } else if (cad->isInVars("global_radius")) {
-            radius = cad->getData("global_radius")->GetAsChar();
+            global_radius = cad->getData("global_radius")->GetAsFloat();
         }
         // Colors
         if (cad->isInVars("r")) {
-            r = cad->getData("r")->GetAsChar();
-            g = cad->getData("g")->GetAsChar();
-            b = cad->getData("b")->GetAsChar();
-            a = cad->getData("a")->GetAsChar();
-            stride += 4 * cad->getData("r")->getTypeSize();
+            col[0] = cad->getData("r");
+            col[1] = cad->getData("g");
+            col[2] = cad->getData("b");
+            col[3] = cad->getData("a");
         } else if (cad->isInVars("global_r")) {
-            r = cad->getData("global_r")->GetAsChar();
-            g = cad->getData("global_g")->GetAsChar();
-            b = cad->getData("global_b")->GetAsChar();
-            a = cad->getData("global_a")->GetAsChar();
+            global_col[0] = cad->getData("global_r")->GetAsFloat();
+            global_col[1] = cad->getData("global_g")->GetAsFloat();
+            global_col[2] = cad->getData("global_b")->GetAsFloat();
+            global_col[3] = cad->getData("global_a")->GetAsFloat();
         } else if (cad->isInVars("i")) {
-            intensity = cad->getData("i")->GetAsChar();
-            stride += cad->getData("i")->getTypeSize();
-            // normalizing intentsity to [0,1]
-            // std::vector<float>::iterator minIt = std::min_element(std::begin(intensity), std::end(intensity));
-            // std::vector<float>::iterator maxIt = std::max_element(std::begin(intensity), std::end(intensity));
-            // float minIntensity = intensity[std::distance(std::begin(intensity), minIt)];
-            // float maxIntensity = intensity[std::distance(std::begin(intensity), maxIt)];
-            // for (auto i = 0; i < intensity.size(); i++) {
-            //	intensity[i] = (intensity[i] - minIntensity)/(maxIntensity - minIntensity);
-            //}
+            intensity = cad->getData("i");
         }
         // ID
         if (cad->isInVars("id")) {
-            id = cad->getData("id")->GetAsChar();
-            stride += cad->getData("id")->getTypeSize();
+            id = cad->getData("id");
         }
 
         // Set bounding box
@@ -204,110 +242,132 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
             }
         }
 
+        // Set types, the same for all lists. Interleaved positions, intensities and ids are passed through in
+        // their own type, everything else is packed per list.
+        const bool interleaved = (pos[1] == nullptr);
+        const bool vertPassthrough =
+            interleaved && radius == nullptr && (pos[0]->getType() == "float" || pos[0]->getType() == "double");
+        if (vertPassthrough) {
+            vertType = pos[0]->getType() == "float" ? core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ
+                                                    : core::moldyn::SimpleSphericalParticles::VERTDATA_DOUBLE_XYZ;
+            vertStride = 3 * pos[0]->getTypeSize();
+        } else {
+            vertType = radius != nullptr ? core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZR
+                                         : core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ;
+            vertStride = core::moldyn::SimpleSphericalParticles::VertexDataSize[vertType];
+        }
+
+        colType = core::moldyn::SimpleSphericalParticles::COLDATA_NONE;
+        bool colPassthrough = false;
+        if (col[0] != nullptr) {
+            colType = col[0]->getType() == "float" || col[0]->getType() == "double"
+                          ? core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGBA
+                          : core::moldyn::SimpleSphericalParticles::COLDATA_UINT8_RGBA;
+        } else if (intensity != nullptr) {
+            colPassthrough = intensity->getType() == "float" || intensity->getType() == "double";
+            colType = intensity->getType() == "double" ? core::moldyn::SimpleSphericalParticles::COLDATA_DOUBLE_I
+                                                       : core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I;
+        }
+        colStride = core::moldyn::SimpleSphericalParticles::ColorDataSize[colType];
+
+        idType = core::moldyn::SimpleSphericalParticles::IDDATA_NONE;
+        if (id != nullptr) {
+            if (id->getType() == "unsigned long long int") {
+                idType = core::moldyn::SimpleSphericalParticles::IDDATA_UINT64;
+            } else if (id->getType() == "unsigned int") {
+                idType = core::moldyn::SimpleSphericalParticles::IDDATA_UINT32;
+            }
+        }
+        idStride = core::moldyn::SimpleSphericalParticles::IDDataSize[idType];
+
         // Set particle list count
+        plist_count.clear();
         plist_count.reserve(plist_offset.size());
         mpdc->SetParticleListCount(plist_offset.size());
-        mix.resize(plist_offset.size());
+        vertData.assign(plist_offset.size(), nullptr);
+        colData.assign(plist_offset.size(), nullptr);
+        idData.assign(plist_offset.size(), nullptr);
         for (auto k = 0; k < plist_offset.size(); k++) {
 
             unsigned long long int particleCount;
 
             if (k == plist_offset.size()-1) {
-                auto tot_count = std::accumulate(p_count.begin(), p_count.end(), 0);
+                auto tot_count = std::accumulate(p_count.begin(), p_count.end(), 0ull);
                 particleCount = tot_count - plist_offset[k];
             } else {
                 particleCount = plist_offset[k + 1] - plist_offset[k];
             }
             plist_count.emplace_back(particleCount);
 
-            // Set types
-            colType = core::moldyn::SimpleSphericalParticles::COLDATA_NONE;
-            vertType = core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ;
-            idType = core::moldyn::SimpleSphericalParticles::IDDATA_NONE;
+            const size_t first = plist_offset[k];
+            const int64_t cnt = static_cast<int64_t>(particleCount);
 
-            if (cad->isInVars("global_radius")) {
-                auto flt_radius = reinterpret_cast<std::vector<float>&>(radius);
-                mpdc->AccessParticles(k).SetGlobalRadius(flt_radius[0]);
-            } else if (cad->isInVars("radius")) {
-                vertType = core::moldyn::SimpleSphericalParticles::VERTDATA_FLOAT_XYZR;
-            } else {
+            if (!global_radius.empty()) {
+                mpdc->AccessParticles(k).SetGlobalRadius(global_radius[0]);
+            } else if (radius == nullptr) {
                 mpdc->AccessParticles(k).SetGlobalRadius(1.0f);
             }
-            if (cad->isInVars("global_r")) {
-                auto flt_r = reinterpret_cast<std::vector<float>&>(r);
-                auto flt_g = reinterpret_cast<std::vector<float>&>(g);
-                auto flt_b = reinterpret_cast<std::vector<float>&>(b);
-                auto flt_a = reinterpret_cast<std::vector<float>&>(a);
-                mpdc->AccessParticles(k).SetGlobalColour(r[0] * 255, g[0] * 255, b[0] * 255, a[0] * 255);
-            } else if (cad->isInVars("r")) {
-                if (cad->getData("r")->getType() == "float") {
-                    colType = core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGBA;
-                } else {
-                    colType = core::moldyn::SimpleSphericalParticles::COLDATA_UINT8_RGBA;
-                }
-            } else if (cad->isInVars("i")) {
-                colType = core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I;
-            } else {
+            if (!global_col[0].empty()) {
+                mpdc->AccessParticles(k).SetGlobalColour(global_col[0][0] * 255, global_col[1][0] * 255,
+                    global_col[2][0] * 255, global_col[3][0] * 255);
+            } else if (col[0] == nullptr && intensity == nullptr) {
                 mpdc->AccessParticles(k).SetGlobalColour(0.8 * 255, 0.8 * 255, 0.8 * 255, 1.0 * 255);
             }
-            if (cad->isInVars("id")) {
-                if (cad->getData("id")->getType() == "unsigned long long int") {
-                    idType = core::moldyn::SimpleSphericalParticles::IDDATA_UINT64;
-                } else if (cad->getData("id")->getType() == "unsigned int") {
-                    idType = core::moldyn::SimpleSphericalParticles::IDDATA_UINT32;
-                }
-            }
 
-            // Fill mmpld byte array
-            mix[k].clear();
-            mix[k].shrink_to_fit();
-            mix[k].reserve(stride * p_count[k]);
-
-            for (size_t i = plist_offset[k]; i < (plist_offset[k] + particleCount); i++) {
-
-                if (cad->isInVars("xyz")) {
-                    const size_t sot = cad->getData("xyz")->getTypeSize();
-                    mix[k].insert(mix[k].end(), X.begin() + 3 * sot * i, X.begin() + 3 * sot * i + 3 * sot);
-                } else {
-                    const size_t sot = cad->getData("x")->getTypeSize();
-                    mix[k].insert(mix[k].end(), X.begin() + sot * i, X.begin() + sot * (i + 1));
-                    mix[k].insert(mix[k].end(), Y.begin() + sot * i, Y.begin() + sot * (i + 1));
-                    mix[k].insert(mix[k].end(), Z.begin() + sot * i, Z.begin() + sot * (i + 1));
+            // Positions
+            if (vertPassthrough) {
+                vertData[k] = shareColumn(pos[0], first, 3);
+            } else {
+                const size_t comps = radius != nullptr ? 4 : 3;
+                auto packed = std::make_shared<std::vector<float>>(comps * particleCount);
+                for (size_t c = 0; c < 3; ++c) {
+                    if (interleaved) {
+                        gatherColumn(*pos[0], first, 3, c, packed->data() + c, comps, cnt);
+                    } else {
+                        gatherColumn(*pos[c], first, 1, 0, packed->data() + c, comps, cnt);
+                    }
                 }
-                if (cad->isInVars("radius")) {
-                    std::vector<char> tmp_radius = reinterpret_cast<std::vector<char>&>(radius);
-                    const size_t sot = cad->getData("radius")->getTypeSize();
-                    mix[k].insert(mix[k].end(), tmp_radius.begin() + sot * i, tmp_radius.begin() + sot * i + sot);
+                if (radius != nullptr) {
+                    gatherColumn(*radius, first, 1, 0, packed->data() + 3, comps, cnt);
                 }
-                if (cad->isInVars("r")) {
-                    const size_t sot = cad->getData("r")->getTypeSize();
-                    mix[k].insert(mix[k].end(), r.begin() + sot * i, r.begin() + sot * (i + 1));
-                    mix[k].insert(mix[k].end(), g.begin() + sot * i, g.begin() + sot * (i + 1));
-                    mix[k].insert(mix[k].end(), b.begin() + sot * i, b.begin() + sot * (i + 1));
-                    mix[k].insert(mix[k].end(), a.begin() + sot * i, a.begin() + sot * (i + 1));
-                } else if (cad->isInVars("i")) {
-                    const size_t sot = cad->getData("i")->getTypeSize();
-                    mix[k].insert(mix[k].end(), intensity.begin() + sot * i, intensity.begin() + sot * (i + 1));
+                vertData[k] = core::moldyn::SimpleSphericalParticles::SharedBuffer(packed, packed->data());
+            }
+
+            // Colors
+            if (colPassthrough) {
+                colData[k] = shareColumn(intensity, first, 1);
+            } else if (colType == core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I) {
+                auto packed = std::make_shared<std::vector<float>>(particleCount);
+                gatherColumn(*intensity, first, 1, 0, packed->data(), 1, cnt);
+                colData[k] = core::moldyn::SimpleSphericalParticles::SharedBuffer(packed, packed->data());
+            } else if (colType == core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGBA) {
+                auto packed = std::make_shared<std::vector<float>>(4 * particleCount);
+                for (size_t c = 0; c < 4; ++c) {
+                    gatherColumn(*col[c], first, 1, 0, packed->data() + c, 4, cnt);
                 }
-                if (cad->isInVars("id")) {
-                    const size_t sot = cad->getData("id")->getTypeSize();
-                    mix[k].insert(mix[k].end(), id.begin() + sot * i, id.begin() + sot * (i + 1));
+                colData[k] = core::moldyn::SimpleSphericalParticles::SharedBuffer(packed, packed->data());
+            } else if (colType == core::moldyn::SimpleSphericalParticles::COLDATA_UINT8_RGBA) {
+                auto packed = std::make_shared<std::vector<unsigned char>>(4 * particleCount);
+                for (size_t c = 0; c < 4; ++c) {
+                    gatherColumn(*col[c], first, 1, 0, packed->data() + c, 4, cnt);
                 }
+                colData[k] = core::moldyn::SimpleSphericalParticles::SharedBuffer(packed, packed->data());
+            }
+
+            // IDs
+            if (idType != core::moldyn::SimpleSphericalParticles::IDDATA_NONE) {
+                idData[k] = shareColumn(id, first, 1);
             }
         }
     }
 
-    for (auto k = 0; k < mix.size(); k++) {
+    for (auto k = 0; k < vertData.size(); k++) {
         // Set particles
         mpdc->AccessParticles(k).SetCount(plist_count[k]);
 
-        mpdc->AccessParticles(k).SetVertexData(vertType, mix[k].data(), stride);
-        mpdc->AccessParticles(k).SetColourData(
-            colType, mix[k].data() + core::moldyn::SimpleSphericalParticles::VertexDataSize[vertType], stride);
-        mpdc->AccessParticles(k).SetIDData(idType,
-            mix[k].data() + core::moldyn::SimpleSphericalParticles::VertexDataSize[vertType] +
-                core::moldyn::SimpleSphericalParticles::ColorDataSize[colType],
-            stride);
+        mpdc->AccessParticles(k).SetVertexData(vertType, vertData[k], vertStride);
+        mpdc->AccessParticles(k).SetColourData(colType, colData[k], colStride);
+        mpdc->AccessParticles(k).SetIDData(idType, idData[k], idStride);
         if (cad->isInVars("list_box")) {
             vislib::math::Cuboid<float> lbox(list_box[6 * k + 0], list_box[6 * k + 1], list_box[6 * k + 2],
                 list_box[6 * k + 3], list_box[6 * k + 4], list_box[6 * k + 5]);
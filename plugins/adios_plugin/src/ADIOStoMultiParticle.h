@@ -73,7 +73,10 @@ private:
     core::CalleeSlot mpSlot;
     core::CallerSlot adiosSlot;
 
-    std::vector<std::vector<char>> mix;
+    /** Data of the particle lists, either sharing the columns of the ADIOS call or packed */
+    std::vector<core::moldyn::SimpleSphericalParticles::SharedBuffer> vertData;
+    std::vector<core::moldyn::SimpleSphericalParticles::SharedBuffer> colData;
+    std::vector<core::moldyn::SimpleSphericalParticles::SharedBuffer> idData;
 
     size_t currentFrame = -1;
 
@@ -81,7 +84,9 @@ private:
     core::moldyn::SimpleSphericalParticles::VertexDataType vertType = core::moldyn::SimpleSphericalParticles::VERTDATA_NONE;
     core::moldyn::SimpleSphericalParticles::IDDataType idType = core::moldyn::SimpleSphericalParticles::IDDATA_NONE;
 
-    size_t stride = 0;
+    unsigned int vertStride = 0;
+    unsigned int colStride = 0;
+    unsigned int idStride = 0;
 
     std::vector<unsigned long long int> plist_offset;
     std::vector<float> list_box;
@@ -33,6 +33,7 @@ public:
     virtual const std::string getType() = 0;
     virtual const size_t getTypeSize() = 0;
     virtual size_t size() = 0;
+    virtual const void* getDataPtr() = 0;
 
     std::vector<size_t> shape;
     bool singleValue = false;
@@ -49,6 +50,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<double>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "double"; }
     const size_t getTypeSize() override { return sizeof(double); }
@@ -75,6 +77,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<float>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "float"; }
     const size_t getTypeSize() override { return sizeof(float); }
@@ -105,6 +108,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<int>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "int"; }
     const size_t getTypeSize() override { return sizeof(int); }
@@ -131,6 +135,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<unsigned long long int>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "unsigned long long int"; }
     const size_t getTypeSize() override { return sizeof(unsigned long long int); }
@@ -159,6 +164,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<unsigned int>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "unsigned int"; }
     const size_t getTypeSize() override { return sizeof(unsigned int); }
@@ -187,6 +193,7 @@ public:
     std::vector<unsigned char> GetAsUChar() override { return this->getAs<unsigned char>(); }
 
     std::vector<unsigned char>& getVec() { return dataVec; }
+    const void* getDataPtr() override { return dataVec.data(); }
     size_t size() override { return dataVec.size(); }
     const std::string getType() override { return "unsigned char"; }
     const size_t getTypeSize() override { return sizeof(unsigned char); }
@@ -1,9 +1,13 @@
 #include "stdafx.h"
 #include "adiosDataSource.h"
 #include <algorithm>
+#include <functional>
 #include <numeric>
 #include "mmcore/cluster/mpi/MpiCall.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "vislib/Trace.h"
 #include "vislib/sys/CmdLineProvider.h"
 #include "vislib/sys/Log.h"
@@ -18,6 +22,9 @@ adiosDataSource::adiosDataSource(void)
     , getData("getdata", "Slot to request data from this data source.")
     , data_hash(0)
     , filename("filename", "The path to the ADIOS-based file to load.")
+    , engineSlot("engine", "The ADIOS2 engine; SST streams the steps of a running simulation.")
+    , timeoutSlot("timeout", "Seconds to wait for the next step of a stream, negative values wait indefinitely.")
+    , perRankBlocksSlot("perRankBlocks", "With MPI, each rank only reads its share of the blocks.")
     , frameCount(0)
     , loadedFrameID(-1)
     , io(nullptr) {
@@ -26,6 +33,19 @@ adiosDataSource::adiosDataSource(void)
     this->filename.SetUpdateCallback(&adiosDataSource::filenameChanged);
     this->MakeSlotAvailable(&this->filename);
 
+    auto engineEnum = new core::param::EnumParam(0);
+    engineEnum->SetTypePair(0, "BPFile");
+    engineEnum->SetTypePair(1, "SST");
+    this->engineSlot << engineEnum;
+    this->engineSlot.SetUpdateCallback(&adiosDataSource::filenameChanged);
+    this->MakeSlotAvailable(&this->engineSlot);
+
+    this->timeoutSlot << new core::param::FloatParam(0.0f);
+    this->MakeSlotAvailable(&this->timeoutSlot);
+
+    this->perRankBlocksSlot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->perRankBlocksSlot);
+
 
     this->getData.SetCallback("CallADIOSData", "GetData", &adiosDataSource::getDataCallback);
     this->getData.SetCallback("CallADIOSData", "GetHeader", &adiosDataSource::getHeaderCallback);
@@ -80,138 +100,54 @@ bool adiosDataSource::getDataCallback(core::Call& caller) {
     CallADIOSData* cad = dynamic_cast<CallADIOSData*>(&caller);
     if (cad == nullptr) return false;
 
-    if (dataHashChanged || loadedFrameID != cad->getFrameIDtoLoad()) {
+    const bool streaming = this->isStreaming();
+    if (streaming || dataHashChanged || loadedFrameID != cad->getFrameIDtoLoad()) {
 
         try {
-            const std::string fname = std::string(T2A(this->filename.Param<core::param::FilePathParam>()->Value()));
-            if (this->reader) {
-                this->reader.Close();
-                this->io->RemoveAllVariables();
-            }
-            this->reader = io->Open(fname, adios2::Mode::Read);
-
-            vislib::sys::Log::DefaultLog.WriteInfo(
-                "ADIOS2datasource: Stepping to frame number: %d", cad->getFrameIDtoLoad());
-            if (cad->getFrameIDtoLoad() != 0) {
-                for (auto i = 0; i < cad->getFrameIDtoLoad(); i++) {
-                    reader.BeginStep();
-                    reader.EndStep();
+            if (streaming) {
+                if (!this->stepOpen && !this->beginStreamingStep()) {
+                    // no new step yet, so the data of the previous one is handed out again
+                    cad->setData(std::make_shared<adiosDataMap>(this->dataMap));
+                    cad->setDataHash(this->data_hash);
+                    return true;
+                }
+            } else {
+                const std::string fname = std::string(T2A(this->filename.Param<core::param::FilePathParam>()->Value()));
+                this->closeEngine();
+                this->reader = io->Open(fname, adios2::Mode::Read);
+
+                vislib::sys::Log::DefaultLog.WriteInfo(
+                    "ADIOS2datasource: Stepping to frame number: %d", cad->getFrameIDtoLoad());
+                if (cad->getFrameIDtoLoad() != 0) {
+                    for (auto i = 0; i < cad->getFrameIDtoLoad(); i++) {
+                        reader.BeginStep();
+                        reader.EndStep();
+                    }
                 }
-            }
 
-            vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Beginning step");
-            const adios2::StepStatus status = reader.BeginStep();
-            if (status != adios2::StepStatus::OK) {
-                vislib::sys::Log::DefaultLog.WriteError("ADIOS2 ERROR: BeginStep returned an error.");
-                return false;
+                vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Beginning step");
+                const adios2::StepStatus status = reader.BeginStep();
+                if (status != adios2::StepStatus::OK) {
+                    vislib::sys::Log::DefaultLog.WriteError("ADIOS2 ERROR: BeginStep returned an error.");
+                    return false;
+                }
+                this->stepOpen = true;
             }
 
-
             auto varsToInquire = cad->getVarsToInquire();
             if (varsToInquire.empty()) {
                 vislib::sys::Log::DefaultLog.WriteError("adiosDataSource: varsToInquire is empty.");
                 return false;
             }
 
-            for (auto toInq : varsToInquire) {
-                for (auto var : variables) {
-					if (var.first == toInq) {
-                        std::vector<size_t> shape(1);
-                        bool singleValue = true;
-						if (var.second["SingleValue"] != std::string("true")) {
-							//num = std::stoi(var.second["Shape"]);
-							singleValue = false;
-						}
-                        auto num = 1;
-						if (var.second["Type"] == "float") {
-
-                            auto fc = std::make_shared<FloatContainer>(FloatContainer());
-                            fc->singleValue = singleValue;
-                            std::vector<float>& tmp_vec = fc->getVec();
-                            adios2::Variable<float> advar = io->InquireVariable<float>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-                            
-                            reader.Get<float>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-
-                        } else if (var.second["Type"] == "double") {
-
-                            auto fc = std::make_shared<DoubleContainer>(DoubleContainer());
-                            fc->singleValue = singleValue;
-                            std::vector<double>& tmp_vec = fc->getVec();
-
-                            adios2::Variable<double> advar = io->InquireVariable<double>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-
-                            reader.Get<double>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-
-                        } else if (var.second["Type"] == "int") {
-
-                            auto fc = std::make_shared<IntContainer>(IntContainer());
-                            fc->singleValue = singleValue;
-                            std::vector<int>& tmp_vec = fc->getVec();
-
-                            adios2::Variable<int> advar = io->InquireVariable<int>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-
-                            reader.Get<int>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-                        } else if (var.second["Type"] == "unsigned long long int") {
-                            auto fc = std::make_shared<UInt64Container>(UInt64Container());
-                            fc->singleValue = singleValue;
-                            std::vector<unsigned long long int>& tmp_vec = fc->getVec();
-
-                            adios2::Variable<unsigned long long int> advar =
-                                io->InquireVariable<unsigned long long int>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-
-                            reader.Get<unsigned long long int>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-                        } else if (var.second["Type"] == "unsigned char") {
-                            auto fc = std::make_shared<UCharContainer>(UCharContainer());
-                            fc->singleValue = singleValue;
-                            std::vector<unsigned char>& tmp_vec = fc->getVec();
-
-                            adios2::Variable<unsigned char> advar = io->InquireVariable<unsigned char>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-
-                            reader.Get<unsigned char>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-                        } else if (var.second["Type"] == "unsigned int") {
-                            auto fc = std::make_shared<UInt32Container>(UInt32Container());
-                            fc->singleValue = singleValue;
-                            std::vector<unsigned int>& tmp_vec = fc->getVec();
-
-                            adios2::Variable<unsigned int> advar = io->InquireVariable<unsigned int>(var.first);
-                            auto info = reader.BlocksInfo(advar, cad->getFrameIDtoLoad());
-                            fc->shape = info[0].Count;
-                            std::for_each(fc->shape.begin(), fc->shape.end(), [&](decltype(num) n) { num *= n; });
-                            tmp_vec.resize(num);
-
-                            reader.Get<unsigned int>(advar, tmp_vec);
-                            dataMap[var.first] = std::move(fc);
-                        }
-                    }
-                }
-            }
+            this->readVariables(varsToInquire);
 
             reader.EndStep();
+            this->stepOpen = false;
+            if (streaming) {
+                // every step of a stream is new data, while the frame id stays the same
+                ++this->data_hash;
+            }
             loadedFrameID = cad->getFrameIDtoLoad();
             // here data is loaded
         } catch (std::invalid_argument& e) {
@@ -239,6 +175,7 @@ bool adiosDataSource::getDataCallback(core::Call& caller) {
             vislib::sys::Log::DefaultLog.WriteError(e.what());
         }
 
+        // the map only holds shared pointers to the containers of the step, which are not copied
         cad->setData(std::make_shared<adiosDataMap>(dataMap));
         cad->setDataHash(this->data_hash);
 		this->dataHashChanged = false;
@@ -247,6 +184,147 @@ bool adiosDataSource::getDataCallback(core::Call& caller) {
 }
 
 
+/*
+ * adiosDataSource::readVariables
+ */
+void adiosDataSource::readVariables(const std::vector<std::string>& varsToInquire) {
+    for (const auto& toInq : varsToInquire) {
+        const auto var = this->variables.find(toInq);
+        if (var == this->variables.end()) continue;
+
+        auto& params = var->second;
+        const bool singleValue = params["SingleValue"] == std::string("true");
+        const auto& type = params["Type"];
+
+        if (type == "float") {
+            this->readVariable<float, FloatContainer>(toInq, singleValue);
+        } else if (type == "double") {
+            this->readVariable<double, DoubleContainer>(toInq, singleValue);
+        } else if (type == "int") {
+            this->readVariable<int, IntContainer>(toInq, singleValue);
+        } else if (type == "unsigned long long int") {
+            this->readVariable<unsigned long long int, UInt64Container>(toInq, singleValue);
+        } else if (type == "unsigned char") {
+            this->readVariable<unsigned char, UCharContainer>(toInq, singleValue);
+        } else if (type == "unsigned int") {
+            this->readVariable<unsigned int, UInt32Container>(toInq, singleValue);
+        }
+    }
+}
+
+
+/*
+ * adiosDataSource::readVariable
+ */
+template <class T, class C> void adiosDataSource::readVariable(const std::string& name, const bool singleValue) {
+    auto fc = std::make_shared<C>();
+    fc->singleValue = singleValue;
+    std::vector<T>& vec = fc->getVec();
+
+    adios2::Variable<T> advar = this->io->InquireVariable<T>(name);
+    const auto info = this->reader.BlocksInfo(advar, this->reader.CurrentStep());
+    if (info.empty()) {
+        vislib::sys::Log::DefaultLog.WriteWarn("adiosDataSource: Variable %s has no blocks.", name.c_str());
+        return;
+    }
+
+    size_t rank = 0, size = 1;
+#ifdef WITH_MPI
+    if (this->MpiInitialized && this->perRankBlocksSlot.Param<core::param::BoolParam>()->Value()) {
+        rank = static_cast<size_t>(this->mpiRank);
+        size = static_cast<size_t>(this->mpiSize);
+    }
+#endif
+
+    const auto count = [](const adios2::Dims& dims) {
+        return std::accumulate(dims.begin(), dims.end(), static_cast<size_t>(1), std::multiplies<size_t>());
+    };
+
+    if (singleValue || size == 1) {
+        fc->shape = info[0].Count;
+        vec.resize(count(fc->shape));
+        this->reader.Get<T>(advar, vec);
+    } else {
+        // blocks are assigned round-robin and concatenated along the first dimension
+        std::vector<size_t> blocks, offsets(1, 0);
+        for (size_t b = rank; b < info.size(); b += size) {
+            blocks.push_back(b);
+            offsets.push_back(offsets.back() + count(info[b].Count));
+        }
+
+        fc->shape = info[blocks.empty() ? 0 : blocks[0]].Count;
+        if (!fc->shape.empty()) {
+            fc->shape[0] = 0;
+            for (const auto b : blocks) fc->shape[0] += info[b].Count[0];
+        }
+        vec.resize(offsets.back());
+
+        // the selection is taken when reading, so the blocks are read synchronously one after another
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            advar.SetBlockSelection(blocks[i]);
+            this->reader.Get<T>(advar, vec.data() + offsets[i], adios2::Mode::Sync);
+        }
+    }
+
+    this->dataMap[name] = std::move(fc);
+}
+
+
+/*
+ * adiosDataSource::isStreaming
+ */
+bool adiosDataSource::isStreaming(void) { return this->engineSlot.Param<core::param::EnumParam>()->Value() == 1; }
+
+
+/*
+ * adiosDataSource::closeEngine
+ */
+void adiosDataSource::closeEngine(void) {
+    if (this->reader) {
+        if (this->stepOpen) this->reader.EndStep();
+        this->reader.Close();
+        this->io->RemoveAllVariables();
+    }
+    this->stepOpen = false;
+}
+
+
+/*
+ * adiosDataSource::beginStreamingStep
+ */
+bool adiosDataSource::beginStreamingStep(void) {
+    if (this->streamChanged) {
+        this->closeEngine();
+        this->variables.clear();
+        this->dataMap.clear();
+
+        const std::string fname = std::string(T2A(this->filename.Param<core::param::FilePathParam>()->Value()));
+        vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Connecting to stream %s", fname.c_str());
+        this->io->SetEngine("SST");
+        this->reader = this->io->Open(fname, adios2::Mode::Read);
+        this->streamChanged = false;
+        this->endOfStream = false;
+    }
+    if (this->endOfStream) return false;
+
+    // skip steps that were written in the meantime to keep pace with the simulation
+    const auto status = this->reader.BeginStep(
+        adios2::StepMode::LatestAvailable, this->timeoutSlot.Param<core::param::FloatParam>()->Value());
+
+    if (status == adios2::StepStatus::OK) {
+        this->stepOpen = true;
+        this->variables = this->io->AvailableVariables();
+        return true;
+    } else if (status == adios2::StepStatus::EndOfStream) {
+        vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: End of stream reached");
+        this->endOfStream = true;
+    } else if (status != adios2::StepStatus::NotReady) {
+        vislib::sys::Log::DefaultLog.WriteError("ADIOS2 ERROR: BeginStep returned an error.");
+    }
+    return false;
+}
+
+
 /*
  * adiosDataSource::filenameChanged
  */
@@ -254,6 +332,7 @@ bool adiosDataSource::filenameChanged(core::param::ParamSlot& slot) {
     using vislib::sys::Log;
     this->data_hash++;
 	this->dataHashChanged = true;
+    this->streamChanged = true;
     this->frameCount = 1;
 
     return true;
@@ -264,9 +343,25 @@ bool adiosDataSource::getHeaderCallback(core::Call& caller) {
     CallADIOSData* cad = dynamic_cast<CallADIOSData*>(&caller);
     if (cad == nullptr) return false;
 
-    if (dataHashChanged || loadedFrameID != cad->getFrameIDtoLoad()) {
+    const bool streaming = this->isStreaming();
+    if (streaming || dataHashChanged || loadedFrameID != cad->getFrameIDtoLoad()) {
 
         try {
+            if (streaming) {
+                // the variables of a stream are only known within a step, which is kept open for reading the data
+                if (!this->stepOpen) this->beginStreamingStep();
+
+                std::vector<std::string> availVars;
+                availVars.reserve(variables.size());
+                for (const auto& var : variables) {
+                    availVars.push_back(var.first);
+                }
+                cad->setAvailableVars(availVars);
+                cad->setFrameCount(1);
+                cad->setDataHash(this->data_hash);
+                return true;
+            }
+
             vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Setting Engine");
             // io.SetEngine("InSituMPI");
             io->SetEngine("bpfile");
@@ -275,10 +370,8 @@ bool adiosDataSource::getHeaderCallback(core::Call& caller) {
 
             vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Opening File %s", fname.c_str());
 
-            if (this->reader) {
-                this->reader.Close();
-                this->io->RemoveAllVariables();
-                }
+            this->closeEngine();
+            this->streamChanged = true;
             this->reader = io->Open(fname, adios2::Mode::Read);
 
             // vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Reading available attributes");
@@ -83,6 +83,39 @@ private:
     vislib::StringA getCommandLine(void);
     bool filenameChanged(core::param::ParamSlot& slot);
 
+    /**
+     * Answer whether a streaming engine is selected, which only moves forward through its steps.
+     */
+    bool isStreaming(void);
+
+    /**
+     * Ends an open step and closes the engine.
+     */
+    void closeEngine(void);
+
+    /**
+     * Opens the engine if necessary and begins the latest available step, waiting at most for the timeout.
+     *
+     * @return 'true' if a step is open, 'false' if none is available yet or the stream has ended.
+     */
+    bool beginStreamingStep(void);
+
+    /**
+     * Reads the inquired variables of the current step into the data map.
+     *
+     * @param varsToInquire The names of the variables.
+     */
+    void readVariables(const std::vector<std::string>& varsToInquire);
+
+    /**
+     * Reads a variable of the current step. With MPI, each rank only reads its share of the blocks, which
+     * are concatenated along the first dimension.
+     *
+     * @param name The name of the variable.
+     * @param singleValue Whether the variable is a single value, which is read by all ranks.
+     */
+    template <class T, class C> void readVariable(const std::string& name, bool singleValue);
+
     /** The slot for requesting data */
     core::CalleeSlot getData;
 
@@ -96,6 +129,15 @@ private:
     /** The file name */
     core::param::ParamSlot filename;
 
+    /** The ADIOS2 engine, either for files or for streaming from a running simulation */
+    core::param::ParamSlot engineSlot;
+
+    /** Time in seconds to wait for the next step of a stream */
+    core::param::ParamSlot timeoutSlot;
+
+    /** Read only the blocks assigned to this rank */
+    core::param::ParamSlot perRankBlocksSlot;
+
     int step = 0;
     int particleCount = 0;
     size_t frameCount;
@@ -106,6 +148,9 @@ private:
     adios2::ADIOS adiosInst;
     std::shared_ptr<adios2::IO> io;
     adios2::Engine reader;
+    bool streamChanged = true;
+    bool stepOpen = false;
+    bool endOfStream = false;
     std::map<std::string, adios2::Params> variables;
     adiosDataMap dataMap;
 };
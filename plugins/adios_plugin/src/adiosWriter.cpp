@@ -1,9 +1,14 @@
 #include "stdafx.h"
 #include "adiosWriter.h"
 #include <chrono>
+#include <sstream>
+#include <type_traits>
 #include "mmcore/cluster/mpi/MpiCall.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/StringParam.h"
 #include "vislib/Trace.h"
 #include "vislib/sys/CmdLineProvider.h"
 #include "vislib/sys/Log.h"
@@ -19,6 +24,10 @@ adiosWriter::adiosWriter(void)
     , getData("getdata", "Slot to request data from this data source.")
     , outputPatternSlot("outputPattern","Sets an file IO pattern.")
     , encodingSlot("encoding","Specifiy encoding")
+    , encodingParamsSlot("encodingParams", "Parameters of the compression as key=value pairs separated by ';', "
+                                           "e.g. 'accuracy=0.001' for zfp and sz.")
+    , aggregatorsSlot("aggregators", "Number of sub-files the data of all ranks is aggregated into, 0 uses the ADIOS2 default.")
+    , asyncSlot("async", "Writes the steps in a background thread while the next frame is fetched.")
     , io(nullptr) {
 
     this->filename.SetParameter(new core::param::FilePathParam(""));
@@ -35,9 +44,22 @@ adiosWriter::adiosWriter(void)
 
     auto encEnum = new core::param::EnumParam(0);
     encEnum->SetTypePair(0, "None");
+    encEnum->SetTypePair(1, "blosc");
+    encEnum->SetTypePair(2, "bzip2");
+    encEnum->SetTypePair(3, "zfp");
+    encEnum->SetTypePair(4, "sz");
     this->encodingSlot << encEnum;
     this->MakeSlotAvailable(&this->encodingSlot);
 
+    this->encodingParamsSlot << new core::param::StringParam("");
+    this->MakeSlotAvailable(&this->encodingParamsSlot);
+
+    this->aggregatorsSlot << new core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->aggregatorsSlot);
+
+    this->asyncSlot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->asyncSlot);
+
     this->callRequestMpi.SetCompatibleCall<core::cluster::mpi::MpiCallDescription>();
     this->MakeSlotAvailable(&this->callRequestMpi);
 }
@@ -180,173 +202,239 @@ bool adiosWriter::run() {
         return false;
     }
 
+    // the next frame is fetched and staged while the previous one is written
+    const bool async = this->asyncSlot.Param<core::param::BoolParam>()->Value();
+    if (async) {
+        this->stopWriting = false;
+        this->writingThread = std::thread(&adiosWriter::writeQueuedSteps, this);
+    }
 
+    bool retval = true;
     const auto frameCount = cad->getFrameCount();
     for (auto i = 0; i < frameCount; i++) { // for each frame
 
         vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Starting frame %d", i);
 
-            cad->setFrameIDtoLoad(i);
-
-            auto avaiVars = cad->getAvailableVars();
+        cad->setFrameIDtoLoad(i);
 
-            if (!(*cad)(0)) {
-                vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: Error during GetData");
-                return false;
-            }
-
-        try {
-            if (!this->writer) {
-                const std::string fname = std::string(T2A(this->filename.Param<core::param::FilePathParam>()->Value()));
-                vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Opening File %s", fname.c_str());
-                writer = io->Open(fname, adios2::Mode::Write);
-            }
+        if (!(*cad)(0)) {
+            vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: Error during GetData");
+            retval = false;
+            break;
+        }
 
-            vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: BeginStep");
-            writer.BeginStep();
+        auto step = this->stageStep(*cad, i);
+        if (async) {
+            this->queueStep(std::move(step));
+        } else {
+            this->writeStep(*step);
+        }
 
-            io->RemoveAllVariables();
-            for (auto var : avaiVars) {
+    } // end for each frame
 
-                std::vector<size_t> globalDim;
-                std::vector<size_t> offsets;
-                std::vector<size_t> localDim;
+    if (async) {
+        {
+            std::lock_guard<std::mutex> lock(this->stepLock);
+            this->stopWriting = true;
+        }
+        this->stepCondition.notify_all();
+        this->writingThread.join();
+    }
 
-                const size_t num = cad->getData(var)->size();
+    return retval;
+}
 
-                if (this->outputPatternSlot.Param<core::param::EnumParam>()->Value() == 1 && !cad->getData(var)->singleValue) {
-                    std::vector<size_t> shape;
-                    if (!cad->getData(var)->shape.empty())
-                        shape = cad->getData(var)->shape;
-                    else {
-                        shape = {cad->getData(var)->size()};
-                    }
-                    localDim = shape;
-                    globalDim = localDim;
-#ifdef WITH_MPI                  
-                    offsets.resize(shape.size());
-                    // offsets
-                    auto mpierror = MPI_Scan(localDim.data(), offsets.data(), 1, MPI_UINT64_T, MPI_SUM, this->mpi_comm_);
-                    if (mpierror != MPI_SUCCESS)
-                        vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: MPI_Allreduce of offsets failed.");
-                    offsets[0] -= localDim[0];
-                    // global dim
-                    mpierror = MPI_Allreduce(localDim.data(), globalDim.data(), 1, MPI_UINT64_T, MPI_SUM, this->mpi_comm_);
-                    if (mpierror != MPI_SUCCESS)
-                        vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: MPI_Allreduce of offsets failed.");
-                    //vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer:");
+/*
+ * adiosWriter::stageStep
+ */
+std::unique_ptr<adiosWriter::StagedStep> adiosWriter::stageStep(CallADIOSData& cad, size_t frame) {
+    auto step = std::make_unique<StagedStep>();
+    step->frame = frame;
+
+    // the data sources create new containers for every frame, so holding them is a snapshot of the frame
+    for (const auto& var : cad.getAvailableVars()) {
+        StagedVariable staged;
+        staged.name = var;
+        staged.data = cad.getData(var);
+
+        const size_t num = staged.data->size();
+
+        if (this->outputPatternSlot.Param<core::param::EnumParam>()->Value() == 1 && !staged.data->singleValue) {
+            std::vector<size_t> shape;
+            if (!staged.data->shape.empty())
+                shape = staged.data->shape;
+            else {
+                shape = {staged.data->size()};
+            }
+            staged.localDim = shape;
+            staged.globalDim = staged.localDim;
+#ifdef WITH_MPI
+            staged.offsets.resize(shape.size());
+            // offsets
+            auto mpierror =
+                MPI_Scan(staged.localDim.data(), staged.offsets.data(), 1, MPI_UINT64_T, MPI_SUM, this->mpi_comm_);
+            if (mpierror != MPI_SUCCESS)
+                vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: MPI_Allreduce of offsets failed.");
+            staged.offsets[0] -= staged.localDim[0];
+            // global dim
+            mpierror = MPI_Allreduce(
+                staged.localDim.data(), staged.globalDim.data(), 1, MPI_UINT64_T, MPI_SUM, this->mpi_comm_);
+            if (mpierror != MPI_SUCCESS)
+                vislib::sys::Log::DefaultLog.WriteError("ADIOS2writer: MPI_Allreduce of offsets failed.");
 #else
-                    globalDim = shape;
-                    offsets = std::vector<size_t>(shape.size(), 0);
+            staged.globalDim = shape;
+            staged.offsets = std::vector<size_t>(shape.size(), 0);
 #endif
-                } else {
-                    globalDim = {static_cast<size_t>(num)};
-                    offsets = {static_cast<size_t>(0)};
-                    localDim = {static_cast<size_t>(num)};
-                }
-
-                if (cad->getData(var)->getType() == "float") {
-
-                    std::vector<float>& values = dynamic_cast<FloatContainer*>(cad->getData(var).get())->getVec();
-
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<float> adiosVar =
-                        io->DefineVariable<float>(var, globalDim, offsets, localDim, false);
-
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<float>(adiosVar, values.data());
-                } else if (cad->getData(var)->getType() == "double") {
+        } else {
+            staged.globalDim = {static_cast<size_t>(num)};
+            staged.offsets = {static_cast<size_t>(0)};
+            staged.localDim = {static_cast<size_t>(num)};
+        }
 
-                    std::vector<double>& values = dynamic_cast<DoubleContainer*>(cad->getData(var).get())->getVec();
+        step->variables.push_back(std::move(staged));
+    }
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<double> adiosVar =
-                        io->DefineVariable<double>(var, globalDim, offsets, localDim, false);
+    return step;
+}
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<double>(adiosVar, values.data());
-                } else if (cad->getData(var)->getType() == "int") {
+/*
+ * adiosWriter::queueStep
+ */
+void adiosWriter::queueStep(std::unique_ptr<StagedStep> step) {
+    std::unique_lock<std::mutex> lock(this->stepLock);
+    this->stepCondition.wait(lock, [this]() { return this->queuedStep == nullptr; });
+    this->queuedStep = std::move(step);
+    lock.unlock();
+    this->stepCondition.notify_all();
+}
 
-                    std::vector<int>& values = dynamic_cast<IntContainer*>(cad->getData(var).get())->getVec();
+/*
+ * adiosWriter::writeQueuedSteps
+ */
+void adiosWriter::writeQueuedSteps(void) {
+    std::unique_lock<std::mutex> lock(this->stepLock);
+    while (true) {
+        this->stepCondition.wait(lock, [this]() { return this->queuedStep != nullptr || this->stopWriting; });
+        if (this->queuedStep == nullptr) break;
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<int> adiosVar = io->DefineVariable<int>(var, globalDim, offsets, localDim, false);
+        auto step = std::move(this->queuedStep);
+        lock.unlock();
+        this->stepCondition.notify_all();
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<int>(adiosVar, values.data());
-                } else if (cad->getData(var)->getType() == "unsigned long long int") {
+        this->writeStep(*step);
 
-                    std::vector<unsigned long long int>& values =
-                        dynamic_cast<UInt64Container*>(cad->getData(var).get())->getVec();
+        lock.lock();
+    }
+}
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<unsigned long long int> adiosVar =
-                        io->DefineVariable<unsigned long long int>(var, globalDim, offsets, localDim, false);
+/*
+ * adiosWriter::putVariable
+ */
+template <class T, class C> void adiosWriter::putVariable(const StagedVariable& var) {
+    std::vector<T>& values = dynamic_cast<C*>(var.data.get())->getVec();
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<unsigned long long int>(adiosVar, values.data());
-                } else if (cad->getData(var)->getType() == "unsigned char") {
+    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
+    adios2::Variable<T> adiosVar = io->DefineVariable<T>(var.name, var.globalDim, var.offsets, var.localDim, false);
 
-                    std::vector<unsigned char>& values =
-                        dynamic_cast<UCharContainer*>(cad->getData(var).get())->getVec();
+    // lossy compressors only work on floating point data
+    if (adiosVar && this->compressor != nullptr && !var.data->singleValue &&
+        (!this->lossyCompressor || std::is_floating_point<T>::value)) {
+        adiosVar.AddOperation(*this->compressor, this->compressorParams);
+    }
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<unsigned char> adiosVar =
-                        io->DefineVariable<unsigned char>(var, globalDim, offsets, localDim, false);
+    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
+    if (adiosVar) writer.Put<T>(adiosVar, values.data());
+}
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<unsigned char>(adiosVar, values.data());
-                } else if (cad->getData(var)->getType() == "unsigned int") {
+/*
+ * adiosWriter::writeStep
+ */
+void adiosWriter::writeStep(const StagedStep& step) {
+    try {
+        if (!this->writer) {
+            // operator and aggregation have to be set up before the engine is opened
+            const auto encoding = this->encodingSlot.Param<core::param::EnumParam>();
+            if (encoding->Value() != 0) {
+                const std::string type(encoding->ValueString().PeekBuffer());
+                this->compressor = std::make_unique<adios2::Operator>(adiosInst.DefineOperator("compressor", type));
+                this->lossyCompressor = (type == "zfp" || type == "sz");
+
+                std::istringstream params(
+                    std::string(T2A(this->encodingParamsSlot.Param<core::param::StringParam>()->Value())));
+                std::string keyValue;
+                while (std::getline(params, keyValue, ';')) {
+                    const auto separator = keyValue.find('=');
+                    if (separator != std::string::npos) {
+                        this->compressorParams[keyValue.substr(0, separator)] = keyValue.substr(separator + 1);
+                    }
+                }
+            }
 
-                    std::vector<unsigned int>& values =
-                        dynamic_cast<UInt32Container*>(cad->getData(var).get())->getVec();
+            const auto aggregators = this->aggregatorsSlot.Param<core::param::IntParam>()->Value();
+            if (aggregators > 0) {
+                io->SetParameter("SubStreams", std::to_string(aggregators));
+            }
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Defining Variables");
-                    adios2::Variable<unsigned int> adiosVar =
-                        io->DefineVariable<unsigned int>(var, globalDim, offsets, localDim, false);
+            const std::string fname = std::string(T2A(this->filename.Param<core::param::FilePathParam>()->Value()));
+            vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2: Opening File %s", fname.c_str());
+            writer = io->Open(fname, adios2::Mode::Write);
+        }
 
-                    vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Putting Variables");
-                    if (adiosVar) writer.Put<unsigned int>(adiosVar, values.data());
-                }
-                vislib::sys::Log::DefaultLog.WriteInfo(
-                    "ADIOS2writer: Trying to write - var: %s size: %d", var.c_str(), num);
+        vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: BeginStep of frame %d", step.frame);
+        writer.BeginStep();
+
+        io->RemoveAllVariables();
+        for (const auto& var : step.variables) {
+            const auto type = var.data->getType();
+
+            if (type == "float") {
+                this->putVariable<float, FloatContainer>(var);
+            } else if (type == "double") {
+                this->putVariable<double, DoubleContainer>(var);
+            } else if (type == "int") {
+                this->putVariable<int, IntContainer>(var);
+            } else if (type == "unsigned long long int") {
+                this->putVariable<unsigned long long int, UInt64Container>(var);
+            } else if (type == "unsigned char") {
+                this->putVariable<unsigned char, UCharContainer>(var);
+            } else if (type == "unsigned int") {
+                this->putVariable<unsigned int, UInt32Container>(var);
             }
+            vislib::sys::Log::DefaultLog.WriteInfo(
+                "ADIOS2writer: Trying to write - var: %s size: %d", var.name.c_str(), var.data->size());
+        }
 
-            vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: EndStep");
-            auto t1 = std::chrono::high_resolution_clock::now();
-            writer.EndStep();
-            auto t2 = std::chrono::high_resolution_clock::now();
-            const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-            vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Time spent for writing frame: %d us", duration);
+        vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: EndStep");
+        auto t1 = std::chrono::high_resolution_clock::now();
+        writer.EndStep();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+        vislib::sys::Log::DefaultLog.WriteInfo("ADIOS2writer: Time spent for writing frame: %d us", duration);
 
-        } catch (std::invalid_argument& e) {
+    } catch (std::invalid_argument& e) {
 #ifdef WITH_MPI
-            vislib::sys::Log::DefaultLog.WriteError(
-                "Invalid argument exception, STOPPING PROGRAM from rank %d", this->mpiRank);
+        vislib::sys::Log::DefaultLog.WriteError(
+            "Invalid argument exception, STOPPING PROGRAM from rank %d", this->mpiRank);
 #else
-            vislib::sys::Log::DefaultLog.WriteError("Invalid argument exception, STOPPING PROGRAM");
+        vislib::sys::Log::DefaultLog.WriteError("Invalid argument exception, STOPPING PROGRAM");
 #endif
-            vislib::sys::Log::DefaultLog.WriteError(e.what());
-        } catch (std::ios_base::failure& e) {
+        vislib::sys::Log::DefaultLog.WriteError(e.what());
+    } catch (std::ios_base::failure& e) {
 #ifdef WITH_MPI
-            vislib::sys::Log::DefaultLog.WriteError(
-                "IO System base failure exception, STOPPING PROGRAM from rank %d", this->mpiRank);
+        vislib::sys::Log::DefaultLog.WriteError(
+            "IO System base failure exception, STOPPING PROGRAM from rank %d", this->mpiRank);
 #else
-            vislib::sys::Log::DefaultLog.WriteError("IO System base failure exception, STOPPING PROGRAM");
+        vislib::sys::Log::DefaultLog.WriteError("IO System base failure exception, STOPPING PROGRAM");
 #endif
-            vislib::sys::Log::DefaultLog.WriteError(e.what());
-        } catch (std::exception& e) {
+        vislib::sys::Log::DefaultLog.WriteError(e.what());
+    } catch (std::exception& e) {
 #ifdef WITH_MPI
-            vislib::sys::Log::DefaultLog.WriteError("Exception, STOPPING PROGRAM from rank %d", this->mpiRank);
+        vislib::sys::Log::DefaultLog.WriteError("Exception, STOPPING PROGRAM from rank %d", this->mpiRank);
 #else
-            vislib::sys::Log::DefaultLog.WriteError("Exception, STOPPING PROGRAM");
+        vislib::sys::Log::DefaultLog.WriteError("Exception, STOPPING PROGRAM");
 #endif
-            vislib::sys::Log::DefaultLog.WriteError(e.what());
-        }
-
-    } // end for each frame
-
-    return true;
+        vislib::sys::Log::DefaultLog.WriteError(e.what());
+    }
 }
 
 
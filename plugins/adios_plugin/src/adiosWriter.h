@@ -7,6 +7,12 @@
 #include "CallADIOSData.h"
 #include "mmcore/AbstractDataWriter.h"
 #include "vislib/String.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #ifdef WITH_MPI
 #    include <mpi.h>
 #endif
@@ -65,11 +71,62 @@ protected:
     virtual bool getCapabilities(core::DataWriterCtrlCall& call);
 
 private:
+    /** A variable of a step, holding its data until it is written */
+    struct StagedVariable {
+        std::string name;
+        std::shared_ptr<abstractContainer> data;
+        adios2::Dims globalDim;
+        adios2::Dims offsets;
+        adios2::Dims localDim;
+    };
+
+    /** A step waiting to be written */
+    struct StagedStep {
+        size_t frame;
+        std::vector<StagedVariable> variables;
+    };
+
     /** slot for MPIprovider */
     core::CallerSlot callRequestMpi;
     bool initMPI();
     vislib::StringA getCommandLine(void);
 
+    /**
+     * Takes the data of the current frame and computes the dimensions of its variables, which needs MPI.
+     *
+     * @param cad The call holding the data of the frame.
+     * @param frame The frame.
+     *
+     * @return The staged step.
+     */
+    std::unique_ptr<StagedStep> stageStep(CallADIOSData& cad, size_t frame);
+
+    /**
+     * Writes a staged step, opening the engine on first use.
+     *
+     * @param step The step.
+     */
+    void writeStep(const StagedStep& step);
+
+    /**
+     * Defines and puts a variable of the current step, compressing it if requested.
+     *
+     * @param var The variable.
+     */
+    template <class T, class C> void putVariable(const StagedVariable& var);
+
+    /**
+     * Hands a step to the writing thread, waiting until the previous one has been taken.
+     *
+     * @param step The step.
+     */
+    void queueStep(std::unique_ptr<StagedStep> step);
+
+    /**
+     * Main loop of the writing thread, which writes queued steps until stopped.
+     */
+    void writeQueuedSteps(void);
+
 #ifdef WITH_MPI
     MPI_Comm mpi_comm_ = MPI_COMM_NULL;
     bool useMpi = false;
@@ -80,7 +137,10 @@ private:
     /** Param Slots */
     core::param::ParamSlot filename;
     core::param::ParamSlot outputPatternSlot;
-    core::param::ParamSlot encodingSlot;    
+    core::param::ParamSlot encodingSlot;
+    core::param::ParamSlot encodingParamsSlot;
+    core::param::ParamSlot aggregatorsSlot;
+    core::param::ParamSlot asyncSlot;
 
     /** The slot asking for data */
     core::CallerSlot getData;
@@ -89,7 +149,16 @@ private:
     adios2::ADIOS adiosInst;
     std::shared_ptr<adios2::IO> io;
     adios2::Engine writer;
-
+    std::unique_ptr<adios2::Operator> compressor;
+    adios2::Params compressorParams;
+    bool lossyCompressor = false;
+
+    // Writing thread, with the step staged for it
+    std::thread writingThread;
+    std::mutex stepLock;
+    std::condition_variable stepCondition;
+    std::unique_ptr<StagedStep> queuedStep;
+    bool stopWriting = false;
 };
 
 
@@ -31,9 +31,18 @@ struct TextureHandle
     uvec2 tex_handle;
 };
 
+struct TimestepParams
+{
+    uint timestep;
+    uint node_cnt;
+    uint timestep_cnt;
+    uint padding;
+};
+
 layout(std430, binding = 0) readonly buffer MeshShaderParamsBuffer { MeshShaderParams mesh_shader_params[]; };
 layout(std430, binding = 1) readonly buffer DynamicDataBuffer { DynamicData dynamic_data[]; };
 layout(std430, binding = 2) readonly buffer TextureHandlesBuffer { TextureHandle texture_handles[]; };
+layout(std430, binding = 3) readonly buffer TimestepParamsBuffer { TimestepParams timestep_params; };
 
 
 uniform mat4 view_mx;
@@ -46,22 +55,24 @@ out vec3 vColour;
 void main()
 {
     mat4 object_transform = mesh_shader_params[gl_DrawIDARB].transform;
+    // the dynamic data of all time steps is stored one step after the other
+    uint node_idx = timestep_params.timestep * timestep_params.node_cnt + uint(gl_VertexID);
     vec3 vertex_displacement = vec3(
-        dynamic_data[gl_VertexID].node_displX,
-        dynamic_data[gl_VertexID].node_displY,
-        dynamic_data[gl_VertexID].node_displZ
+        dynamic_data[node_idx].node_displX,
+        dynamic_data[node_idx].node_displY,
+        dynamic_data[node_idx].node_displZ
         );
     vertex_displacement *= 10.0f;
     //vertex_displacement = vec3(0.0f);
 
-    vec3 colour = texture(sampler1D(texture_handles[0].tex_handle), dynamic_data[gl_VertexID].norm_stressY ).rgb;
+    vec3 colour = texture(sampler1D(texture_handles[0].tex_handle), dynamic_data[node_idx].norm_stressY ).rgb;
 
     vColour = colour;
 
     vec3 position = vec3(
-        dynamic_data[gl_VertexID].node_posX,
-        dynamic_data[gl_VertexID].node_posY,
-        dynamic_data[gl_VertexID].node_posZ
+        dynamic_data[node_idx].node_posX,
+        dynamic_data[node_idx].node_posY,
+        dynamic_data[node_idx].node_posZ
     );
     //position = v_position;
 
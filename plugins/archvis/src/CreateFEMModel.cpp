@@ -1,5 +1,7 @@
 #include "CreateFEMModel.h"
 
+#include <algorithm>
+
 #include "mmstd_datatools/table/TableDataCall.h"
 #include "mmcore/param/IntParam.h"
 
@@ -66,14 +68,8 @@ bool megamol::archvis::CreateFEMModel::getDataCallback(core::Call& caller) {
         return false;
     }
 
-    // update frame id for faked parameter changing...
-    
-    auto p0 = this->m_fem_param_0.Param<core::param::IntParam>()->Value();
-    auto p1 = this->m_fem_param_1.Param<core::param::IntParam>()->Value();
-
-    unsigned int frame_id = p1;
-
-    dynData_ft->SetFrameID(frame_id);
+    // all time steps are loaded at once, the one shown is chosen on the GPU by the render task data source
+    dynData_ft->SetFrameID(0);
 
     (*node_ft)();
     (*element_ft)();
@@ -96,73 +92,72 @@ bool megamol::archvis::CreateFEMModel::getDataCallback(core::Call& caller) {
         return false;
     }
 
-    std::vector<FEMModel::Vec3> nodes;
-    nodes.reserve(node_ft->GetRowsCount());
-
-    std::vector<FEMModel::DynamicData> dynamic_data;
-    dynamic_data.reserve(dynData_ft->GetRowsCount());
+    std::vector<FEMModel::Vec3> nodes(node_ft->GetRowsCount());
 
     auto const node_accessor = node_ft->GetData();
-    for (int node_idx = 0; node_idx < node_ft->GetRowsCount(); ++node_idx) {
+#pragma omp parallel for
+    for (int node_idx = 0; node_idx < static_cast<int>(node_ft->GetRowsCount()); ++node_idx) {
         auto curr_idx = node_idx * 4;
-        nodes.push_back({
+        nodes[node_idx] = FEMModel::Vec3(
             node_accessor[curr_idx + 1],
             node_accessor[curr_idx + 2],
             node_accessor[curr_idx + 3]
-            }
         );
     }
 
-    auto const dynData_accessor = dynData_ft->GetData();
-    for (int dynData_idx = 0; dynData_idx < dynData_ft->GetRowsCount(); ++dynData_idx) {
-        auto curr_idx = dynData_idx * 13;
-        dynamic_data.push_back(FEMModel::DynamicData());
-        dynamic_data.back().node_number = dynData_accessor[curr_idx + 0];
-        dynamic_data.back().node_posX = dynData_accessor[curr_idx + 1];
-        dynamic_data.back().node_posY = dynData_accessor[curr_idx + 2];
-        dynamic_data.back().node_posZ = dynData_accessor[curr_idx + 3];
-        dynamic_data.back().node_displX = dynData_accessor[curr_idx + 4];
-        dynamic_data.back().node_displY = dynData_accessor[curr_idx + 5];
-        dynamic_data.back().node_displZ = dynData_accessor[curr_idx + 6];
-        dynamic_data.back().norm_stressX = dynData_accessor[curr_idx + 7] / 100000000;
-        dynamic_data.back().norm_stressY = dynData_accessor[curr_idx + 8] / 100000000;
-        dynamic_data.back().norm_stressZ = dynData_accessor[curr_idx + 9] / 100000000;
-        dynamic_data.back().shear_stressX = dynData_accessor[curr_idx + 10] / 100000000;
-        dynamic_data.back().shear_stressY = dynData_accessor[curr_idx + 11] / 100000000;
-        dynamic_data.back().shear_stressZ = dynData_accessor[curr_idx + 12] / 100000000;
-
- 
-        //dynamic_data.push_back({
-        //   static_cast<int>( dynData_accessor[curr_idx + 0] ),
-        //       dynData_accessor[curr_idx + 1],
-        //       dynData_accessor[curr_idx + 2],
-        //       dynData_accessor[curr_idx + 3],
-        //       dynData_accessor[curr_idx + 4],
-        //       dynData_accessor[curr_idx + 5],
-        //       dynData_accessor[curr_idx + 6],
-        //       dynData_accessor[curr_idx + 7],
-        //       dynData_accessor[curr_idx + 8],
-        //       dynData_accessor[curr_idx + 9],
-        //       dynData_accessor[curr_idx + 10],
-        //       dynData_accessor[curr_idx + 11],
-        //       dynData_accessor[curr_idx + 12],
-        //       0.0f, //padding
-        //       0.0f, //padding
-        //       0.0f  //padding
-        //   }
-        //);
+    // the hash of the first time step identifies the displacement data
+    auto const deform_input_hash = dynData_ft->DataHash();
+
+    // time steps are stored one after the other, the tables of all steps must have the same number of rows
+    size_t const timesteps = std::max<size_t>(dynData_ft->GetFrameCount(), 1);
+    size_t const rows = dynData_ft->GetRowsCount();
+    std::vector<FEMModel::DynamicData> dynamic_data(timesteps * rows);
+
+    for (size_t timestep = 0; timestep < timesteps; ++timestep) {
+        if (timestep > 0) {
+            dynData_ft->SetFrameID(static_cast<unsigned int>(timestep));
+            (*dynData_ft)();
+            if (dynData_ft->GetRowsCount() != rows) {
+                return false;
+            }
+        }
+
+        auto const dynData_accessor = dynData_ft->GetData();
+        FEMModel::DynamicData* const timestep_data = dynamic_data.data() + timestep * rows;
+#pragma omp parallel for
+        for (int dynData_idx = 0; dynData_idx < static_cast<int>(rows); ++dynData_idx) {
+            auto curr_idx = dynData_idx * 13;
+            auto& dyn = timestep_data[dynData_idx];
+            dyn.node_number = dynData_accessor[curr_idx + 0];
+            dyn.node_posX = dynData_accessor[curr_idx + 1];
+            dyn.node_posY = dynData_accessor[curr_idx + 2];
+            dyn.node_posZ = dynData_accessor[curr_idx + 3];
+            dyn.node_displX = dynData_accessor[curr_idx + 4];
+            dyn.node_displY = dynData_accessor[curr_idx + 5];
+            dyn.node_displZ = dynData_accessor[curr_idx + 6];
+            dyn.norm_stressX = dynData_accessor[curr_idx + 7] / 100000000;
+            dyn.norm_stressY = dynData_accessor[curr_idx + 8] / 100000000;
+            dyn.norm_stressZ = dynData_accessor[curr_idx + 9] / 100000000;
+            dyn.shear_stressX = dynData_accessor[curr_idx + 10] / 100000000;
+            dyn.shear_stressY = dynData_accessor[curr_idx + 11] / 100000000;
+            dyn.shear_stressZ = dynData_accessor[curr_idx + 12] / 100000000;
+            dyn.padding0 = 0.0f;
+            dyn.padding1 = 0.0f;
+            dyn.padding2 = 0.0f;
+        }
     }
 
     auto const elem_accesssor = element_ft->GetData();
     if (element_ft->GetColumnsCount() == 9)
     {
         std::vector<std::array<size_t, 8>> elements;
-        elements.reserve(element_ft->GetRowsCount());
+        elements.resize(element_ft->GetRowsCount());
 
-        for (int elem_idx = 0; elem_idx < element_ft->GetRowsCount(); ++elem_idx) {
+#pragma omp parallel for
+        for (int elem_idx = 0; elem_idx < static_cast<int>(element_ft->GetRowsCount()); ++elem_idx) {
 
             auto curr_idx = elem_idx * 9;
-            elements.push_back({
+            elements[elem_idx] = std::array<size_t, 8>({
                     static_cast<size_t>(elem_accesssor[curr_idx + 1]),
                     static_cast<size_t>(elem_accesssor[curr_idx + 2]),
                     static_cast<size_t>(elem_accesssor[curr_idx + 3]),
@@ -176,7 +171,7 @@ bool megamol::archvis::CreateFEMModel::getDataCallback(core::Call& caller) {
         }
 
         m_FEM_model = std::make_shared<FEMModel>(nodes, elements);
-        m_FEM_model->setDynamicData(dynamic_data);
+        m_FEM_model->setDynamicData(std::move(dynamic_data), timesteps);
     }
     else
     {
@@ -186,7 +181,7 @@ bool megamol::archvis::CreateFEMModel::getDataCallback(core::Call& caller) {
     this->m_my_hash++;
     this->m_node_input_hash = node_ft->DataHash();
     this->m_element_input_hash = element_ft->DataHash();
-    this->m_deform_input_hash = dynData_ft->DataHash();
+    this->m_deform_input_hash = deform_input_hash;
 
     cd->setFEMData(m_FEM_model);
     cd->SetDataHash(this->m_my_hash);
@@ -1,7 +1,9 @@
 #include "stdafx.h"
 
+#include <exception>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 #include "FEMLoader.h"
 
@@ -21,6 +23,51 @@ std::vector<std::string> split(std::string const& s, char delimiter) {
     }
     return tokens;
 }
+
+/*
+ * Reads all lines of a text file, such that they can be parsed in parallel.
+ */
+std::vector<std::string> readLines(std::string const& filename) {
+    std::vector<std::string> lines;
+
+    std::ifstream file;
+    file.open(filename, std::ifstream::in);
+
+    if (file.is_open()) {
+        std::string line;
+        while (std::getline(file, line, '\n')) {
+            lines.push_back(std::move(line));
+        }
+    }
+
+    return lines;
+}
+
+/*
+ * Parses all lines in parallel and answers the values of the lines accepted by
+ * parse in file order. Lines that cannot be converted are skipped.
+ */
+template <typename T, typename F> std::vector<T> parseLines(std::vector<std::string> const& lines, F parse) {
+    std::vector<T> values(lines.size());
+    std::vector<char> valid(lines.size(), 0);
+
+#pragma omp parallel for schedule(static)
+    for (int line_idx = 0; line_idx < static_cast<int>(lines.size()); ++line_idx) {
+        try {
+            valid[line_idx] = parse(lines[line_idx], values[line_idx]) ? 1 : 0;
+        } catch (std::exception const&) {
+            valid[line_idx] = 0;
+        }
+    }
+
+    std::vector<T> retval;
+    retval.reserve(lines.size());
+    for (size_t line_idx = 0; line_idx < lines.size(); ++line_idx) {
+        if (valid[line_idx] != 0) retval.push_back(values[line_idx]);
+    }
+
+    return retval;
+}
 } // namespace
 
 namespace megamol {
@@ -103,77 +150,32 @@ bool FEMLoader::getDataCallback(core::Call& caller) {
 void FEMLoader::release() {}
 
 std::vector<FEMModel::Vec3> FEMLoader::loadNodesFromFile(std::string const& filename) {
-    std::vector<FEMModel::Vec3> retval;
-
-    std::ifstream file;
-    file.open(filename, std::ifstream::in);
-
-    if (file.is_open()) {
-        file.seekg(0, std::ifstream::beg);
-
-        unsigned int lines_read = 0;
-        while (!file.eof()) {
-            std::string line;
-            std::getline(file, line, '\n');
-
-            auto sl = split(line, ',');
-
-            if (sl.size() == 4)
-                retval.push_back(FEMModel::Vec3(std::stof(sl[1]), std::stof(sl[2]), std::stof(sl[3])));
-        }
-    }
-
-    return retval;
+    return parseLines<FEMModel::Vec3>(readLines(filename), [](std::string const& line, FEMModel::Vec3& node) {
+        auto sl = split(line, ',');
+        if (sl.size() != 4) return false;
+        node = FEMModel::Vec3(std::stof(sl[1]), std::stof(sl[2]), std::stof(sl[3]));
+        return true;
+    });
 }
 
 std::vector<std::array<size_t, 8>> FEMLoader::loadElementsFromFile(std::string const& filename) {
-    std::vector<std::array<size_t, 8>> retval;
-
-    std::ifstream file;
-    file.open(filename, std::ifstream::in);
-
-    if (file.is_open()) {
-        file.seekg(0, std::ifstream::beg);
-
-        unsigned int lines_read = 0;
-        while (!file.eof()) {
-            std::string line;
-            std::getline(file, line, '\n');
-
+    return parseLines<std::array<size_t, 8>>(
+        readLines(filename), [](std::string const& line, std::array<size_t, 8>& element) {
             auto sl = split(line, ',');
-
-            if (sl.size() == 9)
-                retval.push_back({std::stoul(sl[1]), std::stoul(sl[2]), std::stoul(sl[3]), std::stoul(sl[4]),
-                    std::stoul(sl[5]), std::stoul(sl[6]), std::stoul(sl[7]), std::stoul(sl[8])});
-        }
-    }
-
-    return retval;
+            if (sl.size() != 9) return false;
+            element = {std::stoul(sl[1]), std::stoul(sl[2]), std::stoul(sl[3]), std::stoul(sl[4]), std::stoul(sl[5]),
+                std::stoul(sl[6]), std::stoul(sl[7]), std::stoul(sl[8])};
+            return true;
+        });
 }
 
 std::vector<FEMModel::Vec4> FEMLoader::loadNodeDeformationsFromFile(std::string const& filename) {
-    std::vector<FEMModel::Vec4> retval;
-
-    std::ifstream file;
-    file.open(filename, std::ifstream::in);
-
-    if (file.is_open()) {
-        file.seekg(0, std::ifstream::beg);
-
-        unsigned int lines_read = 0;
-        while (!file.eof()) {
-            std::string line;
-            std::getline(file, line, '\n');
-
-            auto sl = split(line, ',');
-
-            if (sl.size() == 4)
-                retval.push_back(
-                    FEMModel::Vec4(std::stof(sl[1]), std::stof(sl[2]), std::stof(sl[3]), 0.0f /*padding*/));
-        }
-    }
-
-    return retval;
+    return parseLines<FEMModel::Vec4>(readLines(filename), [](std::string const& line, FEMModel::Vec4& deformation) {
+        auto sl = split(line, ',');
+        if (sl.size() != 4) return false;
+        deformation = FEMModel::Vec4(std::stof(sl[1]), std::stof(sl[2]), std::stof(sl[3]), 0.0f /*padding*/);
+        return true;
+    });
 }
 
 } // namespace archvis
@@ -13,6 +13,7 @@
 
 #include <array>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "vislib/math/Matrix.h"
@@ -127,7 +128,13 @@ public:
 
     void setElements(std::vector<std::array<size_t, 8>> const& elements);
 
-    void setDynamicData(std::vector<DynamicData> const& dyn_data);
+    /**
+     * Sets the dynamic data of all time steps, stored time step by time step
+     * with one entry per node each.
+     */
+    void setDynamicData(std::vector<DynamicData> const& dyn_data, size_t timesteps = 1);
+
+    void setDynamicData(std::vector<DynamicData>&& dyn_data, size_t timesteps = 1);
 
     std::vector<Vec3> const& getNodes();
 
@@ -137,6 +144,8 @@ public:
 
     std::vector<DynamicData> const& getDynamicData();
 
+    size_t getTimestepCount();
+
 private:
     size_t m_node_cnt;
     size_t m_timesteps;
@@ -181,8 +190,14 @@ inline void FEMModel::setElements(std::vector<std::array<size_t, 8>> const& elem
     }
 }
 
-inline void FEMModel::setDynamicData(std::vector<DynamicData> const& dyn_data) {
+inline void FEMModel::setDynamicData(std::vector<DynamicData> const& dyn_data, size_t timesteps) {
     m_dynamic_data = dyn_data;
+    m_timesteps = timesteps;
+}
+
+inline void FEMModel::setDynamicData(std::vector<DynamicData>&& dyn_data, size_t timesteps) {
+    m_dynamic_data = std::move(dyn_data);
+    m_timesteps = timesteps;
 }
 
 inline std::vector<FEMModel::Vec3> const& FEMModel::getNodes() { return m_node_positions; }
@@ -193,6 +208,8 @@ inline std::vector<FEMModel::Element> const& FEMModel::getElements() { return m_
 
 inline std::vector<FEMModel::DynamicData> const& FEMModel::getDynamicData() { return m_dynamic_data; }
 
+inline size_t FEMModel::getTimestepCount() { return m_timesteps; }
+
 } // namespace archvis
 } // namespace megamol
 
@@ -1,16 +1,26 @@
 #include "FEMRenderTaskDataSource.h"
 
+#include <algorithm>
 #include <variant>
 
+#include "mmcore/param/IntParam.h"
+
 #include "mesh/GPUMeshCollection.h"
 #include "mesh/MeshCalls.h"
 
 #include "FEMDataCall.h"
 
 megamol::archvis::FEMRenderTaskDataSource::FEMRenderTaskDataSource()
-    : m_fem_callerSlot("getFEMFile", "Connects the data source with loaded FEM data"), m_FEM_model_hash(0) {
+    : m_fem_callerSlot("getFEMFile", "Connects the data source with loaded FEM data")
+    , m_timestep_slot("timestep", "The time step of the displacements and stresses to show")
+    , m_FEM_model_hash(0)
+    , m_node_cnt(0)
+    , m_timestep_cnt(0) {
     this->m_fem_callerSlot.SetCompatibleCall<FEMDataCallDescription>();
     this->MakeSlotAvailable(&this->m_fem_callerSlot);
+
+    this->m_timestep_slot << new core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->m_timestep_slot);
 }
 
 megamol::archvis::FEMRenderTaskDataSource::~FEMRenderTaskDataSource() {}
@@ -53,6 +63,11 @@ bool megamol::archvis::FEMRenderTaskDataSource::getDataCallback(core::Call& call
     rtc->setData(m_gpu_render_tasks);
 
     if (this->m_FEM_model_hash == fem_call->DataHash()) {
+        // all time steps are on the GPU already, choosing another one only updates the step parameters
+        if (this->m_timestep_slot.IsDirty()) {
+            this->m_timestep_slot.ResetDirty();
+            m_gpu_render_tasks->updatePerFrameDataBuffer(this->getTimestepParams(), 3);
+        }
         return true;
     }
 
@@ -83,8 +98,14 @@ bool megamol::archvis::FEMRenderTaskDataSource::getDataCallback(core::Call& call
 
     auto const& node_deformation = fem_call->getFEMData()->getDynamicData();
 
+    m_timestep_cnt = std::max<size_t>(fem_call->getFEMData()->getTimestepCount(), 1);
+    m_node_cnt = node_deformation.size() / m_timestep_cnt;
+
     m_gpu_render_tasks->addPerFrameDataBuffer(node_deformation, 1);
 
+    this->m_timestep_slot.ResetDirty();
+    m_gpu_render_tasks->addPerFrameDataBuffer(this->getTimestepParams(), 3);
+
     { 
         // TODO get transfer function texture and add as per frame data
         std::vector<GLuint64> texture_handles;
@@ -103,3 +124,10 @@ bool megamol::archvis::FEMRenderTaskDataSource::getDataCallback(core::Call& call
 
     return true;
 }
+
+std::vector<uint32_t> megamol::archvis::FEMRenderTaskDataSource::getTimestepParams() {
+    auto timestep = std::max(this->m_timestep_slot.Param<core::param::IntParam>()->Value(), 0);
+    auto max_timestep = static_cast<int>(std::max<size_t>(m_timestep_cnt, 1) - 1);
+    return {static_cast<uint32_t>(std::min(timestep, max_timestep)), static_cast<uint32_t>(m_node_cnt),
+        static_cast<uint32_t>(m_timestep_cnt), 0};
+}
@@ -11,6 +11,10 @@
 #    pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include <vector>
+
+#include "mmcore/param/ParamSlot.h"
+
 #include "mesh/AbstractGPURenderTaskDataSource.h"
 
 namespace megamol {
@@ -47,9 +51,24 @@ protected:
     virtual bool getDataCallback(core::Call& caller);
 
 private:
+    /**
+     * Answer the parameters of the time step to show, i.e. the time step,
+     * the node count per time step and the time step count.
+     */
+    std::vector<uint32_t> getTimestepParams();
+
     megamol::core::CallerSlot m_fem_callerSlot;
 
+    /** The time step of the dynamic data to show, applied in the vertex shader */
+    core::param::ParamSlot m_timestep_slot;
+
     uint64_t m_FEM_model_hash;
+
+    /** The number of nodes per time step of the current model */
+    size_t m_node_cnt;
+
+    /** The number of time steps of the current model */
+    size_t m_timestep_cnt;
 };
 
 } // namespace archvis
@@ -16,6 +16,7 @@ using namespace megamol::cinematic;
 CallKeyframeKeeper::CallKeyframeKeeper(void) : core::AbstractGetDataCall(),
     cameraParam(nullptr),
     interpolCamPos(nullptr),
+    interpolCamPosHash(0),
     keyframes(nullptr),
     boundingbox(nullptr),
     interpolSteps(10),
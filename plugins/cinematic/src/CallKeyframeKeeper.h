@@ -146,6 +146,14 @@ namespace cinematic {
             this->interpolCamPos = k;
         }
 
+        /** The hash changes whenever the interpolated camera positions are rebuilt */
+        inline SIZE_T getInterpolCamPositionsHash() {
+            return this->interpolCamPosHash;
+        }
+        inline void setInterpolCamPositionsHash(SIZE_T h) {
+            this->interpolCamPosHash = h;
+        }
+
         // TOTAL ANIMATION TIME
         inline void setTotalAnimTime(float f) {
             this->totalAnimTime = f;
@@ -219,6 +227,7 @@ namespace cinematic {
 		// Pointer to array of keyframes
 		std::shared_ptr<megamol::core::view::Camera_2> cameraParam;
 		std::shared_ptr<std::vector<glm::vec3 >>       interpolCamPos;
+        SIZE_T                                         interpolCamPosHash;
 		std::shared_ptr<std::vector<Keyframe>>	       keyframes;
         std::shared_ptr<vislib::math::Cuboid<float>>   boundingbox;
         unsigned int                                   interpolSteps;
@@ -20,6 +20,7 @@
 #include "KeyframeKeeper.h"
 #include "CinematicView.h"
 #include "ReplacementRenderer.h"
+#include "RenderBenchmark.h"
 
 /* anonymous namespace hides this type from any other object files */
 namespace {
@@ -53,6 +54,7 @@ namespace {
 			this->module_descriptions.RegisterAutoDescription<megamol::cinematic::KeyframeKeeper>();
 			this->module_descriptions.RegisterAutoDescription<megamol::cinematic::CinematicView>();
             this->module_descriptions.RegisterAutoDescription<megamol::cinematic::ReplacementRenderer>();
+            this->module_descriptions.RegisterAutoDescription<megamol::cinematic::RenderBenchmark>();
 
             // register calls here:
 			this->call_descriptions.RegisterAutoDescription < megamol::cinematic::CallKeyframeKeeper>();
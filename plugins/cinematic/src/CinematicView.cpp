@@ -45,6 +45,7 @@ CinematicView::CinematicView(void)
     , vpHLast(0)
     , sbSide(CinematicView::SkyboxSides::SKYBOX_NONE)
     , fbo()
+    , frameExporter()
     , rendering(false)
     , fps(24)
     , pngdata() {
@@ -697,13 +698,6 @@ bool CinematicView::render2file_setup() {
     // Set current time stamp to file name
     this->pngdata.filename = "frames";
 
-    // Create new byte buffer
-    this->pngdata.buffer = new BYTE[this->pngdata.width * this->pngdata.height * this->pngdata.bpp];
-    if (this->pngdata.buffer == nullptr) {
-        throw vislib::Exception(
-            "[CINEMATIC VIEW] [startAnimRendering] Cannot allocate image buffer.", __FILE__, __LINE__);
-    }
-
     // Disable showing BBOX and CUBE (Uniform backCol is needed for being able to detect changes written to fbo.)
     ///XXX Base::showViewCubeSlot.Param<param::BoolParam>()->SetValue(false);
     ///XXX Base::showBBox.Param<param::BoolParam>()->SetValue(false);
@@ -745,73 +739,16 @@ bool CinematicView::render2file_write_png() {
         }
         tmpFilename.Prepend(this->pngdata.filename);
 
-        // open final image file
-        if (!this->pngdata.file.Open(vislib::sys::Path::Concatenate(this->pngdata.path, tmpFilename),
-                vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE,
-                vislib::sys::File::CREATE_OVERWRITE)) {
-            throw vislib::Exception(
-                "[CINEMATIC VIEW] [startAnimRendering] Cannot open output file", __FILE__, __LINE__);
-        }
-
-        // init png lib
-        this->pngdata.ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, &this->pngError, &this->pngWarn);
-        if (this->pngdata.ptr == nullptr) {
-            throw vislib::Exception(
-                "[CINEMATIC VIEW] [startAnimRendering] Cannot create png structure", __FILE__, __LINE__);
-        }
-        this->pngdata.infoptr = png_create_info_struct(this->pngdata.ptr);
-        if (this->pngdata.infoptr == nullptr) {
-            throw vislib::Exception("[CINEMATIC VIEW] [startAnimRendering] Cannot create png info", __FILE__, __LINE__);
-        }
-        png_set_write_fn(this->pngdata.ptr, static_cast<void*>(&this->pngdata.file), &this->pngWrite, &this->pngFlush);
-        png_set_IHDR(this->pngdata.ptr, this->pngdata.infoptr, this->pngdata.width, this->pngdata.height, 8,
-            PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-
-        if (fbo.GetColourTexture(this->pngdata.buffer, 0, GL_RGB, GL_UNSIGNED_BYTE) != GL_NO_ERROR) {
+        // the frame is read back and encoded while the next frames are rendered
+        vislib::StringA framePath(vislib::sys::Path::Concatenate(this->pngdata.path, tmpFilename));
+        if (!this->frameExporter.Export(this->fbo, framePath.PeekBuffer())) {
             throw vislib::Exception(
-                "[CINEMATIC VIEW] [writeTextureToPng] Failed to create Screenshot: Cannot read image data", __FILE__,
-                __LINE__);
-        }
-
-        BYTE** rows = nullptr;
-        try {
-            rows = new BYTE*[this->cineHeight];
-            for (UINT i = 0; i < this->pngdata.height; i++) {
-                rows[this->pngdata.height - (1 + i)] =
-                    this->pngdata.buffer + this->pngdata.bpp * i * this->pngdata.width;
-            }
-            png_set_rows(this->pngdata.ptr, this->pngdata.infoptr, rows);
-
-            png_write_png(this->pngdata.ptr, this->pngdata.infoptr, PNG_TRANSFORM_IDENTITY, nullptr);
-
-            ARY_SAFE_DELETE(rows);
-        } catch (...) {
-            if (rows != nullptr) {
-                ARY_SAFE_DELETE(rows);
-            }
-            throw;
-        }
-
-        if (this->pngdata.ptr != nullptr) {
-            if (this->pngdata.infoptr != nullptr) {
-                png_destroy_write_struct(&this->pngdata.ptr, &this->pngdata.infoptr);
-            } else {
-                png_destroy_write_struct(&this->pngdata.ptr, (png_infopp) nullptr);
-            }
-        }
-
-        try {
-            this->pngdata.file.Flush();
-        } catch (...) {
-        }
-        try {
-            this->pngdata.file.Close();
-        } catch (...) {
+                "[CINEMATIC VIEW] [render2file_write_png] Failed to write frame", __FILE__, __LINE__);
         }
 
         vislib::sys::Log::DefaultLog.WriteWarn(
-            "[CINEMATIC VIEW] [render2file_write_png] Wrote png file %d for animation time %f ...\n", this->pngdata.cnt,
-            this->pngdata.animTime);
+            "[CINEMATIC VIEW] [render2file_write_png] Exporting png file %d for animation time %f ...\n",
+            this->pngdata.cnt, this->pngdata.animTime);
 
         // --------------------------------------------------------------------
 
@@ -843,6 +780,11 @@ bool CinematicView::render2file_write_png() {
 
 bool CinematicView::render2file_finish() {
 
+    // wait for the frames still being read back or encoded
+    if (!this->frameExporter.Finish()) {
+        vislib::sys::Log::DefaultLog.WriteError("[CINEMATIC VIEW] Failed to write some of the frames.");
+    }
+
     if (this->pngdata.ptr != nullptr) {
         if (this->pngdata.infoptr != nullptr) {
             png_destroy_write_struct(&this->pngdata.ptr, &this->pngdata.infoptr);
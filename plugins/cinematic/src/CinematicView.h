@@ -16,6 +16,7 @@
 #include "mmcore/view/CallRender3D_2.h"
 #include "mmcore/view/CallRenderView.h"
 
+#include "mmcore/utility/FrameExporter.h"
 #include "mmcore/utility/SDFFont.h"
 
 #include "mmcore/param/BoolParam.h"
@@ -128,6 +129,8 @@ namespace cinematic {
         CinematicView::SkyboxSides sbSide;
 
         vislib::graphics::gl::FramebufferObject fbo;
+        /** Writes the rendered frames while the next ones are rendered */
+        core::utility::FrameExporter frameExporter;
         bool rendering;
         unsigned int fps;
 
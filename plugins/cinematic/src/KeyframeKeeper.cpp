@@ -60,6 +60,11 @@ KeyframeKeeper::KeyframeKeeper(void) : core::Module(),
     filename("keyframes.kf"),
     simTangentStatus(false),
     tl(0.5f),
+    interpolCamPosHash(0),
+    interpolCamPosSteps(0),
+    segmentLookup(),
+    segmentLookupStart(0.0f),
+    segmentLookupStep(1.0f),
     undoQueue(),
     undoQueueIndex(0)
 {
@@ -207,9 +212,13 @@ bool KeyframeKeeper::CallForGetInterpolCamPositions(core::Call& c) {
     CallKeyframeKeeper *ccc = dynamic_cast<CallKeyframeKeeper*>(&c);
     if (ccc == nullptr) return false;
 
+    // Only rebuild if the steps changed, all changes of keyframes already refresh the positions
     this->interpolSteps = ccc->getInterpolationSteps();
-    this->refreshInterpolCamPos(this->interpolSteps);
+    if (this->interpolSteps != this->interpolCamPosSteps) {
+        this->refreshInterpolCamPos(this->interpolSteps);
+    }
     ccc->setInterpolCamPositions(this->interpolCamPos);
+    ccc->setInterpolCamPositionsHash(this->interpolCamPosHash);
 
     return true;
 }
@@ -593,6 +602,7 @@ bool KeyframeKeeper::CallForGetUpdatedKeyframeData(core::Call& c) {
             this->snapKeyframe2AnimFrame(&this->keyframes->operator[](i));
         }
         this->snapKeyframe2AnimFrame(&this->selectedKeyframe);
+        this->refreshSegmentLookup();
     }
 
     // snapSimFramesParam -----------------------------------------------------
@@ -619,6 +629,7 @@ bool KeyframeKeeper::CallForGetUpdatedKeyframeData(core::Call& c) {
     ccc->setSelectedKeyframe(this->selectedKeyframe);
     ccc->setTotalAnimTime(this->totalAnimTime);
     ccc->setInterpolCamPositions(this->interpolCamPos);
+    ccc->setInterpolCamPositionsHash(this->interpolCamPosHash);
     ccc->setTotalSimTime(this->totalSimTime);
     ccc->setFps(this->fps);
     ccc->setControlPointPosition(this->startCtrllPos, this->endCtrllPos);
@@ -905,6 +916,8 @@ void KeyframeKeeper::setSameSpeed() {
             kfDist += glm::length(this->interpolCamPos->operator[](i + 1) - this->interpolCamPos->operator[](i));
         }
 
+        this->refreshSegmentLookup();
+
         // Restore previous selected keyframe
         if (selIndex >= 0) {
             this->selectedKeyframe = this->keyframes->operator[](selIndex);
@@ -916,12 +929,17 @@ void KeyframeKeeper::setSameSpeed() {
 void KeyframeKeeper::refreshInterpolCamPos(unsigned int s) {
 
     this->interpolCamPos->clear();
-    this->interpolCamPos->reserve(1000);
+    this->interpolCamPosHash++;
+    this->interpolCamPosSteps = s;
+    this->refreshSegmentLookup();
 
     if (s == 0) {
         vislib::sys::Log::DefaultLog.WriteError("[KEYFRAME KEEPER] [refreshInterpolCamPos] Interpolation step count is ZERO.");
         return;
     }
+    if (this->keyframes->size() > 1) {
+        this->interpolCamPos->reserve((this->keyframes->size() - 1) * s + 1);
+    }
 
     float startTime;
     float deltaTimeStep;
@@ -1114,13 +1132,6 @@ Keyframe KeyframeKeeper::interpolateKeyframe(float time) {
     t = (t < 0.0f) ? (0.0f) : (t);
     t = (t > this->totalAnimTime) ? (this->totalAnimTime) : (t);
 
-    // Check if there is an existing keyframe at requested time
-    for (SIZE_T i = 0; i < this->keyframes->size(); i++) {
-        if (t == this->keyframes->operator[](i).GetAnimTime()) {
-            return this->keyframes->operator[](i);
-        }
-    }
-
     if (this->keyframes->empty()) {
         // vislib::sys::Log::DefaultLog.WriteInfo("[KEYFRAME KEEPER] [Interpolate Keyframe] Empty keyframe array.");
         Keyframe kf = Keyframe();
@@ -1163,31 +1174,34 @@ Keyframe KeyframeKeeper::interpolateKeyframe(float time) {
         kf.SetCameraApertureAngele(this->camViewApertureangle);
         return kf;
     }
-    else { // if ((t > this->keyframes->front().GetAnimTime()) && (t < this->keyframes->back().GetAnimTime())) {
+    else { // if ((t >= this->keyframes->front().GetAnimTime()) && (t <= this->keyframes->back().GetAnimTime())) {
 
-        // new default keyframe
-        Keyframe kf = Keyframe();
-        kf.SetAnimTime(t);
+        if (this->keyframes->size() == 1) {
+            return this->keyframes->front();
+        }
 
         // determine indices for interpolation 
-        int i0 = 0;
-        int i1 = 0;
-        int i2 = 0;
-        int i3 = 0;
         int kfIdxCnt = (int)this->keyframes->size() - 1;
-        float iT = 0.0f;
-        for (int i = 0; i < kfIdxCnt; i++) {
-            float tMin = this->keyframes->operator[](i).GetAnimTime();
-            float tMax = this->keyframes->operator[](i + 1).GetAnimTime();
-            if ((tMin < t) && (t < tMax)) {
-                iT = (t - tMin) / (tMax - tMin); // Map current time to [0,1] between two keyframes
-                i1 = i;
-                i2 = i + 1;
-                break;
-            }
+        int i1 = static_cast<int>(this->findSegment(t));
+        int i2 = i1 + 1;
+
+        // Check if there is an existing keyframe at requested time
+        float tMin = this->keyframes->operator[](i1).GetAnimTime();
+        float tMax = this->keyframes->operator[](i2).GetAnimTime();
+        if (t == tMin) {
+            return this->keyframes->operator[](i1);
+        }
+        if (t == tMax) {
+            return this->keyframes->operator[](i2);
         }
-        i0 = (i1 > 0) ? (i1 - 1) : (0);
-        i3 = (i2 < kfIdxCnt) ? (i2 + 1) : (kfIdxCnt);
+        float iT = (t - tMin) / (tMax - tMin); // Map current time to [0,1] between two keyframes
+
+        // new default keyframe
+        Keyframe kf = Keyframe();
+        kf.SetAnimTime(t);
+
+        int i0 = (i1 > 0) ? (i1 - 1) : (0);
+        int i3 = (i2 < kfIdxCnt) ? (i2 + 1) : (kfIdxCnt);
 
         // Interpolate simulation time linear between i1 and i2
         float simT1 = this->keyframes->operator[](i1).GetSimTime();
@@ -1266,6 +1280,58 @@ Keyframe KeyframeKeeper::interpolateKeyframe(float time) {
 }
 
 
+void KeyframeKeeper::refreshSegmentLookup(void) {
+
+    this->segmentLookup.clear();
+    if (this->keyframes->size() < 2) {
+        return;
+    }
+
+    // A few buckets per keyframe, so only a few segments have to be skipped
+    // in findSegment, even for unevenly distributed keyframes
+    const unsigned int segCnt = static_cast<unsigned int>(this->keyframes->size()) - 1;
+    const unsigned int bucketCnt = 4 * segCnt;
+    this->segmentLookupStart = this->keyframes->front().GetAnimTime();
+    this->segmentLookupStep = (this->keyframes->back().GetAnimTime() - this->segmentLookupStart) / (float)bucketCnt;
+    if (this->segmentLookupStep <= 0.0f) {
+        return;
+    }
+
+    this->segmentLookup.resize(bucketCnt);
+    unsigned int seg = 0;
+    for (unsigned int b = 0; b < bucketCnt; b++) {
+        float bucketStart = this->segmentLookupStart + this->segmentLookupStep * (float)b;
+        while ((seg < segCnt - 1) && (this->keyframes->operator[](seg + 1).GetAnimTime() <= bucketStart)) {
+            seg++;
+        }
+        this->segmentLookup[b] = seg;
+    }
+}
+
+
+unsigned int KeyframeKeeper::findSegment(float time) {
+
+    const unsigned int segCnt = static_cast<unsigned int>(this->keyframes->size()) - 1;
+
+    // Start at the segment of the bucket. The table might be outdated if the
+    // times of keyframes were changed in between, so always verify the result.
+    unsigned int seg = 0;
+    if (!this->segmentLookup.empty()) {
+        int b = static_cast<int>((time - this->segmentLookupStart) / this->segmentLookupStep);
+        b = vislib::math::Clamp(b, 0, static_cast<int>(this->segmentLookup.size()) - 1);
+        seg = vislib::math::Min(this->segmentLookup[b], segCnt - 1);
+    }
+    while ((seg > 0) && (time < this->keyframes->operator[](seg).GetAnimTime())) {
+        seg--;
+    }
+    while ((seg < segCnt - 1) && (time > this->keyframes->operator[](seg + 1).GetAnimTime())) {
+        seg++;
+    }
+
+    return seg;
+}
+
+
 float KeyframeKeeper::interpolate_f(float u, float f0, float f1, float f2, float f3) {
 
     // Catmull-Rom
@@ -114,6 +114,14 @@ namespace cinematic {
         vislib::StringA             filename;
         bool                        simTangentStatus;
         float                       tl; // Global interpolation spline tangent length of keyframes
+        SIZE_T                      interpolCamPosHash; // Changes whenever the interpolated camera positions are rebuilt
+        unsigned int                interpolCamPosSteps; // Interpolation steps of the interpolated camera positions
+
+        // Keyframe segment containing the start of each of the uniform time
+        // buckets over the animation, allows constant time segment lookup
+        std::vector<unsigned int>   segmentLookup;
+        float                       segmentLookupStart;
+        float                       segmentLookupStep;
 
         // undo queue stuff -----------------------------------------------
 
@@ -213,6 +221,17 @@ namespace cinematic {
         */
         void refreshInterpolCamPos(unsigned int s);
 
+        /**
+        * Rebuild the segment lookup table (called when animation times of keyframes change).
+        */
+        void refreshSegmentLookup(void);
+
+        /**
+        * Get the index i of the keyframe segment [i, i+1] containing the given animation time.
+        * Requires at least two keyframes and a time between the first and the last keyframe.
+        */
+        unsigned int findSegment(float time);
+
         /**  
         * Updating edit parameters without setting them dirty.
         */
@@ -0,0 +1,541 @@
+/*
+ * RenderBenchmark.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+
+#include "RenderBenchmark.h"
+
+#include "mmcore/AbstractNamedObject.h"
+#include "mmcore/AbstractNamedObjectContainer.h"
+#include "mmcore/CoreInstance.h"
+#include "mmcore/ViewInstance.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/ButtonParam.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/StringParam.h"
+#include "mmcore/view/CallRenderView.h"
+
+#include "vislib/graphics/gl/FramebufferObject.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
+#include "vislib/sys/AutoLock.h"
+#include "vislib/sys/Log.h"
+
+#include "CallKeyframeKeeper.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <utility>
+
+
+using namespace megamol;
+using namespace megamol::core;
+using namespace megamol::cinematic;
+
+
+RenderBenchmark::RenderBenchmark(void)
+    : core::job::AbstractJob()
+    , core::Module()
+    , core::view::AbstractView::Hooks()
+    , viewNameSlot("view", "The name of the view instance or view to be benchmarked")
+    , modeParamNameSlot("mode::param", "Full name of the render mode parameter, e.g. '::inst::SphereRenderer1::renderMode'")
+    , modesSlot("mode::modes", "Names of the render modes to benchmark, separated by ';' (empty for all modes)")
+    , dataParamNameSlot("data::param",
+          "Full name of the data source parameter controlling the data set, e.g. the particle count of a generator or "
+          "the file name of a MMPLD data source (empty for the current data set only)")
+    , dataValuesSlot("data::values", "Values of the data source parameter to benchmark, separated by ';'")
+    , resolutionsSlot("resolutions", "Off-screen resolutions to benchmark, separated by ';', e.g. '1280x720;1920x1080'")
+    , cameraStepsSlot("cameraSteps",
+          "Number of camera positions sampled evenly along the tracking shot of the connected keyframe keeper")
+    , warmupFramesSlot("frames::warmup", "Number of unmeasured frames rendered before each configuration")
+    , framesSlot("frames::measured", "Number of measured frames per configuration")
+    , uploadParamNameSlot("uploadParam",
+          "Full name of the renderer parameter reporting the uploaded MB of the last frame, e.g. "
+          "'::inst::SphereRenderer1::statistics::uploadedMB' (empty for none)")
+    , outputFileSlot("output::filename", "The file the results are written to")
+    , outputFormatSlot("output::format", "The format of the results")
+    , applyBestModeSlot("applyBestMode", "Switch the renderer to the mode with the lowest mean frame time afterwards")
+    , triggerButtonSlot("trigger", "Runs the benchmark")
+    , keyframeKeeperSlot("keyframeData", "Connects to the keyframe keeper providing the camera path")
+    , running(false) {
+
+    this->viewNameSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->viewNameSlot);
+
+    this->modeParamNameSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->modeParamNameSlot);
+
+    this->modesSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->modesSlot);
+
+    this->dataParamNameSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->dataParamNameSlot);
+
+    this->dataValuesSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->dataValuesSlot);
+
+    this->resolutionsSlot << new param::StringParam("1280x720;1920x1080;3840x2160");
+    this->MakeSlotAvailable(&this->resolutionsSlot);
+
+    this->cameraStepsSlot << new param::IntParam(1, 1);
+    this->MakeSlotAvailable(&this->cameraStepsSlot);
+
+    this->warmupFramesSlot << new param::IntParam(10, 0);
+    this->MakeSlotAvailable(&this->warmupFramesSlot);
+
+    this->framesSlot << new param::IntParam(100, 1);
+    this->MakeSlotAvailable(&this->framesSlot);
+
+    this->uploadParamNameSlot << new param::StringParam("");
+    this->MakeSlotAvailable(&this->uploadParamNameSlot);
+
+    this->outputFileSlot << new param::FilePathParam("benchmark.csv");
+    this->MakeSlotAvailable(&this->outputFileSlot);
+
+    param::EnumParam* formats = new param::EnumParam(0);
+    formats->SetTypePair(0, "CSV");
+    formats->SetTypePair(1, "JSON");
+    this->outputFormatSlot << formats;
+    this->MakeSlotAvailable(&this->outputFormatSlot);
+
+    this->applyBestModeSlot << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->applyBestModeSlot);
+
+    this->triggerButtonSlot << new param::ButtonParam();
+    this->triggerButtonSlot.SetUpdateCallback(&RenderBenchmark::triggerButtonClicked);
+    this->MakeSlotAvailable(&this->triggerButtonSlot);
+
+    this->keyframeKeeperSlot.SetCompatibleCall<CallKeyframeKeeperDescription>();
+    this->MakeSlotAvailable(&this->keyframeKeeperSlot);
+}
+
+
+RenderBenchmark::~RenderBenchmark(void) {
+    this->Release();
+}
+
+
+bool RenderBenchmark::IsRunning(void) const {
+    return this->running;
+}
+
+
+bool RenderBenchmark::Start(void) {
+    this->triggerButtonClicked(this->triggerButtonSlot);
+    return true;
+}
+
+
+bool RenderBenchmark::Terminate(void) {
+    this->running = false;
+    return true;
+}
+
+
+bool RenderBenchmark::create(void) {
+    // Intentionally empty. Initialization is lazy.
+    return true;
+}
+
+
+void RenderBenchmark::release(void) {
+    // intentionally empty.
+}
+
+
+void RenderBenchmark::BeforeRender(core::view::AbstractView* view) {
+    using vislib::sys::Log;
+
+    view->UnregisterHook(this); // avoid recursive calling
+
+    if (!this->running) return;
+    this->running = false;
+
+    // Render modes
+    vislib::StringA modeParamName(this->modeParamNameSlot.Param<param::StringParam>()->Value());
+    param::ParamSlot* modeSlot = this->findParam(modeParamName);
+    param::EnumParam* modeParam = (modeSlot != nullptr) ? modeSlot->Param<param::EnumParam>() : nullptr;
+
+    if (modeParam == nullptr) {
+        Log::DefaultLog.WriteError("[RenderBenchmark] Unable to find render mode parameter \"%s\"",
+            modeParamName.PeekBuffer());
+        return;
+    }
+
+    const auto selectedModes = split(vislib::StringA(this->modesSlot.Param<param::StringParam>()->Value()));
+    std::vector<std::pair<int, std::string>> modes;
+
+    vislib::Map<int, vislib::TString> modeMap = modeParam->getMap();
+    vislib::Map<int, vislib::TString>::Iterator modeMapIt = modeMap.GetIterator();
+    while (modeMapIt.HasNext()) {
+        const auto& mode = modeMapIt.Next();
+        const std::string name(vislib::StringA(mode.Value()).PeekBuffer());
+
+        if (selectedModes.empty() || std::find(selectedModes.begin(), selectedModes.end(), name) != selectedModes.end()) {
+            modes.push_back(std::make_pair(mode.Key(), name));
+        }
+    }
+
+    if (modes.empty()) {
+        Log::DefaultLog.WriteError("[RenderBenchmark] None of the selected render modes is provided by \"%s\"",
+            modeParamName.PeekBuffer());
+        return;
+    }
+
+    // Data sets
+    vislib::StringA dataParamName(this->dataParamNameSlot.Param<param::StringParam>()->Value());
+    param::ParamSlot* dataSlot = nullptr;
+    vislib::TString originalData;
+
+    if (!dataParamName.IsEmpty()) {
+        dataSlot = this->findParam(dataParamName);
+
+        if (dataSlot == nullptr) {
+            Log::DefaultLog.WriteError("[RenderBenchmark] Unable to find data parameter \"%s\"",
+                dataParamName.PeekBuffer());
+            return;
+        }
+
+        originalData = dataSlot->Parameter()->ValueString();
+    }
+
+    auto dataValues = split(vislib::StringA(this->dataValuesSlot.Param<param::StringParam>()->Value()));
+    if (dataSlot == nullptr || dataValues.empty()) {
+        dataValues.assign(1, std::string(vislib::StringA(originalData).PeekBuffer()));
+    }
+
+    // Resolutions
+    std::vector<std::array<int, 2>> resolutions;
+    for (const auto& resolution : split(vislib::StringA(this->resolutionsSlot.Param<param::StringParam>()->Value()))) {
+        std::array<int, 2> size;
+        if (std::sscanf(resolution.c_str(), "%dx%d", &size[0], &size[1]) == 2 && size[0] > 0 && size[1] > 0) {
+            resolutions.push_back(size);
+        } else {
+            Log::DefaultLog.WriteWarn("[RenderBenchmark] Ignoring invalid resolution \"%s\"", resolution.c_str());
+        }
+    }
+
+    if (resolutions.empty()) {
+        Log::DefaultLog.WriteError("[RenderBenchmark] No valid resolution given");
+        return;
+    }
+
+    // Camera positions along the tracking shot, or the current camera if no keyframes are available
+    auto ccc = this->keyframeKeeperSlot.CallAs<CallKeyframeKeeper>();
+    std::vector<float> cameraTimes;
+    float originalCameraTime = -1.0f;
+
+    if (ccc != nullptr && (*ccc)(CallKeyframeKeeper::CallForGetUpdatedKeyframeData) && !ccc->getKeyframes()->empty()) {
+        originalCameraTime = ccc->getSelectedKeyframe().GetAnimTime();
+
+        const int steps = this->cameraStepsSlot.Param<param::IntParam>()->Value();
+        const float totalTime = ccc->getTotalAnimTime();
+
+        for (int i = 0; i < steps; ++i) {
+            cameraTimes.push_back((steps > 1) ? (totalTime * i) / (steps - 1) : originalCameraTime);
+        }
+    } else {
+        ccc = nullptr;
+        cameraTimes.push_back(-1.0f);
+    }
+
+    // Upload statistics
+    vislib::StringA uploadParamName(this->uploadParamNameSlot.Param<param::StringParam>()->Value());
+    param::ParamSlot* uploadSlot = nullptr;
+
+    if (!uploadParamName.IsEmpty()) {
+        uploadSlot = this->findParam(uploadParamName);
+
+        if (uploadSlot == nullptr) {
+            Log::DefaultLog.WriteWarn("[RenderBenchmark] Unable to find upload parameter \"%s\"",
+                uploadParamName.PeekBuffer());
+        }
+    }
+
+    const unsigned int warmupFrames = static_cast<unsigned int>(this->warmupFramesSlot.Param<param::IntParam>()->Value());
+    const unsigned int measuredFrames = static_cast<unsigned int>(this->framesSlot.Param<param::IntParam>()->Value());
+
+    Log::DefaultLog.WriteInfo("[RenderBenchmark] Benchmarking %u configurations with %u frames each",
+        static_cast<unsigned int>(dataValues.size() * resolutions.size() * modes.size() * cameraTimes.size()),
+        measuredFrames);
+
+    // Run the benchmark, measuring frame times with timer queries
+    const int originalMode = modeParam->Value();
+    std::vector<Result> results;
+
+    GLuint query;
+    glGenQueries(1, &query);
+
+    vislib::graphics::gl::FramebufferObject fbo;
+    view::CallRenderView crv;
+
+    for (const auto& dataValue : dataValues) {
+        if (dataSlot != nullptr && !dataSlot->Parameter()->ParseValue(vislib::TString(vislib::StringA(dataValue.c_str())))) {
+            Log::DefaultLog.WriteWarn("[RenderBenchmark] Unable to set data parameter to \"%s\"", dataValue.c_str());
+            continue;
+        }
+
+        for (const auto& resolution : resolutions) {
+            if (!fbo.Create(resolution[0], resolution[1], GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE,
+                    vislib::graphics::gl::FramebufferObject::ATTACHMENT_RENDERBUFFER, GL_DEPTH_COMPONENT24)) {
+                Log::DefaultLog.WriteError("[RenderBenchmark] Unable to create framebuffer object of size %dx%d",
+                    resolution[0], resolution[1]);
+                continue;
+            }
+
+            for (const auto& mode : modes) {
+                modeParam->SetValue(mode.first);
+
+                for (const float cameraTime : cameraTimes) {
+                    if (ccc != nullptr) {
+                        ccc->setSelectedKeyframeTime(cameraTime);
+                        (*ccc)(CallKeyframeKeeper::CallForGetSelectedKeyframeAtTime);
+                    }
+
+                    std::vector<double> frameTimes;
+                    frameTimes.reserve(measuredFrames);
+                    double uploadMB = 0.0;
+
+                    for (unsigned int frame = 0; frame < warmupFrames + measuredFrames; ++frame) {
+                        const bool measure = (frame >= warmupFrames);
+
+                        if (fbo.Enable() != GL_NO_ERROR) {
+                            Log::DefaultLog.WriteError("[RenderBenchmark] Cannot enable framebuffer object");
+                            break;
+                        }
+                        glViewport(0, 0, resolution[0], resolution[1]);
+
+                        crv.ResetAll();
+                        crv.SetOutputBuffer(&fbo, vislib::math::Rectangle<int>(0, 0, resolution[0], resolution[1]));
+                        crv.SetTile(static_cast<float>(resolution[0]), static_cast<float>(resolution[1]), 0.0f,
+                            0.0f, static_cast<float>(resolution[0]), static_cast<float>(resolution[1]));
+                        crv.SetTime(-1.0f);
+
+                        if (measure) glBeginQuery(GL_TIME_ELAPSED, query);
+                        view->OnRenderView(crv); // glClear by SFX
+                        if (measure) glEndQuery(GL_TIME_ELAPSED);
+
+                        fbo.Disable();
+
+                        if (measure) {
+                            GLuint64 elapsed = 0;
+                            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                            frameTimes.push_back(static_cast<double>(elapsed) / 1.0e6);
+
+                            if (uploadSlot != nullptr) {
+                                uploadMB += std::atof(vislib::StringA(uploadSlot->Parameter()->ValueString()).PeekBuffer());
+                            }
+                        }
+                    }
+
+                    if (frameTimes.empty()) continue;
+
+                    Result result;
+                    result.data = dataValue;
+                    result.width = resolution[0];
+                    result.height = resolution[1];
+                    result.mode = mode.second;
+                    result.cameraTime = cameraTime;
+                    result.frames = static_cast<unsigned int>(frameTimes.size());
+
+                    double sum = 0.0;
+                    for (const double time : frameTimes) {
+                        sum += time;
+                    }
+                    result.gpuMean = sum / frameTimes.size();
+                    result.gpuMin = *std::min_element(frameTimes.begin(), frameTimes.end());
+                    result.gpuMax = *std::max_element(frameTimes.begin(), frameTimes.end());
+                    std::nth_element(frameTimes.begin(), frameTimes.begin() + frameTimes.size() / 2, frameTimes.end());
+                    result.gpuMedian = frameTimes[frameTimes.size() / 2];
+                    result.uploadMB = uploadMB / frameTimes.size();
+
+                    Log::DefaultLog.WriteInfo("[RenderBenchmark] %s, %dx%d, %s, camera %.2f: %.3f ms (median %.3f ms), "
+                        "%.2f MB uploaded per frame", result.data.c_str(), result.width, result.height,
+                        result.mode.c_str(), result.cameraTime, result.gpuMean, result.gpuMedian, result.uploadMB);
+
+                    results.push_back(result);
+                }
+            }
+
+            fbo.Release();
+        }
+    }
+
+    glDeleteQueries(1, &query);
+
+    // Restore the original state
+    if (dataSlot != nullptr) {
+        dataSlot->Parameter()->ParseValue(originalData);
+    }
+    if (ccc != nullptr) {
+        ccc->setSelectedKeyframeTime(originalCameraTime);
+        (*ccc)(CallKeyframeKeeper::CallForGetSelectedKeyframeAtTime);
+    }
+
+    // Select the mode with the lowest mean frame time over all configurations
+    std::map<int, std::pair<double, unsigned int>> modeTimes;
+    for (const auto& result : results) {
+        const auto mode = std::find_if(modes.begin(), modes.end(),
+            [&result](const std::pair<int, std::string>& m) { return m.second == result.mode; });
+
+        modeTimes[mode->first].first += result.gpuMean;
+        ++modeTimes[mode->first].second;
+    }
+
+    int bestMode = originalMode;
+    std::string bestModeName;
+    double bestTime = std::numeric_limits<double>::max();
+
+    for (const auto& modeTime : modeTimes) {
+        const double meanTime = modeTime.second.first / modeTime.second.second;
+
+        if (meanTime < bestTime) {
+            bestTime = meanTime;
+            bestMode = modeTime.first;
+        }
+    }
+
+    for (const auto& mode : modes) {
+        if (mode.first == bestMode && !modeTimes.empty()) {
+            bestModeName = mode.second;
+        }
+    }
+
+    if (!bestModeName.empty()) {
+        Log::DefaultLog.WriteInfo("[RenderBenchmark] Fastest render mode: %s (%.3f ms on average)",
+            bestModeName.c_str(), bestTime);
+    }
+
+    modeParam->SetValue(this->applyBestModeSlot.Param<param::BoolParam>()->Value() ? bestMode : originalMode);
+
+    this->writeResults(results, bestModeName);
+}
+
+
+bool RenderBenchmark::triggerButtonClicked(core::param::ParamSlot& slot) {
+    using vislib::sys::Log;
+    ASSERT(&slot == &this->triggerButtonSlot);
+
+    vislib::StringA mvn(this->viewNameSlot.Param<param::StringParam>()->Value());
+
+    vislib::sys::AutoLock lock(this->ModuleGraphLock());
+    {
+        AbstractNamedObjectContainer::ptr_type anoc =
+            AbstractNamedObjectContainer::dynamic_pointer_cast(this->RootModule());
+        AbstractNamedObject::ptr_type ano = anoc->FindChild(mvn);
+        ViewInstance* vi = dynamic_cast<ViewInstance*>(ano.get());
+        auto av = dynamic_cast<view::AbstractView*>(ano.get());
+        if (vi != nullptr && vi->View() != nullptr) {
+            av = vi->View();
+        }
+
+        bool found = false;
+        if (av != nullptr) {
+            av->RegisterHook(this);
+            found = true;
+        } else {
+            // suppose a view was actually intended!
+            const auto fun = [this, &found](view::AbstractView* v) {
+                v->RegisterHook(this);
+                found = true;
+            };
+            this->GetCoreInstance()->FindModuleNoLock<view::AbstractView>(mvn.PeekBuffer(), fun);
+        }
+
+        if (!found) {
+            Log::DefaultLog.WriteError("[RenderBenchmark] Unable to find view or viewInstance \"%s\"", mvn.PeekBuffer());
+            return true;
+        }
+    }
+
+    Log::DefaultLog.WriteInfo("[RenderBenchmark] Benchmark of \"%s\" requested", mvn.PeekBuffer());
+    this->running = true;
+
+    return true;
+}
+
+
+param::ParamSlot* RenderBenchmark::findParam(const vislib::StringA& name) {
+    AbstractNamedObjectContainer* anoc = dynamic_cast<AbstractNamedObjectContainer*>(this->RootModule().get());
+    if (anoc == nullptr || name.IsEmpty()) return nullptr;
+
+    return dynamic_cast<param::ParamSlot*>(anoc->FindNamedObject(name).get());
+}
+
+
+std::vector<std::string> RenderBenchmark::split(const vislib::StringA& list) {
+    std::vector<std::string> values;
+    const std::string str(list.PeekBuffer());
+
+    std::size_t begin = 0;
+    while (begin <= str.size()) {
+        std::size_t end = str.find(';', begin);
+        if (end == std::string::npos) end = str.size();
+
+        std::string value = str.substr(begin, end - begin);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t") + 1);
+
+        if (!value.empty()) {
+            values.push_back(value);
+        }
+
+        begin = end + 1;
+    }
+
+    return values;
+}
+
+
+bool RenderBenchmark::writeResults(const std::vector<Result>& results, const std::string& bestMode) const {
+    using vislib::sys::Log;
+
+    const vislib::StringA filename(this->outputFileSlot.Param<param::FilePathParam>()->Value());
+    std::ofstream file(filename.PeekBuffer(), std::ios::out | std::ios::trunc);
+
+    if (!file.good()) {
+        Log::DefaultLog.WriteError("[RenderBenchmark] Unable to open output file \"%s\"", filename.PeekBuffer());
+        return false;
+    }
+
+    if (this->outputFormatSlot.Param<param::EnumParam>()->Value() == 0) {
+        file << "data,width,height,mode,camera_time,frames,gpu_mean_ms,gpu_median_ms,gpu_min_ms,gpu_max_ms,upload_mb"
+             << std::endl;
+
+        for (const auto& result : results) {
+            file << "\"" << result.data << "\"," << result.width << "," << result.height << "," << result.mode << ","
+                 << result.cameraTime << "," << result.frames << "," << result.gpuMean << "," << result.gpuMedian << ","
+                 << result.gpuMin << "," << result.gpuMax << "," << result.uploadMB << std::endl;
+        }
+    } else {
+        file << "{" << std::endl << "  \"best_mode\": \"" << bestMode << "\"," << std::endl << "  \"results\": [";
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& result = results[i];
+
+            file << ((i == 0) ? "" : ",") << std::endl
+                 << "    { \"data\": \"" << result.data << "\", \"width\": " << result.width
+                 << ", \"height\": " << result.height << ", \"mode\": \"" << result.mode
+                 << "\", \"camera_time\": " << result.cameraTime << ", \"frames\": " << result.frames
+                 << ", \"gpu_mean_ms\": " << result.gpuMean << ", \"gpu_median_ms\": " << result.gpuMedian
+                 << ", \"gpu_min_ms\": " << result.gpuMin << ", \"gpu_max_ms\": " << result.gpuMax
+                 << ", \"upload_mb\": " << result.uploadMB << " }";
+        }
+
+        file << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+
+    Log::DefaultLog.WriteInfo("[RenderBenchmark] Results written to \"%s\"", filename.PeekBuffer());
+
+    return true;
+}
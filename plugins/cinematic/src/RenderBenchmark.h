@@ -0,0 +1,213 @@
+/*
+ * RenderBenchmark.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_CINEMATIC_RENDERBENCHMARK_H_INCLUDED
+#define MEGAMOL_CINEMATIC_RENDERBENCHMARK_H_INCLUDED
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractJob.h"
+#include "mmcore/param/ParamSlot.h"
+#include "mmcore/view/AbstractView.h"
+
+#include "vislib/String.h"
+
+#include <string>
+#include <vector>
+
+
+namespace megamol {
+namespace cinematic {
+
+    /**
+     * Job module benchmarking the render modes of a renderer, e.g. the SphereRenderer.
+     *
+     * The render mode parameter of the renderer is swept over all or the selected modes, for multiple
+     * data set sizes (by setting a parameter of the data source, e.g. the particle count of a generator
+     * or the file name of a MMPLD file), off-screen resolutions and camera positions along the tracking
+     * shot of a keyframe keeper. For each configuration, the GPU time of the frames is measured with
+     * timer queries, and the uploaded data is read from a statistics parameter of the renderer. The
+     * results are written as CSV or JSON, and the fastest mode is optionally applied to the renderer.
+     */
+    class RenderBenchmark : public core::job::AbstractJob, public core::Module,
+        public core::view::AbstractView::Hooks {
+    public:
+
+        /**
+         * Answer the name of this module.
+         *
+         * @return The name of this module.
+         */
+        static const char *ClassName(void) { return "RenderBenchmark"; }
+
+        /**
+         * Answer a human readable description of this module.
+         *
+         * @return A human readable description of this module.
+         */
+        static const char *Description(void) {
+            return "Job module measuring the frame times of the render modes of a renderer";
+        }
+
+        /**
+         * Answers whether this module is available on the current system.
+         *
+         * @return 'true' if the module is available, 'false' otherwise.
+         */
+        static bool IsAvailable(void) { return true; }
+
+        /**
+         * Disallow usage in quickstarts
+         *
+         * @return false
+         */
+        static bool SupportQuickstart(void) { return false; }
+
+        /** Ctor. */
+        RenderBenchmark(void);
+
+        /** Dtor. */
+        virtual ~RenderBenchmark(void);
+
+        /**
+         * Answers whether or not this job is still running.
+         *
+         * @return 'true' if this job is still running, 'false' if it has
+         *         finished.
+         */
+        virtual bool IsRunning(void) const;
+
+        /**
+         * Starts the job, running the benchmark in the next frame of the view.
+         *
+         * @return true if the job has been successfully started.
+         */
+        virtual bool Start(void);
+
+        /**
+         * Terminates the job.
+         *
+         * @return true to acknowledge that the job will finish as soon
+         *         as possible, false if termination is not possible.
+         */
+        virtual bool Terminate(void);
+
+    protected:
+
+        /**
+         * Implementation of 'Create'.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        virtual bool create(void);
+
+        /**
+         * Implementation of 'Release'.
+         */
+        virtual void release(void);
+
+        /**
+         * Hook method to be called before the view is rendered, running the whole benchmark.
+         *
+         * @param view The calling view
+         */
+        virtual void BeforeRender(core::view::AbstractView *view);
+
+    private:
+
+        /** Measurements of one configuration */
+        struct Result {
+            std::string data;
+            int width, height;
+            std::string mode;
+            float cameraTime;
+            unsigned int frames;
+            double gpuMean, gpuMedian, gpuMin, gpuMax;
+            double uploadMB;
+        };
+
+        /**
+         * Registers the benchmark as hook of the view, triggered by clicking on the trigger button.
+         *
+         * @param slot Must be the triggerButtonSlot
+         */
+        bool triggerButtonClicked(core::param::ParamSlot& slot);
+
+        /**
+         * Find a parameter by its full name.
+         *
+         * @param name Full name of the parameter
+         *
+         * @return The parameter slot, or nullptr if not found
+         */
+        core::param::ParamSlot* findParam(const vislib::StringA& name);
+
+        /**
+         * Split a list of values separated by ';', dropping empty entries.
+         *
+         * @param list The list of values
+         *
+         * @return The separate values
+         */
+        static std::vector<std::string> split(const vislib::StringA& list);
+
+        /**
+         * Write the results to the output file.
+         *
+         * @param results  The measurements of all configurations
+         * @param bestMode Name of the mode with the lowest mean frame time
+         *
+         * @return 'true' on success, 'false' otherwise
+         */
+        bool writeResults(const std::vector<Result>& results, const std::string& bestMode) const;
+
+        /** The name of the view instance to be benchmarked */
+        core::param::ParamSlot viewNameSlot;
+
+        /** Render modes to benchmark */
+        core::param::ParamSlot modeParamNameSlot;
+        core::param::ParamSlot modesSlot;
+
+        /** Data set sizes to benchmark */
+        core::param::ParamSlot dataParamNameSlot;
+        core::param::ParamSlot dataValuesSlot;
+
+        /** Off-screen resolutions to benchmark */
+        core::param::ParamSlot resolutionsSlot;
+
+        /** Number of camera positions sampled along the tracking shot */
+        core::param::ParamSlot cameraStepsSlot;
+
+        /** Frames per configuration */
+        core::param::ParamSlot warmupFramesSlot;
+        core::param::ParamSlot framesSlot;
+
+        /** Parameter of the renderer reporting the uploaded MB of the last frame */
+        core::param::ParamSlot uploadParamNameSlot;
+
+        /** Output of the results */
+        core::param::ParamSlot outputFileSlot;
+        core::param::ParamSlot outputFormatSlot;
+
+        /** Apply the fastest mode after the benchmark */
+        core::param::ParamSlot applyBestModeSlot;
+
+        /** The trigger button */
+        core::param::ParamSlot triggerButtonSlot;
+
+        /** Caller slot to the keyframe keeper providing the camera path */
+        core::CallerSlot keyframeKeeperSlot;
+
+        /** A simple running flag */
+        bool running;
+
+    };
+
+} /* end namespace cinematic */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_CINEMATIC_RENDERBENCHMARK_H_INCLUDED */
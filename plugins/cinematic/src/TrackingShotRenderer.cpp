@@ -35,6 +35,9 @@ TrackingShotRenderer::TrackingShotRenderer(void) : Renderer3DModule_2(),
     manipulator(), 
     manipulatorGrabbed(false),
     textureShader(),
+    splineVbo(0),
+    splineVboCount(0),
+    splineVboHash(0),
     fbo(),
     mouseX(0.0f),
     mouseY(0.0f)
@@ -118,6 +121,11 @@ void TrackingShotRenderer::release(void) {
 
     this->textureShader.Release();
 
+    if (this->splineVbo != 0) {
+        glDeleteBuffers(1, &this->splineVbo);
+        this->splineVbo = 0;
+    }
+
     if (this->fbo.IsEnabled()) {
         this->fbo.Disable();
     }
@@ -396,13 +404,24 @@ bool TrackingShotRenderer::Render(megamol::core::view::CallRender3D_2& call) {
     }
 
     // Draw spline    
+    if ((this->splineVbo == 0) || (this->splineVboHash != ccc->getInterpolCamPositionsHash())) {
+        if (this->splineVbo == 0) {
+            glGenBuffers(1, &this->splineVbo);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, this->splineVbo);
+        glBufferData(GL_ARRAY_BUFFER, interpolKeyframes->size() * sizeof(glm::vec3), interpolKeyframes->data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->splineVboCount = static_cast<GLsizei>(interpolKeyframes->size());
+        this->splineVboHash = ccc->getInterpolCamPositionsHash();
+    }
     glColor4fv(sColor);
     glLineWidth(2.0f);
-    glBegin(GL_LINE_STRIP);
-    for (unsigned int i = 0; i < interpolKeyframes->size(); i++) {
-        glVertex3fv(glm::value_ptr(interpolKeyframes->operator[](i)));
-    }
-    glEnd();
+    glBindBuffer(GL_ARRAY_BUFFER, this->splineVbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glDrawArrays(GL_LINE_STRIP, 0, this->splineVboCount);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // DRAW MENU --------------------------------------------------------------
     glDisable(GL_DEPTH_TEST);
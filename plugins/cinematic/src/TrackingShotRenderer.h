@@ -162,6 +162,11 @@ namespace cinematic {
         /** The render to texture shader */
         vislib::graphics::gl::GLSLShader textureShader;
 
+        /** The spline, only uploaded again when the interpolated camera positions change */
+        GLuint                           splineVbo;
+        GLsizei                          splineVboCount;
+        SIZE_T                           splineVboHash;
+
         bool isSelecting;
 
         /*** INPUT ***/
@@ -18,9 +18,21 @@ uniform float k_diffuse;
 uniform float k_specular;
 uniform float shininess;
 
+uniform float light_cutoff;
+
+uniform mat4 view_mx;
 uniform mat4 inv_view_mx;
 uniform mat4 inv_proj_mx;
 
+// Each work group shades one screen tile, with the point lights culled against the depth range of the tile
+#define TILE_SIZE 16
+#define MAX_TILE_LIGHTS 256
+
+shared uint tile_min_depth;
+shared uint tile_max_depth;
+shared uint tile_light_cnt;
+shared uint tile_lights[MAX_TILE_LIGHTS];
+
 
 vec3 depthToWorldPos(float depth, vec2 uv) {
     float z = depth * 2.0 - 1.0;
@@ -36,6 +48,17 @@ vec3 depthToWorldPos(float depth, vec2 uv) {
     return ws_pos.xyz;
 }
 
+vec3 ndcToViewPos(vec3 ndc) {
+    vec4 vs_pos = inv_proj_mx * vec4(ndc, 1.0);
+    return vs_pos.xyz / vs_pos.w;
+}
+
+// Squared distance of a point to an axis aligned box
+float distanceToBox(vec3 p, vec3 box_min, vec3 box_max) {
+    vec3 d = max(vec3(0.0), max(box_min - p, p - box_max));
+    return dot(d, d);
+}
+
 float lambert(vec3 light_dir, vec3 normal) { return clamp(dot(normal, light_dir), 0.0, 1.0); }
 
 float specular(vec3 light_dir, vec3 normal) {
@@ -46,16 +69,24 @@ float specular(vec3 light_dir, vec3 normal) {
 }
 
 
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+vec2 pointLight(int i, vec3 world_pos, vec3 normal) {
+    vec3 light_dir = vec3(point_light_params[i].x, point_light_params[i].y, point_light_params[i].z) - world_pos;
+    float d = length(light_dir);
+    light_dir = normalize(light_dir);
+    return vec2(k_diffuse * lambert(light_dir, normal), k_specular * specular(light_dir, normal)) *
+           point_light_params[i].intensity * (1.0 / (d * d));
+}
+
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE, local_size_z = 1) in;
 
 void main() {
     uvec3 gID = gl_GlobalInvocationID.xyz;
     ivec2 pixel_coords = ivec2(gID.xy);
     ivec2 tgt_resolution = imageSize(tgt_tx2D);
 
-    if (pixel_coords.x >= tgt_resolution.x || pixel_coords.y >= tgt_resolution.y) {
-        return;
-    }
+    // No early return for pixels outside of the target, as all invocations take part in the culling
+    bool inside = pixel_coords.x < tgt_resolution.x && pixel_coords.y < tgt_resolution.y;
 
     vec2 pixel_coords_norm = (vec2(pixel_coords) + vec2(0.5)) / vec2(tgt_resolution);
 
@@ -63,24 +94,86 @@ void main() {
     vec3 normal = texture(normal_tx2D, pixel_coords_norm).rgb;
     float depth = texture(depth_tx2D, pixel_coords_norm).r;
 
+    bool lit = inside && depth > 0.0f && depth < 1.0f;
+
+    // Depth range of the tile, where the bits of positive floats compare like the values
+    if (gl_LocalInvocationIndex == 0) {
+        tile_min_depth = floatBitsToUint(1.0);
+        tile_max_depth = 0u;
+        tile_light_cnt = 0u;
+    }
+    barrier();
+
+    if (lit) {
+        atomicMin(tile_min_depth, floatBitsToUint(depth));
+        atomicMax(tile_max_depth, floatBitsToUint(depth));
+    }
+    barrier();
+
+    float min_depth = uintBitsToFloat(tile_min_depth);
+    float max_depth = uintBitsToFloat(tile_max_depth);
+
+    // Cull the point lights against the view space bounding box of the tile. Without cutoff, the lights
+    // reach infinitely far and all of them are kept.
+    if (min_depth <= max_depth) {
+        vec2 tile_min = vec2(gl_WorkGroupID.xy * TILE_SIZE) / vec2(tgt_resolution) * 2.0 - 1.0;
+        vec2 tile_max = vec2((gl_WorkGroupID.xy + 1) * TILE_SIZE) / vec2(tgt_resolution) * 2.0 - 1.0;
+
+        vec3 box_min = vec3(1.0e30);
+        vec3 box_max = vec3(-1.0e30);
+        for (int c = 0; c < 8; ++c) {
+            vec3 ndc = vec3((c & 1) == 0 ? tile_min.x : tile_max.x, (c & 2) == 0 ? tile_min.y : tile_max.y,
+                ((c & 4) == 0 ? min_depth : max_depth) * 2.0 - 1.0);
+            vec3 corner = ndcToViewPos(ndc);
+            box_min = min(box_min, corner);
+            box_max = max(box_max, corner);
+        }
+
+        for (uint i = gl_LocalInvocationIndex; i < uint(point_light_cnt); i += TILE_SIZE * TILE_SIZE) {
+            bool affects = light_cutoff <= 0.0;
+
+            if (!affects) {
+                vec3 light_pos = (view_mx * vec4(point_light_params[i].x, point_light_params[i].y,
+                                                point_light_params[i].z, 1.0)).xyz;
+                float radius_sq = abs(point_light_params[i].intensity) / light_cutoff;
+                affects = distanceToBox(light_pos, box_min, box_max) <= radius_sq;
+            }
+
+            if (affects) {
+                uint idx = atomicAdd(tile_light_cnt, 1u);
+                if (idx < MAX_TILE_LIGHTS) {
+                    tile_lights[idx] = i;
+                }
+            }
+        }
+    }
+    barrier();
+
+    if (!inside) {
+        return;
+    }
+
     vec4 retval = albedo;
 
-    if (depth > 0.0f && depth < 1.0f) {
+    if (lit) {
         vec3 world_pos = depthToWorldPos(depth, pixel_coords_norm);
 
-        float reflected_light = 0.0;
-        float specular_light = 0.0;
-        for (int i = 0; i < point_light_cnt; ++i) {
-            vec3 light_dir =
-                vec3(point_light_params[i].x, point_light_params[i].y, point_light_params[i].z) - world_pos;
-            float d = length(light_dir);
-            light_dir = normalize(light_dir);
-            reflected_light +=
-                k_diffuse * lambert(light_dir, normal) * point_light_params[i].intensity * (1.0 / (d * d));
-            specular_light +=
-                k_specular * specular(light_dir, normal) * point_light_params[i].intensity * (1.0 / (d * d));
+        vec2 light = vec2(0.0);
+
+        // Fall back to all lights if the list of the tile overflowed
+        if (tile_light_cnt <= MAX_TILE_LIGHTS) {
+            for (uint j = 0; j < tile_light_cnt; ++j) {
+                light += pointLight(int(tile_lights[j]), world_pos, normal);
+            }
+        } else {
+            for (int i = 0; i < point_light_cnt; ++i) {
+                light += pointLight(i, world_pos, normal);
+            }
         }
 
+        float reflected_light = light.x;
+        float specular_light = light.y;
+
         for (int i = 0; i < distant_light_cnt; ++i) {
             vec3 light_dir = vec3(distant_light_params[i].x, distant_light_params[i].y, distant_light_params[i].z);
             reflected_light += lambert(light_dir, normal) * distant_light_params[i].intensity;
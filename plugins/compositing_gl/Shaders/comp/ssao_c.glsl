@@ -7,6 +7,7 @@ struct Samples
 layout(std430, binding = 1) readonly buffer SamplesBuffer { Samples samples[]; };
 uniform int sample_cnt;
 uniform float radius;
+uniform int frame_idx;
 
 uniform sampler2D normal_tx2D;
 uniform sampler2D depth_tx2D;
@@ -55,6 +56,10 @@ void main()
     float depth    = texture(depth_tx2D, pixel_coords_norm).r;
     vec3 rand_vec  = texture(noise_tx2D, pixel_coords_norm * noise_scale).xyz;
 
+    // rotate the kernel by the golden angle in each frame, so that accumulated frames use different samples
+    float angle = 2.39996 * float(frame_idx);
+    rand_vec.xy = mat2(cos(angle), sin(angle), -sin(angle), cos(angle)) * rand_vec.xy;
+
     vec3 view_pos = depthToViewPos(depth,pixel_coords_norm);
 
     normal = transpose(mat3(inv_view_mx)) * normal; // transform normal to view space
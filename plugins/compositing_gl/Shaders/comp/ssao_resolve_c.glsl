@@ -0,0 +1,114 @@
+
+uniform sampler2D ao_tx2D;
+uniform sampler2D depth_tx2D;
+uniform sampler2D history_tx2D;
+
+uniform int max_frames;
+uniform int reset_history;
+
+// accumulated occlusion, number of accumulated frames and view space depth, for the next frame
+layout(rgba16f) writeonly uniform image2D history_tgt_tx2D;
+layout(rgba16f) writeonly uniform image2D tgt_tx2D;
+
+uniform mat4 inv_view_mx;
+uniform mat4 inv_proj_mx;
+uniform mat4 prev_view_mx;
+uniform mat4 prev_proj_mx;
+
+
+vec3 depthToViewPos(float depth, vec2 uv) {
+    float z = depth * 2.0 - 1.0;
+
+    vec4 cs_pos = vec4(uv * 2.0 - 1.0, z, 1.0);
+    vec4 vs_pos = inv_proj_mx * cs_pos;
+
+    // Perspective division
+    vs_pos /= vs_pos.w;
+
+    return vs_pos.xyz;
+}
+
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+// Upsamples the (reduced resolution) ssao result and accumulates it with the reprojected result of the last frames
+void main()
+{
+    uvec3 gID = gl_GlobalInvocationID.xyz;
+    ivec2 pixel_coords = ivec2(gID.xy);
+    ivec2 tgt_resolution = imageSize (tgt_tx2D);
+
+    if (pixel_coords.x >= tgt_resolution.x || pixel_coords.y >= tgt_resolution.y) {
+        return;
+    }
+
+    vec2 pixel_coords_norm = (vec2(pixel_coords) + vec2(0.5)) / vec2(tgt_resolution);
+
+    float depth = texture(depth_tx2D, pixel_coords_norm).r;
+
+    if (depth <= 0.0) {
+        float occlusion = texture(ao_tx2D, pixel_coords_norm).r;
+        imageStore(history_tgt_tx2D, pixel_coords, vec4(occlusion, 0.0, 0.0, 1.0));
+        imageStore(tgt_tx2D, pixel_coords, vec4(occlusion, occlusion, occlusion, 1.0));
+        return;
+    }
+
+    vec3 view_pos = depthToViewPos(depth, pixel_coords_norm);
+
+    // bilateral upsampling, i.e. bilinear weights damped by the depth difference of the low resolution texels
+    ivec2 ao_resolution = textureSize(ao_tx2D, 0);
+    vec2 ao_coords = pixel_coords_norm * vec2(ao_resolution) - vec2(0.5);
+    ivec2 ao_base = ivec2(floor(ao_coords));
+    vec2 ao_frac = ao_coords - vec2(ao_base);
+
+    float occlusion_sum = 0.0;
+    float weight_sum = 0.0;
+
+    for (int y = 0; y < 2; ++y)
+    {
+        for (int x = 0; x < 2; ++x)
+        {
+            ivec2 texel = clamp(ao_base + ivec2(x, y), ivec2(0), ao_resolution - ivec2(1));
+            vec2 texel_norm = (vec2(texel) + vec2(0.5)) / vec2(ao_resolution);
+
+            float texel_z = depthToViewPos(texture(depth_tx2D, texel_norm).r, texel_norm).z;
+            float depth_diff = abs(view_pos.z - texel_z) / max(abs(view_pos.z), 0.0001);
+
+            float weight = (x == 0 ? 1.0 - ao_frac.x : ao_frac.x) * (y == 0 ? 1.0 - ao_frac.y : ao_frac.y);
+            weight *= 1.0 / (0.001 + depth_diff);
+
+            occlusion_sum += weight * texelFetch(ao_tx2D, texel, 0).r;
+            weight_sum += weight;
+        }
+    }
+
+    float occlusion = weight_sum > 0.0 ? occlusion_sum / weight_sum : texture(ao_tx2D, pixel_coords_norm).r;
+    float frame_cnt = 1.0;
+
+    // temporal accumulation, if the surface was already visible at the reprojected position in the last frame
+    if (reset_history == 0)
+    {
+        vec4 world_pos = inv_view_mx * vec4(view_pos, 1.0);
+        vec4 prev_vs_pos = prev_view_mx * world_pos;
+        vec4 prev_cs_pos = prev_proj_mx * prev_vs_pos;
+
+        if (prev_cs_pos.w > 0.0)
+        {
+            vec2 prev_coords_norm = prev_cs_pos.xy / prev_cs_pos.w * 0.5 + 0.5;
+
+            if (all(greaterThanEqual(prev_coords_norm, vec2(0.0))) && all(lessThan(prev_coords_norm, vec2(1.0))))
+            {
+                vec4 history = texelFetch(history_tx2D, ivec2(prev_coords_norm * vec2(tgt_resolution)), 0);
+
+                if (history.g > 0.0 && abs(history.b - prev_vs_pos.z) <= 0.01 * abs(prev_vs_pos.z))
+                {
+                    frame_cnt = min(history.g + 1.0, float(max_frames));
+                    occlusion = mix(history.r, occlusion, 1.0 / frame_cnt);
+                }
+            }
+        }
+    }
+
+    imageStore(history_tgt_tx2D, pixel_coords, vec4(occlusion, frame_cnt, view_pos.z, 1.0));
+    imageStore(tgt_tx2D, pixel_coords, vec4(occlusion, occlusion, occlusion, 1.0));
+}
@@ -0,0 +1,48 @@
+/*
+ * InputHashes.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef INPUT_HASHES_H_INCLUDED
+#define INPUT_HASHES_H_INCLUDED
+
+#include <algorithm>
+#include <vector>
+
+namespace megamol {
+namespace compositing {
+
+/**
+ * Keeps track of the data hashes of the inputs of a compositing pass, so that the pass can be skipped
+ * if none of its inputs changed since its last run, e.g. if its output is requested by several modules
+ * within the same frame. A hash of zero is unknown, as set by modules that do not track changes of their
+ * output, and always counts as a change.
+ */
+class InputHashes {
+public:
+    /**
+     * Answer whether the pass has to run, and remember the hashes for the next call.
+     *
+     * @param hashes The current data hashes of the inputs
+     * @param force Whether the pass has to run anyway, e.g. because a parameter changed
+     *
+     * @return 'true' if the pass has to run, 'false' if its last output is still valid
+     */
+    bool changed(std::vector<size_t> const& hashes, bool force) {
+        const bool changed =
+            force || hashes != m_hashes || std::find(hashes.begin(), hashes.end(), 0) != hashes.end();
+        m_hashes = hashes;
+        return changed;
+    }
+
+private:
+    /** Hashes of the inputs at the last run of the pass */
+    std::vector<size_t> m_hashes;
+};
+
+} // namespace compositing
+} // namespace megamol
+
+#endif // !INPUT_HASHES_H_INCLUDED
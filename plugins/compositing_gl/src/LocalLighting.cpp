@@ -11,11 +11,14 @@
 megamol::compositing::LocalLighting::LocalLighting() 
     : core::Module()
     , m_output_texture(nullptr)
+    , m_output_texture_hash(0)
     , m_point_lights_buffer(nullptr)
     , m_distant_lights_buffer(nullptr)
     , m_diffuse("m_diffuse", "Diffuse part for Blinn-Phong lighting")
     , m_specular("m_specular", "Specular part for Blinn-Phong lighting")
     , m_shininess("m_shininess", "Shininess for specular lighting")
+    , m_light_cutoff("m_light_cutoff", "Attenuated intensity below which point lights are culled per screen tile, "
+                                       "zero disables culling")
     , m_output_tex_slot("OutputTexture", "Gives access to resulting output texture")
     , m_albedo_tex_slot("AlbedoTexture", "Connect to the albedo render target texture")
     , m_normal_tex_slot("NormalTexture", "Connects to the normals render target texture")
@@ -33,6 +36,9 @@ megamol::compositing::LocalLighting::LocalLighting()
     this->m_shininess << new core::param::FloatParam(16.0f, 0.0f);
     this->MakeSlotAvailable(&this->m_shininess);
 
+    this->m_light_cutoff << new core::param::FloatParam(1.0f / 256.0f, 0.0f);
+    this->MakeSlotAvailable(&this->m_light_cutoff);
+
     this->m_output_tex_slot.SetCallback(CallTexture2D::ClassName(), "GetData", &LocalLighting::getDataCallback);
     this->m_output_tex_slot.SetCallback(CallTexture2D::ClassName(), "GetMetaData", &LocalLighting::getMetaDataCallback);
     this->MakeSlotAvailable(&this->m_output_tex_slot);
@@ -143,6 +149,25 @@ bool megamol::compositing::LocalLighting::getDataCallback(core::Call& caller) {
 
     auto light_update = this->GetLights();
 
+    // skip the pass if neither the inputs, the lights nor the parameters changed since its last run
+    const bool params_dirty = this->m_diffuse.IsDirty() || this->m_specular.IsDirty() ||
+                              this->m_shininess.IsDirty() || this->m_light_cutoff.IsDirty();
+    this->m_diffuse.ResetDirty();
+    this->m_specular.ResetDirty();
+    this->m_shininess.ResetDirty();
+    this->m_light_cutoff.ResetDirty();
+
+    core::BasicMetaData meta_data;
+    if (!m_input_hashes.changed({call_albedo->getMetaData().m_data_hash, call_normal->getMetaData().m_data_hash,
+                                    call_depth->getMetaData().m_data_hash, call_camera->getMetaData().m_data_hash},
+            light_update || params_dirty)) {
+        meta_data.m_data_hash = m_output_texture_hash;
+        lhs_tc->setMetaData(meta_data);
+        return true;
+    }
+    meta_data.m_data_hash = ++m_output_texture_hash;
+    lhs_tc->setMetaData(meta_data);
+
     this->m_point_lights.clear();
     this->m_distant_lights.clear();
     for (const auto element : this->m_light_map) {
@@ -181,6 +206,8 @@ bool megamol::compositing::LocalLighting::getDataCallback(core::Call& caller) {
             this->m_specular.Param<core::param::FloatParam>()->Value());
         glUniform1f(m_lighting_prgm->ParameterLocation("shininess"),
             this->m_shininess.Param<core::param::FloatParam>()->Value());
+        glUniform1f(m_lighting_prgm->ParameterLocation("light_cutoff"),
+            this->m_light_cutoff.Param<core::param::FloatParam>()->Value());
 
         glActiveTexture(GL_TEXTURE0);
         albedo_tx2D->bindTexture();
@@ -198,11 +225,13 @@ bool megamol::compositing::LocalLighting::getDataCallback(core::Call& caller) {
         auto inv_proj_mx = glm::inverse(proj_mx);
         glUniformMatrix4fv(m_lighting_prgm->ParameterLocation("inv_view_mx"), 1, GL_FALSE, glm::value_ptr(inv_view_mx));
         glUniformMatrix4fv(m_lighting_prgm->ParameterLocation("inv_proj_mx"), 1, GL_FALSE, glm::value_ptr(inv_proj_mx));
+        glUniformMatrix4fv(m_lighting_prgm->ParameterLocation("view_mx"), 1, GL_FALSE, glm::value_ptr(view_mx));
 
         m_output_texture->bindImage(0, GL_WRITE_ONLY);
 
-        m_lighting_prgm->Dispatch(static_cast<int>(std::ceil(std::get<0>(texture_res) / 8.0f)),
-            static_cast<int>(std::ceil(std::get<1>(texture_res) / 8.0f)), 1);
+        // one work group per 16x16 tile, which culls the point lights before shading
+        m_lighting_prgm->Dispatch(static_cast<int>(std::ceil(std::get<0>(texture_res) / 16.0f)),
+            static_cast<int>(std::ceil(std::get<1>(texture_res) / 16.0f)), 1);
 
         m_lighting_prgm->Disable();
     }
@@ -20,6 +20,8 @@
 #include "glowl/BufferObject.hpp"
 #include "glowl/Texture2D.hpp"
 
+#include "InputHashes.h"
+
 namespace megamol {
 namespace compositing {
 
@@ -94,6 +96,12 @@ private:
     /** Texture that the lighting result will be written to */
     std::shared_ptr<glowl::Texture2D> m_output_texture;
 
+    /** Hash value to keep track of update to the output texture */
+    size_t m_output_texture_hash;
+
+    /** Hashes of the input textures and camera at the last lighting pass */
+    InputHashes m_input_hashes;
+
     /** GPU buffer object for making active (point)lights available in during shading pass */
     std::unique_ptr<glowl::BufferObject> m_point_lights_buffer;
 
@@ -118,6 +126,9 @@ private:
     /** Slot for setting specular shininess of Blinn-Phong */
     megamol::core::param::ParamSlot m_shininess;
 
+    /** Slot for setting the attenuated intensity below which point lights are culled per screen tile */
+    megamol::core::param::ParamSlot m_light_cutoff;
+
     /** Slot for requesting the output textures from this module, i.e. lhs connection */
     megamol::core::CalleeSlot m_output_tex_slot;
 
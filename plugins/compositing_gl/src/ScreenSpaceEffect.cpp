@@ -19,9 +19,16 @@ megamol::compositing::ScreenSpaceEffect::ScreenSpaceEffect()
     : core::Module()
     , m_output_texture(nullptr)
     , m_output_texture_hash(0)
+    , m_ssao_history_idx(0)
+    , m_ssao_history_valid(false)
+    , m_ssao_frame_idx(0)
+    , m_ssao_static_frames(0)
     , m_mode("Mode", "Sets screen space effect mode, e.g. ssao, fxaa...")
     , m_ssao_radius("SSAO Radius", "Sets radius for SSAO")
     , m_ssao_sample_cnt("SSAO Samples", "Sets the number of samples used SSAO")
+    , m_ssao_resolution("SSAO Resolution", "Sets the resolution SSAO is computed at, relative to the inputs")
+    , m_ssao_frames("SSAO Frames", "Sets the number of frames SSAO is accumulated over. With an unchanged camera, "
+                                   "SSAO is not updated after that many frames, 1 disables the accumulation")
     , m_output_tex_slot("OutputTexture", "Gives access to resulting output texture")
     , m_input_tex_slot("InputTexture", "Connects an optional input texture")
     , m_normals_tex_slot("NormalTexture", "Connects the normals render target texture")
@@ -38,6 +45,15 @@ megamol::compositing::ScreenSpaceEffect::ScreenSpaceEffect()
     this->m_ssao_radius << new megamol::core::param::FloatParam(0.5f, 0.0f);
     this->MakeSlotAvailable(&this->m_ssao_radius);
 
+    this->m_ssao_resolution << new megamol::core::param::EnumParam(2);
+    this->m_ssao_resolution.Param<megamol::core::param::EnumParam>()->SetTypePair(1, "Full");
+    this->m_ssao_resolution.Param<megamol::core::param::EnumParam>()->SetTypePair(2, "Half");
+    this->m_ssao_resolution.Param<megamol::core::param::EnumParam>()->SetTypePair(4, "Quarter");
+    this->MakeSlotAvailable(&this->m_ssao_resolution);
+
+    this->m_ssao_frames << new megamol::core::param::IntParam(16, 1, 256);
+    this->MakeSlotAvailable(&this->m_ssao_frames);
+
     this->m_output_tex_slot.SetCallback(CallTexture2D::ClassName(), "GetData", &ScreenSpaceEffect::getDataCallback);
     this->m_output_tex_slot.SetCallback(
         CallTexture2D::ClassName(), "GetMetaData", &ScreenSpaceEffect::getMetaDataCallback);
@@ -63,10 +79,12 @@ bool megamol::compositing::ScreenSpaceEffect::create() {
         // create shader program
         m_ssao_prgm = std::make_unique<GLSLComputeShader>();
         m_ssao_blur_prgm = std::make_unique<GLSLComputeShader>();
+        m_ssao_resolve_prgm = std::make_unique<GLSLComputeShader>();
         m_fxaa_prgm = std::make_unique<GLSLComputeShader>();
 
         vislib::graphics::gl::ShaderSource compute_ssao_src;
         vislib::graphics::gl::ShaderSource compute_ssao_blur_src;
+        vislib::graphics::gl::ShaderSource compute_ssao_resolve_src;
         vislib::graphics::gl::ShaderSource compute_fxaa_src;
 
         if (!instance()->ShaderSourceFactory().MakeShaderSource("Compositing::ssao", compute_ssao_src)) return false;
@@ -78,6 +96,12 @@ bool megamol::compositing::ScreenSpaceEffect::create() {
         if (!m_ssao_blur_prgm->Compile(compute_ssao_blur_src.Code(), compute_ssao_blur_src.Count())) return false;
         if (!m_ssao_blur_prgm->Link()) return false;
 
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("Compositing::ssaoResolve", compute_ssao_resolve_src))
+            return false;
+        if (!m_ssao_resolve_prgm->Compile(compute_ssao_resolve_src.Code(), compute_ssao_resolve_src.Count()))
+            return false;
+        if (!m_ssao_resolve_prgm->Link()) return false;
+
         if (!instance()->ShaderSourceFactory().MakeShaderSource("Compositing::fxaa", compute_fxaa_src)) return false;
         if (!m_fxaa_prgm->Compile(compute_fxaa_src.Code(), compute_fxaa_src.Count())) return false;
         if (!m_fxaa_prgm->Link()) return false;
@@ -100,6 +124,9 @@ bool megamol::compositing::ScreenSpaceEffect::create() {
     glowl::TextureLayout tx_layout(GL_RGBA16F, 1, 1, 1, GL_RGBA, GL_HALF_FLOAT, 1);
     m_output_texture = std::make_shared<glowl::Texture2D>("screenspace_effect_output", tx_layout, nullptr);
     m_intermediate_texture = std::make_shared<glowl::Texture2D>("screenspace_effect_intermediate", tx_layout, nullptr);
+    m_ssao_blurred_texture = std::make_shared<glowl::Texture2D>("ssao_blurred", tx_layout, nullptr);
+    m_ssao_history_textures[0] = std::make_shared<glowl::Texture2D>("ssao_history_0", tx_layout, nullptr);
+    m_ssao_history_textures[1] = std::make_shared<glowl::Texture2D>("ssao_history_1", tx_layout, nullptr);
 
     // quick 'n dirty from https://learnopengl.com/Advanced-Lighting/SSAO
     std::uniform_real_distribution<float> randomFloats(0.0, 1.0); // random floats between 0.0 - 1.0
@@ -142,29 +169,52 @@ bool megamol::compositing::ScreenSpaceEffect::getDataCallback(core::Call& caller
 
     if (lhs_tc == NULL) return false;
 
-    // TODO check/update data hash
-
     if (lhs_tc->getData() == nullptr) {
         lhs_tc->setData(m_output_texture);
     }
 
-    std::function<void(std::shared_ptr<glowl::Texture2D> src, std::shared_ptr<glowl::Texture2D> tgt)>
-        setupOutputTexture = [](std::shared_ptr<glowl::Texture2D> src, std::shared_ptr<glowl::Texture2D> tgt) {
-            // set output texture size to primary input texture
-            std::array<float, 2> texture_res = {
-                static_cast<float>(src->getWidth()), static_cast<float>(src->getHeight())};
+    // skip the pass if neither the inputs nor the parameters changed since its last run
+    const bool params_dirty = this->m_mode.IsDirty() || this->m_ssao_radius.IsDirty() ||
+                              this->m_ssao_sample_cnt.IsDirty() || this->m_ssao_resolution.IsDirty() ||
+                              this->m_ssao_frames.IsDirty();
+    this->m_mode.ResetDirty();
+    this->m_ssao_radius.ResetDirty();
+    this->m_ssao_sample_cnt.ResetDirty();
+    this->m_ssao_resolution.ResetDirty();
+    this->m_ssao_frames.ResetDirty();
+
+    core::BasicMetaData meta_data;
+    auto unchanged = [&](bool changed) {
+        if (changed) {
+            ++m_output_texture_hash;
+        }
+        meta_data.m_data_hash = m_output_texture_hash;
+        lhs_tc->setMetaData(meta_data);
+        return !changed;
+    };
+
+    std::function<bool(std::shared_ptr<glowl::Texture2D> src, std::shared_ptr<glowl::Texture2D> tgt, int divisor)>
+        setupOutputTexture = [](std::shared_ptr<glowl::Texture2D> src, std::shared_ptr<glowl::Texture2D> tgt,
+                                 int divisor) {
+            // set output texture size to primary input texture, reduced by the given divisor
+            std::array<float, 2> texture_res = {std::ceil(src->getWidth() / static_cast<float>(divisor)),
+                std::ceil(src->getHeight() / static_cast<float>(divisor))};
 
             if (tgt->getWidth() != std::get<0>(texture_res) || tgt->getHeight() != std::get<1>(texture_res)) {
                 glowl::TextureLayout tx_layout(
                     GL_RGBA16F, std::get<0>(texture_res), std::get<1>(texture_res), 1, GL_RGBA, GL_HALF_FLOAT, 1);
                 tgt->reload(tx_layout, nullptr);
+                return true;
             }
+            return false;
         };
 
 
     if (this->m_mode.Param<core::param::EnumParam>()->Value() == 0) {
         m_ssao_radius.Param<core::param::FloatParam>()->SetGUIVisible(true);
         m_ssao_sample_cnt.Param<core::param::IntParam>()->SetGUIVisible(true);
+        m_ssao_resolution.Param<core::param::EnumParam>()->SetGUIVisible(true);
+        m_ssao_frames.Param<core::param::IntParam>()->SetGUIVisible(true);
 
         if (call_normal == NULL) return false;
         if (call_depth == NULL) return false;
@@ -177,9 +227,6 @@ bool megamol::compositing::ScreenSpaceEffect::getDataCallback(core::Call& caller
         auto normal_tx2D = call_normal->getData();
         auto depth_tx2D = call_depth->getData();
 
-        setupOutputTexture(normal_tx2D, m_intermediate_texture);
-        setupOutputTexture(normal_tx2D, m_output_texture);
-
         // obtain camera information
         core::view::Camera_2 cam = call_camera->getData();
         cam_type::snapshot_type snapshot;
@@ -188,12 +235,42 @@ bool megamol::compositing::ScreenSpaceEffect::getDataCallback(core::Call& caller
         glm::mat4 view_mx = view_tmp;
         glm::mat4 proj_mx = proj_tmp;
 
+        const int divisor = m_ssao_resolution.Param<core::param::EnumParam>()->Value();
+        const int max_frames = m_ssao_frames.Param<core::param::IntParam>()->Value();
+
+        bool resized = setupOutputTexture(normal_tx2D, m_intermediate_texture, divisor);
+        resized |= setupOutputTexture(normal_tx2D, m_ssao_blurred_texture, divisor);
+        resized |= setupOutputTexture(normal_tx2D, m_ssao_history_textures[0], 1);
+        resized |= setupOutputTexture(normal_tx2D, m_ssao_history_textures[1], 1);
+        resized |= setupOutputTexture(normal_tx2D, m_output_texture, 1);
+
+        const bool reset_history = params_dirty || resized || !m_ssao_history_valid;
+        const bool camera_static = !reset_history && view_mx == m_ssao_prev_view_mx && proj_mx == m_ssao_prev_proj_mx;
+
+        if (!camera_static) {
+            m_ssao_static_frames = 0;
+        }
+
+        // without accumulation, only recompute on changed inputs; with accumulation, keep refining the result until
+        // it has converged for an unchanged camera, and stop working afterwards
+        const bool inputs_changed = m_input_hashes.changed({call_normal->getMetaData().m_data_hash,
+                                                               call_depth->getMetaData().m_data_hash,
+                                                               call_camera->getMetaData().m_data_hash},
+            params_dirty);
+        const bool converged = camera_static && m_ssao_static_frames >= max_frames;
+
+        if (unchanged(max_frames > 1 ? !converged : inputs_changed)) {
+            return true;
+        }
+
+        // ssao at reduced resolution
         m_ssao_prgm->Enable();
 
         m_ssao_samples->bind(1);
 
         glUniform1f(m_ssao_prgm->ParameterLocation("radius"), m_ssao_radius.Param<core::param::FloatParam>()->Value());
         glUniform1i(m_ssao_prgm->ParameterLocation("sample_cnt"), m_ssao_sample_cnt.Param<core::param::IntParam>()->Value());
+        glUniform1i(m_ssao_prgm->ParameterLocation("frame_idx"), max_frames > 1 ? m_ssao_frame_idx : 0);
 
         glActiveTexture(GL_TEXTURE0);
         normal_tx2D->bindTexture();
@@ -215,36 +292,91 @@ bool megamol::compositing::ScreenSpaceEffect::getDataCallback(core::Call& caller
 
         m_intermediate_texture->bindImage(0, GL_WRITE_ONLY);
 
-        m_ssao_prgm->Dispatch(static_cast<int>(std::ceil(m_output_texture->getWidth() / 8.0f)),
-            static_cast<int>(std::ceil(m_output_texture->getHeight() / 8.0f)), 1);
+        m_ssao_prgm->Dispatch(static_cast<int>(std::ceil(m_intermediate_texture->getWidth() / 8.0f)),
+            static_cast<int>(std::ceil(m_intermediate_texture->getHeight() / 8.0f)), 1);
 
         m_ssao_prgm->Disable();
 
         glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
 
+        // blur, also at reduced resolution
         m_ssao_blur_prgm->Enable();
 
         glActiveTexture(GL_TEXTURE0);
         m_intermediate_texture->bindTexture();
-        glUniform1i(m_ssao_prgm->ParameterLocation("src_tx2D"), 0);
+        glUniform1i(m_ssao_blur_prgm->ParameterLocation("src_tx2D"), 0);
 
-        m_output_texture->bindImage(0, GL_WRITE_ONLY);
+        m_ssao_blurred_texture->bindImage(0, GL_WRITE_ONLY);
 
-        m_ssao_blur_prgm->Dispatch(static_cast<int>(std::ceil(m_output_texture->getWidth() / 8.0f)),
-            static_cast<int>(std::ceil(m_output_texture->getHeight() / 8.0f)), 1);
+        m_ssao_blur_prgm->Dispatch(static_cast<int>(std::ceil(m_ssao_blurred_texture->getWidth() / 8.0f)),
+            static_cast<int>(std::ceil(m_ssao_blurred_texture->getHeight() / 8.0f)), 1);
 
         m_ssao_blur_prgm->Disable();
 
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        // bilateral upsampling and accumulation with the reprojected result of the last frame
+        const int history_idx = 1 - m_ssao_history_idx;
+
+        m_ssao_resolve_prgm->Enable();
+
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("max_frames"), max_frames);
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("reset_history"), reset_history ? 1 : 0);
+
+        glActiveTexture(GL_TEXTURE0);
+        m_ssao_blurred_texture->bindTexture();
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("ao_tx2D"), 0);
+        glActiveTexture(GL_TEXTURE1);
+        depth_tx2D->bindTexture();
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("depth_tx2D"), 1);
+        glActiveTexture(GL_TEXTURE2);
+        m_ssao_history_textures[m_ssao_history_idx]->bindTexture();
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("history_tx2D"), 2);
+
+        glUniformMatrix4fv(
+            m_ssao_resolve_prgm->ParameterLocation("inv_view_mx"), 1, GL_FALSE, glm::value_ptr(inv_view_mx));
+        glUniformMatrix4fv(
+            m_ssao_resolve_prgm->ParameterLocation("inv_proj_mx"), 1, GL_FALSE, glm::value_ptr(inv_proj_mx));
+        glUniformMatrix4fv(
+            m_ssao_resolve_prgm->ParameterLocation("prev_view_mx"), 1, GL_FALSE, glm::value_ptr(m_ssao_prev_view_mx));
+        glUniformMatrix4fv(
+            m_ssao_resolve_prgm->ParameterLocation("prev_proj_mx"), 1, GL_FALSE, glm::value_ptr(m_ssao_prev_proj_mx));
+
+        m_ssao_history_textures[history_idx]->bindImage(0, GL_WRITE_ONLY);
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("history_tgt_tx2D"), 0);
+        m_output_texture->bindImage(1, GL_WRITE_ONLY);
+        glUniform1i(m_ssao_resolve_prgm->ParameterLocation("tgt_tx2D"), 1);
+
+        m_ssao_resolve_prgm->Dispatch(static_cast<int>(std::ceil(m_output_texture->getWidth() / 8.0f)),
+            static_cast<int>(std::ceil(m_output_texture->getHeight() / 8.0f)), 1);
+
+        m_ssao_resolve_prgm->Disable();
+
+        m_ssao_history_idx = history_idx;
+        m_ssao_history_valid = true;
+        m_ssao_prev_view_mx = view_mx;
+        m_ssao_prev_proj_mx = proj_mx;
+        ++m_ssao_frame_idx;
+        if (camera_static || reset_history) {
+            ++m_ssao_static_frames;
+        }
+
     } else if (this->m_mode.Param<core::param::EnumParam>()->Value() == 1) {
         m_ssao_radius.Param<core::param::FloatParam>()->SetGUIVisible(false);
         m_ssao_sample_cnt.Param<core::param::IntParam>()->SetGUIVisible(false);
+        m_ssao_resolution.Param<core::param::EnumParam>()->SetGUIVisible(false);
+        m_ssao_frames.Param<core::param::IntParam>()->SetGUIVisible(false);
 
         if (call_input == NULL) return false;
         if (!(*call_input)(0)) return false;
 
+        if (unchanged(m_input_hashes.changed({call_input->getMetaData().m_data_hash}, params_dirty))) {
+            return true;
+        }
+
         auto input_tx2D = call_input->getData();
 
-        setupOutputTexture(input_tx2D, m_output_texture);
+        setupOutputTexture(input_tx2D, m_output_texture, 1);
 
         m_fxaa_prgm->Enable();
 
@@ -18,6 +18,12 @@
 #include "glowl/BufferObject.hpp"
 #include "glowl/Texture2D.hpp"
 
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include "InputHashes.h"
+
 namespace megamol {
 namespace compositing {
 
@@ -79,6 +85,9 @@ private:
     /** Shader program for texture ssao */
     std::unique_ptr<GLSLComputeShader> m_ssao_blur_prgm;
 
+    /** Shader program for upsampling and temporal accumulation of ssao */
+    std::unique_ptr<GLSLComputeShader> m_ssao_resolve_prgm;
+
     /** Shader program for texture ssao */
     std::unique_ptr<GLSLComputeShader> m_fxaa_prgm;
 
@@ -94,9 +103,34 @@ private:
     /** Texture that can store intermediate results for multi-pass effect, e.g. ssao with blur */
     std::shared_ptr<glowl::Texture2D> m_intermediate_texture;
 
+    /** Texture that stores the blurred ssao result at the ssao resolution */
+    std::shared_ptr<glowl::Texture2D> m_ssao_blurred_texture;
+
+    /** Ping-pong textures with the accumulated ssao of the current and the last frame */
+    std::array<std::shared_ptr<glowl::Texture2D>, 2> m_ssao_history_textures;
+
+    /** Index of the history texture written in the last frame */
+    int m_ssao_history_idx;
+
+    /** Flag whether the history textures contain the result of the last frame */
+    bool m_ssao_history_valid;
+
+    /** Number of ssao frames computed, used for varying the sample kernel */
+    int m_ssao_frame_idx;
+
+    /** Number of consecutive frames accumulated with an unchanged camera */
+    int m_ssao_static_frames;
+
+    /** Camera matrices of the last ssao frame, for reprojection */
+    glm::mat4 m_ssao_prev_view_mx;
+    glm::mat4 m_ssao_prev_proj_mx;
+
     /** Hash value to keep track of update to the output texture */
     size_t m_output_texture_hash;
 
+    /** Hashes of the inputs at the last run of the effect */
+    InputHashes m_input_hashes;
+
     /** Parameter for selecting the screen space effect that is computed, e.g. ssao, fxaa,... */
     megamol::core::param::ParamSlot m_mode;
 
@@ -106,6 +140,12 @@ private:
     /** Parameter for selecting the ssao sample count */
     megamol::core::param::ParamSlot m_ssao_sample_cnt;
 
+    /** Parameter for selecting the resolution of the ssao computation relative to the input */
+    megamol::core::param::ParamSlot m_ssao_resolution;
+
+    /** Parameter for selecting the number of frames that are accumulated */
+    megamol::core::param::ParamSlot m_ssao_frames;
+
     /** Slot for requesting the output textures from this module, i.e. lhs connection */
     megamol::core::CalleeSlot m_output_tex_slot;
 
@@ -4,9 +4,24 @@
 
 #include "compositing/CompositingCalls.h"
 
+#include "mmcore/utility/RenderTargetPool.h"
+
+namespace {
+    /** The render targets, leased from the pool shared with other modules */
+    megamol::core::utility::RenderTargetPool::lease_type leaseGBuffer(int width, int height) {
+        static const std::vector<megamol::core::utility::RenderTargetPool::Attachment> attachments = {
+            {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT}, // surface albedo
+            {GL_RGB16F, GL_RGB, GL_HALF_FLOAT},   // normals
+            {GL_R32F, GL_RED, GL_FLOAT}           // clip space depth
+        };
+        return megamol::core::utility::RenderTargetPool::Instance().Acquire(width, height, attachments, true);
+    }
+}
+
 megamol::compositing::SimpleRenderTarget::SimpleRenderTarget() 
     : Renderer3DModule_2()
     , m_GBuffer(nullptr)
+    , m_version(0)
     , m_color_render_target("Color", "Access the color render target texture")
     , m_normal_render_target("Normals", "Access the normals render target texture")
     , m_depth_render_target("Depth", "Access the depth render target texture")
@@ -51,15 +66,13 @@ megamol::compositing::SimpleRenderTarget::~SimpleRenderTarget() {
 
 bool megamol::compositing::SimpleRenderTarget::create() { 
 
-    m_GBuffer = std::make_shared<glowl::FramebufferObject>(1, 1, true);
-    m_GBuffer->createColorAttachment(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT); // surface albedo
-    m_GBuffer->createColorAttachment(GL_RGB16F, GL_RGB, GL_HALF_FLOAT); // normals
-    m_GBuffer->createColorAttachment(GL_R32F, GL_RED, GL_FLOAT);        // clip space depth
+    m_GBuffer = leaseGBuffer(1, 1);
 
     return true; 
 }
 
 void megamol::compositing::SimpleRenderTarget::release() {
+    m_GBuffer.reset();
 }
 
 bool megamol::compositing::SimpleRenderTarget::GetExtents(core::view::CallRender3D_2& call) { 
@@ -79,6 +92,7 @@ bool megamol::compositing::SimpleRenderTarget::Render(core::view::CallRender3D_2
 void megamol::compositing::SimpleRenderTarget::PreRender(core::view::CallRender3D_2& call)
 {
     m_last_used_camera = call.GetCamera();
+    ++m_version;
 
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
@@ -88,7 +102,8 @@ void megamol::compositing::SimpleRenderTarget::PreRender(core::view::CallRender3
     glGetIntegerv(GL_READ_BUFFER, &this->old_rb);
 
     if (m_GBuffer->getWidth() != viewport[2] || m_GBuffer->getHeight() != viewport[3]) {
-        m_GBuffer->resize(viewport[2], viewport[3]);
+        // The old render targets return to the pool once no receiver holds them anymore
+        m_GBuffer = leaseGBuffer(viewport[2], viewport[3]);
     }
 
     m_GBuffer->bind();
@@ -105,6 +120,7 @@ bool megamol::compositing::SimpleRenderTarget::getColorRenderTarget(core::Call&
     if (ct == NULL) return false;
 
     ct->setData(m_GBuffer->getColorAttachment(0));
+    ct->setMetaData(this->versionMetaData());
 
     return true;
 }
@@ -115,6 +131,7 @@ bool megamol::compositing::SimpleRenderTarget::getNormalsRenderTarget(core::Call
     if (ct == NULL) return false;
 
     ct->setData(m_GBuffer->getColorAttachment(1));
+    ct->setMetaData(this->versionMetaData());
 
     return true;
 }
@@ -125,6 +142,7 @@ bool megamol::compositing::SimpleRenderTarget::getDepthRenderTarget(core::Call&
     if (ct == NULL) return false;
 
     ct->setData(m_GBuffer->getColorAttachment(2));
+    ct->setMetaData(this->versionMetaData());
 
     return true;
 }
@@ -135,6 +153,7 @@ bool megamol::compositing::SimpleRenderTarget::getCameraSnapshot(core::Call& cal
     if (cc == NULL) return false;
 
     cc->setData(m_last_used_camera);
+    cc->setMetaData(this->versionMetaData());
 
     return true; 
 }
@@ -145,8 +164,15 @@ bool megamol::compositing::SimpleRenderTarget::getFramebufferObject(core::Call&
     if (cf == NULL) return false;
 
     cf->setData(m_GBuffer);
+    cf->setMetaData(this->versionMetaData());
 
     return true;
 }
 
 bool megamol::compositing::SimpleRenderTarget::getMetaDataCallback(core::Call& caller) { return true; }
+
+megamol::core::BasicMetaData megamol::compositing::SimpleRenderTarget::versionMetaData() const {
+    core::BasicMetaData meta_data;
+    meta_data.m_data_hash = m_version;
+    return meta_data;
+}
@@ -10,6 +10,7 @@
 
 
 #include "mmcore/CalleeSlot.h"
+#include "mmcore/CallGeneric.h"
 #include "mmcore/view/CallRender3D_2.h"
 #include "mmcore/view/Renderer3DModule_2.h"
 
@@ -126,6 +127,11 @@ protected:
     bool getMetaDataCallback(core::Call& caller);
 
 private:
+    /**
+     * Meta data of all outputs, carrying the version of the last rendering as data hash
+     */
+    core::BasicMetaData versionMetaData() const;
+
     /**
      * G-Buffer for deferred rendering. By default if uses three color attachments (and a depth renderbuffer):
      * surface albedo - RGB 16bit per channel
@@ -137,6 +143,9 @@ private:
     /** Local copy of last used camera*/
     core::view::Camera_2 m_last_used_camera;
 
+    /** Hash of the render targets and camera, incremented whenever they are rendered again */
+    size_t m_version;
+
     core::CalleeSlot m_color_render_target;
     core::CalleeSlot m_normal_render_target;
     core::CalleeSlot m_depth_render_target;
@@ -94,12 +94,24 @@ bool megamol::compositing::TextureCombine::getDataCallback(core::Call& caller) {
     if (!(*rhs_tc0)(0)) return false;
     if (!(*rhs_tc1)(0)) return false;
 
-    // TODO check/update data hash
-
     if (lhs_tc->getData() == nullptr) {
         lhs_tc->setData(m_output_texture);
     }
 
+    // skip the pass if neither the inputs nor the mode changed since its last run
+    const bool mode_dirty = this->m_mode.IsDirty();
+    this->m_mode.ResetDirty();
+
+    core::BasicMetaData meta_data;
+    if (!m_input_hashes.changed(
+            {rhs_tc0->getMetaData().m_data_hash, rhs_tc1->getMetaData().m_data_hash}, mode_dirty)) {
+        meta_data.m_data_hash = m_output_texture_hash;
+        lhs_tc->setMetaData(meta_data);
+        return true;
+    }
+    meta_data.m_data_hash = ++m_output_texture_hash;
+    lhs_tc->setMetaData(meta_data);
+
     // set output texture size to primary input texture
     auto src0_tx2D = rhs_tc0->getData();
     auto src1_tx2D = rhs_tc1->getData();
@@ -134,10 +146,10 @@ bool megamol::compositing::TextureCombine::getDataCallback(core::Call& caller) {
 
         glActiveTexture(GL_TEXTURE0);
         src0_tx2D->bindTexture();
-        glUniform1i(m_add_prgm->ParameterLocation("src0_tx2D"), 0);
+        glUniform1i(m_mult_prgm->ParameterLocation("src0_tx2D"), 0);
         glActiveTexture(GL_TEXTURE1);
         src1_tx2D->bindTexture();
-        glUniform1i(m_add_prgm->ParameterLocation("src1_tx2D"), 1);
+        glUniform1i(m_mult_prgm->ParameterLocation("src1_tx2D"), 1);
 
         m_output_texture->bindImage(0, GL_WRITE_ONLY);
 
@@ -151,8 +163,5 @@ bool megamol::compositing::TextureCombine::getDataCallback(core::Call& caller) {
 }
 
 bool megamol::compositing::TextureCombine::getMetaDataCallback(core::Call& caller) {
-
-    // TODO output hash?
-
     return true;
 }
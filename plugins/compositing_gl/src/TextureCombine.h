@@ -18,6 +18,8 @@
 
 #include "glowl/Texture2D.hpp"
 
+#include "InputHashes.h"
+
 namespace megamol {
 namespace compositing {
 
@@ -91,6 +93,9 @@ private:
     /** Hash value to keep track of update to the output texture */
     size_t                             m_output_texture_hash;
 
+    /** Hashes of the input textures at the last combination */
+    InputHashes                        m_input_hashes;
+
     /** Parameter for selecting the texture combination mode, e.g. add, multiply */
     megamol::core::param::ParamSlot    m_mode;
 
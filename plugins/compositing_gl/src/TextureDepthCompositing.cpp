@@ -13,6 +13,7 @@
 megamol::compositing::TextureDepthCompositing::TextureDepthCompositing()
     : core::Module()
     , m_output_texture(nullptr)
+    , m_output_texture_hash(0)
     , m_output_tex_slot("OutputTexture", "Gives access to resulting output texture")
     , m_input_tex_0_slot("InputTexture0", "Connects the primary input texture that is also used the set the output texture size")
     , m_input_tex_1_slot("InputTexture1", "Connects the secondary input texture") 
@@ -98,12 +99,22 @@ bool megamol::compositing::TextureDepthCompositing::getDataCallback(core::Call&
     if (!(*rhs_dtc0)(0)) return false;
     if (!(*rhs_dtc1)(0)) return false;
 
-    // TODO check/update data hash
-
     if (lhs_tc->getData() == nullptr) {
         lhs_tc->setData(m_output_texture);
     }
 
+    // skip the pass if none of the inputs changed since its last run
+    core::BasicMetaData meta_data;
+    if (!m_input_hashes.changed({rhs_tc0->getMetaData().m_data_hash, rhs_tc1->getMetaData().m_data_hash,
+                                    rhs_dtc0->getMetaData().m_data_hash, rhs_dtc1->getMetaData().m_data_hash},
+            false)) {
+        meta_data.m_data_hash = m_output_texture_hash;
+        lhs_tc->setMetaData(meta_data);
+        return true;
+    }
+    meta_data.m_data_hash = ++m_output_texture_hash;
+    lhs_tc->setMetaData(meta_data);
+
     // set output texture size to primary input texture
     auto src0_tx2D = rhs_tc0->getData();
     auto src1_tx2D = rhs_tc1->getData();
@@ -147,7 +158,5 @@ bool megamol::compositing::TextureDepthCompositing::getDataCallback(core::Call&
 
 bool megamol::compositing::TextureDepthCompositing::getMetaDataCallback(core::Call& caller) {
 
-    // TODO output hash?
-
     return true;
 }
@@ -18,6 +18,8 @@
 
 #include "glowl/Texture2D.hpp"
 
+#include "InputHashes.h"
+
 namespace megamol {
 namespace compositing {
 
@@ -85,6 +87,12 @@ private:
     /** Texture that the combination result will be written to */
     std::shared_ptr<glowl::Texture2D>  m_output_texture;
 
+    /** Hash value to keep track of update to the output texture */
+    size_t                             m_output_texture_hash;
+
+    /** Hashes of the input textures at the last compositing */
+    InputHashes                        m_input_hashes;
+
     /** Slot for requesting the output textures from this module, i.e. lhs connection */
     megamol::core::CalleeSlot          m_output_tex_slot;
 
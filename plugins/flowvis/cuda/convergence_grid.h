@@ -0,0 +1,176 @@
+/*
+ * convergence_grid.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Uniform grid over the convergence structures, used for nearest structure queries.
+        * Items index points first, followed by lines.
+        */
+        struct convergence_grid_data
+        {
+            /** Grid origin and cell size */
+            std::array<float, 2> origin;
+            std::array<float, 2> cell_size;
+
+            /** Number of cells per direction */
+            std::array<int, 2> resolution;
+
+            /** Offsets into the items per cell, with an additional end offset */
+            std::vector<int> cell_offsets;
+
+            /** Items sorted by cell */
+            std::vector<int> cell_items;
+        };
+
+        /**
+        * Create a uniform grid over the convergence structures, with about one convergence structure per cell
+        *
+        * @param domain         Domain size (minimum and maximum coordinates)
+        * @param points         Convergence structures defined as points
+        * @param lines          Convergence structures defined as lines
+        *
+        * @return Grid; without convergence structures, the grid does not contain any cell
+        */
+        inline convergence_grid_data create_convergence_grid(const std::array<float, 4>& domain,
+            const std::vector<float>& points, const std::vector<float>& lines)
+        {
+            convergence_grid_data grid;
+            grid.origin = { 0.0f, 0.0f };
+            grid.cell_size = { 0.0f, 0.0f };
+            grid.resolution = { 0, 0 };
+
+            const int num_points = static_cast<int>(points.size() / 2);
+            const int num_lines = static_cast<int>(lines.size() / 4);
+            const int num_items = num_points + num_lines;
+
+            if (num_items == 0)
+            {
+                return grid;
+            }
+
+            // Compute bounds, enclosing domain and convergence structures
+            float min_x = domain[0], min_y = domain[1], max_x = domain[2], max_y = domain[3];
+
+            for (std::size_t i = 0; i < points.size() / 2; ++i)
+            {
+                min_x = std::min(min_x, points[i * 2 + 0]); max_x = std::max(max_x, points[i * 2 + 0]);
+                min_y = std::min(min_y, points[i * 2 + 1]); max_y = std::max(max_y, points[i * 2 + 1]);
+            }
+
+            for (std::size_t i = 0; i < lines.size() / 2; ++i)
+            {
+                min_x = std::min(min_x, lines[i * 2 + 0]); max_x = std::max(max_x, lines[i * 2 + 0]);
+                min_y = std::min(min_y, lines[i * 2 + 1]); max_y = std::max(max_y, lines[i * 2 + 1]);
+            }
+
+            const float extent_x = std::max(max_x - min_x, FLT_EPSILON);
+            const float extent_y = std::max(max_y - min_y, FLT_EPSILON);
+
+            // Choose resolution such that there is about one convergence structure per cell
+            const int max_resolution = 2048;
+            const float num_cells = static_cast<float>(std::min(num_items, max_resolution * max_resolution));
+
+            const int resolution_x = std::min(std::max(static_cast<int>(std::round(std::sqrt(num_cells * extent_x / extent_y))), 1), max_resolution);
+            const int resolution_y = std::min(std::max(static_cast<int>(std::ceil(num_cells / resolution_x)), 1), max_resolution);
+
+            const float cell_size_x = extent_x / resolution_x;
+            const float cell_size_y = extent_y / resolution_y;
+
+            auto to_cell = [&](const float value, const float min_value, const float cell_size, const int resolution)
+            {
+                return std::min(std::max(static_cast<int>(std::floor((value - min_value) / cell_size)), 0), resolution - 1);
+            };
+
+            // Assign convergence structures to cells
+            std::vector<std::pair<int, int>> entries;
+            entries.reserve(num_items);
+
+            for (int i = 0; i < num_points; ++i)
+            {
+                const int x = to_cell(points[i * 2 + 0], min_x, cell_size_x, resolution_x);
+                const int y = to_cell(points[i * 2 + 1], min_y, cell_size_y, resolution_y);
+
+                entries.push_back(std::make_pair(y * resolution_x + x, i));
+            }
+
+            const float half_cell_diagonal = 0.5f * std::sqrt(cell_size_x * cell_size_x + cell_size_y * cell_size_y);
+
+            for (int i = 0; i < num_lines; ++i)
+            {
+                const float p0_x = lines[i * 4 + 0], p0_y = lines[i * 4 + 1];
+                const float p1_x = lines[i * 4 + 2], p1_y = lines[i * 4 + 3];
+
+                const float dir_x = p1_x - p0_x, dir_y = p1_y - p0_y;
+                const float length_squared = dir_x * dir_x + dir_y * dir_y;
+
+                const int first_x = to_cell(std::min(p0_x, p1_x), min_x, cell_size_x, resolution_x);
+                const int last_x = to_cell(std::max(p0_x, p1_x), min_x, cell_size_x, resolution_x);
+                const int first_y = to_cell(std::min(p0_y, p1_y), min_y, cell_size_y, resolution_y);
+                const int last_y = to_cell(std::max(p0_y, p1_y), min_y, cell_size_y, resolution_y);
+
+                for (int y = first_y; y <= last_y; ++y)
+                {
+                    for (int x = first_x; x <= last_x; ++x)
+                    {
+                        // Conservatively test if the segment passes through the cell
+                        const float center_x = min_x + (x + 0.5f) * cell_size_x;
+                        const float center_y = min_y + (y + 0.5f) * cell_size_y;
+
+                        const float t = length_squared > 0.0f ? std::min(std::max(((center_x - p0_x) * dir_x
+                            + (center_y - p0_y) * dir_y) / length_squared, 0.0f), 1.0f) : 0.0f;
+
+                        const float diff_x = p0_x + t * dir_x - center_x;
+                        const float diff_y = p0_y + t * dir_y - center_y;
+
+                        if (std::sqrt(diff_x * diff_x + diff_y * diff_y) <= half_cell_diagonal)
+                        {
+                            entries.push_back(std::make_pair(y * resolution_x + x, num_points + i));
+                        }
+                    }
+                }
+            }
+
+            // Create cell offsets and items, sorted by cell
+            grid.cell_offsets.assign(static_cast<std::size_t>(resolution_x) * resolution_y + 1, 0);
+            grid.cell_items.resize(entries.size());
+
+            for (const auto& entry : entries)
+            {
+                ++grid.cell_offsets[entry.first + 1];
+            }
+
+            for (std::size_t i = 1; i < grid.cell_offsets.size(); ++i)
+            {
+                grid.cell_offsets[i] += grid.cell_offsets[i - 1];
+            }
+
+            std::vector<int> cell_fill(grid.cell_offsets.begin(), grid.cell_offsets.end() - 1);
+
+            for (const auto& entry : entries)
+            {
+                grid.cell_items[cell_fill[entry.first]++] = entry.second;
+            }
+
+            grid.origin = { min_x, min_y };
+            grid.cell_size = { cell_size_x, cell_size_y };
+            grid.resolution = { resolution_x, resolution_y };
+
+            return grid;
+        }
+    }
+}
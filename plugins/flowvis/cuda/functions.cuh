@@ -7,32 +7,78 @@
 /**
 * Manual bilinear interpolation of values or vectors within a voxel
 *
+* @tparam sample_type Floating point type used for interpolation
+*
 * @param position Position at which to interpolate
 *
 * @return Interpolated tuple
 */
-template <int dimension>
+template <int dimension, typename sample_type = float>
 __device__
-typename real_t<float, dimension>::type texture_interpolation(const cudaTextureObject_t texture, const float2 position)
+typename real_t<sample_type, dimension>::type texture_interpolation(const cudaTextureObject_t texture, const typename real_t<sample_type, 2>::type position)
 {
+    using sample2_t = typename real_t<sample_type, 2>::type;
+
+    constexpr sample_type half = static_cast<sample_type>(0.5);
+    constexpr sample_type one = static_cast<sample_type>(1.0);
+
+    // Calculate lower and upper corners of the interpolated voxel
+    const sample2_t lc = make_real<sample_type, 2>(floor(position.x - half) + half, floor(position.y - half) + half);
+    const sample2_t uc = make_real<sample_type, 2>(lc.x + one, lc.y + one);
+
+    // Calculate relative position within the voxel
+    const sample2_t a = make_real<sample_type, 2>(position.x - lc.x, position.y - lc.y);
+
+    // Interpolate linearly; texels are stored in single precision
+    const auto t0 = make_real<sample_type, dimension, float>(tex2D<typename real_t<float, dimension>::type>(texture, static_cast<float>(lc.x), static_cast<float>(lc.y)));
+    const auto t1 = make_real<sample_type, dimension, float>(tex2D<typename real_t<float, dimension>::type>(texture, static_cast<float>(uc.x), static_cast<float>(lc.y)));
+    const auto t2 = make_real<sample_type, dimension, float>(tex2D<typename real_t<float, dimension>::type>(texture, static_cast<float>(uc.x), static_cast<float>(uc.y)));
+    const auto t3 = make_real<sample_type, dimension, float>(tex2D<typename real_t<float, dimension>::type>(texture, static_cast<float>(lc.x), static_cast<float>(uc.y)));
+
+    const auto ra = (one - a.x) * t0 + a.x * t1;
+    const auto rb = (one - a.x) * t3 + a.x * t2;
+
+    // Interpolate linearly between previous results
+    return (one - a.y) * ra + a.y * rb;
+}
+
+/**
+* Manual bilinear interpolation of values or vectors within a voxel of a layer of a layered texture
+*
+* @tparam sample_type Floating point type used for interpolation
+*
+* @param position Position at which to interpolate
+* @param layer Layer of the texture
+*
+* @return Interpolated tuple
+*/
+template <int dimension, typename sample_type = float>
+__device__
+typename real_t<sample_type, dimension>::type layered_texture_interpolation(const cudaTextureObject_t texture, const typename real_t<sample_type, 2>::type position, const int layer)
+{
+    using sample2_t = typename real_t<sample_type, 2>::type;
+
+    constexpr sample_type half = static_cast<sample_type>(0.5);
+    constexpr sample_type one = static_cast<sample_type>(1.0);
+
     // Calculate lower and upper corners of the interpolated voxel
-    const float2 lc = { floor(position.x - 0.5f) + 0.5f, floor(position.y - 0.5f) + 0.5f };
-    const float2 uc = lc + make_float2(1.0);
+    const sample2_t lc = make_real<sample_type, 2>(floor(position.x - half) + half, floor(position.y - half) + half);
+    const sample2_t uc = make_real<sample_type, 2>(lc.x + one, lc.y + one);
 
     // Calculate relative position within the voxel
-    const float2 a = { position.x - lc.x, position.y - lc.y };
+    const sample2_t a = make_real<sample_type, 2>(position.x - lc.x, position.y - lc.y);
 
-    // Interpolate linearly
-    const auto t0 = tex2D<typename real_t<float, dimension>::type>(texture, lc.x, lc.y);
-    const auto t1 = tex2D<typename real_t<float, dimension>::type>(texture, uc.x, lc.y);
-    const auto t2 = tex2D<typename real_t<float, dimension>::type>(texture, uc.x, uc.y);
-    const auto t3 = tex2D<typename real_t<float, dimension>::type>(texture, lc.x, uc.y);
+    // Interpolate linearly; texels are stored in single precision
+    const auto t0 = make_real<sample_type, dimension, float>(tex2DLayered<typename real_t<float, dimension>::type>(texture, static_cast<float>(lc.x), static_cast<float>(lc.y), layer));
+    const auto t1 = make_real<sample_type, dimension, float>(tex2DLayered<typename real_t<float, dimension>::type>(texture, static_cast<float>(uc.x), static_cast<float>(lc.y), layer));
+    const auto t2 = make_real<sample_type, dimension, float>(tex2DLayered<typename real_t<float, dimension>::type>(texture, static_cast<float>(uc.x), static_cast<float>(uc.y), layer));
+    const auto t3 = make_real<sample_type, dimension, float>(tex2DLayered<typename real_t<float, dimension>::type>(texture, static_cast<float>(lc.x), static_cast<float>(uc.y), layer));
 
-    const auto ra = (1.0f - a.x) * t0 + a.x * t1;
-    const auto rb = (1.0f - a.x) * t3 + a.x * t2;
+    const auto ra = (one - a.x) * t0 + a.x * t1;
+    const auto rb = (one - a.x) * t3 + a.x * t2;
 
     // Interpolate linearly between previous results
-    return (1.0f - a.y) * ra + a.y * rb;
+    return (one - a.y) * ra + a.y * rb;
 }
 
 /**
@@ -201,6 +201,49 @@ typename std::enable_if<dimension == 4, typename real_t<float_type, dimension>::
     return real_t<float_type, 4>::make(v.x, v.y, v.z, v.w);
 }
 
+// Operations on double-precision 2D vectors, which are independent of USE_DOUBLE, as they are required
+// for mixed and double-precision integration
+inline __host__ __device__ double2 operator+(double2 a, double2 b)
+{
+    return make_real<double, 2>(a.x + b.x, a.y + b.y);
+}
+inline __host__ __device__ void operator+=(double2& a, double2 b)
+{
+    a.x += b.x;
+    a.y += b.y;
+}
+inline __host__ __device__ double2 operator-(double2 a, double2 b)
+{
+    return make_real<double, 2>(a.x - b.x, a.y - b.y);
+}
+inline __host__ __device__ double2 operator-(double2 a)
+{
+    return make_real<double, 2>(-a.x, -a.y);
+}
+inline __host__ __device__ double2 operator*(double2 a, double b)
+{
+    return make_real<double, 2>(a.x * b, a.y * b);
+}
+inline __host__ __device__ double2 operator*(double b, double2 a)
+{
+    return make_real<double, 2>(b * a.x, b * a.y);
+}
+inline __host__ __device__ double2 operator*(double2 a, double2 b)
+{
+    return make_real<double, 2>(a.x * b.x, a.y * b.y);
+}
+
+#if !USE_DOUBLE
+inline __host__ __device__ double length(double2 v)
+{
+    return sqrt(v.x * v.x + v.y * v.y);
+}
+inline __host__ __device__ double2 fabs(double2 v)
+{
+    return make_real<double, 2>(fabs(v.x), fabs(v.y));
+}
+#endif
+
 #if USE_DOUBLE
 // Addition
 inline __host__ __device__ Real4 operator+(Real4 a, Real4 b)
@@ -1,6 +1,8 @@
 #include "streamlines.h"
 #include "streamlines.cuh"
 
+#include "convergence_grid.h"
+
 #include <cuda_runtime_api.h>
 
 #include "real_type.h"
@@ -8,37 +10,88 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <exception>
 #include <float.h>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #define __cuda_kernel_start(a, b) <<< a, b >>>
+#define __cuda_kernel_start_stream(a, b, s) <<< a, b, 0, s >>>
 
 // Transformations: domain offset, domain scale, texture offset, texture scale, time scale, max integration error, cell size}
 __constant__ float2 const_data[7];
 
-// Textures: vector field, 4th-order runge-kutta step size, convergence points, point ids, convergence lines, line ids
-__constant__ cudaTextureObject_t textures[6];
+// Textures: vector field, convergence points, point ids, convergence lines, line ids
+__constant__ cudaTextureObject_t textures[5];
+
+// Uniform grid over the convergence structures, where items index points first, followed by lines
+struct convergence_grid_t
+{
+    float2 origin;
+    float2 cell_size;
+    int2 resolution;
+
+    const int* cell_offsets;
+    const int* cell_items;
+};
+
+__constant__ convergence_grid_t convergence_grid;
+
+// Sliding window of two frames of a time-dependent vector field, stored in layers of one texture; if disabled,
+// the steady vector field is used
+struct time_window_t
+{
+    int enabled;
+    int layers[2];
+    float times[2];
+
+    cudaTextureObject_t texture;
+};
+
+__constant__ time_window_t time_window;
+
+// Criteria for terminating stream lines which converged to a structure; disabled if zero
+struct convergence_criteria_t
+{
+    float distance;
+    int num_steps;
+    float radius;
+};
+
+__constant__ convergence_criteria_t convergence_criteria;
+
+/**
+* Vector type of the given floating point type
+*/
+template <typename real_type>
+using real2_t = typename real_t<real_type, 2>::type;
 
 /**
 * Transform world position to texture coordinates
 *
+* @tparam sample_type   Floating point type of the texture coordinates
+* @tparam real_type     Floating point type of the position
+*
 * @param pos World position
 *
 * @return Texture coordinates
 */
+template <typename sample_type, typename real_type>
 inline __device__
-float2 pos_to_texcoords(const float2 pos)
+real2_t<sample_type> pos_to_texcoords(const real2_t<real_type> pos)
 {
     // Transform position from [physical] to [0 : 1]
-    const float2 scaled_position = (pos - const_data[0]) * const_data[1];
+    const real2_t<real_type> scaled_position = (pos - make_real<real_type, 2, float>(const_data[0])) * make_real<real_type, 2, float>(const_data[1]);
 
     // Transform position from [0 : 1] to [0.5 : texture width - 0.5]
-    return scaled_position * const_data[3] - const_data[2];
+    return make_real<sample_type, 2, real_type>(scaled_position * make_real<real_type, 2, float>(const_data[3]) - make_real<real_type, 2, float>(const_data[2]));
 }
 
 /**
@@ -60,123 +113,211 @@ int2 pos_to_surfcoords(const float2 pos)
     return make_int2(floor(scaled_position.x * const_data[3].x), floor(scaled_position.y * const_data[3].y));
 }
 
+/**
+* Get the velocity at a position and time, interpolating linearly between the frames of the time window
+*
+* @tparam real_type     Floating point type of position, time and returned velocity
+* @tparam sample_type   Floating point type for interpolating the single-precision texels
+*
+* @param pos    World position
+* @param time   Time, ignored for steady vector fields
+*
+* @return Velocity
+*/
+template <typename real_type, typename sample_type>
+inline __device__
+real2_t<real_type> sample_velocity(const real2_t<real_type> pos, const real_type time)
+{
+    const real2_t<sample_type> texcoords = pos_to_texcoords<sample_type, real_type>(pos);
+
+    if (!time_window.enabled)
+    {
+        return make_real<real_type, 2, sample_type>(texture_interpolation<2, sample_type>(textures[0], texcoords));
+    }
+
+    const sample_type alpha = fmin(fmax(static_cast<sample_type>((time - time_window.times[0]) / (time_window.times[1] - time_window.times[0])),
+        static_cast<sample_type>(0.0)), static_cast<sample_type>(1.0));
+
+    return make_real<real_type, 2, sample_type>(
+        (static_cast<sample_type>(1.0) - alpha) * layered_texture_interpolation<2, sample_type>(time_window.texture, texcoords, time_window.layers[0])
+        + alpha * layered_texture_interpolation<2, sample_type>(time_window.texture, texcoords, time_window.layers[1]));
+}
+
+/**
+* Get the time remaining until the end of the time window in integration direction
+*
+* @param time   Time
+* @param sign   Sign (1: forward, 2: backward integration)
+*
+* @return Remaining time
+*/
+template <typename real_type>
+inline __device__
+real_type remaining_time(const real_type time, const float sign)
+{
+    return sign > 0.0f ? time_window.times[1] - time : time - time_window.times[0];
+}
+
 /**
 * Advect position using 4th-order Runge-Kutta
 *
+* @tparam real_type     Floating point type of position, time and Runge-Kutta coefficients
+* @tparam sample_type   Floating point type for interpolating the single-precision texels
+*
 * @param pos    In/out position
+* @param time   In/out time, only advanced for time-dependent vector fields
 * @param delta  Time step coefficient
 * @param sign   Sign (1: forward, 2: backward integration)
 */
+template <typename real_type, typename sample_type>
 __device__
-void advectRK4(float2& pos, const float delta, const float sign)
+void advectRK4(real2_t<real_type>& pos, real_type& time, const real_type delta, const float sign)
 {
-    // Calculate step size
-    const auto max_velocity = length(texture_interpolation<2>(textures[0], pos_to_texcoords(pos)));
-    const auto min_cellsize = fminf(const_data[6].x, const_data[6].y);
+    // Calculate step size; path lines use the time step as is, as normalizing by the velocity would distort time
+    real_type step;
 
-    const auto steps_per_cell = max_velocity > 0.0f ? min_cellsize / max_velocity : 0.0f;
+    if (time_window.enabled)
+    {
+        step = fmin(delta, remaining_time(time, sign));
+    }
+    else
+    {
+        const real_type max_velocity = length(sample_velocity<real_type, sample_type>(pos, time));
+        const real_type min_cellsize = fminf(const_data[6].x, const_data[6].y);
+
+        const real_type steps_per_cell = max_velocity > static_cast<real_type>(0.0) ? min_cellsize / max_velocity : static_cast<real_type>(0.0);
+
+        step = steps_per_cell * delta;
+    }
+
+    const real_type half = static_cast<real_type>(0.5);
+    const real_type dt = step * sign;
 
     // Calculate Runge-Kutta coefficients
-    const float2 k1 = steps_per_cell * delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos));
-    const float2 k2 = steps_per_cell * delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + 0.5f * k1));
-    const float2 k3 = steps_per_cell * delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + 0.5f * k2));
-    const float2 k4 = steps_per_cell * delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + k3));
+    const real2_t<real_type> k1 = dt * sample_velocity<real_type, sample_type>(pos, time);
+    const real2_t<real_type> k2 = dt * sample_velocity<real_type, sample_type>(pos + half * k1, time + half * dt);
+    const real2_t<real_type> k3 = dt * sample_velocity<real_type, sample_type>(pos + half * k2, time + half * dt);
+    const real2_t<real_type> k4 = dt * sample_velocity<real_type, sample_type>(pos + k3, time + dt);
 
     // Advect and store position
-    pos += (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+    pos += (static_cast<real_type>(1.0) / static_cast<real_type>(6.0)) * (k1 + static_cast<real_type>(2.0) * k2 + static_cast<real_type>(2.0) * k3 + k4);
+
+    if (time_window.enabled)
+    {
+        time += dt;
+    }
 }
 
 /**
 * Advect position using 4th-order Runge-Kutta with 5th-order error estimation for adaptive time steps
 * See http://www.aip.de/groups/soe/local/numres/bookcpdf/c16-2.pdf for details
 *
+* @tparam real_type     Floating point type of position, time and Runge-Kutta coefficients
+* @tparam sample_type   Floating point type for interpolating the single-precision texels
+*
 * @param pos        In/out position
+* @param time       In/out time, only advanced for time-dependent vector fields
 * @param delta      Time step coefficient
 * @param sign       Sign (1: forward, 2: backward integration)
 * @param max_error  Maximum error allowed, used for step size adjustment
 *
 * @return Time step coefficient based on error estimation, with corresponding error
 */
+template <typename real_type, typename sample_type>
 __device__
-float2 advectRK45(float2& pos, float& delta, const float sign, const float max_error)
+real2_t<real_type> advectRK45(real2_t<real_type>& pos, real_type& time, real_type& delta, const float sign, const real_type max_error)
 {
     // Cash-Karp parameters
-    constexpr float b_21 = 0.2f;
-    constexpr float b_31 = 0.075f;
-    constexpr float b_41 = 0.3f;
-    constexpr float b_51 = -11.0f / 54.0f;
-    constexpr float b_61 = 1631.0f / 55296.0f;
-    constexpr float b_32 = 0.225f;
-    constexpr float b_42 = -0.9f;
-    constexpr float b_52 = 2.5f;
-    constexpr float b_62 = 175.0f / 512.0f;
-    constexpr float b_43 = 1.2f;
-    constexpr float b_53 = -70.0f / 27.0f;
-    constexpr float b_63 = 575.0f / 13824.0f;
-    constexpr float b_54 = 35.0f / 27.0f;
-    constexpr float b_64 = 44275.0f / 110592.0f;
-    constexpr float b_65 = 253.0f / 4096.0f;
-
-    constexpr float c_1 = 37.0f / 378.0f;
-    constexpr float c_2 = 0.0f;
-    constexpr float c_3 = 250.0f / 621.0f;
-    constexpr float c_4 = 125.0f / 594.0f;
-    constexpr float c_5 = 0.0f;
-    constexpr float c_6 = 512.0f / 1771.0f;
-
-    constexpr float c_1s = 2825.0f / 27648.0f;
-    constexpr float c_2s = 0.0f;
-    constexpr float c_3s = 18575.0f / 48384.0f;
-    constexpr float c_4s = 13525.0f / 55296.0f;
-    constexpr float c_5s = 277.0f / 14336.0f;
-    constexpr float c_6s = 0.25f;
+    constexpr real_type b_21 = static_cast<real_type>(0.2);
+    constexpr real_type b_31 = static_cast<real_type>(0.075);
+    constexpr real_type b_41 = static_cast<real_type>(0.3);
+    constexpr real_type b_51 = static_cast<real_type>(-11.0 / 54.0);
+    constexpr real_type b_61 = static_cast<real_type>(1631.0 / 55296.0);
+    constexpr real_type b_32 = static_cast<real_type>(0.225);
+    constexpr real_type b_42 = static_cast<real_type>(-0.9);
+    constexpr real_type b_52 = static_cast<real_type>(2.5);
+    constexpr real_type b_62 = static_cast<real_type>(175.0 / 512.0);
+    constexpr real_type b_43 = static_cast<real_type>(1.2);
+    constexpr real_type b_53 = static_cast<real_type>(-70.0 / 27.0);
+    constexpr real_type b_63 = static_cast<real_type>(575.0 / 13824.0);
+    constexpr real_type b_54 = static_cast<real_type>(35.0 / 27.0);
+    constexpr real_type b_64 = static_cast<real_type>(44275.0 / 110592.0);
+    constexpr real_type b_65 = static_cast<real_type>(253.0 / 4096.0);
+
+    constexpr real_type c_1 = static_cast<real_type>(37.0 / 378.0);
+    constexpr real_type c_2 = static_cast<real_type>(0.0);
+    constexpr real_type c_3 = static_cast<real_type>(250.0 / 621.0);
+    constexpr real_type c_4 = static_cast<real_type>(125.0 / 594.0);
+    constexpr real_type c_5 = static_cast<real_type>(0.0);
+    constexpr real_type c_6 = static_cast<real_type>(512.0 / 1771.0);
+
+    constexpr real_type c_1s = static_cast<real_type>(2825.0 / 27648.0);
+    constexpr real_type c_2s = static_cast<real_type>(0.0);
+    constexpr real_type c_3s = static_cast<real_type>(18575.0 / 48384.0);
+    constexpr real_type c_4s = static_cast<real_type>(13525.0 / 55296.0);
+    constexpr real_type c_5s = static_cast<real_type>(277.0 / 14336.0);
+    constexpr real_type c_6s = static_cast<real_type>(0.25);
+
+    constexpr real_type a_2 = static_cast<real_type>(0.2);
+    constexpr real_type a_3 = static_cast<real_type>(0.3);
+    constexpr real_type a_4 = static_cast<real_type>(0.6);
+    constexpr real_type a_5 = static_cast<real_type>(1.0);
+    constexpr real_type a_6 = static_cast<real_type>(0.875);
 
     // Constants
-    constexpr float grow_exponent = -0.2f;
-    constexpr float shrink_exponent = -0.25f;
-    constexpr float max_growth = 5.0f;
-    constexpr float max_shrink = 0.1f;
-    constexpr float safety = 0.9f;
+    constexpr real_type grow_exponent = static_cast<real_type>(-0.2);
+    constexpr real_type shrink_exponent = static_cast<real_type>(-0.25);
+    constexpr real_type max_growth = static_cast<real_type>(5.0);
+    constexpr real_type max_shrink = static_cast<real_type>(0.1);
+    constexpr real_type safety = static_cast<real_type>(0.9);
 
     // Calculate Runge-Kutta coefficients
-    float2 output_position;
-    float2 used_delta_and_error;
+    real2_t<real_type> output_position;
+    real2_t<real_type> used_delta_and_error;
     bool decreased = false;
 
+    // Do not step over the end of the time window
+    if (time_window.enabled)
+    {
+        delta = fmin(delta, remaining_time(time, sign));
+    }
+
     do
     {
-        const float2 k1 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos));
-        const float2 k2 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + b_21 * k1));
-        const float2 k3 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + b_31 * k1 + b_32 * k2));
-        const float2 k4 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + b_41 * k1 + b_42 * k2 + b_43 * k3));
-        const float2 k5 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + b_51 * k1 + b_52 * k2 + b_53 * k3 + b_54 * k4));
-        const float2 k6 = delta * sign * texture_interpolation<2>(textures[0], pos_to_texcoords(pos + b_61 * k1 + b_62 * k2 + b_63 * k3 + b_64 * k4 + b_65 * k5));
+        const real_type dt = delta * sign;
+
+        const real2_t<real_type> k1 = dt * sample_velocity<real_type, sample_type>(pos, time);
+        const real2_t<real_type> k2 = dt * sample_velocity<real_type, sample_type>(pos + b_21 * k1, time + a_2 * dt);
+        const real2_t<real_type> k3 = dt * sample_velocity<real_type, sample_type>(pos + b_31 * k1 + b_32 * k2, time + a_3 * dt);
+        const real2_t<real_type> k4 = dt * sample_velocity<real_type, sample_type>(pos + b_41 * k1 + b_42 * k2 + b_43 * k3, time + a_4 * dt);
+        const real2_t<real_type> k5 = dt * sample_velocity<real_type, sample_type>(pos + b_51 * k1 + b_52 * k2 + b_53 * k3 + b_54 * k4, time + a_5 * dt);
+        const real2_t<real_type> k6 = dt * sample_velocity<real_type, sample_type>(pos + b_61 * k1 + b_62 * k2 + b_63 * k3 + b_64 * k4 + b_65 * k5, time + a_6 * dt);
 
         // Calculate error estimate
-        const float2 fifth_order = pos + c_1 * k1 + c_2 * k2 + c_3 * k3 + c_4 * k4 + c_5 * k5 + c_6 * k6;
-        const float2 fourth_order = pos + c_1s * k1 + c_2s * k2 + c_3s * k3 + c_4s * k4 + c_5s * k5 + c_6s * k6;
+        const real2_t<real_type> fifth_order = pos + c_1 * k1 + c_2 * k2 + c_3 * k3 + c_4 * k4 + c_5 * k5 + c_6 * k6;
+        const real2_t<real_type> fourth_order = pos + c_1s * k1 + c_2s * k2 + c_3s * k3 + c_4s * k4 + c_5s * k5 + c_6s * k6;
 
-        const float2 difference = fabs(fifth_order - fourth_order);
+        const real2_t<real_type> difference = fabs(fifth_order - fourth_order);
 
         //const float2 scale = make_Real4(1.0);
-        const float2 scale = fabs(texture_interpolation<2>(textures[0], pos_to_texcoords(pos)));
+        const real2_t<real_type> scale = fabs(sample_velocity<real_type, sample_type>(pos, time));
 
-        const float error = fmaxf(0.0f, fmaxf(difference.x / scale.x, difference.y / scale.y)) / max_error;
+        const real_type error = fmax(static_cast<real_type>(0.0), fmax(difference.x / scale.x, difference.y / scale.y)) / max_error;
 
         // Set new, adapted time step
         used_delta_and_error.x = delta;
         used_delta_and_error.y = error;
 
-        if (error > 1.0f)
+        if (error > static_cast<real_type>(1.0))
         {
             // Error too large, reduce time step
-            delta *= fmaxf(max_shrink, safety * powf(error, shrink_exponent));
+            delta *= fmax(max_shrink, safety * pow(error, shrink_exponent));
             decreased = true;
         }
         else
         {
             // Error (too) small, increase time step
-            delta *= fminf(max_growth, safety * powf(error, grow_exponent));
+            delta *= fmin(max_growth, safety * pow(error, grow_exponent));
             decreased = false;
         }
 
@@ -188,6 +329,11 @@ float2 advectRK45(float2& pos, float& delta, const float sign, const float max_e
     // Advect and store position
     pos = output_position;
 
+    if (time_window.enabled)
+    {
+        time += used_delta_and_error.x * sign;
+    }
+
     return used_delta_and_error;
 }
 
@@ -211,271 +357,911 @@ void update_label_and_dist(const int label_conv_structure, const float dist_conv
 }
 
 /**
-* Update label and distance
+* Calculate the distance between a position and a convergence structure
 *
 * @param num_convergence_points Number of critical points
-* @param num_convergence_lines  Number of segments (lines)
+* @param item                   Index of the convergence structure, with points first, followed by lines
 * @param pos                    Stream line position
-* @param label                  In/out (previous) label
-* @param distance               In/out (previous) distance
+*
+* @return Distance between the position and the convergence structure
 */
-__device__
-void update_label_and_dist(const int num_convergence_points, const int num_convergence_lines, const float2 pos, short& label, float& distance)
+inline __device__
+float distance_to_structure(const int num_convergence_points, const int item, const float2 pos)
 {
-#if __streamlines_cuda_shi_et_al
-    label = -1;
-    distance = FLT_MAX;
-#endif
-
-    // Calculate distance of the current position to critical points
-    for (int k = 0; k < num_convergence_points; ++k)
+    if (item < num_convergence_points)
     {
-        const float id = tex1Dfetch<float>(textures[3], k);
-
-        const float2 p = make_real<float, 2>(tex1Dfetch<float2>(textures[2], k));
-        const float dist = length(make_real<float, 2>(pos - p));
+        const float2 p = make_real<float, 2>(tex1Dfetch<float2>(textures[1], item));
 
-        update_label_and_dist(id, dist, label, distance);
+        return length(make_real<float, 2>(pos - p));
     }
 
-    // Calculate distance of the current position to line segments
-    for (int k = 0; k < num_convergence_lines; ++k)
-    {
-        const float id = tex1Dfetch<float>(textures[5], k);
+    const int k = item - num_convergence_points;
 
-        const float2 p0 = make_real<float, 2>(tex1Dfetch<float2>(textures[4], k * 2 + 0));
-        const float2 p1 = make_real<float, 2>(tex1Dfetch<float2>(textures[4], k * 2 + 1));
-        const float dist = distance_point_line(make_real<float, 2>(pos), make_real<float, 2>(p0), make_real<float, 2>(p1));
-        
-        update_label_and_dist(id, dist, label, distance);
-    }
+    const float2 p0 = make_real<float, 2>(tex1Dfetch<float2>(textures[3], k * 2 + 0));
+    const float2 p1 = make_real<float, 2>(tex1Dfetch<float2>(textures[3], k * 2 + 1));
+
+    return distance_point_line(make_real<float, 2>(pos), make_real<float, 2>(p0), make_real<float, 2>(p1));
 }
 
 /**
-* Compute stream lines and update labels and distances
+* Find the convergence structure nearest to the given position that is closer than the given maximum distance.
+* The cells of the uniform grid are visited in rings around the cell containing the position, until the
+* remaining rings cannot contain a closer convergence structure.
 *
 * @param num_convergence_points Number of critical points
-* @param num_convergence_lines  Number of segments (lines)
-* @param num_triangles          Number of triangles
-* @param particles              Seed particles
-* @param num_particles          Number of seed particles
-* @param num_steps              Number of advection steps
-* @param labels                 Output labels
-* @param distances              Output distances
-* @param terminations           Output terminations
-* @param method                 Integration method
+* @param pos                    Stream line position
+* @param max_distance           Maximum distance; only structures closer than this are considered
+* @param nearest_distance       Output distance to the nearest structure, or the maximum distance if none was found
+*
+* @return Index of the nearest structure, with points first, followed by lines; -1 if none was found
 */
-__global__
-void compute_streamlines_kernel(const int num_convergence_points, const int num_convergence_lines, const float sign,
-    float2* particles, const int num_particles, const int num_steps, float* labels, float* distances, float* terminations, const int method)
+__device__
+int find_nearest_structure(const int num_convergence_points, const float2 pos, const float max_distance, float& nearest_distance)
 {
-    // Get kernel ID
-    const int tid = threadIdx.x;
-    const int gid = blockIdx.x*blockDim.x + tid;
+    int nearest = -1;
+    nearest_distance = max_distance;
 
-    if (gid < num_particles && terminations[gid] == 0)
+    if (convergence_grid.cell_offsets == nullptr)
     {
-        // Get initial values for labels, distances and positions
-        short label = (short)labels[gid];
-        float dist = distances[gid];
-        short termination = (short)terminations[gid];
-        float2 pos = particles[gid];
+        return nearest;
+    }
 
-#if !(__streamlines_cuda_shi_et_al)
-        // Initially update values by evaluating the distance to convergence structures
-        update_label_and_dist(num_convergence_points, num_convergence_lines, pos, label, dist);
-#endif
+    // Get cell containing the position, or the closest cell if the position lies outside the grid
+    const int2 resolution = convergence_grid.resolution;
+    const float2 cell_position = (pos - convergence_grid.origin) / convergence_grid.cell_size;
 
-        // Calculate initial time step
-        float step = const_data[4].x * texture_interpolation<1>(textures[1], pos_to_texcoords(pos));
+    const int cell_x = min(max(static_cast<int>(floorf(cell_position.x)), 0), resolution.x - 1);
+    const int cell_y = min(max(static_cast<int>(floorf(cell_position.y)), 0), resolution.y - 1);
 
-        for (int j = 0; j < num_steps; ++j)
-        {
-            // Advect using 4th-order Runge-Kutta
-            const float2 posPrev = pos;
+    const float min_cell_size = fminf(convergence_grid.cell_size.x, convergence_grid.cell_size.y);
+    const int max_ring = max(resolution.x, resolution.y);
 
-            if (method == 0)
-            {
-                advectRK4(pos, const_data[4].x, sign);
-            }
-            else if (method == 1)
-            {
-                advectRK45(pos, step, sign, const_data[5].x);
-            }
+    for (int ring = 0; ring <= max_ring; ++ring)
+    {
+        // All cells of this and the following rings are at least this far away
+        if (ring > 0 && (ring - 1) * min_cell_size > nearest_distance)
+        {
+            break;
+        }
 
-#if !(__streamlines_cuda_shi_et_al)
-            // Update values by evaluating the distance to convergence structures
-            update_label_and_dist(num_convergence_points, num_convergence_lines, pos, label, dist);
-#endif
+        for (int y = max(cell_y - ring, 0); y <= min(cell_y + ring, resolution.y - 1); ++y)
+        {
+            // Only visit cells on the perimeter of the ring
+            const int step = (y == cell_y - ring || y == cell_y + ring) ? 1 : 2 * ring;
 
-            // If advection had no effect, abort the algorithm
-            if (posPrev.x == pos.x && posPrev.y == pos.y)
+            for (int x = cell_x - ring; x <= cell_x + ring; x += step)
             {
-                float dist = FLT_MAX;
-
-                for (int k = 0; k < num_convergence_points; ++k)
+                if (x < 0 || x >= resolution.x)
                 {
-                    const float2 p = make_real<float, 2>(tex1Dfetch<float2>(textures[2], k));
-
-                    dist = fminf(dist, length(make_real<float, 2>(pos - p)));
+                    continue;
                 }
 
-                for (int k = 0; k < num_convergence_lines; ++k)
-                {
-                    const float2 p0 = make_real<float, 2>(tex1Dfetch<float2>(textures[4], k * 2 + 0));
-                    const float2 p1 = make_real<float, 2>(tex1Dfetch<float2>(textures[4], k * 2 + 1));
-
-                    dist = fminf(dist, distance_point_line(make_real<float, 2>(pos), make_real<float, 2>(p0), make_real<float, 2>(p1)));
-                }
+                const int cell = y * resolution.x + x;
 
-                if (dist < 0.5f * fminf(const_data[6].x, const_data[6].y))
+                for (int i = convergence_grid.cell_offsets[cell]; i < convergence_grid.cell_offsets[cell + 1]; ++i)
                 {
-                    termination = 3;
+                    const int item = convergence_grid.cell_items[i];
+                    const float dist = distance_to_structure(num_convergence_points, item, pos);
+
+                    // Prefer lower indices for equal distances, as a linear search would
+                    if (dist < nearest_distance || (dist == nearest_distance && nearest != -1 && item < nearest))
+                    {
+                        nearest = item;
+                        nearest_distance = dist;
+                    }
                 }
-                else
-                {
-                    termination = 2;
-                }
-
-                break;
             }
+        }
+    }
 
-            // If current position is outside of the domain, set "outside"-label and distance and
-            // abort the algorithm
-            const float2 pos_01 = (pos - const_data[0]) * const_data[1];
-
-            if (pos_01.x < static_cast<float>(0.0) || pos_01.x > static_cast<float>(1.0) ||
-                pos_01.y < static_cast<float>(0.0) || pos_01.y > static_cast<float>(1.0))
-            {
-                termination = 1;
+    return nearest;
+}
 
+/**
+* Update label and distance
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param pos                    Stream line position
+* @param label                  In/out (previous) label
+* @param distance               In/out (previous) distance
+*/
+__device__
+void update_label_and_dist(const int num_convergence_points, const int num_convergence_lines, const float2 pos, short& label, float& distance)
+{
 #if __streamlines_cuda_shi_et_al
-                label = -1;
-                dist = 0.0;
+    label = -1;
+    distance = FLT_MAX;
 #endif
 
-                break;
-            }
-        }
-#if __streamlines_cuda_shi_et_al
-        // Update values by evaluating the distance to convergence structures at the final position
-        update_label_and_dist(num_convergence_points, num_convergence_lines, pos, label, dist);
-#endif
+    // Find the nearest convergence structure that is closer than the previous one
+    float nearest_distance;
+    const int nearest = find_nearest_structure(num_convergence_points, pos, distance, nearest_distance);
 
-        // Store and return calculated values
-        labels[gid] = label;
-        distances[gid] = dist;
-        terminations[gid] = termination;
-        particles[gid] = pos;
+    if (nearest != -1)
+    {
+        const float id = nearest < num_convergence_points
+            ? tex1Dfetch<float>(textures[2], nearest)
+            : tex1Dfetch<float>(textures[4], nearest - num_convergence_points);
+
+        update_label_and_dist(id, nearest_distance, label, distance);
     }
 }
 
-// ################################################################################################################################
+/**
+* State of a single stream line during integration
+*
+* @tparam real_type     Floating point type of position, time and step size
+*/
+template <typename real_type>
+struct streamline_state
+{
+    short label;
+    float dist;
+    short termination;
+    real2_t<real_type> pos;
+    real_type time;
+    real_type step;
+    float sign;
+
+    // Position and label since which the stream line stayed within the convergence radius, and the number of steps
+    real2_t<real_type> anchor;
+    short anchor_label;
+    int anchor_steps;
+};
 
-namespace megamol
+/**
+* Load the initial values of a stream line and initialize its state
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param gid                    Index of the stream line
+* @param sign                   Sign of the integration direction
+* @param particles              Seed particles
+* @param labels                 Input labels
+* @param distances              Input distances
+* @param terminations           Input terminations
+* @param state                  Output stream line state
+*/
+template <typename real_type, typename sample_type>
+__device__
+void begin_streamline(const int num_convergence_points, const int num_convergence_lines, const int gid, const float sign,
+    const float2* particles, const float* labels, const float* distances, const float* terminations, streamline_state<real_type>& state)
 {
-    namespace flowvis
+    // Get initial values for labels, distances and positions
+    state.label = (short)labels[gid];
+    state.dist = distances[gid];
+    state.termination = (short)terminations[gid];
+    state.pos = make_real<real_type, 2, float>(particles[gid]);
+    state.sign = sign;
+
+    // Path lines start at the beginning of the time window in integration direction
+    state.time = time_window.enabled ? (sign > 0.0f ? time_window.times[0] : time_window.times[1]) : static_cast<real_type>(0.0);
+
+#if !(__streamlines_cuda_shi_et_al)
+    // Initially update values by evaluating the distance to convergence structures
+    update_label_and_dist(num_convergence_points, num_convergence_lines, make_real<float, 2, real_type>(state.pos), state.label, state.dist);
+#endif
+
+    // Calculate initial time step from the constant cell diagonal
+    state.step = static_cast<real_type>(const_data[4].x * length(const_data[6]));
+
+    state.anchor = state.pos;
+    state.anchor_label = state.label;
+    state.anchor_steps = 0;
+}
+
+/**
+* Check if a stream line converged, i.e., it came closer to its labelled structure than the convergence distance,
+* or stayed within the convergence radius without changing its label for the given number of steps
+*
+* @param pos                    Current position
+* @param state                  In/out stream line state
+*
+* @return True if the stream line converged, false otherwise
+*/
+template <typename real_type>
+__device__
+bool check_convergence(const float2 pos, streamline_state<real_type>& state)
+{
+    if (state.label == -1)
     {
-        static std::unique_ptr<streamlines_cuda_impl> impl = nullptr;
+        return false;
+    }
 
-        streamlines_cuda::streamlines_cuda(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
-            const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
-            const std::vector<float>& lines, const std::vector<int>& line_ids, const float integration_timestep,
-            const float max_integration_error, const integration_method method)
+    if (convergence_criteria.distance > 0.0f && state.dist < convergence_criteria.distance)
+    {
+        return true;
+    }
+
+    if (convergence_criteria.num_steps > 0)
+    {
+        if (state.label != state.anchor_label || length(pos - make_real<float, 2, real_type>(state.anchor)) > convergence_criteria.radius)
         {
-            impl = std::make_unique<streamlines_cuda_impl>(resolution, domain, vectors,
-                points, point_ids, lines, line_ids, integration_timestep, max_integration_error, method);
+            state.anchor = state.pos;
+            state.anchor_label = state.label;
+            state.anchor_steps = 0;
         }
-
-        void streamlines_cuda::update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
-            std::vector<float>& terminations, const int num_integration_steps, const float sign, const unsigned int num_particles_per_batch)
+        else if (++state.anchor_steps >= convergence_criteria.num_steps)
         {
-            impl->update_labels(source, labels, distances, terminations, num_integration_steps, sign, num_particles_per_batch);
+            return true;
         }
     }
-}
 
-// ################################################################################################################################
+    return false;
+}
 
-namespace megamol
+/**
+* Perform a single integration step of a stream line
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param method                 Integration method
+* @param state                  In/out stream line state
+*
+* @return True if the stream line terminated, false otherwise
+*/
+template <typename real_type, typename sample_type>
+__device__
+bool advance_streamline(const int num_convergence_points, const int num_convergence_lines, const int method, streamline_state<real_type>& state)
 {
-    namespace flowvis
-    {
-        streamlines_cuda_impl::streamlines_cuda_impl(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
-            const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
-            const std::vector<float>& lines, const std::vector<int>& line_ids, const float integration_timestep,
-            const float max_integration_error, const streamlines_cuda::integration_method method)
-            : resolution(resolution), d_velocity(nullptr), d_rk4_step(nullptr), d_convergence_points(nullptr),
-            d_convergence_lines(nullptr), d_convergence_line_ids(nullptr), method(method)
-        {
-            // Get domain boundaries
-            const std::size_t num_vectors = vectors.size() / 2;
-
-            // Create constants and upload them to GPU
-            const float cellx = (domain[2] - domain[0]) / (this->resolution[0] - 1);
-            const float celly = (domain[3] - domain[1]) / (this->resolution[1] - 1);
-            const float cell_diag = std::sqrt(cellx * cellx + celly * celly);
-
-            const float2 domain_offset = make_real<float, 2>(domain[0], domain[1]);
-            const float2 domain_scale = make_real<float, 2>(1.0f / (domain[2] - domain[0]), 1.0f / (domain[3] - domain[1]));
-            const float2 texture_offset = make_real<float, 2>(-0.5f, -0.5f);
-            const float2 texture_scale = make_real<float, 2>(this->resolution[0] - 1, this->resolution[1] - 1);
-            const float2 time_scale = make_real<float, 2>(integration_timestep);
-            const float2 max_error = make_real<float, 2>(max_integration_error);
-            const float2 cell_size = make_real<float, 2>(cellx, celly);
+    // Advect using 4th-order Runge-Kutta
+    const real2_t<real_type> posPrev = state.pos;
 
-            const std::array<float2, 7> h_const_data = { domain_offset, domain_scale, texture_offset, texture_scale, time_scale, max_error, cell_size };
+    if (method == 0)
+    {
+        advectRK4<real_type, sample_type>(state.pos, state.time, const_data[4].x, state.sign);
+    }
+    else if (method == 1)
+    {
+        advectRK45<real_type, sample_type>(state.pos, state.time, state.step, state.sign, const_data[5].x);
+    }
 
-            cudaMemcpyToSymbol(const_data, h_const_data.data(), h_const_data.size() * sizeof(float2));
+    // Distance queries are performed in single precision
+    const float2 pos = make_real<float, 2, real_type>(state.pos);
 
-            // Create velocity texture and upload to GPU
-            static_assert(sizeof(float2) == 2 * sizeof(float), "CUDA type 'float2' must only consist of two 'float' members.");
+#if !(__streamlines_cuda_shi_et_al)
+    // Update values by evaluating the distance to convergence structures
+    update_label_and_dist(num_convergence_points, num_convergence_lines, pos, state.label, state.dist);
+#endif
 
-            initialize_texture(vectors.data(), 2, &this->velocity_texture, &this->d_velocity);
-            cudaMemcpyToSymbol(textures, &this->velocity_texture, sizeof(cudaTextureObject_t));
+    // If advection had no effect, abort the algorithm
+    if (posPrev.x == state.pos.x && posPrev.y == state.pos.y)
+    {
+        // Check if there is a convergence structure within half a cell
+        float nearest_distance;
 
-            // Create texture for Runge-Kutta step size and upload to GPU
-            std::vector<float> h_rk4step(num_vectors);
+        if (find_nearest_structure(num_convergence_points, pos, 0.5f * fminf(const_data[6].x, const_data[6].y), nearest_distance) != -1)
+        {
+            state.termination = 3;
+        }
+        else
+        {
+            state.termination = 2;
+        }
 
-            for (int i = 0; i < num_vectors; ++i)
-            {
-                h_rk4step[i] = cell_diag;
-            }
+        return true;
+    }
 
-            initialize_texture(h_rk4step.data(), 1, &this->rk4_step_texture, &this->d_rk4_step);
-            cudaMemcpyToSymbol(textures, &this->rk4_step_texture, sizeof(cudaTextureObject_t), sizeof(cudaTextureObject_t));
+    // If current position is outside of the domain, set "outside"-label and distance and
+    // abort the algorithm
+    const real2_t<real_type> pos_01 = (state.pos - make_real<real_type, 2, float>(const_data[0])) * make_real<real_type, 2, float>(const_data[1]);
 
-            // Create texture for critical points and upload to GPU
-            this->num_convergence_points = static_cast<int>(point_ids.size());
+    if (pos_01.x < static_cast<real_type>(0.0) || pos_01.x > static_cast<real_type>(1.0) ||
+        pos_01.y < static_cast<real_type>(0.0) || pos_01.y > static_cast<real_type>(1.0))
+    {
+        state.termination = 1;
 
-            if (!points.empty())
-            {
-                std::vector<float2> h_convergence_points(this->num_convergence_points);
-                std::vector<float> h_ids(this->num_convergence_points);
+#if __streamlines_cuda_shi_et_al
+        state.label = -1;
+        state.dist = 0.0;
+#endif
 
-                for (int i = 0; i < this->num_convergence_points; ++i)
-                {
-                    h_ids[i] = static_cast<float>(point_ids[i]);
-                    h_convergence_points[i] = make_float2(points[i * 2 + 0], points[i * 2 + 1]);
-                }
+        return true;
+    }
 
-                initialize_texture((void*)h_convergence_points.data(), this->num_convergence_points,
-                    sizeof(float), sizeof(float), 0, 0, &this->convergence_points_texture, (void**)&this->d_convergence_points);
+    // If the stream line converged to its labelled structure, its label cannot change anymore
+    if (check_convergence(pos, state))
+    {
+        state.termination = 5;
 
-                initialize_texture((void*)h_ids.data(), this->num_convergence_points,
-                    sizeof(float), 0, 0, 0, &this->convergence_point_ids_texture, (void**)&this->d_convergence_point_ids);
+        return true;
+    }
 
-                cudaMemcpyToSymbol(textures, &this->convergence_points_texture, sizeof(cudaTextureObject_t), 2 * sizeof(cudaTextureObject_t));
-                cudaMemcpyToSymbol(textures, &this->convergence_point_ids_texture, sizeof(cudaTextureObject_t), 3 * sizeof(cudaTextureObject_t));
-            }
+    // If the end of the time window is reached, stop for continuing in the next window
+    if (time_window.enabled && remaining_time(state.time, state.sign) <= static_cast<real_type>(1.0e-6f * (time_window.times[1] - time_window.times[0])))
+    {
+        state.termination = 4;
 
-            // Create texture for line segments and upload to GPU
-            this->num_convergence_lines = static_cast<int>(line_ids.size());
+        return true;
+    }
 
-            if (!lines.empty())
-            {
-                std::vector<float2> h_convergence_lines(this->num_convergence_lines * 2);
-                std::vector<float> h_ids(this->num_convergence_lines);
+    return false;
+}
+
+/**
+* Store the values of a stream line
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param gid                    Index of the stream line
+* @param state                  Stream line state
+* @param particles              Output end positions
+* @param labels                 Output labels
+* @param distances              Output distances
+* @param terminations           Output terminations
+*/
+template <typename real_type>
+__device__
+void end_streamline(const int num_convergence_points, const int num_convergence_lines, const int gid, streamline_state<real_type>& state,
+    float2* particles, float* labels, float* distances, float* terminations)
+{
+#if __streamlines_cuda_shi_et_al
+    // Update values by evaluating the distance to convergence structures at the final position
+    update_label_and_dist(num_convergence_points, num_convergence_lines, make_real<float, 2, real_type>(state.pos), state.label, state.dist);
+#endif
+
+    // Store and return calculated values
+    labels[gid] = state.label;
+    distances[gid] = state.dist;
+    terminations[gid] = state.termination;
+    particles[gid] = make_real<float, 2, real_type>(state.pos);
+}
+
+/**
+* Compute stream lines and update labels and distances, using one thread per stream line
+*
+* @tparam real_type             Floating point type of position, time and step size during integration
+* @tparam sample_type           Floating point type for interpolating the single-precision texels
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param base_sign              Sign of the integration direction for the first particles, negated for the others
+* @param particles              Seed particles, consecutively stored per direction
+* @param num_particles          Total number of seed particles
+* @param num_first_particles    Number of seed particles integrated in the direction of the base sign
+* @param num_steps              Number of advection steps
+* @param labels                 Output labels
+* @param distances              Output distances
+* @param terminations           Output terminations
+* @param method                 Integration method
+*/
+template <typename real_type, typename sample_type>
+__global__
+void compute_streamlines_kernel(const int num_convergence_points, const int num_convergence_lines, const float base_sign,
+    float2* particles, const int num_particles, const int num_first_particles, const int num_steps,
+    float* labels, float* distances, float* terminations, const int method)
+{
+    // Get kernel ID
+    const int gid = blockIdx.x * blockDim.x + threadIdx.x;
+
+    if (gid < num_particles && terminations[gid] == 0)
+    {
+        streamline_state<real_type> state;
+
+        begin_streamline<real_type, sample_type>(num_convergence_points, num_convergence_lines, gid, gid < num_first_particles ? base_sign : -base_sign,
+            particles, labels, distances, terminations, state);
+
+        for (int j = 0; j < num_steps; ++j)
+        {
+            if (advance_streamline<real_type, sample_type>(num_convergence_points, num_convergence_lines, method, state))
+            {
+                break;
+            }
+        }
+
+        end_streamline(num_convergence_points, num_convergence_lines, gid, state, particles, labels, distances, terminations);
+    }
+}
+
+/**
+* Compute stream lines and update labels and distances, using persistent threads which fetch a
+* new stream line from the work queue as soon as their current stream line terminated
+*
+* @tparam real_type             Floating point type of position, time and step size during integration
+* @tparam sample_type           Floating point type for interpolating the single-precision texels
+*
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param base_sign              Sign of the integration direction for the first particles, negated for the others
+* @param particles              Seed particles, consecutively stored per direction
+* @param num_particles          Total number of seed particles
+* @param num_first_particles    Number of seed particles integrated in the direction of the base sign
+* @param num_steps              Number of advection steps
+* @param labels                 Output labels
+* @param distances              Output distances
+* @param terminations           Output terminations
+* @param method                 Integration method
+* @param work_counter           Index of the next stream line to process, initially zero
+*/
+template <typename real_type, typename sample_type>
+__global__
+void compute_streamlines_persistent_kernel(const int num_convergence_points, const int num_convergence_lines, const float base_sign,
+    float2* particles, const int num_particles, const int num_first_particles, const int num_steps,
+    float* labels, float* distances, float* terminations, const int method, int* work_counter)
+{
+    streamline_state<real_type> state;
+
+    int gid = atomicAdd(work_counter, 1);
+    int j = 0;
+    bool active = false;
+
+    // Perform single steps, such that threads of a warp whose stream lines terminated are refilled immediately
+    while (gid < num_particles)
+    {
+        if (!active)
+        {
+            if (terminations[gid] != 0)
+            {
+                gid = atomicAdd(work_counter, 1);
+                continue;
+            }
+
+            begin_streamline<real_type, sample_type>(num_convergence_points, num_convergence_lines, gid, gid < num_first_particles ? base_sign : -base_sign,
+                particles, labels, distances, terminations, state);
+
+            active = true;
+            j = 0;
+        }
+
+        const bool terminated = j >= num_steps || advance_streamline<real_type, sample_type>(num_convergence_points, num_convergence_lines, method, state);
+
+        if (terminated || ++j >= num_steps)
+        {
+            end_streamline(num_convergence_points, num_convergence_lines, gid, state, particles, labels, distances, terminations);
+
+            active = false;
+            gid = atomicAdd(work_counter, 1);
+        }
+    }
+}
+
+/**
+* Launch the stream line kernel for the given precision
+*
+* @tparam real_type             Floating point type of position, time and step size during integration
+* @tparam sample_type           Floating point type for interpolating the single-precision texels
+*
+* @param num_blocks             Number of blocks
+* @param num_threads            Number of threads per block
+* @param stream                 Stream on which the kernel is launched
+* @param num_convergence_points Number of critical points
+* @param num_convergence_lines  Number of segments (lines)
+* @param base_sign              Sign of the integration direction for the first particles, negated for the others
+* @param particles              Seed particles, consecutively stored per direction
+* @param num_particles          Total number of seed particles
+* @param num_first_particles    Number of seed particles integrated in the direction of the base sign
+* @param num_steps              Number of advection steps
+* @param labels                 Output labels
+* @param distances              Output distances
+* @param terminations           Output terminations
+* @param method                 Integration method
+* @param work_counter           Index of the next stream line to process, only used by the persistent-thread kernel
+*/
+template <typename real_type, typename sample_type>
+void launch_streamlines_kernel(const int num_blocks, const int num_threads, const cudaStream_t stream,
+    const int num_convergence_points, const int num_convergence_lines, const float base_sign, float2* particles,
+    const int num_particles, const int num_first_particles, const int num_steps, float* labels, float* distances,
+    float* terminations, const int method, int* work_counter)
+{
+#if __streamlines_cuda_persistent_threads
+    compute_streamlines_persistent_kernel<real_type, sample_type> __cuda_kernel_start_stream(num_blocks, num_threads, stream) (num_convergence_points,
+        num_convergence_lines, base_sign, particles, num_particles, num_first_particles, num_steps, labels, distances,
+        terminations, method, work_counter);
+#else
+    compute_streamlines_kernel<real_type, sample_type> __cuda_kernel_start_stream(num_blocks, num_threads, stream) (num_convergence_points,
+        num_convergence_lines, base_sign, particles, num_particles, num_first_particles, num_steps, labels, distances,
+        terminations, method);
+#endif
+}
+
+/**
+* Get the number of blocks of the persistent-thread kernel which can be resident on a multiprocessor
+*
+* @tparam real_type             Floating point type of position, time and step size during integration
+* @tparam sample_type           Floating point type for interpolating the single-precision texels
+*
+* @param num_threads            Number of threads per block
+*
+* @return Number of resident blocks, or a negative value if the query failed
+*/
+template <typename real_type, typename sample_type>
+int get_num_resident_blocks(const int num_threads)
+{
+    int num_blocks_per_multiprocessor = 0;
+
+    if (cudaOccupancyMaxActiveBlocksPerMultiprocessor(&num_blocks_per_multiprocessor,
+        compute_streamlines_persistent_kernel<real_type, sample_type>, num_threads, 0) != cudaSuccess)
+    {
+        return -1;
+    }
+
+    return num_blocks_per_multiprocessor;
+}
+
+/**
+* Throw an exception if a CUDA runtime call failed
+*
+* @param err        Return value of the CUDA runtime call
+* @param message    Message describing the failed operation
+*/
+inline
+void cuda_check(const cudaError_t err, const char* message)
+{
+    if (err)
+    {
+        std::stringstream ss;
+        ss << message << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+// ################################################################################################################################
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        static std::vector<std::unique_ptr<streamlines_cuda_impl>> impls;
+        static std::atomic<unsigned int> current_instance(0);
+
+        /**
+        * Run the given function concurrently for all devices, one thread per device, and rethrow the first error
+        *
+        * @param func   Function to run, taking the implementation of the respective device
+        */
+        template <typename func_t>
+        static void for_each_device(const func_t& func)
+        {
+            if (impls.size() == 1)
+            {
+                func(*impls.front());
+                return;
+            }
+
+            std::vector<std::exception_ptr> errors(impls.size());
+            std::vector<std::thread> threads;
+
+            for (std::size_t i = 1; i < impls.size(); ++i)
+            {
+                threads.emplace_back([&func, &errors, i]()
+                {
+                    try
+                    {
+                        func(*impls[i]);
+                    }
+                    catch (...)
+                    {
+                        errors[i] = std::current_exception();
+                    }
+                });
+            }
+
+            try
+            {
+                func(*impls.front());
+            }
+            catch (...)
+            {
+                errors.front() = std::current_exception();
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        streamlines_cuda::streamlines_cuda(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+            const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
+            const std::vector<float>& lines, const std::vector<int>& line_ids, const float integration_timestep,
+            const float max_integration_error, const integration_method method, const vector_storage storage)
+            : storage(storage)
+        {
+            // Release previous instances first, freeing their device memory
+            impls.clear();
+
+            this->instance = ++current_instance;
+
+            int num_devices = 0;
+            cuda_check(cudaGetDeviceCount(&num_devices), "Error getting number of CUDA devices.");
+
+            // Each device gets its own copy of the vector field and convergence structures
+            for (int device = 0; device < num_devices; ++device)
+            {
+                impls.push_back(std::make_unique<streamlines_cuda_impl>(device, resolution, domain, vectors,
+                    points, point_ids, lines, line_ids, integration_timestep, max_integration_error, method, storage));
+            }
+        }
+
+        unsigned int streamlines_cuda::get_number_of_available_devices()
+        {
+            int num_devices = 0;
+
+            if (cudaGetDeviceCount(&num_devices) != cudaSuccess)
+            {
+                // Reset error state
+                cudaGetLastError();
+
+                return 0;
+            }
+
+            return static_cast<unsigned int>(num_devices);
+        }
+
+        streamlines_cuda::vector_storage streamlines_cuda::get_vector_storage() const
+        {
+            return this->storage;
+        }
+
+        bool streamlines_cuda::is_current() const
+        {
+            return this->instance == current_instance;
+        }
+
+        unsigned int streamlines_cuda::get_number_of_devices() const
+        {
+            return static_cast<unsigned int>(impls.size());
+        }
+
+        void streamlines_cuda::set_integration_parameters(const float integration_timestep, const float max_integration_error,
+            const integration_method method)
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.set_integration_parameters(integration_timestep, max_integration_error, method);
+            });
+        }
+
+        void streamlines_cuda::set_precision(const precision integration_precision)
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.set_precision(integration_precision);
+            });
+        }
+
+        void streamlines_cuda::set_convergence_criteria(const float distance, const unsigned int num_steps, const float radius)
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.set_convergence_criteria(distance, num_steps, radius);
+            });
+        }
+
+        void streamlines_cuda::set_time_window(const std::vector<float>& first_vectors, const float first_time,
+            const std::vector<float>& second_vectors, const float second_time)
+        {
+            if (!(second_time > first_time))
+            {
+                throw std::runtime_error("The frames of the time window must be given in increasing order of time.");
+            }
+
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.set_time_window(first_vectors, first_time, second_vectors, second_time);
+            });
+        }
+
+        void streamlines_cuda::set_time_window_times(const float first_time, const float second_time)
+        {
+            if (!(second_time > first_time))
+            {
+                throw std::runtime_error("The frames of the time window must be given in increasing order of time.");
+            }
+
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.set_time_window_times(first_time, second_time);
+            });
+        }
+
+        void streamlines_cuda::prefetch_frame(const std::vector<float>& vectors, const float time)
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.prefetch_frame(vectors, time);
+            });
+        }
+
+        void streamlines_cuda::advance_time_window()
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.advance_time_window();
+            });
+        }
+
+        void streamlines_cuda::clear_time_window()
+        {
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.clear_time_window();
+            });
+        }
+
+        streamlines_cuda::statistics streamlines_cuda::get_statistics() const
+        {
+            statistics stats{};
+
+            for (const auto& impl : impls)
+            {
+                const auto& device_stats = impl->get_statistics();
+
+                stats.upload_time += device_stats.upload_time;
+                stats.kernel_time += device_stats.kernel_time;
+                stats.download_time += device_stats.download_time;
+                stats.bytes_uploaded += device_stats.bytes_uploaded;
+                stats.bytes_downloaded += device_stats.bytes_downloaded;
+            }
+
+            return stats;
+        }
+
+        void streamlines_cuda::reset_statistics()
+        {
+            for (auto& impl : impls)
+            {
+                impl->reset_statistics();
+            }
+        }
+
+        void streamlines_cuda::update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+            std::vector<float>& terminations, const int num_integration_steps, const float sign, const unsigned int num_particles_per_batch)
+        {
+            // Devices fetch batches from the same queue, as early terminating stream lines make static partitions uneven
+            std::atomic<unsigned int> next_offset(0);
+
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.update_labels(source, labels, distances, terminations, num_integration_steps, sign, num_particles_per_batch, next_offset);
+            });
+        }
+
+        void streamlines_cuda::update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+            std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+            std::vector<float>& source_backward, std::vector<float>& labels_backward,
+            std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+            const int num_integration_steps, const bool identical_seeds, const unsigned int num_particles_per_batch)
+        {
+            // Devices fetch batches from the same queue, as early terminating stream lines make static partitions uneven
+            std::atomic<unsigned int> next_offset(0);
+
+            for_each_device([&](streamlines_cuda_impl& impl)
+            {
+                impl.update_labels_bidirectional(source_forward, labels_forward, distances_forward, terminations_forward,
+                    source_backward, labels_backward, distances_backward, terminations_backward,
+                    num_integration_steps, identical_seeds, num_particles_per_batch, next_offset);
+            });
+        }
+    }
+}
+
+// ################################################################################################################################
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        streamlines_cuda_impl::streamlines_cuda_impl(const int device, const std::array<unsigned int, 2>& resolution,
+            const std::array<float, 4>& domain, const std::vector<float>& vectors, const std::vector<float>& points,
+            const std::vector<int>& point_ids, const std::vector<float>& lines, const std::vector<int>& line_ids,
+            const float integration_timestep, const float max_integration_error, const streamlines_cuda::integration_method method,
+            const streamlines_cuda::vector_storage storage)
+            : device(device), resolution(resolution), d_velocity(nullptr), d_convergence_points(nullptr),
+            d_convergence_lines(nullptr), d_convergence_line_ids(nullptr), d_grid_offsets(nullptr), d_grid_items(nullptr), d_frames(nullptr),
+            time_window_enabled(false), time_window_layers{ 0, 1 }, time_window_times{ 0.0f, 0.0f }, prefetch_stream(nullptr),
+            h_prefetch_frame(nullptr), prefetch_pending(false), prefetch_time(0.0f), method(method),
+            integration_precision(streamlines_cuda::precision::SINGLE), storage(storage)
+        {
+            // All following resources, including constant memory, are created on the given device
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            // Create streams with initially empty buffers
+            for (auto& buffers : this->buffers)
+            {
+                std::memset(&buffers, 0, sizeof(stream_buffers));
+
+                cuda_check(cudaStreamCreateWithFlags(&buffers.stream, cudaStreamNonBlocking), "Error creating CUDA stream.");
+
+                for (auto& event : buffers.events)
+                {
+                    cuda_check(cudaEventCreate(&event), "Error creating CUDA event.");
+                }
+            }
+
+            cuda_check(cudaStreamCreateWithFlags(&this->prefetch_stream, cudaStreamNonBlocking), "Error creating CUDA stream.");
+
+            reset_statistics();
+
+            // Integrate in the steady vector field, until a time window is set, and without early termination
+            update_time_window();
+            set_convergence_criteria(0.0f, 0, 0.0f);
+
+            // Get the number of blocks which can be resident at once, for the persistent-thread kernel;
+            // double-precision variants use more registers and thus fewer blocks may be resident
+            int num_multiprocessors = 0;
+
+            cuda_check(cudaDeviceGetAttribute(&num_multiprocessors, cudaDevAttrMultiProcessorCount, this->device),
+                "Error getting number of multiprocessors.");
+
+            const std::array<int, 3> num_blocks_per_multiprocessor = { get_num_resident_blocks<float, float>(64),
+                get_num_resident_blocks<double, float>(64), get_num_resident_blocks<double, double>(64) };
+
+            for (std::size_t i = 0; i < num_blocks_per_multiprocessor.size(); ++i)
+            {
+                if (num_blocks_per_multiprocessor[i] < 0)
+                {
+                    throw std::runtime_error("Error getting occupancy of the stream line kernel.");
+                }
+
+                this->num_persistent_blocks[i] = std::max(1, num_multiprocessors * num_blocks_per_multiprocessor[i]);
+            }
+
+            // Create constants and upload them to GPU
+            const float cellx = (domain[2] - domain[0]) / (this->resolution[0] - 1);
+            const float celly = (domain[3] - domain[1]) / (this->resolution[1] - 1);
+
+            const float2 domain_offset = make_real<float, 2>(domain[0], domain[1]);
+            const float2 domain_scale = make_real<float, 2>(1.0f / (domain[2] - domain[0]), 1.0f / (domain[3] - domain[1]));
+            const float2 texture_offset = make_real<float, 2>(-0.5f, -0.5f);
+            const float2 texture_scale = make_real<float, 2>(this->resolution[0] - 1, this->resolution[1] - 1);
+            const float2 time_scale = make_real<float, 2>(integration_timestep);
+            const float2 max_error = make_real<float, 2>(max_integration_error);
+            const float2 cell_size = make_real<float, 2>(cellx, celly);
+
+            const std::array<float2, 7> h_const_data = { domain_offset, domain_scale, texture_offset, texture_scale, time_scale, max_error, cell_size };
+
+            cudaMemcpyToSymbol(const_data, h_const_data.data(), h_const_data.size() * sizeof(float2));
+
+            // Create velocity texture in the selected storage format and upload to GPU; the initial Runge-Kutta
+            // step size is the same for all cells, and thus computed from the cell size in constant memory
+            static_assert(sizeof(float2) == 2 * sizeof(float), "CUDA type 'float2' must only consist of two 'float' members.");
+
+            std::vector<__half> h_half_vectors;
+
+            initialize_texture(convert_vectors(vectors.data(), vectors.size(), h_half_vectors), 2, &this->velocity_texture, &this->d_velocity);
+            cudaMemcpyToSymbol(textures, &this->velocity_texture, sizeof(cudaTextureObject_t));
+
+            // Create texture for critical points and upload to GPU
+            this->num_convergence_points = static_cast<int>(point_ids.size());
+
+            if (!points.empty())
+            {
+                std::vector<float2> h_convergence_points(this->num_convergence_points);
+                std::vector<float> h_ids(this->num_convergence_points);
+
+                for (int i = 0; i < this->num_convergence_points; ++i)
+                {
+                    h_ids[i] = static_cast<float>(point_ids[i]);
+                    h_convergence_points[i] = make_float2(points[i * 2 + 0], points[i * 2 + 1]);
+                }
+
+                initialize_texture((void*)h_convergence_points.data(), this->num_convergence_points,
+                    sizeof(float), sizeof(float), 0, 0, &this->convergence_points_texture, (void**)&this->d_convergence_points);
+
+                initialize_texture((void*)h_ids.data(), this->num_convergence_points,
+                    sizeof(float), 0, 0, 0, &this->convergence_point_ids_texture, (void**)&this->d_convergence_point_ids);
+
+                cudaMemcpyToSymbol(textures, &this->convergence_points_texture, sizeof(cudaTextureObject_t), 1 * sizeof(cudaTextureObject_t));
+                cudaMemcpyToSymbol(textures, &this->convergence_point_ids_texture, sizeof(cudaTextureObject_t), 2 * sizeof(cudaTextureObject_t));
+            }
+
+            // Create texture for line segments and upload to GPU
+            this->num_convergence_lines = static_cast<int>(line_ids.size());
+
+            if (!lines.empty())
+            {
+                std::vector<float2> h_convergence_lines(this->num_convergence_lines * 2);
+                std::vector<float> h_ids(this->num_convergence_lines);
 
                 for (int i = 0; i < this->num_convergence_lines; ++i)
                 {
@@ -490,25 +1276,42 @@ namespace megamol
                 initialize_texture((void*)h_ids.data(), this->num_convergence_lines,
                     sizeof(float), 0, 0, 0, &this->convergence_line_ids_texture, (void**)&this->d_convergence_line_ids);
 
-                cudaMemcpyToSymbol(textures, &this->convergence_lines_texture, sizeof(cudaTextureObject_t), 4 * sizeof(cudaTextureObject_t));
-                cudaMemcpyToSymbol(textures, &this->convergence_line_ids_texture, sizeof(cudaTextureObject_t), 5 * sizeof(cudaTextureObject_t));
+                cudaMemcpyToSymbol(textures, &this->convergence_lines_texture, sizeof(cudaTextureObject_t), 3 * sizeof(cudaTextureObject_t));
+                cudaMemcpyToSymbol(textures, &this->convergence_line_ids_texture, sizeof(cudaTextureObject_t), 4 * sizeof(cudaTextureObject_t));
+            }
+
+            // Create uniform grid for accelerating nearest convergence structure queries
+            initialize_grid(domain, points, lines);
+        }
+
+        streamlines_cuda_impl::~streamlines_cuda_impl()
+        {
+            cudaSetDevice(this->device);
+
+            release_buffers();
+
+            for (auto& buffers : this->buffers)
+            {
+                if (buffers.stream != nullptr)
+                {
+                    cudaStreamDestroy(buffers.stream);
+                }
+
+                for (auto& event : buffers.events)
+                {
+                    if (event != nullptr)
+                    {
+                        cudaEventDestroy(event);
+                    }
+                }
             }
-        }
 
-        streamlines_cuda_impl::~streamlines_cuda_impl()
-        {
             if (this->d_velocity)
             {
                 cudaDestroyTextureObject(this->velocity_texture);
                 cudaFreeArray(this->d_velocity);
             }
 
-            if (this->d_rk4_step)
-            {
-                cudaDestroyTextureObject(this->rk4_step_texture);
-                cudaFreeArray(this->d_rk4_step);
-            }
-
             if (this->d_convergence_points)
             {
                 cudaDestroyTextureObject(this->convergence_points_texture);
@@ -524,143 +1327,593 @@ namespace megamol
                 cudaDestroyTextureObject(this->convergence_line_ids_texture);
                 cudaFree(this->d_convergence_line_ids);
             }
+
+            cudaFree(this->d_grid_offsets);
+            cudaFree(this->d_grid_items);
+
+            if (this->prefetch_stream != nullptr)
+            {
+                cudaStreamSynchronize(this->prefetch_stream);
+                cudaStreamDestroy(this->prefetch_stream);
+            }
+
+            cudaFreeHost(this->h_prefetch_frame);
+
+            if (this->d_frames)
+            {
+                cudaDestroyTextureObject(this->frames_texture);
+                cudaFreeArray(this->d_frames);
+            }
         }
 
-        void streamlines_cuda_impl::update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
-            std::vector<float>& terminations, const int num_integration_steps, const float sign, unsigned int num_particles_per_batch)
+        void streamlines_cuda_impl::set_integration_parameters(const float integration_timestep, const float max_integration_error,
+            const streamlines_cuda::integration_method method)
         {
-            // Subdivide the input
-            const unsigned int num_particles = static_cast<unsigned int>(source.size() / 2);
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
 
-            cudaError_t err;
-            std::stringstream ss;
+            // Only overwrite the time step information in constant memory, leaving textures and grid untouched
+            const std::array<float2, 2> h_const_data = { make_real<float, 2>(integration_timestep), make_real<float, 2>(max_integration_error) };
 
-            const std::size_t max_num_particles_per_batch = std::min(num_particles_per_batch, num_particles);
+            cuda_check(cudaMemcpyToSymbol(const_data, h_const_data.data(), h_const_data.size() * sizeof(float2), 4 * sizeof(float2)),
+                "Error updating integration parameters.");
 
-            // Allocate memory
-            float *d_labels;
-            err = cudaMalloc((void**)&d_labels, max_num_particles_per_batch * sizeof(float));
-            if (err)
+            this->method = method;
+        }
+
+        void streamlines_cuda_impl::set_precision(const streamlines_cuda::precision integration_precision)
+        {
+            this->integration_precision = integration_precision;
+        }
+
+        void streamlines_cuda_impl::set_time_window(const std::vector<float>& first_vectors, const float first_time,
+            const std::vector<float>& second_vectors, const float second_time)
+        {
+            const std::size_t num_values = static_cast<std::size_t>(this->resolution[0]) * this->resolution[1] * 2;
+
+            if (first_vectors.size() != num_values || second_vectors.size() != num_values)
             {
-                ss << "Error allocating memory using cudaMalloc for labels." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                throw std::runtime_error(ss.str());
+                throw std::runtime_error("Frames of the time window must match the resolution of the vector field.");
             }
 
-            float *d_dists;
-            err = cudaMalloc((void**)&d_dists, max_num_particles_per_batch * sizeof(float));
-            if (err)
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            initialize_frames_texture();
+
+            // Discard a pending prefetch, as it does not follow the new window
+            cuda_check(cudaStreamSynchronize(this->prefetch_stream), "Error prefetching frame.");
+            this->prefetch_pending = false;
+
+            std::vector<__half> h_half_frame;
+
+            upload_frame(convert_vectors(first_vectors.data(), num_values, h_half_frame), 0, nullptr);
+            upload_frame(convert_vectors(second_vectors.data(), num_values, h_half_frame), 1, nullptr);
+
+            this->time_window_enabled = true;
+            this->time_window_layers = { 0, 1 };
+            this->time_window_times = { first_time, second_time };
+
+            update_time_window();
+        }
+
+        void streamlines_cuda_impl::set_time_window_times(const float first_time, const float second_time)
+        {
+            if (!this->time_window_enabled)
             {
-                ss << "Error allocating memory using cudaMalloc for distances." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                throw std::runtime_error(ss.str());
+                throw std::runtime_error("A time window must be set before changing its times.");
             }
 
-            float *d_terminations;
-            err = cudaMalloc((void**)&d_terminations, max_num_particles_per_batch * sizeof(float));
-            if (err)
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            // Discard a pending prefetch, as it does not follow the changed window
+            cuda_check(cudaStreamSynchronize(this->prefetch_stream), "Error prefetching frame.");
+            this->prefetch_pending = false;
+
+            this->time_window_times = { first_time, second_time };
+
+            update_time_window();
+        }
+
+        void streamlines_cuda_impl::prefetch_frame(const std::vector<float>& vectors, const float time)
+        {
+            const std::size_t num_values = static_cast<std::size_t>(this->resolution[0]) * this->resolution[1] * 2;
+
+            if (!this->time_window_enabled)
             {
-                ss << "Error allocating memory using cudaMalloc for termination reasons." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                throw std::runtime_error(ss.str());
+                throw std::runtime_error("A time window must be set before prefetching frames.");
             }
 
-            float2 *d_particles;
-            err = cudaMalloc((void**)&d_particles, max_num_particles_per_batch * sizeof(float2));
-            if (err)
+            if (vectors.size() != num_values)
             {
-                ss << "Error allocating memory using cudaMalloc for particles." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                throw std::runtime_error(ss.str());
+                throw std::runtime_error("Prefetched frame must match the resolution of the vector field.");
             }
 
-            for (unsigned int offset = 0; offset < num_particles; offset += num_particles_per_batch)
+            if (!(time > this->time_window_times[1]))
             {
-                const int num_particles_this_batch = std::min(num_particles_per_batch, num_particles - offset);
+                throw std::runtime_error("Prefetched frame must follow the time window.");
+            }
 
-                // Copy data to GPU memory
-                err = cudaMemcpy(d_labels, &labels[offset], num_particles_this_batch * sizeof(float), cudaMemcpyHostToDevice);
-                if (err)
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            // Wait for a previous prefetch, before overwriting its staging memory
+            cuda_check(cudaStreamSynchronize(this->prefetch_stream), "Error prefetching frame.");
+
+            if (this->h_prefetch_frame == nullptr)
+            {
+                cuda_check(cudaMallocHost(&this->h_prefetch_frame, num_values * get_component_size()),
+                    "Error allocating pinned memory using cudaMallocHost for prefetching frames.");
+            }
+
+            if (this->storage == streamlines_cuda::vector_storage::HALF)
+            {
+                __half* h_half_frame = static_cast<__half*>(this->h_prefetch_frame);
+
+                for (std::size_t i = 0; i < num_values; ++i)
+                {
+                    h_half_frame[i] = __float2half_rn(vectors[i]);
+                }
+            }
+            else
+            {
+                std::memcpy(this->h_prefetch_frame, vectors.data(), num_values * sizeof(float));
+            }
+
+            // The layer not used by the current window is free
+            const int spare_layer = num_frame_layers - this->time_window_layers[0] - this->time_window_layers[1];
+
+            upload_frame(this->h_prefetch_frame, spare_layer, this->prefetch_stream);
+
+            this->stats.bytes_uploaded += num_values * get_component_size();
+
+            this->prefetch_pending = true;
+            this->prefetch_time = time;
+        }
+
+        void streamlines_cuda_impl::advance_time_window()
+        {
+            if (!this->prefetch_pending)
+            {
+                throw std::runtime_error("The next frame must be prefetched before advancing the time window.");
+            }
+
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+            cuda_check(cudaStreamSynchronize(this->prefetch_stream), "Error prefetching frame.");
+
+            const int spare_layer = num_frame_layers - this->time_window_layers[0] - this->time_window_layers[1];
+
+            this->time_window_layers = { this->time_window_layers[1], spare_layer };
+            this->time_window_times = { this->time_window_times[1], this->prefetch_time };
+
+            this->prefetch_pending = false;
+
+            update_time_window();
+        }
+
+        void streamlines_cuda_impl::clear_time_window()
+        {
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+            cuda_check(cudaStreamSynchronize(this->prefetch_stream), "Error prefetching frame.");
+
+            this->time_window_enabled = false;
+            this->prefetch_pending = false;
+
+            update_time_window();
+        }
+
+        const streamlines_cuda::statistics& streamlines_cuda_impl::get_statistics() const
+        {
+            return this->stats;
+        }
+
+        void streamlines_cuda_impl::reset_statistics()
+        {
+            this->stats = streamlines_cuda::statistics{};
+        }
+
+        void streamlines_cuda_impl::update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+            std::vector<float>& terminations, const int num_integration_steps, const float sign, const unsigned int num_particles_per_batch,
+            std::atomic<unsigned int>& next_offset)
+        {
+            const std::array<direction_data, 2> data = {
+                direction_data{ &source, &labels, &distances, &terminations },
+                direction_data{ nullptr, nullptr, nullptr, nullptr } };
+
+            update_labels(data, 1, false, num_integration_steps, sign, num_particles_per_batch, next_offset);
+        }
+
+        void streamlines_cuda_impl::update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+            std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+            std::vector<float>& source_backward, std::vector<float>& labels_backward,
+            std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+            const int num_integration_steps, const bool identical_seeds, const unsigned int num_particles_per_batch,
+            std::atomic<unsigned int>& next_offset)
+        {
+            if (source_forward.size() != source_backward.size())
+            {
+                throw std::runtime_error("Forward and backward seed must be of the same size for bidirectional integration.");
+            }
+
+            const std::array<direction_data, 2> data = {
+                direction_data{ &source_forward, &labels_forward, &distances_forward, &terminations_forward },
+                direction_data{ &source_backward, &labels_backward, &distances_backward, &terminations_backward } };
+
+            update_labels(data, 2, identical_seeds, num_integration_steps, 1.0f, num_particles_per_batch, next_offset);
+        }
+
+        void streamlines_cuda_impl::update_labels(const std::array<direction_data, 2>& data, const unsigned int num_directions,
+            const bool identical_seeds, const int num_integration_steps, const float sign, unsigned int num_particles_per_batch,
+            std::atomic<unsigned int>& next_offset)
+        {
+            // Subdivide the input
+            const unsigned int num_particles = static_cast<unsigned int>(data[0].source->size() / 2);
+
+            if (num_particles == 0)
+            {
+                return;
+            }
+
+            num_particles_per_batch = std::max(1u, std::min(num_particles_per_batch, num_particles));
+
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            // Make sure that the persistent buffers are large enough
+            reserve_buffers(num_particles_per_batch);
+
+            // Process batches round-robin on the streams, such that uploading, computing and downloading overlap.
+            // Batches are fetched from the queue shared with the other devices, until all batches are processed.
+            unsigned int batch = 0;
+
+            for (unsigned int offset = next_offset.fetch_add(num_particles_per_batch); offset < num_particles;
+                offset = next_offset.fetch_add(num_particles_per_batch), ++batch)
+            {
+                auto& buffers = this->buffers[batch % num_streams];
+
+                // Wait for the previous batch of this stream before reusing its buffers
+                finish_batch(buffers, data, num_directions);
+
+                const unsigned int num_particles_this_batch = std::min(num_particles_per_batch, num_particles - offset);
+
+                // Stage only active seeds in pinned memory, consecutively for each direction; already terminated
+                // stream lines are neither uploaded, nor processed by the kernel
+                unsigned int num_total_active = 0;
+
+                for (unsigned int d = 0; d < num_directions; ++d)
                 {
-                    ss << "Error copying to GPU memory using cudaMemcpy for labels." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    const auto& terminations = *data[d].terminations;
+
+                    unsigned int* indices = buffers.h_indices + d * num_particles_this_batch;
+                    unsigned int num_active = 0;
+
+                    for (unsigned int i = 0; i < num_particles_this_batch; ++i)
+                    {
+                        // Path lines stopped at the end of the previous time window are continued
+                        if (terminations[offset + i] == 0.0f || (this->time_window_enabled && terminations[offset + i] == 4.0f))
+                        {
+                            indices[num_active++] = i;
+                        }
+                    }
+
+                    buffers.pending_num_active[d] = num_active;
+                    num_total_active += num_active;
                 }
 
-                err = cudaMemcpy(d_dists, &distances[offset], num_particles_this_batch * sizeof(float), cudaMemcpyHostToDevice);
-                if (err)
+                if (num_total_active == 0)
                 {
-                    ss << "Error copying to GPU memory using cudaMemcpy for distances." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    continue;
                 }
 
-                err = cudaMemcpy(d_terminations, &terminations[offset], num_particles_this_batch * sizeof(float), cudaMemcpyHostToDevice);
-                if (err)
+                // Identical seeds only need to be uploaded once, if the same stream lines are active in both directions
+                const bool upload_once = identical_seeds && num_directions == 2 && buffers.pending_num_active[0] == buffers.pending_num_active[1] &&
+                    std::equal(buffers.h_indices, buffers.h_indices + buffers.pending_num_active[0], buffers.h_indices + num_particles_this_batch);
+
+                const unsigned int num_uploaded_particles = upload_once ? buffers.pending_num_active[0] : num_total_active;
+
+                for (unsigned int d = 0, buffer_offset = 0; d < num_directions; buffer_offset += buffers.pending_num_active[d++])
                 {
-                    ss << "Error copying to GPU memory using cudaMemcpy for termination reasons." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    const unsigned int* indices = buffers.h_indices + d * num_particles_this_batch;
+                    const bool upload_particles = d == 0 || !upload_once;
+
+                    for (unsigned int i = 0; i < buffers.pending_num_active[d]; ++i)
+                    {
+                        const unsigned int index = offset + indices[i];
+
+                        buffers.h_labels[buffer_offset + i] = (*data[d].labels)[index];
+                        buffers.h_dists[buffer_offset + i] = (*data[d].distances)[index];
+                        buffers.h_terminations[buffer_offset + i] = 0.0f;
+
+                        if (upload_particles)
+                        {
+                            buffers.h_particles[buffer_offset + i] = make_float2((*data[d].source)[2 * index + 0], (*data[d].source)[2 * index + 1]);
+                        }
+                    }
                 }
 
-                err = cudaMemcpy(d_particles, &source[2 * offset], num_particles_this_batch * sizeof(float2), cudaMemcpyHostToDevice);
-                if (err)
+                // Copy data to GPU memory
+                cuda_check(cudaEventRecord(buffers.events[0], buffers.stream), "Error recording CUDA event.");
+
+                cuda_check(cudaMemcpyAsync(buffers.d_labels, buffers.h_labels, num_total_active * sizeof(float),
+                    cudaMemcpyHostToDevice, buffers.stream), "Error copying to GPU memory using cudaMemcpyAsync for labels.");
+
+                cuda_check(cudaMemcpyAsync(buffers.d_dists, buffers.h_dists, num_total_active * sizeof(float),
+                    cudaMemcpyHostToDevice, buffers.stream), "Error copying to GPU memory using cudaMemcpyAsync for distances.");
+
+                cuda_check(cudaMemcpyAsync(buffers.d_terminations, buffers.h_terminations, num_total_active * sizeof(float),
+                    cudaMemcpyHostToDevice, buffers.stream), "Error copying to GPU memory using cudaMemcpyAsync for termination reasons.");
+
+                cuda_check(cudaMemcpyAsync(buffers.d_particles, buffers.h_particles, num_uploaded_particles * sizeof(float2),
+                    cudaMemcpyHostToDevice, buffers.stream), "Error copying to GPU memory using cudaMemcpyAsync for particles.");
+
+                // Duplicate identical seed on the GPU instead of uploading it twice
+                if (num_uploaded_particles != num_total_active)
                 {
-                    ss << "Error copying to GPU memory using cudaMemcpy for particles." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    cuda_check(cudaMemcpyAsync(buffers.d_particles + num_uploaded_particles, buffers.d_particles,
+                        num_uploaded_particles * sizeof(float2), cudaMemcpyDeviceToDevice, buffers.stream),
+                        "Error copying GPU memory using cudaMemcpyAsync for particles.");
                 }
 
+                this->stats.bytes_uploaded += 3 * num_total_active * sizeof(float) + num_uploaded_particles * sizeof(float2);
+
                 //--------------------------------------------------------------------------
 
-                compute_streamlines(d_particles, num_particles_this_batch, this->num_convergence_points, this->num_convergence_lines,
-                    num_integration_steps, sign, d_labels, d_dists, d_terminations, this->method);
-                
+                cuda_check(cudaEventRecord(buffers.events[1], buffers.stream), "Error recording CUDA event.");
+
+                compute_streamlines(buffers, num_total_active, buffers.pending_num_active[0], this->num_convergence_points,
+                    this->num_convergence_lines, num_integration_steps, sign, this->method, this->integration_precision);
+
+                cuda_check(cudaGetLastError(), "Error launching kernel for stream line computation.");
+
+                cuda_check(cudaEventRecord(buffers.events[2], buffers.stream), "Error recording CUDA event.");
+
                 //--------------------------------------------------------------------------
 
                 // Copy data from GPU memory
-                err = cudaMemcpy(&labels[offset], d_labels, num_particles_this_batch * sizeof(float), cudaMemcpyDeviceToHost);
-                if (err)
+                cuda_check(cudaMemcpyAsync(buffers.h_labels, buffers.d_labels, num_total_active * sizeof(float),
+                    cudaMemcpyDeviceToHost, buffers.stream), "Error copying from GPU memory using cudaMemcpyAsync for labels.");
+
+                cuda_check(cudaMemcpyAsync(buffers.h_dists, buffers.d_dists, num_total_active * sizeof(float),
+                    cudaMemcpyDeviceToHost, buffers.stream), "Error copying from GPU memory using cudaMemcpyAsync for distances.");
+
+                cuda_check(cudaMemcpyAsync(buffers.h_terminations, buffers.d_terminations, num_total_active * sizeof(float),
+                    cudaMemcpyDeviceToHost, buffers.stream), "Error copying from GPU memory using cudaMemcpyAsync for termination reasons.");
+
+                cuda_check(cudaMemcpyAsync(buffers.h_particles, buffers.d_particles, num_total_active * sizeof(float2),
+                    cudaMemcpyDeviceToHost, buffers.stream), "Error copying from GPU memory using cudaMemcpyAsync for particles.");
+
+                cuda_check(cudaEventRecord(buffers.events[3], buffers.stream), "Error recording CUDA event.");
+
+                this->stats.bytes_downloaded += 3 * num_total_active * sizeof(float) + num_total_active * sizeof(float2);
+
+                buffers.pending_offset = offset;
+                buffers.pending_num_particles = num_particles_this_batch;
+            }
+
+            // Wait for all remaining batches
+            for (auto& buffers : this->buffers)
+            {
+                finish_batch(buffers, data, num_directions);
+            }
+        }
+
+        void streamlines_cuda_impl::reserve_buffers(const std::size_t num_particles)
+        {
+            for (auto& buffers : this->buffers)
+            {
+                if (buffers.capacity >= num_particles)
                 {
-                    ss << "Error copying from GPU memory using cudaMemcpy for labels." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    continue;
                 }
 
-                err = cudaMemcpy(&distances[offset], d_dists, num_particles_this_batch * sizeof(float), cudaMemcpyDeviceToHost);
-                if (err)
+                // Free too small buffers
+                cudaFree(buffers.d_particles);
+                cudaFree(buffers.d_labels);
+                cudaFree(buffers.d_dists);
+                cudaFree(buffers.d_terminations);
+
+                cudaFreeHost(buffers.h_particles);
+                cudaFreeHost(buffers.h_labels);
+                cudaFreeHost(buffers.h_dists);
+                cudaFreeHost(buffers.h_terminations);
+                cudaFreeHost(buffers.h_indices);
+
+                buffers.d_particles = buffers.h_particles = nullptr;
+                buffers.d_labels = buffers.d_dists = buffers.d_terminations = nullptr;
+                buffers.h_labels = buffers.h_dists = buffers.h_terminations = nullptr;
+                buffers.h_indices = nullptr;
+                buffers.capacity = 0;
+
+                // Allocate device memory
+                cuda_check(cudaMalloc((void**)&buffers.d_labels, 2 * num_particles * sizeof(float)),
+                    "Error allocating memory using cudaMalloc for labels.");
+
+                cuda_check(cudaMalloc((void**)&buffers.d_dists, 2 * num_particles * sizeof(float)),
+                    "Error allocating memory using cudaMalloc for distances.");
+
+                cuda_check(cudaMalloc((void**)&buffers.d_terminations, 2 * num_particles * sizeof(float)),
+                    "Error allocating memory using cudaMalloc for termination reasons.");
+
+                cuda_check(cudaMalloc((void**)&buffers.d_particles, 2 * num_particles * sizeof(float2)),
+                    "Error allocating memory using cudaMalloc for particles.");
+
+                // Allocate pinned host memory
+                cuda_check(cudaMallocHost((void**)&buffers.h_labels, 2 * num_particles * sizeof(float)),
+                    "Error allocating pinned memory using cudaMallocHost for labels.");
+
+                cuda_check(cudaMallocHost((void**)&buffers.h_dists, 2 * num_particles * sizeof(float)),
+                    "Error allocating pinned memory using cudaMallocHost for distances.");
+
+                cuda_check(cudaMallocHost((void**)&buffers.h_terminations, 2 * num_particles * sizeof(float)),
+                    "Error allocating pinned memory using cudaMallocHost for termination reasons.");
+
+                cuda_check(cudaMallocHost((void**)&buffers.h_particles, 2 * num_particles * sizeof(float2)),
+                    "Error allocating pinned memory using cudaMallocHost for particles.");
+
+                cuda_check(cudaMallocHost((void**)&buffers.h_indices, 2 * num_particles * sizeof(unsigned int)),
+                    "Error allocating pinned memory using cudaMallocHost for indices of active particles.");
+
+                if (buffers.d_work_counter == nullptr)
                 {
-                    ss << "Error copying from GPU memory using cudaMemcpy for distances." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    cuda_check(cudaMalloc((void**)&buffers.d_work_counter, sizeof(int)),
+                        "Error allocating memory using cudaMalloc for work counter.");
                 }
 
-                err = cudaMemcpy(&terminations[offset], d_terminations, num_particles_this_batch * sizeof(float), cudaMemcpyDeviceToHost);
-                if (err)
+                buffers.capacity = num_particles;
+            }
+        }
+
+        void streamlines_cuda_impl::release_buffers()
+        {
+            for (auto& buffers : this->buffers)
+            {
+                if (buffers.stream != nullptr)
                 {
-                    ss << "Error copying from GPU memory using cudaMemcpy for termination reasons." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    cudaStreamSynchronize(buffers.stream);
                 }
 
-                err = cudaMemcpy(&source[2 * offset], d_particles, num_particles_this_batch * sizeof(float2), cudaMemcpyDeviceToHost);
-                if (err)
+                cudaFree(buffers.d_particles);
+                cudaFree(buffers.d_labels);
+                cudaFree(buffers.d_dists);
+                cudaFree(buffers.d_terminations);
+
+                cudaFreeHost(buffers.h_particles);
+                cudaFreeHost(buffers.h_labels);
+                cudaFreeHost(buffers.h_dists);
+                cudaFreeHost(buffers.h_terminations);
+                cudaFreeHost(buffers.h_indices);
+                cudaFree(buffers.d_work_counter);
+
+                buffers.d_particles = buffers.h_particles = nullptr;
+                buffers.d_labels = buffers.d_dists = buffers.d_terminations = nullptr;
+                buffers.h_labels = buffers.h_dists = buffers.h_terminations = nullptr;
+                buffers.h_indices = nullptr;
+                buffers.d_work_counter = nullptr;
+                buffers.capacity = 0;
+                buffers.pending_num_particles = 0;
+            }
+        }
+
+        void streamlines_cuda_impl::finish_batch(stream_buffers& buffers, const std::array<direction_data, 2>& data, const unsigned int num_directions)
+        {
+            if (buffers.pending_num_particles == 0)
+            {
+                return;
+            }
+
+            cuda_check(cudaStreamSynchronize(buffers.stream), "Error computing stream lines.");
+
+            // Accumulate timings of the batch
+            float upload_time = 0.0f, kernel_time = 0.0f, download_time = 0.0f;
+
+            cuda_check(cudaEventElapsedTime(&upload_time, buffers.events[0], buffers.events[1]), "Error measuring upload time.");
+            cuda_check(cudaEventElapsedTime(&kernel_time, buffers.events[1], buffers.events[2]), "Error measuring kernel time.");
+            cuda_check(cudaEventElapsedTime(&download_time, buffers.events[2], buffers.events[3]), "Error measuring download time.");
+
+            this->stats.upload_time += upload_time;
+            this->stats.kernel_time += kernel_time;
+            this->stats.download_time += download_time;
+
+            const unsigned int offset = buffers.pending_offset;
+            const unsigned int num_particles = buffers.pending_num_particles;
+
+            // Scatter results of the active stream lines back to their original position
+            for (unsigned int d = 0, buffer_offset = 0; d < num_directions; buffer_offset += buffers.pending_num_active[d++])
+            {
+                const unsigned int* indices = buffers.h_indices + d * num_particles;
+
+                for (unsigned int i = 0; i < buffers.pending_num_active[d]; ++i)
                 {
-                    ss << "Error copying from GPU memory using cudaMemcpy for particles." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
-                    throw std::runtime_error(ss.str());
+                    const unsigned int index = offset + indices[i];
+
+                    (*data[d].labels)[index] = buffers.h_labels[buffer_offset + i];
+                    (*data[d].distances)[index] = buffers.h_dists[buffer_offset + i];
+                    (*data[d].terminations)[index] = buffers.h_terminations[buffer_offset + i];
+                    (*data[d].source)[2 * index + 0] = buffers.h_particles[buffer_offset + i].x;
+                    (*data[d].source)[2 * index + 1] = buffers.h_particles[buffer_offset + i].y;
                 }
             }
 
-            cudaFree(d_labels);
-            cudaFree(d_dists);
-            cudaFree(d_terminations);
-            cudaFree(d_particles);
+            buffers.pending_num_particles = 0;
+        }
+
+        void streamlines_cuda_impl::compute_streamlines(stream_buffers& buffers, const int num_particles, const int num_first_particles,
+            const int num_convergence_points, const int num_convergence_lines, const int num_steps, const float sign,
+            const streamlines_cuda::integration_method method, const streamlines_cuda::precision integration_precision)
+        {
+            const int num_threads = 64;
+
+#if __streamlines_cuda_persistent_threads
+            // Run CUDA kernel with only as many threads as can be resident, fetching stream lines from a work queue
+            const int num_blocks = std::min(this->num_persistent_blocks[static_cast<std::size_t>(integration_precision)],
+                num_particles / num_threads + (num_particles % num_threads == 0 ? 0 : 1));
+
+            cuda_check(cudaMemsetAsync(buffers.d_work_counter, 0, sizeof(int), buffers.stream), "Error resetting work counter using cudaMemsetAsync.");
+#else
+            // Run CUDA kernel with one thread per stream line
+            const int num_blocks = num_particles / num_threads + (num_particles % num_threads == 0 ? 0 : 1);
+#endif
+
+            switch (integration_precision)
+            {
+            case streamlines_cuda::precision::SINGLE:
+                launch_streamlines_kernel<float, float>(num_blocks, num_threads, buffers.stream, num_convergence_points, num_convergence_lines,
+                    sign, buffers.d_particles, num_particles, num_first_particles, num_steps, buffers.d_labels, buffers.d_dists,
+                    buffers.d_terminations, static_cast<int>(method), buffers.d_work_counter);
+
+                break;
+            case streamlines_cuda::precision::MIXED:
+                launch_streamlines_kernel<double, float>(num_blocks, num_threads, buffers.stream, num_convergence_points, num_convergence_lines,
+                    sign, buffers.d_particles, num_particles, num_first_particles, num_steps, buffers.d_labels, buffers.d_dists,
+                    buffers.d_terminations, static_cast<int>(method), buffers.d_work_counter);
+
+                break;
+            case streamlines_cuda::precision::DOUBLE:
+                launch_streamlines_kernel<double, double>(num_blocks, num_threads, buffers.stream, num_convergence_points, num_convergence_lines,
+                    sign, buffers.d_particles, num_particles, num_first_particles, num_steps, buffers.d_labels, buffers.d_dists,
+                    buffers.d_terminations, static_cast<int>(method), buffers.d_work_counter);
+
+                break;
+            }
         }
 
-        void streamlines_cuda_impl::compute_streamlines(float2* d_particles, const int num_particles, const int num_convergence_points, const int num_convergence_lines,
-            const int num_steps, const float sign, float* d_labels, float* d_dists, float* d_terminations, const streamlines_cuda::integration_method method)
+        void streamlines_cuda_impl::initialize_grid(const std::array<float, 4>& domain, const std::vector<float>& points, const std::vector<float>& lines)
         {
-            // Run CUDA kernel
-            int num_threads = 64;
-            int num_blocks = num_particles / num_threads + (num_particles % num_threads == 0 ? 0 : 1);
+            convergence_grid_t h_grid;
+            std::memset(&h_grid, 0, sizeof(convergence_grid_t));
+
+            const auto grid = create_convergence_grid(domain, points, lines);
+
+            if (grid.cell_offsets.empty())
+            {
+                cudaMemcpyToSymbol(convergence_grid, &h_grid, sizeof(convergence_grid_t));
+                return;
+            }
+
+            // Upload grid to GPU
+            cuda_check(cudaMalloc((void**)&this->d_grid_offsets, grid.cell_offsets.size() * sizeof(int)),
+                "Error allocating memory using cudaMalloc for the convergence structure grid.");
 
-            compute_streamlines_kernel __cuda_kernel_start(num_blocks, num_threads) (num_convergence_points, num_convergence_lines, sign,
-                d_particles, num_particles, num_steps, d_labels, d_dists, d_terminations, static_cast<int>(method));
+            cuda_check(cudaMalloc((void**)&this->d_grid_items, std::max(grid.cell_items.size(), static_cast<std::size_t>(1)) * sizeof(int)),
+                "Error allocating memory using cudaMalloc for the convergence structure grid.");
+
+            cuda_check(cudaMemcpy(this->d_grid_offsets, grid.cell_offsets.data(), grid.cell_offsets.size() * sizeof(int), cudaMemcpyHostToDevice),
+                "Error copying memory using cudaMemcpy for the convergence structure grid.");
+
+            cuda_check(cudaMemcpy(this->d_grid_items, grid.cell_items.data(), grid.cell_items.size() * sizeof(int), cudaMemcpyHostToDevice),
+                "Error copying memory using cudaMemcpy for the convergence structure grid.");
+
+            h_grid.origin = make_float2(grid.origin[0], grid.origin[1]);
+            h_grid.cell_size = make_float2(grid.cell_size[0], grid.cell_size[1]);
+            h_grid.resolution = make_int2(grid.resolution[0], grid.resolution[1]);
+            h_grid.cell_offsets = this->d_grid_offsets;
+            h_grid.cell_items = this->d_grid_items;
+
+            cudaMemcpyToSymbol(convergence_grid, &h_grid, sizeof(convergence_grid_t));
         }
 
         void streamlines_cuda_impl::initialize_texture(const void* h_data, const int num_components, cudaTextureObject_t* texture, cudaArray** d_data)
         {
-            cudaChannelFormatDesc desc = cudaCreateChannelDesc(sizeof(float) * 8, num_components > 1 ? sizeof(float) * 8 : 0,
-                num_components > 2 ? sizeof(float) * 8 : 0, num_components > 3 ? sizeof(float) * 8 : 0, cudaChannelFormatKindFloat);
+            const int num_bits = static_cast<int>(get_component_size() * 8);
+
+            cudaChannelFormatDesc desc = cudaCreateChannelDesc(num_bits, num_components > 1 ? num_bits : 0,
+                num_components > 2 ? num_bits : 0, num_components > 3 ? num_bits : 0, cudaChannelFormatKindFloat);
 
             cudaError_t err;
             std::stringstream ss;
@@ -668,15 +1921,15 @@ namespace megamol
             err = cudaMallocArray(d_data, &desc, static_cast<std::size_t>(this->resolution[0]), static_cast<std::size_t>(this->resolution[1]));
             if (err)
             {
-                ss << "Error allocating memory using cudaMalloc3DArray for velocity or RK4 step size." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
+                ss << "Error allocating memory using cudaMallocArray for velocity." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
                 throw std::runtime_error(ss.str());
             }
 
             err = cudaMemcpyToArray(*d_data, 0, 0, h_data, static_cast<std::size_t>(this->resolution[0]) *
-                static_cast<std::size_t>(this->resolution[1]) * sizeof(float) * num_components, cudaMemcpyHostToDevice);
+                static_cast<std::size_t>(this->resolution[1]) * get_component_size() * num_components, cudaMemcpyHostToDevice);
             if (err)
             {
-                ss << "Error copying memory using cudaMemcpy3D for velocity or RK4 step size." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
+                ss << "Error copying memory using cudaMemcpyToArray for velocity." << " (" << cudaGetErrorName(err) << ": " << cudaGetErrorString(err) << ")";
                 throw std::runtime_error(ss.str());
             }
 
@@ -696,6 +1949,112 @@ namespace megamol
             cudaCreateTextureObject(texture, &resDesc, &texDesc, nullptr);
         }
 
+        void streamlines_cuda_impl::initialize_frames_texture()
+        {
+            if (this->d_frames != nullptr)
+            {
+                return;
+            }
+
+            const int num_bits = static_cast<int>(get_component_size() * 8);
+
+            const cudaChannelFormatDesc desc = cudaCreateChannelDesc(num_bits, num_bits, 0, 0, cudaChannelFormatKindFloat);
+
+            cuda_check(cudaMalloc3DArray(&this->d_frames, &desc, make_cudaExtent(this->resolution[0], this->resolution[1], num_frame_layers),
+                cudaArrayLayered), "Error allocating memory using cudaMalloc3DArray for the frames of the time window.");
+
+            cudaResourceDesc resDesc;
+            memset(&resDesc, 0, sizeof(resDesc));
+            resDesc.resType = cudaResourceTypeArray;
+            resDesc.res.array.array = this->d_frames;
+
+            cudaTextureDesc texDesc;
+            memset(&texDesc, 0, sizeof(texDesc));
+            texDesc.addressMode[0] = cudaAddressModeBorder;
+            texDesc.addressMode[1] = cudaAddressModeBorder;
+            texDesc.readMode = cudaReadModeElementType;
+            texDesc.filterMode = cudaFilterModePoint;
+            texDesc.normalizedCoords = 0;
+
+            cuda_check(cudaCreateTextureObject(&this->frames_texture, &resDesc, &texDesc, nullptr),
+                "Error creating texture for the frames of the time window.");
+        }
+
+        void streamlines_cuda_impl::upload_frame(const void* h_frame, const int layer, const cudaStream_t stream)
+        {
+            cudaMemcpy3DParms parameters;
+            memset(&parameters, 0, sizeof(parameters));
+
+            parameters.srcPtr = make_cudaPitchedPtr(const_cast<void*>(h_frame), this->resolution[0] * 2 * get_component_size(),
+                this->resolution[0], this->resolution[1]);
+            parameters.dstArray = this->d_frames;
+            parameters.dstPos = make_cudaPos(0, 0, layer);
+            parameters.extent = make_cudaExtent(this->resolution[0], this->resolution[1], 1);
+            parameters.kind = cudaMemcpyHostToDevice;
+
+            if (stream != nullptr)
+            {
+                cuda_check(cudaMemcpy3DAsync(&parameters, stream), "Error copying frame using cudaMemcpy3DAsync.");
+            }
+            else
+            {
+                cuda_check(cudaMemcpy3D(&parameters), "Error copying frame using cudaMemcpy3D.");
+            }
+        }
+
+        std::size_t streamlines_cuda_impl::get_component_size() const
+        {
+            return this->storage == streamlines_cuda::vector_storage::HALF ? sizeof(__half) : sizeof(float);
+        }
+
+        const void* streamlines_cuda_impl::convert_vectors(const float* vectors, const std::size_t num_values, std::vector<__half>& buffer) const
+        {
+            if (this->storage != streamlines_cuda::vector_storage::HALF)
+            {
+                return vectors;
+            }
+
+            // Half-precision texels are promoted to single precision when fetched, such that sampling is unaffected
+            buffer.resize(num_values);
+
+            for (std::size_t i = 0; i < num_values; ++i)
+            {
+                buffer[i] = __float2half_rn(vectors[i]);
+            }
+
+            return buffer.data();
+        }
+
+        void streamlines_cuda_impl::set_convergence_criteria(const float distance, const unsigned int num_steps, const float radius)
+        {
+            cuda_check(cudaSetDevice(this->device), "Error setting CUDA device.");
+
+            // Only called between integrations, when no kernel reads the constant memory
+            convergence_criteria_t h_convergence_criteria;
+            h_convergence_criteria.distance = distance;
+            h_convergence_criteria.num_steps = static_cast<int>(num_steps);
+            h_convergence_criteria.radius = radius;
+
+            cuda_check(cudaMemcpyToSymbol(convergence_criteria, &h_convergence_criteria, sizeof(convergence_criteria_t)),
+                "Error setting convergence criteria.");
+        }
+
+        void streamlines_cuda_impl::update_time_window()
+        {
+            // Only called between integrations, when no kernel reads the constant memory
+            time_window_t h_time_window;
+            std::memset(&h_time_window, 0, sizeof(time_window_t));
+
+            h_time_window.enabled = this->time_window_enabled ? 1 : 0;
+            h_time_window.layers[0] = this->time_window_layers[0];
+            h_time_window.layers[1] = this->time_window_layers[1];
+            h_time_window.times[0] = this->time_window_times[0];
+            h_time_window.times[1] = this->time_window_times[1];
+            h_time_window.texture = this->d_frames != nullptr ? this->frames_texture : 0;
+
+            cuda_check(cudaMemcpyToSymbol(time_window, &h_time_window, sizeof(time_window_t)), "Error updating time window.");
+        }
+
         void streamlines_cuda_impl::initialize_texture(const void* h_data, const int num_elements, const int c0,
             const int c1, const int c2, const int c3, cudaTextureObject_t* texture, void** d_data)
         {
@@ -7,12 +7,14 @@
 #pragma once
 
 #include <cuda_runtime_api.h>
+#include <cuda_fp16.h>
 
 #include "streamlines.h"
 
 #include "real_type.h"
 
 #include <array>
+#include <atomic>
 #include <vector>
 
 namespace megamol
@@ -26,8 +28,9 @@ namespace megamol
         {
         public:
             /**
-            * Initialize constants and textures
+            * Initialize constants and textures on the given device
             *
+            * @param device                     CUDA device on which the computation is performed
             * @param resolution                 Domain resolution (number of vectors per direction)
             * @param domain                     Domain size (minimum and maximum coordinates)
             * @param vectors                    Vectors defining the vector field to analyze
@@ -38,17 +41,91 @@ namespace megamol
             * @param integration_timestep       Time step factor for advection
             * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
             * @param method                     Integration method
+            * @param storage                    Storage format of the vector field textures
             */
-            streamlines_cuda_impl(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+            streamlines_cuda_impl(int device, const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
                 const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
                 const std::vector<float>& lines, const std::vector<int>& line_ids, float integration_timestep,
-                float max_integration_error, streamlines_cuda::integration_method method);
+                float max_integration_error, streamlines_cuda::integration_method method, streamlines_cuda::vector_storage storage);
 
             /**
             * Destructor
             */
             ~streamlines_cuda_impl();
 
+            /**
+            * Set time step information and integration method for subsequent integrations on this device
+            *
+            * @param integration_timestep       Time step factor for advection
+            * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
+            * @param method                     Integration method
+            */
+            void set_integration_parameters(float integration_timestep, float max_integration_error, streamlines_cuda::integration_method method);
+
+            /**
+            * Set floating point precision for subsequent integrations on this device
+            *
+            * @param integration_precision      Floating point precision
+            */
+            void set_precision(streamlines_cuda::precision integration_precision);
+
+            /**
+            * Set criteria for terminating converged stream lines in constant memory
+            *
+            * @param distance                   Distance to the labelled structure below which stream lines converged; 0 to disable
+            * @param num_steps                  Number of steps within the radius without label change; 0 to disable
+            * @param radius                     Radius for the number of steps
+            */
+            void set_convergence_criteria(float distance, unsigned int num_steps, float radius);
+
+            /**
+            * Upload two frames of a time-dependent vector field and integrate path lines between them
+            *
+            * @param first_vectors              Vectors of the first frame
+            * @param first_time                 Time of the first frame
+            * @param second_vectors             Vectors of the second frame
+            * @param second_time                Time of the second frame
+            */
+            void set_time_window(const std::vector<float>& first_vectors, float first_time, const std::vector<float>& second_vectors, float second_time);
+
+            /**
+            * Change the times of the current time window, keeping its frames
+            *
+            * @param first_time                 New time of the first frame
+            * @param second_time                New time of the second frame
+            */
+            void set_time_window_times(float first_time, float second_time);
+
+            /**
+            * Upload the frame following the time window asynchronously into the spare layer
+            *
+            * @param vectors                    Vectors of the next frame
+            * @param time                       Time of the next frame
+            */
+            void prefetch_frame(const std::vector<float>& vectors, float time);
+
+            /**
+            * Advance the time window to the prefetched frame, after waiting for its upload
+            */
+            void advance_time_window();
+
+            /**
+            * Integrate stream lines in the steady vector field again
+            */
+            void clear_time_window();
+
+            /**
+            * Get timings and transfer volume of the batches processed on this device since the last reset
+            *
+            * @return Statistics
+            */
+            const streamlines_cuda::statistics& get_statistics() const;
+
+            /**
+            * Reset timings and transfer volume
+            */
+            void reset_statistics();
+
             /**
             * Update labels for the given seed
             *
@@ -58,33 +135,157 @@ namespace megamol
             * @param terminations               In/output termination reasons
             * @param num_integration_steps      Number of integration steps
             * @param sign                       Sign indicating forward (1) or backward (-1) integration
-            * @param num_particles_per_batch    Number of particles processed and uploaded to the GPU per batch
+            * @param num_particles_per_batch    Number of particles processed per batch and stream
+            * @param next_offset                Offset of the next batch to process, shared between devices for load balancing
             */
             void update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
-                std::vector<float>& terminations, int num_integration_steps, float sign, unsigned int num_particles_per_batch);
+                std::vector<float>& terminations, int num_integration_steps, float sign, unsigned int num_particles_per_batch,
+                std::atomic<unsigned int>& next_offset);
+
+            /**
+            * Update labels for the given forward and backward seed within the same kernel launch
+            *
+            * @param source_forward             In/output seed for advecting stream lines forward
+            * @param labels_forward             In/output labels of forward integration
+            * @param distances_forward          In/output distances of forward integration
+            * @param terminations_forward       In/output termination reasons of forward integration
+            * @param source_backward            In/output seed for advecting stream lines backward
+            * @param labels_backward            In/output labels of backward integration
+            * @param distances_backward         In/output distances of backward integration
+            * @param terminations_backward      In/output termination reasons of backward integration
+            * @param num_integration_steps      Number of integration steps
+            * @param identical_seeds            Forward and backward seed are identical, and only uploaded once
+            * @param num_particles_per_batch    Number of particles processed per batch and stream
+            * @param next_offset                Offset of the next batch to process, shared between devices for load balancing
+            */
+            void update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+                std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+                std::vector<float>& source_backward, std::vector<float>& labels_backward,
+                std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+                int num_integration_steps, bool identical_seeds, unsigned int num_particles_per_batch,
+                std::atomic<unsigned int>& next_offset);
 
         private:
+            /** Number of streams used for overlapping upload, computation and download of batches */
+            static constexpr unsigned int num_streams = 3;
+
+            /**
+            * In/output data of one integration direction
+            */
+            struct direction_data
+            {
+                std::vector<float>* source;
+                std::vector<float>* labels;
+                std::vector<float>* distances;
+                std::vector<float>* terminations;
+            };
+
+            /**
+            * Persistent device and pinned host buffers of a single stream.
+            * Each buffer holds the data of up to two integration directions,
+            * stored consecutively per batch.
+            */
+            struct stream_buffers
+            {
+                /** Stream on which the batch is processed */
+                cudaStream_t stream;
+
+                /** Device buffers */
+                float2* d_particles;
+                float* d_labels;
+                float* d_dists;
+                float* d_terminations;
+
+                /** Pinned host buffers for asynchronous transfer */
+                float2* h_particles;
+                float* h_labels;
+                float* h_dists;
+                float* h_terminations;
+
+                /** Indices of the active particles within the batch, per direction */
+                unsigned int* h_indices;
+
+                /** Work counter for the persistent-thread kernel */
+                int* d_work_counter;
+
+                /** Number of particles per direction the buffers can hold */
+                std::size_t capacity;
+
+                /** Batch currently in flight on this stream */
+                unsigned int pending_offset;
+                unsigned int pending_num_particles;
+                unsigned int pending_num_active[2];
+
+                /** Events recorded before upload, before and after the kernel, and after download of the pending batch */
+                std::array<cudaEvent_t, 4> events;
+            };
+
+            /**
+            * Update labels for one or two integration directions, processing batches on multiple streams
+            *
+            * @param data                       In/output data per direction
+            * @param num_directions             Number of directions (1 or 2)
+            * @param identical_seeds            Seeds of both directions are identical, and only uploaded once
+            * @param num_integration_steps      Number of integration steps
+            * @param sign                       Sign of the first direction; the second direction uses the opposite sign
+            * @param num_particles_per_batch    Number of particles per direction processed per batch and stream
+            * @param next_offset                Offset of the next batch to process, shared between devices for load balancing
+            */
+            void update_labels(const std::array<direction_data, 2>& data, unsigned int num_directions, bool identical_seeds,
+                int num_integration_steps, float sign, unsigned int num_particles_per_batch, std::atomic<unsigned int>& next_offset);
+
+            /**
+            * Make sure that the buffers of all streams can hold the given number of particles per direction.
+            * Buffers are only reallocated when they are too small.
+            *
+            * @param num_particles          Number of particles per batch and direction
+            */
+            void reserve_buffers(std::size_t num_particles);
+
+            /**
+            * Free the device and pinned host buffers of all streams
+            */
+            void release_buffers();
+
             /**
-            * Compute stream lines and update the given labels and distances
+            * Wait for the batch pending on the stream and copy its results to the output
             *
-            * @param d_particles            Initial seed positions for the stream lines
-            * @param num_particles          Number of seed particles
+            * @param buffers                Buffers of the stream
+            * @param data                   Output data per direction
+            * @param num_directions         Number of directions (1 or 2)
+            */
+            void finish_batch(stream_buffers& buffers, const std::array<direction_data, 2>& data, unsigned int num_directions);
+
+            /**
+            * Compute stream lines and update the given labels and distances, stored in the buffers of the stream
+            *
+            * @param buffers                Buffers of the stream on which the kernel is launched
+            * @param num_particles          Total number of seed particles
+            * @param num_first_particles    Number of seed particles integrated in the direction of the given sign, the others use the opposite sign
             * @param num_convergence_points Number of convergence structures represented by points
             * @param num_convergence_lines  Number of convergence structures represented by lines
             * @param num_steps              Number of integration steps
-            * @param sign                   Sign indicating forward (1) or backward (-1) integration
-            * @param d_labels               Output labels
-            * @param d_dists                Output distances
-            * @param d_terminations         Output reasons for stream line termination
+            * @param sign                   Sign indicating forward (1) or backward (-1) integration of the first particles
             * @param method                 Integration method
+            * @param integration_precision  Floating point precision
             */
-            void compute_streamlines(float2* d_particles, int num_particles, int num_convergence_points, int num_convergence_lines,
-                int num_steps, float sign, float* d_labels, float* d_dists, float* d_terminations, streamlines_cuda::integration_method method);
+            void compute_streamlines(stream_buffers& buffers, int num_particles, int num_first_particles, int num_convergence_points,
+                int num_convergence_lines, int num_steps, float sign, streamlines_cuda::integration_method method,
+                streamlines_cuda::precision integration_precision);
 
             /**
-            * Initialize a higher-dimensional texture
+            * Initialize the uniform grid over the convergence structures, used for nearest structure queries
             *
-            * @param h_data         Input data to generate the texture from
+            * @param domain         Domain size (minimum and maximum coordinates)
+            * @param points         Convergence structures defined as points
+            * @param lines          Convergence structures defined as lines
+            */
+            void initialize_grid(const std::array<float, 4>& domain, const std::vector<float>& points, const std::vector<float>& lines);
+
+            /**
+            * Initialize a higher-dimensional texture in the selected storage format
+            *
+            * @param h_data         Input data to generate the texture from, already in the storage format
             * @param num_components Number of components (=1 scaler, >1 vector)
             * @param texture        Output CUDA texture object
             * @param d_data         Output CUDA array
@@ -105,6 +306,49 @@ namespace megamol
             */
             void initialize_texture(const void* h_data, int num_elements, int c0, int c1, int c2, int c3, cudaTextureObject_t* texture, void** d_data);
 
+            /**
+            * Create the layered texture for the frames of the time window, if not already created
+            */
+            void initialize_frames_texture();
+
+            /**
+            * Copy a frame into a layer of the frames texture
+            *
+            * @param h_frame        Vectors of the frame
+            * @param layer          Target layer
+            * @param stream         Stream for asynchronous copies from pinned memory, or nullptr for synchronous copies
+            */
+            void upload_frame(const void* h_frame, int layer, cudaStream_t stream);
+
+            /**
+            * Get the size of a single vector component in the selected storage format
+            *
+            * @return Size in bytes
+            */
+            std::size_t get_component_size() const;
+
+            /**
+            * Convert vectors to the selected storage format
+            *
+            * @param vectors        Single-precision vectors
+            * @param num_values     Number of vector components
+            * @param buffer         Buffer for storing converted vectors, if necessary
+            *
+            * @return Pointer to the vectors in the storage format, i.e., either to the input or the buffer
+            */
+            const void* convert_vectors(const float* vectors, std::size_t num_values, std::vector<__half>& buffer) const;
+
+            /**
+            * Set the time window in constant memory
+            */
+            void update_time_window();
+
+            // CUDA device
+            int device;
+
+            // Number of resident blocks for the persistent-thread kernel, per precision
+            std::array<int, 3> num_persistent_blocks;
+
             // Vector field resolution
             std::array<unsigned int, 2> resolution;
 
@@ -116,9 +360,6 @@ namespace megamol
             cudaTextureObject_t velocity_texture;
             cudaArray* d_velocity;
 
-            cudaTextureObject_t rk4_step_texture;
-            cudaArray* d_rk4_step;
-
             cudaTextureObject_t convergence_point_ids_texture;
             float* d_convergence_point_ids;
             cudaTextureObject_t convergence_points_texture;
@@ -129,8 +370,38 @@ namespace megamol
             cudaTextureObject_t convergence_lines_texture;
             float2* d_convergence_lines;
 
-            // Integration method
+            // Uniform grid over the convergence structures
+            int* d_grid_offsets;
+            int* d_grid_items;
+
+            // Frames of time-dependent vector fields, stored in the layers of a texture: two for the
+            // current time window, and one spare layer for prefetching the next frame
+            static constexpr int num_frame_layers = 3;
+
+            cudaTextureObject_t frames_texture;
+            cudaArray* d_frames;
+
+            bool time_window_enabled;
+            std::array<int, 2> time_window_layers;
+            std::array<float, 2> time_window_times;
+
+            // Prefetching of the next frame on its own stream, from pinned memory
+            cudaStream_t prefetch_stream;
+            void* h_prefetch_frame;
+
+            bool prefetch_pending;
+            float prefetch_time;
+
+            // Integration method and precision, and storage format of the vector field
             streamlines_cuda::integration_method method;
+            streamlines_cuda::precision integration_precision;
+            streamlines_cuda::vector_storage storage;
+
+            // Persistent per-stream buffers
+            std::array<stream_buffers, num_streams> buffers;
+
+            // Timings and transfer volume
+            streamlines_cuda::statistics stats;
         };
     }
 }
@@ -9,7 +9,11 @@
 // Used algorithm
 #define __streamlines_cuda_shi_et_al 0                  // True: use method by Shi et al., else our method
 
+// Kernel scheduling
+#define __streamlines_cuda_persistent_threads 1         // True: refill threads from a work queue as stream lines terminate, else one thread per stream line
+
 #include <array>
+#include <cstdint>
 #include <vector>
 
 namespace megamol
@@ -17,7 +21,14 @@ namespace megamol
     namespace flowvis
     {
         /**
-        * Class for computation of stream lines, corresponding labels and distances on the GPU
+        * Class for computation of stream lines, corresponding labels and distances on the GPU.
+        * Batches of particles are distributed dynamically among all visible CUDA devices.
+        *
+        * For time-dependent vector fields, path lines are computed within a sliding window of two frames, between
+        * which the velocity is interpolated linearly in time. Particles reaching the end of the window terminate
+        * with reason 4, and are continued from there after advancing the window to the prefetched frame.
+        *
+        * The device state is shared by all instances, such that only the most recently created instance is valid.
         */
         class streamlines_cuda
         {
@@ -32,7 +43,41 @@ namespace megamol
             };
 
             /**
-            * Initialize constants and textures
+            * Floating point precision of the integration; the vector field is stored as selected by the vector storage
+            */
+            enum class precision
+            {
+                SINGLE,     // Single precision throughout
+                MIXED,      // Double-precision positions, times and Runge-Kutta stages, single-precision interpolation
+                DOUBLE      // Double-precision interpolation in addition
+            };
+
+            /**
+            * Storage format of the vector field textures, including the frames of time windows
+            */
+            enum class vector_storage
+            {
+                SINGLE,     // Single-precision texels
+                HALF        // Half-precision texels, halving the memory footprint; interpolated in the precision of the integration
+            };
+
+            /**
+            * Timings and transfer volume of the batches processed since the last reset, summed over all streams and devices
+            */
+            struct statistics
+            {
+                /** GPU time in milliseconds, measured with events around the transfers and the kernel of each batch */
+                double upload_time;
+                double kernel_time;
+                double download_time;
+
+                /** Bytes transferred between host and device */
+                std::uint64_t bytes_uploaded;
+                std::uint64_t bytes_downloaded;
+            };
+
+            /**
+            * Initialize constants and textures on all visible devices
             *
             * @param resolution                 Domain resolution (number of vectors per direction)
             * @param domain                     Domain size (minimum and maximum coordinates)
@@ -44,11 +89,122 @@ namespace megamol
             * @param integration_timestep       Time step factor for advection
             * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
             * @param method                     Integration method
+            * @param storage                    Storage format of the vector field textures
             */
             streamlines_cuda(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
                 const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
                 const std::vector<float>& lines, const std::vector<int>& line_ids, float integration_timestep,
-                float max_integration_error, integration_method method);
+                float max_integration_error, integration_method method, vector_storage storage = vector_storage::SINGLE);
+
+            /**
+            * Get number of visible CUDA devices, without initializing any of them
+            *
+            * @return Number of CUDA devices; zero if there is no device or no driver
+            */
+            static unsigned int get_number_of_available_devices();
+
+            /**
+            * Check if this instance is still valid, i.e., no other instance has been created since,
+            * replacing the vector field and state on the devices
+            *
+            * @return True if this is the most recently created instance, false otherwise
+            */
+            bool is_current() const;
+
+            /**
+            * Get the storage format of the vector field textures
+            *
+            * @return Storage format
+            */
+            vector_storage get_vector_storage() const;
+
+            /**
+            * Get number of devices used for computation
+            *
+            * @return Number of CUDA devices
+            */
+            unsigned int get_number_of_devices() const;
+
+            /**
+            * Set time step information and integration method for subsequent integrations,
+            * keeping the uploaded vector field and convergence structures
+            *
+            * @param integration_timestep       Time step factor for advection
+            * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
+            * @param method                     Integration method
+            */
+            void set_integration_parameters(float integration_timestep, float max_integration_error, integration_method method);
+
+            /**
+            * Set floating point precision for subsequent integrations, single precision by default.
+            * Positions are stored in single precision between integrations, i.e., between batches and time windows.
+            *
+            * @param integration_precision      Floating point precision
+            */
+            void set_precision(precision integration_precision);
+
+            /**
+            * Set criteria for terminating stream lines early for subsequent integrations, once they converged and their
+            * label cannot change anymore. Converged stream lines are terminated with reason 5. Disabled by default.
+            * The number of steps is counted within each integration, i.e., it restarts with every batch.
+            *
+            * @param distance                   Terminate if the distance to the labelled structure falls below this distance; 0 to disable
+            * @param num_steps                  Terminate if the label did not change for this number of steps, while the stream line
+            *                                   stayed within the radius; 0 to disable
+            * @param radius                     Radius for the number of steps
+            */
+            void set_convergence_criteria(float distance, unsigned int num_steps, float radius);
+
+            /**
+            * Integrate path lines between the two given frames of a time-dependent vector field, instead of stream lines
+            * in the steady vector field. Forward integration starts at the first frame, backward integration at the second.
+            *
+            * @param first_vectors              Vectors of the first frame
+            * @param first_time                 Time of the first frame
+            * @param second_vectors             Vectors of the second frame
+            * @param second_time                Time of the second frame, larger than that of the first
+            */
+            void set_time_window(const std::vector<float>& first_vectors, float first_time, const std::vector<float>& second_vectors, float second_time);
+
+            /**
+            * Change the times of the current time window, keeping its uploaded frames. Setting both frames to the same
+            * steady vector field, this integrates for a fixed time span, e.g., for computing flow maps.
+            *
+            * @param first_time                 New time of the first frame
+            * @param second_time                New time of the second frame, larger than that of the first
+            */
+            void set_time_window_times(float first_time, float second_time);
+
+            /**
+            * Upload the frame following the time window asynchronously, overlapping with the integration in the current window
+            *
+            * @param vectors                    Vectors of the next frame
+            * @param time                       Time of the next frame, larger than that of the second frame of the window
+            */
+            void prefetch_frame(const std::vector<float>& vectors, float time);
+
+            /**
+            * Advance the time window to span the second frame of the current window and the prefetched frame,
+            * waiting for the prefetch to finish. Particles terminated at the end of the previous window are continued.
+            */
+            void advance_time_window();
+
+            /**
+            * Integrate stream lines in the steady vector field again
+            */
+            void clear_time_window();
+
+            /**
+            * Get timings and transfer volume of all batches processed since the last reset
+            *
+            * @return Statistics summed over all devices
+            */
+            statistics get_statistics() const;
+
+            /**
+            * Reset timings and transfer volume
+            */
+            void reset_statistics();
 
             /**
             * Update labels for the given seed
@@ -59,10 +215,38 @@ namespace megamol
             * @param terminations               In/output termination reasons
             * @param num_integration_steps      Number of integration steps
             * @param sign                       Sign indicating forward (1) or backward (-1) integration
-            * @param num_particles_per_batch    Number of particles processed and uploaded to the GPU per batch
+            * @param num_particles_per_batch    Number of particles processed per batch; batches are pipelined on multiple streams and devices
             */
             void update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
                 std::vector<float>& terminations, int num_integration_steps, float sign, unsigned int num_particles_per_batch);
+
+            /**
+            * Update labels for the given forward and backward seed within the same kernel launch
+            *
+            * @param source_forward             In/output seed for advecting stream lines forward
+            * @param labels_forward             In/output labels of forward integration
+            * @param distances_forward          In/output distances of forward integration
+            * @param terminations_forward       In/output termination reasons of forward integration
+            * @param source_backward            In/output seed for advecting stream lines backward
+            * @param labels_backward            In/output labels of backward integration
+            * @param distances_backward         In/output distances of backward integration
+            * @param terminations_backward      In/output termination reasons of backward integration
+            * @param num_integration_steps      Number of integration steps
+            * @param identical_seeds            Forward and backward seed are identical, and only uploaded once
+            * @param num_particles_per_batch    Number of particles processed per batch; batches are pipelined on multiple streams and devices
+            */
+            void update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+                std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+                std::vector<float>& source_backward, std::vector<float>& labels_backward,
+                std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+                int num_integration_steps, bool identical_seeds, unsigned int num_particles_per_batch);
+
+        private:
+            /** Number of this instance, in order of creation */
+            unsigned int instance;
+
+            /** Storage format of the vector field textures */
+            vector_storage storage;
         };
     }
 }
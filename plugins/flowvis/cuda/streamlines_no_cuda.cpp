@@ -0,0 +1,117 @@
+/*
+ * streamlines_no_cuda.cpp
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#include "streamlines.h"
+
+#include <stdexcept>
+
+/**
+* Replacement of the CUDA implementation for builds without CUDA, reporting no devices,
+* such that the modules select the CPU implementation or report that a device is required
+*/
+namespace megamol
+{
+    namespace flowvis
+    {
+        namespace
+        {
+            [[noreturn]] void throw_unavailable()
+            {
+                throw std::runtime_error("The flowvis plugin was built without CUDA, the GPU integration is not available.");
+            }
+        }
+
+        streamlines_cuda::streamlines_cuda(const std::array<unsigned int, 2>&, const std::array<float, 4>&,
+            const std::vector<float>&, const std::vector<float>&, const std::vector<int>&,
+            const std::vector<float>&, const std::vector<int>&, float, float, integration_method, const vector_storage storage)
+            : instance(0), storage(storage)
+        {
+            throw_unavailable();
+        }
+
+        unsigned int streamlines_cuda::get_number_of_available_devices()
+        {
+            return 0;
+        }
+
+        bool streamlines_cuda::is_current() const
+        {
+            return false;
+        }
+
+        streamlines_cuda::vector_storage streamlines_cuda::get_vector_storage() const
+        {
+            return this->storage;
+        }
+
+        unsigned int streamlines_cuda::get_number_of_devices() const
+        {
+            return 0;
+        }
+
+        void streamlines_cuda::set_integration_parameters(float, float, integration_method)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::set_precision(precision)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::set_convergence_criteria(float, unsigned int, float)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::set_time_window(const std::vector<float>&, float, const std::vector<float>&, float)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::set_time_window_times(float, float)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::prefetch_frame(const std::vector<float>&, float)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::advance_time_window()
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::clear_time_window()
+        {
+            throw_unavailable();
+        }
+
+        streamlines_cuda::statistics streamlines_cuda::get_statistics() const
+        {
+            return statistics{};
+        }
+
+        void streamlines_cuda::reset_statistics()
+        {
+        }
+
+        void streamlines_cuda::update_labels(std::vector<float>&, std::vector<float>&, std::vector<float>&,
+            std::vector<float>&, int, float, unsigned int)
+        {
+            throw_unavailable();
+        }
+
+        void streamlines_cuda::update_labels_bidirectional(std::vector<float>&, std::vector<float>&,
+            std::vector<float>&, std::vector<float>&, std::vector<float>&, std::vector<float>&,
+            std::vector<float>&, std::vector<float>&, int, bool, unsigned int)
+        {
+            throw_unavailable();
+        }
+    }
+}
@@ -17,21 +17,22 @@ namespace flowvis {
  * Runge-Kutta 4 for fixed step size
  *
  * @tparam dimension Dimension of the vector field domain
+ * @tparam vector_field_t Vector field type, providing interpolate, find_cell and get_cell_sizes like tpf::data::grid
  *
  * @param vector_field Vector field
  * @param point Point to advect (will be modified)
  * @param delta Time step
  * @param forward Forward integration if true, reverse integration otherwise
  */
-template <int dimension>
-void advect_point_rk4(const tpf::data::grid<float, float, dimension, dimension>& vector_field,
-    Eigen::Matrix<float, dimension, 1>& point, const float delta, const bool forward);
+template <int dimension, typename vector_field_t>
+void advect_point_rk4(const vector_field_t& vector_field, Eigen::Matrix<float, dimension, 1>& point, const float delta,
+    const bool forward);
 
 /**
  * Runge-Kutta-Fehlberg 4-5 for dynamic step size
  *
  * @tparam dimension Dimension of the vector field domain
- * @tparam components Number of components (dimension of the vectors)
+ * @tparam vector_field_t Vector field type, providing interpolate like tpf::data::grid
  *
  * @param vector_field Vector field
  * @param point Point to advect (will be modified)
@@ -39,16 +40,16 @@ void advect_point_rk4(const tpf::data::grid<float, float, dimension, dimension>&
  * @param max_error Maximum allowed error, exceeding leads to time step adaption
  * @param forward Forward integration if true, reverse integration otherwise
  */
-template <int dimension>
-void advect_point_rk45(const tpf::data::grid<float, float, dimension, dimension>& vector_field,
-    Eigen::Matrix<float, dimension, 1>& point, float& delta, const float max_error, const bool forward);
+template <int dimension, typename vector_field_t>
+void advect_point_rk45(const vector_field_t& vector_field, Eigen::Matrix<float, dimension, 1>& point, float& delta,
+    const float max_error, const bool forward);
 
 } // namespace flowvis
 } // namespace megamol
 
-template <int dimension>
-void megamol::flowvis::advect_point_rk4(const tpf::data::grid<float, float, dimension, dimension>& vector_field,
-    Eigen::Matrix<float, dimension, 1>& point, const float delta, const bool forward) {
+template <int dimension, typename vector_field_t>
+void megamol::flowvis::advect_point_rk4(const vector_field_t& vector_field, Eigen::Matrix<float, dimension, 1>& point,
+    const float delta, const bool forward) {
 
     // Calculate step size
     const auto max_velocity = vector_field.interpolate(point).norm();
@@ -75,9 +76,9 @@ void megamol::flowvis::advect_point_rk4(const tpf::data::grid<float, float, dime
     point += advection;
 }
 
-template <int dimension>
-void megamol::flowvis::advect_point_rk45(const tpf::data::grid<float, float, dimension, dimension>& vector_field,
-    Eigen::Matrix<float, dimension, 1>& point, float& delta, const float max_error, const bool forward) {
+template <int dimension, typename vector_field_t>
+void megamol::flowvis::advect_point_rk45(const vector_field_t& vector_field, Eigen::Matrix<float, dimension, 1>& point,
+    float& delta, const float max_error, const bool forward) {
 
     // Cash-Karp parameters
     constexpr float b_21 = 0.2f;
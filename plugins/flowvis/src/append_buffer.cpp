@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "append_buffer.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        append_buffer::append_buffer() : buffer(0), mapping(nullptr), capacity(0), stored_size(0)
+        {
+        }
+
+        bool append_buffer::update(const void* data, const std::size_t size, std::size_t num_unchanged)
+        {
+            num_unchanged = std::min(num_unchanged, std::min(size, this->stored_size));
+
+            // Overwriting stored data, which could still be in use, or growing beyond the capacity requires a new buffer
+            const bool reallocate = this->buffer == 0 || size > this->capacity || num_unchanged < std::min(size, this->stored_size);
+
+            if (reallocate)
+            {
+                allocate(size > this->capacity ? std::max(size + size / 2, this->capacity * 2) : this->capacity);
+
+                num_unchanged = 0;
+            }
+
+            // Upload data after the unchanged range
+            if (size > num_unchanged)
+            {
+                if (this->mapping != nullptr)
+                {
+                    std::memcpy(static_cast<char*>(this->mapping) + num_unchanged, static_cast<const char*>(data) + num_unchanged, size - num_unchanged);
+                }
+                else
+                {
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+                    glBufferSubData(GL_COPY_WRITE_BUFFER, num_unchanged, size - num_unchanged, static_cast<const char*>(data) + num_unchanged);
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                }
+            }
+
+            this->stored_size = size;
+
+            return reallocate;
+        }
+
+        void append_buffer::release()
+        {
+            if (this->buffer != 0)
+            {
+                if (this->mapping != nullptr)
+                {
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+                    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                }
+
+                glDeleteBuffers(1, &this->buffer);
+            }
+
+            this->buffer = 0;
+            this->mapping = nullptr;
+            this->capacity = this->stored_size = 0;
+        }
+
+        GLuint append_buffer::get_handle() const
+        {
+            return this->buffer;
+        }
+
+        std::size_t append_buffer::size() const
+        {
+            return this->stored_size;
+        }
+
+        void append_buffer::allocate(const std::size_t capacity)
+        {
+            release();
+
+            this->capacity = std::max(capacity, static_cast<std::size_t>(1));
+
+            glGenBuffers(1, &this->buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+
+            if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+            {
+                const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+                glBufferStorage(GL_COPY_WRITE_BUFFER, this->capacity, nullptr, flags);
+                this->mapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, this->capacity, flags);
+            }
+            else
+            {
+                glBufferData(GL_COPY_WRITE_BUFFER, this->capacity, nullptr, GL_DYNAMIC_DRAW);
+            }
+
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+    }
+}
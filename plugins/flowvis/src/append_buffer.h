@@ -0,0 +1,89 @@
+/*
+ * append_buffer.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "glad/glad.h"
+
+#include <cstddef>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Over-allocated OpenGL buffer for data that mostly grows by appending.
+        * Where available, the buffer is persistently mapped, such that appended ranges are written directly.
+        * As draw calls only read the previously stored range, appending does not need synchronization.
+        * Changing stored data instead creates a new buffer, leaving the old one to the driver until it is unused.
+        *
+        * @author Alexander Straub
+        */
+        class append_buffer
+        {
+        public:
+            /**
+            * Constructor, not creating any OpenGL objects
+            */
+            append_buffer();
+
+            /**
+            * Destructor, not releasing any OpenGL objects; see release()
+            */
+            ~append_buffer() = default;
+
+            /** No copies */
+            append_buffer(const append_buffer&) = delete;
+            append_buffer& operator=(const append_buffer&) = delete;
+
+            /**
+            * Update the buffer contents, only uploading data after the unchanged range
+            *
+            * @param data           Data
+            * @param size           Size of the data in bytes
+            * @param num_unchanged  Number of leading bytes unchanged since the last update
+            *
+            * @return True if the buffer handle changed, such that it has to be rebound; false otherwise
+            */
+            bool update(const void* data, std::size_t size, std::size_t num_unchanged);
+
+            /**
+            * Release the buffer, requiring a valid OpenGL context
+            */
+            void release();
+
+            /**
+            * Get the buffer handle
+            *
+            * @return Buffer handle; 0 if no data has been uploaded yet
+            */
+            GLuint get_handle() const;
+
+            /**
+            * Get the size of the stored data
+            *
+            * @return Size in bytes
+            */
+            std::size_t size() const;
+
+        private:
+            /**
+            * Create a new buffer, replacing the old one
+            *
+            * @param capacity   Capacity in bytes
+            */
+            void allocate(std::size_t capacity);
+
+            /** Buffer handle, and persistently mapped memory if supported */
+            GLuint buffer;
+            void* mapping;
+
+            /** Capacity and size of the stored data in bytes */
+            std::size_t capacity;
+            std::size_t stored_size;
+        };
+    }
+}
@@ -0,0 +1,332 @@
+/*
+ * chunked_array.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Array stored in chunks of fixed size, which are shared between copies of the array.
+        * Copying thus creates a cheap snapshot, while writing to a chunk that is still shared
+        * with another snapshot copies that chunk first (copy-on-write). Chunks that are shared
+        * are never modified, so snapshots can be read concurrently to the array being written.
+        *
+        * @author Alexander Straub
+        */
+        template <typename T>
+        class chunked_array
+        {
+        public:
+            using chunk_t = std::vector<T>;
+
+            /** Default number of elements per chunk, as power of two */
+            static constexpr unsigned int default_chunk_shift = 20;
+
+            /**
+            * Constructor
+            *
+            * @param chunk_shift    Number of elements per chunk, as power of two
+            */
+            explicit chunked_array(const unsigned int chunk_shift = default_chunk_shift)
+                : chunk_shift(chunk_shift), chunk_mask((static_cast<std::size_t>(1) << chunk_shift) - 1), num_elements(0)
+            {
+            }
+
+            /**
+            * Constructor
+            *
+            * @param data           Data to copy into the chunks
+            * @param chunk_shift    Number of elements per chunk, as power of two
+            */
+            explicit chunked_array(const std::vector<T>& data, const unsigned int chunk_shift = default_chunk_shift)
+                : chunked_array(chunk_shift)
+            {
+                append(data.data(), data.size());
+            }
+
+            /**
+            * Get number of elements
+            *
+            * @return Number of elements
+            */
+            std::size_t size() const
+            {
+                return this->num_elements;
+            }
+
+            /**
+            * Check for elements
+            *
+            * @return True if there are no elements, false otherwise
+            */
+            bool empty() const
+            {
+                return this->num_elements == 0;
+            }
+
+            /**
+            * Get number of elements per chunk
+            *
+            * @return Number of elements per chunk
+            */
+            std::size_t get_chunk_size() const
+            {
+                return this->chunk_mask + 1;
+            }
+
+            /**
+            * Get number of chunks
+            *
+            * @return Number of chunks
+            */
+            std::size_t get_number_of_chunks() const
+            {
+                return this->chunks.size();
+            }
+
+            /**
+            * Get chunk for read access
+            *
+            * @param index  Index of the chunk
+            *
+            * @return Chunk
+            */
+            const chunk_t& get_chunk(const std::size_t index) const
+            {
+                return *this->chunks[index];
+            }
+
+            /**
+            * Get chunk for write access, copying it if it is shared with another snapshot
+            *
+            * @param index  Index of the chunk
+            *
+            * @return Chunk
+            */
+            chunk_t& get_writable_chunk(const std::size_t index)
+            {
+                auto& chunk = this->chunks[index];
+
+                if (chunk.use_count() > 1)
+                {
+                    chunk = std::make_shared<chunk_t>(*chunk);
+                }
+
+                return *chunk;
+            }
+
+            /**
+            * Replace a chunk, or append it as new last chunk, e.g., when receiving changed chunks of a snapshot.
+            * Only the last chunk may hold fewer elements than the chunk size.
+            *
+            * @param index  Index of the chunk, at most the current number of chunks
+            * @param chunk  New chunk
+            */
+            void replace_chunk(const std::size_t index, std::shared_ptr<chunk_t> chunk)
+            {
+                if (index == this->chunks.size())
+                {
+                    this->chunks.push_back(std::move(chunk));
+                }
+                else
+                {
+                    this->chunks[index] = std::move(chunk);
+                }
+
+                this->num_elements = ((this->chunks.size() - 1) << this->chunk_shift) + this->chunks.back()->size();
+            }
+
+            /**
+            * Check if the chunk is shared with the respective chunk of another array, i.e., if it is unchanged
+            *
+            * @param other  Other array
+            * @param index  Index of the chunk
+            *
+            * @return True if the chunk is shared, false otherwise
+            */
+            bool shares_chunk_with(const chunked_array& other, const std::size_t index) const
+            {
+                return index < this->chunks.size() && index < other.chunks.size() && this->chunks[index] == other.chunks[index];
+            }
+
+            /**
+            * Check if all chunks are shared with another array, i.e., if the array is unchanged
+            *
+            * @param other  Other array
+            *
+            * @return True if all chunks are shared, false otherwise
+            */
+            bool shares_data_with(const chunked_array& other) const
+            {
+                return this->num_elements == other.num_elements && this->chunks == other.chunks;
+            }
+
+            /**
+            * Check if the array was created from another array by only appending elements,
+            * i.e., if all elements of the other array are unchanged
+            *
+            * @param other  Other, previous array
+            *
+            * @return True if elements have only been appended, false otherwise
+            */
+            bool extends(const chunked_array& other) const
+            {
+                if (this->num_elements < other.num_elements || this->chunk_shift != other.chunk_shift)
+                {
+                    return false;
+                }
+
+                // Only the last chunk of the other array can have been copied, when elements were appended to it
+                for (std::size_t index = 0; index < other.chunks.size(); ++index)
+                {
+                    if (this->chunks[index] != other.chunks[index] && (index + 1 != other.chunks.size()
+                        || !std::equal(other.chunks[index]->begin(), other.chunks[index]->end(), this->chunks[index]->begin())))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+            * Read element
+            *
+            * @param index  Index of the element
+            *
+            * @return Element
+            */
+            const T& operator[](const std::size_t index) const
+            {
+                return (*this->chunks[index >> this->chunk_shift])[index & this->chunk_mask];
+            }
+
+            /**
+            * Write element, copying its chunk if it is shared with another snapshot
+            *
+            * @param index  Index of the element
+            * @param value  New value
+            */
+            void set(const std::size_t index, const T& value)
+            {
+                get_writable_chunk(index >> this->chunk_shift)[index & this->chunk_mask] = value;
+            }
+
+            /**
+            * Resize the array, initializing new elements with the given value
+            *
+            * @param size   New number of elements
+            * @param value  Value for new elements
+            */
+            void resize(const std::size_t size, const T& value = T())
+            {
+                if (size < this->num_elements)
+                {
+                    this->chunks.resize(num_chunks_for(size));
+
+                    if (!this->chunks.empty())
+                    {
+                        get_writable_chunk(this->chunks.size() - 1).resize(size - ((this->chunks.size() - 1) << this->chunk_shift));
+                    }
+
+                    this->num_elements = size;
+                }
+                else if (size > this->num_elements)
+                {
+                    const std::vector<T> values(size - this->num_elements, value);
+                    append(values.data(), values.size());
+                }
+            }
+
+            /**
+            * Append elements, filling up the last chunk first
+            *
+            * @param data   Elements to append
+            * @param num    Number of elements
+            */
+            void append(const T* data, std::size_t num)
+            {
+                const std::size_t chunk_size = get_chunk_size();
+
+                while (num > 0)
+                {
+                    if (this->chunks.empty() || this->chunks.back()->size() == chunk_size)
+                    {
+                        this->chunks.push_back(std::make_shared<chunk_t>());
+                        this->chunks.back()->reserve(std::min(num, chunk_size));
+                    }
+
+                    auto& chunk = get_writable_chunk(this->chunks.size() - 1);
+                    const std::size_t num_copy = std::min(num, chunk_size - chunk.size());
+
+                    chunk.insert(chunk.end(), data, data + num_copy);
+
+                    data += num_copy;
+                    num -= num_copy;
+                    this->num_elements += num_copy;
+                }
+            }
+
+            /**
+            * Append elements, filling up the last chunk first
+            *
+            * @param data   Elements to append
+            */
+            void append(const std::vector<T>& data)
+            {
+                append(data.data(), data.size());
+            }
+
+            /**
+            * Copy all elements into contiguous memory
+            *
+            * @return Contiguous copy of the elements
+            */
+            std::shared_ptr<std::vector<T>> to_vector() const
+            {
+                auto data = std::make_shared<std::vector<T>>();
+                data->reserve(this->num_elements);
+
+                for (const auto& chunk : this->chunks)
+                {
+                    data->insert(data->end(), chunk->begin(), chunk->end());
+                }
+
+                return data;
+            }
+
+        private:
+            /**
+            * Get number of chunks needed for storing the given number of elements
+            *
+            * @param size   Number of elements
+            *
+            * @return Number of chunks
+            */
+            std::size_t num_chunks_for(const std::size_t size) const
+            {
+                return (size + this->chunk_mask) >> this->chunk_shift;
+            }
+
+            /** Chunk size */
+            unsigned int chunk_shift;
+            std::size_t chunk_mask;
+
+            /** Number of elements */
+            std::size_t num_elements;
+
+            /** Shared chunks */
+            std::vector<std::shared_ptr<chunk_t>> chunks;
+        };
+    }
+}
@@ -13,7 +13,12 @@
 
 #include "Eigen/Dense"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 namespace megamol
 {
@@ -24,7 +29,8 @@ namespace megamol
             glyph_hash(-1),
             vector_field_slot("get_vector_field", "Vector field input"),
             vector_field_hash(-1),
-            boundary("boundary", "Number of boundary cells")
+            boundary("boundary", "Number of boundary cells"),
+            tile_size("tile_size", "Number of cell rows processed at once; 0 processes the whole field at once")
         {
             // Connect output
             this->glyph_slot.SetCallback(glyph_data_call::ClassName(), glyph_data_call::FunctionName(0), &critical_points::get_glyph_data_callback);
@@ -38,6 +44,9 @@ namespace megamol
             // Create parameter
             this->boundary << new core::param::IntParam(0);
             this->MakeSlotAvailable(&this->boundary);
+
+            this->tile_size << new core::param::IntParam(0, 0);
+            this->MakeSlotAvailable(&this->tile_size);
         }
 
         critical_points::~critical_points()
@@ -67,8 +76,16 @@ namespace megamol
                 {
                     this->vector_field_hash = get_vector_field->DataHash();
 
-                    const auto& positions = *get_vector_field->get_positions();
+                    if (get_vector_field->get_components() != 2)
+                    {
+                        vislib::sys::Log::DefaultLog.WriteError("Critical points can only be extracted from planar vector fields");
+
+                        return false;
+                    }
+
                     const auto& vectors = *get_vector_field->get_vectors();
+                    const auto& resolution = get_vector_field->get_resolution();
+                    const auto& bounding_rectangle = get_vector_field->get_bounding_rectangle();
 
                     // Reset output
                     this->glyph_output.clear();
@@ -79,36 +96,69 @@ namespace megamol
 
                     const unsigned int boundary_layer = static_cast<unsigned int>(this->boundary.Param<core::param::IntParam>()->Value());
 
-                    for (unsigned int y = boundary_layer; y < get_vector_field->get_resolution()[1] - 1 - boundary_layer; ++y)
+                    if (resolution[0] > 2 * boundary_layer + 1 && resolution[1] > 2 * boundary_layer + 1)
                     {
-                        for (unsigned int x = boundary_layer; x < get_vector_field->get_resolution()[0] - 1 - boundary_layer; ++x)
+                        const unsigned int x_begin = boundary_layer;
+                        const unsigned int x_end = resolution[0] - 1 - boundary_layer;
+                        const unsigned int y_begin = boundary_layer;
+                        const unsigned int y_end = resolution[1] - 1 - boundary_layer;
+
+                        const float x_step = bounding_rectangle.Width() / (resolution[0] - 1);
+                        const float y_step = bounding_rectangle.Height() / (resolution[1] - 1);
+
+                        const unsigned int tile_size = this->tile_size.Param<core::param::IntParam>()->Value() > 0
+                            ? static_cast<unsigned int>(this->tile_size.Param<core::param::IntParam>()->Value()) : (y_end - y_begin);
+
+                        std::vector<std::size_t> candidates;
+                        std::vector<std::pair<type, Eigen::Vector2f>> tile_critical_points;
+
+                        for (unsigned int tile_begin = y_begin; tile_begin < y_end; tile_begin += tile_size)
                         {
-                            const auto index_bottom_left = x + y * get_vector_field->get_resolution()[0];
-                            const auto index_bottom_right = x + 1 + y * get_vector_field->get_resolution()[0];
-                            const auto index_top_left = x + (y + 1) * get_vector_field->get_resolution()[0];
-                            const auto index_top_right = x + 1 + (y + 1) * get_vector_field->get_resolution()[0];
-
-                            const cell_t cell = {
-                                Eigen::Vector2f(vectors[index_bottom_left * 2 + 0], vectors[index_bottom_left * 2 + 1]),
-                                Eigen::Vector2f(vectors[index_bottom_right * 2 + 0], vectors[index_bottom_right * 2 + 1]),
-                                Eigen::Vector2f(vectors[index_top_left * 2 + 0], vectors[index_top_left * 2 + 1]),
-                                Eigen::Vector2f(vectors[index_top_right * 2 + 0], vectors[index_top_right * 2 + 1]),
-                                Eigen::Vector2f(positions[index_bottom_left * 2 + 0], positions[index_bottom_left * 2 + 1]),
-                                Eigen::Vector2f(positions[index_top_right * 2 + 0], positions[index_top_right * 2 + 1])
-                            };
-
-                            const auto critical_point = extract_critical_point(cell);
-
-                            if (critical_point.first != type::NONE && critical_point.first != type::UNHANDLED)
-                            {
-                                this->glyph_output.push_back(critical_point);
+                            const unsigned int tile_end = std::min(tile_begin + tile_size, y_end);
 
-                                this->glyph_hash = static_cast<SIZE_T>(core::utility::DataHash(this->glyph_hash,
-                                    critical_point.first, critical_point.second[0], critical_point.second[1]));
+                            // Find candidate cells in the current tile
+                            find_candidate_cells(vectors, resolution, x_begin, x_end, tile_begin, tile_end, candidates);
+
+                            // Classify candidate cells in parallel
+                            tile_critical_points.resize(candidates.size());
+
+                            #pragma omp parallel for schedule(dynamic, 64)
+                            for (long long i = 0; i < static_cast<long long>(candidates.size()); ++i)
+                            {
+                                const auto index_bottom_left = candidates[i];
+                                const auto index_bottom_right = index_bottom_left + 1;
+                                const auto index_top_left = index_bottom_left + resolution[0];
+                                const auto index_top_right = index_top_left + 1;
+
+                                const auto x = static_cast<unsigned int>(index_bottom_left % resolution[0]);
+                                const auto y = static_cast<unsigned int>(index_bottom_left / resolution[0]);
+
+                                const cell_t cell = {
+                                    Eigen::Vector2f(vectors[index_bottom_left * 2 + 0], vectors[index_bottom_left * 2 + 1]),
+                                    Eigen::Vector2f(vectors[index_bottom_right * 2 + 0], vectors[index_bottom_right * 2 + 1]),
+                                    Eigen::Vector2f(vectors[index_top_left * 2 + 0], vectors[index_top_left * 2 + 1]),
+                                    Eigen::Vector2f(vectors[index_top_right * 2 + 0], vectors[index_top_right * 2 + 1]),
+                                    Eigen::Vector2f(bounding_rectangle.Left() + x * x_step, bounding_rectangle.Bottom() + y * y_step),
+                                    Eigen::Vector2f(bounding_rectangle.Left() + (x + 1) * x_step, bounding_rectangle.Bottom() + (y + 1) * y_step)
+                                };
+
+                                tile_critical_points[i] = extract_critical_point(cell);
                             }
-                            else if (critical_point.first == type::UNHANDLED)
+
+                            // Collect critical points in the original order for a deterministic hash
+                            for (const auto& critical_point : tile_critical_points)
                             {
-                                has_unhandled_case = true;
+                                if (critical_point.first != type::NONE && critical_point.first != type::UNHANDLED)
+                                {
+                                    this->glyph_output.push_back(critical_point);
+
+                                    this->glyph_hash = static_cast<SIZE_T>(core::utility::DataHash(this->glyph_hash,
+                                        critical_point.first, critical_point.second[0], critical_point.second[1]));
+                                }
+                                else if (critical_point.first == type::UNHANDLED)
+                                {
+                                    has_unhandled_case = true;
+                                }
                             }
                         }
                     }
@@ -123,6 +173,7 @@ namespace megamol
                 if (glyph_call->DataHash() != this->glyph_hash)
                 {
                     glyph_call->clear();
+                    glyph_call->reserve_points(this->glyph_output.size());
 
                     for (std::size_t i = 0; i < this->glyph_output.size(); ++i)
                     {
@@ -143,6 +194,55 @@ namespace megamol
             return get_vector_field != nullptr && (*get_vector_field)(1);
         }
 
+        void critical_points::find_candidate_cells(const std::vector<float>& vectors, const std::array<unsigned int, 2>& resolution,
+            const unsigned int x_begin, const unsigned int x_end, const unsigned int y_begin, const unsigned int y_end,
+            std::vector<std::size_t>& candidates) const
+        {
+            std::vector<std::vector<std::size_t>> row_candidates(y_end - y_begin);
+
+            #pragma omp parallel
+            {
+                std::vector<unsigned char> is_candidate(x_end - x_begin);
+
+                #pragma omp for
+                for (long long y = y_begin; y < static_cast<long long>(y_end); ++y)
+                {
+                    const float* bottom = &vectors[static_cast<std::size_t>(y) * resolution[0] * 2];
+                    const float* top = bottom + static_cast<std::size_t>(resolution[0]) * 2;
+
+                    // Branch-free test for sign changes of both components, using the same tests as the classification
+                    for (unsigned int x = x_begin; x < x_end; ++x)
+                    {
+                        const int num_negative_u = (bottom[x * 2 + 0] < 0.0f) + (bottom[x * 2 + 2] < 0.0f)
+                            + (top[x * 2 + 0] < 0.0f) + (top[x * 2 + 2] < 0.0f);
+
+                        const int num_negative_v = std::signbit(bottom[x * 2 + 1]) + std::signbit(bottom[x * 2 + 3])
+                            + std::signbit(top[x * 2 + 1]) + std::signbit(top[x * 2 + 3]);
+
+                        is_candidate[x - x_begin] = (num_negative_u % 4 != 0) & (num_negative_v % 4 != 0);
+                    }
+
+                    auto& row = row_candidates[y - y_begin];
+
+                    for (unsigned int x = x_begin; x < x_end; ++x)
+                    {
+                        if (is_candidate[x - x_begin])
+                        {
+                            row.push_back(static_cast<std::size_t>(y) * resolution[0] + x);
+                        }
+                    }
+                }
+            }
+
+            // Concatenate candidates in row-major order
+            candidates.clear();
+
+            for (const auto& row : row_candidates)
+            {
+                candidates.insert(candidates.end(), row.begin(), row.end());
+            }
+        }
+
         std::pair<critical_points::type, Eigen::Vector2f> critical_points::extract_critical_point(const cell_t& cell) const
         {
             // Return the point directly, if it is a zero-vector itself
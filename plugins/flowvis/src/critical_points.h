@@ -14,6 +14,7 @@
 
 #include "Eigen/Dense"
 
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -24,6 +25,10 @@ namespace megamol
         /**
         * Module for calculating critical points of a vector field.
         *
+        * Extraction runs in two passes: first, cells are culled by testing for sign changes of both
+        * vector components, before the remaining candidate cells are classified in parallel.
+        * Optionally, the field is processed in tiles of cell rows to bound the working set.
+        *
         * @author Alexander Straub
         */
         class critical_points : public core::Module
@@ -98,6 +103,20 @@ namespace megamol
             */
             std::pair<type, Eigen::Vector2f> extract_critical_point(const cell_t& cell) const;
 
+            /**
+            * Find cells which possibly contain a critical point, i.e., where both vector components change sign
+            *
+            * @param vectors Vectors of the vector field
+            * @param resolution Resolution of the vector field
+            * @param x_begin First cell column
+            * @param x_end Cell column after the last one
+            * @param y_begin First cell row
+            * @param y_end Cell row after the last one
+            * @param candidates Output indices of the bottom left vertex of the candidate cells, in row-major order
+            */
+            void find_candidate_cells(const std::vector<float>& vectors, const std::array<unsigned int, 2>& resolution,
+                unsigned int x_begin, unsigned int x_end, unsigned int y_begin, unsigned int y_end, std::vector<std::size_t>& candidates) const;
+
             /**
             * Linear interpolate position based on value
             *
@@ -178,6 +197,9 @@ namespace megamol
 
             /** Parameter for the boundary */
             core::param::ParamSlot boundary;
+
+            /** Parameter for the number of cell rows per tile */
+            core::param::ParamSlot tile_size;
         };
     }
 }
\ No newline at end of file
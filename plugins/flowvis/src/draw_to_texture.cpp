@@ -63,7 +63,7 @@ draw_to_texture::~draw_to_texture() { this->Release(); }
 
 bool draw_to_texture::create() { return true; }
 
-void draw_to_texture::release() {}
+void draw_to_texture::release() { this->fbo.reset(); }
 
 bool draw_to_texture::get_input_extent() {
     auto rc_ptr = this->rendering_slot.CallAs<core::view::CallRender2D>();
@@ -119,9 +119,9 @@ bool draw_to_texture::get_data(core::Call& call) {
                             ? static_cast<int>(this->width.Param<core::param::IntParam>()->Value() / aspect_ratio)
                             : this->height.Param<core::param::IntParam>()->Value();
 
-    if (this->fbo == nullptr || this->width.IsDirty() || this->height.IsDirty()) {
-        this->fbo = std::make_unique<glowl::FramebufferObject>(width, height);
-        this->fbo->createColorAttachment(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    if (this->fbo == nullptr || this->fbo->getWidth() != width || this->fbo->getHeight() != height) {
+        this->fbo = core::utility::RenderTargetPool::Instance().Acquire(
+            width, height, {{GL_RGBA16F, GL_RGBA, GL_FLOAT}});
 
         this->width.ResetDirty();
         this->height.ResetDirty();
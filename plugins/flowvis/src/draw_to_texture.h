@@ -11,6 +11,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/utility/RenderTargetPool.h"
 
 #include "vislib/math/Rectangle.h"
 
@@ -100,8 +101,8 @@ private:
     /** Bounding rectangle */
     vislib::math::Rectangle<float> bounding_rectangle;
 
-    /** FBO */
-    std::unique_ptr<glowl::FramebufferObject> fbo;
+    /** FBO, leased from the render target pool */
+    core::utility::RenderTargetPool::lease_type fbo;
 
     /** Hash dummy */
     SIZE_T hash;
@@ -16,20 +16,26 @@
 #include "clip_plane.h"
 #include "critical_points.h"
 #include "extract_model_matrix.h"
+#include "ftle.h"
 #include "glyph_data_reader.h"
 #include "implicit_topology.h"
 #include "implicit_topology_reader.h"
+#include "implicit_topology_server.h"
+#include "implicit_topology_sweep.h"
 #include "implicit_topology_writer.h"
 #include "line_strip.h"
 #include "periodic_orbits.h"
 #include "periodic_orbits_theisel.h"
+#include "separatrices.h"
 #include "stl_data_source.h"
 #include "streamlines_2d.h"
+#include "synthetic_vector_field.h"
 #include "vector_field_reader.h"
 
 #include "draw_texture_3d.h"
 #include "draw_to_texture.h"
 #include "glyph_renderer_2d.h"
+#include "lic_renderer_2d.h"
 #include "render_to_file.h"
 #include "triangle_mesh_renderer_2d.h"
 #include "triangle_mesh_renderer_3d.h"
@@ -70,21 +76,27 @@ namespace {
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::clip_plane>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::critical_points>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::extract_model_matrix>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::ftle>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::glyph_data_reader>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::implicit_topology>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::implicit_topology_reader>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::implicit_topology_server>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::implicit_topology_sweep>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::implicit_topology_writer>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::line_strip>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::periodic_orbits>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::periodic_orbits_theisel>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::separatrices>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::stl_data_source>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::streamlines_2d>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::synthetic_vector_field>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::vector_field_reader>();
 
             // register renderer here:
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::draw_texture_3d>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::draw_to_texture>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::glyph_renderer_2d>();
+            this->module_descriptions.RegisterAutoDescription<megamol::flowvis::lic_renderer_2d>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::render_to_file>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::triangle_mesh_renderer_2d>();
             this->module_descriptions.RegisterAutoDescription<megamol::flowvis::triangle_mesh_renderer_3d>();
@@ -0,0 +1,422 @@
+#include "stdafx.h"
+#include "ftle.h"
+
+#include "mesh_data_call.h"
+#include "triangle_mesh_call.h"
+#include "vector_field_call.h"
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/TransferFunctionParam.h"
+
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+    * Compute the FTLE from the gradient of the flow map, using central differences in the interior
+    * and one-sided differences at the boundary of the seed grid
+    *
+    * @param resolution         Resolution of the seed grid
+    * @param seeds              Seed positions
+    * @param flow_map           Advected seed positions
+    * @param integration_time   Absolute integration time
+    *
+    * @return FTLE per seed
+    */
+    std::vector<float> compute_ftle_field(const std::array<unsigned int, 2>& resolution, const std::vector<float>& seeds,
+        const std::vector<float>& flow_map, const float integration_time)
+    {
+        const auto res_x = static_cast<long long>(resolution[0]);
+        const auto res_y = static_cast<long long>(resolution[1]);
+
+        std::vector<float> ftle(static_cast<std::size_t>(res_x * res_y), 0.0f);
+
+        #pragma omp parallel for
+        for (long long y = 0; y < res_y; ++y)
+        {
+            const auto y_0 = std::max(y - 1, 0LL);
+            const auto y_1 = std::min(y + 1, res_y - 1);
+
+            for (long long x = 0; x < res_x; ++x)
+            {
+                const auto x_0 = std::max(x - 1, 0LL);
+                const auto x_1 = std::min(x + 1, res_x - 1);
+
+                const auto left = 2 * (y * res_x + x_0);
+                const auto right = 2 * (y * res_x + x_1);
+                const auto bottom = 2 * (y_0 * res_x + x);
+                const auto top = 2 * (y_1 * res_x + x);
+
+                const float dx = seeds[right] - seeds[left];
+                const float dy = seeds[top + 1] - seeds[bottom + 1];
+
+                // Jacobian of the flow map
+                const float j_00 = (flow_map[right] - flow_map[left]) / dx;
+                const float j_10 = (flow_map[right + 1] - flow_map[left + 1]) / dx;
+                const float j_01 = (flow_map[top] - flow_map[bottom]) / dy;
+                const float j_11 = (flow_map[top + 1] - flow_map[bottom + 1]) / dy;
+
+                // Largest eigenvalue of the symmetric Cauchy-Green tensor
+                const float c_00 = j_00 * j_00 + j_10 * j_10;
+                const float c_01 = j_00 * j_01 + j_10 * j_11;
+                const float c_11 = j_01 * j_01 + j_11 * j_11;
+
+                const float half_trace = 0.5f * (c_00 + c_11);
+                const float half_difference = 0.5f * (c_00 - c_11);
+
+                const float max_eigenvalue = half_trace + std::sqrt(half_difference * half_difference + c_01 * c_01);
+
+                if (max_eigenvalue > 0.0f && std::isfinite(max_eigenvalue))
+                {
+                    ftle[y * res_x + x] = std::log(max_eigenvalue) / (2.0f * integration_time);
+                }
+            }
+        }
+
+        return ftle;
+    }
+}
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        ftle::ftle() :
+            triangle_mesh_slot("set_triangle_mesh", "Triangulated seed grid"),
+            mesh_data_slot("set_mesh_data", "Forward and backward FTLE on the seed grid"),
+            vector_field_slot("vector_field_slot", "Vector field input"),
+            seed_resolution_x("seed_resolution_x", "Number of seeds in x direction"),
+            seed_resolution_y("seed_resolution_y", "Number of seeds in y direction"),
+            integration_method("integration_method", "Method for stream line integration"),
+            integration_time("integration_time", "Integration time for computing the flow map"),
+            integration_timestep("integration_timestep", "(Initial) time step for stream line integration"),
+            max_integration_error("max_integration_error", "Maximum integration error for Runge-Kutta 4-5"),
+            max_integration_steps("max_integration_steps", "Maximum number of integration steps, after which seeds are not advected further"),
+            num_particles_per_batch("num_particles_per_batch", "Number of particles processed per batch"),
+            transfer_function("transfer_function", "Transfer function for coloring the FTLE fields"),
+            vector_field_hash(-1),
+            vector_field_changed(false),
+            ftle_hash(0)
+        {
+            // Connect output
+            this->triangle_mesh_slot.SetCallback(triangle_mesh_call::ClassName(), triangle_mesh_call::FunctionName(0), &ftle::get_triangle_data_callback);
+            this->triangle_mesh_slot.SetCallback(triangle_mesh_call::ClassName(), triangle_mesh_call::FunctionName(1), &ftle::get_triangle_extent_callback);
+            this->MakeSlotAvailable(&this->triangle_mesh_slot);
+
+            this->mesh_data_slot.SetCallback(mesh_data_call::ClassName(), mesh_data_call::FunctionName(0), &ftle::get_data_data_callback);
+            this->mesh_data_slot.SetCallback(mesh_data_call::ClassName(), mesh_data_call::FunctionName(1), &ftle::get_data_extent_callback);
+            this->MakeSlotAvailable(&this->mesh_data_slot);
+
+            // Connect input
+            this->vector_field_slot.SetCompatibleCall<vector_field_call::vector_field_description>();
+            this->MakeSlotAvailable(&this->vector_field_slot);
+
+            // Create seed parameters
+            this->seed_resolution_x << new core::param::IntParam(256, 2);
+            this->MakeSlotAvailable(&this->seed_resolution_x);
+
+            this->seed_resolution_y << new core::param::IntParam(256, 2);
+            this->MakeSlotAvailable(&this->seed_resolution_y);
+
+            // Create integration parameters
+            this->integration_method << new core::param::EnumParam(0);
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(0, "Runge-Kutta 4 (fixed)");
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(1, "Runge-Kutta 4-5 (dynamic)");
+            this->MakeSlotAvailable(&this->integration_method);
+
+            this->integration_time << new core::param::FloatParam(1.0f);
+            this->MakeSlotAvailable(&this->integration_time);
+
+            this->integration_timestep << new core::param::FloatParam(0.01f);
+            this->MakeSlotAvailable(&this->integration_timestep);
+
+            this->max_integration_error << new core::param::FloatParam(0.000001f);
+            this->MakeSlotAvailable(&this->max_integration_error);
+
+            this->max_integration_steps << new core::param::IntParam(10000, 1);
+            this->MakeSlotAvailable(&this->max_integration_steps);
+
+            this->num_particles_per_batch << new core::param::IntParam(10000, 1);
+            this->MakeSlotAvailable(&this->num_particles_per_batch);
+
+            // Create transfer function parameters
+            this->transfer_function << new core::param::TransferFunctionParam("");
+            this->MakeSlotAvailable(&this->transfer_function);
+        }
+
+        ftle::~ftle()
+        {
+            this->Release();
+        }
+
+        bool ftle::create()
+        {
+            return true;
+        }
+
+        void ftle::release()
+        {
+            this->integrator = nullptr;
+        }
+
+        bool ftle::get_input_data()
+        {
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (vf_call == nullptr || !(*vf_call)(1) || !(*vf_call)(0))
+            {
+                vislib::sys::Log::DefaultLog.WriteError("The ftle module needs a vector field as input");
+
+                return false;
+            }
+
+            if (vf_call->get_components() != 2 || vf_call->get_vectors() == nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("FTLE can only be computed for planar vector fields");
+
+                return false;
+            }
+
+            if (vf_call->DataHash() != this->vector_field_hash)
+            {
+                this->bounding_rectangle = vf_call->get_bounding_rectangle();
+                this->resolution = vf_call->get_resolution();
+                this->vectors = vf_call->get_vectors();
+
+                this->vector_field_hash = vf_call->DataHash();
+                this->vector_field_changed = true;
+            }
+
+            return true;
+        }
+
+        bool ftle::compute_ftle()
+        {
+            if (!(this->vector_field_changed || this->seed_resolution_x.IsDirty() || this->seed_resolution_y.IsDirty()
+                || this->integration_method.IsDirty() || this->integration_time.IsDirty() || this->integration_timestep.IsDirty()
+                || this->max_integration_error.IsDirty() || this->max_integration_steps.IsDirty() || this->num_particles_per_batch.IsDirty()))
+            {
+                return this->ftle_forward != nullptr;
+            }
+
+            this->seed_resolution_x.ResetDirty();
+            this->seed_resolution_y.ResetDirty();
+            this->integration_method.ResetDirty();
+            this->integration_time.ResetDirty();
+            this->integration_timestep.ResetDirty();
+            this->max_integration_error.ResetDirty();
+            this->max_integration_steps.ResetDirty();
+            this->num_particles_per_batch.ResetDirty();
+
+            const auto method = static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value());
+            const auto time = this->integration_time.Param<core::param::FloatParam>()->Value();
+            const auto timestep = this->integration_timestep.Param<core::param::FloatParam>()->Value();
+            const auto max_error = this->max_integration_error.Param<core::param::FloatParam>()->Value();
+
+            const bool upload = this->vector_field_changed || this->integrator == nullptr || !this->integrator->is_current();
+
+            this->vector_field_changed = false;
+            this->ftle_forward = this->ftle_backward = nullptr;
+
+            try
+            {
+                // Upload the vector field only if it changed, or if another module replaced it on the devices
+                if (upload)
+                {
+                    if (this->integrator != nullptr && !this->integrator->is_current())
+                    {
+                        vislib::sys::Log::DefaultLog.WriteWarn("The GPU integrator was used by another module, uploading the vector field again");
+                    }
+
+                    this->integrator = nullptr;
+
+                    const std::array<float, 4> domain = { this->bounding_rectangle.Left(), this->bounding_rectangle.Bottom(),
+                        this->bounding_rectangle.Right(), this->bounding_rectangle.Top() };
+
+                    // Without convergence structures, seeds are only stopped at the end of the integration time or the domain boundary
+                    this->integrator = std::make_unique<streamlines_cuda>(this->resolution, domain, *this->vectors,
+                        std::vector<float>(), std::vector<int>(), std::vector<float>(), std::vector<int>(), timestep, max_error, method);
+
+                    // Integrate path lines in the steady vector field, for advecting by the given time instead of arc length
+                    this->integrator->set_time_window(*this->vectors, 0.0f, *this->vectors, time);
+                }
+                else
+                {
+                    this->integrator->set_integration_parameters(timestep, max_error, method);
+                    this->integrator->set_time_window_times(0.0f, time);
+                }
+
+                // Create seed grid, triangulating each cell by two triangles
+                const std::array<unsigned int, 2> seed_resolution = {
+                    static_cast<unsigned int>(this->seed_resolution_x.Param<core::param::IntParam>()->Value()),
+                    static_cast<unsigned int>(this->seed_resolution_y.Param<core::param::IntParam>()->Value()) };
+
+                const auto num_seeds = static_cast<std::size_t>(seed_resolution[0]) * seed_resolution[1];
+
+                this->vertices = std::make_shared<std::vector<float>>(2 * num_seeds);
+                this->indices = std::make_shared<std::vector<unsigned int>>();
+                this->indices->reserve(6 * static_cast<std::size_t>(seed_resolution[0] - 1) * (seed_resolution[1] - 1));
+
+                for (unsigned int y = 0; y < seed_resolution[1]; ++y)
+                {
+                    for (unsigned int x = 0; x < seed_resolution[0]; ++x)
+                    {
+                        const auto index = static_cast<std::size_t>(y) * seed_resolution[0] + x;
+
+                        (*this->vertices)[2 * index + 0] = this->bounding_rectangle.Left()
+                            + this->bounding_rectangle.Width() * x / static_cast<float>(seed_resolution[0] - 1);
+                        (*this->vertices)[2 * index + 1] = this->bounding_rectangle.Bottom()
+                            + this->bounding_rectangle.Height() * y / static_cast<float>(seed_resolution[1] - 1);
+
+                        if (x + 1 < seed_resolution[0] && y + 1 < seed_resolution[1])
+                        {
+                            const auto i = static_cast<unsigned int>(index);
+
+                            this->indices->insert(this->indices->end(), { i, i + 1, i + seed_resolution[0] });
+                            this->indices->insert(this->indices->end(), { i + 1, i + 1 + seed_resolution[0], i + seed_resolution[0] });
+                        }
+                    }
+                }
+
+                // Advect seeds forward and backward, computing the flow maps
+                const auto num_steps = this->max_integration_steps.Param<core::param::IntParam>()->Value();
+                const auto batch_size = static_cast<unsigned int>(this->num_particles_per_batch.Param<core::param::IntParam>()->Value());
+
+                std::vector<float> flow_map_forward(*this->vertices), flow_map_backward(*this->vertices);
+                std::vector<float> labels(num_seeds, -1.0f), distances(num_seeds, std::numeric_limits<float>::max()), terminations(num_seeds, 0.0f);
+
+                this->integrator->update_labels(flow_map_forward, labels, distances, terminations, num_steps, 1.0f, batch_size);
+
+                std::fill(labels.begin(), labels.end(), -1.0f);
+                std::fill(distances.begin(), distances.end(), std::numeric_limits<float>::max());
+                std::fill(terminations.begin(), terminations.end(), 0.0f);
+
+                this->integrator->update_labels(flow_map_backward, labels, distances, terminations, num_steps, -1.0f, batch_size);
+
+                // Compute FTLE from the flow map gradients
+                this->ftle_forward = std::make_shared<mesh_data_call::data_set>();
+                this->ftle_forward->data = std::make_shared<std::vector<float>>(
+                    compute_ftle_field(seed_resolution, *this->vertices, flow_map_forward, time));
+
+                this->ftle_backward = std::make_shared<mesh_data_call::data_set>();
+                this->ftle_backward->data = std::make_shared<std::vector<float>>(
+                    compute_ftle_field(seed_resolution, *this->vertices, flow_map_backward, time));
+
+                for (auto data_set : { this->ftle_forward, this->ftle_backward })
+                {
+                    const auto min_max = std::minmax_element(data_set->data->begin(), data_set->data->end());
+
+                    data_set->min_value = *min_max.first;
+                    data_set->max_value = *min_max.second;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Error computing FTLE: %s", e.what());
+
+                this->integrator = nullptr;
+                this->ftle_forward = this->ftle_backward = nullptr;
+
+                return false;
+            }
+
+            ++this->ftle_hash;
+
+            return true;
+        }
+
+        bool ftle::get_triangle_data_callback(core::Call& call)
+        {
+            auto* triangle_call = dynamic_cast<triangle_mesh_call*>(&call);
+
+            if (triangle_call == nullptr || !(get_input_data() && compute_ftle()))
+            {
+                return false;
+            }
+
+            if (triangle_call->DataHash() != this->ftle_hash)
+            {
+                triangle_call->set_vertices(this->vertices);
+                triangle_call->set_indices(this->indices);
+
+                triangle_call->SetDataHash(this->ftle_hash);
+            }
+
+            return true;
+        }
+
+        bool ftle::get_triangle_extent_callback(core::Call& call)
+        {
+            auto* triangle_call = dynamic_cast<triangle_mesh_call*>(&call);
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (triangle_call == nullptr || vf_call == nullptr || !(*vf_call)(1))
+            {
+                return false;
+            }
+
+            triangle_call->set_dimension(triangle_mesh_call::dimension_t::TWO);
+            triangle_call->set_bounding_rectangle(vf_call->get_bounding_rectangle());
+
+            return true;
+        }
+
+        bool ftle::get_data_data_callback(core::Call& call)
+        {
+            auto* data_call = dynamic_cast<mesh_data_call*>(&call);
+
+            if (data_call == nullptr || !(get_input_data() && compute_ftle()))
+            {
+                return false;
+            }
+
+            if (data_call->DataHash() != this->ftle_hash || this->transfer_function.IsDirty())
+            {
+                const auto tf_string = this->transfer_function.Param<core::param::TransferFunctionParam>()->Value();
+
+                this->ftle_forward->transfer_function = tf_string;
+                this->ftle_forward->transfer_function_dirty = true;
+                data_call->set_data("ftle forward", this->ftle_forward);
+
+                this->ftle_backward->transfer_function = tf_string;
+                this->ftle_backward->transfer_function_dirty = true;
+                data_call->set_data("ftle backward", this->ftle_backward);
+
+                data_call->SetDataHash(this->ftle_hash);
+
+                this->transfer_function.ResetDirty();
+            }
+
+            return true;
+        }
+
+        bool ftle::get_data_extent_callback(core::Call& call)
+        {
+            auto* data_call = dynamic_cast<mesh_data_call*>(&call);
+
+            if (data_call == nullptr)
+            {
+                return false;
+            }
+
+            data_call->set_data("ftle forward");
+            data_call->set_data("ftle backward");
+
+            return true;
+        }
+    }
+}
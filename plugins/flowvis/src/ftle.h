@@ -0,0 +1,154 @@
+/*
+ * ftle.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "mesh_data_call.h"
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Module for computing the forward and backward finite-time Lyapunov exponent (FTLE) of a 2D vector field.
+        *
+        * The flow map of a dense seed grid is computed on the GPU by advecting the seeds for a fixed integration time,
+        * using the integrator of the implicit topology computation. The vector field is uploaded once per input change,
+        * while changes of the integration parameters or seed resolution only restart the advection. As the integrator
+        * state on the GPU is shared with implicit topology computations, it is uploaded again if such a computation
+        * replaced it in the meantime.
+        * The FTLE is then computed from the largest eigenvalue of the Cauchy-Green tensor of the flow map gradient.
+        *
+        * @author Alexander Straub
+        */
+        class ftle : public core::Module
+        {
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static const char* ClassName() { return "ftle"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static const char* Description() { return "Compute the finite-time Lyapunov exponent of 2D vector fields on the GPU"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static bool IsAvailable() { return true; }
+
+            /**
+            * Constructor
+            */
+            ftle();
+
+            /**
+            * Destructor
+            */
+            ~ftle();
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+        private:
+            /**
+            * Get the input vector field, uploading it to the GPU if it changed
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool get_input_data();
+
+            /**
+            * Compute the flow maps and FTLE fields for the current parameters, if not already computed
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool compute_ftle();
+
+            /** Callbacks for the seed grid */
+            bool get_triangle_data_callback(core::Call& call);
+            bool get_triangle_extent_callback(core::Call& call);
+
+            /** Callbacks for the FTLE fields */
+            bool get_data_data_callback(core::Call& call);
+            bool get_data_extent_callback(core::Call& call);
+
+            /** Output slot for the triangulated seed grid */
+            core::CalleeSlot triangle_mesh_slot;
+
+            /** Output slot for the FTLE fields, defined on the vertices of the seed grid */
+            core::CalleeSlot mesh_data_slot;
+
+            /** Input slot for getting the vector field */
+            core::CallerSlot vector_field_slot;
+
+            /** Parameters for the seed grid */
+            core::param::ParamSlot seed_resolution_x, seed_resolution_y;
+
+            /** Parameters for the integration */
+            core::param::ParamSlot integration_method;
+            core::param::ParamSlot integration_time;
+            core::param::ParamSlot integration_timestep;
+            core::param::ParamSlot max_integration_error;
+            core::param::ParamSlot max_integration_steps;
+            core::param::ParamSlot num_particles_per_batch;
+
+            /** Transfer function for coloring the FTLE fields */
+            core::param::ParamSlot transfer_function;
+
+            /** Input vector field and its integrator */
+            SIZE_T vector_field_hash;
+            bool vector_field_changed;
+
+            vislib::math::Rectangle<float> bounding_rectangle;
+            std::array<unsigned int, 2> resolution;
+            std::shared_ptr<std::vector<float>> vectors;
+
+            std::unique_ptr<streamlines_cuda> integrator;
+
+            /** Seed grid and FTLE fields */
+            SIZE_T ftle_hash;
+
+            std::shared_ptr<std::vector<float>> vertices;
+            std::shared_ptr<std::vector<unsigned int>> indices;
+
+            std::shared_ptr<mesh_data_call::data_set> ftle_forward;
+            std::shared_ptr<mesh_data_call::data_set> ftle_backward;
+        };
+    }
+}
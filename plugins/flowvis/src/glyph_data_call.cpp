@@ -14,14 +14,14 @@ namespace megamol
     {
         glyph_data_call::glyph_data_call() : bounding_rectangle_valid(false)
         {
-            this->point_vertices = std::make_shared<std::vector<float>>();
-            this->line_vertices = std::make_shared<std::vector<float>>();
+            this->point_vertices = this->float_buffers.Acquire();
+            this->line_vertices = this->float_buffers.Acquire();
 
-            this->point_indices = std::make_shared<std::vector<unsigned int>>();
-            this->line_indices = std::make_shared<std::vector<unsigned int>>();
+            this->point_indices = this->index_buffers.Acquire();
+            this->line_indices = this->index_buffers.Acquire();
 
-            this->point_values = std::make_shared<std::vector<float>>();
-            this->line_values = std::make_shared<std::vector<float>>();
+            this->point_values = this->float_buffers.Acquire();
+            this->line_values = this->float_buffers.Acquire();
 
             this->SetDataHash(-1);
         }
@@ -80,29 +80,13 @@ namespace megamol
 
             this->point_values->push_back(value);
 
-            // Adjust bounding rectangle
-            if (this->bounding_rectangle_valid)
-            {
-                this->bounding_rectangle.SetLeft(std::min(this->bounding_rectangle.Left(), point[0]));
-                this->bounding_rectangle.SetRight(std::max(this->bounding_rectangle.Right(), point[0]));
-
-                this->bounding_rectangle.SetBottom(std::min(this->bounding_rectangle.Bottom(), point[1]));
-                this->bounding_rectangle.SetTop(std::max(this->bounding_rectangle.Top(), point[1]));
-            }
-            else
-            {
-                this->bounding_rectangle.SetLeft(point[0]);
-                this->bounding_rectangle.SetRight(point[0]);
-
-                this->bounding_rectangle.SetBottom(point[1]);
-                this->bounding_rectangle.SetTop(point[1]);
-            }
-
-            this->bounding_rectangle_valid = true;
+            extend_bounding_rectangle(point[0], point[1], point[0], point[1]);
         }
 
         void glyph_data_call::add_line(const std::vector<Eigen::Vector2f>& points, float value)
         {
+            if (points.empty()) return;
+
             unsigned int next_index = static_cast<unsigned int>(this->line_vertices->size() / 2);
 
             // Push restart index
@@ -114,44 +98,99 @@ namespace megamol
             min_x = max_x = points[0][0];
             min_y = max_y = points[0][1];
 
+            // Append all points at once, after a single growth of the storage
+            const auto num_indices = this->line_indices->size();
+            const auto num_vertices = this->line_vertices->size();
+            const auto num_values = this->line_values->size();
+
+            this->line_indices->resize(num_indices + points.size());
+            this->line_vertices->resize(num_vertices + 2 * points.size());
+            this->line_values->resize(num_values + points.size(), value);
+
+            unsigned int* indices = this->line_indices->data() + num_indices;
+            float* vertices = this->line_vertices->data() + num_vertices;
+
             // Add indices for a line strip
             for (std::size_t i = 0; i < points.size(); ++i)
             {
                 const auto& point = points[i];
 
-                this->line_indices->push_back(next_index++);
+                indices[i] = next_index++;
 
-                this->line_vertices->push_back(point[0]);
-                this->line_vertices->push_back(point[1]);
+                vertices[2 * i + 0] = point[0];
+                vertices[2 * i + 1] = point[1];
 
                 min_x = std::min(min_x, point[0]);
                 max_x = std::max(max_x, point[0]);
 
                 min_y = std::min(min_y, point[1]);
                 max_y = std::max(max_y, point[1]);
-
-                this->line_values->push_back(value);
             }
 
-            // Adjust bounding rectangle
-            if (this->bounding_rectangle_valid)
-            {
-                this->bounding_rectangle.SetLeft(std::min(this->bounding_rectangle.Left(), min_x));
-                this->bounding_rectangle.SetRight(std::max(this->bounding_rectangle.Right(), max_x));
+            extend_bounding_rectangle(min_x, min_y, max_x, max_y);
+        }
+
+        void glyph_data_call::reserve_points(std::size_t num_points)
+        {
+            this->point_indices->reserve(this->point_indices->size() + num_points);
+            this->point_vertices->reserve(this->point_vertices->size() + 2 * num_points);
+            this->point_values->reserve(this->point_values->size() + num_points);
+        }
+
+        void glyph_data_call::reserve_lines(std::size_t num_lines, std::size_t num_points)
+        {
+            this->line_indices->reserve(this->line_indices->size() + num_points + num_lines);
+            this->line_vertices->reserve(this->line_vertices->size() + 2 * num_points);
+            this->line_values->reserve(this->line_values->size() + num_points);
+        }
 
-                this->bounding_rectangle.SetBottom(std::min(this->bounding_rectangle.Bottom(), min_y));
-                this->bounding_rectangle.SetTop(std::max(this->bounding_rectangle.Top(), max_y));
+        void glyph_data_call::add_points(const std::vector<std::pair<float, Eigen::Vector2f>>& points)
+        {
+            reserve_points(points.size());
+
+            for (const auto& point : points)
+            {
+                add_point(point.second, point.first);
             }
-            else
+        }
+
+        void glyph_data_call::add_lines(const std::vector<std::pair<float, std::vector<Eigen::Vector2f>>>& lines)
+        {
+            std::size_t num_points = 0;
+
+            for (const auto& line : lines)
             {
-                this->bounding_rectangle.SetLeft(min_x);
-                this->bounding_rectangle.SetRight(max_x);
+                num_points += line.second.size();
+            }
 
-                this->bounding_rectangle.SetBottom(min_y);
-                this->bounding_rectangle.SetTop(max_y);
+            reserve_lines(lines.size(), num_points);
+
+            for (const auto& line : lines)
+            {
+                add_line(line.second, line.first);
             }
+        }
 
-            this->bounding_rectangle_valid = true;
+        void glyph_data_call::set_points(std::shared_ptr<std::vector<float>> vertices, std::shared_ptr<std::vector<unsigned int>> indices,
+            std::shared_ptr<std::vector<float>> values, const vislib::math::Rectangle<float>& bounding_rectangle)
+        {
+            this->point_vertices = vertices;
+            this->point_indices = indices;
+            this->point_values = values;
+
+            extend_bounding_rectangle(bounding_rectangle.Left(), bounding_rectangle.Bottom(),
+                bounding_rectangle.Right(), bounding_rectangle.Top());
+        }
+
+        void glyph_data_call::set_lines(std::shared_ptr<std::vector<float>> vertices, std::shared_ptr<std::vector<unsigned int>> indices,
+            std::shared_ptr<std::vector<float>> values, const vislib::math::Rectangle<float>& bounding_rectangle)
+        {
+            this->line_vertices = vertices;
+            this->line_indices = indices;
+            this->line_values = values;
+
+            extend_bounding_rectangle(bounding_rectangle.Left(), bounding_rectangle.Bottom(),
+                bounding_rectangle.Right(), bounding_rectangle.Top());
         }
 
         std::vector<std::pair<Eigen::Vector2f, float>> glyph_data_call::get_points() const {
@@ -196,29 +235,73 @@ namespace megamol
             std::vector<std::pair<std::pair<Eigen::Vector2f, Eigen::Vector2f>, float>> line_segments;
 
             if (!this->line_indices->empty()) {
-                const auto lines = get_lines();
+                // Walk the line strips directly, each segment carrying the value of the first point of its line
+                const auto& indices = *this->line_indices;
+                const auto& vertices = *this->line_vertices;
 
-                for (const auto& line : lines) {
-                    for (std::size_t segment = 0; segment < line.first.size() - 1; ++segment) {
-                        line_segments.push_back(
-                            std::make_pair(std::make_pair(line.first[segment], line.first[segment + 1]), line.second));
+                line_segments.reserve(indices.size());
+
+                float value = (*this->line_values)[indices[0]];
+
+                for (std::size_t i = 1; i < indices.size(); ++i) {
+                    const auto first = indices[i - 1];
+                    const auto second = indices[i];
+
+                    if (second == -1) {
+                        continue;
+                    }
+                    if (first == -1) {
+                        // Restart index found: new line
+                        value = (*this->line_values)[second];
+                        continue;
                     }
+
+                    const auto first_index = static_cast<std::size_t>(first);
+                    const auto second_index = static_cast<std::size_t>(second);
+
+                    line_segments.push_back(std::make_pair(
+                        std::make_pair(Eigen::Vector2f(vertices[first_index * 2], vertices[first_index * 2 + 1]),
+                            Eigen::Vector2f(vertices[second_index * 2], vertices[second_index * 2 + 1])),
+                        value));
                 }
             }
 
             return line_segments;
         }
 
+        void glyph_data_call::extend_bounding_rectangle(float left, float bottom, float right, float top)
+        {
+            if (this->bounding_rectangle_valid)
+            {
+                this->bounding_rectangle.SetLeft(std::min(this->bounding_rectangle.Left(), left));
+                this->bounding_rectangle.SetRight(std::max(this->bounding_rectangle.Right(), right));
+
+                this->bounding_rectangle.SetBottom(std::min(this->bounding_rectangle.Bottom(), bottom));
+                this->bounding_rectangle.SetTop(std::max(this->bounding_rectangle.Top(), top));
+            }
+            else
+            {
+                this->bounding_rectangle.SetLeft(left);
+                this->bounding_rectangle.SetRight(right);
+
+                this->bounding_rectangle.SetBottom(bottom);
+                this->bounding_rectangle.SetTop(top);
+            }
+
+            this->bounding_rectangle_valid = true;
+        }
+
         void glyph_data_call::clear()
         {
-            this->point_vertices->clear();
-            this->line_vertices->clear();
+            // Replace storage, as it might be shared with the module that set it or with the renderers
+            this->point_vertices = this->float_buffers.Acquire();
+            this->line_vertices = this->float_buffers.Acquire();
 
-            this->point_indices->clear();
-            this->line_indices->clear();
+            this->point_indices = this->index_buffers.Acquire();
+            this->line_indices = this->index_buffers.Acquire();
 
-            this->point_values->clear();
-            this->line_values->clear();
+            this->point_values = this->float_buffers.Acquire();
+            this->line_values = this->float_buffers.Acquire();
 
             this->bounding_rectangle_valid = false;
         }
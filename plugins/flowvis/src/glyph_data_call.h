@@ -8,6 +8,7 @@
 
 #include "mmcore/AbstractGetDataCall.h"
 #include "mmcore/factories/CallAutoDescription.h"
+#include "mmcore/utility/FrameArena.h"
 
 #include "vislib/math/Rectangle.h"
 
@@ -126,6 +127,57 @@ namespace megamol
             */
             void add_line(const std::vector<Eigen::Vector2f>& points, float value);
 
+            /**
+            * Reserve storage for points to be added
+            *
+            * @param num_points Number of points to be added
+            */
+            void reserve_points(std::size_t num_points);
+
+            /**
+            * Reserve storage for lines to be added
+            *
+            * @param num_lines Number of lines to be added
+            * @param num_points Number of points of all these lines
+            */
+            void reserve_lines(std::size_t num_lines, std::size_t num_points);
+
+            /**
+            * Add many points at once
+            *
+            * @param points Values and positions of the points
+            */
+            void add_points(const std::vector<std::pair<float, Eigen::Vector2f>>& points);
+
+            /**
+            * Add many lines at once
+            *
+            * @param lines Values and points of the lines
+            */
+            void add_lines(const std::vector<std::pair<float, std::vector<Eigen::Vector2f>>>& lines);
+
+            /**
+            * Set all points at once, sharing the given storage instead of copying it point by point
+            *
+            * @param vertices Vertices of the points, which may contain unreferenced vertices
+            * @param indices Indices of the points
+            * @param values Values stored at the vertices
+            * @param bounding_rectangle Bounding rectangle of all referenced vertices
+            */
+            void set_points(std::shared_ptr<std::vector<float>> vertices, std::shared_ptr<std::vector<unsigned int>> indices,
+                std::shared_ptr<std::vector<float>> values, const vislib::math::Rectangle<float>& bounding_rectangle);
+
+            /**
+            * Set all lines at once, sharing the given storage instead of copying it line by line
+            *
+            * @param vertices Vertices of the lines, which may contain unreferenced vertices
+            * @param indices Indices defining line strips, separated by a restart index (-1)
+            * @param values Values stored at the vertices
+            * @param bounding_rectangle Bounding rectangle of all referenced vertices
+            */
+            void set_lines(std::shared_ptr<std::vector<float>> vertices, std::shared_ptr<std::vector<unsigned int>> indices,
+                std::shared_ptr<std::vector<float>> values, const vislib::math::Rectangle<float>& bounding_rectangle);
+
             /**
             * Get all points
             *
@@ -153,6 +205,11 @@ namespace megamol
             void clear();
 
         protected:
+            /**
+            * Extend the bounding rectangle to contain the given one
+            */
+            void extend_bounding_rectangle(float left, float bottom, float right, float top);
+
             /** Bounding rectangle */
             vislib::math::Rectangle<float> bounding_rectangle;
             bool bounding_rectangle_valid;
@@ -161,6 +218,10 @@ namespace megamol
             std::shared_ptr<std::vector<float>> point_vertices, line_vertices;
             std::shared_ptr<std::vector<unsigned int>> point_indices, line_indices;
             std::shared_ptr<std::vector<float>> point_values, line_values;
+
+            /** Storage of previous frames, reused once nobody refers to it anymore */
+            core::utility::BufferPool<float> float_buffers;
+            core::utility::BufferPool<unsigned int> index_buffers;
         };
     }
 }
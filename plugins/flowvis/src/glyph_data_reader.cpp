@@ -173,16 +173,8 @@ namespace megamol
                 if (this->stored_data.hash != glyph_call->DataHash())
                 {
                     glyph_call->clear();
-
-                    for (const auto& point : this->stored_data.points)
-                    {
-                        glyph_call->add_point(point.second, point.first);
-                    }
-
-                    for (const auto& line : this->stored_data.lines)
-                    {
-                        glyph_call->add_line(line.second, line.first);
-                    }
+                    glyph_call->add_points(this->stored_data.points);
+                    glyph_call->add_lines(this->stored_data.lines);
 
                     glyph_call->SetDataHash(this->stored_data.hash);
                 }
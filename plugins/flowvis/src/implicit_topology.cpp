@@ -4,6 +4,7 @@
 #include "glyph_data_call.h"
 #include "implicit_topology_call.h"
 #include "implicit_topology_computation.h"
+#include "implicit_topology_remote.h"
 #include "implicit_topology_results.h"
 #include "mesh_data_call.h"
 #include "triangle_mesh_call.h"
@@ -18,26 +19,143 @@
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
+#include "mmcore/profiler/Manager.h"
+#include "mmcore/param/StringParam.h"
 #include "mmcore/param/TransferFunctionParam.h"
+#include "mmcore/param/Vector4fParam.h"
 #include "mmcore/view/special/CallbackScreenShooter.h"
 
+#include "vislib/StringConverter.h"
 #include "vislib/math/Rectangle.h"
 #include "vislib/sys/Log.h"
 
 #include "Eigen/Dense"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <future>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+namespace
+{
+    /** Compute minimum and maximum value in parallel */
+    std::pair<float, float> compute_range(const std::vector<float>& data)
+    {
+        const auto num_values = static_cast<long long>(data.size());
+
+        float min_value = std::numeric_limits<float>::max();
+        float max_value = std::numeric_limits<float>::lowest();
+
+        #pragma omp parallel
+        {
+            float local_min = std::numeric_limits<float>::max();
+            float local_max = std::numeric_limits<float>::lowest();
+
+            #pragma omp for nowait
+            for (long long i = 0; i < num_values; ++i)
+            {
+                local_min = std::min(local_min, data[i]);
+                local_max = std::max(local_max, data[i]);
+            }
+
+            #pragma omp critical
+            {
+                min_value = std::min(min_value, local_min);
+                max_value = std::max(max_value, local_max);
+            }
+        }
+
+        return { min_value, max_value };
+    }
+
+    /** Combine forward and backward labels into unique labels, numbered in order of their first occurrence */
+    void combine_labels(const std::vector<float>& labels_forward, const std::vector<float>& labels_backward, std::vector<float>& labels)
+    {
+        const auto num_values = static_cast<long long>(labels_forward.size());
+
+        // Identify combinations by the bits of their smaller and larger label, where adding zero removes negative zeros
+        std::vector<uint64_t> keys(labels_forward.size());
+
+        #pragma omp parallel for
+        for (long long i = 0; i < num_values; ++i)
+        {
+            const auto min_max = std::minmax(labels_forward[i] + 0.0f, labels_backward[i] + 0.0f);
+
+            uint32_t min_bits, max_bits;
+            std::memcpy(&min_bits, &min_max.first, sizeof(uint32_t));
+            std::memcpy(&max_bits, &min_max.second, sizeof(uint32_t));
+
+            keys[i] = (static_cast<uint64_t>(min_bits) << 32) | max_bits;
+        }
+
+        // Find first occurrence of each combination, first per thread and then merged
+        std::unordered_map<uint64_t, long long> first_occurrences;
+
+        #pragma omp parallel
+        {
+            std::unordered_map<uint64_t, long long> local_occurrences;
+
+            #pragma omp for nowait
+            for (long long i = 0; i < num_values; ++i)
+            {
+                local_occurrences.insert(std::make_pair(keys[i], i));
+            }
+
+            #pragma omp critical
+            {
+                for (const auto& occurrence : local_occurrences)
+                {
+                    auto entry = first_occurrences.insert(occurrence);
+
+                    if (!entry.second && occurrence.second < entry.first->second)
+                    {
+                        entry.first->second = occurrence.second;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::pair<long long, uint64_t>> order;
+        order.reserve(first_occurrences.size());
+
+        for (const auto& occurrence : first_occurrences)
+        {
+            order.push_back(std::make_pair(occurrence.second, occurrence.first));
+        }
+
+        std::sort(order.begin(), order.end());
+
+        std::unordered_map<uint64_t, float> combined_labels;
+
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            combined_labels[order[i].second] = static_cast<float>(i);
+        }
+
+        // Set combined labels
+        labels.resize(labels_forward.size());
+
+        #pragma omp parallel for
+        for (long long i = 0; i < num_values; ++i)
+        {
+            labels[i] = combined_labels.find(keys[i])->second;
+        }
+    }
+}
+
 namespace megamol
 {
     namespace flowvis
@@ -49,6 +167,7 @@ namespace megamol
             screenshot_slot("screenshot_slot", "Screenshot output slot"),
             log_slot("log_slot", "Log output slot"),
             performance_slot("performance_slot", "Performance log output slot"),
+            telemetry_slot("telemetry_slot", "Telemetry output slot, writing timings and counters as JSON lines"),
             vector_field_slot("vector_field_slot", "Vector field input slot"),
             convergence_structures_slot("convergence_structures_slot", "Convergence structures input slot"),
             result_reader_slot("result_reader_slot", "Results input slot"),
@@ -57,6 +176,10 @@ namespace megamol
             reset_computation("reset_computation", "Reset the computation"),
             load_computation("load_computation", "Load computation from file"),
             save_computation("save_computation", "Save computation to file"),
+            remote_server("remote_server", "Address of a remote implicit topology server, e.g., tcp://host:port; empty for computing locally"),
+            region_of_interest("region_of_interest", "Region of interest (minimum x, minimum y, maximum x, maximum y), whose seeds are recomputed"),
+            region_reload_input("region_reload_input", "Reload vector field and convergence structures before recomputing the region of interest"),
+            recompute_region("recompute_region", "Integrate the seeds within the region of interest again, and continue the refinement"),
             label_transfer_function("label_transfer_function", "Transfer function for labels"),
             label_fixed_range("label_fixed_range", "Fixed or dynamic value range for labels"),
             label_range_min("label_range_min", "Minimum value for labels in the transfer function"),
@@ -80,12 +203,27 @@ namespace megamol
             max_integration_error("max_integration_error", "Maximum integration error for Runge-Kutta 4-5"),
             num_particles_per_batch("num_particles_per_batch", "Number of particles per batch (influences GPU utilization)"),
             num_integration_steps_per_batch("num_integration_steps_per_batch", "Number of integration steps per batch, after which a result can be visualized"),
+            computation_backend("computation_backend", "Backend for stream line computation"),
+            integration_precision("integration_precision", "Floating point precision of the stream line integration on the GPU"),
+            vector_storage("vector_storage", "Storage format of the vector field on the GPU; half precision reduces memory and bandwidth"),
+            convergence_distance("convergence_distance", "Terminate stream lines closer to their labelled structure than this distance; 0 to disable"),
+            convergence_steps("convergence_steps", "Terminate stream lines whose label did not change for this number of steps within the convergence radius; 0 to disable"),
+            convergence_radius("convergence_radius", "Radius within which stream lines have to stay for terminating after the number of convergence steps"),
+            refinement_structure("refinement_structure", "Structure for grid refinement: Delaunay triangulation of all seeds, or quadtree subdividing the initial grid cells"),
             refinement_threshold("refinement_threshold", "Threshold for grid refinement, defined as minimum edge length"),
             refine_at_labels("refine_at_labels", "Should the grid be refined in regions of different labels?"),
             distance_difference_threshold("distance_difference_threshold", "Threshold for refining the grid when neighboring nodes exceed a distance difference"),
+            incremental_refinement("incremental_refinement", "Only revisit the neighborhood of newly inserted points during grid refinement"),
+            max_points_per_refinement("max_points_per_refinement", "Maximum number of points per grid refinement, refining edges between different labels and with large distance differences first; 0 for no limit"),
             auto_save_results("auto_save_results", "Automatically save results when new ones are available"),
             auto_save_screenshots("auto_save_screenshots", "Automatically take screenshot when new results are available"),
-            computation_running(false), mesh_output_changed(false), data_output_changed(false), computation(nullptr), previous_result(nullptr)
+            preview_resolution("preview_resolution", "Resolution of the raster for clustering the vertices of intermediate results into a preview; 0 for always showing full resolution"),
+            computation_running(false), mesh_output_changed(false), data_output_changed(false), screenshot_pending(false), preview_shown(false),
+            data_param_generation(static_cast<std::size_t>(-1)),
+            vertices_appended(false), forward_data_appended(false), backward_data_appended(false),
+            forward_data_append_only_since(static_cast<SIZE_T>(-1)), backward_data_append_only_since(static_cast<SIZE_T>(-1)),
+            gradients_unchanged_since(static_cast<SIZE_T>(-1)),
+            computation(nullptr), remote_computation(nullptr), previous_result(nullptr), pending_save(nullptr), result_writer(1)
         {
             // Connect output
             this->triangle_mesh_slot.SetCallback(triangle_mesh_call::ClassName(), triangle_mesh_call::FunctionName(0), &implicit_topology::get_triangle_data_callback);
@@ -114,6 +252,10 @@ namespace megamol
             this->MakeSlotAvailable(&this->performance_slot);
             this->get_performance_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
 
+            this->telemetry_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology::get_telemetry_cb_callback);
+            this->MakeSlotAvailable(&this->telemetry_slot);
+            this->get_telemetry_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
             // Connect input
             this->vector_field_slot.SetCompatibleCall<vector_field_call::vector_field_description>();
             this->MakeSlotAvailable(&this->vector_field_slot);
@@ -145,6 +287,37 @@ namespace megamol
             this->num_integration_steps_per_batch << new core::param::IntParam(10000);
             this->MakeSlotAvailable(&this->num_integration_steps_per_batch);
 
+            this->computation_backend << new core::param::EnumParam(0);
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(0, "Automatic");
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(1, "CUDA");
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(2, "CPU");
+            this->MakeSlotAvailable(&this->computation_backend);
+
+            this->integration_precision << new core::param::EnumParam(0);
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(0, "Single");
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(1, "Mixed");
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(2, "Double");
+            this->MakeSlotAvailable(&this->integration_precision);
+
+            this->vector_storage << new core::param::EnumParam(0);
+            this->vector_storage.Param<core::param::EnumParam>()->SetTypePair(0, "Single");
+            this->vector_storage.Param<core::param::EnumParam>()->SetTypePair(1, "Half");
+            this->MakeSlotAvailable(&this->vector_storage);
+
+            this->convergence_distance << new core::param::FloatParam(0.0f, 0.0f);
+            this->MakeSlotAvailable(&this->convergence_distance);
+
+            this->convergence_steps << new core::param::IntParam(0, 0);
+            this->MakeSlotAvailable(&this->convergence_steps);
+
+            this->convergence_radius << new core::param::FloatParam(0.0f, 0.0f);
+            this->MakeSlotAvailable(&this->convergence_radius);
+
+            this->refinement_structure << new core::param::EnumParam(0);
+            this->refinement_structure.Param<core::param::EnumParam>()->SetTypePair(0, "Delaunay triangulation");
+            this->refinement_structure.Param<core::param::EnumParam>()->SetTypePair(1, "Quadtree");
+            this->MakeSlotAvailable(&this->refinement_structure);
+
             this->refinement_threshold << new core::param::FloatParam(0.00024f);
             this->MakeSlotAvailable(&this->refinement_threshold);
 
@@ -154,6 +327,12 @@ namespace megamol
             this->distance_difference_threshold << new core::param::FloatParam(0.00025f);
             this->MakeSlotAvailable(&this->distance_difference_threshold);
 
+            this->incremental_refinement << new core::param::BoolParam(true);
+            this->MakeSlotAvailable(&this->incremental_refinement);
+
+            this->max_points_per_refinement << new core::param::IntParam(0, 0);
+            this->MakeSlotAvailable(&this->max_points_per_refinement);
+
             // Create computation buttons
             this->start_computation << new core::param::ButtonParam();
             this->start_computation.SetUpdateCallback(&implicit_topology::start_computation_callback);
@@ -175,6 +354,20 @@ namespace megamol
             this->save_computation.SetUpdateCallback(&implicit_topology::save_computation_callback);
             this->MakeSlotAvailable(&this->save_computation);
 
+            this->remote_server << new core::param::StringParam("");
+            this->MakeSlotAvailable(&this->remote_server);
+
+            // Create region of interest parameters
+            this->region_of_interest << new core::param::Vector4fParam(vislib::math::Vector<float, 4>(0.0f, 0.0f, 0.0f, 0.0f));
+            this->MakeSlotAvailable(&this->region_of_interest);
+
+            this->region_reload_input << new core::param::BoolParam(false);
+            this->MakeSlotAvailable(&this->region_reload_input);
+
+            this->recompute_region << new core::param::ButtonParam();
+            this->recompute_region.SetUpdateCallback(&implicit_topology::recompute_region_callback);
+            this->MakeSlotAvailable(&this->recompute_region);
+
             // Create auto-save and auto-screenshot checkboxes
             this->auto_save_results << new core::param::BoolParam(false);
             this->MakeSlotAvailable(&this->auto_save_results);
@@ -182,6 +375,10 @@ namespace megamol
             this->auto_save_screenshots << new core::param::BoolParam(false);
             this->MakeSlotAvailable(&this->auto_save_screenshots);
 
+            // Create preview parameter
+            this->preview_resolution << new core::param::IntParam(0, 0, 2048);
+            this->MakeSlotAvailable(&this->preview_resolution);
+
             // Create transfer function parameters
             this->label_transfer_function << new core::param::TransferFunctionParam(
                 "{\"Interpolation\":\"LINEAR\",\"Nodes\":[[0.0,0.0,0.423499,1.0,0.0,0.05],[0.0,0.119346,0.529237,1.0,0.125,0.05]," \
@@ -262,6 +459,8 @@ namespace megamol
             {
                 this->computation->terminate();
             }
+
+            this->remote_computation = nullptr;
         }
 
         bool implicit_topology::create()
@@ -276,7 +475,7 @@ namespace megamol
         bool implicit_topology::initialize_computation()
         {
             // Try to load input vector field
-            if (this->computation == nullptr)
+            if (this->computation == nullptr && this->remote_computation == nullptr)
             {
                 std::array<unsigned int, 2> resolution;
                 std::array<float, 4> domain;
@@ -290,13 +489,41 @@ namespace megamol
 
                 if (load_input(resolution, domain, positions, vectors, points, point_ids, lines, line_ids))
                 {
-                    // Create new computation object
-                    this->computation = std::make_unique<implicit_topology_computation>(this->get_log_callback(), this->get_performance_callback(),
-                        std::move(resolution), std::move(domain), std::move(positions), std::move(vectors), std::move(points), std::move(point_ids),
-                        std::move(lines), std::move(line_ids),
-                        this->integration_timestep.Param<core::param::FloatParam>()->Value(),
-                        this->max_integration_error.Param<core::param::FloatParam>()->Value(),
-                        static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value()));
+                    const std::string remote_server(static_cast<const char*>(T2A(this->remote_server.Param<core::param::StringParam>()->Value())));
+
+                    if (!remote_server.empty())
+                    {
+                        // Create client for computing on the remote server
+                        this->remote_computation = std::make_unique<implicit_topology_remote_client>(remote_server,
+                            std::move(resolution), std::move(domain), std::move(positions), std::move(vectors), std::move(points), std::move(point_ids),
+                            std::move(lines), std::move(line_ids),
+                            this->integration_timestep.Param<core::param::FloatParam>()->Value(),
+                            this->max_integration_error.Param<core::param::FloatParam>()->Value(),
+                            static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value()));
+
+                        if (this->refinement_structure.Param<core::param::EnumParam>()->Value() == 1)
+                        {
+                            this->remote_computation->set_quadtree_refinement();
+                        }
+                    }
+                    else
+                    {
+                        // Create new computation object
+                        this->computation = std::make_unique<implicit_topology_computation>(this->get_log_callback(), this->get_performance_callback(),
+                            std::move(resolution), std::move(domain), std::move(positions), std::move(vectors), std::move(points), std::move(point_ids),
+                            std::move(lines), std::move(line_ids),
+                            this->integration_timestep.Param<core::param::FloatParam>()->Value(),
+                            this->max_integration_error.Param<core::param::FloatParam>()->Value(),
+                            static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value()));
+
+                        if (this->refinement_structure.Param<core::param::EnumParam>()->Value() == 1)
+                        {
+                            this->computation->set_quadtree_refinement();
+                        }
+
+                        this->computation->set_vector_storage(
+                            static_cast<streamlines_cuda::vector_storage>(this->vector_storage.Param<core::param::EnumParam>()->Value()));
+                    }
 
                     set_readonly_fixed_parameters(true);
 
@@ -317,6 +544,13 @@ namespace megamol
 
             if (vf_call != nullptr && (*vf_call)(1) && (*vf_call)(0))
             {
+                if (vf_call->get_components() != 2)
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Implicit topology computation is only supported for planar vector fields");
+
+                    return false;
+                }
+
                 resolution = this->resolution = vf_call->get_resolution();
                 domain = { vf_call->get_bounding_rectangle().Left(), vf_call->get_bounding_rectangle().Bottom(),
                     vf_call->get_bounding_rectangle().Right(), vf_call->get_bounding_rectangle().Top() };
@@ -374,6 +608,25 @@ namespace megamol
 
         void implicit_topology::update_results()
         {
+            // Take screenshot of the previous results, after they have been passed to the renderers
+            if (this->screenshot_pending && !(this->mesh_output_changed || this->data_output_changed))
+            {
+                this->screenshot_pending = false;
+
+                this->get_screenshot_callback();
+            }
+
+            // Switch between preview and full resolution of the current results on request
+            if (this->preview_resolution.IsDirty() && this->previous_result != nullptr && !(this->mesh_output_changed || this->data_output_changed))
+            {
+                this->preview_resolution.ResetDirty();
+
+                set_outputs(*this->previous_result, nullptr);
+
+                this->mesh_output_changed = true;
+                this->data_output_changed = true;
+            }
+
             // Try to get new results
             if (this->computation_running && !(this->mesh_output_changed || this->data_output_changed))
             {
@@ -388,16 +641,7 @@ namespace megamol
                 // Store triangles
                 auto result = this->last_result.get();
 
-                this->vertices = result.vertices;
-                this->indices = result.indices;
-
-                this->labels_forward = result.labels_forward;
-                this->distances_forward = result.distances_forward;
-                this->terminations_forward = result.terminations_forward;
-
-                this->labels_backward = result.labels_backward;
-                this->distances_backward = result.distances_backward;
-                this->terminations_backward = result.terminations_backward;
+                set_outputs(result, this->previous_result.get());
 
                 this->computation_running = !result.computation_state.finished;
 
@@ -410,18 +654,18 @@ namespace megamol
                 }
 
                 // Save new last result
-                this->last_result = this->computation->get_results();
+                this->last_result = this->remote_computation != nullptr ? this->remote_computation->get_results() : this->computation->get_results();
                 this->previous_result = std::make_unique<implicit_topology_results>(result);
 
-                // Save result to file, and take screenshot
+                // Save result to file in the background, and take screenshot when the result is rendered
                 if (this->auto_save_results.Param<core::param::BoolParam>()->Value())
                 {
-                    this->get_result_writer_callback(result);
+                    save_results_async(result);
                 }
 
                 if (this->auto_save_screenshots.Param<core::param::BoolParam>()->Value())
                 {
-                    this->get_screenshot_callback();
+                    this->screenshot_pending = true;
                 }
 
                 this->mesh_output_changed = true;
@@ -429,11 +673,327 @@ namespace megamol
             }
         }
 
+        void implicit_topology::set_outputs(const implicit_topology_results& result, const implicit_topology_results* previous)
+        {
+            // Intermediate results with more vertices than raster cells are only shown as preview
+            const auto preview_resolution = static_cast<std::size_t>(this->preview_resolution.Param<core::param::IntParam>()->Value());
+
+            if (!result.computation_state.finished && preview_resolution > 0 && result.indices != nullptr
+                && result.vertices.size() / 2 > preview_resolution * preview_resolution)
+            {
+                set_preview_outputs(result, preview_resolution);
+
+                this->vertices_appended = false;
+                this->forward_data_appended = false;
+                this->backward_data_appended = false;
+
+                this->preview_shown = true;
+
+                return;
+            }
+
+            // All arrays have to be flattened again after a preview
+            if (this->preview_shown)
+            {
+                previous = nullptr;
+
+                this->preview_shown = false;
+            }
+
+            // Only flatten arrays whose chunks changed since the previous result
+            auto update = [](std::shared_ptr<std::vector<float>>& data, const chunked_array<float>& new_data, const chunked_array<float>* old_data)
+            {
+                if (data == nullptr || old_data == nullptr || !new_data.shares_data_with(*old_data))
+                {
+                    data = new_data.to_vector();
+                }
+            };
+
+            update(this->vertices, result.vertices, previous != nullptr ? &previous->vertices : nullptr);
+            this->indices = result.indices;
+
+            update(this->labels_forward, result.labels_forward, previous != nullptr ? &previous->labels_forward : nullptr);
+            update(this->distances_forward, result.distances_forward, previous != nullptr ? &previous->distances_forward : nullptr);
+            update(this->terminations_forward, result.terminations_forward, previous != nullptr ? &previous->terminations_forward : nullptr);
+
+            update(this->labels_backward, result.labels_backward, previous != nullptr ? &previous->labels_backward : nullptr);
+            update(this->distances_backward, result.distances_backward, previous != nullptr ? &previous->distances_backward : nullptr);
+            update(this->terminations_backward, result.terminations_backward, previous != nullptr ? &previous->terminations_backward : nullptr);
+
+            // Check which outputs have only been appended to, allowing for incremental uploads
+            this->vertices_appended = previous != nullptr && result.vertices.extends(previous->vertices);
+
+            this->forward_data_appended = previous != nullptr && result.labels_forward.extends(previous->labels_forward)
+                && result.distances_forward.extends(previous->distances_forward) && result.terminations_forward.extends(previous->terminations_forward);
+
+            this->backward_data_appended = previous != nullptr && result.labels_backward.extends(previous->labels_backward)
+                && result.distances_backward.extends(previous->distances_backward) && result.terminations_backward.extends(previous->terminations_backward);
+        }
+
+        void implicit_topology::set_preview_outputs(const implicit_topology_results& result, const std::size_t resolution)
+        {
+            const std::size_t num_vertices = result.vertices.size() / 2;
+
+            // Fit raster to the extent of the mesh, using the given resolution along its longer side
+            float min_x = result.vertices[0], max_x = result.vertices[0];
+            float min_y = result.vertices[1], max_y = result.vertices[1];
+
+            for (std::size_t i = 1; i < num_vertices; ++i)
+            {
+                min_x = std::min(min_x, result.vertices[i * 2 + 0]);
+                max_x = std::max(max_x, result.vertices[i * 2 + 0]);
+                min_y = std::min(min_y, result.vertices[i * 2 + 1]);
+                max_y = std::max(max_y, result.vertices[i * 2 + 1]);
+            }
+
+            const float extent = std::max(std::max(max_x - min_x, max_y - min_y), std::numeric_limits<float>::min());
+            const float cell_size = extent / static_cast<float>(resolution);
+
+            const auto num_cells_x = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((max_x - min_x) / cell_size)));
+            const auto num_cells_y = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((max_y - min_y) / cell_size)));
+
+            auto get_cell = [&](const std::size_t vertex, float& distance) -> std::size_t
+            {
+                const float x = (result.vertices[vertex * 2 + 0] - min_x) / cell_size;
+                const float y = (result.vertices[vertex * 2 + 1] - min_y) / cell_size;
+
+                const auto cell_x = std::min(num_cells_x - 1, static_cast<std::size_t>(x));
+                const auto cell_y = std::min(num_cells_y - 1, static_cast<std::size_t>(y));
+
+                const float diff_x = x - (static_cast<float>(cell_x) + 0.5f);
+                const float diff_y = y - (static_cast<float>(cell_y) + 0.5f);
+                distance = diff_x * diff_x + diff_y * diff_y;
+
+                return cell_y * num_cells_x + cell_x;
+            };
+
+            // Cluster vertices per raster cell, represented by the vertex closest to the cell center
+            constexpr auto none = std::numeric_limits<GLuint>::max();
+
+            std::vector<GLuint> representatives(num_cells_x * num_cells_y, none);
+            std::vector<float> representative_distances(representatives.size(), std::numeric_limits<float>::max());
+            std::vector<GLuint> clusters(num_vertices);
+
+            for (std::size_t i = 0; i < num_vertices; ++i)
+            {
+                float distance;
+                const auto cell = get_cell(i, distance);
+
+                clusters[i] = static_cast<GLuint>(cell);
+
+                if (distance < representative_distances[cell])
+                {
+                    representatives[cell] = static_cast<GLuint>(i);
+                    representative_distances[cell] = distance;
+                }
+            }
+
+            // Output the representatives with their values, and collect their indices
+            auto vertices = std::make_shared<std::vector<float>>();
+            auto labels_forward = std::make_shared<std::vector<float>>();
+            auto labels_backward = std::make_shared<std::vector<float>>();
+            auto distances_forward = std::make_shared<std::vector<float>>();
+            auto distances_backward = std::make_shared<std::vector<float>>();
+            auto terminations_forward = std::make_shared<std::vector<float>>();
+            auto terminations_backward = std::make_shared<std::vector<float>>();
+
+            std::vector<GLuint> cell_indices(representatives.size(), none);
+
+            for (std::size_t cell = 0; cell < representatives.size(); ++cell)
+            {
+                const auto vertex = representatives[cell];
+
+                if (vertex != none)
+                {
+                    cell_indices[cell] = static_cast<GLuint>(labels_forward->size());
+
+                    vertices->push_back(result.vertices[vertex * 2 + 0]);
+                    vertices->push_back(result.vertices[vertex * 2 + 1]);
+
+                    labels_forward->push_back(result.labels_forward[vertex]);
+                    labels_backward->push_back(result.labels_backward[vertex]);
+                    distances_forward->push_back(result.distances_forward[vertex]);
+                    distances_backward->push_back(result.distances_backward[vertex]);
+                    terminations_forward->push_back(result.terminations_forward[vertex]);
+                    terminations_backward->push_back(result.terminations_backward[vertex]);
+                }
+            }
+
+            // Keep triangles spanning three different clusters, once per combination of clusters
+            const auto& input_indices = *result.indices;
+
+            std::vector<std::array<GLuint, 3>> triangles;
+            std::vector<std::uint64_t> keys;
+
+            const std::uint64_t num_clusters = labels_forward->size();
+
+            for (std::size_t i = 0; i + 2 < input_indices.size(); i += 3)
+            {
+                std::array<GLuint, 3> triangle = { cell_indices[clusters[input_indices[i + 0]]], cell_indices[clusters[input_indices[i + 1]]],
+                    cell_indices[clusters[input_indices[i + 2]]] };
+
+                if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                {
+                    continue;
+                }
+
+                auto sorted = triangle;
+                std::sort(sorted.begin(), sorted.end());
+
+                keys.push_back((sorted[0] * num_clusters + sorted[1]) * num_clusters + sorted[2]);
+                triangles.push_back(triangle);
+            }
+
+            std::vector<std::size_t> order(triangles.size());
+            std::iota(order.begin(), order.end(), static_cast<std::size_t>(0));
+            std::sort(order.begin(), order.end(), [&keys](const std::size_t lhs, const std::size_t rhs) { return keys[lhs] < keys[rhs]; });
+
+            auto indices = std::make_shared<std::vector<GLuint>>();
+            indices->reserve(triangles.size() * 3);
+
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+                if (i == 0 || keys[order[i]] != keys[order[i - 1]])
+                {
+                    indices->insert(indices->end(), triangles[order[i]].begin(), triangles[order[i]].end());
+                }
+            }
+
+            this->vertices = vertices;
+            this->indices = indices;
+
+            this->labels_forward = labels_forward;
+            this->labels_backward = labels_backward;
+            this->distances_forward = distances_forward;
+            this->distances_backward = distances_backward;
+            this->terminations_forward = terminations_forward;
+            this->terminations_backward = terminations_backward;
+        }
+
+        void implicit_topology::save_results_async(const implicit_topology_results& result)
+        {
+            {
+                std::lock_guard<std::mutex> guard(this->pending_save_lock);
+
+                const bool queued = this->pending_save != nullptr;
+
+                this->pending_save = std::make_unique<implicit_topology_results>(result);
+
+                // The queued save picks up the newer results instead
+                if (queued)
+                {
+                    return;
+                }
+            }
+
+            this->result_writer.enqueue([this, writer = this->get_result_writer_callback](const job_pool::token_t&)
+            {
+                std::unique_ptr<implicit_topology_results> result;
+
+                {
+                    std::lock_guard<std::mutex> guard(this->pending_save_lock);
+                    result = std::move(this->pending_save);
+                }
+
+                if (result != nullptr && !writer(*result))
+                {
+                    vislib::sys::Log::DefaultLog.WriteWarn("Could not save results of version %u.", result->computation_state.version);
+                }
+            });
+        }
+
+        void implicit_topology::update_gradients()
+        {
+            // Gradients are still valid if computed for the same results, as unchanged arrays are shared
+            if (this->gradients != nullptr && this->gradient_input_vertices.lock() == this->vertices && this->gradient_input_indices.lock() == this->indices
+                && this->gradient_input_distances_forward.lock() == this->distances_forward
+                && this->gradient_input_distances_backward.lock() == this->distances_backward)
+            {
+                return;
+            }
+
+            const auto& vertices = *this->vertices;
+            const auto& indices = *this->indices;
+
+            const auto& distances_forward = *this->distances_forward;
+            const auto& distances_backward = *this->distances_backward;
+
+            const std::size_t num_vertices = distances_forward.size();
+
+            // Create adjacency from vertices to their incident triangles, if the mesh topology changed
+            if (this->gradient_input_indices.lock() != this->indices || this->vertex_triangle_offsets.size() != num_vertices + 1)
+            {
+                this->vertex_triangle_offsets.assign(num_vertices + 1, 0);
+                this->vertex_triangles.resize(indices.size());
+
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    ++this->vertex_triangle_offsets[indices[i] + 1];
+                }
+
+                std::partial_sum(this->vertex_triangle_offsets.begin(), this->vertex_triangle_offsets.end(), this->vertex_triangle_offsets.begin());
+
+                std::vector<GLuint> fill(this->vertex_triangle_offsets.begin(), this->vertex_triangle_offsets.end() - 1);
+
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    this->vertex_triangles[fill[indices[i]]++] = static_cast<GLuint>(i / 3);
+                }
+            }
+
+            // Per vertex, compute the maximum gradient magnitude along its incident edges, without concurrent writes
+            auto& gradients = *(this->gradients = std::make_shared<std::vector<float>>(num_vertices));
+            auto& gradients_forward = *(this->gradients_forward = std::make_shared<std::vector<float>>(num_vertices));
+            auto& gradients_backward = *(this->gradients_backward = std::make_shared<std::vector<float>>(num_vertices));
+
+            #pragma omp parallel for
+            for (long long vertex = 0; vertex < static_cast<long long>(num_vertices); ++vertex)
+            {
+                const float point_x = vertices[vertex * 2 + 0];
+                const float point_y = vertices[vertex * 2 + 1];
+
+                float gradient_forward = 0.0f;
+                float gradient_backward = 0.0f;
+
+                for (auto t = this->vertex_triangle_offsets[vertex]; t < this->vertex_triangle_offsets[vertex + 1]; ++t)
+                {
+                    const auto triangle = this->vertex_triangles[t];
+
+                    for (std::size_t corner = 0; corner < 3; ++corner)
+                    {
+                        const auto neighbor = indices[triangle * 3 + corner];
+
+                        if (neighbor != static_cast<GLuint>(vertex))
+                        {
+                            const float diff_x = vertices[neighbor * 2 + 0] - point_x;
+                            const float diff_y = vertices[neighbor * 2 + 1] - point_y;
+                            const float length = std::sqrt(diff_x * diff_x + diff_y * diff_y);
+
+                            gradient_forward = std::max(gradient_forward, std::abs(distances_forward[vertex] - distances_forward[neighbor]) / length);
+                            gradient_backward = std::max(gradient_backward, std::abs(distances_backward[vertex] - distances_backward[neighbor]) / length);
+                        }
+                    }
+                }
+
+                gradients_forward[vertex] = gradient_forward;
+                gradients_backward[vertex] = gradient_backward;
+                gradients[vertex] = std::max(gradient_forward, gradient_backward);
+            }
+
+            this->gradient_input_vertices = this->vertices;
+            this->gradient_input_indices = this->indices;
+            this->gradient_input_distances_forward = this->distances_forward;
+            this->gradient_input_distances_backward = this->distances_backward;
+        }
+
         void implicit_topology::set_readonly_fixed_parameters(const bool read_only)
         {
             this->integration_method.Parameter()->SetGUIReadOnly(read_only);
             this->integration_timestep.Parameter()->SetGUIReadOnly(read_only);
             this->max_integration_error.Parameter()->SetGUIReadOnly(read_only);
+            this->refinement_structure.Parameter()->SetGUIReadOnly(read_only);
+            this->vector_storage.Parameter()->SetGUIReadOnly(read_only);
+            this->remote_server.Parameter()->SetGUIReadOnly(read_only);
         }
 
         void implicit_topology::set_readonly_variable_parameters(const bool read_only)
@@ -441,10 +1001,17 @@ namespace megamol
             this->num_integration_steps.Parameter()->SetGUIReadOnly(read_only);
             this->num_particles_per_batch.Parameter()->SetGUIReadOnly(read_only);
             this->num_integration_steps_per_batch.Parameter()->SetGUIReadOnly(read_only);
+            this->computation_backend.Parameter()->SetGUIReadOnly(read_only);
+            this->integration_precision.Parameter()->SetGUIReadOnly(read_only);
+            this->convergence_distance.Parameter()->SetGUIReadOnly(read_only);
+            this->convergence_steps.Parameter()->SetGUIReadOnly(read_only);
+            this->convergence_radius.Parameter()->SetGUIReadOnly(read_only);
 
             this->refinement_threshold.Parameter()->SetGUIReadOnly(read_only);
             this->refine_at_labels.Parameter()->SetGUIReadOnly(read_only);
             this->distance_difference_threshold.Parameter()->SetGUIReadOnly(read_only);
+            this->incremental_refinement.Parameter()->SetGUIReadOnly(read_only);
+            this->max_points_per_refinement.Parameter()->SetGUIReadOnly(read_only);
         }
 
         bool implicit_topology::get_triangle_data_callback(core::Call& call)
@@ -457,10 +1024,17 @@ namespace megamol
 
             if (this->mesh_output_changed)
             {
+                const auto hash = triangle_call->DataHash() + 1;
+
                 triangle_call->set_vertices(this->vertices);
                 triangle_call->set_indices(this->indices);
 
-                triangle_call->SetDataHash(triangle_call->DataHash() + 1);
+                if (!this->vertices_appended)
+                {
+                    triangle_call->set_vertices_append_only_since(hash);
+                }
+
+                triangle_call->SetDataHash(hash);
 
                 this->mesh_output_changed = false;
             }
@@ -496,18 +1070,25 @@ namespace megamol
             auto* data_call = dynamic_cast<mesh_data_call*>(&call);
             if (data_call == nullptr) return false;
 
+            // Only look at the parameters if any of them have been set since the last request
+            const auto param_generation = this->ParamGeneration();
+            const bool params_changed = param_generation != this->data_param_generation;
+
             // Set accessibility
-            this->label_range_min.Parameter()->SetGUIReadOnly(!this->label_fixed_range.Param<core::param::BoolParam>()->Value());
-            this->label_range_max.Parameter()->SetGUIReadOnly(!this->label_fixed_range.Param<core::param::BoolParam>()->Value());
+            if (params_changed)
+            {
+                this->label_range_min.Parameter()->SetGUIReadOnly(!this->label_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->label_range_max.Parameter()->SetGUIReadOnly(!this->label_fixed_range.Param<core::param::BoolParam>()->Value());
 
-            this->distance_range_min.Parameter()->SetGUIReadOnly(!this->distance_fixed_range.Param<core::param::BoolParam>()->Value());
-            this->distance_range_max.Parameter()->SetGUIReadOnly(!this->distance_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->distance_range_min.Parameter()->SetGUIReadOnly(!this->distance_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->distance_range_max.Parameter()->SetGUIReadOnly(!this->distance_fixed_range.Param<core::param::BoolParam>()->Value());
 
-            this->termination_range_min.Parameter()->SetGUIReadOnly(!this->termination_fixed_range.Param<core::param::BoolParam>()->Value());
-            this->termination_range_max.Parameter()->SetGUIReadOnly(!this->termination_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->termination_range_min.Parameter()->SetGUIReadOnly(!this->termination_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->termination_range_max.Parameter()->SetGUIReadOnly(!this->termination_fixed_range.Param<core::param::BoolParam>()->Value());
 
-            this->gradient_range_min.Parameter()->SetGUIReadOnly(!this->gradient_fixed_range.Param<core::param::BoolParam>()->Value());
-            this->gradient_range_max.Parameter()->SetGUIReadOnly(!this->gradient_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->gradient_range_min.Parameter()->SetGUIReadOnly(!this->gradient_fixed_range.Param<core::param::BoolParam>()->Value());
+                this->gradient_range_max.Parameter()->SetGUIReadOnly(!this->gradient_fixed_range.Param<core::param::BoolParam>()->Value());
+            }
 
             // Only update if there is actual data
             if (this->labels_forward == nullptr || this->labels_backward == nullptr || this->distances_forward == nullptr ||
@@ -519,11 +1100,11 @@ namespace megamol
             // Update render output if there are new results
             update_results();
 
-            if (this->data_output_changed
-                || this->label_fixed_range.IsDirty() || this->label_range_min.IsDirty() || this->label_range_max.IsDirty()
+            if (this->data_output_changed || (params_changed
+                && (this->label_fixed_range.IsDirty() || this->label_range_min.IsDirty() || this->label_range_max.IsDirty()
                 || this->distance_fixed_range.IsDirty() || this->distance_range_min.IsDirty() || this->distance_range_max.IsDirty()
                 || this->termination_fixed_range.IsDirty() || this->termination_range_min.IsDirty() || this->termination_range_max.IsDirty()
-                || this->gradient_fixed_range.IsDirty() || this->gradient_range_min.IsDirty() || this->gradient_range_max.IsDirty())
+                || this->gradient_fixed_range.IsDirty() || this->gradient_range_min.IsDirty() || this->gradient_range_max.IsDirty())))
             {
                 this->label_fixed_range.ResetDirty();
                 this->label_range_min.ResetDirty();
@@ -541,11 +1122,25 @@ namespace megamol
                 this->gradient_range_min.ResetDirty();
                 this->gradient_range_max.ResetDirty();
 
-                // Set data function
-                auto set_data = [](mesh_data_call* call, std::shared_ptr<std::vector<float>> data, const std::string& name,
-                    const bool fixed_range, const float range_min, const float range_max) -> std::pair<float, float>
+                // Set data hash, and the hashes since which data sets have only been appended to
+                const auto data_hash = data_call->DataHash() + 1;
+
+                if (this->data_output_changed)
+                {
+                    this->forward_data_append_only_since = this->forward_data_appended ? this->forward_data_append_only_since : data_hash;
+                    this->backward_data_append_only_since = this->backward_data_appended ? this->backward_data_append_only_since : data_hash;
+
+                    this->gradients_unchanged_since = data_hash;
+                }
+
+                const auto combined_append_only_since = std::max(this->forward_data_append_only_since, this->backward_data_append_only_since);
+
+                // Set data function, computing value ranges only once per data set
+                auto set_data = [this](mesh_data_call* call, std::shared_ptr<std::vector<float>> data, const std::string& name,
+                    const bool fixed_range, const float range_min, const float range_max, const SIZE_T append_only_since) -> std::pair<float, float>
                 {
                     auto data_set = std::make_shared<mesh_data_call::data_set>();
+                    data_set->append_only_since = append_only_since;
 
                     if (fixed_range)
                     {
@@ -554,9 +1149,15 @@ namespace megamol
                     }
                     else
                     {
-                        const auto min_max_value = std::minmax_element(data->begin(), data->end());
-                        data_set->min_value = *min_max_value.first;
-                        data_set->max_value = *min_max_value.second;
+                        auto& cached_range = this->value_ranges[name];
+
+                        if (cached_range.first.lock() != data)
+                        {
+                            cached_range = std::make_pair(std::weak_ptr<std::vector<float>>(data), compute_range(*data));
+                        }
+
+                        data_set->min_value = cached_range.second.first;
+                        data_set->max_value = cached_range.second.second;
                     }
 
                     data_set->data = data;
@@ -570,42 +1171,25 @@ namespace megamol
                 if (this->data_output_changed)
                 {
                     // Generate unique labels from combinations
-                    this->labels = std::make_shared<std::vector<float>>(this->labels_forward->size());
-
-                    auto less = [](const std::pair<float, float>& lhs, const std::pair<float, float>& rhs) -> std::size_t
-                    { return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second); };
-
-                    std::map<std::pair<float, float>, float, decltype(less)> label_combinations(less);
-
-                    int counter = 0;
+                    this->labels = std::make_shared<std::vector<float>>();
 
-                    for (std::size_t i = 0; i < this->labels->size(); ++i)
-                    {
-                        const auto min_max = std::minmax((*this->labels_forward)[i], (*this->labels_backward)[i]);
-
-                        if (label_combinations.find(min_max) == label_combinations.end())
-                        {
-                            label_combinations[min_max] = static_cast<float>(counter++);
-                        }
-
-                        (*this->labels)[i] = label_combinations.at(min_max);
-                    }
+                    combine_labels(*this->labels_forward, *this->labels_backward, *this->labels);
                 }
 
                 auto label_min_max = set_data(data_call, this->labels, "labels",
                     this->label_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->label_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->label_range_max.Param<core::param::FloatParam>()->Value());
+                    this->label_range_max.Param<core::param::FloatParam>()->Value(), combined_append_only_since);
 
                 auto label_forward_min_max = set_data(data_call, this->labels_forward, "labels (forward)",
                     this->label_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->label_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->label_range_max.Param<core::param::FloatParam>()->Value());
+                    this->label_range_max.Param<core::param::FloatParam>()->Value(), this->forward_data_append_only_since);
 
                 auto label_backward_min_max = set_data(data_call, this->labels_backward, "labels (backward)",
                     this->label_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->label_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->label_range_max.Param<core::param::FloatParam>()->Value());
+                    this->label_range_max.Param<core::param::FloatParam>()->Value(), this->backward_data_append_only_since);
 
                 const float label_min = std::min(label_forward_min_max.first, label_backward_min_max.first);
                 const float label_max = std::max(label_forward_min_max.second, label_backward_min_max.second);
@@ -623,27 +1207,32 @@ namespace megamol
                     // Generate combination of distances
                     this->distances = std::make_shared<std::vector<float>>(this->distances_forward->size());
 
-                    for (std::size_t i = 0; i < this->distances->size(); ++i)
+                    const auto& distances_forward = *this->distances_forward;
+                    const auto& distances_backward = *this->distances_backward;
+                    auto& distances = *this->distances;
+
+                    #pragma omp parallel for
+                    for (long long i = 0; i < static_cast<long long>(distances.size()); ++i)
                     {
-                        (*this->distances)[i] = std::sqrt((*this->distances_forward)[i] * (*this->distances_forward)[i]
-                            + (*this->distances_backward)[i] * (*this->distances_backward)[i]) / std::sqrt(2.0f);
+                        distances[i] = std::sqrt(distances_forward[i] * distances_forward[i]
+                            + distances_backward[i] * distances_backward[i]) / std::sqrt(2.0f);
                     }
                 }
 
                 set_data(data_call, this->distances, "distances",
                     this->distance_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->distance_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->distance_range_max.Param<core::param::FloatParam>()->Value());
+                    this->distance_range_max.Param<core::param::FloatParam>()->Value(), combined_append_only_since);
 
                 auto distance_forward_min_max = set_data(data_call, this->distances_forward, "distances (forward)",
                     this->distance_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->distance_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->distance_range_max.Param<core::param::FloatParam>()->Value());
+                    this->distance_range_max.Param<core::param::FloatParam>()->Value(), this->forward_data_append_only_since);
 
                 auto distance_backward_min_max = set_data(data_call, this->distances_backward, "distances (backward)",
                     this->distance_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->distance_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->distance_range_max.Param<core::param::FloatParam>()->Value());
+                    this->distance_range_max.Param<core::param::FloatParam>()->Value(), this->backward_data_append_only_since);
 
                 const float distance_min = std::min(distance_forward_min_max.first, distance_backward_min_max.first);
                 const float distance_max = std::max(distance_forward_min_max.second, distance_backward_min_max.second);
@@ -657,12 +1246,12 @@ namespace megamol
                 auto termination_forward_min_max = set_data(data_call, this->terminations_forward, "reasons for termination (forward)",
                     this->termination_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->termination_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->termination_range_max.Param<core::param::FloatParam>()->Value());
+                    this->termination_range_max.Param<core::param::FloatParam>()->Value(), this->forward_data_append_only_since);
 
                 auto termination_backward_min_max = set_data(data_call, this->terminations_backward, "reasons for termination (backward)",
                     this->termination_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->termination_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->termination_range_max.Param<core::param::FloatParam>()->Value());
+                    this->termination_range_max.Param<core::param::FloatParam>()->Value(), this->backward_data_append_only_since);
 
                 const float termination_min = std::min(termination_forward_min_max.first, termination_backward_min_max.first);
                 const float termination_max = std::max(termination_forward_min_max.second, termination_backward_min_max.second);
@@ -672,63 +1261,26 @@ namespace megamol
 
                 this->termination_transfer_function.ForceSetDirty();
 
-                // Compute and set gradient magnitudes
+                // Compute and set gradient magnitudes, only if mesh or distances changed
                 if (this->data_output_changed)
                 {
-                    auto& gradients = *(this->gradients = std::make_shared<std::vector<float>>(this->distances_forward->size()));
-                    auto& gradients_forward = *(this->gradients_forward = std::make_shared<std::vector<float>>(this->distances_forward->size(), 0.0f));
-                    auto& gradients_backward = *(this->gradients_backward = std::make_shared<std::vector<float>>(this->distances_backward->size(), 0.0f));
-
-                    const auto& vertices = *this->vertices;
-                    const auto& indices = *this->indices;
-
-                    const auto& distances_forward = *this->distances_forward;
-                    const auto& distances_backward = *this->distances_backward;
-
-                    for (std::size_t i = 0; i < indices.size(); i += 3)
-                    {
-                        const Eigen::Vector2f point_1(vertices[indices[i + 0] * 2 + 0], vertices[indices[i + 0] * 2 + 1]);
-                        const Eigen::Vector2f point_2(vertices[indices[i + 1] * 2 + 0], vertices[indices[i + 1] * 2 + 1]);
-                        const Eigen::Vector2f point_3(vertices[indices[i + 2] * 2 + 0], vertices[indices[i + 2] * 2 + 1]);
-
-                        const Eigen::Vector2f distance_1(distances_forward[indices[i + 0]], distances_backward[indices[i + 0]]);
-                        const Eigen::Vector2f distance_2(distances_forward[indices[i + 1]], distances_backward[indices[i + 1]]);
-                        const Eigen::Vector2f distance_3(distances_forward[indices[i + 2]], distances_backward[indices[i + 2]]);
-
-                        gradients_forward[indices[i + 0]] = std::max(gradients_forward[indices[i + 0]], std::abs(distance_1[0] - distance_2[0]) / (point_1 - point_2).norm());
-                        gradients_forward[indices[i + 1]] = std::max(gradients_forward[indices[i + 1]], std::abs(distance_1[0] - distance_2[0]) / (point_1 - point_2).norm());
-                        gradients_forward[indices[i + 0]] = std::max(gradients_forward[indices[i + 0]], std::abs(distance_1[0] - distance_3[0]) / (point_1 - point_3).norm());
-                        gradients_forward[indices[i + 2]] = std::max(gradients_forward[indices[i + 2]], std::abs(distance_1[0] - distance_3[0]) / (point_1 - point_3).norm());
-                        gradients_forward[indices[i + 1]] = std::max(gradients_forward[indices[i + 1]], std::abs(distance_2[0] - distance_3[0]) / (point_2 - point_3).norm());
-                        gradients_forward[indices[i + 2]] = std::max(gradients_forward[indices[i + 2]], std::abs(distance_2[0] - distance_3[0]) / (point_2 - point_3).norm());
-
-                        gradients_backward[indices[i + 0]] = std::max(gradients_backward[indices[i + 0]], std::abs(distance_1[1] - distance_2[1]) / (point_1 - point_2).norm());
-                        gradients_backward[indices[i + 1]] = std::max(gradients_backward[indices[i + 1]], std::abs(distance_1[1] - distance_2[1]) / (point_1 - point_2).norm());
-                        gradients_backward[indices[i + 0]] = std::max(gradients_backward[indices[i + 0]], std::abs(distance_1[1] - distance_3[1]) / (point_1 - point_3).norm());
-                        gradients_backward[indices[i + 2]] = std::max(gradients_backward[indices[i + 2]], std::abs(distance_1[1] - distance_3[1]) / (point_1 - point_3).norm());
-                        gradients_backward[indices[i + 1]] = std::max(gradients_backward[indices[i + 1]], std::abs(distance_2[1] - distance_3[1]) / (point_2 - point_3).norm());
-                        gradients_backward[indices[i + 2]] = std::max(gradients_backward[indices[i + 2]], std::abs(distance_2[1] - distance_3[1]) / (point_2 - point_3).norm());
-
-                        gradients[indices[i + 0]] = std::max(gradients_forward[indices[i + 0]], gradients_backward[indices[i + 0]]);
-                        gradients[indices[i + 1]] = std::max(gradients_forward[indices[i + 1]], gradients_backward[indices[i + 1]]);
-                        gradients[indices[i + 2]] = std::max(gradients_forward[indices[i + 2]], gradients_backward[indices[i + 2]]);
-                    }
+                    update_gradients();
                 }
 
                 set_data(data_call, this->gradients, "gradients",
                     this->gradient_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->gradient_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->gradient_range_max.Param<core::param::FloatParam>()->Value());
+                    this->gradient_range_max.Param<core::param::FloatParam>()->Value(), this->gradients_unchanged_since);
 
                 auto gradient_forward_min_max = set_data(data_call, this->gradients_forward, "gradients (forward)",
                     this->gradient_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->gradient_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->gradient_range_max.Param<core::param::FloatParam>()->Value());
+                    this->gradient_range_max.Param<core::param::FloatParam>()->Value(), this->gradients_unchanged_since);
 
                 auto gradient_backward_min_max = set_data(data_call, this->gradients_backward, "gradients (backward)",
                     this->gradient_fixed_range.Param<core::param::BoolParam>()->Value(),
                     this->gradient_range_min.Param<core::param::FloatParam>()->Value(),
-                    this->gradient_range_max.Param<core::param::FloatParam>()->Value());
+                    this->gradient_range_max.Param<core::param::FloatParam>()->Value(), this->gradients_unchanged_since);
 
                 const float gradient_min = std::min(gradient_forward_min_max.first, gradient_backward_min_max.first);
                 const float gradient_max = std::max(gradient_forward_min_max.second, gradient_backward_min_max.second);
@@ -800,7 +1352,7 @@ namespace megamol
                 }
 
                 // Set new data hash
-                data_call->SetDataHash(data_call->DataHash() + 1);
+                data_call->SetDataHash(data_hash);
 
                 this->data_output_changed = false;
             }
@@ -816,6 +1368,11 @@ namespace megamol
                 }
             };
 
+            if (!params_changed)
+            {
+                return true;
+            }
+
             if (this->label_transfer_function.IsDirty())
             {
                 set_transfer_function(data_call->get_data("labels"), this->label_transfer_function.Param<core::param::TransferFunctionParam>()->Value());
@@ -851,6 +1408,8 @@ namespace megamol
                 this->gradient_transfer_function.ResetDirty();
             }
 
+            this->data_param_generation = param_generation;
+
             return true;
         }
 
@@ -910,6 +1469,13 @@ namespace megamol
             return true;
         }
 
+        bool implicit_topology::get_telemetry_cb_callback(core::Call& call)
+        {
+            this->get_telemetry_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
         bool implicit_topology::start_computation_callback(core::param::ParamSlot& slot)
         {
             // Initialize computation object
@@ -919,15 +1485,38 @@ namespace megamol
                 return false;
             }
 
-            // Start computation with current values
-            this->computation->start(this->num_integration_steps.Param<core::param::IntParam>()->Value(),
-                this->refinement_threshold.Param<core::param::FloatParam>()->Value(),
-                this->refine_at_labels.Param<core::param::BoolParam>()->Value(),
-                this->distance_difference_threshold.Param<core::param::FloatParam>()->Value(),
-                this->num_particles_per_batch.Param<core::param::IntParam>()->Value(),
-                this->num_integration_steps_per_batch.Param<core::param::IntParam>()->Value());
+            // Start local or remote computation with current values
+            auto start = [this](auto& computation)
+            {
+                computation.set_convergence_criteria(this->convergence_distance.Param<core::param::FloatParam>()->Value(),
+                    static_cast<unsigned int>(this->convergence_steps.Param<core::param::IntParam>()->Value()),
+                    this->convergence_radius.Param<core::param::FloatParam>()->Value());
+
+                computation.start(this->num_integration_steps.Param<core::param::IntParam>()->Value(),
+                    this->refinement_threshold.Param<core::param::FloatParam>()->Value(),
+                    this->refine_at_labels.Param<core::param::BoolParam>()->Value(),
+                    this->distance_difference_threshold.Param<core::param::FloatParam>()->Value(),
+                    this->incremental_refinement.Param<core::param::BoolParam>()->Value(),
+                    this->max_points_per_refinement.Param<core::param::IntParam>()->Value(),
+                    this->num_particles_per_batch.Param<core::param::IntParam>()->Value(),
+                    this->num_integration_steps_per_batch.Param<core::param::IntParam>()->Value(),
+                    static_cast<implicit_topology_computation::computation_backend>(this->computation_backend.Param<core::param::EnumParam>()->Value()),
+                    static_cast<streamlines_cuda::precision>(this->integration_precision.Param<core::param::EnumParam>()->Value()));
+
+                this->last_result = computation.get_results();
+            };
+
+            if (this->remote_computation != nullptr)
+            {
+                start(*this->remote_computation);
+            }
+            else
+            {
+                // Time stamps of the telemetry match those of the call profiling
+                this->computation->set_telemetry_output(this->get_telemetry_callback(), []() { return core::profiler::Manager::Instance().Now(); });
 
-            this->last_result = this->computation->get_results();
+                start(*this->computation);
+            }
 
             this->computation_running = true;
 
@@ -942,9 +1531,16 @@ namespace megamol
         bool implicit_topology::stop_computation_callback(core::param::ParamSlot&)
         {
             // Terminate computation
-            if (this->computation != nullptr && this->computation_running)
+            if (this->computation_running && (this->computation != nullptr || this->remote_computation != nullptr))
             {
-                this->computation->terminate();
+                if (this->remote_computation != nullptr)
+                {
+                    this->remote_computation->terminate();
+                }
+                else
+                {
+                    this->computation->terminate();
+                }
 
                 vislib::sys::Log::DefaultLog.WriteInfo("Computation of topology terminated!");
             }
@@ -963,6 +1559,7 @@ namespace megamol
             stop_computation_callback(slot);
 
             this->computation = nullptr;
+            this->remote_computation = nullptr;
             this->previous_result = nullptr;
 
             // Reset parameters to read-write
@@ -1013,6 +1610,9 @@ namespace megamol
                     std::move(resolution), std::move(domain), std::move(positions), std::move(vectors), std::move(points), std::move(point_ids),
                     std::move(lines), std::move(line_ids), previous_results);
 
+                this->computation->set_vector_storage(
+                    static_cast<streamlines_cuda::vector_storage>(this->vector_storage.Param<core::param::EnumParam>()->Value()));
+
                 this->integration_timestep.Param<core::param::FloatParam>()->SetValue(previous_results.computation_state.integration_timestep);
                 this->max_integration_error.Param<core::param::FloatParam>()->SetValue(previous_results.computation_state.max_integration_error);
 
@@ -1046,6 +1646,9 @@ namespace megamol
                 return false;
             }
 
+            // Wait for pending automatic saves, which use the same writer
+            this->result_writer.wait();
+
             if (!this->get_result_writer_callback(*this->previous_result))
             {
                 slot.ResetDirty();
@@ -1056,5 +1659,81 @@ namespace megamol
 
             return true;
         }
+
+        bool implicit_topology::recompute_region_callback(core::param::ParamSlot& slot)
+        {
+            if (this->computation_running)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("The region of interest can only be recomputed while the computation is stopped.");
+
+                slot.ResetDirty();
+                return false;
+            }
+
+            if (this->remote_computation != nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("The region of interest can only be recomputed for local computations.");
+
+                slot.ResetDirty();
+                return false;
+            }
+
+            if (this->computation == nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("There is no computation whose results could be recomputed.");
+
+                slot.ResetDirty();
+                return false;
+            }
+
+            // Restart from the latest results with the current input, e.g., after convergence structures have been edited
+            if (this->region_reload_input.Param<core::param::BoolParam>()->Value())
+            {
+                std::array<unsigned int, 2> resolution;
+                std::array<float, 4> domain;
+
+                std::vector<float> positions;
+                std::vector<float> vectors;
+                std::vector<float> points;
+                std::vector<int> point_ids;
+                std::vector<float> lines;
+                std::vector<int> line_ids;
+
+                const auto previous_resolution = this->resolution;
+
+                if (!load_input(resolution, domain, positions, vectors, points, point_ids, lines, line_ids))
+                {
+                    slot.ResetDirty();
+                    return false;
+                }
+
+                if (resolution != previous_resolution)
+                {
+                    vislib::sys::Log::DefaultLog.WriteWarn("Cannot recompute the region of interest, as the resolution of the vector field changed.");
+
+                    slot.ResetDirty();
+                    return false;
+                }
+
+                const auto latest_result = this->computation->get_results().get();
+
+                this->computation = std::make_unique<implicit_topology_computation>(this->get_log_callback(), this->get_performance_callback(),
+                    std::move(resolution), std::move(domain), std::move(positions), std::move(vectors), std::move(points), std::move(point_ids),
+                    std::move(lines), std::move(line_ids), latest_result);
+            }
+
+            // Invalidate seeds within the region and restart the computation, which integrates them first
+            const auto& roi = this->region_of_interest.Param<core::param::Vector4fParam>()->Value();
+
+            const std::array<float, 4> region = { std::min(roi.X(), roi.Z()), std::min(roi.Y(), roi.W()),
+                std::max(roi.X(), roi.Z()), std::max(roi.Y(), roi.W()) };
+
+            const auto num_invalidated = this->computation->invalidate_region(region);
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Invalidated %zu seeds within [%f, %f] x [%f, %f].",
+                num_invalidated, region[0], region[2], region[1], region[3]);
+
+            return start_computation_callback(slot);
+        }
     }
 }
@@ -7,7 +7,9 @@
 #pragma once
 
 #include "implicit_topology_computation.h"
+#include "implicit_topology_remote.h"
 #include "implicit_topology_results.h"
+#include "job_pool.h"
 #include "triangulation.h"
 
 #include "mmcore/Call.h"
@@ -19,9 +21,14 @@
 #include "glad/glad.h"
 
 #include <array>
+#include <cstddef>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace megamol
@@ -109,12 +116,16 @@ namespace megamol
             bool get_performance_cb_callback(core::Call& call);
             std::function<std::ostream&()> get_performance_callback;
 
+            bool get_telemetry_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_telemetry_callback;
+
             /** Callbacks for starting/stopping/resetting the computation */
             bool start_computation_callback(core::param::ParamSlot& parameter);
             bool stop_computation_callback(core::param::ParamSlot& parameter);
             bool reset_computation_callback(core::param::ParamSlot& parameter);
             bool load_computation_callback(core::param::ParamSlot& parameter);
             bool save_computation_callback(core::param::ParamSlot& parameter);
+            bool recompute_region_callback(core::param::ParamSlot& parameter);
 
             /**
             * Initialize computation.
@@ -145,6 +156,35 @@ namespace megamol
             */
             void update_results();
 
+            /**
+            * Set outputs from the given results, or a preview of them.
+            *
+            * @param result     Results
+            * @param previous   Results of the current outputs, whose unchanged arrays are reused; nullptr to set all outputs
+            */
+            void set_outputs(const implicit_topology_results& result, const implicit_topology_results* previous);
+
+            /**
+            * Set outputs to a preview of the given results, clustering the vertices within the cells of a raster
+            * and only keeping triangles between different clusters.
+            *
+            * @param result     Results
+            * @param resolution Number of raster cells along the longer side of the domain
+            */
+            void set_preview_outputs(const implicit_topology_results& result, std::size_t resolution);
+
+            /**
+            * Save results in the background. While a save is still waiting, it is replaced by the newer results.
+            *
+            * @param result Results to save, sharing their chunks with the computation
+            */
+            void save_results_async(const implicit_topology_results& result);
+
+            /**
+            * Compute gradient magnitudes of the distance fields per vertex, if mesh or distances changed.
+            */
+            void update_gradients();
+
             /**
             * Manipulate accessibility of fixed parameters
             *
@@ -174,6 +214,7 @@ namespace megamol
             /** Output slots for logging */
             core::CalleeSlot log_slot;
             core::CalleeSlot performance_slot;
+            core::CalleeSlot telemetry_slot;
 
             /** Input slot for getting the vector field */
             core::CallerSlot vector_field_slot;
@@ -191,6 +232,14 @@ namespace megamol
             core::param::ParamSlot load_computation;
             core::param::ParamSlot save_computation;
 
+            /** Address of a remote compute server; empty for computing locally */
+            core::param::ParamSlot remote_server;
+
+            /** Recompute a region of interest, optionally with reloaded input */
+            core::param::ParamSlot region_of_interest;
+            core::param::ParamSlot region_reload_input;
+            core::param::ParamSlot recompute_region;
+
             /** Settings for labels */
             core::param::ParamSlot label_transfer_function;
             core::param::ParamSlot label_fixed_range;
@@ -219,16 +268,28 @@ namespace megamol
             core::param::ParamSlot max_integration_error;
             core::param::ParamSlot num_particles_per_batch;
             core::param::ParamSlot num_integration_steps_per_batch;
+            core::param::ParamSlot computation_backend;
+            core::param::ParamSlot integration_precision;
+            core::param::ParamSlot vector_storage;
+            core::param::ParamSlot convergence_distance;
+            core::param::ParamSlot convergence_steps;
+            core::param::ParamSlot convergence_radius;
 
             /** Parameters for grid refinement */
+            core::param::ParamSlot refinement_structure;
             core::param::ParamSlot refinement_threshold;
             core::param::ParamSlot refine_at_labels;
             core::param::ParamSlot distance_difference_threshold;
+            core::param::ParamSlot incremental_refinement;
+            core::param::ParamSlot max_points_per_refinement;
 
             /** Parameters for automatical saving of results and screenshots */
             core::param::ParamSlot auto_save_results;
             core::param::ParamSlot auto_save_screenshots;
 
+            /** Parameter for showing a preview of intermediate results */
+            core::param::ParamSlot preview_resolution;
+
             /** Input information */
             std::array<unsigned int, 2> resolution;
 
@@ -238,6 +299,24 @@ namespace megamol
             bool mesh_output_changed;
             bool data_output_changed;
 
+            /** Screenshot to take once the current results have been passed to the renderers */
+            bool screenshot_pending;
+
+            /** Indicator for the outputs showing a preview */
+            bool preview_shown;
+
+            /** Parameter generation at the last data request */
+            std::size_t data_param_generation;
+
+            /** Indicator for outputs that have only been appended to, and the data hashes since when */
+            bool vertices_appended;
+            bool forward_data_appended;
+            bool backward_data_appended;
+
+            SIZE_T forward_data_append_only_since;
+            SIZE_T backward_data_append_only_since;
+            SIZE_T gradients_unchanged_since;
+
             /** Output vertices and indices of the triangle mesh */
             std::shared_ptr<std::vector<GLfloat>> vertices;
             std::shared_ptr<std::vector<GLuint>> indices;
@@ -247,6 +326,9 @@ namespace megamol
             std::shared_ptr<std::vector<GLfloat>> labels_forward;
             std::shared_ptr<std::vector<GLfloat>> labels_backward;
 
+            /** Value ranges of the output data sets, cached as long as the data sets are unchanged */
+            std::map<std::string, std::pair<std::weak_ptr<std::vector<GLfloat>>, std::pair<float, float>>> value_ranges;
+
             /** Output distances */
             std::shared_ptr<std::vector<GLfloat>> distances;
             std::shared_ptr<std::vector<GLfloat>> distances_forward;
@@ -261,6 +343,15 @@ namespace megamol
             std::shared_ptr<std::vector<GLfloat>> gradients_forward;
             std::shared_ptr<std::vector<GLfloat>> gradients_backward;
 
+            /** Input of the last gradient computation, and adjacency from vertices to their incident triangles */
+            std::weak_ptr<std::vector<GLfloat>> gradient_input_vertices;
+            std::weak_ptr<std::vector<GLuint>> gradient_input_indices;
+            std::weak_ptr<std::vector<GLfloat>> gradient_input_distances_forward;
+            std::weak_ptr<std::vector<GLfloat>> gradient_input_distances_backward;
+
+            std::vector<GLuint> vertex_triangle_offsets;
+            std::vector<GLuint> vertex_triangles;
+
             /** Output mask */
             std::shared_ptr<std::vector<GLfloat>> valid_all;
             std::shared_ptr<std::vector<GLfloat>> valid_one;
@@ -270,11 +361,21 @@ namespace megamol
             /** Computation class */
             std::unique_ptr<implicit_topology_computation> computation;
 
+            /** Client of the remote computation, used instead of the local computation class */
+            std::unique_ptr<implicit_topology_remote_client> remote_computation;
+
             /** Store last promised result */
             std::shared_future<implicit_topology_results> last_result;
 
             /** Store previous result */
             std::unique_ptr<implicit_topology_results> previous_result;
+
+            /** Latest results waiting to be saved */
+            std::mutex pending_save_lock;
+            std::unique_ptr<implicit_topology_results> pending_save;
+
+            /** Background writer for automatically saved results, destroyed first as its jobs access the members above */
+            job_pool result_writer;
         };
     }
 }
\ No newline at end of file
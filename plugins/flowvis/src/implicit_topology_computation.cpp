@@ -2,6 +2,9 @@
 
 #include "implicit_topology_computation.h"
 #include "implicit_topology_results.h"
+#include "implicit_topology_telemetry.h"
+#include "quadtree.h"
+#include "streamlines_cpu.h"
 
 #include "../cuda/streamlines.h"
 
@@ -9,16 +12,75 @@
 #include <array>
 #include <chrono>
 #include <cmath>
-#include <deque>
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <thread>
-#include <unordered_set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+namespace
+{
+    /** Number of stream lines per reason of termination, offset by one: boundary, active, outside domain, stagnation, at structure */
+    using termination_counts_t = std::array<std::uint64_t, 7>;
+
+    /**
+    * Count stream lines per reason of termination
+    *
+    * @param terminations   Reasons of termination
+    * @param counts         In/output counts, to which the stream lines are added
+    */
+    template <typename array_t>
+    void count_terminations(const array_t& terminations, termination_counts_t& counts)
+    {
+        for (std::size_t i = 0; i < terminations.size(); ++i)
+        {
+            const auto reason = static_cast<std::size_t>(static_cast<int>(terminations[i]) + 1);
+
+            if (reason < counts.size())
+            {
+                ++counts[reason];
+            }
+        }
+    }
+
+    /**
+    * Compute the position of a point along a Morton (Z-order) curve through the domain
+    *
+    * @param x          X coordinate
+    * @param y          Y coordinate
+    * @param domain     Domain (minimum x, minimum y, maximum x, maximum y)
+    *
+    * @return Morton code, interleaving 16 bits per coordinate
+    */
+    std::uint32_t morton_code(const float x, const float y, const std::array<float, 4>& domain)
+    {
+        auto quantize = [](const float value, const float min, const float max) -> std::uint32_t
+        {
+            const float relative = (max > min) ? (value - min) / (max - min) : 0.0f;
+
+            return static_cast<std::uint32_t>(std::min(std::max(relative, 0.0f), 1.0f) * 65535.0f);
+        };
+
+        auto spread = [](std::uint32_t value)
+        {
+            value = (value | (value << 8)) & 0x00FF00FFu;
+            value = (value | (value << 4)) & 0x0F0F0F0Fu;
+            value = (value | (value << 2)) & 0x33333333u;
+            value = (value | (value << 1)) & 0x55555555u;
+
+            return value;
+        };
+
+        return spread(quantize(x, domain[0], domain[2])) | (spread(quantize(y, domain[1], domain[3])) << 1);
+    }
+}
+
 namespace megamol
 {
     namespace flowvis
@@ -39,8 +101,16 @@ namespace megamol
             integration_timestep(integration_timestep),
             max_integration_error(max_integration_error),
             method(method),
+            backends(std::make_shared<streamline_backends>()),
             num_integration_steps_performed(0),
+            result_version(0),
             terminate_computation(false),
+            refinement_initialized(false),
+            refinement_round(0),
+            convergence_distance(0.0f),
+            convergence_steps(0),
+            convergence_radius(0.0f),
+            vector_storage(streamlines_cuda::vector_storage::SINGLE),
             log_output(log_stream),
             performance_output(performance_stream)
         {
@@ -53,20 +123,11 @@ namespace megamol
             this->log_output << "Integration time step:                 " << this->integration_timestep << std::endl;
             this->log_output << "Maximum integration error:             " << this->max_integration_error << std::endl;
 
-            // Store positions
-            this->positions_forward = this->positions;
-            this->positions_backward = this->positions;
-
             // Compute initial fields
             unsigned int num = this->resolution[0] * this->resolution[1];
 
-            this->labels_forward.resize(num);
-            this->distances_forward.resize(num);
-            this->terminations_forward.resize(num);
-
-            this->labels_backward.resize(num);
-            this->distances_backward.resize(num);
-            this->terminations_backward.resize(num);
+            std::vector<float> labels_forward(num), distances_forward(num), terminations_forward(num);
+            std::vector<float> labels_backward(num), distances_backward(num), terminations_backward(num);
 
             auto calc_dot = [](const float x_1, const float y_1, const float x_2, const float y_2) { return x_1 * x_2 + y_1 * y_2; };
             auto calc_norm = [calc_dot](const float x, const float y) { return calc_dot(x, y, x, y); };
@@ -80,7 +141,7 @@ namespace megamol
                 const float x_vec = this->vectors[n * 2 + 0];
                 const float y_vec = this->vectors[n * 2 + 1];
 
-                this->distances_forward[n] = this->distances_backward[n] = std::numeric_limits<float>::max();
+                distances_forward[n] = distances_backward[n] = std::numeric_limits<float>::max();
 
                 // Compute minimum distance to convergence structures represented by points
                 for (unsigned int i = 0; i < this->point_ids.size(); ++i)
@@ -90,10 +151,10 @@ namespace megamol
 
                     const float distance = calc_length(x_pos, y_pos, point_x_pos, point_y_pos);
 
-                    if (this->distances_forward[n] > distance)
+                    if (distances_forward[n] > distance)
                     {
-                        this->labels_forward[n] = this->labels_backward[n] = static_cast<GLfloat>(this->point_ids[i]);
-                        this->distances_forward[n] = this->distances_backward[n] = distance;
+                        labels_forward[n] = labels_backward[n] = static_cast<GLfloat>(this->point_ids[i]);
+                        distances_forward[n] = distances_backward[n] = distance;
                     }
                 }
 
@@ -137,26 +198,40 @@ namespace megamol
                         }
                     }
 
-                    if (this->distances_forward[n] > distance)
+                    if (distances_forward[n] > distance)
                     {
-                        this->labels_forward[n] = this->labels_backward[n] = static_cast<GLfloat>(this->line_ids[i]);
-                        this->distances_forward[n] = this->distances_backward[n] = distance;
+                        labels_forward[n] = labels_backward[n] = static_cast<GLfloat>(this->line_ids[i]);
+                        distances_forward[n] = distances_backward[n] = distance;
                     }
                 }
 
                 // Set special values if it is part of the boundary
                 if (x_vec == 0.0f && y_vec == 0.0f)
                 {
-                    this->labels_forward[n] = this->labels_backward[n] = -1.0f;
-                    this->distances_forward[n] = this->distances_backward[n] = 0.0f;
-                    this->terminations_forward[n] = this->terminations_backward[n] = -1.0f;
+                    labels_forward[n] = labels_backward[n] = -1.0f;
+                    distances_forward[n] = distances_backward[n] = 0.0f;
+                    terminations_forward[n] = terminations_backward[n] = -1.0f;
                 }
                 else
                 {
-                    this->terminations_forward[n] = this->terminations_backward[n] = 0.0f;
+                    terminations_forward[n] = terminations_backward[n] = 0.0f;
                 }
             }
 
+            // Store positions and initial fields
+            this->positions_forward = chunked_array<float>(this->positions, implicit_topology_results::chunk_shift + 1);
+            this->positions_backward = chunked_array<float>(this->positions, implicit_topology_results::chunk_shift + 1);
+
+            this->labels_forward = chunked_array<float>(labels_forward, implicit_topology_results::chunk_shift);
+            this->distances_forward = chunked_array<float>(distances_forward, implicit_topology_results::chunk_shift);
+            this->terminations_forward = chunked_array<float>(terminations_forward, implicit_topology_results::chunk_shift);
+
+            this->labels_backward = chunked_array<float>(labels_backward, implicit_topology_results::chunk_shift);
+            this->distances_backward = chunked_array<float>(distances_backward, implicit_topology_results::chunk_shift);
+            this->terminations_backward = chunked_array<float>(terminations_backward, implicit_topology_results::chunk_shift);
+
+            this->mesh_vertices = chunked_array<float>(this->positions, implicit_topology_results::chunk_shift + 1);
+
             // Initialize triangulation
             this->delaunay.insert_points(this->positions);
         }
@@ -176,17 +251,27 @@ namespace megamol
             integration_timestep(previous_result.computation_state.integration_timestep),
             max_integration_error(previous_result.computation_state.max_integration_error),
             method(previous_result.computation_state.method),
-            positions_forward(*previous_result.positions_forward),
-            positions_backward(*previous_result.positions_backward),
-            labels_forward(*previous_result.labels_forward),
-            distances_forward(*previous_result.distances_forward),
-            terminations_forward(*previous_result.terminations_forward),
-            labels_backward(*previous_result.labels_backward),
-            distances_backward(*previous_result.distances_backward),
-            terminations_backward(*previous_result.terminations_backward),
+            backends(std::make_shared<streamline_backends>()),
+            positions_forward(previous_result.positions_forward),
+            positions_backward(previous_result.positions_backward),
+            labels_forward(previous_result.labels_forward),
+            distances_forward(previous_result.distances_forward),
+            terminations_forward(previous_result.terminations_forward),
+            labels_backward(previous_result.labels_backward),
+            distances_backward(previous_result.distances_backward),
+            terminations_backward(previous_result.terminations_backward),
             num_integration_steps_performed(previous_result.computation_state.num_integration_steps),
-            delaunay(*previous_result.vertices),
+            result_version(previous_result.computation_state.version + 1),
+            delaunay(*previous_result.vertices.to_vector()),
+            mesh_vertices(previous_result.vertices),
+            mesh_indices(previous_result.indices),
             terminate_computation(false),
+            refinement_initialized(false),
+            refinement_round(0),
+            convergence_distance(0.0f),
+            convergence_steps(0),
+            convergence_radius(0.0f),
+            vector_storage(streamlines_cuda::vector_storage::SINGLE),
             log_output(log_stream),
             performance_output(performance_stream)
         {
@@ -208,18 +293,22 @@ namespace megamol
 
         void implicit_topology_computation::start(const unsigned int num_integration_steps,
             const float refinement_threshold, const bool refine_at_labels, const float distance_difference_threshold,
-            const unsigned int num_particles_per_batch, const unsigned int num_integration_steps_per_batch)
+            const bool incremental_refinement, const unsigned int max_points_per_refinement, const unsigned int num_particles_per_batch,
+            const unsigned int num_integration_steps_per_batch, const computation_backend backend,
+            const streamlines_cuda::precision integration_precision)
         {
             // Prepare results
             {
                 std::promise<implicit_topology_results> promise;
                 this->current_result = promise.get_future().share();
 
+                // Check if there is actually something to do
+                const bool nothing_to_do = num_integration_steps <= this->num_integration_steps_performed && this->invalidated_seeds.empty();
+
                 // Set initial result
-                set_result(promise, num_integration_steps <= this->num_integration_steps_performed);
+                set_result(promise, nothing_to_do);
 
-                // Check if there is actually something to do
-                if (num_integration_steps <= this->num_integration_steps_performed)
+                if (nothing_to_do)
                 {
                     return;
                 }
@@ -234,9 +323,14 @@ namespace megamol
                 this->computation.join();
             }
 
+            // Refinement criteria may have changed, thus start with refining the whole grid
+            this->refinement_initialized = false;
+            this->refinement_deferred.clear();
+
             this->computation = std::thread(&implicit_topology_computation::run, this, std::move(promise),
                 num_integration_steps, refinement_threshold, refine_at_labels, distance_difference_threshold,
-                num_particles_per_batch, num_integration_steps_per_batch);
+                incremental_refinement, max_points_per_refinement, num_particles_per_batch, num_integration_steps_per_batch, backend,
+                integration_precision);
         }
 
         void implicit_topology_computation::terminate()
@@ -256,14 +350,63 @@ namespace megamol
             return this->current_result;
         }
 
+        implicit_topology_computation::streamline_backends::~streamline_backends() {}
+
+        std::shared_ptr<implicit_topology_computation::streamline_backends> implicit_topology_computation::get_backends() const
+        {
+            return this->backends;
+        }
+
+        void implicit_topology_computation::set_backends(std::shared_ptr<streamline_backends> backends)
+        {
+            this->backends = backends != nullptr ? std::move(backends) : std::make_shared<streamline_backends>();
+        }
+
+        void implicit_topology_computation::set_telemetry_output(std::ostream& telemetry_stream, std::function<double()> clock)
+        {
+            this->telemetry.set_output(telemetry_stream, std::move(clock));
+        }
+
+        void implicit_topology_computation::set_convergence_criteria(const float distance, const unsigned int num_steps, const float radius)
+        {
+            this->convergence_distance = distance;
+            this->convergence_steps = num_steps;
+            this->convergence_radius = radius;
+        }
+
+        void implicit_topology_computation::set_quadtree_refinement()
+        {
+            // The quadtree indexes its points like the initial grid, thus it cannot represent refined results
+            if (this->mesh_vertices.size() != this->positions.size())
+            {
+                this->log_output << "Quadtree refinement is not available for refined results; using the Delaunay triangulation." << std::endl;
+                return;
+            }
+
+            this->cells = std::make_unique<quadtree>(this->resolution, this->domain);
+            this->delaunay = triangulation();
+            this->mesh_indices = nullptr;
+        }
+
+        void implicit_topology_computation::set_vector_storage(const streamlines_cuda::vector_storage storage)
+        {
+            this->vector_storage = storage;
+        }
+
         void implicit_topology_computation::run(std::promise<implicit_topology_results>&& promise, const unsigned int num_integration_steps,
             const float refinement_threshold, const bool refine_at_labels, const float distance_difference_threshold,
-            const unsigned int num_particles_per_batch, const unsigned int num_integration_steps_per_batch)
+            const bool incremental_refinement, const unsigned int max_points_per_refinement, const unsigned int num_particles_per_batch,
+            const unsigned int num_integration_steps_per_batch, const computation_backend backend,
+            const streamlines_cuda::precision integration_precision)
         {
             // Write output
             this->log_output << "Refinement threshold:                  " << refinement_threshold << std::endl;
             this->log_output << "Refinement at labels:                  " << (refine_at_labels ? "yes" : "no") << std::endl;
             this->log_output << "Distance difference threshold:         " << distance_difference_threshold << std::endl;
+            this->log_output << "Incremental refinement:                " << (incremental_refinement ? "yes" : "no") << std::endl;
+            this->log_output << "Maximum points per refinement:         " << max_points_per_refinement << std::endl;
+            this->log_output << "Convergence distance:                  " << this->convergence_distance << std::endl;
+            this->log_output << "Convergence steps within radius:       " << this->convergence_steps << " / " << this->convergence_radius << std::endl;
             this->log_output << std::endl;
 
             this->log_output << "Starting computation..." << std::endl;
@@ -278,20 +421,137 @@ namespace megamol
             const std::chrono::time_point<clock_t> time_start_total = clock_t::now();
             const std::chrono::time_point<clock_t> time_start_initialization = clock_t::now();
 
-            streamlines_cuda streamlines(this->resolution, this->domain, this->vectors, this->points, this->point_ids,
-                this->lines, this->line_ids, this->integration_timestep, this->max_integration_error, this->method);
+            // Select backend, using the CPU if there is no CUDA device available, or the plugin was built without CUDA
+            const bool cuda_available = streamlines_cuda::get_number_of_available_devices() > 0;
+            const bool use_cuda = cuda_available && backend != computation_backend::CPU;
+
+            if (backend == computation_backend::CUDA && !cuda_available)
+            {
+                this->log_output << "No CUDA device available, computing on the CPU instead" << std::endl << std::endl;
+            }
+
+            update_labels_t update_labels_bidirectional;
+
+            using namespace std::placeholders;
+
+            // Upload input only if the backend is not already shared from a previous computation
+            bool reused_backend = false;
+
+            if (use_cuda)
+            {
+                if (this->backends->gpu == nullptr || this->backends->gpu->get_vector_storage() != this->vector_storage)
+                {
+                    this->backends->gpu = std::make_unique<streamlines_cuda>(this->resolution, this->domain, this->vectors, this->points, this->point_ids,
+                        this->lines, this->line_ids, this->integration_timestep, this->max_integration_error, this->method, this->vector_storage);
+                }
+                else
+                {
+                    this->backends->gpu->set_integration_parameters(this->integration_timestep, this->max_integration_error, this->method);
+                    reused_backend = true;
+                }
+
+                this->backends->gpu->set_precision(integration_precision);
+                this->backends->gpu->set_convergence_criteria(this->convergence_distance, this->convergence_steps, this->convergence_radius);
+
+                update_labels_bidirectional = std::bind(&streamlines_cuda::update_labels_bidirectional, this->backends->gpu.get(),
+                    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11);
+            }
+            else
+            {
+                if (this->backends->cpu == nullptr)
+                {
+                    this->backends->cpu = std::make_unique<streamlines_cpu>(this->resolution, this->domain, this->vectors, this->points, this->point_ids,
+                        this->lines, this->line_ids, this->integration_timestep, this->max_integration_error, this->method);
+                }
+                else
+                {
+                    this->backends->cpu->set_integration_parameters(this->integration_timestep, this->max_integration_error, this->method);
+                    reused_backend = true;
+                }
+
+                this->backends->cpu->set_convergence_criteria(this->convergence_distance, this->convergence_steps, this->convergence_radius);
+
+                update_labels_bidirectional = std::bind(&streamlines_cpu::update_labels_bidirectional, this->backends->cpu.get(),
+                    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11);
+            }
 
             this->performance_output << "Initialization:;" << std::chrono::duration_cast<duration_t>(clock_t::now() - time_start_initialization).count() << std::endl << std::endl;
 
+            this->telemetry.add_time("initialization", std::chrono::duration<double, std::milli>(clock_t::now() - time_start_initialization).count());
+            this->telemetry.add_count("reused_backend", reused_backend ? 1 : 0);
+            this->telemetry.write_record("initialization");
+
+            // Telemetry of an integration: active seeds, seeds terminated during the integration per reason, and GPU timings and transfers
+            auto record_integration = [this, use_cuda](const char* event, const termination_counts_t& before, const termination_counts_t& after)
+            {
+                this->telemetry.add_count("active_seeds", before[1]);
+                this->telemetry.add_count("terminated_outside", after[2] - before[2]);
+                this->telemetry.add_count("terminated_stagnation", after[3] - before[3]);
+                this->telemetry.add_count("terminated_at_structure", after[4] - before[4]);
+                this->telemetry.add_count("terminated_converged", after[6] - before[6]);
+
+                if (use_cuda)
+                {
+                    const auto stats = this->backends->gpu->get_statistics();
+                    this->backends->gpu->reset_statistics();
+
+                    this->telemetry.add_time("upload", stats.upload_time);
+                    this->telemetry.add_time("kernel", stats.kernel_time);
+                    this->telemetry.add_time("download", stats.download_time);
+                    this->telemetry.add_count("bytes_uploaded", stats.bytes_uploaded);
+                    this->telemetry.add_count("bytes_downloaded", stats.bytes_downloaded);
+                }
+
+                this->telemetry.write_record(event);
+            };
+
+            if (use_cuda)
+            {
+                this->backends->gpu->reset_statistics();
+            }
+
+            if (use_cuda)
+            {
+                this->log_output << "Backend:                               CUDA (" << this->backends->gpu->get_number_of_devices() << " device(s))"
+                    << (reused_backend ? ", reused" : "") << std::endl;
+                this->log_output << "Precision:                             "
+                    << (integration_precision == streamlines_cuda::precision::DOUBLE ? "double" :
+                        (integration_precision == streamlines_cuda::precision::MIXED ? "mixed" : "single")) << std::endl;
+                this->log_output << "Vector storage:                        "
+                    << (this->vector_storage == streamlines_cuda::vector_storage::HALF ? "half" : "single") << std::endl << std::endl;
+            }
+            else
+            {
+                this->log_output << "Backend:                               CPU" << (reused_backend ? ", reused" : "") << std::endl << std::endl;
+            }
+
             // Initialize performance measure and output
-            this->total_time = this->total_time_integration = this->total_time_refinement = duration_t::zero();
+            this->total_time = this->total_time_integration = this->total_time_refinement = this->total_time_refined_integration = duration_t::zero();
             this->performance_num_particles_added = 0;
+            this->performance_total_num_resolved_edges = 0;
 
             this->performance_output << "Grid refinement " << duration_str << ";";
             this->performance_output << "Number of points;";
+            this->performance_output << "Candidate edges;";
+            this->performance_output << "Resolved boundary edges;";
             this->performance_output << "Number of integration steps;";
             this->performance_output << "Stream line integration " << duration_str << ";";
-            this->performance_output << "Total " << duration_str << std::endl;
+            this->performance_output << "Total " << duration_str << ";";
+            this->performance_output << "Cost per resolved boundary " << duration_str << std::endl;
+
+            // Integrate seeds of invalidated regions again, such that they catch up with all other seeds
+            if (!this->invalidated_seeds.empty())
+            {
+                integrate_invalidated_seeds(update_labels_bidirectional, num_particles_per_batch, num_integration_steps_per_batch);
+
+                if (this->terminate_computation)
+                {
+                    this->log_output << "Finished computation! (terminated)" << std::endl << std::endl;
+
+                    set_result(promise, true);
+                    return;
+                }
+            }
 
             const auto time_start_integration = clock_t::now();
             const std::size_t performance_num_integration_steps = num_integration_steps - this->num_integration_steps_performed;
@@ -308,11 +568,39 @@ namespace megamol
                     this->log_output << "Number of integration steps:           " << num_steps << "   "
                         << this->num_integration_steps_performed << " / " << num_integration_steps << std::endl;
 
-                    streamlines.update_labels(this->positions_forward, this->labels_forward, this->distances_forward, this->terminations_forward,
-                        num_steps, 1.0f, num_particles_per_batch);
+                    termination_counts_t terminations_before{}, terminations_after{};
 
-                    streamlines.update_labels(this->positions_backward, this->labels_backward, this->distances_backward, this->terminations_backward,
-                        num_steps, -1.0f, num_particles_per_batch);
+                    if (this->telemetry.is_enabled())
+                    {
+                        count_terminations(this->terminations_forward, terminations_before);
+                        count_terminations(this->terminations_backward, terminations_before);
+                    }
+
+                    // Integrate forward and backward in one launch; before the first step, both directions share the same seed.
+                    // Chunks still shared with the last published result are copied before being written to.
+                    {
+                        implicit_topology_telemetry::scoped_timer timer(this->telemetry, "integration");
+
+                        for (std::size_t chunk = 0; chunk < this->labels_forward.get_number_of_chunks(); ++chunk)
+                        {
+                            update_labels_bidirectional(
+                                this->positions_forward.get_writable_chunk(chunk), this->labels_forward.get_writable_chunk(chunk),
+                                this->distances_forward.get_writable_chunk(chunk), this->terminations_forward.get_writable_chunk(chunk),
+                                this->positions_backward.get_writable_chunk(chunk), this->labels_backward.get_writable_chunk(chunk),
+                                this->distances_backward.get_writable_chunk(chunk), this->terminations_backward.get_writable_chunk(chunk),
+                                num_steps, this->num_integration_steps_performed == 0, num_particles_per_batch);
+                        }
+                    }
+
+                    if (this->telemetry.is_enabled())
+                    {
+                        count_terminations(this->terminations_forward, terminations_after);
+                        count_terminations(this->terminations_backward, terminations_after);
+
+                        this->telemetry.add_count("integration_steps", num_steps);
+
+                        record_integration("integration", terminations_before, terminations_after);
+                    }
 
                     this->num_integration_steps_performed += num_steps;
 
@@ -334,9 +622,10 @@ namespace megamol
 
                 this->performance_output << "-;";
                 this->performance_output << this->labels_forward.size() << ";";
+                this->performance_output << "-;-;";
                 this->performance_output << performance_num_integration_steps << ";";
                 this->performance_output << this->total_time_integration.count() << ";";
-                this->performance_output << this->total_time.count() << std::endl;
+                this->performance_output << this->total_time.count() << ";-" << std::endl;
             }
 
             // Alternatingly perform grid refinement and stream line integration
@@ -368,7 +657,17 @@ namespace megamol
                     const auto time_start_refinement = clock_t::now();
 
                     // Refine grid and get new seed points
-                    new_positions_forward = new_positions_backward = refine_grid(refinement_threshold, refine_at_labels, distance_difference_threshold);
+                    {
+                        implicit_topology_telemetry::scoped_timer timer(this->telemetry, "refinement");
+
+                        new_positions_forward = new_positions_backward = refine_grid(refinement_threshold, refine_at_labels,
+                            distance_difference_threshold, incremental_refinement, max_points_per_refinement);
+                    }
+
+                    this->telemetry.add_count("candidate_edges", this->performance_num_candidate_edges);
+                    this->telemetry.add_count("resolved_edges", this->performance_num_resolved_edges);
+                    this->telemetry.add_count("new_points", new_positions_forward.size() / 2);
+                    this->telemetry.write_record("refinement");
 
                     // Performance output
                     time_refinement = std::chrono::duration_cast<duration_t>(clock_t::now() - time_start_refinement);
@@ -377,14 +676,17 @@ namespace megamol
                     this->total_time_refinement += time_refinement;
 
                     this->performance_output << time_refinement.count() << ";";
-                    this->performance_output << (new_positions_forward.size() / 2) << ";" << std::flush;
+                    this->performance_output << (new_positions_forward.size() / 2) << ";";
+                    this->performance_output << this->performance_num_candidate_edges << ";";
+                    this->performance_output << this->performance_num_resolved_edges << ";" << std::flush;
 
                     this->performance_num_particles_added += new_positions_forward.size() / 2;
+                    this->performance_total_num_resolved_edges += this->performance_num_resolved_edges;
 
                     // Check if new points have been added; if not, the computation is finished
                     if (new_positions_forward.empty())
                     {
-                        this->performance_output << "-;-;" << time_refinement.count() << std::endl;
+                        this->performance_output << "-;-;" << time_refinement.count() << ";-" << std::endl;
 
                         finished = true;
                     }
@@ -428,11 +730,33 @@ namespace megamol
                     this->log_output << "Number of integration steps:           " << num_steps << "   "
                                      << num_refined_integration_steps << " / " << num_integration_steps << std::endl;
 
-                    streamlines.update_labels(new_positions_forward, new_labels_forward, new_distances_forward, new_terminations_forward,
-                        num_steps, 1.0f, num_particles_per_batch);
+                    termination_counts_t terminations_before{}, terminations_after{};
+
+                    if (this->telemetry.is_enabled())
+                    {
+                        count_terminations(new_terminations_forward, terminations_before);
+                        count_terminations(new_terminations_backward, terminations_before);
+                    }
+
+                    // Integrate forward and backward in one launch; newly created seeds are identical for both directions
+                    {
+                        implicit_topology_telemetry::scoped_timer timer(this->telemetry, "integration");
+
+                        update_labels_bidirectional(
+                            new_positions_forward, new_labels_forward, new_distances_forward, new_terminations_forward,
+                            new_positions_backward, new_labels_backward, new_distances_backward, new_terminations_backward,
+                            num_steps, num_refined_integration_steps == 0, num_particles_per_batch);
+                    }
+
+                    if (this->telemetry.is_enabled())
+                    {
+                        count_terminations(new_terminations_forward, terminations_after);
+                        count_terminations(new_terminations_backward, terminations_after);
+
+                        this->telemetry.add_count("integration_steps", num_steps);
 
-                    streamlines.update_labels(new_positions_backward, new_labels_backward, new_distances_backward, new_terminations_backward,
-                        num_steps, -1.0f, num_particles_per_batch);
+                        record_integration("refined_integration", terminations_before, terminations_after);
+                    }
 
                     num_refined_integration_steps += num_steps;
 
@@ -446,23 +770,34 @@ namespace megamol
 
                         this->total_time += time_integration;
                         this->total_time_integration += time_integration;
+                        this->total_time_refined_integration += time_integration;
 
                         this->performance_output << num_integration_steps << ";";
                         this->performance_output << time_integration.count() << ";";
-                        this->performance_output << (time_refinement + time_integration).count() << std::endl;
+                        this->performance_output << (time_refinement + time_integration).count() << ";";
 
-                        // Merge positions and output arrays
-                        this->positions_forward.insert(this->positions_forward.end(), new_positions_forward.begin(), new_positions_forward.end());
-                        this->positions_backward.insert(this->positions_backward.end(), new_positions_backward.begin(), new_positions_backward.end());
+                        if (this->performance_num_resolved_edges > 0)
+                        {
+                            this->performance_output << static_cast<double>((time_refinement + time_integration).count())
+                                / this->performance_num_resolved_edges << std::endl;
+                        }
+                        else
+                        {
+                            this->performance_output << "-" << std::endl;
+                        }
 
-                        this->labels_forward.insert(this->labels_forward.end(), new_labels_forward.begin(), new_labels_forward.end());
-                        this->labels_backward.insert(this->labels_backward.end(), new_labels_backward.begin(), new_labels_backward.end());
+                        // Merge positions and output arrays, filling up the last chunks first
+                        this->positions_forward.append(new_positions_forward);
+                        this->positions_backward.append(new_positions_backward);
 
-                        this->distances_forward.insert(this->distances_forward.end(), new_distances_forward.begin(), new_distances_forward.end());
-                        this->distances_backward.insert(this->distances_backward.end(), new_distances_backward.begin(), new_distances_backward.end());
+                        this->labels_forward.append(new_labels_forward);
+                        this->labels_backward.append(new_labels_backward);
 
-                        this->terminations_forward.insert(this->terminations_forward.end(), new_terminations_forward.begin(), new_terminations_forward.end());
-                        this->terminations_backward.insert(this->terminations_backward.end(), new_terminations_backward.begin(), new_terminations_backward.end());
+                        this->distances_forward.append(new_distances_forward);
+                        this->distances_backward.append(new_distances_backward);
+
+                        this->terminations_forward.append(new_terminations_forward);
+                        this->terminations_backward.append(new_terminations_backward);
 
                         finished_refined_integration = true;
                     }
@@ -483,11 +818,18 @@ namespace megamol
                 }
             }
 
+            finish_insertion();
+
             this->log_output << "Finished computation!" << (this->terminate_computation ? " (terminated)" : "") << std::endl << std::endl;
 
             // Performance output
             this->total_runtime = std::chrono::duration_cast<duration_t>(clock_t::now() - time_start_total);
 
+            this->telemetry.add_time("total", std::chrono::duration<double, std::milli>(clock_t::now() - time_start_total).count());
+            this->telemetry.add_count("num_points", this->labels_forward.size());
+            this->telemetry.add_count("terminated", this->terminate_computation ? 1 : 0);
+            this->telemetry.write_record("finished");
+
             print_performance(num_integration_steps);
         }
 
@@ -495,22 +837,34 @@ namespace megamol
         {
             implicit_topology_results current_result;
 
-            auto mesh = this->delaunay.export_grid();
-            current_result.vertices = mesh.first;
-            current_result.indices = mesh.second;
+            // Only export the mesh topology if it changed, i.e., after refinement; all other arrays are
+            // shared with the computation, such that only chunks modified afterwards have to be copied
+            if (this->mesh_indices == nullptr)
+            {
+                finish_insertion();
+
+                implicit_topology_telemetry::scoped_timer timer(this->telemetry, "export_indices");
+
+                this->mesh_indices = this->cells != nullptr ? this->cells->export_indices() : this->delaunay.export_indices();
+            }
+
+            current_result.vertices = this->mesh_vertices;
+            current_result.indices = this->mesh_indices;
 
-            current_result.positions_forward = std::make_shared<std::vector<float>>(this->positions_forward);
-            current_result.labels_forward = std::make_shared<std::vector<float>>(this->labels_forward);
-            current_result.distances_forward = std::make_shared<std::vector<float>>(this->distances_forward);
-            current_result.terminations_forward = std::make_shared<std::vector<float>>(this->terminations_forward);
+            current_result.positions_forward = this->positions_forward;
+            current_result.labels_forward = this->labels_forward;
+            current_result.distances_forward = this->distances_forward;
+            current_result.terminations_forward = this->terminations_forward;
 
-            current_result.positions_backward = std::make_shared<std::vector<float>>(this->positions_backward);
-            current_result.labels_backward = std::make_shared<std::vector<float>>(this->labels_backward);
-            current_result.distances_backward = std::make_shared<std::vector<float>>(this->distances_backward);
-            current_result.terminations_backward = std::make_shared<std::vector<float>>(this->terminations_backward);
+            current_result.positions_backward = this->positions_backward;
+            current_result.labels_backward = this->labels_backward;
+            current_result.distances_backward = this->distances_backward;
+            current_result.terminations_backward = this->terminations_backward;
 
+            current_result.computation_state.version = this->result_version++;
             current_result.computation_state.finished = finished;
 
+            current_result.computation_state.method = this->method;
             current_result.computation_state.integration_timestep = this->integration_timestep;
             current_result.computation_state.max_integration_error = this->max_integration_error;
             current_result.computation_state.num_integration_steps = this->num_integration_steps_performed;
@@ -518,148 +872,619 @@ namespace megamol
             promise.set_value(std::move(current_result));
         }
 
+        std::size_t implicit_topology_computation::invalidate_region(const std::array<float, 4>& region)
+        {
+            std::size_t num_invalidated = 0;
+
+            for (std::size_t i = 0; i < this->labels_forward.size(); ++i)
+            {
+                const float x = this->mesh_vertices[i * 2 + 0];
+                const float y = this->mesh_vertices[i * 2 + 1];
+
+                // Boundary seeds are never integrated, and thus do not need to be invalidated
+                if (x < region[0] || x > region[2] || y < region[1] || y > region[3] ||
+                    (this->terminations_forward[i] == -1.0f && this->terminations_backward[i] == -1.0f))
+                {
+                    continue;
+                }
+
+                // Reset seed to its original position, and initialize its results as for seeds inserted by refinement
+                this->positions_forward.set(i * 2 + 0, x);
+                this->positions_forward.set(i * 2 + 1, y);
+                this->positions_backward.set(i * 2 + 0, x);
+                this->positions_backward.set(i * 2 + 1, y);
+
+                this->labels_forward.set(i, -1.0f);
+                this->labels_backward.set(i, -1.0f);
+                this->distances_forward.set(i, std::numeric_limits<float>::max());
+                this->distances_backward.set(i, std::numeric_limits<float>::max());
+                this->terminations_forward.set(i, 0.0f);
+                this->terminations_backward.set(i, 0.0f);
+
+                this->invalidated_seeds.push_back(i);
+                ++num_invalidated;
+            }
+
+            // Regions may overlap
+            std::sort(this->invalidated_seeds.begin(), this->invalidated_seeds.end());
+            this->invalidated_seeds.erase(std::unique(this->invalidated_seeds.begin(), this->invalidated_seeds.end()), this->invalidated_seeds.end());
+
+            return num_invalidated;
+        }
+
+        void implicit_topology_computation::integrate_invalidated_seeds(const update_labels_t& update_labels_bidirectional,
+            const unsigned int num_particles_per_batch, const unsigned int num_integration_steps_per_batch)
+        {
+            const auto time_start = clock_t::now();
+            const std::size_t num_seeds = this->invalidated_seeds.size();
+
+            this->log_output << "Integrating stream lines for invalidated particles..." << std::endl;
+            this->log_output << "Number of invalidated particles:       " << num_seeds << std::endl;
+
+            // Gather invalidated seeds and their reset results
+            std::vector<float> positions_forward(2 * num_seeds), positions_backward(2 * num_seeds);
+            std::vector<float> labels_forward(num_seeds), labels_backward(num_seeds);
+            std::vector<float> distances_forward(num_seeds), distances_backward(num_seeds);
+            std::vector<float> terminations_forward(num_seeds), terminations_backward(num_seeds);
+
+            for (std::size_t s = 0; s < num_seeds; ++s)
+            {
+                const auto i = this->invalidated_seeds[s];
+
+                positions_forward[s * 2 + 0] = positions_backward[s * 2 + 0] = this->positions_forward[i * 2 + 0];
+                positions_forward[s * 2 + 1] = positions_backward[s * 2 + 1] = this->positions_forward[i * 2 + 1];
+
+                labels_forward[s] = this->labels_forward[i];
+                labels_backward[s] = this->labels_backward[i];
+                distances_forward[s] = this->distances_forward[i];
+                distances_backward[s] = this->distances_backward[i];
+                terminations_forward[s] = this->terminations_forward[i];
+                terminations_backward[s] = this->terminations_backward[i];
+            }
+
+            // Integrate as many steps as all other seeds; the seeds are identical for both directions before the first step
+            unsigned int num_steps_performed = 0;
+
+            while (num_steps_performed < this->num_integration_steps_performed && !this->terminate_computation)
+            {
+                const unsigned int num_steps = std::min(this->num_integration_steps_performed - num_steps_performed, num_integration_steps_per_batch);
+
+                this->log_output << "Number of integration steps:           " << num_steps << "   "
+                    << num_steps_performed << " / " << this->num_integration_steps_performed << std::endl;
+
+                implicit_topology_telemetry::scoped_timer timer(this->telemetry, "integration");
+
+                update_labels_bidirectional(positions_forward, labels_forward, distances_forward, terminations_forward,
+                    positions_backward, labels_backward, distances_backward, terminations_backward,
+                    num_steps, num_steps_performed == 0, num_particles_per_batch);
+
+                num_steps_performed += num_steps;
+            }
+
+            // Keep the seeds invalidated if terminated early, such that they are integrated completely next time
+            if (this->terminate_computation)
+            {
+                return;
+            }
+
+            // Scatter results back to the original seeds
+            for (std::size_t s = 0; s < num_seeds; ++s)
+            {
+                const auto i = this->invalidated_seeds[s];
+
+                this->positions_forward.set(i * 2 + 0, positions_forward[s * 2 + 0]);
+                this->positions_forward.set(i * 2 + 1, positions_forward[s * 2 + 1]);
+                this->positions_backward.set(i * 2 + 0, positions_backward[s * 2 + 0]);
+                this->positions_backward.set(i * 2 + 1, positions_backward[s * 2 + 1]);
+
+                this->labels_forward.set(i, labels_forward[s]);
+                this->labels_backward.set(i, labels_backward[s]);
+                this->distances_forward.set(i, distances_forward[s]);
+                this->distances_backward.set(i, distances_backward[s]);
+                this->terminations_forward.set(i, terminations_forward[s]);
+                this->terminations_backward.set(i, terminations_backward[s]);
+            }
+
+            this->invalidated_seeds.clear();
+
+            this->telemetry.add_count("invalidated_seeds", num_seeds);
+            this->telemetry.add_count("integration_steps", num_steps_performed);
+            this->telemetry.write_record("region_integration");
+
+            this->log_output << "Finished integration for invalidated particles!" << std::endl << std::endl;
+
+            this->performance_output << "Region integration:;" << std::chrono::duration_cast<duration_t>(clock_t::now() - time_start).count()
+                << ";" << num_seeds << std::endl << std::endl;
+        }
+
         std::vector<float> implicit_topology_computation::refine_grid(const float refinement_threshold,
-            const bool refine_at_labels, const float distance_difference_threshold)
+            const bool refine_at_labels, const float distance_difference_threshold, const bool incremental, const unsigned int max_points)
         {
+            if (this->cells != nullptr)
+            {
+                return refine_quadtree(refinement_threshold, refine_at_labels, distance_difference_threshold, max_points);
+            }
+
             this->log_output << "Refining grid..." << std::endl;
 
-            // Find and mark points where the edges should be refined
-            std::unordered_set<std::size_t> marked_points;
+            finish_insertion();
+
+            const std::size_t num_vertices = this->delaunay.get_number_of_vertices();
+
+            // Update the neighbors once, such that they can be queried in parallel
+            const auto& adjacency = this->delaunay.get_adjacency();
+
+            const bool full_refinement = !incremental || !this->refinement_initialized;
+
+            this->refinement_marks.resize(num_vertices, 0);
+            this->refinement_stamps.resize(num_vertices, 0);
+
+            const auto stamp = ++this->refinement_round;
+
+            // Select points whose marks have to be (re-)evaluated: all points, or only points connected
+            // to the points inserted last, as all other marks cannot have changed
+            std::vector<std::size_t> sources;
+
+            if (full_refinement)
+            {
+                sources.resize(num_vertices);
+                std::iota(sources.begin(), sources.end(), 0);
+
+                std::fill(this->refinement_stamps.begin(), this->refinement_stamps.end(), stamp);
+            }
+            else
+            {
+                const auto last_inserted = this->delaunay.get_last_inserted();
+
+                auto add_source = [this, &sources, stamp](const std::size_t index)
+                {
+                    if (this->refinement_stamps[index] != stamp)
+                    {
+                        this->refinement_stamps[index] = stamp;
+                        sources.push_back(index);
+                    }
+                };
+
+                for (std::size_t index = last_inserted.first; index < last_inserted.second; ++index)
+                {
+                    add_source(this->delaunay.get_vertex(index)->info());
+
+                    for (auto neighbor = adjacency.begin(index); neighbor != adjacency.end(index); ++neighbor)
+                    {
+                        add_source(*neighbor);
+                    }
+                }
+
+                // Revisit points whose candidate edges have been deferred
+                for (const auto index : this->refinement_deferred)
+                {
+                    add_source(index);
+                }
+            }
+
+            this->refinement_deferred.clear();
+
+            // Mark points, where at least one connected edge satisfies the refinement criteria
+            #pragma omp parallel for
+            for (long long source_index = 0; source_index < static_cast<long long>(sources.size()); ++source_index)
+            {
+                const auto point_i = sources[source_index];
+
+                std::uint8_t mark = not_marked;
+
+                for (auto neighbor = adjacency.begin(point_i); neighbor != adjacency.end(point_i) && mark != marked_by_label; ++neighbor)
+                {
+                    const auto edge_mark = evaluate_edge(point_i, *neighbor, refine_at_labels, distance_difference_threshold);
+
+                    if (edge_mark != not_marked)
+                    {
+                        mark = (mark == not_marked || edge_mark == marked_by_label) ? edge_mark : mark;
+                    }
+                }
+
+                this->refinement_marks[point_i] = mark;
+            }
 
             std::size_t num_points_by_label = 0;
             std::size_t num_points_by_distance = 0;
 
-            for (auto cell_it = this->delaunay.get_finite_cells_begin(); cell_it != this->delaunay.get_finite_cells_end(); ++cell_it)
+            for (const auto point_i : sources)
             {
-                for (int pi = 0; pi < 2; ++pi)
-                {
-                    const auto vertex_i = cell_it->vertex(pi);
-                    const auto point_i = vertex_i->info();
+                num_points_by_label += this->refinement_marks[point_i] == marked_by_label ? 1 : 0;
+                num_points_by_distance += this->refinement_marks[point_i] == marked_by_distance ? 1 : 0;
+            }
 
-                    const auto label_forward_i = this->labels_forward[point_i];
-                    const auto label_backward_i = this->labels_backward[point_i];
+            this->log_output << "Marked points:                         " << (num_points_by_label + num_points_by_distance) << std::endl;
+            this->log_output << "Marked points by label:                " << num_points_by_label << std::endl;
+            this->log_output << "Marked points by distance difference:  " << num_points_by_distance << std::endl;
 
-                    const auto distance_forward_i = this->distances_forward[point_i];
-                    const auto distance_backward_i = this->distances_backward[point_i];
+            // Refine edges connected to marked points if they are not too short already. Edges between two marked
+            // points are only handled by the point with the lower index. Unchanged marked points do not need to be
+            // revisited, as their edges have been refined before.
+            const auto refinement_threshold_squared = refinement_threshold * refinement_threshold;
 
-                    const auto termination_forward_i = this->terminations_forward[point_i];
-                    const auto termination_backward_i = this->terminations_backward[point_i];
+            auto for_each_marked_edge = [this, &adjacency, stamp](const std::size_t point_i, const std::function<void(const triangulation::vertex_t&)>& func)
+            {
+                for (auto neighbor = adjacency.begin(point_i); neighbor != adjacency.end(point_i); ++neighbor)
+                {
+                    const auto point_j = *neighbor;
 
-                    for (int pj = pi + 1; pj < 3; ++pj)
+                    if (this->refinement_marks[point_j] == not_marked || this->refinement_stamps[point_j] != stamp || point_i < point_j)
                     {
-                        const auto vertex_j = cell_it->vertex(pj);
-                        const auto point_j = vertex_j->info();
+                        func(this->delaunay.get_vertex(point_j));
+                    }
+                }
+            };
+
+            // Count candidate edges per marked point, ...
+            std::vector<std::size_t> candidate_offsets(sources.size() + 1, 0);
+            long long num_marked_edges = 0;
 
-                        const auto label_forward_j = this->labels_forward[point_j];
-                        const auto label_backward_j = this->labels_backward[point_j];
+            #pragma omp parallel for reduction(+:num_marked_edges)
+            for (long long source_index = 0; source_index < static_cast<long long>(sources.size()); ++source_index)
+            {
+                const auto point_i = sources[source_index];
 
-                        const auto distance_forward_j = this->distances_forward[point_j];
-                        const auto distance_backward_j = this->distances_backward[point_j];
+                if (this->refinement_marks[point_i] != not_marked)
+                {
+                    const auto& point = this->delaunay.get_vertex(point_i)->point();
 
-                        const auto termination_forward_j = this->terminations_forward[point_j];
-                        const auto termination_backward_j = this->terminations_backward[point_j];
+                    for_each_marked_edge(point_i, [&](const triangulation::vertex_t& neighbor)
+                    {
+                        ++num_marked_edges;
 
-                        if (termination_forward_i == 0 || termination_backward_i == 0 || termination_forward_j == 0 || termination_backward_j == 0)
+                        if ((point - neighbor->point()).squared_length() > refinement_threshold_squared)
                         {
-                            if (refine_at_labels && (label_forward_i != label_forward_j || label_backward_i != label_backward_j))
-                            {
-                                ++num_points_by_label;
-
-                                marked_points.insert(point_i);
-                                marked_points.insert(point_j);
-                            }
-                            else if (std::abs(distance_forward_i - distance_forward_j) > distance_difference_threshold
-                                || std::abs(distance_backward_i - distance_backward_j) > distance_difference_threshold)
-                            {
-                                ++num_points_by_distance;
-
-                                marked_points.insert(point_i);
-                                marked_points.insert(point_j);
-                            }
+                            ++candidate_offsets[source_index + 1];
                         }
-                    }
+                    });
                 }
             }
 
-            this->log_output << "Marked points:                         " << marked_points.size() << std::endl;
-            this->log_output << "Marked points by label:                " << num_points_by_label << std::endl;
-            this->log_output << "Marked points by distance difference:  " << num_points_by_distance << std::endl;
+            std::partial_sum(candidate_offsets.begin(), candidate_offsets.end(), candidate_offsets.begin());
 
-            // Refine edges connected to marked points if they are not too short already
-            std::deque<std::pair<triangulation::point_t, std::size_t>> new_points;
-            std::size_t point_index = this->delaunay.delaunay.number_of_vertices();
+            this->log_output << "Marked edges:                          " << num_marked_edges << std::endl;
 
-            auto edge_hash = [](const std::pair<std::size_t, std::size_t>& edge) { return std::hash<std::size_t>()(edge.first) ^ std::hash<std::size_t>()(edge.second); };
+            // ... collect them with their priority, given by the number of directions with different labels, followed by
+            // the larger distance difference, and their midpoints, ...
+            struct candidate_edge
+            {
+                std::size_t point;
+
+                float label_difference;
+                float distance_difference;
+                float length_squared;
+
+                std::array<float, 2> mid_point;
+            };
 
-            std::unordered_set<std::pair<std::size_t, std::size_t>, decltype(edge_hash)> edges(199, edge_hash);
-            std::vector<triangulation::point_t> vertices(this->delaunay.delaunay.number_of_vertices());
+            std::vector<candidate_edge> candidates(candidate_offsets.back());
 
-            for (auto cell_it = this->delaunay.get_finite_cells_begin(); cell_it != this->delaunay.get_finite_cells_end(); ++cell_it)
+            #pragma omp parallel for
+            for (long long source_index = 0; source_index < static_cast<long long>(sources.size()); ++source_index)
             {
-                for (int pi = 0; pi < 2; ++pi)
+                const auto point_i = sources[source_index];
+
+                if (this->refinement_marks[point_i] != not_marked)
                 {
-                    const auto point_i = static_cast<std::size_t>(cell_it->vertex(pi)->info());
+                    const auto& point = this->delaunay.get_vertex(point_i)->point();
+                    auto candidate_index = candidate_offsets[source_index];
 
-                    for (int pj = pi + 1; pj < 3; ++pj)
+                    for_each_marked_edge(point_i, [&](const triangulation::vertex_t& neighbor)
                     {
-                        const auto point_j = static_cast<std::size_t>(cell_it->vertex(pj)->info());
+                        const auto sub = neighbor->point() - point;
+                        const auto length_squared = sub.squared_length();
 
-                        if (marked_points.find(point_i) != marked_points.end() || marked_points.find(point_j) != marked_points.end())
+                        if (length_squared > refinement_threshold_squared)
                         {
-                            vertices[point_i] = cell_it->vertex(pi)->point();
-                            vertices[point_j] = cell_it->vertex(pj)->point();
+                            const auto point_j = neighbor->info();
+                            const auto mid_point = point + 0.5 * sub;
+
+                            auto& candidate = candidates[candidate_index++];
+
+                            candidate.point = point_i;
+                            candidate.label_difference = refine_at_labels ? static_cast<float>(
+                                (this->labels_forward[point_i] != this->labels_forward[point_j] ? 1 : 0) +
+                                (this->labels_backward[point_i] != this->labels_backward[point_j] ? 1 : 0)) : 0.0f;
+                            candidate.distance_difference = std::max(std::abs(this->distances_forward[point_i] - this->distances_forward[point_j]),
+                                std::abs(this->distances_backward[point_i] - this->distances_backward[point_j]));
+                            candidate.length_squared = static_cast<float>(CGAL::to_double(length_squared));
 
-                            const auto e = std::make_pair(std::min(point_i, point_j), std::max(point_i, point_j));
-                            edges.insert(e);
+                            candidate.mid_point[0] = static_cast<float>(CGAL::to_double(mid_point[0]));
+                            candidate.mid_point[1] = static_cast<float>(CGAL::to_double(mid_point[1]));
                         }
-                    }
+                    });
                 }
             }
 
-            this->log_output << "Marked edges:                          " << edges.size() << std::endl;
+            this->performance_num_candidate_edges = candidates.size();
 
-            const auto refinement_threshold_squared = refinement_threshold * refinement_threshold;
+            // ... select those of highest priority if the number of new points is limited, deferring the others, ...
+            if (max_points > 0 && candidates.size() > max_points)
+            {
+                std::nth_element(candidates.begin(), candidates.begin() + max_points, candidates.end(),
+                    [](const candidate_edge& lhs, const candidate_edge& rhs)
+                    {
+                        return std::tie(lhs.label_difference, lhs.distance_difference, lhs.length_squared) >
+                            std::tie(rhs.label_difference, rhs.distance_difference, rhs.length_squared);
+                    });
 
-            for (const auto& edge : edges)
+                for (auto candidate = candidates.begin() + max_points; candidate != candidates.end(); ++candidate)
+                {
+                    this->refinement_deferred.push_back(candidate->point);
+                }
+
+                std::sort(this->refinement_deferred.begin(), this->refinement_deferred.end());
+                this->refinement_deferred.erase(std::unique(this->refinement_deferred.begin(), this->refinement_deferred.end()), this->refinement_deferred.end());
+
+                candidates.resize(max_points);
+            }
+
+            this->log_output << "Candidate edges:                       " << this->performance_num_candidate_edges << std::endl;
+            this->log_output << "Deferred candidate edges:              " << (this->performance_num_candidate_edges - candidates.size()) << std::endl;
+
+            // ... order them along a space-filling curve, such that neighboring threads integrate stream lines in the
+            // same region and share cached velocities, ...
             {
-                const auto point_i = edge.first;
-                const auto point_j = edge.second;
+                std::vector<std::pair<std::uint32_t, std::size_t>> order(candidates.size());
 
-                const auto edge_point_0 = vertices[point_i];
-                const auto edge_point_1 = vertices[point_j];
+                for (std::size_t candidate_index = 0; candidate_index < candidates.size(); ++candidate_index)
+                {
+                    order[candidate_index] = std::make_pair(morton_code(candidates[candidate_index].mid_point[0],
+                        candidates[candidate_index].mid_point[1], this->domain), candidate_index);
+                }
+
+                std::sort(order.begin(), order.end());
 
-                const auto sub = edge_point_0 - edge_point_1;
-                const auto edge_length_squared = sub.squared_length();
+                std::vector<candidate_edge> sorted_candidates(candidates.size());
 
-                if (edge_length_squared > refinement_threshold_squared)
+                for (std::size_t candidate_index = 0; candidate_index < candidates.size(); ++candidate_index)
                 {
-                    const auto mid_point = edge_point_1 + 0.5 * sub;
+                    sorted_candidates[candidate_index] = candidates[order[candidate_index].second];
+                }
+
+                candidates.swap(sorted_candidates);
+            }
+
+            // ... and create new points at their midpoints. Edges whose halves do not exceed the threshold are resolved.
+            const auto resolution_threshold_squared = 4.0f * refinement_threshold_squared;
+
+            std::vector<float> new_points(2 * candidates.size());
+            this->performance_num_resolved_edges = 0;
 
-                    new_points.push_back(std::make_pair(mid_point, point_index++));
+            for (std::size_t candidate_index = 0; candidate_index < candidates.size(); ++candidate_index)
+            {
+                new_points[candidate_index * 2 + 0] = candidates[candidate_index].mid_point[0];
+                new_points[candidate_index * 2 + 1] = candidates[candidate_index].mid_point[1];
+
+                if (candidates[candidate_index].length_squared <= resolution_threshold_squared)
+                {
+                    ++this->performance_num_resolved_edges;
                 }
             }
 
-            if (new_points.size() != 0)
+            if (!new_points.empty())
             {
-                this->delaunay.delaunay.insert(new_points.begin(), new_points.end());
+                // Insert the new points on another thread, while their stream lines are integrated, also updating the
+                // neighbors and triangles needed afterwards by the next refinement and the result
+                this->pending_insertion = std::async(std::launch::async, [this, new_points]()
+                {
+                    const auto time_start = clock_t::now();
+
+                    this->delaunay.insert_points(new_points);
+                    this->delaunay.get_adjacency();
+                    this->delaunay.export_indices();
+
+                    return std::chrono::duration<double, std::milli>(clock_t::now() - time_start).count();
+                });
+
+                // Append new vertices to the mesh, and invalidate its topology
+                this->mesh_vertices.append(new_points);
+                this->mesh_indices = nullptr;
             }
 
-            this->log_output << "New points:                            " << new_points.size() << std::endl;
+            this->refinement_initialized = true;
+
+            this->log_output << "New points:                            " << (new_points.size() / 2) << std::endl;
             this->log_output << "Refinement finished!" << std::endl;
             this->log_output << std::endl;
 
-            // Return points in usable fashion
-            std::vector<float> new_points_gl;
-            new_points_gl.reserve(new_points.size());
+            return new_points;
+        }
+
+        std::vector<float> implicit_topology_computation::refine_quadtree(const float refinement_threshold,
+            const bool refine_at_labels, const float distance_difference_threshold, const unsigned int max_points)
+        {
+            this->log_output << "Refining quadtree..." << std::endl;
+
+            // Mark leaves larger than the threshold, where at least one boundary edge satisfies the refinement criteria,
+            // with their priority given as for the edges of the triangulation, and their lower left corner
+            struct candidate_leaf
+            {
+                std::size_t leaf;
+
+                float label_difference;
+                float distance_difference;
+                float size;
+
+                std::array<float, 2> corner;
+            };
+
+            const auto num_leaves = this->cells->get_number_of_leaves();
+
+            std::vector<candidate_leaf> leaves(num_leaves);
+            std::vector<std::uint8_t> marks(num_leaves, not_marked);
+
+            #pragma omp parallel
+            {
+                std::vector<std::size_t> boundary;
+                std::array<std::size_t, 4> corners;
+
+                #pragma omp for
+                for (long long leaf = 0; leaf < static_cast<long long>(num_leaves); ++leaf)
+                {
+                    const auto size = this->cells->get_size(static_cast<std::size_t>(leaf));
+
+                    if (size <= refinement_threshold)
+                    {
+                        continue;
+                    }
+
+                    this->cells->get_boundary(static_cast<std::size_t>(leaf), boundary, corners);
+
+                    auto& candidate = leaves[leaf];
+                    candidate.leaf = static_cast<std::size_t>(leaf);
+                    candidate.label_difference = 0.0f;
+                    candidate.distance_difference = 0.0f;
+                    candidate.size = size;
+
+                    auto mark = not_marked;
+
+                    for (std::size_t index = 0; index < boundary.size(); ++index)
+                    {
+                        const auto point_i = boundary[index];
+                        const auto point_j = boundary[(index + 1) % boundary.size()];
+
+                        const auto edge_mark = evaluate_edge(point_i, point_j, refine_at_labels, distance_difference_threshold);
+
+                        if (edge_mark != not_marked)
+                        {
+                            mark = (mark == not_marked || edge_mark == marked_by_label) ? edge_mark : mark;
+
+                            candidate.label_difference = std::max(candidate.label_difference, refine_at_labels ? static_cast<float>(
+                                (this->labels_forward[point_i] != this->labels_forward[point_j] ? 1 : 0) +
+                                (this->labels_backward[point_i] != this->labels_backward[point_j] ? 1 : 0)) : 0.0f);
+                            candidate.distance_difference = std::max(candidate.distance_difference,
+                                std::max(std::abs(this->distances_forward[point_i] - this->distances_forward[point_j]),
+                                    std::abs(this->distances_backward[point_i] - this->distances_backward[point_j])));
+                        }
+                    }
+
+                    candidate.corner[0] = this->mesh_vertices[boundary[0] * 2 + 0];
+                    candidate.corner[1] = this->mesh_vertices[boundary[0] * 2 + 1];
+
+                    marks[leaf] = mark;
+                }
+            }
+
+            std::vector<candidate_leaf> candidates;
+            std::size_t num_leaves_by_label = 0;
+
+            for (std::size_t leaf = 0; leaf < num_leaves; ++leaf)
+            {
+                if (marks[leaf] != not_marked)
+                {
+                    candidates.push_back(leaves[leaf]);
+                    num_leaves_by_label += marks[leaf] == marked_by_label ? 1 : 0;
+                }
+            }
+
+            this->performance_num_candidate_edges = candidates.size();
+
+            this->log_output << "Marked leaves:                         " << candidates.size() << std::endl;
+            this->log_output << "Marked leaves by label:                " << num_leaves_by_label << std::endl;
+            this->log_output << "Marked leaves by distance difference:  " << (candidates.size() - num_leaves_by_label) << std::endl;
+
+            // Select those of highest priority if the number of new points is limited, each subdivision creating up to
+            // five points; the others are found again by the next refinement, ...
+            const std::size_t max_leaves = max_points > 0 ? std::max(max_points / 5u, 1u) : candidates.size();
+
+            if (candidates.size() > max_leaves)
+            {
+                std::nth_element(candidates.begin(), candidates.begin() + max_leaves, candidates.end(),
+                    [](const candidate_leaf& lhs, const candidate_leaf& rhs)
+                    {
+                        return std::tie(lhs.label_difference, lhs.distance_difference, lhs.size) >
+                            std::tie(rhs.label_difference, rhs.distance_difference, rhs.size);
+                    });
+
+                candidates.resize(max_leaves);
+            }
+
+            this->log_output << "Deferred leaves:                       " << (this->performance_num_candidate_edges - candidates.size()) << std::endl;
 
-            std::for_each(new_points.begin(), new_points.end(),
-                [&new_points_gl](const std::pair<triangulation::point_t, std::size_t>& value)
+            // ... order them along a space-filling curve, as the new points are created in this order, ...
+            std::vector<std::pair<std::uint32_t, std::size_t>> order(candidates.size());
+
+            for (std::size_t candidate_index = 0; candidate_index < candidates.size(); ++candidate_index)
+            {
+                order[candidate_index] = std::make_pair(morton_code(candidates[candidate_index].corner[0],
+                    candidates[candidate_index].corner[1], this->domain), candidates[candidate_index].leaf);
+            }
+
+            std::sort(order.begin(), order.end());
+
+            // ... and subdivide them. Leaves whose children do not exceed the threshold are resolved.
+            std::vector<std::size_t> subdivided_leaves(order.size());
+            this->performance_num_resolved_edges = 0;
+
+            for (std::size_t candidate_index = 0; candidate_index < candidates.size(); ++candidate_index)
             {
-                new_points_gl.push_back(static_cast<float>(CGAL::to_double(value.first[0])));
-                new_points_gl.push_back(static_cast<float>(CGAL::to_double(value.first[1])));
-            });
+                subdivided_leaves[candidate_index] = order[candidate_index].second;
 
-            return new_points_gl;
+                if (candidates[candidate_index].size <= 2.0f * refinement_threshold)
+                {
+                    ++this->performance_num_resolved_edges;
+                }
+            }
+
+            std::vector<float> new_points;
+
+            {
+                implicit_topology_telemetry::scoped_timer timer(this->telemetry, "quadtree_subdivision");
+
+                new_points = this->cells->subdivide(subdivided_leaves);
+            }
+
+            if (!new_points.empty())
+            {
+                // Append new vertices to the mesh, and invalidate its topology
+                this->mesh_vertices.append(new_points);
+                this->mesh_indices = nullptr;
+            }
+
+            this->refinement_initialized = true;
+
+            this->log_output << "New points:                            " << (new_points.size() / 2) << std::endl;
+            this->log_output << "Refinement finished!" << std::endl;
+            this->log_output << std::endl;
+
+            return new_points;
+        }
+
+        void implicit_topology_computation::finish_insertion()
+        {
+            if (this->pending_insertion.valid())
+            {
+                const auto time_insertion = this->pending_insertion.get();
+
+                // Telemetry is recorded on this thread only, thus with the next record
+                this->telemetry.add_time("delaunay_insert", time_insertion);
+            }
+        }
+
+        implicit_topology_computation::refinement_mark_t implicit_topology_computation::evaluate_edge(const std::size_t point_i,
+            const std::size_t point_j, const bool refine_at_labels, const float distance_difference_threshold) const
+        {
+            // Converged stream lines terminated early, but are labelled like those still running
+            auto is_refinable = [](const float termination) { return termination == 0.0f || termination == 5.0f; };
+
+            if (is_refinable(this->terminations_forward[point_i]) || is_refinable(this->terminations_backward[point_i]) ||
+                is_refinable(this->terminations_forward[point_j]) || is_refinable(this->terminations_backward[point_j]))
+            {
+                if (refine_at_labels && (this->labels_forward[point_i] != this->labels_forward[point_j] ||
+                    this->labels_backward[point_i] != this->labels_backward[point_j]))
+                {
+                    return marked_by_label;
+                }
+                else if (std::abs(this->distances_forward[point_i] - this->distances_forward[point_j]) > distance_difference_threshold
+                    || std::abs(this->distances_backward[point_i] - this->distances_backward[point_j]) > distance_difference_threshold)
+                {
+                    return marked_by_distance;
+                }
+            }
+
+            return not_marked;
         }
 
         void implicit_topology_computation::print_performance(const unsigned int num_integration_steps) const
@@ -670,14 +1495,28 @@ namespace megamol
             this->performance_output << "Number of integration steps;";
             this->performance_output << "Stream line integrations " << duration_str << ";";
             this->performance_output << "Grid refinements " << duration_str << ";";
-            this->performance_output << "Total " << duration_str << std::endl;
+            this->performance_output << "Total " << duration_str << ";";
+            this->performance_output << "Resolved boundary edges;";
+            this->performance_output << "Cost per resolved boundary " << duration_str << std::endl;
 
             this->performance_output << this->performance_num_particles_added << ";";
             this->performance_output << num_integration_steps << ";";
             this->performance_output << this->total_time_integration.count() << ";";
             this->performance_output << this->total_time_refinement.count() << ";";
-            this->performance_output << this->total_time.count() << std::endl;
-            this->performance_output << "-;-;-;-;" << this->total_runtime.count() << std::endl;
+            this->performance_output << this->total_time.count() << ";";
+            this->performance_output << this->performance_total_num_resolved_edges << ";";
+
+            if (this->performance_total_num_resolved_edges > 0)
+            {
+                this->performance_output << static_cast<double>((this->total_time_refined_integration + this->total_time_refinement).count())
+                    / this->performance_total_num_resolved_edges << std::endl;
+            }
+            else
+            {
+                this->performance_output << "-" << std::endl;
+            }
+
+            this->performance_output << "-;-;-;-;" << this->total_runtime.count() << ";-;-" << std::endl;
         }
 
         const char* implicit_topology_computation::duration_str = "[ms]";
@@ -6,13 +6,18 @@
  */
 #pragma once
 
+#include "chunked_array.h"
 #include "implicit_topology_results.h"
+#include "implicit_topology_telemetry.h"
+#include "quadtree.h"
 #include "triangulation.h"
 
 #include "../cuda/streamlines.h"
 
 #include <array>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
@@ -23,6 +28,8 @@ namespace megamol
 {
     namespace flowvis
     {
+        class streamlines_cpu;
+
         /**
         * Class for computing the implicit topology of a vector field.
         * This computation is performed concurrently, while allowing access to
@@ -34,6 +41,28 @@ namespace megamol
         class implicit_topology_computation
         {
         public:
+            /**
+            * Backends for stream line computation
+            */
+            enum class computation_backend
+            {
+                AUTOMATIC,
+                CUDA,
+                CPU
+            };
+
+            /**
+            * Stream line backends, holding the uploaded vector field and convergence structures.
+            * Subsequent computations on the same input can share them, only updating the integration parameters.
+            */
+            struct streamline_backends
+            {
+                std::unique_ptr<streamlines_cuda> gpu;
+                std::unique_ptr<streamlines_cpu> cpu;
+
+                ~streamline_backends();
+            };
+
             /**
             * Initialize computation by providing seed positions and corresponding vectors, convergence structures,
             * and the initial delaunay triangulation of the domain.
@@ -93,11 +122,17 @@ namespace megamol
             * @param refinement_threshold               Threshold for refinement to prevent from refining infinitly
             * @param refine_at_labels                   Refine where different labels meet?
             * @param distance_difference_threshold      Refine when distance difference between neighboring nodes exceed the threshold
+            * @param incremental_refinement             Only revisit the neighborhood of the points inserted by the previous refinement
+            * @param max_points_per_refinement          Maximum number of points inserted per refinement, prioritized by refinement criteria; 0 for no limit
             * @param num_particles_per_batch            Number of particles processed and uploaded to the GPU per batch
             * @param num_integration_steps_per_batch    Number of integration steps per batch, after which a new (intermediate) result can be extracted
+            * @param backend                            Backend for stream line computation; automatic selection uses the CPU if there is no CUDA device
+            * @param integration_precision              Floating point precision of the integration; only supported by the CUDA backend
             */
             void start(unsigned int num_integration_steps, float refinement_threshold, bool refine_at_labels,
-                float distance_difference_threshold, unsigned int num_particles_per_batch, unsigned int num_integration_steps_per_batch);
+                float distance_difference_threshold, bool incremental_refinement, unsigned int max_points_per_refinement,
+                unsigned int num_particles_per_batch, unsigned int num_integration_steps_per_batch, computation_backend backend,
+                streamlines_cuda::precision integration_precision = streamlines_cuda::precision::SINGLE);
 
             /**
             * Terminate current computation as soon as possible.
@@ -111,7 +146,77 @@ namespace megamol
             */
             std::shared_future<implicit_topology_results> get_results() const;
 
+            /**
+            * Get the stream line backends, which are created when first needed by a computation.
+            *
+            * @return Stream line backends
+            */
+            std::shared_ptr<streamline_backends> get_backends() const;
+
+            /**
+            * Use the stream line backends of another computation on the same input, instead of creating new ones.
+            * Computations sharing their backends must not run at the same time.
+            *
+            * @param backends                           Stream line backends of the other computation
+            */
+            void set_backends(std::shared_ptr<streamline_backends> backends);
+
+            /**
+            * Enable telemetry, writing per-phase timings and counters as JSON lines. Must be set before starting the computation.
+            *
+            * @param telemetry_stream                   Stream in which to write the telemetry records
+            * @param clock                              Clock for the time stamps of the records, in seconds
+            */
+            void set_telemetry_output(std::ostream& telemetry_stream, std::function<double()> clock);
+
+            /**
+            * Terminate stream lines early once they converged, such that their label cannot change anymore.
+            * Converged seeds are terminated with reason 5, and are still considered for refinement.
+            * Must be set before starting the computation; disabled by default.
+            *
+            * @param distance                           Terminate if the distance to the labelled structure falls below this distance; 0 to disable
+            * @param num_steps                          Terminate if the label did not change for this number of steps, while the stream line
+            *                                           stayed within the radius; 0 to disable
+            * @param radius                             Radius for the number of steps
+            */
+            void set_convergence_criteria(float distance, unsigned int num_steps, float radius);
+
+            /**
+            * Refine by subdividing the cells of the initial grid in a quadtree, instead of inserting points into a
+            * Delaunay triangulation. Cells are subdivided where the refinement criteria are satisfied on their boundary,
+            * and their triangulation is only created for the output mesh. Must be set before starting the computation
+            * for the first time, and is not available for computations initialized from previous results.
+            */
+            void set_quadtree_refinement();
+
+            /**
+            * Set the storage format of the vector field on the GPU, where half precision halves the memory footprint
+            * and texture bandwidth at the cost of accuracy. Must be set before starting the computation for the first
+            * time; only supported by the CUDA backend.
+            *
+            * @param storage                            Storage format of the vector field
+            */
+            void set_vector_storage(streamlines_cuda::vector_storage storage);
+
+            /**
+            * Invalidate the results of all seeds within the given rectangle, keeping the triangulation and all other results.
+            * These seeds are integrated again from their original positions when the computation is started next,
+            * followed by the usual refinement. Must not be called while the computation is running.
+            *
+            * @param region                             Rectangle (minimum x, minimum y, maximum x, maximum y)
+            *
+            * @return Number of invalidated seeds
+            */
+            std::size_t invalidate_region(const std::array<float, 4>& region);
+
         private:
+            /** Marks of points and edges satisfying the refinement criteria */
+            enum refinement_mark_t : std::uint8_t { not_marked = 0, marked_by_label = 1, marked_by_distance = 2 };
+
+            /** Function for integrating stream lines forward and backward, provided by the selected backend */
+            using update_labels_t = std::function<void(std::vector<float>&, std::vector<float>&, std::vector<float>&, std::vector<float>&,
+                std::vector<float>&, std::vector<float>&, std::vector<float>&, std::vector<float>&, int, bool, unsigned int)>;
+
             /**
             * Main algorithm.
             *
@@ -120,12 +225,17 @@ namespace megamol
             * @param refinement_threshold               Threshold for refinement to prevent from refining infinitly
             * @param refine_at_labels                   Refine where different labels meet?
             * @param distance_difference_threshold      Refine when distance difference between neighboring nodes exceed the threshold
+            * @param incremental_refinement             Only revisit the neighborhood of the points inserted by the previous refinement
+            * @param max_points_per_refinement          Maximum number of points inserted per refinement, prioritized by refinement criteria; 0 for no limit
             * @param num_particles_per_batch            Number of particles processed and uploaded to the GPU per batch
             * @param num_integration_steps_per_batch    Number of integration steps per batch, after which a new (intermediate) result can be extracted
+            * @param backend                            Backend for stream line computation
+            * @param integration_precision              Floating point precision of the integration
             */
             void run(std::promise<implicit_topology_results>&& promise, unsigned int num_integration_steps, float refinement_threshold,
-                bool refine_at_labels, float distance_difference_threshold, unsigned int num_particles_per_batch,
-                unsigned int num_integration_steps_per_batch);
+                bool refine_at_labels, float distance_difference_threshold, bool incremental_refinement, unsigned int max_points_per_refinement,
+                unsigned int num_particles_per_batch, unsigned int num_integration_steps_per_batch, computation_backend backend,
+                streamlines_cuda::precision integration_precision);
 
             /**
             * Set current results.
@@ -135,16 +245,67 @@ namespace megamol
             */
             void set_result(std::promise<implicit_topology_results>& promise, bool finished);
 
+            /**
+            * Integrate the seeds invalidated by invalidate_region again, for the number of integration steps
+            * already performed for all other seeds, and store their results.
+            *
+            * @param update_labels_bidirectional        Function for integrating stream lines
+            * @param num_particles_per_batch            Number of particles processed and uploaded to the GPU per batch
+            * @param num_integration_steps_per_batch    Number of integration steps per batch
+            */
+            void integrate_invalidated_seeds(const update_labels_t& update_labels_bidirectional,
+                unsigned int num_particles_per_batch, unsigned int num_integration_steps_per_batch);
+
             /**
             * Refine the grid around nodes and edges which satisfy the refinement criteria defined by the parameters.
+            * If the number of points is limited, the candidate edges with the highest priority are refined first,
+            * i.e., edges between different labels, followed by edges with large distance differences.
+            * The remaining candidates are deferred to the next refinement.
             *
             * @param refinement_threshold               Threshold for refinement to prevent from refining infinitly
             * @param refine_at_labels                   Refine where different labels meet?
             * @param distance_difference_threshold      Refine when distance difference between neighboring nodes exceed the threshold
+            * @param incremental                        Only revisit the neighborhood of the points inserted by the previous refinement
+            * @param max_points                         Maximum number of points to insert; 0 for no limit
             *
             * @return Newly created seed points
             */
-            std::vector<float> refine_grid(float refinement_threshold, bool refine_at_labels, float distance_difference_threshold);
+            std::vector<float> refine_grid(float refinement_threshold, bool refine_at_labels, float distance_difference_threshold,
+                bool incremental, unsigned int max_points);
+
+            /**
+            * Refine the quadtree by subdividing leaves larger than the threshold, where neighboring points on their
+            * boundary satisfy the refinement criteria. All leaves are evaluated in each refinement. If the number of
+            * points is limited, the leaves with the highest priority are subdivided first, as for refine_grid.
+            *
+            * @param refinement_threshold               Threshold for refinement to prevent from refining infinitly
+            * @param refine_at_labels                   Refine where different labels meet?
+            * @param distance_difference_threshold      Refine when distance difference between neighboring nodes exceed the threshold
+            * @param max_points                         Maximum number of points to insert; 0 for no limit
+            *
+            * @return Newly created seed points
+            */
+            std::vector<float> refine_quadtree(float refinement_threshold, bool refine_at_labels, float distance_difference_threshold,
+                unsigned int max_points);
+
+            /**
+            * Wait for the insertion of the points of the last refinement into the triangulation, if still pending.
+            * Must be called before accessing the triangulation.
+            */
+            void finish_insertion();
+
+            /**
+            * Evaluate the refinement criteria for an edge
+            *
+            * @param point_i                            Index of the first point
+            * @param point_j                            Index of the second point
+            * @param refine_at_labels                   Refine where different labels meet?
+            * @param distance_difference_threshold      Refine when distance difference between neighboring nodes exceed the threshold
+            *
+            * @return Mark of the edge
+            */
+            refinement_mark_t evaluate_edge(std::size_t point_i, std::size_t point_j, bool refine_at_labels,
+                float distance_difference_threshold) const;
 
             /**
             * Output the performance measured
@@ -175,35 +336,80 @@ namespace megamol
             /** Integration method */
             streamlines_cuda::integration_method method;
 
+            /** Stream line backends, possibly shared with other computations */
+            std::shared_ptr<streamline_backends> backends;
+
             /** Output positions */
-            std::vector<float> positions_forward;
-            std::vector<float> positions_backward;
+            chunked_array<float> positions_forward;
+            chunked_array<float> positions_backward;
 
             /** Output labels, distances, and reasons for termination for forward, and backward integration */
-            std::vector<float> labels_forward;
-            std::vector<float> distances_forward;
-            std::vector<float> terminations_forward;
+            chunked_array<float> labels_forward;
+            chunked_array<float> distances_forward;
+            chunked_array<float> terminations_forward;
 
-            std::vector<float> labels_backward;
-            std::vector<float> distances_backward;
-            std::vector<float> terminations_backward;
+            chunked_array<float> labels_backward;
+            chunked_array<float> distances_backward;
+            chunked_array<float> terminations_backward;
 
             /** Number of integration steps performed */
             unsigned int num_integration_steps_performed;
 
+            /** Version of the next result */
+            unsigned int result_version;
+
             /** Delaunay triangulation for computing a triangle mesh for refinement */
             triangulation delaunay;
 
+            /** Quadtree replacing the Delaunay triangulation for refinement, if selected */
+            std::unique_ptr<quadtree> cells;
+
+            /**
+            * Pending insertion of new points into the triangulation, overlapping with the integration of their stream lines,
+            * which returns its duration in milliseconds
+            */
+            std::future<double> pending_insertion;
+
+            /** Triangle mesh vertices, and indices which are reset for re-export when the triangulation changes */
+            chunked_array<float> mesh_vertices;
+            std::shared_ptr<std::vector<unsigned int>> mesh_indices;
+
             /** Computation thread */
             std::thread computation;
             bool terminate_computation;
 
+            /** Refinement state: marks per point, and the refinement round in which the marks were last evaluated */
+            bool refinement_initialized;
+            std::uint32_t refinement_round;
+
+            std::vector<std::uint8_t> refinement_marks;
+            std::vector<std::uint32_t> refinement_stamps;
+
+            /** Points with candidate edges that were deferred due to the limit of points per refinement */
+            std::vector<std::size_t> refinement_deferred;
+
+            /** Criteria for terminating converged stream lines */
+            float convergence_distance;
+            unsigned int convergence_steps;
+            float convergence_radius;
+
+            /** Storage format of the vector field on the GPU */
+            streamlines_cuda::vector_storage vector_storage;
+
+            /** Seeds whose results were invalidated, and which have to be integrated again */
+            std::vector<std::size_t> invalidated_seeds;
+
             /** Current results */
             std::shared_future<implicit_topology_results> current_result;
 
             /** Performance */
             std::size_t performance_num_particles_added;
 
+            /** Candidate edges and resolved boundary edges, i.e., edges refined below the threshold, of the last refinement */
+            std::size_t performance_num_candidate_edges;
+            std::size_t performance_num_resolved_edges;
+            std::size_t performance_total_num_resolved_edges;
+
             using clock_t = std::chrono::high_resolution_clock;
             using duration_t = std::chrono::milliseconds;
             static const char* duration_str;
@@ -212,10 +418,14 @@ namespace megamol
             duration_t total_time;
             duration_t total_time_integration;
             duration_t total_time_refinement;
+            duration_t total_time_refined_integration;
 
             /** Performance output */
             std::ostream& log_output;
             std::ostream& performance_output;
+
+            /** Structured telemetry */
+            implicit_topology_telemetry telemetry;
         };
     }
 }
@@ -0,0 +1,208 @@
+/*
+ * implicit_topology_file_format.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Chunked file format for results from implicit topology computation.
+        *
+        * The file starts with the header, followed by the array table and a chunk table per array.
+        * The chunk tables store offset and size of every chunk, such that chunks can be accessed
+        * directly in a memory-mapped file, and optionally compressed independently of each other.
+        * Files without the magic number are stored in the previous, unchunked format.
+        *
+        * Since version 3, labels and reasons for termination may be stored as 16 bit and 8 bit integers,
+        * and distances as half precision floats, indicated by the element size of the respective array.
+        *
+        * @author Alexander Straub
+        */
+        namespace implicit_topology_file_format
+        {
+            /** Magic number and current version */
+            constexpr char magic[8] = { 'M', 'M', 'I', 'M', 'P', 'T', 'O', 'P' };
+            constexpr uint32_t version = 3;
+
+            /** Arrays stored in the file, in this order */
+            enum class array_id : uint32_t
+            {
+                VERTICES,
+                INDICES,
+                POSITIONS_FORWARD,
+                POSITIONS_BACKWARD,
+                LABELS_FORWARD,
+                LABELS_BACKWARD,
+                DISTANCES_FORWARD,
+                DISTANCES_BACKWARD,
+                TERMINATIONS_FORWARD,
+                TERMINATIONS_BACKWARD,
+
+                NUM_ARRAYS
+            };
+
+            /** Compression of a single chunk */
+            enum class chunk_compression : uint32_t
+            {
+                UNCOMPRESSED,
+                ZLIB
+            };
+
+            /** File header */
+            struct header
+            {
+                char magic[8];
+                uint32_t version;
+                uint32_t num_arrays;
+
+                uint64_t num_particles;
+                uint64_t num_indices;
+
+                uint32_t method;
+                uint32_t num_integration_steps;
+                float integration_timestep;
+                float max_integration_error;
+            };
+
+            /** Entry of the array table */
+            struct array_entry
+            {
+                uint32_t id;
+                uint32_t element_size;
+
+                uint64_t num_elements;
+                uint64_t num_chunks;
+
+                /** Offset of the chunk table, from the beginning of the file */
+                uint64_t chunk_table_offset;
+            };
+
+            /** Entry of a chunk table */
+            struct chunk_entry
+            {
+                /** Offset of the chunk data, from the beginning of the file */
+                uint64_t offset;
+
+                /** Size of the stored, possibly compressed, data in bytes */
+                uint64_t stored_size;
+
+                uint64_t num_elements;
+
+                uint32_t compression;
+                uint32_t reserved;
+            };
+
+            /**
+            * Convert to half precision, rounding to nearest even
+            *
+            * @param value Single precision value
+            *
+            * @return Bits of the half precision value
+            */
+            inline uint16_t float_to_half(const float value)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(float));
+
+                const uint32_t sign = (bits >> 16) & 0x8000u;
+                const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xffu) - 127 + 15;
+                uint32_t mantissa = bits & 0x7fffffu;
+
+                // Infinity and NaN, and overflow to infinity
+                if (exponent == 0xff - 127 + 15)
+                {
+                    return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+                }
+
+                if (exponent >= 0x1f)
+                {
+                    return static_cast<uint16_t>(sign | 0x7c00u);
+                }
+
+                // Subnormal numbers, and underflow to zero
+                if (exponent <= 0)
+                {
+                    if (exponent < -10)
+                    {
+                        return static_cast<uint16_t>(sign);
+                    }
+
+                    mantissa |= 0x800000u;
+
+                    const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+                    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+                    const uint32_t halfway = 1u << (shift - 1);
+
+                    uint32_t half = mantissa >> shift;
+
+                    if (remainder > halfway || (remainder == halfway && (half & 1u) != 0))
+                    {
+                        ++half;
+                    }
+
+                    return static_cast<uint16_t>(sign | half);
+                }
+
+                // Normal numbers, where rounding may carry over into the exponent
+                uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+                const uint32_t remainder = mantissa & 0x1fffu;
+
+                if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0))
+                {
+                    ++half;
+                }
+
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            /**
+            * Convert from half precision
+            *
+            * @param half Bits of the half precision value
+            *
+            * @return Single precision value
+            */
+            inline float half_to_float(const uint16_t half)
+            {
+                const uint32_t sign = (static_cast<uint32_t>(half) & 0x8000u) << 16;
+                const uint32_t exponent = (half >> 10) & 0x1fu;
+                const uint32_t mantissa = half & 0x3ffu;
+
+                uint32_t bits = sign;
+
+                if (exponent == 0x1f)
+                {
+                    bits |= 0x7f800000u | (mantissa << 13);
+                }
+                else if (exponent != 0)
+                {
+                    bits |= ((exponent + 127 - 15) << 23) | (mantissa << 13);
+                }
+                else if (mantissa != 0)
+                {
+                    const float value = std::ldexp(static_cast<float>(mantissa), -24);
+
+                    return sign != 0 ? -value : value;
+                }
+
+                float value;
+                std::memcpy(&value, &bits, sizeof(float));
+
+                return value;
+            }
+
+            static_assert(sizeof(header) == 48, "Unexpected padding in file header");
+            static_assert(sizeof(array_entry) == 32, "Unexpected padding in array table");
+            static_assert(sizeof(chunk_entry) == 32, "Unexpected padding in chunk table");
+        }
+    }
+}
@@ -1,13 +1,24 @@
 #include "stdafx.h"
 
+#include "implicit_topology_file_format.h"
 #include "implicit_topology_results.h"
 #include "implicit_topology_reader.h"
+#include "mapped_file.h"
 
 #include "vislib/sys/Log.h"
 
+#include "zlib.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace megamol
 {
@@ -33,72 +44,286 @@ namespace megamol
 
         bool implicit_topology_reader::read(const std::string& filename, implicit_topology_results& content)
         {
-            // Open output file
+            namespace format = implicit_topology_file_format;
+
             try
             {
-                std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+                // Map file into memory, and fall back to the previous format if the magic number is missing
+                const mapped_file file(filename);
 
-                if (!ifs.good())
+                if (file.size() < sizeof(format::header) || std::memcmp(file.data(), format::magic, sizeof(format::magic)) != 0)
                 {
-                    vislib::sys::Log::DefaultLog.WriteWarn("Unable to open implicit topology results file '%s'!", filename.c_str());
-                    return false;
+                    return read_legacy(filename, content);
                 }
 
-                // Gather information for the file header and write it
-                unsigned int num_particles, num_indices;
-
-                ifs.read(reinterpret_cast<char*>(&num_particles), sizeof(unsigned int));
-                ifs.read(reinterpret_cast<char*>(&num_indices), sizeof(unsigned int));
-                ifs.read(reinterpret_cast<char*>(&content.computation_state.num_integration_steps), sizeof(unsigned int));
-                ifs.read(reinterpret_cast<char*>(&content.computation_state.integration_timestep), sizeof(float));
-                ifs.read(reinterpret_cast<char*>(&content.computation_state.max_integration_error), sizeof(float));
+                read_chunked(file, content);
+            }
+            catch (const std::exception& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Unable to read implicit topology results file '%s': %s", filename.c_str(), e.what());
 
-                // Read vertices and indices
-                content.vertices = std::make_shared<std::vector<float>>(2 * num_particles);
-                content.indices = std::make_shared<std::vector<unsigned int>>(num_indices);
+                return false;
+            }
 
-                ifs.read(reinterpret_cast<char*>(content.vertices->data()), content.vertices->size() * sizeof(float));
-                ifs.read(reinterpret_cast<char*>(content.indices->data()), content.indices->size() * sizeof(unsigned int));
+            return true;
+        }
 
-                // Read stream line end positions
-                content.positions_forward = std::make_shared<std::vector<float>>(2 * num_particles);
-                content.positions_backward = std::make_shared<std::vector<float>>(2 * num_particles);
+        void implicit_topology_reader::read_chunked(const mapped_file& file, implicit_topology_results& content) const
+        {
+            namespace format = implicit_topology_file_format;
 
-                ifs.read(reinterpret_cast<char*>(content.positions_forward->data()), content.positions_forward->size() * sizeof(float));
-                ifs.read(reinterpret_cast<char*>(content.positions_backward->data()), content.positions_backward->size() * sizeof(float));
+            auto check_range = [&file](const uint64_t offset, const uint64_t size)
+            {
+                if (offset > file.size() || size > file.size() - offset)
+                {
+                    throw std::runtime_error("File is truncated or corrupt");
+                }
+            };
 
-                // Read labels
-                content.labels_forward = std::make_shared<std::vector<float>>(num_particles);
-                content.labels_backward = std::make_shared<std::vector<float>>(num_particles);
+            // Read header
+            format::header header;
+            std::memcpy(&header, file.data(), sizeof(format::header));
 
-                ifs.read(reinterpret_cast<char*>(content.labels_forward->data()), content.labels_forward->size() * sizeof(float));
-                ifs.read(reinterpret_cast<char*>(content.labels_backward->data()), content.labels_backward->size() * sizeof(float));
+            if (header.version > format::version)
+            {
+                throw std::runtime_error("Unsupported file version " + std::to_string(header.version));
+            }
 
-                // Read distances
-                content.distances_forward = std::make_shared<std::vector<float>>(num_particles);
-                content.distances_backward = std::make_shared<std::vector<float>>(num_particles);
+            content.computation_state.method = static_cast<streamlines_cuda::integration_method>(header.method);
+            content.computation_state.num_integration_steps = header.num_integration_steps;
+            content.computation_state.integration_timestep = header.integration_timestep;
+            content.computation_state.max_integration_error = header.max_integration_error;
 
-                ifs.read(reinterpret_cast<char*>(content.distances_forward->data()), content.distances_forward->size() * sizeof(float));
-                ifs.read(reinterpret_cast<char*>(content.distances_backward->data()), content.distances_backward->size() * sizeof(float));
+            // Read array table, ignoring unknown arrays
+            check_range(sizeof(format::header), header.num_arrays * sizeof(format::array_entry));
 
-                // Read reason of termination
-                content.terminations_forward = std::make_shared<std::vector<float>>(num_particles);
-                content.terminations_backward = std::make_shared<std::vector<float>>(num_particles);
+            std::array<format::array_entry, static_cast<std::size_t>(format::array_id::NUM_ARRAYS)> arrays;
+            std::array<bool, static_cast<std::size_t>(format::array_id::NUM_ARRAYS)> available;
+            available.fill(false);
 
-                ifs.read(reinterpret_cast<char*>(content.terminations_forward->data()), content.terminations_forward->size() * sizeof(float));
-                ifs.read(reinterpret_cast<char*>(content.terminations_backward->data()), content.terminations_backward->size() * sizeof(float));
+            for (uint32_t i = 0; i < header.num_arrays; ++i)
+            {
+                format::array_entry entry;
+                std::memcpy(&entry, file.data() + sizeof(format::header) + i * sizeof(format::array_entry), sizeof(format::array_entry));
 
-                // Finish reading
-                ifs.close();
+                if (entry.id < arrays.size())
+                {
+                    arrays[entry.id] = entry;
+                    available[entry.id] = true;
+                }
             }
-            catch (const std::exception& e)
+
+            // Decode chunks directly from mapped memory, only decompressing where necessary
+            std::vector<char> buffer;
+
+            auto read_array = [&](const format::array_id id, const uint64_t num_elements, const uint32_t element_size,
+                const std::function<void(const char*, std::size_t)>& append)
             {
-                vislib::sys::Log::DefaultLog.WriteError("Unable to read implicit topology results file '%s': %s", filename.c_str(), e.what());
+                const auto& entry = arrays[static_cast<std::size_t>(id)];
+
+                if (!available[static_cast<std::size_t>(id)] || entry.num_elements != num_elements || entry.element_size != element_size)
+                {
+                    throw std::runtime_error("Array " + std::to_string(static_cast<uint32_t>(id)) + " is missing or of unexpected size");
+                }
+
+                check_range(entry.chunk_table_offset, entry.num_chunks * sizeof(format::chunk_entry));
+
+                uint64_t num_read = 0;
+
+                for (uint64_t i = 0; i < entry.num_chunks; ++i)
+                {
+                    format::chunk_entry chunk;
+                    std::memcpy(&chunk, file.data() + entry.chunk_table_offset + i * sizeof(format::chunk_entry), sizeof(format::chunk_entry));
+
+                    check_range(chunk.offset, chunk.stored_size);
+
+                    const char* data = file.data() + chunk.offset;
+                    const uint64_t size = chunk.num_elements * element_size;
+
+                    if (chunk.compression == static_cast<uint32_t>(format::chunk_compression::ZLIB))
+                    {
+                        buffer.resize(static_cast<std::size_t>(size));
+                        uLongf decompressed_size = static_cast<uLongf>(size);
+
+                        if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &decompressed_size,
+                            reinterpret_cast<const Bytef*>(data), static_cast<uLong>(chunk.stored_size)) != Z_OK || decompressed_size != size)
+                        {
+                            throw std::runtime_error("Unable to decompress chunk of array " + std::to_string(static_cast<uint32_t>(id)));
+                        }
+
+                        data = buffer.data();
+                    }
+                    else if (chunk.compression == static_cast<uint32_t>(format::chunk_compression::UNCOMPRESSED))
+                    {
+                        if (chunk.stored_size != size)
+                        {
+                            throw std::runtime_error("File is truncated or corrupt");
+                        }
+
+                        if (reinterpret_cast<std::uintptr_t>(data) % element_size != 0)
+                        {
+                            buffer.assign(data, data + size);
+                            data = buffer.data();
+                        }
+                    }
+                    else
+                    {
+                        throw std::runtime_error("Unsupported chunk compression " + std::to_string(chunk.compression));
+                    }
+
+                    append(data, static_cast<std::size_t>(chunk.num_elements));
+                    num_read += chunk.num_elements;
+                }
+
+                if (num_read != num_elements)
+                {
+                    throw std::runtime_error("File is truncated or corrupt");
+                }
+            };
+
+            auto read_float_array = [&read_array](const format::array_id id, const uint64_t num_elements, chunked_array<float>& data)
+            {
+                data.resize(0);
 
+                read_array(id, num_elements, sizeof(float), [&data](const char* chunk, const std::size_t num)
+                    { data.append(reinterpret_cast<const float*>(chunk), num); });
+            };
+
+            // Arrays may be stored compactly, identified by their element size, and are converted to floats
+            std::vector<float> converted;
+
+            auto read_compact_array = [&](const format::array_id id, const uint64_t num_elements, chunked_array<float>& data,
+                const uint32_t compact_element_size, const std::function<float(const char*)>& convert)
+            {
+                if (arrays[static_cast<std::size_t>(id)].element_size != compact_element_size)
+                {
+                    read_float_array(id, num_elements, data);
+                    return;
+                }
+
+                data.resize(0);
+
+                read_array(id, num_elements, compact_element_size, [&](const char* chunk, const std::size_t num)
+                {
+                    converted.resize(num);
+
+                    for (std::size_t i = 0; i < num; ++i)
+                    {
+                        converted[i] = convert(chunk + i * compact_element_size);
+                    }
+
+                    data.append(converted.data(), num);
+                });
+            };
+
+            auto convert_int16 = [](const char* value)
+            {
+                int16_t integer;
+                std::memcpy(&integer, value, sizeof(int16_t));
+                return static_cast<float>(integer);
+            };
+
+            auto convert_int8 = [](const char* value)
+            {
+                int8_t integer;
+                std::memcpy(&integer, value, sizeof(int8_t));
+                return static_cast<float>(integer);
+            };
+
+            // Distances of seeds which did not reach a structure are the largest float, stored as infinity
+            auto convert_half = [](const char* value)
+            {
+                uint16_t half;
+                std::memcpy(&half, value, sizeof(uint16_t));
+
+                const auto distance = format::half_to_float(half);
+                return distance == std::numeric_limits<float>::infinity() ? std::numeric_limits<float>::max() : distance;
+            };
+
+            // Read vertices and indices
+            read_float_array(format::array_id::VERTICES, 2 * header.num_particles, content.vertices);
+
+            content.indices = std::make_shared<std::vector<unsigned int>>();
+            content.indices->reserve(static_cast<std::size_t>(header.num_indices));
+
+            read_array(format::array_id::INDICES, header.num_indices, sizeof(unsigned int), [&content](const char* chunk, const std::size_t num)
+                { content.indices->insert(content.indices->end(), reinterpret_cast<const unsigned int*>(chunk), reinterpret_cast<const unsigned int*>(chunk) + num); });
+
+            // Read stream line end positions
+            read_float_array(format::array_id::POSITIONS_FORWARD, 2 * header.num_particles, content.positions_forward);
+            read_float_array(format::array_id::POSITIONS_BACKWARD, 2 * header.num_particles, content.positions_backward);
+
+            // Read labels
+            read_compact_array(format::array_id::LABELS_FORWARD, header.num_particles, content.labels_forward, sizeof(int16_t), convert_int16);
+            read_compact_array(format::array_id::LABELS_BACKWARD, header.num_particles, content.labels_backward, sizeof(int16_t), convert_int16);
+
+            // Read distances
+            read_compact_array(format::array_id::DISTANCES_FORWARD, header.num_particles, content.distances_forward, sizeof(uint16_t), convert_half);
+            read_compact_array(format::array_id::DISTANCES_BACKWARD, header.num_particles, content.distances_backward, sizeof(uint16_t), convert_half);
+
+            // Read reason of termination
+            read_compact_array(format::array_id::TERMINATIONS_FORWARD, header.num_particles, content.terminations_forward, sizeof(int8_t), convert_int8);
+            read_compact_array(format::array_id::TERMINATIONS_BACKWARD, header.num_particles, content.terminations_backward, sizeof(int8_t), convert_int8);
+        }
+
+        bool implicit_topology_reader::read_legacy(const std::string& filename, implicit_topology_results& content) const
+        {
+            std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+
+            if (!ifs.good())
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("Unable to open implicit topology results file '%s'!", filename.c_str());
                 return false;
             }
 
+            // Read file header
+            unsigned int num_particles, num_indices;
+
+            ifs.read(reinterpret_cast<char*>(&num_particles), sizeof(unsigned int));
+            ifs.read(reinterpret_cast<char*>(&num_indices), sizeof(unsigned int));
+            ifs.read(reinterpret_cast<char*>(&content.computation_state.num_integration_steps), sizeof(unsigned int));
+            ifs.read(reinterpret_cast<char*>(&content.computation_state.integration_timestep), sizeof(float));
+            ifs.read(reinterpret_cast<char*>(&content.computation_state.max_integration_error), sizeof(float));
+
+            // Read directly into the chunks
+            auto read_array = [&ifs](chunked_array<float>& data, const std::size_t size)
+            {
+                data.resize(0);
+                data.resize(size);
+
+                for (std::size_t chunk = 0; chunk < data.get_number_of_chunks(); ++chunk)
+                {
+                    auto& chunk_data = data.get_writable_chunk(chunk);
+                    ifs.read(reinterpret_cast<char*>(chunk_data.data()), chunk_data.size() * sizeof(float));
+                }
+            };
+
+            // Read vertices and indices
+            content.indices = std::make_shared<std::vector<unsigned int>>(num_indices);
+
+            read_array(content.vertices, 2 * static_cast<std::size_t>(num_particles));
+            ifs.read(reinterpret_cast<char*>(content.indices->data()), content.indices->size() * sizeof(unsigned int));
+
+            // Read stream line end positions
+            read_array(content.positions_forward, 2 * static_cast<std::size_t>(num_particles));
+            read_array(content.positions_backward, 2 * static_cast<std::size_t>(num_particles));
+
+            // Read labels
+            read_array(content.labels_forward, num_particles);
+            read_array(content.labels_backward, num_particles);
+
+            // Read distances
+            read_array(content.distances_forward, num_particles);
+            read_array(content.distances_backward, num_particles);
+
+            // Read reason of termination
+            read_array(content.terminations_forward, num_particles);
+            read_array(content.terminations_backward, num_particles);
+
+            // Finish reading
+            ifs.close();
+
             return true;
         }
     }
-}
\ No newline at end of file
+}
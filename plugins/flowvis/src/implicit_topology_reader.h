@@ -8,6 +8,7 @@
 
 #include "implicit_topology_call.h"
 #include "implicit_topology_results.h"
+#include "mapped_file.h"
 
 #include "mmcore/AbstractCallbackReader.h"
 
@@ -73,6 +74,27 @@ namespace megamol
             * @return true if the job has been successfully started.
             */
             virtual bool read(const std::string& filename, implicit_topology_results& content) override;
+
+        private:
+            /**
+            * Read results from a memory-mapped file in the chunked format
+            *
+            * @param file       Mapped file
+            * @param content    Output results
+            *
+            * @throw std::runtime_error if the file is corrupt or of an unsupported version
+            */
+            void read_chunked(const mapped_file& file, implicit_topology_results& content) const;
+
+            /**
+            * Read results from a file in the previous, unchunked format
+            *
+            * @param filename   Name of the file
+            * @param content    Output results
+            *
+            * @return True on success, false otherwise
+            */
+            bool read_legacy(const std::string& filename, implicit_topology_results& content) const;
         };
     }
 }
@@ -0,0 +1,575 @@
+#include "stdafx.h"
+#include "implicit_topology_remote.h"
+
+#include "chunked_array.h"
+#include "implicit_topology_computation.h"
+#include "implicit_topology_file_format.h"
+#include "implicit_topology_results.h"
+
+#include "../cuda/streamlines.h"
+
+#include "vislib/sys/Log.h"
+
+#include "zmq.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        namespace implicit_topology_remote
+        {
+            namespace
+            {
+                using array_id = implicit_topology_file_format::array_id;
+                using chunked_member = chunked_array<float> implicit_topology_results::*;
+
+                /** Chunked arrays of the results, in the order of the file format */
+                const std::array<std::pair<array_id, chunked_member>, 9> chunked_arrays = { {
+                    { array_id::VERTICES, &implicit_topology_results::vertices },
+                    { array_id::POSITIONS_FORWARD, &implicit_topology_results::positions_forward },
+                    { array_id::POSITIONS_BACKWARD, &implicit_topology_results::positions_backward },
+                    { array_id::LABELS_FORWARD, &implicit_topology_results::labels_forward },
+                    { array_id::LABELS_BACKWARD, &implicit_topology_results::labels_backward },
+                    { array_id::DISTANCES_FORWARD, &implicit_topology_results::distances_forward },
+                    { array_id::DISTANCES_BACKWARD, &implicit_topology_results::distances_backward },
+                    { array_id::TERMINATIONS_FORWARD, &implicit_topology_results::terminations_forward },
+                    { array_id::TERMINATIONS_BACKWARD, &implicit_topology_results::terminations_backward } } };
+
+                /** Append data to a message */
+                template <typename T>
+                void write(std::vector<char>& message, const T& value)
+                {
+                    const auto* bytes = reinterpret_cast<const char*>(&value);
+                    message.insert(message.end(), bytes, bytes + sizeof(T));
+                }
+
+                template <typename T>
+                void write(std::vector<char>& message, const T* values, const std::size_t num)
+                {
+                    const auto* bytes = reinterpret_cast<const char*>(values);
+                    message.insert(message.end(), bytes, bytes + num * sizeof(T));
+                }
+
+                /** Read data from a message, checking its size */
+                class reader
+                {
+                public:
+                    reader(const void* data, const std::size_t size) : data(static_cast<const char*>(data)), size(size), position(0) {}
+
+                    template <typename T>
+                    bool read(T& value)
+                    {
+                        return read(&value, 1);
+                    }
+
+                    template <typename T>
+                    bool read(T* values, const std::size_t num)
+                    {
+                        if (num > (this->size - this->position) / sizeof(T))
+                        {
+                            return false;
+                        }
+
+                        if (num > 0)
+                        {
+                            std::memcpy(values, this->data + this->position, num * sizeof(T));
+                            this->position += num * sizeof(T);
+                        }
+
+                        return true;
+                    }
+
+                    template <typename T>
+                    bool read(std::vector<T>& values, const uint64_t num)
+                    {
+                        if (num > (this->size - this->position) / sizeof(T))
+                        {
+                            return false;
+                        }
+
+                        values.resize(static_cast<std::size_t>(num));
+
+                        return read(values.data(), values.size());
+                    }
+
+                    bool read_type(const message_type expected)
+                    {
+                        message_type type;
+
+                        return read(type) && type == expected;
+                    }
+
+                    bool at_end() const
+                    {
+                        return this->position == this->size;
+                    }
+
+                private:
+                    const char* data;
+                    std::size_t size;
+                    std::size_t position;
+                };
+            }
+
+            std::vector<char> write_job(const job& job, const start_parameters& parameters)
+            {
+                auto header = job.header;
+                header.num_positions = job.positions.size();
+                header.num_vectors = job.vectors.size();
+                header.num_points = job.points.size();
+                header.num_point_ids = job.point_ids.size();
+                header.num_lines = job.lines.size();
+                header.num_line_ids = job.line_ids.size();
+
+                std::vector<char> message;
+                message.reserve(sizeof(message_type) + sizeof(job_header) + sizeof(start_parameters)
+                    + (job.positions.size() + job.vectors.size() + job.points.size() + job.lines.size()) * sizeof(float)
+                    + (job.point_ids.size() + job.line_ids.size()) * sizeof(int));
+
+                write(message, message_type::JOB);
+                write(message, header);
+                write(message, parameters);
+
+                write(message, job.positions.data(), job.positions.size());
+                write(message, job.vectors.data(), job.vectors.size());
+                write(message, job.points.data(), job.points.size());
+                write(message, job.point_ids.data(), job.point_ids.size());
+                write(message, job.lines.data(), job.lines.size());
+                write(message, job.line_ids.data(), job.line_ids.size());
+
+                return message;
+            }
+
+            std::vector<char> write_resume(const start_parameters& parameters)
+            {
+                std::vector<char> message;
+
+                write(message, message_type::RESUME);
+                write(message, parameters);
+
+                return message;
+            }
+
+            std::vector<char> write_terminate()
+            {
+                std::vector<char> message;
+
+                write(message, message_type::TERMINATE);
+
+                return message;
+            }
+
+            std::vector<char> write_snapshot(const implicit_topology_results& results, const implicit_topology_results* previous)
+            {
+                const bool indices_changed = previous == nullptr || results.indices != previous->indices;
+
+                snapshot_header header;
+                header.method = static_cast<uint32_t>(results.computation_state.method);
+                header.integration_timestep = results.computation_state.integration_timestep;
+                header.max_integration_error = results.computation_state.max_integration_error;
+                header.num_integration_steps = results.computation_state.num_integration_steps;
+                header.version = results.computation_state.version;
+                header.finished = results.computation_state.finished ? 1 : 0;
+                header.num_arrays = static_cast<uint32_t>(chunked_arrays.size());
+                header.indices_changed = indices_changed ? 1 : 0;
+                header.num_indices = results.indices != nullptr ? results.indices->size() : 0;
+
+                std::vector<char> message;
+
+                write(message, message_type::SNAPSHOT);
+                write(message, header);
+
+                if (indices_changed && results.indices != nullptr)
+                {
+                    write(message, results.indices->data(), results.indices->size());
+                }
+
+                // Only send chunks not shared with the previous snapshot, which the client already has
+                for (const auto& entry : chunked_arrays)
+                {
+                    const auto& data = results.*entry.second;
+
+                    std::vector<std::size_t> changed_chunks;
+
+                    for (std::size_t index = 0; index < data.get_number_of_chunks(); ++index)
+                    {
+                        if (previous == nullptr || !data.shares_chunk_with(previous->*entry.second, index))
+                        {
+                            changed_chunks.push_back(index);
+                        }
+                    }
+
+                    array_header array;
+                    array.id = static_cast<uint32_t>(entry.first);
+                    array.num_changed_chunks = static_cast<uint32_t>(changed_chunks.size());
+                    array.num_elements = data.size();
+
+                    write(message, array);
+
+                    for (const auto index : changed_chunks)
+                    {
+                        const auto& chunk_data = data.get_chunk(index);
+
+                        chunk_header chunk;
+                        chunk.index = index;
+                        chunk.num_elements = chunk_data.size();
+
+                        write(message, chunk);
+                        write(message, chunk_data.data(), chunk_data.size());
+                    }
+                }
+
+                return message;
+            }
+
+            std::vector<char> write_failure(const std::string& reason)
+            {
+                std::vector<char> message;
+
+                write(message, message_type::FAILURE);
+                write(message, reason.data(), reason.size());
+
+                return message;
+            }
+
+            bool read_type(const void* data, const std::size_t size, message_type& type)
+            {
+                return reader(data, size).read(type);
+            }
+
+            bool read_job(const void* data, const std::size_t size, job& job, start_parameters& parameters)
+            {
+                reader message(data, size);
+
+                return message.read_type(message_type::JOB) && message.read(job.header) && message.read(parameters)
+                    && message.read(job.positions, job.header.num_positions) && message.read(job.vectors, job.header.num_vectors)
+                    && message.read(job.points, job.header.num_points) && message.read(job.point_ids, job.header.num_point_ids)
+                    && message.read(job.lines, job.header.num_lines) && message.read(job.line_ids, job.header.num_line_ids)
+                    && message.at_end();
+            }
+
+            bool read_resume(const void* data, const std::size_t size, start_parameters& parameters)
+            {
+                reader message(data, size);
+
+                return message.read_type(message_type::RESUME) && message.read(parameters) && message.at_end();
+            }
+
+            bool read_snapshot(const void* data, const std::size_t size, implicit_topology_results& results)
+            {
+                reader message(data, size);
+
+                snapshot_header header;
+
+                if (!message.read_type(message_type::SNAPSHOT) || !message.read(header) || header.num_arrays != chunked_arrays.size())
+                {
+                    return false;
+                }
+
+                results.computation_state.method = static_cast<streamlines_cuda::integration_method>(header.method);
+                results.computation_state.integration_timestep = header.integration_timestep;
+                results.computation_state.max_integration_error = header.max_integration_error;
+                results.computation_state.num_integration_steps = header.num_integration_steps;
+                results.computation_state.version = header.version;
+                results.computation_state.finished = header.finished != 0;
+
+                if (header.indices_changed != 0)
+                {
+                    auto indices = std::make_shared<std::vector<unsigned int>>();
+
+                    if (!message.read(*indices, header.num_indices))
+                    {
+                        return false;
+                    }
+
+                    results.indices = indices;
+                }
+
+                // Unchanged chunks are kept from the previous snapshot
+                for (const auto& entry : chunked_arrays)
+                {
+                    auto& data = results.*entry.second;
+
+                    array_header array;
+
+                    if (!message.read(array) || array.id != static_cast<uint32_t>(entry.first))
+                    {
+                        return false;
+                    }
+
+                    if (array.num_elements < data.size())
+                    {
+                        data.resize(static_cast<std::size_t>(array.num_elements));
+                    }
+
+                    for (uint32_t i = 0; i < array.num_changed_chunks; ++i)
+                    {
+                        chunk_header chunk;
+                        auto chunk_data = std::make_shared<chunked_array<float>::chunk_t>();
+
+                        if (!message.read(chunk) || chunk.index > data.get_number_of_chunks() || chunk.num_elements > data.get_chunk_size()
+                            || !message.read(*chunk_data, chunk.num_elements))
+                        {
+                            return false;
+                        }
+
+                        data.replace_chunk(static_cast<std::size_t>(chunk.index), chunk_data);
+                    }
+
+                    if (data.size() != array.num_elements)
+                    {
+                        return false;
+                    }
+                }
+
+                return message.at_end();
+            }
+
+            bool read_failure(const void* data, const std::size_t size, std::string& reason)
+            {
+                reader message(data, size);
+
+                if (!message.read_type(message_type::FAILURE))
+                {
+                    return false;
+                }
+
+                reason.assign(static_cast<const char*>(data) + sizeof(message_type), size - sizeof(message_type));
+
+                return true;
+            }
+        }
+
+        implicit_topology_remote_client::implicit_topology_remote_client(std::string address, std::array<unsigned int, 2> resolution,
+            std::array<float, 4> domain, std::vector<float> positions, std::vector<float> vectors, std::vector<float> points,
+            std::vector<int> point_ids, std::vector<float> lines, std::vector<int> line_ids, const float integration_timestep,
+            const float max_integration_error, const streamlines_cuda::integration_method method)
+            : address(std::move(address)), job_sent(false), convergence_distance(0.0f), convergence_steps(0), convergence_radius(0.0f),
+            context(1), quit(false)
+        {
+            auto& header = this->job.header;
+            header.resolution[0] = resolution[0];
+            header.resolution[1] = resolution[1];
+            std::memcpy(header.domain, domain.data(), sizeof(header.domain));
+            header.method = static_cast<uint32_t>(method);
+            header.integration_timestep = integration_timestep;
+            header.max_integration_error = max_integration_error;
+            header.quadtree_refinement = 0;
+
+            this->job.positions = std::move(positions);
+            this->job.vectors = std::move(vectors);
+            this->job.points = std::move(points);
+            this->job.point_ids = std::move(point_ids);
+            this->job.lines = std::move(lines);
+            this->job.line_ids = std::move(line_ids);
+
+            this->results = this->promise.get_future().share();
+        }
+
+        implicit_topology_remote_client::~implicit_topology_remote_client()
+        {
+            terminate();
+
+            this->quit = true;
+
+            if (this->communication.joinable())
+            {
+                this->communication.join();
+            }
+        }
+
+        void implicit_topology_remote_client::start(const unsigned int num_integration_steps, const float refinement_threshold,
+            const bool refine_at_labels, const float distance_difference_threshold, const bool incremental_refinement,
+            const unsigned int max_points_per_refinement, const unsigned int num_particles_per_batch,
+            const unsigned int num_integration_steps_per_batch, const implicit_topology_computation::computation_backend backend,
+            const streamlines_cuda::precision precision)
+        {
+            implicit_topology_remote::start_parameters parameters;
+            parameters.num_integration_steps = num_integration_steps;
+            parameters.refinement_threshold = refinement_threshold;
+            parameters.refine_at_labels = refine_at_labels ? 1 : 0;
+            parameters.distance_difference_threshold = distance_difference_threshold;
+            parameters.incremental_refinement = incremental_refinement ? 1 : 0;
+            parameters.max_points_per_refinement = max_points_per_refinement;
+            parameters.num_particles_per_batch = num_particles_per_batch;
+            parameters.num_integration_steps_per_batch = num_integration_steps_per_batch;
+            parameters.backend = static_cast<uint32_t>(backend);
+            parameters.precision = static_cast<uint32_t>(precision);
+            parameters.convergence_distance = this->convergence_distance;
+            parameters.convergence_steps = this->convergence_steps;
+            parameters.convergence_radius = this->convergence_radius;
+            parameters.reserved = 0;
+
+            {
+                std::lock_guard<std::mutex> guard(this->lock);
+
+                // The input is only sent once, later starts resume the computation on the server
+                if (!this->job_sent)
+                {
+                    this->outgoing.push_back(implicit_topology_remote::write_job(this->job, parameters));
+                    this->job_sent = true;
+
+                    this->job.positions.clear();
+                    this->job.positions.shrink_to_fit();
+                    this->job.vectors.clear();
+                    this->job.vectors.shrink_to_fit();
+                }
+                else
+                {
+                    this->outgoing.push_back(implicit_topology_remote::write_resume(parameters));
+                }
+            }
+
+            if (!this->communication.joinable())
+            {
+                this->communication = std::thread(&implicit_topology_remote_client::communicate, this);
+            }
+        }
+
+        void implicit_topology_remote_client::terminate()
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            if (this->job_sent)
+            {
+                this->outgoing.push_back(implicit_topology_remote::write_terminate());
+            }
+        }
+
+        std::shared_future<implicit_topology_results> implicit_topology_remote_client::get_results() const
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            return this->results;
+        }
+
+        void implicit_topology_remote_client::set_convergence_criteria(const float distance, const unsigned int num_steps, const float radius)
+        {
+            this->convergence_distance = distance;
+            this->convergence_steps = num_steps;
+            this->convergence_radius = radius;
+        }
+
+        void implicit_topology_remote_client::set_quadtree_refinement()
+        {
+            this->job.header.quadtree_refinement = 1;
+        }
+
+        void implicit_topology_remote_client::communicate()
+        {
+            try
+            {
+                zmq::socket_t socket(this->context, ZMQ_DEALER);
+                socket.setsockopt(ZMQ_LINGER, 1000);
+                socket.connect(this->address);
+
+                vislib::sys::Log::DefaultLog.WriteInfo("Connected to implicit topology server at %s.", this->address.c_str());
+
+                while (true)
+                {
+                    // Send queued messages, including the final termination queued before quitting
+                    const bool quitting = this->quit;
+
+                    {
+                        std::unique_lock<std::mutex> guard(this->lock);
+
+                        while (!this->outgoing.empty())
+                        {
+                            auto message = std::move(this->outgoing.front());
+                            this->outgoing.pop_front();
+
+                            guard.unlock();
+
+                            zmq::message_t frame(message.data(), message.size());
+                            socket.send(frame);
+
+                            guard.lock();
+                        }
+                    }
+
+                    if (quitting)
+                    {
+                        break;
+                    }
+
+                    // Receive snapshots
+                    zmq::pollitem_t item = { static_cast<void*>(socket), 0, ZMQ_POLLIN, 0 };
+
+                    if (zmq::poll(&item, 1, std::chrono::milliseconds(100)) <= 0)
+                    {
+                        continue;
+                    }
+
+                    zmq::message_t frame;
+
+                    if (!socket.recv(&frame, ZMQ_DONTWAIT))
+                    {
+                        continue;
+                    }
+
+                    implicit_topology_remote::message_type type;
+
+                    if (!implicit_topology_remote::read_type(frame.data(), frame.size(), type))
+                    {
+                        continue;
+                    }
+
+                    if (type == implicit_topology_remote::message_type::SNAPSHOT)
+                    {
+                        auto snapshot = this->received;
+
+                        if (implicit_topology_remote::read_snapshot(frame.data(), frame.size(), snapshot))
+                        {
+                            set_result(snapshot);
+                        }
+                        else
+                        {
+                            vislib::sys::Log::DefaultLog.WriteError("Received invalid snapshot from implicit topology server at %s.", this->address.c_str());
+                        }
+                    }
+                    else if (type == implicit_topology_remote::message_type::FAILURE)
+                    {
+                        std::string reason;
+                        implicit_topology_remote::read_failure(frame.data(), frame.size(), reason);
+
+                        vislib::sys::Log::DefaultLog.WriteError("Implicit topology server at %s failed: %s", this->address.c_str(), reason.c_str());
+
+                        // End the computation for the requesting module, keeping the last results
+                        auto snapshot = this->received;
+                        snapshot.computation_state.finished = true;
+
+                        set_result(snapshot);
+                    }
+                }
+            }
+            catch (const zmq::error_t& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Communication with implicit topology server at %s failed: %s", this->address.c_str(), e.what());
+            }
+        }
+
+        void implicit_topology_remote_client::set_result(const implicit_topology_results& results)
+        {
+            this->received = results;
+
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            this->promise.set_value(results);
+            this->promise = std::promise<implicit_topology_results>();
+            this->results = this->promise.get_future().share();
+        }
+    }
+}
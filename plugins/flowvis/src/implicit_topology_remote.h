@@ -0,0 +1,292 @@
+/*
+ * implicit_topology_remote.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "implicit_topology_computation.h"
+#include "implicit_topology_results.h"
+
+#include "../cuda/streamlines.h"
+
+#include "zmq.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Protocol for running the implicit topology computation on a remote compute server.
+        *
+        * Every message is a single frame, starting with its message type. The client sends the input and all
+        * parameters with a job, and can resume or terminate it later. The server answers with snapshots of the
+        * (intermediate) results, which only contain the chunks that changed since the previous snapshot sent,
+        * using the arrays and chunking of the implicit topology file format. The triangle indices are only sent
+        * when they changed. Data is sent in the native byte order of the machines, which are expected to match.
+        *
+        * @author Alexander Straub
+        */
+        namespace implicit_topology_remote
+        {
+            /** Message types */
+            enum class message_type : uint32_t
+            {
+                JOB,
+                RESUME,
+                TERMINATE,
+                SNAPSHOT,
+                FAILURE
+            };
+
+            /** Parameters for starting or resuming a computation */
+            struct start_parameters
+            {
+                uint32_t num_integration_steps;
+                float refinement_threshold;
+                uint32_t refine_at_labels;
+                float distance_difference_threshold;
+                uint32_t incremental_refinement;
+                uint32_t max_points_per_refinement;
+                uint32_t num_particles_per_batch;
+                uint32_t num_integration_steps_per_batch;
+                uint32_t backend;
+                uint32_t precision;
+
+                float convergence_distance;
+                uint32_t convergence_steps;
+                float convergence_radius;
+                uint32_t reserved;
+            };
+
+            /** Fixed parameters of a job, followed by the input arrays of the given sizes */
+            struct job_header
+            {
+                uint32_t resolution[2];
+                float domain[4];
+
+                uint32_t method;
+                float integration_timestep;
+                float max_integration_error;
+                uint32_t quadtree_refinement;
+
+                uint64_t num_positions;
+                uint64_t num_vectors;
+                uint64_t num_points;
+                uint64_t num_point_ids;
+                uint64_t num_lines;
+                uint64_t num_line_ids;
+            };
+
+            /** Snapshot header, followed by the indices if they changed, and all chunked arrays */
+            struct snapshot_header
+            {
+                uint32_t method;
+                float integration_timestep;
+                float max_integration_error;
+                uint32_t num_integration_steps;
+                uint32_t version;
+                uint32_t finished;
+
+                uint32_t num_arrays;
+                uint32_t indices_changed;
+                uint64_t num_indices;
+            };
+
+            /** Array header, followed by its changed chunks */
+            struct array_header
+            {
+                uint32_t id;
+                uint32_t num_changed_chunks;
+
+                uint64_t num_elements;
+            };
+
+            /** Chunk header, followed by its elements */
+            struct chunk_header
+            {
+                uint64_t index;
+                uint64_t num_elements;
+            };
+
+            static_assert(sizeof(start_parameters) == 56, "Unexpected padding in start parameters");
+            static_assert(sizeof(job_header) == 88, "Unexpected padding in job header");
+            static_assert(sizeof(snapshot_header) == 40, "Unexpected padding in snapshot header");
+            static_assert(sizeof(array_header) == 16, "Unexpected padding in array header");
+            static_assert(sizeof(chunk_header) == 16, "Unexpected padding in chunk header");
+
+            /** Input of a job */
+            struct job
+            {
+                job_header header;
+
+                std::vector<float> positions;
+                std::vector<float> vectors;
+                std::vector<float> points;
+                std::vector<int> point_ids;
+                std::vector<float> lines;
+                std::vector<int> line_ids;
+            };
+
+            /**
+            * Write messages
+            *
+            * @param job                Input and fixed parameters of the job
+            * @param parameters         Parameters for starting or resuming the computation
+            * @param results            Results to send
+            * @param previous           Results sent before, whose chunks are not sent again; nullptr to send all chunks
+            * @param reason             Reason for a failure
+            *
+            * @return Message
+            */
+            std::vector<char> write_job(const job& job, const start_parameters& parameters);
+            std::vector<char> write_resume(const start_parameters& parameters);
+            std::vector<char> write_terminate();
+            std::vector<char> write_snapshot(const implicit_topology_results& results, const implicit_topology_results* previous);
+            std::vector<char> write_failure(const std::string& reason);
+
+            /**
+            * Read messages
+            *
+            * @param data               Message data
+            * @param size               Message size in bytes
+            * @param type               Message type
+            * @param job                Input and fixed parameters of the job
+            * @param parameters         Parameters for starting or resuming the computation
+            * @param results            Results received before, which are updated with the changed chunks
+            * @param reason             Reason for a failure
+            *
+            * @return 'true' if the message is valid, 'false' otherwise
+            */
+            bool read_type(const void* data, std::size_t size, message_type& type);
+            bool read_job(const void* data, std::size_t size, job& job, start_parameters& parameters);
+            bool read_resume(const void* data, std::size_t size, start_parameters& parameters);
+            bool read_snapshot(const void* data, std::size_t size, implicit_topology_results& results);
+            bool read_failure(const void* data, std::size_t size, std::string& reason);
+        }
+
+        /**
+        * Client for running the implicit topology computation on a remote compute server, instead of locally.
+        * Provides the same interface for controlling the computation and getting its (intermediate) results
+        * as the local computation, such that the requesting module only needs to choose either of them.
+        *
+        * @author Alexander Straub
+        */
+        class implicit_topology_remote_client
+        {
+        public:
+            /**
+            * Initialize the job, which is sent to the server when the computation is started.
+            *
+            * @param address                            Address of the server, e.g., tcp://host:port
+            * @param resolution                         Domain resolution (number of vectors per direction)
+            * @param domain                             Domain size (minimum and maximum coordinates)
+            * @param positions                          Positions of the vectors, also used as initial seed
+            * @param vectors                            Vectors of the vector field
+            * @param points                             Convergence structure points (e.g., critical points, periodic orbits, ...)
+            * @param point_ids                          Unique IDs (or labels) of the given points
+            * @param lines                              Convergence structure lines (e.g., domain boundaries, obstacles, ...)
+            * @param line_ids                           (Unique) IDs (or labels) of the given lines
+            * @param integration_timestep               (Initial) integration time step
+            * @param max_integration_error              Maximum integration error for Runge-Kutta 4-5
+            * @param method                             Integration method
+            */
+            implicit_topology_remote_client(std::string address, std::array<unsigned int, 2> resolution, std::array<float, 4> domain,
+                std::vector<float> positions, std::vector<float> vectors, std::vector<float> points, std::vector<int> point_ids,
+                std::vector<float> lines, std::vector<int> line_ids, float integration_timestep, float max_integration_error,
+                streamlines_cuda::integration_method method);
+
+            /**
+            * Destructor, terminating the remote computation
+            */
+            ~implicit_topology_remote_client();
+
+            /**
+            * Start or resume the remote computation, with the parameters of the local computation.
+            */
+            void start(unsigned int num_integration_steps, float refinement_threshold, bool refine_at_labels,
+                float distance_difference_threshold, bool incremental_refinement, unsigned int max_points_per_refinement,
+                unsigned int num_particles_per_batch, unsigned int num_integration_steps_per_batch,
+                implicit_topology_computation::computation_backend backend, streamlines_cuda::precision precision);
+
+            /**
+            * Terminate the remote computation, which can be resumed afterwards.
+            */
+            void terminate();
+
+            /**
+            * Get last (intermediate) results.
+            *
+            * @return Future object on (intermediate) results
+            */
+            std::shared_future<implicit_topology_results> get_results() const;
+
+            /**
+            * Set convergence criteria, applied when starting the computation.
+            *
+            * @param distance                           Terminate if the distance to the labelled structure falls below this distance; 0 to disable
+            * @param num_steps                          Terminate if the label did not change for this number of steps within the radius; 0 to disable
+            * @param radius                             Radius for the number of steps criterion
+            */
+            void set_convergence_criteria(float distance, unsigned int num_steps, float radius);
+
+            /**
+            * Use a quadtree instead of a Delaunay triangulation for refinement.
+            */
+            void set_quadtree_refinement();
+
+        private:
+            /**
+            * Connect to the server, send queued messages and receive snapshots, until the client is destroyed.
+            */
+            void communicate();
+
+            /**
+            * Provide next (intermediate) results.
+            *
+            * @param results                            Results
+            */
+            void set_result(const implicit_topology_results& results);
+
+            /** Server address */
+            const std::string address;
+
+            /** Job, sent with the first start */
+            implicit_topology_remote::job job;
+            bool job_sent;
+
+            /** Convergence criteria */
+            float convergence_distance;
+            unsigned int convergence_steps;
+            float convergence_radius;
+
+            /** Messages waiting to be sent */
+            std::deque<std::vector<char>> outgoing;
+
+            /** Last received results, and future on the next */
+            implicit_topology_results received;
+            std::promise<implicit_topology_results> promise;
+            std::shared_future<implicit_topology_results> results;
+
+            /** Guards the outgoing messages and the results */
+            mutable std::mutex lock;
+
+            /** Communication thread, owning the socket */
+            zmq::context_t context;
+            std::thread communication;
+            std::atomic<bool> quit;
+        };
+    }
+}
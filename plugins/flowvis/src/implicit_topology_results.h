@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include "chunked_array.h"
+
 #include "../cuda/streamlines.h"
 
 #include <memory>
@@ -16,28 +18,32 @@ namespace megamol
     namespace flowvis
     {
         /**
-        * Struct for storing results from implicit topology computation
+        * Struct for storing results from implicit topology computation.
+        * Copies share all unchanged chunks, such that (intermediate) results are cheap snapshots.
         *
         * @author Alexander Straub
         */
         struct implicit_topology_results
         {
+            /** Number of particles per chunk, as power of two; positions use chunks of twice that size */
+            static constexpr unsigned int chunk_shift = chunked_array<float>::default_chunk_shift;
+
             /** End positions of stream lines */
-            std::shared_ptr<std::vector<float>> positions_forward;
-            std::shared_ptr<std::vector<float>> positions_backward;
+            chunked_array<float> positions_forward = chunked_array<float>(chunk_shift + 1);
+            chunked_array<float> positions_backward = chunked_array<float>(chunk_shift + 1);
 
             /** Label and distance fields, and reasons for termination */
-            std::shared_ptr<std::vector<float>> labels_forward;
-            std::shared_ptr<std::vector<float>> labels_backward;
+            chunked_array<float> labels_forward = chunked_array<float>(chunk_shift);
+            chunked_array<float> labels_backward = chunked_array<float>(chunk_shift);
 
-            std::shared_ptr<std::vector<float>> distances_forward;
-            std::shared_ptr<std::vector<float>> distances_backward;
+            chunked_array<float> distances_forward = chunked_array<float>(chunk_shift);
+            chunked_array<float> distances_backward = chunked_array<float>(chunk_shift);
 
-            std::shared_ptr<std::vector<float>> terminations_forward;
-            std::shared_ptr<std::vector<float>> terminations_backward;
+            chunked_array<float> terminations_forward = chunked_array<float>(chunk_shift);
+            chunked_array<float> terminations_backward = chunked_array<float>(chunk_shift);
 
             /** Triangle mesh */
-            std::shared_ptr<std::vector<float>> vertices;
+            chunked_array<float> vertices = chunked_array<float>(chunk_shift + 1);
             std::shared_ptr<std::vector<unsigned int>> indices;
 
             /** Computation state */
@@ -53,6 +59,9 @@ namespace megamol
                 /** Number of time steps computed */
                 unsigned int num_integration_steps;
 
+                /** Version of the results, increased with every snapshot */
+                unsigned int version;
+
                 /** Indicate that the computation is finished */
                 bool finished;
 
@@ -0,0 +1,299 @@
+#include "stdafx.h"
+#include "implicit_topology_server.h"
+
+#include "implicit_topology_computation.h"
+#include "implicit_topology_remote.h"
+#include "implicit_topology_results.h"
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/DirectDataWriterCall.h"
+#include "mmcore/param/StringParam.h"
+#include "mmcore/profiler/Manager.h"
+
+#include "vislib/StringConverter.h"
+#include "vislib/sys/Log.h"
+
+#include "zmq.hpp"
+
+#include <array>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        namespace
+        {
+            /** Send a message to the client with the given identity */
+            void send(zmq::socket_t& socket, const std::string& client, const std::vector<char>& message)
+            {
+                zmq::message_t identity(client.data(), client.size());
+                zmq::message_t frame(message.data(), message.size());
+
+                socket.send(identity, ZMQ_SNDMORE);
+                socket.send(frame);
+            }
+
+            /** Start or resume the computation with the received parameters */
+            void start(implicit_topology_computation& computation, const implicit_topology_remote::start_parameters& parameters)
+            {
+                computation.set_convergence_criteria(parameters.convergence_distance, parameters.convergence_steps, parameters.convergence_radius);
+
+                computation.start(parameters.num_integration_steps, parameters.refinement_threshold, parameters.refine_at_labels != 0,
+                    parameters.distance_difference_threshold, parameters.incremental_refinement != 0, parameters.max_points_per_refinement,
+                    parameters.num_particles_per_batch, parameters.num_integration_steps_per_batch,
+                    static_cast<implicit_topology_computation::computation_backend>(parameters.backend),
+                    static_cast<streamlines_cuda::precision>(parameters.precision));
+            }
+        }
+
+        implicit_topology_server::implicit_topology_server() :
+            AbstractThreadedJob(), Module(),
+            log_slot("log_slot", "Log output slot"),
+            performance_slot("performance_slot", "Performance log output slot"),
+            telemetry_slot("telemetry_slot", "Telemetry output slot, writing timings and counters as JSON lines"),
+            address("address", "Address the server binds to, e.g., tcp://*:port")
+        {
+            // Connect output
+            this->log_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_server::get_log_cb_callback);
+            this->MakeSlotAvailable(&this->log_slot);
+            this->get_log_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            this->performance_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_server::get_performance_cb_callback);
+            this->MakeSlotAvailable(&this->performance_slot);
+            this->get_performance_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            this->telemetry_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_server::get_telemetry_cb_callback);
+            this->MakeSlotAvailable(&this->telemetry_slot);
+            this->get_telemetry_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            // Create server parameters
+            this->address << new core::param::StringParam("tcp://*:5556");
+            this->MakeSlotAvailable(&this->address);
+        }
+
+        implicit_topology_server::~implicit_topology_server()
+        {
+            this->Release();
+        }
+
+        bool implicit_topology_server::create()
+        {
+            return true;
+        }
+
+        void implicit_topology_server::release()
+        {
+        }
+
+        bool implicit_topology_server::Terminate()
+        {
+            // The running computation is terminated by the job thread, which owns it
+            AbstractThreadedJob::Terminate();
+
+            return true;
+        }
+
+        DWORD implicit_topology_server::Run(void*)
+        {
+            const std::string address(static_cast<const char*>(T2A(this->address.Param<core::param::StringParam>()->Value())));
+
+            // The computation of the current job, its client, and the last snapshot sent to it
+            std::unique_ptr<implicit_topology_computation> computation;
+            std::shared_future<implicit_topology_results> result;
+            std::unique_ptr<implicit_topology_results> sent;
+            std::string client;
+            bool running = false;
+
+            try
+            {
+                zmq::context_t context(1);
+                zmq::socket_t socket(context, ZMQ_ROUTER);
+                socket.setsockopt(ZMQ_LINGER, 0);
+                socket.bind(address);
+
+                vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology server \"%s\" listening at %s.", this->FullName().PeekBuffer(), address.c_str());
+
+                while (!this->shouldTerminate())
+                {
+                    // Forward new (intermediate) results, only sending the chunks changed since the last snapshot
+                    if (running && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                    {
+                        const auto& snapshot = result.get();
+
+                        if (sent == nullptr || snapshot.computation_state.version != sent->computation_state.version)
+                        {
+                            send(socket, client, implicit_topology_remote::write_snapshot(snapshot, sent.get()));
+
+                            sent = std::make_unique<implicit_topology_results>(snapshot);
+                            running = !snapshot.computation_state.finished;
+                        }
+
+                        if (running)
+                        {
+                            result = computation->get_results();
+                        }
+                    }
+
+                    // Receive requests, waking up regularly to check for new results and termination
+                    zmq::pollitem_t item = { static_cast<void*>(socket), 0, ZMQ_POLLIN, 0 };
+
+                    if (zmq::poll(&item, 1, std::chrono::milliseconds(running ? 10 : 100)) <= 0)
+                    {
+                        continue;
+                    }
+
+                    zmq::message_t identity, frame;
+
+                    if (!socket.recv(&identity, ZMQ_DONTWAIT) || !identity.more() || !socket.recv(&frame, ZMQ_DONTWAIT))
+                    {
+                        continue;
+                    }
+
+                    const std::string sender(static_cast<const char*>(identity.data()), identity.size());
+
+                    implicit_topology_remote::message_type type;
+
+                    if (!implicit_topology_remote::read_type(frame.data(), frame.size(), type))
+                    {
+                        continue;
+                    }
+
+                    if (type == implicit_topology_remote::message_type::JOB)
+                    {
+                        implicit_topology_remote::job job;
+                        implicit_topology_remote::start_parameters parameters;
+
+                        if (!implicit_topology_remote::read_job(frame.data(), frame.size(), job, parameters)
+                            || job.positions.size() != 2 * static_cast<std::size_t>(job.header.resolution[0]) * job.header.resolution[1]
+                            || job.vectors.size() != job.positions.size())
+                        {
+                            send(socket, sender, implicit_topology_remote::write_failure("Invalid job"));
+                            continue;
+                        }
+
+                        // Only one job is computed at a time, replacing the previous one
+                        if (computation != nullptr)
+                        {
+                            computation->terminate();
+                            computation = nullptr;
+
+                            if (sender != client)
+                            {
+                                send(socket, client, implicit_topology_remote::write_failure("Job replaced by another client"));
+                            }
+                        }
+
+                        vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology server \"%s\" received a job for a %ux%u vector field.",
+                            this->FullName().PeekBuffer(), job.header.resolution[0], job.header.resolution[1]);
+
+                        try
+                        {
+                            computation = std::make_unique<implicit_topology_computation>(this->get_log_callback(), this->get_performance_callback(),
+                                std::array<unsigned int, 2>{ job.header.resolution[0], job.header.resolution[1] },
+                                std::array<float, 4>{ job.header.domain[0], job.header.domain[1], job.header.domain[2], job.header.domain[3] },
+                                std::move(job.positions), std::move(job.vectors), std::move(job.points), std::move(job.point_ids),
+                                std::move(job.lines), std::move(job.line_ids), job.header.integration_timestep, job.header.max_integration_error,
+                                static_cast<streamlines_cuda::integration_method>(job.header.method));
+
+                            if (job.header.quadtree_refinement != 0)
+                            {
+                                computation->set_quadtree_refinement();
+                            }
+
+                            computation->set_telemetry_output(this->get_telemetry_callback(), []() { return core::profiler::Manager::Instance().Now(); });
+
+                            start(*computation, parameters);
+                        }
+                        catch (const std::exception& e)
+                        {
+                            computation = nullptr;
+                            running = false;
+
+                            send(socket, sender, implicit_topology_remote::write_failure(e.what()));
+                            continue;
+                        }
+
+                        result = computation->get_results();
+                        sent = nullptr;
+                        client = sender;
+                        running = true;
+                    }
+                    else if (type == implicit_topology_remote::message_type::RESUME)
+                    {
+                        implicit_topology_remote::start_parameters parameters;
+
+                        if (computation == nullptr || sender != client || running
+                            || !implicit_topology_remote::read_resume(frame.data(), frame.size(), parameters))
+                        {
+                            send(socket, sender, implicit_topology_remote::write_failure("No terminated job to resume"));
+                            continue;
+                        }
+
+                        start(*computation, parameters);
+
+                        result = computation->get_results();
+                        running = true;
+                    }
+                    else if (type == implicit_topology_remote::message_type::TERMINATE)
+                    {
+                        if (computation != nullptr && sender == client && running)
+                        {
+                            computation->terminate();
+                            running = false;
+                        }
+                    }
+                }
+            }
+            catch (const zmq::error_t& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Implicit topology server \"%s\" failed: %s", this->FullName().PeekBuffer(), e.what());
+
+                if (computation != nullptr)
+                {
+                    computation->terminate();
+                }
+
+                return -1;
+            }
+
+            if (computation != nullptr)
+            {
+                computation->terminate();
+            }
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology server \"%s\" terminated.", this->FullName().PeekBuffer());
+
+            return 0;
+        }
+
+        bool implicit_topology_server::get_log_cb_callback(core::Call& call)
+        {
+            this->get_log_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_server::get_performance_cb_callback(core::Call& call)
+        {
+            this->get_performance_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_server::get_telemetry_cb_callback(core::Call& call)
+        {
+            this->get_telemetry_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+    }
+}
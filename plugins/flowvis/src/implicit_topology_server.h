@@ -0,0 +1,120 @@
+/*
+ * implicit_topology_server.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include <functional>
+#include <iostream>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Job serving implicit topology computations to remote clients, e.g., for running on a cluster node
+        * with a headless MegaMol instance while the implicit topology module of the interactive session only
+        * acts as a client. The server computes one job at a time, and streams (intermediate) results
+        * as snapshots of the changed chunks to the client.
+        *
+        * @author Alexander Straub
+        */
+        class implicit_topology_server : public core::job::AbstractThreadedJob, public core::Module
+        {
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static inline const char* ClassName() { return "implicit_topology_server"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static inline const char* Description() { return "Job for serving implicit topology computations of 2D vector fields to remote clients"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static inline bool IsAvailable() { return true; }
+
+            /**
+             * Disallow usage in quickstarts.
+             *
+             * @return 'false'
+             */
+            static inline bool SupportQuickstart() { return false; }
+
+            /**
+             * Initialises a new instance.
+             */
+            implicit_topology_server();
+
+            /**
+             * Finalises an instance.
+             */
+            virtual ~implicit_topology_server();
+
+            /**
+             * Terminates the job thread, also terminating the running computation.
+             *
+             * @return 'true' to acknowledge that the job will finish as soon as possible, 'false' if termination is not possible.
+             */
+            virtual bool Terminate() override;
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+        private:
+            /**
+             * Receive jobs and send their results, until terminated.
+             *
+             * @param userData  Unused
+             *
+             * @return 0 on success, negative value on error
+             */
+            virtual DWORD Run(void* userData) override;
+
+            /** Callbacks for the log, performance and telemetry output */
+            bool get_log_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_log_callback;
+
+            bool get_performance_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_performance_callback;
+
+            bool get_telemetry_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_telemetry_callback;
+
+            /** Output slots for the log, performance and telemetry output */
+            core::CalleeSlot log_slot;
+            core::CalleeSlot performance_slot;
+            core::CalleeSlot telemetry_slot;
+
+            /** Address the server binds to */
+            core::param::ParamSlot address;
+        };
+    }
+}
@@ -0,0 +1,437 @@
+#include "stdafx.h"
+#include "implicit_topology_sweep.h"
+
+#include "glyph_data_call.h"
+#include "implicit_topology_call.h"
+#include "implicit_topology_computation.h"
+#include "implicit_topology_results.h"
+#include "vector_field_call.h"
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/DirectDataWriterCall.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/profiler/Manager.h"
+#include "mmcore/param/StringParam.h"
+
+#include "vislib/StringConverter.h"
+#include "vislib/sys/Log.h"
+
+#include <array>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        implicit_topology_sweep::implicit_topology_sweep() :
+            AbstractThreadedJob(), Module(),
+            result_writer_slot("result_writer_slot", "Results output slot"),
+            log_slot("log_slot", "Log output slot"),
+            performance_slot("performance_slot", "Performance log output slot"),
+            telemetry_slot("telemetry_slot", "Telemetry output slot, writing timings and counters as JSON lines"),
+            vector_field_slot("vector_field_slot", "Vector field input slot"),
+            convergence_structures_slot("convergence_structures_slot", "Convergence structures input slot"),
+            integration_method("integration_method", "Method for stream line integration"),
+            num_integration_steps("num_integration_steps", "Number of stream line integration steps"),
+            max_integration_error("max_integration_error", "Maximum integration error for Runge-Kutta 4-5"),
+            num_particles_per_batch("num_particles_per_batch", "Number of particles processed and uploaded to the GPU per batch"),
+            num_integration_steps_per_batch("num_integration_steps_per_batch", "Number of integration steps per batch"),
+            computation_backend("computation_backend", "Backend for stream line computation"),
+            integration_precision("integration_precision", "Floating point precision of the stream line integration on the GPU"),
+            refine_at_labels("refine_at_labels", "Refine at label boundaries"),
+            incremental_refinement("incremental_refinement", "Only revisit the neighborhood of the points inserted by the previous refinement"),
+            max_points_per_refinement("max_points_per_refinement", "Maximum number of points inserted per refinement; 0 for no limit"),
+            integration_timesteps("integration_timesteps", "Initial time steps for stream line integration, separated by semicolons"),
+            refinement_thresholds("refinement_thresholds", "Thresholds for grid refinement, separated by semicolons"),
+            distance_difference_thresholds("distance_difference_thresholds", "Thresholds for refinement at distance differences, separated by semicolons")
+        {
+            // Connect output
+            this->result_writer_slot.SetCallback(implicit_topology_writer_call::ClassName(), implicit_topology_writer_call::FunctionName(0), &implicit_topology_sweep::get_result_writer_cb_callback);
+            this->MakeSlotAvailable(&this->result_writer_slot);
+            this->get_result_writer_callback = [](const implicit_topology_results&) -> bool {
+                vislib::sys::Log::DefaultLog.WriteWarn("Cannot write results. Writer module not connected!"); return true; };
+
+            this->log_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_sweep::get_log_cb_callback);
+            this->MakeSlotAvailable(&this->log_slot);
+            this->get_log_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            this->performance_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_sweep::get_performance_cb_callback);
+            this->MakeSlotAvailable(&this->performance_slot);
+            this->get_performance_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            this->telemetry_slot.SetCallback(core::DirectDataWriterCall::ClassName(), core::DirectDataWriterCall::FunctionName(0), &implicit_topology_sweep::get_telemetry_cb_callback);
+            this->MakeSlotAvailable(&this->telemetry_slot);
+            this->get_telemetry_callback = []() -> std::ostream& { static std::ostream dummy(nullptr); return dummy; };
+
+            // Connect input
+            this->vector_field_slot.SetCompatibleCall<vector_field_call::vector_field_description>();
+            this->MakeSlotAvailable(&this->vector_field_slot);
+
+            this->convergence_structures_slot.SetCompatibleCall<glyph_data_call::glyph_data_description>();
+            this->MakeSlotAvailable(&this->convergence_structures_slot);
+
+            // Create computation parameters
+            this->integration_method << new core::param::EnumParam(0);
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(0, "Runge-Kutta 4 (fixed)");
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(1, "Runge-Kutta 4-5 (dynamic)");
+            this->MakeSlotAvailable(&this->integration_method);
+
+            this->num_integration_steps << new core::param::IntParam(0);
+            this->MakeSlotAvailable(&this->num_integration_steps);
+
+            this->max_integration_error << new core::param::FloatParam(0.000001f);
+            this->MakeSlotAvailable(&this->max_integration_error);
+
+            this->num_particles_per_batch << new core::param::IntParam(10000);
+            this->MakeSlotAvailable(&this->num_particles_per_batch);
+
+            this->num_integration_steps_per_batch << new core::param::IntParam(10000);
+            this->MakeSlotAvailable(&this->num_integration_steps_per_batch);
+
+            this->computation_backend << new core::param::EnumParam(0);
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(0, "Automatic");
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(1, "CUDA");
+            this->computation_backend.Param<core::param::EnumParam>()->SetTypePair(2, "CPU");
+            this->MakeSlotAvailable(&this->computation_backend);
+
+            this->integration_precision << new core::param::EnumParam(0);
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(0, "Single");
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(1, "Mixed");
+            this->integration_precision.Param<core::param::EnumParam>()->SetTypePair(2, "Double");
+            this->MakeSlotAvailable(&this->integration_precision);
+
+            this->refine_at_labels << new core::param::BoolParam(true);
+            this->MakeSlotAvailable(&this->refine_at_labels);
+
+            this->incremental_refinement << new core::param::BoolParam(true);
+            this->MakeSlotAvailable(&this->incremental_refinement);
+
+            this->max_points_per_refinement << new core::param::IntParam(0, 0);
+            this->MakeSlotAvailable(&this->max_points_per_refinement);
+
+            // Create sweep parameters
+            this->integration_timesteps << new core::param::StringParam("0.01");
+            this->MakeSlotAvailable(&this->integration_timesteps);
+
+            this->refinement_thresholds << new core::param::StringParam("0.00024");
+            this->MakeSlotAvailable(&this->refinement_thresholds);
+
+            this->distance_difference_thresholds << new core::param::StringParam("0.00025");
+            this->MakeSlotAvailable(&this->distance_difference_thresholds);
+        }
+
+        implicit_topology_sweep::~implicit_topology_sweep()
+        {
+            this->Release();
+        }
+
+        bool implicit_topology_sweep::create()
+        {
+            return true;
+        }
+
+        void implicit_topology_sweep::release()
+        {
+        }
+
+        bool implicit_topology_sweep::Terminate()
+        {
+            // The running computation is terminated by the job thread, which owns it
+            AbstractThreadedJob::Terminate();
+
+            return true;
+        }
+
+        DWORD implicit_topology_sweep::Run(void*)
+        {
+            // Get swept parameter values
+            std::vector<float> timesteps, refinement_thresholds, distance_difference_thresholds;
+
+            if (!parse_sweep_values(this->integration_timesteps, timesteps) ||
+                !parse_sweep_values(this->refinement_thresholds, refinement_thresholds) ||
+                !parse_sweep_values(this->distance_difference_thresholds, distance_difference_thresholds))
+            {
+                return -1;
+            }
+
+            // Load input once for all runs
+            std::array<unsigned int, 2> resolution;
+            std::array<float, 4> domain;
+
+            std::vector<float> positions;
+            std::vector<float> vectors;
+            std::vector<float> points;
+            std::vector<int> point_ids;
+            std::vector<float> lines;
+            std::vector<int> line_ids;
+
+            if (!load_input(resolution, domain, positions, vectors, points, point_ids, lines, line_ids))
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("Implicit topology sweep \"%s\" could not load its input.", this->FullName().PeekBuffer());
+                return -2;
+            }
+
+            // Get fixed parameters
+            const auto method = static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value());
+            const auto num_integration_steps = static_cast<unsigned int>(this->num_integration_steps.Param<core::param::IntParam>()->Value());
+            const auto max_integration_error = this->max_integration_error.Param<core::param::FloatParam>()->Value();
+            const auto num_particles_per_batch = static_cast<unsigned int>(this->num_particles_per_batch.Param<core::param::IntParam>()->Value());
+            const auto num_integration_steps_per_batch = static_cast<unsigned int>(this->num_integration_steps_per_batch.Param<core::param::IntParam>()->Value());
+            const auto backend = static_cast<implicit_topology_computation::computation_backend>(this->computation_backend.Param<core::param::EnumParam>()->Value());
+            const auto integration_precision = static_cast<streamlines_cuda::precision>(this->integration_precision.Param<core::param::EnumParam>()->Value());
+
+            const auto refine_at_labels = this->refine_at_labels.Param<core::param::BoolParam>()->Value();
+            const auto incremental_refinement = this->incremental_refinement.Param<core::param::BoolParam>()->Value();
+            const auto max_points_per_refinement = static_cast<unsigned int>(this->max_points_per_refinement.Param<core::param::IntParam>()->Value());
+
+            const std::size_t num_runs = timesteps.size() * refinement_thresholds.size() * distance_difference_thresholds.size();
+            std::size_t run = 0;
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Starting implicit topology sweep \"%s\" with %zu runs...", this->FullName().PeekBuffer(), num_runs);
+
+            // Vector field and convergence structures are only uploaded by the first run, and reused afterwards
+            std::shared_ptr<implicit_topology_computation::streamline_backends> backends;
+
+            for (const auto timestep : timesteps)
+            {
+                for (const auto refinement_threshold : refinement_thresholds)
+                {
+                    for (const auto distance_difference_threshold : distance_difference_thresholds)
+                    {
+                        if (this->shouldTerminate())
+                        {
+                            vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology sweep \"%s\" terminated after %zu of %zu runs.",
+                                this->FullName().PeekBuffer(), run, num_runs);
+
+                            return 0;
+                        }
+
+                        ++run;
+
+                        vislib::sys::Log::DefaultLog.WriteInfo("Run %zu of %zu: time step %f, refinement threshold %f, distance difference threshold %f",
+                            run, num_runs, timestep, refinement_threshold, distance_difference_threshold);
+
+                        // Each computation keeps its own copy of the input
+                        implicit_topology_computation computation(this->get_log_callback(), this->get_performance_callback(),
+                            resolution, domain, positions, vectors, points, point_ids, lines, line_ids, timestep, max_integration_error, method);
+
+                        computation.set_telemetry_output(this->get_telemetry_callback(), []() { return core::profiler::Manager::Instance().Now(); });
+
+                        if (backends != nullptr)
+                        {
+                            computation.set_backends(backends);
+                        }
+                        else
+                        {
+                            backends = computation.get_backends();
+                        }
+
+                        computation.start(num_integration_steps, refinement_threshold, refine_at_labels, distance_difference_threshold,
+                            incremental_refinement, max_points_per_refinement, num_particles_per_batch, num_integration_steps_per_batch, backend,
+                            integration_precision);
+
+                        // Block on (intermediate) results, only waking up regularly to check for termination
+                        auto result = computation.get_results();
+
+                        while (!this->shouldTerminate())
+                        {
+                            if (result.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+                            {
+                                continue;
+                            }
+
+                            if (result.get().computation_state.finished)
+                            {
+                                break;
+                            }
+
+                            // Continue with the next result, once the computation thread provided it
+                            const auto version = result.get().computation_state.version;
+
+                            do
+                            {
+                                std::this_thread::yield();
+
+                                result = computation.get_results();
+                            }
+                            while (result.wait_for(std::chrono::seconds(0)) == std::future_status::ready && result.get().computation_state.version == version);
+                        }
+
+                        if (this->shouldTerminate())
+                        {
+                            computation.terminate();
+
+                            vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology sweep \"%s\" terminated during run %zu of %zu.",
+                                this->FullName().PeekBuffer(), run, num_runs);
+
+                            return 0;
+                        }
+
+                        if (!this->get_result_writer_callback(result.get()))
+                        {
+                            vislib::sys::Log::DefaultLog.WriteWarn("Could not write results of run %zu.", run);
+                        }
+                    }
+                }
+            }
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Implicit topology sweep \"%s\" complete.", this->FullName().PeekBuffer());
+
+            return 0;
+        }
+
+        bool implicit_topology_sweep::get_result_writer_cb_callback(core::Call& call)
+        {
+            this->get_result_writer_callback = dynamic_cast<implicit_topology_writer_call*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_sweep::get_log_cb_callback(core::Call& call)
+        {
+            this->get_log_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_sweep::get_performance_cb_callback(core::Call& call)
+        {
+            this->get_performance_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_sweep::get_telemetry_cb_callback(core::Call& call)
+        {
+            this->get_telemetry_callback = dynamic_cast<core::DirectDataWriterCall*>(&call)->GetCallback();
+
+            return true;
+        }
+
+        bool implicit_topology_sweep::load_input(std::array<unsigned int, 2>& resolution, std::array<float, 4>& domain, std::vector<float>& positions,
+            std::vector<float>& vectors, std::vector<float>& points, std::vector<int>& point_ids, std::vector<float>& lines, std::vector<int>& line_ids)
+        {
+            // Get vector field
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (vf_call != nullptr && (*vf_call)(1) && (*vf_call)(0))
+            {
+                if (vf_call->get_components() != 2)
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Implicit topology computation is only supported for planar vector fields");
+
+                    return false;
+                }
+
+                resolution = vf_call->get_resolution();
+                domain = { vf_call->get_bounding_rectangle().Left(), vf_call->get_bounding_rectangle().Bottom(),
+                    vf_call->get_bounding_rectangle().Right(), vf_call->get_bounding_rectangle().Top() };
+
+                positions = *vf_call->get_positions();
+                vectors = *vf_call->get_vectors();
+            }
+            else
+            {
+                return false;
+            }
+
+            // Load convergence structures
+            auto* glyph_call = this->convergence_structures_slot.CallAs<glyph_data_call>();
+
+            if (glyph_call != nullptr && (*glyph_call)(1) && (*glyph_call)(0))
+            {
+                // Get points
+                const auto& input_points = glyph_call->get_points();
+
+                points.reserve(2 * input_points.size());
+                point_ids.reserve(input_points.size());
+
+                for (const auto& point : input_points)
+                {
+                    points.push_back(point.first[0]);
+                    points.push_back(point.first[1]);
+
+                    point_ids.push_back(static_cast<int>(point.second));
+                }
+
+                // Get lines
+                const auto& input_lines = glyph_call->get_line_segments();
+
+                lines.reserve(4 * input_lines.size());
+                line_ids.reserve(input_lines.size());
+
+                for (const auto& line : input_lines)
+                {
+                    lines.push_back(line.first.first[0]);
+                    lines.push_back(line.first.first[1]);
+                    lines.push_back(line.first.second[0]);
+                    lines.push_back(line.first.second[1]);
+
+                    line_ids.push_back(static_cast<int>(line.second));
+                }
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        bool implicit_topology_sweep::parse_sweep_values(core::param::ParamSlot& parameter, std::vector<float>& values) const
+        {
+            std::string input(static_cast<const char*>(T2A(parameter.Param<core::param::StringParam>()->Value())));
+
+            for (auto& character : input)
+            {
+                if (character == ';' || character == ',')
+                {
+                    character = ' ';
+                }
+            }
+
+            std::istringstream stream(input);
+            std::string token;
+
+            while (stream >> token)
+            {
+                try
+                {
+                    std::size_t num_parsed = 0;
+                    values.push_back(std::stof(token, &num_parsed));
+
+                    if (num_parsed != token.size())
+                    {
+                        throw std::invalid_argument(token);
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Invalid value '%s' for parameter '%s'.", token.c_str(), parameter.Name().PeekBuffer());
+                    return false;
+                }
+            }
+
+            if (values.empty())
+            {
+                vislib::sys::Log::DefaultLog.WriteError("No values given for parameter '%s'.", parameter.Name().PeekBuffer());
+                return false;
+            }
+
+            return true;
+        }
+    }
+}
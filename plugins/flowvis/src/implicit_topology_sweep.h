@@ -0,0 +1,181 @@
+/*
+ * implicit_topology_sweep.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "implicit_topology_computation.h"
+#include "implicit_topology_results.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include <array>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Job for computing the implicit topology of a vector field for all combinations of the given
+        * integration time steps, refinement thresholds, and distance difference thresholds, without user interaction.
+        * The input is loaded and uploaded only once, and all results are passed on to the connected writer.
+        *
+        * @author Alexander Straub
+        */
+        class implicit_topology_sweep : public core::job::AbstractThreadedJob, public core::Module
+        {
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static inline const char* ClassName() { return "implicit_topology_sweep"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static inline const char* Description() { return "Job for computing implicit topology of a 2D vector field for a parameter sweep"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static inline bool IsAvailable() { return true; }
+
+            /**
+             * Disallow usage in quickstarts.
+             *
+             * @return 'false'
+             */
+            static inline bool SupportQuickstart() { return false; }
+
+            /**
+             * Initialises a new instance.
+             */
+            implicit_topology_sweep();
+
+            /**
+             * Finalises an instance.
+             */
+            virtual ~implicit_topology_sweep();
+
+            /**
+             * Terminates the job thread, also terminating the running computation.
+             *
+             * @return 'true' to acknowledge that the job will finish as soon as possible, 'false' if termination is not possible.
+             */
+            virtual bool Terminate() override;
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+        private:
+            /**
+             * Perform the computation for all parameter combinations.
+             *
+             * @param userData  Unused
+             *
+             * @return 0 on success, negative value on error
+             */
+            virtual DWORD Run(void* userData) override;
+
+            /** Callbacks for the result writer */
+            bool get_result_writer_cb_callback(core::Call& call);
+            std::function<bool(const implicit_topology_results&)> get_result_writer_callback;
+
+            /** Callbacks for the log, performance and telemetry output */
+            bool get_log_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_log_callback;
+
+            bool get_performance_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_performance_callback;
+
+            bool get_telemetry_cb_callback(core::Call& call);
+            std::function<std::ostream&()> get_telemetry_callback;
+
+            /**
+            * Load input from the connected modules.
+            *
+            * @param resolution     Domain resolution (number of vectors per direction)
+            * @param domain         Domain size (minimum and maximum coordinates)
+            * @param positions      Positions of the vectors, also used as initial seed
+            * @param vectors        Vectors of the vector field
+            * @param points         Convergence structure points
+            * @param point_ids      IDs (or labels) of the given points
+            * @param lines          Convergence structure lines
+            * @param line_ids       IDs (or labels) of the given lines
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool load_input(std::array<unsigned int, 2>& resolution, std::array<float, 4>& domain, std::vector<float>& positions, std::vector<float>& vectors,
+                std::vector<float>& points, std::vector<int>& point_ids, std::vector<float>& lines, std::vector<int>& line_ids);
+
+            /**
+            * Parse the values of a sweep parameter.
+            *
+            * @param parameter      Parameter containing values separated by semicolons, commas or white space
+            * @param values         Parsed values
+            *
+            * @return 'true' if at least one value was given and all values are valid, 'false' otherwise
+            */
+            bool parse_sweep_values(core::param::ParamSlot& parameter, std::vector<float>& values) const;
+
+            /** Output slot for writing results to file */
+            core::CalleeSlot result_writer_slot;
+
+            /** Output slots for the log, performance and telemetry output */
+            core::CalleeSlot log_slot;
+            core::CalleeSlot performance_slot;
+            core::CalleeSlot telemetry_slot;
+
+            /** Input slot for getting the vector field */
+            core::CallerSlot vector_field_slot;
+
+            /** Input slot for getting the convergence structures */
+            core::CallerSlot convergence_structures_slot;
+
+            /** Parameters for stream line computation, shared by all runs */
+            core::param::ParamSlot integration_method;
+            core::param::ParamSlot num_integration_steps;
+            core::param::ParamSlot max_integration_error;
+            core::param::ParamSlot num_particles_per_batch;
+            core::param::ParamSlot num_integration_steps_per_batch;
+            core::param::ParamSlot computation_backend;
+            core::param::ParamSlot integration_precision;
+
+            /** Parameters for topology refinement, shared by all runs */
+            core::param::ParamSlot refine_at_labels;
+            core::param::ParamSlot incremental_refinement;
+            core::param::ParamSlot max_points_per_refinement;
+
+            /** Swept parameters, each given as list of values */
+            core::param::ParamSlot integration_timesteps;
+            core::param::ParamSlot refinement_thresholds;
+            core::param::ParamSlot distance_difference_thresholds;
+        };
+    }
+}
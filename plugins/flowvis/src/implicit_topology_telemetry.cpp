@@ -0,0 +1,102 @@
+#include "stdafx.h"
+#include "implicit_topology_telemetry.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        implicit_topology_telemetry::scoped_timer::scoped_timer(implicit_topology_telemetry& telemetry, const char* phase)
+            : telemetry(telemetry), phase(phase), start(std::chrono::high_resolution_clock::now())
+        { }
+
+        implicit_topology_telemetry::scoped_timer::~scoped_timer()
+        {
+            const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - this->start;
+
+            this->telemetry.add_time(this->phase, duration.count());
+        }
+
+        implicit_topology_telemetry::implicit_topology_telemetry() : stream(nullptr)
+        { }
+
+        void implicit_topology_telemetry::set_output(std::ostream& stream, clock_t clock)
+        {
+            // Streams without buffer, e.g., the default of unconnected output slots, do not enable the telemetry
+            this->stream = stream.rdbuf() != nullptr ? &stream : nullptr;
+
+            if (clock)
+            {
+                this->clock = std::move(clock);
+            }
+            else
+            {
+                const auto start = std::chrono::steady_clock::now();
+
+                this->clock = [start]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+            }
+        }
+
+        bool implicit_topology_telemetry::is_enabled() const
+        {
+            return this->stream != nullptr;
+        }
+
+        void implicit_topology_telemetry::add_time(const char* phase, const double milliseconds)
+        {
+            if (is_enabled())
+            {
+                this->times[phase] += milliseconds;
+            }
+        }
+
+        void implicit_topology_telemetry::add_count(const char* counter, const std::uint64_t value)
+        {
+            if (is_enabled())
+            {
+                this->counters[counter] += value;
+            }
+        }
+
+        void implicit_topology_telemetry::write_record(const char* event)
+        {
+            if (!is_enabled())
+            {
+                return;
+            }
+
+            // Event, phase and counter names are identifiers, which need no escaping
+            std::stringstream record;
+            record << std::setprecision(9);
+
+            record << "{\"event\":\"" << event << "\",\"time\":" << this->clock() << ",\"times_ms\":{";
+
+            for (auto it = this->times.begin(); it != this->times.end(); ++it)
+            {
+                record << (it != this->times.begin() ? "," : "") << "\"" << it->first << "\":" << it->second;
+            }
+
+            record << "},\"counters\":{";
+
+            for (auto it = this->counters.begin(); it != this->counters.end(); ++it)
+            {
+                record << (it != this->counters.begin() ? "," : "") << "\"" << it->first << "\":" << it->second;
+            }
+
+            record << "}}";
+
+            // Write complete lines only, such that the stream stays parsable when the computation is terminated
+            *this->stream << record.str() << std::endl;
+
+            this->times.clear();
+            this->counters.clear();
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * implicit_topology_telemetry.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Collection of per-phase timings and counters of the implicit topology computation,
+        * written as one JSON object per line for every recorded event. Timings and counters
+        * accumulate until the next record is written.
+        *
+        * @author Alexander Straub
+        */
+        class implicit_topology_telemetry
+        {
+        public:
+            /** Clock providing the time stamp of a record, in seconds */
+            using clock_t = std::function<double()>;
+
+            /**
+            * Timer adding the time between its construction and destruction to a phase
+            */
+            class scoped_timer
+            {
+            public:
+                /**
+                * Start timer
+                *
+                * @param telemetry  Telemetry to which the time is added
+                * @param phase      Name of the phase
+                */
+                scoped_timer(implicit_topology_telemetry& telemetry, const char* phase);
+
+                /**
+                * Stop timer and add the time
+                */
+                ~scoped_timer();
+
+            private:
+                implicit_topology_telemetry& telemetry;
+                const char* phase;
+
+                std::chrono::high_resolution_clock::time_point start;
+            };
+
+            /**
+            * Constructor, creating a disabled telemetry
+            */
+            implicit_topology_telemetry();
+
+            /**
+            * Set output stream and clock, enabling the telemetry if the stream has a buffer
+            *
+            * @param stream     Stream to which records are written as JSON lines
+            * @param clock      Clock for the time stamps; if empty, seconds since this call are used
+            */
+            void set_output(std::ostream& stream, clock_t clock = clock_t());
+
+            /**
+            * Check whether records are written, such that measures only needed for telemetry can be skipped otherwise
+            *
+            * @return True if there is an output stream, false otherwise
+            */
+            bool is_enabled() const;
+
+            /**
+            * Add time to a phase
+            *
+            * @param phase          Name of the phase
+            * @param milliseconds   Time in milliseconds
+            */
+            void add_time(const char* phase, double milliseconds);
+
+            /**
+            * Add to a counter
+            *
+            * @param counter    Name of the counter
+            * @param value      Value to add
+            */
+            void add_count(const char* counter, std::uint64_t value);
+
+            /**
+            * Write a record with the accumulated timings and counters, and reset them afterwards
+            *
+            * @param event      Name of the event
+            */
+            void write_record(const char* event);
+
+        private:
+            /** Output stream; nullptr if disabled */
+            std::ostream* stream;
+
+            /** Clock for time stamps */
+            clock_t clock;
+
+            /** Accumulated timings and counters, ordered for a stable output */
+            std::map<std::string, double> times;
+            std::map<std::string, std::uint64_t> counters;
+        };
+    }
+}
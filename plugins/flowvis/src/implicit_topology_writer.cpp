@@ -1,20 +1,87 @@
 #include "stdafx.h"
 
+#include "implicit_topology_file_format.h"
 #include "implicit_topology_results.h"
 #include "implicit_topology_writer.h"
 
+#include "mmcore/param/EnumParam.h"
+
 #include "vislib/sys/Log.h"
 
+#include "zlib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /** Check if all values are integers that can be represented by the given type */
+    template <typename T>
+    bool is_representable(const megamol::flowvis::chunked_array<float>& data)
+    {
+        for (std::size_t chunk = 0; chunk < data.get_number_of_chunks(); ++chunk)
+        {
+            for (const auto value : data.get_chunk(chunk))
+            {
+                if (!(value >= static_cast<float>(std::numeric_limits<T>::min()) && value <= static_cast<float>(std::numeric_limits<T>::max()))
+                    || value != std::floor(value))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /** Convert values to integers of the given type */
+    template <typename T>
+    void convert_to_integers(const float* values, const std::size_t num_values, char* converted)
+    {
+        for (std::size_t i = 0; i < num_values; ++i)
+        {
+            const auto value = static_cast<T>(values[i]);
+            std::memcpy(converted + i * sizeof(T), &value, sizeof(T));
+        }
+    }
+
+    /** Convert values to half precision */
+    void convert_to_half(const float* values, const std::size_t num_values, char* converted)
+    {
+        for (std::size_t i = 0; i < num_values; ++i)
+        {
+            const auto value = megamol::flowvis::implicit_topology_file_format::float_to_half(values[i]);
+            std::memcpy(converted + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+        }
+    }
+}
 
 namespace megamol
 {
     namespace flowvis
     {
-        implicit_topology_writer::implicit_topology_writer()
+        implicit_topology_writer::implicit_topology_writer() :
+            compression("compression", "Compression of the stored chunks"),
+            distance_precision("distance_precision", "Precision of the stored distances; half precision reduces their size by half at the cost of accuracy")
         {
+            this->compression << new core::param::EnumParam(0);
+            this->compression.Param<core::param::EnumParam>()->SetTypePair(0, "None");
+            this->compression.Param<core::param::EnumParam>()->SetTypePair(1, "zlib");
+            this->MakeSlotAvailable(&this->compression);
+
+            this->distance_precision << new core::param::EnumParam(0);
+            this->distance_precision.Param<core::param::EnumParam>()->SetTypePair(0, "Single");
+            this->distance_precision.Param<core::param::EnumParam>()->SetTypePair(1, "Half");
+            this->MakeSlotAvailable(&this->distance_precision);
         }
 
         implicit_topology_writer::~implicit_topology_writer()
@@ -33,6 +100,8 @@ namespace megamol
 
         bool implicit_topology_writer::write(const std::string& filename, const implicit_topology_results& content)
         {
+            namespace format = implicit_topology_file_format;
+
             // Open output file
             try
             {
@@ -44,38 +113,212 @@ namespace megamol
                     return false;
                 }
 
-                // Gather information for the file header and write it
-                const unsigned int num_particles = static_cast<unsigned int>(content.vertices->size() / 2);
-                const unsigned int num_indices = static_cast<unsigned int>(content.indices->size());
+                // Gather chunks of all arrays, in the order defined by the file format
+                struct array_chunks
+                {
+                    format::array_entry entry;
+                    std::vector<std::pair<const char*, uint64_t>> chunks;
+
+                    /** Chunks converted for compact storage */
+                    std::vector<std::vector<char>> converted;
+                };
+
+                std::vector<array_chunks> arrays(static_cast<std::size_t>(format::array_id::NUM_ARRAYS));
+
+                auto add_array = [&arrays](const format::array_id id, const chunked_array<float>& data)
+                {
+                    auto& array = arrays[static_cast<std::size_t>(id)];
+
+                    for (std::size_t chunk = 0; chunk < data.get_number_of_chunks(); ++chunk)
+                    {
+                        array.chunks.push_back(std::make_pair(reinterpret_cast<const char*>(data.get_chunk(chunk).data()),
+                            static_cast<uint64_t>(data.get_chunk(chunk).size())));
+                    }
+
+                    array.entry.id = static_cast<uint32_t>(id);
+                    array.entry.element_size = sizeof(float);
+                    array.entry.num_elements = data.size();
+                };
+
+                auto add_converted_array = [&arrays](const format::array_id id, const chunked_array<float>& data, const uint32_t element_size,
+                    const std::function<void(const float*, std::size_t, char*)>& convert)
+                {
+                    auto& array = arrays[static_cast<std::size_t>(id)];
+                    array.converted.resize(data.get_number_of_chunks());
+
+                    for (std::size_t chunk = 0; chunk < data.get_number_of_chunks(); ++chunk)
+                    {
+                        const auto& values = data.get_chunk(chunk);
+
+                        array.converted[chunk].resize(values.size() * element_size);
+                        convert(values.data(), values.size(), array.converted[chunk].data());
+
+                        array.chunks.push_back(std::make_pair(array.converted[chunk].data(), static_cast<uint64_t>(values.size())));
+                    }
+
+                    array.entry.id = static_cast<uint32_t>(id);
+                    array.entry.element_size = element_size;
+                    array.entry.num_elements = data.size();
+                };
+
+                // Store labels and reasons for termination as small integers, if they are representable as such
+                auto add_integer_array = [&](const format::array_id id, const chunked_array<float>& data, const bool is_label)
+                {
+                    if (is_label && is_representable<int16_t>(data))
+                    {
+                        add_converted_array(id, data, sizeof(int16_t), convert_to_integers<int16_t>);
+                    }
+                    else if (!is_label && is_representable<int8_t>(data))
+                    {
+                        add_converted_array(id, data, sizeof(int8_t), convert_to_integers<int8_t>);
+                    }
+                    else
+                    {
+                        add_array(id, data);
+                    }
+                };
+
+                // Store distances in the selected precision
+                const bool half_distances = this->distance_precision.Param<core::param::EnumParam>()->Value() == 1;
+
+                auto add_distance_array = [&](const format::array_id id, const chunked_array<float>& data)
+                {
+                    if (half_distances)
+                    {
+                        add_converted_array(id, data, sizeof(uint16_t), convert_to_half);
+                    }
+                    else
+                    {
+                        add_array(id, data);
+                    }
+                };
+
+                add_array(format::array_id::VERTICES, content.vertices);
+                add_array(format::array_id::POSITIONS_FORWARD, content.positions_forward);
+                add_array(format::array_id::POSITIONS_BACKWARD, content.positions_backward);
+                add_integer_array(format::array_id::LABELS_FORWARD, content.labels_forward, true);
+                add_integer_array(format::array_id::LABELS_BACKWARD, content.labels_backward, true);
+                add_distance_array(format::array_id::DISTANCES_FORWARD, content.distances_forward);
+                add_distance_array(format::array_id::DISTANCES_BACKWARD, content.distances_backward);
+                add_integer_array(format::array_id::TERMINATIONS_FORWARD, content.terminations_forward, false);
+                add_integer_array(format::array_id::TERMINATIONS_BACKWARD, content.terminations_backward, false);
+
+                // Split indices into chunks of the same size as the labels
+                {
+                    auto& array = arrays[static_cast<std::size_t>(format::array_id::INDICES)];
+                    const std::size_t chunk_size = static_cast<std::size_t>(1) << implicit_topology_results::chunk_shift;
+
+                    for (std::size_t offset = 0; offset < content.indices->size(); offset += chunk_size)
+                    {
+                        array.chunks.push_back(std::make_pair(reinterpret_cast<const char*>(content.indices->data() + offset),
+                            static_cast<uint64_t>(std::min(chunk_size, content.indices->size() - offset))));
+                    }
+
+                    array.entry.id = static_cast<uint32_t>(format::array_id::INDICES);
+                    array.entry.element_size = sizeof(unsigned int);
+                    array.entry.num_elements = content.indices->size();
+                }
+
+                // Create file header and lay out array and chunk tables
+                format::header header;
+                std::copy(format::magic, format::magic + sizeof(format::magic), header.magic);
+                header.version = format::version;
+                header.num_arrays = static_cast<uint32_t>(arrays.size());
+                header.num_particles = content.vertices.size() / 2;
+                header.num_indices = content.indices->size();
+                header.method = static_cast<uint32_t>(content.computation_state.method);
+                header.num_integration_steps = content.computation_state.num_integration_steps;
+                header.integration_timestep = content.computation_state.integration_timestep;
+                header.max_integration_error = content.computation_state.max_integration_error;
+
+                uint64_t offset = sizeof(format::header) + arrays.size() * sizeof(format::array_entry);
+
+                for (auto& array : arrays)
+                {
+                    array.entry.num_chunks = array.chunks.size();
+                    array.entry.chunk_table_offset = offset;
+
+                    offset += array.chunks.size() * sizeof(format::chunk_entry);
+                }
+
+                // Write header, and reserve space for the tables, which are only complete after writing the chunks
+                ofs.write(reinterpret_cast<const char*>(&header), sizeof(format::header));
+                ofs.write(std::vector<char>(static_cast<std::size_t>(offset - sizeof(format::header)), 0).data(), offset - sizeof(format::header));
 
-                ofs.write(reinterpret_cast<const char*>(&num_particles), sizeof(unsigned int));
-                ofs.write(reinterpret_cast<const char*>(&num_indices), sizeof(unsigned int));
-                ofs.write(reinterpret_cast<const char*>(&content.computation_state.num_integration_steps), sizeof(unsigned int));
-                ofs.write(reinterpret_cast<const char*>(&content.computation_state.integration_timestep), sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(&content.computation_state.max_integration_error), sizeof(float));
+                // Write chunks one after another, aligned for direct access in mapped memory
+                const bool compress = this->compression.Param<core::param::EnumParam>()->Value() == 1;
+                const uint64_t alignment = 8;
 
-                // Write vertices and indices
-                ofs.write(reinterpret_cast<const char*>(content.vertices->data()), content.vertices->size() * sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(content.indices->data()), content.indices->size() * sizeof(unsigned int));
+                std::vector<std::vector<format::chunk_entry>> chunk_tables(arrays.size());
+                std::vector<Bytef> compressed;
 
-                // Write stream line end positions
-                ofs.write(reinterpret_cast<const char*>(content.positions_forward->data()), content.positions_forward->size() * sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(content.positions_backward->data()), content.positions_backward->size() * sizeof(float));
+                for (std::size_t i = 0; i < arrays.size(); ++i)
+                {
+                    for (const auto& chunk : arrays[i].chunks)
+                    {
+                        const uint64_t padding = (alignment - offset % alignment) % alignment;
+
+                        if (padding > 0)
+                        {
+                            ofs.write(std::vector<char>(static_cast<std::size_t>(padding), 0).data(), padding);
+                            offset += padding;
+                        }
+
+                        format::chunk_entry entry;
+                        entry.offset = offset;
+                        entry.num_elements = chunk.second;
+                        entry.compression = static_cast<uint32_t>(format::chunk_compression::UNCOMPRESSED);
+                        entry.reserved = 0;
+
+                        const char* data = chunk.first;
+                        uint64_t size = chunk.second * arrays[i].entry.element_size;
+
+                        // Store compressed data only if it is actually smaller
+                        if (compress && size > 0)
+                        {
+                            uLongf compressed_size = compressBound(static_cast<uLong>(size));
+                            compressed.resize(compressed_size);
 
-                // Write labels
-                ofs.write(reinterpret_cast<const char*>(content.labels_forward->data()), content.labels_forward->size() * sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(content.labels_backward->data()), content.labels_backward->size() * sizeof(float));
+                            if (compress2(compressed.data(), &compressed_size, reinterpret_cast<const Bytef*>(data),
+                                static_cast<uLong>(size), Z_BEST_SPEED) == Z_OK && compressed_size < size)
+                            {
+                                entry.compression = static_cast<uint32_t>(format::chunk_compression::ZLIB);
 
-                // Write distances
-                ofs.write(reinterpret_cast<const char*>(content.distances_forward->data()), content.distances_forward->size() * sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(content.distances_backward->data()), content.distances_backward->size() * sizeof(float));
+                                data = reinterpret_cast<const char*>(compressed.data());
+                                size = compressed_size;
+                            }
+                        }
 
-                // Write reason of termination
-                ofs.write(reinterpret_cast<const char*>(content.terminations_forward->data()), content.terminations_forward->size() * sizeof(float));
-                ofs.write(reinterpret_cast<const char*>(content.terminations_backward->data()), content.terminations_backward->size() * sizeof(float));
+                        entry.stored_size = size;
+
+                        ofs.write(data, size);
+                        offset += size;
+
+                        chunk_tables[i].push_back(entry);
+                    }
+                }
+
+                // Write array and chunk tables
+                ofs.seekp(sizeof(format::header));
+
+                for (const auto& array : arrays)
+                {
+                    ofs.write(reinterpret_cast<const char*>(&array.entry), sizeof(format::array_entry));
+                }
+
+                for (const auto& chunk_table : chunk_tables)
+                {
+                    ofs.write(reinterpret_cast<const char*>(chunk_table.data()), chunk_table.size() * sizeof(format::chunk_entry));
+                }
 
                 // Finish writing
                 ofs.close();
+
+                if (ofs.fail())
+                {
+                    vislib::sys::Log::DefaultLog.WriteWarn("Unable to write all data to implicit topology results file '%s'!", filename.c_str());
+                    return false;
+                }
             }
             catch (const std::exception& e)
             {
@@ -87,4 +330,4 @@ namespace megamol
             return true;
         }
     }
-}
\ No newline at end of file
+}
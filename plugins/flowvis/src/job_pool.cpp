@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "job_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        job_pool::job_pool(const unsigned int num_workers) : token(std::make_shared<token_t>(false)), num_running(0), shutdown(false)
+        {
+            const auto num_threads = num_workers > 0 ? num_workers : std::max(std::thread::hardware_concurrency(), 1u);
+
+            this->workers.reserve(num_threads);
+
+            for (unsigned int i = 0; i < num_threads; ++i)
+            {
+                this->workers.emplace_back(&job_pool::work, this);
+            }
+        }
+
+        job_pool::~job_pool()
+        {
+            {
+                std::lock_guard<std::mutex> locker(this->lock);
+
+                this->token->store(true);
+                this->jobs.clear();
+
+                this->shutdown = true;
+            }
+
+            this->job_available.notify_all();
+
+            for (auto& worker : this->workers)
+            {
+                worker.join();
+            }
+        }
+
+        void job_pool::enqueue(job_t job)
+        {
+            {
+                std::lock_guard<std::mutex> locker(this->lock);
+
+                this->jobs.push_back(std::make_pair(std::move(job), this->token));
+            }
+
+            this->job_available.notify_one();
+        }
+
+        void job_pool::cancel()
+        {
+            {
+                std::lock_guard<std::mutex> locker(this->lock);
+
+                this->token->store(true);
+                this->token = std::make_shared<token_t>(false);
+
+                this->jobs.clear();
+            }
+
+            this->job_finished.notify_all();
+        }
+
+        void job_pool::wait()
+        {
+            std::unique_lock<std::mutex> locker(this->lock);
+
+            this->job_finished.wait(locker, [this]() { return this->jobs.empty() && this->num_running == 0; });
+        }
+
+        std::size_t job_pool::get_num_jobs() const
+        {
+            std::lock_guard<std::mutex> locker(this->lock);
+
+            return this->jobs.size() + this->num_running;
+        }
+
+        void job_pool::work()
+        {
+            std::unique_lock<std::mutex> locker(this->lock);
+
+            while (true)
+            {
+                this->job_available.wait(locker, [this]() { return this->shutdown || !this->jobs.empty(); });
+
+                if (this->shutdown)
+                {
+                    return;
+                }
+
+                auto job = std::move(this->jobs.front());
+                this->jobs.pop_front();
+
+                ++this->num_running;
+
+                // Run job without holding the lock
+                locker.unlock();
+
+                try
+                {
+                    job.first(*job.second);
+                }
+                catch (...)
+                {
+                    // Jobs are responsible for reporting their own errors
+                }
+
+                locker.lock();
+
+                --this->num_running;
+
+                this->job_finished.notify_all();
+            }
+        }
+    }
+}
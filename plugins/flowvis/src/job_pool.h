@@ -0,0 +1,106 @@
+/*
+ * job_pool.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Fixed number of worker threads, processing jobs from a queue in order of submission.
+        * Each job receives the cancellation token that was current when it was submitted;
+        * cancelling sets that token and discards all jobs that did not start yet.
+        *
+        * @author Alexander Straub
+        */
+        class job_pool
+        {
+        public:
+            /** Cancellation token, which running jobs should poll */
+            using token_t = std::atomic<bool>;
+
+            /** Job, getting passed its cancellation token */
+            using job_t = std::function<void(const token_t&)>;
+
+            /**
+            * Constructor, starting the worker threads
+            *
+            * @param num_workers    Number of worker threads; 0 for the number of hardware threads
+            */
+            explicit job_pool(unsigned int num_workers = 0);
+
+            /**
+            * Destructor, cancelling all jobs and waiting for the worker threads to finish
+            */
+            ~job_pool();
+
+            /** No copy */
+            job_pool(const job_pool&) = delete;
+            job_pool& operator=(const job_pool&) = delete;
+
+            /**
+            * Add a job to the queue
+            *
+            * @param job    Job to run on one of the worker threads
+            */
+            void enqueue(job_t job);
+
+            /**
+            * Cancel the running jobs and discard the queued ones; jobs submitted afterwards are not affected
+            */
+            void cancel();
+
+            /**
+            * Wait until all queued and running jobs are finished
+            */
+            void wait();
+
+            /**
+            * Get number of jobs that are queued or running
+            *
+            * @return Number of unfinished jobs
+            */
+            std::size_t get_num_jobs() const;
+
+        private:
+            /**
+            * Main loop of the worker threads
+            */
+            void work();
+
+            /** Queued jobs with their cancellation tokens */
+            std::deque<std::pair<job_t, std::shared_ptr<token_t>>> jobs;
+
+            /** Token for newly submitted jobs */
+            std::shared_ptr<token_t> token;
+
+            /** Number of running jobs */
+            std::size_t num_running;
+
+            /** Synchronization */
+            mutable std::mutex lock;
+            std::condition_variable job_available;
+            std::condition_variable job_finished;
+
+            bool shutdown;
+
+            /** Worker threads */
+            std::vector<std::thread> workers;
+        };
+    }
+}
@@ -0,0 +1,666 @@
+#include "stdafx.h"
+#include "lic_renderer_2d.h"
+
+#include "vector_field_call.h"
+
+#include "flowvis/shader.h"
+
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/TransferFunctionParam.h"
+#include "mmcore/view/CallRender2D.h"
+#include "mmcore/view/MouseFlags.h"
+
+#include "vislib/sys/Log.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        namespace
+        {
+            /** Number of refinement levels for progressive computation of the LIC, each halving the resolution */
+            constexpr int num_progressive_levels = 2;
+        }
+
+        lic_renderer_2d::lic_renderer_2d() :
+            render_input_slot("render_input_slot", "Render input slot"),
+            vector_field_slot("vector_field_slot", "Vector field input"), vector_field_hash(-1),
+            resolution("resolution", "Resolution of the LIC texture along the longer side of the domain"),
+            kernel_length("kernel_length", "Number of integration steps in each direction of the streamlines"),
+            step_size("step_size", "Integration step size, relative to the texel size of the LIC texture"),
+            noise_seed("noise_seed", "Seed for the white noise texture"),
+            animate("animate", "Animate the LIC by periodically shifting the convolution kernel along the streamlines"),
+            animation_speed("animation_speed", "Number of animation periods per second"),
+            progressive("progressive", "Progressively refine the LIC from coarse to full resolution after changes"),
+            contrast("contrast", "Contrast of the LIC"),
+            color_by_magnitude("color_by_magnitude", "Color the LIC by the magnitude of the velocity"),
+            transfer_function("transfer_function", "Transfer function for coloring the velocity magnitude")
+        {
+            // Connect input slots
+            this->render_input_slot.SetCompatibleCall<core::view::CallRender2DDescription>();
+            this->MakeSlotAvailable(&this->render_input_slot);
+
+            this->vector_field_slot.SetCompatibleCall<vector_field_call::vector_field_description>();
+            this->MakeSlotAvailable(&this->vector_field_slot);
+
+            // Connect parameter slots
+            this->resolution << new core::param::IntParam(1024, 16);
+            this->MakeSlotAvailable(&this->resolution);
+
+            this->kernel_length << new core::param::IntParam(20, 1);
+            this->MakeSlotAvailable(&this->kernel_length);
+
+            this->step_size << new core::param::FloatParam(0.5f);
+            this->MakeSlotAvailable(&this->step_size);
+
+            this->noise_seed << new core::param::IntParam(0);
+            this->MakeSlotAvailable(&this->noise_seed);
+
+            this->animate << new core::param::BoolParam(false);
+            this->MakeSlotAvailable(&this->animate);
+
+            this->animation_speed << new core::param::FloatParam(1.0f);
+            this->MakeSlotAvailable(&this->animation_speed);
+
+            this->progressive << new core::param::BoolParam(true);
+            this->MakeSlotAvailable(&this->progressive);
+
+            this->contrast << new core::param::FloatParam(1.0f);
+            this->MakeSlotAvailable(&this->contrast);
+
+            this->color_by_magnitude << new core::param::BoolParam(false);
+            this->MakeSlotAvailable(&this->color_by_magnitude);
+
+            this->transfer_function << new core::param::TransferFunctionParam("");
+            this->MakeSlotAvailable(&this->transfer_function);
+        }
+
+        lic_renderer_2d::~lic_renderer_2d()
+        {
+            this->Release();
+        }
+
+        bool lic_renderer_2d::create()
+        {
+            return true;
+        }
+
+        void lic_renderer_2d::release()
+        {
+            // Remove shaders, buffers, textures and arrays
+            if (this->render_data.initialized)
+            {
+                glDetachShader(this->render_data.lic_prog, this->render_data.lic_vs);
+                glDetachShader(this->render_data.lic_prog, this->render_data.lic_fs);
+                glDeleteProgram(this->render_data.lic_prog);
+
+                glDetachShader(this->render_data.display_prog, this->render_data.display_vs);
+                glDetachShader(this->render_data.display_prog, this->render_data.display_fs);
+                glDeleteProgram(this->render_data.display_prog);
+
+                glDeleteVertexArrays(1, &this->render_data.vao);
+                glDeleteBuffers(1, &this->render_data.vbo);
+
+                glDeleteFramebuffers(1, &this->render_data.fbo);
+
+                glDeleteTextures(1, &this->render_data.vector_field);
+                glDeleteTextures(1, &this->render_data.noise);
+                glDeleteTextures(1, &this->render_data.lic);
+                glDeleteTextures(1, &this->render_data.tf);
+
+                this->render_data.initialized = false;
+            }
+
+            return;
+        }
+
+        bool lic_renderer_2d::initialize()
+        {
+            // Create shaders and link them
+            const std::string lic_vertex_shader =
+                "#version 330 \n" \
+                "layout(location = 1) in vec2 in_texcoords; \n" \
+                "void main() { \n" \
+                "    gl_Position = vec4(2.0f * in_texcoords - 1.0f, 0.0f, 1.0f); \n" \
+                "}";
+
+            const std::string lic_fragment_shader =
+                "#version 330 \n" \
+                "uniform sampler2D vector_field; \n" \
+                "uniform sampler2D noise; \n" \
+                "uniform vec2 field_resolution; \n" \
+                "uniform vec2 domain_size; \n" \
+                "uniform vec2 lic_size; \n" \
+                "uniform float step_length; \n" \
+                "uniform int num_steps; \n" \
+                "uniform int animate; \n" \
+                "uniform float phase; \n" \
+                "out vec2 lic_value; \n" \
+                "vec2 velocity(vec2 position) { \n" \
+                "    return texture(vector_field, (position * (field_resolution - 1.0f) + 0.5f) / field_resolution).xy; \n" \
+                "} \n" \
+                "float weight(float s) { \n" \
+                "    float w = 0.5f + 0.5f * cos(3.14159265f * s / float(num_steps + 1)); \n" \
+                "    return animate != 0 ? w * (1.0f + sin(12.5663706f * s / float(num_steps) - phase)) : w; \n" \
+                "} \n" \
+                "void main() { \n" \
+                "    vec2 start = gl_FragCoord.xy / lic_size; \n" \
+                "    float w = weight(0.0f); \n" \
+                "    float sum = w * texture(noise, start).r; \n" \
+                "    float weights = w; \n" \
+                "    float weights_squared = w * w; \n" \
+                "    for (int direction = -1; direction <= 1; direction += 2) { \n" \
+                "        vec2 position = start; \n" \
+                "        for (int step = 1; step <= num_steps; ++step) { \n" \
+                "            vec2 v = velocity(position); \n" \
+                "            if (length(v) == 0.0f) break; \n" \
+                "            vec2 midpoint = position + 0.5f * float(direction) * step_length * normalize(v) / domain_size; \n" \
+                "            v = velocity(midpoint); \n" \
+                "            if (length(v) == 0.0f) break; \n" \
+                "            position += float(direction) * step_length * normalize(v) / domain_size; \n" \
+                "            if (any(lessThan(position, vec2(0.0f))) || any(greaterThan(position, vec2(1.0f)))) break; \n" \
+                "            w = weight(float(direction * step)); \n" \
+                "            sum += w * texture(noise, position).r; \n" \
+                "            weights += w; \n" \
+                "            weights_squared += w * w; \n" \
+                "        } \n" \
+                "    } \n" \
+                "    float value = (sum / weights - 0.5f) * weights / sqrt(weights_squared) + 0.5f; \n" \
+                "    lic_value = vec2(value, length(velocity(start))); \n" \
+                "}";
+
+            const std::string display_vertex_shader =
+                "#version 330 \n" \
+                "layout(location = 0) in vec2 in_position; \n" \
+                "layout(location = 1) in vec2 in_texcoords; \n" \
+                "uniform mat4 model_view_matrix; \n" \
+                "uniform mat4 projection_matrix; \n" \
+                "out vec2 texcoords; \n" \
+                "void main() { \n" \
+                "    gl_Position = projection_matrix * model_view_matrix * vec4(in_position, 0.0f, 1.0f); \n" \
+                "    texcoords = in_texcoords; \n" \
+                "}";
+
+            const std::string display_fragment_shader =
+                "#version 330 \n" \
+                "uniform sampler2D lic; \n" \
+                "uniform sampler1D transfer_function; \n" \
+                "uniform vec2 lic_extent; \n" \
+                "uniform float contrast; \n" \
+                "uniform float max_magnitude; \n" \
+                "uniform int color_by_magnitude; \n" \
+                "in vec2 texcoords; \n" \
+                "out vec4 fragColor; \n" \
+                "void main() { \n" \
+                "    vec2 value = texture(lic, texcoords * lic_extent).rg; \n" \
+                "    float intensity = clamp((value.r - 0.5f) * contrast + 0.5f, 0.0f, 1.0f); \n" \
+                "    vec3 color = color_by_magnitude != 0 ? " \
+                "        texture(transfer_function, max_magnitude > 0.0f ? value.g / max_magnitude : 0.0f).rgb : vec3(1.0f); \n" \
+                "    fragColor = vec4(intensity * color, 1.0f); \n" \
+                "}";
+
+            try
+            {
+                this->render_data.lic_vs = utility::make_shader(lic_vertex_shader, GL_VERTEX_SHADER);
+                this->render_data.lic_fs = utility::make_shader(lic_fragment_shader, GL_FRAGMENT_SHADER);
+
+                this->render_data.lic_prog = utility::make_program({ this->render_data.lic_vs, this->render_data.lic_fs });
+
+                this->render_data.display_vs = utility::make_shader(display_vertex_shader, GL_VERTEX_SHADER);
+                this->render_data.display_fs = utility::make_shader(display_fragment_shader, GL_FRAGMENT_SHADER);
+
+                this->render_data.display_prog = utility::make_program({ this->render_data.display_vs, this->render_data.display_fs });
+            }
+            catch (const std::exception& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError(e.what());
+
+                return false;
+            }
+
+            // Create array and buffer for the domain quad
+            glGenVertexArrays(1, &this->render_data.vao);
+            glGenBuffers(1, &this->render_data.vbo);
+
+            glBindVertexArray(this->render_data.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, this->render_data.vbo);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<GLvoid*>(2 * sizeof(GLfloat)));
+
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            // Create framebuffer and textures; storage is allocated on first upload
+            glGenFramebuffers(1, &this->render_data.fbo);
+
+            glGenTextures(1, &this->render_data.vector_field);
+            glGenTextures(1, &this->render_data.noise);
+            glGenTextures(1, &this->render_data.lic);
+            glGenTextures(1, &this->render_data.tf);
+
+            this->render_data.field_resolution = { 0, 0 };
+            this->render_data.lic_resolution = { 0, 0 };
+            this->render_data.lic_extent = { 1.0f, 1.0f };
+            this->render_data.max_magnitude = 0.0f;
+            this->render_data.level = 0;
+
+            this->render_data.initialized = true;
+
+            return true;
+        }
+
+        bool lic_renderer_2d::update_vector_field()
+        {
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (vf_call == nullptr || !(*vf_call)(0)) return false;
+
+            if (vf_call->DataHash() == this->vector_field_hash) return true;
+
+            if (vf_call->get_components() != 2 || vf_call->get_vectors() == nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("LIC can only be computed for planar vector fields");
+
+                return false;
+            }
+
+            this->vector_field_hash = vf_call->DataHash();
+
+            const auto& vectors = *vf_call->get_vectors();
+
+            this->domain = vf_call->get_bounding_rectangle();
+            this->render_data.field_resolution = vf_call->get_resolution();
+
+            // Get maximum magnitude for coloring
+            this->render_data.max_magnitude = 0.0f;
+
+            for (std::size_t i = 0; i < vectors.size() / 2; ++i)
+            {
+                this->render_data.max_magnitude = std::max(this->render_data.max_magnitude,
+                    std::sqrt(vectors[i * 2 + 0] * vectors[i * 2 + 0] + vectors[i * 2 + 1] * vectors[i * 2 + 1]));
+            }
+
+            // Upload vector field, interpolating linearly between the grid nodes
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, this->render_data.vector_field);
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, static_cast<GLsizei>(this->render_data.field_resolution[0]),
+                static_cast<GLsizei>(this->render_data.field_resolution[1]), 0, GL_RG, GL_FLOAT, static_cast<const GLvoid*>(vectors.data()));
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            // Update domain quad
+            const std::array<GLfloat, 16> quad = {
+                this->domain.Left(), this->domain.Bottom(), 0.0f, 0.0f,
+                this->domain.Right(), this->domain.Bottom(), 1.0f, 0.0f,
+                this->domain.Left(), this->domain.Top(), 0.0f, 1.0f,
+                this->domain.Right(), this->domain.Top(), 1.0f, 1.0f };
+
+            glBindBuffer(GL_ARRAY_BUFFER, this->render_data.vbo);
+            glBufferData(GL_ARRAY_BUFFER, quad.size() * sizeof(GLfloat), quad.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            // Force reallocation of the LIC texture, as the aspect ratio might have changed
+            this->render_data.lic_resolution = { 0, 0 };
+
+            return true;
+        }
+
+        void lic_renderer_2d::compute_lic(const unsigned int level, const double time)
+        {
+            const auto width = std::max(this->render_data.lic_resolution[0] >> level, 1);
+            const auto height = std::max(this->render_data.lic_resolution[1] >> level, 1);
+
+            this->render_data.lic_extent[0] = static_cast<GLfloat>(width) / this->render_data.lic_resolution[0];
+            this->render_data.lic_extent[1] = static_cast<GLfloat>(height) / this->render_data.lic_resolution[1];
+
+            // Keep the length of the streamlines, but reduce the number of steps for coarser levels
+            const auto num_steps = std::max(this->kernel_length.Param<core::param::IntParam>()->Value() >> level, 1);
+            const auto step_length = this->step_size.Param<core::param::FloatParam>()->Value()
+                * (this->domain.Width() / this->render_data.lic_resolution[0]) * (1 << level);
+
+            const auto phase = static_cast<float>(std::fmod(2.0 * time * this->animation_speed.Param<core::param::FloatParam>()->Value(), 2.0))
+                * 3.14159265f;
+
+            // Save state and render into the LIC texture
+            GLint previous_framebuffer, previous_viewport[4];
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+            glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->render_data.fbo);
+            glViewport(0, 0, width, height);
+
+            glUseProgram(this->render_data.lic_prog);
+            glDisable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+
+            glUniform1i(glGetUniformLocation(this->render_data.lic_prog, "vector_field"), 0);
+            glUniform1i(glGetUniformLocation(this->render_data.lic_prog, "noise"), 1);
+            glUniform2f(glGetUniformLocation(this->render_data.lic_prog, "field_resolution"),
+                static_cast<GLfloat>(this->render_data.field_resolution[0]), static_cast<GLfloat>(this->render_data.field_resolution[1]));
+            glUniform2f(glGetUniformLocation(this->render_data.lic_prog, "domain_size"), this->domain.Width(), this->domain.Height());
+            glUniform2f(glGetUniformLocation(this->render_data.lic_prog, "lic_size"), static_cast<GLfloat>(width), static_cast<GLfloat>(height));
+            glUniform1f(glGetUniformLocation(this->render_data.lic_prog, "step_length"), step_length);
+            glUniform1i(glGetUniformLocation(this->render_data.lic_prog, "num_steps"), num_steps);
+            glUniform1i(glGetUniformLocation(this->render_data.lic_prog, "animate"), this->animate.Param<core::param::BoolParam>()->Value() ? 1 : 0);
+            glUniform1f(glGetUniformLocation(this->render_data.lic_prog, "phase"), phase);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, this->render_data.vector_field);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, this->render_data.noise);
+
+            glBindVertexArray(this->render_data.vao);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            glBindVertexArray(0);
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            glDepthMask(GL_TRUE);
+            glEnable(GL_DEPTH_TEST);
+            glUseProgram(0);
+
+            // Restore state
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previous_framebuffer));
+            glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+        }
+
+        bool lic_renderer_2d::Render(core::view::CallRender2D& call)
+        {
+            // Call input renderer, if connected
+            auto* input_renderer = this->render_input_slot.CallAs<core::view::CallRender2D>();
+
+            if (input_renderer != nullptr && (*input_renderer)(core::view::AbstractCallRender::FnRender))
+            {
+                (*input_renderer) = call;
+            }
+
+            // Initialize renderer by creating shaders, buffers and textures
+            if (!this->render_data.initialized && !initialize())
+            {
+                return false;
+            }
+
+            // Get camera transformation matrices
+            glGetFloatv(GL_MODELVIEW_MATRIX, this->camera.model_view.data());
+            glGetFloatv(GL_PROJECTION_MATRIX, this->camera.projection.data());
+
+            // Update vector field (connection mandatory)
+            const auto previous_hash = this->vector_field_hash;
+
+            if (!update_vector_field()) return false;
+
+            bool restart = this->vector_field_hash != previous_hash;
+
+            // (Re)allocate LIC and noise textures, using square texels on the domain
+            if (this->render_data.lic_resolution[0] == 0 || this->resolution.IsDirty() || this->noise_seed.IsDirty())
+            {
+                this->resolution.ResetDirty();
+                this->noise_seed.ResetDirty();
+
+                const auto resolution = this->resolution.Param<core::param::IntParam>()->Value();
+                const auto aspect_ratio = this->domain.Width() / this->domain.Height();
+
+                this->render_data.lic_resolution[0] = aspect_ratio >= 1.0f ? resolution
+                    : std::max(static_cast<GLsizei>(std::round(resolution * aspect_ratio)), 1);
+                this->render_data.lic_resolution[1] = aspect_ratio >= 1.0f
+                    ? std::max(static_cast<GLsizei>(std::round(resolution / aspect_ratio)), 1) : resolution;
+
+                const auto num_texels = static_cast<std::size_t>(this->render_data.lic_resolution[0]) * this->render_data.lic_resolution[1];
+
+                std::mt19937 generator(static_cast<std::mt19937::result_type>(this->noise_seed.Param<core::param::IntParam>()->Value()));
+                std::uniform_real_distribution<GLfloat> distribution(0.0f, 1.0f);
+
+                std::vector<GLfloat> noise(num_texels);
+                std::generate(noise.begin(), noise.end(), [&generator, &distribution]() { return distribution(generator); });
+
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, this->render_data.noise);
+
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, this->render_data.lic_resolution[0], this->render_data.lic_resolution[1],
+                    0, GL_RED, GL_FLOAT, static_cast<const GLvoid*>(noise.data()));
+
+                glBindTexture(GL_TEXTURE_2D, this->render_data.lic);
+
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, this->render_data.lic_resolution[0], this->render_data.lic_resolution[1],
+                    0, GL_RG, GL_FLOAT, nullptr);
+
+                glBindTexture(GL_TEXTURE_2D, 0);
+
+                glBindFramebuffer(GL_FRAMEBUFFER, this->render_data.fbo);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->render_data.lic, 0);
+
+                if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Unable to create framebuffer for the LIC");
+
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    this->render_data.lic_resolution = { 0, 0 };
+
+                    return false;
+                }
+
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+                restart = true;
+            }
+
+            // Restart computation if any of its parameters changed
+            if (this->kernel_length.IsDirty() || this->step_size.IsDirty() || this->animate.IsDirty() || this->progressive.IsDirty())
+            {
+                this->kernel_length.ResetDirty();
+                this->step_size.ResetDirty();
+                this->animate.ResetDirty();
+                this->progressive.ResetDirty();
+
+                restart = true;
+            }
+
+            if (restart)
+            {
+                this->render_data.level = this->progressive.Param<core::param::BoolParam>()->Value() ? num_progressive_levels : 0;
+            }
+
+            // Compute LIC, refining it over the next frames or recomputing it every frame for animation
+            const bool animated = this->animate.Param<core::param::BoolParam>()->Value();
+
+            if (this->render_data.level >= 0 || animated)
+            {
+                compute_lic(static_cast<unsigned int>(std::max(this->render_data.level, 0)), call.InstanceTime());
+
+                this->render_data.level = std::max(this->render_data.level - 1, -1);
+            }
+
+            // Update transfer function
+            if (this->transfer_function.IsDirty() || restart)
+            {
+                this->transfer_function.ResetDirty();
+
+                std::vector<GLfloat> texture_data;
+                unsigned int texture_size;
+                std::array<float, 2> _unused__texture_range;
+
+                core::param::TransferFunctionParam::TransferFunctionTexture(this->transfer_function.Param<core::param::TransferFunctionParam>()->Value(),
+                    texture_data, texture_size, _unused__texture_range);
+
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_1D, this->render_data.tf);
+
+                glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+                glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, static_cast<GLsizei>(texture_size), 0, GL_RGBA, GL_FLOAT, static_cast<GLvoid*>(texture_data.data()));
+
+                glBindTexture(GL_TEXTURE_1D, 0);
+            }
+
+            // Render LIC onto the domain
+            glUseProgram(this->render_data.display_prog);
+            glDisable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+
+            glUniformMatrix4fv(glGetUniformLocation(this->render_data.display_prog, "model_view_matrix"), 1, GL_FALSE, this->camera.model_view.data());
+            glUniformMatrix4fv(glGetUniformLocation(this->render_data.display_prog, "projection_matrix"), 1, GL_FALSE, this->camera.projection.data());
+
+            glUniform1i(glGetUniformLocation(this->render_data.display_prog, "lic"), 0);
+            glUniform1i(glGetUniformLocation(this->render_data.display_prog, "transfer_function"), 1);
+            glUniform2f(glGetUniformLocation(this->render_data.display_prog, "lic_extent"), this->render_data.lic_extent[0], this->render_data.lic_extent[1]);
+            glUniform1f(glGetUniformLocation(this->render_data.display_prog, "contrast"), this->contrast.Param<core::param::FloatParam>()->Value());
+            glUniform1f(glGetUniformLocation(this->render_data.display_prog, "max_magnitude"), this->render_data.max_magnitude);
+            glUniform1i(glGetUniformLocation(this->render_data.display_prog, "color_by_magnitude"),
+                this->color_by_magnitude.Param<core::param::BoolParam>()->Value() ? 1 : 0);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, this->render_data.lic);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_1D, this->render_data.tf);
+
+            glBindVertexArray(this->render_data.vao);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            glBindVertexArray(0);
+
+            glBindTexture(GL_TEXTURE_1D, 0);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            glDepthMask(GL_TRUE);
+            glEnable(GL_DEPTH_TEST);
+            glUseProgram(0);
+
+            return true;
+        }
+
+        bool lic_renderer_2d::GetExtents(core::view::CallRender2D& call)
+        {
+            // Get and set bounding rectangle (connection mandatory)
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (vf_call == nullptr || !(*vf_call)(1)) return false;
+
+            this->bounds = vf_call->get_bounding_rectangle();
+
+            // Get bounding rectangle of input renderer, if available
+            auto* input_renderer = this->render_input_slot.CallAs<core::view::CallRender2D>();
+
+            if (input_renderer != nullptr && (*input_renderer)(core::view::AbstractCallRender::FnGetExtents))
+            {
+                this->bounds.SetLeft(std::min(this->bounds.Left(), input_renderer->GetBoundingBox().Left()));
+                this->bounds.SetRight(std::max(this->bounds.Right(), input_renderer->GetBoundingBox().Right()));
+                this->bounds.SetBottom(std::min(this->bounds.Bottom(), input_renderer->GetBoundingBox().Bottom()));
+                this->bounds.SetTop(std::max(this->bounds.Top(), input_renderer->GetBoundingBox().Top()));
+            }
+
+            call.SetBoundingBox(this->bounds);
+
+            return true;
+        }
+
+        bool lic_renderer_2d::OnKey(core::view::Key key, core::view::KeyAction action, core::view::Modifiers mods)
+        {
+            auto* input_renderer = this->render_input_slot.template CallAs<core::view::CallRender2D>();
+            if (input_renderer == nullptr) return false;
+
+            core::view::InputEvent evt;
+            evt.tag = core::view::InputEvent::Tag::Key;
+            evt.keyData.key = key;
+            evt.keyData.action = action;
+            evt.keyData.mods = mods;
+
+            input_renderer->SetInputEvent(evt);
+            return (*input_renderer)(core::view::InputCall::FnOnKey);
+        }
+
+        bool lic_renderer_2d::OnChar(unsigned int codePoint)
+        {
+            auto* input_renderer = this->render_input_slot.template CallAs<core::view::CallRender2D>();
+            if (input_renderer == nullptr) return false;
+
+            core::view::InputEvent evt;
+            evt.tag = core::view::InputEvent::Tag::Char;
+            evt.charData.codePoint = codePoint;
+
+            input_renderer->SetInputEvent(evt);
+            return (*input_renderer)(core::view::InputCall::FnOnChar);
+        }
+
+        bool lic_renderer_2d::OnMouseButton(core::view::MouseButton button, core::view::MouseButtonAction action, core::view::Modifiers mods)
+        {
+            auto* input_renderer = this->render_input_slot.template CallAs<core::view::CallRender2D>();
+            if (input_renderer == nullptr) return false;
+
+            core::view::InputEvent evt;
+            evt.tag = core::view::InputEvent::Tag::MouseButton;
+            evt.mouseButtonData.button = button;
+            evt.mouseButtonData.action = action;
+            evt.mouseButtonData.mods = mods;
+
+            input_renderer->SetInputEvent(evt);
+            return (*input_renderer)(core::view::InputCall::FnOnMouseButton);
+        }
+
+        bool lic_renderer_2d::OnMouseMove(double x, double y)
+        {
+            auto* input_renderer = this->render_input_slot.template CallAs<core::view::CallRender2D>();
+            if (input_renderer == nullptr) return false;
+
+            core::view::InputEvent evt;
+            evt.tag = core::view::InputEvent::Tag::MouseMove;
+            evt.mouseMoveData.x = x;
+            evt.mouseMoveData.y = y;
+
+            input_renderer->SetInputEvent(evt);
+            return (*input_renderer)(core::view::InputCall::FnOnMouseMove);
+        }
+
+        bool lic_renderer_2d::OnMouseScroll(double dx, double dy)
+        {
+            auto* input_renderer = this->render_input_slot.template CallAs<core::view::CallRender2D>();
+            if (input_renderer == nullptr) return false;
+
+            core::view::InputEvent evt;
+            evt.tag = core::view::InputEvent::Tag::MouseScroll;
+            evt.mouseScrollData.dx = dx;
+            evt.mouseScrollData.dy = dy;
+
+            input_renderer->SetInputEvent(evt);
+            return (*input_renderer)(core::view::InputCall::FnOnMouseScroll);
+        }
+    }
+}
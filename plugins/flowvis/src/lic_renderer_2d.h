@@ -0,0 +1,213 @@
+/*
+ * lic_renderer_2d.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
+#include "mmcore/view/CallRender2D.h"
+#include "mmcore/view/MouseFlags.h"
+#include "mmcore/view/Renderer2DModule.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include "glad/glad.h"
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Module for rendering a line integral convolution (LIC) of a 2D vector field, providing
+        * dense flow context, e.g., underneath the results of an implicit topology computation.
+        *
+        * The vector field is uploaded as a texture, and a white noise texture is convolved along
+        * the streamlines in a fragment shader, rendering into an offscreen texture which is then
+        * drawn onto the domain. The LIC is only recomputed on changes, refining it progressively
+        * from a coarse to the full resolution over the following frames. For animated LIC, the
+        * convolution kernel is shifted periodically along the streamlines over time instead.
+        *
+        * @author Alexander Straub
+        */
+        class lic_renderer_2d : public core::view::Renderer2DModule
+        {
+            static_assert(std::is_same<GLfloat, float>::value, "'GLfloat' and 'float' must be the same type!");
+
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static inline const char* ClassName() { return "lic_renderer_2d"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static inline const char* Description() { return "Line integral convolution renderer for 2D vector fields"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static inline bool IsAvailable() { return true; }
+
+            /**
+             * Initialises a new instance.
+             */
+            lic_renderer_2d();
+
+            /**
+             * Finalises an instance.
+             */
+            virtual ~lic_renderer_2d();
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+            /**
+             * The render callback.
+             *
+             * @param call The calling call.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool Render(core::view::CallRender2D& call) override;
+
+            /**
+             * The extent callback.
+             *
+             * @param call The calling call.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool GetExtents(core::view::CallRender2D& call) override;
+
+            /**
+            * Forwards key events.
+            */
+            virtual bool OnKey(core::view::Key key, core::view::KeyAction action, core::view::Modifiers mods) override;
+
+            /**
+            * Forwards character events.
+            */
+            virtual bool OnChar(unsigned int codePoint) override;
+
+            /**
+            * Forwards mouse button events.
+            */
+            virtual bool OnMouseButton(core::view::MouseButton button, core::view::MouseButtonAction action, core::view::Modifiers mods) override;
+
+            /**
+            * Forwards mouse move events.
+            */
+            virtual bool OnMouseMove(double x, double y) override;
+
+            /**
+            * Forwards scroll events.
+            */
+            virtual bool OnMouseScroll(double dx, double dy) override;
+
+        private:
+            /**
+            * Initialize shaders, textures and buffers
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool initialize();
+
+            /**
+            * Get the input vector field, uploading it as texture if it changed
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool update_vector_field();
+
+            /**
+            * Compute the LIC at the given refinement level into the offscreen texture
+            *
+            * @param level Refinement level, where level 0 is the full resolution and each
+            *              further level halves the resolution
+            * @param time Instance time for animating the LIC
+            */
+            void compute_lic(unsigned int level, double time);
+
+            /** Input render call */
+            core::CallerSlot render_input_slot;
+
+            /** Input slot for the vector field */
+            core::CallerSlot vector_field_slot;
+            SIZE_T vector_field_hash;
+
+            /** Parameters for the LIC computation */
+            core::param::ParamSlot resolution;
+            core::param::ParamSlot kernel_length;
+            core::param::ParamSlot step_size;
+            core::param::ParamSlot noise_seed;
+
+            /** Parameters for animating the LIC */
+            core::param::ParamSlot animate;
+            core::param::ParamSlot animation_speed;
+
+            /** Parameter for progressive refinement of the LIC */
+            core::param::ParamSlot progressive;
+
+            /** Parameters for the display of the LIC */
+            core::param::ParamSlot contrast;
+            core::param::ParamSlot color_by_magnitude;
+            core::param::ParamSlot transfer_function;
+
+            /** Bounding rectangle of the vector field and the combined one of the input renderer */
+            vislib::math::Rectangle<float> domain, bounds;
+
+            /** Struct for storing data needed for rendering */
+            struct render_data_t
+            {
+                bool initialized = false;
+
+                GLuint lic_vs, lic_fs, lic_prog;
+                GLuint display_vs, display_fs, display_prog;
+                GLuint vao, vbo;
+                GLuint fbo;
+                GLuint vector_field, noise, lic, tf;
+
+                std::array<unsigned int, 2> field_resolution;
+                std::array<GLsizei, 2> lic_resolution;
+                std::array<GLfloat, 2> lic_extent;
+                float max_magnitude;
+
+                /** Current refinement level, where a negative value marks the LIC as up to date */
+                int level;
+
+            } render_data;
+
+            /** Struct for storing data needed for creating transformation matrices */
+            struct camera_t
+            {
+                std::array<GLfloat, 16> model_view, projection;
+
+            } camera;
+        };
+    }
+}
@@ -7,6 +7,7 @@
 
 #include "mmcore/Call.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/IntParam.h"
 #include "mmcore/utility/DataHash.h"
 
 #include "vislib/sys/Log.h"
@@ -14,10 +15,181 @@
 #include "Eigen/Dense"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
+namespace {
+/**
+ * Uniform grid over points, with about two points per cell, for neighbor queries
+ */
+class point_grid {
+public:
+    explicit point_grid(const std::vector<Eigen::Vector2f>& points) : points(points) {
+        this->min = this->max = points.front();
+
+        for (const auto& point : points) {
+            this->min = this->min.cwiseMin(point);
+            this->max = this->max.cwiseMax(point);
+        }
+
+        const Eigen::Vector2f size = (this->max - this->min).cwiseMax(std::numeric_limits<float>::epsilon());
+
+        this->cell_size = std::max(std::sqrt(2.0f * size.prod() / points.size()),
+            std::max(size.x(), size.y()) / static_cast<float>(std::max<std::size_t>(points.size(), 1)));
+
+        this->resolution[0] = std::max(1, static_cast<int>(size.x() / this->cell_size) + 1);
+        this->resolution[1] = std::max(1, static_cast<int>(size.y() / this->cell_size) + 1);
+
+        // Sort points into cells
+        this->offsets.assign(static_cast<std::size_t>(this->resolution[0]) * this->resolution[1] + 1, 0);
+
+        for (const auto& point : points) {
+            ++this->offsets[cell_index(point) + 1];
+        }
+
+        std::partial_sum(this->offsets.begin(), this->offsets.end(), this->offsets.begin());
+
+        auto fill = this->offsets;
+        this->indices.resize(points.size());
+
+        for (std::size_t point_index = 0; point_index < points.size(); ++point_index) {
+            this->indices[fill[cell_index(points[point_index])]++] = static_cast<unsigned int>(point_index);
+        }
+    }
+
+    /**
+     * Find the nearest neighbors of a point
+     *
+     * @param point_index Index of the point
+     * @param k Maximum number of neighbors
+     * @param neighbors Output neighbors, sorted by distance
+     */
+    void nearest(const std::size_t point_index, const std::size_t k, std::vector<unsigned int>& neighbors) const {
+        const auto& point = this->points[point_index];
+        const auto cell = cell_coordinates(point);
+
+        auto& candidates = this->candidates;
+        candidates.clear();
+
+        const int max_ring = std::max(this->resolution[0], this->resolution[1]);
+
+        for (int ring = 0; ring <= max_ring; ++ring) {
+            for (int y = cell[1] - ring; y <= cell[1] + ring; ++y) {
+                for (int x = cell[0] - ring; x <= cell[0] + ring; ++x) {
+                    if ((std::abs(x - cell[0]) != ring && std::abs(y - cell[1]) != ring) || x < 0 || y < 0 ||
+                        x >= this->resolution[0] || y >= this->resolution[1]) {
+                        continue;
+                    }
+
+                    const auto cell_index = static_cast<std::size_t>(y) * this->resolution[0] + x;
+
+                    for (auto i = this->offsets[cell_index]; i < this->offsets[cell_index + 1]; ++i) {
+                        const auto neighbor = this->indices[i];
+
+                        if (neighbor != point_index) {
+                            const float distance = (this->points[neighbor] - point).squaredNorm();
+
+                            candidates.push_back(std::make_pair(distance, neighbor));
+                        }
+                    }
+                }
+            }
+
+            // Points in further rings are at least this far away
+            const float ring_distance = ring * this->cell_size;
+
+            if (candidates.size() >= k) {
+                std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+
+                if (candidates[k - 1].first <= ring_distance * ring_distance) {
+                    break;
+                }
+            }
+        }
+
+        const auto num_neighbors = std::min(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + num_neighbors, candidates.end());
+
+        neighbors.resize(num_neighbors);
+
+        for (std::size_t i = 0; i < num_neighbors; ++i) {
+            neighbors[i] = candidates[i].second;
+        }
+    }
+
+    /**
+     * Compute the position of a point along a Hilbert curve through the grid
+     *
+     * @param point Point
+     *
+     * @return Position along the curve
+     */
+    std::uint64_t hilbert_index(const Eigen::Vector2f& point) const {
+        const std::uint32_t order = 1u << 16;
+        const Eigen::Vector2f relative =
+            (point - this->min).cwiseQuotient((this->max - this->min).cwiseMax(std::numeric_limits<float>::epsilon()));
+
+        std::uint32_t x = static_cast<std::uint32_t>(std::min(std::max(relative.x(), 0.0f), 1.0f) * (order - 1));
+        std::uint32_t y = static_cast<std::uint32_t>(std::min(std::max(relative.y(), 0.0f), 1.0f) * (order - 1));
+
+        std::uint64_t index = 0;
+
+        for (std::uint32_t s = order / 2; s > 0; s /= 2) {
+            const std::uint32_t rx = (x & s) > 0 ? 1 : 0;
+            const std::uint32_t ry = (y & s) > 0 ? 1 : 0;
+
+            index += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+            // Rotate quadrant
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = order - 1 - x;
+                    y = order - 1 - y;
+                }
+
+                std::swap(x, y);
+            }
+        }
+
+        return index;
+    }
+
+private:
+    std::array<int, 2> cell_coordinates(const Eigen::Vector2f& point) const {
+        const Eigen::Vector2f cell = (point - this->min) / this->cell_size;
+
+        return {std::min(std::max(static_cast<int>(cell.x()), 0), this->resolution[0] - 1),
+            std::min(std::max(static_cast<int>(cell.y()), 0), this->resolution[1] - 1)};
+    }
+
+    std::size_t cell_index(const Eigen::Vector2f& point) const {
+        const auto cell = cell_coordinates(point);
+
+        return static_cast<std::size_t>(cell[1]) * this->resolution[0] + cell[0];
+    }
+
+    const std::vector<Eigen::Vector2f>& points;
+
+    Eigen::Vector2f min, max;
+    float cell_size;
+    std::array<int, 2> resolution;
+
+    std::vector<std::size_t> offsets;
+    std::vector<unsigned int> indices;
+
+    static thread_local std::vector<std::pair<float, unsigned int>> candidates;
+};
+
+thread_local std::vector<std::pair<float, unsigned int>> point_grid::candidates;
+} // namespace
+
 namespace megamol {
 namespace flowvis {
 
@@ -25,6 +197,7 @@ line_strip::line_strip()
     : line_strip_slot("line_strip", "Line strip connecting the input points")
     , points_slot("points", "Input points")
     , method("method", "Method for connecting the points")
+    , time_budget("time_budget", "Time budget for improving the line strip by local search, in milliseconds")
     , points_hash(-1)
     , points_changed(false)
     , line_strip_hash(-1) {
@@ -44,7 +217,11 @@ line_strip::line_strip()
     this->method << new core::param::EnumParam(0);
     this->method.Param<core::param::EnumParam>()->SetTypePair(0, "Point order");
     this->method.Param<core::param::EnumParam>()->SetTypePair(1, "Smallest distance (approx. TSP)");
+    this->method.Param<core::param::EnumParam>()->SetTypePair(2, "Smallest distance (approx. TSP, local search)");
     this->MakeSlotAvailable(&this->method);
+
+    this->time_budget << new core::param::IntParam(100, 0);
+    this->MakeSlotAvailable(&this->time_budget);
 }
 
 line_strip::~line_strip() { this->Release(); }
@@ -117,6 +294,220 @@ void line_strip::create_lines_tsp(const std::vector<Eigen::Vector2f>& points) {
     }
 }
 
+void line_strip::create_lines_local_search(const std::vector<Eigen::Vector2f>& points) {
+    // Create an initial tour along a space-filling curve, ...
+    const long long num_points = static_cast<long long>(points.size());
+    const point_grid grid(points);
+
+    std::vector<std::pair<std::uint64_t, unsigned int>> curve(points.size());
+
+#pragma omp parallel for
+    for (long long point_index = 0; point_index < num_points; ++point_index) {
+        curve[point_index] =
+            std::make_pair(grid.hilbert_index(points[point_index]), static_cast<unsigned int>(point_index));
+    }
+
+    std::sort(curve.begin(), curve.end());
+
+    std::vector<unsigned int> tour(points.size());
+    std::vector<unsigned int> position(points.size());
+
+    for (std::size_t i = 0; i < curve.size(); ++i) {
+        tour[i] = curve[i].second;
+        position[curve[i].second] = static_cast<unsigned int>(i);
+    }
+
+    // ... get the nearest neighbors of each point as candidates for new edges, ...
+    const std::size_t num_neighbors = 8;
+
+    std::vector<unsigned int> neighbors(points.size() * num_neighbors);
+    std::vector<unsigned int> neighbor_counts(points.size());
+
+#pragma omp parallel
+    {
+        std::vector<unsigned int> point_neighbors;
+
+#pragma omp for
+        for (long long point_index = 0; point_index < num_points; ++point_index) {
+            grid.nearest(point_index, num_neighbors, point_neighbors);
+
+            std::copy(point_neighbors.begin(), point_neighbors.end(), neighbors.begin() + point_index * num_neighbors);
+            neighbor_counts[point_index] = static_cast<unsigned int>(point_neighbors.size());
+        }
+    }
+
+    // ... and improve the tour by 2-opt moves between neighbors, until no move improves it or time runs out
+    const auto n = points.size();
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(this->time_budget.Param<core::param::IntParam>()->Value());
+
+    auto distance = [&points](const unsigned int i, const unsigned int j) { return (points[i] - points[j]).norm(); };
+    auto next = [&tour, &position, n](const unsigned int i) { return tour[(position[i] + 1) % n]; };
+    auto previous = [&tour, &position, n](const unsigned int i) { return tour[(position[i] + n - 1) % n]; };
+
+    auto reverse = [&tour, &position, n](std::size_t first, std::size_t count) {
+        for (std::size_t last = first + count - 1; first < last; ++first, --last) {
+            std::swap(tour[first % n], tour[last % n]);
+
+            position[tour[first % n]] = static_cast<unsigned int>(first % n);
+            position[tour[last % n]] = static_cast<unsigned int>(last % n);
+        }
+    };
+
+    std::vector<unsigned int> active(tour.begin(), tour.end());
+    std::vector<std::uint8_t> is_active(n, 1);
+
+    std::size_t num_moves = 0;
+    std::size_t num_iterations = 0;
+    bool timed_out = false;
+
+    while (!active.empty() && n > 3 && !timed_out) {
+        if ((++num_iterations & 0xFF) == 0 && std::chrono::steady_clock::now() > deadline) {
+            timed_out = true;
+            continue;
+        }
+
+        const auto a = active.back();
+        active.pop_back();
+        is_active[a] = 0;
+
+        // Replace edges (a, b) and (c, d) by (a, c) and (b, d), where b and d are the successors of a and c, or the
+        // predecessors for the reversed direction; a path between the edges is reversed
+        bool improved = false;
+
+        for (int direction = 0; direction < 2 && !improved; ++direction) {
+            const auto b = direction == 0 ? next(a) : previous(a);
+            const auto length_ab = distance(a, b);
+
+            for (unsigned int neighbor_index = 0; neighbor_index < neighbor_counts[a] && !improved; ++neighbor_index) {
+                const auto c = neighbors[a * num_neighbors + neighbor_index];
+                const auto length_ac = distance(a, c);
+
+                if (length_ac >= length_ab) {
+                    break;
+                }
+
+                const auto d = direction == 0 ? next(c) : previous(c);
+
+                if (c == b || d == a || length_ac + distance(b, d) >= length_ab + distance(c, d) - 1e-6f * length_ab) {
+                    continue;
+                }
+
+                // Reverse the path from b to c, or the complementary path from d to a if it is shorter
+                const auto first = direction == 0 ? b : a;
+                const auto last = direction == 0 ? c : d;
+                const std::size_t length = (position[last] + n - position[first]) % n + 1;
+
+                if (2 * length <= n) {
+                    reverse(position[first], length);
+                } else {
+                    reverse((position[last] + 1) % n, n - length);
+                }
+
+                for (const auto point : {a, b, c, d}) {
+                    if (!is_active[point]) {
+                        is_active[point] = 1;
+                        active.push_back(point);
+                    }
+                }
+
+                ++num_moves;
+                improved = true;
+            }
+        }
+
+        // Move the path of up to three points starting at a between a neighbor c and its successor or predecessor,
+        // rotating it with the shorter path between its old and new place
+        for (std::size_t segment_length = 1; segment_length <= 3 && !improved && n > segment_length + 2;
+             ++segment_length) {
+            const auto s1 = a;
+            const auto s2 = tour[(position[a] + segment_length - 1) % n];
+            const auto p = previous(s1);
+            const auto q = next(s2);
+
+            const auto removal_gain = distance(p, s1) + distance(s2, q) - distance(p, q);
+
+            if (removal_gain <= 0.0f) {
+                continue;
+            }
+
+            for (unsigned int neighbor_index = 0; neighbor_index < neighbor_counts[a] && !improved; ++neighbor_index) {
+                const auto c = neighbors[a * num_neighbors + neighbor_index];
+
+                if (distance(s1, c) >= removal_gain) {
+                    break;
+                }
+
+                if ((position[c] + n - position[s1]) % n < segment_length) {
+                    continue;
+                }
+
+                // Insert between x and its successor y, either as (x, s1, ..., s2, y) or as (x, s2, ..., s1, y)
+                for (int side = 0; side < 2 && !improved; ++side) {
+                    const auto x = side == 0 ? c : previous(c);
+                    const auto y = side == 0 ? next(c) : c;
+                    const bool forward = side == 0;
+
+                    if (x == s2 || y == s1) {
+                        continue;
+                    }
+
+                    const auto insertion_cost = forward ? distance(x, s1) + distance(s2, y) - distance(x, y)
+                                                        : distance(x, s2) + distance(s1, y) - distance(x, y);
+
+                    if (insertion_cost >= removal_gain - 1e-6f * removal_gain) {
+                        continue;
+                    }
+
+                    const std::size_t length_after = (position[x] + n - position[q]) % n + 1;
+                    const std::size_t length_before = (position[p] + n - position[y]) % n + 1;
+                    const std::size_t first = position[s1];
+
+                    if (length_after <= length_before) {
+                        // (s1, ..., s2, q, ..., x) becomes (q, ..., x, s2, ..., s1)
+                        reverse(first, segment_length + length_after);
+                        reverse(first, length_after);
+
+                        if (forward) {
+                            reverse(first + length_after, segment_length);
+                        }
+                    } else {
+                        // (y, ..., p, s1, ..., s2) becomes (s2, ..., s1, y, ..., p)
+                        const std::size_t begin = position[y];
+
+                        reverse(begin, length_before + segment_length);
+                        reverse(begin + segment_length, length_before);
+
+                        if (forward) {
+                            reverse(begin, segment_length);
+                        }
+                    }
+
+                    for (const auto point : {p, q, s1, s2, x, y}) {
+                        if (!is_active[point]) {
+                            is_active[point] = 1;
+                            active.push_back(point);
+                        }
+                    }
+
+                    ++num_moves;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    vislib::sys::Log::DefaultLog.WriteInfo("Improved line strip of %lld points by %zu moves%s", num_points, num_moves,
+        timed_out ? ", time budget exceeded" : "");
+
+    // Output tour
+    this->lines.second.resize(points.size());
+
+    for (std::size_t i = 0; i < tour.size(); ++i) {
+        this->lines.second[i] = points[tour[i]];
+    }
+}
+
 bool line_strip::get_lines_data(core::Call& call) {
     auto& gdc = static_cast<glyph_data_call&>(call);
 
@@ -124,8 +515,9 @@ bool line_strip::get_lines_data(core::Call& call) {
         return false;
     }
 
-    if (this->points_changed || this->method.IsDirty()) {
+    if (this->points_changed || this->method.IsDirty() || this->time_budget.IsDirty()) {
         this->method.ResetDirty();
+        this->time_budget.ResetDirty();
 
         // Connect points
         if (this->points.size() < 2) {
@@ -143,6 +535,9 @@ bool line_strip::get_lines_data(core::Call& call) {
             break;
         case 1:
             create_lines_tsp(points);
+            break;
+        case 2:
+            create_lines_local_search(points);
         }
 
         // Set new hash
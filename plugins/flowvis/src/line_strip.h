@@ -84,6 +84,7 @@ namespace megamol
             /** Create lines using different methods */
             void create_lines_input_order(const std::vector<Eigen::Vector2f>& points);
             void create_lines_tsp(const std::vector<Eigen::Vector2f>& points);
+            void create_lines_local_search(const std::vector<Eigen::Vector2f>& points);
 
             /** Callbacks for the computed seed lines */
             bool get_lines_data(core::Call& call);
@@ -97,6 +98,7 @@ namespace megamol
 
             /** Parameters for defining the method for connection */
             core::param::ParamSlot method;
+            core::param::ParamSlot time_budget;
 
             /** Bounding rectangle */
             vislib::math::Rectangle<float> bounding_rectangle;
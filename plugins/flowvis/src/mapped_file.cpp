@@ -0,0 +1,130 @@
+#include "stdafx.h"
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace megamol
+{
+    namespace flowvis
+    {
+#ifdef _WIN32
+        mapped_file::mapped_file(const std::string& filename) : mapping(nullptr), length(0), file(INVALID_HANDLE_VALUE), file_mapping(nullptr)
+        {
+            this->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            if (this->file == INVALID_HANDLE_VALUE)
+            {
+                throw std::runtime_error("Unable to open file '" + filename + "'");
+            }
+
+            LARGE_INTEGER file_size;
+
+            if (!GetFileSizeEx(this->file, &file_size))
+            {
+                CloseHandle(this->file);
+                throw std::runtime_error("Unable to get size of file '" + filename + "'");
+            }
+
+            this->length = static_cast<std::size_t>(file_size.QuadPart);
+
+            if (this->length > 0)
+            {
+                this->file_mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+                if (this->file_mapping == nullptr)
+                {
+                    CloseHandle(this->file);
+                    throw std::runtime_error("Unable to map file '" + filename + "'");
+                }
+
+                this->mapping = static_cast<const char*>(MapViewOfFile(this->file_mapping, FILE_MAP_READ, 0, 0, 0));
+
+                if (this->mapping == nullptr)
+                {
+                    CloseHandle(this->file_mapping);
+                    CloseHandle(this->file);
+                    throw std::runtime_error("Unable to map file '" + filename + "'");
+                }
+            }
+        }
+
+        mapped_file::~mapped_file()
+        {
+            if (this->mapping != nullptr)
+            {
+                UnmapViewOfFile(this->mapping);
+            }
+
+            if (this->file_mapping != nullptr)
+            {
+                CloseHandle(this->file_mapping);
+            }
+
+            CloseHandle(this->file);
+        }
+#else
+        mapped_file::mapped_file(const std::string& filename) : mapping(nullptr), length(0), file(-1)
+        {
+            this->file = open(filename.c_str(), O_RDONLY);
+
+            if (this->file == -1)
+            {
+                throw std::runtime_error("Unable to open file '" + filename + "'");
+            }
+
+            struct stat file_stat;
+
+            if (fstat(this->file, &file_stat) == -1)
+            {
+                close(this->file);
+                throw std::runtime_error("Unable to get size of file '" + filename + "'");
+            }
+
+            this->length = static_cast<std::size_t>(file_stat.st_size);
+
+            if (this->length > 0)
+            {
+                void* memory = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, this->file, 0);
+
+                if (memory == MAP_FAILED)
+                {
+                    close(this->file);
+                    throw std::runtime_error("Unable to map file '" + filename + "'");
+                }
+
+                this->mapping = static_cast<const char*>(memory);
+            }
+        }
+
+        mapped_file::~mapped_file()
+        {
+            if (this->mapping != nullptr)
+            {
+                munmap(const_cast<char*>(this->mapping), this->length);
+            }
+
+            close(this->file);
+        }
+#endif
+
+        const char* mapped_file::data() const
+        {
+            return this->mapping;
+        }
+
+        std::size_t mapped_file::size() const
+        {
+            return this->length;
+        }
+    }
+}
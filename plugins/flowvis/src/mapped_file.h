@@ -0,0 +1,71 @@
+/*
+ * mapped_file.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Read-only memory mapping of a whole file.
+        * Pages are only loaded by the operating system when accessed.
+        *
+        * @author Alexander Straub
+        */
+        class mapped_file
+        {
+        public:
+            /**
+            * Constructor, mapping the file into memory
+            *
+            * @param filename   Name of the file to map
+            *
+            * @throw std::runtime_error if the file cannot be opened or mapped
+            */
+            explicit mapped_file(const std::string& filename);
+
+            /**
+            * Destructor, unmapping the file
+            */
+            ~mapped_file();
+
+            /** No copies */
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            /**
+            * Get pointer to the mapped memory
+            *
+            * @return Pointer to the first byte of the file, or nullptr for empty files
+            */
+            const char* data() const;
+
+            /**
+            * Get size of the file
+            *
+            * @return Size in bytes
+            */
+            std::size_t size() const;
+
+        private:
+            /** Mapped memory and its size */
+            const char* mapping;
+            std::size_t length;
+
+            /** Native handles */
+#ifdef _WIN32
+            void* file;
+            void* file_mapping;
+#else
+            int file;
+#endif
+        };
+    }
+}
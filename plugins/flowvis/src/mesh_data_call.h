@@ -37,6 +37,9 @@ namespace megamol
                 float min_value, max_value;
 
                 std::shared_ptr<std::vector<float>> data;
+
+                /** Data hash since which values have only been appended, i.e., values of data with this or a later hash are still valid */
+                SIZE_T append_only_since = static_cast<SIZE_T>(-1);
             };
 
             /**
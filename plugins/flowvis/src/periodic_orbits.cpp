@@ -6,6 +6,8 @@
 #include "mouse_click_call.h"
 #include "vector_field_call.h"
 
+#include "../cuda/streamlines.h"
+
 #include "mmcore/Call.h"
 #include "mmcore/DirectDataWriterCall.h"
 #include "mmcore/param/BoolParam.h"
@@ -31,11 +33,14 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <limits>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <ostream>
-#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
@@ -67,10 +72,19 @@ namespace megamol
             output_exit_streamlines("output_exit_streamlines", "Output stream lines from exit search"),
             output_critical_points("output_critical_points", "Also write input critical points to file?"),
             output_critical_points_finished(false),
+            search("search", "Search periodic orbits from a grid of candidates, preselected on the GPU"),
+            candidate_resolution("candidate_resolution", "Number of candidate seeds per direction"),
+            candidate_checks("candidate_checks", "Number of checks for returns of the candidates, the first half approaching their limit sets"),
+            candidate_steps_per_check("candidate_steps_per_check", "Number of integration steps between two checks for returns"),
+            candidate_min_returns("candidate_min_returns", "Minimum number of returns for a candidate to be validated"),
+            candidate_return_radius("candidate_return_radius", "Radius around the previous position, in cell sizes, within which a candidate returned"),
+            max_candidates("max_candidates", "Maximum number of candidates validated on the CPU"),
+            candidate_timestep("candidate_timestep", "Time step factor for the integration of candidates on the GPU"),
+            num_particles_per_batch("num_particles_per_batch", "Number of candidates per batch on the GPU"),
             stop("stop", "Stop the currently running integration processes"),
             reset("reset", "Reset and clear all previous results"),
             output("output", "Output next valid turn"),
-            num_threads(0), terminate(false), output_next(false)
+            resolution{ 0, 0 }, domain{ 0.0f, 0.0f, 0.0f, 0.0f }, num_threads(0), output_next(false)
         {
             // Connect output
             this->glyph_slot.SetCallback(glyph_data_call::ClassName(), glyph_data_call::FunctionName(0), &periodic_orbits::get_glyph_data_callback);
@@ -136,6 +150,34 @@ namespace megamol
             this->output_critical_points << new core::param::BoolParam(false);
             this->MakeSlotAvailable(&this->output_critical_points);
 
+            this->search << new core::param::ButtonParam();
+            this->search.SetUpdateCallback(&periodic_orbits::search_callback);
+            this->MakeSlotAvailable(&this->search);
+
+            this->candidate_resolution << new core::param::IntParam(64, 1);
+            this->MakeSlotAvailable(&this->candidate_resolution);
+
+            this->candidate_checks << new core::param::IntParam(200, 2);
+            this->MakeSlotAvailable(&this->candidate_checks);
+
+            this->candidate_steps_per_check << new core::param::IntParam(10, 1);
+            this->MakeSlotAvailable(&this->candidate_steps_per_check);
+
+            this->candidate_min_returns << new core::param::IntParam(3, 1);
+            this->MakeSlotAvailable(&this->candidate_min_returns);
+
+            this->candidate_return_radius << new core::param::FloatParam(0.5f, 0.0f);
+            this->MakeSlotAvailable(&this->candidate_return_radius);
+
+            this->max_candidates << new core::param::IntParam(32, 1);
+            this->MakeSlotAvailable(&this->max_candidates);
+
+            this->candidate_timestep << new core::param::FloatParam(0.01f, 0.0f);
+            this->MakeSlotAvailable(&this->candidate_timestep);
+
+            this->num_particles_per_batch << new core::param::IntParam(10000, 1);
+            this->MakeSlotAvailable(&this->num_particles_per_batch);
+
             this->stop << new core::param::ButtonParam();
             this->stop.SetUpdateCallback(&periodic_orbits::stop_callback);
             this->MakeSlotAvailable(&this->stop);
@@ -151,12 +193,8 @@ namespace megamol
 
         periodic_orbits::~periodic_orbits()
         {
-            this->terminate = true;
-
-            while (this->num_threads != 0)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+            this->jobs.cancel();
+            this->jobs.wait();
 
             this->Release();
         }
@@ -191,6 +229,13 @@ namespace megamol
                 auto* get_critical_points = this->critical_points_slot.CallAs<glyph_data_call>();
 
                 const bool has_vector_field = get_vector_field != nullptr && (*get_vector_field)(0);
+
+                if (has_vector_field && get_vector_field->get_components() != 2)
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Periodic orbits can only be computed for planar vector fields");
+
+                    return false;
+                }
                 const bool has_critical_points = get_critical_points != nullptr && (*get_critical_points)(0);
                 const bool has_different_input = (get_vector_field->DataHash() != this->vector_field_hash ||
                     get_critical_points->DataHash() != this->critical_points_hash);
@@ -199,7 +244,7 @@ namespace megamol
                 {
                     std::lock_guard<std::mutex> locker(this->lock);
 
-                    if (this->num_threads != 0)
+                    if (this->jobs.get_num_jobs() != 0)
                     {
                         return true;
                     }
@@ -248,9 +293,15 @@ namespace megamol
                         node_coordinates[d][cell_sizes[d].size()] = node_coordinates[d][cell_sizes[d].size() - 1] + cell_sizes[d][cell_sizes[d].size() - 1];
                     }
 
-                    this->grid = tpf::data::grid<double, double, 2, 2>("vector_field", extent, std::move(vectors),
+                    this->grid = std::make_shared<const tpf::data::grid<double, double, 2, 2>>("vector_field", extent, std::move(vectors),
                         std::move(cell_coordinates), std::move(node_coordinates), std::move(cell_sizes));
 
+                    // Keep a single-precision copy for the candidate search on the GPU
+                    this->vectors = std::make_shared<const std::vector<float>>(*get_vector_field->get_vectors());
+                    this->resolution = get_vector_field->get_resolution();
+                    this->domain = { get_vector_field->get_bounding_rectangle().Left(), get_vector_field->get_bounding_rectangle().Bottom(),
+                        get_vector_field->get_bounding_rectangle().Right(), get_vector_field->get_bounding_rectangle().Top() };
+
                     // Reset output
                     this->line_output.clear();
                     this->point_output.clear();
@@ -259,14 +310,17 @@ namespace megamol
                     this->orbit_cells.clear();
 
                     // Store critical points
-                    this->input_critical_points.reserve(critical_points.size());
+                    auto input_critical_points = std::make_shared<std::vector<std::pair<critical_points::type, Eigen::Vector2d>>>();
+                    input_critical_points->reserve(critical_points.size());
 
                     for (const auto& critical_point : critical_points)
                     {
-                        this->input_critical_points.push_back(
+                        input_critical_points->push_back(
                             std::make_pair(static_cast<critical_points::type>(static_cast<int>(critical_point.second)),
                                 Eigen::Vector2d(critical_point.first[0], critical_point.first[1])));
                     }
+
+                    this->input_critical_points = input_critical_points;
                 }
 
                 // Fill glyph call
@@ -275,16 +329,8 @@ namespace megamol
                 if (glyph_call->DataHash() != this->glyph_hash)
                 {
                     glyph_call->clear();
-
-                    for (std::size_t i = 0; i < this->line_output.size(); ++i)
-                    {
-                        glyph_call->add_line(this->line_output[i].second, this->line_output[i].first);
-                    }
-
-                    for (std::size_t i = 0; i < this->point_output.size(); ++i)
-                    {
-                        glyph_call->add_point(this->point_output[i].second, this->point_output[i].first);
-                    }
+                    glyph_call->add_lines(this->line_output);
+                    glyph_call->add_points(this->point_output);
 
                     glyph_call->SetDataHash(this->glyph_hash);
                 }
@@ -311,22 +357,33 @@ namespace megamol
 
             std::lock_guard<std::mutex> locker(this->lock);
 
-            if (get_mouse_coordinates != nullptr && this->grid.get_num_elements() > 0)
+            if (get_mouse_coordinates != nullptr && this->grid != nullptr && this->grid->get_num_elements() > 0)
             {
                 const Eigen::Vector2d seed(get_mouse_coordinates->get_coordinates().first, get_mouse_coordinates->get_coordinates().second);
 
-                // Seed a stream lines
+                // Seed a stream lines, where the jobs share the current vector field and critical points
                 const auto direction = this->integration_direction.Param<core::param::EnumParam>()->Value();
 
+                auto seed_job = [this, seed](const float sign)
+                {
+                    this->jobs.enqueue([this, grid = this->grid, input_critical_points = this->input_critical_points, seed, sign]
+                        (const job_pool::token_t& terminate)
+                        {
+                            extract_periodic_orbit(*grid, *input_critical_points, seed, sign, terminate);
+                        });
+                };
+
                 if (direction == 0 || direction == 1)
                 {
-                    std::thread(&periodic_orbits::extract_periodic_orbit, this, this->grid, this->input_critical_points, seed, 1.0f).detach();
+                    seed_job(1.0f);
                 }
 
                 if (direction == 0 || direction == 2)
                 {
-                    std::thread(&periodic_orbits::extract_periodic_orbit, this, this->grid, this->input_critical_points, seed, -1.0f).detach();
+                    seed_job(-1.0f);
                 }
+
+                vislib::sys::Log::DefaultLog.WriteInfo("Number of queued or running processes: %d", this->jobs.get_num_jobs());
             }
 
             return true;
@@ -342,11 +399,12 @@ namespace megamol
 
                 this->get_output = get_output_cb->GetCallback();
 
-                if (!this->output_critical_points_finished && this->output_critical_points.Param<core::param::BoolParam>()->Value())
+                if (!this->output_critical_points_finished && this->output_critical_points.Param<core::param::BoolParam>()->Value()
+                    && this->input_critical_points != nullptr)
                 {
                     this->get_output() << "# Critical points" << std::endl;
 
-                    for (const auto& critical_point : this->input_critical_points)
+                    for (const auto& critical_point : *this->input_critical_points)
                     {
                         this->get_output() << critical_point.second[0] << "," << critical_point.second[1] << std::endl;
                     }
@@ -364,7 +422,7 @@ namespace megamol
         {
             std::lock_guard<std::mutex> locker(this->lock);
 
-            this->terminate = true;
+            this->jobs.cancel();
 
             return true;
         }
@@ -373,6 +431,8 @@ namespace megamol
         {
             std::lock_guard<std::mutex> locker(this->lock);
 
+            this->jobs.cancel();
+
             this->line_output.clear();
             this->point_output.clear();
             ++this->glyph_hash;
@@ -393,8 +453,274 @@ namespace megamol
             return true;
         }
 
+        bool periodic_orbits::search_callback(core::param::ParamSlot&)
+        {
+            std::lock_guard<std::mutex> locker(this->lock);
+
+            if (this->grid == nullptr || this->vectors == nullptr || this->input_critical_points == nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("Cannot search for periodic orbits without vector field and critical points");
+
+                return true;
+            }
+
+            if (streamlines_cuda::get_number_of_available_devices() == 0)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Cannot search for periodic orbits: no CUDA device available");
+
+                return true;
+            }
+
+            // Get parameters, where the integration parameters of the GPU match those of the individual seeds
+            candidate_parameter_t parameter;
+            parameter.seed_resolution = static_cast<unsigned int>(this->candidate_resolution.Param<core::param::IntParam>()->Value());
+            parameter.num_checks = static_cast<unsigned int>(this->candidate_checks.Param<core::param::IntParam>()->Value());
+            parameter.steps_per_check = static_cast<unsigned int>(this->candidate_steps_per_check.Param<core::param::IntParam>()->Value());
+            parameter.min_returns = static_cast<unsigned int>(this->candidate_min_returns.Param<core::param::IntParam>()->Value());
+            parameter.max_candidates = static_cast<unsigned int>(this->max_candidates.Param<core::param::IntParam>()->Value());
+            parameter.num_particles_per_batch = static_cast<unsigned int>(this->num_particles_per_batch.Param<core::param::IntParam>()->Value());
+            parameter.return_radius = this->candidate_return_radius.Param<core::param::FloatParam>()->Value();
+            parameter.direction = this->integration_direction.Param<core::param::EnumParam>()->Value();
+
+            parameter.method = this->integration_method.Param<core::param::EnumParam>()->Value() == static_cast<int>(integration_parameter_t::method_t::RUNGE_KUTTA_4)
+                ? streamlines_cuda::integration_method::RUNGE_KUTTA_4 : streamlines_cuda::integration_method::RUNGE_KUTTA_4_5;
+            parameter.timestep = this->candidate_timestep.Param<core::param::FloatParam>()->Value();
+            parameter.maximum_error = this->maximum_error.Param<core::param::FloatParam>()->Value();
+
+            this->jobs.enqueue([this, grid = this->grid, vectors = this->vectors, resolution = this->resolution, domain = this->domain,
+                input_critical_points = this->input_critical_points, parameter](const job_pool::token_t& terminate)
+                {
+                    search_candidates(grid, *vectors, resolution, domain, input_critical_points, parameter, terminate);
+                });
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Number of queued or running processes: %d", this->jobs.get_num_jobs());
+
+            return true;
+        }
+
+        void periodic_orbits::search_candidates(std::shared_ptr<const tpf::data::grid<double, double, 2, 2>> grid, const std::vector<float>& vectors,
+            const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+            std::shared_ptr<const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>> input_critical_points,
+            const candidate_parameter_t& parameter, const job_pool::token_t& terminate)
+        {
+            // State of the candidates advected in one direction
+            struct candidates_t
+            {
+                float sign;
+
+                std::vector<float> positions, labels, distances, terminations;
+
+                std::vector<Eigen::Vector2f> anchors;
+                std::vector<std::uint8_t> left_anchor;
+                std::vector<unsigned int> returns;
+                std::vector<std::vector<std::size_t>> visited_cells;
+            };
+
+            const float cell_width = (domain[2] - domain[0]) / (resolution[0] - 1);
+            const float cell_height = (domain[3] - domain[1]) / (resolution[1] - 1);
+            const float radius = parameter.return_radius * std::min(cell_width, cell_height);
+
+            const auto get_cell = [&](const float x, const float y) -> std::size_t
+            {
+                const auto cell_x = static_cast<std::size_t>(std::min(std::max((x - domain[0]) / cell_width, 0.0f), static_cast<float>(resolution[0] - 2)));
+                const auto cell_y = static_cast<std::size_t>(std::min(std::max((y - domain[1]) / cell_height, 0.0f), static_cast<float>(resolution[1] - 2)));
+
+                return cell_y * (resolution[0] - 1) + cell_x;
+            };
+
+            try
+            {
+                // Terminate candidates at critical points, as they cannot be part of a periodic orbit
+                std::vector<float> points;
+                std::vector<int> point_ids;
+
+                points.reserve(2 * input_critical_points->size());
+                point_ids.reserve(input_critical_points->size());
+
+                for (const auto& critical_point : *input_critical_points)
+                {
+                    points.push_back(static_cast<float>(critical_point.second[0]));
+                    points.push_back(static_cast<float>(critical_point.second[1]));
+                    point_ids.push_back(static_cast<int>(point_ids.size()));
+                }
+
+                streamlines_cuda integrator(resolution, domain, vectors, points, point_ids, std::vector<float>(), std::vector<int>(),
+                    parameter.timestep, parameter.maximum_error, parameter.method);
+
+                integrator.set_convergence_criteria(radius, 0, 0.0f);
+
+                // Seed candidates at the centers of a regular grid, for each direction of integration
+                const std::size_t num_seeds = static_cast<std::size_t>(parameter.seed_resolution) * parameter.seed_resolution;
+
+                std::vector<candidates_t> candidates;
+
+                if (parameter.direction == 0 || parameter.direction == 1) candidates.push_back(candidates_t{ 1.0f });
+                if (parameter.direction == 0 || parameter.direction == 2) candidates.push_back(candidates_t{ -1.0f });
+
+                for (auto& direction : candidates)
+                {
+                    direction.positions.resize(2 * num_seeds);
+                    direction.labels.resize(num_seeds, -1.0f);
+                    direction.distances.resize(num_seeds, std::numeric_limits<float>::max());
+                    direction.terminations.resize(num_seeds, 0.0f);
+
+                    direction.anchors.resize(num_seeds);
+                    direction.left_anchor.resize(num_seeds, 0);
+                    direction.returns.resize(num_seeds, 0);
+                    direction.visited_cells.resize(num_seeds);
+
+                    for (std::size_t j = 0; j < parameter.seed_resolution; ++j)
+                    {
+                        for (std::size_t i = 0; i < parameter.seed_resolution; ++i)
+                        {
+                            const auto index = j * parameter.seed_resolution + i;
+
+                            direction.positions[2 * index + 0] = domain[0] + (i + 0.5f) * (domain[2] - domain[0]) / parameter.seed_resolution;
+                            direction.positions[2 * index + 1] = domain[1] + (j + 0.5f) * (domain[3] - domain[1]) / parameter.seed_resolution;
+                        }
+                    }
+                }
+
+                // Advect all candidates in chunks, recording a return each time a candidate comes back within the radius of its anchor
+                // after having left it; the anchors are set after the first half of the checks, and follow the candidates on return
+                const auto first_check = parameter.num_checks / 2;
+
+                for (unsigned int check = 0; check < parameter.num_checks && !terminate; ++check)
+                {
+                    if (candidates.size() == 2)
+                    {
+                        integrator.update_labels_bidirectional(candidates[0].positions, candidates[0].labels, candidates[0].distances,
+                            candidates[0].terminations, candidates[1].positions, candidates[1].labels, candidates[1].distances,
+                            candidates[1].terminations, parameter.steps_per_check, check == 0, parameter.num_particles_per_batch);
+                    }
+                    else
+                    {
+                        integrator.update_labels(candidates[0].positions, candidates[0].labels, candidates[0].distances, candidates[0].terminations,
+                            parameter.steps_per_check, candidates[0].sign, parameter.num_particles_per_batch);
+                    }
+
+                    if (check < first_check)
+                    {
+                        continue;
+                    }
+
+                    for (auto& direction : candidates)
+                    {
+                        #pragma omp parallel for
+                        for (long long i = 0; i < static_cast<long long>(num_seeds); ++i)
+                        {
+                            if (direction.terminations[i] != 0.0f)
+                            {
+                                continue;
+                            }
+
+                            const Eigen::Vector2f position(direction.positions[2 * i + 0], direction.positions[2 * i + 1]);
+
+                            if (check == first_check)
+                            {
+                                direction.anchors[i] = position;
+                            }
+                            else
+                            {
+                                const float distance = (position - direction.anchors[i]).norm();
+
+                                if (distance > 2.0f * radius)
+                                {
+                                    direction.left_anchor[i] = 1;
+                                }
+                                else if (direction.left_anchor[i] && distance < radius)
+                                {
+                                    direction.anchors[i] = position;
+                                    direction.left_anchor[i] = 0;
+                                    ++direction.returns[i];
+                                }
+                            }
+
+                            const auto cell = get_cell(position[0], position[1]);
+
+                            if (direction.visited_cells[i].empty() || direction.visited_cells[i].back() != cell)
+                            {
+                                direction.visited_cells[i].push_back(cell);
+                            }
+                        }
+                    }
+                }
+
+                if (terminate)
+                {
+                    return;
+                }
+
+                // Select candidates with the most returns, skipping those on the path of an already selected candidate
+                std::size_t num_returned = 0, num_selected = 0;
+
+                for (const auto& direction : candidates)
+                {
+                    std::vector<std::size_t> order;
+
+                    for (std::size_t i = 0; i < num_seeds; ++i)
+                    {
+                        if (direction.terminations[i] == 0.0f && direction.returns[i] >= parameter.min_returns)
+                        {
+                            order.push_back(i);
+                        }
+                    }
+
+                    num_returned += order.size();
+
+                    std::stable_sort(order.begin(), order.end(),
+                        [&direction](const std::size_t lhs, const std::size_t rhs) { return direction.returns[lhs] > direction.returns[rhs]; });
+
+                    std::unordered_set<std::size_t> covered_cells;
+
+                    for (std::size_t i = 0; i < order.size() && num_selected < parameter.max_candidates; ++i)
+                    {
+                        const auto candidate = order[i];
+
+                        const Eigen::Vector2d seed(direction.positions[2 * candidate + 0], direction.positions[2 * candidate + 1]);
+
+                        if (covered_cells.find(get_cell(static_cast<float>(seed[0]), static_cast<float>(seed[1]))) != covered_cells.end())
+                        {
+                            continue;
+                        }
+
+                        // Cover the neighborhood of the path, as the checks can skip cells
+                        for (const auto cell : direction.visited_cells[candidate])
+                        {
+                            const auto cell_x = static_cast<long long>(cell % (resolution[0] - 1));
+                            const auto cell_y = static_cast<long long>(cell / (resolution[0] - 1));
+
+                            for (long long y = std::max(cell_y - 1, 0LL); y <= std::min(cell_y + 1, static_cast<long long>(resolution[1]) - 2); ++y)
+                            {
+                                for (long long x = std::max(cell_x - 1, 0LL); x <= std::min(cell_x + 1, static_cast<long long>(resolution[0]) - 2); ++x)
+                                {
+                                    covered_cells.insert(static_cast<std::size_t>(y * (resolution[0] - 1) + x));
+                                }
+                            }
+                        }
+
+                        // Validate the candidate exactly on the CPU
+                        this->jobs.enqueue([this, grid, input_critical_points, seed, sign = direction.sign](const job_pool::token_t& terminate)
+                            {
+                                extract_periodic_orbit(*grid, *input_critical_points, seed, sign, terminate);
+                            });
+
+                        ++num_selected;
+                    }
+                }
+
+                vislib::sys::Log::DefaultLog.WriteInfo("Periodic orbit candidates: %d of %d seeds returned, %d queued for validation",
+                    static_cast<int>(num_returned), static_cast<int>(num_seeds * candidates.size()), static_cast<int>(num_selected));
+            }
+            catch (const std::exception& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Error searching periodic orbit candidates: %s", e.what());
+            }
+        }
+
         void periodic_orbits::extract_periodic_orbit(const tpf::data::grid<double, double, 2, 2>& grid,
-            const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points, const Eigen::Vector2d& seed, const float sign)
+            const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points, const Eigen::Vector2d& seed, const float sign,
+            const job_pool::token_t& terminate)
         {
             try
             {
@@ -421,8 +747,6 @@ namespace megamol
                 {
                     std::lock_guard<std::mutex> locker(this->lock);
 
-                    this->terminate = false;
-
                     vislib::sys::Log::DefaultLog.WriteInfo("Number of processes running: %d", ++this->num_threads);
 
                     vislib::sys::Log::DefaultLog.WriteInfo("Starting %s stream line at [%.5f, %.5f]", (sign < 0.0f) ? "backward" : "forward", seed[0], seed[1]);
@@ -456,12 +780,12 @@ namespace megamol
                 bool has_exit = true;
                 bool output_now = false;
 
-                while (has_exit && !this->terminate)
+                while (has_exit && !terminate)
                 {
                     // Find turn
-                    const auto visited_cells = find_turn(grid, input_critical_points, position, integration, critical_point_detection);
+                    const auto visited_cells = find_turn(grid, input_critical_points, position, integration, critical_point_detection, terminate);
 
-                    if (!this->terminate)
+                    if (!terminate)
                     {
                         if (visited_cells && !visited_cells->first.empty())
                         {
@@ -562,7 +886,7 @@ namespace megamol
                                         Eigen::Vector2d possible_exit = *possible_exit_it;
 
                                         integration.sign *= -1.0f;
-                                        const auto exit = find_exits(grid, possible_exit, integration, visited_cells->first);
+                                        const auto exit = find_exits(grid, possible_exit, integration, visited_cells->first, terminate);
                                         integration.sign *= -1.0f;
 
                                         has_exit = exit.first;
@@ -601,7 +925,7 @@ namespace megamol
                                 }
 
                                 // Add list of cells to already extracted periodic orbits
-                                if (!has_exit && !this->terminate && unique_detection)
+                                if (!has_exit && !terminate && unique_detection)
                                 {
                                     std::lock_guard<std::mutex> locker(this->lock);
 
@@ -640,7 +964,7 @@ namespace megamol
                     }
                 }
 
-                if (!this->terminate)
+                if (!terminate)
                 {
                     // Use Poincar map for finding the closed stream line
                     if (!output_exit_streamline)
@@ -832,7 +1156,8 @@ namespace megamol
         tpf::utility::optional<std::pair<std::list<periodic_orbits::coords_t>, std::list<periodic_orbits::kernel::Point_2>>>
             periodic_orbits::find_turn(const tpf::data::grid<double, double, 2, 2>& grid,
                 const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points,
-                Eigen::Vector2d& position, integration_parameter_t& integration_param, const bool critical_point_detection) const
+                Eigen::Vector2d& position, integration_parameter_t& integration_param, const bool critical_point_detection,
+                const job_pool::token_t& terminate) const
         {
             // Initialize cell list
             std::list<coords_t> visited_cells;
@@ -843,7 +1168,7 @@ namespace megamol
 
             bool found_turn = false;
 
-            while (!found_turn && !this->terminate)
+            while (!found_turn && !terminate)
             {
                 const auto old_position = position;
 
@@ -1003,7 +1328,8 @@ namespace megamol
         }
 
         std::pair<bool, std::vector<Eigen::Vector2d>> periodic_orbits::find_exits(const tpf::data::grid<double, double, 2, 2>& grid,
-            Eigen::Vector2d& position, integration_parameter_t& integration_param, const std::list<coords_t>& comparison) const
+            Eigen::Vector2d& position, integration_parameter_t& integration_param, const std::list<coords_t>& comparison,
+            const job_pool::token_t& terminate) const
         {
             // Initialize comparison
             std::vector<Eigen::Vector2d> streamline;
@@ -1034,7 +1360,7 @@ namespace megamol
             // Advect stream line while it corresponds to the input list of cells
             bool first_cell = true;
 
-            while (!this->terminate)
+            while (!terminate)
             {
                 const auto old_position = position;
 
@@ -7,6 +7,9 @@
 #pragma once
 
 #include "critical_points.h"
+#include "job_pool.h"
+
+#include "../cuda/streamlines.h"
 
 #include "mmcore/Call.h"
 #include "mmcore/CalleeSlot.h"
@@ -22,8 +25,10 @@
 
 #include "Eigen/Dense"
 
+#include <array>
 #include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <set>
@@ -38,6 +43,10 @@ namespace megamol
         /**
         * Module for computing periodic orbits of a vector field.
         *
+        * Periodic orbits are either searched from seeds provided by mouse clicks, or automatically from a dense grid
+        * of candidate seeds. For the latter, all candidates are advected on the GPU, recording when they return close
+        * to a previous position, and only those repeatedly returning go through the exact validation on the CPU.
+        *
         * @author Alexander Straub
         */
         class periodic_orbits : public core::Module
@@ -118,6 +127,23 @@ namespace megamol
                 } param;
             };
 
+            /** Struct transporting the parameters for the automatic candidate search */
+            struct candidate_parameter_t
+            {
+                unsigned int seed_resolution;
+                unsigned int num_checks;
+                unsigned int steps_per_check;
+                unsigned int min_returns;
+                unsigned int max_candidates;
+                unsigned int num_particles_per_batch;
+                float return_radius;
+                int direction;
+
+                streamlines_cuda::integration_method method;
+                float timestep;
+                float maximum_error;
+            };
+
             /**
             * Extract periodic orbits.
             *
@@ -125,9 +151,28 @@ namespace megamol
             * @param input_critical_points Critical points
             * @param seed Seed of the stream line used to find the periodic orbit
             * @param sign Direction of integration
+            * @param terminate Cancellation token, set when the computation should be stopped
             */
             void extract_periodic_orbit(const tpf::data::grid<double, double, 2, 2>& grid,
-                const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points, const Eigen::Vector2d& seed, float sign);
+                const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points, const Eigen::Vector2d& seed, float sign,
+                const job_pool::token_t& terminate);
+
+            /**
+            * Search candidates for periodic orbits by advecting a grid of seeds on the GPU, and queue the extraction of
+            * periodic orbits for the candidates which repeatedly returned close to a previous position.
+            *
+            * @param grid Vector field for the extraction
+            * @param vectors Vector field for the GPU integration
+            * @param resolution Resolution of the vector field
+            * @param domain Domain of the vector field (minimum x, minimum y, maximum x, maximum y)
+            * @param input_critical_points Critical points, at which candidates are terminated
+            * @param parameter Parameters of the candidate search
+            * @param terminate Cancellation token, set when the computation should be stopped
+            */
+            void search_candidates(std::shared_ptr<const tpf::data::grid<double, double, 2, 2>> grid, const std::vector<float>& vectors,
+                const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+                std::shared_ptr<const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>> input_critical_points,
+                const candidate_parameter_t& parameter, const job_pool::token_t& terminate);
 
             /**
             * Advect using the predefined method
@@ -173,12 +218,13 @@ namespace megamol
             * @param position Original/Output position
             * @param integration_parameter Parameter for time step control
             * @param critical_point_detection Detect critical points
+            * @param terminate Cancellation token, set when the computation should be stopped
             *
             * @return List of coordinates, defining a turn
             */
             tpf::utility::optional<std::pair<std::list<coords_t>, std::list<kernel::Point_2>>> find_turn(const tpf::data::grid<double, double, 2, 2>& grid,
                 const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>& input_critical_points, Eigen::Vector2d& position,
-                integration_parameter_t& integration_parameter, bool critical_point_detection) const;
+                integration_parameter_t& integration_parameter, bool critical_point_detection, const job_pool::token_t& terminate) const;
 
             /**
             * Validate a previous turn
@@ -200,11 +246,12 @@ namespace megamol
             * @param position Original/Output position
             * @param integration_parameter Parameter for time step control
             * @param comparison List of cells to compare with
+            * @param terminate Cancellation token, set when the computation should be stopped
             *
             * @return True: valid, false otherwise
             */
             std::pair<bool, std::vector<Eigen::Vector2d>> find_exits(const tpf::data::grid<double, double, 2, 2>& grid, Eigen::Vector2d& position,
-                integration_parameter_t& integration_parameter, const std::list<coords_t>& comparison) const;
+                integration_parameter_t& integration_parameter, const std::list<coords_t>& comparison, const job_pool::token_t& terminate) const;
 
             /**
             * Get intermediate cells
@@ -271,6 +318,7 @@ namespace megamol
             bool stop_callback(core::param::ParamSlot&);
             bool reset_callback(core::param::ParamSlot&);
             bool output_callback(core::param::ParamSlot&);
+            bool search_callback(core::param::ParamSlot&);
 
             /** Output slot for the glyphs */
             core::CalleeSlot glyph_slot;
@@ -320,23 +368,41 @@ namespace megamol
             core::param::ParamSlot output_critical_points;
             bool output_critical_points_finished;
 
+            /** Parameters for the automatic search of candidates on the GPU */
+            core::param::ParamSlot search;
+            core::param::ParamSlot candidate_resolution;
+            core::param::ParamSlot candidate_checks;
+            core::param::ParamSlot candidate_steps_per_check;
+            core::param::ParamSlot candidate_min_returns;
+            core::param::ParamSlot candidate_return_radius;
+            core::param::ParamSlot max_candidates;
+            core::param::ParamSlot candidate_timestep;
+            core::param::ParamSlot num_particles_per_batch;
+
             /** Parameter for stopping and resetting the computation */
             core::param::ParamSlot stop;
             core::param::ParamSlot reset;
             core::param::ParamSlot output;
 
-            /** Stored vector field */
-            tpf::data::grid<double, double, 2, 2> grid;
+            /** Stored vector field, shared read-only with the running jobs */
+            std::shared_ptr<const tpf::data::grid<double, double, 2, 2>> grid;
+
+            /** Stored vector field in single precision for the GPU, shared read-only with the candidate search */
+            std::shared_ptr<const std::vector<float>> vectors;
+            std::array<unsigned int, 2> resolution;
+            std::array<float, 4> domain;
 
-            /** Stored critical points */
-            std::vector<std::pair<critical_points::type, Eigen::Vector2d>> input_critical_points;
+            /** Stored critical points, shared read-only with the running jobs */
+            std::shared_ptr<const std::vector<std::pair<critical_points::type, Eigen::Vector2d>>> input_critical_points;
 
             /** Mutex for synchronization */
             std::mutex lock;
             std::size_t num_threads;
 
-            bool terminate;
             bool output_next;
+
+            /** Worker threads for the extraction of periodic orbits, cancelled on stop and reset */
+            job_pool jobs;
         };
     }
 }
\ No newline at end of file
@@ -28,12 +28,197 @@
 #include "tpf/data/tpf_grid_information.h"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
+namespace {
+/**
+ * Axis-aligned bounding box of a quad, spanned by two neighboring points before and after advection
+ */
+struct quad_bounds {
+    Eigen::Vector3f min, max;
+
+    bool overlaps(const quad_bounds& other) const {
+        return (this->min.array() <= other.max.array()).all() && (other.min.array() <= this->max.array()).all();
+    }
+};
+
+/**
+ * Compute the bounding boxes of all quads of a triangle strip
+ *
+ * @param previous_points One side of the triangle strip
+ * @param advected_points Other side of the triangle strip
+ *
+ * @return Bounding box per quad
+ */
+std::vector<quad_bounds> compute_quad_bounds(
+    const std::vector<Eigen::Vector3f>& previous_points, const std::vector<Eigen::Vector3f>& advected_points) {
+
+    std::vector<quad_bounds> bounds(previous_points.size() - 1);
+
+    for (std::size_t point_index = 0; point_index < bounds.size(); ++point_index) {
+        bounds[point_index].min = previous_points[point_index]
+                                      .cwiseMin(previous_points[point_index + 1])
+                                      .cwiseMin(advected_points[point_index])
+                                      .cwiseMin(advected_points[point_index + 1]);
+        bounds[point_index].max = previous_points[point_index]
+                                      .cwiseMax(previous_points[point_index + 1])
+                                      .cwiseMax(advected_points[point_index])
+                                      .cwiseMax(advected_points[point_index + 1]);
+    }
+
+    return bounds;
+}
+
+/**
+ * Uniform grid in the xy-plane over the quads of a triangle strip, for finding quads with overlapping bounding boxes
+ */
+class quad_grid {
+public:
+    /**
+     * Create grid with a cell size about the average quad extent
+     *
+     * @param bounds Bounding boxes of the quads
+     */
+    explicit quad_grid(const std::vector<quad_bounds>& bounds) : resolution{0, 0} {
+        if (bounds.empty()) {
+            return;
+        }
+
+        this->domain = bounds.front();
+
+        Eigen::Vector2f average_extent(0.0f, 0.0f);
+
+        for (const auto& quad : bounds) {
+            this->domain.min = this->domain.min.cwiseMin(quad.min);
+            this->domain.max = this->domain.max.cwiseMax(quad.max);
+
+            average_extent += (quad.max - quad.min).head<2>();
+        }
+
+        average_extent /= static_cast<float>(bounds.size());
+
+        const int max_resolution = 1024;
+
+        for (int d = 0; d < 2; ++d) {
+            const auto extent = this->domain.max[d] - this->domain.min[d];
+
+            this->resolution[d] = (average_extent[d] > 0.0f)
+                                      ? std::min(std::max(static_cast<int>(extent / average_extent[d]), 1), max_resolution)
+                                      : 1;
+            this->cell_size[d] = std::max(extent / this->resolution[d], std::numeric_limits<float>::min());
+        }
+
+        // Sort quads into all cells they overlap
+        this->cell_offsets.assign(static_cast<std::size_t>(this->resolution[0]) * this->resolution[1] + 1, 0);
+
+        for (int pass = 0; pass < 2; ++pass) {
+            std::vector<std::size_t> cell_fill;
+
+            if (pass == 1) {
+                for (std::size_t i = 1; i < this->cell_offsets.size(); ++i) {
+                    this->cell_offsets[i] += this->cell_offsets[i - 1];
+                }
+
+                this->cell_items.resize(this->cell_offsets.back());
+                cell_fill.assign(this->cell_offsets.begin(), this->cell_offsets.end() - 1);
+            }
+
+            for (std::size_t quad_index = 0; quad_index < bounds.size(); ++quad_index) {
+                const auto cells = get_cells(bounds[quad_index]);
+
+                for (int y = cells[1]; y <= cells[3]; ++y) {
+                    for (int x = cells[0]; x <= cells[2]; ++x) {
+                        const auto cell = static_cast<std::size_t>(y) * this->resolution[0] + x;
+
+                        if (pass == 0) {
+                            ++this->cell_offsets[cell + 1];
+                        } else {
+                            this->cell_items[cell_fill[cell]++] = quad_index;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Find quads whose bounding boxes overlap the given one
+     *
+     * @param query Bounding box to test against
+     * @param bounds Bounding boxes of the quads, as used for creating the grid
+     * @param quads Output indices of the overlapping quads in ascending order
+     */
+    void find_overlapping(
+        const quad_bounds& query, const std::vector<quad_bounds>& bounds, std::vector<std::size_t>& quads) const {
+
+        quads.clear();
+
+        if (this->resolution[0] == 0 || !this->domain.overlaps(query)) {
+            return;
+        }
+
+        const auto cells = get_cells(query);
+
+        for (int y = cells[1]; y <= cells[3]; ++y) {
+            for (int x = cells[0]; x <= cells[2]; ++x) {
+                const auto cell = static_cast<std::size_t>(y) * this->resolution[0] + x;
+
+                for (auto i = this->cell_offsets[cell]; i < this->cell_offsets[cell + 1]; ++i) {
+                    if (bounds[this->cell_items[i]].overlaps(query)) {
+                        quads.push_back(this->cell_items[i]);
+                    }
+                }
+            }
+        }
+
+        std::sort(quads.begin(), quads.end());
+        quads.erase(std::unique(quads.begin(), quads.end()), quads.end());
+    }
+
+private:
+    /**
+     * Get range of cells overlapped by a bounding box, clamped to the grid
+     *
+     * @param bounds Bounding box
+     *
+     * @return First and last cell in x and y direction: [x_first, y_first, x_last, y_last]
+     */
+    std::array<int, 4> get_cells(const quad_bounds& bounds) const {
+        std::array<int, 4> cells;
+
+        for (int d = 0; d < 2; ++d) {
+            auto to_cell = [this, d](const float value) {
+                return std::min(std::max(static_cast<int>(std::floor((value - this->domain.min[d]) / this->cell_size[d])), 0),
+                    this->resolution[d] - 1);
+            };
+
+            cells[d] = to_cell(bounds.min[d]);
+            cells[d + 2] = to_cell(bounds.max[d]);
+        }
+
+        return cells;
+    }
+
+    /** Bounding box of all quads */
+    quad_bounds domain;
+
+    /** Number of cells per direction and their size */
+    std::array<int, 2> resolution;
+    std::array<float, 2> cell_size;
+
+    /** Offsets into the quads per cell, with an additional end offset, and quads sorted by cell */
+    std::vector<std::size_t> cell_offsets;
+    std::vector<std::size_t> cell_items;
+};
+} // namespace
+
 namespace megamol {
 namespace flowvis {
 
@@ -168,6 +353,12 @@ bool periodic_orbits_theisel::get_input_data() {
         return false;
     }
 
+    if (vfc.get_components() != 2) {
+        vislib::sys::Log::DefaultLog.WriteError("Periodic orbits can only be computed for planar vector fields");
+
+        return false;
+    }
+
     if (vfc.DataHash() != this->vector_field_hash) {
         this->resolution = vfc.get_resolution();
         this->grid_positions = vfc.get_positions();
@@ -380,12 +571,14 @@ bool periodic_orbits_theisel::compute_periodic_orbits() {
             advected_backward_points.reserve(num_seed_points);
 
             for (std::size_t integration = 0; integration < num_integration_steps; ++integration) {
-                // Advect forward stream surface
-                advected_forward_points.clear();
-
-                for (std::size_t point_index = 0; point_index < previous_forward_points.size(); ++point_index) {
-                    advected_forward_points.push_back(advect_point(
-                        vector_field, previous_forward_points[point_index], forward_timesteps[point_index], true));
+                // Advect forward stream surface, where the seed points are independent of each other
+                advected_forward_points.resize(previous_forward_points.size());
+
+#pragma omp parallel for
+                for (long long point_index = 0; point_index < static_cast<long long>(previous_forward_points.size());
+                     ++point_index) {
+                    advected_forward_points[point_index] = advect_point(
+                        vector_field, previous_forward_points[point_index], forward_timesteps[point_index], true);
                 }
 
                 forward_points.insert(forward_points.end(), advected_forward_points.begin(), advected_forward_points.end());
@@ -420,11 +613,13 @@ bool periodic_orbits_theisel::compute_periodic_orbits() {
                 std::swap(previous_forward_points, advected_forward_points);
 
                 // Advect backward stream surface
-                advected_backward_points.clear();
+                advected_backward_points.resize(previous_backward_points.size());
 
-                for (std::size_t point_index = 0; point_index < previous_backward_points.size(); ++point_index) {
-                    advected_backward_points.push_back(advect_point(
-                        vector_field, previous_backward_points[point_index], backward_timesteps[point_index], false));
+#pragma omp parallel for
+                for (long long point_index = 0; point_index < static_cast<long long>(previous_backward_points.size());
+                     ++point_index) {
+                    advected_backward_points[point_index] = advect_point(
+                        vector_field, previous_backward_points[point_index], backward_timesteps[point_index], false);
                 }
 
                 backward_points.insert(backward_points.end(), advected_backward_points.begin(), advected_backward_points.end());
@@ -680,7 +875,27 @@ std::vector<std::tuple<Eigen::Vector2f, std::size_t, std::size_t>> periodic_orbi
 
     std::vector<std::tuple<Eigen::Vector2f, std::size_t, std::size_t>> intersections;
 
+    if (num_seed_points < 2 || previous_backward_points.size() != num_seed_points ||
+        advected_forward_points.size() != num_seed_points || advected_backward_points.size() != num_seed_points) {
+
+        return intersections;
+    }
+
+    // Broad phase: only test quads of the triangle strips whose bounding boxes overlap
+    const auto forward_bounds = compute_quad_bounds(previous_forward_points, advected_forward_points);
+    const auto backward_bounds = compute_quad_bounds(previous_backward_points, advected_backward_points);
+
+    const quad_grid backward_grid(backward_bounds);
+
+    std::vector<std::size_t> candidates;
+
     for (std::size_t fwd_point_index = 0; fwd_point_index < num_seed_points - 1; ++fwd_point_index) {
+        backward_grid.find_overlapping(forward_bounds[fwd_point_index], backward_bounds, candidates);
+
+        if (candidates.empty()) {
+            continue;
+        }
+
         const kernel_t::Point_3 fwd_point_1(previous_forward_points[fwd_point_index][0],
             previous_forward_points[fwd_point_index][1], previous_forward_points[fwd_point_index][2]);
         const kernel_t::Point_3 fwd_point_2(previous_forward_points[fwd_point_index + 1][0],
@@ -693,7 +908,8 @@ std::vector<std::tuple<Eigen::Vector2f, std::size_t, std::size_t>> periodic_orbi
         const kernel_t::Triangle_3 fwd_triangle_1(fwd_point_1, fwd_point_3, fwd_point_4);
         const kernel_t::Triangle_3 fwd_triangle_2(fwd_point_1, fwd_point_4, fwd_point_2);
 
-        for (std::size_t bwd_point_index = 0; bwd_point_index < num_seed_points - 1; ++bwd_point_index) {
+        // Narrow phase: exact test in order of the backward quads
+        for (const auto bwd_point_index : candidates) {
             const kernel_t::Point_3 bwd_point_1(previous_backward_points[bwd_point_index][0],
                 previous_backward_points[bwd_point_index][1], previous_backward_points[bwd_point_index][2]);
             const kernel_t::Point_3 bwd_point_2(previous_backward_points[bwd_point_index + 1][0],
@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "quadtree.h"
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        quadtree::quadtree(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain)
+            : resolution(resolution), domain(domain)
+        {
+            const auto num_cells_x = resolution[0] > 1 ? resolution[0] - 1 : 1;
+            const auto num_cells_y = resolution[1] > 1 ? resolution[1] - 1 : 1;
+
+            this->lattice_size[0] = (domain[2] - domain[0]) / (num_cells_x * static_cast<float>(1u << max_level));
+            this->lattice_size[1] = (domain[3] - domain[1]) / (num_cells_y * static_cast<float>(1u << max_level));
+
+            // Grid points, in the same order as the seeds of the grid
+            this->points.reserve(static_cast<std::size_t>(resolution[0]) * resolution[1]);
+
+            for (std::uint32_t y = 0; y < resolution[1]; ++y)
+            {
+                for (std::uint32_t x = 0; x < resolution[0]; ++x)
+                {
+                    this->points.emplace(key(x << max_level, y << max_level), this->points.size());
+                }
+            }
+
+            // Grid cells as roots
+            if (resolution[0] > 1 && resolution[1] > 1)
+            {
+                this->leaves.reserve(static_cast<std::size_t>(num_cells_x) * num_cells_y);
+
+                for (std::uint32_t y = 0; y < num_cells_y; ++y)
+                {
+                    for (std::uint32_t x = 0; x < num_cells_x; ++x)
+                    {
+                        this->leaves.push_back(cell_t{ x << max_level, y << max_level, 0 });
+                    }
+                }
+            }
+        }
+
+        std::size_t quadtree::get_number_of_points() const
+        {
+            return this->points.size();
+        }
+
+        std::size_t quadtree::get_number_of_leaves() const
+        {
+            return this->leaves.size();
+        }
+
+        void quadtree::get_boundary(const std::size_t leaf, std::vector<std::size_t>& boundary, std::array<std::size_t, 4>& corners) const
+        {
+            const auto& cell = this->leaves[leaf];
+            const std::uint32_t size = 1u << (max_level - cell.level);
+
+            const std::array<std::array<std::uint32_t, 2>, 4> corner_positions = {
+                std::array<std::uint32_t, 2>{ cell.x, cell.y }, std::array<std::uint32_t, 2>{ cell.x + size, cell.y },
+                std::array<std::uint32_t, 2>{ cell.x + size, cell.y + size }, std::array<std::uint32_t, 2>{ cell.x, cell.y + size } };
+
+            boundary.clear();
+
+            for (std::size_t corner = 0; corner < 4; ++corner)
+            {
+                const auto& from = corner_positions[corner];
+                const auto& to = corner_positions[(corner + 1) % 4];
+
+                corners[corner] = boundary.size();
+                boundary.push_back(this->points.at(key(from[0], from[1])));
+
+                get_edge_points(from[0], from[1], to[0], to[1], boundary);
+            }
+        }
+
+        float quadtree::get_size(const std::size_t leaf) const
+        {
+            const auto size = static_cast<float>(1u << (max_level - this->leaves[leaf].level));
+
+            return size * std::max(std::abs(this->lattice_size[0]), std::abs(this->lattice_size[1]));
+        }
+
+        std::vector<GLfloat> quadtree::subdivide(const std::vector<std::size_t>& leaves)
+        {
+            std::vector<GLfloat> positions;
+            positions.reserve(leaves.size() * 5 * 2);
+
+            for (const auto leaf : leaves)
+            {
+                const auto cell = this->leaves[leaf];
+
+                if (cell.level == max_level)
+                {
+                    continue;
+                }
+
+                const std::uint32_t size = 1u << (max_level - cell.level);
+                const std::uint32_t half = size / 2;
+
+                // Edge midpoints, which might already exist as hanging points, and the center
+                add_point(cell.x + half, cell.y, positions);
+                add_point(cell.x + size, cell.y + half, positions);
+                add_point(cell.x + half, cell.y + size, positions);
+                add_point(cell.x, cell.y + half, positions);
+                add_point(cell.x + half, cell.y + half, positions);
+
+                // Children
+                const auto level = cell.level + 1;
+
+                this->leaves[leaf] = cell_t{ cell.x, cell.y, level };
+                this->leaves.push_back(cell_t{ cell.x + half, cell.y, level });
+                this->leaves.push_back(cell_t{ cell.x + half, cell.y + half, level });
+                this->leaves.push_back(cell_t{ cell.x, cell.y + half, level });
+            }
+
+            if (!positions.empty())
+            {
+                this->indices = nullptr;
+            }
+
+            return positions;
+        }
+
+        std::shared_ptr<std::vector<GLuint>> quadtree::export_indices() const
+        {
+            if (this->indices != nullptr)
+            {
+                return this->indices;
+            }
+
+            // Number of boundary segments on each edge of a leaf
+            auto get_edge_lengths = [](const std::vector<std::size_t>& boundary, const std::array<std::size_t, 4>& corners)
+            {
+                return std::array<std::size_t, 4>{ corners[1] - corners[0], corners[2] - corners[1],
+                    corners[3] - corners[2], boundary.size() - corners[3] };
+            };
+
+            // Count the triangles of each leaf's fan, which has a triangle for each boundary segment not incident to
+            // the fan center, ...
+            std::vector<std::size_t> offsets(this->leaves.size() + 1, 0);
+            std::vector<std::size_t> centers(this->leaves.size());
+
+            #pragma omp parallel
+            {
+                std::vector<std::size_t> boundary;
+                std::array<std::size_t, 4> corners;
+
+                #pragma omp for
+                for (long long leaf = 0; leaf < static_cast<long long>(this->leaves.size()); ++leaf)
+                {
+                    get_boundary(static_cast<std::size_t>(leaf), boundary, corners);
+
+                    const auto edge_lengths = get_edge_lengths(boundary, corners);
+
+                    std::size_t num_triangles = 0;
+
+                    for (std::size_t corner = 0; corner < 4; ++corner)
+                    {
+                        const auto corner_triangles = boundary.size() - edge_lengths[corner] - edge_lengths[(corner + 3) % 4];
+
+                        if (corner_triangles > num_triangles)
+                        {
+                            centers[leaf] = corner;
+                            num_triangles = corner_triangles;
+                        }
+                    }
+
+                    offsets[leaf + 1] = num_triangles;
+                }
+            }
+
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            // ... and create them
+            auto indices = std::make_shared<std::vector<GLuint>>(3 * offsets.back());
+
+            #pragma omp parallel
+            {
+                std::vector<std::size_t> boundary;
+                std::array<std::size_t, 4> corners;
+
+                #pragma omp for
+                for (long long leaf = 0; leaf < static_cast<long long>(this->leaves.size()); ++leaf)
+                {
+                    get_boundary(static_cast<std::size_t>(leaf), boundary, corners);
+
+                    const auto edge_lengths = get_edge_lengths(boundary, corners);
+
+                    const auto num_points = boundary.size();
+                    const auto corner = centers[leaf];
+                    const auto start = corners[corner];
+
+                    auto index = 3 * offsets[leaf];
+
+                    for (auto i = edge_lengths[corner]; i < num_points - edge_lengths[(corner + 3) % 4]; ++i)
+                    {
+                        (*indices)[index++] = static_cast<GLuint>(boundary[start]);
+                        (*indices)[index++] = static_cast<GLuint>(boundary[(start + i) % num_points]);
+                        (*indices)[index++] = static_cast<GLuint>(boundary[(start + i + 1) % num_points]);
+                    }
+                }
+            }
+
+            this->indices = indices;
+
+            return this->indices;
+        }
+
+        std::uint64_t quadtree::key(const std::uint32_t x, const std::uint32_t y)
+        {
+            return (static_cast<std::uint64_t>(x) << 32) | y;
+        }
+
+        void quadtree::get_edge_points(const std::uint32_t x0, const std::uint32_t y0, const std::uint32_t x1, const std::uint32_t y1,
+            std::vector<std::size_t>& points) const
+        {
+            // Points on an edge only exist at midpoints of existing points, as they are created by subdivision
+            if (std::max(x0, x1) - std::min(x0, x1) + std::max(y0, y1) - std::min(y0, y1) < 2)
+            {
+                return;
+            }
+
+            const std::uint32_t x = (x0 + x1) / 2;
+            const std::uint32_t y = (y0 + y1) / 2;
+
+            const auto point = this->points.find(key(x, y));
+
+            if (point != this->points.end())
+            {
+                get_edge_points(x0, y0, x, y, points);
+                points.push_back(point->second);
+                get_edge_points(x, y, x1, y1, points);
+            }
+        }
+
+        void quadtree::add_point(const std::uint32_t x, const std::uint32_t y, std::vector<GLfloat>& positions)
+        {
+            if (this->points.emplace(key(x, y), this->points.size()).second)
+            {
+                positions.push_back(this->domain[0] + x * this->lattice_size[0]);
+                positions.push_back(this->domain[1] + y * this->lattice_size[1]);
+            }
+        }
+    }
+}
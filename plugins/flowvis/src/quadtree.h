@@ -0,0 +1,146 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Quadtree over the cells of a uniform grid, for adaptive refinement of seed points.
+        *
+        * The tree is stored implicitly as a flat array of its leaves, each given by the integer coordinates of
+        * its lower left corner on a lattice with 2^max_level subdivisions per grid cell, and its level. Points are
+        * shared between neighboring leaves, and indexed in the order of their creation, starting with the grid
+        * points in row-major order. Neighboring leaves may differ in size, such that a leaf edge can contain
+        * additional (hanging) points, which are considered for refinement and triangulation.
+        */
+        class quadtree
+        {
+        public:
+            /** Maximum number of subdivisions of a grid cell */
+            static constexpr unsigned int max_level = 16;
+
+            /**
+            * Constructor
+            *
+            * @param resolution Number of grid points in x and y direction
+            * @param domain Domain of the grid (minimum x, minimum y, maximum x, maximum y)
+            */
+            quadtree(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain);
+
+            /**
+            * Get number of points
+            *
+            * @return Number of points
+            */
+            std::size_t get_number_of_points() const;
+
+            /**
+            * Get number of leaves
+            *
+            * @return Number of leaves
+            */
+            std::size_t get_number_of_leaves() const;
+
+            /**
+            * Get the point indices on the boundary of a leaf in counter-clockwise order, starting at its lower left
+            * corner. Thread-safe, as long as the tree is not subdivided at the same time.
+            *
+            * @param leaf Index of the leaf
+            * @param boundary Point indices, including hanging points
+            * @param corners Positions of the four corners within the boundary
+            */
+            void get_boundary(std::size_t leaf, std::vector<std::size_t>& boundary, std::array<std::size_t, 4>& corners) const;
+
+            /**
+            * Get the edge length of a leaf, which is the larger one of the grid cell sizes, scaled to the leaf level
+            *
+            * @param leaf Index of the leaf
+            *
+            * @return Edge length
+            */
+            float get_size(std::size_t leaf) const;
+
+            /**
+            * Subdivide leaves, which are replaced by their four children. Leaves on the maximum level are skipped.
+            * The children of the first leaf take its place, while all other children are appended.
+            *
+            * @param leaves Indices of the leaves to subdivide, which must not contain duplicates
+            *
+            * @return Positions of the newly created points
+            */
+            std::vector<GLfloat> subdivide(const std::vector<std::size_t>& leaves);
+
+            /**
+            * Triangulate all leaves in parallel, fanning out from the corner with the fewest hanging points on its
+            * edges. The indices are only created once after each subdivision, and shared afterwards; they must not
+            * be modified.
+            *
+            * @return Indices of the triangle vertices
+            */
+            std::shared_ptr<std::vector<GLuint>> export_indices() const;
+
+        private:
+            /** Leaf, given by its lower left corner on the lattice and its level */
+            struct cell_t
+            {
+                std::uint32_t x, y;
+                std::uint32_t level;
+            };
+
+            /**
+            * Get the key of a lattice position
+            *
+            * @param x Lattice x coordinate
+            * @param y Lattice y coordinate
+            *
+            * @return Key for the point map
+            */
+            static std::uint64_t key(std::uint32_t x, std::uint32_t y);
+
+            /**
+            * Append all points between two points of an edge, not including these, in order
+            *
+            * @param x0 Lattice x coordinate of the first point
+            * @param y0 Lattice y coordinate of the first point
+            * @param x1 Lattice x coordinate of the second point
+            * @param y1 Lattice y coordinate of the second point
+            * @param points Point indices
+            */
+            void get_edge_points(std::uint32_t x0, std::uint32_t y0, std::uint32_t x1, std::uint32_t y1,
+                std::vector<std::size_t>& points) const;
+
+            /**
+            * Get the index of the point at the given lattice position, creating it if necessary
+            *
+            * @param x Lattice x coordinate
+            * @param y Lattice y coordinate
+            * @param positions Positions of newly created points
+            */
+            void add_point(std::uint32_t x, std::uint32_t y, std::vector<GLfloat>& positions);
+
+            // Grid information
+            const std::array<unsigned int, 2> resolution;
+            const std::array<float, 4> domain;
+
+            // Size of a lattice unit
+            std::array<float, 2> lattice_size;
+
+            // Leaves of the tree
+            std::vector<cell_t> leaves;
+
+            // Point indices by their lattice position
+            std::unordered_map<std::uint64_t, std::size_t> points;
+
+            // Triangle indices, created on demand
+            mutable std::shared_ptr<std::vector<GLuint>> indices;
+        };
+    }
+}
@@ -20,56 +20,10 @@
 #include "vislib/sys/FastFile.h"
 #include "vislib/sys/Log.h"
 
-#include "png.h"
-
 #include <array>
 #include <memory>
 #include <vector>
 
-namespace {
-/**
- * My error handling function for png export
- *
- * @param pngPtr The png structure pointer
- * @param msg The error message
- */
-static void PNGAPI myPngError(png_structp pngPtr, png_const_charp msg) {
-    vislib::sys::Log::DefaultLog.WriteError("%s", msg);
-}
-
-/**
- * My error handling function for png export
- *
- * @param pngPtr The png structure pointer
- * @param msg The error message
- */
-static void PNGAPI myPngWarn(png_structp pngPtr, png_const_charp msg) {
-    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Png-Warning: %s\n", msg);
-}
-
-/**
- * My write function for png export
- *
- * @param pngPtr The png structure pointer
- * @param buf The pointer to the buffer to be written
- * @param size The number of bytes to be written
- */
-static void PNGAPI myPngWrite(png_structp pngPtr, png_bytep buf, png_size_t size) {
-    vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
-    f->Write(buf, size);
-}
-
-/**
- * My flush function for png export
- *
- * @param pngPtr The png structure pointer
- */
-static void PNGAPI myPngFlush(png_structp pngPtr) {
-    vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
-    f->Flush();
-}
-} // namespace
-
 namespace megamol {
 namespace flowvis {
 
@@ -84,7 +38,8 @@ render_to_file::render_to_file(void)
     , fbo_height("height", "Output height")
     , fbo_viewport("viewport", "Viewport options to set viewport of file output")
     , output_file("output_file", "Output file path")
-    , trigger("trigger", "Write the rendering to file") {
+    , trigger("trigger", "Write the rendering to file")
+    , exporter() {
 
     this->viewSlot.SetCompatibleCall<core::view::CallRenderViewDescription>();
     this->MakeSlotAvailable(&this->viewSlot);
@@ -153,6 +108,9 @@ void render_to_file::DeserialiseCamera(vislib::Serialiser& serialiser) {
  * render_to_file::Render
  */
 void render_to_file::Render(const mmcRenderViewContext& context) {
+    // Hand finished read-backs of recorded frames to the encoder
+    this->exporter.Poll();
+
     auto* view = this->viewSlot.CallAs<core::view::CallRenderView>();
 
     if (view != nullptr) {
@@ -271,65 +229,15 @@ bool render_to_file::record(core::param::ParamSlot&) {
     // Restore state
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
 
-    // Download texture data
-    static_assert(sizeof(GLubyte) == sizeof(uint8_t) && sizeof(uint8_t) == sizeof(png_byte), "Mismatching data types");
-
-    std::vector<uint8_t> buffer(static_cast<std::size_t>(fbo_width) * fbo_height * 4 * sizeof(GLubyte));
-
-    fbo.BindColourTexture(0);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Save to file
-    vislib::sys::FastFile file;
-
-    if (!file.Open(output_file.PeekBuffer(), vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE,
-            vislib::sys::File::CREATE_OVERWRITE)) {
-        vislib::sys::Log::DefaultLog.WriteError("Cannot open output file");
-        return false;
-    }
-
-    auto png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, &myPngError, &myPngWarn);
-    if (png_ptr == nullptr) {
-        vislib::sys::Log::DefaultLog.WriteError("Cannot create png structure");
-        return false;
-    }
-
-    auto png_info_ptr = png_create_info_struct(png_ptr);
-    if (png_info_ptr == nullptr) {
-        vislib::sys::Log::DefaultLog.WriteError("Cannot create png info");
-        return false;
-    }
-
-    png_set_write_fn(png_ptr, static_cast<void*>(&file), &myPngWrite, &myPngFlush);
-    png_set_IHDR(png_ptr, png_info_ptr, fbo_width, fbo_height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-        PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-
-    try {
-        std::vector<uint8_t*> rows(fbo_height);
-
-        for (std::size_t i = 0; i < rows.size(); ++i) {
-            rows[rows.size() - (1 + i)] = buffer.data() + sizeof(uint8_t) * i * 4 * fbo_width;
-        }
-
-        png_set_rows(png_ptr, png_info_ptr, rows.data());
-        png_write_png(png_ptr, png_info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
-    } catch (...) {
+    // Read back and save to file, which finishes in the background
+    if (!this->exporter.Export(fbo, vislib::StringA(output_file).PeekBuffer(), true)) {
         vislib::sys::Log::DefaultLog.WriteError("Cannot write png file");
         return false;
     }
 
-    if (png_ptr != nullptr) {
-        if (png_info_ptr != nullptr) {
-            png_destroy_write_struct(&png_ptr, &png_info_ptr);
-        } else {
-            png_destroy_write_struct(&png_ptr, nullptr);
-        }
-    }
+    vislib::sys::Log::DefaultLog.WriteInfo("Saving screenshot to file '%s'", vislib::StringA(output_file).PeekBuffer());
 
-    file.Close();
-
-    vislib::sys::Log::DefaultLog.WriteInfo("Saved screenshot to file '%s'", output_file.PeekBuffer());
+    return true;
 }
 
 
@@ -509,7 +417,7 @@ bool render_to_file::create(void) {
 /*
  * render_to_file::release
  */
-void render_to_file::release(void) {}
+void render_to_file::release(void) { this->exporter.Finish(); }
 
 
 /*
@@ -9,6 +9,7 @@
 #include "mmcore/Call.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/utility/FrameExporter.h"
 #include "mmcore/view/AbstractView.h"
 #include "mmcore/view/CallRenderView.h"
 #include "mmcore/view/Input.h"
@@ -196,6 +197,9 @@ private:
 
     /** Trigger */
     core::param::ParamSlot trigger;
+
+    /** Writes the recorded frames without stalling the rendering */
+    core::utility::FrameExporter exporter;
 };
 
 } // namespace flowvis
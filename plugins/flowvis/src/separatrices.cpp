@@ -0,0 +1,455 @@
+#include "stdafx.h"
+#include "separatrices.h"
+
+#include "critical_points.h"
+#include "glyph_data_call.h"
+#include "vector_field_call.h"
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+
+#include "vislib/sys/Log.h"
+
+#include "Eigen/Dense"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    /**
+    * Compute the Jacobian of the bilinearly interpolated vector field at the given position
+    *
+    * @param resolution             Resolution of the vector field
+    * @param bounding_rectangle     Domain of the vector field
+    * @param vectors                Vectors at the grid nodes
+    * @param position               Position at which the Jacobian is computed
+    *
+    * @return Jacobian
+    */
+    Eigen::Matrix2f compute_jacobian(const std::array<unsigned int, 2>& resolution, const vislib::math::Rectangle<float>& bounding_rectangle,
+        const std::vector<float>& vectors, const Eigen::Vector2f& position)
+    {
+        const float cell_width = bounding_rectangle.Width() / (resolution[0] - 1);
+        const float cell_height = bounding_rectangle.Height() / (resolution[1] - 1);
+
+        const float cell_x = (position[0] - bounding_rectangle.Left()) / cell_width;
+        const float cell_y = (position[1] - bounding_rectangle.Bottom()) / cell_height;
+
+        const auto x = static_cast<std::size_t>(std::min(std::max(std::floor(cell_x), 0.0f), static_cast<float>(resolution[0] - 2)));
+        const auto y = static_cast<std::size_t>(std::min(std::max(std::floor(cell_y), 0.0f), static_cast<float>(resolution[1] - 2)));
+
+        const float t_x = cell_x - x;
+        const float t_y = cell_y - y;
+
+        const auto vector = [&resolution, &vectors](const std::size_t x, const std::size_t y)
+        {
+            const auto index = 2 * (y * resolution[0] + x);
+
+            return Eigen::Vector2f(vectors[index + 0], vectors[index + 1]);
+        };
+
+        const auto bottom_left = vector(x, y);
+        const auto bottom_right = vector(x + 1, y);
+        const auto top_left = vector(x, y + 1);
+        const auto top_right = vector(x + 1, y + 1);
+
+        Eigen::Matrix2f jacobian;
+        jacobian.col(0) = ((1.0f - t_y) * (bottom_right - bottom_left) + t_y * (top_right - top_left)) / cell_width;
+        jacobian.col(1) = ((1.0f - t_x) * (top_left - bottom_left) + t_x * (top_right - bottom_right)) / cell_height;
+
+        return jacobian;
+    }
+}
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        separatrices::separatrices() :
+            separatrices_slot("set_separatrices", "Separatrices as lines"),
+            vector_field_slot("vector_field_slot", "Vector field input"),
+            critical_points_slot("critical_points_slot", "Critical points input, providing the saddles for seeding"),
+            seed_offset("seed_offset", "Distance of the seeds from their saddle, relative to the cell size; separatrices "
+                "terminate when approaching another critical point closer than half this distance"),
+            integration_method("integration_method", "Method for stream line integration"),
+            integration_timestep("integration_timestep", "(Initial) time step for stream line integration"),
+            max_integration_error("max_integration_error", "Maximum integration error for Runge-Kutta 4-5"),
+            num_integration_steps("num_integration_steps", "Maximum number of integration steps per separatrix"),
+            num_steps_per_vertex("num_steps_per_vertex", "Number of integration steps between consecutive output vertices"),
+            num_particles_per_batch("num_particles_per_batch", "Number of particles processed per batch"),
+            vector_field_hash(-1),
+            critical_points_hash(-1),
+            input_changed(false),
+            separatrices_hash(0)
+        {
+            // Connect output
+            this->separatrices_slot.SetCallback(glyph_data_call::ClassName(), glyph_data_call::FunctionName(0), &separatrices::get_separatrices_data);
+            this->separatrices_slot.SetCallback(glyph_data_call::ClassName(), glyph_data_call::FunctionName(1), &separatrices::get_separatrices_extent);
+            this->MakeSlotAvailable(&this->separatrices_slot);
+
+            // Connect input
+            this->vector_field_slot.SetCompatibleCall<vector_field_call::vector_field_description>();
+            this->MakeSlotAvailable(&this->vector_field_slot);
+
+            this->critical_points_slot.SetCompatibleCall<glyph_data_call::glyph_data_description>();
+            this->MakeSlotAvailable(&this->critical_points_slot);
+
+            // Create seed parameters
+            this->seed_offset << new core::param::FloatParam(0.5f);
+            this->MakeSlotAvailable(&this->seed_offset);
+
+            // Create integration parameters
+            this->integration_method << new core::param::EnumParam(1);
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(0, "Runge-Kutta 4 (fixed)");
+            this->integration_method.Param<core::param::EnumParam>()->SetTypePair(1, "Runge-Kutta 4-5 (dynamic)");
+            this->MakeSlotAvailable(&this->integration_method);
+
+            this->integration_timestep << new core::param::FloatParam(0.01f);
+            this->MakeSlotAvailable(&this->integration_timestep);
+
+            this->max_integration_error << new core::param::FloatParam(0.000001f);
+            this->MakeSlotAvailable(&this->max_integration_error);
+
+            this->num_integration_steps << new core::param::IntParam(10000, 1);
+            this->MakeSlotAvailable(&this->num_integration_steps);
+
+            this->num_steps_per_vertex << new core::param::IntParam(10, 1);
+            this->MakeSlotAvailable(&this->num_steps_per_vertex);
+
+            this->num_particles_per_batch << new core::param::IntParam(10000, 1);
+            this->MakeSlotAvailable(&this->num_particles_per_batch);
+        }
+
+        separatrices::~separatrices()
+        {
+            this->Release();
+        }
+
+        bool separatrices::create()
+        {
+            return true;
+        }
+
+        void separatrices::release()
+        {
+            this->integrator = nullptr;
+        }
+
+        bool separatrices::get_input_data()
+        {
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+            auto* cp_call = this->critical_points_slot.CallAs<glyph_data_call>();
+
+            if (vf_call == nullptr || cp_call == nullptr || !(*vf_call)(1) || !(*vf_call)(0) || !(*cp_call)(0))
+            {
+                vislib::sys::Log::DefaultLog.WriteError("The separatrices module needs a vector field and its critical points as input");
+
+                return false;
+            }
+
+            if (vf_call->get_components() != 2 || vf_call->get_vectors() == nullptr)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Separatrices can only be extracted from planar vector fields");
+
+                return false;
+            }
+
+            if (vf_call->DataHash() != this->vector_field_hash)
+            {
+                this->bounding_rectangle = vf_call->get_bounding_rectangle();
+                this->resolution = vf_call->get_resolution();
+                this->vectors = vf_call->get_vectors();
+
+                this->vector_field_hash = vf_call->DataHash();
+                this->input_changed = true;
+            }
+
+            if (cp_call->DataHash() != this->critical_points_hash)
+            {
+                const auto points = cp_call->get_points();
+
+                this->critical_point_positions.resize(2 * points.size());
+                this->saddles.clear();
+
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    this->critical_point_positions[2 * i + 0] = points[i].first[0];
+                    this->critical_point_positions[2 * i + 1] = points[i].first[1];
+
+                    if (points[i].second == static_cast<float>(critical_points::type::SADDLE))
+                    {
+                        this->saddles.push_back(points[i].first);
+                    }
+                }
+
+                this->critical_points_hash = cp_call->DataHash();
+                this->input_changed = true;
+            }
+
+            return true;
+        }
+
+        bool separatrices::compute_separatrices()
+        {
+            if (!(this->input_changed || this->seed_offset.IsDirty() || this->integration_method.IsDirty() || this->integration_timestep.IsDirty()
+                || this->max_integration_error.IsDirty() || this->num_integration_steps.IsDirty() || this->num_steps_per_vertex.IsDirty()
+                || this->num_particles_per_batch.IsDirty()))
+            {
+                return this->line_indices != nullptr;
+            }
+
+            this->seed_offset.ResetDirty();
+            this->integration_method.ResetDirty();
+            this->integration_timestep.ResetDirty();
+            this->max_integration_error.ResetDirty();
+            this->num_integration_steps.ResetDirty();
+            this->num_steps_per_vertex.ResetDirty();
+            this->num_particles_per_batch.ResetDirty();
+
+            const auto method = static_cast<streamlines_cuda::integration_method>(this->integration_method.Param<core::param::EnumParam>()->Value());
+            const auto timestep = this->integration_timestep.Param<core::param::FloatParam>()->Value();
+            const auto max_error = this->max_integration_error.Param<core::param::FloatParam>()->Value();
+
+            const bool upload = this->input_changed || this->integrator == nullptr || !this->integrator->is_current();
+
+            this->input_changed = false;
+            this->line_vertices = nullptr;
+            this->line_indices = nullptr;
+            this->line_values = nullptr;
+
+            try
+            {
+                // Upload the vector field and the critical points as convergence structures only if they changed,
+                // or if another module replaced them on the devices
+                if (upload)
+                {
+                    if (this->integrator != nullptr && !this->integrator->is_current())
+                    {
+                        vislib::sys::Log::DefaultLog.WriteWarn("The GPU integrator was used by another module, uploading the vector field again");
+                    }
+
+                    this->integrator = nullptr;
+
+                    const std::array<float, 4> domain = { this->bounding_rectangle.Left(), this->bounding_rectangle.Bottom(),
+                        this->bounding_rectangle.Right(), this->bounding_rectangle.Top() };
+
+                    std::vector<int> critical_point_ids(this->critical_point_positions.size() / 2);
+
+                    for (std::size_t i = 0; i < critical_point_ids.size(); ++i)
+                    {
+                        critical_point_ids[i] = static_cast<int>(i);
+                    }
+
+                    this->integrator = std::make_unique<streamlines_cuda>(this->resolution, domain, *this->vectors,
+                        this->critical_point_positions, critical_point_ids, std::vector<float>(), std::vector<int>(), timestep, max_error, method);
+                }
+                else
+                {
+                    this->integrator->set_integration_parameters(timestep, max_error, method);
+                }
+
+                // Terminate at critical points, closer than the seeds are to their own saddle
+                const float cell_size = std::min(this->bounding_rectangle.Width() / (this->resolution[0] - 1),
+                    this->bounding_rectangle.Height() / (this->resolution[1] - 1));
+
+                const float offset = this->seed_offset.Param<core::param::FloatParam>()->Value() * cell_size;
+
+                this->integrator->set_convergence_criteria(0.5f * offset, 0, 0.0f);
+
+                // Seed along the unstable eigenvector for forward, and along the stable eigenvector for backward integration
+                const auto num_saddles = this->saddles.size();
+                const auto num_lines = 4 * num_saddles;
+
+                std::vector<float> source_forward(4 * num_saddles), source_backward(4 * num_saddles);
+
+                for (std::size_t i = 0; i < num_saddles; ++i)
+                {
+                    const Eigen::EigenSolver<Eigen::Matrix2f> eigensolver(
+                        compute_jacobian(this->resolution, this->bounding_rectangle, *this->vectors, this->saddles[i]), true);
+
+                    const auto unstable = eigensolver.eigenvalues()[0].real() > eigensolver.eigenvalues()[1].real() ? 0 : 1;
+
+                    const Eigen::Vector2f unstable_direction = eigensolver.eigenvectors().col(unstable).real().normalized();
+                    const Eigen::Vector2f stable_direction = eigensolver.eigenvectors().col(1 - unstable).real().normalized();
+
+                    for (std::size_t side = 0; side < 2; ++side)
+                    {
+                        const float sign = side == 0 ? 1.0f : -1.0f;
+
+                        const Eigen::Vector2f forward_seed = this->saddles[i] + sign * offset * unstable_direction;
+                        const Eigen::Vector2f backward_seed = this->saddles[i] + sign * offset * stable_direction;
+
+                        source_forward[4 * i + 2 * side + 0] = forward_seed[0];
+                        source_forward[4 * i + 2 * side + 1] = forward_seed[1];
+                        source_backward[4 * i + 2 * side + 0] = backward_seed[0];
+                        source_backward[4 * i + 2 * side + 1] = backward_seed[1];
+                    }
+                }
+
+                // Integrate all separatrices in both directions in the same launches, storing a vertex after each launch
+                const auto num_steps = this->num_integration_steps.Param<core::param::IntParam>()->Value();
+                const auto steps_per_vertex = this->num_steps_per_vertex.Param<core::param::IntParam>()->Value();
+                const auto batch_size = static_cast<unsigned int>(this->num_particles_per_batch.Param<core::param::IntParam>()->Value());
+
+                const auto stride = static_cast<std::size_t>((num_steps + steps_per_vertex - 1) / steps_per_vertex) + 1;
+
+                auto vertices = std::make_shared<std::vector<float>>(2 * num_lines * stride);
+                std::vector<std::size_t> line_lengths(num_lines, 1);
+
+                const auto half = 2 * num_saddles;
+
+                const auto add_vertex = [&](const std::size_t line, const std::vector<float>& source, const std::size_t seed)
+                {
+                    const auto index = 2 * (line * stride + line_lengths[line]++);
+
+                    (*vertices)[index + 0] = std::min(std::max(source[2 * seed + 0], this->bounding_rectangle.Left()), this->bounding_rectangle.Right());
+                    (*vertices)[index + 1] = std::min(std::max(source[2 * seed + 1], this->bounding_rectangle.Bottom()), this->bounding_rectangle.Top());
+                };
+
+                for (std::size_t i = 0; i < half; ++i)
+                {
+                    (*vertices)[2 * i * stride + 0] = source_forward[2 * i + 0];
+                    (*vertices)[2 * i * stride + 1] = source_forward[2 * i + 1];
+                    (*vertices)[2 * (half + i) * stride + 0] = source_backward[2 * i + 0];
+                    (*vertices)[2 * (half + i) * stride + 1] = source_backward[2 * i + 1];
+                }
+
+                std::vector<float> labels_forward(half, -1.0f), distances_forward(half, std::numeric_limits<float>::max()), terminations_forward(half, 0.0f);
+                std::vector<float> labels_backward(half, -1.0f), distances_backward(half, std::numeric_limits<float>::max()), terminations_backward(half, 0.0f);
+
+                std::vector<bool> active_forward(half), active_backward(half);
+
+                for (int step = 0; step < num_steps; step += steps_per_vertex)
+                {
+                    // Only add vertices to separatrices which have not terminated before this launch
+                    bool any_active = false;
+
+                    for (std::size_t i = 0; i < half; ++i)
+                    {
+                        active_forward[i] = terminations_forward[i] == 0.0f;
+                        active_backward[i] = terminations_backward[i] == 0.0f;
+
+                        any_active = any_active || active_forward[i] || active_backward[i];
+                    }
+
+                    if (!any_active)
+                    {
+                        break;
+                    }
+
+                    this->integrator->update_labels_bidirectional(source_forward, labels_forward, distances_forward, terminations_forward,
+                        source_backward, labels_backward, distances_backward, terminations_backward,
+                        std::min(steps_per_vertex, num_steps - step), false, batch_size);
+
+                    for (std::size_t i = 0; i < half; ++i)
+                    {
+                        if (active_forward[i]) add_vertex(i, source_forward, i);
+                        if (active_backward[i]) add_vertex(half + i, source_backward, i);
+                    }
+                }
+
+                // Create line strips with restart indices and per-vertex values
+                auto indices = std::make_shared<std::vector<unsigned int>>();
+                auto values = std::make_shared<std::vector<float>>(num_lines * stride);
+
+                Eigen::Vector4f bounds(this->bounding_rectangle.Right(), this->bounding_rectangle.Top(),
+                    this->bounding_rectangle.Left(), this->bounding_rectangle.Bottom());
+
+                for (std::size_t i = 0; i < num_lines; ++i)
+                {
+                    if (i != 0)
+                    {
+                        indices->push_back(static_cast<unsigned int>(-1));
+                    }
+
+                    for (std::size_t j = 0; j < line_lengths[i]; ++j)
+                    {
+                        const auto index = i * stride + j;
+
+                        indices->push_back(static_cast<unsigned int>(index));
+
+                        bounds.head<2>() = bounds.head<2>().cwiseMin(Eigen::Vector2f((*vertices)[2 * index + 0], (*vertices)[2 * index + 1]));
+                        bounds.tail<2>() = bounds.tail<2>().cwiseMax(Eigen::Vector2f((*vertices)[2 * index + 0], (*vertices)[2 * index + 1]));
+                    }
+
+                    std::fill_n(values->begin() + i * stride, stride, i < half ? 1.0f : 0.0f);
+                }
+
+                if (num_lines == 0)
+                {
+                    bounds << 0.0f, 0.0f, 0.0f, 0.0f;
+                }
+
+                this->line_vertices = vertices;
+                this->line_indices = indices;
+                this->line_values = values;
+                this->line_bounding_rectangle = vislib::math::Rectangle<float>(bounds[0], bounds[1], bounds[2], bounds[3]);
+            }
+            catch (const std::exception& e)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Error extracting separatrices: %s", e.what());
+
+                this->line_vertices = nullptr;
+                this->line_indices = nullptr;
+                this->line_values = nullptr;
+
+                this->integrator = nullptr;
+
+                return false;
+            }
+
+            ++this->separatrices_hash;
+
+            return true;
+        }
+
+        bool separatrices::get_separatrices_data(core::Call& call)
+        {
+            auto* glyph_call = dynamic_cast<glyph_data_call*>(&call);
+
+            if (glyph_call == nullptr || !get_input_data() || !compute_separatrices())
+            {
+                return false;
+            }
+
+            if (glyph_call->DataHash() != this->separatrices_hash)
+            {
+                glyph_call->clear();
+
+                if (!this->line_indices->empty())
+                {
+                    glyph_call->set_lines(this->line_vertices, this->line_indices, this->line_values, this->line_bounding_rectangle);
+                }
+
+                glyph_call->SetDataHash(this->separatrices_hash);
+            }
+
+            return true;
+        }
+
+        bool separatrices::get_separatrices_extent(core::Call& call)
+        {
+            auto* glyph_call = dynamic_cast<glyph_data_call*>(&call);
+            auto* vf_call = this->vector_field_slot.CallAs<vector_field_call>();
+
+            if (glyph_call == nullptr || vf_call == nullptr || !(*vf_call)(1))
+            {
+                return false;
+            }
+
+            glyph_call->set_bounding_rectangle(vf_call->get_bounding_rectangle());
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * separatrices.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "../cuda/streamlines.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include "Eigen/Dense"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Module for extracting the separatrices of a 2D vector field, seeded at the saddles provided by the critical points module.
+        *
+        * For each saddle, four seeds are placed next to it along the eigenvector directions of the Jacobian. The seeds along
+        * the unstable direction are advected forward, and those along the stable direction backward, all within the same
+        * kernel launches of the GPU integrator of the implicit topology computation. The separatrices terminate at other
+        * critical points, at the domain boundary, or after the maximum number of integration steps. As the integrator
+        * state on the GPU is shared with other modules, it is uploaded again if another module replaced it in the meantime.
+        *
+        * The separatrices are output as lines with the value 1 for unstable and 0 for stable separatrices.
+        *
+        * @author Alexander Straub
+        */
+        class separatrices : public core::Module
+        {
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static const char* ClassName() { return "separatrices"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static const char* Description() { return "Extract separatrices of 2D vector fields on the GPU, seeded at saddles"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static bool IsAvailable() { return true; }
+
+            /**
+            * Constructor
+            */
+            separatrices();
+
+            /**
+            * Destructor
+            */
+            ~separatrices();
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+        private:
+            /**
+            * Get the input vector field and critical points
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool get_input_data();
+
+            /**
+            * Compute the separatrices for the current parameters, if not already computed
+            *
+            * @return 'true' on success, 'false' otherwise
+            */
+            bool compute_separatrices();
+
+            /** Callbacks for the separatrices */
+            bool get_separatrices_data(core::Call& call);
+            bool get_separatrices_extent(core::Call& call);
+
+            /** Output slot for the separatrices */
+            core::CalleeSlot separatrices_slot;
+
+            /** Input slot for getting the vector field */
+            core::CallerSlot vector_field_slot;
+
+            /** Input slot for getting the critical points */
+            core::CallerSlot critical_points_slot;
+
+            /** Parameters for seeding */
+            core::param::ParamSlot seed_offset;
+
+            /** Parameters for the integration */
+            core::param::ParamSlot integration_method;
+            core::param::ParamSlot integration_timestep;
+            core::param::ParamSlot max_integration_error;
+            core::param::ParamSlot num_integration_steps;
+            core::param::ParamSlot num_steps_per_vertex;
+            core::param::ParamSlot num_particles_per_batch;
+
+            /** Input vector field and critical points, and the integrator */
+            SIZE_T vector_field_hash;
+            SIZE_T critical_points_hash;
+            bool input_changed;
+
+            vislib::math::Rectangle<float> bounding_rectangle;
+            std::array<unsigned int, 2> resolution;
+            std::shared_ptr<std::vector<float>> vectors;
+            std::vector<float> critical_point_positions;
+            std::vector<Eigen::Vector2f> saddles;
+
+            std::unique_ptr<streamlines_cuda> integrator;
+
+            /** Output separatrices, stored with a fixed number of vertices per line */
+            SIZE_T separatrices_hash;
+
+            std::shared_ptr<std::vector<float>> line_vertices;
+            std::shared_ptr<std::vector<unsigned int>> line_indices;
+            std::shared_ptr<std::vector<float>> line_values;
+            vislib::math::Rectangle<float> line_bounding_rectangle;
+        };
+    }
+}
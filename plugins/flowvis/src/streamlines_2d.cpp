@@ -2,6 +2,7 @@
 #include "streamlines_2d.h"
 
 #include "glyph_data_call.h"
+#include "tiled_vector_field.h"
 #include "vector_field_call.h"
 
 #include "flowvis/integrator.h"
@@ -18,6 +19,13 @@
 #include "tpf/data/tpf_grid.h"
 #include "tpf/data/tpf_grid_information.h"
 
+#include "Eigen/Dense"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
 namespace megamol {
 namespace flowvis {
 
@@ -95,6 +103,11 @@ bool streamlines_2d::get_input_data() {
         return false;
     }
 
+    if (vfc.get_components() != 2) {
+        vislib::sys::Log::DefaultLog.WriteError("Stream lines can only be computed for planar vector fields");
+        return false;
+    }
+
     if (!spc(0)) {
         vislib::sys::Log::DefaultLog.WriteError("Error getting input seed points");
         return false;
@@ -102,8 +115,16 @@ bool streamlines_2d::get_input_data() {
 
     if (vfc.DataHash() != this->vector_field_hash) {
         this->resolution = vfc.get_resolution();
-        this->grid_positions = vfc.get_positions();
-        this->vectors = vfc.get_vectors();
+        this->tiled_vectors = vfc.get_tiled_vectors();
+
+        // Avoid assembling positions and vectors of the whole field if it is provided in tiles
+        if (this->tiled_vectors == nullptr) {
+            this->grid_positions = vfc.get_positions();
+            this->vectors = vfc.get_vectors();
+        } else {
+            this->grid_positions = nullptr;
+            this->vectors = nullptr;
+        }
 
         this->vector_field_hash = vfc.DataHash();
         this->vector_field_changed = true;
@@ -157,89 +178,163 @@ bool streamlines_2d::compute_streamlines() {
         this->max_integration_error.ResetDirty();
         this->num_integration_steps.ResetDirty();
 
-        // Create grid containing the vector field
-        tpf::data::extent_t extent;
-        extent.push_back(std::make_pair(0ull, static_cast<std::size_t>(this->resolution[0] - 1)));
-        extent.push_back(std::make_pair(0ull, static_cast<std::size_t>(this->resolution[1] - 1)));
+        // Get parameters
+        const auto integration_method = this->integration_method.Param<core::param::EnumParam>()->Value();
+        const auto num_integration_steps = this->num_integration_steps.Param<core::param::IntParam>()->Value();
+        const auto max_integration_error = this->max_integration_error.Param<core::param::FloatParam>()->Value();
+        const auto direction = this->direction.Param<core::param::EnumParam>()->Value();
 
-        const Eigen::Vector2f origin((*this->grid_positions)[0], (*this->grid_positions)[1]);
-        const Eigen::Vector2f right((*this->grid_positions)[2], (*this->grid_positions)[3]);
-        const Eigen::Vector2f up(
-            (*this->grid_positions)[2 * this->resolution[0]], (*this->grid_positions)[2 * this->resolution[0] + 1]);
+        // Advect all seed points, writing the vertices of each line to its own fixed-size range
+        const auto num_lines = (direction == 0 ? 2 : 1) * this->seed_points.size();
+        const auto stride = static_cast<std::size_t>(num_integration_steps) + 1;
 
-        const Eigen::Vector2f cell_size(right.x() - origin.x(), up.y() - origin.y());
-        const auto node_origin = origin - 0.5f * cell_size;
+        auto vertices = std::make_shared<std::vector<float>>(num_lines * stride * 2);
 
-        tpf::data::grid_information<float>::array_type cell_coordinates(2), node_coordinates(2), cell_sizes(2);
+        std::vector<unsigned int> line_lengths(num_lines);
+        std::vector<Eigen::Vector4f> line_bounds(num_lines);
 
-        for (std::size_t dimension = 0; dimension < 2; ++dimension) {
-            cell_coordinates[dimension].resize(this->resolution[dimension]);
-            node_coordinates[dimension].resize(this->resolution[dimension] + 1);
-            cell_sizes[dimension].resize(this->resolution[dimension]);
+        auto advect = [&](const auto& vector_field) {
+            for (std::size_t direction_run = 0; direction_run < (direction == 0 ? 2 : 1); ++direction_run) {
+                #pragma omp parallel for
+                for (long long point_index = 0; point_index < static_cast<long long>(this->seed_points.size());
+                     ++point_index) {
 
-            for (std::size_t element = 0; element < this->resolution[dimension]; ++element) {
-                cell_sizes[dimension][element] = cell_size[dimension];
-                cell_coordinates[dimension][element] = origin[dimension] + element * cell_size[dimension];
-                node_coordinates[dimension][element] = origin[dimension] + (element - 0.5f) * cell_size[dimension];
-            }
+                    const auto line_index = direction_run * this->seed_points.size() + point_index;
 
-            node_coordinates[dimension][this->resolution[dimension]] =
-                origin[dimension] + (this->resolution[dimension] - 0.5f) * cell_size[dimension];
-        }
+                    Eigen::Vector2f point = this->seed_points[point_index].first;
+                    Eigen::Vector4f bounds(point.x(), point.y(), point.x(), point.y());
 
-        const tpf::data::grid<float, float, 2, 2> vector_field("vector_field", extent, *this->vectors,
-            std::move(cell_coordinates), std::move(node_coordinates), std::move(cell_sizes));
+                    auto integration_timestep = this->integration_timestep.Param<core::param::FloatParam>()->Value();
 
-        // Get parameters
-        const auto integration_method = this->integration_method.Param<core::param::EnumParam>()->Value();
-        const auto num_integration_steps = this->num_integration_steps.Param<core::param::IntParam>()->Value();
-        const auto max_integration_error = this->max_integration_error.Param<core::param::FloatParam>()->Value();
-        const auto direction = this->direction.Param<core::param::EnumParam>()->Value();
+                    float* line_points = vertices->data() + line_index * stride * 2;
+                    unsigned int num_line_points = 0;
+
+                    auto add_point = [&line_points, &num_line_points, &bounds](const Eigen::Vector2f& position) {
+                        line_points[num_line_points * 2 + 0] = position.x();
+                        line_points[num_line_points * 2 + 1] = position.y();
+
+                        bounds.head<2>() = bounds.head<2>().cwiseMin(position);
+                        bounds.tail<2>() = bounds.tail<2>().cwiseMax(position);
+
+                        ++num_line_points;
+                    };
 
-        // Advect all seed points
-        this->streamlines.clear();
-        this->streamlines.resize(direction == 0 ? 2 * this->seed_points.size() : this->seed_points.size());
-
-        for (std::size_t direction_run = 0; direction_run < (direction == 0 ? 2 : 1); ++direction_run) {
-            #pragma omp parallel for
-            for (long long point_index = 0; point_index < static_cast<long long>(this->seed_points.size());
-                 ++point_index) {
-
-                Eigen::Vector2f point = this->seed_points[point_index].first;
-
-                auto integration_timestep = this->integration_timestep.Param<core::param::FloatParam>()->Value();
-
-                std::vector<Eigen::Vector2f> line_points;
-                line_points.reserve(num_integration_steps + 1);
-
-                line_points.push_back(point);
-
-                try {
-                    for (std::size_t integration = 0; integration < num_integration_steps; ++integration) {
-                        switch (integration_method) {
-                        case 0:
-                            advect_point_rk4<2>(vector_field, point, integration_timestep,
-                                direction == 1 || (direction == 0 && direction_run == 0));
-                            line_points.push_back(point);
-                            break;
-                        case 1:
-                            advect_point_rk45<2>(vector_field, point, integration_timestep, max_integration_error,
-                                direction == 1 || (direction == 0 && direction_run == 0));
-                            line_points.push_back(point);
-                            break;
+                    add_point(point);
+
+                    try {
+                        for (std::size_t integration = 0; integration < num_integration_steps; ++integration) {
+                            switch (integration_method) {
+                            case 0:
+                                advect_point_rk4<2>(vector_field, point, integration_timestep,
+                                    direction == 1 || (direction == 0 && direction_run == 0));
+                                add_point(point);
+                                break;
+                            case 1:
+                                advect_point_rk45<2>(vector_field, point, integration_timestep, max_integration_error,
+                                    direction == 1 || (direction == 0 && direction_run == 0));
+                                add_point(point);
+                                break;
+                            }
+                        }
+                    } catch (std::exception&) {
+                        if (num_line_points == 1 && stride > 1) {
+                            add_point(point);
                         }
                     }
-                } catch (std::exception&) {
-                    if (line_points.size() == 1) {
-                        line_points.push_back(point);
-                    }
+
+                    line_lengths[line_index] = num_line_points;
+                    line_bounds[line_index] = bounds;
+                }
+            }
+        };
+
+        if (this->tiled_vectors != nullptr) {
+            // Integrate on the tiles, which are loaded as the particles reach them
+            advect(*this->tiled_vectors);
+
+            const auto statistics = this->tiled_vectors->get_statistics();
+
+            vislib::sys::Log::DefaultLog.WriteInfo("Streamline integration loaded %llu tiles, with %llu cache hits",
+                static_cast<unsigned long long>(statistics.misses), static_cast<unsigned long long>(statistics.hits));
+        } else {
+            // Create grid containing the vector field
+            tpf::data::extent_t extent;
+            extent.push_back(std::make_pair(0ull, static_cast<std::size_t>(this->resolution[0] - 1)));
+            extent.push_back(std::make_pair(0ull, static_cast<std::size_t>(this->resolution[1] - 1)));
+
+            const Eigen::Vector2f origin((*this->grid_positions)[0], (*this->grid_positions)[1]);
+            const Eigen::Vector2f right((*this->grid_positions)[2], (*this->grid_positions)[3]);
+            const Eigen::Vector2f up(
+                (*this->grid_positions)[2 * this->resolution[0]], (*this->grid_positions)[2 * this->resolution[0] + 1]);
+
+            const Eigen::Vector2f cell_size(right.x() - origin.x(), up.y() - origin.y());
+            const auto node_origin = origin - 0.5f * cell_size;
+
+            tpf::data::grid_information<float>::array_type cell_coordinates(2), node_coordinates(2), cell_sizes(2);
+
+            for (std::size_t dimension = 0; dimension < 2; ++dimension) {
+                cell_coordinates[dimension].resize(this->resolution[dimension]);
+                node_coordinates[dimension].resize(this->resolution[dimension] + 1);
+                cell_sizes[dimension].resize(this->resolution[dimension]);
+
+                for (std::size_t element = 0; element < this->resolution[dimension]; ++element) {
+                    cell_sizes[dimension][element] = cell_size[dimension];
+                    cell_coordinates[dimension][element] = origin[dimension] + element * cell_size[dimension];
+                    node_coordinates[dimension][element] = origin[dimension] + (element - 0.5f) * cell_size[dimension];
                 }
 
-                this->streamlines[direction_run * this->seed_points.size() + point_index] =
-                   std::make_pair(static_cast<float>(point_index), line_points);
+                node_coordinates[dimension][this->resolution[dimension]] =
+                    origin[dimension] + (this->resolution[dimension] - 0.5f) * cell_size[dimension];
             }
+
+            const tpf::data::grid<float, float, 2, 2> vector_field("vector_field", extent, *this->vectors,
+                std::move(cell_coordinates), std::move(node_coordinates), std::move(cell_sizes));
+
+            advect(vector_field);
         }
 
+        // Create line strips with restart indices and per-vertex values
+        std::vector<std::size_t> index_offsets(num_lines + 1, 0);
+
+        for (std::size_t line_index = 0; line_index < num_lines; ++line_index) {
+            index_offsets[line_index + 1] = index_offsets[line_index] + line_lengths[line_index] + (line_index != 0 ? 1 : 0);
+        }
+
+        auto indices = std::make_shared<std::vector<unsigned int>>(index_offsets.back());
+        auto values = std::make_shared<std::vector<float>>(num_lines * stride);
+
+        #pragma omp parallel for
+        for (long long line_index = 0; line_index < static_cast<long long>(num_lines); ++line_index) {
+            auto index = index_offsets[line_index];
+
+            if (line_index != 0) {
+                (*indices)[index++] = static_cast<unsigned int>(-1);
+            }
+
+            for (std::size_t i = 0; i < line_lengths[line_index]; ++i) {
+                (*indices)[index++] = static_cast<unsigned int>(line_index * stride + i);
+            }
+
+            std::fill_n(values->begin() + line_index * stride, stride,
+                static_cast<float>(static_cast<std::size_t>(line_index) % this->seed_points.size()));
+        }
+
+        Eigen::Vector4f bounds(0.0f, 0.0f, 0.0f, 0.0f);
+
+        if (num_lines > 0) {
+            bounds = line_bounds[0];
+
+            for (const auto& line_bound : line_bounds) {
+                bounds.head<2>() = bounds.head<2>().cwiseMin(line_bound.head<2>());
+                bounds.tail<2>() = bounds.tail<2>().cwiseMax(line_bound.tail<2>());
+            }
+        }
+
+        this->line_vertices = vertices;
+        this->line_indices = indices;
+        this->line_values = values;
+        this->line_bounding_rectangle = vislib::math::Rectangle<float>(bounds[0], bounds[1], bounds[2], bounds[3]);
+
         this->streamlines_hash = core::utility::DataHash(this->vector_field_hash, this->seed_points_hash,
             this->direction.Param<core::param::EnumParam>()->Value(),
             this->integration_method.Param<core::param::EnumParam>()->Value(),
@@ -264,8 +359,8 @@ bool streamlines_2d::get_streamlines_data(core::Call& call) {
     if (gdc.DataHash() != this->streamlines_hash) {
         gdc.clear();
 
-        for (const auto& line : this->streamlines) {
-            gdc.add_line(line.second, line.first);
+        if (this->line_indices != nullptr && !this->line_indices->empty()) {
+            gdc.set_lines(this->line_vertices, this->line_indices, this->line_values, this->line_bounding_rectangle);
         }
 
         gdc.SetDataHash(this->streamlines_hash);
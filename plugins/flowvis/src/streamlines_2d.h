@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include "tiled_vector_field.h"
+
 #include "mmcore/Call.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
@@ -118,16 +120,23 @@ private:
     std::shared_ptr<std::vector<float>> grid_positions;
     std::shared_ptr<std::vector<float>> vectors;
 
+    /** Input vector field in tiles loaded on demand; if set, positions and vectors are not requested */
+    std::shared_ptr<tiled_vector_field> tiled_vectors;
+
     /** Input seed points */
     SIZE_T seed_points_hash;
     bool seed_points_changed;
 
     std::vector<std::pair<Eigen::Vector2f, float>> seed_points;
 
-    /** Output streamlines */
+    /** Output streamlines, stored with a fixed number of vertices per line */
     SIZE_T streamlines_hash;
 
-    std::vector<std::pair<float, std::vector<Eigen::Vector2f>>> streamlines;
+    std::shared_ptr<std::vector<float>> line_vertices;
+    std::shared_ptr<std::vector<unsigned int>> line_indices;
+    std::shared_ptr<std::vector<float>> line_values;
+
+    vislib::math::Rectangle<float> line_bounding_rectangle;
 };
 
 } // namespace flowvis
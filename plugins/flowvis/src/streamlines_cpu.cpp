@@ -0,0 +1,662 @@
+#include "stdafx.h"
+#include "streamlines_cpu.h"
+
+#include "../cuda/convergence_grid.h"
+#include "../cuda/streamlines.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        streamlines_cpu::streamlines_cpu(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+            const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
+            const std::vector<float>& lines, const std::vector<int>& line_ids, const float integration_timestep,
+            const float max_integration_error, const streamlines_cuda::integration_method method)
+            : points(points), lines(lines), integration_timestep(integration_timestep), max_integration_error(max_integration_error), method(method),
+            convergence_distance(0.0f), convergence_steps(0), convergence_radius(0.0f)
+        {
+            this->resolution = { static_cast<int>(resolution[0]), static_cast<int>(resolution[1]) };
+
+            // Create constants, as they are used by the CUDA implementation
+            this->cell_size = { (domain[2] - domain[0]) / (resolution[0] - 1), (domain[3] - domain[1]) / (resolution[1] - 1) };
+            this->cell_diagonal = std::sqrt(this->cell_size[0] * this->cell_size[0] + this->cell_size[1] * this->cell_size[1]);
+
+            this->domain_offset = { domain[0], domain[1] };
+            this->domain_scale = { 1.0f / (domain[2] - domain[0]), 1.0f / (domain[3] - domain[1]) };
+            this->grid_scale = { static_cast<float>(resolution[0] - 1), static_cast<float>(resolution[1] - 1) };
+
+            // Store vector field as structure of arrays
+            const std::size_t num_vectors = vectors.size() / 2;
+
+            this->velocity_x.resize(num_vectors);
+            this->velocity_y.resize(num_vectors);
+
+            for (std::size_t i = 0; i < num_vectors; ++i)
+            {
+                this->velocity_x[i] = vectors[i * 2 + 0];
+                this->velocity_y[i] = vectors[i * 2 + 1];
+            }
+
+            // Store ids of convergence structures, with points first, followed by lines
+            this->num_convergence_points = static_cast<int>(point_ids.size());
+            this->num_convergence_lines = static_cast<int>(line_ids.size());
+
+            this->ids.reserve(point_ids.size() + line_ids.size());
+
+            for (const auto id : point_ids)
+            {
+                this->ids.push_back(static_cast<float>(id));
+            }
+
+            for (const auto id : line_ids)
+            {
+                this->ids.push_back(static_cast<float>(id));
+            }
+
+            // Create uniform grid for accelerating nearest convergence structure queries
+            this->grid = create_convergence_grid(domain, points, lines);
+        }
+
+        void streamlines_cpu::set_integration_parameters(const float integration_timestep, const float max_integration_error,
+            const streamlines_cuda::integration_method method)
+        {
+            this->integration_timestep = integration_timestep;
+            this->max_integration_error = max_integration_error;
+            this->method = method;
+        }
+
+        void streamlines_cpu::set_convergence_criteria(const float distance, const unsigned int num_steps, const float radius)
+        {
+            this->convergence_distance = distance;
+            this->convergence_steps = num_steps;
+            this->convergence_radius = radius;
+        }
+
+        void streamlines_cpu::update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+            std::vector<float>& terminations, const int num_integration_steps, const float sign, unsigned int)
+        {
+            compute_streamlines(source, labels, distances, terminations, num_integration_steps, sign);
+        }
+
+        void streamlines_cpu::update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+            std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+            std::vector<float>& source_backward, std::vector<float>& labels_backward,
+            std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+            const int num_integration_steps, bool, unsigned int)
+        {
+            if (source_forward.size() != source_backward.size())
+            {
+                throw std::runtime_error("Forward and backward seed must be of the same size for bidirectional integration.");
+            }
+
+            compute_streamlines(source_forward, labels_forward, distances_forward, terminations_forward, num_integration_steps, 1.0f);
+            compute_streamlines(source_backward, labels_backward, distances_backward, terminations_backward, num_integration_steps, -1.0f);
+        }
+
+        void streamlines_cpu::interpolate(const float x, const float y, float& u, float& v, float& w) const
+        {
+            // Transform position from [physical] to [0 : resolution - 1], matching the texture lookup of the CUDA implementation
+            const float grid_x = (x - this->domain_offset[0]) * this->domain_scale[0] * this->grid_scale[0];
+            const float grid_y = (y - this->domain_offset[1]) * this->domain_scale[1] * this->grid_scale[1];
+
+            const float lower_x = std::floor(grid_x);
+            const float lower_y = std::floor(grid_y);
+
+            const float a_x = grid_x - lower_x;
+            const float a_y = grid_y - lower_y;
+
+            const int i_x = static_cast<int>(lower_x);
+            const int i_y = static_cast<int>(lower_y);
+
+            u = v = w = 0.0f;
+
+            // Interpolate bilinearly, with samples outside the grid being zero
+            const std::array<int, 4> offsets_x = { 0, 1, 1, 0 };
+            const std::array<int, 4> offsets_y = { 0, 0, 1, 1 };
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const int s_x = i_x + offsets_x[i];
+                const int s_y = i_y + offsets_y[i];
+
+                if (s_x >= 0 && s_x < this->resolution[0] && s_y >= 0 && s_y < this->resolution[1])
+                {
+                    const float weight = (offsets_x[i] == 0 ? 1.0f - a_x : a_x) * (offsets_y[i] == 0 ? 1.0f - a_y : a_y);
+                    const int index = s_y * this->resolution[0] + s_x;
+
+                    u += weight * this->velocity_x[index];
+                    v += weight * this->velocity_y[index];
+                    w += weight;
+                }
+            }
+        }
+
+        void streamlines_cpu::interpolate_block(const float* x, const float* y, float* u, float* v) const
+        {
+            const float* velocity_x = this->velocity_x.data();
+            const float* velocity_y = this->velocity_y.data();
+
+            const int res_x = this->resolution[0];
+            const int res_y = this->resolution[1];
+
+            const float offset_x = this->domain_offset[0];
+            const float offset_y = this->domain_offset[1];
+            const float domain_scale_x = this->domain_scale[0];
+            const float domain_scale_y = this->domain_scale[1];
+            const float grid_scale_x = this->grid_scale[0];
+            const float grid_scale_y = this->grid_scale[1];
+
+            #pragma omp simd
+            for (int i = 0; i < block_size; ++i)
+            {
+                // Transform position from [physical] to [0 : resolution - 1], clamped to where all samples lie outside the grid
+                const float unclamped_x = (x[i] - offset_x) * domain_scale_x * grid_scale_x;
+                const float unclamped_y = (y[i] - offset_y) * domain_scale_y * grid_scale_y;
+
+                const float grid_x = std::min(std::max(unclamped_x, -1.0f), static_cast<float>(res_x));
+                const float grid_y = std::min(std::max(unclamped_y, -1.0f), static_cast<float>(res_y));
+
+                // Truncation of the positive shifted coordinates is the floor, avoiding a call without SSE 4.1
+                const int x0 = static_cast<int>(grid_x + 1.0f) - 1;
+                const int y0 = static_cast<int>(grid_y + 1.0f) - 1;
+
+                const float a_x = grid_x - static_cast<float>(x0);
+                const float a_y = grid_y - static_cast<float>(y0);
+
+                // Samples outside the grid get zero weight, and a clamped index to keep the gather in range
+                const float w_x0 = ((x0 >= 0) & (x0 < res_x)) ? 1.0f - a_x : 0.0f;
+                const float w_x1 = ((x0 + 1 >= 0) & (x0 + 1 < res_x)) ? a_x : 0.0f;
+                const float w_y0 = ((y0 >= 0) & (y0 < res_y)) ? 1.0f - a_y : 0.0f;
+                const float w_y1 = ((y0 + 1 >= 0) & (y0 + 1 < res_y)) ? a_y : 0.0f;
+
+                const int c_x0 = std::min(std::max(x0, 0), res_x - 1);
+                const int c_x1 = std::min(std::max(x0 + 1, 0), res_x - 1);
+                const int c_y0 = std::min(std::max(y0, 0), res_y - 1) * res_x;
+                const int c_y1 = std::min(std::max(y0 + 1, 0), res_y - 1) * res_x;
+
+                u[i] = w_y0 * (w_x0 * velocity_x[c_y0 + c_x0] + w_x1 * velocity_x[c_y0 + c_x1])
+                    + w_y1 * (w_x0 * velocity_x[c_y1 + c_x0] + w_x1 * velocity_x[c_y1 + c_x1]);
+                v[i] = w_y0 * (w_x0 * velocity_y[c_y0 + c_x0] + w_x1 * velocity_y[c_y0 + c_x1])
+                    + w_y1 * (w_x0 * velocity_y[c_y1 + c_x0] + w_x1 * velocity_y[c_y1 + c_x1]);
+            }
+        }
+
+        void streamlines_cpu::advect_rk4(block_state& block, const float sign) const
+        {
+            const float delta = this->integration_timestep;
+            const float min_cellsize = std::min(this->cell_size[0], this->cell_size[1]);
+
+            // Runge-Kutta stages of all lanes, each computed by one pass over the block
+            alignas(64) float factor[block_size];
+            alignas(64) float sample_x[block_size], sample_y[block_size];
+            alignas(64) float u1[block_size], v1[block_size], u2[block_size], v2[block_size];
+            alignas(64) float u3[block_size], v3[block_size], u4[block_size], v4[block_size];
+
+            // Calculate step size
+            interpolate_block(block.pos_x, block.pos_y, u1, v1);
+
+            #pragma omp simd
+            for (int i = 0; i < block_size; ++i)
+            {
+                // Divide unconditionally, as a masked division cannot be vectorized
+                const float max_velocity = std::sqrt(u1[i] * u1[i] + v1[i] * v1[i]);
+                const float step = min_cellsize / std::max(max_velocity, FLT_MIN);
+                factor[i] = (max_velocity > 0.0f ? step : 0.0f) * delta * sign;
+
+                u1[i] *= factor[i]; v1[i] *= factor[i];
+
+                sample_x[i] = block.pos_x[i] + 0.5f * u1[i];
+                sample_y[i] = block.pos_y[i] + 0.5f * v1[i];
+            }
+
+            // Calculate Runge-Kutta coefficients
+            interpolate_block(sample_x, sample_y, u2, v2);
+
+            #pragma omp simd
+            for (int i = 0; i < block_size; ++i)
+            {
+                u2[i] *= factor[i]; v2[i] *= factor[i];
+
+                sample_x[i] = block.pos_x[i] + 0.5f * u2[i];
+                sample_y[i] = block.pos_y[i] + 0.5f * v2[i];
+            }
+
+            interpolate_block(sample_x, sample_y, u3, v3);
+
+            #pragma omp simd
+            for (int i = 0; i < block_size; ++i)
+            {
+                u3[i] *= factor[i]; v3[i] *= factor[i];
+
+                sample_x[i] = block.pos_x[i] + u3[i];
+                sample_y[i] = block.pos_y[i] + v3[i];
+            }
+
+            interpolate_block(sample_x, sample_y, u4, v4);
+
+            #pragma omp simd
+            for (int i = 0; i < block_size; ++i)
+            {
+                u4[i] *= factor[i]; v4[i] *= factor[i];
+
+                sample_x[i] = block.pos_x[i] + (1.0f / 6.0f) * (u1[i] + 2.0f * u2[i] + 2.0f * u3[i] + u4[i]);
+                sample_y[i] = block.pos_y[i] + (1.0f / 6.0f) * (v1[i] + 2.0f * v2[i] + 2.0f * v3[i] + v4[i]);
+            }
+
+            // Advect and store position of active stream lines
+            for (int i = 0; i < block_size; ++i)
+            {
+                if (block.active[i])
+                {
+                    block.pos_x[i] = sample_x[i];
+                    block.pos_y[i] = sample_y[i];
+                }
+            }
+        }
+
+        void streamlines_cpu::advect_rk45(float& x, float& y, float& delta, const float sign) const
+        {
+            // Cash-Karp parameters
+            constexpr float b_21 = 0.2f;
+            constexpr float b_31 = 0.075f;
+            constexpr float b_41 = 0.3f;
+            constexpr float b_51 = -11.0f / 54.0f;
+            constexpr float b_61 = 1631.0f / 55296.0f;
+            constexpr float b_32 = 0.225f;
+            constexpr float b_42 = -0.9f;
+            constexpr float b_52 = 2.5f;
+            constexpr float b_62 = 175.0f / 512.0f;
+            constexpr float b_43 = 1.2f;
+            constexpr float b_53 = -70.0f / 27.0f;
+            constexpr float b_63 = 575.0f / 13824.0f;
+            constexpr float b_54 = 35.0f / 27.0f;
+            constexpr float b_64 = 44275.0f / 110592.0f;
+            constexpr float b_65 = 253.0f / 4096.0f;
+
+            constexpr float c_1 = 37.0f / 378.0f;
+            constexpr float c_3 = 250.0f / 621.0f;
+            constexpr float c_4 = 125.0f / 594.0f;
+            constexpr float c_6 = 512.0f / 1771.0f;
+
+            constexpr float c_1s = 2825.0f / 27648.0f;
+            constexpr float c_3s = 18575.0f / 48384.0f;
+            constexpr float c_4s = 13525.0f / 55296.0f;
+            constexpr float c_5s = 277.0f / 14336.0f;
+            constexpr float c_6s = 0.25f;
+
+            // Constants
+            constexpr float grow_exponent = -0.2f;
+            constexpr float shrink_exponent = -0.25f;
+            constexpr float max_growth = 5.0f;
+            constexpr float max_shrink = 0.1f;
+            constexpr float safety = 0.9f;
+
+            // Velocity at the current position, used for the first coefficient and as error scale
+            float u0, v0, w;
+            interpolate(x, y, u0, v0, w);
+
+            bool decreased = false;
+            float output_x, output_y;
+
+            do
+            {
+                const float f = delta * sign;
+
+                float u2, v2, u3, v3, u4, v4, u5, v5, u6, v6;
+
+                const float k1_x = f * u0, k1_y = f * v0;
+
+                interpolate(x + b_21 * k1_x, y + b_21 * k1_y, u2, v2, w);
+                const float k2_x = f * u2, k2_y = f * v2;
+
+                interpolate(x + b_31 * k1_x + b_32 * k2_x, y + b_31 * k1_y + b_32 * k2_y, u3, v3, w);
+                const float k3_x = f * u3, k3_y = f * v3;
+
+                interpolate(x + b_41 * k1_x + b_42 * k2_x + b_43 * k3_x, y + b_41 * k1_y + b_42 * k2_y + b_43 * k3_y, u4, v4, w);
+                const float k4_x = f * u4, k4_y = f * v4;
+
+                interpolate(x + b_51 * k1_x + b_52 * k2_x + b_53 * k3_x + b_54 * k4_x,
+                    y + b_51 * k1_y + b_52 * k2_y + b_53 * k3_y + b_54 * k4_y, u5, v5, w);
+                const float k5_x = f * u5, k5_y = f * v5;
+
+                interpolate(x + b_61 * k1_x + b_62 * k2_x + b_63 * k3_x + b_64 * k4_x + b_65 * k5_x,
+                    y + b_61 * k1_y + b_62 * k2_y + b_63 * k3_y + b_64 * k4_y + b_65 * k5_y, u6, v6, w);
+                const float k6_x = f * u6, k6_y = f * v6;
+
+                // Calculate error estimate
+                const float fifth_order_x = x + c_1 * k1_x + c_3 * k3_x + c_4 * k4_x + c_6 * k6_x;
+                const float fifth_order_y = y + c_1 * k1_y + c_3 * k3_y + c_4 * k4_y + c_6 * k6_y;
+
+                const float fourth_order_x = x + c_1s * k1_x + c_3s * k3_x + c_4s * k4_x + c_5s * k5_x + c_6s * k6_x;
+                const float fourth_order_y = y + c_1s * k1_y + c_3s * k3_y + c_4s * k4_y + c_5s * k5_y + c_6s * k6_y;
+
+                const float error = std::max(0.0f, std::max(std::abs(fifth_order_x - fourth_order_x) / std::abs(u0),
+                    std::abs(fifth_order_y - fourth_order_y) / std::abs(v0))) / this->max_integration_error;
+
+                if (error > 1.0f)
+                {
+                    // Error too large, reduce time step
+                    delta *= std::max(max_shrink, safety * std::pow(error, shrink_exponent));
+                    decreased = true;
+                }
+                else
+                {
+                    // Error (too) small, increase time step
+                    delta *= std::min(max_growth, safety * std::pow(error, grow_exponent));
+                    decreased = false;
+                }
+
+                output_x = fifth_order_x;
+                output_y = fifth_order_y;
+            }
+            while (decreased);
+
+            // Advect and store position
+            x = output_x;
+            y = output_y;
+        }
+
+        float streamlines_cpu::distance_to_structure(const int item, const float x, const float y) const
+        {
+            if (item < this->num_convergence_points)
+            {
+                const float diff_x = x - this->points[item * 2 + 0];
+                const float diff_y = y - this->points[item * 2 + 1];
+
+                return std::sqrt(diff_x * diff_x + diff_y * diff_y);
+            }
+
+            const int k = item - this->num_convergence_points;
+
+            const float p0_x = this->lines[k * 4 + 0], p0_y = this->lines[k * 4 + 1];
+            const float p1_x = this->lines[k * 4 + 2], p1_y = this->lines[k * 4 + 3];
+
+            // Test if one of the line endpoints is closest to the point
+            const float length = std::sqrt((p1_x - p0_x) * (p1_x - p0_x) + (p1_y - p0_y) * (p1_y - p0_y));
+
+            const float line_x = length > 0.0f ? (p1_x - p0_x) / length : 0.0f;
+            const float line_y = length > 0.0f ? (p1_y - p0_y) / length : 0.0f;
+
+            const float d = line_x * (x - p0_x) + line_y * (y - p0_y);
+
+            float diff_x, diff_y;
+
+            if (d < 0.0f)
+            {
+                diff_x = x - p0_x;
+                diff_y = y - p0_y;
+            }
+            else if (d > length)
+            {
+                diff_x = x - p1_x;
+                diff_y = y - p1_y;
+            }
+            else
+            {
+                // Project point onto line and calculate the distance
+                diff_x = x - (p0_x + line_x * d);
+                diff_y = y - (p0_y + line_y * d);
+            }
+
+            return std::sqrt(diff_x * diff_x + diff_y * diff_y);
+        }
+
+        int streamlines_cpu::find_nearest_structure(const float x, const float y, const float max_distance, float& nearest_distance) const
+        {
+            int nearest = -1;
+            nearest_distance = max_distance;
+
+            if (this->grid.cell_offsets.empty())
+            {
+                return nearest;
+            }
+
+            // Get cell containing the position, or the closest cell if the position lies outside the grid
+            const auto& resolution = this->grid.resolution;
+
+            const int cell_x = std::min(std::max(static_cast<int>(std::floor((x - this->grid.origin[0]) / this->grid.cell_size[0])), 0), resolution[0] - 1);
+            const int cell_y = std::min(std::max(static_cast<int>(std::floor((y - this->grid.origin[1]) / this->grid.cell_size[1])), 0), resolution[1] - 1);
+
+            const float min_cell_size = std::min(this->grid.cell_size[0], this->grid.cell_size[1]);
+            const int max_ring = std::max(resolution[0], resolution[1]);
+
+            // Visit cells in rings around the cell until the remaining rings cannot contain a closer structure
+            for (int ring = 0; ring <= max_ring; ++ring)
+            {
+                if (ring > 0 && (ring - 1) * min_cell_size > nearest_distance)
+                {
+                    break;
+                }
+
+                for (int cy = std::max(cell_y - ring, 0); cy <= std::min(cell_y + ring, resolution[1] - 1); ++cy)
+                {
+                    // Only visit cells on the perimeter of the ring
+                    const int step = (cy == cell_y - ring || cy == cell_y + ring) ? 1 : 2 * ring;
+
+                    for (int cx = cell_x - ring; cx <= cell_x + ring; cx += step)
+                    {
+                        if (cx < 0 || cx >= resolution[0])
+                        {
+                            continue;
+                        }
+
+                        const int cell = cy * resolution[0] + cx;
+
+                        for (int i = this->grid.cell_offsets[cell]; i < this->grid.cell_offsets[cell + 1]; ++i)
+                        {
+                            const int item = this->grid.cell_items[i];
+                            const float dist = distance_to_structure(item, x, y);
+
+                            // Prefer lower indices for equal distances, as a linear search would
+                            if (dist < nearest_distance || (dist == nearest_distance && nearest != -1 && item < nearest))
+                            {
+                                nearest = item;
+                                nearest_distance = dist;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return nearest;
+        }
+
+        void streamlines_cpu::update_label_and_dist(const float x, const float y, short& label, float& distance) const
+        {
+#if __streamlines_cuda_shi_et_al
+            label = -1;
+            distance = FLT_MAX;
+#endif
+
+            // Find the nearest convergence structure that is closer than the previous one
+            float nearest_distance;
+            const int nearest = find_nearest_structure(x, y, distance, nearest_distance);
+
+            if (nearest != -1 && nearest_distance < distance)
+            {
+                label = static_cast<short>(static_cast<int>(this->ids[nearest]));
+                distance = nearest_distance;
+            }
+        }
+
+        void streamlines_cpu::compute_streamlines(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+            std::vector<float>& terminations, const int num_integration_steps, const float sign) const
+        {
+            const long long num_particles = static_cast<long long>(labels.size());
+            const long long num_blocks = (num_particles + block_size - 1) / block_size;
+
+            const float half_cell = 0.5f * std::min(this->cell_size[0], this->cell_size[1]);
+
+            // Blocks are dynamically scheduled, as stream lines terminate at different times
+            #pragma omp parallel for schedule(dynamic)
+            for (long long block_index = 0; block_index < num_blocks; ++block_index)
+            {
+                const long long first = block_index * block_size;
+                const int num_block_particles = static_cast<int>(std::min(static_cast<long long>(block_size), num_particles - first));
+
+                // Load block, where already terminated stream lines, and padding, are inactive
+                block_state block;
+                int num_active = 0;
+
+                for (int i = 0; i < block_size; ++i)
+                {
+                    const bool valid = i < num_block_particles;
+
+                    block.pos_x[i] = valid ? source[2 * (first + i) + 0] : this->domain_offset[0];
+                    block.pos_y[i] = valid ? source[2 * (first + i) + 1] : this->domain_offset[1];
+                    block.label[i] = valid ? static_cast<short>(labels[first + i]) : -1;
+                    block.dist[i] = valid ? distances[first + i] : 0.0f;
+                    block.termination[i] = valid ? static_cast<short>(terminations[first + i]) : -1;
+                    block.active[i] = valid && block.termination[i] == 0;
+
+                    if (block.active[i])
+                    {
+#if !(__streamlines_cuda_shi_et_al)
+                        // Initially update values by evaluating the distance to convergence structures
+                        update_label_and_dist(block.pos_x[i], block.pos_y[i], block.label[i], block.dist[i]);
+#endif
+
+                        // Calculate initial time step
+                        float u, v, w;
+                        interpolate(block.pos_x[i], block.pos_y[i], u, v, w);
+
+                        block.step[i] = this->integration_timestep * this->cell_diagonal * w;
+
+                        block.anchor_x[i] = block.pos_x[i];
+                        block.anchor_y[i] = block.pos_y[i];
+                        block.anchor_label[i] = block.label[i];
+                        block.anchor_steps[i] = 0;
+
+                        ++num_active;
+                    }
+                }
+
+                for (int j = 0; j < num_integration_steps && num_active > 0; ++j)
+                {
+                    float previous_x[block_size], previous_y[block_size];
+
+                    std::copy_n(block.pos_x, block_size, previous_x);
+                    std::copy_n(block.pos_y, block_size, previous_y);
+
+                    // Advect
+                    if (this->method == streamlines_cuda::integration_method::RUNGE_KUTTA_4)
+                    {
+                        advect_rk4(block, sign);
+                    }
+                    else
+                    {
+                        for (int i = 0; i < block_size; ++i)
+                        {
+                            if (block.active[i])
+                            {
+                                advect_rk45(block.pos_x[i], block.pos_y[i], block.step[i], sign);
+                            }
+                        }
+                    }
+
+                    // Update labels, and check for termination
+                    for (int i = 0; i < block_size; ++i)
+                    {
+                        if (!block.active[i])
+                        {
+                            continue;
+                        }
+
+#if !(__streamlines_cuda_shi_et_al)
+                        // Update values by evaluating the distance to convergence structures
+                        update_label_and_dist(block.pos_x[i], block.pos_y[i], block.label[i], block.dist[i]);
+#endif
+
+                        // If advection had no effect, terminate, indicating if there is a convergence structure within half a cell
+                        if (previous_x[i] == block.pos_x[i] && previous_y[i] == block.pos_y[i])
+                        {
+                            float nearest_distance;
+
+                            block.termination[i] = find_nearest_structure(block.pos_x[i], block.pos_y[i], half_cell, nearest_distance) != -1 ? 3 : 2;
+                            block.active[i] = false;
+                            --num_active;
+
+                            continue;
+                        }
+
+                        // If current position is outside of the domain, terminate
+                        const float pos_01_x = (block.pos_x[i] - this->domain_offset[0]) * this->domain_scale[0];
+                        const float pos_01_y = (block.pos_y[i] - this->domain_offset[1]) * this->domain_scale[1];
+
+                        if (pos_01_x < 0.0f || pos_01_x > 1.0f || pos_01_y < 0.0f || pos_01_y > 1.0f)
+                        {
+                            block.termination[i] = 1;
+                            block.active[i] = false;
+                            --num_active;
+
+#if __streamlines_cuda_shi_et_al
+                            block.label[i] = -1;
+                            block.dist[i] = 0.0f;
+#endif
+
+                            continue;
+                        }
+
+                        // If the stream line converged to its labelled structure, terminate, as its label cannot change anymore
+                        if (block.label[i] != -1)
+                        {
+                            bool converged = this->convergence_distance > 0.0f && block.dist[i] < this->convergence_distance;
+
+                            if (!converged && this->convergence_steps > 0)
+                            {
+                                const float dx = block.pos_x[i] - block.anchor_x[i];
+                                const float dy = block.pos_y[i] - block.anchor_y[i];
+
+                                if (block.label[i] != block.anchor_label[i] || std::sqrt(dx * dx + dy * dy) > this->convergence_radius)
+                                {
+                                    block.anchor_x[i] = block.pos_x[i];
+                                    block.anchor_y[i] = block.pos_y[i];
+                                    block.anchor_label[i] = block.label[i];
+                                    block.anchor_steps[i] = 0;
+                                }
+                                else
+                                {
+                                    converged = ++block.anchor_steps[i] >= static_cast<int>(this->convergence_steps);
+                                }
+                            }
+
+                            if (converged)
+                            {
+                                block.termination[i] = 5;
+                                block.active[i] = false;
+                                --num_active;
+                            }
+                        }
+                    }
+                }
+
+                // Store values of stream lines that were active initially
+                for (int i = 0; i < num_block_particles; ++i)
+                {
+                    if (terminations[first + i] != 0.0f)
+                    {
+                        continue;
+                    }
+
+#if __streamlines_cuda_shi_et_al
+                    // Update values by evaluating the distance to convergence structures at the final position
+                    update_label_and_dist(block.pos_x[i], block.pos_y[i], block.label[i], block.dist[i]);
+#endif
+
+                    source[2 * (first + i) + 0] = block.pos_x[i];
+                    source[2 * (first + i) + 1] = block.pos_y[i];
+                    labels[first + i] = block.label[i];
+                    distances[first + i] = block.dist[i];
+                    terminations[first + i] = block.termination[i];
+                }
+            }
+        }
+    }
+}
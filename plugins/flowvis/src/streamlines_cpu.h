@@ -0,0 +1,248 @@
+/*
+ * streamlines_cpu.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "../cuda/convergence_grid.h"
+#include "../cuda/streamlines.h"
+
+#include <array>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Class for computation of stream lines, corresponding labels and distances on the CPU.
+        * Provides the same interface and semantics as streamlines_cuda, for systems without CUDA device.
+        * Seeds are processed in blocks, stored as structure of arrays to allow for vectorization,
+        * which are distributed dynamically among the threads.
+        */
+        class streamlines_cpu
+        {
+        public:
+            /**
+            * Initialize constants and sampled fields
+            *
+            * @param resolution                 Domain resolution (number of vectors per direction)
+            * @param domain                     Domain size (minimum and maximum coordinates)
+            * @param vectors                    Vectors defining the vector field to analyze
+            * @param points                     Convergence structures defined as points
+            * @param point_ids                  IDs (or labels) of the point convergence structures
+            * @param lines                      Convergence structures defined as lines
+            * @param line_ids                   IDs (or labels) of the line convergence structures
+            * @param integration_timestep       Time step factor for advection
+            * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
+            * @param method                     Integration method
+            */
+            streamlines_cpu(const std::array<unsigned int, 2>& resolution, const std::array<float, 4>& domain,
+                const std::vector<float>& vectors, const std::vector<float>& points, const std::vector<int>& point_ids,
+                const std::vector<float>& lines, const std::vector<int>& line_ids, float integration_timestep,
+                float max_integration_error, streamlines_cuda::integration_method method);
+
+            /**
+            * Set time step information and integration method for subsequent integrations
+            *
+            * @param integration_timestep       Time step factor for advection
+            * @param max_integration_error      Maximum error for Runge-Kutta 4-5, above which the time step size has to be adapted
+            * @param method                     Integration method
+            */
+            void set_integration_parameters(float integration_timestep, float max_integration_error, streamlines_cuda::integration_method method);
+
+            /**
+            * Set criteria for terminating stream lines early, as for the CUDA implementation
+            *
+            * @param distance                   Terminate if the distance to the labelled structure falls below this distance; 0 to disable
+            * @param num_steps                  Terminate if the label did not change for this number of steps, while the stream line
+            *                                   stayed within the radius; 0 to disable
+            * @param radius                     Radius for the number of steps
+            */
+            void set_convergence_criteria(float distance, unsigned int num_steps, float radius);
+
+            /**
+            * Update labels for the given seed
+            *
+            * @param source                     In/output seed for advecting stream lines
+            * @param labels                     In/output labels
+            * @param distances                  In/output distances
+            * @param terminations               In/output termination reasons
+            * @param num_integration_steps      Number of integration steps
+            * @param sign                       Sign indicating forward (1) or backward (-1) integration
+            * @param num_particles_per_batch    Unused, for compatibility with the CUDA interface
+            */
+            void update_labels(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+                std::vector<float>& terminations, int num_integration_steps, float sign, unsigned int num_particles_per_batch);
+
+            /**
+            * Update labels for the given forward and backward seed
+            *
+            * @param source_forward             In/output seed for advecting stream lines forward
+            * @param labels_forward             In/output labels of forward integration
+            * @param distances_forward          In/output distances of forward integration
+            * @param terminations_forward       In/output termination reasons of forward integration
+            * @param source_backward            In/output seed for advecting stream lines backward
+            * @param labels_backward            In/output labels of backward integration
+            * @param distances_backward         In/output distances of backward integration
+            * @param terminations_backward      In/output termination reasons of backward integration
+            * @param num_integration_steps      Number of integration steps
+            * @param identical_seeds            Unused, for compatibility with the CUDA interface
+            * @param num_particles_per_batch    Unused, for compatibility with the CUDA interface
+            */
+            void update_labels_bidirectional(std::vector<float>& source_forward, std::vector<float>& labels_forward,
+                std::vector<float>& distances_forward, std::vector<float>& terminations_forward,
+                std::vector<float>& source_backward, std::vector<float>& labels_backward,
+                std::vector<float>& distances_backward, std::vector<float>& terminations_backward,
+                int num_integration_steps, bool identical_seeds, unsigned int num_particles_per_batch);
+
+        private:
+            /** Number of seeds per block, processed together */
+            static constexpr int block_size = 16;
+
+            /**
+            * State of a block of stream lines, stored as structure of arrays
+            */
+            struct block_state
+            {
+                alignas(64) float pos_x[block_size];
+                alignas(64) float pos_y[block_size];
+                float step[block_size];
+                float dist[block_size];
+                short label[block_size];
+                short termination[block_size];
+                bool active[block_size];
+
+                float anchor_x[block_size];
+                float anchor_y[block_size];
+                short anchor_label[block_size];
+                int anchor_steps[block_size];
+            };
+
+            /**
+            * Bilinearly interpolate the vector field, where values outside the grid are zero
+            *
+            * @param x      Position x-coordinate
+            * @param y      Position y-coordinate
+            * @param u      Output vector x-component
+            * @param v      Output vector y-component
+            * @param w      Output sum of the weights of samples within the grid
+            */
+            void interpolate(float x, float y, float& u, float& v, float& w) const;
+
+            /**
+            * Bilinearly interpolate the vector field for all lanes of a block, where values outside the grid are zero.
+            * Branch-free, such that the lanes are processed as vector registers with gathered samples.
+            *
+            * @param x      Position x-coordinates
+            * @param y      Position y-coordinates
+            * @param u      Output vector x-components
+            * @param v      Output vector y-components
+            */
+            void interpolate_block(const float* x, const float* y, float* u, float* v) const;
+
+            /**
+            * Advect all active stream lines of a block using 4th-order Runge-Kutta
+            *
+            * @param block  In/out block state
+            * @param sign   Sign (1: forward, -1: backward integration)
+            */
+            void advect_rk4(block_state& block, float sign) const;
+
+            /**
+            * Advect a single stream line using 4th-order Runge-Kutta with 5th-order error estimation for adaptive time steps
+            *
+            * @param x      In/out position x-coordinate
+            * @param y      In/out position y-coordinate
+            * @param delta  In/out time step coefficient
+            * @param sign   Sign (1: forward, -1: backward integration)
+            */
+            void advect_rk45(float& x, float& y, float& delta, float sign) const;
+
+            /**
+            * Calculate the distance between a position and a convergence structure
+            *
+            * @param item   Index of the convergence structure, with points first, followed by lines
+            * @param x      Position x-coordinate
+            * @param y      Position y-coordinate
+            *
+            * @return Distance between the position and the convergence structure
+            */
+            float distance_to_structure(int item, float x, float y) const;
+
+            /**
+            * Find the convergence structure nearest to the given position that is closer than the given maximum distance
+            *
+            * @param x                  Position x-coordinate
+            * @param y                  Position y-coordinate
+            * @param max_distance       Maximum distance; only structures closer than this are considered
+            * @param nearest_distance   Output distance to the nearest structure, or the maximum distance if none was found
+            *
+            * @return Index of the nearest structure, with points first, followed by lines; -1 if none was found
+            */
+            int find_nearest_structure(float x, float y, float max_distance, float& nearest_distance) const;
+
+            /**
+            * Update label and distance if a convergence structure is closer than the previous one
+            *
+            * @param x          Position x-coordinate
+            * @param y          Position y-coordinate
+            * @param label      In/out (previous) label
+            * @param distance   In/out (previous) distance
+            */
+            void update_label_and_dist(float x, float y, short& label, float& distance) const;
+
+            /**
+            * Compute stream lines of one direction and update the given labels and distances
+            *
+            * @param source                     In/output seed for advecting stream lines
+            * @param labels                     In/output labels
+            * @param distances                  In/output distances
+            * @param terminations               In/output termination reasons
+            * @param num_integration_steps      Number of integration steps
+            * @param sign                       Sign indicating forward (1) or backward (-1) integration
+            */
+            void compute_streamlines(std::vector<float>& source, std::vector<float>& labels, std::vector<float>& distances,
+                std::vector<float>& terminations, int num_integration_steps, float sign) const;
+
+            // Vector field resolution and transformation into grid coordinates
+            std::array<int, 2> resolution;
+            std::array<float, 2> domain_offset;
+            std::array<float, 2> domain_scale;
+            std::array<float, 2> grid_scale;
+
+            // Cell size and corresponding initial time step for Runge-Kutta 4-5
+            std::array<float, 2> cell_size;
+            float cell_diagonal;
+
+            // Vector field, stored as structure of arrays
+            std::vector<float> velocity_x;
+            std::vector<float> velocity_y;
+
+            // Convergence structures with their ids
+            std::vector<float> points;
+            std::vector<float> lines;
+            std::vector<float> ids;
+
+            int num_convergence_points;
+            int num_convergence_lines;
+
+            // Uniform grid over the convergence structures
+            convergence_grid_data grid;
+
+            // Time step information
+            float integration_timestep;
+            float max_integration_error;
+
+            // Integration method
+            streamlines_cuda::integration_method method;
+
+            // Criteria for terminating converged stream lines
+            float convergence_distance;
+            unsigned int convergence_steps;
+            float convergence_radius;
+        };
+    }
+}
@@ -0,0 +1,322 @@
+#include "stdafx.h"
+#include "synthetic_vector_field.h"
+
+#include "vector_field_call.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        synthetic_vector_field::synthetic_vector_field() :
+            output_slot("output_slot", "Output slot for the vector field"),
+            field_type("field_type", "Analytic vector field"),
+            resolution_x("resolution_x", "Number of vectors in x direction"),
+            resolution_y("resolution_y", "Number of vectors in y direction"),
+            lattice_cells("lattice_cells", "Number of lattice cells per direction, each containing a source, a sink and two saddles"),
+            gyre_amplitude("gyre_amplitude", "Velocity magnitude of the double gyre"),
+            gyre_epsilon("gyre_epsilon", "Horizontal oscillation of the separatrix of the double gyre"),
+            gyre_period("gyre_period", "Period of the oscillation of the double gyre"),
+            frame_count("frame_count", "Number of frames of the time-dependent double gyre"),
+            frame_time_step("frame_time_step", "Time between two frames"),
+            num_vortices("num_vortices", "Number of randomly placed vortices"),
+            vortex_radius("vortex_radius", "Core radius of the vortices"),
+            random_seed("random_seed", "Seed for placing the vortices")
+        {
+            // Set connections and parameters
+            this->output_slot.SetCallback(vector_field_call::ClassName(), vector_field_call::FunctionName(0), &synthetic_vector_field::get_data);
+            this->output_slot.SetCallback(vector_field_call::ClassName(), vector_field_call::FunctionName(1), &synthetic_vector_field::get_extent);
+            this->MakeSlotAvailable(&this->output_slot);
+
+            this->field_type << new core::param::EnumParam(static_cast<int>(field_t::CRITICAL_POINT_LATTICE));
+            this->field_type.Param<core::param::EnumParam>()->SetTypePair(static_cast<int>(field_t::CRITICAL_POINT_LATTICE), "Source/sink/saddle lattice");
+            this->field_type.Param<core::param::EnumParam>()->SetTypePair(static_cast<int>(field_t::DOUBLE_GYRE), "Double gyre");
+            this->field_type.Param<core::param::EnumParam>()->SetTypePair(static_cast<int>(field_t::RANDOM_VORTICES), "Random vortices");
+            this->MakeSlotAvailable(&this->field_type);
+
+            this->resolution_x << new core::param::IntParam(256, 2);
+            this->MakeSlotAvailable(&this->resolution_x);
+
+            this->resolution_y << new core::param::IntParam(256, 2);
+            this->MakeSlotAvailable(&this->resolution_y);
+
+            this->lattice_cells << new core::param::IntParam(4, 1);
+            this->MakeSlotAvailable(&this->lattice_cells);
+
+            this->gyre_amplitude << new core::param::FloatParam(0.1f);
+            this->MakeSlotAvailable(&this->gyre_amplitude);
+
+            this->gyre_epsilon << new core::param::FloatParam(0.25f, 0.0f);
+            this->MakeSlotAvailable(&this->gyre_epsilon);
+
+            this->gyre_period << new core::param::FloatParam(10.0f, 0.0001f);
+            this->MakeSlotAvailable(&this->gyre_period);
+
+            this->frame_count << new core::param::IntParam(1, 1);
+            this->MakeSlotAvailable(&this->frame_count);
+
+            this->frame_time_step << new core::param::FloatParam(0.1f);
+            this->MakeSlotAvailable(&this->frame_time_step);
+
+            this->num_vortices << new core::param::IntParam(16, 1);
+            this->MakeSlotAvailable(&this->num_vortices);
+
+            this->vortex_radius << new core::param::FloatParam(0.05f, 0.0001f);
+            this->MakeSlotAvailable(&this->vortex_radius);
+
+            this->random_seed << new core::param::IntParam(42, 0);
+            this->MakeSlotAvailable(&this->random_seed);
+
+            // Initialize stored data
+            this->stored_data.bounding_rectangle = vislib::math::Rectangle<float>(0.0f, 0.0f, 1.0f, 1.0f);
+            this->stored_data.resolution = { 0u, 0u };
+            this->stored_data.frame_count = 1;
+            this->stored_data.frame_id = 0;
+            this->stored_data.time = 0.0f;
+            this->stored_data.hash = 0;
+
+            // Compute the field on first request
+            this->field_type.ForceSetDirty();
+        }
+
+        synthetic_vector_field::~synthetic_vector_field()
+        {
+            this->Release();
+        }
+
+        bool synthetic_vector_field::create()
+        {
+            return true;
+        }
+
+        void synthetic_vector_field::release()
+        {
+            this->stored_data.vectors = nullptr;
+        }
+
+        bool synthetic_vector_field::get_data(core::Call& call)
+        {
+            // Get call
+            auto* vf_call = dynamic_cast<vector_field_call*>(&call);
+
+            if (vf_call == nullptr)
+            {
+                return false;
+            }
+
+            update_parameters();
+
+            // Compute the requested frame
+            compute_frame(vf_call->get_frame_id());
+
+            vf_call->set_resolution(this->stored_data.resolution);
+            vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
+            vf_call->set_frame_count(this->stored_data.frame_count);
+
+            vf_call->set_frame_id(this->stored_data.frame_id);
+            vf_call->set_time(this->stored_data.time);
+            vf_call->set_vectors(this->stored_data.vectors);
+
+            vf_call->SetDataHash(this->stored_data.hash);
+
+            return true;
+        }
+
+        bool synthetic_vector_field::get_extent(core::Call& call)
+        {
+            // Get call
+            auto* vf_call = dynamic_cast<vector_field_call*>(&call);
+
+            if (vf_call == nullptr)
+            {
+                return false;
+            }
+
+            update_parameters();
+
+            vf_call->set_resolution(this->stored_data.resolution);
+            vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
+            vf_call->set_frame_count(this->stored_data.frame_count);
+
+            return true;
+        }
+
+        void synthetic_vector_field::update_parameters()
+        {
+            if (!(this->field_type.IsDirty() || this->resolution_x.IsDirty() || this->resolution_y.IsDirty() || this->lattice_cells.IsDirty() ||
+                this->gyre_amplitude.IsDirty() || this->gyre_epsilon.IsDirty() || this->gyre_period.IsDirty() || this->frame_count.IsDirty() ||
+                this->frame_time_step.IsDirty() || this->num_vortices.IsDirty() || this->vortex_radius.IsDirty() || this->random_seed.IsDirty()))
+            {
+                return;
+            }
+
+            this->field_type.ResetDirty();
+            this->resolution_x.ResetDirty();
+            this->resolution_y.ResetDirty();
+            this->lattice_cells.ResetDirty();
+            this->gyre_amplitude.ResetDirty();
+            this->gyre_epsilon.ResetDirty();
+            this->gyre_period.ResetDirty();
+            this->frame_count.ResetDirty();
+            this->frame_time_step.ResetDirty();
+            this->num_vortices.ResetDirty();
+            this->vortex_radius.ResetDirty();
+            this->random_seed.ResetDirty();
+
+            const auto type = static_cast<field_t>(this->field_type.Param<core::param::EnumParam>()->Value());
+
+            // The double gyre is defined on [0, 2] x [0, 1], and is the only time-dependent field
+            this->stored_data.bounding_rectangle = type == field_t::DOUBLE_GYRE
+                ? vislib::math::Rectangle<float>(0.0f, 0.0f, 2.0f, 1.0f) : vislib::math::Rectangle<float>(0.0f, 0.0f, 1.0f, 1.0f);
+
+            this->stored_data.resolution = { static_cast<unsigned int>(this->resolution_x.Param<core::param::IntParam>()->Value()),
+                static_cast<unsigned int>(this->resolution_y.Param<core::param::IntParam>()->Value()) };
+
+            this->stored_data.frame_count = type == field_t::DOUBLE_GYRE
+                ? static_cast<unsigned int>(this->frame_count.Param<core::param::IntParam>()->Value()) : 1;
+
+            this->stored_data.vectors = nullptr;
+        }
+
+        void synthetic_vector_field::compute_frame(const unsigned int frame_id)
+        {
+            const auto frame = std::min(frame_id, this->stored_data.frame_count - 1);
+
+            if (this->stored_data.vectors != nullptr && this->stored_data.frame_id == frame)
+            {
+                return;
+            }
+
+            const auto type = static_cast<field_t>(this->field_type.Param<core::param::EnumParam>()->Value());
+            const auto time = frame * this->frame_time_step.Param<core::param::FloatParam>()->Value();
+
+            const auto x_num = this->stored_data.resolution[0];
+            const auto y_num = this->stored_data.resolution[1];
+
+            const auto& rectangle = this->stored_data.bounding_rectangle;
+
+            const float x_step = rectangle.Width() / (x_num - 1);
+            const float y_step = rectangle.Height() / (y_num - 1);
+
+            constexpr float pi = 3.14159265358979323846f;
+
+            // Place vortices; the values are derived from the raw engine output, whose sequence is
+            // standardized, instead of using distributions, which differ between standard libraries
+            std::vector<std::array<float, 3>> vortices;
+
+            if (type == field_t::RANDOM_VORTICES)
+            {
+                std::mt19937 generator(static_cast<std::mt19937::result_type>(this->random_seed.Param<core::param::IntParam>()->Value()));
+
+                auto random = [&generator]() { return static_cast<float>(generator()) / 4294967296.0f; };
+
+                vortices.resize(static_cast<std::size_t>(this->num_vortices.Param<core::param::IntParam>()->Value()));
+
+                for (auto& vortex : vortices)
+                {
+                    vortex[0] = random();
+                    vortex[1] = random();
+
+                    // Circulation with random sign and magnitude in [0.5, 1)
+                    const float magnitude = 0.5f + 0.5f * random();
+                    vortex[2] = random() < 0.5f ? -magnitude : magnitude;
+                }
+            }
+
+            const int lattice_cells = this->lattice_cells.Param<core::param::IntParam>()->Value();
+
+            const float gyre_amplitude = this->gyre_amplitude.Param<core::param::FloatParam>()->Value();
+            const float gyre_epsilon = this->gyre_epsilon.Param<core::param::FloatParam>()->Value();
+            const float gyre_omega = 2.0f * pi / this->gyre_period.Param<core::param::FloatParam>()->Value();
+
+            const float vortex_radius_squared = std::pow(this->vortex_radius.Param<core::param::FloatParam>()->Value(), 2.0f);
+
+            auto vectors = std::make_shared<std::vector<float>>(static_cast<std::size_t>(x_num) * y_num * 2);
+
+            #pragma omp parallel for
+            for (long long y_index = 0; y_index < static_cast<long long>(y_num); ++y_index)
+            {
+                const float y = rectangle.Bottom() + y_index * y_step;
+
+                for (std::size_t x_index = 0; x_index < x_num; ++x_index)
+                {
+                    const float x = rectangle.Left() + x_index * x_step;
+
+                    float u = 0.0f, v = 0.0f;
+
+                    switch (type)
+                    {
+                    case field_t::CRITICAL_POINT_LATTICE:
+                    {
+                        // Critical points at all multiples of the cell size; the signs of the eigenvalues alternate
+                        // between neighboring points, resulting in sources, sinks, and saddles
+                        u = std::sin(pi * lattice_cells * x);
+                        v = std::sin(pi * lattice_cells * y);
+
+                        break;
+                    }
+                    case field_t::DOUBLE_GYRE:
+                    {
+                        // Shadden et al. 2005
+                        const float a = gyre_epsilon * std::sin(gyre_omega * time);
+                        const float b = 1.0f - 2.0f * gyre_epsilon * std::sin(gyre_omega * time);
+
+                        const float f = a * x * x + b * x;
+                        const float df = 2.0f * a * x + b;
+
+                        u = -pi * gyre_amplitude * std::sin(pi * f) * std::cos(pi * y);
+                        v = pi * gyre_amplitude * std::cos(pi * f) * std::sin(pi * y) * df;
+
+                        break;
+                    }
+                    case field_t::RANDOM_VORTICES:
+                    {
+                        // Superposition of Lamb-Oseen vortices, each a center in its own velocity field
+                        for (const auto& vortex : vortices)
+                        {
+                            const float dx = x - vortex[0];
+                            const float dy = y - vortex[1];
+                            const float r_squared = dx * dx + dy * dy;
+
+                            if (r_squared > 0.0f)
+                            {
+                                const float factor = vortex[2] / (2.0f * pi * r_squared) * (1.0f - std::exp(-r_squared / vortex_radius_squared));
+
+                                u -= factor * dy;
+                                v += factor * dx;
+                            }
+                        }
+
+                        break;
+                    }
+                    }
+
+                    const std::size_t xy = static_cast<std::size_t>(y_index) * x_num + x_index;
+
+                    (*vectors)[xy * 2 + 0] = u;
+                    (*vectors)[xy * 2 + 1] = v;
+                }
+            }
+
+            this->stored_data.frame_id = frame;
+            this->stored_data.time = time;
+            this->stored_data.vectors = vectors;
+
+            ++this->stored_data.hash;
+        }
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * synthetic_vector_field.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "vector_field_call.h"
+
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * Source of analytic 2D vector fields with known topology, for reproducible measurements without input files.
+        *
+        * Available fields are a lattice of sources, sinks and saddles, the (time-dependent) double gyre,
+        * and a superposition of randomly placed Lamb-Oseen vortices.
+        *
+        * @author Alexander Straub
+        */
+        class synthetic_vector_field : public core::Module
+        {
+        public:
+            /**
+             * Answer the name of this module.
+             *
+             * @return The name of this module.
+             */
+            static const char* ClassName() { return "synthetic_vector_field"; }
+
+            /**
+             * Answer a human readable description of this module.
+             *
+             * @return A human readable description of this module.
+             */
+            static const char* Description() { return "Source of analytic vector fields with known topology"; }
+
+            /**
+             * Answers whether this module is available on the current system.
+             *
+             * @return 'true' if the module is available, 'false' otherwise.
+             */
+            static bool IsAvailable() { return true; }
+
+            /**
+            * Constructor
+            */
+            synthetic_vector_field();
+
+            /**
+            * Destructor
+            */
+            ~synthetic_vector_field();
+
+        protected:
+            /**
+             * Implementation of 'Create'.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            virtual bool create() override;
+
+            /**
+             * Implementation of 'Release'.
+             */
+            virtual void release() override;
+
+        private:
+            /** Available fields */
+            enum class field_t
+            {
+                CRITICAL_POINT_LATTICE,
+                DOUBLE_GYRE,
+                RANDOM_VORTICES
+            };
+
+            /**
+             * Callbacks for providing the vector field.
+             *
+             * @return 'true' on success, 'false' otherwise.
+             */
+            bool get_data(core::Call& call);
+            bool get_extent(core::Call& call);
+
+            /**
+            * Update domain information from the parameters, invalidating the vectors if any parameter changed
+            */
+            void update_parameters();
+
+            /**
+            * Compute the vectors of the requested frame, if not already computed
+            *
+            * @param frame_id   Requested frame, clamped to the available frames
+            */
+            void compute_frame(unsigned int frame_id);
+
+            /** Output slot */
+            core::CalleeSlot output_slot;
+
+            /** Field and resolution */
+            core::param::ParamSlot field_type;
+            core::param::ParamSlot resolution_x, resolution_y;
+
+            /** Number of lattice cells per direction */
+            core::param::ParamSlot lattice_cells;
+
+            /** Double gyre parameters, and number of frames with their time step */
+            core::param::ParamSlot gyre_amplitude;
+            core::param::ParamSlot gyre_epsilon;
+            core::param::ParamSlot gyre_period;
+            core::param::ParamSlot frame_count;
+            core::param::ParamSlot frame_time_step;
+
+            /** Number of random vortices, their core radius, and the seed of the random number generator */
+            core::param::ParamSlot num_vortices;
+            core::param::ParamSlot vortex_radius;
+            core::param::ParamSlot random_seed;
+
+            /** Output data */
+            struct data_t
+            {
+                /** Bounding rectangle */
+                vislib::math::Rectangle<float> bounding_rectangle;
+
+                /** Grid resolution */
+                std::array<unsigned int, 2> resolution;
+
+                /** Number of frames */
+                unsigned int frame_count;
+
+                /** Computed frame, its time and vectors */
+                unsigned int frame_id;
+                float time;
+
+                std::shared_ptr<std::vector<float>> vectors;
+
+                /** Current hash */
+                SIZE_T hash;
+
+            } stored_data;
+        };
+    }
+}
@@ -0,0 +1,194 @@
+#include "stdafx.h"
+#include "tiled_vector_field.h"
+
+#include "vislib/math/Rectangle.h"
+
+#include "Eigen/Dense"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        tiled_vector_field::tiled_vector_field(const std::array<unsigned int, 2>& resolution, const vislib::math::Rectangle<float>& bounding_rectangle,
+            const unsigned int tile_size, const std::size_t cache_size, loader_t loader) :
+            resolution(resolution), bounding_rectangle(bounding_rectangle),
+            cell_size(bounding_rectangle.Width() / (std::max(resolution[0], 2u) - 1), bounding_rectangle.Height() / (std::max(resolution[1], 2u) - 1)),
+            tile_size(tile_size),
+            num_tiles{ tile_size > 0 ? (std::max(resolution[0], 2u) - 2) / tile_size + 1 : 0, tile_size > 0 ? (std::max(resolution[1], 2u) - 2) / tile_size + 1 : 0 },
+            loader(std::move(loader)), cache_size(cache_size), cache_statistics{ 0, 0 }
+        {
+            if (resolution[0] < 2 || resolution[1] < 2)
+            {
+                throw std::runtime_error("Tiled vector fields need at least two vectors per direction");
+            }
+
+            if (tile_size == 0 || cache_size == 0)
+            {
+                throw std::runtime_error("Tile size and cache size must be positive");
+            }
+        }
+
+        const std::array<unsigned int, 2>& tiled_vector_field::get_resolution() const
+        {
+            return this->resolution;
+        }
+
+        const vislib::math::Rectangle<float>& tiled_vector_field::get_bounding_rectangle() const
+        {
+            return this->bounding_rectangle;
+        }
+
+        unsigned int tiled_vector_field::get_tile_size() const
+        {
+            return this->tile_size;
+        }
+
+        Eigen::Vector2f tiled_vector_field::interpolate(const Eigen::Vector2f& point) const
+        {
+            const auto cell = find_cell(point);
+
+            if (!cell)
+            {
+                throw std::runtime_error("Position outside of the vector field domain");
+            }
+
+            // Local coordinates within the cell
+            const Eigen::Vector2f local = (point - Eigen::Vector2f(this->bounding_rectangle.Left(), this->bounding_rectangle.Bottom())).cwiseQuotient(this->cell_size)
+                - cell->cast<float>();
+
+            // Get corner vectors from the tile containing the cell
+            const auto tile_x = static_cast<unsigned int>((*cell)[0] / this->tile_size);
+            const auto tile_y = static_cast<unsigned int>((*cell)[1] / this->tile_size);
+
+            const auto tile = get_tile(tile_x, tile_y);
+
+            const std::size_t x = (*cell)[0] - static_cast<std::size_t>(tile_x) * this->tile_size;
+            const std::size_t y = (*cell)[1] - static_cast<std::size_t>(tile_y) * this->tile_size;
+
+            const float* bottom = tile->vectors.data() + (y * tile->num_x + x) * 2;
+            const float* top = bottom + static_cast<std::size_t>(tile->num_x) * 2;
+
+            const Eigen::Vector2f bottom_vector = (1.0f - local[0]) * Eigen::Vector2f(bottom[0], bottom[1]) + local[0] * Eigen::Vector2f(bottom[2], bottom[3]);
+            const Eigen::Vector2f top_vector = (1.0f - local[0]) * Eigen::Vector2f(top[0], top[1]) + local[0] * Eigen::Vector2f(top[2], top[3]);
+
+            return (1.0f - local[1]) * bottom_vector + local[1] * top_vector;
+        }
+
+        std::optional<tiled_vector_field::cell_t> tiled_vector_field::find_cell(const Eigen::Vector2f& point) const
+        {
+            if (!(point[0] >= this->bounding_rectangle.Left() && point[0] <= this->bounding_rectangle.Right() &&
+                point[1] >= this->bounding_rectangle.Bottom() && point[1] <= this->bounding_rectangle.Top()))
+            {
+                return std::nullopt;
+            }
+
+            // Positions on the upper boundaries belong to the last cell
+            const Eigen::Vector2f coordinates = (point - Eigen::Vector2f(this->bounding_rectangle.Left(), this->bounding_rectangle.Bottom())).cwiseQuotient(this->cell_size);
+
+            return cell_t(std::min(static_cast<std::size_t>(coordinates[0]), static_cast<std::size_t>(this->resolution[0] - 2)),
+                std::min(static_cast<std::size_t>(coordinates[1]), static_cast<std::size_t>(this->resolution[1] - 2)));
+        }
+
+        Eigen::Vector2f tiled_vector_field::get_cell_sizes(const cell_t&) const
+        {
+            return this->cell_size;
+        }
+
+        std::shared_ptr<std::vector<float>> tiled_vector_field::gather() const
+        {
+            auto vectors = std::make_shared<std::vector<float>>(static_cast<std::size_t>(this->resolution[0]) * this->resolution[1] * 2);
+
+            // Load whole rows of tiles, such that each vector is loaded only once
+            std::vector<float> rows;
+
+            for (unsigned int first_y = 0; first_y < this->resolution[1]; first_y += this->tile_size)
+            {
+                const auto num_y = std::min(this->tile_size, this->resolution[1] - first_y);
+
+                this->loader({ 0u, first_y }, { this->resolution[0], num_y }, rows);
+
+                std::copy(rows.begin(), rows.end(), vectors->begin() + static_cast<std::size_t>(first_y) * this->resolution[0] * 2);
+            }
+
+            return vectors;
+        }
+
+        tiled_vector_field::statistics tiled_vector_field::get_statistics() const
+        {
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+            return this->cache_statistics;
+        }
+
+        std::shared_ptr<const tiled_vector_field::tile_t> tiled_vector_field::get_tile(const unsigned int tile_x, const unsigned int tile_y) const
+        {
+            const std::size_t tile_index = static_cast<std::size_t>(tile_y) * this->num_tiles[0] + tile_x;
+
+            {
+                std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+                const auto it = this->cache_lookup.find(tile_index);
+
+                if (it != this->cache_lookup.end())
+                {
+                    this->cache.splice(this->cache.begin(), this->cache, it->second);
+                    ++this->cache_statistics.hits;
+
+                    return it->second->second;
+                }
+            }
+
+            // Load outside of the lock, such that other threads are not blocked by the loader;
+            // tiles include the first row and column of their upper and right neighbors
+            const std::array<unsigned int, 2> first{ tile_x * this->tile_size, tile_y * this->tile_size };
+            const std::array<unsigned int, 2> num{ std::min(this->tile_size + 1, this->resolution[0] - first[0]),
+                std::min(this->tile_size + 1, this->resolution[1] - first[1]) };
+
+            auto tile = std::make_shared<tile_t>();
+            tile->num_x = num[0];
+
+            this->loader(first, num, tile->vectors);
+
+            if (tile->vectors.size() != static_cast<std::size_t>(num[0]) * num[1] * 2)
+            {
+                throw std::runtime_error("Loaded tile does not contain the expected number of vectors");
+            }
+
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+            // Another thread may have loaded the same tile in the meantime
+            const auto it = this->cache_lookup.find(tile_index);
+
+            if (it != this->cache_lookup.end())
+            {
+                this->cache.splice(this->cache.begin(), this->cache, it->second);
+
+                return it->second->second;
+            }
+
+            ++this->cache_statistics.misses;
+
+            this->cache.emplace_front(tile_index, tile);
+            this->cache_lookup[tile_index] = this->cache.begin();
+
+            // Evict least recently used tiles; tiles still in use remain valid through their shared pointers
+            while (this->cache.size() > this->cache_size)
+            {
+                this->cache_lookup.erase(this->cache.back().first);
+                this->cache.pop_back();
+            }
+
+            return tile;
+        }
+    }
+}
@@ -0,0 +1,183 @@
+/*
+ * tiled_vector_field.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VIS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "vislib/math/Rectangle.h"
+
+#include "Eigen/Dense"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace megamol
+{
+    namespace flowvis
+    {
+        /**
+        * 2D vector field on a uniform grid, which is split into square tiles that are loaded on demand
+        * and kept in a least-recently-used cache of limited size. Neighboring tiles share one row and
+        * column of vectors, such that all four corners of a cell are always found in the same tile.
+        *
+        * Provides the interface used by the integrators, i.e., interpolation, cell lookup and cell sizes,
+        * and can be accessed concurrently.
+        *
+        * @author Alexander Straub
+        */
+        class tiled_vector_field
+        {
+        public:
+            /**
+            * Function loading the vectors of a block of grid nodes
+            *
+            * @param first      Index of the first node in x and y direction
+            * @param num        Number of nodes in x and y direction
+            * @param vectors    Output vectors, row-major with two components each
+            */
+            using loader_t = std::function<void(const std::array<unsigned int, 2>& first, const std::array<unsigned int, 2>& num, std::vector<float>& vectors)>;
+
+            /** Cell index */
+            using cell_t = Eigen::Matrix<std::size_t, 2, 1>;
+
+            /** Cache statistics */
+            struct statistics
+            {
+                std::uint64_t hits;
+                std::uint64_t misses;
+            };
+
+            /**
+            * Constructor
+            *
+            * @param resolution             Grid resolution (number of vectors per direction), at least two per direction
+            * @param bounding_rectangle     Domain, spanned by the outermost grid nodes
+            * @param tile_size              Number of cells per tile and direction
+            * @param cache_size             Maximum number of tiles kept in memory
+            * @param loader                 Function for loading the vectors of a tile
+            *
+            * @throw std::runtime_error if the resolution, tile size or cache size is invalid
+            */
+            tiled_vector_field(const std::array<unsigned int, 2>& resolution, const vislib::math::Rectangle<float>& bounding_rectangle,
+                unsigned int tile_size, std::size_t cache_size, loader_t loader);
+
+            /** No copies, as the cache is not shared */
+            tiled_vector_field(const tiled_vector_field&) = delete;
+            tiled_vector_field& operator=(const tiled_vector_field&) = delete;
+
+            /**
+            * Get grid resolution
+            *
+            * @return Number of vectors per direction
+            */
+            const std::array<unsigned int, 2>& get_resolution() const;
+
+            /**
+            * Get domain
+            *
+            * @return Bounding rectangle
+            */
+            const vislib::math::Rectangle<float>& get_bounding_rectangle() const;
+
+            /**
+            * Get number of cells per tile and direction
+            *
+            * @return Tile size
+            */
+            unsigned int get_tile_size() const;
+
+            /**
+            * Bilinearly interpolate the vector at the given position, loading the containing tile if necessary
+            *
+            * @param point      Position
+            *
+            * @return Interpolated vector
+            *
+            * @throw std::runtime_error if the position is outside the domain
+            */
+            Eigen::Vector2f interpolate(const Eigen::Vector2f& point) const;
+
+            /**
+            * Find the cell containing the given position
+            *
+            * @param point      Position
+            *
+            * @return Cell index, or no value if the position is outside the domain
+            */
+            std::optional<cell_t> find_cell(const Eigen::Vector2f& point) const;
+
+            /**
+            * Get the size of a cell, which is the same for all cells
+            *
+            * @param cell       Cell index
+            *
+            * @return Cell size
+            */
+            Eigen::Vector2f get_cell_sizes(const cell_t& cell) const;
+
+            /**
+            * Assemble all vectors, bypassing the cache; only for consumers that need the whole field
+            *
+            * @return Vectors, row-major with two components each
+            */
+            std::shared_ptr<std::vector<float>> gather() const;
+
+            /**
+            * Get cache statistics
+            *
+            * @return Number of tile accesses served from the cache, and number of loaded tiles
+            */
+            statistics get_statistics() const;
+
+        private:
+            /** Tile with its vectors and number of nodes in x direction */
+            struct tile_t
+            {
+                std::vector<float> vectors;
+                unsigned int num_x;
+            };
+
+            /**
+            * Get a tile from the cache, or load it
+            *
+            * @param tile_x     Tile index in x direction
+            * @param tile_y     Tile index in y direction
+            *
+            * @return Tile, which stays valid even if evicted from the cache
+            */
+            std::shared_ptr<const tile_t> get_tile(unsigned int tile_x, unsigned int tile_y) const;
+
+            /** Grid information */
+            const std::array<unsigned int, 2> resolution;
+            const vislib::math::Rectangle<float> bounding_rectangle;
+            const Eigen::Vector2f cell_size;
+
+            /** Tiling */
+            const unsigned int tile_size;
+            const std::array<unsigned int, 2> num_tiles;
+
+            /** Loader */
+            const loader_t loader;
+
+            /** Cache, with the most recently used tile in front */
+            const std::size_t cache_size;
+
+            mutable std::mutex cache_mutex;
+            mutable std::list<std::pair<std::size_t, std::shared_ptr<const tile_t>>> cache;
+            mutable std::unordered_map<std::size_t, decltype(cache)::iterator> cache_lookup;
+
+            mutable statistics cache_statistics;
+        };
+    }
+}
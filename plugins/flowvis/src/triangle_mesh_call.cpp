@@ -11,7 +11,7 @@ namespace megamol
 {
     namespace flowvis
     {
-        triangle_mesh_call::triangle_mesh_call() : dimension(dimension_t::INVALID) {}
+        triangle_mesh_call::triangle_mesh_call() : dimension(dimension_t::INVALID), vertices_append_only_since(static_cast<SIZE_T>(-1)) {}
 
         triangle_mesh_call::dimension_t triangle_mesh_call::get_dimension() const
         {
@@ -53,6 +53,16 @@ namespace megamol
             this->vertices = vertices;
         }
 
+        SIZE_T triangle_mesh_call::get_vertices_append_only_since() const
+        {
+            return this->vertices_append_only_since;
+        }
+
+        void triangle_mesh_call::set_vertices_append_only_since(const SIZE_T hash)
+        {
+            this->vertices_append_only_since = hash;
+        }
+
         std::shared_ptr<std::vector<float>> triangle_mesh_call::get_normals() const
         {
             return this->normals;
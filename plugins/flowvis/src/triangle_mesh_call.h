@@ -106,6 +106,17 @@ namespace megamol
             */
             void set_vertices(std::shared_ptr<std::vector<float>> vertices);
 
+            /**
+            * Getter for the data hash since which vertices have only been appended, i.e.,
+            * vertices of data with this or a later hash are still valid
+            */
+            SIZE_T get_vertices_append_only_since() const;
+
+            /**
+            * Setter for the data hash since which vertices have only been appended
+            */
+            void set_vertices_append_only_since(SIZE_T hash);
+
             /**
              * Getter for the normals
              */
@@ -140,6 +151,9 @@ namespace megamol
             std::shared_ptr<std::vector<float>> vertices;
             std::shared_ptr<std::vector<float>> normals;
             std::shared_ptr<std::vector<unsigned int>> indices;
+
+            /** Data hash since which vertices have only been appended */
+            SIZE_T vertices_append_only_since;
         };
     }
 }
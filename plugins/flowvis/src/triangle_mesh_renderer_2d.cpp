@@ -85,10 +85,10 @@ namespace megamol
                 glDeleteProgram(this->render_data.prog);
 
                 glDeleteVertexArrays(1, &this->render_data.vao);
-                glDeleteBuffers(1, &this->render_data.vbo);
-                glDeleteBuffers(1, &this->render_data.ibo);
-                glDeleteBuffers(1, &this->render_data.cbo);
-                glDeleteBuffers(1, &this->render_data.mbo);
+                this->render_data.vbo.release();
+                this->render_data.ibo.release();
+                this->render_data.cbo.release();
+                this->render_data.mbo.release();
 
                 glDeleteTextures(1, &this->render_data.tf);
             }
@@ -151,12 +151,8 @@ namespace megamol
                     return false;
                 }
 
-                // Create arrays and buffers
+                // Create arrays; buffers are created on first upload
                 glGenVertexArrays(1, &this->render_data.vao);
-                glGenBuffers(1, &this->render_data.vbo);
-                glGenBuffers(1, &this->render_data.ibo);
-                glGenBuffers(1, &this->render_data.cbo);
-                glGenBuffers(1, &this->render_data.mbo);
 
                 // Create transfer function texture
                 glGenTextures(1, &this->render_data.tf);
@@ -175,6 +171,10 @@ namespace megamol
 
             if (get_triangles->DataHash() != this->triangle_mesh_hash)
             {
+                // Previously uploaded vertices are still valid if vertices have only been appended since
+                const bool append_only = this->triangle_mesh_hash != static_cast<SIZE_T>(-1)
+                    && this->triangle_mesh_hash >= get_triangles->get_vertices_append_only_since();
+
                 // Set hash
                 this->triangle_mesh_hash = get_triangles->DataHash();
 
@@ -182,21 +182,24 @@ namespace megamol
                 this->render_data.vertices = get_triangles->get_vertices();
                 this->render_data.indices = get_triangles->get_indices();
 
-                // Prepare OpenGL buffers
+                // Prepare OpenGL buffers, only uploading appended vertices if possible
                 if (this->render_data.vertices != nullptr && this->render_data.indices != nullptr)
                 {
+                    this->render_data.vbo.update(this->render_data.vertices->data(), this->render_data.vertices->size() * sizeof(GLfloat),
+                        append_only ? this->render_data.vbo.size() : 0);
+                    this->render_data.ibo.update(this->render_data.indices->data(), this->render_data.indices->size() * sizeof(GLuint), 0);
+
                     glBindVertexArray(this->render_data.vao);
 
-                    glBindBuffer(GL_ARRAY_BUFFER, this->render_data.vbo);
-                    glBufferData(GL_ARRAY_BUFFER, this->render_data.vertices->size() * sizeof(GLfloat), this->render_data.vertices->data(), GL_STATIC_DRAW);
+                    glBindBuffer(GL_ARRAY_BUFFER, this->render_data.vbo.get_handle());
 
                     glEnableVertexAttribArray(0);
                     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->render_data.ibo);
-                    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->render_data.indices->size() * sizeof(GLuint), this->render_data.indices->data(), GL_STATIC_DRAW);
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->render_data.ibo.get_handle());
 
                     glBindVertexArray(0);
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
                 }
             }
 
@@ -207,16 +210,23 @@ namespace megamol
 
                 bool new_data = false;
                 bool new_mask = false;
+                bool append_only_data = false;
 
                 if (get_data != nullptr && (*get_data)(0))
                 {
                     if (get_data->DataHash() != this->mesh_data_hash || this->data_set.IsDirty())
                     {
+                        // Previously uploaded values of the same data set are still valid if values have only been appended since
+                        const bool same_data_set = !this->data_set.IsDirty();
+
                         // Set hash and reset parameter
                         this->data_set.ResetDirty();
 
                         this->render_data.values = get_data->get_data(this->data_set.Param<core::param::FlexEnumParam>()->Value());
 
+                        append_only_data = same_data_set && this->render_data.values != nullptr && this->mesh_data_hash != static_cast<SIZE_T>(-1)
+                            && this->mesh_data_hash >= this->render_data.values->append_only_since;
+
                         new_data = true;
                     }
 
@@ -248,6 +258,9 @@ namespace megamol
                     this->render_data.values->min_value = 0.0f;
                     this->render_data.values->max_value = 1.0f;
                     this->render_data.values->data = std::make_shared<std::vector<GLfloat>>(this->render_data.vertices->size() / 2, 1.0f);
+
+                    new_data = true;
+                    append_only_data = false;
                 }
 
                 if (this->render_data.mask == nullptr)
@@ -257,31 +270,36 @@ namespace megamol
                     new_mask = true;
                 }
 
-                // Prepare OpenGL buffers
-                glBindVertexArray(this->render_data.vao);
+                // Prepare OpenGL buffers, only uploading appended values if possible
+                if (new_data)
+                {
+                    this->render_data.cbo.update(this->render_data.values->data->data(), this->render_data.values->data->size() * sizeof(GLfloat),
+                        append_only_data ? this->render_data.cbo.size() : 0);
 
-                glBindBuffer(GL_ARRAY_BUFFER, this->render_data.cbo);
-                glBufferData(GL_ARRAY_BUFFER, this->render_data.values->data->size() * sizeof(GLfloat), this->render_data.values->data->data(), GL_STATIC_DRAW);
+                    glBindVertexArray(this->render_data.vao);
 
-                glEnableVertexAttribArray(1);
-                glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+                    glBindBuffer(GL_ARRAY_BUFFER, this->render_data.cbo.get_handle());
 
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->render_data.ibo);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->render_data.indices->size() * sizeof(GLuint), this->render_data.indices->data(), GL_STATIC_DRAW);
+                    glEnableVertexAttribArray(1);
+                    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-                glBindVertexArray(0);
+                    glBindVertexArray(0);
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
+                }
 
                 if (new_mask)
                 {
+                    this->render_data.mbo.update(this->render_data.mask->data(), this->render_data.mask->size() * sizeof(GLfloat), 0);
+
                     glBindVertexArray(this->render_data.vao);
 
-                    glBindBuffer(GL_ARRAY_BUFFER, this->render_data.mbo);
-                    glBufferData(GL_ARRAY_BUFFER, this->render_data.mask->size() * sizeof(GLfloat), this->render_data.mask->data(), GL_STATIC_DRAW);
+                    glBindBuffer(GL_ARRAY_BUFFER, this->render_data.mbo.get_handle());
 
                     glEnableVertexAttribArray(2);
                     glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
 
                     glBindVertexArray(0);
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
                 }
 
                 if (new_data || this->render_data.values->transfer_function_dirty)
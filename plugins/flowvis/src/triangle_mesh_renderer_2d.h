@@ -6,6 +6,7 @@
  */
 #pragma once
 
+#include "append_buffer.h"
 #include "mesh_data_call.h"
 
 #include "mmcore/CallerSlot.h"
@@ -160,7 +161,8 @@ namespace megamol
                 bool initialized = false;
 
                 GLuint vs, fs, prog;
-                GLuint vao, vbo, ibo, cbo, mbo;
+                GLuint vao;
+                append_buffer vbo, ibo, cbo, mbo;
                 GLuint tf, tf_size;
 
                 std::shared_ptr<std::vector<GLfloat>> vertices;
@@ -3,6 +3,10 @@
 
 #include "glad/glad.h"
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -10,7 +14,8 @@ namespace megamol
 {
     namespace flowvis
     {
-        triangulation::triangulation(const std::vector<GLfloat>& initial_points) : point_index(0)
+        triangulation::triangulation(const std::vector<GLfloat>& initial_points) : point_index(0), last_inserted_index(0),
+            vertex_positions(std::make_shared<std::vector<GLfloat>>()), adjacency_size(0)
         {
             if (!initial_points.empty())
             {
@@ -20,31 +25,85 @@ namespace megamol
 
         void triangulation::insert_points(const std::vector<GLfloat>& new_points)
         {
-            // Get new points and add them to the triangulation and the output
-            std::vector<std::pair<point_t, std::size_t>> points;
-            points.reserve(new_points.size() / 2);
+            // Get new points
+            const std::size_t num_new_points = new_points.size() / 2;
 
-            for (std::size_t i = 0; i < new_points.size() / 2; ++i)
+            std::vector<point_t> points;
+            points.reserve(num_new_points);
+
+            for (std::size_t i = 0; i < num_new_points; ++i)
+            {
+                points.push_back(point_t(static_cast<double>(new_points[i * 2 + 0]), static_cast<double>(new_points[i * 2 + 1])));
+            }
+
+            // Sort spatially for fast point location, while keeping track of the original order
+            std::vector<std::ptrdiff_t> order(num_new_points);
+            std::iota(order.begin(), order.end(), 0);
+
+            typedef CGAL::Spatial_sort_traits_adapter_2<kernel, CGAL::Pointer_property_map<point_t>::type> sort_traits_t;
+            CGAL::spatial_sort(order.begin(), order.end(), sort_traits_t(CGAL::make_property_map(points)));
+
+            // Apply delaunay, using the previously inserted vertex as hint for locating the next one
+            this->last_inserted_index = this->point_index;
+            this->vertices.resize(this->point_index + num_new_points);
+
+            delaunay_t::Face_handle hint;
+
+            for (const auto i : order)
             {
-                points.push_back(std::make_pair(point_t(static_cast<double>(new_points[i * 2 + 0]), static_cast<double>(new_points[i * 2 + 1])), this->point_index++));
+                const auto num_vertices = this->delaunay.number_of_vertices();
+                const auto vertex = this->delaunay.insert(points[i], hint);
+
+                if (this->delaunay.number_of_vertices() != num_vertices)
+                {
+                    vertex->info() = this->point_index + i;
+                }
+
+                this->vertices[this->point_index + i] = vertex;
+
+                hint = vertex->face();
             }
 
-            // Apply delaunay
-            this->delaunay.insert(points.begin(), points.end());
+            this->point_index += num_new_points;
+
+            // Append the new positions, without modifying previously exported ones
+            if (this->vertex_positions.use_count() > 1)
+            {
+                this->vertex_positions = std::make_shared<std::vector<GLfloat>>(*this->vertex_positions);
+            }
+
+            this->vertex_positions->insert(this->vertex_positions->end(), new_points.begin(), new_points.begin() + num_new_points * 2);
+
+            this->indices = nullptr;
+        }
+
+        std::size_t triangulation::get_number_of_vertices() const
+        {
+            return this->vertices.size();
+        }
+
+        triangulation::vertex_t triangulation::get_vertex(const std::size_t index) const
+        {
+            return this->vertices[index];
+        }
+
+        std::pair<std::size_t, std::size_t> triangulation::get_last_inserted() const
+        {
+            return std::make_pair(this->last_inserted_index, this->point_index);
         }
 
         std::pair<std::shared_ptr<std::vector<GLfloat>>, std::shared_ptr<std::vector<GLuint>>> triangulation::export_grid() const
         {
-            // Extract points
-            auto vertices = std::make_shared<std::vector<GLfloat>>(this->delaunay.number_of_vertices() * 2);
+            return std::make_pair(this->vertex_positions, export_indices());
+        }
 
-            for (auto vertex_it = this->delaunay.finite_vertices_begin(); vertex_it != this->delaunay.finite_vertices_end(); ++vertex_it)
+        std::shared_ptr<std::vector<GLuint>> triangulation::export_indices() const
+        {
+            if (this->indices != nullptr)
             {
-                (*vertices)[vertex_it->info() * 2 + 0] = static_cast<GLfloat>(CGAL::to_double(vertex_it->point()[0]));
-                (*vertices)[vertex_it->info() * 2 + 1] = static_cast<GLfloat>(CGAL::to_double(vertex_it->point()[1]));
+                return this->indices;
             }
 
-            // Extract cells
             auto indices = std::make_shared<std::vector<GLuint>>(get_number_of_cells() * 3);
 
             std::size_t cell_index = 0;
@@ -58,7 +117,9 @@ namespace megamol
                 }
             }
 
-            return std::make_pair(vertices, indices);
+            indices->resize(cell_index);
+
+            return this->indices = indices;
         }
 
         std::vector<triangulation::vertex_t> triangulation::get_neighbors(const vertex_t& vertex) const
@@ -79,6 +140,78 @@ namespace megamol
             return neighbors;
         }
 
+        const triangulation::adjacency_t& triangulation::get_adjacency() const
+        {
+            if (this->adjacency_size == this->point_index && !this->adjacency.offsets.empty())
+            {
+                return this->adjacency;
+            }
+
+            auto for_each_neighbor = [this](const vertex_t& vertex, const std::function<void(std::size_t)>& func)
+            {
+                auto circulator = this->delaunay.incident_vertices(vertex);
+                const auto first = circulator;
+
+                if (circulator == nullptr)
+                {
+                    return;
+                }
+
+                do
+                {
+                    if (!this->delaunay.is_infinite(circulator->handle()))
+                    {
+                        func(circulator->info());
+                    }
+                } while (++circulator != first);
+            };
+
+            // Only vertices inserted since the last update, and vertices connected to them, can have changed neighbors,
+            // as all edges removed by an insertion are between vertices connected to the inserted one afterwards
+            std::vector<std::uint8_t> changed(this->point_index, 0);
+
+            for (std::size_t index = this->adjacency_size; index < this->point_index; ++index)
+            {
+                const auto& vertex = this->vertices[index];
+
+                changed[index] = changed[vertex->info()] = 1;
+
+                for_each_neighbor(vertex, [&changed](const std::size_t neighbor) { changed[neighbor] = 1; });
+            }
+
+            // Duplicate points share the vertex of the point inserted first
+            for (std::size_t index = 0; index < this->adjacency_size; ++index)
+            {
+                changed[index] |= changed[this->vertices[index]->info()];
+            }
+
+            // Query changed vertices, copying the neighbors of all others
+            adjacency_t updated;
+            updated.offsets.resize(this->point_index + 1);
+            updated.neighbors.reserve(this->adjacency.neighbors.size() + 6 * (this->point_index - this->adjacency_size));
+
+            for (std::size_t index = 0; index < this->point_index; ++index)
+            {
+                updated.offsets[index] = updated.neighbors.size();
+
+                if (changed[index])
+                {
+                    for_each_neighbor(this->vertices[index], [&updated](const std::size_t neighbor) { updated.neighbors.push_back(neighbor); });
+                }
+                else
+                {
+                    updated.neighbors.insert(updated.neighbors.end(), this->adjacency.begin(index), this->adjacency.end(index));
+                }
+            }
+
+            updated.offsets[this->point_index] = updated.neighbors.size();
+
+            this->adjacency = std::move(updated);
+            this->adjacency_size = this->point_index;
+
+            return this->adjacency;
+        }
+
         std::size_t triangulation::get_number_of_cells() const
         {
             return this->delaunay.number_of_faces();
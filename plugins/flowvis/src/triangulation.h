@@ -5,9 +5,13 @@
 #include <CGAL/Triangulation_vertex_base_with_info_2.h>
 #include <CGAL/Triangulation_face_base_2.h>
 #include <CGAL/Triangulation_data_structure_2.h>
+#include <CGAL/Spatial_sort_traits_adapter_2.h>
+#include <CGAL/property_map.h>
+#include <CGAL/spatial_sort.h>
 
 #include "glad/glad.h"
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -33,6 +37,21 @@ namespace megamol
 
             typedef delaunay_t::Vertex_handle vertex_t;
 
+            /**
+            * Neighbors of all vertices in compressed row storage, indexed by the order of insertion
+            */
+            struct adjacency_t
+            {
+                // Per vertex, the first index into the neighbors, followed by the past-the-end index of the last vertex
+                std::vector<std::size_t> offsets;
+
+                // Indices of the neighbor vertices
+                std::vector<std::size_t> neighbors;
+
+                const std::size_t* begin(const std::size_t index) const { return this->neighbors.data() + this->offsets[index]; }
+                const std::size_t* end(const std::size_t index) const { return this->neighbors.data() + this->offsets[index + 1]; }
+            };
+
         public:
             /**
             * Constructor
@@ -49,12 +68,44 @@ namespace megamol
             void insert_points(const std::vector<GLfloat>& new_points);
 
             /**
-            * Export triangulation as grid
+            * Get number of vertices in triangulation
+            *
+            * @return Number of vertices
+            */
+            std::size_t get_number_of_vertices() const;
+
+            /**
+            * Get vertex by its index, corresponding to the order of insertion
+            *
+            * @param index Index of the vertex
+            *
+            * @return Vertex handle
+            */
+            vertex_t get_vertex(std::size_t index) const;
+
+            /**
+            * Get the range of indices of the vertices inserted by the last call to insert_points
+            *
+            * @return First and past-the-end index
+            */
+            std::pair<std::size_t, std::size_t> get_last_inserted() const;
+
+            /**
+            * Export triangulation as grid. The arrays are shared with the triangulation and must not be modified;
+            * they are replaced instead of being modified by the next call to insert_points.
             *
-            * @param grid Grid storing the triangulation
+            * @return Vertex positions, indexed by the order of insertion, and indices of the triangle vertices
             */
             std::pair<std::shared_ptr<std::vector<GLfloat>>, std::shared_ptr<std::vector<GLuint>>> export_grid() const;
 
+            /**
+            * Export triangulation cells as triangle indices. The indices are only extracted once after each call to
+            * insert_points, and shared afterwards; they must not be modified.
+            *
+            * @return Indices of the triangle vertices
+            */
+            std::shared_ptr<std::vector<GLuint>> export_indices() const;
+
             /**
             * Get neighbor vertices
             *
@@ -64,6 +115,16 @@ namespace megamol
             */
             std::vector<vertex_t> get_neighbors(const vertex_t& vertex) const;
 
+            /**
+            * Get the neighbors of all vertices. After insertion, only the neighbors of new vertices and their
+            * neighbors are queried, as all other vertices keep their neighbors.
+            *
+            * The update is not thread-safe; call this before querying the neighbors in parallel.
+            *
+            * @return Neighbor indices per vertex
+            */
+            const adjacency_t& get_adjacency() const;
+
             /**
             * Get number of cells in triangulation
             *
@@ -97,6 +158,22 @@ namespace megamol
             // Counter for mapping triangulated points to original input
             std::size_t point_index;
 
+            // Vertex handles, indexed by the order of insertion
+            std::vector<vertex_t> vertices;
+
+            // Index of the first vertex inserted by the last call to insert_points
+            std::size_t last_inserted_index;
+
+            // Vertex positions, indexed by the order of insertion
+            std::shared_ptr<std::vector<GLfloat>> vertex_positions;
+
+            // Triangle indices, extracted on demand
+            mutable std::shared_ptr<std::vector<GLuint>> indices;
+
+            // Neighbors of the vertices, and the number of vertices they are up to date for
+            mutable adjacency_t adjacency;
+            mutable std::size_t adjacency_size;
+
         public:
             // Access to delaunay triangulation
             delaunay_t delaunay;
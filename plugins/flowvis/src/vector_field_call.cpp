@@ -1,9 +1,12 @@
 #include "stdafx.h"
 #include "vector_field_call.h"
 
+#include "tiled_vector_field.h"
+
 #include "vislib/math/Rectangle.h"
 
 #include <array>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -11,7 +14,7 @@ namespace megamol
 {
     namespace flowvis
     {
-        vector_field_call::vector_field_call() : vectors(nullptr)
+        vector_field_call::vector_field_call() : resolution{ 0u, 0u }, components(2), depth(1), depth_range{ 0.0f, 0.0f }, vectors(nullptr), tiled_vectors(nullptr), frame_count(1), frame_id(0), time(0.0f)
         {
             SetDataHash(-1);
         }
@@ -23,6 +26,11 @@ namespace megamol
 
         void vector_field_call::set_bounding_rectangle(const vislib::math::Rectangle<float>& bounding_rectangle)
         {
+            if (this->bounding_rectangle != bounding_rectangle)
+            {
+                this->positions = nullptr;
+            }
+
             this->bounding_rectangle = bounding_rectangle;
         }
 
@@ -33,11 +41,89 @@ namespace megamol
 
         void vector_field_call::set_resolution(std::array<unsigned int, 2> resolution)
         {
+            if (this->resolution != resolution)
+            {
+                this->positions = nullptr;
+            }
+
             this->resolution = resolution;
         }
 
+        unsigned int vector_field_call::get_components() const
+        {
+            return this->components;
+        }
+
+        void vector_field_call::set_components(const unsigned int components)
+        {
+            if (this->components != components)
+            {
+                this->positions = nullptr;
+            }
+
+            this->components = components;
+        }
+
+        unsigned int vector_field_call::get_depth() const
+        {
+            return this->depth;
+        }
+
+        const std::array<float, 2>& vector_field_call::get_depth_range() const
+        {
+            return this->depth_range;
+        }
+
+        void vector_field_call::set_depth(const unsigned int depth, const std::array<float, 2> depth_range)
+        {
+            if (this->depth != depth || this->depth_range != depth_range)
+            {
+                this->positions = nullptr;
+            }
+
+            this->depth = depth;
+            this->depth_range = depth_range;
+        }
+
         std::shared_ptr<std::vector<float>> vector_field_call::get_positions() const
         {
+            // Compute positions of the uniform grid on first access
+            if (this->positions == nullptr && this->resolution[0] > 0 && this->resolution[1] > 0 && this->depth > 0)
+            {
+                const auto x_num = this->resolution[0];
+                const auto y_num = this->resolution[1];
+                const auto z_num = this->components == 3 ? this->depth : 1u;
+                const auto num_coordinates = this->components == 3 ? 3u : 2u;
+
+                const float x_step = x_num > 1 ? this->bounding_rectangle.Width() / (x_num - 1) : 0.0f;
+                const float y_step = y_num > 1 ? this->bounding_rectangle.Height() / (y_num - 1) : 0.0f;
+                const float z_step = z_num > 1 ? (this->depth_range[1] - this->depth_range[0]) / (z_num - 1) : 0.0f;
+
+                auto positions = std::make_shared<std::vector<float>>(static_cast<std::size_t>(x_num) * y_num * z_num * num_coordinates);
+
+                #pragma omp parallel for
+                for (long long yz = 0; yz < static_cast<long long>(y_num) * z_num; ++yz)
+                {
+                    const auto y = static_cast<std::size_t>(yz % y_num);
+                    const auto z = static_cast<std::size_t>(yz / y_num);
+
+                    for (std::size_t x = 0; x < x_num; ++x)
+                    {
+                        const std::size_t xyz = static_cast<std::size_t>(yz) * x_num + x;
+
+                        (*positions)[xyz * num_coordinates + 0] = this->bounding_rectangle.Left() + x * x_step;
+                        (*positions)[xyz * num_coordinates + 1] = this->bounding_rectangle.Bottom() + y * y_step;
+
+                        if (num_coordinates == 3)
+                        {
+                            (*positions)[xyz * num_coordinates + 2] = this->depth_range[0] + z * z_step;
+                        }
+                    }
+                }
+
+                this->positions = positions;
+            }
+
             return this->positions;
         }
 
@@ -48,6 +134,12 @@ namespace megamol
 
         std::shared_ptr<std::vector<float>> vector_field_call::get_vectors() const
         {
+            // Assemble the whole field for consumers that cannot work on tiles
+            if (this->vectors == nullptr && this->tiled_vectors != nullptr)
+            {
+                this->vectors = this->tiled_vectors->gather();
+            }
+
             return this->vectors;
         }
 
@@ -55,5 +147,45 @@ namespace megamol
         {
             this->vectors = vectors;
         }
+
+        std::shared_ptr<tiled_vector_field> vector_field_call::get_tiled_vectors() const
+        {
+            return this->tiled_vectors;
+        }
+
+        void vector_field_call::set_tiled_vectors(std::shared_ptr<tiled_vector_field> tiled_vectors)
+        {
+            this->tiled_vectors = tiled_vectors;
+        }
+
+        unsigned int vector_field_call::get_frame_count() const
+        {
+            return this->frame_count;
+        }
+
+        void vector_field_call::set_frame_count(const unsigned int frame_count)
+        {
+            this->frame_count = frame_count;
+        }
+
+        unsigned int vector_field_call::get_frame_id() const
+        {
+            return this->frame_id;
+        }
+
+        void vector_field_call::set_frame_id(const unsigned int frame_id)
+        {
+            this->frame_id = frame_id;
+        }
+
+        float vector_field_call::get_time() const
+        {
+            return this->time;
+        }
+
+        void vector_field_call::set_time(const float time)
+        {
+            this->time = time;
+        }
     }
 }
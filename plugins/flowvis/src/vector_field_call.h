@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include "tiled_vector_field.h"
+
 #include "mmcore/AbstractGetDataCall.h"
 #include "mmcore/factories/CallAutoDescription.h"
 
@@ -84,7 +86,35 @@ namespace megamol
             void set_resolution(std::array<unsigned int, 2> resolution);
 
             /**
-            * Getter for the positions
+            * Getter for the number of vector components, which equals the number of
+            * spatial dimensions: 2 for planar fields, or 3 for volumetric fields
+            */
+            unsigned int get_components() const;
+
+            /**
+            * Setter for the number of vector components
+            */
+            void set_components(unsigned int components);
+
+            /**
+            * Getter for the grid resolution along the z axis; 1 for planar fields
+            */
+            unsigned int get_depth() const;
+
+            /**
+            * Getter for the extent along the z axis
+            */
+            const std::array<float, 2>& get_depth_range() const;
+
+            /**
+            * Setter for the grid resolution and extent along the z axis
+            */
+            void set_depth(unsigned int depth, std::array<float, 2> depth_range);
+
+            /**
+            * Getter for the positions; if not set explicitly, they are computed
+            * from resolution and bounding rectangle on first access, with as many
+            * coordinates per position as there are components
             */
             std::shared_ptr<std::vector<float>> get_positions() const;
 
@@ -94,7 +124,8 @@ namespace megamol
             void set_positions(std::shared_ptr<std::vector<float>> positions);
 
             /**
-            * Getter for the vectors
+            * Getter for the vectors; if only tiled vectors are set, all tiles
+            * are gathered on first access
             */
             std::shared_ptr<std::vector<float>> get_vectors() const;
 
@@ -103,6 +134,48 @@ namespace megamol
             */
             void set_vectors(std::shared_ptr<std::vector<float>> vectors);
 
+            /**
+            * Getter for the tiled vectors, which are loaded on demand; nullptr if the
+            * vectors are only provided as a whole
+            */
+            std::shared_ptr<tiled_vector_field> get_tiled_vectors() const;
+
+            /**
+            * Setter for the tiled vectors; the vectors have to be set to nullptr
+            * for them to be gathered from the tiles
+            */
+            void set_tiled_vectors(std::shared_ptr<tiled_vector_field> tiled_vectors);
+
+            /**
+            * Getter for the number of time steps (frames)
+            */
+            unsigned int get_frame_count() const;
+
+            /**
+            * Setter for the number of time steps (frames)
+            */
+            void set_frame_count(unsigned int frame_count);
+
+            /**
+            * Getter for the frame; requested by the caller, and set to the provided frame by the callee
+            */
+            unsigned int get_frame_id() const;
+
+            /**
+            * Setter for the frame; requested by the caller, and set to the provided frame by the callee
+            */
+            void set_frame_id(unsigned int frame_id);
+
+            /**
+            * Getter for the time of the provided frame
+            */
+            float get_time() const;
+
+            /**
+            * Setter for the time of the provided frame
+            */
+            void set_time(float time);
+
         protected:
             /** Bounding rectangle */
             vislib::math::Rectangle<float> bounding_rectangle;
@@ -110,11 +183,24 @@ namespace megamol
             /** Grid resolution */
             std::array<unsigned int, 2> resolution;
 
-            /** Grid positions */
-            std::shared_ptr<std::vector<float>> positions;
-            
-            /** Vectors */
-            std::shared_ptr<std::vector<float>> vectors;
+            /** Number of components, and grid resolution and extent along the z axis */
+            unsigned int components;
+            unsigned int depth;
+            std::array<float, 2> depth_range;
+
+            /** Grid positions, computed lazily if not set */
+            mutable std::shared_ptr<std::vector<float>> positions;
+
+            /** Vectors, gathered lazily from the tiles if not set */
+            mutable std::shared_ptr<std::vector<float>> vectors;
+
+            /** Tiled vectors */
+            std::shared_ptr<tiled_vector_field> tiled_vectors;
+
+            /** Number of frames, provided frame and its time */
+            unsigned int frame_count;
+            unsigned int frame_id;
+            float time;
         };
     }
 }
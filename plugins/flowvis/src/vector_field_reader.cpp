@@ -1,16 +1,24 @@
 #include "stdafx.h"
 #include "vector_field_reader.h"
 
+#include "tiled_vector_field.h"
 #include "vector_field_call.h"
 
 #include "mmcore/Call.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
 
 #include "vislib/sys/Log.h"
 
-#include <fstream>
-#include <iostream>
+#include "vislib/String.h"
+#include "vislib/StringConverter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace megamol
@@ -19,7 +27,9 @@ namespace megamol
     {
         vector_field_reader::vector_field_reader() :
             output_slot("output_slot", "Output slot for the vector field"),
-            file_path_slot("file_path_slot", "File path to the stored vector field")
+            file_path_slot("file_path_slot", "File path to the stored vector field"),
+            tile_size("tile_size", "Number of cells per tile and direction, for reading frames on demand; 0 reads whole frames"),
+            tile_cache_size("tile_cache_size", "Maximum number of tiles kept in memory")
         {
             // Set connections and parameters
             this->output_slot.SetCallback(vector_field_call::ClassName(), vector_field_call::FunctionName(0), &vector_field_reader::get_data);
@@ -29,11 +39,26 @@ namespace megamol
             this->file_path_slot << new core::param::FilePathParam("");
             this->MakeSlotAvailable(&this->file_path_slot);
 
+            this->tile_size << new core::param::IntParam(0, 0);
+            this->MakeSlotAvailable(&this->tile_size);
+
+            this->tile_cache_size << new core::param::IntParam(64, 1);
+            this->MakeSlotAvailable(&this->tile_cache_size);
+
             // Initialize stored data
             this->stored_data.bounding_rectangle = vislib::math::Rectangle<float>(0.0f, 0.0f, 1.0f, 1.0f);
             this->stored_data.resolution = { 0u, 0u };
-            this->stored_data.positions = std::make_shared<std::vector<float>>();
+            this->stored_data.components = 2;
+            this->stored_data.depth = 1;
+            this->stored_data.depth_range = { 0.0f, 0.0f };
+            this->stored_data.frame_count = 1;
+            this->stored_data.time_range = { 0.0f, 0.0f };
+            this->stored_data.data_offset = 0;
+            this->stored_data.frame_id = 0;
+            this->stored_data.time = 0.0f;
             this->stored_data.vectors = std::make_shared<std::vector<float>>();
+            this->stored_data.tiled_vectors = nullptr;
+            this->stored_data.hash = 0;
         }
 
         vector_field_reader::~vector_field_reader()
@@ -47,203 +72,264 @@ namespace megamol
         }
 
         void vector_field_reader::release()
-        { }
+        {
+            this->stored_data.vectors = nullptr;
+            this->stored_data.tiled_vectors = nullptr;
+            this->stored_data.file = nullptr;
+        }
 
         bool vector_field_reader::get_data(core::Call& call)
         {
             // Get call
             auto* vf_call = dynamic_cast<vector_field_call*>(&call);
 
-            if (vf_call != nullptr)
+            if (vf_call == nullptr)
             {
-                if (!this->file_path_slot.Param<core::param::FilePathParam>()->Value().IsEmpty() &&
-                    this->file_path_slot.IsDirty())
-                {
-                    this->file_path_slot.ResetDirty();
+                return false;
+            }
 
-                    // Open file
-                    std::ifstream vectors_ifs(this->file_path_slot.Param<core::param::FilePathParam>()->Value(), std::ios_base::in | std::ios_base::binary);
+            if (!open_file())
+            {
+                return false;
+            }
 
-                    if (vectors_ifs.good())
-                    {
-                        // Get dimension from file
-                        unsigned int dimension, components;
+            // Copy the requested frame from the mapped file
+            load_frame(vf_call->get_frame_id());
 
-                        vectors_ifs.read(reinterpret_cast<char*>(&dimension), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&components), sizeof(unsigned int));
+            vf_call->set_resolution(this->stored_data.resolution);
+            vf_call->set_components(this->stored_data.components);
+            vf_call->set_depth(this->stored_data.depth, this->stored_data.depth_range);
+            vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
+            vf_call->set_frame_count(this->stored_data.frame_count);
 
-                        if (dimension != 2)
-                        {
-                            vislib::sys::Log::DefaultLog.WriteError("Vector field file must have exactly two dimensions '%s'",
-                                this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+            vf_call->set_frame_id(this->stored_data.frame_id);
+            vf_call->set_time(this->stored_data.time);
+            vf_call->set_vectors(this->stored_data.vectors);
+            vf_call->set_tiled_vectors(this->stored_data.tiled_vectors);
 
-                            return false;
-                        }
+            vf_call->SetDataHash(this->stored_data.hash);
 
-                        if (components != 2)
-                        {
-                            vislib::sys::Log::DefaultLog.WriteError("Vectors must have exactly two components '%s'",
-                                this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+            return true;
+        }
 
-                            return false;
-                        }
+        bool vector_field_reader::get_extent(core::Call& call)
+        {
+            // Get call
+            auto* vf_call = dynamic_cast<vector_field_call*>(&call);
 
-                        // Read extents from file
-                        float x_min, x_max, y_min, y_max;
-                        unsigned int x_num, y_num, num;
+            if (vf_call == nullptr)
+            {
+                return false;
+            }
 
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_num), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_min), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_max), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_num), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_min), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_max), sizeof(float));
+            if (!open_file())
+            {
+                return false;
+            }
 
-                        num = x_num * y_num;
+            vf_call->set_resolution(this->stored_data.resolution);
+            vf_call->set_components(this->stored_data.components);
+            vf_call->set_depth(this->stored_data.depth, this->stored_data.depth_range);
+            vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
+            vf_call->set_frame_count(this->stored_data.frame_count);
 
-                        vf_call->set_resolution(this->stored_data.resolution = { static_cast<unsigned int>(x_num), static_cast<unsigned int>(y_num) });
-                        vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle = vislib::math::Rectangle<float>(x_min, y_min, x_max, y_max));
+            return true;
+        }
 
-                        // Read file content
-                        const float x_step = (x_max - x_min) / (x_num - 1);
-                        const float y_step = (y_max - y_min) / (y_num - 1);
+        bool vector_field_reader::open_file()
+        {
+            const auto& file_path = this->file_path_slot.Param<core::param::FilePathParam>()->Value();
 
-                        auto positions = std::make_shared<std::vector<float>>(num * 2);
-                        auto vectors = std::make_shared<std::vector<float>>(num * 2);
+            if (file_path.IsEmpty() || !this->file_path_slot.IsDirty())
+            {
+                return true;
+            }
 
-                        for (unsigned int y = 0; y < y_num; ++y)
-                        {
-                            for (unsigned int x = 0; x < x_num; ++x)
-                            {
-                                const unsigned int xy = y * x_num + x;
+            this->file_path_slot.ResetDirty();
 
-                                // Calculate positions
-                                const float x_pos = x_min + x * x_step;
-                                const float y_pos = y_min + y * y_step;
+            const std::string filename(static_cast<const char*>(T2A(file_path)));
 
-                                (*positions)[xy * 2 + 0] = x_pos;
-                                (*positions)[xy * 2 + 1] = y_pos;
+            // Map file
+            std::shared_ptr<mapped_file> file;
 
-                                // Read vectors
-                                vectors_ifs.read(reinterpret_cast<char*>(&(*vectors)[xy * 2 + 0]), sizeof(float));
-                                vectors_ifs.read(reinterpret_cast<char*>(&(*vectors)[xy * 2 + 1]), sizeof(float));
-                            }
-                        }
+            try
+            {
+                file = std::make_shared<mapped_file>(filename);
+            }
+            catch (const std::exception& ex)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("Unable to open input vector field file '%s': %s",
+                    filename.c_str(), ex.what());
 
-                        vf_call->set_positions(this->stored_data.positions = positions);
-                        vf_call->set_vectors(this->stored_data.vectors = vectors);
+                return false;
+            }
 
-                        vectors_ifs.close();
+            std::size_t offset = 0;
 
-                        vf_call->SetDataHash(this->stored_data.hash = (vf_call->DataHash() + 1));
+            auto read = [&file, &offset](void* value, const std::size_t size)
+            {
+                if (offset + size > file->size())
+                {
+                    return false;
+                }
 
-                        return true;
-                    }
-                    else
-                    {
-                        vislib::sys::Log::DefaultLog.WriteWarn("Unable to open input vector field file '%s'!",
-                            this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+                std::memcpy(value, file->data() + offset, size);
+                offset += size;
 
-                        return false;
-                    }
-                }
-                else
-                {
-                    vf_call->set_resolution(this->stored_data.resolution);
-                    vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
+                return true;
+            };
 
-                    vf_call->set_positions(this->stored_data.positions);
-                    vf_call->set_vectors(this->stored_data.vectors);
+            // Get dimension from file
+            unsigned int dimension, components;
 
-                    vf_call->SetDataHash(this->stored_data.hash);
+            if (!read(&dimension, sizeof(unsigned int)) || !read(&components, sizeof(unsigned int)))
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Vector field file is too small '%s'", filename.c_str());
 
-                    return true;
+                return false;
+            }
+
+            if (components != 2 && components != 3)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Vectors must have two or three components '%s'", filename.c_str());
+
+                return false;
+            }
+
+            if (dimension != components && dimension != components + 1)
+            {
+                vislib::sys::Log::DefaultLog.WriteError("Vector field file must have as many spatial dimensions as vector components, "
+                    "and optionally a time dimension '%s'", filename.c_str());
+
+                return false;
+            }
+
+            // Read extents from file, where the z dimension is only given for three components, and the time dimension is optional
+            std::array<unsigned int, 4> num{ 0u, 0u, 1u, 1u };
+            std::array<float, 4> min{ 0.0f, 0.0f, 0.0f, 0.0f };
+            std::array<float, 4> max{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for (unsigned int d = 0; d < dimension; ++d)
+            {
+                const auto index = (components == 2 && d == 2) ? 3 : d;
+
+                if (!read(&num[index], sizeof(unsigned int)) || !read(&min[index], sizeof(float)) || !read(&max[index], sizeof(float)))
+                {
+                    vislib::sys::Log::DefaultLog.WriteError("Vector field file is too small '%s'", filename.c_str());
+
+                    return false;
                 }
             }
-            else
+
+            const std::size_t num_values = static_cast<std::size_t>(num[0]) * num[1] * num[2] * num[3] * components;
+
+            if (num_values == 0 || offset + num_values * sizeof(float) > file->size())
             {
+                vislib::sys::Log::DefaultLog.WriteError("Vector field file does not contain the expected number of vectors '%s'",
+                    filename.c_str());
+
                 return false;
             }
 
+            this->stored_data.resolution = { num[0], num[1] };
+            this->stored_data.components = components;
+            this->stored_data.depth = num[2];
+            this->stored_data.depth_range = { min[2], max[2] };
+            this->stored_data.bounding_rectangle = vislib::math::Rectangle<float>(min[0], min[1], max[0], max[1]);
+            this->stored_data.frame_count = num[3];
+            this->stored_data.time_range = { min[3], max[3] };
+
+            this->stored_data.file = file;
+            this->stored_data.data_offset = offset;
+
+            this->stored_data.vectors = nullptr;
+            this->stored_data.tiled_vectors = nullptr;
+
             return true;
         }
 
-        bool vector_field_reader::get_extent(core::Call& call)
+        void vector_field_reader::load_frame(const unsigned int frame_id)
         {
-            // Get call
-            auto* vf_call = dynamic_cast<vector_field_call*>(&call);
-
-            if (vf_call != nullptr)
+            if (this->stored_data.file == nullptr)
             {
-                if (!this->file_path_slot.Param<core::param::FilePathParam>()->Value().IsEmpty() && this->file_path_slot.IsDirty())
-                {
-                    // Open file
-                    std::ifstream vectors_ifs(this->file_path_slot.Param<core::param::FilePathParam>()->Value(), std::ios_base::in | std::ios_base::binary);
+                return;
+            }
 
-                    if (vectors_ifs.good())
-                    {
-                        // Get dimension from file
-                        unsigned int dimension, components;
+            const auto frame = std::min(frame_id, this->stored_data.frame_count - 1);
 
-                        vectors_ifs.read(reinterpret_cast<char*>(&dimension), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&components), sizeof(unsigned int));
+            const bool tiling_changed = this->tile_size.IsDirty() || this->tile_cache_size.IsDirty();
 
-                        if (dimension != 2)
-                        {
-                            vislib::sys::Log::DefaultLog.WriteError("Vector field file must have exactly two dimensions '%s'",
-                                this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+            this->tile_size.ResetDirty();
+            this->tile_cache_size.ResetDirty();
 
-                            return false;
-                        }
+            if (!tiling_changed && (this->stored_data.vectors != nullptr || this->stored_data.tiled_vectors != nullptr)
+                && this->stored_data.frame_id == frame)
+            {
+                return;
+            }
 
-                        if (components != 2)
-                        {
-                            vislib::sys::Log::DefaultLog.WriteError("Vectors must have exactly two components '%s'",
-                                this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+            const auto resolution = this->stored_data.resolution;
 
-                            return false;
-                        }
+            const std::size_t num_values = static_cast<std::size_t>(resolution[0]) * resolution[1] * this->stored_data.depth
+                * this->stored_data.components;
+            const std::size_t frame_offset = this->stored_data.data_offset + frame * num_values * sizeof(float);
 
-                        // Read extents from file
-                        float x_min, x_max, y_min, y_max;
-                        unsigned int x_num, y_num;
+            std::shared_ptr<std::vector<float>> vectors;
+            std::shared_ptr<tiled_vector_field> tiled_vectors;
 
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_num), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_min), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&x_max), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_num), sizeof(unsigned int));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_min), sizeof(float));
-                        vectors_ifs.read(reinterpret_cast<char*>(&y_max), sizeof(float));
+            const auto tile_size = this->tile_size.Param<core::param::IntParam>()->Value();
 
-                        vf_call->set_resolution(this->stored_data.resolution = { static_cast<unsigned int>(x_num), static_cast<unsigned int>(y_num) });
-                        vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle = vislib::math::Rectangle<float>(x_min, y_min, x_max, y_max));
+            if (tile_size > 0 && this->stored_data.components != 2)
+            {
+                vislib::sys::Log::DefaultLog.WriteWarn("Tiles are only supported for planar vector fields, reading whole frames instead");
+            }
+            else if (tile_size > 0)
+            {
+                // Read the rows of a tile from the mapping, keeping the file alive for as long as the tiles are used
+                auto file = this->stored_data.file;
 
-                        vectors_ifs.close();
+                auto loader = [file, frame_offset, resolution](const std::array<unsigned int, 2>& first,
+                    const std::array<unsigned int, 2>& num, std::vector<float>& vectors)
+                {
+                    vectors.resize(static_cast<std::size_t>(num[0]) * num[1] * 2);
 
-                        return true;
-                    }
-                    else
+                    for (unsigned int y = 0; y < num[1]; ++y)
                     {
-                        vislib::sys::Log::DefaultLog.WriteWarn("Unable to open input vector field file '%s'!",
-                            this->file_path_slot.Param<core::param::FilePathParam>()->Value());
+                        const std::size_t xy = static_cast<std::size_t>(first[1] + y) * resolution[0] + first[0];
 
-                        return false;
+                        std::memcpy(vectors.data() + static_cast<std::size_t>(y) * num[0] * 2,
+                            file->data() + frame_offset + xy * 2 * sizeof(float), static_cast<std::size_t>(num[0]) * 2 * sizeof(float));
                     }
+                };
+
+                try
+                {
+                    tiled_vectors = std::make_shared<tiled_vector_field>(resolution, this->stored_data.bounding_rectangle,
+                        static_cast<unsigned int>(tile_size), static_cast<std::size_t>(this->tile_cache_size.Param<core::param::IntParam>()->Value()),
+                        loader);
                 }
-                else
+                catch (const std::exception& ex)
                 {
-                    vf_call->set_resolution(this->stored_data.resolution);
-                    vf_call->set_bounding_rectangle(this->stored_data.bounding_rectangle);
-
-                    return true;
+                    vislib::sys::Log::DefaultLog.WriteWarn("Unable to provide the vector field in tiles, reading whole frames instead: %s", ex.what());
                 }
             }
-            else
+
+            if (tiled_vectors == nullptr)
             {
-                return false;
+                // Copy the frame in one go, only touching the pages of the mapping that belong to it
+                vectors = std::make_shared<std::vector<float>>(num_values);
+                std::memcpy(vectors->data(), this->stored_data.file->data() + frame_offset, num_values * sizeof(float));
             }
 
-            return true;
+            this->stored_data.frame_id = frame;
+            this->stored_data.time = this->stored_data.frame_count > 1 ? (this->stored_data.time_range[0] + frame *
+                (this->stored_data.time_range[1] - this->stored_data.time_range[0]) / (this->stored_data.frame_count - 1))
+                : this->stored_data.time_range[0];
+
+            this->stored_data.vectors = vectors;
+            this->stored_data.tiled_vectors = tiled_vectors;
+
+            ++this->stored_data.hash;
         }
     }
 }
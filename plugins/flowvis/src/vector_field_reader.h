@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include "mapped_file.h"
+#include "tiled_vector_field.h"
 #include "vector_field_call.h"
 
 #include "mmcore/Call.h"
@@ -16,6 +18,7 @@
 #include "vislib/math/Rectangle.h"
 
 #include <array>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -26,6 +29,11 @@ namespace megamol
         /**
         * Reader for vector fields.
         *
+        * The file is memory-mapped, and only the vectors of the requested frame are read from it.
+        * Files store planar fields with two components, or volumetric fields with three components.
+        * Files with a dimension more than the components store time-dependent fields, one frame after another.
+        * Optionally, frames are provided in tiles, which are only read when accessed, for fields exceeding memory.
+        *
         * @author Alexander Straub
         */
         class vector_field_reader : public core::Module
@@ -84,12 +92,30 @@ namespace megamol
             bool get_data(core::Call& call);
             bool get_extent(core::Call& call);
 
+            /**
+            * Map the file and read its header, if the file path has changed
+            *
+            * @return 'true' on success, 'false' otherwise.
+            */
+            bool open_file();
+
+            /**
+            * Copy the vectors of the requested frame from the mapped file, or set up its tiles, if not already loaded
+            *
+            * @param frame_id   Requested frame, clamped to the available frames
+            */
+            void load_frame(unsigned int frame_id);
+
             /** Output slot */
             core::CalleeSlot output_slot;
 
             /** File path parameter */
             core::param::ParamSlot file_path_slot;
 
+            /** Tile size and number of cached tiles for loading frames on demand */
+            core::param::ParamSlot tile_size;
+            core::param::ParamSlot tile_cache_size;
+
             /** Output data */
             struct data_t
             {
@@ -99,11 +125,25 @@ namespace megamol
                 /** Grid resolution */
                 std::array<unsigned int, 2> resolution;
 
-                /** Grid positions */
-                std::shared_ptr<std::vector<float>> positions;
+                /** Number of components, and grid resolution and extent along the z axis */
+                unsigned int components;
+                unsigned int depth;
+                std::array<float, 2> depth_range;
+
+                /** Number of frames, and time of the first and last frame */
+                unsigned int frame_count;
+                std::array<float, 2> time_range;
+
+                /** Mapped file and offset of the vectors therein */
+                std::shared_ptr<mapped_file> file;
+                std::size_t data_offset;
+
+                /** Loaded frame, its time and vectors */
+                unsigned int frame_id;
+                float time;
 
-                /** Vectors */
                 std::shared_ptr<std::vector<float>> vectors;
+                std::shared_ptr<tiled_vector_field> tiled_vectors;
 
                 /** Current hash */
                 SIZE_T hash;
@@ -50,6 +50,8 @@
 
 
 #define GUI_MAX_MULITLINE 7
+/// Maximum time in seconds the GUI is not rebuilt, to show changes of parameter values not caused by input.
+#define GUI_IDLE_REFRESH_INTERVAL 0.25f
 
 
 using namespace megamol;
@@ -62,6 +64,8 @@ GUIView::GUIView()
     , render_view_slot("renderview", "Connects to a preceding RenderView that will be decorated with a GUI")
     , style_param("style", "Color style, theme")
     , state_param("state", "Current state of all windows. Automatically updated.")
+    , redraw_param("eventDrivenRedraw", "Rebuild the GUI only on input and in regular intervals, drawing the last "
+                                        "frame again otherwise")
     , context(nullptr)
     , window_manager()
     , tf_editor()
@@ -91,6 +95,9 @@ GUIView::GUIView()
 
     this->state_param << new core::param::StringParam("");
     this->MakeSlotAvailable(&this->state_param);
+
+    this->redraw_param << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->redraw_param);
 }
 
 GUIView::~GUIView() { this->Release(); }
@@ -192,6 +199,11 @@ bool GUIView::create() {
     this->state.win_delete = "";
     this->state.last_instance_time = 0.0f;
     this->state.hotkeys_check_once = true;
+    this->requestRedraw();
+    this->state.idle_time = 0.0f;
+    this->state.gui_active = false;
+    this->state.gui_hovered = false;
+    this->state.display_size = ImVec2(0.0f, 0.0f);
     // Adding additional utf-8 glyph ranges
     /// (there is no error if glyph has no representation in font atlas)
     this->state.font_utf8_ranges.clear();
@@ -367,6 +379,7 @@ void GUIView::UpdateFreeze(bool freeze) {
 
 bool GUIView::OnKey(core::view::Key key, core::view::KeyAction action, core::view::Modifiers mods) {
     ImGui::SetCurrentContext(this->context);
+    this->requestRedraw();
 
     ImGuiIO& io = ImGui::GetIO();
 
@@ -520,6 +533,7 @@ bool GUIView::OnKey(core::view::Key key, core::view::KeyAction action, core::vie
 
 bool GUIView::OnChar(unsigned int codePoint) {
     ImGui::SetCurrentContext(this->context);
+    this->requestRedraw();
 
     ImGuiIO& io = ImGui::GetIO();
     io.ClearInputCharacters();
@@ -547,6 +561,13 @@ bool GUIView::OnMouseMove(double x, double y) {
     auto hoverFlags = ImGuiHoveredFlags_AnyWindow | ImGuiHoveredFlags_AllowWhenDisabled |
                       ImGuiHoveredFlags_AllowWhenBlockedByPopup | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem;
 
+    // Moving the mouse over the view only requires the GUI to be rebuilt for updating the hover state when leaving it
+    const bool hovered = io.WantCaptureMouse || this->hoversWindow((float)x, (float)y);
+    if (hovered || this->state.gui_hovered) {
+        this->requestRedraw();
+    }
+    this->state.gui_hovered = hovered;
+
     if (!ImGui::IsWindowHovered(hoverFlags)) {
         auto* crv = this->render_view_slot.CallAs<core::view::CallRenderView>();
         if (crv == nullptr) return false;
@@ -575,6 +596,8 @@ bool GUIView::OnMouseButton(
     auto hoverFlags = ImGuiHoveredFlags_AnyWindow | ImGuiHoveredFlags_AllowWhenDisabled |
                       ImGuiHoveredFlags_AllowWhenBlockedByPopup | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem;
 
+    this->requestRedraw();
+
     // Trigger saving state when mouse hoverd any window and on button mouse release event
     if ((!down) && (io.MouseDown[buttonIndex]) && hoverFlags) {
         this->state.win_save_state = true;
@@ -610,6 +633,10 @@ bool GUIView::OnMouseScroll(double dx, double dy) {
     auto hoverFlags = ImGuiHoveredFlags_AnyWindow | ImGuiHoveredFlags_AllowWhenDisabled |
                       ImGuiHoveredFlags_AllowWhenBlockedByPopup | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem;
 
+    if (this->state.gui_hovered) {
+        this->requestRedraw();
+    }
+
     if (!ImGui::IsWindowHovered(hoverFlags)) {
         auto* crv = this->render_view_slot.CallAs<core::view::CallRenderView>();
         if (crv == nullptr) return false;
@@ -663,6 +690,7 @@ void GUIView::validateGUI() {
             break;
         }
         this->style_param.ResetDirty();
+        this->requestRedraw();
     }
 
     ImGuiIO& io = ImGui::GetIO();
@@ -671,6 +699,7 @@ void GUIView::validateGUI() {
         auto state = this->state_param.Param<core::param::StringParam>()->Value();
         this->window_manager.StateFromJSON(std::string(state));
         this->state_param.ResetDirty();
+        this->requestRedraw();
     } else if (this->state.win_save_state &&
                (this->state.win_save_delay > 2.0f)) { // Delayed saving after triggering saving state
         std::string state;
@@ -695,6 +724,7 @@ bool GUIView::drawGUI(vislib::math::Rectangle<int> viewport, double instanceTime
     ImGuiIO& io = ImGui::GetIO();
     io.DisplaySize = ImVec2((float)viewportWidth, (float)viewportHeight);
     io.DisplayFramebufferScale = ImVec2(1.0, 1.0);
+    const bool rebuild = this->needsRebuild(io.DisplaySize);
 
     if ((instanceTime - this->state.last_instance_time) < 0.0) {
         vislib::sys::Log::DefaultLog.WriteWarn("[GUIView] Current instance time results in negative time delta.");
@@ -706,6 +736,20 @@ bool GUIView::drawGUI(vislib::math::Rectangle<int> viewport, double instanceTime
                                          ? (instanceTime)
                                          : (this->state.last_instance_time + io.DeltaTime);
 
+    // Draw the last frame again if nothing changed, which only costs its draw calls ----------------
+    if (!rebuild) {
+        this->state.idle_time += io.DeltaTime;
+        // Scrolling the view must not pile up for the next rebuilt frame
+        io.MouseWheel = 0.0f;
+        io.MouseWheelH = 0.0f;
+        auto draw_data = ImGui::GetDrawData();
+        if (draw_data != nullptr) {
+            glViewport(0, 0, viewportWidth, viewportHeight);
+            ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+        }
+        return true;
+    }
+
     // Changes that need to be applied before next ImGui::Begin: ---------------
     // Loading new font (set in FONT window)
     if (!this->state.font_file.empty()) {
@@ -799,6 +843,14 @@ bool GUIView::drawGUI(vislib::math::Rectangle<int> viewport, double instanceTime
     };
     this->window_manager.EnumWindows(func);
 
+    // Keep rebuilding while the user interacts with an item, e.g. for dragging sliders or the text cursor
+    this->state.gui_active = ImGui::IsAnyItemActive() || io.WantTextInput;
+    this->state.idle_time = 0.0f;
+    this->state.display_size = io.DisplaySize;
+    if (this->state.redraw_frames > 0) {
+        this->state.redraw_frames--;
+    }
+
     // Render the frame -------------------------------------------------------
     glViewport(0, 0, viewportWidth, viewportHeight);
     ImGui::Render();
@@ -808,6 +860,40 @@ bool GUIView::drawGUI(vislib::math::Rectangle<int> viewport, double instanceTime
 }
 
 
+bool GUIView::needsRebuild(const ImVec2& display_size) {
+    if (!this->redraw_param.Param<core::param::BoolParam>()->Value() || (this->state.redraw_frames > 0) ||
+        this->state.gui_active || (display_size.x != this->state.display_size.x) ||
+        (display_size.y != this->state.display_size.y) || (ImGui::GetDrawData() == nullptr)) {
+        return true;
+    }
+    if (!this->state.font_file.empty() || (this->state.font_index >= 0) || !this->state.win_delete.empty()) {
+        return true;
+    }
+
+    // Rebuild regularly for showing changes of parameter values, and the fps window at its refresh rate
+    float interval = GUI_IDLE_REFRESH_INTERVAL;
+    this->window_manager.EnumWindows([&](const std::string& wn, WindowManager::WindowConfiguration& wc) {
+        if (wc.win_show && (wc.win_callback == WindowManager::DrawCallbacks::FPSMS) &&
+            (wc.fpsms_refresh_rate > 0.0f)) {
+            interval = std::min(interval, 1.0f / wc.fpsms_refresh_rate);
+        }
+    });
+    return (this->state.idle_time >= interval);
+}
+
+
+bool GUIView::hoversWindow(float x, float y) {
+    bool hovers = false;
+    this->window_manager.EnumWindows([&](const std::string& wn, WindowManager::WindowConfiguration& wc) {
+        if (wc.win_show && (x >= wc.win_position.x) && (y >= wc.win_position.y) &&
+            (x < wc.win_position.x + wc.win_size.x) && (y < wc.win_position.y + wc.win_size.y)) {
+            hovers = true;
+        }
+    });
+    return hovers;
+}
+
+
 void GUIView::drawMainWindowCallback(const std::string& wn, WindowManager::WindowConfiguration& wc) {
     // Menu -------------------------------------------------------------------
     /// Requires window flag ImGuiWindowFlags_MenuBar
@@ -1144,7 +1230,7 @@ void GUIView::drawFpsWindowCallback(const std::string& wn, WindowManager::Window
     ImGuiIO& io = ImGui::GetIO();
     ImGuiStyle& style = ImGui::GetStyle();
 
-    wc.buf_current_delay += io.DeltaTime;
+    wc.buf_current_delay += io.DeltaTime + this->state.idle_time; // including the frames the GUI was not rebuilt
     if (wc.fpsms_refresh_rate <= 0.0f) {
         return;
     }
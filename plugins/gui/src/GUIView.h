@@ -130,6 +130,11 @@ private:
         std::string win_delete;    // Name of the window to delete.
         double last_instance_time; // Last instance time.
         bool hotkeys_check_once;   // WORKAROUND: Check multiple hotkey assignments once.
+        unsigned int redraw_frames; // Number of frames the GUI is rebuilt at least, e.g. after input.
+        float idle_time;            // Time since the GUI was rebuilt last.
+        bool gui_active;            // Flag indicating that an item was active in the last rebuilt frame.
+        bool gui_hovered;           // Flag indicating that the mouse hovered the GUI at the last mouse move.
+        ImVec2 display_size;        // Display size of the last rebuilt frame.
     };
 
 
@@ -147,6 +152,9 @@ private:
     /** A parameter to store the profile */
     core::param::ParamSlot state_param;
 
+    /** A parameter to rebuild the GUI only on input instead of every frame */
+    core::param::ParamSlot redraw_param;
+
     /** The ImGui context created and used by this GUIView */
     ImGuiContext* context;
 
@@ -184,6 +192,26 @@ private:
      */
     void validateGUI();
 
+    /**
+     * Requests the GUI to be rebuilt for the next frames, e.g. after input.
+     */
+    inline void requestRedraw(void) { this->state.redraw_frames = 3; }
+
+    /**
+     * Answers whether the GUI has to be rebuilt, or whether the last frame can be drawn again.
+     *
+     * @param display_size  The current display size.
+     */
+    bool needsRebuild(const ImVec2& display_size);
+
+    /**
+     * Answers whether a position is covered by a visible window.
+     *
+     * @param x  The x coordinate of the position.
+     * @param y  The y coordinate of the position.
+     */
+    bool hoversWindow(float x, float y);
+
     /**
      * Draws the GUI.
      *
@@ -50,7 +50,20 @@ public:
 
     enum Encoding : uint8_t { PNG, BMP, JPEG, SNAPPY, RAW };
 
-    enum Format : uint8_t { RGB, RGBA };
+    /** Pixel formats, the BC formats are block compressed and can be uploaded to the GPU as is */
+    enum Format : uint8_t { RGB, RGBA, BC1_RGB, BC1_RGBA, BC3_RGBA, BC7_RGBA };
+
+    /**
+     * GL texture holding the decoded image, uploaded once by the producer for all consumers.
+     * The name is valid in the GL context of the producer, the producer's deleter releases it.
+     */
+    struct Texture {
+        /** Name of the GL_TEXTURE_2D */
+        unsigned int name = 0;
+
+        /** Number of mip levels in the texture */
+        unsigned int levels = 1;
+    };
 
     Image2DCall();
 
@@ -58,6 +71,20 @@ public:
 
     void* GetData() const { return this->data_; }
 
+    /**
+     * Answer the reference-counted handle of the data.
+     *
+     * @return The handle, or nullptr if the producer set a raw pointer only
+     */
+    std::shared_ptr<const void> GetDataHandle() const { return this->data_handle_; }
+
+    /**
+     * Answer the texture of the image.
+     *
+     * @return The texture, or nullptr if the producer did not upload the image
+     */
+    std::shared_ptr<const Texture> GetTexture() const { return this->texture_; }
+
     Encoding GetEncoding() const { return this->enc_; }
 
     Format GetFormat() const { return this->format_; }
@@ -68,6 +95,19 @@ public:
 
     size_t GetFilesize() const { return this->filesize_; }
 
+    /**
+     * Answer whether a format is block compressed.
+     *
+     * @param format The format
+     *
+     * @return True for the BC formats
+     */
+    static bool IsCompressed(Format const format) { return format >= BC1_RGB; }
+
+    /**
+     * Sets the data as raw pointer, which must stay valid until the next request.
+     * Resets the data handle and the texture.
+     */
     void SetData(Encoding const enc, Format const format, size_t width, size_t height, size_t filesize,
         void* data) {
         this->enc_ = enc;
@@ -76,8 +116,27 @@ public:
         this->height_ = height;
         this->filesize_ = filesize;
         this->data_ = data;
+        this->data_handle_.reset();
+        this->texture_.reset();
     }
 
+    /**
+     * Sets the data as reference-counted handle, so consumers can keep the data beyond the next request
+     * without copying it. Resets the texture.
+     */
+    void SetData(Encoding const enc, Format const format, size_t width, size_t height, size_t filesize,
+        std::shared_ptr<const void> data) {
+        this->SetData(enc, format, width, height, filesize, const_cast<void*>(data.get()));
+        this->data_handle_ = std::move(data);
+    }
+
+    /**
+     * Sets the texture of the data set before.
+     *
+     * @param texture The texture
+     */
+    void SetTexture(std::shared_ptr<const Texture> texture) { this->texture_ = std::move(texture); }
+
 private:
     size_t width_, height_, filesize_;
 
@@ -87,6 +146,10 @@ private:
 
     void* data_;
 
+    std::shared_ptr<const void> data_handle_;
+
+    std::shared_ptr<const Texture> texture_;
+
 }; // end class Image2DCall
 
 typedef megamol::core::CallAutoDescription<Image2DCall> Image2DCallDescription;
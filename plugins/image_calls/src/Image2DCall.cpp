@@ -2,4 +2,5 @@
 #include "image_calls/Image2DCall.h"
 
 
-megamol::image_calls::Image2DCall::Image2DCall() : width_{0}, height_{0}, filesize_{0}, enc_{PNG}, data_{nullptr} {}
+megamol::image_calls::Image2DCall::Image2DCall()
+    : width_{0}, height_{0}, filesize_{0}, enc_{PNG}, format_{RGB}, data_{nullptr} {}
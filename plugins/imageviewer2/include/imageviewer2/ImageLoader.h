@@ -0,0 +1,114 @@
+/*
+ * ImageLoader.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_IMAGELOADER_H_INCLUDED
+#define MEGAMOLCORE_IMAGELOADER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#    pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vislib/String.h"
+#include "vislib/graphics/BitmapImage.h"
+
+namespace megamol {
+namespace imageviewer2 {
+
+/**
+ * Loads and decodes images on a pool of background threads, such that the
+ * render thread only has to upload them. Each thread uses its own codec
+ * instances, as the codecs are not thread-safe. Decoded images are cached
+ * until they are no longer retained.
+ */
+class ImageLoader {
+public:
+    /** A decoded image, in TemplateByteRGB format */
+    typedef std::shared_ptr<const vislib::graphics::BitmapImage> ImagePtr;
+
+    /**
+     * Ctor.
+     *
+     * @param threadCount The number of decoding threads
+     */
+    ImageLoader(unsigned int threadCount);
+
+    /** Dtor. Waits for the decoding threads to finish their current images. */
+    ~ImageLoader(void);
+
+    /**
+     * Answer the decoded image of a file, if it is ready.
+     *
+     * @param filename The image file
+     * @param failed Receives whether loading or decoding the file failed
+     *
+     * @return The decoded image, or nullptr if it is not ready or failed
+     */
+    ImagePtr Get(const vislib::TString& filename, bool& failed);
+
+    /**
+     * Requests a file to be loaded in the background, unless it is cached
+     * or queued already.
+     *
+     * @param filename The image file
+     * @param urgent Whether the file is needed right now, i.e. decoded
+     *               before all prefetched files
+     */
+    void Request(const vislib::TString& filename, bool urgent);
+
+    /**
+     * Drops all cached and queued images, except for the given files.
+     *
+     * @param filenames The files to keep
+     */
+    void Retain(const std::vector<vislib::TString>& filenames);
+
+private:
+    /** A cached image */
+    struct Entry {
+        /** Whether the file has been processed */
+        bool done = false;
+
+        /** Whether loading or decoding the file failed */
+        bool failed = false;
+
+        /** The decoded image */
+        ImagePtr image;
+    };
+
+    /** The main function of the decoding threads */
+    void decode(void);
+
+    /** The cached and queued images by file name */
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+
+    /** The files waiting to be decoded */
+    std::deque<std::string> queue;
+
+    /** Guards 'entries', 'queue' and 'running' */
+    std::mutex lock;
+
+    /** Signals new files in the queue */
+    std::condition_variable queued;
+
+    /** Whether the decoding threads keep running */
+    bool running;
+
+    /** The decoding threads */
+    std::vector<std::thread> threads;
+};
+
+} /* end namespace imageviewer2 */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_IMAGELOADER_H_INCLUDED */
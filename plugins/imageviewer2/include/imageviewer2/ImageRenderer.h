@@ -12,6 +12,7 @@
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
 #include <memory>
+#include "imageviewer2/ImageLoader.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/view/Renderer3DModule_2.h"
 #include "vislib/Pair.h"
@@ -102,6 +103,11 @@ protected:
     virtual bool Render(view::CallRender3D_2& call);
 
 private:
+    /** The image tiles with their rectangles */
+    typedef vislib::Array<
+        vislib::Pair<vislib::math::Rectangle<float>, vislib::SmartPtr<vislib::graphics::gl::OpenGLTexture2D>>>
+        TileArray;
+
     /**
      * Splits a line at the semicolon into a left and right part. If there
      * is no semicolon, defaultEye governs which one of the strings is set,
@@ -152,6 +158,34 @@ private:
     /** makes sure the image for the respective eye is loaded. */
     bool assertImage(bool rightEye);
 
+    /**
+     * Continues loading a local image file in the background, or starts
+     * it if the file changed, and uploads a limited number of its tiles
+     * once it is decoded. The last image stays visible until all tiles
+     * of the new one are uploaded.
+     *
+     * @param filename The image file to show
+     */
+    void streamImage(const vislib::TString& filename);
+
+    /** Requests the images of the next slides from the loader. */
+    void prefetchImages(void);
+
+    /**
+     * Uploads one tile of an RGB image through the pixel buffer.
+     *
+     * @param image The image data
+     * @param imageWidth The width of the image
+     * @param imageHeight The height of the image
+     * @param x The left column of the tile
+     * @param y The top row of the tile
+     * @param target The tiles the new one is appended to
+     *
+     * @return 'true' on success, 'false' if the texture could not be created
+     */
+    bool uploadTile(const BYTE* image, unsigned int imageWidth, unsigned int imageHeight, unsigned int x,
+        unsigned int y, TileArray& target);
+
     bool initMPI();
 
     /** The image file path slot */
@@ -187,6 +221,12 @@ private:
     /** if only one image per pair is defined: where it should go */
     param::ParamSlot defaultEye;
 
+    /** the number of following slides that are decoded in advance */
+    param::ParamSlot prefetchSlot;
+
+    /** the number of tiles uploaded per frame while switching images */
+    param::ParamSlot tilesPerFrameSlot;
+
     /** slot for MPIprovider */
     CallerSlot callRequestMpi;
 
@@ -225,8 +265,28 @@ private:
     GLuint theVAO;
 
     /** The image tiles */
-    vislib::Array<vislib::Pair<vislib::math::Rectangle<float>, vislib::SmartPtr<vislib::graphics::gl::OpenGLTexture2D>>>
-        tiles;
+    TileArray tiles;
+
+    /** Whether the tiles changed since the vertex buffers were filled */
+    bool tilesChanged;
+
+    /** The background decoder for local image files */
+    std::unique_ptr<ImageLoader> loader;
+
+    /** The file that is being loaded, empty if none */
+    vislib::TString pendingFile;
+
+    /** The decoded image of pendingFile, once it is ready */
+    ImageLoader::ImagePtr pendingImage;
+
+    /** The uploaded tiles of pendingImage */
+    TileArray pendingTiles;
+
+    /** The index of the next tile of pendingImage to upload */
+    unsigned int pendingTile;
+
+    /** The pixel buffer for uploading tiles */
+    GLuint uploadBuffer;
 
     /** the slide show files for the left eye */
     vislib::Array<vislib::TString> leftFiles;
@@ -0,0 +1,173 @@
+/*
+ * ImageLoader.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "imageviewer2/ImageLoader.h"
+#include <algorithm>
+#include "imageviewer2/JpegBitmapCodec.h"
+#include "mmcore/misc/PngBitmapCodec.h"
+#include "vislib/graphics/BitmapCodecCollection.h"
+#include "vislib/sys/FastFile.h"
+#include "vislib/sys/Log.h"
+
+using namespace megamol;
+
+namespace {
+
+/** The key of a file in the cache */
+std::string fileKey(const vislib::TString& filename) { return std::string(vislib::StringA(filename).PeekBuffer()); }
+
+} // namespace
+
+
+/*
+ * imageviewer2::ImageLoader::ImageLoader
+ */
+imageviewer2::ImageLoader::ImageLoader(unsigned int threadCount) : running(true) {
+    for (unsigned int i = 0; i < std::max(threadCount, 1u); ++i) {
+        this->threads.emplace_back(&ImageLoader::decode, this);
+    }
+}
+
+
+/*
+ * imageviewer2::ImageLoader::~ImageLoader
+ */
+imageviewer2::ImageLoader::~ImageLoader(void) {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->running = false;
+        this->queue.clear();
+    }
+    this->queued.notify_all();
+    for (auto& t : this->threads) {
+        t.join();
+    }
+}
+
+
+/*
+ * imageviewer2::ImageLoader::Get
+ */
+imageviewer2::ImageLoader::ImagePtr imageviewer2::ImageLoader::Get(const vislib::TString& filename, bool& failed) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto it = this->entries.find(fileKey(filename));
+    failed = (it != this->entries.end()) && it->second->done && it->second->failed;
+    if ((it == this->entries.end()) || !it->second->done) {
+        return nullptr;
+    }
+    return it->second->image;
+}
+
+
+/*
+ * imageviewer2::ImageLoader::Request
+ */
+void imageviewer2::ImageLoader::Request(const vislib::TString& filename, bool urgent) {
+    if (filename.IsEmpty()) return;
+    const std::string key = fileKey(filename);
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (this->entries.find(key) != this->entries.end()) {
+            // queued or decoded already, only an urgent file jumps the queue
+            auto it = std::find(this->queue.begin(), this->queue.end(), key);
+            if (!urgent || (it == this->queue.end()) || (it == this->queue.begin())) return;
+            this->queue.erase(it);
+        } else {
+            this->entries[key] = std::make_shared<Entry>();
+        }
+        if (urgent) {
+            this->queue.push_front(key);
+        } else {
+            this->queue.push_back(key);
+        }
+    }
+    this->queued.notify_one();
+}
+
+
+/*
+ * imageviewer2::ImageLoader::Retain
+ */
+void imageviewer2::ImageLoader::Retain(const std::vector<vislib::TString>& filenames) {
+    std::vector<std::string> keys;
+    for (const auto& f : filenames) {
+        keys.push_back(fileKey(f));
+    }
+    auto retained = [&keys](const std::string& key) { return std::find(keys.begin(), keys.end(), key) != keys.end(); };
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        if (retained(it->first)) {
+            ++it;
+        } else {
+            it = this->entries.erase(it);
+        }
+    }
+    this->queue.erase(
+        std::remove_if(this->queue.begin(), this->queue.end(), [&](const std::string& key) { return !retained(key); }),
+        this->queue.end());
+}
+
+
+/*
+ * imageviewer2::ImageLoader::decode
+ */
+void imageviewer2::ImageLoader::decode(void) {
+    // the codecs keep state while decoding, so every thread needs its own ones
+    vislib::graphics::BitmapCodecCollection codecs = vislib::graphics::BitmapCodecCollection::BuildDefaultCollection();
+    codecs.AddCodec(new sg::graphics::PngBitmapCodec());
+    codecs.AddCodec(new sg::graphics::JpegBitmapCodec());
+
+    while (true) {
+        std::string key;
+        std::shared_ptr<Entry> entry;
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->queued.wait(guard, [this]() { return !this->running || !this->queue.empty(); });
+            if (!this->running) return;
+            key = this->queue.front();
+            this->queue.pop_front();
+            auto it = this->entries.find(key);
+            if (it == this->entries.end()) continue;
+            entry = it->second;
+        }
+
+        auto image = std::make_shared<vislib::graphics::BitmapImage>();
+        bool failed = true;
+        try {
+            vislib::sys::FastFile in;
+            if (in.Open(key.c_str(), vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+                    vislib::sys::File::OPEN_ONLY)) {
+                const auto fileSize = static_cast<SIZE_T>(in.GetSize());
+                std::vector<BYTE> allFile(fileSize);
+                in.Read(allFile.data(), fileSize);
+                in.Close();
+                if (codecs.LoadBitmapImage(*image, allFile.data(), fileSize)) {
+                    image->Convert(vislib::graphics::BitmapImage::TemplateByteRGB);
+                    failed = false;
+                } else {
+                    vislib::sys::Log::DefaultLog.WriteWarn("ImageLoader: failed decoding file '%s'\n", key.c_str());
+                }
+            } else {
+                vislib::sys::Log::DefaultLog.WriteWarn("ImageLoader: failed opening file '%s'\n", key.c_str());
+            }
+        } catch (vislib::Exception ex) {
+            vislib::sys::Log::DefaultLog.WriteWarn(
+                "ImageLoader: failed loading file '%s': %s\n", key.c_str(), ex.GetMsgA());
+        } catch (...) {
+            vislib::sys::Log::DefaultLog.WriteWarn("ImageLoader: failed loading file '%s'\n", key.c_str());
+        }
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        entry->done = true;
+        entry->failed = failed;
+        if (!failed) {
+            entry->image = image;
+        }
+    }
+}
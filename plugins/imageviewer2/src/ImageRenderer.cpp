@@ -25,6 +25,8 @@
 #include "mmcore/view/CallRender3D_2.h"
 #include "vislib/sys/Log.h"
 #include "vislib/sys/SystemInformation.h"
+#include <algorithm>
+#include <thread>
 //#include <cmath>
 
 using namespace megamol::core;
@@ -48,11 +50,20 @@ imageviewer2::ImageRenderer::ImageRenderer(void)
     , lastSlot("last", "go to last image in slideshow")
     , blankMachine("blankMachine", "semicolon-separated list of machines that do not load image")
     , defaultEye("defaultEye", "where the image goes if the slideshow only has one image per line")
+    , prefetchSlot("prefetch", "number of following slides that are decoded in the background in advance")
+    , tilesPerFrameSlot("tilesPerFrame", "number of image tiles uploaded per frame while switching local images")
     , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
     , callRequestImage{"requestImage", "Requests an image to display"}
     , width(1)
     , height(1)
     , tiles()
+    , tilesChanged(false)
+    , loader()
+    , pendingFile("")
+    , pendingImage()
+    , pendingTiles()
+    , pendingTile(0)
+    , uploadBuffer(0)
     , leftFiles()
     , rightFiles()
     , datahash{std::numeric_limits<size_t>::max()} {
@@ -95,6 +106,12 @@ imageviewer2::ImageRenderer::ImageRenderer(void)
     this->defaultEye << ep;
     this->MakeSlotAvailable(&this->defaultEye);
 
+    this->prefetchSlot << new param::IntParam(1, 0);
+    this->MakeSlotAvailable(&this->prefetchSlot);
+
+    this->tilesPerFrameSlot << new param::IntParam(4, 1);
+    this->MakeSlotAvailable(&this->tilesPerFrameSlot);
+
     this->leftFiles.AssertCapacity(20);
     this->rightFiles.AssertCapacity(20);
     this->leftFiles.SetCapacityIncrement(20);
@@ -168,6 +185,10 @@ bool imageviewer2::ImageRenderer::create(void) {
     glGenBuffers(1, &theVertBuffer);
     glGenBuffers(1, &theTexCoordBuffer);
     glGenVertexArrays(1, &theVAO);
+    glGenBuffers(1, &uploadBuffer);
+
+    // leave some cores to the rendering
+    this->loader = std::make_unique<ImageLoader>(std::min(4u, std::max(1u, std::thread::hardware_concurrency() / 2)));
 
     return true;
 }
@@ -213,14 +234,144 @@ bool imageviewer2::ImageRenderer::GetExtents(view::CallRender3D_2& call) {
 }
 
 
+/*
+ * imageviewer2::ImageRenderer::streamImage
+ */
+void imageviewer2::ImageRenderer::streamImage(const vislib::TString& filename) {
+    // a partially uploaded image is only dropped if neither eye wants it anymore
+    const bool pendingWanted =
+        !this->pendingFile.IsEmpty() &&
+        ((this->pendingFile == this->leftFilenameSlot.Param<param::FilePathParam>()->Value()) ||
+            (this->pendingFile == this->rightFilenameSlot.Param<param::FilePathParam>()->Value()));
+    if ((filename != this->loadedFile) && (filename != this->pendingFile) && !pendingWanted) {
+        vislib::sys::Log::DefaultLog.WriteInfo(
+            "ImageRenderer: Loading file '%s' in the background\n", filename.PeekBuffer());
+        this->pendingFile = filename;
+        this->pendingImage = nullptr;
+        this->pendingTiles.Clear();
+        this->pendingTile = 0;
+        this->loader->Request(filename, true);
+        this->prefetchImages();
+    }
+    if (this->pendingFile.IsEmpty()) return;
+
+    if (this->pendingImage == nullptr) {
+        bool failed = false;
+        this->pendingImage = this->loader->Get(this->pendingFile, failed);
+        if (failed) {
+            printf("ImageRenderer: failed loading file\n");
+            this->tiles.Clear();
+            this->tilesChanged = true;
+            this->width = this->height = 0;
+            this->loadedFile = this->pendingFile;
+            this->pendingFile.Clear();
+            return;
+        }
+        if (this->pendingImage == nullptr) return;
+        vislib::sys::Log::DefaultLog.WriteInfo(
+            "ImageRenderer: Uploading file '%s'\n", this->pendingFile.PeekBuffer());
+    }
+
+    const unsigned int w = this->pendingImage->Width();
+    const unsigned int h = this->pendingImage->Height();
+    const unsigned int tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+    const unsigned int tileCount = tilesX * ((h + TILE_SIZE - 1) / TILE_SIZE);
+    const BYTE* image_ptr = this->pendingImage->PeekDataAs<BYTE>();
+
+    ::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int budget = this->tilesPerFrameSlot.Param<param::IntParam>()->Value();
+         (budget > 0) && (this->pendingTile < tileCount); --budget, ++this->pendingTile) {
+        this->uploadTile(image_ptr, w, h, (this->pendingTile % tilesX) * TILE_SIZE,
+            (this->pendingTile / tilesX) * TILE_SIZE, this->pendingTiles);
+    }
+
+    if (this->pendingTile == tileCount) {
+        this->tiles = this->pendingTiles;
+        this->pendingTiles.Clear();
+        this->tilesChanged = true;
+        this->width = w;
+        this->height = h;
+        this->loadedFile = this->pendingFile;
+        this->pendingFile.Clear();
+        this->pendingImage = nullptr;
+    }
+}
+
+
+/*
+ * imageviewer2::ImageRenderer::prefetchImages
+ */
+void imageviewer2::ImageRenderer::prefetchImages(void) {
+    std::vector<vislib::TString> retained;
+    retained.push_back(this->leftFilenameSlot.Param<param::FilePathParam>()->Value());
+    retained.push_back(this->rightFilenameSlot.Param<param::FilePathParam>()->Value());
+
+    const int current = this->currentSlot.Param<param::IntParam>()->Value();
+    const int prefetch = this->prefetchSlot.Param<param::IntParam>()->Value();
+    for (int s = std::max(current + 1, 0); (s <= current + prefetch) && (s < this->leftFiles.Count()); ++s) {
+        this->loader->Request(this->leftFiles[s], false);
+        this->loader->Request(this->rightFiles[s], false);
+        retained.push_back(this->leftFiles[s]);
+        retained.push_back(this->rightFiles[s]);
+    }
+
+    // everything else is decoded again if it is needed, which bounds the memory to the prefetched slides
+    this->loader->Retain(retained);
+}
+
+
+/*
+ * imageviewer2::ImageRenderer::uploadTile
+ */
+bool imageviewer2::ImageRenderer::uploadTile(const BYTE* image, unsigned int imageWidth, unsigned int imageHeight,
+    unsigned int x, unsigned int y, TileArray& target) {
+    const unsigned int w = vislib::math::Min(TILE_SIZE, imageWidth - x);
+    const unsigned int h = vislib::math::Min(TILE_SIZE, imageHeight - y);
+
+    // copy the tile into a freshly orphaned pixel buffer, so the driver can transfer it without stalling on the
+    // previous tile, and create the texture from the buffer
+    ::glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->uploadBuffer);
+    ::glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(w) * h * 3, nullptr, GL_STREAM_DRAW);
+    BYTE* buf = static_cast<BYTE*>(::glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+    if (buf == nullptr) {
+        ::glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    for (unsigned int l = 0; l < h; l++) {
+        ::memcpy(buf + (static_cast<size_t>(l) * w * 3),
+            image + ((static_cast<size_t>(y + l) * imageWidth + x) * 3), static_cast<size_t>(w) * 3);
+    }
+    ::glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    vislib::SmartPtr<vislib::graphics::gl::OpenGLTexture2D> tex = new vislib::graphics::gl::OpenGLTexture2D();
+    const bool created = (tex->Create(w, h, false, nullptr, GL_RGB) == GL_NO_ERROR);
+    ::glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!created) return false;
+
+    tex->Bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+    tex->SetFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    tex->SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    target.Add(vislib::Pair<vislib::math::Rectangle<float>, vislib::SmartPtr<vislib::graphics::gl::OpenGLTexture2D>>());
+    target.Last().First().Set(static_cast<float>(x), static_cast<float>(imageHeight - y), static_cast<float>(x + w),
+        static_cast<float>(imageHeight - (y + h)));
+    target.Last().SetSecond(tex);
+    return true;
+}
+
+
 /*
  * imageviewer2::ImageRenderer::release
  */
 void imageviewer2::ImageRenderer::release(void) {
     //    this->image.Release();
+    this->loader.reset();
     glDeleteBuffers(1, &theVertBuffer);
     glDeleteBuffers(1, &theTexCoordBuffer);
     glDeleteVertexArrays(1, &theVAO);
+    glDeleteBuffers(1, &uploadBuffer);
 }
 
 
@@ -256,6 +407,16 @@ bool imageviewer2::ImageRenderer::assertImage(bool rightEye) {
     }
 
     param::ParamSlot* filenameSlot = rightEye ? (&this->rightFilenameSlot) : (&this->leftFilenameSlot);
+
+    // local files are decoded in the background, while cluster nodes and images from the call load synchronously
+    // to stay in sync
+    if (!useMpi && !imgcConnected) {
+        filenameSlot->ResetDirty();
+        if (!beBlank) {
+            this->streamImage(filenameSlot->Param<param::FilePathParam>()->Value());
+        }
+        return true;
+    }
     if (filenameSlot->IsDirty() || (imgcConnected /* && imgc->DataHash() != datahash*/) ||
         useMpi) { //< imgc has precedence
         if (!imgcConnected) {
@@ -306,6 +467,9 @@ bool imageviewer2::ImageRenderer::assertImage(bool rightEye) {
                 int fileSize = 0;
                 BYTE* allFile = nullptr;
                 BYTE* imgc_data_ptr = nullptr;
+                // keeps the image of the call alive while it is distributed and decoded
+                std::shared_ptr<const void> imgc_data_handle;
+                int imgcUnchanged = 0;
 #ifdef WITH_MPI
                 // single node or role boss loads the image
                 if (!useMpi || roleRank == roleImgcRank) {
@@ -330,15 +494,23 @@ bool imageviewer2::ImageRenderer::assertImage(bool rightEye) {
                         vislib::sys::Log::DefaultLog.WriteInfo("ImageRenderer: Retrieving image from call\n");
                         // retrieve data from call
                         if (!(*imgc)(0)) return false;
+                        // the tiles are still valid if the producer did not change the image
+                        imgcUnchanged = (imgc->DataHash() != 0 && imgc->DataHash() == this->datahash) ? 1 : 0;
+                        this->datahash = imgc->DataHash();
                         this->width = imgc->GetWidth();
                         this->height = imgc->GetHeight();
                         fileSize = imgc->GetFilesize();
+                        imgc_data_handle = imgc->GetDataHandle();
                         allFile = reinterpret_cast<BYTE*>(imgc->GetData());
                     }
 #ifdef WITH_MPI
                 }
                 // cluster nodes broadcast file size
                 if (useMpi) {
+                    if (remoteness) {
+                        MPI_Bcast(&imgcUnchanged, 1, MPI_INT, roleImgcRank, roleComm);
+                        if (imgcUnchanged != 0) return true;
+                    }
                     int bcastRoot = roleImgcRank;
                     vislib::sys::Log::DefaultLog.WriteInfo("ImageRenderer: Broadcast root = %d\n", bcastRoot);
                     MPI_Bcast(&fileSize, 1, MPI_INT, bcastRoot, roleComm);
@@ -402,32 +574,13 @@ bool imageviewer2::ImageRenderer::assertImage(bool rightEye) {
                 // now everyone should have a copy of the loaded image
 
                 this->tiles.Clear();
+                this->tilesChanged = true;
                 if (this->width > 0 && this->height > 0 && image_ptr != nullptr) {
-                    BYTE* buf = new BYTE[TILE_SIZE * TILE_SIZE * 3];
                     for (unsigned int y = 0; y < this->height; y += TILE_SIZE) {
-                        unsigned int h = vislib::math::Min(TILE_SIZE, this->height - y);
                         for (unsigned int x = 0; x < this->width; x += TILE_SIZE) {
-                            unsigned int w = vislib::math::Min(TILE_SIZE, this->width - x);
-                            for (unsigned int l = 0; l < h; l++) {
-                                ::memcpy(buf + (l * w * 3), image_ptr + ((y + l) * this->width * 3 + x * 3), w * 3);
-                            }
-                            this->tiles.Add(vislib::Pair<vislib::math::Rectangle<float>,
-                                vislib::SmartPtr<vislib::graphics::gl::OpenGLTexture2D>>());
-                            this->tiles.Last().First().Set(static_cast<float>(x), static_cast<float>(this->height - y),
-                                static_cast<float>(x + w), static_cast<float>(this->height - (y + h)));
-                            this->tiles.Last().SetSecond(new vislib::graphics::gl::OpenGLTexture2D());
-                            if (this->tiles.Last().Second()->Create(w, h, false, buf, GL_RGB) != GL_NO_ERROR) {
-                                this->tiles.RemoveLast();
-                            } else {
-                                this->tiles.Last().Second()->Bind();
-                                glGenerateMipmap(GL_TEXTURE_2D);
-                                this->tiles.Last().Second()->SetFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-                                this->tiles.Last().Second()->SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-                                glBindTexture(GL_TEXTURE_2D, 0);
-                            }
+                            this->uploadTile(image_ptr, this->width, this->height, x, y, this->tiles);
                         }
                     }
-                    delete[] buf;
                     if (!imgcConnected) {
                         delete[] allFile;
                     }
@@ -522,8 +675,7 @@ bool imageviewer2::ImageRenderer::Render(view::CallRender3D_2& call) {
     auto MVPinv = glm::inverse(MVP);
     auto MVPtransp = glm::transpose(MVP);
 
-    static bool buffers_initialized = false;
-    if (!buffers_initialized && this->tiles.Count() > 0) {
+    if (this->tilesChanged && this->tiles.Count() > 0) {
         std::vector<GLfloat> theTexCoords;
         std::vector<GLfloat> theVertCoords;
         const float halfTexel = (1.0f / TILE_SIZE) * 0.5f;
@@ -559,7 +711,7 @@ bool imageviewer2::ImageRenderer::Render(view::CallRender3D_2& call) {
         ::glEnableVertexAttribArray(1);
         ::glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
         ::glBindVertexArray(0);
-        buffers_initialized = true;
+        this->tilesChanged = false;
     }
 
     // param::ParamSlot *filenameSlot = rightEye ? (&this->rightFilenameSlot) : (&this->leftFilenameSlot);
@@ -0,0 +1,35 @@
+uniform uint bins;
+uniform uint passCount;
+uniform float alphaScaling;
+
+layout(std430, binding = 6) buffer HistogramSSBO {
+    uint histograms[];
+};
+
+layout(std430, binding = 7) buffer HistogramMaxSSBO {
+    uint histogramMax[];
+};
+
+layout(std430, binding = 8) buffer HistogramPassSSBO {
+    uint histogramPasses[];
+};
+
+in vec2 vsUV;
+flat in uint vsPlot;
+
+layout(location = 0) out vec4 fsColor;
+
+void main() {
+    const uint passes = histogramPasses[vsPlot];
+    const uvec2 bin = uvec2(clamp(vsUV * bins, vec2(0.0), vec2(bins - 1)));
+    const uint count = histograms[(vsPlot * bins + bin.y) * bins + bin.x];
+    if (passes == 0 || count == 0) {
+        discard;
+    }
+
+    // Extrapolate the partial sample to the full table while refining.
+    const float scale = float(passCount) / float(passes);
+    const float value = log(1.0 + count * scale) / log(1.0 + histogramMax[vsPlot] * scale);
+    const vec4 color = tflookup(clamp(value, 0.0, 1.0));
+    fsColor = vec4(color.rgb, color.a * alphaScaling);
+}
@@ -0,0 +1,15 @@
+uniform mat4 modelViewProjection;
+
+out vec2 vsUV;
+flat out uint vsPlot;
+
+void main() {
+    const Plot plot = plots[gl_InstanceID];
+    const vec2 quad[4] = { vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0) };
+
+    vsUV = quad[gl_VertexID];
+    vsPlot = gl_InstanceID;
+
+    const vec2 position = vec2(plot.offsetX, plot.offsetY) + vsUV * vec2(plot.sizeX, plot.sizeY);
+    gl_Position = modelViewProjection * vec4(position, 0.0, 1.0);
+}
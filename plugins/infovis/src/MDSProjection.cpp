@@ -7,6 +7,10 @@
 
 #include <Eigen/Dense>
 #include <Eigen/SVD>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
 #include <set>
 #include <sstream>
 #include "MDSProjection.h"
@@ -22,9 +26,16 @@ MDSProjection::MDSProjection(void)
     , dataOutSlot("dataOut", "Ouput")
     , dataInSlot("dataIn", "Input")
     , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
+    , landmarksSlot("landmarks", "Number of landmarks the rows are placed relative to (0 = all rows, classic MDS)")
+    , randomSeedSlot("randomSeed", "Set the random Seed choosing the first landmark")
     , datahash(0)
     , dataInHash(0)
-    , columnInfos() {
+    , columnInfos()
+    , cancelWorker(false)
+    , embeddingRows(0)
+    , embeddingColumns(0)
+    , embeddingChanged(false)
+    , embeddingFinished(false) {
 
     this->dataInSlot.SetCompatibleCall<megamol::stdplugin::datatools::table::TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataInSlot);
@@ -37,13 +48,19 @@ MDSProjection::MDSProjection(void)
 
     reduceToNSlot << new ::megamol::core::param::IntParam(2);
     this->MakeSlotAvailable(&reduceToNSlot);
+
+    landmarksSlot << new ::megamol::core::param::IntParam(1000, 0);
+    this->MakeSlotAvailable(&landmarksSlot);
+
+    randomSeedSlot << new ::megamol::core::param::IntParam(42);
+    this->MakeSlotAvailable(&randomSeedSlot);
 }
 
 MDSProjection::~MDSProjection(void) { this->Release(); }
 
 bool MDSProjection::create(void) { return true; }
 
-void MDSProjection::release(void) {}
+void MDSProjection::release(void) { this->stopWorker(); }
 
 bool MDSProjection::getDataCallback(core::Call& c) {
     try {
@@ -60,6 +77,7 @@ bool MDSProjection::getDataCallback(core::Call& c) {
 
         bool finished = dataProjection(inCall);
         if (finished == false) return false;
+        this->publish();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -106,60 +124,184 @@ bool MDSProjection::getHashCallback(core::Call& c) {
 bool megamol::infovis::MDSProjection::dataProjection(megamol::stdplugin::datatools::table::TableDataCall* inCall) {
     // Test if inData has changed and if slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !landmarksSlot.IsDirty() && !randomSeedSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
 
     auto columnCount = inCall->GetColumnsCount();
-    auto column_infos = inCall->GetColumnsInfos();
     auto rowsCount = inCall->GetRowsCount();
     auto inData = inCall->GetData();
 
     int outputDimCount = this->reduceToNSlot.Param<core::param::IntParam>()->Value();
+    int landmarkCount = this->landmarksSlot.Param<core::param::IntParam>()->Value();
+    int randomSeed = this->randomSeedSlot.Param<core::param::IntParam>()->Value();
     if (outputDimCount <= 0 || outputDimCount > columnCount) {
         vislib::sys::Log::DefaultLog.WriteError(_T("%hs: No valid Dimension Count has been given\n"), ClassName());
         return false;
     }
 
-    // Load data in a Matrix
-    Eigen::MatrixXd inDataMat = Eigen::MatrixXd(rowsCount, columnCount);
-    for (int row = 0; row < rowsCount; row++) {
-        for (int col = 0; col < columnCount; col++) {
-            inDataMat(row, col) = inData[row * columnCount + col];
+    // the job works on its own copy, the previous one on outdated input
+    std::vector<double> inputData(inData, inData + columnCount * rowsCount);
+    this->stopWorker();
+    {
+        std::lock_guard<std::mutex> lock(this->embeddingLock);
+        this->embeddingChanged = false;
+        this->embeddingFinished = false;
+    }
+
+    this->dataInHash = inCall->DataHash();
+    reduceToNSlot.ResetDirty();
+    landmarksSlot.ResetDirty();
+    randomSeedSlot.ResetDirty();
+
+    const size_t landmarks = (landmarkCount <= 0) ? rowsCount : std::min<size_t>(landmarkCount, rowsCount);
+    this->worker = std::thread(&MDSProjection::work, this, std::move(inputData), rowsCount, columnCount,
+        outputDimCount, landmarks, randomSeed);
+
+    return true;
+}
+
+void megamol::infovis::MDSProjection::work(std::vector<double> input, size_t rows, size_t columns,
+    unsigned int outputColumns, size_t landmarkCount, int randomSeed) {
+    if (rows == 0 || landmarkCount == 0) return;
+    const int rowsCount = static_cast<int>(rows);
+    const int k = static_cast<int>(landmarkCount);
+    auto squaredDistance = [&input, columns](size_t a, size_t b) {
+        double sum = 0.0;
+        for (size_t c = 0; c < columns; c++) {
+            const double d = input[a * columns + c] - input[b * columns + c];
+            sum += d * d;
+        }
+        return sum;
+    };
+
+    // MaxMin selection: every further landmark is the row farthest from all landmarks so far
+    std::vector<size_t> landmarks(landmarkCount);
+    if (landmarkCount == rows) {
+        for (size_t i = 0; i < rows; i++) landmarks[i] = i;
+    } else {
+        std::mt19937 engine(randomSeed);
+        landmarks[0] = std::uniform_int_distribution<size_t>(0, rows - 1)(engine);
+        std::vector<double> minDistance(rows, std::numeric_limits<double>::max());
+        for (int i = 1; i < k; i++) {
+            if (this->cancelWorker) return;
+            const size_t last = landmarks[i - 1];
+#pragma omp parallel for
+            for (int row = 0; row < rowsCount; row++) {
+                minDistance[row] = std::min(minDistance[row], squaredDistance(row, last));
+            }
+            landmarks[i] = std::max_element(minDistance.begin(), minDistance.end()) - minDistance.begin();
+        }
+    }
+
+    // classic MDS of the landmarks
+    Eigen::MatrixXd delta2(k, k);
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j <= i; j++) {
+            delta2(i, j) = delta2(j, i) = squaredDistance(landmarks[i], landmarks[j]);
+        }
+    }
+    if (this->cancelWorker) return;
+
+    // double centering without forming the centering matrix
+    const Eigen::VectorXd meanDelta2 = delta2.colwise().mean().transpose();
+    const double totalMean = meanDelta2.mean();
+    Eigen::MatrixXd B(k, k);
+    for (int j = 0; j < k; j++) {
+        for (int i = 0; i < k; i++) {
+            B(i, j) = -0.5 * (delta2(i, j) - meanDelta2(i) - meanDelta2(j) + totalMean);
         }
     }
 
-    // generate dissimilarity Matrix( squared euclidean Distance matrix)
-    Eigen::MatrixXd delta2 = euclideanDissimilarityMatrix(inDataMat).array().pow(2);
-    // compute MDS
-    Eigen::MatrixXd result = classicMds(delta2, outputDimCount);
+    // B is symmetric, eigenvalues are ascending
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigSolver(B);
+    if (this->cancelWorker) return;
+
+    // pseudo inverse of the landmark embedding, dimensions without positive variance stay at zero
+    Eigen::MatrixXd pseudoInverse = Eigen::MatrixXd::Zero(outputColumns, k);
+    for (unsigned int d = 0; d < outputColumns && d < static_cast<unsigned int>(k); d++) {
+        const double lambda = eigSolver.eigenvalues()(k - 1 - d);
+        if (lambda > 0.0) pseudoInverse.row(d) = eigSolver.eigenvectors().col(k - 1 - d).transpose() / sqrt(lambda);
+    }
+
+    std::vector<double> result(rows * outputColumns, std::numeric_limits<double>::quiet_NaN());
+    auto triangulate = [&](int row) {
+        Eigen::VectorXd offset(k);
+        for (int j = 0; j < k; j++) offset(j) = meanDelta2(j) - squaredDistance(row, landmarks[j]);
+        const Eigen::VectorXd y = 0.5 * pseudoInverse * offset;
+        for (unsigned int d = 0; d < outputColumns; d++) result[row * outputColumns + d] = y(d);
+    };
+    auto commit = [&](bool finished) {
+        std::lock_guard<std::mutex> lock(this->embeddingLock);
+        this->embedding = result;
+        this->embeddingRows = static_cast<unsigned int>(rows);
+        this->embeddingColumns = outputColumns;
+        this->embeddingChanged = true;
+        this->embeddingFinished = finished;
+    };
+
+    // the landmarks first, then all rows in chunks
+    for (int i = 0; i < k; i++) triangulate(static_cast<int>(landmarks[i]));
+    commit(landmarkCount == rows);
+    if (landmarkCount == rows) return;
+
+    const int chunkRows = 1 << 16;
+    for (int begin = 0; begin < rowsCount && !this->cancelWorker; begin += chunkRows) {
+        const int end = std::min(rowsCount, begin + chunkRows);
+#pragma omp parallel for schedule(dynamic, 256)
+        for (int row = begin; row < end; row++) triangulate(row);
+        commit(end == rowsCount);
+    }
+}
+
+void megamol::infovis::MDSProjection::publish(void) {
+    std::lock_guard<std::mutex> lock(this->embeddingLock);
+    if (!this->embeddingChanged) return;
+    this->embeddingChanged = false;
+
+    const unsigned int outputDimCount = this->embeddingColumns;
+    const size_t rowsCount = this->embeddingRows;
+
+    // rows not placed yet are NaN and do not count
+    std::vector<double> maximas(outputDimCount, std::numeric_limits<double>::lowest());
+    std::vector<double> minimas(outputDimCount, std::numeric_limits<double>::max());
+    for (size_t row = 0; row < rowsCount; row++) {
+        for (unsigned int col = 0; col < outputDimCount; col++) {
+            double value = this->embedding[row * outputDimCount + col];
+            if (maximas[col] < value) maximas[col] = value;
+            if (minimas[col] > value) minimas[col] = value;
+        }
+    }
 
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputDimCount);
 
-    for (int indexX = 0; indexX < outputDimCount; indexX++) {
+    for (unsigned int indexX = 0; indexX < outputDimCount; indexX++) {
         columnInfos[indexX]
             .SetName("MDS" + std::to_string(indexX))
             .SetType(megamol::stdplugin::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
-            .SetMinimumValue(result.col(indexX).minCoeff())
-            .SetMaximumValue(result.col(indexX).maxCoeff());
+            .SetMinimumValue(minimas[indexX])
+            .SetMaximumValue(maximas[indexX]);
     }
 
     // Result Matrix into Output
-    this->data.clear();
-    this->data.reserve(rowsCount * outputDimCount);
+    this->data.assign(this->embedding.begin(), this->embedding.begin() + rowsCount * outputDimCount);
 
-    for (size_t row = 0; row < rowsCount; row++) {
-        for (size_t col = 0; col < outputDimCount; col++) this->data.push_back(result(row, col));
+    if (this->embeddingFinished) {
+        vislib::sys::Log::DefaultLog.WriteInfo("%s: projection finished", ClassName());
     }
-
-    this->dataInHash = inCall->DataHash();
     this->datahash++;
-    reduceToNSlot.ResetDirty();
+}
 
-    return true;
+void megamol::infovis::MDSProjection::stopWorker(void) {
+    if (this->worker.joinable()) {
+        this->cancelWorker = true;
+        this->worker.join();
+    }
+    this->cancelWorker = false;
 }
 
 Eigen::MatrixXd megamol::infovis::MDSProjection::euclideanDissimilarityMatrix(Eigen::MatrixXd dataMatrix) {
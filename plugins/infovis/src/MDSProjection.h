@@ -9,6 +9,10 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace megamol {
 namespace infovis {
@@ -67,6 +71,20 @@ private:
 
     bool dataProjection(megamol::stdplugin::datatools::table::TableDataCall* inCall);
 
+    /** Takes over the latest embedding of the background job, if there is a new one */
+    void publish(void);
+
+    /** Asks the background job to stop after its current chunk of rows and waits for it */
+    void stopWorker(void);
+
+    /**
+     * The background job on a private copy of the input: landmark MDS, i.e. classic MDS of a MaxMin
+     * selection of landmarks, into which all rows are triangulated chunk by chunk. The embedding of the
+     * landmarks is published first, rows not yet triangulated are NaN.
+     */
+    void work(std::vector<double> input, size_t rows, size_t columns, unsigned int outputColumns,
+        size_t landmarkCount, int randomSeed);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -76,6 +94,12 @@ private:
     /** Parameter slot for target number of dimensions */
     ::megamol::core::param::ParamSlot reduceToNSlot;
 
+    /** Parameter slot for the number of landmarks */
+    ::megamol::core::param::ParamSlot landmarksSlot;
+
+    /** Parameter slot for the seed of the first landmark */
+    ::megamol::core::param::ParamSlot randomSeedSlot;
+
     /** ID of the current frame */
     // int frameID; //TODO: unknown
 
@@ -88,6 +112,18 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** The background job and the flag asking it to stop */
+    std::thread worker;
+    std::atomic<bool> cancelWorker;
+
+    /** The latest embedding of the background job, guarded by embeddingLock */
+    std::vector<double> embedding;
+    unsigned int embeddingRows;
+    unsigned int embeddingColumns;
+    bool embeddingChanged;
+    bool embeddingFinished;
+    std::mutex embeddingLock;
 };
 
 } // namespace infovis
@@ -7,6 +7,9 @@
 
 #include <Eigen/Dense>
 #include <Eigen/SVD>
+#include <algorithm>
+#include <limits>
+#include <random>
 #include <sstream>
 
 
@@ -22,9 +25,17 @@ PCAProjection::PCAProjection(void)
     , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
     , scaleSlot("scale", "Set to scale each column to unit variance")
     , centerSlot("center", "Set to shift the mean centroid to the origin")
+    , oversamplingSlot("oversampling",
+          "Additional random directions of the truncated SVD, which is used if the components and these are fewer "
+          "than the columns")
+    , powerIterationsSlot("powerIterations", "Power iterations of the truncated SVD, improving its accuracy")
     , datahash(0)
     , dataInHash(0)
-    , columnInfos() {
+    , columnInfos()
+    , cancelWorker(false)
+    , resultRows(0)
+    , resultColumns(0)
+    , resultChanged(false) {
 
     this->dataInSlot.SetCompatibleCall<megamol::stdplugin::datatools::table::TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataInSlot);
@@ -43,6 +54,12 @@ PCAProjection::PCAProjection(void)
 
     scaleSlot << new ::megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&scaleSlot);
+
+    oversamplingSlot << new ::megamol::core::param::IntParam(10, 0);
+    this->MakeSlotAvailable(&oversamplingSlot);
+
+    powerIterationsSlot << new ::megamol::core::param::IntParam(2, 0);
+    this->MakeSlotAvailable(&powerIterationsSlot);
 }
 
 
@@ -50,7 +67,7 @@ PCAProjection::~PCAProjection(void) { this->Release(); }
 
 bool PCAProjection::create(void) { return true; }
 
-void PCAProjection::release(void) {}
+void PCAProjection::release(void) { this->stopWorker(); }
 
 bool PCAProjection::getDataCallback(core::Call& c) {
 
@@ -68,6 +85,7 @@ bool PCAProjection::getDataCallback(core::Call& c) {
 
         bool finished = project(inCall);
         if (finished == false) return false;
+        this->publish();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -115,20 +133,22 @@ bool megamol::infovis::PCAProjection::project(megamol::stdplugin::datatools::tab
 
     // check if inData has changed and if Slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty() &&
+            !oversamplingSlot.IsDirty() && !powerIterationsSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
 
 
     auto columnCount = inCall->GetColumnsCount();
-    auto column_infos = inCall->GetColumnsInfos();
     auto rowsCount = inCall->GetRowsCount();
     auto inData = inCall->GetData();
 
     unsigned int outputDimCount = this->reduceToNSlot.Param<core::param::IntParam>()->Value();
     bool center = this->centerSlot.Param<core::param::BoolParam>()->Value();
     bool scale = this->scaleSlot.Param<core::param::BoolParam>()->Value();
+    int oversampling = this->oversamplingSlot.Param<core::param::IntParam>()->Value();
+    int powerIterations = this->powerIterationsSlot.Param<core::param::IntParam>()->Value();
 
 
     if (outputDimCount <= 0 || outputDimCount > columnCount) {
@@ -136,118 +156,139 @@ bool megamol::infovis::PCAProjection::project(megamol::stdplugin::datatools::tab
         return false;
     }
 
-    // Load data in a Matrix
-    Eigen::MatrixXd inDataMat = Eigen::MatrixXd(rowsCount, columnCount);
-    for (int row = 0; row < rowsCount; row++) {
-        for (int col = 0; col < columnCount; col++) {
-            inDataMat(row, col) = inData[row * columnCount + col];
-        }
+    // the job works on its own copy, the previous one on outdated input
+    std::vector<double> inputData(inData, inData + columnCount * rowsCount);
+    this->stopWorker();
+    {
+        std::lock_guard<std::mutex> lock(this->resultLock);
+        this->resultChanged = false;
     }
 
-    // calculate mean for each column
-    Eigen::VectorXd mean_vector(columnCount);
-    mean_vector = inDataMat.colwise().mean();
-
-
-    // prepare data
-    if (center) {
-        // substract mean columnwise
-        for (int col = 0; col < columnCount; col++) {
-            inDataMat.col(col) -= Eigen::VectorXd::Constant(rowsCount, mean_vector(col));
-        }
-    }
+    this->dataInHash = inCall->DataHash();
+    reduceToNSlot.ResetDirty();
+    scaleSlot.ResetDirty();
+    centerSlot.ResetDirty();
+    oversamplingSlot.ResetDirty();
+    powerIterationsSlot.ResetDirty();
 
+    this->worker = std::thread(&PCAProjection::work, this, std::move(inputData), rowsCount, columnCount,
+        outputDimCount, center, scale, oversampling, powerIterations);
 
-    if (scale) {
-        // scale data to unit variance by dividing by standard deviation
-        Eigen::VectorXd stdDev(columnCount);
-        for (int col = 0; col < columnCount; col++) {
-            stdDev(col) = sqrt(inDataMat.col(col).cwiseProduct(inDataMat.col(col)).sum() / (rowsCount - 1));
-            inDataMat.col(col) /= stdDev(col);
-        }
-    }
+    return true;
+}
 
+void megamol::infovis::PCAProjection::work(std::vector<double> input, size_t rows, size_t columns,
+    unsigned int outputColumns, bool center, bool scale, int oversampling, int powerIterations) {
+    const int rowsCount = static_cast<int>(rows);
+    const int columnCount = static_cast<int>(columns);
 
-    // calculate CovarianceMatrix
-    MatrixXd covarianceMatrix = inDataMat;
+    // Load data in a Matrix
+    MatrixXd inDataMat = Map<Matrix<double, Dynamic, Dynamic, RowMajor>>(input.data(), rows, columns);
+    input.clear();
+    input.shrink_to_fit();
 
-    /** if center is off: "R ggfortify" doesn't substract mean for the covariance matrix
-    //substract mean for cov Matrix
-    mean_vector = inDataMat.colwise().mean();
+    // prepare data
+#pragma omp parallel for schedule(dynamic)
     for (int col = 0; col < columnCount; col++) {
-        covarianceMatrix.col(col) -= Eigen::VectorXd::Constant(rowsCount, mean_vector(col));
-    }*/
-
-
-    covarianceMatrix = covarianceMatrix.transpose() * covarianceMatrix;
-    covarianceMatrix = covarianceMatrix / (float)(rowsCount - 1);
-
-
-    // calculate Eigenvalues and Eigenvectors
-    EigenSolver<MatrixXd> eigSolver(covarianceMatrix);
-
-    VectorXd eigVal = eigSolver.eigenvalues().real();
-    MatrixXd eigVec = eigSolver.eigenvectors().real();
-
-    // sort eigenvalues (with index): descending
-    // each eigenvalue represents the variance
-    typedef std::pair<float, int> eigenPair;
-    std::vector<eigenPair> sorted;
-    for (unsigned int i = 0; i < columnCount; ++i) {
-        sorted.push_back(std::make_pair(eigVal(i), i));
+        if (center) {
+            // substract mean columnwise
+            inDataMat.col(col).array() -= inDataMat.col(col).mean();
+        }
+        if (scale) {
+            // scale data to unit variance by dividing by standard deviation
+            double stdDev = sqrt(inDataMat.col(col).squaredNorm() / (rowsCount - 1));
+            inDataMat.col(col) /= stdDev;
+        }
     }
-    std::sort(sorted.begin(), sorted.end(), [&sorted](eigenPair& a, eigenPair& b) { return a.first > b.first; });
+    if (this->cancelWorker) return;
+
+    MatrixXd basis;
+    const int sampleCount = static_cast<int>(outputColumns) + std::max(0, oversampling);
+    if (sampleCount >= columnCount) {
+        // few columns: eigen decomposition of the (columns x columns) covariance matrix
+        MatrixXd covarianceMatrix = inDataMat.transpose() * inDataMat / (double)(rowsCount - 1);
+
+        // the covariance matrix is symmetric, eigenvalues are ascending
+        SelfAdjointEigenSolver<MatrixXd> eigSolver(covarianceMatrix);
+        basis = eigSolver.eigenvectors().rightCols(outputColumns).rowwise().reverse();
+
+    } else {
+        // randomised truncated SVD (Halko et al.): find an orthonormal basis Q of the range of the data
+        // from random directions, and decompose the small (samples x columns) matrix Q^T X.
+        std::mt19937 engine(42);
+        std::normal_distribution<double> distribution;
+        MatrixXd omega(columnCount, sampleCount);
+        for (int i = 0; i < omega.size(); i++) omega.data()[i] = distribution(engine);
+
+        auto orthonormalize = [](const MatrixXd& m) -> MatrixXd {
+            HouseholderQR<MatrixXd> qr(m);
+            return qr.householderQ() * MatrixXd::Identity(m.rows(), m.cols());
+        };
+
+        MatrixXd Q = orthonormalize(inDataMat * omega);
+        for (int i = 0; i < powerIterations; i++) {
+            if (this->cancelWorker) return;
+            Q = orthonormalize(inDataMat * orthonormalize(inDataMat.transpose() * Q));
+        }
+        if (this->cancelWorker) return;
 
-    // create Matrix out of sorted (and selected) eigenvectors
-    MatrixXd eigVecBasis = MatrixXd(columnCount, outputDimCount);
-    for (unsigned int i = 0; i < outputDimCount; ++i) {
-        eigVecBasis.col(i) = eigVec.col(sorted[i].second);
+        MatrixXd small = Q.transpose() * inDataMat;
+        JacobiSVD<MatrixXd> svd(small, ComputeThinV);
+        basis = svd.matrixV().leftCols(outputColumns);
     }
-
+    if (this->cancelWorker) return;
 
     // calculate PCA
-    MatrixXd result = inDataMat * eigVecBasis;
+    Matrix<double, Dynamic, Dynamic, RowMajor> projection = inDataMat * basis;
 
+    std::lock_guard<std::mutex> lock(this->resultLock);
+    this->result.assign(projection.data(), projection.data() + projection.size());
+    this->resultRows = static_cast<unsigned int>(rows);
+    this->resultColumns = outputColumns;
+    this->resultChanged = true;
+}
 
-    //// center
-    // mean_vector = result.colwise().mean();
-    //// substract mean adjusted Matrix (shift to mean to zero)
-    // for (int col = 0; col < result.cols(); col++) {
-    //    result.col(col) -= Eigen::VectorXd::Constant(rowsCount, mean_vector(col));
-    //}
-
+void megamol::infovis::PCAProjection::publish(void) {
+    std::lock_guard<std::mutex> lock(this->resultLock);
+    if (!this->resultChanged) return;
+    this->resultChanged = false;
 
-    std::stringstream debug;
-    debug << std::endl << result << std::endl;
+    const unsigned int outputDimCount = this->resultColumns;
+    const size_t rowsCount = this->resultRows;
 
-    vislib::sys::Log::DefaultLog.WriteInfo(debug.str().c_str());
+    std::vector<double> maximas(outputDimCount, std::numeric_limits<double>::lowest());
+    std::vector<double> minimas(outputDimCount, std::numeric_limits<double>::max());
+    for (size_t row = 0; row < rowsCount; row++) {
+        for (unsigned int col = 0; col < outputDimCount; col++) {
+            double value = this->result[row * outputDimCount + col];
+            if (maximas[col] < value) maximas[col] = value;
+            if (minimas[col] > value) minimas[col] = value;
+        }
+    }
 
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputDimCount);
 
-    for (int indexX = 0; indexX < outputDimCount; indexX++) {
+    for (unsigned int indexX = 0; indexX < outputDimCount; indexX++) {
         columnInfos[indexX]
             .SetName("PC" + std::to_string(indexX))
             .SetType(megamol::stdplugin::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
-            .SetMinimumValue(result.col(indexX).minCoeff())
-            .SetMaximumValue(result.col(indexX).maxCoeff());
+            .SetMinimumValue(minimas[indexX])
+            .SetMaximumValue(maximas[indexX]);
     }
 
     // Result Matrix into Output
-    this->data.clear();
-    this->data.reserve(rowsCount * outputDimCount);
+    this->data.assign(this->result.begin(), this->result.begin() + rowsCount * outputDimCount);
 
-    for (size_t row = 0; row < rowsCount; row++) {
-        for (size_t col = 0; col < outputDimCount; col++) this->data.push_back(result(row, col));
-    }
-
-
-    this->dataInHash = inCall->DataHash();
+    vislib::sys::Log::DefaultLog.WriteInfo("%s: projection finished", ClassName());
     this->datahash++;
-    reduceToNSlot.ResetDirty();
-    scaleSlot.ResetDirty();
-    centerSlot.ResetDirty();
+}
 
-    return true;
+void megamol::infovis::PCAProjection::stopWorker(void) {
+    if (this->worker.joinable()) {
+        this->cancelWorker = true;
+        this->worker.join();
+    }
+    this->cancelWorker = false;
 }
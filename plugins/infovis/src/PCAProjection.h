@@ -7,6 +7,10 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace megamol {
 namespace infovis {
@@ -47,6 +51,19 @@ private:
 
     bool project(megamol::stdplugin::datatools::table::TableDataCall* inCall);
 
+    /** Takes over the result of the background job, if there is a new one */
+    void publish(void);
+
+    /** Asks the background job to stop after its current step and waits for it */
+    void stopWorker(void);
+
+    /**
+     * The background job on a private copy of the input. Uses the exact eigen decomposition of the covariance
+     * matrix if there are few columns, and a randomised truncated SVD otherwise.
+     */
+    void work(std::vector<double> input, size_t rows, size_t columns, unsigned int outputColumns, bool center,
+        bool scale, int oversampling, int powerIterations);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -57,6 +74,8 @@ private:
     ::megamol::core::param::ParamSlot reduceToNSlot;
     ::megamol::core::param::ParamSlot scaleSlot;
     ::megamol::core::param::ParamSlot centerSlot;
+    ::megamol::core::param::ParamSlot oversamplingSlot;
+    ::megamol::core::param::ParamSlot powerIterationsSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
@@ -70,6 +89,17 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** The background job and the flag asking it to stop */
+    std::thread worker;
+    std::atomic<bool> cancelWorker;
+
+    /** The latest result of the background job, guarded by resultLock */
+    std::vector<double> result;
+    unsigned int resultRows;
+    unsigned int resultColumns;
+    bool resultChanged;
+    std::mutex resultLock;
 };
 
 } // namespace infovis
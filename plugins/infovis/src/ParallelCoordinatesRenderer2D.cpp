@@ -8,6 +8,7 @@
 #include "mmcore/param/ButtonParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
 #include "mmcore/param/StringParam.h"
 #include "mmcore/utility/ColourParser.h"
 #include "mmcore/view/CallGetTransferFunction.h"
@@ -59,6 +60,8 @@ ParallelCoordinatesRenderer2D::ParallelCoordinatesRenderer2D(void)
     , glLineSmoothSlot("glEnableLineSmooth", "Toggle GLLINESMOOTH")
     , glLineWidthSlot("glLineWidth", "Value for glLineWidth")
     , sqrtDensitySlot("sqrtDensity", "map root of density to transfer function (instead of linear mapping)")
+    , densityBinsSlot("densityBins", "number of bins per axis of the density histograms")
+    , densityMappingSlot("densityMapping", "mapping of the density histograms to the transfer function")
     //, resetFlagsSlot("resetFlags", "Reset item flags to initial state")
     , resetFiltersSlot("resetFilters", "Reset dimension filters to initial state")
     , numTicks(5)
@@ -71,6 +74,8 @@ ParallelCoordinatesRenderer2D::ParallelCoordinatesRenderer2D(void)
     , axisIndirectionBuffer(0)
     , filtersBuffer(0)
     , minmaxBuffer(0)
+    , counterBuffer(0)
+    , densityBuffer(0)
     , interactionState(InteractionState::NONE)
     , pickedAxis(-1)
     , pickedIndicatorAxis(-1)
@@ -81,6 +86,7 @@ ParallelCoordinatesRenderer2D::ParallelCoordinatesRenderer2D(void)
     , strokeEndY(0)
     , needSelectionUpdate(false)
     , needFlagsUpdate(false)
+    , needDensityUpdate(true)
     , lastTimeStep(0)
     , font("Evolventa-SansSerif", core::utility::SDFFont::RenderType::RENDERTYPE_FILL) {
 
@@ -97,6 +103,7 @@ ParallelCoordinatesRenderer2D::ParallelCoordinatesRenderer2D(void)
     drawModes->SetTypePair(DRAW_DISCRETE, "Discrete");
     drawModes->SetTypePair(DRAW_CONTINUOUS, "Continuous");
     drawModes->SetTypePair(DRAW_HISTOGRAM, "Histogram");
+    drawModes->SetTypePair(DRAW_DENSITY, "Density");
     drawModeSlot.SetParameter(drawModes);
     this->MakeSlotAvailable(&drawModeSlot);
 
@@ -168,6 +175,16 @@ ParallelCoordinatesRenderer2D::ParallelCoordinatesRenderer2D(void)
     sqrtDensitySlot << new core::param::BoolParam(true);
     this->MakeSlotAvailable(&sqrtDensitySlot);
 
+    densityBinsSlot << new core::param::IntParam(128, 8, 512);
+    this->MakeSlotAvailable(&densityBinsSlot);
+
+    auto densityMappings = new core::param::EnumParam(DENSITY_LOG);
+    densityMappings->SetTypePair(DENSITY_LINEAR, "Linear");
+    densityMappings->SetTypePair(DENSITY_SQRT, "Sqrt");
+    densityMappings->SetTypePair(DENSITY_LOG, "Log");
+    densityMappingSlot.SetParameter(densityMappings);
+    this->MakeSlotAvailable(&densityMappingSlot);
+
     // resetFlagsSlot << new core::param::ButtonParam();
     // resetFlagsSlot.SetUpdateCallback(this, &ParallelCoordinatesRenderer2D::resetFlagsSlotCallback);
     // this->MakeSlotAvailable(&resetFlagsSlot);
@@ -207,13 +224,13 @@ bool ParallelCoordinatesRenderer2D::enableProgramAndBind(vislib::graphics::gl::G
 
 bool ParallelCoordinatesRenderer2D::create(void) {
     glGenBuffers(1, &dataBuffer);
-    glGenBuffers(1, &flagsBuffer);
     glGenBuffers(1, &minimumsBuffer);
     glGenBuffers(1, &maximumsBuffer);
     glGenBuffers(1, &axisIndirectionBuffer);
     glGenBuffers(1, &filtersBuffer);
     glGenBuffers(1, &minmaxBuffer);
     glGenBuffers(1, &counterBuffer);
+    glGenBuffers(1, &densityBuffer);
 
 #ifndef REMOVE_TEXT
     if (!font.Initialise(this->GetCoreInstance())) return false;
@@ -238,6 +255,9 @@ bool ParallelCoordinatesRenderer2D::create(void) {
 
     if (!makeProgram("::pc_item_draw::histogram", this->drawItemsHistogramProgram)) return false;
 
+    if (!makeProgram("::pc_item_density", this->densityProgram)) return false;
+    if (!makeProgram("::pc_item_density::draw", this->drawItemsDensityProgram)) return false;
+
     if (!makeProgram("::pc_item_filter", this->filterProgram)) return false;
     if (!makeProgram("::pc_item_pick", this->pickProgram)) return false;
     if (!makeProgram("::pc_item_stroke", this->strokeProgram)) return false;
@@ -246,6 +266,7 @@ bool ParallelCoordinatesRenderer2D::create(void) {
     glGetProgramiv(this->minMaxProgram, GL_COMPUTE_WORK_GROUP_SIZE, counterWorkgroupSize);
     glGetProgramiv(this->pickProgram, GL_COMPUTE_WORK_GROUP_SIZE, pickWorkgroupSize);
     glGetProgramiv(this->strokeProgram, GL_COMPUTE_WORK_GROUP_SIZE, strokeWorkgroupSize);
+    glGetProgramiv(this->densityProgram, GL_COMPUTE_WORK_GROUP_SIZE, densityWorkgroupSize);
 
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxWorkgroupCount[0]);
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 1, &maxWorkgroupCount[1]);
@@ -256,13 +277,13 @@ bool ParallelCoordinatesRenderer2D::create(void) {
 
 void ParallelCoordinatesRenderer2D::release(void) {
     glDeleteBuffers(1, &dataBuffer);
-    glDeleteBuffers(1, &flagsBuffer);
     glDeleteBuffers(1, &minimumsBuffer);
     glDeleteBuffers(1, &maximumsBuffer);
     glDeleteBuffers(1, &axisIndirectionBuffer);
     glDeleteBuffers(1, &filtersBuffer);
     glDeleteBuffers(1, &minmaxBuffer);
     glDeleteBuffers(1, &counterBuffer);
+    glDeleteBuffers(1, &densityBuffer);
 
     this->drawAxesProgram.Release();
 }
@@ -414,24 +435,19 @@ void ParallelCoordinatesRenderer2D::assertData(core::view::CallRender2D& call) {
             GL_SHADER_STORAGE_BUFFER, 2 * sizeof(GLfloat), fragmentMinMax.data(), GL_DYNAMIC_READ); // TODO: huh.
         this->currentHash = hash;
         this->lastTimeStep = static_cast<unsigned int>(call.Time());
+        this->needDensityUpdate = true;
     }
 
-    if (version != this->currentFlagsVersion || version == 0) {
-        flagsc->validateFlagsCount(itemCount);
-        auto flagsvector = flagsc->GetFlags();
-
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, flagsBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, this->itemCount * sizeof(core::FlagStorage::FlagItemType),
-            flagsvector.get()->data(), GL_STATIC_DRAW);
-
-        // give the data back
-        flagsc->SetFlags(flagsvector);
+    // the flag storage owns the buffer and updates the changed flags, shared with the other views of the flags
+    flagsc->validateFlagsCount(itemCount);
+    this->flagsBuffer = flagsc->GetFlagsBuffer();
+    if (flagsc->GetVersion() != this->currentFlagsVersion || version == 0) {
         this->currentFlagsVersion = flagsc->GetVersion();
+        this->needDensityUpdate = true;
     }
     (*flagsc)(core::FlagCall::CallUnmapFlags);
 
     makeDebugLabel(GL_BUFFER, DEBUG_NAME(dataBuffer));
-    makeDebugLabel(GL_BUFFER, DEBUG_NAME(flagsBuffer));
     makeDebugLabel(GL_BUFFER, DEBUG_NAME(minimumsBuffer));
     makeDebugLabel(GL_BUFFER, DEBUG_NAME(maximumsBuffer));
     makeDebugLabel(GL_BUFFER, DEBUG_NAME(axisIndirectionBuffer));
@@ -848,6 +864,69 @@ void ParallelCoordinatesRenderer2D::drawItemsHistogram(void) {
     debugPop();
 }
 
+void ParallelCoordinatesRenderer2D::doDensityBinning(void) {
+    debugPush(8, "doDensityBinning");
+    const GLuint bins = static_cast<GLuint>(this->densityBinsSlot.Param<core::param::IntParam>()->Value());
+    const GLsizeiptr bytes = sizeof(GLuint) * (1 + static_cast<GLsizeiptr>(this->columnCount - 1) * bins * bins);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, densityBuffer);
+    GLint64 size = 0;
+    glGetBufferParameteri64v(GL_SHADER_STORAGE_BUFFER, GL_BUFFER_SIZE, &size);
+    if (size != bytes) {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+        makeDebugLabel(GL_BUFFER, DEBUG_NAME(densityBuffer));
+    }
+    const GLuint zero = 0;
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, densityBuffer);
+
+    this->enableProgramAndBind(densityProgram);
+    glUniform1ui(densityProgram.ParameterLocation("densityBins"), bins);
+    glUniform1ui(densityProgram.ParameterLocation("fragmentTestMask"),
+        core::FlagStorage::ENABLED | core::FlagStorage::FILTERED);
+    glUniform1ui(densityProgram.ParameterLocation("fragmentPassMask"), core::FlagStorage::ENABLED);
+
+    GLuint groupCounts[3];
+    computeDispatchSizes(itemCount, densityWorkgroupSize, maxWorkgroupCount, groupCounts);
+
+    densityProgram.Dispatch(groupCounts[0], groupCounts[1], groupCounts[2]);
+    ::glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    densityProgram.Disable();
+    debugPop();
+}
+
+void ParallelCoordinatesRenderer2D::drawItemsDensity(void) {
+    auto tf = this->getTFSlot.CallAs<megamol::core::view::CallGetTransferFunction>();
+    if (tf == nullptr || this->columnCount < 2) return;
+    debugPush(9, "drawItemsDensity");
+
+    // only re-bin if data, flags, filters or the axis order changed since the last frame
+    if (this->needDensityUpdate) {
+        this->needDensityUpdate = false;
+        this->doDensityBinning();
+    }
+
+    if (this->drawOtherItemsSlot.Param<core::param::BoolParam>()->Value()) {
+        this->enableProgramAndBind(drawItemsDensityProgram);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, densityBuffer);
+        tf->BindConvenience(drawItemsDensityProgram, GL_TEXTURE5, 5);
+        glUniform1ui(drawItemsDensityProgram.ParameterLocation("densityBins"),
+            static_cast<GLuint>(this->densityBinsSlot.Param<core::param::IntParam>()->Value()));
+        glUniform1i(drawItemsDensityProgram.ParameterLocation("densityMapping"),
+            this->densityMappingSlot.Param<core::param::EnumParam>()->Value());
+        glDrawArrays(GL_TRIANGLES, 0, 6 * (this->columnCount - 1));
+        drawItemsDensityProgram.Disable();
+    }
+
+    // the selection stays discrete on top of the aggregated context
+    if (this->drawSelectedItemsSlot.Param<core::param::BoolParam>()->Value()) {
+        this->drawItemsDiscrete(core::FlagStorage::ENABLED | core::FlagStorage::SELECTED | core::FlagStorage::FILTERED,
+            core::FlagStorage::ENABLED | core::FlagStorage::SELECTED, this->selectedItemsColor, 0.0f);
+    }
+    debugPop();
+}
+
 void ParallelCoordinatesRenderer2D::drawParcos(void) {
 
     // TODO only when filters changed!
@@ -866,6 +945,9 @@ void ParallelCoordinatesRenderer2D::drawParcos(void) {
     case DRAW_DISCRETE:
         this->drawDiscrete(this->otherItemsColor, this->selectedItemsColor, 1.0f);
         break;
+    case DRAW_DENSITY:
+        this->drawItemsDensity();
+        break;
     case DRAW_CONTINUOUS:
     case DRAW_HISTOGRAM:
         bool ok = true;
@@ -935,6 +1017,12 @@ bool ParallelCoordinatesRenderer2D::Render(core::view::CallRender2D& call) {
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, filtersBuffer);
     glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, this->columnCount * sizeof(DimensionFilter), this->filters.data());
 
+    // brushing, filtering and re-ordering axes change the histograms
+    if (this->needSelectionUpdate || this->needFlagsUpdate || this->densityBinsSlot.IsDirty()) {
+        this->densityBinsSlot.ResetDirty();
+        this->needDensityUpdate = true;
+    }
+
     // Do stroking/picking
     if (this->needSelectionUpdate) {
         this->needSelectionUpdate = false;
@@ -977,6 +1065,9 @@ bool ParallelCoordinatesRenderer2D::Render(core::view::CallRender2D& call) {
         if (flagsc != nullptr) {
             (*flagsc)(core::FlagCall::CallMapFlags);
             auto version = flagsc->GetVersion();
+            // the shaders wrote the shared buffer, so it must not be updated from the old flags before downloading
+            flagsc->MarkFlagsBufferCurrent();
+            this->flagsBuffer = flagsc->GetFlagsBuffer();
             auto flags = flagsc->GetFlags();
             auto f = flags.get();
             glBindBuffer(GL_SHADER_STORAGE_BUFFER, flagsBuffer);
@@ -999,6 +1090,7 @@ bool ParallelCoordinatesRenderer2D::Render(core::view::CallRender2D& call) {
 #endif
             this->currentFlagsVersion = version + 1;
             flagsc->SetFlags(flags, this->currentFlagsVersion);
+            flagsc->MarkFlagsBufferCurrent();
             (*flagsc)(core::FlagCall::CallUnmapFlags);
         }
     }
@@ -100,7 +100,9 @@ protected:
     bool resetFiltersSlotCallback(core::param::ParamSlot& caller);
 
 private:
-    enum DrawMode { DRAW_DISCRETE = 0, DRAW_CONTINUOUS, DRAW_HISTOGRAM };
+    enum DrawMode { DRAW_DISCRETE = 0, DRAW_CONTINUOUS, DRAW_HISTOGRAM, DRAW_DENSITY };
+
+    enum DensityMapping { DENSITY_LINEAR = 0, DENSITY_SQRT, DENSITY_LOG };
 
     enum SelectionMode { SELECT_PICK = 0, SELECT_STROKE };
 
@@ -137,6 +139,10 @@ private:
 
     void drawItemsHistogram();
 
+    void doDensityBinning();
+
+    void drawItemsDensity();
+
     void doPicking(float x, float y, float pickRadius);
 
     void doStroking(float x0, float y0, float x1, float y1);
@@ -202,6 +208,8 @@ private:
     core::param::ParamSlot glLineSmoothSlot;
     core::param::ParamSlot glLineWidthSlot;
     core::param::ParamSlot sqrtDensitySlot;
+    core::param::ParamSlot densityBinsSlot;
+    core::param::ParamSlot densityMappingSlot;
 
     // core::param::ParamSlot resetFlagsSlot;
     core::param::ParamSlot resetFiltersSlot;
@@ -234,15 +242,18 @@ private:
     vislib::graphics::gl::GLSLShader drawItemContinuousProgram;
     vislib::graphics::gl::GLSLShader drawItemsHistogramProgram;
     vislib::graphics::gl::GLSLShader traceItemsDiscreteProgram;
+    vislib::graphics::gl::GLSLShader drawItemsDensityProgram;
 
     vislib::graphics::gl::GLSLComputeShader filterProgram;
     vislib::graphics::gl::GLSLComputeShader minMaxProgram;
+    vislib::graphics::gl::GLSLComputeShader densityProgram;
 
     vislib::graphics::gl::GLSLComputeShader pickProgram;
     vislib::graphics::gl::GLSLComputeShader strokeProgram;
 
     GLuint dataBuffer, flagsBuffer, minimumsBuffer, maximumsBuffer, axisIndirectionBuffer, filtersBuffer, minmaxBuffer;
     GLuint counterBuffer;
+    GLuint densityBuffer;
 
     std::vector<GLuint> axisIndirection;
     std::vector<GLfloat> minimums;
@@ -264,6 +275,7 @@ private:
     float strokeEndY;
     bool needSelectionUpdate;
     bool needFlagsUpdate;
+    bool needDensityUpdate;
 
     GLint maxAxes;
     GLint isoLinesPerInvocation;
@@ -272,6 +284,7 @@ private:
     GLint counterWorkgroupSize[3];
     GLint pickWorkgroupSize[3];
     GLint strokeWorkgroupSize[3];
+    GLint densityWorkgroupSize[3];
     GLint maxWorkgroupCount[3];
 
     megamol::core::utility::SDFFont font;
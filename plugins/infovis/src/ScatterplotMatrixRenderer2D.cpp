@@ -24,6 +24,10 @@ using vislib::sys::Log;
 const GLuint PlotSSBOBindingPoint = 2;
 const GLuint ValueSSBOBindingPoint = 3;
 const GLuint FlagsBindingPoint = 4;
+const GLuint HistogramJobBindingPoint = 5;
+const GLuint HistogramBindingPoint = 6;
+const GLuint HistogramMaxBindingPoint = 7;
+const GLuint HistogramPassBindingPoint = 8;
 
 vislib::math::Matrix<GLfloat, 4, vislib::math::COLUMN_MAJOR> getModelViewProjection() {
     // this is the apex of suck and must die
@@ -102,6 +106,9 @@ ScatterplotMatrixRenderer2D::ScatterplotMatrixRenderer2D()
     , cellNameSizeParam("cellNameSize", "Sets the fontsize for cell names, i.e., column names")
     , alphaScalingParam("alphaScaling", "Scaling factor for overall alpha")
     , alphaAttenuateSubpixelParam("alphaAttenuateSubpixel", "Attenuate alpha of points that have subpixel size")
+    , histogramBinsParam("histogramBins", "Number of bins per axis of each cell (histogram mode)")
+    , histogramRowsPerFrameParam(
+          "histogramRowsPerFrame", "Number of rows binned per cell and frame while refining (histogram mode)")
     , mouse({0, 0, BrushState::NOP})
     , plotSSBO("Plots")
     , valueSSBO("Values")
@@ -111,6 +118,15 @@ ScatterplotMatrixRenderer2D::ScatterplotMatrixRenderer2D()
     , trianglesValid(false)
     , screenFBO(nullptr)
     , screenValid(false)
+    , histogramValueBuffer(0)
+    , histogramBuffer(0)
+    , histogramMaxBuffer(0)
+    , histogramJobBuffer(0)
+    , histogramPassBuffer(0)
+    , histogramPassCount(1)
+    , histogramFlagsVersion(0)
+    , histogramValuesValid(false)
+    , histogramsValid(false)
     , axisFont("Evolventa-SansSerif", core::utility::SDFFont::RenderType::RENDERTYPE_FILL)
     , textFont("Evolventa-SansSerif", core::utility::SDFFont::RenderType::RENDERTYPE_FILL)
     , textValid(false)
@@ -149,6 +165,7 @@ ScatterplotMatrixRenderer2D::ScatterplotMatrixRenderer2D()
     geometryTypes->SetTypePair(GEOMETRY_TYPE_LINE, "Line");
     geometryTypes->SetTypePair(GEOMETRY_TYPE_TEXT, "Text");
     geometryTypes->SetTypePair(GEOMETRY_TYPE_TRIANGULATION, "Delaunay Triangulation");
+    geometryTypes->SetTypePair(GEOMETRY_TYPE_HISTOGRAM, "Binned Histogram");
     this->geometryTypeParam << geometryTypes;
     this->MakeSlotAvailable(&this->geometryTypeParam);
 
@@ -201,6 +218,12 @@ ScatterplotMatrixRenderer2D::ScatterplotMatrixRenderer2D()
     this->alphaAttenuateSubpixelParam << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->alphaAttenuateSubpixelParam);
 
+    this->histogramBinsParam << new core::param::IntParam(128, 8, 1024);
+    this->MakeSlotAvailable(&this->histogramBinsParam);
+
+    this->histogramRowsPerFrameParam << new core::param::IntParam(1 << 18, 1024);
+    this->MakeSlotAvailable(&this->histogramRowsPerFrameParam);
+
     // Create list of data-sensitive parameters.
     dataParams.push_back(&this->valueSelectorParam);
     dataParams.push_back(&this->labelSelectorParam);
@@ -208,6 +231,7 @@ ScatterplotMatrixRenderer2D::ScatterplotMatrixRenderer2D()
     dataParams.push_back(&this->triangulationSmoothnessParam);
     dataParams.push_back(&this->cellSizeParam);
     dataParams.push_back(&this->cellMarginParam);
+    dataParams.push_back(&this->histogramBinsParam);
 
     // Create list of screen-sensitive parameters.
     screenParams.push_back(&this->valueMappingParam);
@@ -235,11 +259,17 @@ bool ScatterplotMatrixRenderer2D::create() {
     if (!makeProgram("::splom::line", this->lineShader)) return false;
     if (!makeProgram("::splom::triangle", this->triangleShader)) return false;
     if (!makeProgram("::splom::screen", this->screenShader)) return false;
-
-    glGenBuffers(1, &flagsBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, flagsBuffer);
-    makeDebugLabel(GL_BUFFER, DEBUG_NAME(flagsBuffer));
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (!makeProgram("::splom::histogramBin", this->histogramBinShader)) return false;
+    if (!makeProgram("::splom::histogram", this->histogramShader)) return false;
+
+    glGenBuffers(1, &histogramValueBuffer);
+    glGenBuffers(1, &histogramBuffer);
+    glGenBuffers(1, &histogramMaxBuffer);
+    glGenBuffers(1, &histogramJobBuffer);
+    glGenBuffers(1, &histogramPassBuffer);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxWorkgroupCount[0]);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 1, &maxWorkgroupCount[1]);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 2, &maxWorkgroupCount[2]);
 
     if (!this->axisFont.Initialise(this->GetCoreInstance())) return false;
     if (!this->textFont.Initialise(this->GetCoreInstance())) return false;
@@ -249,7 +279,13 @@ bool ScatterplotMatrixRenderer2D::create() {
     return true;
 }
 
-void ScatterplotMatrixRenderer2D::release() { glDeleteBuffers(1, &flagsBuffer); }
+void ScatterplotMatrixRenderer2D::release() {
+    glDeleteBuffers(1, &histogramValueBuffer);
+    glDeleteBuffers(1, &histogramBuffer);
+    glDeleteBuffers(1, &histogramMaxBuffer);
+    glDeleteBuffers(1, &histogramJobBuffer);
+    glDeleteBuffers(1, &histogramPassBuffer);
+}
 
 bool ScatterplotMatrixRenderer2D::OnMouseButton(
     core::view::MouseButton button, core::view::MouseButtonAction action, core::view::Modifiers mods) {
@@ -314,9 +350,15 @@ bool ScatterplotMatrixRenderer2D::Render(core::view::CallRender2D& call) {
         case GEOMETRY_TYPE_TEXT:
             this->drawText();
             break;
+        case GEOMETRY_TYPE_HISTOGRAM:
+            this->drawHistograms();
+            break;
         }
 
-        this->drawScreen();
+        // Histograms are mapped directly, everything else goes through the screen texture.
+        if (geometryType != GEOMETRY_TYPE_HISTOGRAM) {
+            this->drawScreen();
+        }
 
     } catch (...) {
         return false;
@@ -412,6 +454,8 @@ bool ScatterplotMatrixRenderer2D::validate(core::view::CallRender2D& call, bool
 
     this->trianglesValid = false;
     this->textValid = false;
+    this->histogramValuesValid = false;
+    this->histogramsValid = false;
     this->index.reset();
     this->updateColumns();
 
@@ -651,23 +695,14 @@ void ScatterplotMatrixRenderer2D::bindMappingUniforms(vislib::graphics::gl::GLSL
 }
 
 void ScatterplotMatrixRenderer2D::bindFlagsAttribute() {
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->flagsBuffer);
-
-    if (this->flagsBufferVersion != this->flagStorage->GetVersion() || this->flagsBufferVersion == 0) {
-        (*this->flagStorage)(core::FlagCall::CallMapFlags);
-        this->flagStorage->validateFlagsCount(this->floatTable->GetRowsCount());
-        auto flags = this->flagStorage->GetFlags();
-
-        // Upload flags.
-        glBufferData(GL_SHADER_STORAGE_BUFFER, flags->size() * sizeof(core::FlagStorage::FlagItemType), flags->data(),
-            GL_STATIC_DRAW);
-        this->flagsBufferVersion = this->flagStorage->GetVersion();
-
-        this->flagStorage->SetFlags(flags);
-        (*this->flagStorage)(core::FlagCall::CallUnmapFlags);
-    }
+    // The flag storage keeps its buffer up to date, which is shared with the other views of the flags.
+    (*this->flagStorage)(core::FlagCall::CallMapFlags);
+    this->flagStorage->validateFlagsCount(this->floatTable->GetRowsCount());
+    const GLuint flagsBuffer = this->flagStorage->GetFlagsBuffer();
+    this->flagsBufferVersion = this->flagStorage->GetVersion();
+    (*this->flagStorage)(core::FlagCall::CallUnmapFlags);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FlagsBindingPoint, this->flagsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FlagsBindingPoint, flagsBuffer);
 }
 
 void ScatterplotMatrixRenderer2D::drawPoints() {
@@ -983,6 +1018,126 @@ void ScatterplotMatrixRenderer2D::drawText() {
     debugPop();
 }
 
+void ScatterplotMatrixRenderer2D::validateHistograms() {
+    const GLuint rowCount = static_cast<GLuint>(this->floatTable->GetRowsCount());
+    const GLuint columnCount = static_cast<GLuint>(this->floatTable->GetColumnsCount());
+    const GLuint bins = this->histogramBinsParam.Param<core::param::IntParam>()->Value();
+
+    // The table is uploaded once and shared by all cells.
+    if (!this->histogramValuesValid) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->histogramValueBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(rowCount) * columnCount * sizeof(float),
+            this->floatTable->GetData(), GL_STATIC_DRAW);
+        makeDebugLabel(GL_BUFFER, DEBUG_NAME(histogramValueBuffer));
+        this->histogramValuesValid = true;
+    }
+
+    // Filtering changes the histograms, so refinement starts over.
+    if (this->histogramsValid && this->histogramFlagsVersion == this->flagStorage->GetVersion()) {
+        return;
+    }
+
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->histogramBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(this->plots.size()) * bins * bins * sizeof(GLuint),
+        nullptr, GL_DYNAMIC_COPY);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    makeDebugLabel(GL_BUFFER, DEBUG_NAME(histogramBuffer));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->histogramMaxBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, this->plots.size() * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    makeDebugLabel(GL_BUFFER, DEBUG_NAME(histogramMaxBuffer));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    const GLuint rowsPerPass = this->histogramRowsPerFrameParam.Param<core::param::IntParam>()->Value();
+    this->histogramPassCount = std::max<GLuint>(1, (rowCount + rowsPerPass - 1) / rowsPerPass);
+    this->histogramPasses.assign(this->plots.size(), 0);
+    this->histogramFlagsVersion = this->flagStorage->GetVersion();
+    this->histogramsValid = true;
+}
+
+void ScatterplotMatrixRenderer2D::drawHistograms() {
+    debugPush(15, "drawHistograms");
+
+    this->bindFlagsAttribute();
+    this->validateHistograms();
+
+    const GLuint rowCount = static_cast<GLuint>(this->floatTable->GetRowsCount());
+    const GLuint bins = this->histogramBinsParam.Param<core::param::IntParam>()->Value();
+    const auto mvp = getModelViewProjection();
+
+    // Refine the cells inside the viewport by one more pass each.
+    std::vector<HistogramJob> jobs;
+    for (GLuint plotIdx = 0; plotIdx < this->plots.size(); ++plotIdx) {
+        if (this->histogramPasses[plotIdx] >= this->histogramPassCount) continue;
+
+        const PlotInfo& plot = this->plots[plotIdx];
+        const auto bl = mvp * vislib::math::Vector<float, 4>(plot.offsetX, plot.offsetY, 0.0f, 1.0f);
+        const auto tr =
+            mvp * vislib::math::Vector<float, 4>(plot.offsetX + plot.sizeX, plot.offsetY + plot.sizeY, 0.0f, 1.0f);
+        if (std::max(bl.X(), tr.X()) < -1.0f || std::min(bl.X(), tr.X()) > 1.0f ||
+            std::max(bl.Y(), tr.Y()) < -1.0f || std::min(bl.Y(), tr.Y()) > 1.0f) {
+            continue;
+        }
+
+        jobs.push_back({plotIdx, this->histogramPasses[plotIdx]++});
+        if (jobs.size() >= static_cast<size_t>(this->maxWorkgroupCount[1])) break;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PlotSSBOBindingPoint, this->plotSSBO.GetHandle());
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, PlotSSBOBindingPoint, this->plotSSBO.GetHandle(), this->plotDstOffset,
+        this->plotDstLength);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HistogramBindingPoint, this->histogramBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HistogramMaxBindingPoint, this->histogramMaxBuffer);
+
+    if (!jobs.empty()) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->histogramJobBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, jobs.size() * sizeof(HistogramJob), jobs.data(), GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HistogramJobBindingPoint, this->histogramJobBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ValueSSBOBindingPoint, this->histogramValueBuffer);
+
+        this->histogramBinShader.Enable();
+        glUniform1ui(this->histogramBinShader.ParameterLocation("rowCount"), rowCount);
+        glUniform1ui(this->histogramBinShader.ParameterLocation("rowStride"),
+            static_cast<GLuint>(this->floatTable->GetColumnsCount()));
+        glUniform1ui(this->histogramBinShader.ParameterLocation("bins"), bins);
+        glUniform1ui(this->histogramBinShader.ParameterLocation("passCount"), this->histogramPassCount);
+
+        const GLuint rowsPerPass = (rowCount + this->histogramPassCount - 1) / this->histogramPassCount;
+        const GLuint groups = std::clamp<GLuint>((rowsPerPass + 255) / 256, 1, this->maxWorkgroupCount[0]);
+        this->histogramBinShader.Dispatch(groups, static_cast<GLuint>(jobs.size()), 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        this->histogramBinShader.Disable();
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->histogramPassBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, this->histogramPasses.size() * sizeof(GLuint),
+        this->histogramPasses.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HistogramPassBindingPoint, this->histogramPassBuffer);
+
+    this->histogramShader.Enable();
+    this->transferFunction->BindConvenience(this->histogramShader, GL_TEXTURE0, 0);
+    glUniformMatrix4fv(
+        this->histogramShader.ParameterLocation("modelViewProjection"), 1, GL_FALSE, mvp.PeekComponents());
+    glUniform1ui(this->histogramShader.ParameterLocation("bins"), bins);
+    glUniform1ui(this->histogramShader.ParameterLocation("passCount"), this->histogramPassCount);
+    glUniform1f(this->histogramShader.ParameterLocation("alphaScaling"),
+        this->alphaScalingParam.Param<core::param::FloatParam>()->Value());
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, this->plots.size());
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    this->histogramShader.Disable();
+
+    debugPop();
+}
+
 void ScatterplotMatrixRenderer2D::bindAndClearScreen() {
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screenRestoreFBO);
 
@@ -1099,6 +1254,7 @@ void ScatterplotMatrixRenderer2D::updateSelection() {
             } else if (this->mouse.selector == BrushState::REMOVE) {
                 (*flags)[row] &= ~core::FlagStorage::SELECTED;
             }
+            this->flagStorage->MarkDirty(row, row + 1);
         }
     }
     this->flagStorage->SetFlags(flags, version + 1);
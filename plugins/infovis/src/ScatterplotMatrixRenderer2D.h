@@ -78,7 +78,13 @@ private:
         VALUE_MAPPING_KERNEL_DENSITY,
         VALUE_MAPPING_WEIGHTED_KERNEL_DENSITY
     };
-    enum GeometryType { GEOMETRY_TYPE_POINT = 0, GEOMETRY_TYPE_LINE, GEOMETRY_TYPE_TEXT, GEOMETRY_TYPE_TRIANGULATION };
+    enum GeometryType {
+        GEOMETRY_TYPE_POINT = 0,
+        GEOMETRY_TYPE_LINE,
+        GEOMETRY_TYPE_TEXT,
+        GEOMETRY_TYPE_TRIANGULATION,
+        GEOMETRY_TYPE_HISTOGRAM
+    };
     enum KernelType { KERNEL_TYPE_BOX = 0, KERNEL_TYPE_GAUSSIAN };
     enum AxisMode { AXIS_MODE_NONE = 0, AXIS_MODE_MINIMALISTIC, AXIS_MODE_SCIENTIFIC };
 
@@ -115,6 +121,11 @@ private:
     };
 
 
+    struct HistogramJob {
+        GLuint plot;
+        GLuint pass;
+    };
+
     struct SPLOMPoints {
         SPLOMPoints(const std::vector<PlotInfo>& plots, const stdplugin::datatools::table::TableDataCall* floatTable)
             : plots(plots)
@@ -203,6 +214,10 @@ private:
 
     void drawText();
 
+    void validateHistograms();
+
+    void drawHistograms();
+
     void unbindScreen();
 
     void bindAndClearScreen();
@@ -257,6 +272,10 @@ private:
 
     core::param::ParamSlot alphaAttenuateSubpixelParam;
 
+    core::param::ParamSlot histogramBinsParam;
+
+    core::param::ParamSlot histogramRowsPerFrameParam;
+
     size_t dataHash;
     unsigned int dataTime;
 
@@ -286,13 +305,16 @@ private:
 
     vislib::graphics::gl::GLSLShader screenShader;
 
+    vislib::graphics::gl::GLSLComputeShader histogramBinShader;
+
+    vislib::graphics::gl::GLSLShader histogramShader;
+
     core::utility::SSBOStreamer plotSSBO;
     GLsizeiptr plotDstOffset;
     GLsizeiptr plotDstLength;
 
     core::utility::SSBOStreamer valueSSBO;
 
-    GLuint flagsBuffer;
     core::FlagStorage::FlagVersionType flagsBufferVersion;
 
     GLuint triangleVBO;
@@ -305,6 +327,18 @@ private:
     GLint screenRestoreFBO;
     bool screenValid;
 
+    GLuint histogramValueBuffer;
+    GLuint histogramBuffer;
+    GLuint histogramMaxBuffer;
+    GLuint histogramJobBuffer;
+    GLuint histogramPassBuffer;
+    std::vector<GLuint> histogramPasses;
+    GLuint histogramPassCount;
+    core::FlagStorage::FlagVersionType histogramFlagsVersion;
+    bool histogramValuesValid;
+    bool histogramsValid;
+    GLint maxWorkgroupCount[3];
+
     megamol::core::utility::SDFFont axisFont;
     megamol::core::utility::SDFFont textFont;
     bool textValid;
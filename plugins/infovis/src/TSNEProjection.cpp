@@ -6,6 +6,8 @@
 #include "mmcore/param/IntParam.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <tsne.h>
 
@@ -22,11 +24,20 @@ TSNEProjection::TSNEProjection(void)
           "theta = 0 corresponds to standard, slow t-SNE, while theta = 1 corresponds to very crude approximations")
     , maxIterSlot("maxIter", "Set the maximum Iterations")
     , perplexitySlot("perplexity", "Set the Perplexity")
+    , streamIterSlot("streamIterations",
+          "Publish the intermediate embedding every n iterations while projecting in the background (0 = only the "
+          "final one)")
+    , warmStartRatioSlot("warmStartRatio",
+          "Continue from the previous embedding if at most this fraction of the rows changed (0 = always restart)")
     , datahash(0)
     , dataInHash(0)
-    , columnInfos() {
-
-    TSNE* tsne = new TSNE(); // lib load test
+    , columnInfos()
+    , lastColumns(0)
+    , cancelWorker(false)
+    , embeddingRows(0)
+    , embeddingColumns(0)
+    , embeddingChanged(false)
+    , embeddingFinished(false) {
 
     this->dataInSlot.SetCompatibleCall<megamol::stdplugin::datatools::table::TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataInSlot);
@@ -51,13 +62,19 @@ TSNEProjection::TSNEProjection(void)
 
     thetaSlot << new ::megamol::core::param::FloatParam(0.5);
     this->MakeSlotAvailable(&thetaSlot);
+
+    streamIterSlot << new ::megamol::core::param::IntParam(100, 0);
+    this->MakeSlotAvailable(&streamIterSlot);
+
+    warmStartRatioSlot << new ::megamol::core::param::FloatParam(0.1f, 0.0f, 1.0f);
+    this->MakeSlotAvailable(&warmStartRatioSlot);
 }
 
 TSNEProjection::~TSNEProjection(void) { this->Release(); }
 
 bool TSNEProjection::create(void) { return true; }
 
-void TSNEProjection::release(void) {}
+void TSNEProjection::release(void) { this->stopWorker(); }
 
 bool TSNEProjection::getDataCallback(core::Call& c) {
     try {
@@ -74,6 +91,7 @@ bool TSNEProjection::getDataCallback(core::Call& c) {
 
         bool finished = project(inCall);
         if (finished == false) return false;
+        this->publish();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -127,15 +145,16 @@ bool megamol::infovis::TSNEProjection::project(megamol::stdplugin::datatools::ta
     }
 
     auto columnCount = inCall->GetColumnsCount();
-    auto column_infos = inCall->GetColumnsInfos();
     auto rowsCount = inCall->GetRowsCount();
     auto inData = inCall->GetData();
 
     unsigned int outputColumnCount = this->reduceToNSlot.Param<core::param::IntParam>()->Value();
     int maxIter = this->maxIterSlot.Param<core::param::IntParam>()->Value();
+    int streamIter = this->streamIterSlot.Param<core::param::IntParam>()->Value();
     int randomSeed = this->randomSeedSlot.Param<core::param::IntParam>()->Value();
     double theta = this->thetaSlot.Param<core::param::FloatParam>()->Value();
     double perplexity = this->perplexitySlot.Param<core::param::FloatParam>()->Value();
+    float warmStartRatio = this->warmStartRatioSlot.Param<core::param::FloatParam>()->Value();
 
 
     if (outputColumnCount <= 0 || outputColumnCount > columnCount) {
@@ -144,49 +163,106 @@ bool megamol::infovis::TSNEProjection::project(megamol::stdplugin::datatools::ta
     }
 
     // Load data in a double Array
-    double* inputData = (double*)malloc(columnCount * rowsCount * sizeof(double));
-    for (int col = 0; col < columnCount; col++) {
-        for (int row = 0; row < rowsCount; row++) {
-            inputData[row * columnCount + col] = inData[row * columnCount + col];
-            // inputData[col*rowsCount + row] = inData[row * columnCount + col];
+    std::vector<double> inputData(inData, inData + columnCount * rowsCount);
+
+    // The previous job works on outdated input, its embedding may still serve as starting point
+    this->stopWorker();
+
+    std::vector<double> initial;
+    {
+        std::lock_guard<std::mutex> lock(this->embeddingLock);
+        if (warmStartRatio > 0.0f && !randomSeedSlot.IsDirty() && this->embeddingRows == rowsCount &&
+            this->embeddingColumns == outputColumnCount && this->lastColumns == columnCount &&
+            this->lastInput.size() == inputData.size()) {
+            size_t changedRows = 0;
+            for (size_t row = 0; row < rowsCount; row++) {
+                if (!std::equal(inputData.begin() + row * columnCount, inputData.begin() + (row + 1) * columnCount,
+                        this->lastInput.begin() + row * columnCount)) {
+                    changedRows++;
+                }
+            }
+            if (changedRows <= warmStartRatio * rowsCount) {
+                initial = this->embedding;
+                vislib::sys::Log::DefaultLog.WriteInfo(
+                    "%s: %zu of %zu rows changed, continuing from the previous embedding", ClassName(), changedRows,
+                    rowsCount);
+            }
         }
+        this->embeddingChanged = false;
+        this->embeddingFinished = false;
     }
 
+    this->lastInput = inputData;
+    this->lastColumns = columnCount;
 
-    TSNE* tsne = new TSNE();
+    this->dataInHash = inCall->DataHash();
+    reduceToNSlot.ResetDirty();
+    maxIterSlot.ResetDirty();
+    randomSeedSlot.ResetDirty();
+    thetaSlot.ResetDirty();
+    perplexitySlot.ResetDirty();
 
-    double* result = (double*)malloc(rowsCount * outputColumnCount * sizeof(double));
-    // void run(double* X, int N, int D, double* Y, int no_dims, double perplexity, double theta, int rand_seed,
-    // bool skip_random_init, int max_iter = 1000, int stop_lying_iter = 250, int mom_switch_iter = 250);
-    tsne->run(
-        inputData, rowsCount, columnCount, result, outputColumnCount, perplexity, theta, randomSeed, false, maxIter);
+    this->worker = std::thread(&TSNEProjection::work, this, std::move(inputData), rowsCount, columnCount,
+        std::move(initial), outputColumnCount, maxIter, streamIter, randomSeed, theta, perplexity);
 
-    double* maximas = new double[outputColumnCount];
-    double* minimas = new double[outputColumnCount];
+    return true;
+}
 
-    for (int col = 0; col < outputColumnCount; col++) {
-        maximas[col] = result[col];
-        minimas[col] = result[col];
+void megamol::infovis::TSNEProjection::work(std::vector<double> input, size_t rows, size_t columns,
+    std::vector<double> initial, unsigned int outputColumns, int maxIter, int chunkIter, int randomSeed, double theta,
+    double perplexity) {
+    const bool warmStart = !initial.empty();
+    std::vector<double> result = warmStart ? std::move(initial) : std::vector<double>(rows * outputColumns);
+
+    // bhtsne exaggerates P and uses a lower momentum for the first 250 iterations, which a warm start skips
+    const int exaggerationIter = warmStart ? 0 : 250;
+    if (chunkIter <= 0) chunkIter = maxIter;
+
+    TSNE tsne;
+    int done = 0;
+    while (done < maxIter && !this->cancelWorker) {
+        const int iter = std::min(chunkIter, maxIter - done);
+        const int lyingIter = std::max(0, exaggerationIter - done);
+        // void run(double* X, int N, int D, double* Y, int no_dims, double perplexity, double theta, int rand_seed,
+        // bool skip_random_init, int max_iter = 1000, int stop_lying_iter = 250, int mom_switch_iter = 250);
+        tsne.run(input.data(), static_cast<int>(rows), static_cast<int>(columns), result.data(), outputColumns,
+            perplexity, theta, randomSeed, warmStart || done > 0, iter, lyingIter, lyingIter);
+        done += iter;
+
+        std::lock_guard<std::mutex> lock(this->embeddingLock);
+        this->embedding = result;
+        this->embeddingRows = static_cast<unsigned int>(rows);
+        this->embeddingColumns = outputColumns;
+        this->embeddingChanged = true;
+        this->embeddingFinished = done >= maxIter;
     }
+}
 
-    for (int col = 0; col < outputColumnCount; col++) {
-        for (int row = 1; row < rowsCount; row++) {
+void megamol::infovis::TSNEProjection::publish(void) {
+    std::lock_guard<std::mutex> lock(this->embeddingLock);
+    if (!this->embeddingChanged) return;
+    this->embeddingChanged = false;
+
+    const unsigned int outputColumnCount = this->embeddingColumns;
+    const size_t rowsCount = this->embeddingRows;
+    const double* result = this->embedding.data();
+
+    std::vector<double> maximas(outputColumnCount, std::numeric_limits<double>::lowest());
+    std::vector<double> minimas(outputColumnCount, std::numeric_limits<double>::max());
+
+    for (size_t row = 0; row < rowsCount; row++) {
+        for (unsigned int col = 0; col < outputColumnCount; col++) {
             double value = result[row * outputColumnCount + col];
             if (maximas[col] < value) maximas[col] = value;
             if (minimas[col] > value) minimas[col] = value;
         }
     }
 
-
-    // std::stringstream debug;
-    // debug << std::endl << result << std::endl;
-    // vislib::sys::Log::DefaultLog.WriteInfo(debug.str().c_str());
-
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputColumnCount);
 
-    for (int indexX = 0; indexX < outputColumnCount; indexX++) {
+    for (unsigned int indexX = 0; indexX < outputColumnCount; indexX++) {
         this->columnInfos[indexX]
             .SetName("TSNE" + std::to_string(indexX))
             .SetType(megamol::stdplugin::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
@@ -195,31 +271,18 @@ bool megamol::infovis::TSNEProjection::project(megamol::stdplugin::datatools::ta
     }
 
     // Result Matrix into Output
-    this->data.clear();
-    this->data.reserve(rowsCount * outputColumnCount);
+    this->data.assign(this->embedding.begin(), this->embedding.begin() + rowsCount * outputColumnCount);
 
-
-    for (size_t row = 0; row < rowsCount; row++) {
-        for (size_t col = 0; col < outputColumnCount; col++)
-            this->data.push_back(result[row * outputColumnCount + col]);
+    if (this->embeddingFinished) {
+        vislib::sys::Log::DefaultLog.WriteInfo("%s: projection finished", ClassName());
     }
-
-
-    this->dataInHash = inCall->DataHash();
     this->datahash++;
-    reduceToNSlot.ResetDirty();
-    maxIterSlot.ResetDirty();
-    randomSeedSlot.ResetDirty();
-    thetaSlot.ResetDirty();
-    perplexitySlot.ResetDirty();
-
-    free(result);
-    result = NULL;
-    free(inputData);
-    inputData = NULL;
-    delete (tsne);
-    delete[] maximas;
-    delete[] minimas;
+}
 
-    return true;
+void megamol::infovis::TSNEProjection::stopWorker(void) {
+    if (this->worker.joinable()) {
+        this->cancelWorker = true;
+        this->worker.join();
+    }
+    this->cancelWorker = false;
 }
@@ -7,6 +7,10 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace megamol {
 namespace infovis {
@@ -48,6 +52,16 @@ private:
 
     bool project(megamol::stdplugin::datatools::table::TableDataCall* inCall);
 
+    /** Takes over the latest embedding of the background job, if there is a new one */
+    void publish(void);
+
+    /** Asks the background job to stop after its current chunk of iterations and waits for it */
+    void stopWorker(void);
+
+    /** The background job, running t-SNE in chunks of iterations on a private copy of the input */
+    void work(std::vector<double> input, size_t rows, size_t columns, std::vector<double> initial,
+        unsigned int outputColumns, int maxIter, int chunkIter, int randomSeed, double theta, double perplexity);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -60,6 +74,8 @@ private:
     ::megamol::core::param::ParamSlot thetaSlot;
     ::megamol::core::param::ParamSlot perplexitySlot;
     ::megamol::core::param::ParamSlot maxIterSlot;
+    ::megamol::core::param::ParamSlot streamIterSlot;
+    ::megamol::core::param::ParamSlot warmStartRatioSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
@@ -73,6 +89,22 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** The input and settings of the last projection, to detect small changes for warm starts */
+    std::vector<double> lastInput;
+    size_t lastColumns;
+
+    /** The background job and the flag asking it to stop */
+    std::thread worker;
+    std::atomic<bool> cancelWorker;
+
+    /** The latest embedding of the background job, guarded by embeddingLock */
+    std::vector<double> embedding;
+    unsigned int embeddingRows;
+    unsigned int embeddingColumns;
+    bool embeddingChanged;
+    bool embeddingFinished;
+    std::mutex embeddingLock;
 };
 
 } // namespace infovis
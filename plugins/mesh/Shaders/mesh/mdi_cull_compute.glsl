@@ -0,0 +1,89 @@
+layout(local_size_x = 64) in;
+
+struct DrawElementsCommand
+{
+    uint cnt;
+    uint instance_cnt;
+    uint first_idx;
+    uint base_vertex;
+    uint base_instance;
+};
+
+struct DrawBounds
+{
+    vec4 lower;
+    vec4 upper;
+};
+
+layout(std430, binding = 0) readonly buffer DrawCommandsIn { DrawElementsCommand draw_commands_in[]; };
+layout(std430, binding = 1) readonly buffer DrawBoundsIn { DrawBounds draw_bounds[]; };
+layout(std430, binding = 2) readonly buffer PerDrawDataIn { uint per_draw_data_in[]; };
+layout(std430, binding = 3) writeonly buffer DrawCommandsOut { DrawElementsCommand draw_commands_out[]; };
+layout(std430, binding = 4) writeonly buffer PerDrawDataOut { uint per_draw_data_out[]; };
+layout(std430, binding = 5) buffer DrawCountOut { uint draw_cnt_out; };
+
+uniform mat4 view_proj_mx;
+uniform vec2 viewport;
+uniform float min_screen_size;
+uniform int draw_cnt;
+uniform int per_draw_data_stride; // in uints
+
+bool isVisible(DrawBounds bounds)
+{
+    // draw commands without bounds are never culled
+    if (bounds.lower.w == 0.0) return true;
+
+    // outcodes of the box corners against the six clip planes
+    uint outside_all = 0x3Fu;
+    bool in_front = true;
+    vec2 ndc_min = vec2(1.0);
+    vec2 ndc_max = vec2(-1.0);
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = vec3((i & 1) != 0 ? bounds.upper.x : bounds.lower.x,
+            (i & 2) != 0 ? bounds.upper.y : bounds.lower.y,
+            (i & 4) != 0 ? bounds.upper.z : bounds.lower.z);
+        vec4 clip = view_proj_mx * vec4(corner, 1.0);
+
+        uint outside = 0u;
+        outside |= (clip.x < -clip.w) ? 0x01u : 0u;
+        outside |= (clip.x > clip.w) ? 0x02u : 0u;
+        outside |= (clip.y < -clip.w) ? 0x04u : 0u;
+        outside |= (clip.y > clip.w) ? 0x08u : 0u;
+        outside |= (clip.z < -clip.w) ? 0x10u : 0u;
+        outside |= (clip.z > clip.w) ? 0x20u : 0u;
+        outside_all &= outside;
+
+        if (clip.w <= 0.0) {
+            in_front = false;
+        } else {
+            ndc_min = min(ndc_min, clip.xy / clip.w);
+            ndc_max = max(ndc_max, clip.xy / clip.w);
+        }
+    }
+
+    // all corners outside of the same plane
+    if (outside_all != 0u) return false;
+
+    // boxes reaching behind the camera cannot be measured on screen
+    if (!in_front) return true;
+
+    vec2 screen_size = (ndc_max - ndc_min) * 0.5 * viewport;
+    return max(screen_size.x, screen_size.y) >= min_screen_size;
+}
+
+void main()
+{
+    int draw_idx = int(gl_GlobalInvocationID.x);
+    if (draw_idx >= draw_cnt) return;
+
+    if (!isVisible(draw_bounds[draw_idx])) return;
+
+    // gl_DrawIDARB of the compacted draw indexes the compacted per draw data
+    uint out_idx = atomicAdd(draw_cnt_out, 1u);
+    draw_commands_out[out_idx] = draw_commands_in[draw_idx];
+    int src = draw_idx * per_draw_data_stride;
+    int dst = int(out_idx) * per_draw_data_stride;
+    for (int i = 0; i < per_draw_data_stride; ++i) {
+        per_draw_data_out[dst + i] = per_draw_data_in[src + i];
+    }
+}
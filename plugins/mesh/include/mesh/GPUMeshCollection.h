@@ -11,6 +11,7 @@
 #    pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include "glowl/Mesh.hpp"
@@ -23,6 +24,12 @@ class MESH_API GPUMeshCollection {
 public:
     template <typename T> using IteratorPair = std::pair<T, T>;
 
+    /** A range [first, first + cnt) of vertices or indices in a batch */
+    struct Range {
+        size_t first;
+        size_t cnt;
+    };
+
     struct BatchedMeshes {
         BatchedMeshes()
             : mesh(nullptr), vertices_allocated(0), vertices_used(0), indices_allocated(0), indices_used(0) {}
@@ -39,11 +46,17 @@ public:
         unsigned int vertices_used;
         unsigned int indices_allocated;
         unsigned int indices_used;
+
+        // ranges below vertices_used and indices_used freed by deleted sub meshes, sorted by first
+        std::vector<Range> free_vertex_ranges;
+        std::vector<Range> free_index_ranges;
     };
 
     struct SubMeshData {
         size_t batch_index;
         glowl::DrawElementsCommand sub_mesh_draw_command;
+        // vertices occupied in the batch, zero once deleted
+        unsigned int vertex_cnt = 0;
     };
 
     GPUMeshCollection() = default;
@@ -59,6 +72,21 @@ public:
         GLenum primitive_type,
         bool store_seperate = false);
 
+    /**
+     * Overwrites the data of a sub mesh in place. Render tasks keep their
+     * draw commands, hence the vertex and index counts must not change.
+     *
+     * @return true on success, false if the counts differ from the sub mesh
+     */
+    template <typename VertexBufferIterator, typename IndexBufferIterator>
+    bool updateSubMesh(size_t submesh_idx,
+        std::vector<IteratorPair<VertexBufferIterator>> const& vertex_buffers,
+        IteratorPair<IndexBufferIterator> index_buffer);
+
+    /**
+     * Frees the space of a sub mesh in its batch for reuse by meshes added
+     * later. The sub mesh keeps its index, but draws nothing.
+     */
     void deleteSubMesh(size_t submesh_idx);
 
     void clear() {
@@ -71,6 +99,18 @@ public:
     std::vector<SubMeshData> const& getSubMeshData();
 
 private:
+    /** Answer whether cnt elements can be allocated from the free ranges or the unused tail */
+    static bool canAllocate(std::vector<Range> const& free_ranges, size_t used, size_t allocated, size_t cnt);
+
+    /** Allocates cnt elements first fit from the free ranges, or from the unused tail */
+    static size_t allocateRange(std::vector<Range>& free_ranges, unsigned int& used, size_t cnt);
+
+    /** Returns a range to the free ranges, merging it with its neighbours and the unused tail */
+    static void freeRange(std::vector<Range>& free_ranges, unsigned int& used, Range range);
+
+    /** Computes the per vertex byte sizes of the vertex buffers */
+    static std::vector<size_t> computeVertexByteSizes(glowl::VertexLayout const& vertex_descriptor, size_t vb_cnt);
+
     std::vector<BatchedMeshes> m_batched_meshes;
     std::vector<SubMeshData> m_sub_mesh_data;
 };
@@ -88,18 +128,7 @@ inline size_t GPUMeshCollection::addMesh(
     typedef typename std::iterator_traits<VertexBufferIterator>::value_type VertexBufferType;
 
     // compute byte size of per vertex data in first vertex buffer
-    std::vector<size_t> vb_attrib_byte_sizes;
-    // single vertex buffer signals possible interleaved vertex layout, sum up all attribute byte sizes
-    if (vertex_buffers.size() == 1) {
-        vb_attrib_byte_sizes.push_back(0);
-        for (auto& attr : vertex_descriptor.attributes) {
-            vb_attrib_byte_sizes.back() += computeAttributeByteSize(attr);
-        }
-    } else {
-        for (auto& attr : vertex_descriptor.attributes) {
-            vb_attrib_byte_sizes.push_back(computeAttributeByteSize(attr));
-        }
-    }
+    std::vector<size_t> vb_attrib_byte_sizes = computeVertexByteSizes(vertex_descriptor, vertex_buffers.size());
 
     // get vertex buffer data pointers and byte sizes
     std::vector<GLvoid*> vb_data;
@@ -110,7 +139,7 @@ inline size_t GPUMeshCollection::addMesh(
     }
     // compute overall byte size of index buffer
     size_t ib_byte_size =
-        sizeof(VertexBufferType) * std::distance(std::get<0>(index_buffer), std::get<1>(index_buffer));
+        sizeof(IndexBufferType) * std::distance(std::get<0>(index_buffer), std::get<1>(index_buffer));
 
     // computer number of requested vertices and indices
     size_t req_vertex_cnt = vb_byte_sizes.front() / vb_attrib_byte_sizes.front();
@@ -125,11 +154,9 @@ inline size_t GPUMeshCollection::addMesh(
             bool idx_type_check = (index_type == it->mesh->getIndexType());
 
             if (layout_check && idx_type_check) {
-                // check whether there is enough space left in batch
-                size_t ava_vertex_cnt = (it->vertices_allocated - it->vertices_used);
-                size_t ava_index_cnt = (it->indices_allocated - it->indices_used);
-
-                if ((req_vertex_cnt < ava_vertex_cnt) && (req_index_cnt < ava_index_cnt)) {
+                // check whether there is enough space left in batch, including the space of deleted sub meshes
+                if (canAllocate(it->free_vertex_ranges, it->vertices_used, it->vertices_allocated, req_vertex_cnt) &&
+                    canAllocate(it->free_index_ranges, it->indices_used, it->indices_allocated, req_index_cnt)) {
                     break;
                 }
             }
@@ -163,34 +190,149 @@ inline size_t GPUMeshCollection::addMesh(
 
     auto sub_mesh_idx = m_sub_mesh_data.size();
 
+    size_t first_vertex = allocateRange(it->free_vertex_ranges, it->vertices_used, req_vertex_cnt);
+    size_t first_index = allocateRange(it->free_index_ranges, it->indices_used, req_index_cnt);
+
     m_sub_mesh_data.emplace_back(SubMeshData());
     m_sub_mesh_data.back().batch_index = std::distance(m_batched_meshes.begin(), it);
-    m_sub_mesh_data.back().sub_mesh_draw_command.first_idx = it->indices_used;
-    m_sub_mesh_data.back().sub_mesh_draw_command.base_vertex = it->vertices_used;
+    m_sub_mesh_data.back().sub_mesh_draw_command.first_idx = first_index;
+    m_sub_mesh_data.back().sub_mesh_draw_command.base_vertex = first_vertex;
     m_sub_mesh_data.back().sub_mesh_draw_command.cnt = req_index_cnt;
     m_sub_mesh_data.back().sub_mesh_draw_command.instance_cnt = 1;
     m_sub_mesh_data.back().sub_mesh_draw_command.base_instance = 0;
+    m_sub_mesh_data.back().vertex_cnt = req_vertex_cnt;
 
     // upload data to GPU
     for (size_t i = 0; i < vb_data.size(); ++i) {
         // at this point, it should be guaranteed that it points at a mesh with matching vertex layout,
-        // hence it's legal to multiply requested attrib byte sizes with vertex used count
-        it->mesh->bufferVertexSubData(i, vb_data[i], vb_byte_sizes[i], vb_attrib_byte_sizes[i] * (it->vertices_used));
+        // hence it's legal to multiply requested attrib byte sizes with the first vertex
+        it->mesh->bufferVertexSubData(i, vb_data[i], vb_byte_sizes[i], vb_attrib_byte_sizes[i] * first_vertex);
     }
 
     it->mesh->bufferIndexSubData(reinterpret_cast<GLvoid*>(&*std::get<0>(index_buffer)), ib_byte_size,
-        glowl::computeByteSize(index_type) * it->indices_used);
-
-    // updated vertices and indices used
-    it->vertices_used += req_vertex_cnt;
-    it->indices_used += req_index_cnt;
+        glowl::computeByteSize(index_type) * first_index);
 
     return sub_mesh_idx;
 }
 
-inline void GPUMeshCollection::deleteSubMesh(size_t submesh_idx) 
-{
+template <typename VertexBufferIterator, typename IndexBufferIterator>
+inline bool GPUMeshCollection::updateSubMesh(size_t submesh_idx,
+    std::vector<IteratorPair<VertexBufferIterator>> const& vertex_buffers,
+    IteratorPair<IndexBufferIterator> index_buffer) {
+    typedef typename std::iterator_traits<IndexBufferIterator>::value_type IndexBufferType;
+    typedef typename std::iterator_traits<VertexBufferIterator>::value_type VertexBufferType;
+
+    if (submesh_idx >= m_sub_mesh_data.size()) return false;
+    auto& sub_mesh = m_sub_mesh_data[submesh_idx];
+    auto& batch = m_batched_meshes[sub_mesh.batch_index];
+
+    auto const& vertex_descriptor = batch.mesh->getVertexLayout();
+    std::vector<size_t> vb_attrib_byte_sizes = computeVertexByteSizes(vertex_descriptor, vertex_buffers.size());
+    if (vb_attrib_byte_sizes.size() != vertex_buffers.size()) return false;
+
+    size_t index_byte_size = glowl::computeByteSize(batch.mesh->getIndexType());
+    size_t ib_byte_size =
+        sizeof(IndexBufferType) * std::distance(std::get<0>(index_buffer), std::get<1>(index_buffer));
+    if ((sub_mesh.vertex_cnt == 0) || (ib_byte_size != sub_mesh.sub_mesh_draw_command.cnt * index_byte_size)) {
+        return false;
+    }
+    for (size_t i = 0; i < vertex_buffers.size(); ++i) {
+        size_t vb_byte_size = sizeof(VertexBufferType) *
+                              std::distance(std::get<0>(vertex_buffers[i]), std::get<1>(vertex_buffers[i]));
+        if (vb_byte_size != sub_mesh.vertex_cnt * vb_attrib_byte_sizes[i]) return false;
+    }
+
+    for (size_t i = 0; i < vertex_buffers.size(); ++i) {
+        batch.mesh->bufferVertexSubData(i, reinterpret_cast<GLvoid*>(&(*std::get<0>(vertex_buffers[i]))),
+            sub_mesh.vertex_cnt * vb_attrib_byte_sizes[i],
+            vb_attrib_byte_sizes[i] * sub_mesh.sub_mesh_draw_command.base_vertex);
+    }
+    batch.mesh->bufferIndexSubData(reinterpret_cast<GLvoid*>(&*std::get<0>(index_buffer)), ib_byte_size,
+        index_byte_size * sub_mesh.sub_mesh_draw_command.first_idx);
+
+    return true;
+}
+
+inline void GPUMeshCollection::deleteSubMesh(size_t submesh_idx) {
+    if (submesh_idx >= m_sub_mesh_data.size()) return;
+    auto& sub_mesh = m_sub_mesh_data[submesh_idx];
+    if (sub_mesh.vertex_cnt == 0) return;
+
+    auto& batch = m_batched_meshes[sub_mesh.batch_index];
+    freeRange(batch.free_vertex_ranges, batch.vertices_used,
+        Range{static_cast<size_t>(sub_mesh.sub_mesh_draw_command.base_vertex), sub_mesh.vertex_cnt});
+    freeRange(batch.free_index_ranges, batch.indices_used,
+        Range{static_cast<size_t>(sub_mesh.sub_mesh_draw_command.first_idx), sub_mesh.sub_mesh_draw_command.cnt});
+
+    sub_mesh.vertex_cnt = 0;
+    sub_mesh.sub_mesh_draw_command.cnt = 0;
+    sub_mesh.sub_mesh_draw_command.instance_cnt = 0;
+}
 
+inline bool GPUMeshCollection::canAllocate(
+    std::vector<Range> const& free_ranges, size_t used, size_t allocated, size_t cnt) {
+    if (used + cnt <= allocated) return true;
+    return std::any_of(free_ranges.begin(), free_ranges.end(), [cnt](Range const& r) { return r.cnt >= cnt; });
+}
+
+inline size_t GPUMeshCollection::allocateRange(std::vector<Range>& free_ranges, unsigned int& used, size_t cnt) {
+    for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+        if (it->cnt >= cnt) {
+            size_t first = it->first;
+            it->first += cnt;
+            it->cnt -= cnt;
+            if (it->cnt == 0) free_ranges.erase(it);
+            return first;
+        }
+    }
+    // the caller checked canAllocate, so the tail is large enough
+    size_t first = used;
+    used += static_cast<unsigned int>(cnt);
+    return first;
+}
+
+inline void GPUMeshCollection::freeRange(std::vector<Range>& free_ranges, unsigned int& used, Range range) {
+    if (range.cnt == 0) return;
+    auto it = std::lower_bound(free_ranges.begin(), free_ranges.end(), range,
+        [](Range const& lhs, Range const& rhs) { return lhs.first < rhs.first; });
+    it = free_ranges.insert(it, range);
+
+    // merge with the successor and the predecessor
+    auto next = it + 1;
+    if ((next != free_ranges.end()) && (it->first + it->cnt == next->first)) {
+        it->cnt += next->cnt;
+        free_ranges.erase(next);
+    }
+    if (it != free_ranges.begin()) {
+        auto prev = it - 1;
+        if (prev->first + prev->cnt == it->first) {
+            prev->cnt += it->cnt;
+            free_ranges.erase(it);
+        }
+    }
+
+    // a free range at the end of the used space returns to the unused tail
+    if (free_ranges.back().first + free_ranges.back().cnt == used) {
+        used = static_cast<unsigned int>(free_ranges.back().first);
+        free_ranges.pop_back();
+    }
+}
+
+inline std::vector<size_t> GPUMeshCollection::computeVertexByteSizes(
+    glowl::VertexLayout const& vertex_descriptor, size_t vb_cnt) {
+    std::vector<size_t> vb_attrib_byte_sizes;
+    // single vertex buffer signals possible interleaved vertex layout, sum up all attribute byte sizes
+    if (vb_cnt == 1) {
+        vb_attrib_byte_sizes.push_back(0);
+        for (auto& attr : vertex_descriptor.attributes) {
+            vb_attrib_byte_sizes.back() += computeAttributeByteSize(attr);
+        }
+    } else {
+        for (auto& attr : vertex_descriptor.attributes) {
+            vb_attrib_byte_sizes.push_back(computeAttributeByteSize(attr));
+        }
+    }
+    return vb_attrib_byte_sizes;
 }
 
 inline std::vector<GPUMeshCollection::BatchedMeshes> const& GPUMeshCollection::getMeshes() { return m_batched_meshes; }
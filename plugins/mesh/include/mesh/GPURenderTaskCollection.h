@@ -27,6 +27,15 @@ public:
     // template<typename T>
     // using IteratorPair = std::pair< T, T>;
 
+    /**
+     * World space bounding box of a single draw command, used by renderers for culling.
+     * Draw commands whose bounds were never set (lower[3] == 0) are never culled.
+     */
+    struct DrawBounds {
+        float lower[4];
+        float upper[4];
+    };
+
     struct RenderTasks {
         /**
          * Compare RenderTasks by shader program and mesh pointer addresses.
@@ -42,6 +51,7 @@ public:
         std::shared_ptr<glowl::Mesh>         mesh;
         std::shared_ptr<glowl::BufferObject> draw_commands;
         std::shared_ptr<glowl::BufferObject> per_draw_data;
+        std::shared_ptr<glowl::BufferObject> draw_bounds;
 
         size_t                               draw_cnt;
     };
@@ -79,6 +89,12 @@ public:
     template <typename PerDrawDataContainer>
     void updatePerDrawData(size_t rt_base_idx, PerDrawDataContainer const& per_draw_data);
 
+    /**
+     * Set the culling bounds of consecutive render tasks, e.g. those added by a single call of addRenderTasks.
+     */
+    template <typename DrawBoundsContainer>
+    void updateDrawBounds(size_t rt_base_idx, DrawBoundsContainer const& draw_bounds);
+
     template <typename PerFrameDataContainer>
     void addPerFrameDataBuffer(PerFrameDataContainer const& per_frame_data, uint32_t buffer_binding_point);
 
@@ -135,20 +151,28 @@ inline size_t GPURenderTaskCollection::addSingleRenderTask(
             size_t old_pdd_byte_size = rts.per_draw_data->getByteSize();
             size_t new_dcs_byte_size = old_dcs_byte_size + sizeof(glowl::DrawElementsCommand);
             size_t new_pdd_byte_size = old_pdd_byte_size + sizeof(PerDrawDataType);
+            size_t old_dbs_byte_size = rts.draw_bounds->getByteSize();
+            size_t new_dbs_byte_size = old_dbs_byte_size + sizeof(DrawBounds);
 
             auto new_dcs_buffer = std::make_shared<glowl::BufferObject>(
                 GL_DRAW_INDIRECT_BUFFER, nullptr, new_dcs_byte_size, GL_DYNAMIC_DRAW);
             auto new_pdd_buffer = std::make_shared<glowl::BufferObject>(
                 GL_SHADER_STORAGE_BUFFER, nullptr, new_pdd_byte_size, GL_DYNAMIC_DRAW);
+            auto new_dbs_buffer = std::make_shared<glowl::BufferObject>(
+                GL_SHADER_STORAGE_BUFFER, nullptr, new_dbs_byte_size, GL_DYNAMIC_DRAW);
 
             glowl::BufferObject::copy(rts.draw_commands.get(), new_dcs_buffer.get());
             glowl::BufferObject::copy(rts.per_draw_data.get(), new_pdd_buffer.get());
+            glowl::BufferObject::copy(rts.draw_bounds.get(), new_dbs_buffer.get());
 
+            DrawBounds const no_bounds = {};
             new_dcs_buffer->bufferSubData(&draw_command, sizeof(glowl::DrawElementsCommand), old_dcs_byte_size);
             new_pdd_buffer->bufferSubData(&per_draw_data, sizeof(PerDrawDataType), old_pdd_byte_size);
+            new_dbs_buffer->bufferSubData(&no_bounds, sizeof(DrawBounds), old_dbs_byte_size);
 
             rts.draw_commands = new_dcs_buffer;
             rts.per_draw_data = new_pdd_buffer;
+            rts.draw_bounds = new_dbs_buffer;
             rts.draw_cnt += 1;
 
             task_added = true;
@@ -183,6 +207,9 @@ inline size_t GPURenderTaskCollection::addSingleRenderTask(
             GL_DRAW_INDIRECT_BUFFER, &draw_command, new_dcs_byte_size, GL_DYNAMIC_DRAW);
         new_task.per_draw_data = std::make_shared<glowl::BufferObject>(
             GL_SHADER_STORAGE_BUFFER, &per_draw_data, new_pdd_byte_size, GL_DYNAMIC_DRAW);
+        DrawBounds const no_bounds = {};
+        new_task.draw_bounds = std::make_shared<glowl::BufferObject>(
+            GL_SHADER_STORAGE_BUFFER, &no_bounds, sizeof(DrawBounds), GL_DYNAMIC_DRAW);
         new_task.draw_cnt = 1;
 
         // Add render task meta data entry
@@ -221,22 +248,30 @@ inline size_t GPURenderTaskCollection::addRenderTasks(
             size_t old_pdd_byte_size = rts.per_draw_data->getByteSize();
             size_t new_dcs_byte_size = old_dcs_byte_size + sizeof(DrawCommandType) * draw_commands.size();
             size_t new_pdd_byte_size = old_pdd_byte_size + sizeof(PerDrawDataType) * per_draw_data.size();
+            size_t old_dbs_byte_size = rts.draw_bounds->getByteSize();
+            size_t new_dbs_byte_size = old_dbs_byte_size + sizeof(DrawBounds) * draw_commands.size();
 
             auto new_dcs_buffer = std::make_shared<glowl::BufferObject>(
                 GL_DRAW_INDIRECT_BUFFER, nullptr, new_dcs_byte_size, GL_DYNAMIC_DRAW);
             auto new_pdd_buffer = std::make_shared<glowl::BufferObject>(
                 GL_SHADER_STORAGE_BUFFER, nullptr, new_pdd_byte_size, GL_DYNAMIC_DRAW);
+            auto new_dbs_buffer = std::make_shared<glowl::BufferObject>(
+                GL_SHADER_STORAGE_BUFFER, nullptr, new_dbs_byte_size, GL_DYNAMIC_DRAW);
 
             glowl::BufferObject::copy(rts.draw_commands.get(), new_dcs_buffer.get());
             glowl::BufferObject::copy(rts.per_draw_data.get(), new_pdd_buffer.get());
+            glowl::BufferObject::copy(rts.draw_bounds.get(), new_dbs_buffer.get());
 
+            std::vector<DrawBounds> const no_bounds(draw_commands.size(), DrawBounds());
             new_dcs_buffer->bufferSubData(
                 draw_commands.data(), sizeof(DrawCommandType) * draw_commands.size(), old_dcs_byte_size);
             new_pdd_buffer->bufferSubData(
                 per_draw_data.data(), sizeof(PerDrawDataType) * per_draw_data.size(), old_pdd_byte_size);
+            new_dbs_buffer->bufferSubData(no_bounds.data(), sizeof(DrawBounds) * no_bounds.size(), old_dbs_byte_size);
 
             rts.draw_commands = new_dcs_buffer;
             rts.per_draw_data = new_pdd_buffer;
+            rts.draw_bounds = new_dbs_buffer;
             rts.draw_cnt += draw_commands.size();
 
             task_added = true;
@@ -274,6 +309,9 @@ inline size_t GPURenderTaskCollection::addRenderTasks(
             GL_DRAW_INDIRECT_BUFFER, draw_commands.data(), new_dcs_byte_size, GL_DYNAMIC_DRAW);
         new_task.per_draw_data = std::make_shared<glowl::BufferObject>(
             GL_SHADER_STORAGE_BUFFER, per_draw_data.data(), new_pdd_byte_size, GL_DYNAMIC_DRAW);
+        std::vector<DrawBounds> const no_bounds(draw_commands.size(), DrawBounds());
+        new_task.draw_bounds = std::make_shared<glowl::BufferObject>(
+            GL_SHADER_STORAGE_BUFFER, no_bounds.data(), sizeof(DrawBounds) * no_bounds.size(), GL_DYNAMIC_DRAW);
         new_task.draw_cnt = draw_commands.size();
 
         retval = m_render_task_meta_data.size();
@@ -308,6 +346,23 @@ inline void GPURenderTaskCollection::updatePerDrawData(
     rts.per_draw_data->bufferSubData(per_draw_data, rt_meta.per_draw_data_byteOffset);
 }
 
+template <typename DrawBoundsContainer>
+inline void GPURenderTaskCollection::updateDrawBounds(
+    size_t rt_base_idx,
+    DrawBoundsContainer const& draw_bounds) {
+    if (rt_base_idx >= m_render_task_meta_data.size()) {
+        vislib::sys::Log::DefaultLog.WriteError("RenderTask update error: Index out of bounds.");
+        return;
+    }
+
+    RenderTaskMetaData rt_meta = m_render_task_meta_data[rt_base_idx];
+
+    auto& rts = m_render_tasks[rt_meta.rts_idx];
+
+    size_t draw_idx = rt_meta.draw_command_byteOffset / sizeof(glowl::DrawElementsCommand);
+    rts.draw_bounds->bufferSubData(draw_bounds, draw_idx * sizeof(DrawBounds));
+}
+
 template <typename PerFrameDataContainer>
 inline void GPURenderTaskCollection::addPerFrameDataBuffer(
     PerFrameDataContainer const& per_frame_data,
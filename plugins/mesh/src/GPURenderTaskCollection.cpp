@@ -19,15 +19,21 @@ void GPURenderTaskCollection::deleteSingleRenderTask(size_t rt_idx) {
     size_t old_pdd_byte_size = rts.per_draw_data->getByteSize();
     size_t new_dcs_byte_size = old_dcs_byte_size - sizeof(glowl::DrawElementsCommand);
     size_t new_pdd_byte_size = old_pdd_byte_size - rt_meta.per_draw_data_byteSize;
+    size_t new_dbs_byte_size = rts.draw_bounds->getByteSize() - sizeof(DrawBounds);
+    size_t draw_bounds_byteOffset =
+        (rt_meta.draw_command_byteOffset / sizeof(glowl::DrawElementsCommand)) * sizeof(DrawBounds);
 
     auto new_dcs_buffer =
         std::make_shared<glowl::BufferObject>(GL_DRAW_INDIRECT_BUFFER, nullptr, new_dcs_byte_size, GL_DYNAMIC_DRAW);
     auto new_pdd_buffer =
         std::make_shared<glowl::BufferObject>(GL_SHADER_STORAGE_BUFFER, nullptr, new_pdd_byte_size, GL_DYNAMIC_DRAW);
+    auto new_dbs_buffer =
+        std::make_shared<glowl::BufferObject>(GL_SHADER_STORAGE_BUFFER, nullptr, new_dbs_byte_size, GL_DYNAMIC_DRAW);
 
     // copy data from beg to delete
     glowl::BufferObject::copy(rts.draw_commands.get(), new_dcs_buffer.get(),0,0,rt_meta.draw_command_byteOffset);
     glowl::BufferObject::copy(rts.per_draw_data.get(), new_pdd_buffer.get(),0,0,rt_meta.per_draw_data_byteOffset);
+    glowl::BufferObject::copy(rts.draw_bounds.get(), new_dbs_buffer.get(), 0, 0, draw_bounds_byteOffset);
 
     // copy data from delete to end
     glowl::BufferObject::copy(rts.draw_commands.get(), new_dcs_buffer.get(),
@@ -36,9 +42,13 @@ void GPURenderTaskCollection::deleteSingleRenderTask(size_t rt_idx) {
     glowl::BufferObject::copy(rts.per_draw_data.get(), new_pdd_buffer.get(),
         rt_meta.per_draw_data_byteOffset + rt_meta.per_draw_data_byteSize, rt_meta.per_draw_data_byteOffset,
         new_pdd_byte_size - rt_meta.per_draw_data_byteOffset);
+    glowl::BufferObject::copy(rts.draw_bounds.get(), new_dbs_buffer.get(),
+        draw_bounds_byteOffset + sizeof(DrawBounds), draw_bounds_byteOffset,
+        new_dbs_byte_size - draw_bounds_byteOffset);
 
     rts.draw_commands = new_dcs_buffer;
     rts.per_draw_data = new_pdd_buffer;
+    rts.draw_bounds = new_dbs_buffer;
     rts.draw_cnt -= 1;
 
     // Set rt meta entry to zero, keep it in list so as to not invalidate any saved indices into that vector
@@ -11,7 +11,10 @@
 #include "RenderMDIMesh.h"
 
 #include "mmcore/CoreInstance.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "vislib/graphics/gl/ShaderSource.h"
+#include "vislib/sys/Log.h"
 
 #include "mesh/MeshCalls.h"
 
@@ -22,12 +25,20 @@ RenderMDIMesh::RenderMDIMesh()
 	: Renderer3DModule_2()
     , m_render_task_callerSlot("getRenderTaskData", "Connects the renderer with a render task data source")
     , m_framebuffer_slot("Framebuffer", "Connects the renderer to an (optional) framebuffer render target from the calling module") 
+    , m_culling_slot("culling", "Culls draw commands outside of the view frustum on the GPU")
+    , m_min_screen_size_slot("minScreenSize", "Culls draw commands whose bounds are smaller on screen (in pixels)")
 {
 	this->m_render_task_callerSlot.SetCompatibleCall<GPURenderTasksDataCallDescription>();
 	this->MakeSlotAvailable(&this->m_render_task_callerSlot);
 
     this->m_framebuffer_slot.SetCompatibleCall<compositing::CallFramebufferGLDescription>();
     this->MakeSlotAvailable(&this->m_framebuffer_slot);
+
+    this->m_culling_slot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->m_culling_slot);
+
+    this->m_min_screen_size_slot << new core::param::FloatParam(0.0f, 0.0f);
+    this->MakeSlotAvailable(&this->m_min_screen_size_slot);
 }
 
 RenderMDIMesh::~RenderMDIMesh()
@@ -121,12 +132,33 @@ bool RenderMDIMesh::create()
 	//TODO delete stuff again
 	*/
 
+    // culling needs the draw count to stay on the GPU
+    if (isExtAvailable("GL_ARB_indirect_parameters")) {
+        vislib::graphics::gl::ShaderSource cull_shader_src;
+        if (this->instance()->ShaderSourceFactory().MakeShaderSource("RenderMDIMesh::cull", cull_shader_src)) {
+            std::string compute_src(cull_shader_src.WholeCode(), (cull_shader_src.WholeCode()).Length());
+
+            m_cull_prgm = std::make_unique<Shader>();
+            if (!m_cull_prgm->compileShaderFromString(&compute_src, Shader::ComputeShader) || !m_cull_prgm->link()) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    "RenderMDIMesh: Unable to create culling shader, culling is disabled:\n%s",
+                    m_cull_prgm->getLog().c_str());
+                m_cull_prgm.reset();
+            }
+        }
+    } else {
+        vislib::sys::Log::DefaultLog.WriteInfo(
+            "RenderMDIMesh: GL_ARB_indirect_parameters missing, culling is disabled");
+    }
+
 	return true;
 }
 
 void RenderMDIMesh::release()
 {
 	m_per_frame_data.reset();
+    m_culled_tasks.clear();
+    m_cull_prgm.reset();
 }
 
 bool RenderMDIMesh::GetExtents(core::view::CallRender3D_2& call) {
@@ -190,6 +222,17 @@ bool RenderMDIMesh::Render(core::view::CallRender3D_2& call) {
 
     // TODO yet another nullptr check for gpu render tasks
 
+    // the pre-pass uses its own buffer bindings, so it runs before the per frame buffers are bound
+    m_culled_tasks.resize(gpu_render_tasks->getRenderTasks().size());
+    if (m_cull_prgm != nullptr && this->m_culling_slot.Param<core::param::BoolParam>()->Value()) {
+        glm::vec2 viewport(cam.resolution_gate().width(), cam.resolution_gate().height());
+        cullRenderTasks(gpu_render_tasks->getRenderTasks(), proj_mx * view_mx, viewport);
+    } else {
+        for (auto& culled_task : m_culled_tasks) {
+            culled_task.active = false;
+        }
+    }
+
 	auto const& per_frame_buffers = gpu_render_tasks->getPerFrameBuffers();
 
 	for (auto const& buffer : per_frame_buffers)
@@ -198,24 +241,43 @@ bool RenderMDIMesh::Render(core::view::CallRender3D_2& call) {
 	}
 	
 	// loop through "registered" render batches
-	for (auto const& render_task : gpu_render_tasks->getRenderTasks())
+    auto const& render_tasks = gpu_render_tasks->getRenderTasks();
+	for (size_t rt_idx = 0; rt_idx < render_tasks.size(); ++rt_idx)
 	{
+        auto const& render_task = render_tasks[rt_idx];
+        auto const& culled_task = m_culled_tasks[rt_idx];
+
         render_task.shader_program->use();
 		
 		// TODO introduce per frame "global" data buffer to store information like camera matrices?
         render_task.shader_program->setUniform("view_mx", view_mx);
         render_task.shader_program->setUniform("proj_mx", proj_mx);
 		
-		render_task.per_draw_data->bind(0);
-		
-		render_task.draw_commands->bind();
-		render_task.mesh->bindVertexArray();
-		
-		glMultiDrawElementsIndirect(render_task.mesh->getPrimitiveType(),
-			render_task.mesh->getIndexType(),
-			(GLvoid*)0,
-			render_task.draw_cnt,
-			0);
+        if (culled_task.active) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culled_task.per_draw_data->getName());
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culled_task.draw_commands->getName());
+            glBindBuffer(GL_PARAMETER_BUFFER_ARB, culled_task.draw_cnt->getName());
+            render_task.mesh->bindVertexArray();
+
+            glMultiDrawElementsIndirectCountARB(render_task.mesh->getPrimitiveType(),
+                render_task.mesh->getIndexType(),
+                (GLvoid*)0,
+                0,
+                static_cast<GLsizei>(render_task.draw_cnt),
+                0);
+        } else {
+            render_task.per_draw_data->bind(0);
+
+            render_task.draw_commands->bind();
+            render_task.mesh->bindVertexArray();
+
+            glMultiDrawElementsIndirect(render_task.mesh->getPrimitiveType(),
+                render_task.mesh->getIndexType(),
+                (GLvoid*)0,
+                render_task.draw_cnt,
+                0);
+        }
 
 		//CallmeshRenderBatches::RenderBatchesData::DrawCommandData::glowl::DrawElementsCommand command_buffer;
 		//command_buffer.cnt = 3;
@@ -246,10 +308,71 @@ bool RenderMDIMesh::Render(core::view::CallRender3D_2& call) {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    if (m_cull_prgm != nullptr) glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
 
     // Restore state
     if (!depth_test) glDisable(GL_DEPTH_TEST);
     if (culling) glEnable(GL_CULL_FACE);
 	
 	return true;
-}
\ No newline at end of file
+}
+
+void RenderMDIMesh::cullRenderTasks(std::vector<GPURenderTaskCollection::RenderTasks> const& render_tasks,
+    glm::mat4 const& view_proj_mx, glm::vec2 const& viewport) {
+
+    m_cull_prgm->use();
+    m_cull_prgm->setUniform("view_proj_mx", view_proj_mx);
+    m_cull_prgm->setUniform("viewport", viewport);
+    m_cull_prgm->setUniform("min_screen_size", this->m_min_screen_size_slot.Param<core::param::FloatParam>()->Value());
+
+    for (size_t rt_idx = 0; rt_idx < render_tasks.size(); ++rt_idx) {
+        auto const& render_task = render_tasks[rt_idx];
+        auto& culled_task = m_culled_tasks[rt_idx];
+
+        // the per draw data is copied as uints, so it has to have the same size for every draw
+        size_t const dcs_byte_size = render_task.draw_commands->getByteSize();
+        size_t const pdd_byte_size = render_task.per_draw_data->getByteSize();
+        culled_task.active = (render_task.draw_cnt > 0) && (render_task.draw_bounds != nullptr) &&
+                             (render_task.draw_bounds->getByteSize() ==
+                                 render_task.draw_cnt * sizeof(GPURenderTaskCollection::DrawBounds)) &&
+                             (pdd_byte_size % (render_task.draw_cnt * sizeof(GLuint)) == 0);
+        if (!culled_task.active) continue;
+
+        if (culled_task.draw_commands == nullptr || culled_task.draw_commands->getByteSize() != dcs_byte_size) {
+            culled_task.draw_commands = std::make_unique<glowl::BufferObject>(
+                GL_SHADER_STORAGE_BUFFER, nullptr, dcs_byte_size, GL_DYNAMIC_COPY);
+        }
+        if (culled_task.per_draw_data == nullptr || culled_task.per_draw_data->getByteSize() != pdd_byte_size) {
+            culled_task.per_draw_data = std::make_unique<glowl::BufferObject>(
+                GL_SHADER_STORAGE_BUFFER, nullptr, pdd_byte_size, GL_DYNAMIC_COPY);
+        }
+        GLuint const zero = 0;
+        if (culled_task.draw_cnt == nullptr) {
+            culled_task.draw_cnt =
+                std::make_unique<glowl::BufferObject>(GL_SHADER_STORAGE_BUFFER, &zero, sizeof(GLuint), GL_DYNAMIC_COPY);
+        } else {
+            culled_task.draw_cnt->bufferSubData(&zero, sizeof(GLuint), 0);
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, render_task.draw_commands->getName());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, render_task.draw_bounds->getName());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, render_task.per_draw_data->getName());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, culled_task.draw_commands->getName());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, culled_task.per_draw_data->getName());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, culled_task.draw_cnt->getName());
+
+        m_cull_prgm->setUniform("draw_cnt", static_cast<GLint>(render_task.draw_cnt));
+        m_cull_prgm->setUniform(
+            "per_draw_data_stride", static_cast<GLint>(pdd_byte_size / (render_task.draw_cnt * sizeof(GLuint))));
+
+        glDispatchCompute(static_cast<GLuint>((render_task.draw_cnt + 63) / 64), 1, 1);
+    }
+
+    for (GLuint binding = 0; binding < 6; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    glUseProgram(0);
+
+    // the compacted buffers are read as draw commands, draw count and SSBO
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
@@ -15,12 +15,14 @@
 #include "vislib/math/Matrix.h"
 
 #include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
 #include "mmcore/view/CallRender3D_2.h"
 #include "mmcore/view/Renderer3DModule_2.h"
 
 #include "compositing/CompositingCalls.h"
 
 #include "mesh/GPUMaterialCollection.h"
+#include "mesh/GPURenderTaskCollection.h"
 
 #include "glowl/BufferObject.hpp"
 #include "glowl/FramebufferObject.hpp"
@@ -37,6 +39,10 @@ namespace mesh {
  * or at least the same vertex format.
  * Per render batch, a single call of glMultiDrawElementsIndirect is made. The data
  * for the indirect draw call is stored and accessed via SSBOs.
+ * If GL_ARB_indirect_parameters is available, a compute pre-pass culls draw commands
+ * by their bounds against the view frustum and a minimum screen size, and writes the
+ * remaining draw commands and their per draw data to compacted buffers that are drawn
+ * with glMultiDrawElementsIndirectCount.
  */
 class RenderMDIMesh : public megamol::core::view::Renderer3DModule_2 {
 public:
@@ -114,6 +120,30 @@ protected:
     bool Render(core::view::CallRender3D_2& call);
 
 private:
+    /** Compacted copies of the draw commands and per draw data of a render task that passed culling */
+    struct CulledRenderTask {
+        std::unique_ptr<glowl::BufferObject> draw_commands;
+        std::unique_ptr<glowl::BufferObject> per_draw_data;
+        std::unique_ptr<glowl::BufferObject> draw_cnt;
+        bool active = false;
+    };
+
+    /**
+     * Run the culling pre-pass for all render tasks.
+     *
+     * @param render_tasks The render tasks.
+     * @param view_proj_mx The view projection matrix.
+     * @param viewport The size of the viewport in pixels.
+     */
+    void cullRenderTasks(std::vector<GPURenderTaskCollection::RenderTasks> const& render_tasks,
+        glm::mat4 const& view_proj_mx, glm::vec2 const& viewport);
+
+    /** Compute shader program of the culling pre-pass */
+    std::unique_ptr<Shader> m_cull_prgm;
+
+    /** Culling results, in the order of the render tasks */
+    std::vector<CulledRenderTask> m_culled_tasks;
+
     /** GPU buffer object that stores per frame data, i.e. camera parameters */
     std::unique_ptr<glowl::BufferObject> m_per_frame_data;
 
@@ -123,6 +153,12 @@ private:
     megamol::core::CallerSlot m_render_task_callerSlot;
 
     megamol::core::CallerSlot m_framebuffer_slot;
+
+    /** Enables culling of draw commands by their bounds */
+    megamol::core::param::ParamSlot m_culling_slot;
+
+    /** Draw commands whose bounds are smaller on screen are culled */
+    megamol::core::param::ParamSlot m_min_screen_size_slot;
 };
 
 } // namespace mesh
@@ -16,6 +16,77 @@
 
 #include "tiny_gltf.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+
+namespace {
+
+/** The bounding box reported while no model is loaded */
+const std::array<float, 6> placeholder_bbox = {-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+
+/**
+ * Answer whether the file is a binary glTF (GLB), either by its extension or
+ * by its magic number.
+ */
+bool isBinaryGltf(std::string const& filename) {
+    std::string ext = filename.substr(std::min(filename.size(), filename.find_last_of('.')));
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == ".glb") return true;
+
+    char magic[4] = {0, 0, 0, 0};
+    std::ifstream file(filename, std::ios::binary);
+    file.read(magic, sizeof(magic));
+    return file.good() && (std::string(magic, sizeof(magic)) == "glTF");
+}
+
+/**
+ * Loads a glTF or GLB file; runs on a worker thread.
+ *
+ * @return The model, or nullptr if the file could not be parsed.
+ */
+std::shared_ptr<tinygltf::Model> loadGltfModel(std::string const& filename) {
+    auto model = std::make_shared<tinygltf::Model>();
+    tinygltf::TinyGLTF loader;
+    std::string err;
+    std::string war;
+
+    bool ret = isBinaryGltf(filename) ? loader.LoadBinaryFromFile(&*model, &err, &war, filename)
+                                      : loader.LoadASCIIFromFile(&*model, &err, &war, filename);
+    if (!err.empty()) {
+        vislib::sys::Log::DefaultLog.WriteError("Err: %s\n", err.c_str());
+    }
+    if (!war.empty()) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Warn: %s\n", war.c_str());
+    }
+
+    if (!ret) {
+        vislib::sys::Log::DefaultLog.WriteError("Failed to parse glTF\n");
+        return nullptr;
+    }
+
+    // compressed primitives have accessors without buffer views, which are skipped when building the meshes
+    for (auto const& ext : model->extensionsUsed) {
+        if ((ext == "KHR_draco_mesh_compression") || (ext == "EXT_meshopt_compression")) {
+            vislib::sys::Log::DefaultLog.WriteWarn(
+                "glTF file %s uses %s, which is not supported. Compressed primitives are skipped.\n", filename.c_str(),
+                ext.c_str());
+        }
+    }
+
+    return model;
+}
+
+/** Answer whether the accessor references uncompressed data in a buffer */
+bool hasBufferData(tinygltf::Model const& model, int accessor_idx) {
+    if ((accessor_idx < 0) || (accessor_idx >= static_cast<int>(model.accessors.size()))) return false;
+    auto const& accessor = model.accessors[accessor_idx];
+    return (accessor.bufferView >= 0) && (accessor.bufferView < static_cast<int>(model.bufferViews.size()));
+}
+
+} // namespace
+
 megamol::mesh::GlTFFileLoader::GlTFFileLoader()
     : core::Module()
     , m_glTFFilename_slot("glTF filename", "The name of the gltf file to load")
@@ -23,6 +94,8 @@ megamol::mesh::GlTFFileLoader::GlTFFileLoader()
     //, m_gltf_cached_hash(0)
     , m_mesh_slot("CallMeshData", "The slot providing access to internal mesh data")
     //, m_mesh_cached_hash(0) 
+    , m_data_hash(0)
+    , m_bbox(placeholder_bbox)
 {
     this->m_gltf_slot.SetCallback(CallGlTFData::ClassName(), "GetData", &GlTFFileLoader::getGltfDataCallback);
     this->m_gltf_slot.SetCallback(CallGlTFData::ClassName(), "GetMetaData", &GlTFFileLoader::getGltfMetaDataCallback);
@@ -60,12 +133,10 @@ bool megamol::mesh::GlTFFileLoader::getGltfMetaDataCallback(core::Call& caller)
     CallGlTFData* gltf_call = dynamic_cast<CallGlTFData*>(&caller);
     if (gltf_call == NULL) return false;
 
-    auto meta_data = gltf_call->getMetaData();
-
-    if (this->m_glTFFilename_slot.IsDirty()) {
-        meta_data.m_data_hash++;
-    }
+    checkAndLoadGltfModel();
 
+    auto meta_data = gltf_call->getMetaData();
+    meta_data.m_data_hash = this->m_data_hash;
     gltf_call->setMetaData(meta_data);
 
     return true; 
@@ -76,30 +147,75 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
     CallMesh* cm = dynamic_cast<CallMesh*>(&caller);
     if (cm == NULL) return false;
 
-    std::shared_ptr<MeshDataAccessCollection> mesh_collection(nullptr);
+    checkAndLoadGltfModel();
+
+    // while the model is loading, the placeholder bounding box and an empty collection are answered
+    auto meta_data = cm->getMetaData();
+    meta_data.m_data_hash = this->m_data_hash;
+    meta_data.m_bboxs.SetBoundingBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+    meta_data.m_bboxs.SetClipBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+    cm->setMetaData(meta_data);
+    cm->setData(m_mesh_collection);
+
+    return true;
+}
+
+bool megamol::mesh::GlTFFileLoader::getMeshMetaDataCallback(core::Call& caller) {
+
+    CallMesh* cm = dynamic_cast<CallMesh*>(&caller);
+    if (cm == NULL) return false;
+
+    checkAndLoadGltfModel();
+
+    auto meta_data = cm->getMetaData();
+    meta_data.m_frame_cnt = 1;
+    meta_data.m_data_hash = this->m_data_hash;
+    meta_data.m_bboxs.SetBoundingBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+    meta_data.m_bboxs.SetClipBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+    cm->setMetaData(meta_data);
+
+    return true;
+}
+
+void megamol::mesh::GlTFFileLoader::checkAndLoadGltfModel() {
+
+    if (this->m_glTFFilename_slot.IsDirty()) {
+        m_glTFFilename_slot.ResetDirty();
+
+        auto vislib_filename = m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value();
+        std::string filename(vislib_filename.PeekBuffer());
 
-    if (cm->getData() == nullptr) {
-        // no incoming mesh -> use your own mesh storage
-        mesh_collection = this->m_mesh_collection;
-        cm->setData(mesh_collection);
-    } else {
-        // incoming mesh -> use it (delete local?)
-        mesh_collection = cm->getData();
+        // a load still running for the previous file is waited for by the assignment
+        m_pending_model = std::async(std::launch::async, loadGltfModel, filename);
     }
 
+    if (m_pending_model.valid() &&
+        (m_pending_model.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+        m_gltf_model = m_pending_model.get();
+        buildMeshCollection();
+        ++m_data_hash;
+    }
+}
+
+void megamol::mesh::GlTFFileLoader::buildMeshCollection() {
+
+    // the collection only references the buffers of the model, so a new one is built for every model
+    m_mesh_collection = std::make_shared<MeshDataAccessCollection>();
+    m_bbox = placeholder_bbox;
+
+    auto model = m_gltf_model;
+    if (model == nullptr) return;
+
     std::array<float, 6> bbox;
 
     bbox[0] = std::numeric_limits<float>::max();
     bbox[1] = std::numeric_limits<float>::max();
     bbox[2] = std::numeric_limits<float>::max();
-    bbox[3] = std::numeric_limits<float>::min();
-    bbox[4] = std::numeric_limits<float>::min();
-    bbox[5] = std::numeric_limits<float>::min();
+    bbox[3] = std::numeric_limits<float>::lowest();
+    bbox[4] = std::numeric_limits<float>::lowest();
+    bbox[5] = std::numeric_limits<float>::lowest();
 
-    checkAndLoadGltfModel();
-    auto model = m_gltf_model;
-
-    if (model == nullptr) return false;
+    bool has_bbox = false;
 
     for (size_t mesh_idx = 0; mesh_idx < model->meshes.size(); mesh_idx++) {
 
@@ -107,10 +223,14 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
 
         for (size_t primitive_idx = 0; primitive_idx < primitive_cnt; ++primitive_idx) {
 
+            auto const& primitive = model->meshes[mesh_idx].primitives[primitive_idx];
+
             std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
             MeshDataAccessCollection::IndexData mesh_indices;
 
-            auto& indices_accessor = model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].indices];
+            if (!hasBufferData(*model, primitive.indices)) continue;
+
+            auto& indices_accessor = model->accessors[primitive.indices];
             auto& indices_bufferView = model->bufferViews[indices_accessor.bufferView];
             auto& indices_buffer = model->buffers[indices_bufferView.buffer];
 
@@ -119,8 +239,10 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
                 indices_buffer.data.data() + indices_bufferView.byteOffset + indices_accessor.byteOffset);
             mesh_indices.type = MeshDataAccessCollection::covertToValueType(indices_accessor.componentType);
 
-            auto& vertex_attributes = model->meshes[mesh_idx].primitives[primitive_idx].attributes;
+            auto& vertex_attributes = primitive.attributes;
             for (auto attrib : vertex_attributes) {
+                if (!hasBufferData(*model, attrib.second)) continue;
+
                 auto& vertexAttrib_accessor = model->accessors[attrib.second];
                 auto& vertexAttrib_bufferView = model->bufferViews[vertexAttrib_accessor.bufferView];
                 auto& vertexAttrib_buffer = model->buffers[vertexAttrib_bufferView.buffer];
@@ -153,15 +275,13 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
                 );
             }
 
-            mesh_collection->addMesh(mesh_attributes, mesh_indices);
+            m_mesh_collection->addMesh(mesh_attributes, mesh_indices);
 
-
-            auto max_data =
-                model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
-                    .maxValues;
-            auto min_data =
-                model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
-                    .minValues;
+            auto position = primitive.attributes.find("POSITION");
+            if (position == primitive.attributes.end()) continue;
+            auto const& max_data = model->accessors[position->second].maxValues;
+            auto const& min_data = model->accessors[position->second].minValues;
+            if ((min_data.size() < 3) || (max_data.size() < 3)) continue;
 
             bbox[0] = std::min(bbox[0], static_cast<float>(min_data[0]));
             bbox[1] = std::min(bbox[1], static_cast<float>(min_data[1]));
@@ -169,59 +289,17 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
             bbox[3] = std::max(bbox[3], static_cast<float>(max_data[0]));
             bbox[4] = std::max(bbox[4], static_cast<float>(max_data[1]));
             bbox[5] = std::max(bbox[5], static_cast<float>(max_data[2]));
+            has_bbox = true;
         }
     }
 
-    auto meta_data = cm->getMetaData();
-    meta_data.m_bboxs.SetBoundingBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
-    meta_data.m_bboxs.SetClipBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
-    cm->setMetaData(meta_data);
-    cm->setData(m_mesh_collection);
-
-    return true;
-}
-
-bool megamol::mesh::GlTFFileLoader::getMeshMetaDataCallback(core::Call& caller) {
-
-    CallMesh* cm = dynamic_cast<CallMesh*>(&caller);
-    if (cm == NULL) return false;
-
-    auto meta_data = cm->getMetaData();
-    meta_data.m_frame_cnt = 1;
-
-    if (this->m_glTFFilename_slot.IsDirty()) {
-        meta_data.m_data_hash++;
-    }
-
-    cm->setMetaData(meta_data);
-
-    return true;
-}
-
-void megamol::mesh::GlTFFileLoader::checkAndLoadGltfModel() {
-
-    if (this->m_glTFFilename_slot.IsDirty()) {
-        m_glTFFilename_slot.ResetDirty();
-
-        auto vislib_filename = m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value();
-        std::string filename(vislib_filename.PeekBuffer());
-
-        m_gltf_model = std::make_shared<tinygltf::Model>();
-        tinygltf::TinyGLTF loader;
-        std::string err;
-        std::string war;
-
-        bool ret = loader.LoadASCIIFromFile(&*m_gltf_model, &err, &war, filename);
-        if (!err.empty()) {
-            vislib::sys::Log::DefaultLog.WriteError("Err: %s\n", err.c_str());
-        }
-
-        if (!ret) {
-            vislib::sys::Log::DefaultLog.WriteError("Failed to parse glTF\n");
-        }
+    if (has_bbox) {
+        m_bbox = bbox;
     }
 }
 
 void megamol::mesh::GlTFFileLoader::release() {
-    // intentionally empty ?
+    if (m_pending_model.valid()) {
+        m_pending_model.wait();
+    }
 }
@@ -8,6 +8,9 @@
 #ifndef GLTF_FILE_LOADER_H_INCLUDED
 #define GLTF_FILE_LOADER_H_INCLUDED
 
+#include <array>
+#include <future>
+
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
 
@@ -72,11 +75,29 @@ protected:
 
     bool getMeshMetaDataCallback(core::Call& caller);
 
+    /**
+     * Starts loading the model in the background if the file name changed,
+     * and takes over the model once it has been loaded.
+     */
     void checkAndLoadGltfModel();
 
+    /**
+     * Builds the mesh collection and the bounding box of the current model.
+     */
+    void buildMeshCollection();
+
 private:
     std::shared_ptr<tinygltf::Model> m_gltf_model;
 
+    /** The model being loaded in the background */
+    std::future<std::shared_ptr<tinygltf::Model>> m_pending_model;
+
+    /** The hash of the current model, incremented whenever a model has been loaded */
+    size_t m_data_hash;
+
+    /** The bounding box of the current model, a placeholder while none is loaded */
+    std::array<float, 6> m_bbox;
+
     std::shared_ptr<MeshDataAccessCollection> m_mesh_collection;
 
     /** The gltf file name */
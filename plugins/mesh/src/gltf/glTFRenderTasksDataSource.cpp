@@ -1,5 +1,7 @@
 #include "stdafx.h"
 
+#include <array>
+
 #include "glTFRenderTasksDataSource.h"
 #include "tiny_gltf.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
@@ -131,6 +133,25 @@ bool megamol::mesh::GlTFRenderTasksDataSource::getDataCallback(core::Call & call
 						object_transform);
 
                     m_rt_collection_indices.push_back(rt_idx);
+
+                    // glTF requires min and max of positions, which give the culling bounds of the primitive
+                    auto const& primitive = model->meshes[model->nodes[node_idx].mesh].primitives[primitive_idx];
+                    auto const position = primitive.attributes.find("POSITION");
+                    if (position != primitive.attributes.end()) {
+                        auto const& accessor = model->accessors[position->second];
+                        if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3) {
+                            std::array<GPURenderTaskCollection::DrawBounds, 1> bounds = {};
+                            for (int i = 0; i < 3; ++i) {
+                                // the object transform only holds the translation
+                                bounds[0].lower[i] = static_cast<float>(accessor.minValues[i]) +
+                                                     object_transform.GetAt(i, 3);
+                                bounds[0].upper[i] = static_cast<float>(accessor.maxValues[i]) +
+                                                     object_transform.GetAt(i, 3);
+                            }
+                            bounds[0].lower[3] = 1.0f;
+                            rt_collection->updateDrawBounds(rt_idx, bounds);
+                        }
+                    }
 				}
 			}
 		}
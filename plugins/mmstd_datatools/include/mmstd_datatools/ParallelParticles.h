@@ -0,0 +1,119 @@
+/*
+ * ParallelParticles.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#ifndef MEGAMOL_DATATOOLS_PARALLELPARTICLES_H_INCLUDED
+#define MEGAMOL_DATATOOLS_PARALLELPARTICLES_H_INCLUDED
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "mmstd_datatools/mmstd_datatools.h"
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /** A range [begin, end) of particles of one list of a MultiParticleDataCall */
+    struct ParticleChunk {
+        unsigned int list;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /**
+     * Splits all particle lists of a call into chunks, such that small lists
+     * and long ones are processed in parallel alike.
+     *
+     * @param data The particle data
+     * @param chunkSize The maximum number of particles per chunk
+     *
+     * @return The chunks, ordered by list and particle index
+     */
+    MMSTD_DATATOOLS_API std::vector<ParticleChunk> SplitParticleChunks(
+        core::moldyn::MultiParticleDataCall& data, uint64_t chunkSize = 1 << 16);
+
+    /**
+     * Calls func(index, chunk) for all chunks in parallel. func must only
+     * read the particle data of the call.
+     *
+     * @param chunks The chunks as answered by SplitParticleChunks
+     * @param func The function processing a chunk
+     */
+    template <class F> void ParallelForChunks(const std::vector<ParticleChunk>& chunks, F func) {
+        const int cnt = static_cast<int>(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < cnt; ++i) {
+            func(static_cast<size_t>(i), chunks[i]);
+        }
+    }
+
+    /** Statistics of the colour index values (COLDATA_FLOAT_I and COLDATA_DOUBLE_I) of all lists */
+    struct ColourIndexStatistics {
+        /** The number of colour index values */
+        uint64_t count = 0;
+
+        /** The smallest value, meaningful only if count > 0 */
+        float minValue = 0.0f;
+
+        /** The largest value, meaningful only if count > 0 */
+        float maxValue = 0.0f;
+
+        /** The number of values in equally sized bins over [minValue, maxValue], if requested */
+        std::vector<uint64_t> histogram;
+    };
+
+    /**
+     * Computes the statistics of the colour index values of all lists in
+     * parallel.
+     *
+     * @param data The particle data
+     * @param bins The number of histogram bins, zero for no histogram
+     *
+     * @return The statistics
+     */
+    MMSTD_DATATOOLS_API ColourIndexStatistics ComputeColourIndexStatistics(
+        core::moldyn::MultiParticleDataCall& data, unsigned int bins = 0);
+
+    /**
+     * Keeps the colour index statistics of the data seen last, such that
+     * they are only recomputed if the data hash or the frame changes. Data
+     * with hash zero is always recomputed.
+     */
+    class MMSTD_DATATOOLS_API ColourIndexStatisticsCache {
+    public:
+        /**
+         * Ctor.
+         *
+         * @param bins The number of histogram bins, zero for no histogram
+         */
+        ColourIndexStatisticsCache(unsigned int bins = 0);
+
+        /**
+         * Answer the statistics of the data, computing them if necessary.
+         *
+         * @param data The particle data
+         *
+         * @return The statistics
+         */
+        const ColourIndexStatistics& Get(core::moldyn::MultiParticleDataCall& data);
+
+        /** Forces the statistics to be recomputed on the next request */
+        inline void Invalidate(void) { this->valid = false; }
+
+    private:
+        unsigned int bins;
+        bool valid;
+        size_t hash;
+        unsigned int frameID;
+        ColourIndexStatistics stats;
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_DATATOOLS_PARALLELPARTICLES_H_INCLUDED */
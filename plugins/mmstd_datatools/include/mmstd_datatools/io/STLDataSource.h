@@ -128,18 +128,38 @@ private:
     /// <summary>
     /// Read a binary file
     /// </summary>
-    /// <param name="filename">File name of the STL file</param>
-    void read_binary(const std::string& filename);
+    /// <param name="content">Content of the STL file</param>
+    void read_binary(const std::vector<char>& content);
 
     /// <summary>
-    /// Read a textual file
+    /// Read a textual file, parsing chunks of facets in parallel
     /// </summary>
-    /// <param name="filename">File name of the STL file</param>
-    void read_ascii(const std::string& filename);
+    /// <param name="content">Content of the STL file</param>
+    void read_ascii(const std::vector<char>& content);
+
+    /// <summary>
+    /// Parse the facets of a textual file, starting after the solid name or at a keyword 'facet'
+    /// </summary>
+    /// <param name="begin">Begin of the text</param>
+    /// <param name="end">End of the text</param>
+    /// <param name="name">Solid name</param>
+    /// <param name="vertices">Output vertices</param>
+    /// <param name="normals">Output normals, one per vertex</param>
+    /// <returns>State of the parser at the end of the text, or EXPECT_SOLID if there is text after the solid</returns>
+    parser_states_t parse_ascii(const char* begin, const char* end, const std::string& name,
+        std::vector<float>& vertices, std::vector<float>& normals) const;
+
+    /// <summary>
+    /// Merge vertices at identical positions, creating an indexed mesh with averaged normals
+    /// </summary>
+    void weld_vertices();
 
     /// File name
     core::param::ParamSlot filename_slot;
 
+    /// Merge vertices at identical positions
+    core::param::ParamSlot weld_slot;
+
     /// Mesh data
     geocalls::CallTriMeshData::Mesh mesh;
 
@@ -13,8 +13,11 @@
 #include "mmcore/AbstractGetDataCall.h"
 #include "vislib/String.h"
 #include "mmcore/factories/CallAutoDescription.h"
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <type_traits>
+#include <vector>
 #include "vislib/macro_utils.h"
 
 namespace megamol {
@@ -28,6 +31,14 @@ namespace table {
 	 * Tabular data is composed from cells that are subdivided into columns and rows.
 	 * Cells are expected to be stored in a consecutive row-major format 
 	 * (until the shitty API no longer provides unsafe pointer access).
+	 *
+	 * Alternatively, the table can be set as individual columns via SetColumns,
+	 * each with its own buffer, stride and storage type, such that filters can
+	 * pass unchanged columns through by reference. Columns can also gather
+	 * their cells through a row index, such that joins can reference their
+	 * inputs instead of copying them. GetColumn answers a column
+	 * in either layout. Consumers using the row-major accessors on such a
+	 * table get a row-major float copy, which the call creates on demand.
 	 */
     class MMSTD_DATATOOLS_API TableDataCall : public core::AbstractGetDataCall {
     public:
@@ -85,6 +96,39 @@ namespace table {
             float maxVal;
         };
 
+        /** Storage type of the cells of a column */
+        enum class ColumnStorage {
+            FLOAT,
+            INT32,
+            UINT8
+        };
+
+        /** Reference to the cells of a column */
+        struct ColumnData {
+            /** Row index of cells missing in a gathered column, which read as NaN */
+            static constexpr uint64_t MissingRow = std::numeric_limits<uint64_t>::max();
+
+            ColumnStorage storage;
+            const void* data;
+            size_t stride; // distance of consecutive cells in elements
+            const uint64_t* rows = nullptr; // if set, row r is the cell rows[r] of data
+
+            inline float Get(size_t row) const {
+                if (rows != nullptr) {
+                    if (rows[row] == MissingRow) return std::numeric_limits<float>::quiet_NaN();
+                    row = static_cast<size_t>(rows[row]);
+                }
+                switch (storage) {
+                case ColumnStorage::INT32:
+                    return static_cast<float>(static_cast<const int32_t*>(data)[row * stride]);
+                case ColumnStorage::UINT8:
+                    return static_cast<float>(static_cast<const uint8_t*>(data)[row * stride]);
+                default:
+                    return static_cast<const float*>(data)[row * stride];
+                }
+            }
+        };
+
         TableDataCall(void);
         virtual ~TableDataCall(void);
 
@@ -101,13 +145,14 @@ namespace table {
         }
 
         inline const float* GetData(void) const {
+            if (column_data != nullptr) return materialize();
             return data;
         }
 
         inline const float* GetData(size_t row) const {
             assert(row >= 0);
             assert(row < rows_count);
-            return data + row * columns_count;
+            return GetData() + row * columns_count;
         }
 
         inline float GetData(size_t col, size_t row) const {
@@ -115,14 +160,45 @@ namespace table {
             assert(col < columns_count);
             assert(row >= 0);
             assert(row < rows_count);
+            if (column_data != nullptr) return column_data[col].Get(row);
             return data[col + row * columns_count];
         }
 
+        /** Answer whether the table has been set as individual columns */
+        inline bool IsColumnMajor(void) const {
+            return column_data != nullptr;
+        }
+
+        /**
+         * Answer the cells of a column, for either layout. For row-major tables,
+         * this is a float column with a stride of the column count.
+         */
+        inline ColumnData GetColumn(size_t col) const {
+            assert(col < columns_count);
+            if (column_data != nullptr) return column_data[col];
+            return ColumnData{ColumnStorage::FLOAT, data + col, columns_count};
+        }
+
         inline void Set(size_t col_cnt, size_t row_cnt, const ColumnInfo* info, const float* d) {
             columns_count = col_cnt;
             rows_count = row_cnt;
             columns = info;
             data = d;
+            column_data = nullptr;
+            row_major.clear();
+        }
+
+        /**
+         * Sets the table as individual columns. The call does not own the
+         * column references nor the cells.
+         */
+        inline void SetColumns(size_t col_cnt, size_t row_cnt, const ColumnInfo* info, const ColumnData* cols) {
+            columns_count = col_cnt;
+            rows_count = row_cnt;
+            columns = info;
+            data = nullptr;
+            column_data = cols;
+            row_major.clear();
         }
         
         inline size_t GetFirstCategoricalColumnIndex() const {
@@ -155,7 +231,7 @@ namespace table {
 			for (int c = 0; c < columns_count; ++c) {
                 const auto& column = columns[c];
                 for (int r = 0; r < rows_count; ++r) {
-                    float cell = data[r * columns_count + c];
+                    float cell = GetData(c, r);
                     assert(cell > column.MaximumValue() && "Value beyond maximum found");
 					assert(cell < column.MinimumValue() && "Value beyond maximum found");
 				}
@@ -163,10 +239,16 @@ namespace table {
 		}
 
     private:
+        /** Creates the row-major copy of a column-major table */
+        const float* materialize(void) const;
+
         size_t columns_count;
         size_t rows_count;
         const ColumnInfo *columns;
         const float *data; // data is stored row major order, aka array of structs
+        const ColumnData *column_data; // or as individual columns
+        VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        mutable std::vector<float> row_major; // row-major copy of column_data
         unsigned int frameCount;
         unsigned int frameID;
     };
@@ -4,6 +4,7 @@
 #include <type_traits>
 
 #include "mmstd_datatools/AbstractManipulator.h"
+#include "ParticleFilterFlags.h"
 
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/param/ParamSlot.h"
@@ -84,6 +85,16 @@ private:
 
     core::param::ParamSlot boxSlot_;
 
+    /** Optional output of the filter result as flags */
+    ParticleFilterFlags flags_;
+
+    /** The particles inside the box for the flag output */
+    std::vector<std::vector<char>> keep_;
+
+    /** The data the flags were computed for */
+    size_t flagsHash_;
+    unsigned int flagsFrameID_;
+
     std::vector<std::vector<char>> data_;
 
     std::vector<size_t> numPts_;
@@ -95,9 +106,15 @@ private:
 template <class T>
 AbstractParticleBoxFilter<T>::AbstractParticleBoxFilter()
     : AbstractManipulator<T>("dataIn", "dataOut")
-    , boxSlot_("box", "Box definition for the Box Filter (minx, miny, minz, maxx, maxy, maxz)") {
+    , boxSlot_("box", "Box definition for the Box Filter (minx, miny, minz, maxx, maxy, maxz)")
+    , flags_()
+    , keep_()
+    , flagsHash_(0)
+    , flagsFrameID_(0) {
     boxSlot_ << new core::param::StringParam("0.0, 0.0, 0.0, 1.0, 1.0, 1.0");
     this->MakeSlotAvailable(&boxSlot_);
+
+    this->MakeSlotAvailable(&flags_.Slot());
 }
 
 
@@ -116,10 +133,47 @@ template <class T> bool AbstractParticleBoxFilter<T>::manipulateData(T& outData,
     numPts_.clear();
     stride_.clear();
 
-    // TODO This assumes the data to be interleaved
-
     auto const plc = outData.GetParticleListCount();
 
+    if (flags_.IsConnected()) {
+        // pass the particles on untouched and only mark the ones outside of the box
+        bool const changed = boxSlot_.IsDirty() || (inData.DataHash() != flagsHash_) ||
+                             (inData.FrameID() != flagsFrameID_) || (inData.DataHash() == 0);
+        if (changed) {
+            boxSlot_.ResetDirty();
+            flagsHash_ = inData.DataHash();
+            flagsFrameID_ = inData.FrameID();
+
+            keep_.resize(plc);
+            for (unsigned int plidx = 0; plidx < plc; ++plidx) {
+                auto& part = outData.AccessParticles(plidx);
+                if (part.GetVertexDataType() == core::moldyn::SimpleSphericalParticles::VERTDATA_NONE) {
+                    keep_[plidx].clear();
+                    continue;
+                }
+
+                auto const pcount = static_cast<INT64>(part.GetCount());
+                auto& keep = keep_[plidx];
+                keep.resize(static_cast<size_t>(pcount));
+
+                auto const& store = part.GetParticleStore();
+                auto const& xacc = store.GetXAcc();
+                auto const& yacc = store.GetYAcc();
+                auto const& zacc = store.GetZAcc();
+
+#pragma omp parallel for
+                for (INT64 pidx = 0; pidx < pcount; ++pidx) {
+                    vislib::math::Point<float, 3> pt(xacc->Get_f(pidx), yacc->Get_f(pidx), zacc->Get_f(pidx));
+                    keep[pidx] = box.Contains(pt, true) ? 1 : 0;
+                }
+            }
+        }
+        flags_.Write(outData, keep_, changed);
+        return true;
+    }
+
+    // TODO This assumes the data to be interleaved
+
     data_.resize(plc);
     numPts_.resize(plc, 0);
     stride_.resize(plc, 0);
@@ -0,0 +1,66 @@
+/*
+ * AffineTransform.h
+ *
+ * Copyright (C) 2019 MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /**
+     * Extracts the affine part of a 4x4 matrix.
+     *
+     * @param m The matrix, a vislib::math::Matrix or anything with GetAt(row, col)
+     * @param rows Receives the upper three rows of 'm', row by row
+     */
+    template<class M> inline void AffineRows(const M& m, float (&rows)[12]) {
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                rows[4 * r + c] = static_cast<float>(m.GetAt(r, c));
+            }
+        }
+    }
+
+    /**
+     * Applies an affine transformation to interleaved positions, in parallel.
+     *
+     * The inner loop is plain arithmetic on local values, so the compiler can
+     * keep the matrix in registers and vectorise it for the target.
+     *
+     * @param rows The affine transformation, see AffineRows
+     * @param src The first position, three consecutive values of type 'T'
+     * @param srcStride The distance between two positions in bytes
+     * @param dst The first output position, three consecutive floats
+     * @param dstStride The distance between two output positions in floats
+     * @param cnt The number of positions
+     */
+    template<class T> inline void TransformPositions(const float (&rows)[12], const void* src, size_t srcStride,
+            float* dst, size_t dstStride, int64_t cnt) {
+        const float m00 = rows[0], m01 = rows[1], m02 = rows[2], m03 = rows[3];
+        const float m10 = rows[4], m11 = rows[5], m12 = rows[6], m13 = rows[7];
+        const float m20 = rows[8], m21 = rows[9], m22 = rows[10], m23 = rows[11];
+        const unsigned char* in = static_cast<const unsigned char*>(src);
+
+#pragma omp parallel for
+        for (int64_t i = 0; i < cnt; ++i) {
+            const T* p = reinterpret_cast<const T*>(in + i * srcStride);
+            const float x = static_cast<float>(p[0]);
+            const float y = static_cast<float>(p[1]);
+            const float z = static_cast<float>(p[2]);
+            float* o = dst + i * dstStride;
+            o[0] = m00 * x + m01 * y + m02 * z + m03;
+            o[1] = m10 * x + m11 * y + m12 * z + m13;
+            o[2] = m20 * x + m21 * y + m22 * z + m23;
+        }
+    }
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
@@ -35,11 +35,12 @@ stdplugin::datatools::CSVFileSequence::CSVFileSequence(void) : core::Module(),
         fileNumberStepSlot("fileNumberStep", "Slot for the file number increase step"),
         fileNameSlotNameSlot("fileNameSlotName", "The name of the data source file name parameter slot"),
         useClipBoxAsBBox("useClipBoxAsBBox", "If true will use the all-data clip box as bounding box"),
+        prefetchSlot("prefetchFiles", "The number of upcoming files read in the background (0 disables prefetching)"),
         outDataSlot("outData", "The slot for publishing data to the writer"),
         inDataSlot("inData", "The slot for requesting data from the source"),
         clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f), datahash(0),
         fileNameTemplate(_T("")), fileNumMin(0), fileNumMax(0), fileNumStep(1),
-        needDataUpdate(true), frameCnt(1), lastIdxRequested(0) {
+        needDataUpdate(true), frameCnt(1), lastIdxRequested(0), frameValid(), prefetcher() {
 
     this->fileNameTemplateSlot << new core::param::StringParam(this->fileNameTemplate);
     this->fileNameTemplateSlot.SetUpdateCallback(&CSVFileSequence::onFileNameTemplateChanged);
@@ -61,6 +62,9 @@ stdplugin::datatools::CSVFileSequence::CSVFileSequence(void) : core::Module(),
     this->useClipBoxAsBBox << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->useClipBoxAsBBox);
 
+    this->prefetchSlot << new core::param::IntParam(2, 0);
+    this->MakeSlotAvailable(&this->prefetchSlot);
+
     this->outDataSlot.SetCallback(
         table::TableDataCall::ClassName(), "GetData", &CSVFileSequence::getDataCallback);
     this->outDataSlot.SetCallback(
@@ -103,6 +107,7 @@ bool stdplugin::datatools::CSVFileSequence::create(void) {
  * CSVFileSequence::release
  */
 void stdplugin::datatools::CSVFileSequence::release(void) {
+    this->prefetcher.Request(std::vector<vislib::TString>(), 0);
 }
 
 
@@ -145,7 +150,8 @@ bool stdplugin::datatools::CSVFileSequence::getDataCallback(core::Call& caller)
         filename.Format(this->fileNameTemplate, idx);
         fnSlot->Parameter()->ParseValue(filename);
 
-        if (this->lastIdxRequested != pgdc->GetFrameID()) {
+        bool frameChanged = (this->lastIdxRequested != pgdc->GetFrameID());
+        if (frameChanged) {
             this->lastIdxRequested = pgdc->GetFrameID();
             this->datahash++;
         }
@@ -166,6 +172,8 @@ bool stdplugin::datatools::CSVFileSequence::getDataCallback(core::Call& caller)
         pgdc->SetFrameID(frameID);
         pgdc->SetDataHash(this->datahash);
         pgdc->SetFrameCount(this->frameCnt);
+
+        if (frameChanged) this->prefetch(frameID);
     }
 
     return true;
@@ -195,20 +203,25 @@ bool stdplugin::datatools::CSVFileSequence::getExtentCallback(core::Call& caller
         pgdc->SetFrameCount(1);
 
     } else {
-        vislib::TString filename;
-
-        unsigned int idx = this->fileNumMin + this->fileNumStep * pgdc->GetFrameID();
-        filename.Format(this->fileNameTemplate, idx);
-        fnSlot->Parameter()->ParseValue(filename);
-
-        if (this->lastIdxRequested != pgdc->GetFrameID()) {
-            this->lastIdxRequested = pgdc->GetFrameID();
+        unsigned int frameID = pgdc->GetFrameID();
+        if (this->lastIdxRequested != frameID) {
+            this->lastIdxRequested = frameID;
             this->datahash++;
         }
 
-        ggdc->SetFrameID(pgdc->GetFrameID());
-        if (!(*ggdc)(1)) {
-            return false; // unable to get data
+        // the source is only asked once per frame whether the file can be read
+        if ((frameID >= this->frameValid.size()) || !this->frameValid[frameID]) {
+            vislib::TString filename;
+
+            unsigned int idx = this->fileNumMin + this->fileNumStep * frameID;
+            filename.Format(this->fileNameTemplate, idx);
+            fnSlot->Parameter()->ParseValue(filename);
+
+            ggdc->SetFrameID(frameID);
+            if (!(*ggdc)(1)) {
+                return false; // unable to get data
+            }
+            if (frameID < this->frameValid.size()) this->frameValid[frameID] = true;
         }
 
         pgdc->SetFrameID(pgdc->GetFrameID());
@@ -472,6 +485,8 @@ void stdplugin::datatools::CSVFileSequence::assertData(void) {
 
     this->frameCnt = 0;
     this->clipbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
+    this->frameValid.clear();
+    this->prefetcher.Clear();
 
     core::param::ParamSlot *fnSlot = this->findFileNameSlot();
     if (fnSlot == NULL) {
@@ -499,6 +514,7 @@ void stdplugin::datatools::CSVFileSequence::assertData(void) {
             "CSVFileSequence: No data files found");
         return;
     }
+    this->frameValid.assign(this->frameCnt, false);
 
     // collect heuristic approach for clipping box
     filename.Format(this->fileNameTemplate, this->fileNumMin);
@@ -509,7 +525,26 @@ void stdplugin::datatools::CSVFileSequence::assertData(void) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "CSVFileSequence: Unable to clipping box of file %u (#1)", this->fileNumMin);
         return;
     }
+    this->frameValid[0] = true;
 
     this->datahash++;
 
 }
+
+
+/*
+ * CSVFileSequence::prefetch
+ */
+void stdplugin::datatools::CSVFileSequence::prefetch(unsigned int frameID) {
+    unsigned int cnt = static_cast<unsigned int>(vislib::math::Max(0,
+        this->prefetchSlot.Param<core::param::IntParam>()->Value()));
+    std::vector<vislib::TString> files;
+    vislib::TString filename;
+    for (unsigned int i = 1; (i <= cnt) && (i < this->frameCnt); ++i) {
+        // playback wraps around at the end of the sequence
+        unsigned int idx = this->fileNumMin + this->fileNumStep * ((frameID + i) % this->frameCnt);
+        filename.Format(this->fileNameTemplate, idx);
+        files.push_back(filename);
+    }
+    this->prefetcher.Request(files, vislib::math::Min(cnt, 2u));
+}
@@ -13,6 +13,8 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
 #include "vislib/math/Cuboid.h"
+#include "FileSequencePrefetcher.h"
+#include <vector>
 
 
 namespace megamol {
@@ -148,6 +150,13 @@ namespace datatools {
          */
         void assertData(void);
 
+        /**
+         * Starts reading the files of the frames following 'frameID'
+         *
+         * @param frameID The frame currently requested
+         */
+        void prefetch(unsigned int frameID);
+
         /** The file name template */
         core::param::ParamSlot fileNameTemplateSlot;
 
@@ -166,6 +175,9 @@ namespace datatools {
         /** Flag controlling the bounding box */
         core::param::ParamSlot useClipBoxAsBBox;
 
+        /** The number of upcoming files read in the background */
+        core::param::ParamSlot prefetchSlot;
+
         /** The slot for publishing data to the writer */
         core::CalleeSlot outDataSlot;
 
@@ -199,6 +211,12 @@ namespace datatools {
         /** The last frame index requested */
         unsigned int lastIdxRequested;
 
+        /** Flags marking the frames whose hash has been requested successfully */
+        std::vector<bool> frameValid;
+
+        /** Reads the upcoming files in the background */
+        FileSequencePrefetcher prefetcher;
+
     };
 
 } /* end namespace datatools */
@@ -35,11 +35,12 @@ stdplugin::datatools::DataFileSequence::DataFileSequence(void) : core::Module(),
         fileNumberStepSlot("fileNumberStep", "Slot for the file number increase step"),
         fileNameSlotNameSlot("fileNameSlotName", "The name of the data source file name parameter slot"),
         useClipBoxAsBBox("useClipBoxAsBBox", "If true will use the all-data clip box as bounding box"),
+        prefetchSlot("prefetchFiles", "The number of upcoming files read in the background (0 disables prefetching)"),
         outDataSlot("outData", "The slot for publishing data to the writer"),
         inDataSlot("inData", "The slot for requesting data from the source"),
         clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f), datahash(0),
         fileNameTemplate(_T("")), fileNumMin(0), fileNumMax(0), fileNumStep(1),
-        needDataUpdate(true), frameCnt(1), lastIdxRequested(0) {
+        needDataUpdate(true), frameCnt(1), lastIdxRequested(0), frameBBoxes(), frameBBoxValid(), prefetcher() {
 
     this->fileNameTemplateSlot << new core::param::StringParam(this->fileNameTemplate);
     this->fileNameTemplateSlot.SetUpdateCallback(&DataFileSequence::onFileNameTemplateChanged);
@@ -61,6 +62,9 @@ stdplugin::datatools::DataFileSequence::DataFileSequence(void) : core::Module(),
     this->useClipBoxAsBBox << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->useClipBoxAsBBox);
 
+    this->prefetchSlot << new core::param::IntParam(2, 0);
+    this->MakeSlotAvailable(&this->prefetchSlot);
+
     //core::CallDescriptionManager::DescriptionIterator iter(core::CallDescriptionManager::Instance()->GetIterator());
     //const core::CallDescription *cd = NULL;
     //while ((cd = this->moveToNextCompatibleCall(iter)) != NULL) {
@@ -102,6 +106,7 @@ bool stdplugin::datatools::DataFileSequence::create(void) {
  * moldyn::DataFileSequence::release
  */
 void stdplugin::datatools::DataFileSequence::release(void) {
+    this->prefetcher.Request(std::vector<vislib::TString>(), 0);
 }
 
 
@@ -144,7 +149,8 @@ bool stdplugin::datatools::DataFileSequence::getDataCallback(core::Call& caller)
         filename.Format(this->fileNameTemplate, idx);
         fnSlot->Parameter()->ParseValue(filename);
 
-        if (this->lastIdxRequested != pgdc->FrameID()) {
+        bool frameChanged = (this->lastIdxRequested != pgdc->FrameID());
+        if (frameChanged) {
             this->lastIdxRequested = pgdc->FrameID();
             this->datahash++;
         }
@@ -164,6 +170,8 @@ bool stdplugin::datatools::DataFileSequence::getDataCallback(core::Call& caller)
 
         pgdc->SetFrameID(frameID, true);
         pgdc->SetDataHash(this->datahash);
+
+        if (frameChanged) this->prefetch(frameID);
     }
 
     return true;
@@ -198,24 +206,35 @@ bool stdplugin::datatools::DataFileSequence::getExtentCallback(core::Call& calle
         pgdc->SetFrameCount(1);
 
     } else {
-        vislib::TString filename;
-
-        unsigned int idx = this->fileNumMin + this->fileNumStep * pgdc->FrameID();
-        filename.Format(this->fileNameTemplate, idx);
-        fnSlot->Parameter()->ParseValue(filename);
-
-        if (this->lastIdxRequested != pgdc->FrameID()) {
-            this->lastIdxRequested = pgdc->FrameID();
+        unsigned int frameID = pgdc->FrameID();
+        if (this->lastIdxRequested != frameID) {
+            this->lastIdxRequested = frameID;
             this->datahash++;
         }
 
-        ggdc->SetFrameID(pgdc->FrameID(), pgdc->IsFrameForced());
-        if (!(*ggdc)(1)) {
-            return false; // unable to get data
+        // the extents of a frame are only requested from the source once
+        bool cached = (frameID < this->frameBBoxValid.size()) && this->frameBBoxValid[frameID];
+        if (!cached) {
+            vislib::TString filename;
+
+            unsigned int idx = this->fileNumMin + this->fileNumStep * frameID;
+            filename.Format(this->fileNameTemplate, idx);
+            fnSlot->Parameter()->ParseValue(filename);
+
+            ggdc->SetFrameID(frameID, pgdc->IsFrameForced());
+            if (!(*ggdc)(1)) {
+                return false; // unable to get data
+            }
+            if (frameID < this->frameBBoxValid.size()) {
+                this->frameBBoxes[frameID] = ggdc->AccessBoundingBoxes().ObjectSpaceBBox();
+                this->frameBBoxValid[frameID] = true;
+            }
         }
 
         if (this->useClipBoxAsBBox.Param<core::param::BoolParam>()->Value()) {
             pgdc->AccessBoundingBoxes().SetObjectSpaceBBox(this->clipbox);
+        } else if (cached) {
+            pgdc->AccessBoundingBoxes().SetObjectSpaceBBox(this->frameBBoxes[frameID]);
         } else {
             pgdc->AccessBoundingBoxes().SetObjectSpaceBBox(ggdc->AccessBoundingBoxes().ObjectSpaceBBox());
         }
@@ -498,6 +517,9 @@ void stdplugin::datatools::DataFileSequence::assertData(void) {
 
     this->frameCnt = 0;
     this->clipbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
+    this->frameBBoxes.clear();
+    this->frameBBoxValid.clear();
+    this->prefetcher.Clear();
 
     core::param::ParamSlot *fnSlot = this->findFileNameSlot();
     if (fnSlot == NULL) {
@@ -525,6 +547,8 @@ void stdplugin::datatools::DataFileSequence::assertData(void) {
             "DataFileSequence: No data files found");
         return;
     }
+    this->frameBBoxes.resize(this->frameCnt);
+    this->frameBBoxValid.assign(this->frameCnt, false);
 
     // collect heuristic approach for clipping box
     filename.Format(this->fileNameTemplate, this->fileNumMin);
@@ -536,6 +560,8 @@ void stdplugin::datatools::DataFileSequence::assertData(void) {
         return;
     }
     this->clipbox = gdc->AccessBoundingBoxes().ClipBox();
+    this->frameBBoxes[0] = gdc->AccessBoundingBoxes().ObjectSpaceBBox();
+    this->frameBBoxValid[0] = true;
 
     if (this->frameCnt > 1) {
         unsigned int idx = this->fileNumMin + this->fileNumStep * (this->frameCnt - 1);
@@ -548,6 +574,8 @@ void stdplugin::datatools::DataFileSequence::assertData(void) {
             return;
         }
         this->clipbox.Union(gdc->AccessBoundingBoxes().ClipBox());
+        this->frameBBoxes[this->frameCnt - 1] = gdc->AccessBoundingBoxes().ObjectSpaceBBox();
+        this->frameBBoxValid[this->frameCnt - 1] = true;
         if (this->frameCnt > 2) {
             idx = this->fileNumMin + this->fileNumStep * ((this->frameCnt - 1) / 2);
             filename.Format(this->fileNameTemplate, idx);
@@ -559,9 +587,29 @@ void stdplugin::datatools::DataFileSequence::assertData(void) {
                 return;
             }
             this->clipbox.Union(gdc->AccessBoundingBoxes().ClipBox());
+            this->frameBBoxes[(this->frameCnt - 1) / 2] = gdc->AccessBoundingBoxes().ObjectSpaceBBox();
+            this->frameBBoxValid[(this->frameCnt - 1) / 2] = true;
         }
     }
 
     this->datahash++;
 
 }
+
+
+/*
+ * moldyn::DataFileSequence::prefetch
+ */
+void stdplugin::datatools::DataFileSequence::prefetch(unsigned int frameID) {
+    unsigned int cnt = static_cast<unsigned int>(vislib::math::Max(0,
+        this->prefetchSlot.Param<core::param::IntParam>()->Value()));
+    std::vector<vislib::TString> files;
+    vislib::TString filename;
+    for (unsigned int i = 1; (i <= cnt) && (i < this->frameCnt); ++i) {
+        // playback wraps around at the end of the sequence
+        unsigned int idx = this->fileNumMin + this->fileNumStep * ((frameID + i) % this->frameCnt);
+        filename.Format(this->fileNameTemplate, idx);
+        files.push_back(filename);
+    }
+    this->prefetcher.Request(files, vislib::math::Min(cnt, 2u));
+}
@@ -17,6 +17,8 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
 #include "vislib/math/Cuboid.h"
+#include "FileSequencePrefetcher.h"
+#include <vector>
 
 
 namespace megamol {
@@ -162,6 +164,13 @@ namespace datatools {
          */
         void assertData(void);
 
+        /**
+         * Starts reading the files of the frames following 'frameID'
+         *
+         * @param frameID The frame currently requested
+         */
+        void prefetch(unsigned int frameID);
+
         /** The file name template */
         core::param::ParamSlot fileNameTemplateSlot;
 
@@ -180,6 +189,9 @@ namespace datatools {
         /** Flag controlling the bounding box */
         core::param::ParamSlot useClipBoxAsBBox;
 
+        /** The number of upcoming files read in the background */
+        core::param::ParamSlot prefetchSlot;
+
         /** The slot for publishing data to the writer */
         core::CalleeSlot outDataSlot;
 
@@ -213,6 +225,15 @@ namespace datatools {
         /** The last frame index requested */
         unsigned int lastIdxRequested;
 
+        /** The cached object space bounding boxes of the frames */
+        std::vector<vislib::math::Cuboid<float> > frameBBoxes;
+
+        /** Flags marking the frames with a cached bounding box */
+        std::vector<bool> frameBBoxValid;
+
+        /** Reads the upcoming files in the background */
+        FileSequencePrefetcher prefetcher;
+
     };
 
 } /* end namespace datatools */
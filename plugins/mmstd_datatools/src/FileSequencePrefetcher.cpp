@@ -0,0 +1,134 @@
+/*
+ * FileSequencePrefetcher.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "FileSequencePrefetcher.h"
+#include "vislib/sys/File.h"
+
+#include <algorithm>
+
+using namespace megamol;
+
+
+/** The number of files remembered as read */
+static const size_t maxDoneFiles = 64;
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::FileSequencePrefetcher
+ */
+stdplugin::datatools::FileSequencePrefetcher::FileSequencePrefetcher(void) : done(), lock(), pending(), quit(false),
+        wake(), workers() {
+    // intentionally empty
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::~FileSequencePrefetcher
+ */
+stdplugin::datatools::FileSequencePrefetcher::~FileSequencePrefetcher(void) {
+    this->stop();
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::Clear
+ */
+void stdplugin::datatools::FileSequencePrefetcher::Clear(void) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->pending.clear();
+    this->done.clear();
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::Request
+ */
+void stdplugin::datatools::FileSequencePrefetcher::Request(
+        const std::vector<vislib::TString>& files, unsigned int threads) {
+    this->resize(files.empty() ? 0 : threads);
+    if (this->workers.empty()) return;
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->pending.clear();
+        for (const auto& f : files) {
+            if (std::find(this->done.begin(), this->done.end(), f) == this->done.end()) {
+                this->pending.push_back(f);
+            }
+        }
+    }
+    this->wake.notify_all();
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::readFile
+ */
+void stdplugin::datatools::FileSequencePrefetcher::readFile(const vislib::TString& filename) {
+    vislib::sys::File file;
+    if (!file.Open(filename, vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+            vislib::sys::File::OPEN_ONLY)) {
+        return;
+    }
+    std::vector<char> buffer(4 * 1024 * 1024);
+    while (!this->quit && (file.Read(buffer.data(), buffer.size()) == buffer.size())) {
+        // only warms the file system cache
+    }
+    file.Close();
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::work
+ */
+void stdplugin::datatools::FileSequencePrefetcher::work(void) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    while (!this->quit) {
+        if (this->pending.empty()) {
+            this->wake.wait(guard);
+            continue;
+        }
+        vislib::TString filename = this->pending.front();
+        this->pending.pop_front();
+        this->done.push_back(filename);
+        if (this->done.size() > maxDoneFiles) this->done.pop_front();
+
+        guard.unlock();
+        this->readFile(filename);
+        guard.lock();
+    }
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::resize
+ */
+void stdplugin::datatools::FileSequencePrefetcher::resize(unsigned int threads) {
+    if (threads == this->workers.size()) return;
+    this->stop();
+    this->quit = false;
+    for (unsigned int i = 0; i < threads; ++i) {
+        this->workers.emplace_back(&FileSequencePrefetcher::work, this);
+    }
+}
+
+
+/*
+ * stdplugin::datatools::FileSequencePrefetcher::stop
+ */
+void stdplugin::datatools::FileSequencePrefetcher::stop(void) {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->quit = true;
+        this->pending.clear();
+    }
+    this->wake.notify_all();
+    for (auto& w : this->workers) {
+        w.join();
+    }
+    this->workers.clear();
+}
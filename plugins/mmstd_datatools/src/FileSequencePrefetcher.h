@@ -0,0 +1,96 @@
+/*
+ * FileSequencePrefetcher.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_DATATOOLS_FILESEQUENCEPREFETCHER_H_INCLUDED
+#define MEGAMOL_DATATOOLS_FILESEQUENCEPREFETCHER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "vislib/String.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+
+    /**
+     * Reads the files following the current time step of a file sequence in
+     * background threads, such that the wrapped loader finds them in the
+     * file system cache when the sequence switches to them.
+     */
+    class FileSequencePrefetcher {
+    public:
+
+        /** Ctor. */
+        FileSequencePrefetcher(void);
+
+        /** Dtor. Stops the worker threads. */
+        ~FileSequencePrefetcher(void);
+
+        /**
+         * Forgets all files read so far, e.g. after the file name template
+         * changed.
+         */
+        void Clear(void);
+
+        /**
+         * Replaces the files waiting to be read. Files which have already
+         * been read recently are skipped.
+         *
+         * @param files The upcoming files, the most urgent one first
+         * @param threads The number of worker threads to use
+         */
+        void Request(const std::vector<vislib::TString>& files, unsigned int threads);
+
+    private:
+
+        /** Reads one file completely, unless the workers are stopped */
+        void readFile(const vislib::TString& filename);
+
+        /** The body of the worker threads */
+        void work(void);
+
+        /** Starts or stops worker threads to match the requested number */
+        void resize(unsigned int threads);
+
+        /** Stops all worker threads */
+        void stop(void);
+
+        /** The files recently read or being read, oldest first */
+        std::deque<vislib::TString> done;
+
+        /** Guards all members */
+        std::mutex lock;
+
+        /** The files waiting to be read, the most urgent one first */
+        std::deque<vislib::TString> pending;
+
+        /** Flag telling the worker threads to exit */
+        std::atomic<bool> quit;
+
+        /** Signals new pending files or 'quit' */
+        std::condition_variable wake;
+
+        /** The worker threads */
+        std::vector<std::thread> workers;
+
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_DATATOOLS_FILESEQUENCEPREFETCHER_H_INCLUDED */
@@ -49,18 +49,23 @@ bool IColInverse::manipulateData(
             }
         }
 
+        // downstream modules may still hold the colours of the previous frame
+        if (!colors || (colors.use_count() > 1)) colors = std::make_shared<std::vector<float>>();
+
         stdplugin::datatools::MultiParticleDataAdaptor parts(inData);
-        colors.resize(parts.get_count());
+        colors->resize(parts.get_count());
         for (size_t i = 0; i < parts.get_count(); ++i) {
-            colors[i] = minCol + maxCol - parts.get_color(i)[0];
+            (*colors)[i] = minCol + maxCol - parts.get_color(i)[0];
         }
 
     }
     
-    const float *data = colors.data();
+    if (!colors) return true;
+    const float *data = colors->data();
     for (unsigned int list = 0; list < outData.GetParticleListCount(); ++list) {
         auto &plist = outData.AccessParticles(list);
-        plist.SetColourData(core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I, data, 0);
+        plist.SetColourData(core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I,
+            core::moldyn::SimpleSphericalParticles::SharedBuffer(colors, data), 0);
         plist.SetColourMapIndexValues(minCol, maxCol);
         data += plist.GetCount();
     }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "mmstd_datatools/AbstractParticleManipulator.h"
+#include <memory>
 #include <vector>
 
 namespace megamol {
@@ -31,7 +32,8 @@ namespace datatools {
     private:
         size_t dataHash;
         unsigned int frameID;
-        std::vector<float> colors;
+        /** The inverted colours, shared with the receivers of the data */
+        std::shared_ptr<std::vector<float>> colors;
         float minCol, maxCol;
 
     };
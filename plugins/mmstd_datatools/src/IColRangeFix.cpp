@@ -6,17 +6,14 @@
  */
 #include "stdafx.h"
 #include "IColRangeFix.h"
-#include "mmstd_datatools/MultiParticleDataAdaptor.h"
-#include "vislib/math/ShallowVector.h"
 #include <algorithm>
-#include "mmcore/param/FloatParam.h"
 
 using namespace megamol;
 using namespace megamol::stdplugin::datatools;
 
 
 IColRangeFix::IColRangeFix() : stdplugin::datatools::AbstractParticleManipulator("outData", "inDataA"),
-        hash(0), frameID(0), minCol(0.0f), maxCol(1.0f) {
+        stats() {
     // intentionally empty
 }
 
@@ -28,28 +25,9 @@ bool IColRangeFix::manipulateData(
         core::moldyn::MultiParticleDataCall& outData,
         core::moldyn::MultiParticleDataCall& inData) {
 
-    if ( (hash != inData.DataHash()) || (inData.DataHash() == 0)
-            || (frameID != inData.FrameID()) ) {
-        // Update data
-        hash = inData.DataHash();
-        frameID = inData.FrameID();
-
-        stdplugin::datatools::MultiParticleDataAdaptor d(inData);
-
-        if (d.get_count() > 0) {
-            minCol = maxCol = *d.get_color(0);
-            for (size_t i = 1; i < d.get_count(); ++i) {
-                float c = *d.get_color(i);
-                if (minCol > c) minCol = c;
-                if (maxCol < c) maxCol = c;
-            }
-
-        } else {
-            minCol = 0.0f;
-            maxCol = 1.0f;
-        }
-
-    }
+    const ColourIndexStatistics& st = this->stats.Get(inData);
+    const float minCol = (st.count > 0) ? st.minValue : 0.0f;
+    const float maxCol = (st.count > 0) ? st.maxValue : 1.0f;
 
     outData = inData;
     inData.SetUnlocker(nullptr, false);
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "mmstd_datatools/AbstractParticleManipulator.h"
+#include "mmstd_datatools/ParallelParticles.h"
 
 namespace megamol {
 namespace stdplugin {
@@ -28,9 +29,7 @@ namespace datatools {
             megamol::core::moldyn::MultiParticleDataCall& inData);
 
     private:
-        size_t hash;
-        unsigned int frameID;
-        float minCol, maxCol;
+        ColourIndexStatisticsCache stats;
     };
 
 }
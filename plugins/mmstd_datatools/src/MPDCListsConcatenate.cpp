@@ -9,6 +9,7 @@
 #include "MPDCListsConcatenate.h"
 
 #include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "mmcore/utility/CallGraphExecutor.h"
 
 
 megamol::stdplugin::datatools::MPDCListsConcatenate::MPDCListsConcatenate()
@@ -24,6 +25,8 @@ megamol::stdplugin::datatools::MPDCListsConcatenate::MPDCListsConcatenate()
 
     dataIn2Slot.SetCompatibleCall<core::moldyn::MultiParticleDataCallDescription>();
     MakeSlotAvailable(&dataIn2Slot);
+
+    setCallableFromWorkerThreads(true);
 }
 
 
@@ -61,9 +64,11 @@ bool megamol::stdplugin::datatools::MPDCListsConcatenate::getExtent(megamol::cor
         return true;
     }
 
-    // both calls are connected, so be smart!
-    if (!((*i1c)(1))) return false;
-    if (!((*i2c)(1))) return false;
+    // both calls are connected, so be smart and query independent inputs concurrently!
+    core::utility::CallGraphExecutor inputs;
+    inputs.Add(*i1c, 1);
+    inputs.Add(*i2c, 1);
+    if (!inputs.Run()) return false;
 
     auto const i1fc = i1c->FrameCount();
     auto const i2fc = i2c->FrameCount();
@@ -75,10 +80,8 @@ bool megamol::stdplugin::datatools::MPDCListsConcatenate::getExtent(megamol::cor
     if (reqFid >= minFc) reqFid = minFc - 1;
 
     i1c->SetFrameID(reqFid, oc->IsFrameForced());
-    if (!((*i1c)(1))) return false;
-
     i2c->SetFrameID(reqFid, oc->IsFrameForced());
-    if (!((*i2c)(1))) return false;
+    if (!inputs.Run()) return false;
 
     vislib::math::Cuboid<float> osbb(i1c->AccessBoundingBoxes().ObjectSpaceBBox());
     osbb.Union(i2c->AccessBoundingBoxes().ObjectSpaceBBox());
@@ -118,10 +121,26 @@ bool megamol::stdplugin::datatools::MPDCListsConcatenate::getData(megamol::core:
         return true;
     }
 
-    // both calls are connected, so be smart!
+    // both calls are connected, so be smart and query independent inputs concurrently!
+    core::utility::CallGraphExecutor extents;
+    extents.Add(*i1c, 1);
+    extents.Add(*i2c, 1);
+    if (!extents.Run()) return false;
 
-    if (!((*i1c)(0))) return false;
-    if (!((*i2c)(0))) return false;
+    auto const minFc = std::min(i1c->FrameCount(), i2c->FrameCount());
+    if (minFc == 0) {
+        // at least one of the inputs has no frames, so there is nothing to concatenate
+        return false;
+    }
+    auto reqFid = oc->FrameID();
+    if (reqFid >= minFc) reqFid = minFc - 1;
+
+    i1c->SetFrameID(reqFid, oc->IsFrameForced());
+    i2c->SetFrameID(reqFid, oc->IsFrameForced());
+    core::utility::CallGraphExecutor data;
+    data.Add(*i1c, 0);
+    data.Add(*i2c, 0);
+    if (!data.Run()) return false;
 
     auto const i1plc = i1c->GetParticleListCount();
     auto const i2plc = i2c->GetParticleListCount();
@@ -141,7 +160,14 @@ bool megamol::stdplugin::datatools::MPDCListsConcatenate::getData(megamol::core:
         outPl = inPl;
     }
 
+    oc->SetFrameCount(minFc);
+    oc->SetFrameID(reqFid, oc->IsFrameForced());
     oc->SetDataHash(i1c->DataHash() + i2c->DataHash() * 10);
 
+    // the lists only reference the upstream data, so keep it locked until the lists are released
+    oc->SetUnlocker(new Unlocker(i1c->GetUnlocker(), i2c->GetUnlocker()), false);
+    i1c->SetUnlocker(nullptr, false);
+    i2c->SetUnlocker(nullptr, false);
+
     return true;
 }
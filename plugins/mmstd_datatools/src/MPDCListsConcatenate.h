@@ -10,6 +10,7 @@
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
+#include "mmcore/moldyn/MultiParticleDataCall.h"
 
 namespace megamol {
 namespace stdplugin {
@@ -28,6 +29,32 @@ protected:
     void release(void) override;
 
 private:
+    /**
+     * Holds the data of both inputs until the concatenated lists, which
+     * point into this data, are no longer used.
+     */
+    class Unlocker : public core::moldyn::MultiParticleDataCall::Unlocker {
+    public:
+        Unlocker(core::moldyn::MultiParticleDataCall::Unlocker* inner1,
+            core::moldyn::MultiParticleDataCall::Unlocker* inner2)
+            : core::moldyn::MultiParticleDataCall::Unlocker(), inner1(inner1), inner2(inner2) {}
+        virtual ~Unlocker(void) { this->Unlock(); }
+        virtual void Unlock(void) {
+            if (this->inner1 != nullptr) {
+                this->inner1->Unlock();
+                SAFE_DELETE(this->inner1);
+            }
+            if (this->inner2 != nullptr) {
+                this->inner2->Unlock();
+                SAFE_DELETE(this->inner2);
+            }
+        }
+
+    private:
+        core::moldyn::MultiParticleDataCall::Unlocker* inner1;
+        core::moldyn::MultiParticleDataCall::Unlocker* inner2;
+    };
+
     bool getExtent(megamol::core::Call& c);
     bool getData(megamol::core::Call& c);
     core::CalleeSlot dataOutSlot;
@@ -0,0 +1,542 @@
+/*
+ * MPIDomainDecomposition.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "MPIDomainDecomposition.h"
+#include "mmcore/cluster/mpi/MpiCall.h"
+#include "mmcore/param/FloatParam.h"
+#include "vislib/sys/Log.h"
+#include "vislib/sys/SystemInformation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace megamol;
+using namespace megamol::stdplugin;
+
+
+/** Number of histogram bins locating the split plane of a k-d tree node */
+#define MPIDOMAINDECOMPOSITION_BINS 1024
+
+
+/*
+ * datatools::MPIDomainDecomposition::MPIDomainDecomposition
+ */
+datatools::MPIDomainDecomposition::MPIDomainDecomposition(void)
+    : AbstractParticleManipulator("outData", "indata")
+    , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
+    , ghostWidthSlot("ghostWidth", "Width of the layer of particles of the neighbouring subdomains copied to each rank")
+    , dataHash(0)
+    , frameID(std::numeric_limits<unsigned int>::max())
+    , globalBBox()
+    , globalClipBox()
+    , domain()
+    , lists() {
+
+    this->callRequestMpi.SetCompatibleCall<core::cluster::mpi::MpiCallDescription>();
+    this->MakeSlotAvailable(&this->callRequestMpi);
+
+    this->ghostWidthSlot.SetParameter(new core::param::FloatParam(0.0f, 0.0f));
+    this->MakeSlotAvailable(&this->ghostWidthSlot);
+}
+
+
+/*
+ * datatools::MPIDomainDecomposition::~MPIDomainDecomposition
+ */
+datatools::MPIDomainDecomposition::~MPIDomainDecomposition(void) { this->Release(); }
+
+
+/*
+ * datatools::MPIDomainDecomposition::manipulateData
+ */
+bool datatools::MPIDomainDecomposition::manipulateData(
+    megamol::core::moldyn::MultiParticleDataCall& outData, megamol::core::moldyn::MultiParticleDataCall& inData) {
+    using megamol::core::moldyn::MultiParticleDataCall;
+
+    outData = inData; // also transfers the unlocker to 'outData'
+
+    inData.SetUnlocker(nullptr, false); // keep original data locked
+                                        // original data will be unlocked through outData
+#ifdef WITH_MPI
+    if (!this->initMPI()) return true;
+
+    // all ranks take part in the exchange, even if only some of them got new data
+    int update = ((this->dataHash != inData.DataHash()) || (this->frameID != inData.FrameID()) ||
+                     this->ghostWidthSlot.IsDirty())
+                     ? 1
+                     : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &update, 1, MPI_INT, MPI_MAX, this->comm);
+    if (update != 0) {
+        this->ghostWidthSlot.ResetDirty();
+        if (!this->decompose(inData)) {
+            this->lists.clear();
+            this->dataHash = 0;
+            this->frameID = std::numeric_limits<unsigned int>::max();
+            return false;
+        }
+        this->dataHash = inData.DataHash();
+        this->frameID = inData.FrameID();
+    }
+
+    for (unsigned int i = 0; i < this->lists.size(); ++i) {
+        MultiParticleDataCall::Particles& p = outData.AccessParticles(i);
+        const List& l = this->lists[i];
+
+        const unsigned int vsize = MultiParticleDataCall::Particles::VertexDataSize[l.vertType];
+        const unsigned int csize = MultiParticleDataCall::Particles::ColorDataSize[l.colType];
+        const unsigned int dsize = MultiParticleDataCall::Particles::DirDataSize[l.dirType];
+        const unsigned int stride = vsize + csize + dsize + MultiParticleDataCall::Particles::IDDataSize[l.idType];
+
+        p.SetCount(l.count);
+        p.SetBBox(l.bbox);
+        p.SetGlobalRadius(l.globalRadius);
+        p.SetColourMapIndexValues(l.minColourIndex, l.maxColourIndex);
+        if (l.count == 0) continue;
+        p.SetVertexData(l.vertType, l.data.data(), stride);
+        p.SetColourData(l.colType, l.data.data() + vsize, stride);
+        p.SetDirData(l.dirType, l.data.data() + vsize + csize, stride);
+        p.SetIDData(l.idType, l.data.data() + vsize + csize + dsize, stride);
+    }
+    if (!this->lists.empty()) {
+        outData.AccessBoundingBoxes().SetObjectSpaceBBox(this->globalBBox);
+        outData.AccessBoundingBoxes().SetObjectSpaceClipBox(this->globalClipBox);
+    }
+#endif /* WITH_MPI */
+
+    return true;
+}
+
+
+/*
+ * datatools::MPIDomainDecomposition::manipulateExtent
+ */
+bool datatools::MPIDomainDecomposition::manipulateExtent(
+    megamol::core::moldyn::MultiParticleDataCall& outData, megamol::core::moldyn::MultiParticleDataCall& inData) {
+    outData = inData;
+    inData.SetUnlocker(nullptr, false);
+
+    // the extent of the whole data set is only known after the first exchange
+    if (!this->lists.empty()) {
+        outData.AccessBoundingBoxes().SetObjectSpaceBBox(this->globalBBox);
+        outData.AccessBoundingBoxes().SetObjectSpaceClipBox(this->globalClipBox);
+    }
+    return true;
+}
+
+
+#ifdef WITH_MPI
+/*
+ * datatools::MPIDomainDecomposition::decompose
+ */
+bool datatools::MPIDomainDecomposition::decompose(megamol::core::moldyn::MultiParticleDataCall& inData) {
+    using megamol::core::moldyn::MultiParticleDataCall;
+    typedef MultiParticleDataCall::Particles Particles;
+    const float maxFloat = std::numeric_limits<float>::max();
+
+    // All ranks must agree on the lists and their layout
+    const int plc = static_cast<int>(inData.GetParticleListCount());
+    int plcRange[2] = {plc, -plc};
+    MPI_Allreduce(MPI_IN_PLACE, plcRange, 2, MPI_INT, MPI_MIN, this->comm);
+    if (plcRange[0] != -plcRange[1]) {
+        vislib::sys::Log::DefaultLog.WriteError("MPIDomainDecomposition: ranks disagree on the number of particle "
+                                                "lists (%d to %d)", plcRange[0], -plcRange[1]);
+        return false;
+    }
+    const unsigned int numLists = static_cast<unsigned int>(plc);
+
+    std::vector<int> types(4 * numLists, 0);
+    std::vector<float> attribs(3 * numLists); // radius, -min colour index, max colour index
+    for (unsigned int l = 0; l < numLists; ++l) {
+        const Particles& p = inData.AccessParticles(l);
+        const bool filled = (p.GetCount() > 0);
+        types[4 * l + 0] = filled ? p.GetVertexDataType() : 0;
+        types[4 * l + 1] = filled ? p.GetColourDataType() : 0;
+        types[4 * l + 2] = filled ? p.GetDirDataType() : 0;
+        types[4 * l + 3] = filled ? p.GetIDDataType() : 0;
+        attribs[3 * l + 0] = p.GetGlobalRadius();
+        attribs[3 * l + 1] = filled ? -p.GetMinColourIndexValue() : -maxFloat;
+        attribs[3 * l + 2] = filled ? p.GetMaxColourIndexValue() : -maxFloat;
+    }
+    std::vector<int> agreed(types.size());
+    MPI_Allreduce(types.data(), agreed.data(), static_cast<int>(types.size()), MPI_INT, MPI_MAX, this->comm);
+    MPI_Allreduce(MPI_IN_PLACE, attribs.data(), static_cast<int>(attribs.size()), MPI_FLOAT, MPI_MAX, this->comm);
+    int mismatch = 0;
+    for (unsigned int l = 0; l < numLists; ++l) {
+        if (inData.AccessParticles(l).GetCount() == 0) continue;
+        if (!std::equal(types.begin() + 4 * l, types.begin() + 4 * l + 4, agreed.begin() + 4 * l)) mismatch = 1;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &mismatch, 1, MPI_INT, MPI_MAX, this->comm);
+    if (mismatch != 0) {
+        vislib::sys::Log::DefaultLog.WriteError(
+            "MPIDomainDecomposition: ranks disagree on the data types of the particle lists");
+        return false;
+    }
+
+    std::vector<unsigned int> elSize(numLists);
+    for (unsigned int l = 0; l < numLists; ++l) {
+        elSize[l] = Particles::VertexDataSize[agreed[4 * l + 0]] + Particles::ColorDataSize[agreed[4 * l + 1]] +
+                    Particles::DirDataSize[agreed[4 * l + 2]] + Particles::IDDataSize[agreed[4 * l + 3]];
+    }
+
+    // Positions of all lists, and the extents of all ranks
+    std::vector<uint64_t> listBase(numLists + 1, 0);
+    for (unsigned int l = 0; l < numLists; ++l) {
+        listBase[l + 1] = listBase[l] + inData.AccessParticles(l).GetCount();
+    }
+    const uint64_t cnt = listBase[numLists];
+    std::vector<float> pos(3 * cnt);
+
+    float extents[18]; // particles, bounding box and clip box; lower corner and negated upper corner
+    std::fill(extents, extents + 18, maxFloat);
+    for (unsigned int l = 0; l < numLists; ++l) {
+        const auto& store = inData.AccessParticles(l).GetParticleStore();
+        const uint64_t lcnt = listBase[l + 1] - listBase[l];
+        float* dst = pos.data() + 3 * listBase[l];
+        for (uint64_t i = 0; i < lcnt; ++i, dst += 3) {
+            dst[0] = store.GetXAcc()->Get_f(i);
+            dst[1] = store.GetYAcc()->Get_f(i);
+            dst[2] = store.GetZAcc()->Get_f(i);
+            for (int k = 0; k < 3; ++k) {
+                extents[k] = std::min(extents[k], dst[k]);
+                extents[3 + k] = std::min(extents[3 + k], -dst[k]);
+            }
+        }
+    }
+    auto storeBox = [](const vislib::math::Cuboid<float>& box, float* dst) {
+        dst[0] = box.Left();
+        dst[1] = box.Bottom();
+        dst[2] = box.Back();
+        dst[3] = -box.Right();
+        dst[4] = -box.Top();
+        dst[5] = -box.Front();
+    };
+    if (inData.AccessBoundingBoxes().IsObjectSpaceBBoxValid()) {
+        storeBox(inData.AccessBoundingBoxes().ObjectSpaceBBox(), extents + 6);
+    }
+    if (inData.AccessBoundingBoxes().IsObjectSpaceClipBoxValid()) {
+        storeBox(inData.AccessBoundingBoxes().ObjectSpaceClipBox(), extents + 12);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, extents, 18, MPI_FLOAT, MPI_MIN, this->comm);
+    if (extents[0] > -extents[3]) {
+        // no particles at all
+        std::copy(extents + 12, extents + 18, extents);
+    }
+    for (int b = 6; b < 18; b += 6) {
+        if (extents[b] > -extents[b + 3]) std::copy(extents, extents + 6, extents + b);
+    }
+    this->globalBBox.Set(extents[6], extents[7], extents[8], -extents[9], -extents[10], -extents[11]);
+    this->globalClipBox.Set(extents[12], extents[13], extents[14], -extents[15], -extents[16], -extents[17]);
+    this->globalClipBox.Union(this->globalBBox);
+
+    // k-d tree, built level by level: the split plane of every node halving its ranks is found from a histogram of
+    // the particles of all ranks along the longest edge of the node
+    struct Node {
+        int firstRank;
+        int numRanks;
+        float lower[3];
+        float upper[3];
+    };
+    std::vector<Node> nodes(1);
+    nodes[0].firstRank = 0;
+    nodes[0].numRanks = this->mpiSize;
+    for (int k = 0; k < 3; ++k) {
+        nodes[0].lower[k] = extents[k];
+        nodes[0].upper[k] = std::max(-extents[3 + k], extents[k]);
+    }
+    std::vector<uint32_t> nodeOf(cnt, 0);
+
+    while (true) {
+        std::vector<int> splitIdx(nodes.size(), -1);
+        std::vector<int> axis(nodes.size(), 0);
+        int numSplit = 0;
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            if (nodes[n].numRanks < 2) continue;
+            splitIdx[n] = numSplit++;
+            for (int k = 1; k < 3; ++k) {
+                if (nodes[n].upper[k] - nodes[n].lower[k] > nodes[n].upper[axis[n]] - nodes[n].lower[axis[n]]) {
+                    axis[n] = k;
+                }
+            }
+        }
+        if (numSplit == 0) break;
+
+        std::vector<uint64_t> hist(static_cast<size_t>(numSplit) * MPIDOMAINDECOMPOSITION_BINS, 0);
+        for (uint64_t i = 0; i < cnt; ++i) {
+            const uint32_t n = nodeOf[i];
+            if (splitIdx[n] < 0) continue;
+            const int a = axis[n];
+            const float ext = nodes[n].upper[a] - nodes[n].lower[a];
+            int bin = (ext > 0.0f)
+                          ? static_cast<int>((pos[3 * i + a] - nodes[n].lower[a]) / ext * MPIDOMAINDECOMPOSITION_BINS)
+                          : 0;
+            bin = std::min(std::max(bin, 0), MPIDOMAINDECOMPOSITION_BINS - 1);
+            ++hist[static_cast<size_t>(splitIdx[n]) * MPIDOMAINDECOMPOSITION_BINS + bin];
+        }
+        MPI_Allreduce(MPI_IN_PLACE, hist.data(), static_cast<int>(hist.size()), MPI_UINT64_T, MPI_SUM, this->comm);
+
+        std::vector<Node> next;
+        std::vector<uint32_t> firstChild(nodes.size());
+        std::vector<float> split(nodes.size(), 0.0f);
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            firstChild[n] = static_cast<uint32_t>(next.size());
+            if (splitIdx[n] < 0) {
+                next.push_back(nodes[n]);
+                continue;
+            }
+            const uint64_t* h = hist.data() + static_cast<size_t>(splitIdx[n]) * MPIDOMAINDECOMPOSITION_BINS;
+            const int leftRanks = nodes[n].numRanks / 2;
+            uint64_t total = 0;
+            for (int b = 0; b < MPIDOMAINDECOMPOSITION_BINS; ++b) total += h[b];
+
+            int splitBin = MPIDOMAINDECOMPOSITION_BINS * leftRanks / nodes[n].numRanks;
+            if (total > 0) {
+                const double target = static_cast<double>(total) * leftRanks / nodes[n].numRanks;
+                uint64_t sum = 0;
+                for (splitBin = 0; splitBin < MPIDOMAINDECOMPOSITION_BINS; ++splitBin) {
+                    sum += h[splitBin];
+                    if (static_cast<double>(sum) >= target) break;
+                }
+                ++splitBin;
+            }
+            const int a = axis[n];
+            split[n] = nodes[n].lower[a] +
+                       (nodes[n].upper[a] - nodes[n].lower[a]) * splitBin / MPIDOMAINDECOMPOSITION_BINS;
+
+            Node left = nodes[n];
+            left.numRanks = leftRanks;
+            left.upper[a] = split[n];
+            Node right = nodes[n];
+            right.firstRank += leftRanks;
+            right.numRanks -= leftRanks;
+            right.lower[a] = split[n];
+            next.push_back(left);
+            next.push_back(right);
+        }
+
+        for (uint64_t i = 0; i < cnt; ++i) {
+            const uint32_t n = nodeOf[i];
+            nodeOf[i] = firstChild[n];
+            if ((splitIdx[n] >= 0) && (pos[3 * i + axis[n]] >= split[n])) ++nodeOf[i];
+        }
+        nodes.swap(next);
+    }
+
+    std::vector<vislib::math::Cuboid<float>> domains(this->mpiSize);
+    for (const Node& n : nodes) {
+        domains[n.firstRank].Set(n.lower[0], n.lower[1], n.lower[2], n.upper[0], n.upper[1], n.upper[2]);
+    }
+    this->domain = domains[this->mpiRank];
+
+    // Destinations: the owner, and every rank whose subdomain is within the ghost width
+    const float ghostWidth = this->ghostWidthSlot.Param<core::param::FloatParam>()->Value();
+    const size_t numSlots = static_cast<size_t>(this->mpiSize) * numLists * 2; // [rank][list][owned, ghost]
+    std::vector<uint64_t> sendCounts(numSlots, 0);
+    std::vector<std::pair<uint64_t, int>> ghosts;
+    for (unsigned int l = 0; l < numLists; ++l) {
+        for (uint64_t i = listBase[l]; i < listBase[l + 1]; ++i) {
+            const int owner = nodes[nodeOf[i]].firstRank;
+            ++sendCounts[(static_cast<size_t>(owner) * numLists + l) * 2];
+            if (ghostWidth <= 0.0f) continue;
+            const float* p = pos.data() + 3 * i;
+            for (int r = 0; r < this->mpiSize; ++r) {
+                if (r == owner) continue;
+                const auto& d = domains[r];
+                if ((p[0] >= d.Left() - ghostWidth) && (p[0] <= d.Right() + ghostWidth) &&
+                    (p[1] >= d.Bottom() - ghostWidth) && (p[1] <= d.Top() + ghostWidth) &&
+                    (p[2] >= d.Back() - ghostWidth) && (p[2] <= d.Front() + ghostWidth)) {
+                    ghosts.emplace_back(i, r);
+                    ++sendCounts[(static_cast<size_t>(r) * numLists + l) * 2 + 1];
+                }
+            }
+        }
+    }
+
+    std::vector<uint64_t> recvCounts(numSlots, 0);
+    MPI_Alltoall(sendCounts.data(), static_cast<int>(2 * numLists), MPI_UINT64_T, recvCounts.data(),
+        static_cast<int>(2 * numLists), MPI_UINT64_T, this->comm);
+
+    // Byte counts of the exchange, which MPI limits to int
+    std::vector<int> sendBytes(this->mpiSize), sendDispl(this->mpiSize), recvBytes(this->mpiSize),
+        recvDispl(this->mpiSize);
+    uint64_t sendTotal = 0, recvTotal = 0;
+    int overflow = 0;
+    for (int r = 0; r < this->mpiSize; ++r) {
+        uint64_t s = 0, v = 0;
+        for (unsigned int l = 0; l < numLists; ++l) {
+            const size_t slot = (static_cast<size_t>(r) * numLists + l) * 2;
+            s += (sendCounts[slot] + sendCounts[slot + 1]) * elSize[l];
+            v += (recvCounts[slot] + recvCounts[slot + 1]) * elSize[l];
+        }
+        sendDispl[r] = static_cast<int>(sendTotal);
+        recvDispl[r] = static_cast<int>(recvTotal);
+        sendBytes[r] = static_cast<int>(s);
+        recvBytes[r] = static_cast<int>(v);
+        sendTotal += s;
+        recvTotal += v;
+        if ((sendTotal > static_cast<uint64_t>(std::numeric_limits<int>::max())) ||
+            (recvTotal > static_cast<uint64_t>(std::numeric_limits<int>::max()))) {
+            overflow = 1;
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &overflow, 1, MPI_INT, MPI_MAX, this->comm);
+    if (overflow != 0) {
+        vislib::sys::Log::DefaultLog.WriteError(
+            "MPIDomainDecomposition: the data of a rank exceed what MPI can exchange at once");
+        return false;
+    }
+
+    // Pack the particles by destination, list and kind
+    std::vector<uint64_t> cursor(numSlots);
+    for (int r = 0; r < this->mpiSize; ++r) {
+        uint64_t off = sendDispl[r];
+        for (unsigned int l = 0; l < numLists; ++l) {
+            const size_t slot = (static_cast<size_t>(r) * numLists + l) * 2;
+            cursor[slot] = off;
+            off += sendCounts[slot] * elSize[l];
+            cursor[slot + 1] = off;
+            off += sendCounts[slot + 1] * elSize[l];
+        }
+    }
+    std::vector<uint8_t> sendBuf(sendTotal);
+    auto pack = [&](unsigned int l, uint64_t i, size_t slot) {
+        const Particles& p = inData.AccessParticles(l);
+        uint8_t* dst = sendBuf.data() + cursor[slot];
+        const unsigned int sizes[4] = {Particles::VertexDataSize[p.GetVertexDataType()],
+            Particles::ColorDataSize[p.GetColourDataType()], Particles::DirDataSize[p.GetDirDataType()],
+            Particles::IDDataSize[p.GetIDDataType()]};
+        const void* ptrs[4] = {p.GetVertexData(), p.GetColourData(), p.GetDirData(), p.GetIDData()};
+        const unsigned int strides[4] = {
+            p.GetVertexDataStride(), p.GetColourDataStride(), p.GetDirDataStride(), p.GetIDDataStride()};
+        for (int k = 0; k < 4; ++k) {
+            if (sizes[k] == 0) continue;
+            memcpy(dst, reinterpret_cast<const uint8_t*>(ptrs[k]) + static_cast<size_t>(strides[k]) * i, sizes[k]);
+            dst += sizes[k];
+        }
+        cursor[slot] += elSize[l];
+    };
+    for (unsigned int l = 0; l < numLists; ++l) {
+        for (uint64_t i = listBase[l]; i < listBase[l + 1]; ++i) {
+            const int owner = nodes[nodeOf[i]].firstRank;
+            pack(l, i - listBase[l], (static_cast<size_t>(owner) * numLists + l) * 2);
+        }
+    }
+    for (const auto& g : ghosts) {
+        const unsigned int l = static_cast<unsigned int>(
+            std::upper_bound(listBase.begin(), listBase.end(), g.first) - listBase.begin() - 1);
+        pack(l, g.first - listBase[l], (static_cast<size_t>(g.second) * numLists + l) * 2 + 1);
+    }
+    pos.clear();
+    pos.shrink_to_fit();
+
+    std::vector<uint8_t> recvBuf(recvTotal);
+    MPI_Alltoallv(sendBuf.data(), sendBytes.data(), sendDispl.data(), MPI_BYTE, recvBuf.data(), recvBytes.data(),
+        recvDispl.data(), MPI_BYTE, this->comm);
+    sendBuf.clear();
+    sendBuf.shrink_to_fit();
+
+    // Unpack, owned particles of all sources first, then the ghosts
+    this->lists.resize(numLists);
+    std::vector<uint64_t> ownedCursor(numLists, 0), ghostCursor(numLists, 0);
+    for (unsigned int l = 0; l < numLists; ++l) {
+        List& list = this->lists[l];
+        list.vertType = static_cast<Particles::VertexDataType>(agreed[4 * l + 0]);
+        list.colType = static_cast<Particles::ColourDataType>(agreed[4 * l + 1]);
+        list.dirType = static_cast<Particles::DirDataType>(agreed[4 * l + 2]);
+        list.idType = static_cast<Particles::IDDataType>(agreed[4 * l + 3]);
+        list.globalRadius = attribs[3 * l + 0];
+        list.minColourIndex = -attribs[3 * l + 1];
+        list.maxColourIndex = attribs[3 * l + 2];
+        list.owned = 0;
+        list.count = 0;
+        for (int s = 0; s < this->mpiSize; ++s) {
+            const size_t slot = (static_cast<size_t>(s) * numLists + l) * 2;
+            list.owned += recvCounts[slot];
+            list.count += recvCounts[slot] + recvCounts[slot + 1];
+        }
+        list.data.resize(list.count * elSize[l]);
+        ghostCursor[l] = list.owned * elSize[l];
+    }
+    for (int s = 0; s < this->mpiSize; ++s) {
+        const uint8_t* src = recvBuf.data() + recvDispl[s];
+        for (unsigned int l = 0; l < numLists; ++l) {
+            const size_t slot = (static_cast<size_t>(s) * numLists + l) * 2;
+            const uint64_t owned = recvCounts[slot] * elSize[l];
+            const uint64_t ghost = recvCounts[slot + 1] * elSize[l];
+            memcpy(this->lists[l].data.data() + ownedCursor[l], src, owned);
+            memcpy(this->lists[l].data.data() + ghostCursor[l], src + owned, ghost);
+            ownedCursor[l] += owned;
+            ghostCursor[l] += ghost;
+            src += owned + ghost;
+        }
+    }
+
+    // Extent of the particles of this rank, which is what sort-last compositing needs
+    for (unsigned int l = 0; l < numLists; ++l) {
+        List& list = this->lists[l];
+        list.bbox = this->domain;
+        if (list.count == 0) continue;
+
+        Particles p;
+        p.SetCount(list.count);
+        p.SetGlobalRadius(list.globalRadius);
+        p.SetVertexData(list.vertType, list.data.data(), elSize[l]);
+        const auto& store = p.GetParticleStore();
+        float lower[3] = {maxFloat, maxFloat, maxFloat};
+        float upper[3] = {-maxFloat, -maxFloat, -maxFloat};
+        for (uint64_t i = 0; i < list.count; ++i) {
+            const float r = store.GetRAcc()->Get_f(i);
+            const float v[3] = {store.GetXAcc()->Get_f(i), store.GetYAcc()->Get_f(i), store.GetZAcc()->Get_f(i)};
+            for (int k = 0; k < 3; ++k) {
+                lower[k] = std::min(lower[k], v[k] - r);
+                upper[k] = std::max(upper[k], v[k] + r);
+            }
+        }
+        list.bbox.Set(lower[0], lower[1], lower[2], upper[0], upper[1], upper[2]);
+    }
+
+    return true;
+}
+#endif /* WITH_MPI */
+
+
+/*
+ * datatools::MPIDomainDecomposition::initMPI
+ */
+bool datatools::MPIDomainDecomposition::initMPI() {
+    bool retval = false;
+#ifdef WITH_MPI
+    if (this->comm == MPI_COMM_NULL) {
+        auto c = this->callRequestMpi.CallAs<core::cluster::mpi::MpiCall>();
+        if (c != nullptr) {
+            /* New method: let MpiProvider do all the stuff. */
+            if ((*c)(core::cluster::mpi::MpiCall::IDX_PROVIDE_MPI)) {
+                vislib::sys::Log::DefaultLog.WriteInfo("Got MPI communicator.");
+                this->comm = c->GetComm();
+            } else {
+                vislib::sys::Log::DefaultLog.WriteError(_T("Could not ")
+                                                        _T("retrieve MPI communicator for the MPI-based view ")
+                                                        _T("from the registered provider module."));
+            }
+        }
+
+        if (this->comm != MPI_COMM_NULL) {
+            vislib::sys::Log::DefaultLog.WriteInfo(_T("MPI is ready, ")
+                                                   _T("retrieving communicator properties ..."));
+            ::MPI_Comm_rank(this->comm, &this->mpiRank);
+            ::MPI_Comm_size(this->comm, &this->mpiSize);
+            vislib::sys::Log::DefaultLog.WriteInfo(_T("This MPIDomainDecomposition on %hs is %d ")
+                                                   _T("of %d."),
+                vislib::sys::SystemInformation::ComputerNameA().PeekBuffer(), this->mpiRank, this->mpiSize);
+        } /* end if (this->comm != MPI_COMM_NULL) */
+    }     /* end if (this->comm == MPI_COMM_NULL) */
+
+    /* Determine success of the whole operation. */
+    retval = (this->comm != MPI_COMM_NULL);
+#endif /* WITH_MPI */
+    return retval;
+}
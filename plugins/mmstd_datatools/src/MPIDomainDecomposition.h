@@ -0,0 +1,157 @@
+/*
+ * MPIDomainDecomposition.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_MPIDOMAINDECOMPOSITION_H_INCLUDED
+#define MEGAMOLCORE_MPIDOMAINDECOMPOSITION_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmstd_datatools/AbstractParticleManipulator.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include "vislib/math/Cuboid.h"
+
+#include <vector>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#endif /* WITH_MPI */
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /**
+     * Module redistributing object-space distributed MultiparticleDataCalls over MPI, such that every rank holds
+     * the particles of one subdomain of a k-d tree balancing the particle counts.
+     *
+     * Particles within the ghost width of a subdomain are additionally copied to its rank and follow the owned
+     * particles of each list. The bounding box of each list is the extent of the particles of this rank, for
+     * sort-last compositing, while the object-space bounding and clip boxes are those of the whole data set, so all
+     * ranks use the same camera and depth range.
+     */
+    class MPIDomainDecomposition : public AbstractParticleManipulator {
+    public:
+
+        /** Return module class name */
+        static const char *ClassName(void) {
+            return "MPIDomainDecomposition";
+        }
+
+        /** Return module class description */
+        static const char *Description(void) {
+            return "redistributes MultiparticleDataCalls over MPI into a k-d tree subdomain per rank";
+        }
+
+        /** Module is always available */
+        static bool IsAvailable(void) {
+#ifdef WITH_MPI
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /** Ctor */
+        MPIDomainDecomposition(void);
+
+        /** Dtor */
+        virtual ~MPIDomainDecomposition(void);
+
+    protected:
+
+        /**
+         * Manipulates the particle data
+         *
+         * @param outData The call receiving the manipulated data
+         * @param inData The call holding the original data
+         *
+         * @return True on success
+         */
+        virtual bool manipulateData(
+            megamol::core::moldyn::MultiParticleDataCall& outData,
+            megamol::core::moldyn::MultiParticleDataCall& inData);
+
+        /**
+         * Manipulates the particle data extent
+         *
+         * @param outData The call receiving the manipulated data
+         * @param inData The call holding the original data
+         *
+         * @return True on success
+         */
+        virtual bool manipulateExtent(
+            megamol::core::moldyn::MultiParticleDataCall& outData,
+            megamol::core::moldyn::MultiParticleDataCall& inData);
+
+        bool initMPI();
+
+    private:
+
+        /** The redistributed particles of one list, interleaved */
+        struct List {
+            std::vector<uint8_t> data;
+            uint64_t count = 0;
+            uint64_t owned = 0;
+            core::moldyn::SimpleSphericalParticles::VertexDataType vertType =
+                core::moldyn::SimpleSphericalParticles::VERTDATA_NONE;
+            core::moldyn::SimpleSphericalParticles::ColourDataType colType =
+                core::moldyn::SimpleSphericalParticles::COLDATA_NONE;
+            core::moldyn::SimpleSphericalParticles::DirDataType dirType =
+                core::moldyn::SimpleSphericalParticles::DIRDATA_NONE;
+            core::moldyn::SimpleSphericalParticles::IDDataType idType =
+                core::moldyn::SimpleSphericalParticles::IDDATA_NONE;
+            float globalRadius = 0.5f;
+            float minColourIndex = 0.0f;
+            float maxColourIndex = 1.0f;
+            vislib::math::Cuboid<float> bbox;
+        };
+
+#ifdef WITH_MPI
+        /**
+         * Builds the k-d tree and exchanges the particles, collectively on all ranks.
+         *
+         * @param inData The call holding the original data
+         *
+         * @return True on success
+         */
+        bool decompose(megamol::core::moldyn::MultiParticleDataCall& inData);
+
+        /** The communicator that the view uses. */
+        MPI_Comm comm = MPI_COMM_NULL;
+#endif /* WITH_MPI */
+
+        /** slot for MPIprovider */
+        core::CallerSlot callRequestMpi;
+
+        /** The width of the layer of ghost particles around each subdomain */
+        core::param::ParamSlot ghostWidthSlot;
+
+        int mpiRank = 0;
+        int mpiSize = 0;
+
+        /** The data hash and frame the decomposition was computed for */
+        size_t dataHash;
+        unsigned int frameID;
+
+        /** The bounding and clip boxes of the whole data set */
+        vislib::math::Cuboid<float> globalBBox;
+        vislib::math::Cuboid<float> globalClipBox;
+
+        /** The subdomain of this rank */
+        vislib::math::Cuboid<float> domain;
+
+        std::vector<List> lists;
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_MPIDOMAINDECOMPOSITION_H_INCLUDED */
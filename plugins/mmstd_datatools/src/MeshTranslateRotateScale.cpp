@@ -11,6 +11,7 @@
 #include "mmcore/param/Vector4fParam.h"
 #include "mmcore/view/CallGetTransferFunction.h"
 #include "vislib/math/Matrix4.h"
+#include "AffineTransform.h"
 
 using namespace megamol;
 using namespace megamol::stdplugin;
@@ -24,7 +25,7 @@ datatools::MeshTranslateRotateScale::MeshTranslateRotateScale(void)
     , translateSlot("translation", "Translates the particles in x, y, z direction")
     , quaternionSlot("quaternion", "Rotates the particles around x, y, z axes")
     , scaleSlot("scale", "Scales the particle data")
-    , finalData(NULL), mesh(NULL) {
+    , finalData(), mesh(), inDataHash(0), inFrameID(0) {
     this->translateSlot.SetParameter(new core::param::Vector3fParam(vislib::math::Vector<float, 3>(0, 0, 0)));
     this->MakeSlotAvailable(&this->translateSlot);
 
@@ -41,8 +42,6 @@ datatools::MeshTranslateRotateScale::MeshTranslateRotateScale(void)
  */
 datatools::MeshTranslateRotateScale::~MeshTranslateRotateScale(void) {
     this->Release();
-    delete[] finalData;
-    delete[] mesh;
 }
 
 
@@ -135,71 +134,60 @@ bool datatools::MeshTranslateRotateScale::manipulateData(
     //auto const totMX = transMX * invOrigTransMX * scaleMX * origTransMX;
 
     unsigned int mlc = outData.Count();
-    vislib::math::Vector<float, 4> pos;
 
-    finalData = new float*[mlc];
-    this->mesh = new geocalls::CallTriMeshData::Mesh[mlc];
+    // the transformed vertices only depend on the input and the parameters
+    const bool rebuild = (inData.DataHash() != this->inDataHash) || (inData.DataHash() == 0) ||
+                         (inData.FrameID() != this->inFrameID) || (this->finalData.size() != mlc) ||
+                         this->InterfaceIsDirty();
+    if (rebuild) {
+        this->inDataHash = inData.DataHash();
+        this->inFrameID = inData.FrameID();
+        this->InterfaceResetDirty();
+
+        float rows[12];
+        AffineRows(totMX, rows);
+
+        this->finalData.resize(mlc);
+        for (unsigned int i = 0; i < mlc; i++) {
+            auto& m = outData.Objects()[i];
+            const int64_t vcnt = static_cast<int64_t>(m.GetVertexCount());
+            std::vector<float>& fd = this->finalData[i];
+            fd.resize(static_cast<size_t>(vcnt) * 3);
+
+            if (m.GetVertexDataType() == geocalls::CallTriMeshData::Mesh::DT_FLOAT) {
+                TransformPositions<float>(rows, m.GetVertexPointerFloat(), 3 * sizeof(float), fd.data(), 3, vcnt);
+            } else if (m.GetVertexDataType() == geocalls::CallTriMeshData::Mesh::DT_DOUBLE) {
+                TransformPositions<double>(rows, m.GetVertexPointerDouble(), 3 * sizeof(double), fd.data(), 3, vcnt);
+            }
+        }
+    }
+
+    this->mesh.resize(mlc);
     for (unsigned int i = 0; i < mlc; i++) {
         auto& m = outData.Objects()[i];
 
         uint64_t vcnt = m.GetVertexCount();
         uint64_t fcnt = m.GetTriCount();
 
-        auto vdt = m.GetVertexDataType();
-        const float* vd;
-        if (vdt == geocalls::CallTriMeshData::Mesh::DT_FLOAT) {
-            vd = m.GetVertexPointerFloat();
-        } else {
-            vd = reinterpret_cast<const float*>(m.GetVertexPointerDouble());
-        }
-
-        unsigned char* cd;
-        unsigned int* indexd;
+        const unsigned char* cd = NULL;
+        const unsigned int* indexd = NULL;
 
         if (m.HasColourPointer()) {
             if (m.GetColourDataType() == geocalls::CallTriMeshData::Mesh::DT_BYTE) {
-                cd = const_cast<unsigned char*>(m.GetColourPointerByte());
+                cd = m.GetColourPointerByte();
             }
         }
         if (m.HasTriIndexPointer()) {
             if (m.GetTriDataType() == geocalls::CallTriMeshData::Mesh::DT_UINT32) {
-                indexd = const_cast<unsigned int*>(m.GetTriIndexPointerUInt32());
+                indexd = m.GetTriIndexPointerUInt32();
             }
         }
 
-        if (m.HasNormalPointer()) {
-        }
-        if (m.HasTextureCoordinatePointer()) {
-        }
-        if (m.HasVertexAttribPointer()) {
-        }
-
-
-        finalData[i] = new float[vcnt * 3];
-        for (size_t loop = 0; loop < vcnt; loop++) {
-
-            pos.SetX(vd[3 * loop]);
-            pos.SetY(vd[3 * loop + 1]);
-            pos.SetZ(vd[3 * loop + 2]);
-            pos.SetW(1.0f);
-
-            pos = totMX * pos;
-
-            finalData[i][3 * loop + 0] = pos.GetX();
-            finalData[i][3 * loop + 1] = pos.GetY();
-            finalData[i][3 * loop + 2] = pos.GetZ();
-
-
-            // Does not work ??
-            // finalData.emplace_back(pos.GetX(), pos.GetY(), pos.GetZ(), part.col.GetRf(), part.col.GetGf(),
-            //    part.col.GetBf(), part.col.GetAf());
-        }
-
-        this->mesh[i].SetVertexData(vcnt, finalData[i], NULL, cd, NULL, false);
-        this->mesh[i].SetTriangleData(fcnt, indexd, false);
+        this->mesh[i].SetVertexData(vcnt, this->finalData[i].data(), NULL, const_cast<unsigned char*>(cd), NULL, false);
+        this->mesh[i].SetTriangleData(fcnt, const_cast<unsigned int*>(indexd), false);
     }
 
-    outData.SetObjects(mlc, this->mesh);
+    outData.SetObjects(mlc, this->mesh.data());
 
     return true;
 }
@@ -10,6 +10,7 @@
 
 #include "mmstd_datatools/AbstractMeshManipulator.h"
 #include "mmcore/param/ParamSlot.h"
+#include <vector>
 
 
 namespace megamol {
@@ -69,8 +70,13 @@ namespace datatools {
         core::param::ParamSlot quaternionSlot;
         core::param::ParamSlot scaleSlot;
 
-        float** finalData;
-        geocalls::CallTriMeshData::Mesh* mesh;
+        /** The transformed vertices of the meshes */
+        std::vector<std::vector<float>> finalData;
+        std::vector<geocalls::CallTriMeshData::Mesh> mesh;
+
+        /** The input the vertices were computed for */
+        size_t inDataHash;
+        unsigned int inFrameID;
     };
 
 } /* end namespace datatools */
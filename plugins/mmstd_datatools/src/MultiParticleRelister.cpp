@@ -8,6 +8,7 @@
 #include "MultiParticleRelister.h"
 #include "mmcore/moldyn/ParticleRelistCall.h"
 #include "mmcore/CoreInstance.h"
+#include <cstring>
 
 using namespace megamol;
 using namespace megamol::stdplugin::datatools;
@@ -20,7 +21,7 @@ MultiParticleRelister::MultiParticleRelister() : AbstractParticleManipulator("ou
         verDatTyp(core::moldyn::SimpleSphericalParticles::VERTDATA_NONE),
         globRad(0.5f),
         partSize(0), colOffset(0),
-        data() {
+        data(), arena() {
     getRelistInfoSlot.SetCompatibleCall<core::moldyn::ParticleRelistCallDescription>();
     MakeSlotAvailable(&getRelistInfoSlot);
 }
@@ -58,6 +59,7 @@ bool MultiParticleRelister::manipulateData(megamol::core::moldyn::MultiParticleD
         outRelistHash++;
 
         data.clear();
+        arena.Reset(); // the memory is kept for the next frame
         colDatTyp = core::moldyn::SimpleSphericalParticles::COLDATA_NONE;
         verDatTyp = core::moldyn::SimpleSphericalParticles::VERTDATA_NONE;
         partSize = 0;
@@ -85,12 +87,11 @@ bool MultiParticleRelister::manipulateData(megamol::core::moldyn::MultiParticleD
         outData.SetParticleListCount(static_cast<unsigned int>(data.size()));
         for (size_t i = 0; i < data.size(); ++i) {
             auto &p = outData.AccessParticles(static_cast<unsigned int>(i));
-            assert((data[i].size() % partSize) == 0);
-            p.SetCount(data[i].size() / partSize);
+            p.SetCount(data[i].second);
             p.SetGlobalColour(globCol.R(), globCol.G(), globCol.B(), globCol.A());
             p.SetGlobalRadius(globRad);
-            p.SetColourData(colDatTyp, data[i].data() + colOffset);
-            p.SetVertexData(verDatTyp, data[i].data());
+            p.SetColourData(colDatTyp, data[i].first + colOffset);
+            p.SetVertexData(verDatTyp, data[i].first);
         }
         outData.SetUnlocker(nullptr);
     }
@@ -132,11 +133,22 @@ void MultiParticleRelister::copyData(const core::moldyn::SimpleSphericalParticle
     colOffset = verSize;
 
     const core::moldyn::ParticleRelistCall::ListIDType *relistData = relist.SourceParticleTargetLists();
-    data.resize(relist.TargetListCount());
+    const size_t cnt = static_cast<size_t>(inData.GetCount());
+    data.assign(relist.TargetListCount(), std::pair<uint8_t*, size_t>(nullptr, 0));
+
+    // count first, so every list is allocated once
+    for (size_t pi = 0; pi < cnt; ++pi) data[relistData[pi]].second++;
+    std::vector<uint8_t*> out(data.size());
+    for (size_t li = 0; li < data.size(); ++li) {
+        data[li].first = arena.Allocate<uint8_t>(data[li].second * partSize);
+        out[li] = data[li].first;
+    }
 
-    for (size_t pi = 0; pi < inData.GetCount(); ++pi, colDat += colStep, verDat += verStep, relistData++) {
-        for (size_t i = 0; i < verSize; ++i) data[*relistData].push_back(verDat[i]);
-        for (size_t i = 0; i < colSize; ++i) data[*relistData].push_back(colDat[i]);
+    for (size_t pi = 0; pi < cnt; ++pi, colDat += colStep, verDat += verStep, relistData++) {
+        uint8_t *&o = out[*relistData];
+        if (verSize > 0) ::memcpy(o, verDat, verSize);
+        if (colSize > 0) ::memcpy(o + verSize, colDat, colSize);
+        o += partSize;
     }
 
 }
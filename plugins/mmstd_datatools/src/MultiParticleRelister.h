@@ -16,6 +16,7 @@
 #include <vector>
 #include <cstdint>
 #include "mmcore/moldyn/ParticleRelistCall.h"
+#include "mmcore/utility/FrameArena.h"
 
 namespace megamol {
 namespace stdplugin {
@@ -53,7 +54,10 @@ namespace datatools {
         float globRad;
         size_t partSize;
         size_t colOffset;
-        std::vector<std::vector<uint8_t> > data;
+
+        /** The particles of the target lists, allocated from 'arena' */
+        std::vector<std::pair<uint8_t*, size_t> > data;
+        core::utility::FrameArena arena;
 
 
     };
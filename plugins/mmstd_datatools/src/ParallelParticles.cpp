@@ -0,0 +1,142 @@
+/*
+ * ParallelParticles.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "mmstd_datatools/ParallelParticles.h"
+#include <algorithm>
+#include <limits>
+
+using namespace megamol;
+using namespace megamol::stdplugin;
+using megamol::core::moldyn::SimpleSphericalParticles;
+
+namespace {
+
+/** Answer whether the list holds colour index values */
+bool hasColourIndex(const SimpleSphericalParticles& p) {
+    return (p.GetColourDataType() == SimpleSphericalParticles::COLDATA_FLOAT_I) ||
+           (p.GetColourDataType() == SimpleSphericalParticles::COLDATA_DOUBLE_I);
+}
+
+/**
+ * Calls func(value) for the colour index values [begin, end) of a list.
+ * Tightly packed floats are read as a plain array, which the compiler can
+ * vectorise.
+ */
+template <class F> void forColourIndex(const SimpleSphericalParticles& p, uint64_t begin, uint64_t end, F func) {
+    const uint8_t* col = static_cast<const uint8_t*>(p.GetColourData());
+    if (p.GetColourDataType() == SimpleSphericalParticles::COLDATA_FLOAT_I) {
+        const size_t stride = std::max<size_t>(p.GetColourDataStride(), sizeof(float));
+        if (stride == sizeof(float)) {
+            const float* f = reinterpret_cast<const float*>(col);
+            for (uint64_t i = begin; i < end; ++i) func(f[i]);
+        } else {
+            for (uint64_t i = begin; i < end; ++i) func(*reinterpret_cast<const float*>(col + i * stride));
+        }
+    } else {
+        const size_t stride = std::max<size_t>(p.GetColourDataStride(), sizeof(double));
+        for (uint64_t i = begin; i < end; ++i) {
+            func(static_cast<float>(*reinterpret_cast<const double*>(col + i * stride)));
+        }
+    }
+}
+
+} // namespace
+
+
+/*
+ * datatools::SplitParticleChunks
+ */
+std::vector<datatools::ParticleChunk> datatools::SplitParticleChunks(
+    core::moldyn::MultiParticleDataCall& data, uint64_t chunkSize) {
+    std::vector<ParticleChunk> chunks;
+    chunkSize = std::max<uint64_t>(chunkSize, 1);
+    for (unsigned int li = 0; li < data.GetParticleListCount(); ++li) {
+        const uint64_t cnt = data.AccessParticles(li).GetCount();
+        for (uint64_t begin = 0; begin < cnt; begin += chunkSize) {
+            chunks.push_back(ParticleChunk{li, begin, std::min(begin + chunkSize, cnt)});
+        }
+    }
+    return chunks;
+}
+
+
+/*
+ * datatools::ComputeColourIndexStatistics
+ */
+datatools::ColourIndexStatistics datatools::ComputeColourIndexStatistics(
+    core::moldyn::MultiParticleDataCall& data, unsigned int bins) {
+    ColourIndexStatistics stats;
+    std::vector<ParticleChunk> chunks = SplitParticleChunks(data);
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+                     [&data](const ParticleChunk& c) { return !hasColourIndex(data.AccessParticles(c.list)); }),
+        chunks.end());
+    if (chunks.empty()) return stats;
+
+    // partial results per chunk, as OpenMP 2 offers no min/max reductions
+    std::vector<float> mins(chunks.size()), maxs(chunks.size());
+    ParallelForChunks(chunks, [&](size_t i, const ParticleChunk& c) {
+        float lo = std::numeric_limits<float>::max();
+        float hi = std::numeric_limits<float>::lowest();
+        forColourIndex(data.AccessParticles(c.list), c.begin, c.end, [&lo, &hi](float v) {
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        });
+        mins[i] = lo;
+        maxs[i] = hi;
+    });
+    stats.minValue = *std::min_element(mins.begin(), mins.end());
+    stats.maxValue = *std::max_element(maxs.begin(), maxs.end());
+    for (const auto& c : chunks) {
+        stats.count += c.end - c.begin;
+    }
+
+    if (bins > 0) {
+        const float range = stats.maxValue - stats.minValue;
+        const float scale = (range > 0.0f) ? static_cast<float>(bins) / range : 0.0f;
+        const float lo = stats.minValue;
+        std::vector<uint64_t> partial(chunks.size() * bins, 0);
+        ParallelForChunks(chunks, [&](size_t i, const ParticleChunk& c) {
+            uint64_t* h = partial.data() + i * bins;
+            forColourIndex(data.AccessParticles(c.list), c.begin, c.end, [&](float v) {
+                h[std::min(static_cast<unsigned int>((v - lo) * scale), bins - 1)]++;
+            });
+        });
+        stats.histogram.assign(bins, 0);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            for (unsigned int b = 0; b < bins; ++b) {
+                stats.histogram[b] += partial[i * bins + b];
+            }
+        }
+    }
+
+    return stats;
+}
+
+
+/*
+ * datatools::ColourIndexStatisticsCache::ColourIndexStatisticsCache
+ */
+datatools::ColourIndexStatisticsCache::ColourIndexStatisticsCache(unsigned int bins)
+    : bins(bins), valid(false), hash(0), frameID(0), stats() {
+    // intentionally empty
+}
+
+
+/*
+ * datatools::ColourIndexStatisticsCache::Get
+ */
+const datatools::ColourIndexStatistics& datatools::ColourIndexStatisticsCache::Get(
+    core::moldyn::MultiParticleDataCall& data) {
+    if (!this->valid || (data.DataHash() == 0) || (this->hash != data.DataHash()) ||
+        (this->frameID != data.FrameID())) {
+        this->stats = ComputeColourIndexStatistics(data, this->bins);
+        this->hash = data.DataHash();
+        this->frameID = data.FrameID();
+        this->valid = true;
+    }
+    return this->stats;
+}
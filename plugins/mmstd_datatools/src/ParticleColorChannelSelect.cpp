@@ -74,8 +74,14 @@ bool datatools::ParticleColorChannelSelect::manipulateData(
                 stride = 4 * 4;
             }
             if (p.GetColourDataStride() > stride) stride = p.GetColourDataStride();
-            p.SetColourData(megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I,
-                static_cast<const float*>(p.GetColourData()) + chan, stride);
+            const float *chanData = static_cast<const float*>(p.GetColourData()) + chan;
+            if (p.GetColourDataOwner()) {
+                // keep sharing the ownership of the colours
+                p.SetColourData(megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I,
+                    megamol::core::moldyn::SimpleSphericalParticles::SharedBuffer(p.GetColourDataOwner(), chanData), stride);
+            } else {
+                p.SetColourData(megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I, chanData, stride);
+            }
 
             std::map<const void*, std::pair<float, float> >::iterator clRng = colRange.find(p.GetColourData());
 
@@ -8,6 +8,7 @@
 #include "ParticleColorSignThreshold.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/BoolParam.h"
+#include "mmstd_datatools/ParallelParticles.h"
 #include <cstdint>
 #include <algorithm>
 
@@ -83,10 +84,13 @@ bool datatools::ParticleColorSignThreshold::manipulateData(
 void datatools::ParticleColorSignThreshold::compute_colors(megamol::core::moldyn::MultiParticleDataCall& dat) {
     size_t allpartcnt = 0;
 
+    // offset of each list into the new colours
     unsigned int plc = dat.GetParticleListCount();
+    std::vector<size_t> offsets(plc, 0);
     for (unsigned int pli = 0; pli < plc; pli++) {
         auto& pl = dat.AccessParticles(pli);
         if (pl.GetColourDataType() != megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I) continue;
+        offsets[pli] = allpartcnt;
         allpartcnt += static_cast<size_t>(pl.GetCount());
     }
 
@@ -95,25 +99,21 @@ void datatools::ParticleColorSignThreshold::compute_colors(megamol::core::moldyn
     float negcol = this->negativeThresholdSlot.Param<core::param::FloatParam>()->Value();
     float poscol = this->positiveThresholdSlot.Param<core::param::FloatParam>()->Value();
 
-    allpartcnt = 0;
-    for (unsigned int pli = 0; pli < plc; pli++) {
-        auto& pl = dat.AccessParticles(pli);
-        if (pl.GetColourDataType() != megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I) continue;
+    ParallelForChunks(SplitParticleChunks(dat), [&](size_t, const ParticleChunk& chunk) {
+        auto& pl = dat.AccessParticles(chunk.list);
+        if (pl.GetColourDataType() != megamol::core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_I) return;
 
-        int part_cnt = static_cast<int>(pl.GetCount());
         const unsigned char *col = static_cast<const unsigned char*>(pl.GetColourData());
         unsigned int stride = std::max<unsigned int>(pl.GetColourDataStride(), sizeof(float));
-#pragma omp parallel for
-        for (int part_i = 0; part_i < part_cnt; ++part_i) {
+        float *dst = this->newColors.data() + offsets[chunk.list];
+        for (uint64_t part_i = chunk.begin; part_i < chunk.end; ++part_i) {
             float c = *reinterpret_cast<const float *>(col + (part_i * stride));
             if (c < negcol) c = -1.0f;
             else if (c > poscol) c = 1.0f;
             else c = 0.0f;
-            this->newColors[allpartcnt + part_i] = c;
+            dst[part_i] = c;
         }
-
-        allpartcnt += static_cast<size_t>(part_cnt);
-    }
+    });
 }
 
 
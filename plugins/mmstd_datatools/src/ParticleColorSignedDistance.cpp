@@ -7,6 +7,7 @@
 #include "stdafx.h"
 #include "ParticleColorSignedDistance.h"
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/utility/ResultCache.h"
 #include <nanoflann.hpp>
 #include <cstdint>
 #include <algorithm>
@@ -79,7 +80,28 @@ bool datatools::ParticleColorSignedDistance::manipulateData(
     if ((this->datahash == 0) || (this->datahash != outData.DataHash()) || (this->time != outData.FrameID())) {
         this->datahash = outData.DataHash();
         this->time = outData.FrameID();
-        this->compute_colors(outData);
+
+        // Results are cached as [minCol, maxCol, colors...]
+        auto& cache = core::utility::ResultCache::Instance();
+        const auto key = core::utility::ResultCache::MakeKey(this->FullName(), this->datahash, this->time,
+            {&this->cyclXSlot, &this->cyclYSlot, &this->cyclZSlot});
+        // A data hash of zero does not identify the data, so the result must not be shared
+        auto cached = (this->datahash != 0) ? cache.Find(key) : nullptr;
+        if (cached && (cached->size() >= 2 * sizeof(float))) {
+            const float *vals = reinterpret_cast<const float *>(cached->data());
+            this->minCol = vals[0];
+            this->maxCol = vals[1];
+            this->newColors.assign(vals + 2, vals + cached->size() / sizeof(float));
+        } else {
+            this->compute_colors(outData);
+
+            std::vector<unsigned char> result((this->newColors.size() + 2) * sizeof(float));
+            float *vals = reinterpret_cast<float *>(result.data());
+            vals[0] = this->minCol;
+            vals[1] = this->maxCol;
+            std::copy(this->newColors.begin(), this->newColors.end(), vals + 2);
+            if (this->datahash != 0) cache.Store(key, std::move(result));
+        }
     }
     
     if (this->newColors.size() > 0) {
@@ -0,0 +1,112 @@
+/*
+ * ParticleFilterFlags.cpp
+ *
+ * Copyright (C) 2019 by MegaMol team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "ParticleFilterFlags.h"
+
+#include "mmcore/FlagCall.h"
+#include "vislib/sys/Log.h"
+
+using namespace megamol;
+using namespace megamol::stdplugin;
+using megamol::core::FlagCall;
+using megamol::core::FlagStorage;
+
+
+/*
+ * datatools::ParticleFilterFlags::ParticleFilterFlags
+ */
+datatools::ParticleFilterFlags::ParticleFilterFlags(void)
+    : slot("flags", "Marks filtered particles in a flag storage instead of removing them"), version(0), valid(false) {
+    this->slot.SetCompatibleCall<core::FlagCallDescription>();
+}
+
+
+/*
+ * datatools::ParticleFilterFlags::~ParticleFilterFlags
+ */
+datatools::ParticleFilterFlags::~ParticleFilterFlags(void) {
+    // intentionally empty
+}
+
+
+/*
+ * datatools::ParticleFilterFlags::IsConnected
+ */
+bool datatools::ParticleFilterFlags::IsConnected(void) {
+    return this->slot.CallAs<FlagCall>() != nullptr;
+}
+
+
+/*
+ * datatools::ParticleFilterFlags::Write
+ */
+bool datatools::ParticleFilterFlags::Write(core::moldyn::MultiParticleDataCall& dat,
+    const std::vector<std::vector<char>>& keep, bool changed) {
+
+    auto* flagc = this->slot.CallAs<FlagCall>();
+    if (flagc == nullptr) return false;
+
+    size_t total = 0;
+    for (unsigned int pli = 0; pli < dat.GetParticleListCount(); ++pli) {
+        total += static_cast<size_t>(dat.AccessParticles(pli).GetCount());
+    }
+
+    if (!(*flagc)(FlagCall::CallMapFlags)) {
+        vislib::sys::Log::DefaultLog.WriteError("ParticleFilterFlags: cannot map flags");
+        return false;
+    }
+    flagc->validateFlagsCount(static_cast<uint32_t>(total));
+
+    if (!changed && this->valid && (flagc->GetVersion() == this->version)) {
+        // nobody touched the flags since we wrote them
+        (*flagc)(FlagCall::CallUnmapFlags);
+        return true;
+    }
+
+    auto flags = flagc->GetFlags();
+    bool anyChange = false;
+    size_t off = 0;
+    for (unsigned int pli = 0; pli < dat.GetParticleListCount(); ++pli) {
+        const size_t cnt = static_cast<size_t>(dat.AccessParticles(pli).GetCount());
+        const char* k = ((pli < keep.size()) && (keep[pli].size() == cnt)) ? keep[pli].data() : nullptr;
+        size_t runBegin = 0;
+        bool inRun = false;
+        for (size_t i = 0; i < cnt; ++i) {
+            auto& f = (*flags)[off + i];
+            const FlagStorage::FlagItemType nf = ((k == nullptr) || (k[i] != 0)) ? (f & ~FlagStorage::FILTERED)
+                                                                               : (f | FlagStorage::FILTERED);
+            if (nf != f) {
+                f = nf;
+                if (!inRun) {
+                    runBegin = off + i;
+                    inRun = true;
+                }
+            } else if (inRun) {
+                flagc->MarkDirty(runBegin, off + i);
+                inRun = false;
+                anyChange = true;
+            }
+        }
+        if (inRun) {
+            flagc->MarkDirty(runBegin, off + cnt);
+            anyChange = true;
+        }
+        off += cnt;
+    }
+
+    if (anyChange) {
+        this->version = flagc->GetVersion() + 1;
+        flagc->SetFlags(flags, this->version);
+    } else {
+        this->version = flagc->GetVersion();
+        flagc->SetFlags(flags);
+    }
+    this->valid = true;
+    (*flagc)(FlagCall::CallUnmapFlags);
+
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+ * ParticleFilterFlags.h
+ *
+ * Copyright (C) 2019 by MegaMol team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMSTD_DATATOOLS_PARTICLEFILTERFLAGS_H_INCLUDED
+#define MMSTD_DATATOOLS_PARTICLEFILTERFLAGS_H_INCLUDED
+#pragma once
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/FlagStorage.h"
+#include "mmcore/moldyn/MultiParticleDataCall.h"
+
+#include <vector>
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /**
+     * Output of particle filters that publish their result as FILTERED flags in a flag storage instead of copying
+     * the particles passing the filter.
+     *
+     * The flag index space is the one of the renderers, i.e. all particles of all lists in list order. Renderers
+     * connected to the same flag storage then draw the unchanged input data and hide the filtered particles. Only
+     * the FILTERED bit is touched, all other flags are kept.
+     */
+    class ParticleFilterFlags {
+    public:
+
+        /** Ctor */
+        ParticleFilterFlags(void);
+
+        /** Dtor */
+        ~ParticleFilterFlags(void);
+
+        /** Answer the slot to be connected to the flag storage */
+        inline core::CallerSlot& Slot(void) {
+            return this->slot;
+        }
+
+        /** Answer whether a flag storage is connected */
+        bool IsConnected(void);
+
+        /**
+         * Writes the filter result to the flag storage.
+         *
+         * The flags are only rewritten if the masks changed or if someone else changed the flags since the last
+         * call, so this can be called for every request of the data.
+         *
+         * @param dat The call holding the unfiltered particles
+         * @param keep One mask per list, non-zero for particles passing the filter. Lists without a mask of their
+         *             size pass completely.
+         * @param changed Whether the masks changed since the last call
+         *
+         * @return True on success, false if no flag storage is connected
+         */
+        bool Write(core::moldyn::MultiParticleDataCall& dat, const std::vector<std::vector<char>>& keep,
+            bool changed);
+
+    private:
+
+        core::CallerSlot slot;
+
+        /** The version of the flags after the last call */
+        core::FlagStorage::FlagVersionType version;
+
+        /** Whether the flags ever received the masks */
+        bool valid;
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MMSTD_DATATOOLS_PARTICLEFILTERFLAGS_H_INCLUDED */
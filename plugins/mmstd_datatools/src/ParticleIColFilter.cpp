@@ -19,7 +19,8 @@ datatools::ParticleIColFilter::ParticleIColFilter() : AbstractParticleManipulato
         maxValSlot("maxVal", "The maximal color value of particles to be passed on"),
         staifHackDistSlot("staifHackDist", "Distance to the bounding box to include particles"),
         dataHash(0), frameId(0), parts(), data(), mapIndex(),
-        inValRangeSlot("inValRange", "Displays the value range of the input color values") {
+        inValRangeSlot("inValRange", "Displays the value range of the input color values"),
+        flags(), keep() {
 
     minValSlot.SetParameter(new core::param::FloatParam(0.0f));
     minValSlot.SetUpdateCallback(&ParticleIColFilter::reset);
@@ -40,6 +41,8 @@ datatools::ParticleIColFilter::ParticleIColFilter() : AbstractParticleManipulato
     particleMapSlot.SetCallback(ParticleFilterMapDataCall::ClassName(), ParticleFilterMapDataCall::FunctionName(ParticleFilterMapDataCall::GET_EXTENT), &ParticleIColFilter::getParticleMapExtent);
     particleMapSlot.SetCallback(ParticleFilterMapDataCall::ClassName(), ParticleFilterMapDataCall::FunctionName(ParticleFilterMapDataCall::GET_HASH), &ParticleIColFilter::getParticleMapHash);
     MakeSlotAvailable(&particleMapSlot);
+
+    MakeSlotAvailable(&flags.Slot());
 }
 
 datatools::ParticleIColFilter::~ParticleIColFilter() {
@@ -50,7 +53,22 @@ bool datatools::ParticleIColFilter::manipulateData(
         megamol::core::moldyn::MultiParticleDataCall& outData,
         megamol::core::moldyn::MultiParticleDataCall& inData) {
 
-    if ((frameId != inData.FrameID()) || (dataHash != inData.DataHash()) || (inData.DataHash() == 0)) {
+    if (flags.IsConnected()) {
+        // pass the particles on untouched and only mark the ones outside of the interval
+        const bool changed = (frameId != inData.FrameID()) || (dataHash != inData.DataHash()) || (inData.DataHash() == 0)
+            || (keep.size() != inData.GetParticleListCount());
+        if (changed) {
+            frameId = inData.FrameID();
+            dataHash = inData.DataHash();
+            setFlagData(inData);
+        }
+        outData = inData;
+        inData.SetUnlocker(nullptr, false);
+        flags.Write(outData, keep, changed);
+        return true;
+    }
+
+    if ((frameId != inData.FrameID()) || (dataHash != inData.DataHash()) || (inData.DataHash() == 0) || !keep.empty()) {
         frameId = inData.FrameID();
         dataHash = inData.DataHash();
         setData(inData);
@@ -75,12 +93,63 @@ void datatools::ParticleIColFilter::setData(core::moldyn::MultiParticleDataCall&
     unsigned int cnt = inDat.GetParticleListCount();
     parts.resize(cnt);
     data.resize(cnt);
+    keep.clear();
     mapIndex.clear();
     ParticleFilterMapDataCall::index_t mapOffset = 0;
 
-    float minV, maxV;
     for (unsigned int i = 0; i < cnt; ++i) {
         setData(parts[i], data[i], inDat.AccessParticles(i), inDat.AccessBoundingBoxes().ObjectSpaceBBox(), mapOffset);
+    }
+
+    updateInValRange(inDat);
+}
+
+void datatools::ParticleIColFilter::setFlagData(core::moldyn::MultiParticleDataCall& inDat) {
+    using core::moldyn::SimpleSphericalParticles;
+
+    unsigned int cnt = inDat.GetParticleListCount();
+    parts.clear();
+    data.clear();
+    keep.resize(cnt);
+    mapIndex.clear();
+
+    float minVal = minValSlot.Param<core::param::FloatParam>()->Value();
+    float maxVal = maxValSlot.Param<core::param::FloatParam>()->Value();
+    if (maxVal < minVal) std::swap(minVal, maxVal);
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        const SimpleSphericalParticles& s = inDat.AccessParticles(i);
+        const INT64 pcnt = static_cast<INT64>(s.GetCount());
+        std::vector<char>& k = keep[i];
+        k.assign(static_cast<size_t>(pcnt), 0);
+
+        // the particles are not moved, so the map is the identity
+        const ParticleFilterMapDataCall::index_t mapOffset = static_cast<ParticleFilterMapDataCall::index_t>(mapIndex.size());
+        mapIndex.resize(mapIndex.size() + static_cast<size_t>(pcnt));
+        for (INT64 j = 0; j < pcnt; ++j) mapIndex[mapOffset + j] = static_cast<ParticleFilterMapDataCall::index_t>(mapOffset + j);
+
+        if (s.GetVertexDataType() == SimpleSphericalParticles::VERTDATA_NONE) continue;
+        if (s.GetColourDataType() != SimpleSphericalParticles::COLDATA_FLOAT_I) continue; // removed as in setData
+
+        const uint8_t* cp = reinterpret_cast<const uint8_t*>(s.GetColourData());
+        int c_step = s.GetColourDataStride();
+        if (c_step < 4) c_step = 4;
+
+#pragma omp parallel for
+        for (INT64 j = 0; j < pcnt; ++j) {
+            const float *ci = reinterpret_cast<const float*>(cp + c_step * j);
+            k[j] = ((minVal <= *ci) && (*ci <= maxVal)) ? 1 : 0;
+        }
+    }
+
+    updateInValRange(inDat);
+}
+
+void datatools::ParticleIColFilter::updateInValRange(core::moldyn::MultiParticleDataCall& inDat) {
+    unsigned int cnt = inDat.GetParticleListCount();
+
+    float minV = 0.0f, maxV = 1.0f;
+    for (unsigned int i = 0; i < cnt; ++i) {
         if (i == 0) {
             minV = inDat.AccessParticles(i).GetMinColourIndexValue();
             maxV = inDat.AccessParticles(i).GetMaxColourIndexValue();
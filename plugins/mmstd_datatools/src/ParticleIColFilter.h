@@ -13,6 +13,7 @@
 #include "vislib/math/Cuboid.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/ParticleFilterMapDataCall.h"
+#include "ParticleFilterFlags.h"
 #include <vector>
 
 
@@ -55,6 +56,8 @@ namespace datatools {
         bool reset(core::param::ParamSlot&);
         void setData(core::moldyn::MultiParticleDataCall& inDat);
         void setData(core::moldyn::MultiParticleDataCall::Particles& p, vislib::RawStorage& d, const core::moldyn::SimpleSphericalParticles& s, vislib::math::Cuboid<float> bbox, ParticleFilterMapDataCall::index_t& mapOffset);
+        void setFlagData(core::moldyn::MultiParticleDataCall& inDat);
+        void updateInValRange(core::moldyn::MultiParticleDataCall& inDat);
 
         bool getParticleMapData(core::Call& c);
         bool getParticleMapExtent(core::Call& c);
@@ -70,6 +73,8 @@ namespace datatools {
         std::vector<vislib::RawStorage> data;
         std::vector<ParticleFilterMapDataCall::index_t> mapIndex;
         core::param::ParamSlot inValRangeSlot;
+        ParticleFilterFlags flags;
+        std::vector<std::vector<char>> keep;
 
     };
 
@@ -1,6 +1,148 @@
 #include "stdafx.h"
 #include "ParticleIdentitySort.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <omp.h>
+
+
+namespace {
+
+using megamol::core::moldyn::SimpleSphericalParticles;
+
+/** Reads the identities of a particle list */
+void readIdentities(SimpleSphericalParticles const& p, std::vector<uint64_t>& ids) {
+    auto const cnt = static_cast<int64_t>(p.GetCount());
+    auto const type = p.GetIDDataType();
+    auto const size = SimpleSphericalParticles::IDDataSize[type];
+    auto const stride = (p.GetIDDataStride() == 0) ? size : p.GetIDDataStride();
+    auto const base = static_cast<char const*>(p.GetIDData());
+
+    ids.resize(cnt);
+#pragma omp parallel for
+    for (int64_t i = 0; i < cnt; ++i) {
+        if (type == SimpleSphericalParticles::IDDATA_UINT32) {
+            uint32_t id;
+            memcpy(&id, base + i * stride, sizeof(id));
+            ids[i] = id;
+        } else {
+            memcpy(&ids[i], base + i * stride, sizeof(uint64_t));
+        }
+    }
+}
+
+/** Answer whether 'perm' still sorts 'ids' */
+bool isSorted(std::vector<uint64_t> const& ids, std::vector<size_t> const& perm) {
+    if (perm.size() != ids.size()) return false;
+    auto const cnt = static_cast<int64_t>(ids.size());
+    int64_t unsorted = 0;
+#pragma omp parallel for reduction(+ : unsorted)
+    for (int64_t i = 1; i < cnt; ++i) {
+        if (ids[perm[i - 1]] > ids[perm[i]]) ++unsorted;
+    }
+    return unsorted == 0;
+}
+
+/**
+ * Computes the permutation sorting 'ids'. Dense unique identities are
+ * scattered directly, all others are sorted by a parallel LSD radix sort
+ * over the bytes of id - min.
+ */
+void sortIdentities(std::vector<uint64_t> const& ids, std::vector<size_t>& perm) {
+    auto const cnt = static_cast<int64_t>(ids.size());
+    perm.resize(cnt);
+    if (cnt == 0) return;
+
+    uint64_t minID = ids[0];
+    uint64_t maxID = ids[0];
+#pragma omp parallel
+    {
+        uint64_t lmin = ids[0];
+        uint64_t lmax = ids[0];
+#pragma omp for
+        for (int64_t i = 0; i < cnt; ++i) {
+            lmin = std::min(lmin, ids[i]);
+            lmax = std::max(lmax, ids[i]);
+        }
+#pragma omp critical
+        {
+            minID = std::min(minID, lmin);
+            maxID = std::max(maxID, lmax);
+        }
+    }
+    uint64_t const range = maxID - minID;
+
+    if (range == static_cast<uint64_t>(cnt - 1)) {
+        // duplicates leave at least one slot unwritten
+        size_t const hole = std::numeric_limits<size_t>::max();
+        std::fill(perm.begin(), perm.end(), hole);
+#pragma omp parallel for
+        for (int64_t i = 0; i < cnt; ++i) {
+            perm[ids[i] - minID] = static_cast<size_t>(i);
+        }
+        int64_t holes = 0;
+#pragma omp parallel for reduction(+ : holes)
+        for (int64_t i = 0; i < cnt; ++i) {
+            if (perm[i] == hole) ++holes;
+        }
+        if (holes == 0) return;
+    }
+
+    std::iota(perm.begin(), perm.end(), 0);
+    int passes = 0;
+    for (uint64_t r = range; r != 0; r >>= 8) ++passes;
+    if (passes == 0) return;
+
+    std::vector<uint64_t> keys(cnt);
+    std::vector<uint64_t> tmpKeys(cnt);
+    std::vector<size_t> tmpPerm(cnt);
+#pragma omp parallel for
+    for (int64_t i = 0; i < cnt; ++i) {
+        keys[i] = ids[i] - minID;
+    }
+
+    std::vector<size_t> hist(static_cast<size_t>(omp_get_max_threads()) * 256);
+    for (int pass = 0; pass < passes; ++pass) {
+        int const shift = 8 * pass;
+#pragma omp parallel
+        {
+            int const t = omp_get_thread_num();
+            int const nt = omp_get_num_threads();
+            int64_t const begin = cnt * t / nt;
+            int64_t const end = cnt * (t + 1) / nt;
+            size_t* h = hist.data() + t * 256;
+
+            std::fill(h, h + 256, 0);
+            for (int64_t i = begin; i < end; ++i) {
+                ++h[(keys[i] >> shift) & 0xFF];
+            }
+#pragma omp barrier
+#pragma omp single
+            {
+                // thread-major offsets per digit keep the sort stable
+                size_t offset = 0;
+                for (int d = 0; d < 256; ++d) {
+                    for (int tt = 0; tt < nt; ++tt) {
+                        size_t const c = hist[tt * 256 + d];
+                        hist[tt * 256 + d] = offset;
+                        offset += c;
+                    }
+                }
+            }
+            for (int64_t i = begin; i < end; ++i) {
+                size_t const dst = h[(keys[i] >> shift) & 0xFF]++;
+                tmpKeys[dst] = keys[i];
+                tmpPerm[dst] = perm[i];
+            }
+        }
+        keys.swap(tmpKeys);
+        perm.swap(tmpPerm);
+    }
+}
+
+} // namespace
 
 
 megamol::stdplugin::datatools::ParticleIdentitySort::ParticleIdentitySort(void)
@@ -20,7 +162,9 @@ bool megamol::stdplugin::datatools::ParticleIdentitySort::manipulateData(
                                         // original data will be unlocked through outData
 
     auto const plc = outData.GetParticleListCount();
-    this->data_.clear();
+    this->data_.resize(plc);
+    this->perm_.resize(plc);
+    std::vector<uint64_t> ids;
     for (unsigned int i = 0; i < plc; ++i) {
         auto& p = outData.AccessParticles(i);
 
@@ -29,8 +173,7 @@ bool megamol::stdplugin::datatools::ParticleIdentitySort::manipulateData(
             continue;
         }
 
-        this->data_.emplace_back();
-        auto& dlist = this->data_.back();
+        auto& dlist = this->data_[i];
 
         auto vs = p.GetVertexDataStride();
         auto cs = p.GetColourDataStride();
@@ -53,44 +196,42 @@ bool megamol::stdplugin::datatools::ParticleIdentitySort::manipulateData(
             cs = core::moldyn::SimpleSphericalParticles::ColorDataSize[p.GetColourDataType()];
             is = core::moldyn::SimpleSphericalParticles::IDDataSize[p.GetIDDataType()];
 
+            // a stride of zero denotes tightly packed arrays
+            if (avs == 0) avs = vs;
+            if (acs == 0) acs = cs;
+            if (ais == 0) ais = is;
+
             ts = vs + cs + is;
 
             // sep = true;
         }
 
-        auto const cnt = p.GetCount();
-
-        std::vector<size_t> keys(cnt);
-        std::iota(keys.begin(), keys.end(), 0);
+        auto const cnt = static_cast<int64_t>(p.GetCount());
 
-        auto const& iAcc = p.GetParticleStore().GetIDAcc();
-
-        std::sort(keys.begin(), keys.end(),
-            [&iAcc](auto const& a, auto const& b) -> bool { return iAcc->Get_u64(a) < iAcc->Get_u64(b); });
+        // identities mostly keep their order over time, so the last permutation is tried first
+        readIdentities(p, ids);
+        auto& keys = this->perm_[i];
+        if (!isSorted(ids, keys)) {
+            sortIdentities(ids, keys);
+        }
 
         dlist.resize(cnt * ts);
 
         auto const basePtr = dlist.data();
 
         if (sep) {
-            for (size_t pidx = 0; pidx < cnt; ++pidx) {
+#pragma omp parallel for
+            for (int64_t pidx = 0; pidx < cnt; ++pidx) {
                 auto const sidx = keys[pidx];
                 memcpy(basePtr + ts * pidx, vp + sidx * avs, vs);
                 memcpy(basePtr + ts * pidx + vs, cp + sidx * acs, cs);
                 memcpy(basePtr + ts * pidx + vs + cs, ip + sidx * ais, is);
-
-                /*auto const didx = iAcc->Get_u64(pidx);
-                memcpy(basePtr + ts * didx, vp, vs);
-                memcpy(basePtr + ts * didx + vs, cp, cs);
-                memcpy(basePtr + ts * didx + vs + cs, ip, is);*/
             }
         } else {
-            for (size_t pidx = 0; pidx < cnt; ++pidx) {
+#pragma omp parallel for
+            for (int64_t pidx = 0; pidx < cnt; ++pidx) {
                 auto const sidx = keys[pidx];
                 memcpy(basePtr + ts * pidx, vp + sidx * ts, ts);
-
-                /*auto const didx = iAcc->Get_u64(pidx);
-                memcpy(basePtr + ts * didx, vp, ts);*/
             }
         }
 
@@ -49,6 +49,9 @@ namespace datatools {
     private:
 
         std::vector<std::vector<char>> data_;
+
+        /** The sort permutations of the last frame, reused while the identities keep their order */
+        std::vector<std::vector<size_t>> perm_;
     };
 
 } /* end namespace datatools */
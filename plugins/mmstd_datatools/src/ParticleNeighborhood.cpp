@@ -33,7 +33,7 @@ datatools::ParticleNeighborhood::ParticleNeighborhood(void)
         outDataSlot("outData", "Provides colors based on local particle temperature"),
         inDataSlot("inData", "Takes the directional particle data"),
         datahash(0), lastTime(-1), newColors(), maxDist(0),
-        allParts(), particleTree(nullptr), myPts(nullptr) {
+        particleTree(nullptr) {
 
     this->cyclXSlot.SetParameter(new core::param::BoolParam(true));
     this->MakeSlotAvailable(&this->cyclXSlot);
@@ -153,30 +153,8 @@ bool datatools::ParticleNeighborhood::assertData(megamol::core::AbstractGetData3
             this->newColors.resize(totalParts);
         }
 
-        allParts.clear();
-        allParts.reserve(totalParts);
-
-        // we could now filter particles according to something. but currently we need not.
-        size_t allpartcnt = 0;
-        for (unsigned int pli = 0; pli < plc; pli++) {
-            if (!isListOK(in, pli)) {
-                continue;
-            }
-
-            UINT64 part_cnt = getListCount(in, pli);
-
-            for (int part_i = 0; part_i < part_cnt; ++part_i) {
-                allParts.push_back(allpartcnt + part_i);
-            }
-            allpartcnt += getListCount(in, pli);
-        }
-
-        // allocate nanoflann data structures for border
-        assert(allpartcnt == totalParts);
-
-        this->myPts = std::make_shared<simplePointcloud>(inMpdc, allParts);
-        particleTree = std::make_shared<my_kd_tree_t>(3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-        particleTree->buildIndex();
+        // indexes all lists with float positions, i.e. the ones isListOK accepts
+        particleTree = ParticleSpatialIndex::Get(*inMpdc);
         this->datahash = in->DataHash();
         this->lastTime = time;
         this->radiusSlot.ForceSetDirty();
@@ -198,7 +176,7 @@ bool datatools::ParticleNeighborhood::assertData(megamol::core::AbstractGetData3
                 }
             }
 
-            const float *vbase = myPts->get_position(thePart);
+            const float *vbase = particleTree->GetPosition(thePart);
             float theVertex[3];
             maxDist = 0.0f;
             std::vector<std::pair<size_t, float> > ret_matches;
@@ -232,11 +210,11 @@ bool datatools::ParticleNeighborhood::assertData(megamol::core::AbstractGetData3
                         if (z_s > 0) theVertex[2] = theVertex[2] + ((theVertex[2] > bbox_cntr.Z()) ? -bbox.Depth() : bbox.Depth());
 
                         if (theSearchType == searchTypeEnum::RADIUS) {
-                            particleTree->radiusSearch(theVertex, theRadius, ret_localMatches, params);
+                            particleTree->RadiusSearch(theVertex, theRadius, ret_localMatches, params);
                             ret_matches.insert(ret_matches.end(), ret_localMatches.begin(), ret_localMatches.end());
                         } else {
                             resultSet.init(ret_index.data(), out_dist_sqr.data());
-                            particleTree->findNeighbors(resultSet, theVertex, params);
+                            particleTree->FindNeighbors(resultSet, theVertex, params);
                             for (size_t i = 0; i < resultSet.size(); ++i) {
                                 ret_matches.push_back(std::pair<size_t, float>(ret_index[i], out_dist_sqr[i]));
                             }
@@ -14,7 +14,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
-#include "PointcloudHelpers.h"
+#include "ParticleSpatialIndex.h"
 #include <vector>
 #include <nanoflann.hpp>
 
@@ -94,17 +94,10 @@ namespace datatools {
         size_t datahash;
         int lastTime;
         std::vector<float> newColors;
-        std::vector<size_t> allParts;
         float maxDist;
 
-        typedef nanoflann::KDTreeSingleIndexAdaptor<
-            nanoflann::L2_Simple_Adaptor<float, simplePointcloud>,
-            simplePointcloud,
-            3 /* dim */
-        > my_kd_tree_t;
-
-        std::shared_ptr<my_kd_tree_t> particleTree;
-        std::shared_ptr<simplePointcloud> myPts;
+        /** The spatial index, shared with other modules working on the same frame */
+        std::shared_ptr<const ParticleSpatialIndex> particleTree;
 
         /** The slot providing access to the manipulated data */
         megamol::core::CalleeSlot outDataSlot;
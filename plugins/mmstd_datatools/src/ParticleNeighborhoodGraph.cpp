@@ -14,6 +14,7 @@
 #include <chrono>
 #include <omp.h>
 #include <set>
+#include <algorithm>
 
 using namespace megamol;
 using namespace megamol::stdplugin::datatools;
@@ -30,7 +31,10 @@ ParticleNeighborhoodGraph::ParticleNeighborhoodGraph() : Module(),
         boundaryXCyclicSlot("boundary::XCyclic", "Activates connection over cyclic boundary conditions in x direction"),
         boundaryYCyclicSlot("boundary::YCyclic", "Activates connection over cyclic boundary conditions in y direction"),
         boundaryZCyclicSlot("boundary::ZCyclic", "Activates connection over cyclic boundary conditions in z direction"),
-        frameId(0), inDataHash(0), outDataHash(0), edges() {
+        skinSlot("incremental::skin", "Extra search distance for reusing the candidate edges over frames (0 to disable)"),
+        frameId(0), inDataHash(0), outDataHash(0), edges(), candidates(), candidatePositions(),
+        candidateRadius(0.0f), candidateBoxSize() {
+    candidateCyclic[0] = candidateCyclic[1] = candidateCyclic[2] = false;
 
     static_assert(sizeof(index_t) * 2 == sizeof(GraphDataCall::edge), "Index type error.");
 
@@ -65,6 +69,9 @@ ParticleNeighborhoodGraph::ParticleNeighborhoodGraph() : Module(),
     boundaryZCyclicSlot.SetParameter(new core::param::BoolParam(false));
     MakeSlotAvailable(&boundaryZCyclicSlot);
 
+    skinSlot.SetParameter(new core::param::FloatParam(0.0f, 0.0f));
+    MakeSlotAvailable(&skinSlot);
+
     forceConnectIsolatedSlot.SetParameter(new core::param::BoolParam(true));
     //MakeSlotAvailable(&forceConnectIsolatedSlot);
 
@@ -131,7 +138,8 @@ bool ParticleNeighborhoodGraph::getData(core::Call& c) {
             || boundaryXCyclicSlot.IsDirty()
             || boundaryYCyclicSlot.IsDirty()
             || boundaryZCyclicSlot.IsDirty()
-            || forceConnectIsolatedSlot.IsDirty()) {
+            || forceConnectIsolatedSlot.IsDirty()
+            || skinSlot.IsDirty()) {
         // update data
         inDataHash = mpc->DataHash();
         frameId = mpc->FrameID();
@@ -144,6 +152,7 @@ bool ParticleNeighborhoodGraph::getData(core::Call& c) {
         boundaryYCyclicSlot.ResetDirty();
         boundaryZCyclicSlot.ResetDirty();
         forceConnectIsolatedSlot.ResetDirty();
+        skinSlot.ResetDirty();
 
         edges.clear();
 
@@ -222,7 +231,236 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
 
         this->radiusSlot.Param<core::param::FloatParam>()->SetValue(neiRad, false);
     }
-    float neiRadSq = neiRad * neiRad;
+    float skin = skinSlot.Param<core::param::FloatParam>()->Value();
+    bool cycX = boundaryXCyclicSlot.Param<core::param::BoolParam>()->Value();
+    bool cycY = boundaryYCyclicSlot.Param<core::param::BoolParam>()->Value();
+    bool cycZ = boundaryZCyclicSlot.Param<core::param::BoolParam>()->Value();
+    auto const& bboxR = data->AccessBoundingBoxes().ObjectSpaceBBox();
+
+    if (skin <= 0.0f) {
+        // plain construction, forget all candidates
+        candidates.clear();
+        candidatePositions.clear();
+        this->findPairs(d, data, neiRad, edges);
+
+    } else {
+        // incremental construction (Verlet list): the candidates found within
+        // radius + skin remain complete as long as no two particles moved
+        // towards each other more than the spare distance.
+        size_t cnt = d.get_count();
+        float maxDisp = FLT_MAX;
+        if ((candidatePositions.size() == cnt * 3)
+                && (candidateCyclic[0] == cycX) && (candidateCyclic[1] == cycY) && (candidateCyclic[2] == cycZ)
+                && (!(cycX || cycY || cycZ) || (candidateBoxSize == bboxR.GetSize()))) {
+            std::vector<float> maxDispMT(omp_get_max_threads(), 0.0f);
+            #pragma omp parallel for
+            for (int i = 0; i < static_cast<int>(cnt); ++i) {
+                const float *p = d.get_position(i);
+                const float *q = candidatePositions.data() + i * 3;
+                float dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+                float &m = maxDispMT[omp_get_thread_num()];
+                m = std::max(m, dx * dx + dy * dy + dz * dz);
+            }
+            maxDisp = std::sqrt(*std::max_element(maxDispMT.begin(), maxDispMT.end()));
+        }
+
+        if ((maxDisp < FLT_MAX) && (neiRad + 2.0f * maxDisp <= candidateRadius)) {
+            vislib::sys::Log::DefaultLog.WriteInfo("PNhG reusing %u candidate edges (max displacement %f)",
+                static_cast<unsigned int>(candidates.size() / 2), maxDisp);
+        } else {
+            candidateRadius = neiRad + skin;
+            candidateCyclic[0] = cycX;
+            candidateCyclic[1] = cycY;
+            candidateCyclic[2] = cycZ;
+            candidateBoxSize = bboxR.GetSize();
+            candidatePositions.resize(cnt * 3);
+            for (size_t i = 0; i < cnt; ++i) {
+                std::copy_n(d.get_position(i), 3, candidatePositions.data() + i * 3);
+            }
+            candidates.clear();
+            this->findPairs(d, data, candidateRadius, candidates);
+        }
+
+        // select the actual edges from the candidates
+        float neiRadSq = neiRad * neiRad;
+        float bboxSize[3] = {bboxR.Width(), bboxR.Height(), bboxR.Depth()};
+        bool cyc[3] = {cycX, cycY, cycZ};
+        int candCnt = static_cast<int>(candidates.size() / 2);
+        std::vector<char> keep(candCnt);
+        #pragma omp parallel for
+        for (int ci = 0; ci < candCnt; ++ci) {
+            const float *p = d.get_position(candidates[ci * 2]);
+            const float *q = d.get_position(candidates[ci * 2 + 1]);
+            float sqDist = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                float dist = std::abs(p[k] - q[k]);
+                if (cyc[k]) dist = std::min(dist, std::abs(bboxSize[k] - dist));
+                sqDist += dist * dist;
+            }
+            keep[ci] = (sqDist < neiRadSq) ? 1 : 0;
+        }
+        edges.reserve(candidates.size());
+        for (int ci = 0; ci < candCnt; ++ci) {
+            if (keep[ci] == 0) continue;
+            edges.push_back(candidates[ci * 2]);
+            edges.push_back(candidates[ci * 2 + 1]);
+        }
+    }
+
+    end = high_resolution_clock::now();
+    vislib::sys::Log::DefaultLog.WriteInfo("PNhG edges computed in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    start = end;
+
+    //if (forceConnectIsolatedSlot.Param<core::param::BoolParam>()->Value()) {
+    //    // 1. detect connected components
+
+    //    // TODO: This is slow!
+
+    //    std::vector<unsigned int> comp_id(d.get_count());
+    //    std::fill(comp_id.begin(), comp_id.end(), 0);
+
+    //    unsigned int next_comp = 1;
+    //    for (size_t i = 0; i < d.get_count(); ++i) {
+    //        if (comp_id[i] != 0) continue;
+    //        comp_id[i] = next_comp;
+
+    //        bool updated = true;
+    //        while (updated) {
+    //            updated = false;
+    //            for (size_t e = 0; e < edges.size(); e += 2) {
+    //                size_t e1 = edges[e];
+    //                unsigned int &c1 = comp_id[e1];
+    //                size_t e2 = edges[e + 1];
+    //                unsigned int &c2 = comp_id[e2];
+    //                if ((c1 == next_comp) && (c2 == next_comp)) continue;
+    //                if (c1 == next_comp)  {
+    //                    assert(c2 == 0);
+    //                    c2 = next_comp;
+    //                    updated = true;
+    //                } else if (c2 == next_comp) {
+    //                    assert(c1 == 0);
+    //                    c1 = next_comp;
+    //                    updated = true;
+    //                }
+    //            }
+    //        }
+
+    //        next_comp++;
+    //    }
+
+    //    end = high_resolution_clock::now();
+    //    vislib::sys::Log::DefaultLog.WriteInfo("Neighborhood graph computed #2.1 in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    //    start = end;
+
+    //    if (next_comp > 2) {
+
+    //        // TODO: This is slow!
+
+    //        // compute centroids for connected components
+    //        std::vector<std::shared_ptr<graph_component> > comps(next_comp - 1);
+    //        for (unsigned int ci = 1; ci < next_comp; ci++) {
+    //            comps[ci - 1] = std::make_shared<graph_component>();
+    //            comps[ci - 1]->id = ci;
+    //            comps[ci - 1]->cnt = 0;
+    //            comps[ci - 1]->pos.SetNull();
+    //        }
+    //        for (size_t i = 0; i < d.get_count(); ++i) {
+    //            comps[comp_id[i] - 1]->cnt++;
+    //            comps[comp_id[i] - 1]->pos += vislib::math::ShallowVector<float, 3>(const_cast<float*>(d.get_position(i)));
+    //        }
+    //        size_t maxVal = 0;
+    //        std::shared_ptr<graph_component> mainComp; // index of the biggest component to merge everything to
+    //        for (std::shared_ptr<graph_component> c: comps) {
+    //             c->pos /= static_cast<double>(c->cnt);
+    //             if (c->cnt > maxVal) {
+    //                 maxVal = c->cnt;
+    //                 mainComp = c;
+    //             }
+    //        }
+    //        assert(mainComp);
+
+    //        // successively merge components into the biggest component
+    //        while (comps.size() > 1) {
+    //            // select the component closest to the biggest component
+    //            double dist = DBL_MAX;
+    //            std::shared_ptr<graph_component> selComp;
+    //            for (std::shared_ptr<graph_component> c : comps) {
+    //                if (c == mainComp) continue;
+    //                double d = (c->pos - mainComp->pos).Length();
+    //                if (d < dist) {
+    //                    dist = d;
+    //                    selComp = c;
+    //                }
+    //            }
+    //            assert(selComp);
+
+    //            // merge selComp into mainComp
+    //            // add an edge between the two nodes closest to the other centroid
+    //            size_t mainPId = static_cast<size_t>(-1);
+    //            double mainPDist = DBL_MAX;
+    //            for (size_t i = 0; i < d.get_count(); ++i) {
+    //                vislib::math::ShallowVector<float, 3> p(const_cast<float*>(d.get_position(i)));
+    //                if (comp_id[i] == mainComp->id) {
+    //                    double d = (selComp->pos - p).Length();
+    //                    if (d < mainPDist) {
+    //                        mainPDist = d;
+    //                        mainPId = i;
+    //                    }
+    //                }
+    //            }
+    //            vislib::math::ShallowVector<float, 3> maincomp_pos(const_cast<float*>(d.get_position(mainPId)));
+
+    //            size_t selPId = static_cast<size_t>(-1);
+    //            double selPDist = DBL_MAX;
+    //            for (size_t i = 0; i < d.get_count(); ++i) {
+    //                vislib::math::ShallowVector<float, 3> p(const_cast<float*>(d.get_position(i)));
+    //                if (comp_id[i] == selComp->id) {
+    //                    double d = (maincomp_pos - p).Length();
+    //                    if (d < selPDist) {
+    //                        selPDist = d;
+    //                        selPId = i;
+    //                    }
+    //                }
+    //            }
+    //            assert(mainPId != static_cast<size_t>(-1));
+    //            assert(selPId != static_cast<size_t>(-1));
+
+    //            edges.push_back(selPId);
+    //            edges.push_back(mainPId);
+
+    //            // remove old ids
+    //            for (size_t i = 0; i < d.get_count(); ++i) {
+    //                if (comp_id[i] == selComp->id) {
+    //                    comp_id[i] = mainComp->id;
+    //                }
+    //            }
+
+    //            // merge centroids
+    //            mainComp->pos *= static_cast<double>(mainComp->cnt);
+    //            selComp->pos *= static_cast<double>(selComp->cnt);
+    //            mainComp->pos += selComp->pos;
+    //            mainComp->cnt += selComp->cnt;
+    //            mainComp->pos /= static_cast<double>(mainComp->cnt);
+
+    //            comps.erase(std::find(comps.begin(), comps.end(), selComp));
+    //        }
+
+    //    }
+    //}
+
+    edges.shrink_to_fit();
+
+    end = high_resolution_clock::now();
+    vislib::sys::Log::DefaultLog.WriteInfo("PNhG completed in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+}
+
+void ParticleNeighborhoodGraph::findPairs(const MultiParticleDataAdaptor& d,
+        core::moldyn::MultiParticleDataCall* data, float rad, std::vector<index_t>& pairs) {
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start = high_resolution_clock::now(), end;
+
+    float radSq = rad * rad;
 
     vislib::math::Cuboid<float> box(
         vislib::math::ShallowPoint<float, 3>(const_cast<float*>(d.get_position(0))),
@@ -233,9 +471,9 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
             );
     }
 
-    unsigned int x_size = static_cast<unsigned int>(std::ceil(box.Width() / neiRad));
-    unsigned int y_size = static_cast<unsigned int>(std::ceil(box.Height() / neiRad));
-    unsigned int z_size = static_cast<unsigned int>(std::ceil(box.Depth() / neiRad));
+    unsigned int x_size = static_cast<unsigned int>(std::ceil(box.Width() / rad));
+    unsigned int y_size = static_cast<unsigned int>(std::ceil(box.Height() / rad));
+    unsigned int z_size = static_cast<unsigned int>(std::ceil(box.Depth() / rad));
 
     auto const& bboxR = data->AccessBoundingBoxes().ObjectSpaceBBox();
     auto const bboxCent = bboxR.CalcCenter();
@@ -253,7 +491,7 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
     std::vector<vislib::math::Vector<unsigned int, 3> > cell(d.get_count());
     for (size_t i = 0; i < d.get_count(); ++i) {
         vislib::math::Vector<float, 3> c = vislib::math::ShallowPoint<float, 3>(const_cast<float*>(d.get_position(i))) - box.GetLeftBottomBack();
-        cell[i] = c / neiRad;
+        cell[i] = c / rad;
         if (cell[i].X() >= x_size) cell[i].SetX(x_size - 1);
         if (cell[i].Y() >= y_size) cell[i].SetY(y_size - 1);
         if (cell[i].Z() >= z_size) cell[i].SetZ(z_size - 1);
@@ -290,7 +528,7 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
     vislib::sys::Log::DefaultLog.WriteInfo("PNhG search grid constructed in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
     start = end;
 
-    edges.reserve(d.get_count() * 2 * 4); // something
+    pairs.reserve(d.get_count() * 2 * 4); // something
 
     bool cycX = boundaryXCyclicSlot.Param<core::param::BoolParam>()->Value();
     bool cycY = boundaryYCyclicSlot.Param<core::param::BoolParam>()->Value();
@@ -387,12 +625,12 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
                     vislib::math::ShallowPoint<float, 3> nPtPos(const_cast<float*>(d.get_position(nPtIdx)));
                     for (vislib::math::Point<float, 3>& pt : testPoss) {
                         float sqDist = pt.SquareDistance(nPtPos);
-                        if (sqDist < neiRadSq) {
+                        if (sqDist < radSq) {
 
                             #pragma omp critical
                             {
-                                edges.push_back(static_cast<index_t>(ptIdx));
-                                edges.push_back(static_cast<index_t>(nPtIdx));
+                                pairs.push_back(static_cast<index_t>(ptIdx));
+                                pairs.push_back(static_cast<index_t>(nPtIdx));
                             }
 
                             break;
@@ -404,151 +642,4 @@ void ParticleNeighborhoodGraph::calcData(core::moldyn::MultiParticleDataCall* da
         }
 
     }
-
-    end = high_resolution_clock::now();
-    vislib::sys::Log::DefaultLog.WriteInfo("PNhG edges computed in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-    start = end;
-
-    //if (forceConnectIsolatedSlot.Param<core::param::BoolParam>()->Value()) {
-    //    // 1. detect connected components
-
-    //    // TODO: This is slow!
-
-    //    std::vector<unsigned int> comp_id(d.get_count());
-    //    std::fill(comp_id.begin(), comp_id.end(), 0);
-
-    //    unsigned int next_comp = 1;
-    //    for (size_t i = 0; i < d.get_count(); ++i) {
-    //        if (comp_id[i] != 0) continue;
-    //        comp_id[i] = next_comp;
-
-    //        bool updated = true;
-    //        while (updated) {
-    //            updated = false;
-    //            for (size_t e = 0; e < edges.size(); e += 2) {
-    //                size_t e1 = edges[e];
-    //                unsigned int &c1 = comp_id[e1];
-    //                size_t e2 = edges[e + 1];
-    //                unsigned int &c2 = comp_id[e2];
-    //                if ((c1 == next_comp) && (c2 == next_comp)) continue;
-    //                if (c1 == next_comp)  {
-    //                    assert(c2 == 0);
-    //                    c2 = next_comp;
-    //                    updated = true;
-    //                } else if (c2 == next_comp) {
-    //                    assert(c1 == 0);
-    //                    c1 = next_comp;
-    //                    updated = true;
-    //                }
-    //            }
-    //        }
-
-    //        next_comp++;
-    //    }
-
-    //    end = high_resolution_clock::now();
-    //    vislib::sys::Log::DefaultLog.WriteInfo("Neighborhood graph computed #2.1 in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-    //    start = end;
-
-    //    if (next_comp > 2) {
-
-    //        // TODO: This is slow!
-
-    //        // compute centroids for connected components
-    //        std::vector<std::shared_ptr<graph_component> > comps(next_comp - 1);
-    //        for (unsigned int ci = 1; ci < next_comp; ci++) {
-    //            comps[ci - 1] = std::make_shared<graph_component>();
-    //            comps[ci - 1]->id = ci;
-    //            comps[ci - 1]->cnt = 0;
-    //            comps[ci - 1]->pos.SetNull();
-    //        }
-    //        for (size_t i = 0; i < d.get_count(); ++i) {
-    //            comps[comp_id[i] - 1]->cnt++;
-    //            comps[comp_id[i] - 1]->pos += vislib::math::ShallowVector<float, 3>(const_cast<float*>(d.get_position(i)));
-    //        }
-    //        size_t maxVal = 0;
-    //        std::shared_ptr<graph_component> mainComp; // index of the biggest component to merge everything to
-    //        for (std::shared_ptr<graph_component> c: comps) {
-    //             c->pos /= static_cast<double>(c->cnt);
-    //             if (c->cnt > maxVal) {
-    //                 maxVal = c->cnt;
-    //                 mainComp = c;
-    //             }
-    //        }
-    //        assert(mainComp);
-
-    //        // successively merge components into the biggest component
-    //        while (comps.size() > 1) {
-    //            // select the component closest to the biggest component
-    //            double dist = DBL_MAX;
-    //            std::shared_ptr<graph_component> selComp;
-    //            for (std::shared_ptr<graph_component> c : comps) {
-    //                if (c == mainComp) continue;
-    //                double d = (c->pos - mainComp->pos).Length();
-    //                if (d < dist) {
-    //                    dist = d;
-    //                    selComp = c;
-    //                }
-    //            }
-    //            assert(selComp);
-
-    //            // merge selComp into mainComp
-    //            // add an edge between the two nodes closest to the other centroid
-    //            size_t mainPId = static_cast<size_t>(-1);
-    //            double mainPDist = DBL_MAX;
-    //            for (size_t i = 0; i < d.get_count(); ++i) {
-    //                vislib::math::ShallowVector<float, 3> p(const_cast<float*>(d.get_position(i)));
-    //                if (comp_id[i] == mainComp->id) {
-    //                    double d = (selComp->pos - p).Length();
-    //                    if (d < mainPDist) {
-    //                        mainPDist = d;
-    //                        mainPId = i;
-    //                    }
-    //                }
-    //            }
-    //            vislib::math::ShallowVector<float, 3> maincomp_pos(const_cast<float*>(d.get_position(mainPId)));
-
-    //            size_t selPId = static_cast<size_t>(-1);
-    //            double selPDist = DBL_MAX;
-    //            for (size_t i = 0; i < d.get_count(); ++i) {
-    //                vislib::math::ShallowVector<float, 3> p(const_cast<float*>(d.get_position(i)));
-    //                if (comp_id[i] == selComp->id) {
-    //                    double d = (maincomp_pos - p).Length();
-    //                    if (d < selPDist) {
-    //                        selPDist = d;
-    //                        selPId = i;
-    //                    }
-    //                }
-    //            }
-    //            assert(mainPId != static_cast<size_t>(-1));
-    //            assert(selPId != static_cast<size_t>(-1));
-
-    //            edges.push_back(selPId);
-    //            edges.push_back(mainPId);
-
-    //            // remove old ids
-    //            for (size_t i = 0; i < d.get_count(); ++i) {
-    //                if (comp_id[i] == selComp->id) {
-    //                    comp_id[i] = mainComp->id;
-    //                }
-    //            }
-
-    //            // merge centroids
-    //            mainComp->pos *= static_cast<double>(mainComp->cnt);
-    //            selComp->pos *= static_cast<double>(selComp->cnt);
-    //            mainComp->pos += selComp->pos;
-    //            mainComp->cnt += selComp->cnt;
-    //            mainComp->pos /= static_cast<double>(mainComp->cnt);
-
-    //            comps.erase(std::find(comps.begin(), comps.end(), selComp));
-    //        }
-
-    //    }
-    //}
-
-    edges.shrink_to_fit();
-
-    end = high_resolution_clock::now();
-    vislib::sys::Log::DefaultLog.WriteInfo("PNhG completed in %u ms", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-
 }
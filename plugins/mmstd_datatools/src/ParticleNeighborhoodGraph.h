@@ -10,6 +10,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "vislib/math/Dimension.h"
 #include <vector>
 #include <cstdint>
 
@@ -23,6 +24,8 @@ namespace moldyn {
 namespace stdplugin {
 namespace datatools {
 
+    class MultiParticleDataAdaptor;
+
     class ParticleNeighborhoodGraph : public core::Module {
     public:
         typedef uint32_t index_t;
@@ -52,6 +55,17 @@ namespace datatools {
 
         void calcData(core::moldyn::MultiParticleDataCall* data);
 
+        /**
+         * Collects all pairs of particles closer than rad using a search grid
+         *
+         * @param d The particles
+         * @param data The call providing the bounding box for cyclic boundaries
+         * @param rad The search radius
+         * @param pairs Receives the pairs of particle indices
+         */
+        void findPairs(const MultiParticleDataAdaptor& d, core::moldyn::MultiParticleDataCall* data,
+            float rad, std::vector<index_t>& pairs);
+
         core::CalleeSlot outGraphDataSlot;
         core::CallerSlot inParticleDataSlot;
         core::param::ParamSlot radiusSlot;
@@ -63,6 +77,7 @@ namespace datatools {
         core::param::ParamSlot boundaryXCyclicSlot;
         core::param::ParamSlot boundaryYCyclicSlot;
         core::param::ParamSlot boundaryZCyclicSlot;
+        core::param::ParamSlot skinSlot;
 
         unsigned int frameId;
         size_t inDataHash;
@@ -70,6 +85,13 @@ namespace datatools {
 
         std::vector<index_t> edges;
 
+        /** The pairs found within candidateRadius at candidatePositions, for the incremental mode */
+        std::vector<index_t> candidates;
+        std::vector<float> candidatePositions;
+        float candidateRadius;
+        bool candidateCyclic[3];
+        vislib::math::Dimension<float, 3> candidateBoxSize;
+
     };
 
 }
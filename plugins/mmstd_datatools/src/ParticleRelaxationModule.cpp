@@ -6,7 +6,13 @@
  */
 #include "stdafx.h"
 #include "ParticleRelaxationModule.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "vislib/sys/Log.h"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::stdplugin;
@@ -17,7 +23,15 @@ using namespace megamol::stdplugin;
  */
 datatools::ParticleRelaxationModule::ParticleRelaxationModule(void)
         : AbstractParticleManipulator("outData", "indata"),
+        maxIterationsSlot("maxIterations", "The maximum number of relaxation steps"),
+        toleranceSlot("tolerance", "The largest overlap, relative to the sum of the radii, considered relaxed"),
         dataHash(0), frameId(0), outDataHash(0), bbox(), cbox() {
+
+    this->maxIterationsSlot.SetParameter(new core::param::IntParam(100, 0));
+    this->MakeSlotAvailable(&this->maxIterationsSlot);
+
+    this->toleranceSlot.SetParameter(new core::param::FloatParam(0.01f, 0.0f));
+    this->MakeSlotAvailable(&this->toleranceSlot);
 }
 
 
@@ -36,7 +50,8 @@ bool datatools::ParticleRelaxationModule::manipulateExtent(
         megamol::core::moldyn::MultiParticleDataCall& outData,
         megamol::core::moldyn::MultiParticleDataCall& inData) {
 
-    if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0)) {
+    if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0)
+            || this->maxIterationsSlot.IsDirty() || this->toleranceSlot.IsDirty()) {
         // will be updates next frame
 
         // spoiler input boxes, because there seems to be a problem with the view3d
@@ -63,7 +78,10 @@ bool datatools::ParticleRelaxationModule::manipulateData(
         megamol::core::moldyn::MultiParticleDataCall& inData) {
     using megamol::core::moldyn::MultiParticleDataCall;
 
-    if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0)) {
+    if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0)
+            || this->maxIterationsSlot.IsDirty() || this->toleranceSlot.IsDirty()) {
+        this->maxIterationsSlot.ResetDirty();
+        this->toleranceSlot.ResetDirty();
         this->frameId = inData.FrameID();
         this->dataHash = inData.DataHash();
         this->outDataHash++;
@@ -110,18 +128,20 @@ bool datatools::ParticleRelaxationModule::manipulateData(
         }
 
         // now run relaxation code
-
-        // TODO: Implement!
+        if (cnt > 0) {
+            const unsigned int maxIterations = static_cast<unsigned int>(
+                std::max(0, this->maxIterationsSlot.Param<core::param::IntParam>()->Value()));
+            const float tolerance = this->toleranceSlot.Param<core::param::FloatParam>()->Value();
+            float residual = 0.0f;
+            unsigned int iterations = relax(this->data.As<float>(), cnt, maxIterations, tolerance, residual);
+            vislib::sys::Log::DefaultLog.WriteInfo("ParticleRelaxationModule: %u steps, remaining overlap %f",
+                iterations, residual);
+        }
 
         // finally compute new bounding boxes
         if (cnt > 0) {
-            float *vert = this->data.As<float>();
-            this->bbox.Set(vert[0], vert[1], vert[2], vert[0], vert[1], vert[2]);
-            float r = vert[3];
-            for (uint64_t pi = 1; pi < cnt; pi++, vert += 4) {
-                this->bbox.GrowToPoint(vert[0], vert[1], vert[2]);
-                r = std::max<float>(r, vert[3]);
-            }
+            float r;
+            computeBounds(this->data.As<float>(), cnt, this->bbox, r);
             this->cbox = this->bbox;
             this->cbox.Grow(r);
 
@@ -151,3 +171,159 @@ bool datatools::ParticleRelaxationModule::manipulateData(
 
     return true;
 }
+
+
+/*
+ * datatools::ParticleRelaxationModule::relax
+ */
+unsigned int datatools::ParticleRelaxationModule::relax(float *vert, uint64_t cnt, unsigned int maxIterations,
+        float tolerance, float& outResidual) {
+    // Jacobi updates of all neighbours at once overshoot in dense packings without under-relaxation
+    const float relaxationFactor = 0.5f;
+    const int chunkSize = 1 << 14;
+    const int chunkCnt = static_cast<int>((cnt + chunkSize - 1) / chunkSize);
+
+    std::vector<float> next(static_cast<size_t>(cnt * 4));
+    std::vector<uint64_t> cellOf(static_cast<size_t>(cnt));
+    std::vector<uint64_t> cellParticles(static_cast<size_t>(cnt));
+    std::vector<uint64_t> cellBegin;
+    std::vector<float> chunkResidual(chunkCnt);
+    float *cur = vert;
+    float *nxt = next.data();
+
+    outResidual = 0.0f;
+    unsigned int iter = 0;
+    while (true) {
+        vislib::math::Cuboid<float> box;
+        float maxRad;
+        computeBounds(cur, cnt, box, maxRad);
+        if (maxRad <= 0.0f) break;
+
+        // cells of the size of the largest diameter, such that all overlaps are with the 27 neighbouring cells
+        float cellSize = 2.0f * maxRad;
+        uint64_t dim[3];
+        while (true) {
+            dim[0] = static_cast<uint64_t>(box.Width() / cellSize) + 1;
+            dim[1] = static_cast<uint64_t>(box.Height() / cellSize) + 1;
+            dim[2] = static_cast<uint64_t>(box.Depth() / cellSize) + 1;
+            if (dim[0] * dim[1] * dim[2] <= 2 * cnt + 1) break;
+            cellSize *= 1.25f; // sparse data, keep the grid at most twice the particle count
+        }
+        const float orig[3] = {box.Left(), box.Bottom(), box.Back()};
+        auto cellCoord = [&](const float *v, int axis) {
+            return std::min<uint64_t>(static_cast<uint64_t>((v[axis] - orig[axis]) / cellSize), dim[axis] - 1);
+        };
+
+#pragma omp parallel for
+        for (int chunk = 0; chunk < chunkCnt; chunk++) {
+            const uint64_t end = std::min<uint64_t>(cnt, static_cast<uint64_t>(chunk + 1) * chunkSize);
+            for (uint64_t i = static_cast<uint64_t>(chunk) * chunkSize; i < end; i++) {
+                const float *v = cur + i * 4;
+                cellOf[i] = (cellCoord(v, 2) * dim[1] + cellCoord(v, 1)) * dim[0] + cellCoord(v, 0);
+            }
+        }
+
+        // counting sort of the particles by cell
+        cellBegin.assign(static_cast<size_t>(dim[0] * dim[1] * dim[2] + 1), 0);
+        for (uint64_t i = 0; i < cnt; i++) cellBegin[cellOf[i] + 1]++;
+        for (size_t c = 1; c < cellBegin.size(); c++) cellBegin[c] += cellBegin[c - 1];
+        {
+            std::vector<uint64_t> pos(cellBegin.begin(), cellBegin.end() - 1);
+            for (uint64_t i = 0; i < cnt; i++) cellParticles[pos[cellOf[i]]++] = i;
+        }
+
+        // every particle moves by half the overlaps with its neighbours, computed from the old positions only
+#pragma omp parallel for schedule(dynamic)
+        for (int chunk = 0; chunk < chunkCnt; chunk++) {
+            float residual = 0.0f;
+            const uint64_t end = std::min<uint64_t>(cnt, static_cast<uint64_t>(chunk + 1) * chunkSize);
+            for (uint64_t i = static_cast<uint64_t>(chunk) * chunkSize; i < end; i++) {
+                const float *v = cur + i * 4;
+                float move[3] = {0.0f, 0.0f, 0.0f};
+                const uint64_t c[3] = {cellCoord(v, 0), cellCoord(v, 1), cellCoord(v, 2)};
+                for (uint64_t z = (c[2] > 0) ? c[2] - 1 : 0; z <= std::min(c[2] + 1, dim[2] - 1); z++) {
+                    for (uint64_t y = (c[1] > 0) ? c[1] - 1 : 0; y <= std::min(c[1] + 1, dim[1] - 1); y++) {
+                        for (uint64_t x = (c[0] > 0) ? c[0] - 1 : 0; x <= std::min(c[0] + 1, dim[0] - 1); x++) {
+                            const uint64_t cell = (z * dim[1] + y) * dim[0] + x;
+                            for (uint64_t k = cellBegin[cell]; k < cellBegin[cell + 1]; k++) {
+                                const uint64_t j = cellParticles[k];
+                                if (j == i) continue;
+                                const float *w = cur + j * 4;
+                                const float d[3] = {v[0] - w[0], v[1] - w[1], v[2] - w[2]};
+                                const float dist = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                                const float overlap = v[3] + w[3] - dist;
+                                if (overlap <= 0.0f) continue;
+                                residual = std::max(residual, overlap / (v[3] + w[3]));
+                                const float push = relaxationFactor * 0.5f * overlap;
+                                if (dist > 0.0f) {
+                                    move[0] += d[0] / dist * push;
+                                    move[1] += d[1] / dist * push;
+                                    move[2] += d[2] / dist * push;
+                                } else {
+                                    // coincident particles separate along x, in the order of their indices
+                                    move[0] += (i < j) ? -push : push;
+                                }
+                            }
+                        }
+                    }
+                }
+                float *n = nxt + i * 4;
+                n[0] = v[0] + move[0];
+                n[1] = v[1] + move[1];
+                n[2] = v[2] + move[2];
+                n[3] = v[3];
+            }
+            chunkResidual[chunk] = residual;
+        }
+
+        outResidual = *std::max_element(chunkResidual.begin(), chunkResidual.end());
+        if ((outResidual <= tolerance) || (iter >= maxIterations)) break;
+        std::swap(cur, nxt);
+        iter++;
+    }
+
+    if (cur != vert) ::memcpy(vert, cur, static_cast<size_t>(cnt * 4 * sizeof(float)));
+    return iter;
+}
+
+
+/*
+ * datatools::ParticleRelaxationModule::computeBounds
+ */
+void datatools::ParticleRelaxationModule::computeBounds(const float *vert, uint64_t cnt,
+        vislib::math::Cuboid<float>& outBox, float& outMaxRadius) {
+    ASSERT(cnt > 0);
+    const int chunkSize = 1 << 16;
+    const int chunkCnt = static_cast<int>((cnt + chunkSize - 1) / chunkSize);
+    std::vector<float> chunkBounds(chunkCnt * 7);
+
+#pragma omp parallel for
+    for (int chunk = 0; chunk < chunkCnt; chunk++) {
+        float *b = chunkBounds.data() + chunk * 7;
+        const uint64_t begin = static_cast<uint64_t>(chunk) * chunkSize;
+        const uint64_t end = std::min<uint64_t>(cnt, begin + chunkSize);
+        const float *v = vert + begin * 4;
+        b[0] = b[3] = v[0];
+        b[1] = b[4] = v[1];
+        b[2] = b[5] = v[2];
+        b[6] = v[3];
+        for (uint64_t i = begin + 1; i < end; i++) {
+            v = vert + i * 4;
+            for (int a = 0; a < 3; a++) {
+                b[a] = std::min(b[a], v[a]);
+                b[a + 3] = std::max(b[a + 3], v[a]);
+            }
+            b[6] = std::max(b[6], v[3]);
+        }
+    }
+
+    const float *b = chunkBounds.data();
+    outBox.Set(b[0], b[1], b[2], b[3], b[4], b[5]);
+    outMaxRadius = b[6];
+    for (int chunk = 1; chunk < chunkCnt; chunk++) {
+        b = chunkBounds.data() + chunk * 7;
+        outBox.GrowToPoint(b[0], b[1], b[2]);
+        outBox.GrowToPoint(b[3], b[4], b[5]);
+        outMaxRadius = std::max(outMaxRadius, b[6]);
+    }
+}
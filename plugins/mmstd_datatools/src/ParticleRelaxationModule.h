@@ -20,7 +20,10 @@ namespace stdplugin {
 namespace datatools {
 
     /**
-     * Module overriding global attributes of particles
+     * Module relaxing overlapping particles. All particles are pushed apart
+     * from their overlapping neighbours, found through a uniform cell grid,
+     * with parallel Jacobi-style updates until the largest overlap falls
+     * below the tolerance or the iteration limit is reached.
      */
     class ParticleRelaxationModule : public AbstractParticleManipulator {
     public:
@@ -74,6 +77,37 @@ namespace datatools {
 
     private:
 
+        /**
+         * Relaxes the particles in place
+         *
+         * @param vert The particles as x, y, z, radius
+         * @param cnt The number of particles
+         * @param maxIterations The maximum number of updates
+         * @param tolerance The overlap relative to the sum of the radii considered relaxed
+         * @param outResidual Receives the largest relative overlap before the last update
+         *
+         * @return The number of updates performed
+         */
+        static unsigned int relax(float *vert, uint64_t cnt, unsigned int maxIterations, float tolerance,
+            float& outResidual);
+
+        /**
+         * Computes the bounding box of the particle centres and the largest radius in parallel
+         *
+         * @param vert The particles as x, y, z, radius
+         * @param cnt The number of particles, must be positive
+         * @param outBox Receives the bounding box
+         * @param outMaxRadius Receives the largest radius
+         */
+        static void computeBounds(const float *vert, uint64_t cnt, vislib::math::Cuboid<float>& outBox,
+            float& outMaxRadius);
+
+        /** The maximum number of relaxation steps */
+        core::param::ParamSlot maxIterationsSlot;
+
+        /** The largest overlap, relative to the sum of the radii, which ends the relaxation */
+        core::param::ParamSlot toleranceSlot;
+
         /** The hash id of the data stored */
         size_t dataHash;
 
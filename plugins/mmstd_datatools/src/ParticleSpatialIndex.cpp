@@ -0,0 +1,137 @@
+/*
+ * ParticleSpatialIndex.cpp
+ *
+ * Copyright (C) 2019 by MegaMol team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "ParticleSpatialIndex.h"
+
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+using namespace megamol;
+using namespace megamol::stdplugin;
+using megamol::core::moldyn::SimpleSphericalParticles;
+
+
+namespace {
+
+    /** The indices currently held by any module, by data hash, frame and list layout */
+    std::map<std::vector<uint64_t>, std::weak_ptr<const datatools::ParticleSpatialIndex>> indexCache;
+    std::mutex indexCacheLock;
+
+    bool hasFloatPositions(const SimpleSphericalParticles& pl) {
+        return (pl.GetVertexDataType() == SimpleSphericalParticles::VERTDATA_FLOAT_XYZ) ||
+               (pl.GetVertexDataType() == SimpleSphericalParticles::VERTDATA_FLOAT_XYZR);
+    }
+
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::Get
+ */
+std::shared_ptr<const datatools::ParticleSpatialIndex> datatools::ParticleSpatialIndex::Get(
+    megamol::core::moldyn::MultiParticleDataCall& dat) {
+
+    if (dat.DataHash() == 0) {
+        // nothing tells us whether two calls hold the same data
+        return std::shared_ptr<const ParticleSpatialIndex>(new ParticleSpatialIndex(dat));
+    }
+
+    // the hash alone is not unique across data sources, so the list layout is part of the key
+    std::vector<uint64_t> key;
+    key.reserve(2 + 4 * dat.GetParticleListCount());
+    key.push_back(static_cast<uint64_t>(dat.DataHash()));
+    key.push_back(dat.FrameID());
+    for (unsigned int pli = 0; pli < dat.GetParticleListCount(); ++pli) {
+        auto& pl = dat.AccessParticles(pli);
+        if (!hasFloatPositions(pl)) continue;
+        key.push_back(pli);
+        key.push_back(pl.GetCount());
+        key.push_back(reinterpret_cast<uintptr_t>(pl.GetVertexData()));
+        key.push_back(pl.GetVertexDataStride());
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(indexCacheLock);
+        for (auto it = indexCache.begin(); it != indexCache.end();) {
+            if (it->second.expired()) {
+                it = indexCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        auto it = indexCache.find(key);
+        if (it != indexCache.end()) {
+            auto idx = it->second.lock();
+            if (idx) return idx;
+        }
+    }
+
+    // build without holding the lock, other frames may be requested meanwhile
+    std::shared_ptr<const ParticleSpatialIndex> idx(new ParticleSpatialIndex(dat));
+
+    std::lock_guard<std::mutex> guard(indexCacheLock);
+    auto& entry = indexCache[key];
+    auto other = entry.lock();
+    if (other) return other; // someone else was faster
+    entry = idx;
+    return idx;
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::~ParticleSpatialIndex
+ */
+datatools::ParticleSpatialIndex::~ParticleSpatialIndex(void) {
+    // intentionally empty
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::ParticleSpatialIndex
+ */
+datatools::ParticleSpatialIndex::ParticleSpatialIndex(megamol::core::moldyn::MultiParticleDataCall& dat)
+    : pts(), tree(3 /* dim */, pts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */)) {
+
+    const unsigned int plc = dat.GetParticleListCount();
+    std::vector<size_t> offsets(plc, 0);
+    size_t total = 0;
+    for (unsigned int pli = 0; pli < plc; ++pli) {
+        offsets[pli] = total;
+        if (hasFloatPositions(dat.AccessParticles(pli))) total += dat.AccessParticles(pli).GetCount();
+    }
+
+    this->pts.positions.resize(3 * total);
+    this->pts.bbox = dat.AccessBoundingBoxes().ObjectSpaceBBox();
+
+    for (unsigned int pli = 0; pli < plc; ++pli) {
+        auto& pl = dat.AccessParticles(pli);
+        if (!hasFloatPositions(pl)) continue;
+
+        unsigned int vert_stride = (pl.GetVertexDataType() == SimpleSphericalParticles::VERTDATA_FLOAT_XYZ) ? 12 : 16;
+        vert_stride = std::max<unsigned int>(vert_stride, pl.GetVertexDataStride());
+        const unsigned char* vert = static_cast<const unsigned char*>(pl.GetVertexData());
+        float* dst = this->pts.positions.data() + 3 * offsets[pli];
+
+        const INT64 cnt = static_cast<INT64>(pl.GetCount());
+#pragma omp parallel for
+        for (INT64 i = 0; i < cnt; ++i) {
+            const float* src = reinterpret_cast<const float*>(vert + i * vert_stride);
+            dst[3 * i + 0] = src[0];
+            dst[3 * i + 1] = src[1];
+            dst[3 * i + 2] = src[2];
+        }
+    }
+
+    vislib::sys::Log::DefaultLog.WriteInfo("ParticleSpatialIndex: building acceleration structure for %zu particles...",
+        total);
+    this->tree.buildIndex();
+    vislib::sys::Log::DefaultLog.WriteInfo("ParticleSpatialIndex: done.");
+}
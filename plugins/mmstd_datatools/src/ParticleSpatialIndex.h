@@ -0,0 +1,146 @@
+/*
+ * ParticleSpatialIndex.h
+ *
+ * Copyright (C) 2019 by MegaMol team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMSTD_DATATOOLS_PARTICLESPATIALINDEX_H_INCLUDED
+#define MMSTD_DATATOOLS_PARTICLESPATIALINDEX_H_INCLUDED
+#pragma once
+
+#include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "vislib/math/Cuboid.h"
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <nanoflann.hpp>
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /**
+     * k-d tree over the positions of all particle lists with float positions, shared by all modules asking for the
+     * same frame of the same data.
+     *
+     * The index space is the one of simplePointcloud, i.e. the particles of all lists with float positions in list
+     * order. The positions are copied, so the index stays valid independently of the call it was built from. All
+     * queries are const and may be issued concurrently.
+     */
+    class ParticleSpatialIndex {
+    public:
+
+        /**
+         * Answer the index of a frame of a call, building it if no other module holds it.
+         *
+         * The call must already hold the data of the frame. Indices are shared between modules if the data hash of
+         * the call is not zero.
+         *
+         * @param dat The call holding the particles
+         *
+         * @return The index
+         */
+        static std::shared_ptr<const ParticleSpatialIndex> Get(megamol::core::moldyn::MultiParticleDataCall& dat);
+
+        /** Answer the number of indexed particles */
+        inline size_t GetCount(void) const {
+            return this->pts.positions.size() / 3;
+        }
+
+        /** Answer the position of a particle */
+        inline const float* GetPosition(size_t index) const {
+            return this->pts.positions.data() + 3 * index;
+        }
+
+        /**
+         * Find all particles closer than a radius.
+         *
+         * @param pos The centre of the search
+         * @param sqRadius The squared search radius
+         * @param matches Receives the indices and squared distances of the particles found
+         * @param params The search parameters
+         *
+         * @return The number of particles found
+         */
+        inline size_t RadiusSearch(const float* pos, float sqRadius, std::vector<std::pair<size_t, float>>& matches,
+            const nanoflann::SearchParams& params) const {
+            return this->tree.radiusSearch(pos, sqRadius, matches, params);
+        }
+
+        /**
+         * Find the nearest particles.
+         *
+         * @param result The result set, initialised with the number of particles to find
+         * @param pos The centre of the search
+         * @param params The search parameters
+         */
+        template<class RESULT>
+        inline void FindNeighbors(RESULT& result, const float* pos, const nanoflann::SearchParams& params) const {
+            this->tree.findNeighbors(result, pos, params);
+        }
+
+        /** Dtor */
+        ~ParticleSpatialIndex(void);
+
+    private:
+
+        /** nanoflann adaptor over the copied positions */
+        class pointcloud {
+        public:
+
+            typedef float coord_t;
+
+            inline size_t kdtree_get_point_count() const {
+                return this->positions.size() / 3;
+            }
+
+            inline coord_t kdtree_distance(const coord_t* p1, const size_t idx_p2, size_t /*size*/) const {
+                const coord_t* p2 = this->positions.data() + 3 * idx_p2;
+                const coord_t d0 = p1[0] - p2[0];
+                const coord_t d1 = p1[1] - p2[1];
+                const coord_t d2 = p1[2] - p2[2];
+                return d0 * d0 + d1 * d1 + d2 * d2;
+            }
+
+            inline coord_t kdtree_get_pt(const size_t idx, int dim) const {
+                assert((dim >= 0) && (dim < 3));
+                return this->positions[3 * idx + dim];
+            }
+
+            template <class BBOX>
+            bool kdtree_get_bbox(BBOX& bb) const {
+                assert(bb.size() == 3);
+                bb[0].low = this->bbox.Left();
+                bb[0].high = this->bbox.Right();
+                bb[1].low = this->bbox.Bottom();
+                bb[1].high = this->bbox.Top();
+                bb[2].low = this->bbox.Back();
+                bb[2].high = this->bbox.Front();
+                return true;
+            }
+
+            std::vector<float> positions;
+            vislib::math::Cuboid<float> bbox;
+        };
+
+        typedef nanoflann::KDTreeSingleIndexAdaptor<
+            nanoflann::L2_Simple_Adaptor<float, pointcloud>,
+            pointcloud,
+            3 /* dim */
+        > tree_type;
+
+        /** Ctor, copies the positions and builds the tree */
+        ParticleSpatialIndex(megamol::core::moldyn::MultiParticleDataCall& dat);
+
+        pointcloud pts;
+        tree_type tree;
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MMSTD_DATATOOLS_PARTICLESPATIALINDEX_H_INCLUDED */
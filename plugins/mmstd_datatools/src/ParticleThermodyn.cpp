@@ -12,12 +12,15 @@
 #include <cfloat>
 #include <cfenv>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <omp.h>
+#include "mmcore/CoreInstance.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
+#include "vislib/graphics/gl/ShaderSource.h"
 #include "vislib/sys/ConsoleProgressBar.h"
 #include "vislib/sys/Log.h"
 
@@ -46,6 +49,8 @@ datatools::ParticleThermodyn::ParticleThermodyn(void)
                                         "sure you have a transfer function that has stops at 0.4 and 0.5. The 0.5 stop "
                                         "allows you to highlight the neighbors responsible for the extremes.")
     , extremeValueSlot("extreme value", "the extreme value that you find weird")
+    , backendSlot("backend", "compute the metrics on the CPU or with a compute shader. The compute shader supports "
+                             "all metrics but density and pressure, and no extremes, these fall back to the CPU.")
     , datahash(0)
     , lastTime(-1)
     , newColors()
@@ -53,6 +58,9 @@ datatools::ParticleThermodyn::ParticleThermodyn(void)
     , maxDist(0.0f)
     , particleTree(nullptr)
     , myPts(nullptr)
+    , metricsShader()
+    , metricsShaderTried(false)
+    , metricsShaderOK(false)
     , outDataSlot("outData", "Provides intensities based on a local particle metric")
     , inDataSlot("inData", "Takes the directional particle data") {
 
@@ -109,6 +117,14 @@ datatools::ParticleThermodyn::ParticleThermodyn(void)
     this->extremeValueSlot.SetParameter(new core::param::FloatParam(50.0));
     this->MakeSlotAvailable(&this->extremeValueSlot);
 
+    core::param::EnumParam* be = new core::param::EnumParam(backendEnum::GPU);
+    be->SetTypePair(backendEnum::CPU, "CPU");
+    be->SetTypePair(backendEnum::GPU, "GPU");
+    this->backendSlot << be;
+    this->MakeSlotAvailable(&this->backendSlot);
+
+    std::fill(std::begin(this->gpuBuffers), std::end(this->gpuBuffers), 0);
+
     this->outDataSlot.SetCallback(
         megamol::core::moldyn::MultiParticleDataCall::ClassName(), "GetData", &ParticleThermodyn::getDataCallback);
     this->outDataSlot.SetCallback(
@@ -144,7 +160,7 @@ bool isListOK(megamol::core::moldyn::MultiParticleDataCall* in, const unsigned i
 /*
  * datatools::ParticleThermodyn::release
  */
-void datatools::ParticleThermodyn::release(void) {}
+void datatools::ParticleThermodyn::release(void) { this->releaseGPU(); }
 
 
 bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCall* in,
@@ -220,11 +236,7 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
         assert(allpartcnt == totalParts);
         this->myPts = std::make_shared<simplePointcloud>(in, allParts);
 
-        vislib::sys::Log::DefaultLog.WriteInfo("ParticleThermodyn: building acceleration structure...");
-        particleTree = std::make_shared<my_kd_tree_t>(
-            3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-        particleTree->buildIndex();
-        vislib::sys::Log::DefaultLog.WriteInfo("ParticleThermodyn: done.");
+        particleTree = ParticleSpatialIndex::Get(*in);
 
         this->datahash = in->DataHash();
         this->lastTime = time;
@@ -234,7 +246,7 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
     if (this->radiusSlot.IsDirty() || this->cyclXSlot.IsDirty() || this->cyclYSlot.IsDirty() ||
         this->cyclZSlot.IsDirty() || this->numNeighborSlot.IsDirty() || this->searchTypeSlot.IsDirty() ||
         this->metricsSlot.IsDirty() || this->removeSelfSlot.IsDirty() || this->findExtremesSlot.IsDirty() ||
-        this->extremeValueSlot.IsDirty()) {
+        this->extremeValueSlot.IsDirty() || this->backendSlot.IsDirty()) {
         allpartcnt = 0;
         ++myHash;
 
@@ -256,10 +268,13 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
 
         const bool remove_self = this->removeSelfSlot.Param<megamol::core::param::BoolParam>()->Value();
 
+        const bool onGPU = (this->backendSlot.Param<core::param::EnumParam>()->Value() == backendEnum::GPU) &&
+                           this->computeMetricsGPU(bbox, cycl_x, cycl_y, cycl_z, remove_self, theMinTemp, theMaxTemp);
+
         allpartcnt = 0;
         for (unsigned int pli = 0; pli < plc; pli++) {
             auto& pl = in->AccessParticles(pli);
-            if (!isListOK(in, pli)) {
+            if (onGPU || !isListOK(in, pli)) {
                 continue;
             }
 
@@ -279,9 +294,11 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
                 float theVertex[3];
                 std::vector<std::pair<size_t, float>> ret_matches;
                 std::vector<std::pair<size_t, float>> ret_localMatches;
-                std::vector<size_t> ret_index(theNumber);
-                std::vector<float> out_dist_sqr(theNumber);
+                std::vector<size_t> ret_index(theNumber + 1);
+                std::vector<float> out_dist_sqr(theNumber + 1);
                 nanoflann::KNNResultSet<float> resultSet(theNumber);
+                // one more hit for the unshifted query, since the particle itself may take one
+                nanoflann::KNNResultSet<float> reachResultSet(theNumber + 1);
                 nanoflann::SearchParams params;
                 params.sorted = false;
                 ret_matches.reserve(100);
@@ -294,13 +311,33 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
 
                     INT64 myIndex = part_i + allpartcnt;
                     ret_matches.clear();
-                    const float* vertexBase = this->myPts->get_position(myIndex);
+                    const float* vertexBase = this->particleTree->GetPosition(myIndex);
                     // const float *velocityBase = this->myPts->get_velocity(myIndex);
 
+                    // squared distance between a periodic image of the particle and the box, i.e. the nearest
+                    // particle the image could find, per shifted dimension
+                    float gapSq[3];
+                    for (int d = 0; d < 3; ++d) {
+                        const float lo = (d == 0) ? bbox.Left() : ((d == 1) ? bbox.Bottom() : bbox.Back());
+                        const float hi = (d == 0) ? bbox.Right() : ((d == 1) ? bbox.Top() : bbox.Front());
+                        const float c = (d == 0) ? bbox_cntr.X() : ((d == 1) ? bbox_cntr.Y() : bbox_cntr.Z());
+                        const float gap = std::max(0.0f, (vertexBase[d] > c) ? hi - vertexBase[d] : vertexBase[d] - lo);
+                        gapSq[d] = gap * gap;
+                    }
+                    // the radius beyond which no image can contribute, known after the unshifted query for kNN
+                    float reachSq = (theSearchType == searchTypeEnum::RADIUS) ? theSquaredRadius + eps
+                                                                             : std::numeric_limits<float>::max();
+
                     for (int x_s = 0; x_s < (cycl_x ? 2 : 1); ++x_s) {
                         for (int y_s = 0; y_s < (cycl_y ? 2 : 1); ++y_s) {
                             for (int z_s = 0; z_s < (cycl_z ? 2 : 1); ++z_s) {
 
+                                // most particles are far from the boundary, skip the images that cannot reach
+                                if ((x_s + y_s + z_s > 0) &&
+                                    (x_s * gapSq[0] + y_s * gapSq[1] + z_s * gapSq[2] > reachSq)) {
+                                    continue;
+                                }
+
                                 theVertex[0] = vertexBase[0];
                                 theVertex[1] = vertexBase[1];
                                 theVertex[2] = vertexBase[2];
@@ -317,7 +354,7 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
                                 if (theSearchType == searchTypeEnum::RADIUS) {
                                     // the documentation says the parameter radius for L2 is squared
                                     // caution: the criterion is < radius, not <= !!!!
-                                    particleTree->radiusSearch(
+                                    particleTree->RadiusSearch(
                                         theVertex, theSquaredRadius + eps, ret_localMatches, params);
                                     if (remove_self) {
                                         ret_localMatches.erase(
@@ -330,12 +367,41 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
                                     ret_matches.insert(
                                         ret_matches.end(), ret_localMatches.begin(), ret_localMatches.end());
                                 } else {
-                                    resultSet.init(ret_index.data(), out_dist_sqr.data());
-                                    particleTree->findNeighbors(resultSet, theVertex, params);
-                                    for (size_t i = 0; i < resultSet.size(); ++i) {
-                                        if (!remove_self || ret_index[i] != myIndex) {
-                                            ret_matches.push_back(
-                                                std::pair<size_t, float>(ret_index[i], out_dist_sqr[i]));
+                                    // The reach is the distance of the k-th neighbor other than the particle
+                                    // itself. If the particle is to be removed, the unshifted query needs one
+                                    // more hit for that, of which only the k nearest are used as before.
+                                    const bool unshifted = (x_s + y_s + z_s == 0);
+                                    const bool extended = unshifted && remove_self;
+                                    nanoflann::KNNResultSet<float>& rs = extended ? reachResultSet : resultSet;
+                                    rs.init(ret_index.data(), out_dist_sqr.data());
+                                    particleTree->FindNeighbors(rs, theVertex, params);
+                                    ret_localMatches.clear();
+                                    for (size_t i = 0; i < rs.size(); ++i) {
+                                        ret_localMatches.push_back(
+                                            std::pair<size_t, float>(ret_index[i], out_dist_sqr[i]));
+                                    }
+                                    if (extended) {
+                                        std::sort(ret_localMatches.begin(), ret_localMatches.end(),
+                                            [](const std::pair<size_t, float>& l, const std::pair<size_t, float>& r) {
+                                                return l.second < r.second;
+                                            });
+                                        size_t others = 0;
+                                        for (const auto& m : ret_localMatches) {
+                                            if ((m.first != myIndex) && (++others == static_cast<size_t>(theNumber))) {
+                                                reachSq = m.second;
+                                                break;
+                                            }
+                                        }
+                                        if (ret_localMatches.size() > static_cast<size_t>(theNumber)) {
+                                            ret_localMatches.resize(theNumber);
+                                        }
+                                    } else if (unshifted && (rs.size() == static_cast<size_t>(theNumber))) {
+                                        reachSq =
+                                            *std::max_element(out_dist_sqr.begin(), out_dist_sqr.begin() + theNumber);
+                                    }
+                                    for (const auto& m : ret_localMatches) {
+                                        if (!remove_self || m.first != myIndex) {
+                                            ret_matches.push_back(m);
                                         }
                                     }
                                 }
@@ -447,6 +513,7 @@ bool datatools::ParticleThermodyn::assertData(core::moldyn::MultiParticleDataCal
         this->removeSelfSlot.ResetDirty();
         this->findExtremesSlot.ResetDirty();
         this->extremeValueSlot.ResetDirty();
+        this->backendSlot.ResetDirty();
     }
 
     // now the colors are known, inject them
@@ -549,7 +616,7 @@ float megamol::stdplugin::datatools::ParticleThermodyn::computeDensity(std::vect
     std::vector<float> part;
     part.reserve(num_matches * 4);
     for (size_t i = 0; i < num_matches; ++i) {
-        auto coord = myPts->get_position(matches[i].first);
+        auto coord = particleTree->GetPosition(matches[i].first);
         part.push_back(
             cycl_x ? coord[0] - bbox.Width() * std::nearbyintf((coord[0] - curPoint[0]) / bbox.Width()) : coord[0]);
         part.push_back(
@@ -571,6 +638,208 @@ float megamol::stdplugin::datatools::ParticleThermodyn::computeDensity(std::vect
 }
 
 
+
+/*
+ * datatools::ParticleThermodyn::computeMetricsGPU
+ */
+bool datatools::ParticleThermodyn::computeMetricsGPU(vislib::math::Cuboid<float> const& bbox, bool cycl_x,
+    bool cycl_y, bool cycl_z, bool remove_self, float& theMinTemp, float& theMaxTemp) {
+    using vislib::sys::Log;
+
+    // must match MAX_K in thermodyn::metrics
+    const int maxNeighbors = 64;
+    // at most that many cells in any direction
+    const int maxGridDim = 512;
+    // particles per dispatch, so a single one does not stall the display for long
+    const size_t batchSize = static_cast<size_t>(1) << 20;
+
+    const float theRadius = this->radiusSlot.Param<core::param::FloatParam>()->Value();
+    const float theMass = this->massSlot.Param<core::param::FloatParam>()->Value();
+    const float theFreedom = this->freedomSlot.Param<core::param::FloatParam>()->Value();
+    const int theNumber = this->numNeighborSlot.Param<core::param::IntParam>()->Value();
+    const auto theSearchType = this->searchTypeSlot.Param<core::param::EnumParam>()->Value();
+    const auto theMetrics = this->metricsSlot.Param<core::param::EnumParam>()->Value();
+    const bool findExtremes = this->findExtremesSlot.Param<megamol::core::param::BoolParam>()->Value();
+
+    if ((theMetrics == metricsEnum::DENSITY) || (theMetrics == metricsEnum::PRESSURE) || findExtremes) {
+        Log::DefaultLog.WriteInfo("ParticleThermodyn: computing density, pressure and extremes on the CPU");
+        return false;
+    }
+    if ((theSearchType == searchTypeEnum::NUM_NEIGHBORS) && ((theNumber < 1) || (theNumber > maxNeighbors))) {
+        Log::DefaultLog.WriteInfo(
+            "ParticleThermodyn: computing on the CPU, the GPU collects between 1 and %d neighbors", maxNeighbors);
+        return false;
+    }
+    const size_t cnt = this->newColors.size();
+    if ((cnt == 0) || (this->particleTree == nullptr) || (this->particleTree->GetCount() != cnt) ||
+        (cnt > std::numeric_limits<GLuint>::max())) {
+        return false;
+    }
+
+    if (!this->metricsShaderTried) {
+        this->metricsShaderTried = true;
+        if (!ogl_IsVersionGEQ(4, 3)) {
+            Log::DefaultLog.WriteWarn("ParticleThermodyn: OpenGL 4.3 is missing, computing on the CPU");
+            return false;
+        }
+        vislib::graphics::gl::ShaderSource comp;
+        try {
+            if (!this->instance()->ShaderSourceFactory().MakeShaderSource("thermodyn::metrics", comp) ||
+                !this->metricsShader.Compile(comp.Code(), comp.Count()) || !this->metricsShader.Link()) {
+                throw vislib::Exception("Generic creation failure", __FILE__, __LINE__);
+            }
+            glGenBuffers(4, this->gpuBuffers);
+            this->metricsShaderOK = true;
+        } catch (vislib::Exception& e) {
+            Log::DefaultLog.WriteWarn(
+                "ParticleThermodyn: unable to create the metrics shader, computing on the CPU: %s", e.GetMsgA());
+        }
+    }
+    if (!this->metricsShaderOK) {
+        return false;
+    }
+
+    // the grid: about theNumber particles in eight cells, or cells as large as the radius, so
+    // the neighbors are found within the next few rings of cells
+    const float extent[3] = {bbox.Width(), bbox.Height(), bbox.Depth()};
+    const float origin[3] = {bbox.Left(), bbox.Bottom(), bbox.Back()};
+    const bool cyclic[3] = {cycl_x && (extent[0] > 0.0f), cycl_y && (extent[1] > 0.0f), cycl_z && (extent[2] > 0.0f)};
+    const float maxExtent = std::max(extent[0], std::max(extent[1], extent[2]));
+    if (!(maxExtent > 0.0f)) {
+        return false;
+    }
+    double volume = 1.0;
+    for (int d = 0; d < 3; ++d) {
+        volume *= std::max(extent[d], maxExtent / maxGridDim);
+    }
+    float cell = (theSearchType == searchTypeEnum::RADIUS)
+                     ? theRadius
+                     : 0.5f * static_cast<float>(std::cbrt(volume * theNumber / static_cast<double>(cnt)));
+    cell = std::max(cell, static_cast<float>(std::cbrt(volume / static_cast<double>(cnt))));
+    cell = std::max(cell, maxExtent / maxGridDim);
+    GLint gridDim[3];
+    float cellSize[3];
+    for (int d = 0; d < 3; ++d) {
+        gridDim[d] = std::max(1, std::min(maxGridDim, static_cast<int>(extent[d] / cell)));
+        cellSize[d] = (extent[d] > 0.0f) ? extent[d] / gridDim[d] : cell;
+    }
+    const size_t cellCount = static_cast<size_t>(gridDim[0]) * gridDim[1] * gridDim[2];
+
+    // counting sort of the particles by cell
+    const bool needVelocities =
+        (theMetrics == metricsEnum::TEMPERATURE) || (theMetrics == metricsEnum::FRACTIONAL_ANISOTROPY);
+    std::vector<GLuint> cellOf(cnt);
+    std::vector<GLuint> cellStarts(cellCount + 1, 0);
+#pragma omp parallel for
+    for (INT64 i = 0; i < static_cast<INT64>(cnt); ++i) {
+        const float* pos = this->particleTree->GetPosition(i);
+        int c[3];
+        for (int d = 0; d < 3; ++d) {
+            c[d] = static_cast<int>(std::floor((pos[d] - origin[d]) / cellSize[d]));
+            c[d] = std::max(0, std::min(gridDim[d] - 1, c[d]));
+        }
+        cellOf[i] = static_cast<GLuint>((c[2] * gridDim[1] + c[1]) * gridDim[0] + c[0]);
+    }
+    for (size_t i = 0; i < cnt; ++i) {
+        ++cellStarts[cellOf[i] + 1];
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        cellStarts[c + 1] += cellStarts[c];
+    }
+    std::vector<GLuint> next(cellStarts.begin(), cellStarts.end() - 1);
+    std::vector<float> positions(cnt * 4);
+    std::vector<float> velocities(needVelocities ? cnt * 4 : 4, 0.0f);
+    for (size_t i = 0; i < cnt; ++i) {
+        const size_t slot = next[cellOf[i]]++;
+        const float* pos = this->particleTree->GetPosition(i);
+        for (int d = 0; d < 3; ++d) {
+            positions[slot * 4 + d] = pos[d] - origin[d];
+        }
+        const GLuint idx = static_cast<GLuint>(i);
+        std::memcpy(&positions[slot * 4 + 3], &idx, sizeof(GLuint));
+        if (needVelocities) {
+            const float* velo = this->myPts->get_velocity(i);
+            for (int d = 0; d < 3; ++d) {
+                velocities[slot * 4 + d] = velo[d];
+            }
+        }
+    }
+    cellOf.clear();
+    cellOf.shrink_to_fit();
+    next.clear();
+    next.shrink_to_fit();
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->gpuBuffers[0]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->gpuBuffers[1]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, velocities.size() * sizeof(float), velocities.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->gpuBuffers[2]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, cellStarts.size() * sizeof(GLuint), cellStarts.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->gpuBuffers[3]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, cnt * sizeof(float), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        Log::DefaultLog.WriteWarn("ParticleThermodyn: out of GPU memory, computing on the CPU");
+        this->releaseGPU();
+        glGenBuffers(4, this->gpuBuffers);
+        return false;
+    }
+
+    this->metricsShader.Enable();
+    glUniform1ui(this->metricsShader.ParameterLocation("particleCount"), static_cast<GLuint>(cnt));
+    glUniform3iv(this->metricsShader.ParameterLocation("gridDim"), 1, gridDim);
+    glUniform3fv(this->metricsShader.ParameterLocation("cellSize"), 1, cellSize);
+    glUniform3fv(this->metricsShader.ParameterLocation("boxSize"), 1, extent);
+    glUniform3i(this->metricsShader.ParameterLocation("cyclic"), cyclic[0] ? 1 : 0, cyclic[1] ? 1 : 0, cyclic[2] ? 1 : 0);
+    glUniform1i(this->metricsShader.ParameterLocation("searchType"), (theSearchType == searchTypeEnum::RADIUS) ? 0 : 1);
+    // same criterion as the radius search of the CPU
+    glUniform1f(this->metricsShader.ParameterLocation("sqRadius"),
+        theRadius * theRadius + std::sqrt(std::numeric_limits<float>::epsilon()));
+    glUniform1i(this->metricsShader.ParameterLocation("numNeighbors"), theNumber);
+    glUniform1i(this->metricsShader.ParameterLocation("metric"), theMetrics);
+    glUniform1i(this->metricsShader.ParameterLocation("removeSelf"), remove_self ? 1 : 0);
+    glUniform1f(this->metricsShader.ParameterLocation("mass"), theMass);
+    glUniform1f(this->metricsShader.ParameterLocation("freedom"), theFreedom);
+    for (GLuint binding = 0; binding < 4; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, this->gpuBuffers[binding]);
+    }
+    for (size_t offset = 0; offset < cnt; offset += batchSize) {
+        const size_t batch = std::min(batchSize, cnt - offset);
+        glUniform1ui(this->metricsShader.ParameterLocation("offset"), static_cast<GLuint>(offset));
+        this->metricsShader.Dispatch(static_cast<unsigned int>((batch + 127) / 128), 1, 1);
+        glFlush();
+    }
+    for (GLuint binding = 0; binding < 4; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    this->metricsShader.Disable();
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->gpuBuffers[3]);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, cnt * sizeof(float), this->newColors.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    for (size_t i = 0; i < cnt; ++i) {
+        const float magnitude = this->newColors[i];
+        if (magnitude < theMinTemp) theMinTemp = magnitude;
+        if (magnitude > theMaxTemp) theMaxTemp = magnitude;
+    }
+    Log::DefaultLog.WriteInfo("ParticleThermodyn: computed %zu particles on the GPU in a %d x %d x %d grid", cnt,
+        gridDim[0], gridDim[1], gridDim[2]);
+    return true;
+}
+
+
+/*
+ * datatools::ParticleThermodyn::releaseGPU
+ */
+void datatools::ParticleThermodyn::releaseGPU(void) {
+    if (this->gpuBuffers[0] != 0) {
+        glDeleteBuffers(4, this->gpuBuffers);
+        std::fill(std::begin(this->gpuBuffers), std::end(this->gpuBuffers), 0);
+    }
+}
+
 bool datatools::ParticleThermodyn::getExtentCallback(megamol::core::Call& c) {
     using megamol::core::moldyn::MultiParticleDataCall;
 
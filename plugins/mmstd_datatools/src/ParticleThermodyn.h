@@ -15,6 +15,9 @@
 #include "mmcore/Module.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "PointcloudHelpers.h"
+#include "ParticleSpatialIndex.h"
+#include "vislib/graphics/gl/GLSLComputeShader.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
 #include <vector>
 #include <nanoflann.hpp>
 #include <Eigen/Eigenvalues>
@@ -43,6 +46,11 @@ namespace datatools {
             NEAREST_DISTANCE
         };
 
+        enum backendEnum {
+            CPU,
+            GPU
+        };
+
         /** Return module class name */
         static const char *ClassName(void) {
             return "ParticleThermodyn";
@@ -99,6 +107,19 @@ namespace datatools {
         float computeFractionalAnisotropy(std::vector<std::pair<size_t, float> > &matches, size_t num_matches);
         float computeDensity(std::vector<std::pair<size_t, float> > &matches, size_t num_matches, float const curPoint[3], float radius, vislib::math::Cuboid<float> const& bbox);
 
+        /**
+         * Computes the metric of all particles with a compute shader, searching
+         * the neighbors in a uniform grid.
+         *
+         * @return false if the metric or the search is not supported on the GPU,
+         *         the metric must then be computed on the CPU
+         */
+        bool computeMetricsGPU(vislib::math::Cuboid<float> const& bbox, bool cycl_x, bool cycl_y, bool cycl_z,
+            bool remove_self, float& theMinTemp, float& theMaxTemp);
+
+        /** Releases the buffers of the compute shader */
+        void releaseGPU(void);
+
         core::param::ParamSlot cyclXSlot;
         core::param::ParamSlot cyclYSlot;
         core::param::ParamSlot cyclZSlot;
@@ -113,6 +134,7 @@ namespace datatools {
         core::param::ParamSlot removeSelfSlot;
         core::param::ParamSlot findExtremesSlot;
         core::param::ParamSlot extremeValueSlot;
+        core::param::ParamSlot backendSlot;
         
         size_t datahash;
         size_t myHash = 0;
@@ -123,15 +145,18 @@ namespace datatools {
 
         Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> eigensolver;
 
-        typedef nanoflann::KDTreeSingleIndexAdaptor<
-            nanoflann::L2_Simple_Adaptor<float, simplePointcloud>,
-            simplePointcloud,
-            3 /* dim */
-        > my_kd_tree_t;
-
-        std::shared_ptr<my_kd_tree_t> particleTree;
+        /** The spatial index, shared with other modules working on the same frame */
+        std::shared_ptr<const ParticleSpatialIndex> particleTree;
         std::shared_ptr<simplePointcloud> myPts;
 
+        /** The compute shader, created on first use */
+        vislib::graphics::gl::GLSLComputeShader metricsShader;
+        bool metricsShaderTried;
+        bool metricsShaderOK;
+
+        /** The sorted positions and velocities, the cell starts and the results */
+        GLuint gpuBuffers[4];
+
         /** The slot providing access to the manipulated data */
         megamol::core::CalleeSlot outDataSlot;
 
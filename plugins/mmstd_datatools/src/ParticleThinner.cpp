@@ -6,20 +6,68 @@
  */
 #include "stdafx.h"
 #include "ParticleThinner.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
 
 using namespace megamol;
 using namespace megamol::stdplugin;
 
+namespace {
+
+    /** The thinning methods */
+    enum Method { METHOD_STRIDE = 0, METHOD_SPATIAL = 1 };
+
+    /** Finalizer of splitmix64 */
+    inline uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /** Key of the grid cell containing the given position, 21 bits per axis */
+    inline uint64_t cellKey(float x, float y, float z, float invEdge) {
+        const uint64_t mask = (1ull << 21) - 1;
+        const uint64_t ix = static_cast<uint64_t>(static_cast<int64_t>(std::floor(x * invEdge))) & mask;
+        const uint64_t iy = static_cast<uint64_t>(static_cast<int64_t>(std::floor(y * invEdge))) & mask;
+        const uint64_t iz = static_cast<uint64_t>(static_cast<int64_t>(std::floor(z * invEdge))) & mask;
+        return (ix << 42) | (iy << 21) | iz;
+    }
+
+} /* end namespace */
+
 
 /*
  * datatools::ParticleThinner::ParticleThinner
  */
 datatools::ParticleThinner::ParticleThinner(void)
         : AbstractParticleManipulator("outData", "indata"),
-        thinningFactorSlot("thinningFactor", "The thinning factor. Only each n-th particle will be kept.") {
+        thinningFactorSlot("thinningFactor", "The thinning factor. Only each n-th particle will be kept."),
+        methodSlot("method", "The thinning method"),
+        cellSizeSlot("cellSize", "The edge length of the grid cells of the spatial method, 0 for automatic"),
+        flags(), keep(), parts(), vertData(), colData(), idData(), dataHash(0), frameId(0), outHash(0) {
     this->thinningFactorSlot.SetParameter(new core::param::IntParam(100, 1));
     this->MakeSlotAvailable(&this->thinningFactorSlot);
+
+    auto *ep = new core::param::EnumParam(METHOD_STRIDE);
+    ep->SetTypePair(METHOD_STRIDE, "stride");
+    ep->SetTypePair(METHOD_SPATIAL, "spatial");
+    this->methodSlot.SetParameter(ep);
+    this->MakeSlotAvailable(&this->methodSlot);
+
+    this->cellSizeSlot.SetParameter(new core::param::FloatParam(0.0f, 0.0f));
+    this->MakeSlotAvailable(&this->cellSizeSlot);
+
+    this->MakeSlotAvailable(&this->flags.Slot());
 }
 
 
@@ -40,6 +88,47 @@ bool datatools::ParticleThinner::manipulateData(
     using megamol::core::moldyn::MultiParticleDataCall;
     int tf = this->thinningFactorSlot.Param<core::param::IntParam>()->Value();
 
+    if (this->methodSlot.Param<core::param::EnumParam>()->Value() == METHOD_SPATIAL) {
+        const bool changed = (this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash())
+            || (inData.DataHash() == 0) || (this->keep.size() != inData.GetParticleListCount())
+            || this->thinningFactorSlot.IsDirty() || this->methodSlot.IsDirty() || this->cellSizeSlot.IsDirty();
+        if (changed) {
+            this->thinningFactorSlot.ResetDirty();
+            this->methodSlot.ResetDirty();
+            this->cellSizeSlot.ResetDirty();
+            this->frameId = inData.FrameID();
+            this->dataHash = inData.DataHash();
+            this->outHash++;
+            this->computeSpatialMasks(inData, tf);
+        }
+
+        if (this->flags.IsConnected()) {
+            // pass the particles on untouched and only mark the dropped ones
+            this->parts.clear();
+            this->vertData.clear();
+            this->colData.clear();
+            this->idData.clear();
+            outData = inData;
+            inData.SetUnlocker(nullptr, false);
+            this->flags.Write(outData, this->keep, changed);
+            return true;
+        }
+
+        if (changed || (this->parts.size() != this->keep.size())) {
+            this->copyKeptParticles(inData);
+        }
+        inData.Unlock();
+
+        outData.SetDataHash(this->outHash);
+        outData.SetFrameID(this->frameId);
+        outData.SetParticleListCount(static_cast<unsigned int>(this->parts.size()));
+        for (size_t i = 0; i < this->parts.size(); ++i) {
+            outData.AccessParticles(static_cast<unsigned int>(i)) = this->parts[i];
+        }
+        outData.SetUnlocker(nullptr);
+        return true;
+    }
+
     outData = inData; // also transfers the unlocker to 'outData'
 
     inData.SetUnlocker(nullptr, false); // keep original data locked
@@ -70,3 +159,141 @@ bool datatools::ParticleThinner::manipulateData(
 
     return true;
 }
+
+
+/*
+ * datatools::ParticleThinner::computeSpatialMasks
+ */
+void datatools::ParticleThinner::computeSpatialMasks(
+        megamol::core::moldyn::MultiParticleDataCall& inData, int tf) {
+    using megamol::core::moldyn::MultiParticleDataCall;
+
+    const unsigned int plc = inData.GetParticleListCount();
+    this->keep.resize(plc);
+
+    UINT64 total = 0;
+    for (unsigned int i = 0; i < plc; i++) {
+        total += inData.AccessParticles(i).GetCount();
+    }
+
+    float edge = this->cellSizeSlot.Param<core::param::FloatParam>()->Value();
+    if (edge <= 0.0f) {
+        // about eight kept particles in an average cell, so keeping at least
+        // one per cell hardly changes the density of the thinned data
+        const vislib::math::Cuboid<float>& bbox = inData.AccessBoundingBoxes().ObjectSpaceBBox();
+        const double volume = static_cast<double>(bbox.Width()) * bbox.Height() * bbox.Depth();
+        edge = (total > 0) ? static_cast<float>(std::cbrt(volume * 8.0 * tf / static_cast<double>(total))) : 0.0f;
+        if (!(edge > 0.0f)) {
+            edge = 1.0f;
+        }
+    }
+    const float invEdge = 1.0f / edge;
+
+    UINT64 kept = 0;
+    for (unsigned int i = 0; i < plc; i++) {
+        MultiParticleDataCall::Particles& p = inData.AccessParticles(i);
+        const INT64 cnt = static_cast<INT64>(p.GetCount());
+        std::vector<char>& k = this->keep[i];
+
+        if (p.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_NONE) {
+            k.assign(static_cast<size_t>(cnt), 1);
+            continue;
+        }
+        k.assign(static_cast<size_t>(cnt), 0);
+
+        auto const& parStore = p.GetParticleStore();
+        auto const& xAcc = parStore.GetXAcc();
+        auto const& yAcc = parStore.GetYAcc();
+        auto const& zAcc = parStore.GetZAcc();
+        auto const& idAcc = parStore.GetIDAcc();
+        const MultiParticleDataCall::Particles::IDDataType idt = p.GetIDDataType();
+
+        std::vector<uint64_t> cells(static_cast<size_t>(cnt));
+#pragma omp parallel for
+        for (INT64 j = 0; j < cnt; ++j) {
+            cells[j] = cellKey(xAcc->Get_f(j), yAcc->Get_f(j), zAcc->Get_f(j), invEdge);
+        }
+
+        std::unordered_map<uint64_t, uint32_t> counts;
+        counts.reserve(static_cast<size_t>(cnt / (8 * tf) + 1));
+        for (INT64 j = 0; j < cnt; ++j) {
+            ++counts[cells[j]];
+        }
+
+        // Every particle is kept with the probability that yields the share
+        // of its cell. The random number is derived from the particle's ID,
+        // so the same particles are chosen in every frame.
+#pragma omp parallel for
+        for (INT64 j = 0; j < cnt; ++j) {
+            const double n = static_cast<double>(counts.find(cells[j])->second);
+            const double share = std::max(1.0, n / tf) / n;
+            uint64_t id = static_cast<uint64_t>(j);
+            if (idt == MultiParticleDataCall::Particles::IDDATA_UINT32) {
+                id = idAcc->Get_u32(j);
+            } else if (idt == MultiParticleDataCall::Particles::IDDATA_UINT64) {
+                id = idAcc->Get_u64(j);
+            }
+            const double r = static_cast<double>(mix(id) >> 11) * (1.0 / 9007199254740992.0);
+            k[j] = (r < share) ? 1 : 0;
+        }
+
+        kept += static_cast<UINT64>(std::count(k.begin(), k.end(), 1));
+    }
+
+    vislib::sys::Log::DefaultLog.WriteInfo("ParticleThinner: kept %llu of %llu particles (cell size %f)",
+        static_cast<unsigned long long>(kept), static_cast<unsigned long long>(total), edge);
+}
+
+
+/*
+ * datatools::ParticleThinner::copyKeptParticles
+ */
+void datatools::ParticleThinner::copyKeptParticles(megamol::core::moldyn::MultiParticleDataCall& inData) {
+    using megamol::core::moldyn::MultiParticleDataCall;
+    typedef MultiParticleDataCall::Particles Particles;
+
+    const unsigned int plc = inData.GetParticleListCount();
+    this->parts.resize(plc);
+    this->vertData.resize(plc);
+    this->colData.resize(plc);
+    this->idData.resize(plc);
+
+    for (unsigned int i = 0; i < plc; i++) {
+        const Particles& p = inData.AccessParticles(i);
+        const std::vector<char>& k = this->keep[i];
+        Particles& outp = this->parts[i];
+        outp = p;
+
+        const UINT64 cnt = p.GetCount();
+        const UINT64 kept = static_cast<UINT64>(std::count(k.begin(), k.end(), 1));
+
+        const size_t vdsize = Particles::VertexDataSize[p.GetVertexDataType()];
+        const size_t cdsize = Particles::ColorDataSize[p.GetColourDataType()];
+        const size_t idsize = Particles::IDDataSize[p.GetIDDataType()];
+        const size_t vdstride = std::max<size_t>(p.GetVertexDataStride(), vdsize);
+        const size_t cdstride = std::max<size_t>(p.GetColourDataStride(), cdsize);
+        const size_t idstride = std::max<size_t>(p.GetIDDataStride(), idsize);
+        const uint8_t *vd = reinterpret_cast<const uint8_t*>(p.GetVertexData());
+        const uint8_t *cd = reinterpret_cast<const uint8_t*>(p.GetColourData());
+        const uint8_t *id = reinterpret_cast<const uint8_t*>(p.GetIDData());
+
+        this->vertData[i].resize(static_cast<size_t>(kept) * vdsize);
+        this->colData[i].resize(static_cast<size_t>(kept) * cdsize);
+        this->idData[i].resize(static_cast<size_t>(kept) * idsize);
+
+        size_t o = 0;
+        for (UINT64 j = 0; j < cnt; ++j) {
+            if (!k[j]) continue;
+            if (vdsize > 0) memcpy(this->vertData[i].data() + o * vdsize, vd + j * vdstride, vdsize);
+            if (cdsize > 0) memcpy(this->colData[i].data() + o * cdsize, cd + j * cdstride, cdsize);
+            if (idsize > 0) memcpy(this->idData[i].data() + o * idsize, id + j * idstride, idsize);
+            ++o;
+        }
+
+        outp.SetCount(kept);
+        outp.SetVertexData(p.GetVertexDataType(), (vdsize > 0) ? this->vertData[i].data() : nullptr);
+        outp.SetColourData(p.GetColourDataType(), (cdsize > 0) ? this->colData[i].data() : nullptr);
+        outp.SetIDData(p.GetIDDataType(), (idsize > 0) ? this->idData[i].data() : nullptr);
+        outp.SetDirData(Particles::DIRDATA_NONE, nullptr);
+    }
+}
@@ -13,6 +13,10 @@
 
 #include "mmstd_datatools/AbstractParticleManipulator.h"
 #include "mmcore/param/ParamSlot.h"
+#include "ParticleFilterFlags.h"
+
+#include <cstdint>
+#include <vector>
 
 
 namespace megamol {
@@ -22,6 +26,12 @@ namespace datatools {
     /**
      * Module thinning the number of particles
      *
+     * The stride method keeps each n-th particle by only adjusting the strides of the input data. The spatial method
+     * sorts the particles into a hashed grid and keeps the same fraction of particles in every cell, at least one,
+     * so clustered data keeps its shape and sparse regions do not vanish. Within a cell, the particles are chosen by
+     * a hash of their ID (or their index without IDs), so the selection is stable over time. If a flag storage is
+     * connected, the spatial method passes the data on untouched and only marks the dropped particles as filtered.
+     *
      * Migrated from SGrottel particle's tool box
      */
     class ParticleThinner : public AbstractParticleManipulator {
@@ -66,9 +76,49 @@ namespace datatools {
 
     private:
 
+        /**
+         * Computes the masks of the spatial method.
+         *
+         * @param inData The call holding the original data
+         * @param tf The thinning factor
+         */
+        void computeSpatialMasks(megamol::core::moldyn::MultiParticleDataCall& inData, int tf);
+
+        /**
+         * Copies the particles kept by the masks. Direction data is dropped.
+         *
+         * @param inData The call holding the original data
+         */
+        void copyKeptParticles(megamol::core::moldyn::MultiParticleDataCall& inData);
+
         /** The thinning factor. Only each n-th particle will be kept. */
         core::param::ParamSlot thinningFactorSlot;
 
+        /** The thinning method */
+        core::param::ParamSlot methodSlot;
+
+        /** The edge length of the grid cells of the spatial method, 0 for automatic */
+        core::param::ParamSlot cellSizeSlot;
+
+        /** Optional output of the spatial method as flags */
+        ParticleFilterFlags flags;
+
+        /** The particles kept by the spatial method, one mask per list */
+        std::vector<std::vector<char>> keep;
+
+        /** The copied particles of the spatial method without flag storage */
+        std::vector<core::moldyn::MultiParticleDataCall::Particles> parts;
+        std::vector<std::vector<uint8_t>> vertData;
+        std::vector<std::vector<uint8_t>> colData;
+        std::vector<std::vector<uint8_t>> idData;
+
+        /** For change tracking of the spatial method */
+        size_t dataHash;
+        unsigned int frameId;
+
+        /** The data hash published by the spatial method without flag storage */
+        size_t outHash;
+
     };
 
 } /* end namespace datatools */
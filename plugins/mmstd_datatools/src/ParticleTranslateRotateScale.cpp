@@ -11,6 +11,9 @@
 #include "mmcore/param/Vector4fParam.h"
 #include "vislib/math/Matrix4.h"
 #include "mmcore/view/CallGetTransferFunction.h"
+#include "AffineTransform.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace megamol;
 using namespace megamol::stdplugin;
@@ -25,7 +28,11 @@ datatools::ParticleTranslateRotateScale::ParticleTranslateRotateScale(void)
     , quaternionSlot("quaternion", "Rotates the particles around x, y, z axes")
     , scaleSlot("scale", "Scales the particle data")
     , getTFSlot("gettransferfunction", "Connects to the transfer function module")
-, finalData(NULL){
+    , finalData()
+    , finalBoxes()
+    , inDataHash(0)
+    , inFrameID(0)
+    , hadTF(false) {
     this->translateSlot.SetParameter(new core::param::Vector3fParam(vislib::math::Vector<float, 3>(0, 0, 0)));
     this->MakeSlotAvailable(&this->translateSlot);
 
@@ -45,7 +52,6 @@ datatools::ParticleTranslateRotateScale::ParticleTranslateRotateScale(void)
  */
 datatools::ParticleTranslateRotateScale::~ParticleTranslateRotateScale(void) {
     this->Release();
-    delete[] finalData;
 }
 
 
@@ -151,79 +157,78 @@ bool datatools::ParticleTranslateRotateScale::manipulateData(
     //outData.AccessBoundingBoxes().MakeScaledWorld(scale);
 
     unsigned int plc = outData.GetParticleListCount();
-    vislib::math::Vector<float, 4> pos;
 
+    megamol::core::view::CallGetTransferFunction* cgtf =
+        this->getTFSlot.CallAs<core::view::CallGetTransferFunction>();
+    const bool haveTF = (cgtf != NULL) && (*cgtf)();
+
+    // the transformed lists only depend on the input, the parameters and the transfer function
+    const bool rebuild = (inData.DataHash() != this->inDataHash) || (inData.DataHash() == 0) ||
+                         (inData.FrameID() != this->inFrameID) || (this->finalData.size() != plc) ||
+                         this->InterfaceIsDirty() || (haveTF && cgtf->IsDirty()) || (haveTF != this->hadTF);
+    if (rebuild) {
+        this->inDataHash = inData.DataHash();
+        this->inFrameID = inData.FrameID();
+        this->hadTF = haveTF;
+        this->InterfaceResetDirty();
+        if (haveTF) cgtf->ResetDirty();
+
+        float rows[12];
+        AffineRows(totMX, rows);
+        static const float origin[3] = {0.0f, 0.0f, 0.0f};
+
+        this->finalData.resize(plc);
+        this->finalBoxes.resize(plc);
+        for (unsigned int i = 0; i < plc; i++) {
+            MultiParticleDataCall::Particles& p = outData.AccessParticles(i);
+            const int64_t cnt = static_cast<int64_t>(p.GetCount());
+            std::vector<float>& fd = this->finalData[i];
+            fd.resize(static_cast<size_t>(cnt) * 7);
+
+            // Positions
+            const void* vd = p.GetVertexData();
+            const size_t vds = std::max<size_t>(
+                p.GetVertexDataStride(), MultiParticleDataCall::Particles::VertexDataSize[p.GetVertexDataType()]);
+            switch (p.GetVertexDataType()) {
+            case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+            case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+                TransformPositions<float>(rows, vd, vds, fd.data(), 7, cnt);
+                break;
+            case MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ:
+                TransformPositions<double>(rows, vd, vds, fd.data(), 7, cnt);
+                break;
+            case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
+                TransformPositions<unsigned short>(rows, vd, vds, fd.data(), 7, cnt);
+                break;
+            default:
+                TransformPositions<float>(rows, origin, 0, fd.data(), 7, cnt);
+                break;
+            }
 
-    finalData = new float*[plc];
-    for (unsigned int i = 0; i < plc; i++) {
-        MultiParticleDataCall::Particles& p = outData.AccessParticles(i);
-
-        uint64_t cnt = p.GetCount();
-
-        const void* cd = p.GetColourData();
-        unsigned int cds = p.GetColourDataStride();
-        MultiParticleDataCall::Particles::ColourDataType cdt = p.GetColourDataType();
-
-        const void* vd = p.GetVertexData();
-        unsigned int vds = p.GetVertexDataStride();
-        MultiParticleDataCall::Particles::VertexDataType vdt = p.GetVertexDataType();
-
+            // Color transfer call and calculation
+            if (haveTF) {
+                this->colorTransferGray(p, cgtf->GetTextureData(), cgtf->TextureSize(), fd.data() + 3, 7);
+            } else {
+                this->colorTransferGray(p, NULL, 0, fd.data() + 3, 7);
+            }
 
-        // Color transfer call and calculation
-        std::vector<float> rgba;
-        rgba.reserve(cnt * 4);
-        unsigned int texSize = 0;
-        megamol::core::view::CallGetTransferFunction* cgtf =
-            this->getTFSlot.CallAs<core::view::CallGetTransferFunction>();
-        if (cgtf != NULL && ((*cgtf)())) {
-            float const* tfTex = cgtf->GetTextureData();
-            texSize = cgtf->TextureSize();
-            this->colorTransferGray(p, tfTex, texSize, rgba);
-        } else {
-            this->colorTransferGray(p, NULL, 0, rgba);
+            auto lbbLocal = static_cast<vislib::math::Vector<float, 3>>(p.GetBBox().GetLeftBottomBack());
+            auto rtfLocal = static_cast<vislib::math::Vector<float, 3>>(p.GetBBox().GetRightTopFront());
+            lbbLocal = totMX * lbbLocal;
+            rtfLocal = totMX * rtfLocal;
+            this->finalBoxes[i].Set(
+                lbbLocal.GetX(), lbbLocal.GetY(), lbbLocal.GetZ(), rtfLocal.GetX(), rtfLocal.GetY(), rtfLocal.GetZ());
         }
+    }
 
-        auto const& parStore = p.GetParticleStore();
-        auto const& xAcc = parStore.GetXAcc();
-        auto const& yAcc = parStore.GetYAcc();
-        auto const& zAcc = parStore.GetZAcc();
-
-        finalData[i] = new float[cnt * 7];
-        for (size_t loop = 0; loop < cnt; loop++) {
-
-            pos.SetX(xAcc->Get_f(loop));
-            pos.SetY(yAcc->Get_f(loop));
-            pos.SetZ(zAcc->Get_f(loop));
-            pos.SetW(1.0f);
-
-            pos = totMX * pos;
-
-            finalData[i][7*loop+0] = pos.GetX();
-            finalData[i][7*loop+1] = pos.GetY();
-            finalData[i][7*loop+2] = pos.GetZ();
-            finalData[i][7*loop+3] = rgba[4*loop+0];
-            finalData[i][7*loop+4] = rgba[4*loop+1];
-            finalData[i][7*loop+5] = rgba[4*loop+2];
-            finalData[i][7*loop+6] = rgba[4*loop+3];
-
-
-            // Does not work ??
-            // finalData.emplace_back(pos.GetX(), pos.GetY(), pos.GetZ(), part.col.GetRf(), part.col.GetGf(),
-            //    part.col.GetBf(), part.col.GetAf());
-        }
+    for (unsigned int i = 0; i < plc; i++) {
+        MultiParticleDataCall::Particles& p = outData.AccessParticles(i);
+        const UINT64 cnt = p.GetCount();
 
-        auto lbbLocal = static_cast<vislib::math::Vector<float, 3>>(p.GetBBox().GetLeftBottomBack());
-        auto rtfLocal = static_cast<vislib::math::Vector<float, 3>>(p.GetBBox().GetRightTopFront());
-        lbbLocal = totMX * lbbLocal;
-        rtfLocal = totMX * rtfLocal;
-        vislib::math::Cuboid<float> newBoxLocal;
-        newBoxLocal.Set(
-            lbbLocal.GetX(), lbbLocal.GetY(), lbbLocal.GetZ(), rtfLocal.GetX(), rtfLocal.GetY(), rtfLocal.GetZ());
-        
-        p.SetBBox(newBoxLocal);
+        p.SetBBox(this->finalBoxes[i]);
         p.SetCount(cnt);
-        p.SetVertexData(MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ, finalData[i], 7 * sizeof(float));
-        p.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA, finalData[i], 7 * sizeof(float));
+        p.SetVertexData(MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ, this->finalData[i].data(), 7 * sizeof(float));
+        p.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA, this->finalData[i].data() + 3, 7 * sizeof(float));
         p.SetGlobalRadius(p.GetGlobalRadius() * scaleX);
     }
 
@@ -231,20 +236,25 @@ bool datatools::ParticleTranslateRotateScale::manipulateData(
 }
 
 void datatools::ParticleTranslateRotateScale::colorTransferGray(core::moldyn::MultiParticleDataCall::Particles& p,
-    float const* transferTable, unsigned int tableSize, std::vector<float>& rgbaArray) {
+    float const* transferTable, unsigned int tableSize, float* rgbaArray, size_t stride) {
 
     auto const& parStore = p.GetParticleStore();
     auto const& iAcc = parStore.GetCRAcc();
-
-    std::vector<float> grayArray(p.GetCount());
-    for (size_t i = 0; i < p.GetCount(); i++) {
-        grayArray[i] = iAcc->Get_f(i);
+    const int64_t cnt = static_cast<int64_t>(p.GetCount());
+    if (cnt == 0) return;
+
+    float gray_max = iAcc->Get_f(0);
+    float gray_min = gray_max;
+    for (int64_t i = 1; i < cnt; i++) {
+        const float gray = iAcc->Get_f(i);
+        if (gray_max < gray) gray_max = gray;
+        if (gray_min > gray) gray_min = gray;
     }
-    
-    float gray_max = *std::max_element(grayArray.begin(), grayArray.end());
-    float gray_min = *std::min_element(grayArray.begin(), grayArray.end());
 
-    for (auto& gray : grayArray) {
+#pragma omp parallel for
+    for (int64_t i = 0; i < cnt; i++) {
+        const float gray = iAcc->Get_f(i);
+        float* rgba = rgbaArray + i * stride;
         float scaled_gray;
         if ((gray_max - gray_min) <= 1e-4f) {
             scaled_gray = 0;
@@ -252,21 +262,21 @@ void datatools::ParticleTranslateRotateScale::colorTransferGray(core::moldyn::Mu
             scaled_gray = (gray - gray_min) / (gray_max - gray_min);
         }
         if (transferTable == NULL && tableSize == 0) {
-            for (int i = 0; i < 3; i++) {
-                rgbaArray.push_back((0.3f + scaled_gray) / 1.3f);
+            for (int c = 0; c < 3; c++) {
+                rgba[c] = (0.3f + scaled_gray) / 1.3f;
             }
-            rgbaArray.push_back(1.0f);
+            rgba[3] = 1.0f;
         } else {
             float exact_tf = (tableSize - 1) * scaled_gray;
             int floor = std::floor(exact_tf);
             float tail = exact_tf - (float)floor;
             floor *= 4;
-            for (int i = 0; i < 4; i++) {
-                float colorFloor = transferTable[floor + i];
-                float colorCeil = transferTable[floor + i + 4];
+            for (int c = 0; c < 4; c++) {
+                float colorFloor = transferTable[floor + c];
+                float colorCeil = transferTable[floor + c + 4];
                 float finalColor = colorFloor + (colorCeil - colorFloor) * (tail);
-                rgbaArray.push_back(finalColor);
+                rgba[c] = finalColor;
             }
         }
     }
-}
\ No newline at end of file
+}
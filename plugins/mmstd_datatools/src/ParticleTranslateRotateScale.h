@@ -10,6 +10,8 @@
 
 #include "mmstd_datatools/AbstractParticleManipulator.h"
 #include "mmcore/param/ParamSlot.h"
+#include "vislib/math/Cuboid.h"
+#include <vector>
 
 
 namespace megamol {
@@ -63,7 +65,7 @@ namespace datatools {
             megamol::core::moldyn::MultiParticleDataCall& outData,
             megamol::core::moldyn::MultiParticleDataCall& inData);
         void colorTransferGray(core::moldyn::MultiParticleDataCall::Particles& p, float const* transferTable, unsigned tableSize,
-                               std::vector<float> &rgbaArray);
+                               float* rgbaArray, size_t stride);
         megamol::core::CallerSlot getTFSlot;
 
     private:
@@ -72,7 +74,14 @@ namespace datatools {
         core::param::ParamSlot quaternionSlot;
         core::param::ParamSlot scaleSlot;
 
-        float** finalData;
+        /** The transformed positions and colours of the lists, interleaved */
+        std::vector<std::vector<float>> finalData;
+        std::vector<vislib::math::Cuboid<float>> finalBoxes;
+
+        /** The input the lists were computed for */
+        size_t inDataHash;
+        unsigned int inFrameID;
+        bool hadTF;
     };
 
 } /* end namespace datatools */
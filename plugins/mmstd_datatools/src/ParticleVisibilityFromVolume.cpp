@@ -60,6 +60,8 @@ datatools::ParticleVisibilityFromVolume::ParticleVisibilityFromVolume(void)
 
     this->volumeSlot.SetCompatibleCall<megamol::core::misc::VolumetricDataCallDescription>();
     this->MakeSlotAvailable(&this->volumeSlot);
+
+    this->MakeSlotAvailable(&this->flags.Slot());
 }
 
 
@@ -104,10 +106,18 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
         return false;
     }
 
+    // with a flag storage, the particles are passed on untouched and only the invisible ones are marked
+    const bool useFlags = this->flags.IsConnected();
+
     if (inData.FrameID() == this->lastTime && inData.DataHash() == this->lastParticleHash &&
         inVol->DataHash() == this->lastVolumeHash && !operatorSlot.IsDirty() && !valueSlot.IsDirty() && !epsilonSlot.IsDirty()
-        && !absoluteSlot.IsDirty()) {
+        && !absoluteSlot.IsDirty() && useFlags == this->lastUsedFlags) {
         // everything should already be correct
+        if (useFlags) {
+            outData = inData;
+            inData.SetUnlocker(nullptr, false);
+            this->flags.Write(outData, this->keep, false);
+        }
         return true;
     }
 
@@ -146,8 +156,15 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
     const auto startTime = std::chrono::high_resolution_clock::now();
 
     unsigned int plc = inData.GetParticleListCount();
-    this->theVertexData.resize(plc);
-    this->theColorData.resize(plc);
+    if (useFlags) {
+        this->theVertexData.clear();
+        this->theColorData.clear();
+        this->keep.resize(plc);
+    } else {
+        this->theVertexData.resize(plc);
+        this->theColorData.resize(plc);
+        this->keep.clear();
+    }
     outData.SetParticleListCount(plc);
     for (unsigned int i = 0; i < plc; ++i) {
         MultiParticleDataCall::Particles& p = inData.AccessParticles(i);
@@ -174,7 +191,9 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
         vertexBasePointer = reinterpret_cast<const uint8_t*>(p.GetVertexData());
         colorBasePointer = reinterpret_cast<const uint8_t*>(p.GetColourData());
 
-        if (cdsize == 0 || vdsize + cdsize == vdstride) {
+        if (useFlags) {
+            this->keep[i].assign(cnt, 0);
+        } else if (cdsize == 0 || vdsize + cdsize == vdstride) {
             // data is interleaved
             commonBasePointer = vertexBasePointer < colorBasePointer ? vertexBasePointer : colorBasePointer;
             colorIsFirst = vertexBasePointer > colorBasePointer;
@@ -263,6 +282,11 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
                 break;
             }
 
+            if (useFlags) {
+                this->keep[i][j] = isOK ? 1 : 0;
+                continue;
+            }
+
             if (isOK) {
 #ifdef _OPENMP
                 const UINT64 localIdx = cntLeft + omp_get_thread_num();
@@ -280,6 +304,13 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
             }
         }
 
+        if (useFlags) {
+            cntLeft = static_cast<UINT64>(std::count(this->keep[i].begin(), this->keep[i].end(), 1));
+            vislib::sys::Log::DefaultLog.WriteInfo(
+                "ParticleVisibilityFromVolume: list %d: %lu / %lu particles visible", i, cntLeft, cnt);
+            continue;
+        }
+
         auto& outp = outData.AccessParticles(i);
         outp.SetCount(cntLeft);
         vislib::sys::Log::DefaultLog.WriteInfo(
@@ -323,6 +354,13 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
     this->lastTime = inData.FrameID();
     this->lastParticleHash = inData.DataHash();
     this->lastVolumeHash = inVol->DataHash();
+    this->lastUsedFlags = useFlags;
+
+    if (useFlags) {
+        outData = inData;
+        inData.SetUnlocker(nullptr, false);
+        this->flags.Write(outData, this->keep, true);
+    }
 
     this->operatorSlot.ResetDirty();
     this->valueSlot.ResetDirty();
@@ -15,6 +15,7 @@
 #include "mmcore/misc/VolumetricDataCall.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/AbstractParticleManipulator.h"
+#include "ParticleFilterFlags.h"
 
 
 namespace megamol {
@@ -82,10 +83,19 @@ private:
     /** the incoming volume */
     core::CallerSlot volumeSlot;
 
+    /** optional output of the filter result as flags */
+    ParticleFilterFlags flags;
+
     /** we have to store the filtered data */
     std::vector<std::vector<uint8_t>> theVertexData;
     std::vector<std::vector<uint8_t>> theColorData;
 
+    /** or only which particles are visible, if the result goes to the flags */
+    std::vector<std::vector<char>> keep;
+
+    /** for change tracking: whether the last result went to the flags */
+    bool lastUsedFlags = false;
+
     /** for change tracking: last frameID we pulled */
     unsigned int lastTime = -1;
 
@@ -181,7 +181,7 @@ bool datatools::ParticlesToDensity::getDataCallback(megamol::core::Call& c) {
     }
 
     // TODO set data
-    outVol->SetData(this->vol[0].data());
+    outVol->SetData(this->vol.data());
     metadata.Components = 1;
     metadata.GridType = core::misc::GridType_t::CARTESIAN;
     metadata.Resolution[0] = static_cast<size_t>(this->xResSlot.Param<core::param::IntParam>()->Value());
@@ -244,12 +244,7 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class megamol::core::moldyn:
     auto const sy = this->yResSlot.Param<core::param::IntParam>()->Value();
     auto const sz = this->zResSlot.Param<core::param::IntParam>()->Value();
 
-    vol.resize(omp_get_max_threads());
-#pragma omp parallel for
-    for (int init = 0; init < omp_get_max_threads(); ++init) {
-        vol[init].resize(sx * sy * sz);
-        std::fill(vol[init].begin(), vol[init].end(), 0.0f);
-    }
+    vol.assign(static_cast<size_t>(sx) * sy * sz, 0.0f);
 
     // TODO: the whole code is wrong since we might not have the bounding box for the actual cyclic boundary conditions.
 
@@ -310,16 +305,14 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class megamol::core::moldyn:
             volOp = [this, &gauss, iAcc, sx, sy, sigma](int const pidx, int const x, int const y, int const z,
                         float const dis, float const rad) -> void {
                 auto const val = iAcc->Get_f(pidx);
-                vol[omp_get_thread_num()][x + (y + z * sy) * sx] +=
-                    gauss(dis, sigma * rad) * val;
+                vol[x + (y + static_cast<size_t>(z) * sy) * sx] += gauss(dis, sigma * rad) * val;
             };
         } break;
         default:
         case 0: {
             volOp = [this, &gauss, sx, sy, sigma](int const pidx, int const x, int const y, int const z, float const dis,
                         float const rad) -> void {
-                vol[omp_get_thread_num()][x + (y + z * sy) * sx] +=
-                    gauss(dis, sigma * rad);
+                vol[x + (y + static_cast<size_t>(z) * sy) * sx] += gauss(dis, sigma * rad);
             };
         }
         }
@@ -354,8 +347,47 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class megamol::core::moldyn:
         }
 #endif
 
+        auto const count = static_cast<int64_t>(parts.GetCount());
+
+        // All threads splat into the same volume. To keep them from writing the same voxels, the particles are
+        // sorted into slabs along z that are at least as thick as the footprint of the largest particle. Slabs of
+        // the same parity are then at least one slab apart and can be processed concurrently.
+        float maxRad = globRad;
+        if (!useGlobRad) {
+            for (int64_t j = 0; j < count; ++j) {
+                maxRad = std::max(maxRad, rAcc->Get_f(j));
+            }
+        }
+        int const maxFilterSizeZ = static_cast<int>(std::ceil(maxRad / sliceDistZ));
+        int cntSlabs = std::max(1, sz / (2 * maxFilterSizeZ + 1));
+        if (cycl_z && (cntSlabs > 1) && (cntSlabs % 2 != 0)) {
+            // The first and the last slab are neighbours due to the wrap-around, so they must differ in parity.
+            --cntSlabs;
+        }
+
+        // Counting sort of the particles by slab, the last bin holding particles outside of the volume
+        std::vector<int64_t> slabStart(cntSlabs + 2, 0);
+        std::vector<int> slabOf(count);
 #pragma omp parallel for
-        for (int64_t j = 0; j < parts.GetCount(); ++j) {
+        for (int64_t j = 0; j < count; ++j) {
+            auto const z = static_cast<int>(std::floor((zAcc->Get_f(j) - minOSz) / sliceDistZ));
+            slabOf[j] = ((z >= 0) && (z < sz)) ? static_cast<int>((static_cast<int64_t>(z) * cntSlabs) / sz) : cntSlabs;
+        }
+        for (int64_t j = 0; j < count; ++j) {
+            ++slabStart[slabOf[j] + 1];
+        }
+        for (int s = 0; s <= cntSlabs; ++s) {
+            slabStart[s + 1] += slabStart[s];
+        }
+        std::vector<int64_t> sorted(count);
+        {
+            std::vector<int64_t> slabEnd(slabStart.begin(), slabStart.end() - 1);
+            for (int64_t j = 0; j < count; ++j) {
+                sorted[slabEnd[slabOf[j]]++] = j;
+            }
+        }
+
+        auto splat = [&](int64_t const j) {
             auto const x_base = xAcc->Get_f(j);
             auto x = static_cast<int>((x_base - minOSx) / sliceDistX);
             auto const y_base = yAcc->Get_f(j);
@@ -412,21 +444,29 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class megamol::core::moldyn:
                     }
                 }
             }
-        }
-    }
+        };
 
-    for (int i = 1; i < omp_get_max_threads(); ++i) {
-        std::transform(vol[i].begin(), vol[i].end(), vol[0].begin(), vol[0].begin(), std::plus<>());
+        for (int parity = 0; parity < 2; ++parity) {
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int s = parity; s < cntSlabs; s += 2) {
+                for (int64_t k = slabStart[s]; k < slabStart[s + 1]; ++k) {
+                    splat(sorted[k]);
+                }
+            }
+        }
+        for (int64_t k = slabStart[cntSlabs]; k < slabStart[cntSlabs + 1]; ++k) {
+            splat(sorted[k]);
+        }
     }
 
-    maxDens = *std::max_element(vol[0].begin(), vol[0].end());
-    minDens = *std::min_element(vol[0].begin(), vol[0].end());
+    maxDens = *std::max_element(vol.begin(), vol.end());
+    minDens = *std::min_element(vol.begin(), vol.end());
     vislib::sys::Log::DefaultLog.WriteInfo("ParticlesToDensity: Captured density %f -> %f", minDens, maxDens);
 
     if (this->normalizeSlot.Param<core::param::BoolParam>()->Value()) {
         auto const rcpValRange = 1.0f / (maxDens - minDens);
         std::transform(
-            vol[0].begin(), vol[0].end(), vol[0].begin(), [this, rcpValRange](float const& a) { return (a - minDens) * rcpValRange; });
+            vol.begin(), vol.end(), vol.begin(), [this, rcpValRange](float const& a) { return (a - minDens) * rcpValRange; });
         minDens = 0.0f;
         maxDens = 1.0f;
     }
@@ -434,14 +474,11 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class megamol::core::moldyn:
 //#define PTD_DEBUG_OUTPUT
 #ifdef PTD_DEBUG_OUTPUT
     std::ofstream raw_file{"bolla.raw", std::ios::binary};
-    raw_file.write(reinterpret_cast<char const*>(vol[0].data()), vol[0].size() * sizeof(float));
+    raw_file.write(reinterpret_cast<char const*>(vol.data()), vol.size() * sizeof(float));
     raw_file.close();
     vislib::sys::Log::DefaultLog.WriteInfo("ParticlesToDensity: Debug file written\n");
 #endif
 
-    // Cleanup
-    vol.resize(1);
-
     const auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
     vislib::sys::Log::DefaultLog.WriteInfo(
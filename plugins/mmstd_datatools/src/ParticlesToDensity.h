@@ -108,7 +108,8 @@ private:
 
     core::param::ParamSlot sigmaSlot;
 
-    std::vector<std::vector<float>> vol;
+    /** The density volume, shared by all threads */
+    std::vector<float> vol;
 
     size_t in_datahash = std::numeric_limits<size_t>::max();
     size_t datahash = 0;
@@ -9,11 +9,80 @@
 #include "SphereDataUnifier.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "vislib/RawStorage.h"
+#include <algorithm>
+#include <cfloat>
 
 using namespace megamol;
 using namespace megamol::stdplugin;
 
 
+namespace {
+
+    /**
+     * Collects the bounds of the particle centres and of the spheres of a
+     * list in parallel. If 'withRadius' is set, the radius is the fourth
+     * component of each particle, otherwise 'radius' is used.
+     */
+    template<class T>
+    void collectExtents(const char *vD, SIZE_T vDs, INT64 pCnt, bool withRadius, float radius,
+            vislib::math::Cuboid<float>& points, vislib::math::Cuboid<float>& spheres) {
+        float pMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float pMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        float sMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float sMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+#pragma omp parallel
+        {
+            float lpMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float lpMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            float lsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float lsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+#pragma omp for
+            for (INT64 pi = 0; pi < pCnt; pi++) {
+                const T *v = reinterpret_cast<const T*>(vD + pi * vDs);
+                float r = withRadius ? static_cast<float>(v[3]) : radius;
+                for (int c = 0; c < 3; c++) {
+                    float x = static_cast<float>(v[c]);
+                    lpMin[c] = std::min(lpMin[c], x);
+                    lpMax[c] = std::max(lpMax[c], x);
+                    lsMin[c] = std::min(lsMin[c], x - r);
+                    lsMax[c] = std::max(lsMax[c], x + r);
+                }
+            }
+#pragma omp critical
+            {
+                for (int c = 0; c < 3; c++) {
+                    pMin[c] = std::min(pMin[c], lpMin[c]);
+                    pMax[c] = std::max(pMax[c], lpMax[c]);
+                    sMin[c] = std::min(sMin[c], lsMin[c]);
+                    sMax[c] = std::max(sMax[c], lsMax[c]);
+                }
+            }
+        }
+        points.Set(pMin[0], pMin[1], pMin[2], pMax[0], pMax[1], pMax[2]);
+        spheres.Set(sMin[0], sMin[1], sMin[2], sMax[0], sMax[1], sMax[2]);
+    }
+
+    /**
+     * Writes the moved and scaled particles of a list as tightly packed
+     * floats with 'comps' components in parallel.
+     */
+    template<class T>
+    void transformParticles(const char *vD, SIZE_T vDs, INT64 pCnt, int comps, float xOff, float yOff, float zOff,
+            float scale, float *dst) {
+#pragma omp parallel for
+        for (INT64 pi = 0; pi < pCnt; pi++) {
+            const T *v = reinterpret_cast<const T*>(vD + pi * vDs);
+            float *d = dst + pi * comps;
+            d[0] = (static_cast<float>(v[0]) + xOff) * scale;
+            d[1] = (static_cast<float>(v[1]) + yOff) * scale;
+            d[2] = (static_cast<float>(v[2]) + zOff) * scale;
+            if (comps == 4) d[3] = static_cast<float>(v[3]) * scale;
+        }
+    }
+
+}
+
+
 /*
  * datatools::SphereDataUnifier::SphereDataUnifier
  */
@@ -91,24 +160,22 @@ bool datatools::SphereDataUnifier::getDataCallback(core::Call& caller) {
                 case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
                     datPos += sizeof(float);
                     deS = sizeof(float) * 3;
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const float *vDf = reinterpret_cast<const float*>(vD);
-                            this->accumExt(first, vDf[0], vDf[1], vDf[2], outP.GetGlobalRadius());
-                        }
+                    if (pCnt > 0) {
+                        vislib::math::Cuboid<float> points, spheres;
+                        collectExtents<float>(static_cast<const char*>(outP.GetVertexData()),
+                            vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride()),
+                            static_cast<INT64>(pCnt), false, outP.GetGlobalRadius(), points, spheres);
+                        this->accumExt(first, points, spheres);
                     }
                     break;
                 case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
                     deS = sizeof(float) * 4;
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(4 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const float *vDf = reinterpret_cast<const float*>(vD);
-                            this->accumExt(first, vDf[0], vDf[1], vDf[2], vDf[3]);
-                        }
+                    if (pCnt > 0) {
+                        vislib::math::Cuboid<float> points, spheres;
+                        collectExtents<float>(static_cast<const char*>(outP.GetVertexData()),
+                            vislib::math::Max<SIZE_T>(4 * sizeof(float), outP.GetVertexDataStride()),
+                            static_cast<INT64>(pCnt), true, 0.0f, points, spheres);
+                        this->accumExt(first, points, spheres);
                     }
                     break;
                 case MultiParticleDataCall::Particles::VERTDATA_NONE:
@@ -117,15 +184,12 @@ bool datatools::SphereDataUnifier::getDataCallback(core::Call& caller) {
                 case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
                     datPos += sizeof(float);
                     deS = sizeof(float) * 3; // is most probably bullshit anyway
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const signed short *vDf = reinterpret_cast<const signed short*>(vD);
-                            this->accumExt(first, static_cast<float>(vDf[0]),
-                                static_cast<float>(vDf[1]),
-                                static_cast<float>(vDf[2]), outP.GetGlobalRadius());
-                        }
+                    if (pCnt > 0) {
+                        vislib::math::Cuboid<float> points, spheres;
+                        collectExtents<signed short>(static_cast<const char*>(outP.GetVertexData()),
+                            vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride()),
+                            static_cast<INT64>(pCnt), false, outP.GetGlobalRadius(), points, spheres);
+                        this->accumExt(first, points, spheres);
                     }
                     break;
                 default:
@@ -168,30 +232,15 @@ bool datatools::SphereDataUnifier::getDataCallback(core::Call& caller) {
                     *this->data.AsAt<float>(datPos) = outP.GetGlobalRadius() * scale;
                     datPos += sizeof(float);
                     deS = sizeof(float) * 3;
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const float *vDf = reinterpret_cast<const float*>(vD);
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 0 * sizeof(float))) = (vDf[0] + xOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 1 * sizeof(float))) = (vDf[1] + yOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 2 * sizeof(float))) = (vDf[2] + zOff) * scale;
-                        }
-                    }
+                    transformParticles<float>(static_cast<const char*>(outP.GetVertexData()),
+                        vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride()),
+                        static_cast<INT64>(pCnt), 3, xOff, yOff, zOff, scale, this->data.AsAt<float>(datPos));
                     break;
                 case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
                     deS = sizeof(float) * 4;
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(4 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const float *vDf = reinterpret_cast<const float*>(vD);
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 0 * sizeof(float))) = (vDf[0] + xOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 1 * sizeof(float))) = (vDf[1] + yOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 2 * sizeof(float))) = (vDf[2] + zOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 3 * sizeof(float))) = vDf[3] * scale;
-                        }
-                    }
+                    transformParticles<float>(static_cast<const char*>(outP.GetVertexData()),
+                        vislib::math::Max<SIZE_T>(4 * sizeof(float), outP.GetVertexDataStride()),
+                        static_cast<INT64>(pCnt), 4, xOff, yOff, zOff, scale, this->data.AsAt<float>(datPos));
                     break;
                 case MultiParticleDataCall::Particles::VERTDATA_NONE:
                     deS = 0;
@@ -200,16 +249,9 @@ bool datatools::SphereDataUnifier::getDataCallback(core::Call& caller) {
                     *this->data.AsAt<float>(datPos) = outP.GetGlobalRadius() * scale;
                     datPos += sizeof(float);
                     deS = sizeof(float) * 3; // is most probably bullshit anyway
-                    {
-                        const char *vD = static_cast<const char*>(outP.GetVertexData());
-                        SIZE_T vDs = vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride());
-                        for (UINT64 pi = 0; pi < pCnt; pi++, vD += vDs) {
-                            const signed short *vDf = reinterpret_cast<const signed short*>(vD);
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 0 * sizeof(float))) = (static_cast<float>(vDf[0]) + xOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 1 * sizeof(float))) = (static_cast<float>(vDf[1]) + yOff) * scale;
-                            *this->data.AsAt<float>(static_cast<SIZE_T>(datPos + pi * deS + 2 * sizeof(float))) = (static_cast<float>(vDf[2]) + zOff) * scale;
-                        }
-                    }
+                    transformParticles<signed short>(static_cast<const char*>(outP.GetVertexData()),
+                        vislib::math::Max<SIZE_T>(3 * sizeof(float), outP.GetVertexDataStride()),
+                        static_cast<INT64>(pCnt), 3, xOff, yOff, zOff, scale, this->data.AsAt<float>(datPos));
                     break;
                 default:
                     deS = 0;
@@ -322,17 +364,15 @@ bool datatools::SphereDataUnifier::getExtentCallback(core::Call& caller) {
 /*
  * datatools::SphereDataUnifier::accumExt
  */
-void datatools::SphereDataUnifier::accumExt(bool& first, float x, float y, float z, float r) {
-    vislib::math::Cuboid<float> b(x - r, y - r, z - r, x + r, y + r, z + r);
-    vislib::math::Point<float, 3> p(x, y, z);
-
+void datatools::SphereDataUnifier::accumExt(bool& first, const vislib::math::Cuboid<float>& points,
+        const vislib::math::Cuboid<float>& spheres) {
     if (first) {
         first = false;
-        this->bbox.Set(p.X(), p.Y(), p.Z(), p.X(), p.Y(), p.Z());
-        this->cbox = b;
+        this->bbox = points;
+        this->cbox = spheres;
     } else {
-        this->bbox.GrowToPoint(p);
-        this->cbox.Union(b);
+        this->bbox.Union(points);
+        this->cbox.Union(spheres);
     }
 
 }
@@ -105,8 +105,16 @@ namespace datatools {
          */
         bool getExtentCallback(core::Call& caller);
 
-        /** TODO: Document */
-        void accumExt(bool& first, float x, float y, float z, float r);
+        /**
+         * Grows the bounding box and the clip box by the extents of one
+         * particle list.
+         *
+         * @param first Flag to be set before the first list, cleared here
+         * @param points The bounds of the particle centres
+         * @param spheres The bounds of the particle spheres
+         */
+        void accumExt(bool& first, const vislib::math::Cuboid<float>& points,
+            const vislib::math::Cuboid<float>& spheres);
 
         /** The call for the output data */
         core::CalleeSlot putDataSlot;
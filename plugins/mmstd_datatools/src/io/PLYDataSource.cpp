@@ -7,8 +7,13 @@
 
 #include "stdafx.h"
 #include "io/PLYDataSource.h"
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include "geometry_calls/CallTriMeshData.h"
@@ -124,6 +129,82 @@ template <class T> void changeEndianness(T& obj) {
     std::reverse(mem, mem + sizeof(T));
 }
 
+/**
+ * Copies one property of all elements into a destination array, changing the
+ * endianness of each value if necessary. The elements are processed in
+ * parallel.
+ *
+ * @param dst The first destination value.
+ * @param dstStride The distance between two destination values in values.
+ * @param src The property of the first element.
+ * @param srcStride The distance between two elements in bytes.
+ * @param size The size of the property in bytes.
+ * @param count The number of elements.
+ * @param swap True if the endianness has to be changed.
+ */
+template <class T>
+void copyProperty(T* dst, size_t dstStride, const char* src, size_t srcStride, size_t size, size_t count, bool swap) {
+    if (size > sizeof(T)) size = sizeof(T);
+    const int cnt = static_cast<int>(count);
+#pragma omp parallel for
+    for (int v = 0; v < cnt; v++) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, src + static_cast<size_t>(v) * srcStride, size);
+        if (swap) std::reverse(bytes, bytes + size);
+        T value = T();
+        std::memcpy(&value, bytes, size);
+        dst[static_cast<size_t>(v) * dstStride] = value;
+    }
+}
+
+/**
+ * Computes the bounds of interleaved three-component positions in parallel.
+ *
+ * @param pos The positions.
+ * @param count The number of positions.
+ * @param bounds Receives the minimum and the maximum, is only extended.
+ */
+template <class T> void growBounds(const T* pos, size_t count, float* bounds) {
+    const int cnt = static_cast<int>(count);
+#pragma omp parallel
+    {
+        float local[6] = {bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]};
+#pragma omp for
+        for (int v = 0; v < cnt; v++) {
+            for (int c = 0; c < 3; c++) {
+                float const val = static_cast<float>(pos[3 * static_cast<size_t>(v) + c]);
+                if (val < local[c]) local[c] = val;
+                if (val > local[c + 3]) local[c + 3] = val;
+            }
+        }
+#pragma omp critical
+        {
+            for (int c = 0; c < 3; c++) {
+                if (local[c] < bounds[c]) bounds[c] = local[c];
+                if (local[c + 3] > bounds[c + 3]) bounds[c + 3] = local[c + 3];
+            }
+        }
+    }
+}
+
+/**
+ * Splits an ASCII line into its whitespace separated words.
+ *
+ * @param line The first character of the line.
+ * @param lineEnd The end of the line.
+ * @param words Receives the start of the words.
+ */
+void splitWords(const char* line, const char* lineEnd, std::vector<const char*>& words) {
+    words.clear();
+    const char* c = line;
+    while (c < lineEnd) {
+        while (c < lineEnd && std::isspace(static_cast<unsigned char>(*c))) c++;
+        if (c >= lineEnd) break;
+        words.push_back(c);
+        while (c < lineEnd && !std::isspace(static_cast<unsigned char>(*c))) c++;
+    }
+}
+
 /*
  * io::PLYDataSource::theUndef
  */
@@ -342,10 +423,18 @@ bool io::PLYDataSource::assertData() {
     float* bbPointer = const_cast<float*>(boundingBox.PeekBounds()); // hackedihack
 
     if (this->hasBinaryFormat) {
+        // only the elements holding selected properties are read, all others are skipped
+        std::vector<bool> neededElements(this->elementCount.size(), false);
+        for (auto const& names : {selectedPos, selectedNormal, selectedColor}) {
+            for (auto const& s : names) {
+                if (elementIndexMap.count(s) > 0) neededElements[elementIndexMap[s].first] = true;
+            }
+        }
+        if (elementIndexMap.count(selectedIndices) > 0) neededElements[elementIndexMap[selectedIndices].first] = true;
+
         // vector storing the read data seperately
         std::vector<std::vector<char>> readData(this->elementCount.size());
         for (size_t i = 0; i < readData.size(); i++) {
-            // maybe TODO: skip unnecessary elements
             uint64_t readsize = elementSizes[i];
             if (elementIndexMap.count(selectedIndices) > 0) {
                 auto idx = elementIndexMap[selectedIndices];
@@ -354,9 +443,12 @@ bool io::PLYDataSource::assertData() {
                     readsize = listSizes[idx.first][idx.second] + 3 * propertySizes[idx.first][idx.second];
                 }
             }
-            readData[i].resize(elementCount[i] * readsize);
-            auto ms = readData[i].max_size();
-            instream.read(reinterpret_cast<char*>(readData[i].data()), elementCount[i] * readsize);
+            if (neededElements[i]) {
+                readData[i].resize(elementCount[i] * readsize);
+                instream.read(reinterpret_cast<char*>(readData[i].data()), elementCount[i] * readsize);
+            } else {
+                instream.seekg(elementCount[i] * readsize, instream.cur);
+            }
             if (instream.fail()) {
                 vislib::sys::Log::DefaultLog.WriteError(
                     "Reading of the field with index %i failed", static_cast<int>(i));
@@ -366,40 +458,29 @@ bool io::PLYDataSource::assertData() {
         }
 
         // copy the data into the vectors (this is necessary because the data may be interleaved, which is not always
-        // the case)
-        // this could be done partially in parallel
+        // the case), changing the endianness on the fly
+        bool const swap = !isLittleEndian;
         for (size_t i = 0; i < selectedPos.size(); i++) {
             if (elementIndexMap.count(selectedPos[i]) > 0) {
                 auto idx = elementIndexMap[selectedPos[i]];
                 auto elemSize = elementSizes[idx.first];
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
+                const char* src = readData[idx.first].data() + stride;
                 if (posPointers.pos_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &posPointers.pos_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                        if (posPointers.pos_float[3 * v + i] < bbPointer[i]) {
-                            bbPointer[i] = posPointers.pos_float[3 * v + i];
-                        }
-                        if (posPointers.pos_float[3 * v + i] > bbPointer[i + 3]) {
-                            bbPointer[i + 3] = posPointers.pos_float[3 * v + i];
-                        }
-                    }
+                    copyProperty(posPointers.pos_float + i, 3, src, elemSize, size, vertex_count, swap);
                 }
                 if (posPointers.pos_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &posPointers.pos_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                        if (posPointers.pos_double[3 * v + i] < bbPointer[i]) {
-                            bbPointer[i] = static_cast<float>(posPointers.pos_double[3 * v + i]);
-                        }
-                        if (posPointers.pos_double[3 * v + i] > bbPointer[i + 3]) {
-                            bbPointer[i + 3] = static_cast<float>(posPointers.pos_double[3 * v + i]);
-                        }
-                    }
+                    copyProperty(posPointers.pos_double + i, 3, src, elemSize, size, vertex_count, swap);
                 }
             }
         }
+        if (posPointers.pos_float != nullptr) {
+            growBounds(posPointers.pos_float, vertex_count, bbPointer);
+        }
+        if (posPointers.pos_double != nullptr) {
+            growBounds(posPointers.pos_double, vertex_count, bbPointer);
+        }
 
         for (size_t i = 0; i < selectedNormal.size(); i++) {
             if (elementIndexMap.count(selectedNormal[i]) > 0) {
@@ -407,17 +488,12 @@ bool io::PLYDataSource::assertData() {
                 auto elemSize = elementSizes[idx.first];
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
+                const char* src = readData[idx.first].data() + stride;
                 if (normalPointers.norm_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &normalPointers.norm_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyProperty(normalPointers.norm_float + i, 3, src, elemSize, size, vertex_count, swap);
                 }
                 if (normalPointers.norm_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &normalPointers.norm_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyProperty(normalPointers.norm_double + i, 3, src, elemSize, size, vertex_count, swap);
                 }
             }
         }
@@ -429,215 +505,178 @@ bool io::PLYDataSource::assertData() {
                 auto elemSize = elementSizes[idx.first];
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
+                const char* src = readData[idx.first].data() + stride;
                 if (colorPointers.col_uchar != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_uchar[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyProperty(colorPointers.col_uchar + i, 3, src, elemSize, size, vertex_count, swap);
                 }
                 if (colorPointers.col_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyProperty(colorPointers.col_float + i, 3, src, elemSize, size, vertex_count, swap);
                 }
                 if (colorPointers.col_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyProperty(colorPointers.col_double + i, 3, src, elemSize, size, vertex_count, swap);
                 }
             }
         }
 
         if (elementIndexMap.count(selectedIndices) > 0) {
             auto idx = elementIndexMap[selectedIndices];
-            auto elemSize = elementSizes[idx.first];
             auto size = propertySizes[idx.first][idx.second];
             auto stride = propertyStrides[idx.first][idx.second];
             auto listStartSize = listSizes[idx.first][idx.second];
             auto totSize = listStartSize + 3 * size;
-            if (facePointers.face_uchar != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_uchar[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
+            for (size_t k = 0; k < 3; k++) {
+                const char* src = readData[idx.first].data() + stride + listStartSize + k * size;
+                if (facePointers.face_uchar != nullptr) {
+                    copyProperty(facePointers.face_uchar + k, 3, src, totSize, size, face_count, swap);
                 }
-            }
-            if (facePointers.face_u16 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_u16[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
+                if (facePointers.face_u16 != nullptr) {
+                    copyProperty(facePointers.face_u16 + k, 3, src, totSize, size, face_count, swap);
                 }
-            }
-            if (facePointers.face_u32 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_u32[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
-                }
-            }
-        }
-        // change endianness if necessary
-        if (!isLittleEndian) {
-            // this could be done in parallel
-            if (posPointers.pos_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(posPointers.pos_float[3 * v + 0]);
-                    changeEndianness(posPointers.pos_float[3 * v + 1]);
-                    changeEndianness(posPointers.pos_float[3 * v + 2]);
-                }
-            }
-            if (posPointers.pos_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(posPointers.pos_double[3 * v + 0]);
-                    changeEndianness(posPointers.pos_double[3 * v + 1]);
-                    changeEndianness(posPointers.pos_double[3 * v + 2]);
-                }
-            }
-            if (normalPointers.norm_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(normalPointers.norm_float[3 * v + 0]);
-                    changeEndianness(normalPointers.norm_float[3 * v + 1]);
-                    changeEndianness(normalPointers.norm_float[3 * v + 2]);
-                }
-            }
-            if (normalPointers.norm_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(normalPointers.norm_double[3 * v + 0]);
-                    changeEndianness(normalPointers.norm_double[3 * v + 1]);
-                    changeEndianness(normalPointers.norm_double[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_uchar != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_uchar[3 * v + 0]);
-                    changeEndianness(colorPointers.col_uchar[3 * v + 1]);
-                    changeEndianness(colorPointers.col_uchar[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_float[3 * v + 0]);
-                    changeEndianness(colorPointers.col_float[3 * v + 1]);
-                    changeEndianness(colorPointers.col_float[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_double[3 * v + 0]);
-                    changeEndianness(colorPointers.col_double[3 * v + 1]);
-                    changeEndianness(colorPointers.col_double[3 * v + 2]);
-                }
-            }
-            if (facePointers.face_uchar != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_uchar[3 * f + 0]);
-                    changeEndianness(facePointers.face_uchar[3 * f + 1]);
-                    changeEndianness(facePointers.face_uchar[3 * f + 2]);
-                }
-            }
-            if (facePointers.face_u16 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_u16[3 * f + 0]);
-                    changeEndianness(facePointers.face_u16[3 * f + 1]);
-                    changeEndianness(facePointers.face_u16[3 * f + 2]);
-                }
-            }
-            if (facePointers.face_u32 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_u32[3 * f + 0]);
-                    changeEndianness(facePointers.face_u32[3 * f + 1]);
-                    changeEndianness(facePointers.face_u32[3 * f + 2]);
+                if (facePointers.face_u32 != nullptr) {
+                    copyProperty(facePointers.face_u32 + k, 3, src, totSize, size, face_count, swap);
                 }
             }
         }
     } else { // ascii format
-        std::string line;
+        // load the whole body and find the start of all lines
+        std::vector<char> body((std::istreambuf_iterator<char>(instream)), std::istreambuf_iterator<char>());
+        std::vector<const char*> lineStarts;
+        const char* bodyEnd = body.data() + body.size();
+        for (const char* c = body.data(); c < bodyEnd;) {
+            lineStarts.push_back(c);
+            const char* nl = static_cast<const char*>(std::memchr(c, '\n', bodyEnd - c));
+            c = (nl == nullptr) ? bodyEnd : nl + 1;
+        }
+        lineStarts.push_back(bodyEnd);
+        const size_t lineCount = lineStarts.size() - 1;
+
+        std::vector<std::pair<size_t, size_t>> posIdx, normalIdx, colorIdx;
+        for (size_t j = 0; j < selectedPos.size(); j++) {
+            if (elementIndexMap.count(selectedPos[j]) > 0) posIdx.push_back({j, elementIndexMap[selectedPos[j]].second});
+        }
+        for (size_t j = 0; j < selectedNormal.size(); j++) {
+            if (elementIndexMap.count(selectedNormal[j]) > 0)
+                normalIdx.push_back({j, elementIndexMap[selectedNormal[j]].second});
+        }
+        for (size_t j = 0; j < selectedColor.size() && j < 3; j++) {
+            if (elementIndexMap.count(selectedColor[j]) > 0)
+                colorIdx.push_back({j, elementIndexMap[selectedColor[j]].second});
+        }
+
+        size_t firstLine = 0;
         for (size_t elm = 0; elm < this->elementCount.size(); elm++) {
+            size_t const elmLines = static_cast<size_t>(this->elementCount[elm]);
+            bool const isVertices = icompare(elementNames[elm], selectedVertices);
+            bool const isFaces = icompare(elementNames[elm], selectedFaces) && elementIndexMap.count(selectedIndices);
+            if ((isVertices || isFaces) && (firstLine + (isVertices ? vertexCount : faceCount) > lineCount)) {
+                vislib::sys::Log::DefaultLog.WriteError(isVertices ? "Unexpected file ending during vertex parsing"
+                                                                   : "Unexpected file ending during face parsing");
+                return false;
+            }
+
             // parse vertices
-            if (icompare(elementNames[elm], selectedVertices)) {
-                for (size_t i = 0; i < vertexCount; i++) {
-                    if (std::getline(instream, line)) {
-                        auto split = isplit(line);
-                        for (size_t j = 0; j < selectedPos.size(); j++) {
-                            if (elementIndexMap.count(selectedPos[j]) > 0) {
-                                auto idx = elementIndexMap[selectedPos[j]];
-                                if (posPointers.pos_float != nullptr) {
-                                    posPointers.pos_float[3 * i + j] = std::stof(split[idx.second]);
-                                }
-                                if (posPointers.pos_double != nullptr) {
-                                    posPointers.pos_double[3 * i + j] = std::stod(split[idx.second]);
-                                }
-                                if (std::stof(split[idx.second]) < bbPointer[j]) {
-                                    bbPointer[j] = std::stof(split[idx.second]);
-                                }
-                                if (std::stof(split[idx.second]) > bbPointer[j + 3]) {
-                                    bbPointer[j + 3] = std::stof(split[idx.second]);
-                                }
+            if (isVertices) {
+                int const cnt = static_cast<int>(vertexCount);
+                bool failed = false;
+#pragma omp parallel
+                {
+                    std::vector<const char*> words;
+#pragma omp for
+                    for (int i = 0; i < cnt; i++) {
+                        splitWords(lineStarts[firstLine + i], lineStarts[firstLine + i + 1], words);
+                        bool ok = true;
+                        for (auto const& p : posIdx) {
+                            if (p.second >= words.size()) {
+                                ok = false;
+                                continue;
+                            }
+                            double const val = std::strtod(words[p.second], nullptr);
+                            if (posPointers.pos_float != nullptr) {
+                                posPointers.pos_float[3 * i + p.first] = static_cast<float>(val);
+                            }
+                            if (posPointers.pos_double != nullptr) {
+                                posPointers.pos_double[3 * i + p.first] = val;
                             }
                         }
-                        for (size_t j = 0; j < selectedNormal.size(); j++) {
-                            if (elementIndexMap.count(selectedNormal[j]) > 0) {
-                                auto idx = elementIndexMap[selectedNormal[j]];
-                                if (normalPointers.norm_float != nullptr) {
-                                    normalPointers.norm_float[3 * i + j] = std::stof(split[idx.second]);
-                                }
-                                if (normalPointers.norm_double != nullptr) {
-                                    normalPointers.norm_double[3 * i + j] = std::stod(split[idx.second]);
-                                }
+                        for (auto const& p : normalIdx) {
+                            if (p.second >= words.size()) {
+                                ok = false;
+                                continue;
+                            }
+                            double const val = std::strtod(words[p.second], nullptr);
+                            if (normalPointers.norm_float != nullptr) {
+                                normalPointers.norm_float[3 * i + p.first] = static_cast<float>(val);
+                            }
+                            if (normalPointers.norm_double != nullptr) {
+                                normalPointers.norm_double[3 * i + p.first] = val;
                             }
                         }
-                        for (size_t j = 0; j < selectedColor.size(); j++) {
-                            if (elementIndexMap.count(selectedColor[j]) > 0) {
-                                auto idx = elementIndexMap[selectedColor[j]];
-                                if (colorPointers.col_uchar != nullptr) {
-                                    colorPointers.col_uchar[3 * i + j] =
-                                        static_cast<unsigned char>(std::stoul(split[idx.second]));
-                                }
-                                if (colorPointers.col_float != nullptr) {
-                                    colorPointers.col_float[3 * i + j] = std::stof(split[idx.second]);
-                                }
-                                if (colorPointers.col_double != nullptr) {
-                                    colorPointers.col_double[3 * i + j] = std::stod(split[idx.second]);
-                                }
+                        for (auto const& p : colorIdx) {
+                            if (p.second >= words.size()) {
+                                ok = false;
+                                continue;
+                            }
+                            if (colorPointers.col_uchar != nullptr) {
+                                colorPointers.col_uchar[3 * i + p.first] =
+                                    static_cast<unsigned char>(std::strtoul(words[p.second], nullptr, 10));
+                            }
+                            if (colorPointers.col_float != nullptr) {
+                                colorPointers.col_float[3 * i + p.first] =
+                                    static_cast<float>(std::strtod(words[p.second], nullptr));
+                            }
+                            if (colorPointers.col_double != nullptr) {
+                                colorPointers.col_double[3 * i + p.first] = std::strtod(words[p.second], nullptr);
                             }
                         }
-                    } else {
-                        vislib::sys::Log::DefaultLog.WriteError("Unexpected file ending during vertex parsing");
-                        return false;
+                        if (!ok) failed = true;
                     }
                 }
+                if (failed) {
+                    vislib::sys::Log::DefaultLog.WriteError("Missing values during vertex parsing");
+                    return false;
+                }
+                if (posPointers.pos_float != nullptr) {
+                    growBounds(posPointers.pos_float, vertexCount, bbPointer);
+                }
+                if (posPointers.pos_double != nullptr) {
+                    growBounds(posPointers.pos_double, vertexCount, bbPointer);
+                }
             }
             // parse faces
-            if (icompare(elementNames[elm], selectedFaces)) {
-                for (size_t i = 0; i < faceCount; i++) {
-                    if (std::getline(instream, line)) {
-                        auto split = isplit(line);
-                        if (elementIndexMap.count(selectedIndices)) {
-                            uint64_t faceSize = static_cast<uint64_t>(std::stoul(split[0]));
-                            if (faceSize != 3) {
-                                vislib::sys::Log::DefaultLog.WriteError(
-                                    "The PlyDataSource is currently only able to handle triangular faces");
-                                return false;
+            if (isFaces) {
+                int const cnt = static_cast<int>(faceCount);
+                bool failed = false;
+#pragma omp parallel
+                {
+                    std::vector<const char*> words;
+#pragma omp for
+                    for (int i = 0; i < cnt; i++) {
+                        splitWords(lineStarts[firstLine + i], lineStarts[firstLine + i + 1], words);
+                        if (words.size() < 4 || std::strtoul(words[0], nullptr, 10) != 3) {
+                            failed = true;
+                            continue;
+                        }
+                        for (size_t j = 0; j < 3; j++) {
+                            unsigned long const val = std::strtoul(words[j + 1], nullptr, 10);
+                            if (facePointers.face_uchar != nullptr) {
+                                facePointers.face_uchar[3 * i + j] = static_cast<unsigned char>(val);
                             }
-                            for (size_t j = 1; j < faceSize + 1; j++) {
-                                unsigned long bla = std::stoul(split[j]);
-                                if (facePointers.face_uchar != nullptr) {
-                                    facePointers.face_uchar[3 * i + j - 1] = static_cast<unsigned char>(bla);
-                                }
-                                if (facePointers.face_u16 != nullptr) {
-                                    facePointers.face_u16[3 * i + j - 1] = static_cast<uint16_t>(bla);
-                                }
-                                if (facePointers.face_u32 != nullptr) {
-                                    facePointers.face_u32[3 * i + j - 1] = static_cast<uint32_t>(bla);
-                                }
+                            if (facePointers.face_u16 != nullptr) {
+                                facePointers.face_u16[3 * i + j] = static_cast<uint16_t>(val);
+                            }
+                            if (facePointers.face_u32 != nullptr) {
+                                facePointers.face_u32[3 * i + j] = static_cast<uint32_t>(val);
                             }
                         }
-                    } else {
-                        vislib::sys::Log::DefaultLog.WriteError("Unexpected file ending during face parsing");
-                        return false;
                     }
                 }
+                if (failed) {
+                    vislib::sys::Log::DefaultLog.WriteError(
+                        "The PlyDataSource is currently only able to handle triangular faces");
+                    return false;
+                }
             }
+            firstLine += elmLines;
         }
     }
 
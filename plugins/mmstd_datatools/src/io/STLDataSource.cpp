@@ -11,6 +11,7 @@
 #include "mmcore/AbstractGetData3DCall.h"
 #include "mmcore/Call.h"
 
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/utility/DataHash.h"
 
@@ -18,8 +19,12 @@
 
 #include "vislib/sys/Log.h"
 
+#include <omp.h>
+
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <limits>
@@ -30,6 +35,63 @@
 #include <string>
 #include <vector>
 
+namespace {
+/// <summary>
+/// Check for white space, as separating words in ASCII STL files
+/// </summary>
+inline bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/// <summary>
+/// Read the next word and convert it to lower case
+/// </summary>
+/// <param name="pos">Position in the text, moved behind the word</param>
+/// <param name="end">End of the text</param>
+/// <param name="word">Output word</param>
+/// <returns>True if a word was found; false at the end of the text</returns>
+inline bool next_word(const char*& pos, const char* end, std::string& word) {
+    while (pos < end && is_space(*pos)) ++pos;
+
+    if (pos == end) {
+        return false;
+    }
+
+    word.clear();
+
+    for (; pos < end && !is_space(*pos); ++pos) {
+        word.push_back(static_cast<char>(::tolower(static_cast<unsigned char>(*pos))));
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Find the next keyword 'facet', skipping the word the position may point into
+/// </summary>
+/// <param name="begin">Begin of the text</param>
+/// <param name="pos">Position at which to start the search</param>
+/// <param name="end">End of the text</param>
+/// <returns>Begin of the keyword, or the end of the text</returns>
+const char* next_facet(const char* begin, const char* pos, const char* end) {
+    if (pos > begin && !is_space(pos[-1])) {
+        while (pos < end && !is_space(*pos)) ++pos;
+    }
+
+    std::string word;
+
+    for (const char* word_begin = pos; next_word(pos, end, word); word_begin = pos) {
+        if (word.compare("facet") == 0) {
+            while (is_space(*word_begin)) ++word_begin;
+
+            return word_begin;
+        }
+    }
+
+    return end;
+}
+} // namespace
+
 namespace megamol {
 namespace stdplugin {
 namespace datatools {
@@ -37,11 +99,16 @@ namespace io {
 
 STLDataSource::STLDataSource()
     : filename_slot("STL file", "The name of to the STL file to load")
+    , weld_slot("Weld vertices", "Merge vertices at identical positions, creating an indexed mesh")
     , mesh_output_slot("mesh_data", "Slot to request mesh data") {
     // Create file name textbox
     this->filename_slot << new core::param::FilePathParam("");
     Module::MakeSlotAvailable(&this->filename_slot);
 
+    // Create option for vertex welding
+    this->weld_slot << new core::param::BoolParam(false);
+    Module::MakeSlotAvailable(&this->weld_slot);
+
     // Create output slot for triangle mesh data
     this->mesh_output_slot.SetCallback(
         geocalls::CallTriMeshData::ClassName(), "GetExtent", &STLDataSource::get_extent_callback);
@@ -76,8 +143,8 @@ bool STLDataSource::get_mesh_data_callback(core::Call& caller) {
         call.SetDataHash(static_cast<SIZE_T>(hash()));
 
         // Fill call
-        this->mesh.SetVertexData(
-            this->num_triangles * 3, this->vertex_buffer->data(), this->normal_buffer->data(), nullptr, nullptr, false);
+        this->mesh.SetVertexData(static_cast<unsigned int>(this->vertex_buffer->size() / 3),
+            this->vertex_buffer->data(), this->normal_buffer->data(), nullptr, nullptr, false);
 
         this->mesh.SetTriangleData(this->num_triangles, this->index_buffer->data(), false);
 
@@ -90,13 +157,15 @@ bool STLDataSource::get_mesh_data_callback(core::Call& caller) {
 void STLDataSource::release() {}
 
 bool STLDataSource::get_input() {
-    if (this->filename_slot.IsDirty()) {
+    if (this->filename_slot.IsDirty() || this->weld_slot.IsDirty()) {
         this->filename_slot.ResetDirty();
+        this->weld_slot.ResetDirty();
 
         // Create arrays
         this->vertex_buffer = std::make_shared<std::vector<float>>();
         this->normal_buffer = std::make_shared<std::vector<float>>();
         this->index_buffer = std::make_shared<std::vector<unsigned int>>();
+        this->num_triangles = 0;
 
         // Read data
         const auto& vislib_filename = this->filename_slot.Param<core::param::FilePathParam>()->Value();
@@ -110,6 +179,10 @@ bool STLDataSource::get_input() {
             return false;
         }
 
+        if (this->weld_slot.Param<core::param::BoolParam>()->Value()) {
+            weld_vertices();
+        }
+
         // Extract extent information
         this->min_x = this->min_y = this->min_z = std::numeric_limits<float>::max();
         this->max_x = this->max_y = this->max_z = std::numeric_limits<float>::lowest();
@@ -131,317 +204,431 @@ bool STLDataSource::get_input() {
         vislib::sys::Log::DefaultLog.WriteInfo("Extent: [%.2f, %.2f, %.2f] x [%.2f, %.2f, %.2f]", this->min_x,
             this->min_y, this->min_z, this->max_x, this->max_y, this->max_z);
     }
+
+    return true;
 }
 
 void STLDataSource::read(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in | std::ofstream::binary);
+    // Read the whole file at once, and parse it from memory
+    std::ifstream ifs(filename, std::ofstream::in | std::ofstream::binary | std::ofstream::ate);
 
-    if (ifs.good()) {
-        // Read first non-white characters to identify an ASCII file
-        std::string line;
+    if (!ifs.good()) {
+        std::stringstream ss;
+        ss << "STL file '" << filename << "' not found or inaccessible";
 
-        while (line.empty() && !ifs.eof()) {
-            // Read and convert line to lower case
-            std::getline(ifs, line);
-            std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+        throw std::runtime_error(ss.str());
+    }
 
-            line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-        }
+    std::vector<char> content(static_cast<std::size_t>(ifs.tellg()));
+    ifs.seekg(0);
 
-        // Read file
-        if (line.substr(0, line.find_first_of("\f\n\r\t\v ")).compare("solid") == 0) {
-            read_ascii(filename);
-        } else {
-            read_binary(filename);
-        }
-    } else {
+    if (!ifs.read(content.data(), static_cast<std::streamsize>(content.size()))) {
         std::stringstream ss;
-        ss << "STL file '" << filename << "' not found or inaccessible";
+        ss << "STL file '" << filename << "' could not be read";
 
         throw std::runtime_error(ss.str());
     }
+
+    // Identify an ASCII file by its first word; binary files whose header starts with 'solid' are told apart by
+    // their size matching the number of triangles
+    const char* pos = content.data();
+    std::string word;
+
+    bool ascii = next_word(pos, content.data() + content.size(), word) && word.compare("solid") == 0;
+
+    if (ascii && content.size() >= 84) {
+        uint32_t num_triangles;
+        std::memcpy(&num_triangles, content.data() + 80, sizeof(uint32_t));
+
+        ascii = content.size() != 84 + 50 * static_cast<std::size_t>(num_triangles);
+    }
+
+    // Read file
+    if (ascii) {
+        read_ascii(content);
+    } else {
+        read_binary(content);
+    }
 }
 
-void STLDataSource::read_binary(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in | std::ofstream::binary);
+void STLDataSource::read_binary(const std::vector<char>& content) {
+    // Get number of triangles from header
+    if (content.size() < 84) {
+        throw std::runtime_error("File is too small to contain an STL header.");
+    }
 
-    if (ifs.good()) {
-        // Get number of triangles from header
-        ifs.ignore(80 * sizeof(uint8_t));
-        ifs.read(reinterpret_cast<char*>(&this->num_triangles), sizeof(uint32_t));
+    std::memcpy(&this->num_triangles, content.data() + 80, sizeof(uint32_t));
 
-        // Sanity check for file size
-        ifs.ignore(std::numeric_limits<std::streamsize>::max());
-        std::streamsize file_size = ifs.gcount();
+    // Sanity check for file size
+    if (content.size() - 84 != 50 * static_cast<std::size_t>(this->num_triangles)) {
+        throw std::runtime_error("File size does not match the number of triangles.");
+    }
 
-        if (file_size != 50 * this->num_triangles) {
-            throw std::runtime_error("File size does not match the number of triangles.");
-        }
+    vislib::sys::Log::DefaultLog.WriteInfo("Number of triangles from binary STL file: %d", this->num_triangles);
 
-        vislib::sys::Log::DefaultLog.WriteInfo("Number of triangles from binary STL file: %d", this->num_triangles);
+    // Read data
+    this->vertex_buffer->resize(9 * this->num_triangles);
+    this->normal_buffer->resize(9 * this->num_triangles);
 
-        // Read data
-        ifs.seekg(80 * sizeof(uint8_t) + sizeof(uint32_t));
+    const char* triangles = content.data() + 84;
+    float* vertices = this->vertex_buffer->data();
+    float* normals = this->normal_buffer->data();
+
+#pragma omp parallel for
+    for (long long triangle_index = 0; triangle_index < static_cast<long long>(this->num_triangles);
+         ++triangle_index) {
+
+        const char* triangle = triangles + 50 * triangle_index;
+
+        std::memcpy(&normals[triangle_index * 9], triangle, 3 * sizeof(float));
+        std::memcpy(&vertices[triangle_index * 9], triangle + 3 * sizeof(float), 9 * sizeof(float));
+
+        // Duplicate normal such that there is one for every vertex
+        std::memcpy(&normals[triangle_index * 9 + 3], &normals[triangle_index * 9], 3 * sizeof(float));
+        std::memcpy(&normals[triangle_index * 9 + 6], &normals[triangle_index * 9], 3 * sizeof(float));
+    }
+
+    // Fill index buffer
+    this->index_buffer->resize(3 * this->num_triangles);
 
-        this->vertex_buffer->resize(9 * this->num_triangles);
-        this->normal_buffer->resize(9 * this->num_triangles);
+    std::iota(this->index_buffer->begin(), this->index_buffer->end(), 0);
+}
+
+void STLDataSource::read_ascii(const std::vector<char>& content) {
+    const char* begin = content.data();
+    const char* end = begin + content.size();
+
+    // Parse header: keyword 'solid', followed by an optional name
+    std::string word, name;
 
-        for (std::size_t triangle_index = 0; triangle_index < static_cast<std::size_t>(this->num_triangles);
-             ++triangle_index) {
+    const char* pos = begin;
+    next_word(pos, end, word);
 
-            ifs.read(reinterpret_cast<char*>(&(*this->normal_buffer)[triangle_index * 9]), 3 * sizeof(float));
-            ifs.read(reinterpret_cast<char*>(&(*this->vertex_buffer)[triangle_index * 9]), 9 * sizeof(float));
-            ifs.ignore(sizeof(uint16_t));
+    const char* name_end = pos;
+
+    if (next_word(name_end, end, word) && word.compare("facet") != 0 && word.compare("endsolid") != 0) {
+        name = word;
+        pos = name_end;
+    }
+
+    // Split the facets into chunks, each starting with a keyword 'facet', and parse them in parallel
+    const std::size_t min_chunk_size = 1 << 20;
+    const std::size_t max_chunks = static_cast<std::size_t>(4 * omp_get_max_threads());
+    const std::size_t num_chunks =
+        std::max<std::size_t>(1, std::min(static_cast<std::size_t>(end - pos) / min_chunk_size, max_chunks));
+
+    std::vector<const char*> chunks(num_chunks + 1);
+    chunks[0] = pos;
+    chunks[num_chunks] = end;
+
+    for (std::size_t chunk_index = 1; chunk_index < num_chunks; ++chunk_index) {
+        chunks[chunk_index] = std::max(chunks[chunk_index - 1],
+            next_facet(begin, pos + ((end - pos) * chunk_index) / num_chunks, end));
+    }
 
-            // Duplicate normal such that there is one for every vertex
-            std::memcpy(&(*this->normal_buffer)[triangle_index * 9 + 3], &(*this->normal_buffer)[triangle_index * 9],
-                3 * sizeof(float));
-            std::memcpy(&(*this->normal_buffer)[triangle_index * 9 + 6], &(*this->normal_buffer)[triangle_index * 9],
-                3 * sizeof(float));
+    std::vector<std::vector<float>> chunk_vertices(num_chunks), chunk_normals(num_chunks);
+    std::vector<parser_states_t> chunk_states(num_chunks);
+    std::vector<std::string> chunk_errors(num_chunks);
+
+#pragma omp parallel for schedule(dynamic)
+    for (long long chunk_index = 0; chunk_index < static_cast<long long>(num_chunks); ++chunk_index) {
+        try {
+            chunk_states[chunk_index] = parse_ascii(chunks[chunk_index], chunks[chunk_index + 1], name,
+                chunk_vertices[chunk_index], chunk_normals[chunk_index]);
+        } catch (const std::runtime_error& ex) {
+            chunk_errors[chunk_index] = ex.what();
         }
+    }
 
-        // Fill index buffer
-        this->index_buffer->resize(3 * this->num_triangles);
+    // Merge chunks in order, ignoring everything after the end of the solid
+    std::size_t num_values = 0;
+    std::size_t num_used_chunks = 0;
 
-        std::iota(this->index_buffer->begin(), this->index_buffer->end(), 0);
-    } else {
-        std::stringstream ss;
-        ss << "STL file '" << filename << "' not found or inaccessible";
+    for (; num_used_chunks < num_chunks; ++num_used_chunks) {
+        if (!chunk_errors[num_used_chunks].empty()) {
+            throw std::runtime_error(chunk_errors[num_used_chunks]);
+        }
 
-        throw std::runtime_error(ss.str());
+        num_values += chunk_vertices[num_used_chunks].size();
+
+        if (chunk_states[num_used_chunks] != parser_states_t::EXPECT_FACET_OR_ENDSOLID) {
+            ++num_used_chunks;
+            break;
+        }
     }
+
+    bool trailing_text = chunk_states[num_used_chunks - 1] == parser_states_t::EXPECT_SOLID;
+
+    for (std::size_t chunk_index = num_used_chunks; chunk_index < num_chunks && !trailing_text; ++chunk_index) {
+        const char* chunk_pos = chunks[chunk_index];
+        trailing_text = next_word(chunk_pos, chunks[chunk_index + 1], word);
+    }
+
+    if (trailing_text) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Found more text after keyword 'endsolid' in ASCII STL file. %s",
+            "Maybe more than one object is stored in the file. This is not supported by this reader.");
+    }
+
+    std::vector<float>& vertices = *this->vertex_buffer;
+    std::vector<float>& normals = *this->normal_buffer;
+
+    vertices.reserve(num_values);
+    normals.reserve(num_values);
+
+    for (std::size_t chunk_index = 0; chunk_index < num_used_chunks; ++chunk_index) {
+        vertices.insert(vertices.end(), chunk_vertices[chunk_index].begin(), chunk_vertices[chunk_index].end());
+        normals.insert(normals.end(), chunk_normals[chunk_index].begin(), chunk_normals[chunk_index].end());
+    }
+
+    this->num_triangles = static_cast<uint32_t>(vertices.size() / 9);
+    vislib::sys::Log::DefaultLog.WriteInfo("Number of triangles from ASCII STL file: %d", this->num_triangles);
+
+    // Fill index buffer
+    this->index_buffer->resize(3 * this->num_triangles);
+
+    std::iota(this->index_buffer->begin(), this->index_buffer->end(), 0);
 }
 
-void STLDataSource::read_ascii(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in);
-
-    if (ifs.good()) {
-        // Get file size and estimate number of triangles
-        ifs.ignore(std::numeric_limits<std::streamsize>::max());
-        std::streamsize file_size = ifs.gcount();
-        ifs.seekg(ifs.beg);
-
-        const std::size_t estimated_num_triangles =
-            static_cast<std::size_t>(1.5f * (static_cast<float>(file_size) / 256.0f));
-
-        std::vector<float>& vertices = *this->vertex_buffer;
-        std::vector<float>& normals = *this->normal_buffer;
-
-        vertices.reserve(9 * estimated_num_triangles);
-        normals.reserve(3 * estimated_num_triangles);
-
-        // Parse file
-        parser_states_t state = parser_states_t::EXPECT_SOLID;
-
-        std::string line;
-        std::string name;
-
-        while (!ifs.eof()) {
-            // Read and convert line to lower case
-            std::getline(ifs, line);
-            std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-
-            line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-
-            while (!line.empty()) {
-                // Extract word from line
-                const std::string word = line.substr(0, line.find_first_of("\f\n\r\t\v "));
-
-                line.erase(0, word.size());
-                line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-
-                // Parse word
-                switch (state) {
-                case parser_states_t::EXPECT_SOLID:
-                    if (word.compare("solid") == 0) {
-                        state = parser_states_t::EXPECT_NAME;
-                    } else {
-                        throw std::runtime_error("Expected ASCII STL file to begin with keyword 'solid'");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_NAME:
-                    name = word;
-
-                    state = parser_states_t::EXPECT_FACET_OR_ENDSOLID;
-
-                    break;
-                case parser_states_t::EXPECT_FACET_OR_ENDSOLID:
-                    if (word.compare("facet") == 0) {
-                        state = parser_states_t::EXPECT_NORMAL;
-                    } else if (word.compare("endsolid") == 0) {
-                        state = parser_states_t::EXPECT_ENDNAME;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'facet' or 'endsolid' after solid name or 'endfacet' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_NORMAL:
-                    if (word.compare("normal") == 0) {
-                        state = parser_states_t::EXPECT_NORMAL_I;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'normal' after keyword 'facet' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_NORMAL_I:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_NORMAL_J;
-
-                    break;
-                case parser_states_t::EXPECT_NORMAL_J:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_NORMAL_K;
-
-                    break;
-                case parser_states_t::EXPECT_NORMAL_K:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_OUTER;
-
-                    break;
-                case parser_states_t::EXPECT_OUTER:
-                    if (word.compare("outer") == 0) {
-                        state = parser_states_t::EXPECT_LOOP;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'outer' after the normal values in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_LOOP:
-                    if (word.compare("loop") == 0) {
-                        state = parser_states_t::EXPECT_VERTEX_1;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'loop' after keyword 'outer' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_1:
-                    if (word.compare("vertex") == 0) {
-                        state = parser_states_t::EXPECT_VERTEX_1_X;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'vertex' after keyword 'loop' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_1_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_1_Y;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_1_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_1_Z;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_1_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_2;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_2:
-                    if (word.compare("vertex") == 0) {
-                        state = parser_states_t::EXPECT_VERTEX_2_X;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'vertex' after the first vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_2_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_2_Y;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_2_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_2_Z;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_2_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_3;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_3:
-                    if (word.compare("vertex") == 0) {
-                        state = parser_states_t::EXPECT_VERTEX_3_X;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'vertex' after the second vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_3_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_3_Y;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_3_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_VERTEX_3_Z;
-
-                    break;
-                case parser_states_t::EXPECT_VERTEX_3_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = parser_states_t::EXPECT_ENDLOOP;
-
-                    break;
-                case parser_states_t::EXPECT_ENDLOOP:
-                    if (word.compare("endloop") == 0) {
-                        state = parser_states_t::EXPECT_ENDFACET;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'endloop' after the third vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_ENDFACET:
-                    if (word.compare("endfacet") == 0) {
-                        state = parser_states_t::EXPECT_FACET_OR_ENDSOLID;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'endfacet' after keyword 'endloop' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_ENDNAME:
-                    if (word.compare(name) == 0) {
-                        state = parser_states_t::EXPECT_EOF;
-                    } else {
-                        throw std::runtime_error("Expected same solid name after keyword 'endsolid' in ASCII STL file");
-                    }
-
-                    break;
-                case parser_states_t::EXPECT_EOF:
-                default:
-                    vislib::sys::Log::DefaultLog.WriteWarn(
-                        "Found more text after keyword 'endsolid' in ASCII STL file. %s",
-                        "Maybe more than one object is stored in the file. This is not supported by this reader.");
+STLDataSource::parser_states_t STLDataSource::parse_ascii(const char* begin, const char* end,
+    const std::string& name, std::vector<float>& vertices, std::vector<float>& normals) const {
+
+    // Values are only stored for complete facets
+    std::array<float, 3> normal;
+    std::array<float, 9> triangle;
+    std::size_t value_index = 0;
+
+    parser_states_t state = parser_states_t::EXPECT_FACET_OR_ENDSOLID;
+
+    auto next_state = [](const parser_states_t state) {
+        return static_cast<parser_states_t>(static_cast<int>(state) + 1);
+    };
+
+    const char* pos = begin;
+    std::string word;
+
+    while (next_word(pos, end, word)) {
+        // Parse word
+        switch (state) {
+        case parser_states_t::EXPECT_FACET_OR_ENDSOLID:
+            if (word.compare("facet") == 0) {
+                state = parser_states_t::EXPECT_NORMAL;
+            } else if (word.compare("endsolid") == 0) {
+                state = name.empty() ? parser_states_t::EXPECT_EOF : parser_states_t::EXPECT_ENDNAME;
+            } else {
+                throw std::runtime_error(
+                    "Expected keyword 'facet' or 'endsolid' after solid name or 'endfacet' in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_NORMAL:
+            if (word.compare("normal") == 0) {
+                state = parser_states_t::EXPECT_NORMAL_I;
+                value_index = 0;
+            } else {
+                throw std::runtime_error("Expected keyword 'normal' after keyword 'facet' in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_NORMAL_I:
+        case parser_states_t::EXPECT_NORMAL_J:
+        case parser_states_t::EXPECT_NORMAL_K:
+            normal[value_index++] = static_cast<float>(atof(word.c_str()));
+
+            state = next_state(state);
+            value_index %= 3;
+
+            break;
+        case parser_states_t::EXPECT_OUTER:
+            if (word.compare("outer") == 0) {
+                state = parser_states_t::EXPECT_LOOP;
+            } else {
+                throw std::runtime_error("Expected keyword 'outer' after the normal values in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_LOOP:
+            if (word.compare("loop") == 0) {
+                state = parser_states_t::EXPECT_VERTEX_1;
+            } else {
+                throw std::runtime_error("Expected keyword 'loop' after keyword 'outer' in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_VERTEX_1:
+            if (word.compare("vertex") == 0) {
+                state = parser_states_t::EXPECT_VERTEX_1_X;
+            } else {
+                throw std::runtime_error("Expected keyword 'vertex' after keyword 'loop' in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_VERTEX_2:
+            if (word.compare("vertex") == 0) {
+                state = parser_states_t::EXPECT_VERTEX_2_X;
+            } else {
+                throw std::runtime_error("Expected keyword 'vertex' after the first vertex values in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_VERTEX_3:
+            if (word.compare("vertex") == 0) {
+                state = parser_states_t::EXPECT_VERTEX_3_X;
+            } else {
+                throw std::runtime_error("Expected keyword 'vertex' after the second vertex values in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_VERTEX_1_X:
+        case parser_states_t::EXPECT_VERTEX_1_Y:
+        case parser_states_t::EXPECT_VERTEX_1_Z:
+        case parser_states_t::EXPECT_VERTEX_2_X:
+        case parser_states_t::EXPECT_VERTEX_2_Y:
+        case parser_states_t::EXPECT_VERTEX_2_Z:
+        case parser_states_t::EXPECT_VERTEX_3_X:
+        case parser_states_t::EXPECT_VERTEX_3_Y:
+        case parser_states_t::EXPECT_VERTEX_3_Z:
+            triangle[value_index++] = static_cast<float>(atof(word.c_str()));
+
+            state = next_state(state);
+
+            break;
+        case parser_states_t::EXPECT_ENDLOOP:
+            if (word.compare("endloop") == 0) {
+                state = parser_states_t::EXPECT_ENDFACET;
+            } else {
+                throw std::runtime_error("Expected keyword 'endloop' after the third vertex values in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_ENDFACET:
+            if (word.compare("endfacet") == 0) {
+                state = parser_states_t::EXPECT_FACET_OR_ENDSOLID;
+
+                // Store facet, duplicating the normal such that there is one for every vertex
+                vertices.insert(vertices.end(), triangle.begin(), triangle.end());
+
+                for (int i = 0; i < 3; ++i) {
+                    normals.insert(normals.end(), normal.begin(), normal.end());
                 }
+
+                value_index = 0;
+            } else {
+                throw std::runtime_error("Expected keyword 'endfacet' after keyword 'endloop' in ASCII STL file");
             }
+
+            break;
+        case parser_states_t::EXPECT_ENDNAME:
+            if (word.compare(name) == 0) {
+                state = parser_states_t::EXPECT_EOF;
+            } else {
+                throw std::runtime_error("Expected same solid name after keyword 'endsolid' in ASCII STL file");
+            }
+
+            break;
+        case parser_states_t::EXPECT_SOLID:
+        case parser_states_t::EXPECT_NAME:
+        case parser_states_t::EXPECT_EOF:
+        default:
+            // Everything after the end of the solid is ignored, probably being another solid
+            return parser_states_t::EXPECT_SOLID;
+        }
+    }
+
+    return state;
+}
+
+void STLDataSource::weld_vertices() {
+    const std::vector<float>& vertices = *this->vertex_buffer;
+    const std::vector<float>& normals = *this->normal_buffer;
+
+    const long long num_vertices = static_cast<long long>(vertices.size() / 3);
+
+    if (num_vertices == 0) {
+        return;
+    }
+
+    // Sort vertices by position, sorting chunks in parallel and merging them pairwise
+    std::vector<unsigned int> order(static_cast<std::size_t>(num_vertices));
+    std::iota(order.begin(), order.end(), 0);
+
+    auto less = [&vertices](const unsigned int lhs, const unsigned int rhs) {
+        return std::lexicographical_compare(
+            &vertices[3 * lhs], &vertices[3 * lhs + 3], &vertices[3 * rhs], &vertices[3 * rhs + 3]);
+    };
+
+    auto equal = [&vertices](const unsigned int lhs, const unsigned int rhs) {
+        return std::equal(&vertices[3 * lhs], &vertices[3 * lhs + 3], &vertices[3 * rhs]);
+    };
+
+    const long long num_chunks =
+        std::max(1LL, std::min(static_cast<long long>(omp_get_max_threads()), num_vertices / 4096));
+
+    auto chunk_begin = [&order, num_vertices, num_chunks](const long long chunk_index) {
+        return order.begin() + std::min(num_vertices, (num_vertices * chunk_index) / num_chunks);
+    };
+
+#pragma omp parallel for
+    for (long long chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+        std::sort(chunk_begin(chunk_index), chunk_begin(chunk_index + 1), less);
+    }
+
+    for (long long width = 1; width < num_chunks; width *= 2) {
+#pragma omp parallel for
+        for (long long chunk_index = 0; chunk_index < num_chunks; chunk_index += 2 * width) {
+            std::inplace_merge(chunk_begin(chunk_index), chunk_begin(std::min(chunk_index + width, num_chunks)),
+                chunk_begin(std::min(chunk_index + 2 * width, num_chunks)), less);
         }
+    }
 
-        this->num_triangles = static_cast<uint32_t>(vertices.size() / 9);
-        vislib::sys::Log::DefaultLog.WriteInfo("Number of triangles from ASCII STL file: %d", this->num_triangles);
+    // Assign a new index to each distinct position, accumulating the normals of the merged vertices
+    std::vector<unsigned int> remap(static_cast<std::size_t>(num_vertices));
+    auto welded_vertices = std::make_shared<std::vector<float>>();
+    auto welded_normals = std::make_shared<std::vector<float>>();
 
-        // Fill index buffer
-        this->index_buffer->resize(3 * this->num_triangles);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const auto vertex = order[i];
+
+        if (i == 0 || !equal(order[i - 1], vertex)) {
+            welded_vertices->insert(welded_vertices->end(), &vertices[3 * vertex], &vertices[3 * vertex + 3]);
+            welded_normals->insert(welded_normals->end(), 3, 0.0f);
+        }
 
-        std::iota(this->index_buffer->begin(), this->index_buffer->end(), 0);
+        const std::size_t new_index = welded_vertices->size() / 3 - 1;
+
+        (*welded_normals)[3 * new_index + 0] += normals[3 * vertex + 0];
+        (*welded_normals)[3 * new_index + 1] += normals[3 * vertex + 1];
+        (*welded_normals)[3 * new_index + 2] += normals[3 * vertex + 2];
+
+        remap[vertex] = static_cast<unsigned int>(new_index);
     }
+
+    const long long num_welded_vertices = static_cast<long long>(welded_vertices->size() / 3);
+
+#pragma omp parallel for
+    for (long long vertex_index = 0; vertex_index < num_welded_vertices; ++vertex_index) {
+        float* normal = &(*welded_normals)[3 * vertex_index];
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+        if (length > 0.0f) {
+            normal[0] /= length;
+            normal[1] /= length;
+            normal[2] /= length;
+        }
+    }
+
+    // Replace the triangle soup by the indexed mesh
+    std::vector<unsigned int>& indices = *this->index_buffer;
+
+#pragma omp parallel for
+    for (long long index = 0; index < static_cast<long long>(indices.size()); ++index) {
+        indices[index] = remap[indices[index]];
+    }
+
+    vislib::sys::Log::DefaultLog.WriteInfo(
+        "Welded %lld vertices of STL file into %lld vertices", num_vertices, num_welded_vertices);
+
+    this->vertex_buffer = welded_vertices;
+    this->normal_buffer = welded_normals;
 }
 
 uint32_t STLDataSource::hash() const {
@@ -450,6 +637,8 @@ uint32_t STLDataSource::hash() const {
     }
 
     return core::utility::DataHash(
+        // Number of vertices, which changes by welding
+        this->vertex_buffer->size(),
         // First vertex
         (*this->vertex_buffer)[0 * sizeof(float)],
         (*this->vertex_buffer)[1 * sizeof(float)],
@@ -30,6 +30,7 @@
 #include "IColToIdentity.h"
 #include "IndexListIndexColor.h"
 #include "MPDCListsConcatenate.h"
+#include "MPIDomainDecomposition.h"
 #include "MPIParticleCollector.h"
 #include "MPIVolumeAggregator.h"
 #include "MeshTranslateRotateScale.h"
@@ -219,6 +220,7 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::io::PlyWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::MPIParticleCollector>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::MPIVolumeAggregator>();
+        this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::MPIDomainDecomposition>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::ParticlesToDensity>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::MPDCListsConcatenate>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::datatools::io::STLDataSource>();
@@ -23,6 +23,9 @@
 #include <list>
 #include <random>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <omp.h>
 
@@ -46,7 +49,84 @@ std::istream& expect(std::istream& is) {
     return is;
 }
 
+/**
+ * Parses a plain decimal number (optional sign, digits, fraction and exponent,
+ * surrounded by optional blanks) without any locale or stream overhead.
+ *
+ * @return 'true' on success, 'false' if the token needs the general parser.
+ */
+bool parseNumberFast(const char* tokenStart, const char* tokenEnd, double& value) {
+    const char* p = tokenStart;
+    while ((p != tokenEnd) && ((*p == ' ') || (*p == '\t'))) ++p;
+    while ((tokenEnd != p) && ((tokenEnd[-1] == ' ') || (tokenEnd[-1] == '\t') || (tokenEnd[-1] == '\r'))) --tokenEnd;
+    if (p == tokenEnd) return false;
+
+    bool negative = false;
+    if ((*p == '-') || (*p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool anyDigit = false;
+    for (; (p != tokenEnd) && (*p >= '0') && (*p <= '9'); ++p) {
+        anyDigit = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa != 0) ++digits;
+        } else {
+            ++exponent; // digits beyond the precision of the mantissa
+        }
+    }
+    if ((p != tokenEnd) && (*p == '.')) {
+        for (++p; (p != tokenEnd) && (*p >= '0') && (*p <= '9'); ++p) {
+            anyDigit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa != 0) ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!anyDigit) return false;
+    if ((p != tokenEnd) && ((*p == 'e') || (*p == 'E'))) {
+        ++p;
+        bool negativeExp = false;
+        if ((p != tokenEnd) && ((*p == '-') || (*p == '+'))) {
+            negativeExp = (*p == '-');
+            ++p;
+        }
+        if ((p == tokenEnd) || (*p < '0') || (*p > '9')) return false;
+        int e = 0;
+        for (; (p != tokenEnd) && (*p >= '0') && (*p <= '9'); ++p) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+        }
+        exponent += negativeExp ? -e : e;
+    }
+    if (p != tokenEnd) return false;
+
+    // Exact powers of ten up to 1e22 keep the result correctly rounded for
+    // typical data; larger exponents are accurate well beyond float precision.
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+        1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    double v = static_cast<double>(mantissa);
+    if (exponent < 0) {
+        v = (exponent >= -22) ? (v / powers[-exponent]) : (v * std::pow(10.0, exponent));
+    } else if (exponent > 0) {
+        v = (exponent <= 22) ? (v * powers[exponent]) : (v * std::pow(10.0, exponent));
+    }
+    value = negative ? -v : v;
+    return true;
+}
+
 double parseValue(const char* tokenStart, const char* tokenEnd) {
+    double fast;
+    if (parseNumberFast(tokenStart, tokenEnd, fast)) {
+        return fast;
+    }
+
     std::string token(tokenStart, tokenEnd - tokenStart);
 
     std::istringstream iss(token);
@@ -407,18 +487,25 @@ void CSVDataSource::assertData(void) {
             }
         }
 
-        // Collect min/max
-        std::vector<float> minVals(colCnt, std::numeric_limits<float>::max());
-        std::vector<float> maxVals(colCnt, -std::numeric_limits<float>::max());
-        for (size_t r = 0; r < rowCnt; ++r) {
+        // Collect min/max, per thread over blocks of rows
+        std::vector<float> minVals(colCnt * thCnt, std::numeric_limits<float>::max());
+        std::vector<float> maxVals(colCnt * thCnt, -std::numeric_limits<float>::max());
+#pragma omp parallel for
+        for (long long r = 0; r < static_cast<long long>(rowCnt); ++r) {
+            const size_t off = static_cast<size_t>(omp_get_thread_num()) * colCnt;
+            const float *row = values.data() + static_cast<size_t>(r) * colCnt;
             for (size_t c = 0; c < colCnt; ++c) {
-                float f = values[r * colCnt + c];
-                if (f < minVals[c]) minVals[c] = f;
-                if (f > maxVals[c]) maxVals[c] = f;
+                if (row[c] < minVals[off + c]) minVals[off + c] = row[c];
+                if (row[c] > maxVals[off + c]) maxVals[off + c] = row[c];
             }
         }
         for (size_t c = 0; c < colCnt; ++c) {
-            columns[c].SetMinimumValue(minVals[c]).SetMaximumValue(maxVals[c]);
+            float minVal = minVals[c], maxVal = maxVals[c];
+            for (int t = 1; t < thCnt; ++t) {
+                minVal = std::min(minVal, minVals[t * colCnt + c]);
+                maxVal = std::max(maxVal, maxVals[t * colCnt + c]);
+            }
+            columns[c].SetMinimumValue(minVal).SetMaximumValue(maxVal);
         }
 
         // 5. All done... report summary
@@ -0,0 +1,477 @@
+/*
+ * ColumnExpression.cpp
+ *
+ * Copyright (C) 2019 by VISUS (University of Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "ColumnExpression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using namespace megamol::stdplugin::datatools;
+using namespace megamol::stdplugin::datatools::table;
+using namespace megamol;
+
+namespace {
+
+/** Applies f to the values of a block */
+template <class F> inline void unary(float* d, const float* a, size_t n, F f) {
+    for (size_t i = 0; i < n; ++i) d[i] = f(a[i]);
+}
+
+/** Applies f to the values of two blocks */
+template <class F> inline void binary(float* d, const float* a, const float* b, size_t n, F f) {
+    for (size_t i = 0; i < n; ++i) d[i] = f(a[i], b[i]);
+}
+
+} // namespace
+
+
+/**
+ * Recursive descent parser for Lua expressions with the usual precedence,
+ * from or, and, comparisons, + -, * / %, unary not and - up to ^. Values
+ * are kept on a stack of registers, thus the operands of an operation are
+ * always the topmost registers.
+ */
+class ColumnExpression::Parser {
+public:
+    Parser(const std::string& text, const TableDataCall::ColumnInfo* infos, size_t columnCount,
+        std::vector<Instruction>& code)
+        : text(text), infos(infos), columnCount(columnCount), code(code), pos(0), top(0), maxTop(0) {}
+
+    /** Parses the whole expression, answering the number of registers needed */
+    unsigned int Parse(void) {
+        this->parseOr();
+        this->skipSpace();
+        if (this->pos < this->text.size()) this->fail("unexpected '" + this->text.substr(this->pos, 1) + "'");
+        return this->maxTop;
+    }
+
+private:
+    typedef void (Parser::*Level)(void);
+
+    void fail(const std::string& msg) const {
+        throw std::runtime_error(msg + " at position " + std::to_string(this->pos + 1));
+    }
+
+    void skipSpace(void) {
+        while ((this->pos < this->text.size()) && std::isspace(static_cast<unsigned char>(this->text[this->pos]))) {
+            ++this->pos;
+        }
+    }
+
+    /** Consumes the operator token if it is next */
+    bool accept(const char* token) {
+        this->skipSpace();
+        const size_t len = std::char_traits<char>::length(token);
+        if (this->text.compare(this->pos, len, token) != 0) return false;
+        // keywords must not be the prefix of a name, '<' must not be the prefix of '<='
+        if (std::isalpha(static_cast<unsigned char>(token[0]))) {
+            if ((this->pos + len < this->text.size()) && isNameChar(this->text[this->pos + len])) return false;
+        } else if ((len == 1) && (this->pos + 1 < this->text.size()) && (this->text[this->pos + 1] == '=') &&
+                   ((token[0] == '<') || (token[0] == '>'))) {
+            return false;
+        }
+        this->pos += len;
+        return true;
+    }
+
+    void expect(const char* token) {
+        if (!this->accept(token)) this->fail(std::string("'") + token + "' expected");
+    }
+
+    static bool isNameChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || (c == '_'); }
+
+    unsigned int push(void) {
+        this->maxTop = std::max(this->maxTop, this->top + 1);
+        return this->top++;
+    }
+
+    void emit(Op op, unsigned int dst, unsigned int a = 0, unsigned int b = 0, unsigned int c = 0) {
+        this->code.push_back(Instruction{op, dst, a, b, c, 0, 0.0f});
+    }
+
+    /** Emits op on the two topmost registers, leaving the result in the lower one */
+    void emitBinary(Op op) {
+        const unsigned int a = this->top - 2;
+        this->emit(op, a, a, a + 1);
+        --this->top;
+    }
+
+    void parseOr(void) {
+        this->parseAnd();
+        while (this->accept("or")) {
+            this->parseAnd();
+            this->emitBinary(Op::Or);
+        }
+    }
+
+    void parseAnd(void) {
+        this->parseComparison();
+        while (this->accept("and")) {
+            this->parseComparison();
+            this->emitBinary(Op::And);
+        }
+    }
+
+    void parseComparison(void) {
+        static const std::pair<const char*, Op> ops[] = {{"==", Op::Eq}, {"~=", Op::Ne}, {"<=", Op::Le},
+            {">=", Op::Ge}, {"<", Op::Lt}, {">", Op::Gt}};
+        this->parseAdditive();
+        bool found = true;
+        while (found) {
+            found = false;
+            for (const auto& o : ops) {
+                if (this->accept(o.first)) {
+                    this->parseAdditive();
+                    this->emitBinary(o.second);
+                    found = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    void parseAdditive(void) {
+        this->parseMultiplicative();
+        while (true) {
+            if (this->accept("+")) {
+                this->parseMultiplicative();
+                this->emitBinary(Op::Add);
+            } else if (this->accept("-")) {
+                this->parseMultiplicative();
+                this->emitBinary(Op::Sub);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseMultiplicative(void) {
+        this->parseUnary();
+        while (true) {
+            if (this->accept("*")) {
+                this->parseUnary();
+                this->emitBinary(Op::Mul);
+            } else if (this->accept("/")) {
+                this->parseUnary();
+                this->emitBinary(Op::Div);
+            } else if (this->accept("%")) {
+                this->parseUnary();
+                this->emitBinary(Op::Mod);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseUnary(void) {
+        if (this->accept("not")) {
+            this->parseUnary();
+            this->emit(Op::Not, this->top - 1, this->top - 1);
+        } else if (this->accept("-")) {
+            this->parseUnary();
+            this->emit(Op::Neg, this->top - 1, this->top - 1);
+        } else {
+            this->parsePower();
+        }
+    }
+
+    void parsePower(void) {
+        this->parsePrimary();
+        if (this->accept("^")) {
+            // right associative and binding tighter than a unary minus on its left only
+            this->parseUnary();
+            this->emitBinary(Op::Pow);
+        }
+    }
+
+    void parsePrimary(void) {
+        this->skipSpace();
+        if (this->pos >= this->text.size()) this->fail("value expected");
+        const char c = this->text[this->pos];
+
+        if (this->accept("(")) {
+            this->parseOr();
+            this->expect(")");
+        } else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.')) {
+            const char* begin = this->text.c_str() + this->pos;
+            char* end = nullptr;
+            const double v = std::strtod(begin, &end);
+            if (end == begin) this->fail("number expected");
+            this->pos += end - begin;
+            this->emitConst(static_cast<float>(v));
+        } else if (c == '$') {
+            ++this->pos;
+            const size_t begin = this->pos;
+            while ((this->pos < this->text.size()) && std::isdigit(static_cast<unsigned char>(this->text[this->pos]))) {
+                ++this->pos;
+            }
+            if (begin == this->pos) this->fail("column index expected");
+            const size_t idx = std::strtoul(this->text.c_str() + begin, nullptr, 10);
+            if (idx >= this->columnCount) this->fail("column index " + std::to_string(idx) + " out of range");
+            this->emitLoad(idx);
+        } else if (c == '[') {
+            const size_t end = this->text.find(']', this->pos);
+            if (end == std::string::npos) this->fail("']' expected");
+            const std::string name = this->text.substr(this->pos + 1, end - this->pos - 1);
+            this->pos = end + 1;
+            this->emitColumn(name);
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || (c == '_')) {
+            const size_t begin = this->pos;
+            while ((this->pos < this->text.size()) && isNameChar(this->text[this->pos])) ++this->pos;
+            const std::string name = this->text.substr(begin, this->pos - begin);
+            if (this->accept("(")) {
+                this->parseCall(name);
+            } else if ((name == "pi") && (this->findColumn(name) == this->columnCount)) {
+                this->emitConst(3.14159265358979f);
+            } else {
+                this->emitColumn(name);
+            }
+        } else {
+            this->fail("unexpected '" + std::string(1, c) + "'");
+        }
+    }
+
+    void parseCall(const std::string& name) {
+        static const std::map<std::string, std::pair<Op, unsigned int>> functions = {{"abs", {Op::Abs, 1}},
+            {"sqrt", {Op::Sqrt, 1}}, {"exp", {Op::Exp, 1}}, {"log", {Op::Log, 1}}, {"sin", {Op::Sin, 1}},
+            {"cos", {Op::Cos, 1}}, {"tan", {Op::Tan, 1}}, {"asin", {Op::Asin, 1}}, {"acos", {Op::Acos, 1}},
+            {"atan", {Op::Atan, 1}}, {"floor", {Op::Floor, 1}}, {"ceil", {Op::Ceil, 1}}, {"min", {Op::Min, 2}},
+            {"max", {Op::Max, 2}}, {"pow", {Op::Pow, 2}}, {"atan2", {Op::Atan2, 2}}, {"select", {Op::Select, 3}}};
+        auto f = functions.find(name);
+        if (f == functions.end()) this->fail("unknown function '" + name + "'");
+        const unsigned int first = this->top;
+        for (unsigned int i = 0; i < f->second.second; ++i) {
+            if (i > 0) this->expect(",");
+            this->parseOr();
+        }
+        this->expect(")");
+        this->emit(f->second.first, first, first, first + 1, first + 2);
+        this->top = first + 1;
+    }
+
+    size_t findColumn(const std::string& name) const {
+        for (size_t i = 0; i < this->columnCount; ++i) {
+            if (this->infos[i].Name() == name) return i;
+        }
+        return this->columnCount;
+    }
+
+    void emitColumn(const std::string& name) {
+        const size_t idx = this->findColumn(name);
+        if (idx == this->columnCount) this->fail("unknown column '" + name + "'");
+        this->emitLoad(idx);
+    }
+
+    void emitLoad(size_t column) {
+        this->emit(Op::Load, this->push());
+        this->code.back().column = column;
+    }
+
+    void emitConst(float value) {
+        this->emit(Op::Const, this->push());
+        this->code.back().value = value;
+    }
+
+    const std::string& text;
+    const TableDataCall::ColumnInfo* infos;
+    size_t columnCount;
+    std::vector<Instruction>& code;
+    size_t pos;
+    unsigned int top;
+    unsigned int maxTop;
+};
+
+
+/*
+ * ColumnExpression::ColumnExpression
+ */
+ColumnExpression::ColumnExpression(void) : code(), registerCount(0) {}
+
+
+/*
+ * ColumnExpression::Compile
+ */
+bool ColumnExpression::Compile(const std::string& expression, const TableDataCall::ColumnInfo* infos,
+    size_t columnCount, std::string& outError) {
+    this->code.clear();
+    this->registerCount = 0;
+    try {
+        Parser parser(expression, infos, columnCount, this->code);
+        this->registerCount = parser.Parse();
+    } catch (const std::runtime_error& e) {
+        this->code.clear();
+        outError = e.what();
+        return false;
+    }
+    return true;
+}
+
+
+/*
+ * ColumnExpression::Evaluate
+ */
+void ColumnExpression::Evaluate(const float* in, size_t columnCount, size_t rowCount, float* out, size_t outStride,
+    float& outMin, float& outMax) const {
+    outMin = std::numeric_limits<float>::max();
+    outMax = std::numeric_limits<float>::lowest();
+    if (this->code.empty() || (rowCount == 0)) {
+        outMin = outMax = 0.0f;
+        return;
+    }
+
+    const int blockCnt = static_cast<int>((rowCount + blockSize - 1) / blockSize);
+#pragma omp parallel
+    {
+        std::vector<float> regs(this->registerCount * blockSize);
+        float lo = std::numeric_limits<float>::max();
+        float hi = std::numeric_limits<float>::lowest();
+#pragma omp for schedule(static)
+        for (int b = 0; b < blockCnt; ++b) {
+            const size_t begin = static_cast<size_t>(b) * blockSize;
+            const size_t cnt = std::min(blockSize, rowCount - begin);
+            const float* res = this->evaluateBlock(in, columnCount, begin, cnt, regs.data());
+            float* dst = out + begin * outStride;
+            for (size_t i = 0; i < cnt; ++i) {
+                dst[i * outStride] = res[i];
+                lo = std::min(lo, res[i]);
+                hi = std::max(hi, res[i]);
+            }
+        }
+#pragma omp critical
+        {
+            outMin = std::min(outMin, lo);
+            outMax = std::max(outMax, hi);
+        }
+    }
+}
+
+
+/*
+ * ColumnExpression::evaluateBlock
+ */
+const float* ColumnExpression::evaluateBlock(
+    const float* in, size_t columnCount, size_t begin, size_t n, float* regs) const {
+    for (const Instruction& ins : this->code) {
+        float* d = regs + ins.dst * blockSize;
+        const float* a = regs + ins.a * blockSize;
+        const float* b = regs + ins.b * blockSize;
+        const float* c = regs + ins.c * blockSize;
+        switch (ins.op) {
+        case Op::Load: {
+            const float* src = in + begin * columnCount + ins.column;
+            for (size_t i = 0; i < n; ++i) d[i] = src[i * columnCount];
+        } break;
+        case Op::Const:
+            std::fill(d, d + n, ins.value);
+            break;
+        case Op::Neg:
+            unary(d, a, n, [](float x) { return -x; });
+            break;
+        case Op::Not:
+            unary(d, a, n, [](float x) { return (x == 0.0f) ? 1.0f : 0.0f; });
+            break;
+        case Op::Add:
+            binary(d, a, b, n, [](float x, float y) { return x + y; });
+            break;
+        case Op::Sub:
+            binary(d, a, b, n, [](float x, float y) { return x - y; });
+            break;
+        case Op::Mul:
+            binary(d, a, b, n, [](float x, float y) { return x * y; });
+            break;
+        case Op::Div:
+            binary(d, a, b, n, [](float x, float y) { return x / y; });
+            break;
+        case Op::Mod:
+            // Lua semantics, the result has the sign of the divisor
+            binary(d, a, b, n, [](float x, float y) { return x - std::floor(x / y) * y; });
+            break;
+        case Op::Pow:
+            binary(d, a, b, n, [](float x, float y) { return std::pow(x, y); });
+            break;
+        case Op::Eq:
+            binary(d, a, b, n, [](float x, float y) { return (x == y) ? 1.0f : 0.0f; });
+            break;
+        case Op::Ne:
+            binary(d, a, b, n, [](float x, float y) { return (x != y) ? 1.0f : 0.0f; });
+            break;
+        case Op::Lt:
+            binary(d, a, b, n, [](float x, float y) { return (x < y) ? 1.0f : 0.0f; });
+            break;
+        case Op::Le:
+            binary(d, a, b, n, [](float x, float y) { return (x <= y) ? 1.0f : 0.0f; });
+            break;
+        case Op::Gt:
+            binary(d, a, b, n, [](float x, float y) { return (x > y) ? 1.0f : 0.0f; });
+            break;
+        case Op::Ge:
+            binary(d, a, b, n, [](float x, float y) { return (x >= y) ? 1.0f : 0.0f; });
+            break;
+        case Op::And:
+            binary(d, a, b, n, [](float x, float y) { return ((x != 0.0f) && (y != 0.0f)) ? 1.0f : 0.0f; });
+            break;
+        case Op::Or:
+            binary(d, a, b, n, [](float x, float y) { return ((x != 0.0f) || (y != 0.0f)) ? 1.0f : 0.0f; });
+            break;
+        case Op::Abs:
+            unary(d, a, n, [](float x) { return std::abs(x); });
+            break;
+        case Op::Sqrt:
+            unary(d, a, n, [](float x) { return std::sqrt(x); });
+            break;
+        case Op::Exp:
+            unary(d, a, n, [](float x) { return std::exp(x); });
+            break;
+        case Op::Log:
+            unary(d, a, n, [](float x) { return std::log(x); });
+            break;
+        case Op::Sin:
+            unary(d, a, n, [](float x) { return std::sin(x); });
+            break;
+        case Op::Cos:
+            unary(d, a, n, [](float x) { return std::cos(x); });
+            break;
+        case Op::Tan:
+            unary(d, a, n, [](float x) { return std::tan(x); });
+            break;
+        case Op::Asin:
+            unary(d, a, n, [](float x) { return std::asin(x); });
+            break;
+        case Op::Acos:
+            unary(d, a, n, [](float x) { return std::acos(x); });
+            break;
+        case Op::Atan:
+            unary(d, a, n, [](float x) { return std::atan(x); });
+            break;
+        case Op::Floor:
+            unary(d, a, n, [](float x) { return std::floor(x); });
+            break;
+        case Op::Ceil:
+            unary(d, a, n, [](float x) { return std::ceil(x); });
+            break;
+        case Op::Min:
+            binary(d, a, b, n, [](float x, float y) { return std::min(x, y); });
+            break;
+        case Op::Max:
+            binary(d, a, b, n, [](float x, float y) { return std::max(x, y); });
+            break;
+        case Op::Atan2:
+            binary(d, a, b, n, [](float x, float y) { return std::atan2(x, y); });
+            break;
+        case Op::Select:
+            for (size_t i = 0; i < n; ++i) d[i] = (a[i] != 0.0f) ? b[i] : c[i];
+            break;
+        }
+    }
+    return regs;
+}
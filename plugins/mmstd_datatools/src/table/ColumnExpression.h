@@ -0,0 +1,141 @@
+/*
+ * ColumnExpression.h
+ *
+ * Copyright (C) 2019 by VISUS (University of Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_DATATOOLS_FLOATTABLE_COLUMNEXPRESSION_H_INCLUDED
+#define MEGAMOL_DATATOOLS_FLOATTABLE_COLUMNEXPRESSION_H_INCLUDED
+
+#include "mmstd_datatools/table/TableDataCall.h"
+
+#include <string>
+#include <vector>
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+namespace table {
+
+/**
+ * An arithmetic expression over the columns of a table, compiled once and
+ * evaluated for all rows in blocks, such that every operation is a tight
+ * loop over the values of a block. Blocks are evaluated in parallel.
+ *
+ * The syntax follows Lua expressions: numbers, pi, columns by name, by
+ * [name with spaces] or by $index, the operators + - * / % ^, comparisons
+ * == ~= < <= > >= and not, and, or, which answer 1 or 0, parentheses and
+ * the functions abs, sqrt, exp, log, sin, cos, tan, asin, acos, atan,
+ * floor, ceil, min, max, pow, atan2 and select(condition, a, b).
+ */
+class ColumnExpression {
+public:
+    /** Ctor */
+    ColumnExpression(void);
+
+    /**
+     * Compiles an expression.
+     *
+     * @param expression The expression
+     * @param infos The infos of the columns of the input table
+     * @param columnCount The number of columns of the input table
+     * @param outError Receives the error message if compiling fails
+     *
+     * @return True on success, false otherwise
+     */
+    bool Compile(const std::string& expression, const TableDataCall::ColumnInfo* infos, size_t columnCount,
+        std::string& outError);
+
+    /**
+     * Evaluates the compiled expression for all rows of the input table.
+     *
+     * @param in The row-major input values
+     * @param columnCount The number of columns of the input table
+     * @param rowCount The number of rows of the input table
+     * @param out Receives the results of the rows at out[row * outStride]
+     * @param outStride The distance of the results of two rows in values
+     * @param outMin Receives the smallest result
+     * @param outMax Receives the largest result
+     */
+    void Evaluate(const float* in, size_t columnCount, size_t rowCount, float* out, size_t outStride, float& outMin,
+        float& outMax) const;
+
+private:
+    /** The operations */
+    enum class Op {
+        Load,
+        Const,
+        Neg,
+        Not,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Mod,
+        Pow,
+        Eq,
+        Ne,
+        Lt,
+        Le,
+        Gt,
+        Ge,
+        And,
+        Or,
+        Abs,
+        Sqrt,
+        Exp,
+        Log,
+        Sin,
+        Cos,
+        Tan,
+        Asin,
+        Acos,
+        Atan,
+        Floor,
+        Ceil,
+        Min,
+        Max,
+        Atan2,
+        Select
+    };
+
+    /** An operation on whole blocks of registers */
+    struct Instruction {
+        Op op;
+        unsigned int dst;
+        unsigned int a;
+        unsigned int b;
+        unsigned int c;
+        size_t column;
+        float value;
+    };
+
+    /** The recursive descent parser emitting the instructions */
+    class Parser;
+
+    /** The number of rows evaluated at once */
+    static const size_t blockSize = 1024;
+
+    /**
+     * Evaluates the rows [begin, begin + cnt).
+     *
+     * @param regs The registers of the evaluating thread
+     *
+     * @return The register holding the results
+     */
+    const float* evaluateBlock(const float* in, size_t columnCount, size_t begin, size_t cnt, float* regs) const;
+
+    /** The compiled operations */
+    std::vector<Instruction> code;
+
+    /** The number of registers used by the operations */
+    unsigned int registerCount;
+};
+
+} /* end namespace table */
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_DATATOOLS_FLOATTABLE_COLUMNEXPRESSION_H_INCLUDED */
@@ -13,6 +13,15 @@
 
 #include "vislib/sys/FastFile.h"
 #include "vislib/String.h"
+#ifdef _WIN32
+#include <windows.h>
+#else /* _WIN32 */
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
 
 using namespace megamol::stdplugin::datatools;
 using namespace megamol::stdplugin::datatools::table;
@@ -21,7 +30,12 @@ using namespace megamol;
 MMFTDataSource::MMFTDataSource(void) : core::Module(),
         filenameSlot("filename", "The file name"),
         getDataSlot("getData", "Slot providing the data"),
-        dataHash(0), columns(), values() {
+        dataHash(0), columns(), values(), columnData(), rowCount(0), mapping(nullptr), mappingSize(0),
+#ifdef _WIN32
+        mappingFile(INVALID_HANDLE_VALUE), mappingHandle(NULL) {
+#else /* _WIN32 */
+        mappingFile(-1) {
+#endif /* _WIN32 */
 
     this->filenameSlot << new core::param::FilePathParam("");
     this->MakeSlotAvailable(&this->filenameSlot);
@@ -44,6 +58,8 @@ bool MMFTDataSource::create(void) {
 void MMFTDataSource::release(void) {
     this->columns.clear();
     this->values.clear();
+    this->columnData.clear();
+    this->unmapFile();
 }
 
 void MMFTDataSource::assertData(void) {
@@ -55,7 +71,10 @@ void MMFTDataSource::assertData(void) {
 
     this->columns.clear();
     this->values.clear();
-
+    this->columnData.clear();
+    this->rowCount = 0;
+    this->unmapFile();
+    this->dataHash++;
 
     vislib::sys::FastFile file;
     if (!file.Open(filenameSlot.Param<core::param::FilePathParam>()->Value(), vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ, vislib::sys::File::OPEN_ONLY)) {
@@ -68,6 +87,8 @@ void MMFTDataSource::assertData(void) {
         file.Close(); \
         this->columns.clear(); \
         this->values.clear(); \
+        this->columnData.clear(); \
+        this->unmapFile(); \
         return; \
     }
 #define ASSERT_READ(A, S) if (file.Read((A), (S)) != (S)) ABORT_ERROR("Read error %d", __LINE__)
@@ -77,7 +98,7 @@ void MMFTDataSource::assertData(void) {
     if (!magicID.Equals("MMFTD")) ABORT_ERROR("Wrong file format magic ID");
     uint16_t version;
     ASSERT_READ(&version, 2);
-    if (version != 0) ABORT_ERROR("Wrong file format version number");
+    if (version > 1) ABORT_ERROR("Wrong file format version number");
 
     uint32_t colCnt;
     ASSERT_READ(&colCnt, 4);
@@ -105,11 +126,106 @@ void MMFTDataSource::assertData(void) {
     uint64_t rowCnt;
     ASSERT_READ(&rowCnt, 8);
 
-    values.resize(static_cast<std::vector<float>::size_type>(rowCnt * colCnt));
+    if (version == 0) {
+        values.resize(static_cast<std::vector<float>::size_type>(rowCnt * colCnt));
 
-    ASSERT_READ(values.data(), rowCnt * colCnt * 4);
+        ASSERT_READ(values.data(), rowCnt * colCnt * 4);
 
-    this->dataHash++;
+    } else {
+        std::vector<uint64_t> offsets(colCnt);
+        ASSERT_READ(offsets.data(), colCnt * 8);
+        file.Close();
+
+        if (!this->mapFile(filenameSlot.Param<core::param::FilePathParam>()->Value())) {
+            ABORT_ERROR("Unable to map file into memory");
+        }
+        this->columnData.resize(colCnt);
+        for (uint32_t c = 0; c < colCnt; ++c) {
+            if ((offsets[c] % sizeof(float) != 0) || (offsets[c] > this->mappingSize)
+                    || (rowCnt * 4 > this->mappingSize - offsets[c])) {
+                ABORT_ERROR("Column %u exceeds the file", c);
+            }
+            this->columnData[c].storage = TableDataCall::ColumnStorage::FLOAT;
+            this->columnData[c].data = this->mapping + offsets[c];
+            this->columnData[c].stride = 1;
+        }
+        this->rowCount = rowCnt;
+    }
+}
+
+
+bool MMFTDataSource::mapFile(const vislib::TString& path) {
+    this->unmapFile();
+
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(vislib::StringW(path).PeekBuffer(), GENERIC_READ,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || (size.QuadPart == 0)) {
+        ::CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        ::CloseHandle(file);
+        return false;
+    }
+    const void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return false;
+    }
+    this->mappingFile = file;
+    this->mappingHandle = mapping;
+    this->mappingSize = static_cast<uint64_t>(size.QuadPart);
+
+#else /* _WIN32 */
+    int file = ::open(vislib::StringA(path).PeekBuffer(), O_RDONLY);
+    if (file == -1) {
+        return false;
+    }
+    struct stat fileStat;
+    if ((::fstat(file, &fileStat) == -1) || (fileStat.st_size == 0)
+            || (static_cast<uint64_t>(fileStat.st_size) > static_cast<uint64_t>(SIZE_MAX))) {
+        ::close(file);
+        return false;
+    }
+    void *data = ::mmap(NULL, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED) {
+        ::close(file);
+        return false;
+    }
+    // columns are read in full once requested
+    ::madvise(data, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+    this->mappingFile = file;
+    this->mappingSize = static_cast<uint64_t>(fileStat.st_size);
+
+#endif /* _WIN32 */
+    this->mapping = static_cast<const unsigned char*>(data);
+    return true;
+}
+
+
+void MMFTDataSource::unmapFile(void) {
+    if (this->mapping == nullptr) return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(this->mapping);
+    ::CloseHandle(this->mappingHandle);
+    ::CloseHandle(this->mappingFile);
+    this->mappingHandle = NULL;
+    this->mappingFile = INVALID_HANDLE_VALUE;
+#else /* _WIN32 */
+    ::munmap(const_cast<unsigned char*>(this->mapping), static_cast<size_t>(this->mappingSize));
+    ::close(this->mappingFile);
+    this->mappingFile = -1;
+#endif /* _WIN32 */
+    this->mapping = nullptr;
+    this->mappingSize = 0;
 }
 
 bool MMFTDataSource::getDataCallback(core::Call& caller) {
@@ -120,7 +236,9 @@ bool MMFTDataSource::getDataCallback(core::Call& caller) {
 
     tfd->SetDataHash(this->dataHash);
     tfd->SetFrameCount(1);
-    if (values.size() == 0) {
+    if (!columnData.empty()) {
+        tfd->SetColumns(columns.size(), static_cast<size_t>(rowCount), columns.data(), columnData.data());
+    } else if (values.size() == 0) {
         tfd->Set(0, 0, nullptr, nullptr);
     } else {
         assert((values.size() % columns.size()) == 0);
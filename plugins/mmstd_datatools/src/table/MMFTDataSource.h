@@ -26,6 +26,23 @@ namespace table {
 
         static const char *ClassName(void) { return "MMFTDataSource"; }
         static const char *Description(void) { return "Binary float table data source"; }
+
+        /*
+         * File format (all values little endian):
+         *   char[6]   "MMFTD\0"
+         *   uint16    version (0: row-major, 1: column-major)
+         *   uint32    column count
+         *   per column: uint16 name length, char[] name, uint8 type (1: categorical), float min, float max
+         *   uint64    row count
+         * version 0:
+         *   float[]   cells, row-major
+         * version 1:
+         *   uint64[]  file offset of each column, 64 byte aligned
+         *   float[]   cells of each column at its offset
+         *
+         * Version 1 files are mapped into memory and passed on as individual
+         * columns, such that only the columns actually read are paged in.
+         */
         static bool IsAvailable(void) { return true; }
 
         MMFTDataSource(void);
@@ -39,6 +56,13 @@ namespace table {
     private:
 
         inline void assertData(void);
+
+        /** Maps the file read-only into memory, answering success */
+        bool mapFile(const vislib::TString& path);
+
+        /** Releases the memory mapping, if any */
+        void unmapFile(void);
+
         bool getDataCallback(core::Call& caller);
         bool getHashCallback(core::Call& caller);
 
@@ -51,6 +75,27 @@ namespace table {
         std::vector<TableDataCall::ColumnInfo> columns;
         std::vector<float> values;
 
+        /** The columns of a column-major (version 1) file, referencing the mapping */
+        std::vector<TableDataCall::ColumnData> columnData;
+
+        /** The row count of a column-major file */
+        uint64_t rowCount;
+
+        /** The memory mapping of a column-major file, or NULL if not mapped */
+        const unsigned char *mapping;
+
+        /** The size of the memory mapping in bytes */
+        uint64_t mappingSize;
+
+#ifdef _WIN32
+        /** The native handles of the mapped file and its mapping */
+        void *mappingFile;
+        void *mappingHandle;
+#else
+        /** The native handle of the mapped file */
+        int mappingFile;
+#endif
+
     };
 
 } /* end namespace table */
@@ -8,25 +8,36 @@
 #include "stdafx.h"
 #include "MMFTDataWriter.h"
 
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
 
 #include "vislib/sys/Log.h"
 #include "vislib/sys/FastFile.h"
 #include "vislib/String.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace megamol::stdplugin::datatools;
 using namespace megamol::stdplugin::datatools::table;
 using namespace megamol;
 
 MMFTDataWriter::MMFTDataWriter(void) : core::AbstractDataWriter(),
         filenameSlot("filename", "The path to the MMFT file to be written"),
-        dataSlot("data", "The slot requesting the data to be written") {
+        dataSlot("data", "The slot requesting the data to be written"),
+        formatSlot("format", "The file format version; column-major files are memory mapped when loaded") {
 
     this->filenameSlot << new core::param::FilePathParam("");
     this->MakeSlotAvailable(&this->filenameSlot);
 
     this->dataSlot.SetCompatibleCall<TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataSlot);
+
+    auto* format = new core::param::EnumParam(1);
+    format->SetTypePair(0, "row-major (version 0)");
+    format->SetTypePair(1, "column-major (version 1)");
+    this->formatSlot << format;
+    this->MakeSlotAvailable(&this->formatSlot);
 }
 
 
@@ -83,11 +94,12 @@ bool MMFTDataWriter::run(void) {
 
     vislib::StringA magicID("MMFTD");
     ASSERT_WRITEOUT(magicID.PeekBuffer(), 6);
-    uint16_t version = 0;
+    uint16_t version = static_cast<uint16_t>(this->formatSlot.Param<core::param::EnumParam>()->Value());
     ASSERT_WRITEOUT(&version, 2);
 
     uint32_t colCnt = static_cast<uint32_t>(cftd->GetColumnsCount());
     ASSERT_WRITEOUT(&colCnt, 4);
+    uint64_t pos = 6 + 2 + 4;
 
     for (uint32_t c = 0; c < colCnt; ++c) {
         const TableDataCall::ColumnInfo& ci = cftd->GetColumnsInfos()[c];
@@ -100,12 +112,50 @@ bool MMFTDataWriter::run(void) {
         ASSERT_WRITEOUT(&f, 4);
         f = ci.MaximumValue();
         ASSERT_WRITEOUT(&f, 4);
+        pos += 2 + nameLen + 1 + 4 + 4;
     }
 
     uint64_t rowCnt = static_cast<uint64_t>(cftd->GetRowsCount());
     ASSERT_WRITEOUT(&rowCnt, 8);
-
-    ASSERT_WRITEOUT(cftd->GetData(), rowCnt * colCnt * 4);
+    pos += 8;
+
+    if (version == 0) {
+        ASSERT_WRITEOUT(cftd->GetData(), rowCnt * colCnt * 4);
+
+    } else {
+        // Column directory, columns aligned to cache lines
+        const uint64_t alignment = 64;
+        auto align = [alignment](uint64_t p) { return (p + alignment - 1) / alignment * alignment; };
+        std::vector<uint64_t> offsets(colCnt);
+        pos += colCnt * 8;
+        const uint64_t dataBegin = pos;
+        for (uint32_t c = 0; c < colCnt; ++c) {
+            offsets[c] = align(pos);
+            pos = offsets[c] + rowCnt * 4;
+        }
+        ASSERT_WRITEOUT(offsets.data(), colCnt * 8);
+        pos = dataBegin;
+
+        const char padding[64] = {0};
+        std::vector<float> buffer;
+        const uint64_t chunkRows = 1 << 20;
+        for (uint32_t c = 0; c < colCnt; ++c) {
+            ASSERT_WRITEOUT(padding, offsets[c] - pos);
+            const auto column = cftd->GetColumn(c);
+            for (uint64_t r = 0; r < rowCnt; r += chunkRows) {
+                const uint64_t cnt = std::min(chunkRows, rowCnt - r);
+                if ((column.storage == TableDataCall::ColumnStorage::FLOAT) && (column.stride == 1) &&
+                    (column.rows == nullptr)) {
+                    ASSERT_WRITEOUT(static_cast<const float*>(column.data) + r, cnt * 4);
+                } else {
+                    buffer.resize(static_cast<size_t>(cnt));
+                    for (uint64_t i = 0; i < cnt; ++i) buffer[i] = column.Get(static_cast<size_t>(r + i));
+                    ASSERT_WRITEOUT(buffer.data(), cnt * 4);
+                }
+            }
+            pos = offsets[c] + rowCnt * 4;
+        }
+    }
 
     return true;
 }
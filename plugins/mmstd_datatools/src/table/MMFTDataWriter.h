@@ -106,6 +106,9 @@ namespace table {
         /** The slot asking for data */
         core::CallerSlot dataSlot;
 
+        /** The file format version to be written (see MMFTDataSource) */
+        core::param::ParamSlot formatSlot;
+
     };
 
 } /* end namespace table */
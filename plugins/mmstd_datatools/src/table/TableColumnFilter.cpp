@@ -72,8 +72,6 @@ bool TableColumnFilter::processData(core::Call &c) {
 
             auto column_count = inCall->GetColumnsCount();
             auto column_infos = inCall->GetColumnsInfos();
-            auto rows_count = inCall->GetRowsCount();
-            auto in_data = inCall->GetData();
 
             auto selectionString = this->selectionStringSlot.Param<core::param::StringParam>()->Value();
             selectionString.Remove(vislib::TString(" "));
@@ -89,13 +87,13 @@ bool TableColumnFilter::processData(core::Call &c) {
             this->columnInfos.clear();
             this->columnInfos.reserve(selectors.Count());
 
-            std::vector<size_t> indexMask;
-            indexMask.reserve(selectors.Count());
+            this->indexMask.clear();
+            this->indexMask.reserve(selectors.Count());
             for (size_t sel = 0; sel < selectors.Count(); sel++) {
                 for (size_t col = 0; col < column_count; col++) {
                     if (selectors[sel].CompareInsensitive(vislib::TString(
                         column_infos[col].Name().c_str()))) {
-                        indexMask.push_back(col);
+                        this->indexMask.push_back(col);
                         this->columnInfos.push_back(column_infos[col]);
                         break;
                     }
@@ -105,21 +103,19 @@ bool TableColumnFilter::processData(core::Call &c) {
                 //    ModuleName.c_str(), selectors[sel].PeekBuffer());
             }
 
-            if (indexMask.size() == 0) {
+            if (this->indexMask.size() == 0) {
                 vislib::sys::Log::DefaultLog.WriteError(_T("%hs: No matches for selectors have been found\n"),
                     ModuleName.c_str());
                 this->columnInfos.clear();
-                this->data.clear();
                 return false;
             }
+        }
 
-            this->data.clear();
-            this->data.reserve(rows_count*this->columnInfos.size());
-
-            for (size_t row = 0; row < rows_count; row++) {
-                for (auto &cidx : indexMask) {
-                    this->data.push_back(in_data[cidx + row*column_count]);
-                }
+        // The selected columns reference the input, which is valid for as long as the input call is
+        this->columns.clear();
+        if (inCall->GetColumnsCount() > 0) {
+            for (auto &cidx : this->indexMask) {
+                this->columns.push_back(inCall->GetColumn(cidx));
             }
         }
 
@@ -127,9 +123,9 @@ bool TableColumnFilter::processData(core::Call &c) {
         outCall->SetFrameID(this->frameID);
         outCall->SetDataHash(this->datahash);
 
-        if (this->columnInfos.size() != 0) {
-            outCall->Set(this->columnInfos.size(), this->data.size() / this->columnInfos.size(),
-                this->columnInfos.data(), this->data.data());
+        if ((this->columnInfos.size() != 0) && (this->columns.size() == this->columnInfos.size())) {
+            outCall->SetColumns(this->columnInfos.size(), inCall->GetRowsCount(),
+                this->columnInfos.data(), this->columns.data());
         } else {
             outCall->Set(0, 0, NULL, NULL);
         }
@@ -79,8 +79,11 @@ private:
     /** Vector storing information about columns */
     std::vector<TableDataCall::ColumnInfo> columnInfos;
 
-    /** Vector stroing the actual float data */
-    std::vector<float> data;
+    /** Indices of the selected input columns */
+    std::vector<size_t> indexMask;
+
+    /** References to the selected input columns */
+    std::vector<TableDataCall::ColumnData> columns;
 }; /* end class TableColumnFilter */
 
 } /* end namespace table */
@@ -40,7 +40,7 @@ bool TableDataCall::ColumnInfo::operator==(const ColumnInfo& rhs) const{
 }
 
 
-TableDataCall::TableDataCall(void) : core::AbstractGetDataCall(), columns_count(0), rows_count(0), columns(nullptr), data(nullptr), frameCount(0), frameID(0) {
+TableDataCall::TableDataCall(void) : core::AbstractGetDataCall(), columns_count(0), rows_count(0), columns(nullptr), data(nullptr), column_data(nullptr), row_major(), frameCount(0), frameID(0) {
     // intentionally empty
 }
 
@@ -49,4 +49,23 @@ TableDataCall::~TableDataCall(void) {
     rows_count = 0; // paranoia
     columns = nullptr; // do not delete, since we do not own the memory of the objects
     data = nullptr; // do not delete, since we do not own the memory of the objects
+    column_data = nullptr; // do not delete, since we do not own the memory of the objects
+}
+
+const float* TableDataCall::materialize(void) const {
+    const size_t cells = columns_count * rows_count;
+    if (row_major.size() != cells) {
+        row_major.resize(cells);
+        for (size_t c = 0; c < columns_count; ++c) {
+            const ColumnData& col = column_data[c];
+            float* dst = row_major.data() + c;
+            if ((col.storage == ColumnStorage::FLOAT) && (col.rows == nullptr)) {
+                const float* src = static_cast<const float*>(col.data);
+                for (size_t r = 0; r < rows_count; ++r) dst[r * columns_count] = src[r * col.stride];
+            } else {
+                for (size_t r = 0; r < rows_count; ++r) dst[r * columns_count] = col.Get(r);
+            }
+        }
+    }
+    return row_major.data();
 }
@@ -8,7 +8,17 @@
 #include "stdafx.h"
 #include "TableJoin.h"
 
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/StringParam.h"
+
+#include "vislib/String.h"
+#include "vislib/sys/Log.h"
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
 
 using namespace megamol::stdplugin::datatools;
 using namespace megamol::stdplugin::datatools::table;
@@ -22,12 +32,60 @@ size_t hash_combine(size_t lhs, size_t rhs) {
     return lhs;
 }
 
+namespace {
+
+/** The join modes */
+enum JoinMode { JOIN_CONCATENATE = 0, JOIN_INNER = 1, JOIN_LEFT = 2 };
+
+/** The number of bits of the key hashes selecting the partition of the build table */
+const unsigned int partitionBits = 8;
+
+/** The number of rows processed at once by one thread */
+const size_t chunkRows = 1 << 16;
+
+/** Marks the end of a bucket chain */
+const uint64_t endOfChain = std::numeric_limits<uint64_t>::max();
+
+/** Answer the hash of the key of a row */
+uint64_t hashKey(const std::vector<TableDataCall::ColumnData>& keys, size_t row) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const auto& k : keys) {
+        float v = k.Get(row);
+        if (v == 0.0f) v = 0.0f; // -0 equals 0
+        uint32_t bits;
+        ::memcpy(&bits, &v, sizeof(bits));
+        h = (h ^ bits) * 0x100000001b3ull;
+    }
+    // finalise, as the partition is selected by the upper bits
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+bool keysEqual(const std::vector<TableDataCall::ColumnData>& a, size_t rowA,
+        const std::vector<TableDataCall::ColumnData>& b, size_t rowB) {
+    for (size_t k = 0; k < a.size(); ++k) {
+        if (a[k].Get(rowA) != b[k].Get(rowB)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
 TableJoin::TableJoin(void) : core::Module(),
     firstTableInSlot("firstTableIn", "First input"),
     secondTableInSlot("secondTableIn", "Second input"),
     dataOutSlot("dataOut", "Output"),
+    modeSlot("mode", "Concatenate the rows of both tables, or join the rows with equal keys"),
+    firstKeysSlot("firstKeys", "The key columns of the first table, separated by \";\""),
+    secondKeysSlot("secondKeys",
+        "The key columns of the second table, separated by \";\", empty for the names of the first table"),
     frameID(-1),
-    firstDataHash(std::numeric_limits<unsigned long>::max()), secondDataHash(std::numeric_limits<unsigned long>::max()) {
+    firstDataHash(std::numeric_limits<unsigned long>::max()), secondDataHash(std::numeric_limits<unsigned long>::max()),
+    paramHash(0), rows_count(0) {
     this->firstTableInSlot.SetCompatibleCall<TableDataCallDescription>();
     this->MakeSlotAvailable(&this->firstTableInSlot);
 
@@ -41,6 +99,19 @@ TableJoin::TableJoin(void) : core::Module(),
         TableDataCall::FunctionName(1),
         &TableJoin::getExtent);
     this->MakeSlotAvailable(&this->dataOutSlot);
+
+    auto modePar = new core::param::EnumParam(JOIN_CONCATENATE);
+    modePar->SetTypePair(JOIN_CONCATENATE, "Concatenate");
+    modePar->SetTypePair(JOIN_INNER, "Inner");
+    modePar->SetTypePair(JOIN_LEFT, "Left");
+    this->modeSlot << modePar;
+    this->MakeSlotAvailable(&this->modeSlot);
+
+    this->firstKeysSlot << new core::param::StringParam("id");
+    this->MakeSlotAvailable(&this->firstKeysSlot);
+
+    this->secondKeysSlot << new core::param::StringParam("");
+    this->MakeSlotAvailable(&this->secondKeysSlot);
 }
 
 TableJoin::~TableJoin(void) {
@@ -81,6 +152,14 @@ bool TableJoin::processData(core::Call &c) {
         if (!(*firstInCall)()) return false;
         if (!(*secondInCall)()) return false;
 
+        if (this->modeSlot.IsDirty() || this->firstKeysSlot.IsDirty() || this->secondKeysSlot.IsDirty()) {
+            this->modeSlot.ResetDirty();
+            this->firstKeysSlot.ResetDirty();
+            this->secondKeysSlot.ResetDirty();
+            ++this->paramHash;
+            this->firstDataHash = std::numeric_limits<unsigned long>::max();
+        }
+
         if (this->firstDataHash != firstInCall->DataHash() || this->secondDataHash != secondInCall->DataHash()
             || this->frameID != firstInCall->GetFrameID() || this->frameID != secondInCall->GetFrameID()) {
             this->firstDataHash = firstInCall->DataHash();
@@ -88,38 +167,67 @@ bool TableJoin::processData(core::Call &c) {
             ASSERT(firstInCall->GetFrameID() == secondInCall->GetFrameID());
             this->frameID = firstInCall->GetFrameID();
 
-            // retrieve data
-            auto firstRowsCount = firstInCall->GetRowsCount();
-            auto firstColumnCount = firstInCall->GetColumnsCount();
-            auto firstColumnInfos = firstInCall->GetColumnsInfos();
-            auto firstData = firstInCall->GetData();
+            this->column_info.clear();
+            this->columns.clear();
+            this->composedRows.clear();
+            this->firstRows.clear();
+            this->secondRows.clear();
+            this->rows_count = 0;
 
-            auto secondRowsCount = secondInCall->GetRowsCount();
-            auto secondColumnCount = secondInCall->GetColumnsCount();
-            auto secondColumnInfos = secondInCall->GetColumnsInfos();
-            auto secondData = secondInCall->GetData();
+            const int mode = this->modeSlot.Param<core::param::EnumParam>()->Value();
+            if (mode == JOIN_CONCATENATE) {
+                // rows missing in the shorter table read as NaN
+                const size_t firstRowsCount = firstInCall->GetRowsCount();
+                const size_t secondRowsCount = secondInCall->GetRowsCount();
+                this->rows_count = std::max(firstRowsCount, secondRowsCount);
+                auto pad = [this](size_t cnt, std::vector<uint64_t>& rows) {
+                    if (cnt == this->rows_count) return false;
+                    rows.resize(this->rows_count, uint64_t(TableDataCall::ColumnData::MissingRow));
+                    for (size_t r = 0; r < cnt; ++r) rows[r] = r;
+                    return true;
+                };
+                const bool padFirst = pad(firstRowsCount, this->firstRows);
+                const bool padSecond = pad(secondRowsCount, this->secondRows);
+                this->appendColumns(*firstInCall, padFirst ? &this->firstRows : nullptr, {});
+                this->appendColumns(*secondInCall, padSecond ? &this->secondRows : nullptr, {});
 
-            // concatenate
-            this->rows_count = std::max(firstRowsCount, secondRowsCount);
-            this->column_count = firstColumnCount + secondColumnCount;
-            this->column_info.clear();
-            this->column_info.reserve(this->column_count);
-            memcpy(this->column_info.data(), firstColumnInfos,
-                sizeof(TableDataCall::ColumnInfo)*firstColumnCount);
-            memcpy(&(this->column_info.data()[firstColumnCount]), secondColumnInfos,
-                sizeof(TableDataCall::ColumnInfo)*secondColumnCount);
-            this->data.clear();
-            this->data.resize(this->rows_count * this->column_count);
-
-            this->concatenate(this->data.data(), this->rows_count, this->column_count,
-				firstData, firstRowsCount, firstColumnCount,
-				secondData, secondRowsCount, secondColumnCount);
+            } else {
+                const std::string firstNames(
+                    vislib::StringA(this->firstKeysSlot.Param<core::param::StringParam>()->Value()).PeekBuffer());
+                std::string secondNames(
+                    vislib::StringA(this->secondKeysSlot.Param<core::param::StringParam>()->Value()).PeekBuffer());
+                if (secondNames.find_first_not_of(" \t;") == std::string::npos) secondNames = firstNames;
+                std::vector<size_t> firstKeys, secondKeys;
+                if (!findColumns(*firstInCall, firstNames, firstKeys)
+                    || !findColumns(*secondInCall, secondNames, secondKeys)) {
+                    vislib::sys::Log::DefaultLog.WriteError(_T("%hs: Key columns \"%hs\" and \"%hs\" not found\n"),
+                        ModuleName.c_str(), firstNames.c_str(), secondNames.c_str());
+                } else if (firstKeys.empty() || (firstKeys.size() != secondKeys.size())) {
+                    vislib::sys::Log::DefaultLog.WriteError(
+                        _T("%hs: Both tables need the same positive number of key columns\n"), ModuleName.c_str());
+                } else {
+                    this->hashJoin(*firstInCall, firstKeys, *secondInCall, secondKeys, mode == JOIN_LEFT);
+                    this->rows_count = this->firstRows.size();
+                    // the key columns of the second table duplicate those of the first one
+                    this->appendColumns(*firstInCall, &this->firstRows, {});
+                    this->appendColumns(*secondInCall, &this->secondRows, secondKeys);
+                    vislib::sys::Log::DefaultLog.WriteInfo(_T("%hs: Joined %u and %u rows into %u rows\n"),
+                        ModuleName.c_str(), static_cast<unsigned int>(firstInCall->GetRowsCount()),
+                        static_cast<unsigned int>(secondInCall->GetRowsCount()),
+                        static_cast<unsigned int>(this->rows_count));
+                }
+            }
         }
 
         outCall->SetFrameCount(firstInCall->GetFrameCount());
         outCall->SetFrameID(this->frameID);
-        outCall->SetDataHash(hash_combine(this->firstDataHash, this->secondDataHash));
-        outCall->Set(this->column_count, this->rows_count, this->column_info.data(), this->data.data());
+        outCall->SetDataHash(hash_combine(hash_combine(this->firstDataHash, this->secondDataHash), this->paramHash));
+        if (!this->columns.empty()) {
+            outCall->SetColumns(this->column_info.size(), this->rows_count, this->column_info.data(),
+                this->columns.data());
+        } else {
+            outCall->Set(0, 0, NULL, NULL);
+        }
     } catch (...) {
         vislib::sys::Log::DefaultLog.WriteError(_T("Failed to execute %hs::processData\n"),
             ModuleName.c_str());
@@ -129,29 +237,159 @@ bool TableJoin::processData(core::Call &c) {
     return true;
 }
 
-void TableJoin::concatenate(
-	float* const out, const size_t rowCount, const size_t columnCount,
-	const float* const first, const size_t firstRowCount, const size_t firstColumnCount, 
-    const float* const second,  const size_t secondRowCount, const size_t secondColumnCount) {
-    assert(rowCount >= firstRowCount && rowCount >= secondRowCount && "Not enough rows");
-    assert(columnCount >= firstColumnCount + secondColumnCount && "Not enough columns");
-    for (size_t row = 0; row < firstRowCount; row++) {
-        float* outR = &out[row * columnCount];
-        memcpy(outR, &first[row * firstColumnCount], sizeof(float) * firstColumnCount);
+bool TableJoin::findColumns(const TableDataCall& call, const std::string& names, std::vector<size_t>& outColumns) {
+    outColumns.clear();
+    std::istringstream stream(names);
+    std::string name;
+    while (std::getline(stream, name, ';')) {
+        const size_t begin = name.find_first_not_of(" \t");
+        if (begin == std::string::npos) continue;
+        const vislib::StringA n(name.substr(begin, name.find_last_not_of(" \t") - begin + 1).c_str());
+        size_t col = 0;
+        while ((col < call.GetColumnsCount()) && !n.CompareInsensitive(call.GetColumnsInfos()[col].Name().c_str())) {
+            ++col;
+        }
+        if (col == call.GetColumnsCount()) return false;
+        outColumns.push_back(col);
+    }
+    return true;
+}
+
+void TableJoin::hashJoin(const TableDataCall& first, const std::vector<size_t>& firstKeys, const TableDataCall& second,
+        const std::vector<size_t>& secondKeys, bool left) {
+    std::vector<TableDataCall::ColumnData> probeKeys, buildKeys;
+    for (size_t k : firstKeys) probeKeys.push_back(first.GetColumn(k));
+    for (size_t k : secondKeys) buildKeys.push_back(second.GetColumn(k));
+
+    // build: hash the keys of the second table and partition its rows by the upper bits of the hashes
+    const size_t partitionCnt = static_cast<size_t>(1) << partitionBits;
+    const size_t buildCnt = second.GetRowsCount();
+    const int buildChunks = static_cast<int>((buildCnt + chunkRows - 1) / chunkRows);
+    std::vector<uint64_t> hashes(buildCnt);
+    std::vector<uint64_t> histograms(static_cast<size_t>(buildChunks) * partitionCnt, 0);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < buildChunks; ++c) {
+        uint64_t* hist = histograms.data() + c * partitionCnt;
+        const size_t end = std::min(buildCnt, (c + 1) * chunkRows);
+        for (size_t r = c * chunkRows; r < end; ++r) {
+            hashes[r] = hashKey(buildKeys, r);
+            ++hist[hashes[r] >> (64 - partitionBits)];
+        }
+    }
+
+    // turn the histograms into the offsets of the chunks within their partitions
+    std::vector<uint64_t> partitionBegin(partitionCnt + 1, 0);
+    uint64_t offset = 0;
+    for (size_t p = 0; p < partitionCnt; ++p) {
+        partitionBegin[p] = offset;
+        for (int c = 0; c < buildChunks; ++c) {
+            const uint64_t cnt = histograms[c * partitionCnt + p];
+            histograms[c * partitionCnt + p] = offset;
+            offset += cnt;
+        }
+    }
+    partitionBegin[partitionCnt] = offset;
+
+    // scatter in chunk order, such that the rows of a partition stay in ascending order
+    std::vector<uint64_t> order(buildCnt);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < buildChunks; ++c) {
+        uint64_t* pos = histograms.data() + c * partitionCnt;
+        const size_t end = std::min(buildCnt, (c + 1) * chunkRows);
+        for (size_t r = c * chunkRows; r < end; ++r) {
+            order[pos[hashes[r] >> (64 - partitionBits)]++] = r;
+        }
+    }
+
+    // one chained hash table per partition, its buckets selected by the lower bits of the hashes
+    std::vector<uint64_t> bucketBegin(partitionCnt + 1, 0);
+    std::vector<uint64_t> bucketMask(partitionCnt, 0);
+    for (size_t p = 0; p < partitionCnt; ++p) {
+        uint64_t buckets = 1;
+        while (buckets < 2 * (partitionBegin[p + 1] - partitionBegin[p])) buckets <<= 1;
+        bucketMask[p] = buckets - 1;
+        bucketBegin[p + 1] = bucketBegin[p] + buckets;
     }
-    for (size_t row = firstRowCount; row < rowCount; row++) {
-        for (size_t col = 0; col < firstColumnCount; col++) {
-            out[col + row * columnCount] = NAN;
+    std::vector<uint64_t> heads(bucketBegin[partitionCnt], endOfChain);
+    std::vector<uint64_t> next(buildCnt, endOfChain);
+#pragma omp parallel for schedule(dynamic)
+    for (int p = 0; p < static_cast<int>(partitionCnt); ++p) {
+        uint64_t* head = heads.data() + bucketBegin[p];
+        // inserting backwards makes the chains list the rows in ascending order
+        for (uint64_t i = partitionBegin[p + 1]; i > partitionBegin[p]; --i) {
+            const uint64_t b = hashes[order[i - 1]] & bucketMask[p];
+            next[i - 1] = head[b];
+            head[b] = i - 1;
         }
     }
-    for (size_t row = 0; row < secondRowCount; row++) {
-        float* outR = &out[firstColumnCount + row * columnCount];
-        memcpy(outR, &second[row * secondColumnCount], sizeof(float) * secondColumnCount);
+
+    // probe: chunks of the first table in parallel, keeping its row order
+    const size_t probeCnt = first.GetRowsCount();
+    const int probeChunks = static_cast<int>((probeCnt + chunkRows - 1) / chunkRows);
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> matches(probeChunks);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < probeChunks; ++c) {
+        auto& m = matches[c];
+        const size_t end = std::min(probeCnt, (c + 1) * chunkRows);
+        for (size_t r = c * chunkRows; r < end; ++r) {
+            const uint64_t h = hashKey(probeKeys, r);
+            const size_t p = static_cast<size_t>(h >> (64 - partitionBits));
+            bool found = false;
+            for (uint64_t i = heads[bucketBegin[p] + (h & bucketMask[p])]; i != endOfChain; i = next[i]) {
+                const uint64_t s = order[i];
+                if ((hashes[s] == h) && keysEqual(probeKeys, r, buildKeys, static_cast<size_t>(s))) {
+                    m.push_back(std::make_pair(static_cast<uint64_t>(r), s));
+                    found = true;
+                }
+            }
+            if (left && !found) {
+                m.push_back(std::make_pair(static_cast<uint64_t>(r), uint64_t(TableDataCall::ColumnData::MissingRow)));
+            }
+        }
     }
-    for (size_t row = secondRowCount; row < rowCount; row++) {
-        for (size_t col = 0; col < secondColumnCount; col++) {
-            out[col + firstColumnCount + row * columnCount] = NAN;
+
+    std::vector<size_t> matchBegin(probeChunks + 1, 0);
+    for (int c = 0; c < probeChunks; ++c) matchBegin[c + 1] = matchBegin[c] + matches[c].size();
+    this->firstRows.resize(matchBegin[probeChunks]);
+    this->secondRows.resize(matchBegin[probeChunks]);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < probeChunks; ++c) {
+        for (size_t i = 0; i < matches[c].size(); ++i) {
+            this->firstRows[matchBegin[c] + i] = matches[c][i].first;
+            this->secondRows[matchBegin[c] + i] = matches[c][i].second;
+        }
+    }
+}
+
+void TableJoin::appendColumns(const TableDataCall& in, const std::vector<uint64_t>* rows,
+        const std::vector<size_t>& skip) {
+    // input columns gathering through the same row index share one composed index
+    std::map<const uint64_t*, size_t> composed;
+    for (size_t c = 0; c < in.GetColumnsCount(); ++c) {
+        if (std::find(skip.begin(), skip.end(), c) != skip.end()) continue;
+        TableDataCall::ColumnData col = in.GetColumn(c);
+        if (rows != nullptr) {
+            if (col.rows == nullptr) {
+                col.rows = rows->data();
+            } else {
+                auto it = composed.find(col.rows);
+                if (it == composed.end()) {
+                    std::vector<uint64_t> index(rows->size());
+                    const uint64_t* inner = col.rows;
+                    const int cnt = static_cast<int>(index.size());
+#pragma omp parallel for
+                    for (int r = 0; r < cnt; ++r) {
+                        const uint64_t o = (*rows)[r];
+                        index[r] = (o == TableDataCall::ColumnData::MissingRow) ? o : inner[o];
+                    }
+                    it = composed.insert(std::make_pair(col.rows, this->composedRows.size())).first;
+                    this->composedRows.push_back(std::move(index));
+                }
+                col.rows = this->composedRows[it->second].data();
+            }
         }
+        this->column_info.push_back(in.GetColumnsInfos()[c]);
+        this->columns.push_back(col);
     }
 }
 
@@ -167,7 +405,7 @@ bool TableJoin::getExtent(core::Call &c) {
         if (!(*inCall)(1)) return false;
 
         outCall->SetFrameCount(inCall->GetFrameCount());
-        outCall->SetDataHash(hash_combine(this->firstDataHash, this->secondDataHash));
+        outCall->SetDataHash(hash_combine(hash_combine(this->firstDataHash, this->secondDataHash), this->paramHash));
     }
     catch (...) {
         vislib::sys::Log::DefaultLog.WriteError(_T("Failed to execute %hs::getExtent\n"), ModuleName.c_str());
@@ -17,13 +17,20 @@
 
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace megamol {
 namespace stdplugin {
 namespace datatools {
 namespace table {
 
 /**
- * This module joins two tables by copying the values together into one matrix
+ * This module joins two tables, either by concatenating their columns row by
+ * row, or by a relational inner or left join on key columns. The output
+ * columns reference the input tables through row indices instead of copying
+ * their cells, thus they are valid for as long as the input data is.
  */
 class TableJoin : public core::Module {
 public:
@@ -44,7 +51,7 @@ public:
      * @return A human readable description of this module.
      */
     static inline const char *Description(void) {
-        return "Joins two tables (union of columns)";
+        return "Joins two tables (union of columns, or inner or left join on key columns)";
     }
 
     /**
@@ -86,10 +93,34 @@ private:
     /** extent callback */
     bool getExtent(core::Call &c);
 
-    /** concatenates two tables */
-    static void concatenate(float* const out, const size_t rowCount, const size_t columnCount,
-        const float* const first, const size_t firstRowCount, const size_t firstColumnCount, const float* const second,
-        const size_t secondRowCount, const size_t secondColumnCount);
+    /**
+     * Finds the columns selected by names separated by ";".
+     *
+     * @return True if all names have been found
+     */
+    static bool findColumns(const TableDataCall& call, const std::string& names, std::vector<size_t>& outColumns);
+
+    /**
+     * Computes the matching rows of both tables with a hash join, where the
+     * second table is radix partitioned by the hashes of its keys.
+     *
+     * @param first The first table, whose row order the result keeps
+     * @param firstKeys The key columns of the first table
+     * @param second The second table
+     * @param secondKeys The key columns of the second table
+     * @param left Whether rows of the first table without match are kept
+     */
+    void hashJoin(const TableDataCall& first, const std::vector<size_t>& firstKeys, const TableDataCall& second,
+        const std::vector<size_t>& secondKeys, bool left);
+
+    /**
+     * Appends views of the columns of a table to the output.
+     *
+     * @param in The table
+     * @param rows The rows of the table in the output, or nullptr if the output rows are those of the table
+     * @param skip The columns not to be appended
+     */
+    void appendColumns(const TableDataCall& in, const std::vector<uint64_t>* rows, const std::vector<size_t>& skip);
 
     /** input slot of first table */
     core::CallerSlot firstTableInSlot;
@@ -100,6 +131,15 @@ private:
     /** data output */
     core::CalleeSlot dataOutSlot;
 
+    /** the join mode */
+    core::param::ParamSlot modeSlot;
+
+    /** the key columns of the first table */
+    core::param::ParamSlot firstKeysSlot;
+
+    /** the key columns of the second table */
+    core::param::ParamSlot secondKeysSlot;
+
     /** frameID */
     int frameID;
 
@@ -107,17 +147,24 @@ private:
     size_t firstDataHash;
     size_t secondDataHash;
 
+    /** counts the changes of the parameters, which change the output data */
+    size_t paramHash;
+
     /** number of rows of the table */
     size_t rows_count;
 
-    /** number of columns of the table */
-    size_t column_count;
-
     /** vector storing the meta information of each column */
     std::vector<TableDataCall::ColumnInfo> column_info;
 
-    /** vector storing the data values of the table */
-    std::vector<float> data;
+    /** the views of the output columns */
+    std::vector<TableDataCall::ColumnData> columns;
+
+    /** the row of the first and second table of every output row */
+    std::vector<uint64_t> firstRows;
+    std::vector<uint64_t> secondRows;
+
+    /** the row indices of input columns which gather through row indices themselves */
+    std::vector<std::vector<uint64_t>> composedRows;
 }; /* end class TableJoin */
 
 } /* end namespace table */
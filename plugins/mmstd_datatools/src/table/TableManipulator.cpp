@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "TableManipulator.h"
+#include "ColumnExpression.h"
 
 #include "mmcore/param/StringParam.h"
 
@@ -64,6 +65,10 @@ TableManipulator::TableManipulator(void)
         "    maxes[c] = -math.huge\n"
         "end\n"
         "\n"
+        "-- mmComputeColumn(c, 'expression') computes a whole output column from the input\n"
+        "-- columns at once, e.g. mmComputeColumn(0, 'sqrt(x^2 + y^2)'), which is much\n"
+        "-- faster than the loop below\n"
+        "\n"
         "-- this allocates the complete table at once for best performance\n"
         "-- you need to do this row-wise if you want to filter out data \n"
         "mmAddOutputRows(rows)\n"
@@ -111,6 +116,10 @@ bool TableManipulator::create(void) {
         "mmGetCellValue", "(int row, int col)\n\treturns value in cell (row, col) in the input data");
     theLua.RegisterCallback<TableManipulator, &TableManipulator::setCellValue>(
         "mmSetCellValue", "(int row, int col, float val)\n\tset cell (row, col) in the output data to val");
+    theLua.RegisterCallback<TableManipulator, &TableManipulator::computeOutputColumn>("mmComputeColumn",
+        "(int col, string expression)\n\tcomputes column col of all output rows from the expression over the input "
+        "columns,\n\twhich can be referenced by name, [name] or $index. Requires as many output as input rows and "
+        "sets the column range.");
 
     return true;
 }
@@ -312,3 +321,31 @@ int TableManipulator::setCellValue(lua_State* L) {
         return 0;
     }
 }
+
+int TableManipulator::computeOutputColumn(lua_State* L) {
+    const auto col = luaL_checkinteger(L, 1);
+    const auto expression = luaL_checkstring(L, 2);
+    if (col < 0 || col >= static_cast<lua_Integer>(this->info.size())) {
+        lua_pushstring(L, "column index out of range");
+        lua_error(L);
+        return 0;
+    }
+    if (this->data.size() != row_count * this->info.size()) {
+        lua_pushstring(L, "you need to add as many output rows as there are input rows first");
+        lua_error(L);
+        return 0;
+    }
+
+    ColumnExpression expr;
+    std::string error;
+    if (!expr.Compile(expression, column_infos, column_count, error)) {
+        lua_pushstring(L, ("invalid expression: " + error).c_str());
+        lua_error(L);
+        return 0;
+    }
+    float min, max;
+    expr.Evaluate(in_data, column_count, row_count, this->data.data() + col, this->info.size(), min, max);
+    this->info[col].SetMinimumValue(min);
+    this->info[col].SetMaximumValue(max);
+    return 0;
+}
@@ -83,6 +83,9 @@ protected:
     /** (row, col, value) sets value in that cell */
     int setCellValue(lua_State* L);
 
+    /** (col, expression) computes column col of all output rows from the expression over the input columns */
+    int computeOutputColumn(lua_State* L);
+
     
 private:
     /** Data callback */
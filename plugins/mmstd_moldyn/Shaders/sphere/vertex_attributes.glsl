@@ -37,6 +37,13 @@ uniform mat4 MVPinv;
 uniform mat4 MVPtransp;
 
 uniform float constRad;
+
+// bounds minimum and edge length per step of quantised positions, scale 0 for unquantised ones
+uniform vec3 quantOffset;
+uniform float quantScale;
+
+// weight of the next frame when interpolating between frames
+uniform float frameAlpha;
 uniform vec4 globalCol;
 uniform int useGlobalCol;
 uniform int useTf;
@@ -2,6 +2,7 @@
 in vec4 inPosition;
 in vec4 inColor;
 in float inColIdx;
+in vec3 inNextPosition;
 
 void main(void) {
     
@@ -9,6 +10,10 @@ void main(void) {
     vec4 inPos = inPosition;
     rad = (constRad < -0.5) ? inPos.w : constRad;
     inPos.w = 1.0;
+    if (quantScale > 0.0) {
+        inPos.xyz = quantOffset + inPos.xyz * quantScale;
+    }
+    inPos.xyz = mix(inPos.xyz, inNextPosition, frameAlpha);
         
 #ifdef WITH_SCALING
     rad *= scaling;
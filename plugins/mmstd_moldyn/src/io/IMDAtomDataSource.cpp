@@ -8,6 +8,7 @@
 #include "stdafx.h"
 #include "io/IMDAtomDataSource.h"
 #include <climits>
+#include "io/TextParsing.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/ButtonParam.h"
@@ -34,6 +35,8 @@
 
 namespace {
 
+namespace text = megamol::stdplugin::moldyn::io::text;
+
 /**
  * Abstract base class for IMDAtom readers.
  *
@@ -226,7 +229,7 @@ protected:
 
 private:
     /** The size of the input buffer */
-    static const unsigned int BUFSIZE = 4 * 1024;
+    static const unsigned int BUFSIZE = 1024 * 1024;
 
     /**
      * Copies a number of bytes from the input buffer to 'dst'.
@@ -355,12 +358,12 @@ public:
      */
     VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
         const char* c = this->sift(fail);
-        try {
-            return static_cast<UINT32>(vislib::CharTraitsA::ParseInt(c));
-        } catch (...) {
+        int i = 0;
+        if ((c == NULL) || (text::ParseInt(c, i) == NULL)) {
             fail = true;
+            return 0;
         }
-        return 0;
+        return static_cast<UINT32>(i);
     }
 
     /**
@@ -373,12 +376,12 @@ public:
      */
     VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
         const char* c = this->sift(fail);
-        try {
-            return static_cast<float>(vislib::CharTraitsA::ParseDouble(c));
-        } catch (...) {
+        float f = 0.0f;
+        if ((c == NULL) || (text::ParseFloat(c, f) == NULL)) {
             fail = true;
+            return 0.0f;
         }
-        return 0.0f;
+        return f;
     }
 
     /**
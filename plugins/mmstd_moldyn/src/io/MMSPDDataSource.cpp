@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "io/MMSPDDataSource.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/CoreInstance.h"
@@ -29,6 +30,7 @@
 #include "vislib/UTF8Encoder.h"
 #include "vislib/utils.h"
 #include "vislib/VersionNumber.h"
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::stdplugin::moldyn::io;
@@ -437,71 +439,74 @@ void MMSPDDataSource::Frame::loadFrameText(char *buffer, UINT64 size, const MMSP
     if (txt.Count() < partCnt + 1) throw vislib::Exception("Data frame truncated", __FILE__, __LINE__);
 
     SIZE_T typeCnt = header.GetTypes().Count();
-    vislib::PtrArray<vislib::RawStorageWriter> typeData;
-    typeData.SetCount(typeCnt);
-    for (SIZE_T i = 0; i < typeCnt; i++) {
-        typeData[i] = new vislib::RawStorageWriter(this->Data()[i].Data());
-        typeData[i]->SetIncrement(vislib::math::Max<SIZE_T>(
-            static_cast<SIZE_T>((header.GetTypes()[i].GetFields().Count() * sizeof(float) * partCnt)
-            / (2 * typeCnt)),
-            1024 * 1024));
-    }
     vislib::RawStorageWriter idxRecDat(this->IndexReconstructionData());
     if (typeCnt > 1) idxRecDat.SetIncrement(vislib::math::Max<SIZE_T>(static_cast<SIZE_T>(partCnt / 10), 10 * 1024));
     UINT32 irdLastType = static_cast<UINT32>(typeCnt);
     UINT64 irdLastCount;
 
-    SIZE_T type = 0;
+    // First pass: types of the particles and their positions in the per-type storage
+    std::vector<UINT32> partType(static_cast<size_t>(partCnt), 0);
+    std::vector<UINT64> partPos(static_cast<size_t>(partCnt));
+    std::vector<UINT64> typePartCnt(typeCnt, 0);
+    const unsigned int idOff = header.HasIDs() ? 1 : 0;
+    const unsigned int off = idOff + ((typeCnt > 1) ? 1 : 0);
     for (UINT64 pi = 0; pi < partCnt; pi++) {
         const vislib::sys::ASCIIFileBuffer::LineBuffer &line = txt.Line(static_cast<SIZE_T>(1 + pi));
-        unsigned int off = 0;
+        SIZE_T type = 0;
         if (typeCnt > 1) {
-            if (header.HasIDs()) {
-                if (line.Count() < 2) throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(1)));
-                if (type >= typeCnt) throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-                off = 2;
-            } else {
-                if (line.Count() < 1) throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(0)));
-                if (type >= typeCnt) throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                off = 1;
-            }
-        } else if (header.HasIDs()) {
-            // type remains 0
-            if (line.Count() < 1) throw vislib::Exception("line truncated", __FILE__, __LINE__);
-            typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-            off = 1;
+            if (line.Count() < off) throw vislib::Exception("line truncated", __FILE__, __LINE__);
+            type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(idOff)));
+            if (type >= typeCnt) throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
+        }
+        if (line.Count() < header.GetTypes()[type].GetFields().Count() + off) {
+            throw vislib::Exception("line truncated", __FILE__, __LINE__);
         }
 
         this->addIndexForReconstruction(static_cast<UINT32>(type), idxRecDat,
             this->IndexReconstructionData(), irdLastType, irdLastCount);
 
-        SIZE_T fieldCnt = header.GetTypes()[type].GetFields().Count();
-        if (line.Count() < fieldCnt + off) throw vislib::Exception("line truncated", __FILE__, __LINE__);
-
-        for (SIZE_T fi = 0; fi < fieldCnt; fi++) {
-            //float val = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(off + this->GetData()[type].FieldMap()[fi])));
-            //if (header.GetTypes()[type].GetFields()[this->GetData()[type].FieldMap()[fi]].GetType() ==
-            //    MMSPDHeader::Field::TYPE_BYTE) {
-            //    val /= 255.0f;
-            //}
-            float val = vislib::CharTraitsA::ParseDouble(line.Word(off + fi));
-            if (header.GetTypes()[type].GetFields()[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
-                val /= 255.0f;
-            }
-
-            //vislib::sys::Log::DefaultLog.WriteInfo("read: %f", val);
-            typeData[type]->Write(val);
-        }
-
+        partType[static_cast<size_t>(pi)] = static_cast<UINT32>(type);
+        partPos[static_cast<size_t>(pi)] = typePartCnt[type]++;
     }
+    this->IndexReconstructionData().EnforceSize(idxRecDat.End(), true);
 
+    std::vector<SIZE_T> stride(typeCnt);
+    std::vector<unsigned char*> typeData(typeCnt);
     for (SIZE_T i = 0; i < typeCnt; i++) {
-        this->Data()[i].Data().EnforceSize(typeData[i]->End(), true);
+        stride[i] = (header.HasIDs() ? sizeof(UINT64) : 0) + header.GetTypes()[i].GetFields().Count() * sizeof(float);
+        this->Data()[i].Data().EnforceSize(static_cast<SIZE_T>(typePartCnt[i] * stride[i]));
+        typeData[i] = this->Data()[i].Data().As<unsigned char>();
     }
-    this->IndexReconstructionData().EnforceSize(idxRecDat.End(), true);
+
+    // Second pass: the particle values are parsed independently of each other
+    bool failed = false;
+    const INT64 cnt = static_cast<INT64>(partCnt);
+#pragma omp parallel for
+    for (INT64 pi = 0; pi < cnt; pi++) {
+        if (failed) continue;
+        try {
+            const vislib::sys::ASCIIFileBuffer::LineBuffer &line = txt.Line(static_cast<SIZE_T>(1 + pi));
+            const SIZE_T type = partType[static_cast<size_t>(pi)];
+            const vislib::Array<MMSPDHeader::Field>& fields = header.GetTypes()[type].GetFields();
+            unsigned char *dst = typeData[type] + static_cast<SIZE_T>(partPos[static_cast<size_t>(pi)] * stride[type]);
+            if (header.HasIDs()) {
+                UINT64 id = vislib::CharTraitsA::ParseUInt64(line.Word(0));
+                ::memcpy(dst, &id, sizeof(UINT64));
+                dst += sizeof(UINT64);
+            }
+            for (SIZE_T fi = 0; fi < fields.Count(); fi++) {
+                float val = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(off + fi)));
+                if (fields[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
+                    val /= 255.0f;
+                }
+                ::memcpy(dst + fi * sizeof(float), &val, sizeof(float));
+            }
+        } catch (...) {
+#pragma omp critical
+            failed = true;
+        }
+    }
+    if (failed) throw vislib::Exception("Illegal number in frame data", __FILE__, __LINE__);
 }
 
 
@@ -739,6 +744,7 @@ float MMSPDDataSource::FileFormatAutoDetect(const unsigned char* data, SIZE_T da
 MMSPDDataSource::MMSPDDataSource(void)
     : core::view::AnimDataModule()
     , filename("filename", "The path to the MMSPD file to load.")
+    , useIndexFile("useIndexFile", "Load the frame index from and store it to a file next to the data file")
     , getData("getdata", "Slot to request data from this data source.")
     , getDirData("getdirdata", "(optional) Slot to request directional data from this data source.")
     , dataHeader(), file(NULL), frameIdx(NULL)
@@ -751,6 +757,9 @@ MMSPDDataSource::MMSPDDataSource(void)
     this->filename.SetUpdateCallback(&MMSPDDataSource::filenameChanged);
     this->MakeSlotAvailable(&this->filename);
 
+    this->useIndexFile.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->useIndexFile);
+
     this->getData.SetCallback("MultiParticleDataCall", "GetData", &MMSPDDataSource::getDataCallback);
     this->getData.SetCallback("MultiParticleDataCall", "GetExtent", &MMSPDDataSource::getExtentCallback);
     this->MakeSlotAvailable(&this->getData);
@@ -1179,6 +1188,22 @@ DWORD MMSPDDataSource::buildFrameIndex(void *userdata) {
                 static_cast<unsigned int>(frameCount),
                 static_cast<unsigned int>((end - begin) / frameCount));
 
+            if (that->useIndexFile.Param<core::param::BoolParam>()->Value()) {
+                std::vector<UINT64> idx(frameCount + 1);
+                bool complete = false;
+                that->frameIdxLock.Lock();
+                if (that->frameIdx != NULL) {
+                    ::memcpy(idx.data(), that->frameIdx, sizeof(UINT64) * (frameCount + 1));
+                    complete = true;
+                    for (unsigned int i = 0; i <= frameCount; i++) {
+                        if ((idx[i] == 0) || (idx[i] == ULLONG_MAX)) complete = false;
+                    }
+                }
+                that->frameIdxLock.Unlock();
+                // truncated data files are indexed again on every load
+                if (complete) that->saveFrameIndexFile(idx.data(), frameCount, static_cast<UINT64>(f.GetSize()));
+            }
+
 #if defined(DEBUG) || defined(_DEBUG)
             //that->frameIdxLock.Lock();
             //if (that->frameIdx == NULL) { that->frameIdxLock.Unlock(); throw vislib::Exception("aborted", __FILE__, __LINE__); }
@@ -1216,6 +1241,99 @@ DWORD MMSPDDataSource::buildFrameIndex(void *userdata) {
 }
 
 
+/*
+ * MMSPDDataSource::frameIndexFileName
+ */
+vislib::TString MMSPDDataSource::frameIndexFileName(void) const {
+    vislib::TString fn(this->filename.Param<core::param::FilePathParam>()->Value());
+    fn.Append(_T(".idx"));
+    return fn;
+}
+
+
+/*
+ * MMSPDDataSource::loadFrameIndexFile
+ *
+ * The frame index file holds the magic "MMSPDIDX", the version (UINT32),
+ * the size of the data file (UINT64), the number of frames (UINT32) and
+ * the #frames + 1 frame seek positions (UINT64).
+ */
+bool MMSPDDataSource::loadFrameIndexFile(void) {
+    using vislib::sys::File;
+    vislib::TString fn = this->frameIndexFileName();
+    if (!File::Exists(fn)) return false;
+
+    File f;
+    if (!f.Open(fn, File::READ_ONLY, File::SHARE_READ, File::OPEN_ONLY)) return false;
+
+    unsigned int frameCount = this->dataHeader.GetTimeCount();
+    char magic[8];
+    UINT32 version = 0, cnt = 0;
+    UINT64 dataSize = 0;
+    std::vector<UINT64> idx(frameCount + 1);
+    bool valid = (f.Read(magic, 8) == 8) && (::memcmp(magic, "MMSPDIDX", 8) == 0)
+        && (f.Read(&version, sizeof(UINT32)) == sizeof(UINT32)) && (version == 1)
+        && (f.Read(&dataSize, sizeof(UINT64)) == sizeof(UINT64))
+        && (dataSize == static_cast<UINT64>(this->file->GetSize()))
+        && (f.Read(&cnt, sizeof(UINT32)) == sizeof(UINT32)) && (cnt == frameCount)
+        && (f.Read(idx.data(), sizeof(UINT64) * idx.size()) == sizeof(UINT64) * idx.size());
+    f.Close();
+
+    // the header must end where the index starts, and the frames must be in order
+    valid = valid && (idx[0] == this->frameIdx[0]) && (idx[frameCount] <= dataSize);
+    for (unsigned int i = 0; valid && (i < frameCount); i++) {
+        valid = (idx[i] < idx[i + 1]);
+    }
+    if (valid && !this->isBinaryFile) {
+        // text frames start with their time frame marker
+        for (unsigned int i : { 0u, frameCount - 1 }) {
+            char c = 0;
+            this->file->Seek(static_cast<File::FileOffset>(idx[i]));
+            valid = valid && (this->file->Read(&c, 1) == 1) && (c == '>');
+        }
+        this->file->Seek(static_cast<File::FileOffset>(idx[0]));
+    }
+    if (!valid) {
+        vislib::sys::Log::DefaultLog.WriteInfo("Frame index file \"%s\" does not match the data file; rebuilding",
+            vislib::StringA(fn).PeekBuffer());
+        return false;
+    }
+
+    this->frameIdxLock.Lock();
+    ::memcpy(this->frameIdx, idx.data(), sizeof(UINT64) * idx.size());
+    this->frameIdxLock.Unlock();
+    vislib::sys::Log::DefaultLog.WriteInfo(50, "Frame index of %u frames loaded from \"%s\"",
+        frameCount, vislib::StringA(fn).PeekBuffer());
+    return true;
+}
+
+
+/*
+ * MMSPDDataSource::saveFrameIndexFile
+ */
+void MMSPDDataSource::saveFrameIndexFile(const UINT64 *idx, unsigned int frameCount,
+        UINT64 dataFileSize) const {
+    using vislib::sys::File;
+    vislib::TString fn = this->frameIndexFileName();
+    File f;
+    const UINT32 version = 1, cnt = frameCount;
+    bool res = f.Open(fn, File::WRITE_ONLY, File::SHARE_EXCLUSIVE, File::CREATE_OVERWRITE);
+    if (res) {
+        res = (f.Write("MMSPDIDX", 8) == 8)
+            && (f.Write(&version, sizeof(UINT32)) == sizeof(UINT32))
+            && (f.Write(&dataFileSize, sizeof(UINT64)) == sizeof(UINT64))
+            && (f.Write(&cnt, sizeof(UINT32)) == sizeof(UINT32))
+            && (f.Write(idx, sizeof(UINT64) * (frameCount + 1)) == sizeof(UINT64) * (frameCount + 1));
+        f.Close();
+        if (!res) File::Delete(fn);
+    }
+    if (!res) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Unable to write frame index file \"%s\"",
+            vislib::StringA(fn).PeekBuffer());
+    }
+}
+
+
 /*
  * MMSPDDataSource::clearData
  */
@@ -1672,7 +1790,11 @@ bool MMSPDDataSource::filenameChanged(core::param::ParamSlot& slot) {
         this->initFrameCache(1);
     } else {
         this->setFrameCount(this->dataHeader.GetTimeCount());
-        this->frameIdxThread.Start(static_cast<void*>(this));
+        if (this->useIndexFile.Param<core::param::BoolParam>()->Value() && this->loadFrameIndexFile()) {
+            this->frameIdxEvent.Set();
+        } else {
+            this->frameIdxThread.Start(static_cast<void*>(this));
+        }
         // this->frameIdxThread.Join(); // Use this pause the main thread for debugging
 
         // estimate data set frame memory foot print
@@ -295,6 +295,33 @@ namespace io {
          */
         static DWORD buildFrameIndex(void *userdata);
 
+        /**
+         * Answer the name of the file persisting the frame index of the
+         * current data file.
+         *
+         * @return The name of the frame index file
+         */
+        vislib::TString frameIndexFileName(void) const;
+
+        /**
+         * Tries to load the frame index from the frame index file. The
+         * frame index must be allocated and 'frameIdx[0]' must hold the
+         * position of the first frame.
+         *
+         * @return 'true' if the frame index has been loaded and matches the
+         *         data file, 'false' if it needs to be built
+         */
+        bool loadFrameIndexFile(void);
+
+        /**
+         * Writes a completed frame index to the frame index file.
+         *
+         * @param idx The frame index of #frames + 1 entries
+         * @param frameCount The number of frames
+         * @param dataFileSize The size of the data file
+         */
+        void saveFrameIndexFile(const UINT64 *idx, unsigned int frameCount, UINT64 dataFileSize) const;
+
         /**
          * Clears the data
          */
@@ -339,6 +366,9 @@ namespace io {
         /** The file name */
         core::param::ParamSlot filename;
 
+        /** Flag whether to load and store the frame index next to the data file */
+        core::param::ParamSlot useIndexFile;
+
         /** The slot for requesting data */
         core::CalleeSlot getData;
 
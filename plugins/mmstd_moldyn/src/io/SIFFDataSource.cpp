@@ -17,6 +17,7 @@
 #include "vislib/String.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/VersionNumber.h"
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::stdplugin::moldyn::io;
@@ -175,96 +176,116 @@ bool SIFFDataSource::filenameChanged(core::param::ParamSlot& slot) {
 
         unsigned int t1 = vislib::sys::GetTicksOfDay();
 
+        // The file is read in blocks of complete lines, and the lines of
+        // each block are parsed in parallel before being appended in order.
+        struct ParsedLine {
+            float x, y, z, rad;
+            int r, g, b, colA;
+            int fields;
+        };
         const SIZE_T bufferSize = 1024 * 1024 * 8;
-        char *buffer = new char[bufferSize];
-        vislib::StringA lineOnBreak;
-        float x, y, z, rad;
-        int r, g, b, colA;
-        while (!file.IsEOF()) {
-            SIZE_T read = static_cast<SIZE_T>(file.Read(buffer, bufferSize));
+        char *buffer = new char[bufferSize + 1];
+        std::vector<SIZE_T> lineStarts;
+        std::vector<ParsedLine> lines;
+        SIZE_T carry = 0;
+        bool eof = false;
+        while (!eof) {
+            SIZE_T read = static_cast<SIZE_T>(file.Read(buffer + carry, bufferSize - carry));
+            SIZE_T end = carry + read;
+            eof = file.IsEOF() || (read == 0);
+            SIZE_T last = end;
+            if (!eof) {
+                while ((last > 0) && (buffer[last - 1] != '\n') && (buffer[last - 1] != '\r')) {
+                    last--;
+                }
+                if (last == 0) {
+                    Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "SIFF-Data-Error: line exceeds %u bytes",
+                        static_cast<unsigned int>(bufferSize));
+                    break;
+                }
+            }
+
+            lineStarts.clear();
             SIZE_T sspos = 0;
-            SIZE_T sepos = 0;
-            while (sepos < read) {
-                while ((sepos < read) && (buffer[sepos] != '\n') && (buffer[sepos] != '\r')) {
-                    sepos++;
+            for (SIZE_T sepos = 0; sepos < last; sepos++) {
+                if ((buffer[sepos] == '\n') || (buffer[sepos] == '\r')) {
+                    buffer[sepos] = 0;
+                    if (sepos > sspos) lineStarts.push_back(sspos);
+                    sspos = sepos + 1;
                 }
-                if ((sepos < read) || file.IsEOF()) {
-                    // handle string input
-                    const char *line;
-                    if ((sepos == read) || !lineOnBreak.IsEmpty()) {
-                        lineOnBreak += vislib::StringA(buffer + sspos, static_cast<unsigned int>(sepos - sspos));
-                        line = lineOnBreak.PeekBuffer();
-                    } else {
-                        buffer[sepos] = 0;
-                        line = buffer + sspos;
-                    }
-                    bool valid = true;
+            }
+            if (sspos < last) {
+                // last line of the file without line break
+                buffer[last] = 0;
+                lineStarts.push_back(sspos);
+            }
 
-                    if (this->verNum == 100) {
-                        int srv =
+            lines.resize(lineStarts.size());
+            const int lineCnt = static_cast<int>(lineStarts.size());
+#pragma omp parallel for
+            for (int li = 0; li < lineCnt; li++) {
+                const char *line = buffer + lineStarts[li];
+                ParsedLine& pl = lines[li];
+                if (this->verNum == 100) {
+                    pl.fields =
 #ifdef _WIN32
-                            sscanf_s
+                        sscanf_s
 #else /* _WIN32 */
-                            sscanf
+                        sscanf
 #endif /* _WIN32 */
-                                (line, "%f %f %f %f %d %d %d %d\n", &x, &y, &z, &rad, &r, &g, &b, &colA);
-                        if (srv == 8) {
-                            if (cnt == 0) {
-                                this->hasAlpha = true;
-                                bpp = 20; // because we now store alpha too
-                            }
-                            if (colA < 0) colA = 0; else if (colA > 255) colA = 255;
-                            srv = 7;
-                        } else colA = 255;
-                        if (srv == 7) {
-                            if (r < 0) r = 0; else if (r > 255) r = 255;
-                            if (g < 0) g = 0; else if (g > 255) g = 255;
-                            if (b < 0) b = 0; else if (b > 255) b = 255;
-                        } else valid = false;
-                    } else if (this->verNum == 101) {
-                        if (
+                            (line, "%f %f %f %f %d %d %d %d\n", &pl.x, &pl.y, &pl.z, &pl.rad,
+                            &pl.r, &pl.g, &pl.b, &pl.colA);
+                    if (pl.fields == 8) {
+                        if (pl.colA < 0) pl.colA = 0; else if (pl.colA > 255) pl.colA = 255;
+                    } else pl.colA = 255;
+                    if (pl.fields >= 7) {
+                        if (pl.r < 0) pl.r = 0; else if (pl.r > 255) pl.r = 255;
+                        if (pl.g < 0) pl.g = 0; else if (pl.g > 255) pl.g = 255;
+                        if (pl.b < 0) pl.b = 0; else if (pl.b > 255) pl.b = 255;
+                    } else pl.fields = 0;
+                } else {
+                    pl.fields =
 #ifdef _WIN32
-                            sscanf_s
+                        sscanf_s
 #else /* _WIN32 */
-                            sscanf
+                        sscanf
 #endif /* _WIN32 */
-                                (line, "%f %f %f\n", &x, &y, &z) == 3) {
-                            // everything fine
-                        } else valid = false;
-                    } else valid = false;
-
-                    if (valid) {
-                        blocks = this->data.GetSize() / (bpp * blockGrow);
-                        if ((1 + cnt / blockGrow) > blocks) {
-                            blocks = 1 + cnt / blockGrow;
-                        }
-                        this->data.AssertSize(blocks * bpp * blockGrow, true);
-
-                        *this->data.AsAt<float>(cnt * bpp + 0) = x;
-                        *this->data.AsAt<float>(cnt * bpp + 4) = y;
-                        *this->data.AsAt<float>(cnt * bpp + 8) = z;
-                        if (this->verNum == 100) {
-                            *this->data.AsAt<float>(cnt * bpp + 12) = rad;
-                            *this->data.AsAt<unsigned char>(cnt * bpp + 16) = static_cast<unsigned char>(r);
-                            *this->data.AsAt<unsigned char>(cnt * bpp + 17) = static_cast<unsigned char>(g);
-                            *this->data.AsAt<unsigned char>(cnt * bpp + 18) = static_cast<unsigned char>(b);
-                            if (this->hasAlpha) {
-                                *this->data.AsAt<unsigned char>(cnt * bpp + 19) = static_cast<unsigned char>(colA);
-                            }
-                        }
-                        cnt++;
-                    }
+                            (line, "%f %f %f\n", &pl.x, &pl.y, &pl.z);
+                    if (pl.fields != 3) pl.fields = 0;
+                }
+            }
 
-                    lineOnBreak.Clear();
-                    sepos++;
-                    sspos = sepos;
+            for (const ParsedLine& pl : lines) {
+                if (pl.fields == 0) continue;
+                if ((cnt == 0) && (pl.fields == 8)) {
+                    this->hasAlpha = true;
+                    bpp = 20; // because we now store alpha too
+                }
 
-                } else {
-                    // store line part for the next loop cycle
-                    lineOnBreak += vislib::StringA(buffer + sspos, static_cast<unsigned int>(sepos - sspos));
+                blocks = this->data.GetSize() / (bpp * blockGrow);
+                if ((1 + cnt / blockGrow) > blocks) {
+                    blocks = 1 + cnt / blockGrow;
+                }
+                this->data.AssertSize(blocks * bpp * blockGrow, true);
+
+                *this->data.AsAt<float>(cnt * bpp + 0) = pl.x;
+                *this->data.AsAt<float>(cnt * bpp + 4) = pl.y;
+                *this->data.AsAt<float>(cnt * bpp + 8) = pl.z;
+                if (this->verNum == 100) {
+                    *this->data.AsAt<float>(cnt * bpp + 12) = pl.rad;
+                    *this->data.AsAt<unsigned char>(cnt * bpp + 16) = static_cast<unsigned char>(pl.r);
+                    *this->data.AsAt<unsigned char>(cnt * bpp + 17) = static_cast<unsigned char>(pl.g);
+                    *this->data.AsAt<unsigned char>(cnt * bpp + 18) = static_cast<unsigned char>(pl.b);
+                    if (this->hasAlpha) {
+                        *this->data.AsAt<unsigned char>(cnt * bpp + 19) = static_cast<unsigned char>(pl.colA);
+                    }
                 }
+                cnt++;
             }
 
+            // keep the incomplete last line for the next block
+            carry = end - last;
+            ::memmove(buffer, buffer + last, carry);
         }
 
         delete[] buffer;
@@ -0,0 +1,213 @@
+/*
+ * TextParsing.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#ifndef MEGAMOL_STDMOLDYN_TEXTPARSING_H_INCLUDED
+#define MEGAMOL_STDMOLDYN_TEXTPARSING_H_INCLUDED
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace megamol {
+namespace stdplugin {
+namespace moldyn {
+namespace io {
+
+/**
+ * Helpers for loading large text files, which replace the line by line
+ * reading, tokenising and sscanf-based parsing of vislib. The text is
+ * parsed from memory, split into chunks of whole lines that are parsed in
+ * parallel. All functions expect the text to be terminated by a zero byte.
+ */
+namespace text {
+
+/** Answer whether c separates tokens within a line */
+inline bool IsBlank(char c) { return (c == ' ') || (c == '\t') || (c == '\r'); }
+
+/** Answer the first character at p that does not separate tokens */
+inline const char* SkipBlanks(const char* p) {
+    while (IsBlank(*p)) ++p;
+    return p;
+}
+
+/** Answer the end of the line starting at p, i.e. its newline or terminating zero */
+inline const char* LineEnd(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return (nl == nullptr) ? end : nl;
+}
+
+/**
+ * Answers the next token at p, moving p behind it.
+ *
+ * @return The length of the token, zero at the end of the line.
+ */
+inline size_t NextToken(const char*& p, const char*& token) {
+    token = SkipBlanks(p);
+    p = token;
+    while ((*p != 0) && (*p != '\n') && !IsBlank(*p)) ++p;
+    return static_cast<size_t>(p - token);
+}
+
+/** Answer whether the token equals str, ignoring the case */
+inline bool TokenEquals(const char* token, size_t len, const char* str) {
+    for (size_t i = 0; i < len; ++i, ++str) {
+        if ((*str == 0) || (std::tolower(static_cast<unsigned char>(token[i])) !=
+                               std::tolower(static_cast<unsigned char>(*str)))) {
+            return false;
+        }
+    }
+    return (*str == 0);
+}
+
+/**
+ * Parses an integer at p, skipping leading blanks.
+ *
+ * @return The position behind the number, or nullptr if there is none.
+ */
+inline const char* ParseInt(const char* p, int& out) {
+    p = SkipBlanks(p);
+    const bool neg = (*p == '-');
+    if ((*p == '-') || (*p == '+')) ++p;
+    if ((*p < '0') || (*p > '9')) return nullptr;
+    int64_t v = 0;
+    while ((*p >= '0') && (*p <= '9')) v = v * 10 + (*p++ - '0');
+    out = static_cast<int>(neg ? -v : v);
+    return p;
+}
+
+/**
+ * Parses a floating point number at p, skipping leading blanks. Numbers
+ * with up to 19 significant digits and small exponents, i.e. the ones
+ * written by simulations, are converted exactly without strtod.
+ *
+ * @return The position behind the number, or nullptr if there is none.
+ */
+inline const char* ParseDouble(const char* p, double& out) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+        1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    p = SkipBlanks(p);
+    const char* start = p;
+    const bool neg = (*p == '-');
+    if ((*p == '-') || (*p == '+')) ++p;
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; (*p >= '0') && (*p <= '9'); ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) ++digits;
+        } else {
+            ++exponent;
+        }
+    }
+    if (*p == '.') {
+        for (++p; (*p >= '0') && (*p <= '9'); ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!any) {
+        // e.g. 'nan' or 'inf'
+        char* e = nullptr;
+        out = std::strtod(start, &e);
+        return (e == start) ? nullptr : e;
+    }
+    if ((*p == 'e') || (*p == 'E')) {
+        int e = 0;
+        const char* q = ParseInt(p + 1, e);
+        if ((q != nullptr) && !IsBlank(p[1])) {
+            exponent += e;
+            p = q;
+        }
+    }
+
+    if ((mantissa < (uint64_t(1) << 53)) && (exponent >= -22) && (exponent <= 22)) {
+        const double v = static_cast<double>(mantissa);
+        out = (exponent < 0) ? (v / pow10[-exponent]) : (v * pow10[exponent]);
+        if (neg) out = -out;
+    } else {
+        out = std::strtod(start, nullptr);
+    }
+    return p;
+}
+
+/** Parses a float, see ParseDouble */
+inline const char* ParseFloat(const char* p, float& out) {
+    double d = 0.0;
+    p = ParseDouble(p, d);
+    out = static_cast<float>(d);
+    return p;
+}
+
+/**
+ * Splits text into ranges of whole lines to be parsed in parallel.
+ *
+ * @param data The text
+ * @param size The length of the text
+ * @param minChunkSize The minimum number of bytes worth a thread
+ *
+ * @return The offsets [begin, end) of the chunks, in order
+ */
+inline std::vector<std::pair<size_t, size_t>> SplitChunks(
+    const char* data, size_t size, size_t minChunkSize = 1 << 20) {
+    const size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t count = std::max<size_t>(std::min(threads, size / std::max<size_t>(minChunkSize, 1)), 1);
+    std::vector<std::pair<size_t, size_t>> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; (i <= count) && (begin < size); ++i) {
+        size_t end = (i == count) ? size : std::max(begin, size * i / count);
+        if (end < size) {
+            end = static_cast<size_t>(LineEnd(data + end, data + size) - data);
+            if (end < size) ++end; // include the newline
+        }
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    return chunks;
+}
+
+/**
+ * Calls func(index, begin, end) for each chunk of text on its own thread.
+ *
+ * @param data The text
+ * @param chunks The chunks as answered by SplitChunks
+ * @param func The function parsing [begin, end) of chunk 'index'
+ */
+template <class F>
+void ParseChunks(const char* data, const std::vector<std::pair<size_t, size_t>>& chunks, F func) {
+    if (chunks.empty()) return;
+    if (chunks.size() == 1) {
+        func(0, data + chunks[0].first, data + chunks[0].second);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        threads.emplace_back([&, i]() { func(i, data + chunks[i].first, data + chunks[i].second); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+} /* end namespace text */
+
+} /* end namespace io */
+} /* end namespace moldyn */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_STDMOLDYN_TEXTPARSING_H_INCLUDED */
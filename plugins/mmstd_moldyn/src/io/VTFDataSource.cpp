@@ -29,6 +29,8 @@
 #include <cstdint>
 #include "vislib/sys/BufferedFile.h"
 #include "vislib/sys/FastFile.h"
+#include "io/TextParsing.h"
+#include <vector>
 
 using namespace megamol::core;
 using namespace megamol::stdplugin::moldyn;
@@ -41,6 +43,8 @@ using namespace megamol::stdplugin::moldyn;
 #define CACHE_SIZE_MAX 100000
 // factor multiplied to the frame size for estimating the overhead to the pure data.
 #define CACHE_FRAME_FACTOR 1.15f
+// number of bytes read at once when scanning for the frames
+#define SCAN_BLOCK_SIZE (64 << 20)
 
 /*****************************************************************************/
 
@@ -95,7 +99,8 @@ void io::VTFDataSource::Frame::Clear(void) {
 /*
  * io::VTFDataSource::Frame::LoadFrame
  */
-bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File *file, unsigned int idx, vislib::Array<SimpleType> &types) {
+bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File *file, unsigned int idx,
+        vislib::sys::File::FileSize size, vislib::Array<SimpleType> &types) {
 /*
 	timestep indexed
 	0 -1 88.08974923911063 93.53975290469917 41.0842180843088940
@@ -107,45 +112,78 @@ bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File *file, unsigned int i
 	
     this->frame = idx;
 	this->partCnt.Resize(types.Count());
-	this->pos[0].EnforceSize(sizeof(float)* 3 * types[0].GetCount());
-	this->col[0].EnforceSize(sizeof(float)* 4 * types[0].GetCount());
-
-	unsigned int id = 0;
-
-	while(!file->IsEOF()) {
-        vislib::StringA line = vislib::sys::ReadLineFromFileA(*file);
-        line.TrimSpaces();
-    
-		vislib::Array<vislib::StringA> shreds = vislib::StringTokeniserA::Split(line, ' ', true);
-
-		if (line.IsEmpty() || line.StartsWithInsensitive("time")) {
-            break;
-		}
-
-		int clusterId = (int)vislib::CharTraitsA::ParseInt(shreds[1]);
-		this->clusterInfos.data[clusterId].Append(id);
-
-		vislib::math::Vector<float, 3> pos;
-		pos.Set((float)vislib::CharTraitsA::ParseDouble(shreds[2]),
-			    (float)vislib::CharTraitsA::ParseDouble(shreds[3]),
-				(float)vislib::CharTraitsA::ParseDouble(shreds[4]));
-
-		vislib::math::Vector<float, 4> col;
-		col.Set(0.0f, // type
-				static_cast<float>(clusterId),
-			    0.0f,
-				0.0f);
-
 
+    // read the whole frame at once and parse its lines in parallel
+    std::vector<char> text(static_cast<size_t>(size) + 1);
+    text.resize(static_cast<size_t>(file->Read(text.data(), size)) + 1);
+    text.back() = 0;
+
+    struct Chunk {
+        std::vector<float> pos;
+        std::vector<int> cluster;
+        bool last = false; // whether the chunk contains the end of the frame
+    };
+    const auto chunkRanges = text::SplitChunks(text.data(), text.size() - 1);
+    std::vector<Chunk> chunks(chunkRanges.size());
+
+    text::ParseChunks(text.data(), chunkRanges, [&chunks](size_t i, const char *begin, const char *end) {
+        Chunk &chunk = chunks[i];
+        chunk.pos.reserve((end - begin) / 16);
+        chunk.cluster.reserve((end - begin) / 48);
+        for (const char *line = begin; line < end;) {
+            const char *lineEnd = text::LineEnd(line, end);
+            const char *p = line;
+            const char *token;
+            const size_t len = text::NextToken(p, token);
+            if ((len == 0) || text::TokenEquals(token, (len < 4) ? len : 4, "time")) {
+                chunk.last = true;
+                break;
+            }
 
-		//this->pos[0].Append(pos.PeekComponents(), 3 * sizeof(float));
+            int clusterId = 0;
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            if (((p = text::ParseInt(p, clusterId)) != nullptr) && ((p = text::ParseFloat(p, x)) != nullptr) &&
+                    ((p = text::ParseFloat(p, y)) != nullptr) && (text::ParseFloat(p, z) != nullptr)) {
+                chunk.cluster.push_back(clusterId);
+                chunk.pos.push_back(x);
+                chunk.pos.push_back(y);
+                chunk.pos.push_back(z);
+            }
+            line = lineEnd + 1;
+        }
+    });
 
-		memcpy(this->pos[0].At(4 * 3 * this->partCnt[0]), pos.PeekComponents(), 3 * sizeof(float));
-		memcpy(this->col[0].At(4 * 4 * this->partCnt[0]), col.PeekComponents(), 4 * sizeof(float));
+    size_t count = 0;
+    for (const auto &chunk : chunks) {
+        count += chunk.cluster.size();
+        if (chunk.last) break;
+    }
+	this->pos[0].EnforceSize(sizeof(float)* 3 * count);
+	this->col[0].EnforceSize(sizeof(float)* 4 * count);
+	this->partCnt[0] = 0;
 
-		++this->partCnt[0];
-		++id;
-	}
+	unsigned int id = 0;
+    for (const auto &chunk : chunks) {
+        for (size_t i = 0; i < chunk.cluster.size(); ++i) {
+            const int clusterId = chunk.cluster[i];
+            this->clusterInfos.data[clusterId].Append(id);
+
+            float *pos = this->pos[0].AsAt<float>(4 * 3 * this->partCnt[0]);
+            pos[0] = chunk.pos[3 * i + 0];
+            pos[1] = chunk.pos[3 * i + 1];
+            pos[2] = chunk.pos[3 * i + 2];
+
+            float *col = this->col[0].AsAt<float>(4 * 4 * this->partCnt[0]);
+            col[0] = 0.0f; // type
+            col[1] = static_cast<float>(clusterId);
+            col[2] = 0.0f;
+            col[3] = 0.0f;
+
+            ++this->partCnt[0];
+            ++id;
+        }
+        if (chunk.last) break;
+    }
 	//								                  count + start                              + data
 	this->clusterInfos.sizeofPlainData = 2 * this->clusterInfos.data.Count() * sizeof(int)+this->partCnt[0] * sizeof(int);
 	this->clusterInfos.plainData = (unsigned int*)malloc(this->clusterInfos.sizeofPlainData);
@@ -326,7 +364,7 @@ io::VTFDataSource::VTFDataSource(void) : view::AnimDataModule(),
         getData("getdata", "Slot to request data from this data source."),
 		preprocessSlot("preprocess", "aggregation preprocessing"),
         types(), frameIdx(), file(NULL),
-        datahash(0)
+        datahash(0), fileSize(0)
 {
 
     this->filename.SetParameter(new param::FilePathParam(""));
@@ -386,8 +424,11 @@ void io::VTFDataSource::loadFrame(view::AnimDataModule::Frame *frame,
     }
     ASSERT(idx < this->FrameCount());
 
+    // the frame ends with the 'time' line of the next one
+    const vislib::sys::File::FileSize end =
+        (idx + 1 < this->frameIdx.Count()) ? this->frameIdx[idx + 1] : this->fileSize;
     this->file->Seek(this->frameIdx[idx]);
-    f->LoadFrame(this->file, idx, this->types);
+    f->LoadFrame(this->file, idx, end - this->frameIdx[idx], this->types);
 
 	if(this->preprocessSlot.Param<param::BoolParam>()->Value())
 		preprocessFrame(*f);
@@ -570,13 +611,13 @@ bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filena
 	bool haveAtomType = false;
 
 	this->types.Clear();
+	this->fileSize = this->file->GetSize();
 	
     vislib::sys::ConsoleProgressBar cpb;
-    cpb.Start("Progress Loading VTF File", static_cast<vislib::sys::ConsoleProgressBar::Size>(this->file->GetSize()));
+    cpb.Start("Progress Loading VTF File", static_cast<vislib::sys::ConsoleProgressBar::Size>(this->fileSize));
 
-    // read the header
-    while (!this->file->IsEOF()) {
-		vislib::sys::File::FileSize currentFileCursor = this->file->Tell();
+    // read the header, the frames are indexed by scanning the file in parallel afterwards
+    while (!this->file->IsEOF() && !(haveBoundingBox && haveAtomType)) {
         vislib::StringA line = vislib::sys::ReadLineFromFileA(*this->file);
         line.TrimSpaces();
 
@@ -609,13 +650,6 @@ bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filena
 			}
 		}
 	
-		if(haveBoundingBox && haveAtomType) {
-			if (shreds[0].Compare("time", false) && shreds[1].Compare("index", false)) {
-				this->frameIdx.Append(this->file->Tell());
-				cpb.Set(static_cast<vislib::sys::ConsoleProgressBar::Size>(this->file->Tell()));
-			}
-		}
-
 		/*
         vislib::StringA line = vislib::sys::ReadLineFromFileA(*this->file);
         line.TrimSpaces();
@@ -678,6 +712,10 @@ bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filena
 		*/
 		
     }
+    if (haveBoundingBox && haveAtomType) {
+        this->scanFrameIndices(cpb);
+    }
+    cpb.Stop();
 	this->setFrameCount((unsigned int)this->frameIdx.Count());
 	//this->initFrameCache(1);
 
@@ -685,6 +723,60 @@ bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filena
 }
 
 
+/*
+ * io::VTFDataSource::scanFrameIndices
+ */
+void io::VTFDataSource::scanFrameIndices(vislib::sys::ConsoleProgressBar &cpb) {
+    vislib::sys::File::FileSize blockStart = this->file->Tell();
+    std::vector<char> block;
+
+    while (blockStart < this->fileSize) {
+        // read a block of whole lines, the last partial line is read again with the next block
+        const vislib::sys::File::FileSize remaining = this->fileSize - blockStart;
+        const size_t blockSize = static_cast<size_t>((remaining < SCAN_BLOCK_SIZE) ? remaining : SCAN_BLOCK_SIZE);
+        block.resize(blockSize + 1);
+        this->file->Seek(blockStart);
+        size_t size = static_cast<size_t>(this->file->Read(block.data(), blockSize));
+        if (size == 0) break;
+        if (blockStart + size < this->fileSize) {
+            size_t lineEnd = size;
+            while ((lineEnd > 0) && (block[lineEnd - 1] != '\n')) --lineEnd;
+            if (lineEnd > 0) size = lineEnd;
+        }
+        block[size] = 0;
+
+        // the positions of the lines following 'time index' lines, per chunk
+        const auto chunkRanges = text::SplitChunks(block.data(), size);
+        std::vector<std::vector<size_t>> indices(chunkRanges.size());
+        text::ParseChunks(block.data(), chunkRanges, [&](size_t i, const char *begin, const char *end) {
+            for (const char *line = begin; line < end;) {
+                const char *lineEnd = text::LineEnd(line, end);
+                const char *p = text::SkipBlanks(line);
+                if (((*p == 't') || (*p == 'T')) && (lineEnd - p >= 10)) {
+                    const char *token;
+                    size_t len = text::NextToken(p, token);
+                    if (text::TokenEquals(token, len, "time")) {
+                        len = text::NextToken(p, token);
+                        if (text::TokenEquals(token, len, "index")) {
+                            indices[i].push_back(static_cast<size_t>(lineEnd + 1 - block.data()));
+                        }
+                    }
+                }
+                line = lineEnd + 1;
+            }
+        });
+        for (const auto &chunk : indices) {
+            for (const auto idx : chunk) {
+                this->frameIdx.Append(blockStart + idx);
+            }
+        }
+
+        blockStart += size;
+        cpb.Set(static_cast<vislib::sys::ConsoleProgressBar::Size>(blockStart));
+    }
+}
+
+
 /*
  * io::VTFDataSource::getDataCallback
  */
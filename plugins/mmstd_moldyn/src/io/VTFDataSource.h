@@ -17,6 +17,7 @@
 #include "vislib/sys/File.h"
 #include "vislib/Array.h"
 #include "vislib/Map.h"
+#include "vislib/sys/ConsoleProgressBar.h"
 
 
 namespace megamol {
@@ -299,15 +300,18 @@ namespace io {
             void Clear(void);
 
             /**
-             * Loads a frame from 'file' to this object.
+             * Loads a frame from 'file' to this object. The lines of the
+             * frame are parsed in parallel.
              *
-             * @param file The data file.
+             * @param file The data file, positioned at the frame.
              * @param idx The index number of the frame.
+             * @param size The maximum number of bytes of the frame.
              * @param types The types array of the data.
              *
              * @return 'true' on success, 'false' on failure.
              */
-            bool LoadFrame(vislib::sys::File *file, unsigned int idx, vislib::Array<SimpleType> &types);
+            bool LoadFrame(vislib::sys::File *file, unsigned int idx, vislib::sys::File::FileSize size,
+                vislib::Array<SimpleType> &types);
 
             /**
              * Sets the number of types of the data set.
@@ -465,6 +469,14 @@ namespace io {
         /** Builds up the frame index table. */
         void buildFrameTable(void);
 
+        /**
+         * Builds up the frame index table by scanning the rest of the file
+         * for 'time index' lines in parallel.
+         *
+         * @param cpb The progress bar to update.
+         */
+        void scanFrameIndices(vislib::sys::ConsoleProgressBar &cpb);
+
         /** Calculates the bounding box from all frames. */
         void calcBoundingBox(void);
 
@@ -529,6 +541,9 @@ namespace io {
 
 		/* bounding box size */
 		vislib::math::Vector<float, 3> extents;
+
+        /** The size of the opened data file */
+        vislib::sys::File::FileSize fileSize;
     };
 
 } /* end namespace io */
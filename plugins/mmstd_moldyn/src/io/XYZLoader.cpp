@@ -11,11 +11,12 @@
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "vislib/sys/FastFile.h"
-#include "vislib/sys/TextFileReader.h"
-#include "vislib/StringTokeniser.h"
 #include "mmcore/CoreInstance.h"
+#include "io/TextParsing.h"
+#include <algorithm>
+#include <cmath>
 #include <map>
-#include <deque>
+#include <string>
 
 using namespace megamol;
 using namespace megamol::stdplugin::moldyn;
@@ -156,73 +157,110 @@ void io::XYZLoader::assertData(void) {
         GetCoreInstance()->Log().WriteError("Unable to open file \"%s\"", vislib::StringA(filenameSlot.Param<core::param::FilePathParam>()->Value()).PeekBuffer());
         return;
     }
-    vislib::sys::TextFileReader reader(&file);
 
-    size_t partCnt = -1;
-    vislib::StringA l;
+    // read the whole file at once and parse the atom lines in parallel
+    std::vector<char> text(static_cast<size_t>(file.GetSize()) + 1);
+    text.resize(static_cast<size_t>(file.Read(text.data(), text.size() - 1)) + 1);
+    text.back() = 0;
+    file.Close();
+    const char *cur = text.data();
+    const char *textEnd = text.data() + text.size() - 1;
+
     unsigned int lineNum = 0;
 
     if (hasCountLineSlot.Param<core::param::BoolParam>()->Value()) {
         lineNum++;
-        reader.ReadLine(l);
-        try {
-            partCnt = static_cast<size_t>(vislib::CharTraitsA::ParseUInt64(l.PeekBuffer()));
-        } catch (...) {
+        int partCnt = 0;
+        if (text::ParseInt(cur, partCnt) == nullptr) {
             GetCoreInstance()->Log().WriteWarn("Unable to parse atom count from first line in \"%s\"",
                 vislib::StringA(filenameSlot.Param<core::param::FilePathParam>()->Value()).PeekBuffer());
         }
+        cur = std::min(text::LineEnd(cur, textEnd) + 1, textEnd);
     }
 
     if (hasCommentLineSlot.Param<core::param::BoolParam>()->Value()) {
         lineNum++;
-        reader.ReadLine(l); // just skip the second line
+        cur = std::min(text::LineEnd(cur, textEnd) + 1, textEnd); // just skip the second line
     }
 
     bool hasEl = hasElementSymbolSlot.Param<core::param::BoolParam>()->Value();
     bool grpEl = groupByElementSlot.Param<core::param::BoolParam>()->Value();
-    bool warning = true;
-    if (!grpEl) poss.resize(1);
-    std::map<std::string, std::deque<float> > grpDat;
+    const size_t tokenCnt = hasEl ? 4 : 3;
+
+    /** The atoms of a chunk of lines, and its problems by line within the chunk */
+    struct Chunk {
+        std::map<std::string, std::vector<float> > grpDat;
+        std::vector<std::pair<unsigned int, int> > problems; // line, -1 too few, 1 too many tokens, 0 parse error
+        unsigned int lines = 0;
+    };
+    const auto chunkRanges = text::SplitChunks(cur, static_cast<size_t>(textEnd - cur));
+    std::vector<Chunk> chunks(chunkRanges.size());
+
+    text::ParseChunks(cur, chunkRanges, [&](size_t i, const char *begin, const char *end) {
+        Chunk &chunk = chunks[i];
+        std::vector<float> *dat = nullptr;
+        std::string lastEl;
+        for (const char *line = begin; line < end; chunk.lines++) {
+            const char *lineEnd = text::LineEnd(line, end);
+            const char *p = line;
+            const char *token[5];
+            size_t len[5];
+            size_t cnt = 0;
+            while ((cnt < 5) && ((len[cnt] = text::NextToken(p, token[cnt])) > 0)) cnt++;
+            line = lineEnd + 1;
+
+            if (cnt != tokenCnt) {
+                chunk.problems.emplace_back(chunk.lines, (cnt < tokenCnt) ? -1 : 1);
+                if (cnt < tokenCnt) continue;
+            }
+            int o = hasEl ? 1 : 0;
 
-    while (reader.ReadLine(l)) {
-        lineNum++;
-        l.Replace('\t', ' ');
-        vislib::Array<vislib::StringA> parts(vislib::StringTokeniserA::Split(l, ' ', true));
-        if (parts.Count() != (hasEl ? 4 : 3)) {
-            if (warning) {
-                GetCoreInstance()->Log().WriteWarn("Problem parsing \"%s\":",
-                    vislib::StringA(filenameSlot.Param<core::param::FilePathParam>()->Value()).PeekBuffer());
-                warning = false;
+            float x = NAN, y = NAN, z = NAN;
+            if ((text::ParseFloat(token[o + 0], x) == nullptr) || (text::ParseFloat(token[o + 1], y) == nullptr) ||
+                (text::ParseFloat(token[o + 2], z) == nullptr)) {
+                chunk.problems.emplace_back(chunk.lines, 0);
+                continue;
             }
+
+            std::string el = (hasEl && grpEl) ? std::string(token[0], len[0]) : "";
+            if ((dat == nullptr) || (el != lastEl)) {
+                dat = &chunk.grpDat[el];
+                lastEl = el;
+            }
+            dat->push_back(x);
+            dat->push_back(y);
+            dat->push_back(z);
         }
-        if (parts.Count() < (hasEl ? 4 : 3)) {
-            GetCoreInstance()->Log().WriteError("Line %u has too few tokens; line will be ignored", lineNum);
-            continue;
-        }
-        if (parts.Count() > (hasEl ? 4 : 3)) {
-            GetCoreInstance()->Log().WriteWarn("Line %u has too many tokens; trailing tokens will be ignored", lineNum);
-        }
-        std::string el = (hasEl && grpEl) ? parts[0].PeekBuffer() : "";
-        int o = hasEl ? 1 : 0;
-
-        float x = NAN, y = NAN, z = NAN;
-        try {
-            x = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 0]));
-            y = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 1]));
-            z = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 2]));
-        } catch (...) {
+    });
+
+    // merge the chunks in order, and report their problems
+    bool warning = true;
+    std::map<std::string, std::vector<float> > grpDat;
+    for (auto &chunk : chunks) {
+        for (const auto &problem : chunk.problems) {
             if (warning) {
                 GetCoreInstance()->Log().WriteWarn("Problem parsing \"%s\":",
                     vislib::StringA(filenameSlot.Param<core::param::FilePathParam>()->Value()).PeekBuffer());
                 warning = false;
             }
-            GetCoreInstance()->Log().WriteError("Failed to parse coordinates at line %u: (%f, %f, %f); line will be ignored", lineNum, x, y, z);
-            continue;
+            const unsigned int l = lineNum + problem.first + 1;
+            if (problem.second < 0) {
+                GetCoreInstance()->Log().WriteError("Line %u has too few tokens; line will be ignored", l);
+            } else if (problem.second > 0) {
+                GetCoreInstance()->Log().WriteWarn("Line %u has too many tokens; trailing tokens will be ignored", l);
+            } else {
+                GetCoreInstance()->Log().WriteError("Failed to parse coordinates at line %u; line will be ignored", l);
+            }
+        }
+        lineNum += chunk.lines;
+        for (auto &g : chunk.grpDat) {
+            auto &dst = grpDat[g.first];
+            if (dst.empty()) {
+                dst.swap(g.second);
+            } else {
+                dst.insert(dst.end(), g.second.begin(), g.second.end());
+            }
         }
-
-        grpDat[el].push_back(x);
-        grpDat[el].push_back(y);
-        grpDat[el].push_back(z);
     }
 
     poss.clear();
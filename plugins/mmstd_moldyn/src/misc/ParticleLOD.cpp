@@ -0,0 +1,191 @@
+/*
+ * ParticleLOD.cpp
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+
+#include "misc/ParticleLOD.h"
+
+#include "vislib/assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+
+using namespace megamol::stdplugin::moldyn::misc;
+using megamol::core::moldyn::SimpleSphericalParticles;
+
+
+/** Highest level of the hierarchy, limiting the grid to 1024^3 cells */
+#define PARTICLELOD_MAX_LEVEL 10
+
+/** Number of particles per cell of uniformly distributed data at the finest level */
+#define PARTICLELOD_PARTICLES_PER_CELL 8.0
+
+
+ParticleLOD::ParticleLOD() : levels(), colourType(SimpleSphericalParticles::COLDATA_NONE), stride(4) {}
+
+
+ParticleLOD::~ParticleLOD() { this->Clear(); }
+
+
+void ParticleLOD::Build(const SimpleSphericalParticles& parts, const vislib::math::Cuboid<float>& bbox) {
+
+    this->Clear();
+
+    const UINT64 count = parts.GetCount();
+    if (count == 0) return;
+
+    // Aggregate indices to a single intensity, and everything else to normalised RGBA
+    float colourScale = 1.0f;
+    bool hasAlpha = true;
+    switch (parts.GetColourDataType()) {
+    case SimpleSphericalParticles::COLDATA_NONE:
+        this->colourType = SimpleSphericalParticles::COLDATA_NONE;
+        this->stride = 4;
+        break;
+    case SimpleSphericalParticles::COLDATA_FLOAT_I:
+    case SimpleSphericalParticles::COLDATA_DOUBLE_I:
+        this->colourType = SimpleSphericalParticles::COLDATA_FLOAT_I;
+        this->stride = 5;
+        break;
+    default:
+        this->colourType = SimpleSphericalParticles::COLDATA_FLOAT_RGBA;
+        this->stride = 8;
+        if (parts.GetColourDataType() == SimpleSphericalParticles::COLDATA_UINT8_RGB ||
+            parts.GetColourDataType() == SimpleSphericalParticles::COLDATA_UINT8_RGBA) {
+            colourScale = 1.0f / 255.0f;
+        } else if (parts.GetColourDataType() == SimpleSphericalParticles::COLDATA_USHORT_RGBA) {
+            colourScale = 1.0f / 65535.0f;
+        }
+        hasAlpha = (parts.GetColourDataType() != SimpleSphericalParticles::COLDATA_UINT8_RGB &&
+                    parts.GetColourDataType() != SimpleSphericalParticles::COLDATA_FLOAT_RGB);
+        break;
+    }
+    const unsigned int numColours = this->stride - 4;
+
+    struct Cell {
+        double pos[3] = {0.0, 0.0, 0.0};
+        double volume = 0.0;
+        double col[4] = {0.0, 0.0, 0.0, 0.0};
+        UINT64 count = 0;
+    };
+
+    const unsigned int finest = GetLevelCount(count) - 1;
+    const unsigned int resolution = 1u << finest;
+    const float edge = std::max(bbox.Width(), std::max(bbox.Height(), bbox.Depth()));
+    const float scale = (edge > 0.0f) ? static_cast<float>(resolution) / edge : 0.0f;
+
+    auto makeKey = [](UINT64 x, UINT64 y, UINT64 z) { return x | (y << 21) | (z << 42); };
+    auto cellIndex = [resolution, scale](float v, float origin) {
+        return static_cast<UINT64>(std::min(std::max((v - origin) * scale, 0.0f), static_cast<float>(resolution - 1)));
+    };
+
+    // Finest level from the particles
+    const auto& store = parts.GetParticleStore();
+    std::unordered_map<UINT64, Cell> cells;
+    cells.reserve(static_cast<size_t>(std::min<UINT64>(count, static_cast<UINT64>(resolution) * resolution * resolution)));
+
+    for (UINT64 i = 0; i < count; ++i) {
+        const float x = store.GetXAcc()->Get_f(i);
+        const float y = store.GetYAcc()->Get_f(i);
+        const float z = store.GetZAcc()->Get_f(i);
+        const float r = store.GetRAcc()->Get_f(i);
+
+        Cell& cell = cells[makeKey(cellIndex(x, bbox.Left()), cellIndex(y, bbox.Bottom()), cellIndex(z, bbox.Back()))];
+        cell.pos[0] += x;
+        cell.pos[1] += y;
+        cell.pos[2] += z;
+        cell.volume += static_cast<double>(r) * r * r;
+        if (numColours == 1) {
+            cell.col[0] += store.GetCRAcc()->Get_f(i);
+        } else if (numColours == 4) {
+            cell.col[0] += store.GetCRAcc()->Get_f(i) * colourScale;
+            cell.col[1] += store.GetCGAcc()->Get_f(i) * colourScale;
+            cell.col[2] += store.GetCBAcc()->Get_f(i) * colourScale;
+            cell.col[3] += hasAlpha ? store.GetCAAcc()->Get_f(i) * colourScale : 1.0f;
+        }
+        cell.count++;
+    }
+
+    // Write each level and merge its cells into the next coarser one
+    this->levels.resize(finest + 1);
+    for (unsigned int level = finest + 1; level-- > 0;) {
+        Level& out = this->levels[level];
+        out.count = cells.size();
+        out.data.resize(static_cast<size_t>(out.count) * this->stride);
+
+        const double maxRadius = 0.5 * std::sqrt(3.0) * GetCellSize(bbox, level);
+        float* dst = out.data.data();
+        for (const auto& c : cells) {
+            const double n = static_cast<double>(c.second.count);
+            dst[0] = static_cast<float>(c.second.pos[0] / n);
+            dst[1] = static_cast<float>(c.second.pos[1] / n);
+            dst[2] = static_cast<float>(c.second.pos[2] / n);
+            dst[3] = static_cast<float>(std::min(std::cbrt(c.second.volume), maxRadius));
+            for (unsigned int k = 0; k < numColours; ++k) {
+                dst[4 + k] = static_cast<float>(c.second.col[k] / n);
+            }
+            dst += this->stride;
+        }
+
+        if (level == 0) break;
+
+        std::unordered_map<UINT64, Cell> parents;
+        parents.reserve(cells.size() / 4 + 1);
+        const UINT64 mask = (1ull << 21) - 1;
+        for (const auto& c : cells) {
+            const UINT64 key = makeKey(
+                (c.first & mask) >> 1, ((c.first >> 21) & mask) >> 1, ((c.first >> 42) & mask) >> 1);
+            Cell& parent = parents[key];
+            for (unsigned int k = 0; k < 3; ++k) parent.pos[k] += c.second.pos[k];
+            for (unsigned int k = 0; k < 4; ++k) parent.col[k] += c.second.col[k];
+            parent.volume += c.second.volume;
+            parent.count += c.second.count;
+        }
+        cells.swap(parents);
+    }
+}
+
+
+void ParticleLOD::Clear() {
+    this->levels.clear();
+    this->levels.shrink_to_fit();
+}
+
+
+unsigned int ParticleLOD::GetLevelCount(UINT64 count) {
+    const double cellsPerEdge = std::cbrt(static_cast<double>(count) / PARTICLELOD_PARTICLES_PER_CELL);
+    const int finest = (cellsPerEdge >= 1.0) ? static_cast<int>(std::floor(std::log2(cellsPerEdge))) : 0;
+    return static_cast<unsigned int>(std::min(finest, PARTICLELOD_MAX_LEVEL)) + 1;
+}
+
+
+float ParticleLOD::GetCellSize(const vislib::math::Cuboid<float>& bbox, unsigned int level) {
+    const float edge = std::max(bbox.Width(), std::max(bbox.Height(), bbox.Depth()));
+    return edge / static_cast<float>(1u << level);
+}
+
+
+void ParticleLOD::GetLevel(
+    unsigned int level, const SimpleSphericalParticles& original, SimpleSphericalParticles& outParts) const {
+    ASSERT(level < this->levels.size());
+
+    const Level& l = this->levels[level];
+    const unsigned char* col = original.GetGlobalColour();
+    const unsigned int bytes = this->stride * sizeof(float);
+
+    outParts.SetCount(l.count);
+    outParts.SetGlobalRadius(original.GetGlobalRadius());
+    outParts.SetGlobalColour(col[0], col[1], col[2], col[3]);
+    outParts.SetColourMapIndexValues(original.GetMinColourIndexValue(), original.GetMaxColourIndexValue());
+    outParts.SetBBox(original.GetBBox());
+    outParts.SetVertexData(SimpleSphericalParticles::VERTDATA_FLOAT_XYZR, l.data.data(), bytes);
+    outParts.SetColourData(this->colourType,
+        (this->colourType == SimpleSphericalParticles::COLDATA_NONE) ? nullptr : l.data.data() + 4, bytes);
+}
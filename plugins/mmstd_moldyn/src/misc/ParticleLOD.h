@@ -0,0 +1,112 @@
+/*
+ * ParticleLOD.h
+ *
+ * Copyright (C) 2019 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMSTD_MOLDYN_PARTICLELOD_H_INCLUDED
+#define MMSTD_MOLDYN_PARTICLELOD_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/moldyn/SimpleSphericalParticles.h"
+
+#include "vislib/math/Cuboid.h"
+
+#include <vector>
+
+
+namespace megamol {
+namespace stdplugin {
+namespace moldyn {
+namespace misc {
+
+    /**
+     * Level-of-detail hierarchy of a particle list.
+     *
+     * Level l aggregates the particles falling into the same cell of a uniform grid with 2^l cells along the
+     * longest edge of the bounding box. Each aggregate has the mean position and colour of its particles and the
+     * radius of a sphere of their total volume, bounded by the cell size. The finest level is chosen such that
+     * the cells of uniformly distributed data contain several particles.
+     */
+    class ParticleLOD {
+
+    public:
+        ParticleLOD();
+        ~ParticleLOD();
+
+        /**
+         * Build the hierarchy, replacing any previous one.
+         *
+         * @param parts  The particles to aggregate.
+         * @param bbox   The bounding box enclosing all particles.
+         */
+        void Build(const core::moldyn::SimpleSphericalParticles& parts, const vislib::math::Cuboid<float>& bbox);
+
+        /** Release all levels. */
+        void Clear();
+
+        /**
+         * Answer whether the hierarchy has been built.
+         *
+         * @return 'True' if there are no levels, 'false' otherwise.
+         */
+        inline bool IsEmpty() const {
+            return this->levels.empty();
+        }
+
+        /**
+         * Answer the number of levels of a hierarchy built for the given number of particles.
+         *
+         * @param count  The number of particles.
+         *
+         * @return The number of levels.
+         */
+        static unsigned int GetLevelCount(UINT64 count);
+
+        /**
+         * Answer the cell size of a level.
+         *
+         * @param bbox   The bounding box enclosing all particles.
+         * @param level  The level.
+         *
+         * @return The edge length of the cells of the level.
+         */
+        static float GetCellSize(const vislib::math::Cuboid<float>& bbox, unsigned int level);
+
+        /**
+         * Expose the aggregates of a level as particle list. The list references the memory of this object.
+         *
+         * @param level     The level, which must be smaller than the number of levels.
+         * @param original  The particle list the hierarchy was built from.
+         * @param outParts  The particle list to receive the aggregates.
+         */
+        void GetLevel(unsigned int level, const core::moldyn::SimpleSphericalParticles& original,
+            core::moldyn::SimpleSphericalParticles& outParts) const;
+
+    private:
+
+        /** Interleaved aggregates of one level */
+        struct Level {
+            std::vector<float> data;
+            UINT64 count;
+        };
+
+        /** The levels, coarsest first */
+        std::vector<Level> levels;
+
+        /** The colour type of the aggregates */
+        core::moldyn::SimpleSphericalParticles::ColourDataType colourType;
+
+        /** The number of floats per aggregate */
+        unsigned int stride;
+    };
+
+} /* end namespace misc */
+} /* end namespace moldyn */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MMSTD_MOLDYN_PARTICLELOD_H_INCLUDED */
@@ -7,6 +7,9 @@
 
 #include "stdafx.h"
 #include "ArrowRenderer.h"
+#include <cstdint>
+#include <cstring>
+#include "PackedColour.h"
 
 
 using namespace megamol::core;
@@ -14,13 +17,29 @@ using namespace megamol::core::moldyn;
 using namespace megamol::stdplugin::moldyn::rendering;
 
 
+namespace {
+
+/** An arrow as read by the instanced shader, see arrow::vertex_instanced */
+struct Glyph {
+    float posRad[4];
+    float dirCol[4];
+};
+
+} // namespace
+
+
 ArrowRenderer::ArrowRenderer(void) : view::Renderer3DModule_2()
     , getDataSlot("getdata", "Connects to the data source")
     , getTFSlot("gettransferfunction", "Connects to the transfer function module")
     , getFlagsSlot("getflags", "connects to a FlagStorage")
     , getClipPlaneSlot("getclipplane", "Connects to a clipping plane module")
     , lengthScaleSlot("lengthScale", ""), lengthFilterSlot("lengthFilter", "Filters the arrows by length")
+    , instancedSlot("instanced", "Draws the arrows as instanced quads read from a shader storage buffer, culling "
+                                 "arrows outside of the view and drawing thin arrows as lines")
+    , lodPixelsSlot("lodPixels", "Width in pixels below which instanced arrows are drawn as lines")
     , arrowShader()
+    , arrowInstancedShader()
+    , instancedAvailable(false)
     , greyTF(0) {
 
     this->getDataSlot.SetCompatibleCall<MultiParticleDataCallDescription>();
@@ -40,6 +59,12 @@ ArrowRenderer::ArrowRenderer(void) : view::Renderer3DModule_2()
     
     this->lengthFilterSlot << new param::FloatParam( 0.0f, 0.0);
     this->MakeSlotAvailable(&this->lengthFilterSlot);
+
+    this->instancedSlot << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->instancedSlot);
+
+    this->lodPixelsSlot << new param::FloatParam(1.0f, 0.0f);
+    this->MakeSlotAvailable(&this->lodPixelsSlot);
 }
 
 
@@ -87,6 +112,27 @@ bool ArrowRenderer::create(void) {
         return false;
     }
 
+    // the instanced path is optional, point sprites are drawn without it
+    this->instancedAvailable = false;
+    if ((isExtAvailable("GL_ARB_shader_storage_buffer_object") != GL_FALSE) &&
+        (isExtAvailable("GL_ARB_buffer_storage") != GL_FALSE)) {
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("arrow::vertex_instanced", vert) ||
+            !instance()->ShaderSourceFactory().MakeShaderSource("arrow::fragment_instanced", frag)) {
+            vislib::sys::Log::DefaultLog.WriteWarn("ArrowRenderer: Unable to load the instanced arrow shader\n");
+        } else {
+            try {
+                this->instancedAvailable =
+                    this->arrowInstancedShader.Create(vert.Code(), vert.Count(), frag.Code(), frag.Count());
+            } catch (vislib::Exception e) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    "ArrowRenderer: Unable to compile the instanced arrow shader: %s\n", e.GetMsgA());
+            } catch (...) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    "ArrowRenderer: Unable to compile the instanced arrow shader: Unknown exception\n");
+            }
+        }
+    }
+
     glEnable(GL_TEXTURE_1D);
     glGenTextures(1, &this->greyTF);
     unsigned char tex[6] = {
@@ -126,6 +172,7 @@ bool ArrowRenderer::GetExtents(view::CallRender3D_2& call) {
 void ArrowRenderer::release(void) {
 
     this->arrowShader.Release();
+    this->arrowInstancedShader.Release();
     glDeleteTextures(1, &this->greyTF);
 }
 
@@ -231,22 +278,32 @@ bool ArrowRenderer::Render(view::CallRender3D_2& call) {
     glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
     glPointSize(vislib::math::Max(viewportStuff[2], viewportStuff[3]));
 
-    this->arrowShader.Enable();
-
-    glUniformMatrix4fv(this->arrowShader.ParameterLocation("MVinv"), 1, GL_FALSE, glm::value_ptr(MVinv));
-    glUniformMatrix4fv(this->arrowShader.ParameterLocation("MVtransp"), 1, GL_FALSE, glm::value_ptr(MVtransp));
-    glUniformMatrix4fv(this->arrowShader.ParameterLocation("MVP"), 1, GL_FALSE, glm::value_ptr(MVP));
-    glUniformMatrix4fv(this->arrowShader.ParameterLocation("MVPinv"), 1, GL_FALSE, glm::value_ptr(MVPinv));
-    glUniformMatrix4fv(this->arrowShader.ParameterLocation("MVPtransp"), 1, GL_FALSE, glm::value_ptr(MVPtransp));
-    glUniform4fv(this->arrowShader.ParameterLocation("viewAttr"), 1, glm::value_ptr(viewportStuff));
-    glUniform3fv(this->arrowShader.ParameterLocation("camIn"), 1, glm::value_ptr(cam_view));
-    glUniform3fv(this->arrowShader.ParameterLocation("camRight"), 1, glm::value_ptr(cam_right));
-    glUniform3fv(this->arrowShader.ParameterLocation("camUp"), 1, glm::value_ptr(cam_up));
-    glUniform4fv(this->arrowShader.ParameterLocation("lightDir"), 1, glm::value_ptr(light_dir));
-    this->arrowShader.SetParameter("lengthScale", lengthScale);
-    this->arrowShader.SetParameter("lengthFilter", lengthFilter);
-    glUniform4fv(this->arrowShader.ParameterLocation("clipDat"), 1, clipDat);
-    glUniform3fv(this->arrowShader.ParameterLocation("clipCol"), 1, clipCol);
+    bool useInstanced = this->instancedSlot.Param<param::BoolParam>()->Value();
+    if (useInstanced && !this->instancedAvailable) {
+        vislib::sys::Log::DefaultLog.WriteWarn(
+            "ArrowRenderer: Instanced arrows are not available, drawing point sprites instead");
+        this->instancedSlot.Param<param::BoolParam>()->SetValue(false);
+        useInstanced = false;
+    }
+    auto& shader = useInstanced ? this->arrowInstancedShader : this->arrowShader;
+
+    shader.Enable();
+
+    glUniformMatrix4fv(shader.ParameterLocation("MVinv"), 1, GL_FALSE, glm::value_ptr(MVinv));
+    glUniformMatrix4fv(shader.ParameterLocation("MVtransp"), 1, GL_FALSE, glm::value_ptr(MVtransp));
+    glUniformMatrix4fv(shader.ParameterLocation("MVP"), 1, GL_FALSE, glm::value_ptr(MVP));
+    glUniformMatrix4fv(shader.ParameterLocation("MVPinv"), 1, GL_FALSE, glm::value_ptr(MVPinv));
+    glUniformMatrix4fv(shader.ParameterLocation("MVPtransp"), 1, GL_FALSE, glm::value_ptr(MVPtransp));
+    glUniform4fv(shader.ParameterLocation("viewAttr"), 1, glm::value_ptr(viewportStuff));
+    glUniform3fv(shader.ParameterLocation("camIn"), 1, glm::value_ptr(cam_view));
+    glUniform3fv(shader.ParameterLocation("camRight"), 1, glm::value_ptr(cam_right));
+    glUniform3fv(shader.ParameterLocation("camUp"), 1, glm::value_ptr(cam_up));
+    glUniform4fv(shader.ParameterLocation("lightDir"), 1, glm::value_ptr(light_dir));
+    shader.SetParameter("lengthScale", lengthScale);
+    shader.SetParameter("lengthFilter", lengthFilter);
+    glUniform4fv(shader.ParameterLocation("clipDat"), 1, clipDat);
+    glUniform3fv(shader.ParameterLocation("clipCol"), 1, clipCol);
+    shader.SetParameter("lodPixels", this->lodPixelsSlot.Param<param::FloatParam>()->Value());
 
     if (c2 != nullptr) {
         unsigned int cial = glGetAttribLocationARB(this->arrowShader, "colIdx");
@@ -264,6 +321,10 @@ bool ArrowRenderer::Render(view::CallRender3D_2& call) {
 
         for (unsigned int i = 0; i < c2->GetParticleListCount(); i++) {
             MultiParticleDataCall::Particles &parts = c2->AccessParticles(i);
+            if (useInstanced) {
+                this->drawInstanced(parts, useFlags ? cflags : nullptr);
+                continue;
+            }
             float minC = 0.0f, maxC = 0.0f;
             unsigned int colTabSize = 0;
 
@@ -394,10 +455,140 @@ bool ArrowRenderer::Render(view::CallRender3D_2& call) {
 
     }
 
-    this->arrowShader.Disable();
+    shader.Disable();
 
     glDisable(GL_DEPTH_TEST);
     glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
     return true;
 }
+
+
+bool ArrowRenderer::drawInstanced(MultiParticleDataCall::Particles& parts, FlagCall* flags) {
+
+    if (parts.GetDirDataType() != MultiParticleDataCall::Particles::DIRDATA_FLOAT_XYZ) {
+        vislib::sys::Log::DefaultLog.WriteWarn("ArrowRenderer: cannot render arrows without directional data!");
+        return false;
+    }
+    const auto vertType = parts.GetVertexDataType();
+    if ((vertType != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ) &&
+        (vertType != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) &&
+        (vertType != MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ)) {
+        return false;
+    }
+    if (parts.GetCount() == 0) {
+        return true;
+    }
+
+    // colour
+    const auto colType = parts.GetColourDataType();
+    int colourMode = 1;
+    float minC = 0.0f, maxC = 0.0f;
+    unsigned int colTabSize = 0;
+    switch (colType) {
+    case MultiParticleDataCall::Particles::COLDATA_NONE:
+        colourMode = 0;
+        glUniform4f(this->arrowInstancedShader.ParameterLocation("globalCol"), parts.GetGlobalColour()[0] / 255.0f,
+            parts.GetGlobalColour()[1] / 255.0f, parts.GetGlobalColour()[2] / 255.0f, 1.0f);
+        break;
+    case MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
+    case MultiParticleDataCall::Particles::COLDATA_DOUBLE_I: {
+        colourMode = 2;
+        glEnable(GL_TEXTURE_1D);
+        view::CallGetTransferFunction* cgtf = this->getTFSlot.CallAs<view::CallGetTransferFunction>();
+        if ((cgtf != nullptr) && ((*cgtf)())) {
+            glBindTexture(GL_TEXTURE_1D, cgtf->OpenGLTexture());
+            colTabSize = cgtf->TextureSize();
+        } else {
+            glBindTexture(GL_TEXTURE_1D, this->greyTF);
+            colTabSize = 2;
+        }
+        glUniform1i(this->arrowInstancedShader.ParameterLocation("colTab"), 0);
+        minC = parts.GetMinColourIndexValue();
+        maxC = parts.GetMaxColourIndexValue();
+    } break;
+    default:
+        break;
+    }
+    glUniform1i(this->arrowInstancedShader.ParameterLocation("colourMode"), colourMode);
+    glUniform4f(this->arrowInstancedShader.ParameterLocation("inConsts1"), parts.GetGlobalRadius(), minC, maxC,
+        float(colTabSize));
+
+    // the glyphs are repacked from the separate streams while uploading the positions
+    const auto* vertBase = static_cast<const uint8_t*>(parts.GetVertexData());
+    const auto* dirBase = static_cast<const uint8_t*>(parts.GetDirData());
+    const auto* colBase = static_cast<const uint8_t*>(parts.GetColourData());
+    const size_t vertStride = (parts.GetVertexDataStride() != 0)
+                                  ? parts.GetVertexDataStride()
+                                  : SimpleSphericalParticles::VertexDataSize[vertType];
+    const size_t dirStride = (parts.GetDirDataStride() != 0)
+                                 ? parts.GetDirDataStride()
+                                 : SimpleSphericalParticles::DirDataSize[parts.GetDirDataType()];
+    const size_t colStride = (parts.GetColourDataStride() != 0)
+                                 ? parts.GetColourDataStride()
+                                 : SimpleSphericalParticles::ColorDataSize[colType];
+    const float globalRad = parts.GetGlobalRadius();
+    auto copyOp = [=](void* dst, const void* src) {
+        const size_t idx = (static_cast<const uint8_t*>(src) - vertBase) / vertStride;
+        Glyph& g = *static_cast<Glyph*>(dst);
+        if (vertType == MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ) {
+            double p[3];
+            std::memcpy(p, src, sizeof(p));
+            g.posRad[0] = static_cast<float>(p[0]);
+            g.posRad[1] = static_cast<float>(p[1]);
+            g.posRad[2] = static_cast<float>(p[2]);
+            g.posRad[3] = globalRad;
+        } else if (vertType == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
+            std::memcpy(g.posRad, src, 4 * sizeof(float));
+        } else {
+            std::memcpy(g.posRad, src, 3 * sizeof(float));
+            g.posRad[3] = globalRad;
+        }
+        std::memcpy(g.dirCol, dirBase + idx * dirStride, 3 * sizeof(float));
+        const uint8_t* c = (colBase != nullptr) ? (colBase + idx * colStride) : nullptr;
+        if (colType == MultiParticleDataCall::Particles::COLDATA_FLOAT_I) {
+            std::memcpy(&g.dirCol[3], c, sizeof(float));
+        } else if (colType == MultiParticleDataCall::Particles::COLDATA_DOUBLE_I) {
+            double d;
+            std::memcpy(&d, c, sizeof(d));
+            g.dirCol[3] = static_cast<float>(d);
+        } else {
+            const uint32_t packed = (c != nullptr) ? PackColour(c, colType) : 0;
+            std::memcpy(&g.dirCol[3], &packed, sizeof(packed));
+        }
+    };
+
+    std::shared_ptr<FlagStorage::FlagVectorType> flagsData;
+    if (flags != nullptr) {
+        (*flags)(core::FlagCall::CallMapFlags);
+        flags->validateFlagsCount(parts.GetCount());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, flags->GetFlagsBuffer());
+        flagsData = flags->GetFlags();
+    }
+    glUniform1ui(this->arrowInstancedShader.ParameterLocation("flagsAvailable"), (flags != nullptr) ? 1 : 0);
+
+    const GLuint numChunks = this->streamer.SetDataWithSize(vertBase, static_cast<GLuint>(vertStride),
+        sizeof(Glyph), parts.GetCount(), 3, (GLuint)(32 * 1024 * 1024));
+    for (GLuint x = 0; x < numChunks; ++x) {
+        GLuint numItems, sync;
+        GLsizeiptr dstOff, dstLen;
+        this->streamer.UploadChunk(x, numItems, sync, dstOff, dstLen, copyOp);
+        glUniform1ui(this->arrowInstancedShader.ParameterLocation("instanceOffset"),
+            x * this->streamer.GetMaxNumItemsPerChunk());
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, this->streamer.GetHandle(), dstOff, dstLen);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(numItems));
+        this->streamer.SignalCompletion(sync);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    if (flags != nullptr) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+        flags->SetFlags(flagsData);
+        (*flags)(core::FlagCall::CallUnmapFlags);
+    }
+
+    glDisable(GL_TEXTURE_1D);
+
+    return true;
+}
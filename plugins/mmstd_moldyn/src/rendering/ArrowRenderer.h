@@ -14,11 +14,13 @@
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/view/CallClipPlane.h"
 #include "mmcore/view/CallGetTransferFunction.h"
 #include "mmcore/FlagCall.h"
 #include "mmcore/view/CallRender3D_2.h"
 #include "mmcore/view/Renderer3DModule_2.h"
+#include "mmcore/utility/SSBOStreamer.h"
 
 #include "vislib/assert.h"
 #include "vislib/graphics/gl/GLSLShader.h"
@@ -108,6 +110,17 @@ namespace rendering {
 
     private:
 
+        /**
+         * Draws the arrows of a particle list as instanced quads, reading the glyphs from the
+         * streamed shader storage buffer. The uniforms common to both paths must be set already.
+         *
+         * @param parts The particle list
+         * @param flags The flags call, if the flags are to be used
+         *
+         * @return 'true' if the list was drawn, 'false' if it cannot be drawn instanced.
+         */
+        bool drawInstanced(MultiParticleDataCall::Particles& parts, FlagCall* flags);
+
         /** The call for data */
         CallerSlot getDataSlot;
 
@@ -123,6 +136,15 @@ namespace rendering {
         /** The arrow shader */
         vislib::graphics::gl::GLSLShader arrowShader;
 
+        /** The arrow shader drawing instanced quads */
+        vislib::graphics::gl::GLSLShader arrowInstancedShader;
+
+        /** Whether the instanced arrow shader could be built */
+        bool instancedAvailable;
+
+        /** Streams the repacked glyphs to the instanced shader */
+        core::utility::SSBOStreamer streamer;
+
         /** A simple black-to-white transfer function texture as fallback */
         unsigned int greyTF;
         
@@ -132,6 +154,12 @@ namespace rendering {
         /** Length filter for arrow lengths */
         param::ParamSlot lengthFilterSlot;
 
+        /** Whether to draw instanced quads instead of point sprites */
+        param::ParamSlot instancedSlot;
+
+        /** Width in pixels below which instanced arrows are drawn as lines */
+        param::ParamSlot lodPixelsSlot;
+
     };
 
 } /* end namespace rendering */
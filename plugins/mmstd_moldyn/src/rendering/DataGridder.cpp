@@ -7,7 +7,11 @@
 
 #include "stdafx.h"
 #include "DataGridder.h"
+#include <algorithm>
 #include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "rendering/ParticleGridDataCall.h"
 #include "mmcore/param/BoolParam.h"
@@ -15,13 +19,39 @@
 #include "vislib/Array.h"
 #include "vislib/math/Cuboid.h"
 #include "vislib/sys/Log.h"
-#include "vislib/Pair.h"
 #include "vislib/PtrArray.h"
 #include "vislib/RawStorageWriter.h"
 
 using namespace megamol::stdplugin::moldyn::rendering;
 
 
+namespace {
+
+/** Answer the number of threads worth sorting count particles */
+unsigned int chunkCount(SIZE_T count) {
+    const SIZE_T minChunkSize = 1 << 16;
+    const SIZE_T threads = std::max<SIZE_T>(std::thread::hardware_concurrency(), 1);
+    return static_cast<unsigned int>(std::max<SIZE_T>(std::min(threads, count / minChunkSize), 1));
+}
+
+/**
+ * Calls func(chunk, begin, end) for 'chunks' consecutive ranges of [0, count),
+ * each on its own thread.
+ */
+template <class F> void parallelChunks(unsigned int chunks, SIZE_T count, F func) {
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < chunks; t++) {
+        threads.emplace_back([&, t]() { func(t, count * t / chunks, count * (t + 1) / chunks); });
+    }
+    func(0, 0, count / chunks);
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+} // namespace
+
+
 /*
  * DataGridder::DataGridder
  */
@@ -92,15 +122,6 @@ void DataGridder::release(void) {
 }
 
 
-/*
- * DataGridder::doSort
- */
-int DataGridder::doSort(const vislib::Pair<SIZE_T, unsigned int>& lhs,
-        const vislib::Pair<SIZE_T, unsigned int>& rhs) {
-    return lhs.Second() - rhs.Second();
-}
-
-
 /*
  * DataGridder::getData
  */
@@ -167,30 +188,67 @@ bool DataGridder::getData(megamol::core::Call& call) {
             t.SetVertexDataType(p.GetVertexDataType());
         }
 
-        // Generate an index buffer storing for each particle which cell it will be safed in.
-        // array<per-type-count, grid-idx&type>
-        vislib::Array<vislib::Pair<SIZE_T, unsigned int> > indexBuffer;
-        SIZE_T oaCnt = 0; // over-all count
-        for (unsigned int i = 0; i < typeCnt; i++) {
-            oaCnt += static_cast<SIZE_T>(mpdc->AccessParticles(i).GetCount());
+        // data grid setup
+        this->vertData.SetCount(gridSize * typeCnt);
+        this->colData.SetCount(gridSize * typeCnt);
+        for (unsigned int j = 0; j < gridSize; j++) {
+            this->grid[j].AllocateParticleLists(typeCnt);
         }
-        indexBuffer.SetCount(oaCnt);
-        oaCnt = 0;
+
+        // Sort the particles of each type into the cells by a counting sort: count the particles per cell
+        // on several threads, turn the counts into the offsets of each thread in each cell and copy the
+        // particles to their offsets.
+        // DO NOT QUANTIZE HERE! The cell bounding box is not yet valid
+        // Just store floats for now and quantize later on
+        std::vector<unsigned int> cells;
+        std::vector<std::vector<SIZE_T> > offsets;
         for (unsigned int i = 0; i < typeCnt; i++) {
-            auto &p = mpdc->AccessParticles(i);
+            core::moldyn::MultiParticleDataCall::Particles &p = mpdc->AccessParticles(i);
+            const unsigned char *colPtr = static_cast<const unsigned char*>(p.GetColourData());
             const unsigned char *vertPtr = static_cast<const unsigned char*>(p.GetVertexData());
+            unsigned int colSize = 0;
+            unsigned int colStep = p.GetColourDataStride();
+            unsigned int vertSize = 0;
             unsigned int vertStep = p.GetVertexDataStride();
             SIZE_T c = static_cast<SIZE_T>(p.GetCount());
 
+            switch (p.GetColourDataType()) {
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_NONE:
+                    colSize = 0;
+                    break;
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
+                    colSize = 4;
+                    break;
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
+                    colSize = 12;
+                    break;
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
+                    colSize = 16;
+                    break;
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
+                    colSize = 3;
+                    break;
+                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
+                    colSize = 4;
+                    break;
+                default:
+                    colSize = 0;
+                    break;
+            }
+            if (colStep < colSize) {
+                colStep = colSize;
+            }
+
             switch (p.GetVertexDataType()) {
                 case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                    continue; // done with that type already!
+                    c = 0;
+                    break;
 
                 case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                    vertStep = vislib::math::Max(vertStep, 12U);
+                    vertSize = 12;
                     break;
                 case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                    vertStep = vislib::math::Max(vertStep, 16U);
+                    vertSize = 16;
                     break;
 
                 case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
@@ -200,107 +258,62 @@ bool DataGridder::getData(megamol::core::Call& call) {
                     throw vislib::Exception("Internal Error\n", __FILE__, __LINE__);
                     break;
             }
-
-            for (SIZE_T j = 0; j < c; j++, oaCnt++, vertPtr += vertStep) {
-                const float *v = reinterpret_cast<const float*>(vertPtr);
-
-                int x = static_cast<int>((v[0] - bbox.Left()) * static_cast<float>(this->gridSizeX) / bbox.Width());
-                if (x < 0) x = 0; else if (static_cast<unsigned int>(x) >= this->gridSizeX) x = this->gridSizeX - 1;
-                int y = static_cast<int>((v[1] - bbox.Bottom()) * static_cast<float>(this->gridSizeY) / bbox.Height());
-                if (y < 0) y = 0; else if (static_cast<unsigned int>(y) >= this->gridSizeY) y = this->gridSizeY - 1;
-                int z = static_cast<int>((v[2] - bbox.Back()) * static_cast<float>(this->gridSizeZ) / bbox.Depth());
-                if (z < 0) z = 0; else if (static_cast<unsigned int>(z) >= this->gridSizeZ) z = this->gridSizeZ - 1;
-
-                indexBuffer[oaCnt].First() = j;
-                indexBuffer[oaCnt].Second() = (x + (y + z * this->gridSizeY) * this->gridSizeX) * typeCnt + i;
+            if (vertStep < vertSize) {
+                vertStep = vertSize;
             }
-        }
-        ASSERT(indexBuffer.Count() == oaCnt);
-        // sort that all particles for each cell are in succession
-        indexBuffer.Sort(&DataGridder::doSort);
-
-        // data grid setup
-        this->vertData.SetCount(gridSize * typeCnt);
-        this->colData.SetCount(gridSize * typeCnt);
 
-        // copy data to grid cells
-        // DO NOT QUANTIZE HERE! The cell bounding box is not yet valid
-        // Just store floats for now and quantize later on
-        SIZE_T start = 0, pos = 0, cnt = indexBuffer.Count();
-        for (unsigned int j = 0; j < gridSize; j++) {
-            for (unsigned int i = 0; i < typeCnt; i++) {
-                core::moldyn::MultiParticleDataCall::Particles &p = mpdc->AccessParticles(i);
-                const unsigned char *colPtr = static_cast<const unsigned char*>(p.GetColourData());
-                const unsigned char *vertPtr = static_cast<const unsigned char*>(p.GetVertexData());
-                unsigned int colSize = 0;
-                unsigned int colStep = p.GetColourDataStride();
-                unsigned int vertSize = 0;
-                unsigned int vertStep = p.GetVertexDataStride();
-                unsigned int ij = j * typeCnt + i;
-
-                switch (p.GetColourDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_NONE:
-                        colSize = 0;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
-                        colSize = 4;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                        colSize = 12;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                        colSize = 16;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                        colSize = 3;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                        colSize = 4;
-                        break;
-                    default:
-                        colSize = 0;
-                        break;
+            // histogram of the cells per thread
+            const unsigned int chunks = chunkCount(c);
+            cells.resize(c);
+            offsets.assign(chunks, std::vector<SIZE_T>(gridSize, 0));
+            parallelChunks(chunks, c, [&](unsigned int t, SIZE_T begin, SIZE_T end) {
+                std::vector<SIZE_T> &counts = offsets[t];
+                for (SIZE_T j = begin; j < end; j++) {
+                    const float *v = reinterpret_cast<const float*>(vertPtr + j * vertStep);
+
+                    int x = static_cast<int>((v[0] - bbox.Left()) * static_cast<float>(this->gridSizeX) / bbox.Width());
+                    if (x < 0) x = 0; else if (static_cast<unsigned int>(x) >= this->gridSizeX) x = this->gridSizeX - 1;
+                    int y = static_cast<int>(
+                        (v[1] - bbox.Bottom()) * static_cast<float>(this->gridSizeY) / bbox.Height());
+                    if (y < 0) y = 0; else if (static_cast<unsigned int>(y) >= this->gridSizeY) y = this->gridSizeY - 1;
+                    int z = static_cast<int>((v[2] - bbox.Back()) * static_cast<float>(this->gridSizeZ) / bbox.Depth());
+                    if (z < 0) z = 0; else if (static_cast<unsigned int>(z) >= this->gridSizeZ) z = this->gridSizeZ - 1;
+
+                    cells[j] = x + (y + z * this->gridSizeY) * this->gridSizeX;
+                    counts[cells[j]]++;
                 }
-                if (colStep < colSize) {
-                    colStep = colSize;
+            });
+
+            // prefix sum over the threads per cell, which also sizes the cells
+            for (unsigned int j = 0; j < gridSize; j++) {
+                SIZE_T sum = 0;
+                for (unsigned int t = 0; t < chunks; t++) {
+                    const SIZE_T n = offsets[t][j];
+                    offsets[t][j] = sum;
+                    sum += n;
                 }
+                unsigned int ij = j * typeCnt + i;
+                this->grid[j].AccessParticleLists()[i].SetCount(sum);
+                this->vertData[ij].EnforceSize(sum * vertSize);
+                this->colData[ij].EnforceSize(sum * colSize);
+            }
 
-                switch (p.GetVertexDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                        continue; // done with that type already!
-
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                        vertSize = 12;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                        vertSize = 16;
-                        break;
-
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-                    default:
-                        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-                            "Internal Error at %s[%d]\n", __FILE__, __LINE__);
-                        throw vislib::Exception("Internal Error\n", __FILE__, __LINE__);
-                        break;
-                }
-                if (vertStep < vertSize) {
-                    vertStep = vertSize;
+            // scatter the particles into the cells, keeping their order
+            parallelChunks(chunks, c, [&](unsigned int t, SIZE_T begin, SIZE_T end) {
+                std::vector<SIZE_T> &next = offsets[t];
+                for (SIZE_T j = begin; j < end; j++) {
+                    unsigned int ij = cells[j] * typeCnt + i;
+                    SIZE_T k = next[cells[j]]++;
+                    ::memcpy(this->vertData[ij].At(k * vertSize), vertPtr + j * vertStep, vertSize);
+                    if (colSize > 0) {
+                        ::memcpy(this->colData[ij].At(k * colSize), colPtr + j * colStep, colSize);
+                    }
                 }
+            });
 
-                ASSERT(start == pos);
-                for (; (pos < cnt) && (indexBuffer[pos].Second() == ij); pos++) ;
-
-                if (i == 0) {
-                    this->grid[j].AllocateParticleLists(typeCnt);
-                }
+            for (unsigned int j = 0; j < gridSize; j++) {
+                unsigned int ij = j * typeCnt + i;
                 ParticleGridDataCall::Particles& parts = this->grid[j].AccessParticleLists()[i];
-                parts.SetCount(pos - start);
-                this->vertData[ij].EnforceSize((pos - start) * vertSize);
-                this->colData[ij].EnforceSize((pos - start) * colSize);
-                for (SIZE_T k = 0; start < pos; k++, start++) {
-                    ::memcpy(this->vertData[ij].At(k * vertSize), vertPtr + (indexBuffer[start].First() * vertStep), vertSize);
-                    ::memcpy(this->colData[ij].At(k * colSize), colPtr + (indexBuffer[start].First() * colStep), colSize);
-                }
                 float maxRad = 0.0f;
                 if (vertSize == 12) {
                     maxRad = this->types[i].GetGlobalRadius();
@@ -317,7 +330,8 @@ bool DataGridder::getData(megamol::core::Call& call) {
                 parts.SetVertexData(this->vertData[ij]);
             }
         }
-        ASSERT(indexBuffer.Count() == pos);
+        cells.clear();
+        offsets.clear();
 
         // calc grid bounding boxes
         for (unsigned int i = 0; i < gridSize; i++) {
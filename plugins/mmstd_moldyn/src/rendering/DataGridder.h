@@ -18,7 +18,6 @@
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "ParticleGridDataCall.h"
 #include "vislib/Array.h"
-#include "vislib/Pair.h"
 #include "vislib/RawStorage.h"
 #include "vislib/types.h"
 
@@ -93,12 +92,6 @@ protected:
 
 private:
 
-    /**
-     * TODO: Document
-     */
-    static int doSort(const vislib::Pair<SIZE_T, unsigned int> &lhs,
-        const vislib::Pair<SIZE_T, unsigned int> &rhs);
-
     /**
      * Callback publishing the gridded data
      *
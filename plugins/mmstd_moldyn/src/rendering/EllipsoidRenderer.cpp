@@ -8,6 +8,8 @@
 #include "stdafx.h"
 #include "EllipsoidRenderer.h"
 #include "mmcore/CoreInstance.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "mmcore/view/CallGetTransferFunction.h"
 #include "mmcore/utility/ShaderSourceFactory.h"
 #include "vislib/assert.h"
@@ -19,6 +21,7 @@
 #include <iostream>
 #include <cstring>
 #include <GL/glu.h>
+#include "PackedColour.h"
 
 
 using namespace megamol;
@@ -27,11 +30,32 @@ using namespace megamol::stdplugin;
 using namespace megamol::stdplugin::moldyn;
 using namespace megamol::stdplugin::moldyn::rendering;
 
+namespace {
+
+/** An ellipsoid as read by the instanced shader, see ellipsoid::vertex_instanced */
+struct Glyph {
+	float posCol[4];
+	float radii[4];
+	float quat[4];
+};
+
+} // namespace
+
 EllipsoidRenderer::EllipsoidRenderer(void) : Renderer3DModule(),
-getDataSlot("getData", "The slot to fetch the ellipsoidal data"){
+getDataSlot("getData", "The slot to fetch the ellipsoidal data"),
+instancedSlot("instanced", "Draws the ellipsoids as instanced quads read from a shader storage buffer, culling "
+	"ellipsoids outside of the view and drawing tiny ellipsoids as single pixels"),
+lodPixelsSlot("lodPixels", "Size in pixels below which instanced ellipsoids are drawn as single pixels"),
+instancedAvailable(false) {
 
 	this->getDataSlot.SetCompatibleCall<core::moldyn::EllipsoidalParticleDataCallDescription>();
 	this->MakeSlotAvailable(&this->getDataSlot);
+
+	this->instancedSlot << new core::param::BoolParam(false);
+	this->MakeSlotAvailable(&this->instancedSlot);
+
+	this->lodPixelsSlot << new core::param::FloatParam(1.0f, 0.0f);
+	this->MakeSlotAvailable(&this->lodPixelsSlot);
 }
 EllipsoidRenderer::~EllipsoidRenderer(void) {
 	this->Release();
@@ -90,6 +114,27 @@ bool EllipsoidRenderer::create(void){
 		return false;
 	}
 
+	// the instanced path is optional, point sprites are drawn without it
+	this->instancedAvailable = false;
+	if ((isExtAvailable("GL_ARB_shader_storage_buffer_object") != GL_FALSE) &&
+		(isExtAvailable("GL_ARB_buffer_storage") != GL_FALSE)) {
+		if (!this->GetCoreInstance()->ShaderSourceFactory().MakeShaderSource("ellipsoid::vertex_instanced", vertSrc) ||
+			!this->GetCoreInstance()->ShaderSourceFactory().MakeShaderSource("ellipsoid::fragment_instanced", fragSrc)) {
+			Log::DefaultLog.WriteWarn("EllipsoidRenderer: unable to load the instanced ellipsoid shader\n");
+		} else {
+			try {
+				this->instancedAvailable = this->ellipsoidInstancedShader.Create(
+					vertSrc.Code(), vertSrc.Count(), fragSrc.Code(), fragSrc.Count());
+			} catch (vislib::Exception e) {
+				Log::DefaultLog.WriteWarn(
+					"EllipsoidRenderer: unable to compile the instanced ellipsoid shader: %s\n", e.GetMsgA());
+			} catch (...) {
+				Log::DefaultLog.WriteWarn(
+					"EllipsoidRenderer: unable to compile the instanced ellipsoid shader: unknown exception\n");
+			}
+		}
+	}
+
 	return true;
 
 }
@@ -124,7 +169,7 @@ bool EllipsoidRenderer::GetExtents(Call& call) {
 }
 void EllipsoidRenderer::release(void) {
 	this->ellipsoidShader.Release();
-
+	this->ellipsoidInstancedShader.Release();
 }
 bool EllipsoidRenderer::Render(Call& call){
 	view::CallRender3D *cr = dynamic_cast<view::CallRender3D*>(&call);
@@ -172,12 +217,32 @@ bool EllipsoidRenderer::Render(Call& call){
 	viewportStuff[2] = 2.0f / viewportStuff[2];
 	viewportStuff[3] = 2.0f / viewportStuff[3];
 
-	this->ellipsoidShader.Enable();
+	bool useInstanced = this->instancedSlot.Param<core::param::BoolParam>()->Value();
+	if (useInstanced && !this->instancedAvailable) {
+		vislib::sys::Log::DefaultLog.WriteWarn(
+			"EllipsoidRenderer: instanced ellipsoids are not available, drawing point sprites instead");
+		this->instancedSlot.Param<core::param::BoolParam>()->SetValue(false);
+		useInstanced = false;
+	}
+	auto& shader = useInstanced ? this->ellipsoidInstancedShader : this->ellipsoidShader;
+
+	shader.Enable();
+
+	glUniform4fvARB(shader.ParameterLocation("viewAttr"), 1, viewportStuff);
+	glUniform3fvARB(shader.ParameterLocation("camIn"), 1, cameraInfo->Front().PeekComponents());
+	glUniform3fvARB(shader.ParameterLocation("camRight"), 1, cameraInfo->Right().PeekComponents());
+	glUniform3fvARB(shader.ParameterLocation("camUp"), 1, cameraInfo->Up().PeekComponents());
 
-	glUniform4fvARB(this->ellipsoidShader.ParameterLocation("viewAttr"), 1, viewportStuff);
-	glUniform3fvARB(this->ellipsoidShader.ParameterLocation("camIn"), 1, cameraInfo->Front().PeekComponents());
-	glUniform3fvARB(this->ellipsoidShader.ParameterLocation("camRight"), 1, cameraInfo->Right().PeekComponents());
-	glUniform3fvARB(this->ellipsoidShader.ParameterLocation("camUp"), 1, cameraInfo->Up().PeekComponents());
+	if (useInstanced) {
+		shader.SetParameter("lodPixels", this->lodPixelsSlot.Param<core::param::FloatParam>()->Value());
+		for (unsigned int i = 0; i < epdc->GetParticleListCount(); i++) {
+			this->drawInstanced(epdc->AccessParticles(i));
+		}
+		epdc->Unlock();
+		shader.Disable();
+		glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+		return true;
+	}
 
 	unsigned int radiiAttrib = glGetAttribLocationARB(this->ellipsoidShader, "radii");
 	unsigned int quatAttrib = glGetAttribLocationARB(this->ellipsoidShader, "quatC");
@@ -258,4 +323,65 @@ bool EllipsoidRenderer::Render(Call& call){
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+
+bool EllipsoidRenderer::drawInstanced(core::moldyn::EllipsoidalParticleDataCall::Particles& parts) {
+	typedef core::moldyn::SimpleSphericalParticles SSP;
+
+	const auto vertType = parts.GetVertexDataType();
+	if ((parts.GetCount() == 0) || (parts.GetQuatData() == nullptr) || (parts.GetRadiiData() == nullptr) ||
+		((vertType != SSP::VERTDATA_FLOAT_XYZ) && (vertType != SSP::VERTDATA_FLOAT_XYZR) &&
+			(vertType != SSP::VERTDATA_SHORT_XYZ))) {
+		return false;
+	}
+
+	// the glyphs are repacked from the separate streams while uploading the positions
+	const auto colType = parts.GetColourDataType();
+	const auto* vertBase = static_cast<const uint8_t*>(parts.GetVertexData());
+	const auto* colBase = static_cast<const uint8_t*>(parts.GetColourData());
+	const auto* radiiBase = reinterpret_cast<const uint8_t*>(parts.GetRadiiData());
+	const auto* quatBase = reinterpret_cast<const uint8_t*>(parts.GetQuatData());
+	const size_t vertStride = (parts.GetVertexDataStride() != 0) ? parts.GetVertexDataStride()
+		: SSP::VertexDataSize[vertType];
+	const size_t colStride = (parts.GetColourDataStride() != 0) ? parts.GetColourDataStride()
+		: SSP::ColorDataSize[colType];
+	const size_t radiiStride = (parts.GetRadiiDataStride() != 0) ? parts.GetRadiiDataStride() : 3 * sizeof(float);
+	const size_t quatStride = (parts.GetQuatDataStride() != 0) ? parts.GetQuatDataStride() : 4 * sizeof(float);
+	const uint8_t* globalCol = parts.GetGlobalColour();
+	const uint32_t globalPacked = (static_cast<uint32_t>(globalCol[0])) | (static_cast<uint32_t>(globalCol[1]) << 8)
+		| (static_cast<uint32_t>(globalCol[2]) << 16) | (255u << 24);
+	auto copyOp = [=](void* dst, const void* src) {
+		const size_t idx = (static_cast<const uint8_t*>(src) - vertBase) / vertStride;
+		Glyph& g = *static_cast<Glyph*>(dst);
+		if (vertType == SSP::VERTDATA_SHORT_XYZ) {
+			int16_t p[3];
+			std::memcpy(p, src, sizeof(p));
+			g.posCol[0] = static_cast<float>(p[0]);
+			g.posCol[1] = static_cast<float>(p[1]);
+			g.posCol[2] = static_cast<float>(p[2]);
+		} else {
+			std::memcpy(g.posCol, src, 3 * sizeof(float));
+		}
+		const uint32_t packed = (colBase != nullptr) ? PackColour(colBase + idx * colStride, colType) : globalPacked;
+		std::memcpy(&g.posCol[3], &packed, sizeof(packed));
+		std::memcpy(g.radii, radiiBase + idx * radiiStride, 3 * sizeof(float));
+		g.radii[3] = 0.0f;
+		std::memcpy(g.quat, quatBase + idx * quatStride, 4 * sizeof(float));
+	};
+
+	const GLuint numChunks = this->streamer.SetDataWithSize(vertBase, static_cast<GLuint>(vertStride),
+		sizeof(Glyph), parts.GetCount(), 3, (GLuint)(32 * 1024 * 1024));
+	for (GLuint x = 0; x < numChunks; ++x) {
+		GLuint numItems, sync;
+		GLsizeiptr dstOff, dstLen;
+		this->streamer.UploadChunk(x, numItems, sync, dstOff, dstLen, copyOp);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, this->streamer.GetHandle(), dstOff, dstLen);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(numItems));
+		this->streamer.SignalCompletion(sync);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+	return true;
+}
@@ -15,6 +15,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/moldyn/EllipsoidalDataCall.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/utility/SSBOStreamer.h"
 #include "mmcore/view/AbstractCallRender3D.h"
 #include "mmcore/view/CallRender3D.h"
 #include "mmcore/view/Renderer3DModule.h"
@@ -93,12 +94,37 @@ protected:
     virtual bool Render(megamol::core::Call& call);
 
 private:
+    /**
+     * Draws the ellipsoids of a particle list as instanced quads, reading the glyphs from the
+     * streamed shader storage buffer.
+     *
+     * @param parts The particle list
+     *
+     * @return 'true' if the list was drawn, 'false' if it cannot be drawn instanced.
+     */
+    bool drawInstanced(megamol::core::moldyn::EllipsoidalParticleDataCall::Particles& parts);
+
     /**The ellipsoid shader*/
     vislib::graphics::gl::GLSLShader ellipsoidShader;
 
+    /** The ellipsoid shader drawing instanced quads */
+    vislib::graphics::gl::GLSLShader ellipsoidInstancedShader;
+
+    /** Whether the instanced ellipsoid shader could be built */
+    bool instancedAvailable;
+
+    /** Streams the repacked glyphs to the instanced shader */
+    megamol::core::utility::SSBOStreamer streamer;
+
     /** The slot to fetch the data */
     megamol::core::CallerSlot getDataSlot;
 
+    /** Whether to draw instanced quads instead of point sprites */
+    megamol::core::param::ParamSlot instancedSlot;
+
+    /** Size in pixels below which instanced ellipsoids are drawn as single pixels */
+    megamol::core::param::ParamSlot lodPixelsSlot;
+
     // camera information
     vislib::SmartPtr<vislib::graphics::CameraParameters> cameraInfo;
 
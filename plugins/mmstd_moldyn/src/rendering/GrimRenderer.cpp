@@ -7,17 +7,14 @@
 
 #include "stdafx.h"
 #include "GrimRenderer.h"
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
 
 
 using namespace megamol::core;
 using namespace megamol::stdplugin::moldyn::rendering;
 
 
-// #define SPEAK_CELL_USAGE 1
-//#define SPEAK_VRAM_CACHE_USAGE 1
-#define VRAM_UPLOAD_QUOTA 0
-//#define VRAM_UPLOAD_QUOTA 25
-//#define VRAM_UPLOAD_QUOTA 100
 //#define SUPSAMP_LOOP 1
 //#define SUPSAMP_LOOPCNT 1
 //#define SUPSAMP_LOOPCNT 2
@@ -26,6 +23,29 @@ using namespace megamol::stdplugin::moldyn::rendering;
 //#define SUPSAMP_LOOPCNT 64
 
 
+namespace {
+
+/** Answers the address of a byte offset into the bound buffer object */
+inline const GLvoid *bufferOffset(SIZE_T offset) {
+    return reinterpret_cast<const GLvoid *>(offset);
+}
+
+/** Copies 'cnt' elements of 'size' bytes each from 'src' with 'stride' bytes between them */
+void copyStrided(void *dst, const void *src, SIZE_T cnt, SIZE_T size, SIZE_T stride) {
+    if (stride <= size) {
+        ::memcpy(dst, src, cnt * size);
+        return;
+    }
+    unsigned char *d = static_cast<unsigned char *>(dst);
+    const unsigned char *s = static_cast<const unsigned char *>(src);
+    for (SIZE_T i = 0; i < cnt; i++, d += size, s += stride) {
+        ::memcpy(d, s, size);
+    }
+}
+
+} /* end namespace */
+
+
 /****************************************************************************/
 // CellInfo
 
@@ -38,7 +58,6 @@ GrimRenderer::CellInfo::CellInfo(void) {
 GrimRenderer::CellInfo::~CellInfo(void) {
 
     glDeleteOcclusionQueriesNV(1, &this->oQuery);
-    this->cache.clear();
 }
 
 /****************************************************************************/
@@ -47,7 +66,8 @@ GrimRenderer::CellInfo::~CellInfo(void) {
 GrimRenderer::GrimRenderer(void) : view::Renderer3DModule(),
         sphereShader(), vanillaSphereShader(), initDepthShader(),
         initDepthMapShader(), depthMipShader(), pointShader(),
-        initDepthPointShader(), vertCntShader(), vertCntShade2r(), fbo(),
+        initDepthPointShader(), vertCntShader(), vertCntShade2r(), cellCullShader(),
+        gpuCullAvailable(false), fbo(),
         getDataSlot("getdata", "Connects to the data source"),
         getTFSlot("gettransferfunction", "Connects to the transfer function module"),
         useCellCullSlot("useCellCull", "Flag to activate per cell culling"),
@@ -55,9 +75,10 @@ GrimRenderer::GrimRenderer(void) : view::Renderer3DModule(),
         speakCellPercSlot("speakCellPerc", "Flag to activate output of percentage of culled cells"),
         speakVertCountSlot("speakVertCount", "Flag to activate output of number of vertices"),
         deferredShadingSlot("deferredShading", "De-/Activates deferred shading with normal generation"),
-        greyTF(0), cellDists(), cellInfos(0), cacheSize(0), cacheSizeUsed(0),
+        greyTF(0), cellDists(), cellInfos(0), typeInfos(), cellLists(), particleBuffer(0), cellBuffer(0),
+        listBuffer(0), commandBuffer(0), counterBuffer(0), commandsValid(false),
         deferredSphereShader(), deferredVanillaSphereShader(), deferredPointShader(), deferredShader(),
-        inhash(0) {
+        inhash(0), inFrameID(0) {
 
     this->getDataSlot.SetCompatibleCall<ParticleGridDataCallDescription>();
     this->MakeSlotAvailable(&this->getDataSlot);
@@ -80,10 +101,6 @@ GrimRenderer::GrimRenderer(void) : view::Renderer3DModule(),
     this->deferredShadingSlot << new param::BoolParam(true);
     this->MakeSlotAvailable(&this->deferredShadingSlot);
     this->deferredShadingSlot.ForceSetDirty();
-
-    this->cacheSize = 256 * 1024 * 1024; // TODO: Any way to get this better?
-    //this->cacheSize = 256 * 1024; // TODO: Any way to get this better?
-    //this->cacheSize = 1; // TODO: Any way to get this better?
 }
 
 
@@ -240,6 +257,36 @@ bool GrimRenderer::create(void) {
         return false;
     }
 
+    // culling the cells on the GPU avoids reading back the occlusion queries
+    this->gpuCullAvailable = (isExtAvailable("GL_ARB_compute_shader") != GL_FALSE)
+        && (isExtAvailable("GL_ARB_shader_storage_buffer_object") != GL_FALSE)
+        && (isExtAvailable("GL_ARB_indirect_parameters") != GL_FALSE);
+    if (this->gpuCullAvailable) {
+        vislib::graphics::gl::ShaderSource comp;
+        try {
+            if (!instance()->ShaderSourceFactory().MakeShaderSource("grim::cullcells", comp)
+                    || !this->cellCullShader.Compile(comp.Code(), comp.Count())
+                    || !this->cellCullShader.Link()) {
+                throw vislib::Exception("Generic creation failure", __FILE__, __LINE__);
+            }
+        } catch(vislib::Exception e) {
+            vislib::sys::Log::DefaultLog.WriteWarn(
+                "Unable to create cell culling shader, falling back to occlusion queries: %s\n", e.GetMsgA());
+            this->gpuCullAvailable = false;
+        }
+    } else {
+        vislib::sys::Log::DefaultLog.WriteInfo(
+            "GL_ARB_indirect_parameters or compute shaders missing, falling back to occlusion queries\n");
+    }
+
+    glGenBuffers(1, &this->particleBuffer);
+    if (this->gpuCullAvailable) {
+        glGenBuffers(1, &this->cellBuffer);
+        glGenBuffers(1, &this->listBuffer);
+        glGenBuffers(1, &this->commandBuffer);
+        glGenBuffers(1, &this->counterBuffer);
+    }
+
     glEnable(GL_TEXTURE_1D);
     glGenTextures(1, &this->greyTF);
     unsigned char tex[6] = {
@@ -305,6 +352,16 @@ void GrimRenderer::release(void) {
     this->deferredVanillaSphereShader.Release();
     this->deferredPointShader.Release();
     this->deferredShader.Release();
+    this->cellCullShader.Release();
+    this->typeInfos.clear();
+    this->cellLists.clear();
+    GLuint buffers[] = {this->particleBuffer, this->cellBuffer, this->listBuffer,
+        this->commandBuffer, this->counterBuffer};
+    for (GLuint b : buffers) {
+        if (b != 0) glDeleteBuffers(1, &b);
+    }
+    this->particleBuffer = this->cellBuffer = this->listBuffer = this->commandBuffer = this->counterBuffer = 0;
+    this->commandsValid = false;
 }
 
 
@@ -337,8 +394,10 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
         daSphereShader = useVertCull ? &this->deferredSphereShader : &this->deferredVanillaSphereShader;
         daPointShader = &this->deferredPointShader;
     }
-    unsigned int cial = glGetAttribLocationARB(*daSphereShader, "colIdx");
-    unsigned int cial2 = glGetAttribLocationARB(*daPointShader, "colIdx");
+    GLint cial = glGetAttribLocationARB(*daSphereShader, "colIdx");
+    GLint cial2 = glGetAttribLocationARB(*daPointShader, "colIdx");
+    // the query results are read back when counting the vertices anyway
+    bool gpuCull = useCellCull && this->gpuCullAvailable && !speakVertCount;
 
     // ask for extend to calculate the data scaling
     pgdc->SetFrameID(static_cast<unsigned int>(cr->Time()));
@@ -353,24 +412,29 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
     // fetch real data
     pgdc->SetFrameID(static_cast<unsigned int>(cr->Time()));
     if (!(*pgdc)(0)) return false;
-    if (this->inhash != pgdc->DataHash()) {
+    unsigned int cellcnt = pgdc->CellsCount();
+    unsigned int typecnt = pgdc->TypesCount();
+
+    bool upload = (this->inhash != pgdc->DataHash()) || (this->inFrameID != pgdc->FrameID())
+        || (this->typeInfos.size() != typecnt);
+    if (this->cellDists.size() != cellcnt) {
+        this->cellDists.resize(cellcnt);
+        this->cellInfos.resize(cellcnt);
+        for (unsigned int i = 0; i < cellcnt; i++) {
+            this->cellDists[i].First() = i;
+            this->cellInfos[i].wasvisible = true; // TODO: refine with Reina-Approach (wtf?)
+        }
+        upload = true;
+    }
+    if (upload) {
         this->inhash = pgdc->DataHash();
-        // invalidate ALL VBOs
-        SIZE_T cnt = this->cellInfos.size();
-        for (SIZE_T i = 0; i < cnt; i++) {
-            SIZE_T cnt2 = this->cellInfos[i].cache.size();
-            for (SIZE_T j = 0; j < cnt2; j++) {
-                glDeleteBuffersARB(2, this->cellInfos[i].cache[j].data);
-                this->cellInfos[i].cache[j].data[0] = 0;
-                this->cellInfos[i].cache[j].data[1] = 0;
-            }
+        this->inFrameID = pgdc->FrameID();
+        if (!this->uploadParticles(*pgdc, scaling)) {
+            pgdc->Unlock();
+            return false;
         }
-        this->cacheSizeUsed = 0;
     }
 
-    unsigned int cellcnt = pgdc->CellsCount();
-    unsigned int typecnt = pgdc->TypesCount();
-
     ///XXX Use this for new camera usage
     //// Camera 
     //view::Camera_2 cam;
@@ -452,23 +516,6 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
         }
     }
 
-    if (this->cellDists.size() != cellcnt) {
-        this->cellDists.resize(cellcnt);
-        this->cellInfos.resize(cellcnt);
-        for (unsigned int i = 0; i < cellcnt; i++) {
-            this->cellDists[i].First() = i;
-            this->cellInfos[i].wasvisible = true; // TODO: refine with Reina-Approach (wtf?)
-            this->cellInfos[i].maxrad = 0.0f;
-            this->cellInfos[i].cache.clear();
-            this->cellInfos[i].cache.resize(typecnt);
-            for (unsigned int j = 0; j < typecnt; j++) {
-                this->cellInfos[i].maxrad = glm::max(this->cellInfos[i].maxrad,
-                    pgdc->Cells()[i].AccessParticleLists()[j].GetMaxRadius() * scaling);
-            }
-        }
-        this->cacheSizeUsed = 0;
-    }
-
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glLineWidth(5.0f);
@@ -482,38 +529,38 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
     std::vector<CellInfo> &infos = this->cellInfos;
     // The usage of these references is required in order to get performance !!! WTF !!!
 
-    for (unsigned int i = 0; i < cellcnt; i++) {
-        unsigned int idx = dists[i].First();
-        const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[idx];
-        CellInfo& info = infos[idx];
-        const vislib::math::Cuboid<float> &bbox = cell.GetBoundingBox();
+    if (!gpuCull) {
+        // the compute shader classifies the cells itself
+        for (unsigned int i = 0; i < cellcnt; i++) {
+            unsigned int idx = dists[i].First();
+            const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[idx];
+            CellInfo& info = infos[idx];
+            const vislib::math::Cuboid<float> &bbox = cell.GetBoundingBox();
 
-        vislib::math::Point<float, 3> cellPos(
-            (bbox.Left() + bbox.Right()) * 0.5f * scaling,
-            (bbox.Bottom() + bbox.Top()) * 0.5f * scaling,
-            (bbox.Back() + bbox.Front()) * 0.5f * scaling);
+            vislib::math::Point<float, 3> cellPos(
+                (bbox.Left() + bbox.Right()) * 0.5f * scaling,
+                (bbox.Bottom() + bbox.Top()) * 0.5f * scaling,
+                (bbox.Back() + bbox.Front()) * 0.5f * scaling);
 
-        vislib::math::Vector<float, 3> cellDistV = cellPos - cr->GetCameraParameters()->Position();
-        float cellDist = cr->GetCameraParameters()->Front().Dot(cellDistV);
+            vislib::math::Vector<float, 3> cellDistV = cellPos - cr->GetCameraParameters()->Position();
+            float cellDist = cr->GetCameraParameters()->Front().Dot(cellDistV);
 
-        dists[i].Second() = cellDist;
+            dists[i].Second() = cellDist;
 
-        // calculate view size of the max sphere
-        float sphereImgRad = info.maxrad * viewDist / cellDist;
-        info.dots = (sphereImgRad < 0.75f);
+            // calculate view size of the max sphere
+            float sphereImgRad = info.maxrad * viewDist / cellDist;
+            info.dots = (sphereImgRad < 0.75f);
 
-        info.isvisible = true;
-        // Testing against the viewing frustum would be nice, but I don't care
+            info.isvisible = true;
+            // Testing against the viewing frustum would be nice, but I don't care
 
+        }
+        std::sort(dists.begin(), dists.end(), GrimRenderer::depthSort);
     }
-    std::sort(dists.begin(), dists.end(), GrimRenderer::depthSort);
 
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
 
-    // upload to gpu-cache
-    int vramUploadQuota = VRAM_UPLOAD_QUOTA; // upload no more then X VBO per frame
-
     // z-buffer-filling
 #if defined(DEBUG) || defined(_DEBUG)
     UINT oldlevel = vislib::Trace::GetInstance().GetLevel();
@@ -524,166 +571,40 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
 
     glScalef(scaling, scaling, scaling);
 
+    glm::mat4 mvp;
+    if (gpuCull) {
+        GLfloat mv[16], proj[16];
+        glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+        glGetFloatv(GL_PROJECTION_MATRIX, proj);
+        mvp = glm::make_mat4(proj) * glm::make_mat4(mv);
+    }
+
     // initialize depth buffer
+    // With GPU culling the cells visible last frame are the draw commands
+    // written by the last culling pass.
 #ifdef _WIN32
 #pragma region Depthbuffer initialization
 #endif /* _WIN32 */
-#ifdef SPEAK_CELL_USAGE
-    printf("[initd1");
-#endif
     this->initDepthPointShader.Enable();
     glPointSize(1.0f);
-    for (int i = cellcnt - 1; i >= 0; i--) { // front to back
-        unsigned int idx = dists[i].First();
-        const ParticleGridDataCall::GridCell *cell = &pgdc->Cells()[idx];
-        CellInfo &info = infos[idx];
-        if (!info.wasvisible) continue;
-        // only draw cells which were visible last frame
-        if (!info.dots) continue;
-
-#ifdef SPEAK_CELL_USAGE
-        printf("-%d", i);
-#endif
-
-        for (unsigned int j = 0; j < typecnt; j++) {
-            const ParticleGridDataCall::Particles &parts = cell->AccessParticleLists()[j];
-            const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-            CellInfo::CacheItem &ci = info.cache[j];
-            unsigned int vbpp = 1, cbpp = 1;
-            switch (ptype.GetVertexDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                    vbpp = 3 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                    vbpp = 4 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-                    vbpp = 3 * sizeof(short);
-                    break;
-                default:
-                    continue;
-            }
-            switch (ptype.GetColourDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                    cbpp = 3;
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                    cbpp = 4;
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                    cbpp = 3 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                    cbpp = 4 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
-                    cbpp = sizeof(float);
-                    break;
-                default:
-                    break;
-            }
-
-            if ((ci.data[0] == 0) && (vramUploadQuota > 0) && (parts.GetCount() > 0) && (((vbpp + cbpp) * parts.GetCount()) < (this->cacheSize - this->cacheSizeUsed))) {
-                // upload
-                glGetError();
-                glGenBuffersARB(2, ci.data);
-                if (glGetError() != GL_NO_ERROR) {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glGenBuffersARB failed");
-                    throw vislib::Exception("glGenBuffersARB failed", __FILE__, __LINE__);
-                }
-                vramUploadQuota--;
-                glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                glGetError();
-                if (parts.GetVertexDataStride() == 0) {
-                    GLenum err;
-                    glBufferDataARB(GL_ARRAY_BUFFER, vbpp * parts.GetCount(), parts.GetVertexData(), GL_STATIC_DRAW);
-                    if ((err = glGetError()) != GL_NO_ERROR) {
-                        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glBufferDataARB failed: %u", err);
-                        throw vislib::Exception("glBufferDataARB failed", __FILE__, __LINE__);
-                    }
-                } else {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-                        "Currently only data without stride is supported for caching");
-                    throw vislib::Exception("Currently only data without stride is supported for caching", __FILE__, __LINE__);
-                }
-                this->cacheSizeUsed += vbpp * parts.GetCount();
-                glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                if (parts.GetColourDataStride() == 0) {
-                    GLenum err;
-                    glBufferDataARB(GL_ARRAY_BUFFER, cbpp * parts.GetCount(), parts.GetColourData(), GL_STATIC_DRAW);
-                    if ((err = glGetError()) != GL_NO_ERROR) {
-                        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glBufferDataARB failed: %u", err);
-                        throw vislib::Exception("glBufferDataARB failed", __FILE__, __LINE__);
-                    }
-                } else {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-                        "Currently only data without stride is supported for caching");
-                    throw vislib::Exception("Currently only data without stride is supported for caching", __FILE__, __LINE__);
-                }
-                this->cacheSizeUsed += cbpp * parts.GetCount();
-#ifdef SPEAK_VRAM_CACHE_USAGE
-                printf("VRAM-Cache: Add[%d; %u] %u/%u\n", i, j, this->cacheSizeUsed, this->cacheSize);
-#endif /* SPEAK_VRAM_CACHE_USAGE */
-            }
-
-            // radius and position
-            bool matrixpooper = false;
-            switch (ptype.GetVertexDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                    continue;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(3, GL_FLOAT, 0, NULL);
-                    } else {
-                        glVertexPointer(3, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                    }
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(3, GL_FLOAT, 16, NULL);
-                    } else {
-                        glVertexPointer(3, GL_FLOAT,
-                            glm::max(16U, parts.GetVertexDataStride()),
-                            parts.GetVertexData());
-                    }
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
-                    float skale = cell->GetBoundingBox().LongestEdge() / static_cast<float>(SHRT_MAX);
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(3, GL_SHORT, 0, NULL);
-                    } else {
-                        glVertexPointer(3, GL_SHORT, /* unsigned short is not supported! */
-                            parts.GetVertexDataStride(), parts.GetVertexData());
-                    }
-                    matrixpooper = true;
-                    glMatrixMode(GL_MODELVIEW);
-                    glPushMatrix();
-                    glTranslatef(cell->GetBoundingBox().Left(),
-                        cell->GetBoundingBox().Bottom(),
-                        cell->GetBoundingBox().Back());
-                    glScalef(skale, skale, skale);
-                } break;
-
-                default:
-                    continue;
-            }
-            glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
-            glBindBufferARB(GL_ARRAY_BUFFER, 0);
-            glDisableClientState(GL_VERTEX_ARRAY);
-            if (matrixpooper) {
-                glPopMatrix();
+    for (unsigned int j = 0; j < typecnt; j++) {
+        if (!this->enableParticleType(*pgdc, j, this->initDepthPointShader, false, false, -1)) continue;
+        if (gpuCull) {
+            this->drawCulledLists(true, j);
+        } else {
+            for (int i = cellcnt - 1; i >= 0; i--) { // front to back
+                unsigned int idx = dists[i].First();
+                const CellInfo &info = infos[idx];
+                if (!info.wasvisible) continue;
+                // only draw cells which were visible last frame
+                if (!info.dots) continue;
+
+                const GLuint *list = &this->cellLists[2 * (idx * typecnt + j)];
+                if (list[1] > 0) glDrawArrays(GL_POINTS, list[0], list[1]);
             }
         }
+        this->disableParticleType(-1);
     }
-#ifdef SPEAK_CELL_USAGE
-    printf("]\n");
-#endif
     this->initDepthPointShader.Disable();
 
     glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
@@ -711,183 +632,24 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
     glColor4ub(192, 192, 192, 255);
     glDisableClientState(GL_COLOR_ARRAY);
 
-#ifdef SPEAK_CELL_USAGE
-    printf("[initd2");
-#endif
-    for (int i = cellcnt - 1; i >= 0; i--) { // front to back
-        unsigned int idx = dists[i].First();
-        const ParticleGridDataCall::GridCell *cell = &pgdc->Cells()[idx];
-        CellInfo &info = infos[idx];
-        if (!info.wasvisible) continue;
-        // only draw cells which were visible last frame
-        if (info.dots) continue;
-
-        //glColor4ub(192, 192, 192, 255);
-        float a = static_cast<float>(i) / static_cast<float>(cellcnt - 1);
-        ASSERT((a >= 0.0) && (a <= 1.0f));
-        glColor3f(1.0f - a, 0.0f, a);
-        if (info.dots) {
-            glColor3ub(255, 0, 0);
-        }
-
-#ifdef SPEAK_CELL_USAGE
-        printf("-%d", i);
-#endif
-
-        for (unsigned int j = 0; j < typecnt; j++) {
-            const ParticleGridDataCall::Particles &parts = cell->AccessParticleLists()[j];
-            const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-            CellInfo::CacheItem &ci = info.cache[j];
-            unsigned int vbpp = 1, cbpp = 1;
-            switch (ptype.GetVertexDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                    vbpp = 3 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                    vbpp = 4 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-                    vbpp = 3 * sizeof(short);
-                    break;
-                default:
-                    continue;
-            }
-            switch (ptype.GetColourDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                    cbpp = 3;
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                    cbpp = 4;
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                    cbpp = 3 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                    cbpp = 4 * sizeof(float);
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
-                    cbpp = sizeof(float);
-                    break;
-                default:
-                    break;
-            }
-
-            if ((ci.data[0] == 0) && (vramUploadQuota > 0) && (parts.GetCount() > 0) && (((vbpp + cbpp) * parts.GetCount()) < (this->cacheSize - this->cacheSizeUsed))) {
-                // upload
-                glGetError();
-                glGenBuffersARB(2, ci.data);
-                if (glGetError() != GL_NO_ERROR) {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glGenBuffersARB failed");
-                    throw vislib::Exception("glGenBuffersARB failed", __FILE__, __LINE__);
-                }
-                vramUploadQuota--;
-                glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                glGetError();
-                if (parts.GetVertexDataStride() == 0) {
-                    GLenum err;
-                    glBufferDataARB(GL_ARRAY_BUFFER, vbpp * parts.GetCount(), parts.GetVertexData(), GL_STATIC_DRAW);
-                    if ((err = glGetError()) != GL_NO_ERROR) {
-                        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glBufferDataARB failed: %u", err);
-                        throw vislib::Exception("glBufferDataARB failed", __FILE__, __LINE__);
-                    }
-                } else {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-                        "Currently only data without stride is supported for caching");
-                    throw vislib::Exception("Currently only data without stride is supported for caching", __FILE__, __LINE__);
-                }
-                this->cacheSizeUsed += vbpp * parts.GetCount();
-                glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                if (parts.GetColourDataStride() == 0) {
-                    GLenum err;
-                    glBufferDataARB(GL_ARRAY_BUFFER, cbpp * parts.GetCount(), parts.GetColourData(), GL_STATIC_DRAW);
-                    if ((err = glGetError()) != GL_NO_ERROR) {
-                        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "glBufferDataARB failed: %u", err);
-                        throw vislib::Exception("glBufferDataARB failed", __FILE__, __LINE__);
-                    }
-                } else {
-                    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-                        "Currently only data without stride is supported for caching");
-                    throw vislib::Exception("Currently only data without stride is supported for caching", __FILE__, __LINE__);
-                }
-                this->cacheSizeUsed += cbpp * parts.GetCount();
-#ifdef SPEAK_VRAM_CACHE_USAGE
-                printf("VRAM-Cache: Add[%d; %u] %u/%u\n", i, j, this->cacheSizeUsed, this->cacheSize);
-#endif /* SPEAK_VRAM_CACHE_USAGE */
-            }
-
-            // radius and position
-            bool matrixpooper = false;
-            switch (ptype.GetVertexDataType()) {
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                    continue;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    glUniform4f(this->initDepthShader.ParameterLocation("inConsts1"), ptype.GetGlobalRadius(), 0.0f, 0.0f, 0.0f);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(3, GL_FLOAT, 0, NULL);
-                    } else {
-                        glVertexPointer(3, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                    }
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    glUniform4f(this->initDepthShader.ParameterLocation("inConsts1"), -1.0f, 0.0f, 0.0f, 0.0f);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(4, GL_FLOAT, 0, NULL);
-                    } else {
-                        glVertexPointer(4, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                    }
-                    break;
-                case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
-                    float skale = cell->GetBoundingBox().LongestEdge() / static_cast<float>(SHRT_MAX);
-                    glEnableClientState(GL_VERTEX_ARRAY);
-                    glUniform4f(this->initDepthShader.ParameterLocation("inConsts1"),
-                        ptype.GetGlobalRadius() / skale, 0.0f, 0.0f, 0.0f);
-                    if (ci.data[0] != 0) {
-                        glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                        glVertexPointer(3, GL_SHORT, 0, NULL);
-                    } else {
-                        glVertexPointer(3, GL_SHORT, /* unsigned short is not supported! */
-                            parts.GetVertexDataStride(), parts.GetVertexData());
-                    }
-                    matrixpooper = true;
-                    glMatrixMode(GL_MODELVIEW);
-                    glPushMatrix();
-                    glTranslatef(cell->GetBoundingBox().Left(),
-                        cell->GetBoundingBox().Bottom(),
-                        cell->GetBoundingBox().Back());
-                    glScalef(skale, skale, skale);
-                } break;
-
-                default:
-                    continue;
-            }
-            glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
-            glBindBufferARB(GL_ARRAY_BUFFER, 0);
-            glDisableClientState(GL_VERTEX_ARRAY);
-
-            if (matrixpooper) {
-                glPopMatrix();
+    for (unsigned int j = 0; j < typecnt; j++) {
+        if (!this->enableParticleType(*pgdc, j, this->initDepthShader, true, false, -1)) continue;
+        if (gpuCull) {
+            this->drawCulledLists(false, j);
+        } else {
+            for (int i = cellcnt - 1; i >= 0; i--) { // front to back
+                unsigned int idx = dists[i].First();
+                const CellInfo &info = infos[idx];
+                if (!info.wasvisible) continue;
+                // only draw cells which were visible last frame
+                if (info.dots) continue;
+
+                const GLuint *list = &this->cellLists[2 * (idx * typecnt + j)];
+                if (list[1] > 0) glDrawArrays(GL_POINTS, list[0], list[1]);
             }
         }
-
-        //glBegin(GL_LINES);
-        //glVertex3f(cell->GetBoundingBox().Left(), cell->GetBoundingBox().Bottom(), cell->GetBoundingBox().Back());
-        //glVertex3f(cell->GetBoundingBox().Right(), cell->GetBoundingBox().Top(), cell->GetBoundingBox().Front());
-        //glVertex3f(cell->GetBoundingBox().Right(), cell->GetBoundingBox().Bottom(), cell->GetBoundingBox().Back());
-        //glVertex3f(cell->GetBoundingBox().Left(), cell->GetBoundingBox().Top(), cell->GetBoundingBox().Front());
-        //glVertex3f(cell->GetBoundingBox().Left(), cell->GetBoundingBox().Top(), cell->GetBoundingBox().Back());
-        //glVertex3f(cell->GetBoundingBox().Right(), cell->GetBoundingBox().Bottom(), cell->GetBoundingBox().Front());
-        //glVertex3f(cell->GetBoundingBox().Right(), cell->GetBoundingBox().Top(), cell->GetBoundingBox().Back());
-        //glVertex3f(cell->GetBoundingBox().Left(), cell->GetBoundingBox().Bottom(), cell->GetBoundingBox().Front());
-        //glEnd();
-
+        this->disableParticleType(-1);
     }
-#ifdef SPEAK_CELL_USAGE
-    printf("]\n");
-#endif
 
     this->initDepthShader.Disable();
 #ifdef _WIN32
@@ -897,7 +659,7 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
 #ifdef _WIN32
 #pragma region issue occlusion queries for all cells to find hidden ones
 #endif /* _WIN32 */
-    if (useCellCull) {
+    if (useCellCull && !gpuCull) {
         // occlusion queries ftw
         glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
         glDepthMask(GL_FALSE);
@@ -965,7 +727,7 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
 #pragma region depth buffer mipmaping
 #endif /* _WIN32 */
     int maxLevel = 0;
-    if (useVertCull) {
+    if (useVertCull || gpuCull) {
         // create depth mipmap
         this->depthmap[0].Enable();
 
@@ -1120,6 +882,78 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
 
     unsigned int visCnt = 0;
 
+#ifdef _WIN32
+#pragma region cell culling
+#endif /* _WIN32 */
+    if (gpuCull) {
+        // test all cells against the depth mip map and compact the draw
+        // commands of the visible ones, the counts stay on the GPU
+        std::vector<GLuint> zeros(2 * typecnt + 1, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->counterBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, zeros.size() * sizeof(GLuint), zeros.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        this->cellCullShader.Enable();
+        glUniform1ui(this->cellCullShader.ParameterLocation("cellCount"), cellcnt);
+        glUniform1ui(this->cellCullShader.ParameterLocation("typeCount"), typecnt);
+        glUniformMatrix4fv(this->cellCullShader.ParameterLocation("mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+        glUniform1f(this->cellCullShader.ParameterLocation("scaling"), scaling);
+        glUniform3fv(this->cellCullShader.ParameterLocation("camPos"), 1,
+            cr->GetCameraParameters()->Position().PeekCoordinates());
+        glUniform3fv(this->cellCullShader.ParameterLocation("camIn"), 1,
+            cr->GetCameraParameters()->Front().PeekComponents());
+        glUniform1f(this->cellCullShader.ParameterLocation("viewDist"), viewDist);
+        glUniform2f(this->cellCullShader.ParameterLocation("viewport"),
+            static_cast<float>(this->fbo.GetWidth()), static_cast<float>(this->fbo.GetHeight()));
+        glUniform1i(this->cellCullShader.ParameterLocation("useOcclusion"), (maxLevel > 0) ? 1 : 0);
+        this->cellCullShader.SetParameter("depthTexParams", this->depthmap[0].GetWidth(),
+            this->depthmap[0].GetHeight() * 2 / 3, maxLevel);
+        glActiveTextureARB(GL_TEXTURE0_ARB);
+        this->depthmap[0].BindColourTexture();
+        this->cellCullShader.SetParameter("depthTex", 0);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->cellBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->listBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->counterBuffer);
+        this->cellCullShader.Dispatch((cellcnt + 63) / 64, 1, 1);
+        for (GLuint binding = 0; binding < 4; binding++) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->cellCullShader.Disable();
+
+        // the compacted lists are read as draw commands and draw counts
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        this->commandsValid = true;
+
+        if (speakCellPerc) {
+            // only read back for the statistics, stalls the pipeline
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->counterBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 2 * typecnt * sizeof(GLuint), sizeof(GLuint), &visCnt);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+    } else {
+        for (unsigned int i = 0; i < cellcnt; i++) {
+            CellInfo& info = infos[i];
+            unsigned int pixelCount;
+            if (!info.isvisible) continue; // frustum culling
+
+            if (useCellCull) {
+                glGetOcclusionQueryuivNV(info.oQuery, GL_PIXEL_COUNT_NV, &pixelCount);
+                info.isvisible = (pixelCount > 0);
+                //printf("PixelCount of cell %u is %u\n", i, pixelCount);
+                if (!info.isvisible) continue; // occlusion culling
+            }
+            visCnt++;
+        }
+    }
+#ifdef _WIN32
+#pragma endregion cell culling
+#endif /* _WIN32 */
+
     if (speakVertCount) {
         //
         // outputs the number of vertices surviving the vertex culling stage
@@ -1160,109 +994,18 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
             this->vertCntShader.Enable();
         }
 
-#ifdef SPEAK_CELL_USAGE
-        printf("[vertCnt");
-#endif
-        for (int i = 0; i < static_cast<int>(cellcnt); i++) { // front to back
-            const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[i];
-            CellInfo& info = infos[i];
-            unsigned int pixelCount;
-            if (!info.isvisible) continue; // frustum culling
-
-            if (useCellCull) {
-                glGetOcclusionQueryuivNV(info.oQuery, GL_PIXEL_COUNT_NV, &pixelCount);
-                info.isvisible = (pixelCount > 0);
-                //printf("PixelCount of cell %u is %u\n", idx, pixelCount);
-                if (!info.isvisible) continue; // occlusion culling
-            } else {
-                info.isvisible = true;
-            }
-            visCnt++;
-
-#ifdef SPEAK_CELL_USAGE
-            printf("-%d", i);
-#endif
-
-            for (unsigned int j = 0; j < typecnt; j++) {
-                const ParticleGridDataCall::Particles &parts = cell.AccessParticleLists()[j];
-                const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-                CellInfo::CacheItem &ci = info.cache[j];
-                float minC = 0.0f, maxC = 0.0f;
-                unsigned int colTabSize = 0;
-
-                // radius and position
-                bool matrixpooper = false;
-                switch (ptype.GetVertexDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                        continue;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        if (useVertCull) {
-                            glUniform4f(this->vertCntShade2r.ParameterLocation("inConsts1"),
-                                ptype.GetGlobalRadius(), minC, maxC, float(colTabSize));
-                        }
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_FLOAT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        if (useVertCull) {
-                            glUniform4f(this->vertCntShade2r.ParameterLocation("inConsts1"),
-                                -1.0f, minC, maxC, float(colTabSize));
-                        }
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(4, GL_FLOAT, 0, NULL);
-                        } else {
-                            glVertexPointer(4, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
-                        float skale = cell.GetBoundingBox().LongestEdge() / static_cast<float>(SHRT_MAX);
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        if (useVertCull) {
-                            glUniform4f(this->vertCntShade2r.ParameterLocation("inConsts1"),
-                                ptype.GetGlobalRadius() / skale, minC, maxC, float(colTabSize));
-                        }
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_SHORT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_SHORT, /* unsigned short is not supported! */
-                                parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        matrixpooper = true;
-                        glMatrixMode(GL_MODELVIEW);
-                        glPushMatrix();
-                        glTranslatef(cell.GetBoundingBox().Left(),
-                            cell.GetBoundingBox().Bottom(),
-                            cell.GetBoundingBox().Back());
-                        glScalef(skale, skale, skale);
-                    } break;
-
-                    default:
-                        continue;
-                }
-
-                glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
-                glBindBufferARB(GL_ARRAY_BUFFER, 0);
-                //glDisableClientState(GL_COLOR_ARRAY);
-                glDisableClientState(GL_VERTEX_ARRAY);
+        vislib::graphics::gl::GLSLShader &cntShader = useVertCull ? this->vertCntShade2r : this->vertCntShader;
+        for (unsigned int j = 0; j < typecnt; j++) {
+            if (!this->enableParticleType(*pgdc, j, cntShader, true, false, -1)) continue;
+            for (unsigned int i = 0; i < cellcnt; i++) {
+                if (!infos[i].isvisible) continue; // culled
 
-                if (matrixpooper) {
-                    glPopMatrix();
-                }
+                const GLuint *list = &this->cellLists[2 * (i * typecnt + j)];
+                if (list[1] > 0) glDrawArrays(GL_POINTS, list[0], list[1]);
             }
-
+            this->disableParticleType(-1);
         }
-        (useVertCull ? this->vertCntShade2r : this->vertCntShader).Disable();
-#ifdef SPEAK_CELL_USAGE
-        printf("]\n");
-#endif
+        cntShader.Disable();
 
         unsigned int totalSchnitzels = 0;
         glEndOcclusionQueryNV();
@@ -1303,192 +1046,30 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
 
         }
 
-#ifdef SPEAK_CELL_USAGE
-        printf("[drawd");
-#endif
         // draw visible data (dots)
         glEnable(GL_DEPTH_TEST);
         glPointSize(1.0f);
         glDisableClientState(GL_COLOR_ARRAY);
         daPointShader->Enable();
-        for (int i = cellcnt - 1; i >= 0; i--) { // front to back
-            const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[i];
-            CellInfo& info = infos[i];
-            unsigned int pixelCount;
-            if (!info.isvisible) continue; // frustum culling
-            if (!info.dots) continue;
-
-            if (useCellCull) {
-                glGetOcclusionQueryuivNV(info.oQuery, GL_PIXEL_COUNT_NV, &pixelCount);
-                info.isvisible = (pixelCount > 0);
-                //printf("PixelCount of cell %u is %u\n", idx, pixelCount);
-                if (!info.isvisible) continue; // occlusion culling
+        for (unsigned int j = 0; j < typecnt; j++) {
+            if (!this->enableParticleType(*pgdc, j, *daPointShader, false, true, cial2)) continue;
+            if (gpuCull) {
+                this->drawCulledLists(true, j);
             } else {
-                info.isvisible = true;
-            }
-            visCnt++;
-
-#ifdef SPEAK_CELL_USAGE
-            printf("-%d", i);
-#endif
-
-            for (unsigned int j = 0; j < typecnt; j++) {
-                const ParticleGridDataCall::Particles &parts = cell.AccessParticleLists()[j];
-                const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-                CellInfo::CacheItem &ci = info.cache[j];
-                float minC = 0.0f, maxC = 0.0f;
-                unsigned int colTabSize = 0;
-
-                // colour
-                switch (ptype.GetColourDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_NONE:
-                        glColor3ubv(ptype.GetGlobalColour());
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(3, GL_UNSIGNED_BYTE, 0, NULL);
-                        } else {
-                            glColorPointer(3, GL_UNSIGNED_BYTE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(4, GL_UNSIGNED_BYTE, 0, NULL);
-                        } else {
-                            glColorPointer(4, GL_UNSIGNED_BYTE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(3, GL_FLOAT, 0, NULL);
-                        } else {
-                            glColorPointer(3, GL_FLOAT,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(4, GL_FLOAT, 0, NULL);
-                        } else {
-                            glColorPointer(4, GL_FLOAT,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I: {
-                        glEnableVertexAttribArrayARB(cial2);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glVertexAttribPointerARB(cial2, 1, GL_FLOAT, GL_FALSE, 0, NULL);
-                        } else {
-                            glVertexAttribPointerARB(cial2, 1, GL_FLOAT, GL_FALSE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-
-                        glEnable(GL_TEXTURE_1D);
-
-                        view::CallGetTransferFunction *cgtf = this->getTFSlot.CallAs<view::CallGetTransferFunction>();
-                        if ((cgtf != NULL) && ((*cgtf)())) {
-                            glBindTexture(GL_TEXTURE_1D, cgtf->OpenGLTexture());
-                            colTabSize = cgtf->TextureSize();
-                        } else {
-                            glBindTexture(GL_TEXTURE_1D, this->greyTF);
-                            colTabSize = 2;
-                        }
-
-                        glUniform1i(daPointShader->ParameterLocation("colTab"), 0);
-                        minC = ptype.GetMinColourIndexValue();
-                        maxC = ptype.GetMaxColourIndexValue();
-                        glColor3ub(127, 127, 127);
-                    } break;
-                    default:
-                        glColor3ub(127, 127, 127);
-                        break;
-                }
-
-                // radius and position
-                bool matrixpooper = false;
-                switch (ptype.GetVertexDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                        continue;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daPointShader->ParameterLocation("inConsts1"),
-                            ptype.GetGlobalRadius(), minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_FLOAT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daPointShader->ParameterLocation("inConsts1"),
-                            -1.0f, minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_FLOAT, 16, NULL);
-                        } else {
-                            glVertexPointer(3, GL_FLOAT,
-                                vislib::math::Max(16U, parts.GetVertexDataStride()),
-                                parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
-                        float skale = cell.GetBoundingBox().LongestEdge() / static_cast<float>(SHRT_MAX);
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daPointShader->ParameterLocation("inConsts1"),
-                            ptype.GetGlobalRadius() / skale, minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_SHORT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_SHORT, /* unsigned short is not supported! */
-                                parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        matrixpooper = true;
-                        glMatrixMode(GL_MODELVIEW);
-                        glPushMatrix();
-                        glTranslatef(cell.GetBoundingBox().Left(),
-                            cell.GetBoundingBox().Bottom(),
-                            cell.GetBoundingBox().Back());
-                        glScalef(skale, skale, skale);
-                    } break;
-
-                    default:
-                        continue;
-                }
-                glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
-                glBindBufferARB(GL_ARRAY_BUFFER, 0);
-                glDisableClientState(GL_COLOR_ARRAY);
-                glDisableClientState(GL_VERTEX_ARRAY);
-                glDisableVertexAttribArrayARB(cial2);
-                glDisable(GL_TEXTURE_1D);
-
-                if (matrixpooper) {
-                    glPopMatrix();
+                for (int i = cellcnt - 1; i >= 0; i--) { // front to back
+                    unsigned int idx = dists[i].First();
+                    const CellInfo &info = infos[idx];
+                    if (!info.isvisible) continue; // culled
+                    if (!info.dots) continue;
+
+                    const GLuint *list = &this->cellLists[2 * (idx * typecnt + j)];
+                    if (list[1] > 0) glDrawArrays(GL_POINTS, list[0], list[1]);
                 }
             }
-
+            this->disableParticleType(cial2);
         }
-#ifdef SPEAK_CELL_USAGE
-        printf("]\n");
-#endif
         daPointShader->Disable();
 
-#ifdef SPEAK_CELL_USAGE
-        printf("[draws");
-#endif
         // draw visible data (spheres)
         daSphereShader->Enable();
 
@@ -1514,180 +1095,23 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
         }
         glPointSize(defaultPointSize);
 
-        for (int i = cellcnt - 1; i >= 0; i--) { // front to back
-            unsigned int idx = dists[i].First();
-            const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[idx];
-            CellInfo& info = infos[idx];
-
-            unsigned int pixelCount;
-            if (!info.isvisible) continue; // frustum culling
-            if (info.dots) continue;
-
-            if (useCellCull) {
-                glGetOcclusionQueryuivNV(info.oQuery, GL_PIXEL_COUNT_NV, &pixelCount);
-                info.isvisible = (pixelCount > 0);
-                //printf("PixelCount of cell %u is %u\n", idx, pixelCount);
-                if (!info.isvisible) continue; // occlusion culling
+        for (unsigned int j = 0; j < typecnt; j++) {
+            if (!this->enableParticleType(*pgdc, j, *daSphereShader, true, true, cial)) continue;
+            if (gpuCull) {
+                this->drawCulledLists(false, j);
             } else {
-                info.isvisible = true;
-            }
-            visCnt++;
-
-#ifdef SPEAK_CELL_USAGE
-            printf("-%d", i);
-#endif
-
-            for (unsigned int j = 0; j < typecnt; j++) {
-                const ParticleGridDataCall::Particles &parts = cell.AccessParticleLists()[j];
-                const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-                CellInfo::CacheItem &ci = info.cache[j];
-                float minC = 0.0f, maxC = 0.0f;
-                unsigned int colTabSize = 0;
-
-                // colour
-                switch (ptype.GetColourDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_NONE:
-                        glColor3ubv(ptype.GetGlobalColour());
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(3, GL_UNSIGNED_BYTE, 0, NULL);
-                        } else {
-                            glColorPointer(3, GL_UNSIGNED_BYTE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(4, GL_UNSIGNED_BYTE, 0, NULL);
-                        } else {
-                            glColorPointer(4, GL_UNSIGNED_BYTE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(3, GL_FLOAT, 0, NULL);
-                        } else {
-                            glColorPointer(3, GL_FLOAT,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                        glEnableClientState(GL_COLOR_ARRAY);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glColorPointer(4, GL_FLOAT, 0, NULL);
-                        } else {
-                            glColorPointer(4, GL_FLOAT,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I: {
-                        glEnableVertexAttribArrayARB(cial);
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[1]);
-                            glVertexAttribPointerARB(cial, 1, GL_FLOAT, GL_FALSE, 0, NULL);
-                        } else {
-                            glVertexAttribPointerARB(cial, 1, GL_FLOAT, GL_FALSE,
-                                parts.GetColourDataStride(), parts.GetColourData());
-                        }
-
-                        glEnable(GL_TEXTURE_1D);
-
-                        view::CallGetTransferFunction *cgtf = this->getTFSlot.CallAs<view::CallGetTransferFunction>();
-                        if ((cgtf != NULL) && ((*cgtf)())) {
-                            glBindTexture(GL_TEXTURE_1D, cgtf->OpenGLTexture());
-                            colTabSize = cgtf->TextureSize();
-                        } else {
-                            glBindTexture(GL_TEXTURE_1D, this->greyTF);
-                            colTabSize = 2;
-                        }
-
-                        glUniform1i(daSphereShader->ParameterLocation("colTab"), 0);
-                        minC = ptype.GetMinColourIndexValue();
-                        maxC = ptype.GetMaxColourIndexValue();
-                        glColor3ub(127, 127, 127);
-                    } break;
-                    default:
-                        glColor3ub(127, 127, 127);
-                        break;
-                }
-
-                // radius and position
-                bool matrixpooper = false;
-                switch (ptype.GetVertexDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_NONE:
-                        continue;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daSphereShader->ParameterLocation("inConsts1"),
-                            ptype.GetGlobalRadius(), minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_FLOAT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daSphereShader->ParameterLocation("inConsts1"),
-                            -1.0f, minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(4, GL_FLOAT, 0, NULL);
-                        } else {
-                            glVertexPointer(4, GL_FLOAT, parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
-                        float skale = cell.GetBoundingBox().LongestEdge() / static_cast<float>(SHRT_MAX);
-                        glEnableClientState(GL_VERTEX_ARRAY);
-                        glUniform4f(daSphereShader->ParameterLocation("inConsts1"),
-                            ptype.GetGlobalRadius() / skale, minC, maxC, float(colTabSize));
-                        if (ci.data[0] != 0) {
-                            glBindBufferARB(GL_ARRAY_BUFFER, ci.data[0]);
-                            glVertexPointer(3, GL_SHORT, 0, NULL);
-                        } else {
-                            glVertexPointer(3, GL_SHORT, /* unsigned short is not supported! */
-                                parts.GetVertexDataStride(), parts.GetVertexData());
-                        }
-                        matrixpooper = true;
-                        glMatrixMode(GL_MODELVIEW);
-                        glPushMatrix();
-                        glTranslatef(cell.GetBoundingBox().Left(),
-                            cell.GetBoundingBox().Bottom(),
-                            cell.GetBoundingBox().Back());
-                        glScalef(skale, skale, skale);
-                    } break;
-
-                    default:
-                        continue;
-                }
-
-                glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
-                glBindBufferARB(GL_ARRAY_BUFFER, 0);
-                glDisableClientState(GL_COLOR_ARRAY);
-                glDisableClientState(GL_VERTEX_ARRAY);
-                glDisableVertexAttribArrayARB(cial);
-                glDisable(GL_TEXTURE_1D);
-
-                if (matrixpooper) {
-                    glPopMatrix();
+                for (int i = cellcnt - 1; i >= 0; i--) { // front to back
+                    unsigned int idx = dists[i].First();
+                    const CellInfo &info = infos[idx];
+                    if (!info.isvisible) continue; // culled
+                    if (info.dots) continue;
+
+                    const GLuint *list = &this->cellLists[2 * (idx * typecnt + j)];
+                    if (list[1] > 0) glDrawArrays(GL_POINTS, list[0], list[1]);
                 }
             }
-
+            this->disableParticleType(cial);
         }
-#ifdef SPEAK_CELL_USAGE
-        printf("]\n");
-#endif
 
 #ifdef SUPSAMP_LOOP
         }
@@ -1706,67 +1130,6 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
     glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
     glDisable(GL_TEXTURE_2D);
 
-    // remove unused cache item
-    if ((this->cacheSizeUsed * 5 / 4) > this->cacheSize) {
-        for (int i = cellcnt - 1; i >= 0; i--) { // front to back
-            unsigned int idx = dists[i].First();
-            const ParticleGridDataCall::GridCell& cell = pgdc->Cells()[idx];
-            CellInfo& info = infos[idx];
-
-            if (info.wasvisible) continue; // this one is still required
-
-            for (unsigned int j = 0; j < typecnt; j++) {
-                const ParticleGridDataCall::Particles &parts = cell.AccessParticleLists()[j];
-                const ParticleGridDataCall::ParticleType &ptype = pgdc->Types()[j];
-                CellInfo::CacheItem &ci = info.cache[j];
-
-                if ((ci.data[0] == 0) || (parts.GetCount() == 0)) continue; // not cached or no data
-
-                unsigned int vbpp = 1, cbpp = 1;
-                switch (ptype.GetVertexDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-                        vbpp = 3 * sizeof(float);
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-                        vbpp = 4 * sizeof(float);
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-                        vbpp = 3 * sizeof(short);
-                        break;
-                    default:
-                        continue;
-                }
-                switch (ptype.GetColourDataType()) {
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
-                        cbpp = 3;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
-                        cbpp = 4;
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
-                        cbpp = 3 * sizeof(float);
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
-                        cbpp = 4 * sizeof(float);
-                        break;
-                    case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
-                        cbpp = sizeof(float);
-                        break;
-                    default:
-                        break;
-                }
-
-                glDeleteBuffersARB(2, ci.data);
-                ci.data[0] = ci.data[1] = 0;
-
-                this->cacheSizeUsed -= (vbpp + cbpp) * parts.GetCount();
-#ifdef SPEAK_VRAM_CACHE_USAGE
-                printf("VRAM-Cache: Del[%d; %u] %u/%u\n", i, j, this->cacheSizeUsed, this->cacheSize);
-#endif /* SPEAK_VRAM_CACHE_USAGE */
-            }
-        }
-    }
-
     if (deferredShading) {
 
         cr->EnableOutputBuffer();
@@ -1887,15 +1250,38 @@ bool GrimRenderer::Render(megamol::core::view::CallRender3D& call) {
     // done!
     pgdc->Unlock();
 
-    for (int i = cellcnt - 1; i >= 0; i--) {
-        CellInfo& info = infos[i];
-        info.wasvisible = info.isvisible;
+    if (!gpuCull) {
+        for (int i = cellcnt - 1; i >= 0; i--) {
+            CellInfo& info = infos[i];
+            info.wasvisible = info.isvisible;
+        }
     }
 
     return true;
 }
 
 
+/*
+ * GrimRenderer::colourSize
+ */
+unsigned int GrimRenderer::colourSize(ParticleGridDataCall::ParticleType::ColourDataType colType) {
+    switch (colType) {
+        case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
+            return 3;
+        case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
+            return 4;
+        case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
+            return 3 * sizeof(float);
+        case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
+            return 4 * sizeof(float);
+        case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
+            return sizeof(float);
+        default:
+            return 0;
+    }
+}
+
+
 bool GrimRenderer::depthSort(const vislib::Pair<unsigned int, float>& lhs, const vislib::Pair<unsigned int, float>& rhs) {
 
     return (rhs.Second() < lhs.Second());
@@ -1905,3 +1291,247 @@ bool GrimRenderer::depthSort(const vislib::Pair<unsigned int, float>& lhs, const
     //if (d < -vislib::math::FLOAT_EPSILON) return -1;
     //return 0;
 }
+
+
+/*
+ * GrimRenderer::enableParticleType
+ */
+bool GrimRenderer::enableParticleType(ParticleGridDataCall &pgdc, unsigned int type,
+        vislib::graphics::gl::GLSLShader &shader, bool withRadii, bool withColour, GLint colIdxAttrib) {
+    const ParticleGridDataCall::ParticleType &ptype = pgdc.Types()[type];
+    const TypeInfo &ti = this->typeInfos[type];
+    float minC = 0.0f, maxC = 0.0f;
+    unsigned int colTabSize = 0;
+
+    switch (ptype.GetVertexDataType()) {
+        case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+        case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+        case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
+            break;
+        default:
+            return false;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->particleBuffer);
+
+    // colour
+    if (withColour) {
+        switch (ptype.GetColourDataType()) {
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_NONE:
+                glColor3ubv(ptype.GetGlobalColour());
+                break;
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
+                glEnableClientState(GL_COLOR_ARRAY);
+                glColorPointer(3, GL_UNSIGNED_BYTE, 0, bufferOffset(ti.colOffset));
+                break;
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
+                glEnableClientState(GL_COLOR_ARRAY);
+                glColorPointer(4, GL_UNSIGNED_BYTE, 0, bufferOffset(ti.colOffset));
+                break;
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
+                glEnableClientState(GL_COLOR_ARRAY);
+                glColorPointer(3, GL_FLOAT, 0, bufferOffset(ti.colOffset));
+                break;
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
+                glEnableClientState(GL_COLOR_ARRAY);
+                glColorPointer(4, GL_FLOAT, 0, bufferOffset(ti.colOffset));
+                break;
+            case core::moldyn::MultiParticleDataCall::Particles::COLDATA_FLOAT_I: {
+                if (colIdxAttrib >= 0) {
+                    glEnableVertexAttribArrayARB(colIdxAttrib);
+                    glVertexAttribPointerARB(colIdxAttrib, 1, GL_FLOAT, GL_FALSE, 0, bufferOffset(ti.colOffset));
+                }
+
+                glEnable(GL_TEXTURE_1D);
+
+                view::CallGetTransferFunction *cgtf = this->getTFSlot.CallAs<view::CallGetTransferFunction>();
+                if ((cgtf != NULL) && ((*cgtf)())) {
+                    glBindTexture(GL_TEXTURE_1D, cgtf->OpenGLTexture());
+                    colTabSize = cgtf->TextureSize();
+                } else {
+                    glBindTexture(GL_TEXTURE_1D, this->greyTF);
+                    colTabSize = 2;
+                }
+
+                glUniform1i(shader.ParameterLocation("colTab"), 0);
+                minC = ptype.GetMinColourIndexValue();
+                maxC = ptype.GetMaxColourIndexValue();
+                glColor3ub(127, 127, 127);
+            } break;
+            default:
+                glColor3ub(127, 127, 127);
+                break;
+        }
+    }
+
+    // radius and position, the quantised positions have been converted on upload
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glUniform4f(shader.ParameterLocation("inConsts1"),
+        (ti.vertComps == 4) ? -1.0f : ptype.GetGlobalRadius(), minC, maxC, float(colTabSize));
+    if (withRadii) {
+        glVertexPointer(ti.vertComps, GL_FLOAT, 0, bufferOffset(ti.vertOffset));
+    } else {
+        glVertexPointer(3, GL_FLOAT, ti.vertComps * sizeof(float), bufferOffset(ti.vertOffset));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+
+/*
+ * GrimRenderer::disableParticleType
+ */
+void GrimRenderer::disableParticleType(GLint colIdxAttrib) {
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (colIdxAttrib >= 0) {
+        glDisableVertexAttribArrayARB(colIdxAttrib);
+    }
+    glDisable(GL_TEXTURE_1D);
+}
+
+
+/*
+ * GrimRenderer::uploadParticles
+ */
+bool GrimRenderer::uploadParticles(ParticleGridDataCall &pgdc, float scaling) {
+    const unsigned int cellcnt = pgdc.CellsCount();
+    const unsigned int typecnt = pgdc.TypesCount();
+    auto align = [](SIZE_T s) { return (s + 15) & ~static_cast<SIZE_T>(15); };
+
+    // layout the lists of all cells type by type
+    this->commandsValid = false;
+    this->typeInfos.resize(typecnt);
+    this->cellLists.assign(2 * cellcnt * typecnt, 0);
+    SIZE_T size = 0;
+    for (unsigned int j = 0; j < typecnt; j++) {
+        const ParticleGridDataCall::ParticleType &ptype = pgdc.Types()[j];
+        TypeInfo &ti = this->typeInfos[j];
+        bool hasVerts = false;
+        switch (ptype.GetVertexDataType()) {
+            case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+            case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+            case core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
+                hasVerts = true;
+                break;
+            default:
+                break;
+        }
+        ti.vertComps = (ptype.GetVertexDataType()
+            == core::moldyn::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) ? 4 : 3;
+        ti.colSize = colourSize(ptype.GetColourDataType());
+
+        GLuint first = 0;
+        for (unsigned int i = 0; i < cellcnt; i++) {
+            GLuint cnt = hasVerts ? static_cast<GLuint>(pgdc.Cells()[i].AccessParticleLists()[j].GetCount()) : 0;
+            this->cellLists[2 * (i * typecnt + j)] = first;
+            this->cellLists[2 * (i * typecnt + j) + 1] = cnt;
+            first += cnt;
+        }
+        ti.vertOffset = size;
+        size = align(size + first * ti.vertComps * sizeof(float));
+        ti.colOffset = size;
+        size = align(size + first * ti.colSize);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->particleBuffer);
+    glGetError();
+    glBufferData(GL_ARRAY_BUFFER, vislib::math::Max<SIZE_T>(size, 16), NULL, GL_STATIC_DRAW);
+    unsigned char *dst = static_cast<unsigned char *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+    if ((glGetError() != GL_NO_ERROR) || (dst == NULL)) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+            "Unable to allocate %lu bytes of GPU memory for the particles", static_cast<unsigned long>(size));
+        this->typeInfos.clear();
+        return false;
+    }
+
+    std::vector<float> bounds(8 * cellcnt);
+    for (unsigned int i = 0; i < cellcnt; i++) {
+        const ParticleGridDataCall::GridCell &cell = pgdc.Cells()[i];
+        const vislib::math::Cuboid<float> &bbox = cell.GetBoundingBox();
+        CellInfo &info = this->cellInfos[i];
+
+        info.maxrad = 0.0f;
+        for (unsigned int j = 0; j < typecnt; j++) {
+            const ParticleGridDataCall::Particles &parts = cell.AccessParticleLists()[j];
+            const ParticleGridDataCall::ParticleType &ptype = pgdc.Types()[j];
+            const TypeInfo &ti = this->typeInfos[j];
+            const GLuint first = this->cellLists[2 * (i * typecnt + j)];
+            const GLuint cnt = this->cellLists[2 * (i * typecnt + j) + 1];
+
+            info.maxrad = glm::max(info.maxrad, parts.GetMaxRadius() * scaling);
+            if (cnt == 0) continue;
+
+            float *vert = reinterpret_cast<float *>(dst + ti.vertOffset) + first * ti.vertComps;
+            if (ptype.GetVertexDataType() == core::moldyn::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ) {
+                // dequantise, as all cells share one vertex array
+                const float skale = bbox.LongestEdge() / static_cast<float>(SHRT_MAX);
+                const unsigned char *src = static_cast<const unsigned char *>(parts.GetVertexData());
+                const unsigned int stride = vislib::math::Max<unsigned int>(
+                    parts.GetVertexDataStride(), 3 * sizeof(short));
+                for (GLuint k = 0; k < cnt; k++, src += stride, vert += 3) {
+                    const short *pos = reinterpret_cast<const short *>(src);
+                    vert[0] = bbox.Left() + static_cast<float>(pos[0]) * skale;
+                    vert[1] = bbox.Bottom() + static_cast<float>(pos[1]) * skale;
+                    vert[2] = bbox.Back() + static_cast<float>(pos[2]) * skale;
+                }
+            } else {
+                copyStrided(vert, parts.GetVertexData(), cnt, ti.vertComps * sizeof(float),
+                    parts.GetVertexDataStride());
+            }
+            if (ti.colSize > 0) {
+                copyStrided(dst + ti.colOffset + first * ti.colSize, parts.GetColourData(), cnt, ti.colSize,
+                    parts.GetColourDataStride());
+            }
+        }
+
+        float *b = &bounds[8 * i];
+        b[0] = bbox.Left();
+        b[1] = bbox.Bottom();
+        b[2] = bbox.Back();
+        b[3] = info.maxrad;
+        b[4] = bbox.Right();
+        b[5] = bbox.Top();
+        b[6] = bbox.Front();
+        b[7] = 0.0f;
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (this->gpuCullAvailable) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->cellBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bounds.size() * sizeof(float), bounds.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->listBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->cellLists.size() * sizeof(GLuint), this->cellLists.data(),
+            GL_STATIC_DRAW);
+        // one command of four uints per class, type and cell, i.e. twice the lists
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->commandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, 4 * this->cellLists.size() * sizeof(GLuint), NULL,
+            GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->counterBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (2 * typecnt + 1) * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    return true;
+}
+
+
+/*
+ * GrimRenderer::drawCulledLists
+ */
+void GrimRenderer::drawCulledLists(bool dots, unsigned int type) {
+    if (!this->commandsValid) return;
+
+    const SIZE_T cellcnt = this->cellInfos.size();
+    const SIZE_T list = (dots ? 0 : this->typeInfos.size()) + type;
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->commandBuffer);
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, this->counterBuffer);
+    glMultiDrawArraysIndirectCountARB(GL_POINTS, bufferOffset(list * cellcnt * 4 * sizeof(GLuint)),
+        static_cast<GLintptr>(list * sizeof(GLuint)), static_cast<GLsizei>(cellcnt), 0);
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -26,6 +26,7 @@
 #include "vislib/math/Cuboid.h"
 #include "vislib/forceinline.h"
 #include "vislib/graphics/gl/FramebufferObject.h"
+#include "vislib/graphics/gl/GLSLComputeShader.h"
 #include "vislib/graphics/gl/GLSLShader.h"
 #include "vislib/Pair.h"
 #include "vislib/math/Point.h"
@@ -139,29 +140,6 @@ namespace rendering {
         class CellInfo {
         public:
 
-            class CacheItem {
-            public:
-                GLuint data[2];
-
-                CacheItem() {
-                    this->data[0] = 0;
-                    this->data[1] = 0;
-                }
-
-                ~CacheItem() {
-                    if (this->data[0] != 0) {
-                        ::glDeleteBuffersARB(2, this->data);
-                    }
-                    this->data[0] = 0;
-                    this->data[1] = 0;
-                }
-
-                inline bool operator==(const CacheItem &rhs) {
-                    return (this->data[0] == rhs.data[0])
-                        && (this->data[1] == rhs.data[1]);
-                }
-            };
-
             /** Flag if the cell is visible now (inside the frustum; not occluded) */
             bool isvisible;
 
@@ -177,9 +155,6 @@ namespace rendering {
             /** The occlusion query object */
             unsigned int oQuery;
 
-            /** gpu-ram caching variables */
-            std::vector<CacheItem> cache;
-
             /**
                 * Ctor
                 */
@@ -206,6 +181,37 @@ namespace rendering {
 
         };
 
+        /**
+            * The location of the particles of one type in the particle buffer.
+            * The lists of all cells are stored consecutively, such that one
+            * vertex pointer setup serves all cells.
+            */
+        class TypeInfo {
+        public:
+
+            /** The byte offset of the positions, always stored as floats */
+            SIZE_T vertOffset;
+
+            /** The byte offset of the colours */
+            SIZE_T colOffset;
+
+            /** The number of position components, 3 or 4 */
+            GLint vertComps;
+
+            /** The number of bytes per colour */
+            unsigned int colSize;
+
+        };
+
+        /**
+            * Answer the number of bytes of a colour of the given type
+            *
+            * @param colType The colour data type
+            *
+            * @return The size of one colour, or zero if there is no colour array
+            */
+        static unsigned int colourSize(ParticleGridDataCall::ParticleType::ColourDataType colType);
+
         /**
             * Sorts the grid cells by their distance to the viewer
             *
@@ -217,6 +223,49 @@ namespace rendering {
         static bool depthSort(const vislib::Pair<unsigned int, float> &lhs,
             const vislib::Pair<unsigned int, float> &rhs);
 
+        /**
+            * Sets up the vertex and colour arrays of one particle type from the
+            * particle buffer.
+            *
+            * @param pgdc The incoming data
+            * @param type The index of the particle type
+            * @param shader The active shader
+            * @param withRadii Whether to pass the per-particle radii as 'w'
+            * @param withColour Whether to set up the colours
+            * @param colIdxAttrib The location of the colour index attribute, or -1
+            *
+            * @return 'false' if the type has no positions to render
+            */
+        bool enableParticleType(ParticleGridDataCall &pgdc, unsigned int type,
+            vislib::graphics::gl::GLSLShader &shader, bool withRadii, bool withColour, GLint colIdxAttrib);
+
+        /**
+            * Undoes 'enableParticleType'
+            *
+            * @param colIdxAttrib The location of the colour index attribute, or -1
+            */
+        void disableParticleType(GLint colIdxAttrib);
+
+        /**
+            * Copies the particles of all cells into the particle buffer and
+            * updates the cell bounds and particle lists used for culling.
+            *
+            * @param pgdc The incoming data
+            * @param scaling The scaling of the data into world space
+            *
+            * @return 'true' on success, 'false' if the buffer could not be filled
+            */
+        bool uploadParticles(ParticleGridDataCall &pgdc, float scaling);
+
+        /**
+            * Draws the particle lists of the culled cells of one class, i.e.
+            * dots or spheres, as written by 'cellCullShader'
+            *
+            * @param dots Whether to draw the lists of the dot cells
+            * @param type The index of the particle type
+            */
+        void drawCulledLists(bool dots, unsigned int type);
+
         /** The sphere shader */
         vislib::graphics::gl::GLSLShader sphereShader;
 
@@ -244,6 +293,12 @@ namespace rendering {
         /** Von Guido aus */
         vislib::graphics::gl::GLSLShader vertCntShade2r;
 
+        /** The shader culling the cells against the depth mip map and writing the draw commands */
+        vislib::graphics::gl::GLSLComputeShader cellCullShader;
+
+        /** Whether the cells are culled on the GPU instead of by occlusion queries */
+        bool gpuCullAvailable;
+
         /** The frame buffer object for the depth estimate */
         vislib::graphics::gl::FramebufferObject fbo;
 
@@ -280,11 +335,32 @@ namespace rendering {
         /** Cell rendering informations */
         std::vector<CellInfo> cellInfos;
 
-        /** Bytes of the GPU-Memory available for caching */
-        SIZE_T cacheSize;
+        /** The particle lists of all types */
+        std::vector<TypeInfo> typeInfos;
+
+        /** The first particle and the particle count per cell and type */
+        std::vector<GLuint> cellLists;
 
-        /** Bytes of the GPU-Memory used by the caching */
-        SIZE_T cacheSizeUsed;
+        /** The buffer holding the particles of all cells and types */
+        GLuint particleBuffer;
+
+        /** The bounding boxes and max radii of all cells, for culling */
+        GLuint cellBuffer;
+
+        /** The buffer object of 'cellLists', for culling */
+        GLuint listBuffer;
+
+        /**
+            * The compacted draw commands of the visible cells, per class and
+            * type. These are kept to prime the depth buffer in the next frame.
+            */
+        GLuint commandBuffer;
+
+        /** The number of draw commands per class and type, followed by the number of visible cells */
+        GLuint counterBuffer;
+
+        /** Whether the commands in 'commandBuffer' match the particle buffer */
+        bool commandsValid;
 
         /** Frame buffer object used for deferred shading */
         vislib::graphics::gl::FramebufferObject dsFBO;
@@ -304,6 +380,9 @@ namespace rendering {
         /** The hash of the incoming data */
         SIZE_T inhash;
 
+        /** The frame of the incoming data */
+        unsigned int inFrameID;
+
     };
 
 } /* end namespace rendering */
@@ -0,0 +1,64 @@
+/*
+ * PackedColour.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#ifndef MEGAMOL_STDMOLDYN_PACKEDCOLOUR_H_INCLUDED
+#define MEGAMOL_STDMOLDYN_PACKEDCOLOUR_H_INCLUDED
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "mmcore/moldyn/SimpleSphericalParticles.h"
+
+namespace megamol {
+namespace stdplugin {
+namespace moldyn {
+namespace rendering {
+
+/** Answer a colour channel in [0, 1] as byte */
+inline uint32_t ToByte(float c) { return static_cast<uint32_t>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f); }
+
+/** Answer the colour at c packed as RGBA8, as unpacked by unpackUnorm4x8 */
+inline uint32_t PackColour(const uint8_t* c, core::moldyn::SimpleSphericalParticles::ColourDataType type) {
+    uint32_t r = 127, g = 127, b = 127, a = 255;
+    switch (type) {
+    case core::moldyn::SimpleSphericalParticles::COLDATA_UINT8_RGBA:
+        a = c[3];
+        // fall through
+    case core::moldyn::SimpleSphericalParticles::COLDATA_UINT8_RGB:
+        r = c[0];
+        g = c[1];
+        b = c[2];
+        break;
+    case core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGBA:
+    case core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGB: {
+        float f[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        std::memcpy(f, c, ((type == core::moldyn::SimpleSphericalParticles::COLDATA_FLOAT_RGBA) ? 4 : 3) * sizeof(float));
+        r = ToByte(f[0]);
+        g = ToByte(f[1]);
+        b = ToByte(f[2]);
+        a = ToByte(f[3]);
+    } break;
+    case core::moldyn::SimpleSphericalParticles::COLDATA_USHORT_RGBA: {
+        uint16_t u[4];
+        std::memcpy(u, c, sizeof(u));
+        r = u[0] >> 8;
+        g = u[1] >> 8;
+        b = u[2] >> 8;
+        a = u[3] >> 8;
+    } break;
+    default:
+        break;
+    }
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+} /* end namespace rendering */
+} /* end namespace moldyn */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_STDMOLDYN_PACKEDCOLOUR_H_INCLUDED */
@@ -47,9 +47,7 @@ SphereRenderer::SphereRenderer(void) : view::Renderer3DModule_2()
     , renderMode(RenderMode::SIMPLE)
     , greyTF(0)
     , flagsEnabled(false)
-    , flagsBuffer(0)
     , flagsUseSSBO(false)
-    , flagsCurrentVersion(0xFFFFFFFF)
     , flagsData(nullptr)
     , sphereShader()
     , sphereGeometryShader()
@@ -73,7 +71,19 @@ SphereRenderer::SphereRenderer(void) : view::Renderer3DModule_2()
     , oldFrameID(0)
     , ambConeConstants()
     , volGen(nullptr)
+    , lodHierarchies()
+    , lodParticles()
     , triggerRebuildGBuffer(false)
+    , nextFrame()
+    , frameAlpha(0.0f)
+    , listMaxRadii()
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+    , cullingCells()
+    , cellCullingAvailable(false)
+    , cellCullShader()
+    , depthInitShader()
+    , depthReduceShader()
+#endif // SPHERE_MIN_OGL_CELL_CULLING
 // , timer()
 #if defined(SPHERE_MIN_OGL_BUFFER_ARRAY) || defined(SPHERE_MIN_OGL_SPLAT)
     /// This variant should not need the fence (?)
@@ -86,22 +96,41 @@ SphereRenderer::SphereRenderer(void) : view::Renderer3DModule_2()
 #ifdef SPHERE_MIN_OGL_SSBO_STREAM
     , streamer()
     , colStreamer()
-    , bufArray()
-    , colBufArray()
+    , residentLists()
+    , residentBytes(0)
+    , frameUploadBytes(0)
+    , residencyClock(0)
 #endif // SPHERE_MIN_OGL_SSBO_STREAM
     , renderModeParam("renderMode", "The sphere render mode.")
     , radiusScalingParam("scaling", "Scaling factor for particle radii.")
     , forceTimeSlot(
           "forceTime", "Flag to force the time code to the specified value. Set to true when rendering a video.")
     , useLocalBBoxParam("useLocalBbox", "Enforce usage of local bbox for camera setup")
+    , frustumCullingParam("frustumCulling", "Skip particle lists whose local bbox lies outside the view frustum")
     , colIdxRangeInfoParam(
           "transfer function::colorIndexRange", "The current color index range. Use as range in transfer function.")
+    , uploadInfoParam("statistics::uploadedMB",
+          "The particle data (in MB) uploaded to the GPU in the last frame, estimated for modes without explicit upload")
     , selectColorParam("flag storage::selectedColor", "Color for selected spheres in flag storage.")
     , softSelectColorParam("flag storage::softSelectedColor", "Color for soft selected spheres in flag storage.")
+    , interpolateFramesParam("simple::interpolateFrames",
+          "Simple: Interpolate positions between adjacent frames on fractional times. Requires the particles in the "
+          "same order in all frames, e.g. sorted by ParticleIdentitySort")
+    , cellCullingParam("simple::cellCulling",
+          "Simple: Sort the particles into grid cells, cull the cells against the view frustum and the depth buffer "
+          "on the GPU and draw the visible ones indirectly. Not applied with flag storage or interpolation")
     , alphaScalingParam("splat::alphaScaling", "Splat: Scaling factor for particle alpha.")
     , attenuateSubpixelParam(
           "splat::attenuateSubpixel", "Splat: Attenuate alpha of points that should have subpixel size.")
     , useStaticDataParam("ssbo::staticData", "SSBO: Upload data only once per hash change and keep data static on GPU")
+    , residencyBudgetParam("ssbo::residencyBudget",
+          "SSBO: Device memory (in MB) for keeping the static data of several frames resident on GPU")
+    , adaptiveStreamingParam("ssbo::adaptiveStreaming",
+          "SSBO: Adapt the ring length and chunk size of streamed data to fence stalls and upload bandwidth")
+    , lodEnableParam("lod::enable",
+          "Level of detail: Render aggregated spheres where particles are smaller than the chosen pixel size")
+    , lodPixelSizeParam("lod::pixelSize",
+          "Level of detail: Maximum projected size (in pixels) of the grid cells whose particles are aggregated")
     , enableLightingSlot("ambient occlusion::enableLighting", "Ambient Occlusion: Enable Lighting")
     , enableGeometryShader("ambient occlusion::useGsProxies",
           "Ambient Occlusion: Enables rendering using triangle strips from the geometry shader")
@@ -148,16 +177,29 @@ SphereRenderer::SphereRenderer(void) : view::Renderer3DModule_2()
     this->useLocalBBoxParam << new param::BoolParam(false);
     this->MakeSlotAvailable(&this->useLocalBBoxParam);
 
+    this->frustumCullingParam << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->frustumCullingParam);
+
     this->colIdxRangeInfoParam << new param::Vector2fParam(vislib::math::Vector<float, 2>(0.0f, 0.0f));
     this->MakeSlotAvailable(&this->colIdxRangeInfoParam);
     this->colIdxRangeInfoParam.Param<param::Vector2fParam>()->SetGUIReadOnly(true);
 
+    this->uploadInfoParam << new param::FloatParam(0.0f);
+    this->MakeSlotAvailable(&this->uploadInfoParam);
+    this->uploadInfoParam.Param<param::FloatParam>()->SetGUIReadOnly(true);
+
     this->selectColorParam << new param::ColorParam(1.0f, 0.0f, 0.0f, 1.0f);
     this->MakeSlotAvailable(&this->selectColorParam);
 
     this->softSelectColorParam << new param::ColorParam(1.0f, 0.5f, 0.5f, 1.0f);
     this->MakeSlotAvailable(&this->softSelectColorParam);
 
+    this->interpolateFramesParam << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->interpolateFramesParam);
+
+    this->cellCullingParam << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->cellCullingParam);
+
     this->alphaScalingParam << new param::FloatParam(5.0f);
     this->MakeSlotAvailable(&this->alphaScalingParam);
 
@@ -167,6 +209,19 @@ SphereRenderer::SphereRenderer(void) : view::Renderer3DModule_2()
     this->useStaticDataParam << new param::BoolParam(false);
     this->MakeSlotAvailable(&this->useStaticDataParam);
 
+    this->residencyBudgetParam << new param::IntParam(1024, 0);
+    this->MakeSlotAvailable(&this->residencyBudgetParam);
+
+    this->adaptiveStreamingParam << new param::BoolParam(true);
+    this->adaptiveStreamingParam.ForceSetDirty();
+    this->MakeSlotAvailable(&this->adaptiveStreamingParam);
+
+    this->lodEnableParam << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->lodEnableParam);
+
+    this->lodPixelSizeParam << new param::FloatParam(1.0f, 0.01f);
+    this->MakeSlotAvailable(&this->lodPixelSizeParam);
+
     this->enableLightingSlot << (new param::BoolParam(false));
     this->MakeSlotAvailable(&this->enableLightingSlot);
 
@@ -310,11 +365,19 @@ bool SphereRenderer::resetResources(void) {
     this->colIdxRangeInfoParam.Param<param::Vector2fParam>()->SetGUIVisible(false);
 
     // Set all render mode dependent parameter to GUI invisible
+    // SIMPLE
+    this->interpolateFramesParam.Param<param::BoolParam>()->SetGUIVisible(false);
+    this->cellCullingParam.Param<param::BoolParam>()->SetGUIVisible(false);
     // SPLAT
     this->alphaScalingParam.Param<param::FloatParam>()->SetGUIVisible(false);
     this->attenuateSubpixelParam.Param<param::BoolParam>()->SetGUIVisible(false);
     // SSBO
     this->useStaticDataParam.Param<param::BoolParam>()->SetGUIVisible(false);
+    this->residencyBudgetParam.Param<param::IntParam>()->SetGUIVisible(false);
+    this->adaptiveStreamingParam.Param<param::BoolParam>()->SetGUIVisible(false);
+    // SPLAT and SSBO
+    this->lodEnableParam.Param<param::BoolParam>()->SetGUIVisible(false);
+    this->lodPixelSizeParam.Param<param::FloatParam>()->SetGUIVisible(false);
     // Ambient Occlusion
     this->enableLightingSlot.Param<param::BoolParam>()->SetGUIVisible(false);
     this->enableGeometryShader.Param<param::BoolParam>()->SetGUIVisible(false);
@@ -327,13 +390,9 @@ bool SphereRenderer::resetResources(void) {
     // Outlining
     this->outlineSizeSlot.Param<param::FloatParam>()->SetGUIVisible(false);
 
-    this->flagsCurrentVersion = (0xFFFFFFFF);
     this->flagsEnabled = false;
     this->flagsUseSSBO = false;
     this->flagsData = nullptr;
-    if (this->flagsUseSSBO) {
-        glDeleteBuffers(1, &this->flagsBuffer);
-    }
 
     if (this->greyTF != 0) {
         glDeleteTextures(1, &this->greyTF);
@@ -368,6 +427,28 @@ bool SphereRenderer::resetResources(void) {
     this->oldHash = -1;
     this->oldFrameID = -1;
 
+#ifdef SPHERE_MIN_OGL_SSBO_STREAM
+    this->residentLists.clear();
+    this->residentBytes = 0;
+#endif // SPHERE_MIN_OGL_SSBO_STREAM
+
+    this->lodHierarchies.clear();
+    this->lodParticles.clear();
+    this->listMaxRadii.clear();
+
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+    this->releaseCullingCells();
+    this->cellCullShader.Release();
+    this->depthInitShader.Release();
+    this->depthReduceShader.Release();
+    this->cellCullingAvailable = false;
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
+    if (!this->nextFrame.buffers.empty()) {
+        glDeleteBuffers(static_cast<GLsizei>(this->nextFrame.buffers.size()), this->nextFrame.buffers.data());
+    }
+    this->nextFrame = NextFrame();
+
     this->colType = SimpleSphericalParticles::ColourDataType::COLDATA_NONE;
     this->vertType = SimpleSphericalParticles::VertexDataType::VERTDATA_NONE;
 
@@ -473,6 +554,35 @@ bool SphereRenderer::createResources() {
 
         case (RenderMode::SIMPLE):
         case (RenderMode::SIMPLE_CLUSTERED): {
+            if (this->renderMode == RenderMode::SIMPLE) {
+                this->interpolateFramesParam.Param<param::BoolParam>()->SetGUIVisible(true);
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+                // culling the cells needs compute shaders and the draw count read from a buffer
+                this->cellCullingAvailable = ogl_IsVersionGEQ(4, 3) &&
+                                             (isExtAvailable("GL_ARB_indirect_parameters") != GL_FALSE);
+                if (this->cellCullingAvailable) {
+                    ShaderSource cull, init, reduce;
+                    try {
+                        if (!instance()->ShaderSourceFactory().MakeShaderSource("sphere_cull::cullcells", cull) ||
+                            !instance()->ShaderSourceFactory().MakeShaderSource("sphere_cull::hizinit", init) ||
+                            !instance()->ShaderSourceFactory().MakeShaderSource("sphere_cull::hizreduce", reduce) ||
+                            !this->cellCullShader.Compile(cull.Code(), cull.Count()) ||
+                            !this->cellCullShader.Link() ||
+                            !this->depthInitShader.Compile(init.Code(), init.Count()) ||
+                            !this->depthInitShader.Link() ||
+                            !this->depthReduceShader.Compile(reduce.Code(), reduce.Count()) ||
+                            !this->depthReduceShader.Link()) {
+                            throw vislib::Exception("Generic creation failure", __FILE__, __LINE__);
+                        }
+                    } catch (vislib::Exception& e) {
+                        vislib::sys::Log::DefaultLog.WriteWarn(
+                            "[SphereRenderer] Unable to create the cell culling shaders: %s", e.GetMsgA());
+                        this->cellCullingAvailable = false;
+                    }
+                }
+                this->cellCullingParam.Param<param::BoolParam>()->SetGUIVisible(this->cellCullingAvailable);
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+            }
             vertShaderName = "sphere_simple::vertex";
             fragShaderName = "sphere_simple::fragment";
             if (!instance()->ShaderSourceFactory().MakeShaderSource(vertShaderName.PeekBuffer(), (*this->vertShader))) {
@@ -521,6 +631,10 @@ bool SphereRenderer::createResources() {
 
         case (RenderMode::SSBO_STREAM): {
             this->useStaticDataParam.Param<param::BoolParam>()->SetGUIVisible(true);
+            this->residencyBudgetParam.Param<param::IntParam>()->SetGUIVisible(true);
+            this->adaptiveStreamingParam.Param<param::BoolParam>()->SetGUIVisible(true);
+            this->lodEnableParam.Param<param::BoolParam>()->SetGUIVisible(true);
+            this->lodPixelSizeParam.Param<param::FloatParam>()->SetGUIVisible(true);
             vertShaderName = "sphere_ssbo::vertex";
             fragShaderName = "sphere_ssbo::fragment";
             if (!instance()->ShaderSourceFactory().MakeShaderSource(vertShaderName.PeekBuffer(), *this->vertShader)) {
@@ -540,6 +654,8 @@ bool SphereRenderer::createResources() {
         case (RenderMode::SPLAT): {
             this->alphaScalingParam.Param<param::FloatParam>()->SetGUIVisible(true);
             this->attenuateSubpixelParam.Param<param::BoolParam>()->SetGUIVisible(true);
+            this->lodEnableParam.Param<param::BoolParam>()->SetGUIVisible(true);
+            this->lodPixelSizeParam.Param<param::FloatParam>()->SetGUIVisible(true);
             vertShaderName = "sphere_splat::vertex";
             fragShaderName = "sphere_splat::fragment";
             if (!instance()->ShaderSourceFactory().MakeShaderSource(vertShaderName.PeekBuffer(), *this->vertShader)) {
@@ -746,10 +862,6 @@ bool SphereRenderer::createResources() {
         return false;
     }
 
-    if (this->flagsUseSSBO) {
-        glGenBuffers(1, &this->flagsBuffer);
-    }
-
     return true;
 }
 
@@ -793,6 +905,66 @@ MultiParticleDataCall *SphereRenderer::getData(unsigned int t, float& outScaling
 }
 
 
+bool SphereRenderer::uploadNextFrame(unsigned int frameID) {
+
+    MultiParticleDataCall* c2 = this->getDataSlot.CallAs<MultiParticleDataCall>();
+    if (c2 == nullptr) return false;
+    c2->SetFrameID(frameID, false);
+    if (!(*c2)(1) || (frameID >= c2->FrameCount())) return false;
+    if (this->nextFrame.valid && (this->nextFrame.frameID == frameID) && (this->nextFrame.hash == c2->DataHash())) {
+        return true;
+    }
+
+    c2->SetFrameID(frameID, false);
+    if (!(*c2)(0)) return false;
+    if (c2->FrameID() != frameID) {
+        // still loading
+        c2->Unlock();
+        return false;
+    }
+
+    const unsigned int plc = c2->GetParticleListCount();
+    if (this->nextFrame.buffers.size() < plc) {
+        const size_t first = this->nextFrame.buffers.size();
+        this->nextFrame.buffers.resize(plc);
+        glGenBuffers(static_cast<GLsizei>(plc - first), this->nextFrame.buffers.data() + first);
+    }
+    this->nextFrame.counts.assign(plc, 0);
+
+    std::vector<float> pos;
+    for (unsigned int i = 0; i < plc; ++i) {
+        MultiParticleDataCall::Particles& parts = c2->AccessParticles(i);
+        if (parts.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_NONE) continue;
+        const UINT64 cnt = parts.GetCount();
+        const auto& store = parts.GetParticleStore();
+        glm::vec3 offset(0.0f);
+        float scale = 1.0f;
+        if (parts.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ) {
+            const auto bbox = parts.GetBBox();
+            offset = glm::vec3(bbox.Left(), bbox.Bottom(), bbox.Back());
+            scale = bbox.LongestEdge() / static_cast<float>(SHRT_MAX);
+        }
+        pos.resize(3 * cnt);
+        for (UINT64 j = 0; j < cnt; ++j) {
+            pos[3 * j] = offset.x + store.GetXAcc()->Get_f(j) * scale;
+            pos[3 * j + 1] = offset.y + store.GetYAcc()->Get_f(j) * scale;
+            pos[3 * j + 2] = offset.z + store.GetZAcc()->Get_f(j) * scale;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, this->nextFrame.buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, pos.size() * sizeof(float), pos.data(), GL_STREAM_DRAW);
+        this->nextFrame.counts[i] = cnt;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->nextFrame.hash = c2->DataHash();
+    this->nextFrame.frameID = frameID;
+    this->nextFrame.valid = true;
+    c2->Unlock();
+
+    return true;
+}
+
+
 void SphereRenderer::getClipData(glm::vec4& out_clipDat, glm::vec4& out_clipCol) {
     
     view::CallClipPlane *ccp = this->getClipPlaneSlot.CallAs<view::CallClipPlane>();
@@ -818,6 +990,115 @@ void SphereRenderer::getClipData(glm::vec4& out_clipDat, glm::vec4& out_clipCol)
 }
 
 
+bool SphereRenderer::isListVisible(const MultiParticleDataCall::Particles& parts) {
+
+    if (!this->frustumCullingParam.Param<param::BoolParam>()->Value()) return true;
+
+    vislib::math::Cuboid<float> bbox = parts.GetBBox();
+    if (bbox.IsEmpty()) return true;
+
+    // Spheres may reach beyond the box of their centers
+    bbox.Grow(this->getListMaxRadius(parts) * this->radiusScalingParam.Param<param::FloatParam>()->Value());
+
+    // The list is outside if all corners lie on the outer side of the same clip plane
+    unsigned int outside[6] = {0, 0, 0, 0, 0, 0};
+    for (unsigned int c = 0; c < 8; ++c) {
+        const glm::vec4 corner = this->curMVP * glm::vec4((c & 1) ? bbox.Right() : bbox.Left(),
+                                                    (c & 2) ? bbox.Top() : bbox.Bottom(),
+                                                    (c & 4) ? bbox.Front() : bbox.Back(), 1.0f);
+        for (unsigned int d = 0; d < 3; ++d) {
+            if (corner[d] < -corner.w) outside[2 * d]++;
+            if (corner[d] > corner.w) outside[2 * d + 1]++;
+        }
+    }
+
+    for (unsigned int p = 0; p < 6; ++p) {
+        if (outside[p] == 8) return false;
+    }
+    return true;
+}
+
+
+float SphereRenderer::getListMaxRadius(const MultiParticleDataCall::Particles& parts) {
+
+    if (parts.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
+        return parts.GetGlobalRadius();
+    }
+
+    const auto key = std::make_pair(parts.GetVertexData(), parts.GetCount());
+    auto it = this->listMaxRadii.find(key);
+    if (it == this->listMaxRadii.end()) {
+        const auto& racc = parts.GetParticleStore().GetRAcc();
+        float maxRadius = 0.0f;
+        for (UINT64 i = 0; i < parts.GetCount(); ++i) {
+            maxRadius = std::max(maxRadius, racc->Get_f(i));
+        }
+        it = this->listMaxRadii.emplace(key, maxRadius).first;
+    }
+    return it->second;
+}
+
+
+MultiParticleDataCall::Particles& SphereRenderer::selectLevelOfDetail(
+    MultiParticleDataCall* mpdc, unsigned int i, int& outLevel) {
+
+    MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
+    outLevel = -1;
+
+    // Aggregates cannot carry the flags of their particles
+    if (!this->lodEnableParam.Param<param::BoolParam>()->Value() ||
+        (this->getFlagsSlot.CallAs<FlagCall>() != nullptr) || (parts.GetCount() == 0)) {
+        return parts;
+    }
+
+    vislib::math::Cuboid<float> bbox = parts.GetBBox();
+    if (bbox.IsEmpty()) {
+        bbox = mpdc->AccessBoundingBoxes().ObjectSpaceBBox();
+    }
+
+    // Projected size of a unit length at the point of the box closest to the camera
+    const glm::vec3 camPos(this->curCamPos);
+    const glm::vec3 nearest = glm::clamp(camPos, glm::vec3(bbox.Left(), bbox.Bottom(), bbox.Back()),
+        glm::vec3(bbox.Right(), bbox.Top(), bbox.Front()));
+    if (nearest == camPos) {
+        return parts;
+    }
+    const glm::vec4 p0 = this->curMVP * glm::vec4(nearest, 1.0f);
+    const glm::vec4 p1 = this->curMVP * glm::vec4(nearest + glm::vec3(this->curCamUp), 1.0f);
+    if ((p0.w <= 0.0f) || (p1.w <= 0.0f)) {
+        return parts;
+    }
+    const float pixelsPerUnit =
+        std::abs(p1.y / p1.w - p0.y / p0.w) * 0.5f * static_cast<float>(this->curVpHeight);
+    const float maxCellSize = this->lodPixelSizeParam.Param<param::FloatParam>()->Value() / pixelsPerUnit;
+
+    // Coarsest level with small enough cells; the original particles if not even the finest level qualifies
+    const unsigned int numLevels = misc::ParticleLOD::GetLevelCount(parts.GetCount());
+    int level = -1;
+    for (unsigned int l = 0; l < numLevels; ++l) {
+        if (misc::ParticleLOD::GetCellSize(bbox, l) <= maxCellSize) {
+            level = static_cast<int>(l);
+            break;
+        }
+    }
+    if (level < 0) {
+        return parts;
+    }
+
+    if (this->lodHierarchies.size() < mpdc->GetParticleListCount()) {
+        this->lodHierarchies.resize(mpdc->GetParticleListCount());
+        this->lodParticles.resize(mpdc->GetParticleListCount());
+    }
+    if (this->lodHierarchies[i].IsEmpty()) {
+        this->lodHierarchies[i].Build(parts, bbox);
+    }
+    this->lodHierarchies[i].GetLevel(static_cast<unsigned int>(level), parts, this->lodParticles[i]);
+
+    outLevel = level;
+    return this->lodParticles[i];
+}
+
+
 bool SphereRenderer::isRenderModeAvailable(RenderMode rm, bool silent) {
 
     std::string warnstr;
@@ -996,7 +1277,14 @@ bool SphereRenderer::Render(view::CallRender3D_2& call) {
         }
     }
 
-    // Get data
+    // Get data, the next frame first for interpolating, as the current one stays locked while rendering
+    this->frameAlpha = 0.0f;
+    if ((this->renderMode == RenderMode::SIMPLE) && this->interpolateFramesParam.Param<param::BoolParam>()->Value()) {
+        const float time = cr3d->Time();
+        if (this->uploadNextFrame(static_cast<unsigned int>(time) + 1)) {
+            this->frameAlpha = time - std::floor(time);
+        }
+    }
     float scaling = 1.0f;
     MultiParticleDataCall* mpdc = this->getData(static_cast<unsigned int>(cr3d->Time()), scaling);
     if (mpdc == nullptr) return false;
@@ -1012,6 +1300,12 @@ bool SphereRenderer::Render(view::CallRender3D_2& call) {
     const SIZE_T hash = mpdc->DataHash();
     const unsigned int frameID = mpdc->FrameID();
     this->stateInvalid = ((hash != this->oldHash) || (frameID != this->oldFrameID));
+    if (this->stateInvalid) {
+        // Level of detail hierarchies are built on demand for each frame of data
+        this->lodHierarchies.clear();
+        this->lodParticles.clear();
+        this->listMaxRadii.clear();
+    }
 
     // Update read only parameter values of color index range to be set manually in  transfer function
     if (this->stateInvalid) {
@@ -1102,6 +1396,20 @@ bool SphereRenderer::Render(view::CallRender3D_2& call) {
     glEnable(GL_CLIP_DISTANCE0);
     glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
+    // Particle data sent to the GPU by the modes not accounting for their uploads themselves
+    size_t particleBytes = 0;
+    for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
+        MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
+        unsigned int colBytes, vertBytes, colStride, vertStride;
+        bool interleaved;
+        this->getBytesAndStride(parts, colBytes, vertBytes, colStride, vertStride, interleaved);
+        particleBytes += static_cast<size_t>(parts.GetCount()) * (interleaved ? vertStride : (vertStride + colStride));
+    }
+    this->frameUploadBytes = 0;
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+    this->cullingCells.drawn = false;
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
     bool retval = false;
     switch (currentRenderMode) {
     case (RenderMode::SIMPLE):
@@ -1130,6 +1438,19 @@ bool SphereRenderer::Render(view::CallRender3D_2& call) {
         break;
     }
 
+    // Ambient occlusion keeps its buffers until the data changes, SSBO counts its uploads while rendering
+    if (currentRenderMode == RenderMode::AMBIENT_OCCLUSION) {
+        this->frameUploadBytes = this->stateInvalid ? particleBytes : 0;
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+    } else if (this->cullingCells.drawn) {
+        // the cells count their uploads when built
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+    } else if (currentRenderMode != RenderMode::SSBO_STREAM) {
+        this->frameUploadBytes = particleBytes;
+    }
+    this->uploadInfoParam.Param<param::FloatParam>()->SetValue(
+        static_cast<float>(this->frameUploadBytes) / (1024.0f * 1024.0f), false);
+
     // Reset OpenGl state
     glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
     glDisable(GL_DEPTH_TEST);
@@ -1168,10 +1489,24 @@ bool SphereRenderer::renderSimple(view::CallRender3D_2* cr3d, MultiParticleDataC
     glUniformMatrix4fv(this->sphereShader.ParameterLocation("MVPinv"), 1, GL_FALSE, glm::value_ptr(this->curMVPinv));
     glUniformMatrix4fv(this->sphereShader.ParameterLocation("MVPtransp"), 1, GL_FALSE, glm::value_ptr(this->curMVPtransp));
 
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+    if (this->useCellCulling(mpdc) && this->renderCullingCells(mpdc)) {
+        this->unsetFlagStorage(this->sphereShader);
+        this->sphereShader.Disable();
+        mpdc->Unlock();
+        return true;
+    }
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
     GLuint flagPartsCount = 0;
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
         MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
 
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
+
         if (!this->setShaderData(this->sphereShader, parts)) {
             continue;
         }
@@ -1198,8 +1533,24 @@ bool SphereRenderer::renderSimple(view::CallRender3D_2* cr3d, MultiParticleDataC
             this->setBufferData(this->sphereShader, parts, 0, parts.GetVertexData(), 0, parts.GetColourData());
         }
 
+        // positions of the next frame, see uploadNextFrame
+        const GLint nextPosAttribLoc = glGetAttribLocation(this->sphereShader, "inNextPosition");
+        const bool interpolate = (this->frameAlpha > 0.0f) && (nextPosAttribLoc != -1) &&
+                                 (i < this->nextFrame.counts.size()) && (this->nextFrame.counts[i] == parts.GetCount());
+        glUniform1f(this->sphereShader.ParameterLocation("frameAlpha"), interpolate ? this->frameAlpha : 0.0f);
+        if (interpolate) {
+            glBindBuffer(GL_ARRAY_BUFFER, this->nextFrame.buffers[i]);
+            glEnableVertexAttribArray(nextPosAttribLoc);
+            glVertexAttribPointer(nextPosAttribLoc, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
         glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(parts.GetCount()));
 
+        if (interpolate) {
+            glDisableVertexAttribArray(nextPosAttribLoc);
+        }
+
         if (this->renderMode == RenderMode::SIMPLE_CLUSTERED) {
             if (parts.IsVAO()) {
                 glBindVertexArray(0);
@@ -1219,6 +1570,421 @@ bool SphereRenderer::renderSimple(view::CallRender3D_2* cr3d, MultiParticleDataC
 }
 
 
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+bool SphereRenderer::useCellCulling(MultiParticleDataCall* mpdc) const {
+
+    if (!this->cellCullingAvailable || (this->renderMode != RenderMode::SIMPLE) ||
+        !this->cellCullingParam.Param<param::BoolParam>()->Value()) {
+        return false;
+    }
+
+    // Flags and the positions of the next frame are indexed in the original order
+    if (this->flagsEnabled || (this->frameAlpha > 0.0f)) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
+        const MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
+        switch (parts.GetVertexDataType()) {
+        case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+        case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+        case MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ:
+            break;
+        default:
+            // Quantised positions would need the bounds of the list for sorting them
+            if (parts.GetCount() > 0) return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool SphereRenderer::buildCullingCells(MultiParticleDataCall* mpdc) {
+
+    // About that many particles per cell, in cells of about equal extent
+    const double particlesPerCell = 4096.0;
+    const int maxCellsPerAxis = 64;
+
+    struct Cell {
+        float lo[4];
+        float hi[4];
+        GLuint info[4];
+    };
+
+    this->releaseCullingCells();
+    CullingCells& cc = this->cullingCells;
+
+    const unsigned int listCount = mpdc->GetParticleListCount();
+    cc.vertexBuffers.assign(listCount, 0);
+    cc.colourBuffers.assign(listCount, 0);
+    cc.listCells.assign(listCount, 0);
+    cc.listFirstCell.assign(listCount, 0);
+
+    std::vector<Cell> cells;
+    std::vector<GLuint> cellOf;
+    std::vector<UINT64> cellStarts;
+    std::vector<UINT64> order;
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned char> colours;
+    size_t uploadBytes = 0;
+
+    for (unsigned int l = 0; l < listCount; l++) {
+        const MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(l);
+        const UINT64 count = parts.GetCount();
+        cc.listFirstCell[l] = static_cast<GLuint>(cells.size());
+        if (count == 0) continue;
+
+        const auto& store = parts.GetParticleStore();
+        const auto& xacc = store.GetXAcc();
+        const auto& yacc = store.GetYAcc();
+        const auto& zacc = store.GetZAcc();
+        const auto& racc = store.GetRAcc();
+
+        // Bounds of the centers, as the bounding box of a list is optional
+        glm::vec3 lo(std::numeric_limits<float>::max());
+        glm::vec3 hi(-std::numeric_limits<float>::max());
+        for (UINT64 i = 0; i < count; ++i) {
+            const glm::vec3 p(xacc->Get_f(i), yacc->Get_f(i), zacc->Get_f(i));
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        const glm::vec3 extent = hi - lo;
+        const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+        int dims[3] = {1, 1, 1};
+        if (maxExtent > 0.0f) {
+            double volume = 1.0;
+            for (int d = 0; d < 3; ++d) {
+                volume *= std::max(extent[d], maxExtent / maxCellsPerAxis);
+            }
+            const float edge =
+                static_cast<float>(std::cbrt(volume * particlesPerCell / static_cast<double>(count)));
+            for (int d = 0; d < 3; ++d) {
+                dims[d] = std::max(1, std::min(maxCellsPerAxis, static_cast<int>(std::ceil(extent[d] / edge))));
+            }
+        }
+
+        // Counting sort of the particles by cell
+        const size_t gridCells = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+        cellOf.resize(count);
+        cellStarts.assign(gridCells + 1, 0);
+        for (UINT64 i = 0; i < count; ++i) {
+            const glm::vec3 p(xacc->Get_f(i), yacc->Get_f(i), zacc->Get_f(i));
+            int c[3];
+            for (int d = 0; d < 3; ++d) {
+                c[d] = (extent[d] > 0.0f) ? static_cast<int>((p[d] - lo[d]) / extent[d] * dims[d]) : 0;
+                c[d] = std::max(0, std::min(dims[d] - 1, c[d]));
+            }
+            cellOf[i] = static_cast<GLuint>((c[2] * dims[1] + c[1]) * dims[0] + c[0]);
+            ++cellStarts[cellOf[i] + 1];
+        }
+        for (size_t c = 0; c < gridCells; ++c) {
+            cellStarts[c + 1] += cellStarts[c];
+        }
+        order.resize(count);
+        {
+            std::vector<UINT64> next(cellStarts.begin(), cellStarts.end() - 1);
+            for (UINT64 i = 0; i < count; ++i) {
+                order[next[cellOf[i]]++] = i;
+            }
+        }
+
+        // Tightly packed copies in cell order
+        const unsigned int vertBytes = MultiParticleDataCall::Particles::VertexDataSize[parts.GetVertexDataType()];
+        const unsigned int vertStride = std::max(parts.GetVertexDataStride(), vertBytes);
+        const unsigned int colBytes = MultiParticleDataCall::Particles::ColorDataSize[parts.GetColourDataType()];
+        const unsigned int colStride = std::max(parts.GetColourDataStride(), colBytes);
+        const unsigned char* vertSrc = static_cast<const unsigned char*>(parts.GetVertexData());
+        const unsigned char* colSrc = static_cast<const unsigned char*>(parts.GetColourData());
+        vertices.resize(count * vertBytes);
+        colours.resize(count * colBytes);
+        for (UINT64 s = 0; s < count; ++s) {
+            const UINT64 i = order[s];
+            std::memcpy(vertices.data() + s * vertBytes, vertSrc + i * vertStride, vertBytes);
+            if (colBytes > 0) {
+                std::memcpy(colours.data() + s * colBytes, colSrc + i * colStride, colBytes);
+            }
+        }
+
+        // Bounds of the non-empty cells
+        for (size_t c = 0; c < gridCells; ++c) {
+            if (cellStarts[c] == cellStarts[c + 1]) continue;
+            Cell cell;
+            glm::vec3 clo(std::numeric_limits<float>::max());
+            glm::vec3 chi(-std::numeric_limits<float>::max());
+            float maxRadius = 0.0f;
+            for (UINT64 s = cellStarts[c]; s < cellStarts[c + 1]; ++s) {
+                const UINT64 i = order[s];
+                const glm::vec3 p(xacc->Get_f(i), yacc->Get_f(i), zacc->Get_f(i));
+                clo = glm::min(clo, p);
+                chi = glm::max(chi, p);
+                maxRadius = std::max(maxRadius, racc->Get_f(i));
+            }
+            for (int d = 0; d < 3; ++d) {
+                cell.lo[d] = clo[d];
+                cell.hi[d] = chi[d];
+            }
+            cell.lo[3] = maxRadius;
+            cell.hi[3] = 0.0f;
+            cell.info[0] = static_cast<GLuint>(cellStarts[c]);
+            cell.info[1] = static_cast<GLuint>(cellStarts[c + 1] - cellStarts[c]);
+            cell.info[2] = l;
+            cell.info[3] = cc.listFirstCell[l];
+            cells.push_back(cell);
+        }
+        cc.listCells[l] = static_cast<GLuint>(cells.size()) - cc.listFirstCell[l];
+
+        glGenBuffers(1, &cc.vertexBuffers[l]);
+        glBindBuffer(GL_ARRAY_BUFFER, cc.vertexBuffers[l]);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+        if (colBytes > 0) {
+            glGenBuffers(1, &cc.colourBuffers[l]);
+            glBindBuffer(GL_ARRAY_BUFFER, cc.colourBuffers[l]);
+            glBufferData(GL_ARRAY_BUFFER, colours.size(), colours.data(), GL_STATIC_DRAW);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploadBytes += vertices.size() + colours.size();
+    }
+    cc.cellCount = static_cast<GLuint>(cells.size());
+
+    // Three sets of draw commands and their counts: the visible cells of alternating frames and the new ones
+    const std::vector<GLuint> visible(cc.cellCount, 0);
+    const std::vector<GLuint> counters(3 * listCount, 0);
+    glGenBuffers(1, &cc.cellBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cc.cellBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, cells.size() * sizeof(Cell), cells.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &cc.visibleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cc.visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, visible.size() * sizeof(GLuint), visible.data(), GL_DYNAMIC_COPY);
+    glGenBuffers(1, &cc.commandBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cc.commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 3 * cells.size() * 4 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &cc.counterBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cc.counterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, counters.size() * sizeof(GLuint), counters.data(), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        vislib::sys::Log::DefaultLog.WriteWarn("[SphereRenderer] Out of memory for the culling cells");
+        this->releaseCullingCells();
+        return false;
+    }
+
+    cc.hash = mpdc->DataHash();
+    cc.frameID = mpdc->FrameID();
+    cc.lastSet = 0;
+    cc.valid = true;
+    this->frameUploadBytes = uploadBytes;
+
+    return true;
+}
+
+
+bool SphereRenderer::renderCullingCells(MultiParticleDataCall* mpdc) {
+
+    CullingCells& cc = this->cullingCells;
+    const unsigned int listCount = mpdc->GetParticleListCount();
+    if (!cc.valid || (cc.hash != mpdc->DataHash()) || (cc.frameID != mpdc->FrameID()) ||
+        (cc.listCells.size() != listCount)) {
+        if (!this->buildCullingCells(mpdc)) {
+            return false;
+        }
+    }
+    cc.drawn = true;
+    const unsigned int visibleSet = 1 - cc.lastSet;
+    const unsigned int newSet = 2;
+
+    // The cells visible in the last frame fill the depth buffer
+    this->drawCullingCells(mpdc, cc.lastSet);
+    this->sphereShader.Disable();
+
+    const bool occlusion = this->buildDepthPyramid();
+
+    const std::vector<GLuint> zeros(listCount, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cc.counterBuffer);
+    glBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, visibleSet * listCount * sizeof(GLuint), listCount * sizeof(GLuint), zeros.data());
+    glBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, newSet * listCount * sizeof(GLuint), listCount * sizeof(GLuint), zeros.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (cc.cellCount > 0) {
+        this->cellCullShader.Enable();
+        glUniform1ui(this->cellCullShader.ParameterLocation("cellCount"), cc.cellCount);
+        glUniform1ui(this->cellCullShader.ParameterLocation("listCount"), listCount);
+        glUniform1ui(this->cellCullShader.ParameterLocation("visibleSet"), visibleSet);
+        glUniformMatrix4fv(this->cellCullShader.ParameterLocation("MVP"), 1, GL_FALSE, glm::value_ptr(this->curMVP));
+        glUniform1f(this->cellCullShader.ParameterLocation("scaling"),
+            this->radiusScalingParam.Param<param::FloatParam>()->Value());
+        glUniform2f(this->cellCullShader.ParameterLocation("viewport"), static_cast<float>(cc.pyramidWidth),
+            static_cast<float>(cc.pyramidHeight));
+        glUniform1i(this->cellCullShader.ParameterLocation("useOcclusion"), occlusion ? 1 : 0);
+        glUniform1i(this->cellCullShader.ParameterLocation("maxLevel"), std::max(cc.pyramidLevels - 1, 0));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, cc.depthPyramid);
+        glUniform1i(this->cellCullShader.ParameterLocation("depthPyramid"), 0);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, cc.cellBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cc.visibleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cc.commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cc.counterBuffer);
+        this->cellCullShader.Dispatch((cc.cellCount + 63) / 64, 1, 1);
+        for (GLuint binding = 0; binding < 4; binding++) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->cellCullShader.Disable();
+    }
+
+    // The compacted lists are read as draw commands and draw counts
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // The cells that became visible
+    this->sphereShader.Enable();
+    this->drawCullingCells(mpdc, newSet);
+    cc.lastSet = visibleSet;
+
+    return true;
+}
+
+
+void SphereRenderer::drawCullingCells(MultiParticleDataCall* mpdc, unsigned int set) {
+
+    const CullingCells& cc = this->cullingCells;
+    const size_t listCount = cc.listCells.size();
+
+    glUniform1ui(this->sphereShader.ParameterLocation("flagsAvailable"), 0);
+    glUniform1f(this->sphereShader.ParameterLocation("frameAlpha"), 0.0f);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, cc.commandBuffer);
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, cc.counterBuffer);
+    for (unsigned int l = 0; l < listCount; l++) {
+        if (cc.listCells[l] == 0) continue;
+
+        MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(l);
+        if (!this->setShaderData(this->sphereShader, parts)) {
+            continue;
+        }
+
+        // The copies in cell order are tightly packed
+        MultiParticleDataCall::Particles sorted(parts);
+        sorted.SetVertexData(parts.GetVertexDataType(), parts.GetVertexData());
+        sorted.SetColourData(parts.GetColourDataType(), parts.GetColourData());
+        this->setBufferData(this->sphereShader, sorted, cc.vertexBuffers[l], nullptr, cc.colourBuffers[l], nullptr);
+
+        const size_t firstCommand = static_cast<size_t>(set) * cc.cellCount + cc.listFirstCell[l];
+        glMultiDrawArraysIndirectCountARB(GL_POINTS, reinterpret_cast<const void*>(firstCommand * 4 * sizeof(GLuint)),
+            static_cast<GLintptr>((set * listCount + l) * sizeof(GLuint)), static_cast<GLsizei>(cc.listCells[l]), 0);
+
+        this->unsetBufferData(this->sphereShader);
+        this->unsetShaderData();
+    }
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+
+bool SphereRenderer::buildDepthPyramid(void) {
+
+    CullingCells& cc = this->cullingCells;
+
+    GLint vp[4];
+    glGetIntegerv(GL_VIEWPORT, vp);
+    if ((vp[2] < 1) || (vp[3] < 1)) {
+        return false;
+    }
+
+    if ((cc.pyramidWidth != vp[2]) || (cc.pyramidHeight != vp[3])) {
+        if (cc.depthTex != 0) glDeleteTextures(1, &cc.depthTex);
+        if (cc.depthPyramid != 0) glDeleteTextures(1, &cc.depthPyramid);
+        cc.pyramidWidth = vp[2];
+        cc.pyramidHeight = vp[3];
+        cc.pyramidLevels = 1 + static_cast<int>(std::floor(std::log2(std::max(vp[2], vp[3]))));
+
+        glGenTextures(1, &cc.depthTex);
+        glBindTexture(GL_TEXTURE_2D, cc.depthTex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, cc.pyramidWidth, cc.pyramidHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+        glGenTextures(1, &cc.depthPyramid);
+        glBindTexture(GL_TEXTURE_2D, cc.depthPyramid);
+        glTexStorage2D(GL_TEXTURE_2D, cc.pyramidLevels, GL_R32F, cc.pyramidWidth, cc.pyramidHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // The depth of the framebuffer being drawn to, unless it has none or is multisampled
+    GLint drawFbo = 0;
+    GLint readFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, drawFbo);
+    GLint sampleBuffers = 0;
+    GLint depthType = GL_NONE;
+    glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, (drawFbo == 0) ? GL_DEPTH : GL_DEPTH_ATTACHMENT,
+        GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &depthType);
+    const bool readable = (sampleBuffers == 0) && (depthType != GL_NONE);
+    if (readable) {
+        glBindTexture(GL_TEXTURE_2D, cc.depthTex);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, vp[0], vp[1], vp[2], vp[3]);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+    if (!readable) {
+        return false;
+    }
+
+    this->depthInitShader.Enable();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, cc.depthTex);
+    glUniform1i(this->depthInitShader.ParameterLocation("depthTex"), 0);
+    glBindImageTexture(0, cc.depthPyramid, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    this->depthInitShader.Dispatch((cc.pyramidWidth + 15) / 16, (cc.pyramidHeight + 15) / 16, 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->depthInitShader.Disable();
+
+    // Each level keeps the farthest depth of the texels it covers
+    this->depthReduceShader.Enable();
+    for (int level = 1; level < cc.pyramidLevels; ++level) {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glBindImageTexture(0, cc.depthPyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, cc.depthPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        const int width = std::max(cc.pyramidWidth >> level, 1);
+        const int height = std::max(cc.pyramidHeight >> level, 1);
+        this->depthReduceShader.Dispatch((width + 15) / 16, (height + 15) / 16, 1);
+    }
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    this->depthReduceShader.Disable();
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    return true;
+}
+
+
+void SphereRenderer::releaseCullingCells(void) {
+
+    CullingCells& cc = this->cullingCells;
+    for (GLuint& b : cc.vertexBuffers) {
+        if (b != 0) glDeleteBuffers(1, &b);
+    }
+    for (GLuint& b : cc.colourBuffers) {
+        if (b != 0) glDeleteBuffers(1, &b);
+    }
+    GLuint buffers[4] = {cc.cellBuffer, cc.visibleBuffer, cc.commandBuffer, cc.counterBuffer};
+    for (GLuint& b : buffers) {
+        if (b != 0) glDeleteBuffers(1, &b);
+    }
+    if (cc.depthTex != 0) glDeleteTextures(1, &cc.depthTex);
+    if (cc.depthPyramid != 0) glDeleteTextures(1, &cc.depthPyramid);
+    cc = CullingCells();
+}
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
+
 bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCall* mpdc) {
 
 #ifdef CHRONOTIMING
@@ -1226,14 +1992,27 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
     std::chrono::steady_clock::time_point before, after;
 #endif
 
+    // Close the upload statistics of the last frame, adapting the streaming sizes to them
+    if (this->adaptiveStreamingParam.IsDirty()) {
+        this->adaptiveStreamingParam.ResetDirty();
+        const bool adaptive = this->adaptiveStreamingParam.Param<param::BoolParam>()->Value();
+        this->streamer.SetAutoSizing(adaptive);
+        this->colStreamer.SetAutoSizing(adaptive);
+    }
+    this->streamer.NewFrame();
+    this->colStreamer.NewFrame();
+
     // this->currBuf = 0;
     GLuint flagPartsCount = 0;
-    if (this->stateInvalid) {
-        this->bufArray.resize(mpdc->GetParticleListCount());
-        this->colBufArray.resize(mpdc->GetParticleListCount());
-    }
+    this->residencyClock++;
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
-        MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
+        int lodLevel = -1;
+        MultiParticleDataCall::Particles& parts = this->selectLevelOfDetail(mpdc, i, lodLevel);
+
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
 
         if (colType != parts.GetColourDataType() || vertType != parts.GetVertexDataType()) {
             this->newShader = this->generateShader(parts);
@@ -1277,12 +2056,18 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
         // does all data reside interleaved in the same memory?
         if (interleaved) {
             if (staticData) {
-                auto& bufA = this->bufArray[i];
-                if (this->stateInvalid || (bufA.GetNumChunks() == 0)) {
+                auto& resident = this->residentLists[std::make_tuple(mpdc->DataHash(), mpdc->FrameID(), i, lodLevel)];
+                auto& bufA = resident.vertices;
+                if (bufA.GetNumChunks() == 0) {
                     bufA.SetDataWithSize(parts.GetVertexData(), vertStride, vertStride, parts.GetCount(),
                         (GLuint)(2 * 1024 * 1024 * 1024));
                     // 2 GB - khronos: Most implementations will let you allocate a size up to the limit of GPU memory.
+                    this->residentBytes -= resident.bytes;
+                    resident.bytes = static_cast<size_t>(parts.GetCount()) * vertStride;
+                    this->residentBytes += resident.bytes;
+                    this->frameUploadBytes += resident.bytes;
                 }
+                resident.lastUsed = this->residencyClock;
                 const GLuint numChunks = bufA.GetNumChunks();
 
                 for (GLuint x = 0; x < numChunks; ++x) {
@@ -1298,6 +2083,7 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
             } else {
                 const GLuint numChunks = this->streamer.SetDataWithSize(
                     parts.GetVertexData(), vertStride, vertStride, parts.GetCount(), 3, (GLuint)(32 * 1024 * 1024));
+                this->frameUploadBytes += static_cast<size_t>(parts.GetCount()) * vertStride;
                 glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->streamer.GetHandle());
                 glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBOvertexBindingPoint, this->streamer.GetHandle());
 
@@ -1319,15 +2105,21 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
             }
         } else {
             if (staticData) {
-                auto& bufA = this->bufArray[i];
-                auto& colA = this->colBufArray[i];
-                if (this->stateInvalid || (bufA.GetNumChunks() == 0)) {
+                auto& resident = this->residentLists[std::make_tuple(mpdc->DataHash(), mpdc->FrameID(), i, lodLevel)];
+                auto& bufA = resident.vertices;
+                auto& colA = resident.colours;
+                if (bufA.GetNumChunks() == 0) {
                     bufA.SetDataWithSize(parts.GetVertexData(), vertStride, vertStride, parts.GetCount(),
                         (GLuint)(2 * 1024 * 1024 * 1024));
                     // 2 GB - khronos: Most implementations will let you allocate a size up to the limit of GPU memory.
                     colA.SetDataWithItems(parts.GetColourData(), colStride, colStride, parts.GetCount(),
                         bufA.GetMaxNumItemsPerChunk());
+                    this->residentBytes -= resident.bytes;
+                    resident.bytes = static_cast<size_t>(parts.GetCount()) * (vertStride + colStride);
+                    this->residentBytes += resident.bytes;
+                    this->frameUploadBytes += resident.bytes;
                 }
+                resident.lastUsed = this->residencyClock;
                 const GLuint numChunks = bufA.GetNumChunks();
 
                 for (GLuint x = 0; x < numChunks; ++x) {
@@ -1350,6 +2142,7 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
                     parts.GetVertexData(), vertStride, vertStride, parts.GetCount(), 3, (GLuint)(32 * 1024 * 1024));
                 const GLuint colSize = this->colStreamer.SetDataWithItems(parts.GetColourData(), colStride, colStride,
                     parts.GetCount(), 3, this->streamer.GetMaxNumItemsPerChunk());
+                this->frameUploadBytes += static_cast<size_t>(parts.GetCount()) * (vertStride + colStride);
                 glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->streamer.GetHandle());
                 glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBOvertexBindingPoint, this->streamer.GetHandle());
                 glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->colStreamer.GetHandle());
@@ -1391,10 +2184,43 @@ bool SphereRenderer::renderSSBO(view::CallRender3D_2* cr3d, MultiParticleDataCal
 
     mpdc->Unlock();
 
+#ifdef CHRONOTIMING
+    const auto& stats = this->streamer.GetFrameStatistics();
+    printf("streamer: %u uploads, %u fence stalls (%.3f ms), %.1f MB/s, ring of %u\n", stats.numUploads,
+        stats.numStalls, stats.stallTime, this->streamer.GetUploadBandwidth() / (1024.0 * 1024.0),
+        this->streamer.GetNumBuffers());
+#endif
+
+    // Without static data nothing is kept resident
+    size_t budget = 0;
+    if (this->useStaticDataParam.Param<param::BoolParam>()->Value()) {
+        budget = static_cast<size_t>(this->residencyBudgetParam.Param<param::IntParam>()->Value()) * 1024 * 1024;
+    }
+    this->evictResidentLists(budget);
+
     return true;
 }
 
 
+void SphereRenderer::evictResidentLists(size_t budget) {
+
+    while (this->residentBytes > budget) {
+        auto lru = this->residentLists.end();
+        for (auto it = this->residentLists.begin(); it != this->residentLists.end(); ++it) {
+            if ((it->second.lastUsed != this->residencyClock) &&
+                ((lru == this->residentLists.end()) || (it->second.lastUsed < lru->second.lastUsed))) {
+                lru = it;
+            }
+        }
+        if (lru == this->residentLists.end()) {
+            break; // Only lists of the current frame are left
+        }
+        this->residentBytes -= lru->second.bytes;
+        this->residentLists.erase(lru);
+    }
+}
+
+
 bool SphereRenderer::renderSplat(view::CallRender3D_2* cr3d, MultiParticleDataCall* mpdc) {
 
     glDisable(GL_DEPTH_TEST);
@@ -1420,7 +2246,13 @@ bool SphereRenderer::renderSplat(view::CallRender3D_2* cr3d, MultiParticleDataCa
     // this->currBuf = 0;
     GLuint flagPartsCount = 0;
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
-        MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
+        int lodLevel = -1;
+        MultiParticleDataCall::Particles& parts = this->selectLevelOfDetail(mpdc, i, lodLevel);
+
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
 
         if (colType != parts.GetColourDataType() || vertType != parts.GetVertexDataType()) {
             this->newShader = this->generateShader(parts);
@@ -1547,6 +2379,11 @@ bool SphereRenderer::renderBufferArray(view::CallRender3D_2* cr3d, MultiParticle
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
         MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
 
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
+
         if (!this->setShaderData(this->sphereShader, parts)) {
             continue;
         }
@@ -1656,6 +2493,11 @@ bool SphereRenderer::renderGeometryShader(view::CallRender3D_2* cr3d, MultiParti
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
         MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
 
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
+
         if (!this->setShaderData(this->sphereGeometryShader, parts)) {
             continue;
         }
@@ -1806,6 +2648,11 @@ bool SphereRenderer::renderOutline(view::CallRender3D_2* cr3d, MultiParticleData
     for (unsigned int i = 0; i < mpdc->GetParticleListCount(); i++) {
         MultiParticleDataCall::Particles& parts = mpdc->AccessParticles(i);
 
+        if (!this->isListVisible(parts)) {
+            flagPartsCount += parts.GetCount();
+            continue;
+        }
+
         if (!this->setShaderData(this->sphereShader, parts)) {
             continue;
         }
@@ -2014,6 +2861,7 @@ bool SphereRenderer::setShaderData(vislib::graphics::gl::GLSLShader& shader, con
     glUniform1i(shader.ParameterLocation("useTf"), static_cast<GLint>(useTf));
 
     // radius and position
+    glUniform1f(shader.ParameterLocation("quantScale"), 0.0f);
     switch (parts.GetVertexDataType()) {
     case MultiParticleDataCall::Particles::VERTDATA_NONE:
         return false;
@@ -2024,8 +2872,13 @@ bool SphereRenderer::setShaderData(vislib::graphics::gl::GLSLShader& shader, con
     case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
         glUniform1f(shader.ParameterLocation("constRad"), -1.0f);
         break;
-    case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
+    case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ: {
+        // quantised relative to the list bounds, see MMPLDWriter
+        const auto bbox = parts.GetBBox();
         glUniform1f(shader.ParameterLocation("constRad"), parts.GetGlobalRadius());
+        glUniform3f(shader.ParameterLocation("quantOffset"), bbox.Left(), bbox.Bottom(), bbox.Back());
+        glUniform1f(shader.ParameterLocation("quantScale"), bbox.LongestEdge() / static_cast<float>(SHRT_MAX));
+    } break;
     default:
         return false;
     }
@@ -2091,20 +2944,15 @@ bool SphereRenderer::setFlagStorage(const vislib::graphics::gl::GLSLShader& shad
     ((*flagc)(FlagCall::CallMapFlags));
     flagc->validateFlagsCount(partsCount);
 
+    if (this->flagsUseSSBO) {
+        // The buffer of the flag storage is shared with the other renderers and only updated on change.
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBOflagsBindingPoint, flagc->GetFlagsBuffer());
+    }
+
     this->flagsData = nullptr;
     this->flagsData = flagc->GetFlags();
 
-    if (this->flagsUseSSBO) {
-        auto version = flagc->GetVersion();
-        if ((version != this->flagsCurrentVersion) || (version == 0)) {
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->flagsBuffer);
-            glBufferData(GL_SHADER_STORAGE_BUFFER, partsCount * sizeof(FlagStorage::FlagItemType),
-                this->flagsData.get()->data(), GL_STATIC_DRAW);
-            this->flagsCurrentVersion = flagc->GetVersion();
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-        }
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBOflagsBindingPoint, this->flagsBuffer);
-    } else {
+    if (!this->flagsUseSSBO) {
         GLuint flagAttrib = glGetAttribLocation(shader, "inFlags");
         glEnableVertexAttribArray(flagAttrib);
         glVertexAttribIPointer(
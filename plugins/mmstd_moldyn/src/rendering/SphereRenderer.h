@@ -9,6 +9,7 @@
 #define MEGAMOL_MOLDYN_SPHERERENDERER_H_INCLUDED
 
 #include "misc/MDAOVolumeGenerator.h"
+#include "misc/ParticleLOD.h"
 
 #include "mmcore/Call.h"
 #include "mmcore/CallerSlot.h"
@@ -37,6 +38,7 @@
 #include "vislib/graphics/gl/ShaderSource.h"
 #include "vislib/graphics/gl/GLSLShader.h"
 #include "vislib/graphics/gl/GLSLGeometryShader.h"
+#include "vislib/graphics/gl/GLSLComputeShader.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
 #include "vislib/graphics/gl/CameraOpenGL.h"
 #include "vislib/graphics/CameraParameters.h"
@@ -51,6 +53,7 @@
 #include <utility>
 #include <cmath>
 #include <cinttypes>
+#include <climits>
 #include <chrono>
 #include <sstream>
 #include <iterator>
@@ -58,6 +61,8 @@
 #include <GL/glu.h>
 #include <algorithm>
 #include <vector>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <sstream>
 #include <deque>
@@ -85,6 +90,7 @@
 #ifdef GL_VERSION_4_3
 #define SPHERE_MIN_OGL_SSBO_STREAM
 #define SPHERE_MIN_OGL_AMBIENT_OCCLUSION
+#define SPHERE_MIN_OGL_CELL_CULLING
 #endif // GL_VERSION_4_3
 
 #ifdef GL_VERSION_4_5
@@ -295,9 +301,7 @@ namespace rendering {
         GLuint                                   greyTF;
 
         bool                                     flagsEnabled;
-        GLuint                                   flagsBuffer;
         bool                                     flagsUseSSBO;
-        FlagStorage::FlagVersionType             flagsCurrentVersion;
         std::shared_ptr<FlagStorage::FlagVectorType> flagsData;
 
         GLSLShader                               sphereShader;
@@ -327,8 +331,61 @@ namespace rendering {
         bool                                     stateInvalid;
         glm::vec2                                ambConeConstants;
         misc::MDAOVolumeGenerator               *volGen;
+        std::vector<misc::ParticleLOD>           lodHierarchies;
+        std::vector<MultiParticleDataCall::Particles> lodParticles;
         bool                                     triggerRebuildGBuffer;
 
+        /** Positions of the frame following the current one, for interpolating between both in simple mode */
+        struct NextFrame {
+            SIZE_T              hash = 0;
+            unsigned int        frameID = 0;
+            bool                valid = false;
+            std::vector<GLuint> buffers;
+            std::vector<UINT64> counts;
+        };
+        NextFrame                                nextFrame;
+        float                                    frameAlpha;
+
+        /** Maximum radius of the particle lists with per-particle radii, by vertex data and count */
+        std::map<std::pair<const void*, UINT64>, float> listMaxRadii;
+
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+        /**
+         * Particles of the simple mode sorted into the cells of a grid per list. The cells are culled on the GPU
+         * and the visible ones drawn with indirect draws, in two passes: The cells visible in the last frame are
+         * drawn first and fill the depth buffer, the pyramid built from it then culls all cells, and those not
+         * drawn yet follow.
+         */
+        struct CullingCells {
+            SIZE_T              hash = 0;
+            unsigned int        frameID = 0;
+            bool                valid = false;
+            GLuint              cellCount = 0;
+            std::vector<GLuint> vertexBuffers;
+            std::vector<GLuint> colourBuffers;
+            std::vector<GLuint> listCells;
+            std::vector<GLuint> listFirstCell;
+            GLuint              cellBuffer = 0;
+            GLuint              visibleBuffer = 0;
+            GLuint              commandBuffer = 0;
+            GLuint              counterBuffer = 0;
+            /** The set of draw commands holding the cells visible in the last frame */
+            unsigned int        lastSet = 0;
+            /** Whether the current frame was drawn from the cells */
+            bool                drawn = false;
+            GLuint              depthTex = 0;
+            GLuint              depthPyramid = 0;
+            int                 pyramidWidth = 0;
+            int                 pyramidHeight = 0;
+            int                 pyramidLevels = 0;
+        };
+        CullingCells                             cullingCells;
+        bool                                     cellCullingAvailable;
+        vislib::graphics::gl::GLSLComputeShader  cellCullShader;
+        vislib::graphics::gl::GLSLComputeShader  depthInitShader;
+        vislib::graphics::gl::GLSLComputeShader  depthReduceShader;
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
         //TimeMeasure                            timer;
 
 #if defined(SPHERE_MIN_OGL_BUFFER_ARRAY) || defined(SPHERE_MIN_OGL_SPLAT)
@@ -340,8 +397,22 @@ namespace rendering {
 #ifdef SPHERE_MIN_OGL_SSBO_STREAM
         megamol::core::utility::SSBOStreamer                  streamer;
         megamol::core::utility::SSBOStreamer                  colStreamer;
-        std::vector<megamol::core::utility::SSBOBufferArray>  bufArray;
-        std::vector<megamol::core::utility::SSBOBufferArray>  colBufArray;
+
+        /** Particle list kept in device memory for static data */
+        struct ResidentList {
+            megamol::core::utility::SSBOBufferArray vertices;
+            megamol::core::utility::SSBOBufferArray colours;
+            size_t                                  bytes = 0;
+            unsigned int                            lastUsed = 0;
+        };
+
+        /** Resident particle lists by data hash, frame ID, list index and level of detail */
+        std::map<std::tuple<SIZE_T, unsigned int, unsigned int, int>, ResidentList> residentLists;
+        size_t                                   residentBytes;
+
+        /** Bytes of particle data uploaded in the current frame */
+        size_t                                   frameUploadBytes;
+        unsigned int                             residencyClock;
 #endif // SPHERE_MIN_OGL_SSBO_STREAM
 
         /*********************************************************************/
@@ -359,17 +430,31 @@ namespace rendering {
 
         megamol::core::param::ParamSlot renderModeParam;
         megamol::core::param::ParamSlot colIdxRangeInfoParam;
+        megamol::core::param::ParamSlot uploadInfoParam;
         megamol::core::param::ParamSlot radiusScalingParam;
         megamol::core::param::ParamSlot forceTimeSlot;
         megamol::core::param::ParamSlot useLocalBBoxParam;
+        megamol::core::param::ParamSlot frustumCullingParam;
         megamol::core::param::ParamSlot selectColorParam;
         megamol::core::param::ParamSlot softSelectColorParam;
 
+        // Affects only Simple rendering: -------------------------------------
+
+        core::param::ParamSlot interpolateFramesParam;
+        core::param::ParamSlot cellCullingParam;
+
         // Affects only Splat rendering ---------------------------------------
 
         core::param::ParamSlot alphaScalingParam;
         core::param::ParamSlot attenuateSubpixelParam;
         core::param::ParamSlot useStaticDataParam;
+        core::param::ParamSlot residencyBudgetParam;
+        core::param::ParamSlot adaptiveStreamingParam;
+
+        // Affects only Splat and SSBO rendering: -----------------------------
+
+        core::param::ParamSlot lodEnableParam;
+        core::param::ParamSlot lodPixelSizeParam;
 
         // Affects only Ambient Occlusion rendering: --------------------------
 
@@ -405,6 +490,17 @@ namespace rendering {
          */
         MultiParticleDataCall *getData(unsigned int t, float& outScaling);
 
+        /**
+         * Uploads the positions of a frame for interpolating towards it, unless
+         * they are resident already. The frame is not forced, such that
+         * playback does not stall while the data source loads it.
+         *
+         * @param frameID  The frame following the current one.
+         *
+         * @return True if the positions of the frame are available.
+         */
+        bool uploadNextFrame(unsigned int frameID);
+
         /**
          * Return clipping information.
          *
@@ -413,6 +509,87 @@ namespace rendering {
          */
         void getClipData(glm::vec4& out_clipDat, glm::vec4& out_clipCol);
 
+        /**
+         * Test the bounding box of a particle list against the view frustum of the current frame.
+         * Lists without bounding box are always considered visible.
+         *
+         * @param parts  The particles of a list.
+         *
+         * @return 'False' if frustum culling is enabled and the list lies completely outside the frustum, 'true' otherwise.
+         */
+        bool isListVisible(const MultiParticleDataCall::Particles& parts);
+
+        /**
+         * Answer the largest radius of the particles of a list, which is the global radius unless the
+         * particles have their own radii. The radii are scanned once per frame of data.
+         *
+         * @param parts  The particles of a list.
+         *
+         * @return The largest radius, not scaled.
+         */
+        float getListMaxRadius(const MultiParticleDataCall::Particles& parts);
+
+#ifdef SPHERE_MIN_OGL_CELL_CULLING
+        /**
+         * Check whether the simple mode draws the current data from culled cells. Flags, frame interpolation
+         * and clustered lists need the particles in their original order.
+         *
+         * @param mpdc  Pointer to the current multi particle data call.
+         *
+         * @return 'True' if cell culling is enabled, available and applicable.
+         */
+        bool useCellCulling(MultiParticleDataCall* mpdc) const;
+
+        /**
+         * Sorts the particles of each list into the cells of a grid and uploads them with the cell bounds.
+         *
+         * @param mpdc  Pointer to the current multi particle data call.
+         *
+         * @return 'True' on success, 'false' otherwise.
+         */
+        bool buildCullingCells(MultiParticleDataCall* mpdc);
+
+        /**
+         * Draws the visible cells into the current framebuffer, with the sphere shader enabled and set up.
+         *
+         * @param mpdc  Pointer to the current multi particle data call.
+         *
+         * @return 'True' on success, 'false' if the cells cannot be built.
+         */
+        bool renderCullingCells(MultiParticleDataCall* mpdc);
+
+        /**
+         * Draws one set of draw commands of the cells.
+         *
+         * @param mpdc  Pointer to the current multi particle data call.
+         * @param set   The set of draw commands.
+         */
+        void drawCullingCells(MultiParticleDataCall* mpdc, unsigned int set);
+
+        /**
+         * Copies the depth buffer of the current viewport and builds its depth-max pyramid.
+         *
+         * @return 'False' if the depth buffer cannot be read, e.g. being multisampled, 'true' otherwise.
+         */
+        bool buildDepthPyramid(void);
+
+        /** Releases the cells and the depth pyramid */
+        void releaseCullingCells(void);
+#endif // SPHERE_MIN_OGL_CELL_CULLING
+
+        /**
+         * Select the particles to render for a list. If level of detail is enabled and the particles of the list
+         * are smaller than the pixel size, the coarsest level of the list's hierarchy whose cells do not exceed the
+         * pixel size is chosen, building the hierarchy if necessary.
+         *
+         * @param mpdc      Pointer to the current multi particle data call.
+         * @param i         The index of the list.
+         * @param outLevel  The selected level, or -1 for the original particles.
+         *
+         * @return The particles of the list or of the selected level.
+         */
+        MultiParticleDataCall::Particles& selectLevelOfDetail(MultiParticleDataCall* mpdc, unsigned int i, int& outLevel);
+
         /**
          * Check if specified render mode or all render mode are available.
          *
@@ -453,6 +630,14 @@ namespace rendering {
         bool renderAmbientOcclusion(view::CallRender3D_2* cr3d, MultiParticleDataCall* mpdc);
 		bool renderOutline(view::CallRender3D_2* cr3d, MultiParticleDataCall* mpdc);
 
+        /**
+         * Evict the least recently used resident particle lists of static SSBO data until the device memory
+         * they occupy falls below the given budget. Lists used for the current frame are never evicted.
+         *
+         * @param budget           The budget in bytes.
+         */
+        void evictResidentLists(size_t budget);
+
         /**
          * Set pointers to vertex and color buffers and corresponding shader variables.
          *
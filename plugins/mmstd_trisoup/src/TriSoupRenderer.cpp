@@ -26,12 +26,49 @@
 #include "vislib/sys/MemmappedFile.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/Vector.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 using namespace megamol;
 using namespace megamol::trisoup;
 
 using namespace megamol::core;
 
+namespace {
+
+    typedef megamol::geocalls::CallTriMeshData::Mesh Mesh;
+
+    /** Answers the byte offset 'offset' as pointer for the gl*Pointer calls */
+    inline const GLvoid *bufferOffset(SIZE_T offset) {
+        return reinterpret_cast<const GLvoid*>(offset);
+    }
+
+    /** Answers whether 'type' is a floating point type */
+    inline bool isFloatType(Mesh::DataType type) {
+        return (type == Mesh::DT_FLOAT) || (type == Mesh::DT_DOUBLE);
+    }
+
+    /**
+     * Uploads 'cnt' values to the bound array buffer at 'offset' as floats,
+     * converting doubles on the way.
+     */
+    void uploadAsFloat(SIZE_T offset, Mesh::DataType type, const float *f, const double *d, SIZE_T cnt,
+            std::vector<float>& scratch) {
+        if (type == Mesh::DT_FLOAT) {
+            ::glBufferSubData(GL_ARRAY_BUFFER, offset, cnt * sizeof(float), f);
+        } else {
+            scratch.resize(cnt);
+#pragma omp parallel for
+            for (int i = 0; i < static_cast<int>(cnt); i++) {
+                scratch[i] = static_cast<float>(d[i]);
+            }
+            ::glBufferSubData(GL_ARRAY_BUFFER, offset, cnt * sizeof(float), scratch.data());
+        }
+    }
+
+} /* end namespace */
+
 
 /*
  * TriSoupRenderer::TriSoupRenderer
@@ -44,7 +81,9 @@ TriSoupRenderer::TriSoupRenderer(void) : Renderer3DModule_2(),
         surFrontStyle("frontstyle", "The rendering style for the front surface"),
         surBackStyle("backstyle", "The rendering style for the back surface"),
         windRule("windingrule", "The triangle edge winding rule"),
-        colorSlot("color", "The triangle color (if no colors are read from file)") {
+        colorSlot("color", "The triangle color (if no colors are read from file)"),
+        meshDataHash(0), meshFrameID(0), drawBuffer(0), volumeBuffer(0), volumePointCount(0),
+        volumeDataHash(0) {
 
     this->getDataSlot.SetCompatibleCall<megamol::geocalls::CallTriMeshDataDescription>();
     this->MakeSlotAvailable(&this->getDataSlot);
@@ -125,7 +164,214 @@ bool TriSoupRenderer::GetExtents(view::CallRender3D_2& call) {
  * TriSoupRenderer::release
  */
 void TriSoupRenderer::release(void) {
-    // intentionally empty
+    this->releaseMeshes();
+    if (this->drawBuffer != 0) {
+        ::glDeleteBuffers(1, &this->drawBuffer);
+        this->drawBuffer = 0;
+    }
+    if (this->volumeBuffer != 0) {
+        ::glDeleteBuffers(1, &this->volumeBuffer);
+        this->volumeBuffer = 0;
+    }
+    this->volumePointCount = 0;
+    this->volumeDataHash = 0;
+}
+
+
+/*
+ * TriSoupRenderer::releaseMeshes
+ */
+void TriSoupRenderer::releaseMeshes(void) {
+    for (MeshBuffers& mb : this->meshBuffers) {
+        if (mb.vertexBuffer != 0) ::glDeleteBuffers(1, &mb.vertexBuffer);
+        if (mb.indexBuffer != 0) ::glDeleteBuffers(1, &mb.indexBuffer);
+    }
+    this->meshBuffers.clear();
+    this->meshDataHash = 0;
+}
+
+
+/*
+ * TriSoupRenderer::uploadMeshes
+ */
+void TriSoupRenderer::uploadMeshes(const geocalls::CallTriMeshData& ctmd) {
+    this->releaseMeshes();
+    this->meshBuffers.resize(ctmd.Count());
+
+    std::vector<float> scratch;
+    std::vector<float> positions;
+    std::vector<GLuint> indices;
+
+    for (unsigned int i = 0; i < ctmd.Count(); i++) {
+        const Mesh& obj = ctmd.Objects()[i];
+        MeshBuffers& mb = this->meshBuffers[i];
+        mb.valid = false;
+        mb.vertexBuffer = 0;
+        mb.indexBuffer = 0;
+        mb.vertexCount = obj.GetVertexCount();
+        mb.hasNormals = obj.HasNormalPointer();
+        mb.hasColours = obj.HasColourPointer();
+        mb.hasTextures = obj.HasTextureCoordinatePointer();
+        mb.colourType = (obj.GetColourDataType() == Mesh::DT_BYTE) ? GL_UNSIGNED_BYTE : GL_FLOAT;
+
+        // Objects with unsupported data types are not rendered
+        if (!isFloatType(obj.GetVertexDataType())) continue;
+        if (mb.hasNormals && !isFloatType(obj.GetNormalDataType())) continue;
+        if (mb.hasColours && !isFloatType(obj.GetColourDataType())
+            && (obj.GetColourDataType() != Mesh::DT_BYTE)) continue;
+        if (mb.hasTextures && !isFloatType(obj.GetTextureCoordinateDataType())) continue;
+        if (obj.HasTriIndexPointer() && (obj.GetTriDataType() != Mesh::DT_BYTE)
+            && (obj.GetTriDataType() != Mesh::DT_UINT16) && (obj.GetTriDataType() != Mesh::DT_UINT32)) continue;
+
+        // The attributes are stored one after the other, colour bytes are padded to keep the alignment
+        const SIZE_T vertCnt = mb.vertexCount;
+        SIZE_T size = vertCnt * 3 * sizeof(float);
+        mb.normalOffset = size;
+        if (mb.hasNormals) size += vertCnt * 3 * sizeof(float);
+        mb.colourOffset = size;
+        if (mb.hasColours) size += (mb.colourType == GL_UNSIGNED_BYTE)
+            ? ((vertCnt * 3 + 3) & ~static_cast<SIZE_T>(3)) : vertCnt * 3 * sizeof(float);
+        mb.textureOffset = size;
+        if (mb.hasTextures) size += vertCnt * 2 * sizeof(float);
+
+        ::glGenBuffers(1, &mb.vertexBuffer);
+        ::glBindBuffer(GL_ARRAY_BUFFER, mb.vertexBuffer);
+        ::glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+        uploadAsFloat(0, obj.GetVertexDataType(), obj.GetVertexPointerFloat(), obj.GetVertexPointerDouble(),
+            vertCnt * 3, positions);
+        const float *pos = (obj.GetVertexDataType() == Mesh::DT_FLOAT) ? obj.GetVertexPointerFloat()
+            : positions.data();
+        if (mb.hasNormals) {
+            uploadAsFloat(mb.normalOffset, obj.GetNormalDataType(), obj.GetNormalPointerFloat(),
+                obj.GetNormalPointerDouble(), vertCnt * 3, scratch);
+        }
+        if (mb.hasColours) {
+            if (mb.colourType == GL_UNSIGNED_BYTE) {
+                ::glBufferSubData(GL_ARRAY_BUFFER, mb.colourOffset, vertCnt * 3, obj.GetColourPointerByte());
+            } else {
+                uploadAsFloat(mb.colourOffset, obj.GetColourDataType(), obj.GetColourPointerFloat(),
+                    obj.GetColourPointerDouble(), vertCnt * 3, scratch);
+            }
+        }
+        if (mb.hasTextures) {
+            uploadAsFloat(mb.textureOffset, obj.GetTextureCoordinateDataType(),
+                obj.GetTextureCoordinatePointerFloat(), obj.GetTextureCoordinatePointerDouble(), vertCnt * 2,
+                scratch);
+        }
+        ::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // All meshes are drawn indexed, meshes without indices get the implicit ones
+        SIZE_T indexCnt = obj.HasTriIndexPointer() ? static_cast<SIZE_T>(obj.GetTriCount()) * 3 : (vertCnt / 3) * 3;
+        indices.resize(indexCnt);
+        if (!obj.HasTriIndexPointer()) {
+            for (SIZE_T j = 0; j < indexCnt; j++) indices[j] = static_cast<GLuint>(j);
+        } else if (obj.GetTriDataType() == Mesh::DT_BYTE) {
+            std::copy(obj.GetTriIndexPointerByte(), obj.GetTriIndexPointerByte() + indexCnt, indices.begin());
+        } else if (obj.GetTriDataType() == Mesh::DT_UINT16) {
+            std::copy(obj.GetTriIndexPointerUInt16(), obj.GetTriIndexPointerUInt16() + indexCnt, indices.begin());
+        } else {
+            std::copy(obj.GetTriIndexPointerUInt32(), obj.GetTriIndexPointerUInt32() + indexCnt, indices.begin());
+        }
+        ::glGenBuffers(1, &mb.indexBuffer);
+        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mb.indexBuffer);
+        ::glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCnt * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        // Partition the triangles into meshlets with bounding spheres
+        const unsigned int meshletIndices = meshletTriangles * 3;
+        const int meshletCnt = static_cast<int>((indexCnt + meshletIndices - 1) / meshletIndices);
+        mb.meshlets.resize(meshletCnt);
+#pragma omp parallel for
+        for (int m = 0; m < meshletCnt; m++) {
+            Meshlet& ml = mb.meshlets[m];
+            ml.firstIndex = static_cast<unsigned int>(m) * meshletIndices;
+            ml.indexCount = static_cast<unsigned int>(
+                std::min<SIZE_T>(meshletIndices, indexCnt - ml.firstIndex));
+            float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+            float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+            for (unsigned int j = ml.firstIndex; j < ml.firstIndex + ml.indexCount; j++) {
+                if (indices[j] >= vertCnt) continue;
+                const float *v = pos + 3 * static_cast<SIZE_T>(indices[j]);
+                for (int c = 0; c < 3; c++) {
+                    lo[c] = std::min(lo[c], v[c]);
+                    hi[c] = std::max(hi[c], v[c]);
+                }
+            }
+            float r2 = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                ml.centre[c] = 0.5f * (lo[c] + hi[c]);
+            }
+            for (unsigned int j = ml.firstIndex; j < ml.firstIndex + ml.indexCount; j++) {
+                if (indices[j] >= vertCnt) continue;
+                const float *v = pos + 3 * static_cast<SIZE_T>(indices[j]);
+                float dx = v[0] - ml.centre[0], dy = v[1] - ml.centre[1], dz = v[2] - ml.centre[2];
+                r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+            }
+            ml.radius = std::sqrt(r2);
+        }
+
+        mb.valid = true;
+    }
+
+    this->meshDataHash = ctmd.DataHash();
+    this->meshFrameID = ctmd.FrameID();
+}
+
+
+/*
+ * TriSoupRenderer::uploadVolumes
+ */
+void TriSoupRenderer::uploadVolumes(CallVolumetricData& cvd) {
+    vislib::Array<CallVolumetricData::Volume>& volumes = cvd.GetVolumes();
+    std::vector<float> positions;
+    std::vector<unsigned char> colours;
+    double offset = 0.5;
+    for(SIZE_T volIdx = 0; volIdx < volumes.Count(); volIdx++) {
+        CallVolumetricData::Volume& v = volumes[volIdx];
+        if (!v.volumeData || v.resX < 2 || v.resY < 2 || v.resZ < 2)
+            continue;
+        /* resolution is always off-by-1 ?! */
+        const int cntX = v.resX - 1, cntY = v.resY - 1, cntZ = v.resZ - 1;
+        const SIZE_T first = positions.size() / 3;
+        positions.resize(positions.size() + static_cast<SIZE_T>(cntX) * cntY * cntZ * 3);
+        colours.resize(colours.size() + static_cast<SIZE_T>(cntX) * cntY * cntZ * 4);
+#pragma omp parallel for
+        for(int x = 0; x < cntX; x++) {
+            for(int y = 0; y < cntY; y++) {
+                for(int z = 0; z < cntZ; z++) {
+                    const SIZE_T p = first + (static_cast<SIZE_T>(x) * cntY + y) * cntZ + z;
+                    positions[3 * p + 0] = static_cast<float>(v.origin[0] + (x+offset)*v.scaling[0]);
+                    positions[3 * p + 1] = static_cast<float>(v.origin[1] + (y+offset)*v.scaling[1]);
+                    positions[3 * p + 2] = static_cast<float>(v.origin[2] + (z+offset)*v.scaling[2]);
+                    unsigned char col[4] = {255, 255, 255, 255};
+//#define COLOR_BY_VOLID
+#ifdef COLOR_BY_VOLID
+                    col[0] = col[1] = col[2] = 0;
+                    col[volIdx%3] = 255;
+#else // COLOR_BY_VOLID
+                    CallVolumetricData::VoxelType voxel = v.volumeData[v.cellIndex(x, y, z)];
+                    if (voxel > 0) {
+                        col[0] = 0;
+                    } else if (voxel < 0) {
+                        col[1] = col[2] = 0;
+                    }
+#endif // COLOR_BY_VOLID
+                    std::copy(col, col + 4, colours.begin() + 4 * p);
+                }
+            }
+        }
+    }
+
+    if (this->volumeBuffer == 0) {
+        ::glGenBuffers(1, &this->volumeBuffer);
+    }
+    this->volumePointCount = static_cast<GLsizei>(positions.size() / 3);
+    ::glBindBuffer(GL_ARRAY_BUFFER, this->volumeBuffer);
+    ::glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float) + colours.size(), NULL, GL_STATIC_DRAW);
+    ::glBufferSubData(GL_ARRAY_BUFFER, 0, positions.size() * sizeof(float), positions.data());
+    ::glBufferSubData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), colours.size(), colours.data());
+    ::glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->volumeDataHash = cvd.DataHash();
 }
 
 
@@ -150,6 +396,23 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
     glm::mat4 proj = projTemp;
     glm::mat4 view = viewTemp;
 
+    // Upload the meshes once per data hash
+    if ((ctmd->DataHash() == 0) || (ctmd->DataHash() != this->meshDataHash)
+        || (ctmd->FrameID() != this->meshFrameID) || (this->meshBuffers.size() != ctmd->Count())) {
+        this->uploadMeshes(*ctmd);
+    }
+
+    // The view frustum planes for culling the meshlets, pointing inwards
+    glm::mat4 mvpT = glm::transpose(proj * view);
+    glm::vec4 frustum[6];
+    for (int i = 0; i < 3; i++) {
+        frustum[2 * i + 0] = mvpT[3] + mvpT[i];
+        frustum[2 * i + 1] = mvpT[3] - mvpT[i];
+    }
+    for (int i = 0; i < 6; i++) {
+        frustum[i] /= glm::length(glm::vec3(frustum[i]));
+    }
+
 	// lighting setup
     this->GetLights();
     glm::vec4 lightPos = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -279,72 +542,40 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
 
     for (unsigned int i = 0; i < ctmd->Count(); i++) {
         const megamol::geocalls::CallTriMeshData::Mesh& obj = ctmd->Objects()[i];
+        const MeshBuffers& mb = this->meshBuffers[i];
+        if (!mb.valid) continue;
 
-        switch (obj.GetVertexDataType()) {
-            case megamol::geocalls::CallTriMeshData::Mesh::DT_FLOAT:
-                ::glVertexPointer(3, GL_FLOAT, 0, obj.GetVertexPointerFloat());
-                break;
-            case megamol::geocalls::CallTriMeshData::Mesh::DT_DOUBLE:
-                ::glVertexPointer(3, GL_DOUBLE, 0, obj.GetVertexPointerDouble());
-                break;
-            default: continue;
-        }
+        ::glBindBuffer(GL_ARRAY_BUFFER, mb.vertexBuffer);
+        ::glVertexPointer(3, GL_FLOAT, 0, bufferOffset(0));
 
-        if (obj.HasNormalPointer() != NULL) {
+        if (mb.hasNormals) {
             if (!normals) { 
                 ::glEnableClientState(GL_NORMAL_ARRAY);
                 normals = true;
             }
-            switch (obj.GetNormalDataType()) {
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_FLOAT:
-                    ::glNormalPointer(GL_FLOAT, 0, obj.GetNormalPointerFloat());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_DOUBLE:
-                    ::glNormalPointer(GL_DOUBLE, 0, obj.GetNormalPointerDouble());
-                    break;
-                default: continue;
-            }
+            ::glNormalPointer(GL_FLOAT, 0, bufferOffset(mb.normalOffset));
         } else if (normals) {
             ::glDisableClientState(GL_NORMAL_ARRAY);
             normals = false;
         }
 
-        if (obj.HasColourPointer() != NULL) {
+        if (mb.hasColours) {
             if (!colors) {
                 ::glEnableClientState(GL_COLOR_ARRAY);
                 colors = true;
             }
-            switch (obj.GetColourDataType()) {
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_BYTE:
-                    ::glColorPointer(3, GL_UNSIGNED_BYTE, 0, obj.GetColourPointerByte());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_FLOAT:
-                    ::glColorPointer(3, GL_FLOAT, 0, obj.GetColourPointerFloat());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_DOUBLE:
-                    ::glColorPointer(3, GL_DOUBLE, 0, obj.GetColourPointerDouble());
-                    break;
-                default: continue;
-            }
+            ::glColorPointer(3, mb.colourType, 0, bufferOffset(mb.colourOffset));
         } else if (colors) {
             ::glDisableClientState(GL_COLOR_ARRAY);
             colors = false;
         }
 
-        if (obj.HasTextureCoordinatePointer() != NULL) {
+        if (mb.hasTextures) {
             if (!textures) {
                 ::glEnableClientState(GL_TEXTURE_COORD_ARRAY);
                 textures = true;
             }
-            switch (obj.GetTextureCoordinateDataType()) {
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_FLOAT:
-                    ::glTexCoordPointer(2, GL_FLOAT, 0, obj.GetTextureCoordinatePointerFloat());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_DOUBLE:
-                    ::glTexCoordPointer(2, GL_DOUBLE, 0, obj.GetTextureCoordinatePointerDouble());
-                    break;
-                default: continue;
-            }
+            ::glTexCoordPointer(2, GL_FLOAT, 0, bufferOffset(mb.textureOffset));
         } else if (textures) {
             ::glDisableClientState(GL_TEXTURE_COORD_ARRAY);
             textures = false;
@@ -394,22 +625,44 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
 
         }
 
-        if (obj.HasTriIndexPointer() != NULL) {
-            switch (obj.GetTriDataType()) {
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_BYTE:
-                    ::glDrawElements(GL_TRIANGLES, obj.GetTriCount() * 3, GL_UNSIGNED_BYTE, obj.GetTriIndexPointerByte());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_UINT16:
-                    ::glDrawElements(GL_TRIANGLES, obj.GetTriCount() * 3, GL_UNSIGNED_SHORT, obj.GetTriIndexPointerUInt16());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_UINT32:
-                    ::glDrawElements(GL_TRIANGLES, obj.GetTriCount() * 3, GL_UNSIGNED_INT, obj.GetTriIndexPointerUInt32());
-                    break;
-                default: continue;
+        // Collect the meshlets inside the view frustum, merging neighbouring ones
+        this->drawCommands.clear();
+        for (const Meshlet& ml : mb.meshlets) {
+            bool visible = true;
+            for (int p = 0; (p < 6) && visible; p++) {
+                visible = (frustum[p].x * ml.centre[0] + frustum[p].y * ml.centre[1] + frustum[p].z * ml.centre[2]
+                    + frustum[p].w >= -ml.radius);
+            }
+            if (!visible) continue;
+            if (!this->drawCommands.empty()
+                && (this->drawCommands.back().firstIndex + this->drawCommands.back().count == ml.firstIndex)) {
+                this->drawCommands.back().count += ml.indexCount;
+            } else {
+                DrawElementsIndirectCommand cmd = {ml.indexCount, 1, ml.firstIndex, 0, 0};
+                this->drawCommands.push_back(cmd);
+            }
+        }
+
+        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mb.indexBuffer);
+        if (this->drawCommands.empty()) {
+            // everything culled
+        } else if (GLAD_GL_VERSION_4_3) {
+            if (this->drawBuffer == 0) {
+                ::glGenBuffers(1, &this->drawBuffer);
             }
+            ::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->drawBuffer);
+            ::glBufferData(GL_DRAW_INDIRECT_BUFFER, this->drawCommands.size() * sizeof(DrawElementsIndirectCommand),
+                this->drawCommands.data(), GL_STREAM_DRAW);
+            ::glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                static_cast<GLsizei>(this->drawCommands.size()), 0);
+            ::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
         } else {
-            ::glDrawArrays(GL_TRIANGLES, 0, obj.GetVertexCount());
+            for (const DrawElementsIndirectCommand& cmd : this->drawCommands) {
+                ::glDrawElements(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+                    bufferOffset(cmd.firstIndex * sizeof(GLuint)));
+            }
         }
+        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
         if (!doLighting) {
             ::glColor3f(r, g, b);
@@ -419,6 +672,7 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
     if (normals) ::glDisableClientState(GL_NORMAL_ARRAY);
     if (colors) ::glDisableClientState(GL_COLOR_ARRAY);
     if (textures) ::glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    ::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     {
         GLfloat mat_ambient[4] = { 0.2f, 0.2f, 0.2f, 1.0f };
@@ -442,17 +696,11 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
         ::glDisable(GL_LIGHTING);
 
         ::glColor3f(1.0f, 0.0f, 0.0f);
-        for (unsigned int i = 0; i < ctmd->Count(); i++) {
-            switch (ctmd->Objects()[i].GetVertexDataType()) {
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_FLOAT:
-                    ::glVertexPointer(3, GL_FLOAT, 0, ctmd->Objects()[i].GetVertexPointerFloat());
-                    break;
-                case megamol::geocalls::CallTriMeshData::Mesh::DT_DOUBLE:
-                    ::glVertexPointer(3, GL_DOUBLE, 0, ctmd->Objects()[i].GetVertexPointerDouble());
-                    break;
-                default: continue;
-            }
-            ::glDrawArrays(GL_POINTS, 0, ctmd->Objects()[i].GetVertexCount());
+        for (const MeshBuffers& mb : this->meshBuffers) {
+            if (!mb.valid) continue;
+            ::glBindBuffer(GL_ARRAY_BUFFER, mb.vertexBuffer);
+            ::glVertexPointer(3, GL_FLOAT, 0, bufferOffset(0));
+            ::glDrawArrays(GL_POINTS, 0, mb.vertexCount);
         }
 
         //::glEnable(GL_POINT_SIZE);
@@ -472,48 +720,22 @@ bool TriSoupRenderer::Render(view::CallRender3D_2& call) {
 
     CallVolumetricData *cvd = this->getVolDataSlot.CallAs<CallVolumetricData>();
     if (cvd != NULL && (*cvd)(0)) {
-        vislib::Array<CallVolumetricData::Volume>& volumes = cvd->GetVolumes();
+        if ((cvd->DataHash() == 0) || (cvd->DataHash() != this->volumeDataHash)) {
+            this->uploadVolumes(*cvd);
+        }
         //::glEnable(GL_POINT_SIZE);
         ::glEnable(GL_DEPTH_TEST);
         ::glDisable(GL_BLEND);
         ::glDisable(GL_LIGHTING);
         ::glPointSize(3);
-        ::glBegin(GL_POINTS);
-        double offset = 0.5;
-        for(SIZE_T volIdx = 0; volIdx < volumes.Count(); volIdx++) {
-            CallVolumetricData::Volume& v = volumes[volIdx];
-            if (!v.volumeData)
-                continue;
-//#define COLOR_BY_VOLID
-#ifdef COLOR_BY_VOLID
-            float col[4] = {0,0,0,1};
-            col[volIdx%3] = 1;
-            ::glColor4fv(col);
-#endif // COLOR_BY_VOLID
-            /* resolution is always off-by-1 ?! */
-            for(int x = 0; x < v.resX-1; x++) {
-                for(int y = 0; y < v.resY-1; y++) {
-                    for(int z = 0; z < v.resZ-1; z++) {
-                        int index = v.cellIndex(x, y, z);
-                        double position[3] = {v.origin[0] + (x+offset)*v.scaling[0],
-                                              v.origin[1] + (y+offset)*v.scaling[1],
-                                              v.origin[2] + (z+offset)*v.scaling[2]};
-                        CallVolumetricData::VoxelType voxel = v.volumeData[index];
-#ifndef COLOR_BY_VOLID
-                        if (voxel != 0) {
-                            if (voxel > 0)
-                                ::glColor4f(0, 1, 1, 1);
-                            else
-                                ::glColor4d(1, 0, 0, 1);
-                        } else
-                            ::glColor4f(1, 1, 1, 1);
-#endif // !COLOR_BY_VOLID
-                       ::glVertex3dv(position);
-                     }
-                }
-            }
-        }
-        ::glEnd();
+        ::glBindBuffer(GL_ARRAY_BUFFER, this->volumeBuffer);
+        ::glEnableClientState(GL_VERTEX_ARRAY);
+        ::glEnableClientState(GL_COLOR_ARRAY);
+        ::glVertexPointer(3, GL_FLOAT, 0, bufferOffset(0));
+        ::glColorPointer(4, GL_UNSIGNED_BYTE, 0, bufferOffset(this->volumePointCount * 3 * sizeof(float)));
+        ::glDrawArrays(GL_POINTS, 0, this->volumePointCount);
+        ::glDisableClientState(GL_COLOR_ARRAY);
+        ::glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
 #if (defined(_MSC_VER) && (_MSC_VER > 1000))
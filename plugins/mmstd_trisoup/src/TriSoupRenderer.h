@@ -16,8 +16,12 @@
 #include "mmcore/Call.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "vislib/graphics/gl/IncludeAllGL.h"
 #include "vislib/math/Cuboid.h"
 #include "vislib/memutils.h"
+#include "geometry_calls/CallTriMeshData.h"
+#include "CallVolumetricData.h"
+#include <vector>
 
 
 namespace megamol {
@@ -26,6 +30,11 @@ namespace trisoup {
 
     /**
      * Renderer for tri-mesh data
+     *
+     * The meshes are uploaded once per data hash into vertex and index buffers,
+     * converting all attributes to float. Each mesh is partitioned into
+     * meshlets of consecutive triangles, which are culled against the view
+     * frustum; the visible ones are drawn with a single indirect multi-draw.
      */
     class TriSoupRenderer : public core::view::Renderer3DModule_2 {
     public:
@@ -99,6 +108,60 @@ namespace trisoup {
 
     private:
 
+        /** A range of consecutive triangles culled as a whole */
+        struct Meshlet {
+            unsigned int firstIndex;
+            unsigned int indexCount;
+            float centre[3];
+            float radius;
+        };
+
+        /** The buffers and the layout of one mesh on the GPU */
+        struct MeshBuffers {
+            bool valid;
+            GLuint vertexBuffer;
+            GLuint indexBuffer;
+            unsigned int vertexCount;
+            SIZE_T normalOffset;
+            SIZE_T colourOffset;
+            SIZE_T textureOffset;
+            bool hasNormals;
+            bool hasColours;
+            bool hasTextures;
+            GLenum colourType;
+            std::vector<Meshlet> meshlets;
+        };
+
+        /** The layout of the commands of glMultiDrawElementsIndirect */
+        struct DrawElementsIndirectCommand {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint firstIndex;
+            GLint baseVertex;
+            GLuint baseInstance;
+        };
+
+        /**
+         * Uploads the meshes of the call into the mesh buffers and builds
+         * their meshlets.
+         *
+         * @param ctmd The call holding the meshes.
+         */
+        void uploadMeshes(const geocalls::CallTriMeshData& ctmd);
+
+        /**
+         * Uploads the occupancy points of the volumes of the call.
+         *
+         * @param cvd The call holding the volumes.
+         */
+        void uploadVolumes(CallVolumetricData& cvd);
+
+        /** Releases all buffers of the meshes */
+        void releaseMeshes(void);
+
+        /** The number of triangles in one meshlet */
+        static const unsigned int meshletTriangles = 256;
+
         /** The slot to fetch the data */
         core::CallerSlot getDataSlot;
 
@@ -123,6 +186,30 @@ namespace trisoup {
         /** The Triangle color */
         core::param::ParamSlot colorSlot;
 
+        /** The meshes on the GPU */
+        std::vector<MeshBuffers> meshBuffers;
+
+        /** The data hash of the uploaded meshes */
+        SIZE_T meshDataHash;
+
+        /** The frame of the uploaded meshes */
+        unsigned int meshFrameID;
+
+        /** The buffer with the commands of the indirect draws */
+        GLuint drawBuffer;
+
+        /** The commands for the visible meshlets of one mesh */
+        std::vector<DrawElementsIndirectCommand> drawCommands;
+
+        /** The buffer holding positions and colours of the volume points */
+        GLuint volumeBuffer;
+
+        /** The number of volume points */
+        GLsizei volumePointCount;
+
+        /** The data hash of the uploaded volumes */
+        SIZE_T volumeDataHash;
+
     };
 
 
@@ -7,30 +7,213 @@
  */
 #include "stdafx.h"
 #include "WavefrontObjDataSource.h"
+#include "mmcore/param/BoolParam.h"
 #include "vislib/Array.h"
 #include "vislib/assert.h"
 #include "vislib/sys/ASCIIFileBuffer.h"
 #include "vislib/math/Cuboid.h"
 #include "vislib/sys/File.h"
 #include "vislib/sys/Log.h"
-#include "vislib/sys/MemmappedFile.h"
 #include "vislib/sys/Path.h"
 #include "vislib/sys/PerformanceCounter.h"
-#include "vislib/PtrArray.h"
-#include "vislib/math/ShallowVector.h"
 #include "vislib/StringConverter.h"
-#include "vislib/math/Vector.h"
-#include <map>
+#include <algorithm>
 #include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 using namespace megamol;
 using namespace megamol::trisoup;
 
 
+/*
+ * WavefrontObjDataSource::ParsedChunk
+ */
+struct WavefrontObjDataSource::ParsedChunk {
+
+    /** A statement which has to be applied in file order */
+    struct Directive {
+
+        /** The kinds of statements */
+        enum Type { MTLLIB, USEMTL, GROUP, LINE } type;
+
+        /** The line of the statement within the chunk */
+        size_t line;
+
+        /** The number of triangles of the chunk preceding the statement */
+        size_t triPos;
+
+        /** The argument of mtllib and usemtl */
+        std::string arg;
+
+        /** The vertex indices of a line segment */
+        int lineS, lineT;
+
+        /** The ID of a line segment */
+        size_t lineID;
+
+        /** Flag whether the line segment has an ID */
+        bool hasID;
+    };
+
+    /** The number of lines of the chunk */
+    size_t lineCount;
+
+    /** The vertices, three floats each */
+    std::vector<float> vert;
+
+    /** The normals, three floats each */
+    std::vector<float> norm;
+
+    /** The texture coordinates, two floats each */
+    std::vector<float> texc;
+
+    /** The triangles of all faces */
+    std::vector<Tri> tris;
+
+    /** The statements to apply in file order */
+    std::vector<Directive> directives;
+
+    /** The lines within the chunk which could not be parsed */
+    std::vector<std::pair<size_t, std::string> > errors;
+};
+
+
+namespace {
+
+    /** Identifies the cache files ("MMOC") */
+    const uint32_t cacheMagic = 0x434F4D4D;
+
+    /** The version of the cache file layout */
+    const uint32_t cacheVersion = 1;
+
+    /** The size of the chunks the file is split into for parsing */
+    const size_t chunkSize = 4 * 1024 * 1024;
+
+    /**
+     * Answers the size and modification time of a file.
+     */
+    bool fileStamp(const vislib::TString& filename, uint64_t& outSize, int64_t& outTime) {
+        struct stat st;
+        if (::stat(vislib::StringA(filename).PeekBuffer(), &st) != 0) return false;
+        outSize = static_cast<uint64_t>(st.st_size);
+        outTime = static_cast<int64_t>(st.st_mtime);
+        return true;
+    }
+
+    /**
+     * Sequential writer into a memory buffer.
+     */
+    class CacheWriter {
+    public:
+        void Write(const void *data, size_t size) {
+            const char *c = static_cast<const char*>(data);
+            this->buffer.insert(this->buffer.end(), c, c + size);
+        }
+        template<class T> void Write(const T& value) {
+            this->Write(&value, sizeof(T));
+        }
+        void WriteString(const vislib::StringA& str) {
+            this->Write(static_cast<uint32_t>(str.Length()));
+            this->Write(str.PeekBuffer(), str.Length());
+        }
+        std::vector<char> buffer;
+    };
+
+    /**
+     * Sequential reader from a memory buffer. All reads fail once the end
+     * of the buffer has been passed.
+     */
+    class CacheReader {
+    public:
+        CacheReader(const std::vector<char>& buffer) : pos(buffer.data()), end(buffer.data() + buffer.size()) {}
+        bool Read(void *data, size_t size) {
+            if (static_cast<size_t>(this->end - this->pos) < size) {
+                this->pos = this->end + 1;
+                return false;
+            }
+            ::memcpy(data, this->pos, size);
+            this->pos += size;
+            return true;
+        }
+        template<class T> bool Read(T& value) {
+            return this->Read(&value, sizeof(T));
+        }
+        bool ReadString(vislib::StringA& str) {
+            uint32_t len;
+            if (!this->Read(len) || (static_cast<size_t>(this->end - this->pos) < len)) return false;
+            str = vislib::StringA(this->pos, static_cast<vislib::StringA::Size>(len));
+            this->pos += len;
+            return true;
+        }
+    private:
+        const char *pos;
+        const char *end;
+    };
+
+    /**
+     * Parses a face element "v", "v/t", "v/t/n" or "v//n".
+     *
+     * @return The number of slashes or -1 on illegal elements
+     */
+    int parseFaceElement(const char *word, const char *wordEnd, unsigned int& v, unsigned int& t, unsigned int& n,
+            bool& hasT, bool& hasN, const char *&outError) {
+        char *e;
+        long idx = ::strtol(word, &e, 10);
+        if ((e == word) || (idx <= 0)) {
+            outError = "Negative face element indices not supported";
+            return -1;
+        }
+        v = static_cast<unsigned int>(idx - 1);
+        hasT = hasN = false;
+        if (e >= wordEnd) return 0;
+        if (*e != '/') {
+            outError = "Illegal face element";
+            return -1;
+        }
+        const char *p = e + 1;
+        if ((p < wordEnd) && (*p != '/')) {
+            idx = ::strtol(p, &e, 10);
+            if ((e == p) || (idx <= 0)) {
+                outError = "Negative face element indices not supported";
+                return -1;
+            }
+            t = static_cast<unsigned int>(idx - 1);
+            hasT = true;
+            p = e;
+        }
+        if ((p >= wordEnd) || (*p != '/')) {
+            outError = "Single slash face entry element illegal";
+            return -1;
+        }
+        p++;
+        if (p < wordEnd) {
+            idx = ::strtol(p, &e, 10);
+            if ((e == p) || (idx <= 0)) {
+                outError = "Negative face element indices not supported";
+                return -1;
+            }
+            n = static_cast<unsigned int>(idx - 1);
+            hasN = true;
+        }
+        return 2;
+    }
+
+}
+
+
 /*
  * WavefrontObjDataSource::WavefrontObjDataSource
  */
-WavefrontObjDataSource::WavefrontObjDataSource(void) : AbstractTriMeshLoader() {
+WavefrontObjDataSource::WavefrontObjDataSource(void) : AbstractTriMeshLoader(),
+        useCacheSlot("useCache", "Store the loaded meshes in a binary cache file next to the OBJ file and load it instead while the OBJ file is unchanged") {
+    this->useCacheSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->useCacheSlot);
+
     lineVerts.AssertCapacity(1000);
     lineVerts.SetCapacityIncrement(1000);
 }
@@ -59,266 +242,180 @@ bool WavefrontObjDataSource::load(const vislib::TString& filename) {
         return false;
     }
 
-    vislib::sys::ASCIIFileBuffer linesA(vislib::sys::ASCIIFileBuffer::PARSING_WORDS);
-    if (!linesA.LoadFile(filename)) {
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to load file");
-        return false;
-    }
-
     this->objs.Clear();
     this->mats.Clear();
     this->lines.clear();
+    this->lineVerts.Clear();
+
+    const bool useCache = this->useCacheSlot.Param<core::param::BoolParam>()->Value();
+    if (useCache && this->loadCache(filename)) {
+        return true;
+    }
+
+    std::vector<char> data;
+    {
+        vislib::sys::File file;
+        if (!file.Open(filename, vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+                vislib::sys::File::OPEN_ONLY)) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to load file");
+            return false;
+        }
+        data.resize(static_cast<size_t>(file.GetSize()) + 1);
+        data.resize(static_cast<size_t>(file.Read(data.data(), data.size() - 1)) + 1);
+        data.back() = '\0';
+        file.Close();
+    }
 
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Start loading \"%s\"\n", vislib::StringA(filename).PeekBuffer());
     double startTime = vislib::sys::PerformanceCounter::QueryMillis();
 
     vislib::TString path = vislib::sys::Path::GetDirectoryName(filename);
 
-    float vec3[3];
-    vislib::math::ShallowVector<float, 3> vec3v3(vec3);
-    vislib::math::ShallowVector<float, 2> vec3v2(vec3);
-    vislib::Array<vislib::math::Vector<float, 3> > vert;
-    vislib::Array<vislib::math::Vector<float, 3> > norm;
-    vislib::Array<vislib::math::Vector<float, 2> > texc;
+    // split the file into chunks of whole lines and parse them in parallel
+    const char *text = data.data();
+    const char *textEnd = text + data.size() - 1;
+    std::vector<const char*> chunkBegins;
+    for (const char *c = text; c < textEnd;) {
+        chunkBegins.push_back(c);
+        c = std::min(c + chunkSize, textEnd);
+        while ((c < textEnd) && (*(c - 1) != '\n')) c++;
+    }
+    chunkBegins.push_back(textEnd);
+
+    const int chunkCount = static_cast<int>(chunkBegins.size()) - 1;
+    std::vector<ParsedChunk> chunks(chunkCount);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int ci = 0; ci < chunkCount; ci++) {
+        parseChunk(chunkBegins[ci], chunkBegins[ci + 1], chunks[ci]);
+    }
+
+    // concatenate the vertex data, the face indices are global already
+    size_t vertCnt = 0, normCnt = 0, texcCnt = 0;
+    for (const ParsedChunk& chunk : chunks) {
+        vertCnt += chunk.vert.size();
+        normCnt += chunk.norm.size();
+        texcCnt += chunk.texc.size();
+    }
+    std::vector<float> vert, norm, texc;
+    vert.reserve(vertCnt);
+    norm.reserve(normCnt);
+    texc.reserve(texcCnt);
+    for (ParsedChunk& chunk : chunks) {
+        vert.insert(vert.end(), chunk.vert.begin(), chunk.vert.end());
+        norm.insert(norm.end(), chunk.norm.begin(), chunk.norm.end());
+        texc.insert(texc.end(), chunk.texc.begin(), chunk.texc.end());
+        std::vector<float>().swap(chunk.vert);
+        std::vector<float>().swap(chunk.norm);
+        std::vector<float>().swap(chunk.texc);
+    }
+    const size_t vertexCount = vert.size() / 3;
+
+    // apply groups, materials and lines in file order
     std::map<size_t, size_t> lineID2Idx;
-    vislib::Array<vislib::StringA> objsMats;
-    vislib::PtrArray<vislib::Array<Tri> > objs;
-    vislib::Array<Tri> *obj = NULL;
+    std::vector<vislib::StringA> objsMats;
+    std::vector<std::vector<Tri> > objs;
     vislib::Array<vislib::StringA> matNames;
+    std::vector<vislib::TString> mtlLibs;
+    size_t lineOffset = 0;
+
+    auto appendTris = [&objs, &objsMats](const std::vector<Tri>& tris, size_t begin, size_t end) {
+        if (begin >= end) return;
+        if (objs.empty()) {
+            objs.push_back(std::vector<Tri>());
+            objsMats.push_back(vislib::StringA::EMPTY);
+        }
+        objs.back().insert(objs.back().end(), tris.begin() + begin, tris.begin() + end);
+    };
 
-    const SIZE_T capacityGrowth = 10 * 1024;
-
-    for (SIZE_T li = 0; li < linesA.Count(); li++) {
-        const vislib::sys::ASCIIFileBuffer::LineBuffer& line = linesA[li];
-        if (line.Count() <= 0) continue;
+    for (ParsedChunk& chunk : chunks) {
+        for (const std::pair<size_t, std::string>& err : chunk.errors) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Error parsing line %u: %s",
+                static_cast<unsigned int>(lineOffset + err.first), err.second.c_str());
+        }
 
-        try {
+        size_t triPos = 0;
+        for (const ParsedChunk::Directive& d : chunk.directives) {
+            appendTris(chunk.tris, triPos, d.triPos);
+            triPos = d.triPos;
 
-            if ((::strcmp(line.Word(0), "mtllib") == 0) && (line.Count() >= 2)) {
+            switch (d.type) {
+            case ParsedChunk::Directive::MTLLIB: {
                 // load material library
-                this->loadMaterialLibrary(vislib::sys::Path::Concatenate(path, A2T(line.Word(1))), matNames);
-
-            } else if ((::strcmp(line.Word(0), "usemtl") == 0) && (line.Count() >= 2)) {
+                vislib::TString lib = vislib::sys::Path::Concatenate(path, A2T(d.arg.c_str()));
+                this->loadMaterialLibrary(lib, matNames);
+                mtlLibs.push_back(lib);
+            } break;
+            case ParsedChunk::Directive::USEMTL: {
                 // use material (new group)
-
-                if (obj == NULL) {
-                    objs.Append(new vislib::Array<Tri>());
-                    objsMats.Append(line.Word(1));
-                    obj = objs.Last();
-
-                } else if (objsMats.Last().IsEmpty()) {
-                    objsMats.Last() = line.Word(1);
-
-                } else if (!objsMats.Last().Equals(line.Word(1))) {
-                    if (obj->Count() > 0) {
-                        objs.Append(new vislib::Array<Tri>());
-                        objsMats.Append(line.Word(1));
-                        obj = objs.Last();
-
+                vislib::StringA name(d.arg.c_str());
+                if (objs.empty()) {
+                    objs.push_back(std::vector<Tri>());
+                    objsMats.push_back(name);
+                } else if (objsMats.back().IsEmpty()) {
+                    objsMats.back() = name;
+                } else if (!objsMats.back().Equals(name)) {
+                    if (!objs.back().empty()) {
+                        objs.push_back(std::vector<Tri>());
+                        objsMats.push_back(name);
                     } else {
-                        objsMats.Last() = line.Word(1);
+                        objsMats.back() = name;
                     }
-
                 }
-
-            } else if ((::strcmp(line.Word(0), "v") == 0) && (line.Count() >= 4)) {
-                // vertex
-                vec3[0] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(1)));
-                vec3[1] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(2)));
-                vec3[2] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(3)));
-                if (vert.Count() == vert.Capacity()) vert.AssertCapacity(vert.Capacity() + capacityGrowth);
-                vert.Add(vec3v3);
-
-            } else if ((::strcmp(line.Word(0), "vn") == 0) && (line.Count() >= 4)) {
-                // vertex normal
-                vec3[0] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(1)));
-                vec3[1] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(2)));
-                vec3[2] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(3)));
-                if (norm.Count() == norm.Capacity()) norm.AssertCapacity(norm.Capacity() + capacityGrowth);
-                norm.Add(vec3v3);
-
-            } else if ((::strcmp(line.Word(0), "vt") == 0) && (line.Count() >= 2)) {
-                // vertex texture coordinate
-                vec3[0] = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(1)));
-                vec3[1] = (line.Count() >= 3) ? static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(2))) : 0.0f;
-                if (texc.Count() == texc.Capacity()) texc.AssertCapacity(texc.Capacity() + capacityGrowth);
-                texc.Add(vec3v2);
-
-            } else if ((::strcmp(line.Word(0), "f") == 0) && (line.Count() >= 4)) {
-                // face
-                if (obj == NULL) {
-                    objs.Append(new vislib::Array<Tri>());
-                    objsMats.Append(vislib::StringA::EMPTY);
-                    obj = objs.Last();
-                }
-
-                Tri t;
-                const char* p1 = ::strchr(line.Word(1), '/');
-                int idx;
-
-                if (p1 == NULL) {
-                    t.n = t.t = false;
-                    t.n1 = t.n2 = t.n3 = 0;
-                    t.t1 = t.t2 = t.t3 = 0;
-                    idx = vislib::CharTraitsA::ParseInt(line.Word(1));
-                    if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                    t.v1 = static_cast<unsigned int>(idx - 1);
-                    idx = vislib::CharTraitsA::ParseInt(line.Word(2));
-                    if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                    t.v2 = static_cast<unsigned int>(idx - 1);
-                    for (unsigned int i = 3; i < line.Count(); i++) {
-                        idx = vislib::CharTraitsA::ParseInt(line.Word(i));
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.v3 = static_cast<unsigned int>(idx - 1);
-                        obj->Append(t);
-                        t.v2 = t.v3;
-                    }
-
-                } else {
-                    SIZE_T len = vislib::CharTraitsA::SafeStringLength(line.Word(1));
-                    const char* p2 = ::strchr(p1 + 1, '/');
-                    if (p2 == NULL) throw vislib::Exception("Single slash face entry element illegal", __FILE__, __LINE__);
-                    t.t = (p2 > p1 + 1);
-                    t.n = (p2 + 1 < line.Word(1) + len);
-                    t.n1 = t.n2 = t.n3 = 0;
-                    t.t1 = t.t2 = t.t3 = 0;
-                    *const_cast<char *>(p1) = '\0';
-                    *const_cast<char *>(p2) = '\0';
-                    p1++;
-                    p2++;
-                    idx = vislib::CharTraitsA::ParseInt(line.Word(1));
-                    if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                    t.v1 = static_cast<unsigned int>(idx - 1);
-                    if (t.t) {
-                        idx = vislib::CharTraitsA::ParseInt(p1);
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.t1 = static_cast<unsigned int>(idx - 1);
-                    }
-                    if (t.n) {
-                        idx = vislib::CharTraitsA::ParseInt(p2);
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.n1 = static_cast<unsigned int>(idx - 1);
-                    }
-
-                    len = vislib::CharTraitsA::SafeStringLength(line.Word(2));
-                    p1 = ::strchr(line.Word(2), '/');
-                    if (p1 == NULL) throw vislib::Exception("Single slash face entry element illegal", __FILE__, __LINE__);
-                    p2 = ::strchr(p1 + 1, '/');
-                    if (p2 == NULL) throw vislib::Exception("Single slash face entry element illegal", __FILE__, __LINE__);
-                    if (t.t != (p2 > p1 + 1)) throw vislib::Exception("face entry inconsistancy", __FILE__, __LINE__);
-                    if (t.n != (p2 + 1 < line.Word(2) + len)) throw vislib::Exception("face entry inconsistancy", __FILE__, __LINE__);
-                    *const_cast<char *>(p1) = '\0';
-                    *const_cast<char *>(p2) = '\0';
-                    p1++;
-                    p2++;
-                    idx = vislib::CharTraitsA::ParseInt(line.Word(2));
-                    if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                    t.v2 = static_cast<unsigned int>(idx - 1);
-                    if (t.t) {
-                        idx = vislib::CharTraitsA::ParseInt(p1);
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.t2 = static_cast<unsigned int>(idx - 1);
-                    }
-                    if (t.n) {
-                        idx = vislib::CharTraitsA::ParseInt(p2);
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.n2 = static_cast<unsigned int>(idx - 1);
-                    }
-
-                    t.v2 = static_cast<unsigned int>(vislib::CharTraitsA::ParseInt(line.Word(2)) - 1);
-                    if (t.t) t.t2 = static_cast<unsigned int>(vislib::CharTraitsA::ParseInt(p1) - 1);
-                    if (t.n) t.n2 = static_cast<unsigned int>(vislib::CharTraitsA::ParseInt(p2) - 1);
-
-                    for (unsigned int i = 3; i < line.Count(); i++) {
-                        len = vislib::CharTraitsA::SafeStringLength(line.Word(i));
-                        p1 = ::strchr(line.Word(i), '/');
-                        if (p1 == NULL) throw vislib::Exception("Single slash face entry element illegal", __FILE__, __LINE__);
-                        p2 = ::strchr(p1 + 1, '/');
-                        if (p2 == NULL) throw vislib::Exception("Single slash face entry element illegal", __FILE__, __LINE__);
-                        if (t.t != (p2 > p1 + 1)) throw vislib::Exception("face entry inconsistancy", __FILE__, __LINE__);
-                        if (t.n != (p2 + 1 < line.Word(i) + len)) throw vislib::Exception("face entry inconsistancy", __FILE__, __LINE__);
-                        *const_cast<char *>(p1) = '\0';
-                        *const_cast<char *>(p2) = '\0';
-                        p1++;
-                        p2++;
-                        idx = vislib::CharTraitsA::ParseInt(line.Word(i));
-                        if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                        t.v3 = static_cast<unsigned int>(idx - 1);
-                        if (t.t) {
-                            idx = vislib::CharTraitsA::ParseInt(p1);
-                            if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                            t.t3 = static_cast<unsigned int>(idx - 1);
-                        }
-                        if (t.n) {
-                            idx = vislib::CharTraitsA::ParseInt(p2);
-                            if (idx <= 0) throw vislib::Exception("Negative face element indices not supported", __FILE__, __LINE__);
-                            t.n3 = static_cast<unsigned int>(idx - 1);
-                        }
-                        obj->Append(t);
-                        t.v2 = t.v3;
-                        t.t2 = t.t3;
-                        t.n2 = t.n3;
-                    }
-
-                }
-
-            } else if (::strcmp(line.Word(0), "g") == 0) {
+            } break;
+            case ParsedChunk::Directive::GROUP:
                 // new group
-                if ((obj == NULL) || (obj->Count() > 0)) {
-                    objs.Append(new vislib::Array<Tri>());
-                    objsMats.Append(vislib::StringA::EMPTY); // or should we keep the material? spec does not tell!
-                    obj = objs.Last();
+                if (objs.empty() || !objs.back().empty()) {
+                    objs.push_back(std::vector<Tri>());
+                    objsMats.push_back(vislib::StringA::EMPTY); // or should we keep the material? spec does not tell!
+                }
+                break;
+            case ParsedChunk::Directive::LINE: {
+                if ((d.lineS <= 0) || (d.lineT <= 0) || (static_cast<size_t>(d.lineS) > vertexCount)
+                        || (static_cast<size_t>(d.lineT) > vertexCount)) {
+                    Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Error parsing line %u: line vertex index out of range",
+                        static_cast<unsigned int>(lineOffset + d.line));
+                    break;
                 }
-            } else if (::strcmp(line.Word(0), "l") == 0) {
-                int idxS = vislib::CharTraitsA::ParseInt(line.Word(1));
-                int idxT = vislib::CharTraitsA::ParseInt(line.Word(2));
-                size_t ID = 0;
                 size_t listIdx = 0;
-                if (line.Count() == 4) {
-                    ID = static_cast<size_t>(vislib::CharTraitsA::ParseUInt64(line.Word(3)));
-                    if (lineID2Idx.find(ID) == lineID2Idx.end()) {
+                if (d.hasID) {
+                    if (lineID2Idx.find(d.lineID) == lineID2Idx.end()) {
                         size_t oldSize = lineID2Idx.size();
-                        lineID2Idx[ID] = oldSize;
-                        lineVerts.SetCount(lineID2Idx[ID] + 1);
+                        lineID2Idx[d.lineID] = oldSize;
+                        lineVerts.SetCount(lineID2Idx[d.lineID] + 1);
                         lineVerts[lineVerts.Count() - 1].AssertCapacity(1000);
                         lineVerts[lineVerts.Count() - 1].SetCapacityIncrement(1000);
                         // new line
                         Lines lineData;
-                        lineData.SetID(ID);
-                        this->lines.push_back(lineData);
-                    }
-                    listIdx = lineID2Idx[ID];
-                } else {
-                    listIdx = 0;
-                    if (lineVerts.Count() == 0) {
-                        lineVerts.SetCount(1);
-                        lineVerts[lineVerts.Count() - 1].AssertCapacity(1000);
-                        lineVerts[lineVerts.Count() - 1].SetCapacityIncrement(1000);
-                        Lines lineData;
-                        lineData.SetID(0);
+                        lineData.SetID(d.lineID);
                         this->lines.push_back(lineData);
                     }
+                    listIdx = lineID2Idx[d.lineID];
+                } else if (lineVerts.Count() == 0) {
+                    lineVerts.SetCount(1);
+                    lineVerts[lineVerts.Count() - 1].AssertCapacity(1000);
+                    lineVerts[lineVerts.Count() - 1].SetCapacityIncrement(1000);
+                    Lines lineData;
+                    lineData.SetID(0);
+                    this->lines.push_back(lineData);
                 }
-                float *vertices = new float[6];
-                auto s = vert[idxS - 1];
-                auto t = vert[idxT - 1];
-                lineVerts[listIdx].Append(s.X());
-                lineVerts[listIdx].Append(s.Y());
-                lineVerts[listIdx].Append(s.Z());
-                lineVerts[listIdx].Append(t.X());
-                lineVerts[listIdx].Append(t.Y());
-                lineVerts[listIdx].Append(t.Z());
-                //lineData.Set(2, vertices, vislib::graphics::ColourRGBAu8(255, 255, 255, 255));
-                //this->lines.push_back(lineData);
+                const float *s = vert.data() + 3 * (d.lineS - 1);
+                const float *t = vert.data() + 3 * (d.lineT - 1);
+                lineVerts[listIdx].Append(s[0]);
+                lineVerts[listIdx].Append(s[1]);
+                lineVerts[listIdx].Append(s[2]);
+                lineVerts[listIdx].Append(t[0]);
+                lineVerts[listIdx].Append(t[1]);
+                lineVerts[listIdx].Append(t[2]);
+            } break;
             }
-
-        } catch(vislib::Exception ex) {
-            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Error parsing line %u: %s (%s, %d)",
-                li, ex.GetMsgA(), ex.GetFile(), ex.GetLine());
-        } catch(...) {
-            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Error parsing line %u: unexpected exception", li);
         }
+        appendTris(chunk.tris, triPos, chunk.tris.size());
+        std::vector<Tri>().swap(chunk.tris);
+
+        lineOffset += chunk.lineCount;
     }
+    chunks.clear();
+
     if (lineVerts.Count() > 0) {
         for (size_t loop = 0; loop < lineVerts.Count(); loop++) {
             lines[loop].Set(static_cast<unsigned int>(lineVerts[loop].Count() / 3), lineVerts[loop].PeekElements(), vislib::graphics::ColourRGBAu8(255, 255, 255, 255));
@@ -328,59 +425,344 @@ bool WavefrontObjDataSource::load(const vislib::TString& filename) {
     double parseTime = (vislib::sys::PerformanceCounter::QueryMillis() - startTime) * 0.001;
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Parsing file completed after %f seconds\n", parseTime);
 
+    std::vector<vislib::StringA> usedMats;
     if (!this->lines.empty()) {
         float minV[] = {FLT_MAX, FLT_MAX, FLT_MAX};
         float maxV[] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
 
-        for (size_t i = 0; i < vert.Count(); i++) {
-            if (minV[0] > vert[i].X())
-                minV[0] = vert[i].X();
-            if (maxV[0] < vert[i].X())
-                maxV[0] = vert[i].X();
-
-            if (minV[1] > vert[i].Y())
-                minV[1] = vert[i].Y();
-            if (maxV[1] < vert[i].Y())
-                maxV[1] = vert[i].Y();
-
-            if (minV[2] > vert[i].Z())
-                minV[2] = vert[i].Z();
-            if (maxV[2] < vert[i].Z())
-                maxV[2] = vert[i].Z();
+        for (size_t i = 0; i < vertexCount; i++) {
+            for (int c = 0; c < 3; c++) {
+                if (minV[c] > vert[i * 3 + c])
+                    minV[c] = vert[i * 3 + c];
+                if (maxV[c] < vert[i * 3 + c])
+                    maxV[c] = vert[i * 3 + c];
+            }
         }
 
         this->bbox.Set(minV[0], minV[1], minV[2], maxV[0], maxV[1], maxV[2]);
     } else {
 
-        unsigned int *vertUsed = new unsigned int[vert.Count()];
-
         unsigned int oc = 0;
-        for (SIZE_T i = 0; i < objs.Count(); i++) {
-            if (objs[i]->Count() > 0) oc++;
+        for (SIZE_T i = 0; i < objs.size(); i++) {
+            if (!objs[i].empty()) oc++;
         }
         this->objs.SetCount(oc);
         this->objs.Trim();
         if (oc == 0) this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
         else this->bbox.Set(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
         oc = 0;
-        for (SIZE_T i = 0; i < objs.Count(); i++) {
-            if (objs[i]->Count() <= 0) continue;
+        for (SIZE_T i = 0; i < objs.size(); i++) {
+            if (objs[i].empty()) continue;
             INT_PTR matIdx = matNames.IndexOf(objsMats[i]);
             this->objs[oc].SetMaterial(
                 ((matIdx == vislib::Array<vislib::StringA>::INVALID_POS) || (static_cast<SIZE_T>(matIdx) >= this->mats.Count()))
                 ? NULL
                 : &this->mats[static_cast<SIZE_T>(matIdx)]);
-            this->makeMesh(this->objs[oc], *objs[i], vertUsed, vert, norm, texc);
+            this->makeMesh(this->objs[oc], objs[i], vert, norm, texc);
+            std::vector<Tri>().swap(objs[i]);
+            usedMats.push_back(objsMats[i]);
             oc++;
         }
+    }
+
+    if (useCache) {
+        this->writeCache(filename, mtlLibs, usedMats);
+    }
+
+    return true;
+}
+
+
+/*
+ * WavefrontObjDataSource::parseChunk
+ */
+void WavefrontObjDataSource::parseChunk(const char *begin, const char *end, ParsedChunk& chunk) {
+    const char *words[32];
+    const char *wordEnds[32];
+    chunk.lineCount = 0;
+
+    for (const char *line = begin; line < end; chunk.lineCount++) {
+        const char *lineEnd = line;
+        while ((lineEnd < end) && (*lineEnd != '\n')) lineEnd++;
+
+        // split the line into words
+        unsigned int wc = 0;
+        for (const char *c = line; (c < lineEnd) && (wc < 32);) {
+            while ((c < lineEnd) && ((*c == ' ') || (*c == '\t') || (*c == '\r'))) c++;
+            if (c >= lineEnd) break;
+            words[wc] = c;
+            while ((c < lineEnd) && (*c != ' ') && (*c != '\t') && (*c != '\r')) c++;
+            wordEnds[wc++] = c;
+        }
+        const size_t lineIdx = chunk.lineCount;
+        line = lineEnd + 1;
+        if (wc == 0) continue;
+
+        const size_t kwLen = static_cast<size_t>(wordEnds[0] - words[0]);
+        auto isKeyword = [&](const char *kw) {
+            return (::strlen(kw) == kwLen) && (::strncmp(words[0], kw, kwLen) == 0);
+        };
+        auto directive = [&](ParsedChunk::Directive::Type type) -> ParsedChunk::Directive& {
+            chunk.directives.push_back(ParsedChunk::Directive());
+            ParsedChunk::Directive& d = chunk.directives.back();
+            d.type = type;
+            d.line = lineIdx;
+            d.triPos = chunk.tris.size();
+            d.lineS = d.lineT = 0;
+            d.lineID = 0;
+            d.hasID = false;
+            return d;
+        };
+
+        if (isKeyword("v") && (wc >= 4)) {
+            // vertex
+            for (unsigned int i = 1; i <= 3; i++) {
+                chunk.vert.push_back(static_cast<float>(::strtod(words[i], NULL)));
+            }
+
+        } else if (isKeyword("vn") && (wc >= 4)) {
+            // vertex normal
+            for (unsigned int i = 1; i <= 3; i++) {
+                chunk.norm.push_back(static_cast<float>(::strtod(words[i], NULL)));
+            }
+
+        } else if (isKeyword("vt") && (wc >= 2)) {
+            // vertex texture coordinate
+            chunk.texc.push_back(static_cast<float>(::strtod(words[1], NULL)));
+            chunk.texc.push_back((wc >= 3) ? static_cast<float>(::strtod(words[2], NULL)) : 0.0f);
+
+        } else if (isKeyword("f") && (wc >= 4)) {
+            // face
+            const size_t triStart = chunk.tris.size();
+            const char *error = NULL;
+            Tri t;
+            t.n1 = t.n2 = t.n3 = 0;
+            t.t1 = t.t2 = t.t3 = 0;
+            bool hasT, hasN;
+            int form = parseFaceElement(words[1], wordEnds[1], t.v1, t.t1, t.n1, t.t, t.n, error);
+            if ((form >= 0) && (parseFaceElement(words[2], wordEnds[2], t.v2, t.t2, t.n2, hasT, hasN, error) >= 0)
+                    && ((hasT != t.t) || (hasN != t.n))) {
+                error = "face entry inconsistancy";
+            }
+            for (unsigned int i = 3; (error == NULL) && (i < wc); i++) {
+                int f = parseFaceElement(words[i], wordEnds[i], t.v3, t.t3, t.n3, hasT, hasN, error);
+                if (f < 0) break;
+                if ((f != form) || (hasT != t.t) || (hasN != t.n)) {
+                    error = "face entry inconsistancy";
+                    break;
+                }
+                chunk.tris.push_back(t);
+                t.v2 = t.v3;
+                t.t2 = t.t3;
+                t.n2 = t.n3;
+            }
+            if (error != NULL) {
+                chunk.tris.resize(triStart);
+                chunk.errors.push_back(std::make_pair(lineIdx, std::string(error)));
+            }
+
+        } else if (isKeyword("mtllib") && (wc >= 2)) {
+            directive(ParsedChunk::Directive::MTLLIB).arg.assign(words[1], wordEnds[1]);
+
+        } else if (isKeyword("usemtl") && (wc >= 2)) {
+            directive(ParsedChunk::Directive::USEMTL).arg.assign(words[1], wordEnds[1]);
+
+        } else if (isKeyword("g")) {
+            directive(ParsedChunk::Directive::GROUP);
+
+        } else if (isKeyword("l") && (wc >= 3)) {
+            ParsedChunk::Directive& d = directive(ParsedChunk::Directive::LINE);
+            d.lineS = static_cast<int>(::strtol(words[1], NULL, 10));
+            d.lineT = static_cast<int>(::strtol(words[2], NULL, 10));
+            if (wc == 4) {
+                d.lineID = static_cast<size_t>(::strtoull(words[3], NULL, 10));
+                d.hasID = true;
+            }
+        }
+    }
+}
+
+
+/*
+ * WavefrontObjDataSource::cacheFileName
+ */
+vislib::TString WavefrontObjDataSource::cacheFileName(const vislib::TString& filename) {
+    vislib::TString name(filename);
+    name.Append(_T(".mmtricache"));
+    return name;
+}
+
+
+/*
+ * WavefrontObjDataSource::loadCache
+ */
+bool WavefrontObjDataSource::loadCache(const vislib::TString& filename) {
+    using vislib::sys::Log;
+    const vislib::TString cacheName = cacheFileName(filename);
+    if (!vislib::sys::File::Exists(cacheName)) return false;
+
+    uint64_t srcSize;
+    int64_t srcTime;
+    if (!fileStamp(filename, srcSize, srcTime)) return false;
+
+    double startTime = vislib::sys::PerformanceCounter::QueryMillis();
+    std::vector<char> data;
+    {
+        vislib::sys::File file;
+        if (!file.Open(cacheName, vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+                vislib::sys::File::OPEN_ONLY)) {
+            return false;
+        }
+        data.resize(static_cast<size_t>(file.GetSize()));
+        data.resize(static_cast<size_t>(file.Read(data.data(), data.size())));
+        file.Close();
+    }
 
-        delete[] vertUsed;
+    CacheReader in(data);
+    uint32_t magic, version;
+    uint64_t size;
+    int64_t time;
+    if (!in.Read(magic) || (magic != cacheMagic) || !in.Read(version) || (version != cacheVersion)
+            || !in.Read(size) || (size != srcSize) || !in.Read(time) || (time != srcTime)) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Cache \"%s\" is outdated", vislib::StringA(cacheName).PeekBuffer());
+        return false;
+    }
+
+    bool ok = true;
+    vislib::Array<vislib::StringA> matNames;
+    uint32_t libCount = 0, objCount = 0, lineCount = 0;
+    float box[6];
+    ok = ok && in.Read(libCount);
+    for (uint32_t i = 0; ok && (i < libCount); i++) {
+        vislib::StringA lib;
+        ok = in.ReadString(lib);
+        if (ok) this->loadMaterialLibrary(A2T(lib), matNames);
     }
 
+    ok = ok && in.Read(objCount);
+    if (ok) this->objs.SetCount(objCount);
+    for (uint32_t i = 0; ok && (i < objCount); i++) {
+        vislib::StringA mat;
+        uint32_t vertCnt, triCnt;
+        uint8_t hasNorm, hasTexc;
+        ok = in.ReadString(mat) && in.Read(vertCnt) && in.Read(triCnt) && in.Read(hasNorm) && in.Read(hasTexc);
+        if (!ok) break;
+
+        float *vd = new float[vertCnt * 3];
+        float *nd = hasNorm ? new float[vertCnt * 3] : NULL;
+        float *td = hasTexc ? new float[vertCnt * 2] : NULL;
+        unsigned int *fd = new unsigned int[triCnt * 3];
+        ok = in.Read(vd, vertCnt * 3 * sizeof(float))
+            && ((nd == NULL) || in.Read(nd, vertCnt * 3 * sizeof(float)))
+            && ((td == NULL) || in.Read(td, vertCnt * 2 * sizeof(float)))
+            && in.Read(fd, triCnt * 3 * sizeof(unsigned int));
+        this->objs[i].SetVertexData(vertCnt, vd, nd, NULL, td, true);
+        this->objs[i].SetTriangleData(triCnt, fd, true);
+
+        INT_PTR matIdx = matNames.IndexOf(mat);
+        this->objs[i].SetMaterial(
+            ((matIdx == vislib::Array<vislib::StringA>::INVALID_POS) || (static_cast<SIZE_T>(matIdx) >= this->mats.Count()))
+            ? NULL
+            : &this->mats[static_cast<SIZE_T>(matIdx)]);
+    }
+
+    ok = ok && in.Read(box) && in.Read(lineCount);
+    if (ok) this->lineVerts.SetCount(lineCount);
+    for (uint32_t i = 0; ok && (i < lineCount); i++) {
+        uint64_t id;
+        uint32_t floatCnt;
+        ok = in.Read(id) && in.Read(floatCnt);
+        if (!ok) break;
+        this->lineVerts[i].SetCount(floatCnt);
+        ok = in.Read(this->lineVerts[i].PeekElements(), floatCnt * sizeof(float));
+        Lines lineData;
+        lineData.SetID(static_cast<size_t>(id));
+        this->lines.push_back(lineData);
+        this->lines.back().Set(floatCnt / 3, this->lineVerts[i].PeekElements(), vislib::graphics::ColourRGBAu8(255, 255, 255, 255));
+    }
+
+    if (!ok) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Cache \"%s\" is corrupt", vislib::StringA(cacheName).PeekBuffer());
+        this->objs.Clear();
+        this->mats.Clear();
+        this->lines.clear();
+        this->lineVerts.Clear();
+        return false;
+    }
+    this->bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
+
+    Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Loaded cache \"%s\" after %f seconds\n",
+        vislib::StringA(cacheName).PeekBuffer(), (vislib::sys::PerformanceCounter::QueryMillis() - startTime) * 0.001);
     return true;
 }
 
 
+/*
+ * WavefrontObjDataSource::writeCache
+ */
+void WavefrontObjDataSource::writeCache(const vislib::TString& filename, const std::vector<vislib::TString>& mtlLibs,
+        const std::vector<vislib::StringA>& objMats) {
+    using vislib::sys::Log;
+    ASSERT(objMats.size() == this->objs.Count());
+
+    uint64_t srcSize;
+    int64_t srcTime;
+    if (!fileStamp(filename, srcSize, srcTime)) return;
+
+    CacheWriter out;
+    out.Write(cacheMagic);
+    out.Write(cacheVersion);
+    out.Write(srcSize);
+    out.Write(srcTime);
+
+    out.Write(static_cast<uint32_t>(mtlLibs.size()));
+    for (const vislib::TString& lib : mtlLibs) {
+        out.WriteString(T2A(lib));
+    }
+
+    out.Write(static_cast<uint32_t>(this->objs.Count()));
+    for (SIZE_T i = 0; i < this->objs.Count(); i++) {
+        const geocalls::CallTriMeshData::Mesh& mesh = this->objs[i];
+        const uint32_t vertCnt = mesh.GetVertexCount();
+        const uint32_t triCnt = mesh.GetTriCount();
+        const uint8_t hasNorm = mesh.HasNormalPointer() ? 1 : 0;
+        const uint8_t hasTexc = mesh.HasTextureCoordinatePointer() ? 1 : 0;
+        out.WriteString(objMats[i]);
+        out.Write(vertCnt);
+        out.Write(triCnt);
+        out.Write(hasNorm);
+        out.Write(hasTexc);
+        out.Write(mesh.GetVertexPointerFloat(), vertCnt * 3 * sizeof(float));
+        if (hasNorm) out.Write(mesh.GetNormalPointerFloat(), vertCnt * 3 * sizeof(float));
+        if (hasTexc) out.Write(mesh.GetTextureCoordinatePointerFloat(), vertCnt * 2 * sizeof(float));
+        out.Write(mesh.GetTriIndexPointerUInt32(), triCnt * 3 * sizeof(unsigned int));
+    }
+
+    const float box[6] = {this->bbox.Left(), this->bbox.Bottom(), this->bbox.Back(),
+        this->bbox.Right(), this->bbox.Top(), this->bbox.Front()};
+    out.Write(box);
+
+    out.Write(static_cast<uint32_t>(this->lineVerts.Count()));
+    for (SIZE_T i = 0; i < this->lineVerts.Count(); i++) {
+        out.Write(static_cast<uint64_t>(this->lines[i].ID()));
+        out.Write(static_cast<uint32_t>(this->lineVerts[i].Count()));
+        out.Write(this->lineVerts[i].PeekElements(), this->lineVerts[i].Count() * sizeof(float));
+    }
+
+    const vislib::TString cacheName = cacheFileName(filename);
+    vislib::sys::File file;
+    if (!file.Open(cacheName, vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE,
+            vislib::sys::File::CREATE_OVERWRITE)
+            || (file.Write(out.buffer.data(), out.buffer.size()) != out.buffer.size())) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "Unable to write cache \"%s\"", vislib::StringA(cacheName).PeekBuffer());
+        file.Close();
+        vislib::sys::File::Delete(cacheName);
+        return;
+    }
+    file.Close();
+}
+
+
 /*
  * WavefrontObjDataSource::loadMaterialLibrary
  */
@@ -482,63 +864,97 @@ void WavefrontObjDataSource::loadMaterialLibrary(const vislib::TString& filename
  * WavefrontObjDataSource::makeMesh
  */
 void WavefrontObjDataSource::makeMesh(megamol::geocalls::CallTriMeshData::Mesh& mesh,
-        const vislib::Array<WavefrontObjDataSource::Tri>& tris,
-        unsigned int* vu, const vislib::Array<vislib::math::Vector<float, 3> >& v,
-        const vislib::Array<vislib::math::Vector<float, 3> >& n,
-        const vislib::Array<vislib::math::Vector<float, 2> >& t) {
-    ASSERT(tris.Count() > 0);
-    ASSERT(v.Count() > 0);
-
-    float *vd = new float[tris.Count() * 3 * 3];  // vertices
-    float *nd = (tris[0].n) ? new float[tris.Count() * 3 * 3] : NULL;  // normals
-    float *td = (tris[0].t) ? new float[tris.Count() * 3 * 2] : NULL;  // texture coordinates
-    unsigned int* fd = new unsigned int[tris.Count() * 3]; // faces. actually just 0,1,2,3,4... since everything is multiplied out already
-    vislib::math::Cuboid<float> bbox(v[0].X(), v[0].Y(), v[0].Z(), v[0].X(), v[0].Y(), v[0].Z());
-
-    for (SIZE_T ti = 0; ti < tris.Count(); ti++) {
-        const Tri& tri = tris[ti];
-        vd[ti * 9 + 0 + 0] = v[tri.v1].X();
-        vd[ti * 9 + 0 + 1] = v[tri.v1].Y();
-        vd[ti * 9 + 0 + 2] = v[tri.v1].Z();
-        bbox.GrowToPoint(v[tri.v1].X(), v[tri.v1].Y(), v[tri.v1].Z());
-        vd[ti * 9 + 3 + 0] = v[tri.v2].X();
-        vd[ti * 9 + 3 + 1] = v[tri.v2].Y();
-        vd[ti * 9 + 3 + 2] = v[tri.v2].Z();
-        bbox.GrowToPoint(v[tri.v2].X(), v[tri.v2].Y(), v[tri.v2].Z());
-        vd[ti * 9 + 6 + 0] = v[tri.v3].X();
-        vd[ti * 9 + 6 + 1] = v[tri.v3].Y();
-        vd[ti * 9 + 6 + 2] = v[tri.v3].Z();
-        bbox.GrowToPoint(v[tri.v3].X(), v[tri.v3].Y(), v[tri.v3].Z());
-        if (nd) {
-            nd[ti * 9 + 0 + 0] = n[tri.n1].X();
-            nd[ti * 9 + 0 + 1] = n[tri.n1].Y();
-            nd[ti * 9 + 0 + 2] = n[tri.n1].Z();
-            nd[ti * 9 + 3 + 0] = n[tri.n2].X();
-            nd[ti * 9 + 3 + 1] = n[tri.n2].Y();
-            nd[ti * 9 + 3 + 2] = n[tri.n2].Z();
-            nd[ti * 9 + 6 + 0] = n[tri.n3].X();
-            nd[ti * 9 + 6 + 1] = n[tri.n3].Y();
-            nd[ti * 9 + 6 + 2] = n[tri.n3].Z();
+        const std::vector<WavefrontObjDataSource::Tri>& tris,
+        const std::vector<float>& v, const std::vector<float>& n,
+        const std::vector<float>& t) {
+    ASSERT(tris.size() > 0);
+    ASSERT(v.size() > 0);
+
+    const int triCnt = static_cast<int>(tris.size());
+    float *vd = new float[tris.size() * 3 * 3];  // vertices
+    float *nd = (tris[0].n) ? new float[tris.size() * 3 * 3] : NULL;  // normals
+    float *td = (tris[0].t) ? new float[tris.size() * 3 * 2] : NULL;  // texture coordinates
+    unsigned int* fd = new unsigned int[tris.size() * 3]; // faces. actually just 0,1,2,3,4... since everything is multiplied out already
+    float bboxMin[] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float bboxMax[] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    const size_t vc = v.size() / 3, nc = n.size() / 3, tc = t.size() / 2;
+    bool outOfRange = false;
+
+#pragma omp parallel
+    {
+        float minV[] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        float maxV[] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        bool invalid = false;
+
+#pragma omp for
+        for (int ti = 0; ti < triCnt; ti++) {
+            const Tri& tri = tris[ti];
+            const unsigned int vi[] = {tri.v1, tri.v2, tri.v3};
+            const unsigned int ni[] = {tri.n1, tri.n2, tri.n3};
+            const unsigned int tci[] = {tri.t1, tri.t2, tri.t3};
+            for (int j = 0; j < 3; j++) {
+                if (vi[j] < vc) {
+                    const float *p = v.data() + 3 * vi[j];
+                    for (int c = 0; c < 3; c++) {
+                        vd[ti * 9 + j * 3 + c] = p[c];
+                        if (minV[c] > p[c]) minV[c] = p[c];
+                        if (maxV[c] < p[c]) maxV[c] = p[c];
+                    }
+                } else {
+                    vd[ti * 9 + j * 3 + 0] = vd[ti * 9 + j * 3 + 1] = vd[ti * 9 + j * 3 + 2] = 0.0f;
+                    invalid = true;
+                }
+                if (nd) {
+                    if (tri.n && (ni[j] < nc)) {
+                        const float *p = n.data() + 3 * ni[j];
+                        nd[ti * 9 + j * 3 + 0] = p[0];
+                        nd[ti * 9 + j * 3 + 1] = p[1];
+                        nd[ti * 9 + j * 3 + 2] = p[2];
+                    } else {
+                        nd[ti * 9 + j * 3 + 0] = nd[ti * 9 + j * 3 + 1] = 0.0f;
+                        nd[ti * 9 + j * 3 + 2] = 1.0f;
+                        invalid = invalid || tri.n;
+                    }
+                }
+                if (td) {
+                    if (tri.t && (tci[j] < tc)) {
+                        td[ti * 6 + j * 2 + 0] = t[2 * tci[j] + 0];
+                        td[ti * 6 + j * 2 + 1] = t[2 * tci[j] + 1];
+                    } else {
+                        td[ti * 6 + j * 2 + 0] = td[ti * 6 + j * 2 + 1] = 0.0f;
+                        invalid = invalid || tri.t;
+                    }
+                }
+                fd[ti * 3 + j] = ti * 3 + j;
+            }
         }
-        if (td) {
-            td[ti * 6 + 0 + 0] = t[tri.t1].X();
-            td[ti * 6 + 0 + 1] = t[tri.t1].Y();
-            td[ti * 6 + 2 + 0] = t[tri.t2].X();
-            td[ti * 6 + 2 + 1] = t[tri.t2].Y();
-            td[ti * 6 + 4 + 0] = t[tri.t3].X();
-            td[ti * 6 + 4 + 1] = t[tri.t3].Y();
+
+#pragma omp critical
+        {
+            for (int c = 0; c < 3; c++) {
+                if (bboxMin[c] > minV[c]) bboxMin[c] = minV[c];
+                if (bboxMax[c] < maxV[c]) bboxMax[c] = maxV[c];
+            }
+            outOfRange = outOfRange || invalid;
         }
-        fd[ti * 3 + 0] = ti * 3;
-        fd[ti * 3 + 1] = ti * 3 + 1;
-        fd[ti * 3 + 2] = ti * 3 + 2;
+    }
+
+    if (bboxMin[0] > bboxMax[0]) {
+        bboxMin[0] = bboxMin[1] = bboxMin[2] = bboxMax[0] = bboxMax[1] = bboxMax[2] = 0.0f;
+    }
+    vislib::math::Cuboid<float> bbox(bboxMin[0], bboxMin[1], bboxMin[2], bboxMax[0], bboxMax[1], bboxMax[2]);
+
+    if (outOfRange) {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+            "Face element indices out of range have been ignored");
     }
 
     // TODO: normal smoothing?
     // TODO: data consolidation?
 
-    mesh.SetVertexData(static_cast<unsigned int>(tris.Count() * 3), vd, nd, NULL, td, true); // now don't delete vd, nd, or td
+    mesh.SetVertexData(static_cast<unsigned int>(tris.size() * 3), vd, nd, NULL, td, true); // now don't delete vd, nd, or td
     //mesh.SetTriangleData(0, NULL, false);
-    mesh.SetTriangleData(tris.Count(), fd, true);
+    mesh.SetTriangleData(static_cast<unsigned int>(tris.size()), fd, true);
 
     if (this->bbox.IsEmpty()) this->bbox = bbox;
     else this->bbox.Union(bbox);
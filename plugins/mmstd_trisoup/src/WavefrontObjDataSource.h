@@ -16,6 +16,8 @@
 #include "vislib/Array.h"
 #include "vislib/String.h"
 #include "vislib/StringTokeniser.h"
+#include <string>
+#include <vector>
 
 
 namespace megamol {
@@ -24,6 +26,12 @@ namespace trisoup {
 
     /**
      * Data source class for wavefront OBJ files
+     *
+     * The file is split into chunks of whole lines, which are parsed in
+     * parallel; groups, materials and lines are then applied in file order.
+     * Optionally, the resulting meshes are stored in a binary cache file next
+     * to the OBJ file, which is loaded instead as long as the OBJ file is
+     * unchanged.
      */
     class WavefrontObjDataSource : public AbstractTriMeshLoader {
     public:
@@ -112,6 +120,49 @@ namespace trisoup {
 
         } Tri;
 
+        /** The result of parsing one chunk of the file */
+        struct ParsedChunk;
+
+        /**
+         * Parses the lines in [begin, end). Vertices, normals, texture
+         * coordinates and faces are parsed completely, all other statements
+         * are recorded to be applied in file order.
+         *
+         * @param begin The first character of the chunk
+         * @param end The end of the chunk, which must be the end of a line
+         * @param chunk Receives the parsed data
+         */
+        static void parseChunk(const char *begin, const char *end, ParsedChunk& chunk);
+
+        /**
+         * Answers the name of the cache file of an OBJ file
+         *
+         * @param filename The OBJ file
+         *
+         * @return The name of the cache file
+         */
+        static vislib::TString cacheFileName(const vislib::TString& filename);
+
+        /**
+         * Loads the meshes and lines from the cache file of an OBJ file, if
+         * the cache file exists and matches the OBJ file.
+         *
+         * @param filename The OBJ file
+         *
+         * @return True if the cache has been loaded
+         */
+        bool loadCache(const vislib::TString& filename);
+
+        /**
+         * Stores the loaded meshes and lines in the cache file of an OBJ file
+         *
+         * @param filename The OBJ file
+         * @param mtlLibs The material libraries loaded
+         * @param objMats The material names of the meshes
+         */
+        void writeCache(const vislib::TString& filename, const std::vector<vislib::TString>& mtlLibs,
+                const std::vector<vislib::StringA>& objMats);
+
         /**
          * Loads a material library file
          *
@@ -125,17 +176,17 @@ namespace trisoup {
          *
          * @param mesh The object to store the new mesh
          * @param tris The incoming triangles
-         * @param vu unsigned-int-Array of the same size as 'v' free to use
-         * @param v The vertices array
-         * @param n The normal vectors array
-         * @param t The texture coordinates array
+         * @param v The vertices array, three floats per vertex
+         * @param n The normal vectors array, three floats per normal
+         * @param t The texture coordinates array, two floats per coordinate
          */
         void makeMesh(megamol::geocalls::CallTriMeshData::Mesh& mesh,
-                const vislib::Array<WavefrontObjDataSource::Tri>& tris,
-                unsigned int* vu, const vislib::Array<vislib::math::Vector<float, 3> >& v,
-                const vislib::Array<vislib::math::Vector<float, 3> >& n,
-                const vislib::Array<vislib::math::Vector<float, 2> >& t);
+                const std::vector<WavefrontObjDataSource::Tri>& tris,
+                const std::vector<float>& v, const std::vector<float>& n,
+                const std::vector<float>& t);
 
+        /** Flag whether to use a binary cache file */
+        core::param::ParamSlot useCacheSlot;
 
         /** vertex store for lines */
         vislib::Array<vislib::Array<float> > lineVerts;
@@ -6,6 +6,7 @@
  */
 #include "stdafx.h"
 #include "VoluMetricJob.h"
+#include "mmcore/CoreInstance.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
@@ -16,14 +17,15 @@
 #include "vislib/math/Vector.h"
 #include "vislib/graphics/NamedColours.h"
 #include "vislib/sys/Thread.h"
-#include "vislib/sys/ThreadPool.h"
 #include "MarchingCubeTables.h"
 #include "TetraVoxelizer.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/sys/ConsoleProgressBar.h"
 #include "vislib/sys/SystemInformation.h"
+#include <algorithm>
 #include <climits>
 #include <cfloat>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::trisoup;
@@ -159,10 +161,17 @@ DWORD VoluMetricJob::Run(void *userData) {
     voxelizerList.SetCapacityIncrement(16);
     SubJobDataList.SetCapacityIncrement(16);
 
+    // the subvolumes are computed by the scheduler of the core, shared with all other modules
+    core::utility::TaskScheduler& scheduler = this->GetCoreInstance()->GetTaskScheduler();
+    std::vector<core::utility::TaskScheduler::TaskHandle> tasks;
+    auto countPending = [&tasks]() {
+        return static_cast<SIZE_T>(std::count_if(tasks.begin(), tasks.end(),
+            [](const core::utility::TaskScheduler::TaskHandle& t) { return !t->IsDone(); }));
+    };
+
     for (unsigned int frameI = 0; frameI < frameCnt; frameI++) {
 
-        vislib::sys::ThreadPool pool;
-        //pool.SetThreadCount(static_cast<SIZE_T>(vislib::sys::SystemInformation::ProcessorCount() * 1.5));
+        tasks.clear();
 
         datacall->SetFrameID(frameI, true);
         do {
@@ -329,7 +338,9 @@ DWORD VoluMetricJob::Run(void *userData) {
                     voxelizerList.Add(v);
 
                     //if (z == 0 && y == 0) {
-                        pool.QueueUserWorkItem(v, sjd);
+                        tasks.push_back(scheduler.Submit(
+                            [v, sjd](const core::utility::TaskScheduler::Task&) { v->Run(sjd); },
+                            core::utility::TaskScheduler::Priority::BACKGROUND));
                     //}
                 }
             }
@@ -350,21 +361,29 @@ DWORD VoluMetricJob::Run(void *userData) {
         vislib::Array<VoxelizerFloat> volPerID;
         vislib::Array<VoxelizerFloat> voidVolPerID;
 
-        SIZE_T lastCount = pool.CountUserWorkItems();
+        SIZE_T lastCount = countPending();
         while(1) {
-            if (pool.Wait(500) && pool.CountUserWorkItems() == 0) {
+            // wait for the oldest pending subvolume, but report the progress regularly
+            for (auto& t : tasks) {
+                if (!t->IsDone()) {
+                    t->Wait(500);
+                    break;
+                }
+            }
+            const SIZE_T pendingCount = countPending();
+            if (pendingCount == 0) {
                         // we are done
                         break;
             }
-            if (lastCount != pool.CountUserWorkItems()) {
+            if (lastCount != pendingCount) {
                 pb.Set(static_cast<vislib::sys::ConsoleProgressBar::Size>(
-                    divX * divY * divZ - pool.CountUserWorkItems()));
+                    divX * divY * divZ - pendingCount));
                 generateStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
                 if (storeMesh)
                     copyMeshesToBackbuffer(uniqueIDs);
                 if (storeVolume)
                     copyVolumesToBackBuffer();
-                lastCount = pool.CountUserWorkItems();
+                lastCount = pendingCount;
             }
         }
         generateStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
@@ -375,7 +394,6 @@ DWORD VoluMetricJob::Run(void *userData) {
             copyVolumesToBackBuffer();
         pb.Stop();
         Log::DefaultLog.WriteInfo("Done marching.");
-        pool.Terminate(true);
 
         while(! this->continueToNextFrameSlot.Param<megamol::core::param::BoolParam>()->Value()) {
             vislib::sys::Thread::Sleep(500);
@@ -0,0 +1,81 @@
+#extension GL_ARB_compute_shader: enable
+
+/* resolution of the volume in voxels */
+uniform ivec3 resolution;
+/* the iso value, in the units returned by sampling the volume texture */
+uniform float isoValue;
+/* world space position of the first voxel and distance between two voxels */
+uniform vec3 boxMin;
+uniform vec3 voxelSize;
+/* number of vertices the vertex buffer can hold */
+uniform uint maxVertices;
+
+/* texture that houses the volume data */
+uniform highp sampler3D volume_tx3D;
+
+struct Vertex {
+    vec4 position;
+    vec4 normal;
+};
+
+layout(std430, binding = 0) writeonly buffer VertexBuffer { Vertex vertices[]; };
+
+/* indirect draw command, whose vertex count doubles as allocator for the vertex buffer */
+layout(std430, binding = 1) buffer DrawCommand {
+    uint vertexCount;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+float fetchValue(ivec3 voxel) {
+    return texelFetch(volume_tx3D, clamp(voxel, ivec3(0), resolution - 1), 0).x;
+}
+
+vec3 fetchGradient(ivec3 voxel) {
+    return vec3(fetchValue(voxel + ivec3(1, 0, 0)) - fetchValue(voxel - ivec3(1, 0, 0)),
+               fetchValue(voxel + ivec3(0, 1, 0)) - fetchValue(voxel - ivec3(0, 1, 0)),
+               fetchValue(voxel + ivec3(0, 0, 1)) - fetchValue(voxel - ivec3(0, 0, 1))) /
+           (2.0 * voxelSize);
+}
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+void main() {
+    ivec3 cell = ivec3(gl_GlobalInvocationID.xyz);
+
+    if (any(greaterThanEqual(cell, resolution - 1))) return;
+
+    float values[8];
+    int configuration = 0;
+    for (int i = 0; i < 8; ++i) {
+        values[i] = fetchValue(cell + cornerOffsets[i]);
+        if (values[i] < isoValue) configuration |= 1 << i;
+    }
+
+    int cntVertices = 0;
+    while (cntVertices < 15 && triangleTable[configuration * 16 + cntVertices] >= 0) {
+        cntVertices += 3;
+    }
+    if (cntVertices == 0) return;
+
+    // Reserve space for all triangles of the cell at once; the host enlarges the buffer and repeats the extraction
+    // if the surface does not fit.
+    uint offset = atomicAdd(vertexCount, uint(cntVertices));
+    if (offset + uint(cntVertices) > maxVertices) return;
+
+    for (int v = 0; v < cntVertices; ++v) {
+        ivec2 corners = edgeCorners[triangleTable[configuration * 16 + v]];
+        ivec3 c0 = cell + cornerOffsets[corners.x];
+        ivec3 c1 = cell + cornerOffsets[corners.y];
+
+        float delta = values[corners.y] - values[corners.x];
+        float t = (delta != 0.0) ? clamp((isoValue - values[corners.x]) / delta, 0.0, 1.0) : 0.5;
+
+        vec3 position = boxMin + mix(vec3(c0), vec3(c1), t) * voxelSize;
+        vec3 gradient = mix(fetchGradient(c0), fetchGradient(c1), t);
+
+        vertices[offset + v].position = vec4(position, 1.0);
+        vertices[offset + v].normal = vec4((length(gradient) > 0.0) ? -normalize(gradient) : vec3(0.0), 0.0);
+    }
+}
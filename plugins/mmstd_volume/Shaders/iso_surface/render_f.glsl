@@ -0,0 +1,15 @@
+uniform vec4 colour;
+
+in vec3 view_normal;
+in vec3 view_position;
+
+out vec4 frag_out;
+
+void main()
+{
+    // Two-sided headlight, so the orientation of the surface does not matter
+    vec3 normal = (length(view_normal) > 0.0) ? normalize(view_normal) : vec3(0.0, 0.0, 1.0);
+    float lambert = abs(dot(normal, normalize(-view_position)));
+
+    frag_out = vec4(colour.rgb * (0.2 + 0.8 * lambert), colour.a);
+}
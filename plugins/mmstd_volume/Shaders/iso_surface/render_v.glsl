@@ -0,0 +1,22 @@
+uniform mat4 view_mx;
+uniform mat4 proj_mx;
+
+struct Vertex {
+    vec4 position;
+    vec4 normal;
+};
+
+layout(std430, binding = 0) readonly buffer VertexBuffer { Vertex vertices[]; };
+
+out vec3 view_normal;
+out vec3 view_position;
+
+void main()
+{
+    Vertex vertex = vertices[gl_VertexID];
+
+    vec4 position = view_mx * vec4(vertex.position.xyz, 1.0);
+    view_position = position.xyz;
+    view_normal = mat3(view_mx) * vertex.normal.xyz;
+    gl_Position = proj_mx * position;
+}
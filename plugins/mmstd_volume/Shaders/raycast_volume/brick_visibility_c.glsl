@@ -0,0 +1,35 @@
+#extension GL_ARB_compute_shader: enable
+
+/* value range of the volume, used to normalize the samples before the transfer function lookup */
+uniform vec2 valRange;
+/* number of bricks along each axis */
+uniform ivec3 brickCount;
+
+/* minimum and maximum sample value of each brick */
+uniform highp sampler3D brick_range_tx3D;
+
+layout(r8, binding = 1) writeonly uniform highp image3D brick_visibility_tx3D;
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+void main() {
+    ivec3 brick = ivec3(gl_GlobalInvocationID.xyz);
+
+    if (any(greaterThanEqual(brick, brickCount))) return;
+
+    vec2 range = (texelFetch(brick_range_tx3D, brick, 0).xy - valRange.x) / (valRange.y - valRange.x);
+
+    // Same mapping as tflookup(), but visiting every texel touched by the value range of the brick, so that
+    // the linear interpolation between two texels cannot produce an opacity the brick is not tested for.
+    int texels = textureSize(tfTexture, 0);
+    vec2 u = clamp((range - tfRange.x) / (tfRange.y - tfRange.x), 0.0, 1.0) * float(texels - 1);
+    int first = int(floor(u.x));
+    int last = min(int(ceil(u.y)), texels - 1);
+
+    float opacity = 0.0;
+    for (int i = first; i <= last && opacity == 0.0; ++i) {
+        opacity = max(opacity, texelFetch(tfTexture, i, 0).w);
+    }
+
+    imageStore(brick_visibility_tx3D, brick, vec4(opacity > 0.0 ? 1.0 : 0.0));
+}
@@ -26,8 +26,19 @@ uniform float opacityThreshold;
 
 uniform vec2 valRange;
 
+/* resolution of the volume in voxels */
+uniform vec3 volumeResolution;
+/* number of voxels along each edge of a brick */
+uniform int brickSize;
+/* number of bricks along each axis */
+uniform ivec3 brickCount;
+/* skip bricks that are entirely transparent under the current transfer function */
+uniform bool skipEmptySpace;
+
 /*	texture that houses the volume data */
 uniform highp sampler3D volume_tx3D;
+/* texture marking the bricks containing visible samples */
+uniform highp sampler3D brick_visibility_tx3D;
 /* texture containing scene depth */
 uniform highp sampler2D depth_tx2D;
 
@@ -132,6 +143,25 @@ void main() {
             texCoords *= 1.0 - 2.0 * halfVoxelSize;
             texCoords += halfVoxelSize;
 
+            if (skipEmptySpace) {
+                // Every brick covers the samples interpolated from its voxels, see RaycastVolumeRenderer.
+                ivec3 voxel = max(ivec3(floor(texCoords * volumeResolution - 0.5f)), ivec3(0));
+                ivec3 brick = min(voxel / brickSize, brickCount - 1);
+
+                if (texelFetch(brick_visibility_tx3D, brick, 0).x == 0.0f) {
+                    // Advance to the first sample behind the brick, staying on the sampling grid of the ray.
+                    vec3 brickMin = (vec3(brick * brickSize) + 0.5f) / volumeResolution;
+                    vec3 brickMax = (vec3((brick + 1) * brickSize) + 0.5f) / volumeResolution;
+                    brickMin = boxMin + (brickMin - halfVoxelSize) / (1.0 - 2.0 * halfVoxelSize) * (boxMax - boxMin);
+                    brickMax = boxMin + (brickMax - halfVoxelSize) / (1.0 - 2.0 * halfVoxelSize) * (boxMax - boxMin);
+
+                    float brick_tnear, brick_tfar;
+                    intersectBox(ray, brickMin, brickMax, brick_tnear, brick_tfar);
+                    t += max(1.0f, ceil((brick_tfar - t) / rayStep)) * rayStep;
+                    continue;
+                }
+            }
+
             vec4 vol_sample = tflookup((texture(volume_tx3D, texCoords).x - valRange.x) / (valRange.y - valRange.x));
             
             // vec4 vol_sample = texture(volume_tx3D,texCoords);
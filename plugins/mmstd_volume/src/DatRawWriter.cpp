@@ -9,14 +9,103 @@
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
 #include "vislib/sys/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::core;
 using namespace megamol::stdplugin::volume;
 
+namespace {
+
+/*
+ * Averages blocks of 2x2x2 voxels of src; the last block along an odd resolution takes the remaining voxels.
+ */
+template <class T>
+void downsample(const T* src, const size_t* srcRes, size_t components, const size_t* dstRes, T* dst) {
+    for (size_t z = 0; z < dstRes[2]; ++z) {
+        for (size_t y = 0; y < dstRes[1]; ++y) {
+            for (size_t x = 0; x < dstRes[0]; ++x) {
+                for (size_t c = 0; c < components; ++c) {
+                    double sum = 0.0;
+                    size_t cnt = 0;
+                    for (size_t sz = 2 * z; sz < std::min(2 * z + 2, srcRes[2]); ++sz) {
+                        for (size_t sy = 2 * y; sy < std::min(2 * y + 2, srcRes[1]); ++sy) {
+                            for (size_t sx = 2 * x; sx < std::min(2 * x + 2, srcRes[0]); ++sx) {
+                                sum += static_cast<double>(
+                                    src[((sz * srcRes[1] + sy) * srcRes[0] + sx) * components + c]);
+                                ++cnt;
+                            }
+                        }
+                    }
+                    double const mean = sum / static_cast<double>(cnt);
+                    dst[((z * dstRes[1] + y) * dstRes[0] + x) * components + c] =
+                        static_cast<T>(std::is_integral<T>::value ? std::round(mean) : mean);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Computes the next level of the pyramid for the scalar type described by meta.
+ */
+bool downsampleLevel(const misc::VolumetricDataCall::Metadata& meta, const void* src, const size_t* dstRes,
+    std::vector<char>& dst) {
+    dst.resize(dstRes[0] * dstRes[1] * dstRes[2] * meta.Components * meta.ScalarLength);
+
+#define DATRAWWRITER_DOWNSAMPLE(T)                                                                                 \
+    downsample(static_cast<const T*>(src), meta.Resolution, meta.Components, dstRes, reinterpret_cast<T*>(dst.data()))
+
+    switch (meta.ScalarType) {
+    case misc::FLOATING_POINT:
+        if (meta.ScalarLength == 4) {
+            DATRAWWRITER_DOWNSAMPLE(float);
+            return true;
+        } else if (meta.ScalarLength == 8) {
+            DATRAWWRITER_DOWNSAMPLE(double);
+            return true;
+        }
+        return false;
+    case misc::UNSIGNED_INTEGER:
+        if (meta.ScalarLength == 1) {
+            DATRAWWRITER_DOWNSAMPLE(uint8_t);
+            return true;
+        } else if (meta.ScalarLength == 2) {
+            DATRAWWRITER_DOWNSAMPLE(uint16_t);
+            return true;
+        } else if (meta.ScalarLength == 4) {
+            DATRAWWRITER_DOWNSAMPLE(uint32_t);
+            return true;
+        }
+        return false;
+    case misc::SIGNED_INTEGER:
+        if (meta.ScalarLength == 1) {
+            DATRAWWRITER_DOWNSAMPLE(int8_t);
+            return true;
+        } else if (meta.ScalarLength == 2) {
+            DATRAWWRITER_DOWNSAMPLE(int16_t);
+            return true;
+        } else if (meta.ScalarLength == 4) {
+            DATRAWWRITER_DOWNSAMPLE(int32_t);
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+
+#undef DATRAWWRITER_DOWNSAMPLE
+}
+
+} // namespace
+
 /*
  * DatRawWriter::DatRawWriter
  */
@@ -25,6 +114,8 @@ DatRawWriter::DatRawWriter(void)
     , filenameSlot("filepathPrefix", "The path prefix of the folder and file the files will be written to. To this "
                                      "path the ending .dat and .raw will be added")
     , frameIDSlot("frameID", "The id of the data frame that will be written")
+    , levelsSlot("levels", "The number of coarser levels of a multi-resolution pyramid written alongside the frame. "
+                           "Level l is stored with the suffix _l<l> and halves the resolution of level l - 1")
     , dataSlot("data", "The slot requesting the data to be written") {
 
     this->filenameSlot.SetParameter(new param::FilePathParam(""));
@@ -33,6 +124,9 @@ DatRawWriter::DatRawWriter(void)
     this->frameIDSlot.SetParameter(new param::IntParam(0, 0));
     this->MakeSlotAvailable(&this->frameIDSlot);
 
+    this->levelsSlot.SetParameter(new param::IntParam(0, 0));
+    this->MakeSlotAvailable(&this->levelsSlot);
+
     this->dataSlot.SetCompatibleCall<misc::VolumetricDataCallDescription>();
     this->MakeSlotAvailable(&this->dataSlot);
 }
@@ -97,7 +191,53 @@ bool DatRawWriter::run(void) {
     datpath << filepath << std::setw(4) << std::setfill('0') <<  std::to_string(frame) << ".dat";
     std::stringstream rawpath;
     rawpath << filepath << std::setw(4) << std::setfill('0') << std::to_string(frame) << ".raw";
-    return writeFrame(datpath.str(), rawpath.str(), *vdc);
+    if (!writeFrame(datpath.str(), rawpath.str(), *vdc->GetMetadata(), vdc->FrameID(), vdc->GetData())) {
+        return false;
+    }
+
+    // Coarser levels of the pyramid, each one computed from the previous one
+    int const levels = this->levelsSlot.Param<param::IntParam>()->Value();
+    if (levels > 0 && vdc->GetMetadata()->GridType != misc::CARTESIAN) {
+        Log::DefaultLog.WriteWarn("Multi-resolution levels are only written for cartesian grids.");
+        return true;
+    }
+
+    misc::VolumetricDataCall::Metadata meta = *vdc->GetMetadata();
+    float sliceDists[3] = {meta.SliceDists[0][0], meta.SliceDists[1][0], meta.SliceDists[2][0]};
+    std::vector<char> src, dst;
+    const void* data = vdc->GetData();
+
+    for (int level = 1; level <= levels; ++level) {
+        if (meta.Resolution[0] <= 1 && meta.Resolution[1] <= 1 && meta.Resolution[2] <= 1) break;
+
+        size_t res[3];
+        for (int d = 0; d < 3; ++d) {
+            res[d] = (meta.Resolution[d] + 1) / 2;
+        }
+        if (!downsampleLevel(meta, data, res, dst)) {
+            Log::DefaultLog.WriteError("Multi-resolution levels are not supported for the scalar type of the data.");
+            return false;
+        }
+
+        // Keep the extents of the volume
+        for (int d = 0; d < 3; ++d) {
+            if (res[d] > 1) {
+                sliceDists[d] *= static_cast<float>(meta.Resolution[d] - 1) / static_cast<float>(res[d] - 1);
+            }
+            meta.Resolution[d] = res[d];
+            meta.SliceDists[d] = sliceDists + d;
+        }
+        src.swap(dst);
+        data = src.data();
+
+        std::stringstream levelpath;
+        levelpath << filepath << std::setw(4) << std::setfill('0') << std::to_string(frame) << "_l" << level;
+        if (!writeFrame(levelpath.str() + ".dat", levelpath.str() + ".raw", meta, vdc->FrameID(), data)) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /*
@@ -111,12 +251,13 @@ bool DatRawWriter::getCapabilities(DataWriterCtrlCall& call) {
 /*
  * DatRawWriter::writeFrame
  */
-bool DatRawWriter::writeFrame(std::string datpath, std::string rawpath, core::misc::VolumetricDataCall& data) {
+bool DatRawWriter::writeFrame(std::string datpath, std::string rawpath,
+    const core::misc::VolumetricDataCall::Metadata& metadata, unsigned int frameID, const void* data) {
     using vislib::sys::Log;
     auto lastPos = rawpath.find_last_of("/\\");
     std::string writestring = rawpath.substr(lastPos + 1);
 
-    auto meta = data.GetMetadata();
+    auto meta = &metadata;
 
     std::ofstream datfile(datpath, std::ios_base::binary);
     if (datfile.is_open()) {
@@ -164,10 +305,10 @@ bool DatRawWriter::writeFrame(std::string datpath, std::string rawpath, core::mi
         datfile << "Resolution:     " << meta->Resolution[0] << " " << meta->Resolution[1] << " " << meta->Resolution[2]
                 << std::endl;
         datfile << "SliceThickness: " << meta->SliceDists[0][0] << " " << meta->SliceDists[1][0] << " "
-                << meta->SliceDists[1][0] << std::endl;
+                << meta->SliceDists[2][0] << std::endl;
         datfile << "Origin:         " << meta->Origin[0] << " " << meta->Origin[1] << " " << meta->Origin[2]
                 << std::endl;
-        datfile << "Time:           " << data.FrameID() << std::endl;
+        datfile << "Time:           " << frameID << std::endl;
         datfile.close();
         Log::DefaultLog.WriteInfo("Dat file successfully written to \"%s\"", datpath.c_str());
     } else {
@@ -177,7 +318,9 @@ bool DatRawWriter::writeFrame(std::string datpath, std::string rawpath, core::mi
 
     std::ofstream rawfile(rawpath, std::ios_base::binary);
     if (rawfile.is_open()) {
-        rawfile.write(reinterpret_cast<const char*>(data.GetData()), data.GetVoxelSize() * data.GetVoxelsPerFrame());
+        size_t const size =
+            meta->Resolution[0] * meta->Resolution[1] * meta->Resolution[2] * meta->Components * meta->ScalarLength;
+        rawfile.write(reinterpret_cast<const char*>(data), size);
         rawfile.close();
         Log::DefaultLog.WriteInfo("Raw file successfully written to \"%s\"", rawpath.c_str());
     } else {
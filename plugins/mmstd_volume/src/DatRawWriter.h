@@ -96,11 +96,14 @@ private:
      *
      * @param datpath The file path to the dat file
      * @param rawpath The file path to the raw file
-     * @param data The data of the current frame
+     * @param meta The metadata of the data to be written
+     * @param frameID The ID of the frame
+     * @param data The voxels of the frame, as described by meta
      *
      * @return True on success
      */
-    bool writeFrame(std::string datpath, std::string rawpath, core::misc::VolumetricDataCall& data);
+    bool writeFrame(std::string datpath, std::string rawpath, const core::misc::VolumetricDataCall::Metadata& meta,
+        unsigned int frameID, const void* data);
 
     /** The file name of the file to be written */
     core::param::ParamSlot filenameSlot;
@@ -108,6 +111,9 @@ private:
     /** The frame ID of the frame to be written */
     core::param::ParamSlot frameIDSlot;
 
+    /** The number of coarser levels of the multi-resolution pyramid to be written */
+    core::param::ParamSlot levelsSlot;
+
     /** The slot asking for data */
     core::CallerSlot dataSlot;
 };
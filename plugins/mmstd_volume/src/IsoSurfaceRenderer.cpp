@@ -0,0 +1,294 @@
+/*
+ * IsoSurfaceRenderer.cpp
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#include "IsoSurfaceRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+
+#include "vislib/Exception.h"
+#include "vislib/graphics/gl/ShaderSource.h"
+#include "vislib/sys/Log.h"
+
+#include "mmcore/CoreInstance.h"
+#include "mmcore/misc/VolumetricDataCall.h"
+#include "mmcore/param/ColorParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/view/Camera_2.h"
+
+using namespace megamol::stdplugin::volume;
+
+/** Size of a vertex of the surface: position and normal */
+#define ISOSURFACERENDERER_VERTEX_SIZE (8 * sizeof(float))
+
+IsoSurfaceRenderer::IsoSurfaceRenderer()
+    : Renderer3DModule_2()
+    , m_volumetricData_callerSlot("getData", "Connects the iso surface renderer with a volumetric data source")
+    , m_iso_value_param("iso value", "The value of the surface, in the units of the data")
+    , m_colour_param("colour", "The colour of the surface") {
+
+    this->m_volumetricData_callerSlot.SetCompatibleCall<core::misc::VolumetricDataCallDescription>();
+    this->MakeSlotAvailable(&this->m_volumetricData_callerSlot);
+
+    this->m_iso_value_param << new core::param::FloatParam(0.5f);
+    this->MakeSlotAvailable(&this->m_iso_value_param);
+
+    this->m_colour_param << new core::param::ColorParam(0.8f, 0.8f, 0.8f, 1.0f);
+    this->MakeSlotAvailable(&this->m_colour_param);
+}
+
+IsoSurfaceRenderer::~IsoSurfaceRenderer() { this->Release(); }
+
+bool IsoSurfaceRenderer::create() {
+    try {
+        // create shader programs
+        m_extract_shdr = std::make_unique<vislib::graphics::gl::GLSLComputeShader>();
+        m_render_shdr = std::make_unique<vislib::graphics::gl::GLSLShader>();
+
+        vislib::graphics::gl::ShaderSource compute_shader_src;
+        vislib::graphics::gl::ShaderSource vertex_shader_src;
+        vislib::graphics::gl::ShaderSource fragment_shader_src;
+
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("IsoSurfaceRenderer::extract", compute_shader_src))
+            return false;
+        if (!m_extract_shdr->Compile(compute_shader_src.Code(), compute_shader_src.Count())) return false;
+        if (!m_extract_shdr->Link()) return false;
+
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("IsoSurfaceRenderer::vert", vertex_shader_src))
+            return false;
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("IsoSurfaceRenderer::frag", fragment_shader_src))
+            return false;
+        if (!m_render_shdr->Compile(vertex_shader_src.Code(), vertex_shader_src.Count(), fragment_shader_src.Code(),
+                fragment_shader_src.Count()))
+            return false;
+        if (!m_render_shdr->Link()) return false;
+    } catch (vislib::graphics::gl::AbstractOpenGLShader::CompileException ce) {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to compile shader (@%s): %s\n",
+            vislib::graphics::gl::AbstractOpenGLShader::CompileException::CompileActionName(ce.FailedAction()),
+            ce.GetMsgA());
+        return false;
+    } catch (vislib::Exception e) {
+        vislib::sys::Log::DefaultLog.WriteMsg(
+            vislib::sys::Log::LEVEL_ERROR, "Unable to compile shader: %s\n", e.GetMsgA());
+        return false;
+    } catch (...) {
+        vislib::sys::Log::DefaultLog.WriteMsg(
+            vislib::sys::Log::LEVEL_ERROR, "Unable to compile shader: Unknown exception\n");
+        return false;
+    }
+
+    // create empty volume texture
+    glowl::TextureLayout volume_layout(GL_R32F, 1, 1, 1, GL_RED, GL_FLOAT, 1,
+        {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+    m_volume_texture = std::make_unique<glowl::Texture3D>("iso_surface_volume_texture", volume_layout, nullptr);
+
+    // create buffers, the vertex buffer grows with the first extraction
+    std::array<GLuint, 4> draw_command = {0, 1, 0, 0};
+    m_draw_command_buffer = std::make_unique<glowl::BufferObject>(
+        GL_SHADER_STORAGE_BUFFER, draw_command.data(), sizeof(draw_command), GL_DYNAMIC_DRAW);
+
+    m_vertex_capacity = 3 * 1024;
+    m_vertex_buffer = std::make_unique<glowl::BufferObject>(
+        GL_SHADER_STORAGE_BUFFER, nullptr, m_vertex_capacity * ISOSURFACERENDERER_VERTEX_SIZE, GL_DYNAMIC_COPY);
+
+    return true;
+}
+
+void IsoSurfaceRenderer::release() {
+    m_extract_shdr.reset(nullptr);
+    m_render_shdr.reset(nullptr);
+    m_volume_texture.reset(nullptr);
+    m_vertex_buffer.reset(nullptr);
+    m_draw_command_buffer.reset(nullptr);
+}
+
+bool IsoSurfaceRenderer::GetExtents(megamol::core::view::CallRender3D_2& cr) {
+    auto cd = m_volumetricData_callerSlot.CallAs<core::misc::VolumetricDataCall>();
+
+    if (cd == nullptr) return false;
+
+    int const req_frame = static_cast<int>(cr.Time());
+
+    cd->SetFrameID(req_frame);
+
+    if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_EXTENTS)) return false;
+    if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_METADATA)) return false;
+
+    cr.SetTimeFramesCount(cd->FrameCount());
+    cr.AccessBoundingBoxes() = cd->GetBoundingBoxes();
+
+    return true;
+}
+
+bool IsoSurfaceRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
+    if (!updateVolumeData()) return false;
+
+    if (m_surface_dirty || m_iso_value_param.IsDirty()) {
+        extractSurface();
+        m_iso_value_param.ResetDirty();
+        m_surface_dirty = false;
+    }
+
+    // get camera
+    core::view::Camera_2 cam;
+    cr.GetCamera(cam);
+
+    cam_type::matrix_type view, proj;
+    cam.calc_matrices(view, proj);
+
+    // store state
+    bool state_depth_test = glIsEnabled(GL_DEPTH_TEST);
+    if (!state_depth_test) glEnable(GL_DEPTH_TEST);
+
+    m_render_shdr->Enable();
+
+    glUniformMatrix4fv(m_render_shdr->ParameterLocation("view_mx"), 1, GL_FALSE,
+        glm::value_ptr(static_cast<glm::mat4>(view)));
+    glUniformMatrix4fv(m_render_shdr->ParameterLocation("proj_mx"), 1, GL_FALSE,
+        glm::value_ptr(static_cast<glm::mat4>(proj)));
+    glUniform4fv(m_render_shdr->ParameterLocation("colour"), 1,
+        this->m_colour_param.Param<core::param::ColorParam>()->Value().data());
+
+    // draw the surface, the vertex count stays on the GPU
+    m_vertex_buffer->bind(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_draw_command_buffer->getName());
+    glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    m_render_shdr->Disable();
+
+    // restore state
+    if (!state_depth_test) glDisable(GL_DEPTH_TEST);
+
+    return true;
+}
+
+bool IsoSurfaceRenderer::updateVolumeData() {
+    auto* cd = this->m_volumetricData_callerSlot.CallAs<core::misc::VolumetricDataCall>();
+
+    if (cd == nullptr) return false;
+
+    if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_EXTENTS)) return false;
+    if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_METADATA)) return false;
+    if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_DATA)) return false;
+
+    if (this->m_volume_datahash != cd->DataHash() || this->m_frame_id != cd->FrameID()) {
+        this->m_volume_datahash = cd->DataHash();
+        this->m_frame_id = cd->FrameID();
+    } else {
+        return true;
+    }
+
+    auto const metadata = cd->GetMetadata();
+
+    if (metadata->GridType != core::misc::CARTESIAN) {
+        vislib::sys::Log::DefaultLog.WriteError("IsoSurfaceRenderer only works with cartesian grids (for now)");
+        return false;
+    }
+
+    for (int d = 0; d < 3; ++d) {
+        m_volume_origin[d] = metadata->Origin[d];
+        m_volume_extents[d] = metadata->Extents[d];
+        m_volume_resolution[d] = static_cast<int>(metadata->Resolution[d]);
+    }
+
+    // Integer data is uploaded normalised, so the iso value must be scaled alike.
+    GLenum internal_format;
+    GLenum type;
+
+    if (metadata->ScalarType == core::misc::FLOATING_POINT && metadata->ScalarLength == 4) {
+        internal_format = GL_R32F;
+        type = GL_FLOAT;
+        m_value_scale = 1.0f;
+    } else if (metadata->ScalarType == core::misc::UNSIGNED_INTEGER && metadata->ScalarLength == 1) {
+        internal_format = GL_R8;
+        type = GL_UNSIGNED_BYTE;
+        m_value_scale = 1.0f / 255.0f;
+    } else if (metadata->ScalarType == core::misc::UNSIGNED_INTEGER && metadata->ScalarLength == 2) {
+        internal_format = GL_R16;
+        type = GL_UNSIGNED_SHORT;
+        m_value_scale = 1.0f / 65535.0f;
+    } else if (metadata->ScalarType == core::misc::SIGNED_INTEGER && metadata->ScalarLength == 2) {
+        internal_format = GL_R16_SNORM;
+        type = GL_SHORT;
+        m_value_scale = 1.0f / 32767.0f;
+    } else {
+        vislib::sys::Log::DefaultLog.WriteError("IsoSurfaceRenderer supports float, uchar, ushort and short volumes.");
+        return false;
+    }
+
+    glowl::TextureLayout volume_layout(internal_format, m_volume_resolution[0], m_volume_resolution[1],
+        m_volume_resolution[2], GL_RED, type, 1,
+        {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+
+    m_volume_texture->reload(volume_layout, cd->GetData());
+
+    m_surface_dirty = true;
+
+    return true;
+}
+
+void IsoSurfaceRenderer::extractSurface() {
+    glm::vec3 const voxel_size = m_volume_extents / glm::max(glm::vec3(m_volume_resolution - 1), glm::vec3(1.0f));
+    glm::ivec3 const cells = glm::max(m_volume_resolution - 1, glm::ivec3(0));
+
+    m_extract_shdr->Enable();
+
+    glUniform3iv(m_extract_shdr->ParameterLocation("resolution"), 1, glm::value_ptr(m_volume_resolution));
+    glUniform1f(m_extract_shdr->ParameterLocation("isoValue"),
+        this->m_iso_value_param.Param<core::param::FloatParam>()->Value() * m_value_scale);
+    glUniform3fv(m_extract_shdr->ParameterLocation("boxMin"), 1, glm::value_ptr(m_volume_origin));
+    glUniform3fv(m_extract_shdr->ParameterLocation("voxelSize"), 1, glm::value_ptr(voxel_size));
+
+    glActiveTexture(GL_TEXTURE0);
+    m_volume_texture->bindTexture();
+    glUniform1i(m_extract_shdr->ParameterLocation("volume_tx3D"), 0);
+
+    // At most two runs: the first one determines the size of the surface if it exceeds the vertex buffer.
+    for (int run = 0; run < 2; ++run) {
+        std::array<GLuint, 4> draw_command = {0, 1, 0, 0};
+        m_draw_command_buffer->rebuffer(draw_command.data(), sizeof(draw_command));
+
+        glUniform1ui(m_extract_shdr->ParameterLocation("maxVertices"), m_vertex_capacity);
+        m_vertex_buffer->bind(0);
+        m_draw_command_buffer->bind(1);
+
+        m_extract_shdr->Dispatch(static_cast<int>(std::ceil(cells.x / 4.0f)),
+            static_cast<int>(std::ceil(cells.y / 4.0f)), static_cast<int>(std::ceil(cells.z / 4.0f)));
+
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        GLuint vertex_count = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_draw_command_buffer->getName());
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &vertex_count);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        if (vertex_count <= m_vertex_capacity) {
+            vislib::sys::Log::DefaultLog.WriteInfo(
+                "IsoSurfaceRenderer: extracted %u triangles at iso value %f", vertex_count / 3,
+                this->m_iso_value_param.Param<core::param::FloatParam>()->Value());
+            break;
+        }
+
+        // leave some room for scrubbing the iso value without reallocating every time
+        m_vertex_capacity = vertex_count + vertex_count / 4;
+        m_vertex_buffer->rebuffer(nullptr, static_cast<GLsizeiptr>(m_vertex_capacity) * ISOSURFACERENDERER_VERTEX_SIZE);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    m_extract_shdr->Disable();
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
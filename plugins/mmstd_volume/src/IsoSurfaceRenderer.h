@@ -0,0 +1,143 @@
+/*
+ * IsoSurfaceRenderer.h
+ *
+ * Copyright (C) 2019 by Universitaet Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef ISO_SURFACE_RENDERER_H_INCLUDED
+#define ISO_SURFACE_RENDERER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#    pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <limits>
+#include <memory>
+
+#include "vislib/graphics/gl/GLSLComputeShader.h"
+#include "vislib/graphics/gl/GLSLShader.h"
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
+#include "mmcore/view/CallRender3D_2.h"
+#include "mmcore/view/Renderer3DModule_2.h"
+
+#include "glowl/BufferObject.hpp"
+#include "glowl/Texture3D.hpp"
+
+namespace megamol {
+namespace stdplugin {
+namespace volume {
+
+/**
+ * Renders an iso surface of a volumetric dataset. The surface is extracted with marching cubes in a compute shader
+ * into a vertex buffer that stays on the GPU, so changing the iso value only repeats the extraction.
+ */
+class IsoSurfaceRenderer : public core::view::Renderer3DModule_2 {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) { return "IsoSurfaceRenderer"; }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Compute-based marching cubes renderer for iso surfaces of volumetric datasets.";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return vislib::graphics::gl::GLSLShader::AreExtensionsAvailable() && ogl_IsVersionGEQ(4, 3);
+    }
+
+    IsoSurfaceRenderer();
+    ~IsoSurfaceRenderer();
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create() override;
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release() override;
+
+    /**
+     * The get extents callback. The module should set the members of
+     * 'call' to tell the caller the extents of its data (bounding boxes
+     * and times).
+     *
+     * @param call The calling call.
+     *
+     * @return The return value of the function.
+     */
+    virtual bool GetExtents(core::view::CallRender3D_2& call) override;
+
+    /**
+     * The render callback.
+     *
+     * @param call The calling call.
+     *
+     * @return The return value of the function.
+     */
+    virtual bool Render(core::view::CallRender3D_2& call) override;
+
+    /**
+     * Get and update data by calling input modules
+     */
+    bool updateVolumeData();
+
+    /**
+     * Extract the iso surface into the vertex buffer, enlarging the buffer if the surface does not fit
+     */
+    void extractSurface();
+
+private:
+    std::unique_ptr<vislib::graphics::gl::GLSLComputeShader> m_extract_shdr;
+    std::unique_ptr<vislib::graphics::gl::GLSLShader> m_render_shdr;
+
+    std::unique_ptr<glowl::Texture3D> m_volume_texture;
+
+    /** vertices of the surface and the indirect draw command holding their number */
+    std::unique_ptr<glowl::BufferObject> m_vertex_buffer;
+    std::unique_ptr<glowl::BufferObject> m_draw_command_buffer;
+
+    GLuint m_vertex_capacity = 0;
+    bool m_surface_dirty = true;
+
+    std::size_t m_volume_datahash = std::numeric_limits<std::size_t>::max();
+    int m_frame_id = -1;
+
+    glm::vec3 m_volume_origin;
+    glm::vec3 m_volume_extents;
+    glm::ivec3 m_volume_resolution;
+
+    /** factor mapping data values to the values returned by sampling the volume texture */
+    float m_value_scale = 1.0f;
+
+    /** caller slot */
+    core::CallerSlot m_volumetricData_callerSlot;
+
+    core::param::ParamSlot m_iso_value_param;
+    core::param::ParamSlot m_colour_param;
+};
+
+} // namespace volume
+} // namespace stdplugin
+} // namespace megamol
+
+#endif
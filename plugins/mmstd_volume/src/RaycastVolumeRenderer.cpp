@@ -10,7 +10,9 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "vislib/Exception.h"
 #include "vislib/graphics/gl/GLSLComputeShader.h"
@@ -21,6 +23,7 @@
 #include "mmcore/Call.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/misc/VolumetricDataCall.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/view/CallGetTransferFunction.h"
 #include "mmcore/view/CallRender3D_2.h"
@@ -33,11 +36,58 @@
 
 using namespace megamol::stdplugin::volume;
 
+/** Number of voxels along each edge of the bricks used for empty space skipping */
+#define RAYCASTVOLUMERENDERER_BRICK_SIZE 8
+
+namespace {
+
+/**
+ * Compute the minimum and maximum value of each brick. A brick also includes the first voxel layer of its
+ * successors, so its range bounds every value interpolated between its voxels.
+ */
+template <typename T>
+void computeBrickRanges(const T* data, const glm::ivec3& resolution, const glm::ivec3& brick_count, float scale,
+    std::vector<float>& ranges) {
+    ranges.resize(2 * static_cast<size_t>(brick_count.x) * brick_count.y * brick_count.z);
+
+    auto dst = ranges.begin();
+    for (int bz = 0; bz < brick_count.z; ++bz) {
+        for (int by = 0; by < brick_count.y; ++by) {
+            for (int bx = 0; bx < brick_count.x; ++bx) {
+                float min_value = std::numeric_limits<float>::max();
+                float max_value = std::numeric_limits<float>::lowest();
+
+                int const z_end = std::min((bz + 1) * RAYCASTVOLUMERENDERER_BRICK_SIZE, resolution.z - 1);
+                int const y_end = std::min((by + 1) * RAYCASTVOLUMERENDERER_BRICK_SIZE, resolution.y - 1);
+                int const x_end = std::min((bx + 1) * RAYCASTVOLUMERENDERER_BRICK_SIZE, resolution.x - 1);
+                for (int z = bz * RAYCASTVOLUMERENDERER_BRICK_SIZE; z <= z_end; ++z) {
+                    for (int y = by * RAYCASTVOLUMERENDERER_BRICK_SIZE; y <= y_end; ++y) {
+                        const T* row = data + (static_cast<size_t>(z) * resolution.y + y) * resolution.x;
+                        for (int x = bx * RAYCASTVOLUMERENDERER_BRICK_SIZE; x <= x_end; ++x) {
+                            float const value = static_cast<float>(row[x]) * scale;
+                            min_value = std::min(min_value, value);
+                            max_value = std::max(max_value, value);
+                        }
+                    }
+                }
+
+                *dst++ = min_value;
+                *dst++ = max_value;
+            }
+        }
+    }
+}
+
+} // namespace
+
 RaycastVolumeRenderer::RaycastVolumeRenderer()
     : Renderer3DModule_2()
+    , m_brick_count(1, 1, 1)
     , m_volumetricData_callerSlot("getData", "Connects the volume renderer with a voluemtric data source")
     , m_transferFunction_callerSlot("getTranfserFunction", "Connects the volume renderer with a transfer function")
-    , m_ray_step_ratio_param("ray step ratio", "Adjust sampling rate") {
+    , m_ray_step_ratio_param("ray step ratio", "Adjust sampling rate")
+    , m_opacity_threshold_param("opacity threshold", "Terminate rays once their accumulated opacity exceeds this")
+    , m_skip_empty_space_param("skip empty space", "Skip bricks that are transparent under the transfer function") {
 
     this->m_volumetricData_callerSlot.SetCompatibleCall<core::misc::VolumetricDataCallDescription>();
     this->MakeSlotAvailable(&this->m_volumetricData_callerSlot);
@@ -47,6 +97,12 @@ RaycastVolumeRenderer::RaycastVolumeRenderer()
 
     this->m_ray_step_ratio_param << new core::param::FloatParam(1.0f);
     this->MakeSlotAvailable(&this->m_ray_step_ratio_param);
+
+    this->m_opacity_threshold_param << new core::param::FloatParam(0.99f, 0.0f, 1.0f);
+    this->MakeSlotAvailable(&this->m_opacity_threshold_param);
+
+    this->m_skip_empty_space_param << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->m_skip_empty_space_param);
 }
 
 RaycastVolumeRenderer::~RaycastVolumeRenderer() { this->Release(); }
@@ -55,9 +111,11 @@ bool RaycastVolumeRenderer::create() {
     try {
         // create shader program
         m_raycast_volume_compute_shdr = std::make_unique<vislib::graphics::gl::GLSLComputeShader>();
+        m_brick_visibility_compute_shdr = std::make_unique<vislib::graphics::gl::GLSLComputeShader>();
         m_render_to_framebuffer_shdr = std::make_unique<vislib::graphics::gl::GLSLShader>();
 
         vislib::graphics::gl::ShaderSource compute_shader_src;
+        vislib::graphics::gl::ShaderSource bricks_shader_src;
         vislib::graphics::gl::ShaderSource vertex_shader_src;
         vislib::graphics::gl::ShaderSource fragment_shader_src;
 
@@ -67,6 +125,12 @@ bool RaycastVolumeRenderer::create() {
             return false;
         if (!m_raycast_volume_compute_shdr->Link()) return false;
 
+        if (!instance()->ShaderSourceFactory().MakeShaderSource("RaycastVolumeRenderer::bricks", bricks_shader_src))
+            return false;
+        if (!m_brick_visibility_compute_shdr->Compile(bricks_shader_src.Code(), bricks_shader_src.Count()))
+            return false;
+        if (!m_brick_visibility_compute_shdr->Link()) return false;
+
         if (!instance()->ShaderSourceFactory().MakeShaderSource("RaycastVolumeRenderer::vert", vertex_shader_src))
             return false;
         if (!instance()->ShaderSourceFactory().MakeShaderSource("RaycastVolumeRenderer::frag", fragment_shader_src))
@@ -105,12 +169,28 @@ bool RaycastVolumeRenderer::create() {
         {});
     m_volume_texture = std::make_unique<glowl::Texture3D>("raycast_volume_texture", volume_layout, nullptr);
 
+    // create a single visible brick until there is data
+    std::array<float, 2> brick_range = {0.0f, 0.0f};
+    glowl::TextureLayout brick_range_layout(GL_RG32F, 1, 1, 1, GL_RG, GL_FLOAT, 1,
+        {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+    m_brick_range_texture =
+        std::make_unique<glowl::Texture3D>("raycast_volume_brick_range", brick_range_layout, brick_range.data());
+
+    std::array<uint8_t, 1> brick_visibility = {255};
+    glowl::TextureLayout brick_visibility_layout(GL_R8, 1, 1, 1, GL_RED, GL_UNSIGNED_BYTE, 1,
+        {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+    m_brick_visibility_texture = std::make_unique<glowl::Texture3D>(
+        "raycast_volume_brick_visibility", brick_visibility_layout, brick_visibility.data());
+
     return true;
 }
 
 void RaycastVolumeRenderer::release() {
     m_raycast_volume_compute_shdr.reset(nullptr);
+    m_brick_visibility_compute_shdr.reset(nullptr);
     m_render_target.reset(nullptr);
+    m_brick_range_texture.reset(nullptr);
+    m_brick_visibility_texture.reset(nullptr);
 }
 
 bool RaycastVolumeRenderer::GetExtents(megamol::core::view::CallRender3D_2& cr) {
@@ -139,6 +219,12 @@ bool RaycastVolumeRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
     auto ct = this->m_transferFunction_callerSlot.CallAs<core::view::CallGetTransferFunction>();
     if (ct == nullptr || !(*ct)()) return false;
 
+    if (m_brick_visibility_dirty || ct->IsDirty()) {
+        updateBrickVisibility(*ct);
+        ct->ResetDirty();
+        m_brick_visibility_dirty = false;
+    }
+
     // get camera
     core::view::Camera_2 cam;
     cr.GetCamera(cam);
@@ -181,7 +267,16 @@ bool RaycastVolumeRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
     glUniform2fv(m_raycast_volume_compute_shdr->ParameterLocation("valRange"), 1, this->valRange.data());
     glUniform1f(m_raycast_volume_compute_shdr->ParameterLocation("rayStepRatio"),
         this->m_ray_step_ratio_param.Param<core::param::FloatParam>()->Value());
-    glUniform1f(m_raycast_volume_compute_shdr->ParameterLocation("opacityThreshold"), 1.0);
+    glUniform1f(m_raycast_volume_compute_shdr->ParameterLocation("opacityThreshold"),
+        this->m_opacity_threshold_param.Param<core::param::FloatParam>()->Value());
+
+    // empty space skipping
+    glUniform3fv(m_raycast_volume_compute_shdr->ParameterLocation("volumeResolution"), 1,
+        glm::value_ptr(m_volume_resolution));
+    glUniform1i(m_raycast_volume_compute_shdr->ParameterLocation("brickSize"), RAYCASTVOLUMERENDERER_BRICK_SIZE);
+    glUniform3iv(m_raycast_volume_compute_shdr->ParameterLocation("brickCount"), 1, glm::value_ptr(m_brick_count));
+    glUniform1i(m_raycast_volume_compute_shdr->ParameterLocation("skipEmptySpace"),
+        this->m_skip_empty_space_param.Param<core::param::BoolParam>()->Value() ? 1 : 0);
 
     // bind volume texture
     glActiveTexture(GL_TEXTURE0);
@@ -189,6 +284,10 @@ bool RaycastVolumeRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
     glUniform1i(m_raycast_volume_compute_shdr->ParameterLocation("volume_tx3D"), 0);
     // bind the transfer function
     ct->BindConvenience(*m_raycast_volume_compute_shdr, GL_TEXTURE1, 1);
+    // bind brick visibility
+    glActiveTexture(GL_TEXTURE2);
+    m_brick_visibility_texture->bindTexture();
+    glUniform1i(m_raycast_volume_compute_shdr->ParameterLocation("brick_visibility_tx3D"), 2);
 
     // bind image texture
     m_render_target->bindImage(0, GL_WRITE_ONLY);
@@ -200,6 +299,9 @@ bool RaycastVolumeRenderer::Render(megamol::core::view::CallRender3D_2& cr) {
     // unbind image texture
     glBindImageTexture(0, 0, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R);
 
+    // unbind brick visibility
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_3D, 0);
     // unbind the transfer function
     ct->UnbindConvenience();
     // unbind volume texture
@@ -354,5 +456,74 @@ bool RaycastVolumeRenderer::updateVolumeData() {
 
     m_volume_texture->reload(volume_layout, volumedata);
 
+    // min/max grid of the bricks, in the units returned by sampling the volume texture
+    glm::ivec3 const resolution(static_cast<int>(metadata->Resolution[0]), static_cast<int>(metadata->Resolution[1]),
+        static_cast<int>(metadata->Resolution[2]));
+    m_brick_count = glm::max((resolution - 2) / RAYCASTVOLUMERENDERER_BRICK_SIZE + 1, glm::ivec3(1));
+
+    std::vector<float> brick_ranges;
+    switch (metadata->ScalarType) {
+    case core::misc::FLOATING_POINT:
+        computeBrickRanges(static_cast<const float*>(volumedata), resolution, m_brick_count, 1.0f, brick_ranges);
+        break;
+    case core::misc::UNSIGNED_INTEGER:
+        if (metadata->ScalarLength == 1) {
+            computeBrickRanges(
+                static_cast<const uint8_t*>(volumedata), resolution, m_brick_count, 1.0f / 255.0f, brick_ranges);
+        } else {
+            computeBrickRanges(static_cast<const uint16_t*>(volumedata), resolution, m_brick_count, 1.0f, brick_ranges);
+        }
+        break;
+    case core::misc::SIGNED_INTEGER:
+        computeBrickRanges(static_cast<const int16_t*>(volumedata), resolution, m_brick_count, 1.0f, brick_ranges);
+        break;
+    default:
+        break;
+    }
+
+    glowl::TextureLayout brick_range_layout(GL_RG32F, m_brick_count.x, m_brick_count.y, m_brick_count.z, GL_RG,
+        GL_FLOAT, 1, {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+    m_brick_range_texture->reload(brick_range_layout, brick_ranges.data());
+
+    glowl::TextureLayout brick_visibility_layout(GL_R8, m_brick_count.x, m_brick_count.y, m_brick_count.z, GL_RED,
+        GL_UNSIGNED_BYTE, 1, {{GL_TEXTURE_MIN_FILTER, GL_NEAREST}, {GL_TEXTURE_MAG_FILTER, GL_NEAREST}}, {});
+    m_brick_visibility_texture->reload(brick_visibility_layout, nullptr);
+
+    m_brick_visibility_dirty = true;
+
     return true;
 }
+
+void RaycastVolumeRenderer::updateBrickVisibility(core::view::CallGetTransferFunction& ct) {
+    m_brick_visibility_compute_shdr->Enable();
+
+    glUniform2fv(m_brick_visibility_compute_shdr->ParameterLocation("valRange"), 1, this->valRange.data());
+    glUniform3iv(m_brick_visibility_compute_shdr->ParameterLocation("brickCount"), 1, glm::value_ptr(m_brick_count));
+
+    // bind brick ranges
+    glActiveTexture(GL_TEXTURE0);
+    m_brick_range_texture->bindTexture();
+    glUniform1i(m_brick_visibility_compute_shdr->ParameterLocation("brick_range_tx3D"), 0);
+    // bind the transfer function
+    ct.BindConvenience(*m_brick_visibility_compute_shdr, GL_TEXTURE1, 1);
+
+    // bind image texture
+    m_brick_visibility_texture->bindImage(1, GL_WRITE_ONLY);
+
+    // dispatch compute
+    m_brick_visibility_compute_shdr->Dispatch(static_cast<int>(std::ceil(m_brick_count.x / 4.0f)),
+        static_cast<int>(std::ceil(m_brick_count.y / 4.0f)), static_cast<int>(std::ceil(m_brick_count.z / 4.0f)));
+
+    // unbind image texture
+    glBindImageTexture(1, 0, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+
+    // unbind the transfer function
+    ct.UnbindConvenience();
+    // unbind brick ranges
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    m_brick_visibility_compute_shdr->Disable();
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
@@ -25,6 +25,7 @@
 #include "mmcore/Call.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/view/CallGetTransferFunction.h"
 #include "mmcore/view/CallRender3D_2.h"
 #include "mmcore/view/Renderer3DModule_2.h"
 
@@ -109,14 +110,27 @@ protected:
      */
     bool updateVolumeData();
 
+    /**
+     * Mark the bricks of the volume that contain visible samples under the given transfer function
+     */
+    void updateBrickVisibility(core::view::CallGetTransferFunction& ct);
+
 private:
     std::unique_ptr<vislib::graphics::gl::GLSLComputeShader> m_raycast_volume_compute_shdr;
+    std::unique_ptr<vislib::graphics::gl::GLSLComputeShader> m_brick_visibility_compute_shdr;
     std::unique_ptr<vislib::graphics::gl::GLSLShader> m_render_to_framebuffer_shdr;
 
     std::unique_ptr<glowl::Texture2D> m_render_target;
 
     std::unique_ptr<glowl::Texture3D> m_volume_texture;
 
+    /** minimum and maximum value of each brick, and whether a brick is visible under the transfer function */
+    std::unique_ptr<glowl::Texture3D> m_brick_range_texture;
+    std::unique_ptr<glowl::Texture3D> m_brick_visibility_texture;
+
+    glm::ivec3 m_brick_count;
+    bool m_brick_visibility_dirty = true;
+
     std::size_t m_volume_datahash = std::numeric_limits<std::size_t>::max();
     int m_frame_id = -1;
 
@@ -129,6 +143,8 @@ private:
     core::CallerSlot m_transferFunction_callerSlot;
 
     core::param::ParamSlot m_ray_step_ratio_param;
+    core::param::ParamSlot m_opacity_threshold_param;
+    core::param::ParamSlot m_skip_empty_space_param;
 
     std::array<float, 2> valRange;
 };
@@ -17,6 +17,7 @@
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/StringParam.h"
 
+#include "vislib/sys/File.h"
 #include "vislib/sys/Log.h"
 
 
@@ -27,12 +28,6 @@
 #endif /* !FALSE */
 
 
-// static int CompareBufferSlots(
-//        const megamol::datraw::VolumetricDataSource::BufferSlot *& lhs,
-//        const megamol::datraw::VolumetricDataSource::BufferSlot *& rhs) {
-//}
-
-
 /*
  * megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource
  */
@@ -45,10 +40,13 @@ megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource(void)
     , paramAsyncWake("AsyncWake", "The time in milliseconds after that the loader wakes itself.")
     , paramBuffers("Buffers", "The number of buffers for loading frames asynchronously.")
     , paramFileName("FileName", "The path to the dat file to be loaded.")
+    , paramLevel("Level", "The level of the multi-resolution pyramid to load, 0 being the full resolution.")
+    , paramMemorySaturation("MemorySaturation", "The memory in MiB that buffers for frames may use.")
     , paramOutputDataSize("OutputDataSize", "Forces the scalar type to the specified size.")
     , paramOutputDataType("OutputDataType", "Enforces the type of a scalar during loading.")
     , paramLoadAsync("LoadAsync", "Start asynchronous loading of frames.")
-    , slotGetData("GetData", "Slot for requesting data from the source.") {
+    , slotGetData("GetData", "Slot for requesting data from the source.")
+    , useCounter(0) {
     using core::misc::VolumetricDataCall;
     core::param::EnumParam* enumParam = nullptr;
 
@@ -67,6 +65,14 @@ megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource(void)
     this->paramFileName.SetUpdateCallback(&VolumetricDataSource::onFileNameChanged);
     this->MakeSlotAvailable(&this->paramFileName);
 
+    this->paramLevel.SetParameter(new core::param::IntParam(0, 0));
+    this->paramLevel.SetUpdateCallback(&VolumetricDataSource::onFileNameChanged);
+    this->MakeSlotAvailable(&this->paramLevel);
+
+    this->paramMemorySaturation.SetParameter(new core::param::IntParam(0, 0));
+    this->paramMemorySaturation.SetUpdateCallback(&VolumetricDataSource::onMemorySaturationChanged);
+    this->MakeSlotAvailable(&this->paramMemorySaturation);
+
     enumParam = new core::param::EnumParam(-1);
     enumParam->SetTypePair(-1, _T("Auto"));
     enumParam->SetTypePair(1, _T("1 Byte/Scalar"));
@@ -123,6 +129,30 @@ size_t megamol::stdplugin::volume::VolumetricDataSource::calcFrameSize(void) con
 }
 
 
+/*
+ * megamol::stdplugin::volume::VolumetricDataSource::calcBufferCount
+ */
+size_t megamol::stdplugin::volume::VolumetricDataSource::calcBufferCount(void) const {
+    using core::param::IntParam;
+
+    size_t retval = this->paramBuffers.Param<IntParam>()->Value();
+    size_t budget = static_cast<size_t>(this->paramMemorySaturation.Param<IntParam>()->Value()) << 20;
+
+    if ((budget > 0) && (this->fileInfo != nullptr)) {
+        size_t frameSize = this->calcFrameSize();
+        if (frameSize > 0) {
+            retval = vislib::math::Max(retval, budget / frameSize);
+        }
+    }
+    if ((this->metadata.NumberOfFrames > 0) && (retval > this->metadata.NumberOfFrames)) {
+        // There is no point in having more buffers than frames.
+        retval = this->metadata.NumberOfFrames;
+    }
+
+    return vislib::math::Max<size_t>(retval, 2);
+}
+
+
 /*
  * megamol::stdplugin::volume::VolumetricDataSource::create
  */
@@ -233,8 +263,26 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onFileNameChanged(core::p
                                   _T("in preparation for changing the data set."));
     }
 
-    /* Read the header. */
+    /* Select the requested level of the pyramid written by DatRawWriter. */
     vislib::StringA fileName(this->paramFileName.Param<core::param::FilePathParam>()->Value());
+    auto level = this->paramLevel.Param<core::param::IntParam>()->Value();
+    if (level > 0) {
+        vislib::StringA stem(fileName);
+        if (stem.EndsWith(".dat") || stem.EndsWith(".DAT")) {
+            stem.Truncate(stem.Length() - 4);
+        }
+        vislib::StringA levelName;
+        levelName.Format("%s_l%d.dat", stem.PeekBuffer(), level);
+        if (vislib::sys::File::Exists(levelName.PeekBuffer())) {
+            fileName = levelName;
+        } else {
+            Log::DefaultLog.WriteWarn(_T("Level %d of %hs does not exist, ")
+                                      _T("loading the full resolution instead."),
+                level, fileName.PeekBuffer());
+        }
+    }
+
+    /* Read the header. */
     if (::datRaw_readHeader(fileName.PeekBuffer(), this->fileInfo, nullptr) != FALSE) {
         Log::DefaultLog.WriteInfo(_T("Successfully loaded dat file %hs."), fileName.PeekBuffer());
 
@@ -434,7 +482,7 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
         try {
             /* Evaluate parameter changes. */
             bool isAsync = this->paramLoadAsync.Param<BoolParam>()->Value();
-            size_t cntBuffers = this->paramBuffers.Param<IntParam>()->Value();
+            size_t cntBuffers = this->calcBufferCount();
 
             if (cntBuffers != this->buffers.Count()) {
                 bool isResume = this->suspendAsyncLoad(true);
@@ -507,6 +555,9 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
                     } /* end if (b != buffer) */
                 }     /* end for (size_t i = 0; i < this->buffers.Count(); ++i) */
 
+                /* Reuse the least recently used frames first. */
+                oldBuffers.Sort(&VolumetricDataSource::compareLastUse);
+
                 if (buffer == nullptr) {
                     /*
                      * If we do not have the frame, request it using a free or
@@ -581,6 +632,7 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
                     ASSERT(buffer->status == BUFFER_STATUS_USED);
 
                     /* Move the stuff to the call and set the unlocker. */
+                    buffer->LastUse = ++this->useCounter;
                     c.SetData(buffer->Buffer.At(0), 1);
                     VolumetricDataSource::setUnlocker(c, buffer);
 
@@ -636,6 +688,7 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
 
                     ASSERT(this->buffers[bufferIdx]->Buffer.At(0) == dst[0]);
                     this->buffers[bufferIdx]->status.store(BUFFER_STATUS_USED);
+                    this->buffers[bufferIdx]->LastUse = ++this->useCounter;
                     c.SetData(dst[0], 1);
                     VolumetricDataSource::setUnlocker(c, this->buffers[bufferIdx]);
 
@@ -834,6 +887,7 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onTryGetData(core::Call&
             auto buffer = this->buffers[bufferIdx];
             int expected = BUFFER_STATUS_READY;
             if (buffer->status.compare_exchange_strong(expected, BUFFER_STATUS_USED)) {
+                buffer->LastUse = ++this->useCounter;
                 data = buffer->Buffer.At(0);
                 cnt = 1;
             }
@@ -978,8 +1032,17 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onLoadAsyncChanged(core::
  * megamol::stdplugin::volume::VolumetricDataSource::onMemorySaturationChanged
  */
 bool megamol::stdplugin::volume::VolumetricDataSource::onMemorySaturationChanged(core::param::ParamSlot& slot) {
-    // TODO: Free memory if allowed staturation was shrinked.
-    return false;
+    if ((this->fileInfo == nullptr) || (this->buffers.Count() == this->calcBufferCount())) {
+        return false;
+    }
+
+    bool isResume = this->suspendAsyncLoad(true);
+    this->assertBuffersUnsafe();
+    if (isResume) {
+        this->resumeAsyncLoad();
+    }
+
+    return true;
 }
 
 
@@ -1217,6 +1280,23 @@ DWORD megamol::stdplugin::volume::VolumetricDataSource::loadAsync(void* userData
 }
 
 
+/*
+ * megamol::stdplugin::volume::VolumetricDataSource::compareLastUse
+ */
+int megamol::stdplugin::volume::VolumetricDataSource::compareLastUse(
+    BufferSlot* const& lhs, BufferSlot* const& rhs) {
+    ASSERT(lhs != nullptr);
+    ASSERT(rhs != nullptr);
+    if (lhs->LastUse < rhs->LastUse) {
+        return -1;
+    } else if (lhs->LastUse > rhs->LastUse) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+
 /*
  * megamol::stdplugin::volume::VolumetricDataSource::setUnlocker
  */
@@ -1275,7 +1355,7 @@ size_t megamol::stdplugin::volume::VolumetricDataSource::assertBuffersUnsafe(siz
     size_t retval = 0;
 
     if (cntFrames < 2) {
-        cntFrames = this->paramBuffers.Param<IntParam>()->Value();
+        cntFrames = this->calcBufferCount();
     }
     ASSERT(cntFrames >= 2);
 
@@ -1286,6 +1366,8 @@ size_t megamol::stdplugin::volume::VolumetricDataSource::assertBuffersUnsafe(siz
             for (size_t i = cntBuffers; i < cntFrames; ++i) {
                 auto bufferSlot = new BufferSlot();
                 bufferSlot->Buffer.AssertSize(frameSize);
+                bufferSlot->FrameID = static_cast<unsigned int>(-1);
+                bufferSlot->LastUse = 0;
                 bufferSlot->status = BUFFER_STATUS_UNUSED;
                 this->buffers.Add(bufferSlot);
             }
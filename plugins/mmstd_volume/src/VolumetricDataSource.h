@@ -83,6 +83,15 @@ protected:
      */
     size_t calcFrameSize(void) const;
 
+    /**
+     * Computes the number of buffers for loading frames, which is the
+     * number requested by 'paramBuffers' or the number of frames fitting
+     * into 'paramMemorySaturation', whichever is larger.
+     *
+     * @return The number of buffers to allocate.
+     */
+    size_t calcBufferCount(void) const;
+
     /**
      * Implementation of 'Create'.
      *
@@ -216,6 +225,8 @@ private:
     typedef struct BufferSlot_t {
         vislib::RawStorage Buffer;
         unsigned int FrameID;
+        /** The value of 'useCounter' when the buffer was last handed out. */
+        unsigned int LastUse;
         std::atomic_int status;
     } BufferSlot;
 
@@ -294,6 +305,11 @@ private:
     /** Executes the given loading call asynchronously. */
     static DWORD loadAsync(void* userData);
 
+    /**
+     * Orders buffers such that the least recently used one comes first.
+     */
+    static int compareLastUse(BufferSlot* const& lhs, BufferSlot* const& rhs);
+
     /**
      * Add an unlocker to 'call' that will eventually unlock 'buffer'.
      */
@@ -378,6 +394,19 @@ private:
     /** The path to the dat file. */
     core::param::ParamSlot paramFileName;
 
+    /**
+     * The level of the multi-resolution pyramid written by DatRawWriter
+     * that should be loaded instead of the file itself.
+     */
+    core::param::ParamSlot paramLevel;
+
+    /**
+     * The memory in MiB that the buffers for (pre-) loading frames may
+     * use. The least recently used frame is replaced once all buffers
+     * are in use.
+     */
+    core::param::ParamSlot paramMemorySaturation;
+
     /**
      * The number of bytes the data set should be converted to during
      * loading.
@@ -396,6 +425,9 @@ private:
     /** The slot that requests the data. */
     core::CalleeSlot slotGetData;
 
+    /** Counts the frames handed out, used to determine the least recently used buffer. */
+    unsigned int useCounter;
+
     std::vector<double> mins, maxes;
 
     template <class T>
@@ -15,6 +15,7 @@
 
 #include "BuckyBall.h"
 #include "DatRawWriter.h"
+#include "IsoSurfaceRenderer.h"
 #include "RaycastVolumeRenderer.h"
 #include "VolumeSliceRenderer.h"
 #include "VolumetricDataSource.h"
@@ -45,6 +46,7 @@ public:
         // register modules here:
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::BuckyBall>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::DatRawWriter>();
+        this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::IsoSurfaceRenderer>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::RaycastVolumeRenderer>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::VolumeSliceRenderer>();
         this->module_descriptions.RegisterAutoDescription<megamol::stdplugin::volume::VolumetricDataSource>();
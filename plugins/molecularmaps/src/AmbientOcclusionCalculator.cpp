@@ -10,9 +10,13 @@
 #include "vislib/math/AbstractPolynomImpl.h"
 #include "vislib/sys/Log.h"
 
+#include <algorithm>
 #include <array>
+#include <climits>
+#include <cstring>
 #include <omp.h>
 #include <fstream>
+#include <numeric>
 
 using namespace megamol;
 using namespace megamol::molecularmaps;
@@ -20,9 +24,14 @@ using namespace megamol::molecularmaps;
 /*
  * AmbientOcclusionCalculator::AmbientOcclusionCalculator
  */
-AmbientOcclusionCalculator::AmbientOcclusionCalculator(void) : aoSampleMax(0), colourSSBOHandle(0), dirTexture(0), lvlTexture(0), mdc(nullptr), normalSSBOHandle(0), 
-	resultVector(std::vector<float>(0)), shaderChanged(false), vertex_normals(nullptr), vertexSSBOHandle(0), vertices(nullptr), 
-	volTexture(0), volumeInitialized(false) {
+AmbientOcclusionCalculator::AmbientOcclusionCalculator(void) : aoSampleMax(0), colourSSBOHandle(0), dirTexture(0), dirtyBoxPending(false),
+	hitSSBOHandle(0), indexSSBOHandle(0), lastProteinDataHash(0), lastProteinFrameID(0), lvlTexture(0), mdc(nullptr), normalSSBOHandle(0),
+	progressSample(0), resultVector(std::vector<float>(0)), shaderChanged(false), shaderLoaded(false), vertex_normals(nullptr),
+	vertexSSBOHandle(0), vertices(nullptr), volTexture(0), volumeInitialized(false) {
+	for (int i = 0; i < 3; i++) {
+		this->dirtyBoxMin[i] = this->dirtyBoxMax[i] = 0.0f;
+		this->posOrigin[i] = this->posExtents[i] = 0.0f;
+	}
 }
 
 /*
@@ -43,6 +52,12 @@ AmbientOcclusionCalculator::~AmbientOcclusionCalculator(void) {
 	if (this->colourSSBOHandle != 0) {
 		glDeleteBuffers(1, &this->colourSSBOHandle);
 	}
+	if (this->hitSSBOHandle != 0) {
+		glDeleteBuffers(1, &this->hitSSBOHandle);
+	}
+	if (this->indexSSBOHandle != 0) {
+		glDeleteBuffers(1, &this->indexSSBOHandle);
+	}
 	if (this->normalSSBOHandle != 0) {
 		glDeleteBuffers(1, &this->normalSSBOHandle);
 	}
@@ -155,78 +170,7 @@ void AmbientOcclusionCalculator::calcLevels(float aoWidthX, float aoWidthY, floa
  * AmbientOcclusionCalculator::calculateVertexShadows
  */
 const std::vector<float> * AmbientOcclusionCalculator::calculateVertexShadows(AmbientOcclusionCalculator::AOSettings settings) {
-	if (this->vertices == nullptr) return nullptr;
-	if (this->vertex_normals == nullptr) return false;
-	if (this->mdc == nullptr) return nullptr;
-
-	// allocate enough space for the result
-	if (this->settings.isDirty(settings) || this->resultVector.size() == 0 || this->shaderChanged) {
-		size_t size = (this->vertices->size() / 3) * 4;
-		this->resultVector.resize(size, 0.0f);
-		this->resultVector.shrink_to_fit();
-	
-		this->resizeVolume(settings);
-		this->settings = settings;
-
-		this->createEmptyVolume(settings);
-		this->createVolumeCPU(settings);
-
-		this->uploadVertexData();
-		this->calcDirections();
-		
-		auto bb = mdc->AccessBoundingBoxes().ObjectSpaceClipBox();
-		float minOSx = bb.Left();
-		float minOSy = bb.Bottom();
-		float minOSz = bb.Back();
-		float rangeOSx = bb.Width();
-		float rangeOSy = bb.Height();
-		float rangeOSz = bb.Depth();
-		float aoWidthX = rangeOSx / static_cast<float>(this->settings.volSizeX);
-		float aoWidthY = rangeOSy / static_cast<float>(this->settings.volSizeY);
-		float aoWidthZ = rangeOSz / static_cast<float>(this->settings.volSizeZ);
-		rangeOSx /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeX));
-		rangeOSy /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeY));
-		rangeOSz /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeZ));
-		minOSx -= rangeOSx / static_cast<float>(this->settings.volSizeX);
-		minOSy -= rangeOSy / static_cast<float>(this->settings.volSizeY);
-		minOSz -= rangeOSz / static_cast<float>(this->settings.volSizeZ);
-
-		float diag = (bb.GetRightTopFront() - bb.GetLeftBottomBack()).Length();
-		this->calcLevels(aoWidthX, aoWidthY, aoWidthZ, diag);
-
-		int n = static_cast<int>(this->vertices->size() / 3);
-
-		this->aoComputeShader.Enable();
-		this->aoComputeShader.SetParameter("aoSampFact", this->settings.evalFactor);
-		this->aoComputeShader.SetParameter("vertexCount", n);
-		this->aoComputeShader.SetParameter("sampleNum", this->settings.numSampleDirections);
-		this->aoComputeShader.SetParameter("sampleMax", this->aoSampleMax);
-		this->aoComputeShader.SetParameter("posOrigin", minOSx, minOSy, minOSz);
-		this->aoComputeShader.SetParameter("posExtents", rangeOSx, rangeOSy, rangeOSz);
-
-		glActiveTexture(GL_TEXTURE5);
-		glBindTexture(GL_TEXTURE_1D, this->dirTexture);
-		this->aoComputeShader.SetParameter("directionTex", 5);
-
-		glActiveTexture(GL_TEXTURE6);
-		glBindTexture(GL_TEXTURE_1D, this->lvlTexture);
-		this->aoComputeShader.SetParameter("levelTex", 6);
-
-		glActiveTexture(GL_TEXTURE7);
-		glBindTexture(GL_TEXTURE_3D, this->volTexture);
-		this->aoComputeShader.SetParameter("aoVol", 7);
-
-		glDispatchCompute((n / 512) + 1, 1, 1);
-		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-		this->aoComputeShader.Disable();
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_3D, 0);
-
-		this->readColourData();
-		this->shaderChanged = false;
-	}
-	return &this->resultVector;
+	return this->progressVertexShadows(settings, 0);
 }
 
 /*
@@ -236,27 +180,10 @@ void AmbientOcclusionCalculator::clearStoredShadowData(void) {
 	this->resultVector.clear();
 }
 
-/*
- * AmbientOcclusionCalculator::createEmptyVolume
- */
-void AmbientOcclusionCalculator::createEmptyVolume(AmbientOcclusionCalculator::AOSettings settings) {
-	if (this->volTexture == 0) return;
-	std::vector<float> vol(settings.volSizeX * settings.volSizeY * settings.volSizeZ, 0.0f);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_3D, this->volTexture);
-	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, settings.volSizeX, settings.volSizeY, settings.volSizeZ, GL_RED, GL_FLOAT, vol.data());
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
-	std::array<float, 4> borderColour = { 0.0f, 0.0f, 0.0f, 0.0f };
-	glTexParameterfv(GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, borderColour.data());
-	glBindTexture(GL_TEXTURE_3D, 0);
-}
-
 /*
  * AmbientOcclusionCalculator::createVolumeCPU
  */
-void AmbientOcclusionCalculator::createVolumeCPU(AmbientOcclusionCalculator::AOSettings settings) {
+bool AmbientOcclusionCalculator::createVolumeCPU(AmbientOcclusionCalculator::AOSettings settings, int changedMin[3], int changedMax[3]) {
 	unsigned int sx = settings.volSizeX;
 	unsigned int sy = settings.volSizeY;
 	unsigned int sz = settings.volSizeZ;
@@ -308,13 +235,144 @@ void AmbientOcclusionCalculator::createVolumeCPU(AmbientOcclusionCalculator::AOS
 	file.close();
 #endif /* DEBUG_WRITE */
 
+	// find the voxels which changed since the last upload
+	for (int i = 0; i < 3; i++) {
+		changedMin[i] = INT_MAX;
+		changedMax[i] = -1;
+	}
+	if (this->occluderVolume.size() != vol[0].size()) {
+		changedMin[0] = changedMin[1] = changedMin[2] = 0;
+		changedMax[0] = static_cast<int>(sx) - 1;
+		changedMax[1] = static_cast<int>(sy) - 1;
+		changedMax[2] = static_cast<int>(sz) - 1;
+	} else {
+#pragma omp parallel
+		{
+			int lmin[3] = { INT_MAX, INT_MAX, INT_MAX };
+			int lmax[3] = { -1, -1, -1 };
+#pragma omp for
+			for (int z = 0; z < static_cast<int>(sz); z++) {
+				for (unsigned int y = 0; y < sy; y++) {
+					for (unsigned int x = 0; x < sx; x++) {
+						size_t idx = x + (y + z * sy) * sx;
+						if (vol[0][idx] != this->occluderVolume[idx]) {
+							lmin[0] = std::min(lmin[0], static_cast<int>(x));
+							lmin[1] = std::min(lmin[1], static_cast<int>(y));
+							lmin[2] = std::min(lmin[2], z);
+							lmax[0] = std::max(lmax[0], static_cast<int>(x));
+							lmax[1] = std::max(lmax[1], static_cast<int>(y));
+							lmax[2] = std::max(lmax[2], z);
+						}
+					}
+				}
+			}
+#pragma omp critical
+			{
+				for (int i = 0; i < 3; i++) {
+					changedMin[i] = std::min(changedMin[i], lmin[i]);
+					changedMax[i] = std::max(changedMax[i], lmax[i]);
+				}
+			}
+		}
+	}
+	if (changedMax[0] < 0) return false;
+
+	// upload only the box around the changed voxels
 	glActiveTexture(GL_TEXTURE7);
 	glBindTexture(GL_TEXTURE_3D, this->volTexture);
-	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, sx, sy, sz, GL_RED, GL_FLOAT, vol[0].data());
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, sx);
+	glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, sy);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, changedMin[0]);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, changedMin[1]);
+	glPixelStorei(GL_UNPACK_SKIP_IMAGES, changedMin[2]);
+	glTexSubImage3D(GL_TEXTURE_3D, 0, changedMin[0], changedMin[1], changedMin[2], changedMax[0] - changedMin[0] + 1,
+		changedMax[1] - changedMin[1] + 1, changedMax[2] - changedMin[2] + 1, GL_RED, GL_FLOAT, vol[0].data());
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
 	glGenerateMipmap(GL_TEXTURE_3D);
 	glTexParameteri(GL_TEXTURE_3D, GL_GENERATE_MIPMAP, GL_TRUE);
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
 	glBindTexture(GL_TEXTURE_3D, 0);
+
+	this->occluderVolume.swap(vol[0]);
+	return true;
+}
+
+/*
+ * AmbientOcclusionCalculator::dispatchPending
+ */
+void AmbientOcclusionCalculator::dispatchPending(int numDirections) {
+	if (!this->dirtyBoxPending && this->pendingVertices.empty()) return;
+
+	const int total = this->settings.numSampleDirections;
+	const int n = static_cast<int>(this->vertices->size() / 3);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->vertexSSBOHandle);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->normalSSBOHandle);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->colourSSBOHandle);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, this->indexSSBOHandle);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, this->hitSSBOHandle);
+
+	this->aoComputeShader.Enable();
+	this->aoComputeShader.SetParameter("aoSampFact", this->settings.evalFactor);
+	this->aoComputeShader.SetParameter("sampleNum", total);
+	this->aoComputeShader.SetParameter("sampleMax", this->aoSampleMax);
+	this->aoComputeShader.SetParameter("posOrigin", this->posOrigin[0], this->posOrigin[1], this->posOrigin[2]);
+	this->aoComputeShader.SetParameter("posExtents", this->posExtents[0], this->posExtents[1], this->posExtents[2]);
+
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_1D, this->dirTexture);
+	this->aoComputeShader.SetParameter("directionTex", 5);
+
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_1D, this->lvlTexture);
+	this->aoComputeShader.SetParameter("levelTex", 6);
+
+	glActiveTexture(GL_TEXTURE7);
+	glBindTexture(GL_TEXTURE_3D, this->volTexture);
+	this->aoComputeShader.SetParameter("aoVol", 7);
+
+	if (this->dirtyBoxPending) {
+		// all sample directions of the vertices with a ray crossing the changed voxels
+		this->aoComputeShader.SetParameter("vertexCount", n);
+		this->aoComputeShader.SetParameter("useIndices", 0);
+		this->aoComputeShader.SetParameter("testBox", 1);
+		this->aoComputeShader.SetParameter("boxMin", this->dirtyBoxMin[0], this->dirtyBoxMin[1], this->dirtyBoxMin[2]);
+		this->aoComputeShader.SetParameter("boxMax", this->dirtyBoxMax[0], this->dirtyBoxMax[1], this->dirtyBoxMax[2]);
+		this->aoComputeShader.SetParameter("sampleBegin", 0);
+		this->aoComputeShader.SetParameter("sampleEnd", total);
+		glDispatchCompute((n / 512) + 1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		this->dirtyBoxPending = false;
+	}
+
+	if (!this->pendingVertices.empty()) {
+		// the next sample directions of the pending vertices
+		int end = (numDirections > 0) ? std::min(total, this->progressSample + numDirections) : total;
+		int cnt = static_cast<int>(this->pendingVertices.size());
+		this->aoComputeShader.SetParameter("vertexCount", cnt);
+		this->aoComputeShader.SetParameter("useIndices", 1);
+		this->aoComputeShader.SetParameter("testBox", 0);
+		this->aoComputeShader.SetParameter("sampleBegin", this->progressSample);
+		this->aoComputeShader.SetParameter("sampleEnd", end);
+		glDispatchCompute((cnt / 512) + 1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		this->progressSample = end;
+		if (end >= total) {
+			this->pendingVertices.clear();
+			this->progressSample = 0;
+		}
+	}
+
+	this->aoComputeShader.Disable();
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_3D, 0);
+
+	this->readColourData();
 }
 
 /*
@@ -337,34 +395,21 @@ bool AmbientOcclusionCalculator::initilialize(core::CoreInstance * instance, con
 	this->vertex_normals = vertex_normals;
 	this->mdc = mdc;
 
-	// generate volume texture
-	if (this->volTexture != 0) {
-		glDeleteTextures(1, &this->volTexture);
-		this->volTexture = 0;
+	// the GPU resources are kept, such that only changes have to be recomputed
+	if (this->volTexture == 0) {
+		glGenTextures(1, &this->volTexture);
+		this->volumeInitialized = false;
 	}
-	glGenTextures(1, &this->volTexture);
 
-	if (!this->loadShaders(instance)) return false;
+	if (!this->shaderLoaded && !this->loadShaders(instance)) return false;
 
 	// create SSBOs
-	if (this->colourSSBOHandle != 0) {
-		glDeleteBuffers(1, &this->colourSSBOHandle);
-		this->colourSSBOHandle = 0;
-	}
-	glGenBuffers(1, &this->colourSSBOHandle);
+	if (this->colourSSBOHandle == 0) glGenBuffers(1, &this->colourSSBOHandle);
+	if (this->hitSSBOHandle == 0) glGenBuffers(1, &this->hitSSBOHandle);
+	if (this->indexSSBOHandle == 0) glGenBuffers(1, &this->indexSSBOHandle);
+	if (this->normalSSBOHandle == 0) glGenBuffers(1, &this->normalSSBOHandle);
+	if (this->vertexSSBOHandle == 0) glGenBuffers(1, &this->vertexSSBOHandle);
 
-	if (this->normalSSBOHandle != 0) {
-		glDeleteBuffers(1, &this->normalSSBOHandle);
-		this->normalSSBOHandle = 0;
-	}
-	glGenBuffers(1, &this->normalSSBOHandle);
-
-	if (this->vertexSSBOHandle != 0) {
-		glDeleteBuffers(1, &this->vertexSSBOHandle);
-		this->vertexSSBOHandle = 0;
-	}
-	glGenBuffers(1, &this->vertexSSBOHandle);
-	
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->vertexSSBOHandle);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->normalSSBOHandle);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->colourSSBOHandle);
@@ -408,9 +453,169 @@ bool AmbientOcclusionCalculator::loadShaders(core::CoreInstance * instance) {
 		return false;
 	}
 	this->shaderChanged = true;
+	this->shaderLoaded = true;
 	return true;
 }
 
+/*
+ * AmbientOcclusionCalculator::isConverged
+ */
+bool AmbientOcclusionCalculator::isConverged(void) const {
+	return !this->resultVector.empty() && this->pendingVertices.empty() && !this->dirtyBoxPending;
+}
+
+/*
+ * AmbientOcclusionCalculator::prepare
+ */
+bool AmbientOcclusionCalculator::prepare(const AmbientOcclusionCalculator::AOSettings& settings) {
+	if (this->vertices == nullptr) return false;
+	if (this->vertex_normals == nullptr) return false;
+	if (this->mdc == nullptr) return false;
+	const size_t n = this->vertices->size() / 3;
+	if (n == 0 || this->vertex_normals->size() < n * 3) return false;
+
+	// changed sampling parameters or shaders invalidate all vertices
+	bool allDirty = this->settings.isDirty(settings) || this->resultVector.size() != n * 4 || this->shaderChanged
+		|| !this->volumeInitialized;
+
+	bool volumeResized = !this->volumeInitialized || this->settings.isVolumeDirty(settings);
+	if (volumeResized) {
+		this->resizeVolume(settings);
+		this->occluderVolume.clear();
+		this->volumeInitialized = true;
+	}
+	this->settings = settings;
+
+	auto bb = mdc->AccessBoundingBoxes().ObjectSpaceClipBox();
+	float rangeOSx = bb.Width();
+	float rangeOSy = bb.Height();
+	float rangeOSz = bb.Depth();
+	float aoWidthX = rangeOSx / static_cast<float>(this->settings.volSizeX);
+	float aoWidthY = rangeOSy / static_cast<float>(this->settings.volSizeY);
+	float aoWidthZ = rangeOSz / static_cast<float>(this->settings.volSizeZ);
+	rangeOSx /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeX));
+	rangeOSy /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeY));
+	rangeOSz /= (1.0f - 2.0f / static_cast<float>(this->settings.volSizeZ));
+	float origin[3] = { bb.Left() - rangeOSx / static_cast<float>(this->settings.volSizeX),
+		bb.Bottom() - rangeOSy / static_cast<float>(this->settings.volSizeY),
+		bb.Back() - rangeOSz / static_cast<float>(this->settings.volSizeZ) };
+	float extents[3] = { rangeOSx, rangeOSy, rangeOSz };
+	for (int i = 0; i < 3; i++) {
+		if (origin[i] != this->posOrigin[i] || extents[i] != this->posExtents[i]) allDirty = true;
+		this->posOrigin[i] = origin[i];
+		this->posExtents[i] = extents[i];
+	}
+
+	// rebuild the occluder volume only for new molecular data
+	int changedMin[3], changedMax[3];
+	bool voxelsChanged = false;
+	if (this->occluderVolume.empty() || this->mdc->DataHash() == 0 || this->mdc->DataHash() != this->lastProteinDataHash
+			|| this->mdc->FrameID() != this->lastProteinFrameID) {
+		voxelsChanged = this->createVolumeCPU(settings, changedMin, changedMax);
+		this->lastProteinDataHash = this->mdc->DataHash();
+		this->lastProteinFrameID = this->mdc->FrameID();
+	}
+
+	if (allDirty) {
+		this->calcDirections();
+		float diag = (bb.GetRightTopFront() - bb.GetLeftBottomBack()).Length();
+		this->calcLevels(aoWidthX, aoWidthY, aoWidthZ, diag);
+	}
+
+	// find the vertices which moved
+	std::vector<unsigned int> changedVertices;
+	if (this->lastVertices.size() != this->vertices->size() || this->lastNormals.size() != this->vertex_normals->size()) {
+		allDirty = true;
+		this->uploadVertexData();
+	} else if (!allDirty) {
+		const float *v = this->vertices->data();
+		const float *nv = this->vertex_normals->data();
+		const float *lv = this->lastVertices.data();
+		const float *ln = this->lastNormals.data();
+		std::vector<std::vector<unsigned int>> local(omp_get_max_threads());
+#pragma omp parallel for
+		for (int i = 0; i < static_cast<int>(n); i++) {
+			if (std::memcmp(v + 3 * i, lv + 3 * i, 3 * sizeof(float)) != 0
+					|| std::memcmp(nv + 3 * i, ln + 3 * i, 3 * sizeof(float)) != 0) {
+				local[omp_get_thread_num()].push_back(static_cast<unsigned int>(i));
+			}
+		}
+		for (const auto& l : local) {
+			changedVertices.insert(changedVertices.end(), l.begin(), l.end());
+		}
+	} else {
+		this->uploadVertexData();
+	}
+	if (!changedVertices.empty()) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->vertexSSBOHandle);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, this->vertices->size() * sizeof(float), this->vertices->data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->normalSSBOHandle);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, this->vertex_normals->size() * sizeof(float), this->vertex_normals->data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	this->lastVertices = *this->vertices;
+	this->lastNormals = *this->vertex_normals;
+	if (this->resultVector.size() != n * 4) {
+		this->resultVector.assign(n * 4, 0.0f);
+		this->resultVector.shrink_to_fit();
+	}
+
+	// determine what has to be recomputed
+	bool pendingChanged = false;
+	bool inProgress = !this->pendingVertices.empty() && this->progressSample > 0;
+	if (allDirty || (voxelsChanged && inProgress)) {
+		this->pendingVertices.resize(n);
+		std::iota(this->pendingVertices.begin(), this->pendingVertices.end(), 0u);
+		this->progressSample = 0;
+		this->dirtyBoxPending = false;
+		pendingChanged = true;
+	} else {
+		if (voxelsChanged) {
+			// voxels influence the samples interpolated around them
+			float boxMin[3], boxMax[3];
+			const unsigned int size[3] = { this->settings.volSizeX, this->settings.volSizeY, this->settings.volSizeZ };
+			for (int i = 0; i < 3; i++) {
+				boxMin[i] = this->posOrigin[i] + this->posExtents[i] * static_cast<float>(changedMin[i] - 1) / static_cast<float>(size[i]);
+				boxMax[i] = this->posOrigin[i] + this->posExtents[i] * static_cast<float>(changedMax[i] + 2) / static_cast<float>(size[i]);
+				if (this->dirtyBoxPending) {
+					boxMin[i] = std::min(boxMin[i], this->dirtyBoxMin[i]);
+					boxMax[i] = std::max(boxMax[i], this->dirtyBoxMax[i]);
+				}
+				this->dirtyBoxMin[i] = boxMin[i];
+				this->dirtyBoxMax[i] = boxMax[i];
+			}
+			this->dirtyBoxPending = true;
+		}
+		if (!changedVertices.empty()) {
+			this->pendingVertices.insert(this->pendingVertices.end(), changedVertices.begin(), changedVertices.end());
+			std::sort(this->pendingVertices.begin(), this->pendingVertices.end());
+			this->pendingVertices.erase(std::unique(this->pendingVertices.begin(), this->pendingVertices.end()),
+				this->pendingVertices.end());
+			this->progressSample = 0;
+			pendingChanged = true;
+		}
+	}
+	if (pendingChanged) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->indexSSBOHandle);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, this->pendingVertices.size() * sizeof(unsigned int),
+			this->pendingVertices.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	this->shaderChanged = false;
+	return true;
+}
+
+/*
+ * AmbientOcclusionCalculator::progressVertexShadows
+ */
+const std::vector<float> * AmbientOcclusionCalculator::progressVertexShadows(AmbientOcclusionCalculator::AOSettings settings,
+		int numDirections) {
+	if (!this->prepare(settings)) return nullptr;
+	this->dispatchPending(numDirections);
+	return &this->resultVector;
+}
+
 /*
  * AmbientOcclusionCalculator::readColourData
  */
@@ -452,4 +657,6 @@ void AmbientOcclusionCalculator::uploadVertexData(void) {
 	size_t n = (this->vertices->size() / 3) * 4;
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->colourSSBOHandle);
 	glBufferData(GL_SHADER_STORAGE_BUFFER, n * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, this->hitSSBOHandle);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (n / 4) * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
 }
\ No newline at end of file
@@ -19,6 +19,10 @@ namespace molecularmaps {
 
 	/**
 	 * Class computing ambient occlusion factors per vertex for a given mesh
+	 *
+	 * The occluder volume is only rebuilt if the molecule or the volume settings change, and after
+	 * changes only the vertices which moved or whose sample rays cross changed voxels are
+	 * recomputed. The sample directions can also be evaluated progressively over several calls.
 	 */
 	class AmbientOcclusionCalculator {
 	public:
@@ -80,7 +84,7 @@ namespace molecularmaps {
 			 * @param aos The other struct
 			 * @return True if the both structs are different from each other, false otherwise
 			 */
-			bool isDirty(const AOSettings& aos) {
+			bool isDirty(const AOSettings& aos) const {
 				if (std::abs(this->angleFactor - aos.angleFactor) > FLT_EPSILON) return true;
 				if (std::abs(this->evalFactor - aos.evalFactor) > FLT_EPSILON) return true;
 				if (std::abs(this->falloffFactor - aos.falloffFactor) > FLT_EPSILON) return true;
@@ -94,6 +98,20 @@ namespace molecularmaps {
 				if (this->volSizeZ != aos.volSizeZ) return true;
 				return false;
 			}
+
+			/**
+			 * Computes whether the occluder volume differs for this struct and another given one
+			 *
+			 * @param aos The other struct
+			 * @return True if the volumes differ, false otherwise
+			 */
+			bool isVolumeDirty(const AOSettings& aos) const {
+				if (std::abs(this->genFac - aos.genFac) > FLT_EPSILON) return true;
+				if (this->volSizeX != aos.volSizeX) return true;
+				if (this->volSizeY != aos.volSizeY) return true;
+				if (this->volSizeZ != aos.volSizeZ) return true;
+				return false;
+			}
 		};
 
 		/**
@@ -115,6 +133,24 @@ namespace molecularmaps {
 		 */
 		const std::vector<float> * calculateVertexShadows(AOSettings settings);
 
+		/**
+		 * Answers whether the stored vertex shadow data covers all sample directions of all
+		 * vertices.
+		 *
+		 * @return True if the stored data is complete, false otherwise.
+		 */
+		bool isConverged(void) const;
+
+		/**
+		 * Advances the computation of the brightness values by the given number of sample
+		 * directions. Vertices which did not change keep their values.
+		 *
+		 * @param settings struct containing all settings for the ambient occlusion
+		 * @param numDirections The number of sample directions to evaluate, all if not positive
+		 * @return Pointer to the vector containing the current, possibly partial, brightness values. If the method was not successful, it returns a nullptr.
+		 */
+		const std::vector<float> * progressVertexShadows(AOSettings settings, int numDirections);
+
 		/**
 		 * Tells the module to erase the stored vertex shadow data.
 		 */
@@ -165,18 +201,32 @@ namespace molecularmaps {
 		void calcLevels(float aoWidthX, float aoWidthY, float aoWidthZ, float diag);
 
 		/**
-		 * Creates an empty volume on the GPU
+		 * Creates the Shadow volume on the CPU and uploads the voxels which changed since the
+		 * last upload on the GPU.
 		 *
 		 * @param settings The settings struct containing the necessary measurements
+		 * @param changedMin Receives the smallest voxel index which changed
+		 * @param changedMax Receives the largest voxel index which changed
+		 * @return True if any voxel changed, false otherwise
 		 */
-		void createEmptyVolume(AOSettings settings);
+		bool createVolumeCPU(AOSettings settings, int changedMin[3], int changedMax[3]);
 
 		/**
-		 * Creates the Shadow volume on the CPU and uploads it on the GPU
+		 * Evaluates the given number of sample directions of the pending vertices and, if
+		 * requested, recomputes the vertices affected by changed voxels.
+		 *
+		 * @param numDirections The number of sample directions to evaluate, all if not positive
+		 */
+		void dispatchPending(int numDirections);
+
+		/**
+		 * Brings the volume, the sampling textures and the vertex data up to date with the given
+		 * settings and determines the vertices to recompute.
 		 *
 		 * @param settings The settings struct containing the necessary measurements
+		 * @return True on success, false if input data is missing.
 		 */
-		void createVolumeCPU(AOSettings settings);
+		bool prepare(const AOSettings& settings);
 
 		/**
 		 * Reads the colour data from the SSBO and writes the result into the resultVector
@@ -207,12 +257,33 @@ namespace molecularmaps {
 		/** Handle for the direction texture */
 		GLuint dirTexture;
 
+		/** Flag whether the vertices affected by the changed voxels have to be recomputed */
+		bool dirtyBoxPending;
+
+		/** The object space box around the changed voxels */
+		float dirtyBoxMin[3], dirtyBoxMax[3];
+
+		/** Handle for the SSBO containing the accumulated sample hits per vertex */
+		GLuint hitSSBOHandle;
+
+		/** Handle for the SSBO containing the indices of the pending vertices */
+		GLuint indexSSBOHandle;
+
 		/** Dirty flag for the internal data */
 		bool isDirty;
 
 		/** The hash of the most recently used protein data */
 		SIZE_T lastProteinDataHash;
 
+		/** The frame of the most recently used protein data */
+		unsigned int lastProteinFrameID;
+
+		/** The vertex normals of the most recent computation */
+		std::vector<float> lastNormals;
+
+		/** The vertex positions of the most recent computation */
+		std::vector<float> lastVertices;
+
 		/** Handle for the level texture */
 		GLuint lvlTexture;
 
@@ -222,6 +293,18 @@ namespace molecularmaps {
 		/** Handle for the SSBO containing the protein atom position data */
 		GLuint normalSSBOHandle;
 
+		/** The occluder volume as uploaded to the GPU */
+		std::vector<float> occluderVolume;
+
+		/** The indices of the vertices which still have to be computed */
+		std::vector<unsigned int> pendingVertices;
+
+		/** The origin and extents of the volume as sampled by the shader */
+		float posOrigin[3], posExtents[3];
+
+		/** The first sample direction not yet evaluated for the pending vertices */
+		int progressSample;
+
 		/** Resulting vector storing one brightness float value per vertex */
 		std::vector<float> resultVector;
 
@@ -231,6 +314,9 @@ namespace molecularmaps {
 		/** Flag indicating whether the shaders have changed */
 		bool shaderChanged;
 
+		/** Flag indicating whether the shaders have been loaded */
+		bool shaderLoaded;
+
 		/** Pointer to the vector containing the vertex positions */
 		const std::vector<float> * vertex_normals;
 
@@ -37,6 +37,7 @@ MapGenerator::MapGenerator(void) : Renderer3DModule(),
 		aoMaxDistSample("ambientOcclusion::maxDistance", "The maximum distance between the surface and the last sample"),
 		aoMinDistSample("ambientOcclusion::minDistance", "The distance between the surface and the first sample"),
 		aoNumSampleDirectionsParam("ambientOcclusion::numSampleDirections", "The number of sample directions per vertex"),
+		aoProgressiveDirectionsParam("ambientOcclusion::directionsPerFrame", "The number of sample directions added per frame in the shadow display mode (0 = all at once)"),
 		aoScalingFactorParam("ambientOcclusion::scaling", "Scaling factor for the particle radii"),
 		aoThresholdParam("ambientOcclusion::threshold", "Set the thresholding factor for the shadow test."),
 		aoVolSizeXParam("ambientOcclusion::volSizeX", "Size of the shadow volume in x-direction (in voxels)"),
@@ -98,6 +99,9 @@ MapGenerator::MapGenerator(void) : Renderer3DModule(),
 	this->aoNumSampleDirectionsParam.SetParameter(new param::IntParam(8, 1, 200));
 	this->MakeSlotAvailable(&this->aoNumSampleDirectionsParam);
 
+	this->aoProgressiveDirectionsParam.SetParameter(new param::IntParam(0, 0));
+	this->MakeSlotAvailable(&this->aoProgressiveDirectionsParam);
+
 	this->aoScalingFactorParam.SetParameter(new param::FloatParam(1.0f, 0.0f));
 	this->MakeSlotAvailable(&this->aoScalingFactorParam);
 
@@ -3726,7 +3730,7 @@ bool MapGenerator::Render(Call& call) {
 				// Check if we want to use AO (default is false, i.e. we do not want to use AO).
 				uint tunnel_id = 0;
 				if (this->aoActive.Param<param::BoolParam>()->Value()) {
-					this->aoCalculator.clearStoredShadowData();
+					// The calculator only recomputes the vertices affected by changes since the last call.
 					AmbientOcclusionCalculator::AOSettings settings;
 					settings.angleFactor = this->aoAngleFactorParam.Param<param::FloatParam>()->Value();
 					settings.evalFactor = this->aoEvalParam.Param<param::FloatParam>()->Value();
@@ -4064,10 +4068,10 @@ bool MapGenerator::Render(Call& call) {
             this->triMeshRenderer.update(&this->faces, &this->vertices, &this->vertexColors, &this->normals);
         }
 	} else if (this->display_param.Param<param::EnumParam>()->Value() == DisplayMode::SHADOW) {
-		// Get the AO texture.
+		// Get the AO texture and refine it if it is computed progressively.
 		auto vector = this->aoCalculator.getVertexShadows();
-		if (vector == nullptr) {
-			// Texture is empty create one.
+		int directionsPerFrame = this->aoProgressiveDirectionsParam.Param<param::IntParam>()->Value();
+		if (vector == nullptr || (directionsPerFrame > 0 && !this->aoCalculator.isConverged())) {
 			this->aoCalculator.initilialize(this->GetCoreInstance(), &this->vertices, &this->normals, mdc);
 			AmbientOcclusionCalculator::AOSettings settings;
 			settings.angleFactor = this->aoAngleFactorParam.Param<param::FloatParam>()->Value();
@@ -4081,16 +4085,12 @@ bool MapGenerator::Render(Call& call) {
 			settings.volSizeX = this->aoVolSizeXParam.Param<param::IntParam>()->Value();
 			settings.volSizeY = this->aoVolSizeYParam.Param<param::IntParam>()->Value();
 			settings.volSizeZ = this->aoVolSizeZParam.Param<param::IntParam>()->Value();
-			vector = this->aoCalculator.calculateVertexShadows(settings);
-			if (vector == nullptr) {
-				// The computation did not work so set the render to nullptr so nothing is rendered.
-				this->triMeshRenderer.update(nullptr, nullptr, nullptr, nullptr);
+			vector = this->aoCalculator.progressVertexShadows(settings, directionsPerFrame);
+		}
 
-			} else {
-				// We have something to show.
-				this->triMeshRenderer.update(&this->faces, &this->vertices, vector, &this->normals, 4);
-				lighting = false;
-			}
+		if (vector == nullptr) {
+			// The computation did not work so set the render to nullptr so nothing is rendered.
+			this->triMeshRenderer.update(nullptr, nullptr, nullptr, nullptr);
 
 		} else {
 			// We have something to show.
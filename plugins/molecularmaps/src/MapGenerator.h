@@ -640,6 +640,9 @@ namespace molecularmaps {
 		/** The param slot for the number of sample direction of the ambient occlusion */
 		core::param::ParamSlot aoNumSampleDirectionsParam;
 
+		/** The param slot for the number of sample directions added per frame to the shadow display */
+		core::param::ParamSlot aoProgressiveDirectionsParam;
+
 		/** The sphere radius scaling param slot for the ambient occlusion */
 		core::param::ParamSlot aoScalingFactorParam;
 
@@ -372,122 +372,97 @@ bool VoronoiChannelCalculator::constructVoronoiDiagram(MolecularDataCall* mdc) {
 	return true;
 }
 
+/*
+ * VoronoiChannelCalculator::fetchGates
+ */
+bool VoronoiChannelCalculator::fetchGates(std::vector<std::pair<vec4d, std::array<uint, 5>>>& batch) {
+	std::lock_guard<std::mutex> lock(this->voronoi_mutex);
+	auto& queue = (this->active_gates == 0) ? this->gatesToTest_one : this->gatesToTest_two;
+
+	// Take a share of the queue that keeps all threads busy until it is drained.
+	size_t share = queue.size() / (4 * std::max(static_cast<size_t>(1), this->voronoi_threads.size()));
+	size_t cnt = std::min(queue.size(), std::min(static_cast<size_t>(64), std::max(static_cast<size_t>(1), share)));
+	batch.assign(queue.end() - cnt, queue.end());
+	queue.resize(queue.size() - cnt);
+	return cnt > 0;
+}
+
 /*
  * VoronoiChannelCalculator::nextVoronoiVertex
  */
 void VoronoiChannelCalculator::nextVoronoiVertex() {
 	std::array<vec3d, 2> circles{ vec3d(), vec3d() };
-	std::pair<vec4d, std::array<uint, 5>> gate;
+	std::vector<std::pair<vec4d, std::array<uint, 5>>> batch;
 	std::array<vec4d, 2> gateCenter{ vec4d(), vec4d() };
 	std::array<vec4d, 2> incircle{ vec4d(), vec4d() };
-	std::array<vec4d, 2> sphereVec{ vec4d(), vec4d() };
-	bool stop = false;
-	while (!stop) {
-		// Get the gate and remove it from the queue.
-		this->voronoi_mutex.lock();
-		if (this->active_gates == 0) {
-			// If the thread waited so long that the active queue is now empty we can stop it.
-			if (this->gatesToTest_one.empty()) {
-				this->voronoi_mutex.unlock();
-				break;
-			}
-
-			// Get the last element from the queue and process it.
-			gate = this->gatesToTest_one.back();
-			this->gatesToTest_one.pop_back();
-
-		} else {
-			// If the thread waited so long that the active queue is now empty we can stop it.
-			if (this->gatesToTest_two.empty()) {
-				this->voronoi_mutex.unlock();
-				break;
-			}
-
-			// Get the last element from the queue and process it.
-			gate = this->gatesToTest_two.back();
-			this->gatesToTest_two.pop_back();
+	std::vector<std::pair<int, vec4d>> results;
+	while (this->fetchGates(batch)) {
+		// Compute the end vertices of all gates of the batch. This only reads the search grid, so no lock is needed.
+		results.resize(batch.size());
+		for (size_t i = 0; i < batch.size(); i++) {
+			const auto& gate = batch[i];
+
+			// Create the vector that contains all three gate spheres.
+			std::array<vec4d, 4> gateVector{
+				this->searchGrid.GetAtoms()[gate.second[0]],
+				this->searchGrid.GetAtoms()[gate.second[1]],
+				this->searchGrid.GetAtoms()[gate.second[2]],
+				vec4d()
+			};
+
+			// Get the gate centers, we only need the first one, i.e. the one with the smaller radius.
+			Computations::ComputeGateCenter(gateVector, gateCenter, incircle, circles);
+
+			// Compute the pivot point of the current gate.
+			vec3d pivot = Computations::ComputePivot(gateVector);
+
+			// Compute the next voronoi vertex.
+			EndVertexParams params = EndVertexParams(gate, gateCenter, gateVector, pivot);
+			results[i].first = this->searchGrid.GetEndVertex(params, results[i].second);
 		}
-		this->voronoi_mutex.unlock();
-
-		// Create the vector that contains all three gate spheres.
-		std::array<vec4d, 4> gateVector{
-			this->searchGrid.GetAtoms()[gate.second[0]],
-			this->searchGrid.GetAtoms()[gate.second[1]],
-			this->searchGrid.GetAtoms()[gate.second[2]],
-			vec4d()
-		};
-
-		// Get the gate centers, we only need the first one, i.e. the one with the smaller radius.
-		auto gateCenter_cnt = Computations::ComputeGateCenter(gateVector, gateCenter, incircle, circles);
-
-		// Compute the pivot point of the current gate.
-		vec3d pivot = Computations::ComputePivot(gateVector);
 
-		// Compute the next voronoi vertex.
-		EndVertexParams params = EndVertexParams(gate, gateCenter, gateVector, pivot);
-		vec4d edgeEndResult;
-		int minIdx = this->searchGrid.GetEndVertex(params, edgeEndResult);
-
-		// Did we find a result for the currently processed gate?
-		if (minIdx >= 0) {
-			// Create the new Voronoi vertex and check if it already exists.
-			this->voronoi_mutex.lock();
-			VoronoiVertex possible_vertex = VoronoiVertex(vec4ui(gate.second[0], gate.second[1], gate.second[2], minIdx), 0);
-			auto it = this->voronoi_vertices.find(possible_vertex.vertex_hash);
-			if (it == this->voronoi_vertices.end()) {
-				// The vertex is new so add it to the list and create the edge between the vertex we came from and the
-				// new vertex.
-				possible_vertex.id = this->voronoi_id++;
-				this->voronoi_vertices.insert(std::pair<uint64_t, VoronoiVertex>(possible_vertex.vertex_hash, possible_vertex));
-				this->voronoi_edges.push_back(VoronoiEdge(possible_vertex.id, gate.first, gate.second[4]));
-				this->vertices.push_back(edgeEndResult);
-				this->voronoi_mutex.unlock();
-
-				// Create the three new gates.
-				std::pair<vec4d, std::array<uint, 5>> new1(edgeEndResult,
-					{ static_cast<uint>(minIdx), gate.second[0], gate.second[1], gate.second[2], possible_vertex.id });
-				std::pair<vec4d, std::array<uint, 5>> new2(edgeEndResult,
-					{ static_cast<uint>(minIdx), gate.second[1], gate.second[2], gate.second[0], possible_vertex.id });
-				std::pair<vec4d, std::array<uint, 5>> new3(edgeEndResult,
-					{ static_cast<uint>(minIdx), gate.second[0], gate.second[2], gate.second[1], possible_vertex.id });
-
-				// Add the new gates to the inactive queue.
-				this->voronoi_mutex.lock();
-				if (this->active_gates == 0) {
-					this->gatesToTest_two.push_back(new3);
-					this->gatesToTest_two.push_back(new2);
-					this->gatesToTest_two.push_back(new1);
+		// Merge the results of the whole batch into the diagram.
+		std::lock_guard<std::mutex> lock(this->voronoi_mutex);
+		auto& inactive = (this->active_gates == 0) ? this->gatesToTest_two : this->gatesToTest_one;
+		for (size_t i = 0; i < batch.size(); i++) {
+			const auto& gate = batch[i];
+			int minIdx = results[i].first;
+			const vec4d& edgeEndResult = results[i].second;
+
+			// Did we find a result for the currently processed gate?
+			if (minIdx >= 0) {
+				// Create the new Voronoi vertex and check if it already exists.
+				VoronoiVertex possible_vertex = VoronoiVertex(vec4ui(gate.second[0], gate.second[1], gate.second[2], minIdx), 0);
+				auto it = this->voronoi_vertices.find(possible_vertex.vertex_hash);
+				if (it == this->voronoi_vertices.end()) {
+					// The vertex is new so add it to the list and create the edge between the vertex we came from and
+					// the new vertex.
+					possible_vertex.id = this->voronoi_id++;
+					this->voronoi_vertices.insert(std::pair<uint64_t, VoronoiVertex>(possible_vertex.vertex_hash, possible_vertex));
+					this->voronoi_edges.push_back(VoronoiEdge(possible_vertex.id, gate.first, gate.second[4]));
+					this->vertices.push_back(edgeEndResult);
+
+					// Add the three new gates to the inactive queue.
+					inactive.push_back(std::pair<vec4d, std::array<uint, 5>>(edgeEndResult,
+						{ static_cast<uint>(minIdx), gate.second[0], gate.second[2], gate.second[1], possible_vertex.id }));
+					inactive.push_back(std::pair<vec4d, std::array<uint, 5>>(edgeEndResult,
+						{ static_cast<uint>(minIdx), gate.second[1], gate.second[2], gate.second[0], possible_vertex.id }));
+					inactive.push_back(std::pair<vec4d, std::array<uint, 5>>(edgeEndResult,
+						{ static_cast<uint>(minIdx), gate.second[0], gate.second[1], gate.second[2], possible_vertex.id }));
 
 				} else {
-					this->gatesToTest_one.push_back(new3);
-					this->gatesToTest_one.push_back(new2);
-					this->gatesToTest_one.push_back(new1);
+					// The vertex already exists so create the edge.
+					this->voronoi_edges.push_back(VoronoiEdge(it->second.id, gate.first, gate.second[4]));
 				}
-				this->voronoi_mutex.unlock();
 
 			} else {
-				// The vertex already exists so create the edge.
-				this->voronoi_edges.push_back(VoronoiEdge(it->second.id, gate.first, gate.second[4]));
-				this->voronoi_mutex.unlock();
-			}
-
-		} else {
-			// Compute the hash value of the voronoi vertex and increase the infinity counter.
-			this->voronoi_mutex.lock();
-			auto vertex_hash = VoronoiVertex::ComputeHash(vec4ui(gate.second[0], gate.second[1], gate.second[2], gate.second[3]));
-			auto it = this->voronoi_vertices.find(vertex_hash);
-			if (it != this->voronoi_vertices.end()) {
-				it->second.infinity_count++;
+				// Compute the hash value of the voronoi vertex and increase the infinity counter.
+				auto vertex_hash = VoronoiVertex::ComputeHash(vec4ui(gate.second[0], gate.second[1], gate.second[2], gate.second[3]));
+				auto it = this->voronoi_vertices.find(vertex_hash);
+				if (it != this->voronoi_vertices.end()) {
+					it->second.infinity_count++;
+				}
 			}
-			this->voronoi_mutex.unlock();
-		}
-
-		// Check if we need to stop the thread because all gates have been processed.
-		if (this->active_gates == 0) {
-			stop = this->gatesToTest_one.empty();
-
-		} else {
-			stop = this->gatesToTest_two.empty();
 		}
 	}
 }
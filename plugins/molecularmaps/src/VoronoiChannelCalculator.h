@@ -78,7 +78,19 @@ namespace molecularmaps {
 		void convexHullThread();
 
 		/**
-		 * Computes the next Voronoi vertices until the thread is stopped.
+		 * Removes the next batch of gates from the active queue.
+		 *
+		 * @param batch Receives the gates to process.
+		 *
+		 * @return true if gates were removed, false if the active queue is empty
+		 */
+		bool fetchGates(std::vector<std::pair<vec4d, std::array<uint, 5>>>& batch);
+
+		/**
+		 * Computes the next Voronoi vertices until the active queue is empty.
+		 *
+		 * The gates are processed in batches, the end vertices of a batch are computed without holding the lock and
+		 * merged into the diagram at once.
 		 */
 		void nextVoronoiVertex();
 
@@ -16,6 +16,8 @@
 #include <omp.h>
 #include <iostream>
 #include <float.h>
+#include <future>
+#include <vector>
 
 #define _USE_MATH_DEFINES 1
 /*
@@ -155,6 +157,9 @@ bool megamol::protein::AggregatedDensity::getExtentCallback(megamol::core::Call&
     return true;
 }
 
+/*
+ * megamol::protein::AggregatedDensity::aggregate
+ */
 bool megamol::protein::AggregatedDensity::aggregate() {
 	megamol::protein_calls::MolecularDataCall *mol = this->molDataCallerSlot.CallAs<megamol::protein_calls::MolecularDataCall>();
     if(!mol) {
@@ -170,29 +175,52 @@ bool megamol::protein::AggregatedDensity::aggregate() {
 
 // this number must remain constant!
 	unsigned int n_atoms = mol->AtomCount();
-
-	float * pos0 = new float[mol->AtomCount() * 3];
-	float * vel  = new float[mol->AtomCount() * 3];
-	memcpy( pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof( float));
-
-	for (unsigned int frame=0; frame < mol->FrameCount(); frame++) {
-		mol->SetFrameID(frame);
-		if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData)) return false;
-		if (mol->AtomCount()!=n_atoms) {
-			delete[] pos0, vel;
-			return false;
+	unsigned int n_frames = mol->FrameCount();
+
+	std::vector<float> pos0(mol->AtomPositions(), mol->AtomPositions() + 3 * n_atoms);
+
+	// The frames are requested in batches of at most 16M floats. While the
+	// next batch is requested, the previous one is accumulated in the
+	// background.
+	const unsigned int batchSize = static_cast<unsigned int>(vislib::math::Clamp<size_t>(
+		(static_cast<size_t>(1) << 24) / (6 * static_cast<size_t>(n_atoms) + 1), 1, 64));
+	std::vector<float> batchPos[2], batchVel[2];
+	std::future<void> accumulation;
+	unsigned int b = 0;
+
+	for (unsigned int first = 0; first < n_frames; first += batchSize) {
+		unsigned int cnt = vislib::math::Min(batchSize, n_frames - first);
+		std::vector<float>& pos = batchPos[b];
+		std::vector<float>& vel = batchVel[b];
+		pos.resize(3 * static_cast<size_t>(n_atoms) * cnt);
+		vel.resize(3 * static_cast<size_t>(n_atoms) * cnt);
+
+		for (unsigned int f = 0; f < cnt; f++) {
+			mol->SetFrameID(first + f);
+			if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData)
+					|| (mol->AtomCount() != n_atoms)) {
+				if (accumulation.valid()) accumulation.wait();
+				return false;
+			}
+			const float* pos_new = mol->AtomPositions();
+			float* p = pos.data() + 3 * static_cast<size_t>(n_atoms) * f;
+			float* v = vel.data() + 3 * static_cast<size_t>(n_atoms) * f;
+			for (unsigned int i = 0; i < 3 * n_atoms; i++) {
+				v[i] = pos_new[i] - pos0[i];
+				p[i] = pos_new[i];
+			}
+			memcpy(pos0.data(), pos_new, n_atoms * 3 * sizeof(float));
 		}
-    	const float* pos_new = mol->AtomPositions();
 
-		for (unsigned int i = 0; i<3*n_atoms; i++) {
-			vel[i] =  pos_new[i] - pos0[i];
-		}
-		memcpy( pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof( float));
-        this->aggregate_frame(pos0, vel, n_atoms);
-        framecounter++;
+		if (accumulation.valid()) accumulation.get();
+		accumulation = std::async(std::launch::async, [this, &pos, &vel, cnt, n_atoms]() {
+			this->aggregate_batch(pos.data(), vel.data(), cnt, n_atoms);
+		});
+		b = 1 - b;
 	}
+	if (accumulation.valid()) accumulation.get();
+	framecounter += n_frames;
 
-	delete[] pos0, vel;
     is_aggregated = true;
     float maxdensity=0;
     float minvelocity=FLT_MAX;
@@ -215,12 +243,51 @@ bool megamol::protein::AggregatedDensity::aggregate() {
     return true;
 }
 
-bool megamol::protein::AggregatedDensity::aggregate_frame(float* pos, float* vel, unsigned int n_atoms) {
+
+/*
+ * megamol::protein::AggregatedDensity::aggregate_batch
+ */
+void megamol::protein::AggregatedDensity::aggregate_batch(const float* pos, const float* vel, unsigned int n_frames,
+		unsigned int n_atoms) {
+	const size_t n_cells = static_cast<size_t>(xbins) * ybins * zbins;
+	const size_t frameSize = 3 * static_cast<size_t>(n_atoms);
+
+	// Every thread accumulates its frames into a partial grid, which are
+	// summed up afterwards
+#pragma omp parallel
+	{
+		std::vector<float> partDensity(n_cells, 0.0f);
+		std::vector<float> partVelocity(3 * n_cells, 0.0f);
+
+#pragma omp for schedule(dynamic)
+		for (int f = 0; f < static_cast<int>(n_frames); f++) {
+			this->aggregate_frame(pos + frameSize * f, vel + frameSize * f, n_atoms, partDensity.data(),
+				partVelocity.data());
+		}
+
+#pragma omp critical
+		{
+			for (size_t i = 0; i < n_cells; i++) {
+				density[i] += partDensity[i];
+			}
+			for (size_t i = 0; i < 3 * n_cells; i++) {
+				velocity[i] += partVelocity[i];
+			}
+		}
+	}
+}
+
+
+/*
+ * megamol::protein::AggregatedDensity::aggregate_frame
+ */
+bool megamol::protein::AggregatedDensity::aggregate_frame(const float* pos, const float* vel, unsigned int n_atoms,
+		float* outDensity, float* outVelocity) {
 	float x, y, z, dx, dy, dz;
 	unsigned int X,Y,Z;
 	float weight;
 	unsigned int linear_index;
-	for (unsigned int i = 0; i<3*n_atoms; i++) {
+	for (unsigned int i = 0; i<n_atoms; i++) {
 		x=(pos[3*i+0]-origin_x)/res; // in lattice constants
 		X=static_cast<unsigned int>(floor(x));
 		dx=x-X;
@@ -236,59 +303,59 @@ bool megamol::protein::AggregatedDensity::aggregate_frame(float* pos, float* vel
           //density[X+xbins*Y+xbins*ybins*Z]+=weight;
   		  weight=(1-dx)*(1-dy)*(1-dz);
           linear_index = (X+0) + (Y+0)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 		  weight=(1-dx)*(1-dy)*(dz);
           linear_index = (X+0) + (Y+0)*xbins + (Z+1)*xbins*ybins;
-		  		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 		  
 		  weight=(1-dx)*(dy)*(1-dz);
           linear_index = (X+0) + (Y+1)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 		  weight=(1-dx)*(dy)*(dz);
           linear_index = (X+0) + (Y+1)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 		  weight=(dx)*(1-dy)*(1-dz);
           linear_index = (X+1) + (Y+0)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 		  weight=(dx)*(1-dy)*(dz);
           linear_index = (X+1) + (Y+0)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 		  
 		  weight=(dx)*(dy)*(1-dz);
           linear_index = (X+1) + (Y+1)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 		  weight=(dx)*(dy)*(dz);
           linear_index = (X+1) + (Y+1)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
+		  outDensity[linear_index]+=weight;
+		  outVelocity[3*linear_index+0]+=weight*vel[3*i+0];
+		  outVelocity[3*linear_index+1]+=weight*vel[3*i+1];
+		  outVelocity[3*linear_index+2]+=weight*vel[3*i+2];
 
 
 
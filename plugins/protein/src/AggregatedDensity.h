@@ -62,7 +62,20 @@ class AggregatedDensity : public megamol::core::Module {
     protected:
 
 		bool aggregate();
-		bool aggregate_frame(float* pos, float* vel, unsigned int n_atoms);
+
+		/**
+		 * Accumulates a batch of frames in parallel into the density and the
+		 * velocity grids.
+		 *
+		 * @param pos The positions of all atoms in all frames of the batch
+		 * @param vel The displacements of all atoms in all frames of the batch
+		 * @param n_frames The number of frames in the batch
+		 * @param n_atoms The number of atoms per frame
+		 */
+		void aggregate_batch(const float* pos, const float* vel, unsigned int n_frames, unsigned int n_atoms);
+
+		bool aggregate_frame(const float* pos, const float* vel, unsigned int n_atoms, float* outDensity,
+			float* outVelocity);
 
         /**
          * Implementation of 'Create'.
@@ -131,7 +131,7 @@ void Base64::Encode(const char *input, char *output, SIZE_T s) {
     // bundles that only contain bits from filler bytes are encoded by '=', the
     // number of '=', therefore, indicates the number of filler bytes used
     nfillers = (3-s%3) % 3;
-    memcpy(&bytes[0], input+s/3, s%3); // Copy valid bytes from the actual data
+    memcpy(&bytes[0], input+3*(s/3), s%3); // Copy valid bytes from the actual data
     memset(&bytes[s%3], 0, nfillers);  // Set filler bytes
     output[4*int(s/3)+0] = MapEncode[(bytes[0] & 0xfc) >> 2];
     output[4*int(s/3)+1] = MapEncode[((bytes[0] & 0x03) << 4) + ((bytes[1] & 0xf0) >> 4)];
@@ -153,8 +153,10 @@ void Base64::Encode(const char *input, char *output, SIZE_T s) {
 void Base64::Decode(const char *input, char *output, SIZE_T s) {
     char bytes[4];
     uint nFillers;
-    // Decode byte triples
-    for (unsigned int cnt = 0; cnt < s/3; cnt++) {
+    // Decode byte triples, every quadruple of characters is independent
+    const int nTriples = static_cast<int>(s/3);
+#pragma omp parallel for
+    for (int cnt = 0; cnt < nTriples; cnt++) {
         char bytes[] = {
                 MapDecode[static_cast<int>(input[cnt*4+0])],
                 MapDecode[static_cast<int>(input[cnt*4+1])],
@@ -114,30 +114,35 @@ bool protein::CCP4VolumeData::tryLoadFile(void) {
 
 
 
-	// open file for reading
+	// open file for reading, the file is memory mapped such that the map is
+	// read in one go without intermediate stream buffering
     vislib::StringA ccp4filename( this->filename.Param<param::FilePathParam>()->Value());
 	const char *fn = ccp4filename.PeekBuffer();
-    std::ifstream fin( fn, std::ios::binary | std::ios::in );
+    vislib::sys::MemmappedFile fin;
 
     // return if file open failed
-    if( !fin ) {
+    if( !fin.Open( fn, vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+            vislib::sys::File::OPEN_ONLY) ) {
         Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
             "%s: Unable to open CCP4 input file \"%s\"", this->ClassName(), fn );
         return false;
     }
 
     // get length of file:
-    fin.seekg( 0, std::ios::end);
-    unsigned int fileLength = static_cast<unsigned int>(fin.tellg());
-    fin.seekg( 0, std::ios::beg);
+    vislib::sys::File::FileSize fileLength = fin.GetSize();
 
 #define WORD 4
 
     // read header
-    fin.read( (char*)&header, sizeof(header));
+    if( fin.Read( &header, sizeof(header)) != sizeof(header) ) {
+        Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
+            "%s: Unable to read the header of \"%s\"", this->ClassName(), fn );
+        return false;
+    }
 
-    // compute the number of bytes for the map
-    unsigned int volBytes = header.volDim[0] * header.volDim[1] * header.volDim[2] * WORD;
+    // compute the number of voxels and bytes for the map
+    SIZE_T volCount = static_cast<SIZE_T>(header.volDim[0]) * header.volDim[1] * header.volDim[2];
+    vislib::sys::File::FileSize volBytes = volCount * WORD;
 
     // read symmetry records and map
     if( this->header.mode == 2 ) {
@@ -147,13 +152,13 @@ bool protein::CCP4VolumeData::tryLoadFile(void) {
                 "%s: File is too large, assuming incorrectly set number of symmetry records.", 
                 this->ClassName() );
             // compute correct number of bytes for symmetry records
-            this->header.nsymbyte = fileLength - ( sizeof( this->header) + volBytes);
+            this->header.nsymbyte = static_cast<int>(fileLength - ( sizeof( this->header) + volBytes));
             // resize symmetry record array
             if( this->symmetry )
                 delete[] this->symmetry;
             this->symmetry = new char[this->header.nsymbyte];
             // read symmetry records
-            fin.read( this->symmetry, this->header.nsymbyte);
+            fin.Read( this->symmetry, this->header.nsymbyte);
         } else if( this->header.nsymbyte > 0 ) {
             Log::DefaultLog.WriteMsg( Log::LEVEL_INFO,
                 "%s: Reading symmetry records.", this->ClassName() );
@@ -162,14 +167,19 @@ bool protein::CCP4VolumeData::tryLoadFile(void) {
                 delete[] this->symmetry;
             this->symmetry = new char[this->header.nsymbyte];
             // read symmetry records
-            fin.read( this->symmetry, this->header.nsymbyte);
+            fin.Read( this->symmetry, this->header.nsymbyte);
         }
         // resize map
         if( this->map )
             delete[] this->map;
-        this->map = new float[volBytes];
+        this->map = new float[volCount];
         // read map
-        fin.read( (char*)map, volBytes);
+        if( fin.Read( this->map, volBytes) != volBytes ) {
+            Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
+                "%s: File \"%s\" is truncated.", this->ClassName(), fn );
+            fin.Close();
+            return false;
+        }
     } else {
         Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
             "%s: Mode %i not supported.", this->ClassName(), this->header.mode );
@@ -177,7 +187,7 @@ bool protein::CCP4VolumeData::tryLoadFile(void) {
     }
 
     // close file
-	fin.close();
+	fin.Close();
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
         "%s: File \"%s\" loaded successfully.\n",
         this->ClassName(), fn );
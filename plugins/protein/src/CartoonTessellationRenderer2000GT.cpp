@@ -56,6 +56,8 @@ CartoonTessellationRenderer2000GT::CartoonTessellationRenderer2000GT(void)
     , lineDebugParam("wireframe", "render in wireframe mode")
     , buttonParam("reload shaders", "reload the shaders")
     , colorInterpolationParam("color interpolation", "should the colors be interpolated?")
+    , atomIndicesHash(0)
+    , atomIndicesCount(0)
     ,
     // this variant should not need the fence
     singleBufferCreationBits(GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT)
@@ -307,6 +309,46 @@ void CartoonTessellationRenderer2000GT::getBytesAndStrideLines(MolecularDataCall
     vertStride = vertStride < vertBytes ? vertBytes : vertStride;
 }
 
+/*
+ * CartoonTessellationRenderer2000GT::updateAtomIndices
+ */
+void CartoonTessellationRenderer2000GT::updateAtomIndices(MolecularDataCall& mol) {
+    // the atom names only change with the data, not with the frame
+    if ((mol.DataHash() != 0) && (mol.DataHash() == this->atomIndicesHash) &&
+        (mol.AtomCount() == this->atomIndicesCount) && (mol.MoleculeCount() == this->atomIndicesCa.size())) {
+        return;
+    }
+    this->atomIndicesHash = mol.DataHash();
+    this->atomIndicesCount = mol.AtomCount();
+
+    this->atomIndicesCa.resize(mol.MoleculeCount());
+    this->atomIndicesO.resize(mol.MoleculeCount());
+    for (unsigned int molIdx = 0; molIdx < mol.MoleculeCount(); molIdx++) {
+        auto& ca = this->atomIndicesCa[molIdx];
+        auto& o = this->atomIndicesO[molIdx];
+        ca.clear();
+        o.clear();
+
+        unsigned int firstResIdx = mol.Molecules()[molIdx].FirstResidueIndex();
+        unsigned int lastResIdx = firstResIdx + mol.Molecules()[molIdx].ResidueCount();
+        for (unsigned int resIdx = firstResIdx; resIdx < lastResIdx; resIdx++) {
+            unsigned int firstAtomIdx = mol.Residues()[resIdx]->FirstAtomIndex();
+            unsigned int lastAtomIdx = firstAtomIdx + mol.Residues()[resIdx]->AtomCount();
+            // write first and last positions three times
+            unsigned int repeat = ((resIdx == firstResIdx) || (resIdx == (lastResIdx - 1))) ? 3 : 1;
+            for (unsigned int atomIdx = firstAtomIdx; atomIdx < lastAtomIdx; atomIdx++) {
+                const auto& name = mol.AtomTypes()[mol.AtomTypeIndices()[atomIdx]].Name();
+                if (name.Equals("CA")) {
+                    ca.insert(ca.end(), repeat, atomIdx);
+                }
+                if (name.Equals("O")) {
+                    o.insert(o.end(), repeat, atomIdx);
+                }
+            }
+        }
+    }
+}
+
 /*
  * GetExtents
  */
@@ -580,61 +622,27 @@ bool CartoonTessellationRenderer2000GT::Render(view::CallRender3D_2& call) {
     }
 #endif
 
-    firstResIdx = 0;
-    lastResIdx = 0;
-    firstAtomIdx = 0;
-    lastAtomIdx = 0;
-    atomTypeIdx = 0;
-
-    for (unsigned int molIdx = 0; molIdx < mol->MoleculeCount(); molIdx++) {
-        this->positionsCa[molIdx].Clear();
-        this->positionsCa[molIdx].AssertCapacity(mol->Molecules()[molIdx].ResidueCount() * 4 + 16);
-        this->positionsO[molIdx].Clear();
-        this->positionsO[molIdx].AssertCapacity(mol->Molecules()[molIdx].ResidueCount() * 4 + 16);
-
-        // bool first;
-        firstResIdx = mol->Molecules()[molIdx].FirstResidueIndex();
-        lastResIdx = firstResIdx + mol->Molecules()[molIdx].ResidueCount();
-        for (unsigned int resIdx = firstResIdx; resIdx < lastResIdx; resIdx++) {
-            firstAtomIdx = mol->Residues()[resIdx]->FirstAtomIndex();
-            lastAtomIdx = firstAtomIdx + mol->Residues()[resIdx]->AtomCount();
-            for (unsigned int atomIdx = firstAtomIdx; atomIdx < lastAtomIdx; atomIdx++) {
-                unsigned int atomTypeIdx = mol->AtomTypeIndices()[atomIdx];
-                if (mol->AtomTypes()[atomTypeIdx].Name().Equals("CA")) {
-                    this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                    this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                    this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                    this->positionsCa[molIdx].Add(1.0f);
-                    // write first and last Ca position three times
-                    if ((resIdx == firstResIdx) || (resIdx == (lastResIdx - 1))) {
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                        this->positionsCa[molIdx].Add(1.0f);
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                        this->positionsCa[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                        this->positionsCa[molIdx].Add(1.0f);
-                    }
-                }
-                if (mol->AtomTypes()[atomTypeIdx].Name().Equals("O")) {
-                    this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                    this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                    this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                    this->positionsO[molIdx].Add(1.0f);
-                    // write first and last Ca position three times
-                    if ((resIdx == firstResIdx) || (resIdx == (lastResIdx - 1))) {
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                        this->positionsO[molIdx].Add(1.0f);
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx]);
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 1]);
-                        this->positionsO[molIdx].Add(mol->AtomPositions()[3 * atomIdx + 2]);
-                        this->positionsO[molIdx].Add(1.0f);
-                    }
-                }
-            }
+    // gather the CA and O positions of the frame, the atoms are only looked up when the data changes
+    this->updateAtomIndices(*mol);
+    const float* atomPos = mol->AtomPositions();
+    const int molCnt = static_cast<int>(mol->MoleculeCount());
+#pragma omp parallel for
+    for (int molIdx = 0; molIdx < molCnt; molIdx++) {
+        const auto& ca = this->atomIndicesCa[molIdx];
+        this->positionsCa[molIdx].SetCount(4 * ca.size());
+        for (size_t i = 0; i < ca.size(); i++) {
+            this->positionsCa[molIdx][4 * i + 0] = atomPos[3 * ca[i] + 0];
+            this->positionsCa[molIdx][4 * i + 1] = atomPos[3 * ca[i] + 1];
+            this->positionsCa[molIdx][4 * i + 2] = atomPos[3 * ca[i] + 2];
+            this->positionsCa[molIdx][4 * i + 3] = 1.0f;
+        }
+        const auto& o = this->atomIndicesO[molIdx];
+        this->positionsO[molIdx].SetCount(4 * o.size());
+        for (size_t i = 0; i < o.size(); i++) {
+            this->positionsO[molIdx][4 * i + 0] = atomPos[3 * o[i] + 0];
+            this->positionsO[molIdx][4 * i + 1] = atomPos[3 * o[i] + 1];
+            this->positionsO[molIdx][4 * i + 2] = atomPos[3 * o[i] + 2];
+            this->positionsO[molIdx][4 * i + 3] = 1.0f;
         }
     }
     // std::cout << "cIndex " << cIndex << " oIndex " << oIndex << " molCount " << mol->MoleculeCount() << std::endl;
@@ -21,6 +21,7 @@
 #include "mmcore/param/ParamSlot.h"
 #include "protein_calls/MolecularDataCall.h"
 #include <map>
+#include <vector>
 #include <utility>
 
 //#define FIRSTFRAME_CHECK
@@ -139,6 +140,13 @@ namespace protein {
 		void getBytesAndStrideLines(MolecularDataCall &mol, unsigned int &colBytes, unsigned int &vertBytes,
 			unsigned int &colStride, unsigned int &vertStride);
 
+        /**
+         * Collects the indices of the CA and O atoms of all molecules, unless they are known for the data already.
+         *
+         * @param mol The molecular data
+         */
+        void updateAtomIndices(MolecularDataCall &mol);
+
         void queueSignal(GLsync& syncObj);
 		void waitSignal(GLsync& syncObj);
 
@@ -175,6 +183,13 @@ namespace protein {
         vislib::Array<vislib::Array<float> > positionsCa;
         vislib::Array<vislib::Array<float> > positionsO;
 
+        /** The atoms written to positionsCa and positionsO per molecule, first and last ones three times */
+        std::vector<std::vector<unsigned int> > atomIndicesCa;
+        std::vector<std::vector<unsigned int> > atomIndicesO;
+        /** The data hash and atom count the atom indices were collected for */
+        SIZE_T atomIndicesHash;
+        unsigned int atomIndicesCount;
+
         /** shader for the spheres (raycasting view) */
         vislib::graphics::gl::GLSLShader sphereShader;
         /** shader for spline rendering */
@@ -485,7 +485,7 @@ bool protein::DofRendererDeferred::createFbo(GLuint width, GLuint height) {
 	// Source buffer
 	glGenTextures(1, &this->sourceBuffer);
 	glBindTexture(GL_TEXTURE_2D, this->sourceBuffer);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA,
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
 			GL_UNSIGNED_BYTE, 0);
 	glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
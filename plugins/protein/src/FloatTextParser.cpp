@@ -0,0 +1,91 @@
+//
+// FloatTextParser.cpp
+//
+// Copyright (C) 2019 by University of Stuttgart (VISUS).
+// All rights reserved.
+//
+
+#include "stdafx.h"
+#include "FloatTextParser.h"
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace megamol::protein;
+
+const SIZE_T FloatTextParser::ChunkSize = 1 << 20;
+
+/*
+ * FloatTextParser::Parse
+ */
+SIZE_T FloatTextParser::Parse(const char *begin, const char *end,
+        float *output, SIZE_T maxCnt) {
+
+    if ((end <= begin) || (maxCnt == 0)) {
+        return 0;
+    }
+
+    // Split the text into chunks, moving every nominal boundary forward to
+    // the next whitespace so that no token is cut
+    const SIZE_T len = static_cast<SIZE_T>(end - begin);
+    const int chunkCnt = static_cast<int>((len + ChunkSize - 1) / ChunkSize);
+    std::vector<const char*> bounds(chunkCnt + 1);
+    bounds[0] = begin;
+    bounds[chunkCnt] = end;
+    for (int c = 1; c < chunkCnt; ++c) {
+        const char *pt = begin + c * ChunkSize;
+        if (pt < bounds[c - 1]) {
+            pt = bounds[c - 1];
+        }
+        while ((pt < end) && !isspace(static_cast<unsigned char>(*pt))) {
+            pt++;
+        }
+        bounds[c] = pt;
+    }
+
+    // Count the tokens of every chunk
+    std::vector<SIZE_T> offsets(chunkCnt + 1, 0);
+#pragma omp parallel for
+    for (int c = 0; c < chunkCnt; ++c) {
+        SIZE_T cnt = 0;
+        bool inToken = false;
+        for (const char *pt = bounds[c]; pt < bounds[c + 1]; ++pt) {
+            const bool space = (isspace(static_cast<unsigned char>(*pt)) != 0);
+            if (!space && !inToken) {
+                cnt++;
+            }
+            inToken = !space;
+        }
+        offsets[c + 1] = cnt;
+    }
+    for (int c = 0; c < chunkCnt; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+
+    // Parse the chunks into their part of the output
+#pragma omp parallel for
+    for (int c = 0; c < chunkCnt; ++c) {
+        SIZE_T idx = offsets[c];
+        const char *pt = bounds[c];
+        const char *chunkEnd = bounds[c + 1];
+        std::string token;
+        while (idx < maxCnt) {
+            while ((pt < chunkEnd) && isspace(static_cast<unsigned char>(*pt))) {
+                pt++;
+            }
+            if (pt >= chunkEnd) {
+                break;
+            }
+            const char *tokenBegin = pt;
+            while ((pt < chunkEnd) && !isspace(static_cast<unsigned char>(*pt))) {
+                pt++;
+            }
+            // Copy the token, as the text need not be terminated
+            token.assign(tokenBegin, pt);
+            output[idx++] = static_cast<float>(atof(token.c_str()));
+        }
+    }
+
+    return (offsets[chunkCnt] < maxCnt) ? offsets[chunkCnt] : maxCnt;
+}
@@ -0,0 +1,52 @@
+//
+// FloatTextParser.h
+//
+// Copyright (C) 2019 by University of Stuttgart (VISUS).
+// All rights reserved.
+//
+
+#ifndef MMPROTEINPLUGIN_FLOATTEXTPARSER_H_INCLUDED
+#define MMPROTEINPLUGIN_FLOATTEXTPARSER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+namespace megamol {
+namespace protein {
+
+/**
+ * Parses whitespace separated numbers in parallel. The text is split into
+ * chunks at whitespace boundaries, the numbers of every chunk are counted,
+ * and the chunks are then parsed independently into their slice of the
+ * output.
+ */
+class FloatTextParser {
+
+public:
+
+    /**
+     * Parses the whitespace separated numbers in [begin, end). Tokens that
+     * are no numbers are stored as zero. 'end' must not point into the
+     * middle of a token.
+     *
+     * @param begin The start of the text
+     * @param end The end of the text
+     * @param output The array receiving the numbers
+     * @param maxCnt The size of the output array, numbers exceeding it are
+     *               ignored
+     *
+     * @return The number of values written to the output array
+     */
+    static SIZE_T Parse(const char *begin, const char *end, float *output,
+            SIZE_T maxCnt);
+
+private:
+
+    /** The approximate number of characters parsed by one task */
+    static const SIZE_T ChunkSize;
+};
+
+} // end namespace protein
+} // end namespace megamol
+
+#endif // MMPROTEINPLUGIN_FLOATTEXTPARSER_H_INCLUDED
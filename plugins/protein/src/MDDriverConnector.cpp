@@ -18,6 +18,7 @@ using namespace megamol;
 using namespace megamol::protein;
 
 #define TIMEOUT 10000 // normally can use vislib::net::Socket::TIMEOUT_INFINITE
+#define POLL_TIMEOUT 10 // how long the thread waits for data before serving the requests again (in ms)
 #define RESET_ATTEMPTS 1 // how many times MDDriver will be reset before deciding that it has failed
 
 // TODO: Find a better way of hiding the error messages when the thread is terminated in the middle of a getData call
@@ -26,9 +27,11 @@ using namespace megamol::protein;
  * MDDriverConnector::MDDriverConnector
  */
 MDDriverConnector::MDDriverConnector(void) : socketValidity(false),
-    pauseRequested(false), goRequested(false), rateRequested(0), zeroForce(false),
-    forcesCount(0), terminateRequested(false), paused(false), reset(0),
-    atomCount(0) { 
+    paused(false), zeroForce(false), pauseRequested(false), goRequested(false),
+    terminateRequested(false), rateRequested(0), reset(0), framesSinceForces(0),
+    framesReceived(0), framesConsumed(0), framesDropped(0), forcesRequested(0),
+    forcesSent(0), forcesCoalesced(0), frameInterval(0.0f), receiveTime(0.0f),
+    forceLatency(0.0f) { 
 
     // Communication with MDDriver
     try {
@@ -66,6 +69,10 @@ void MDDriverConnector::OnThreadStarting(void *config) {
 DWORD MDDriverConnector::Run(void *config) {
     using vislib::sys::Log;
 
+    bool forcesPending = false;
+    this->lastDataTime = Clock::now();
+    this->lastFrameTime = this->lastDataTime;
+
     while (this->socketValidity == true) {
 
         // Pause request
@@ -82,6 +89,7 @@ DWORD MDDriverConnector::Run(void *config) {
             this->sendGo(); // DEBUG the second pause and go call is solving a bug with MDDriver
             this->goRequested = false; // flag go done
             this->paused = false; // flag not currently paused
+            this->lastDataTime = Clock::now();
         }
 
         // Transfer rate request
@@ -90,10 +98,16 @@ DWORD MDDriverConnector::Run(void *config) {
             this->rateRequested = 0; // flag transfer rate done
         }
 
-        // Forces send request
-        if (this->forcesCount != 0 && terminateRequested == false) {
-            this->sendForces();
-            this->forcesCount = 0; // flag force send done
+        // Forces send request, sending the latest set once per coordinate frame
+        if (this->forceSets.Take()) {
+            forcesPending = true;
+        }
+        if (forcesPending && (this->paused || this->framesSinceForces > 0) && terminateRequested == false) {
+            if (this->sendForces(this->forceSets.Front())) {
+                this->forcesSent++;
+            }
+            forcesPending = false; // flag force send done
+            this->framesSinceForces = 0;
         }
 
         // Get data if simulation is running
@@ -105,6 +119,7 @@ DWORD MDDriverConnector::Run(void *config) {
                     this->sendPause();
                     this->sendGo();
                     this->reset += 1; // mark that another reset attempt was made
+                    this->lastDataTime = Clock::now();
                 } else {
                     this->terminateRequested = true; // returned false despite reset attempts - terminate the thread
                 }
@@ -129,6 +144,13 @@ DWORD MDDriverConnector::Run(void *config) {
         }
     }
 
+    Statistics stats = this->GetStatistics();
+    Log::DefaultLog.WriteMsg( Log::LEVEL_INFO, "MDDriver connection statistics: %u frames received, "
+        "%u taken, %u dropped (%.1f ms between frames, %.1f ms receive time); %u force sets requested, "
+        "%u sent, %u coalesced (%.1f ms latency)", stats.framesReceived, stats.framesConsumed,
+        stats.framesDropped, stats.frameInterval, stats.receiveTime, stats.forcesRequested,
+        stats.forcesSent, stats.forcesCoalesced, stats.forceLatency);
+
     return 0;
 }
 
@@ -143,10 +165,8 @@ bool MDDriverConnector::Terminate(void) {
     this->pauseRequested = false;
     this->goRequested = false;
     this->rateRequested = 0;
-    this->forcesCount = 0;
     this->terminateRequested = false;
     this->reset = 0;
-    this->atomCount = 0;
 
     return true;
 }
@@ -163,68 +183,68 @@ void MDDriverConnector::Initialize(vislib::TString inHost, int inPort) {
  * MDDriverConnector::RequestForces
  */
 void MDDriverConnector::RequestForces(int count, const unsigned int *atomIDs, const float *forces) {
+    ForceSet& forceSet = this->forceSets.Back();
     if (count != 0) {
-        if (this->forceIDs.TryLock()) {
-            if (this->forceList.TryLock()) {
-                // Copy the new forces into the forces arrays
-                this->forceIDs.AssertCapacity(count);
-                this->forceIDs.Clear();
-                for (int iter = 0; iter < count; iter += 1) {
-                    this->forceIDs.Add(atomIDs[iter]);
-                }
-                this->forceList.AssertCapacity(count * 3);
-                this->forceList.Clear();
-                for (int iter = 0; iter < count * 3; iter += 1) {
-                    this->forceList.Add(forces[iter]);
-                }
-                this->forcesCount = count;
-                this->zeroForce = true; // mark that the forces will need to be zeroed when they are removed
-                this->forceList.Unlock();
-            }
-            this->forceIDs.Unlock();
-        }
-    } else if (count == 0 && this->zeroForce == true) {
+        // Copy the new forces into the forces arrays
+        forceSet.atomIDs.assign(atomIDs, atomIDs + count);
+        forceSet.forces.assign(forces, forces + count * 3);
+        this->zeroForce = true; // mark that the forces will need to be zeroed when they are removed
+    } else if (this->zeroForce == true) {
         // create a 0 force to clear other forces (not sure this is necessary)
-        if (this->forceIDs.TryLock()) {
-            if (this->forceList.TryLock()) {
-                this->forceIDs.AssertCapacity(1);
-                this->forceIDs.Clear();
-                // apply force to 0th atom
-                this->forceIDs.Add(1);
-                this->forceList.AssertCapacity(3);
-                this->forceList.Clear();
-                // apply 0 vector force
-                this->forceList.Add(0.0f);
-                this->forceList.Add(0.0f);
-                this->forceList.Add(0.0f);
-                this->forcesCount = 1;
-                this->zeroForce = false; // mark that a zero force has been applied so it won't be applied again
-                this->forceList.Unlock();
-            }
-            this->forceIDs.Unlock();
-        } else { // if count == 0 and zeroForce == false
-            this->forcesCount = 0; // don't apply any forces, not even a zero
-        }
+        // apply 0 vector force to 0th atom
+        forceSet.atomIDs.assign(1, 1);
+        forceSet.forces.assign(3, 0.0f);
+        this->zeroForce = false; // mark that a zero force has been applied so it won't be applied again
+    } else {
+        return; // don't apply any forces, not even a zero
+    }
+    forceSet.requested = Clock::now();
+    this->forcesRequested++;
+    if (this->forceSets.Publish()) {
+        this->forcesCoalesced++;
     }
 }
 
 /*
  * MDDriverConnector::GetCoordinates
  */
-void MDDriverConnector::GetCoordinates(int count, float* atomPos) {
+bool MDDriverConnector::GetCoordinates(int count, float* atomPos) {
     using vislib::sys::Log;
 
-    if (this->atomCount == count) {
-        if (this->atomCoordinates.TryLock()) {
-            memcpy(atomPos, atomCoordinates.PeekElements(), sizeof(float)*count*3);
-            this->atomCoordinates.Unlock();
-        }
-    } else if (this->atomCount == 0) {
+    bool newFrame = this->coordinates.Take();
+    if (newFrame) {
+        this->framesConsumed++;
+    }
+
+    const CoordinateFrame& frame = this->coordinates.Front();
+    if (frame.atomCount == count) {
+        memcpy(atomPos, frame.positions.data(), sizeof(float)*count*3);
+    } else if (frame.atomCount == 0) {
         // do nothing - no data received yet, but it's coming, so no error message needed
+        newFrame = false;
     } else {
         Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR, "Atom count mismatch between plugin and MDDriver." );
-        //printf("MDDriver Says: %d \n PDB Loader says: %d\n", this->atomCount, count);
+        //printf("MDDriver Says: %d \n PDB Loader says: %d\n", frame.atomCount, count);
+        newFrame = false;
     }
+    return newFrame;
+}
+
+/*
+ * MDDriverConnector::GetStatistics
+ */
+MDDriverConnector::Statistics MDDriverConnector::GetStatistics(void) const {
+    Statistics stats;
+    stats.framesReceived = this->framesReceived;
+    stats.framesConsumed = this->framesConsumed;
+    stats.framesDropped = this->framesDropped;
+    stats.forcesRequested = this->forcesRequested;
+    stats.forcesSent = this->forcesSent;
+    stats.forcesCoalesced = this->forcesCoalesced;
+    stats.frameInterval = this->frameInterval;
+    stats.receiveTime = this->receiveTime;
+    stats.forceLatency = this->forceLatency;
+    return stats;
 }
 
 /*
@@ -290,9 +310,23 @@ void MDDriverConnector::release(void) {
 bool MDDriverConnector::getData(void) {
     using vislib::sys::Log;
 
-    bool retval = true;
+    bool timedOut = false;
+    if (!this->getHeader(POLL_TIMEOUT, timedOut)) { // see what kind of data is arriving
+        return false;
+    }
+    if (timedOut) {
+        // nothing arrived yet - this is only an error if MDDriver stays silent for too long
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - this->lastDataTime).count() > TIMEOUT) {
+            if (this->reset >= RESET_ATTEMPTS && this->terminateRequested == false) {
+                Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR, "MDDriver sent no data for %d ms.", TIMEOUT );
+            }
+            return false;
+        }
+        return true;
+    }
+    this->lastDataTime = Clock::now();
 
-    retval &= this->getHeader(); // see what kind of data is arriving
+    bool retval = true;
 
     if ( this->header.type == MDD_DISCONNECT) {
         // MDDriver sent a disconnect signal - end the connection
@@ -302,13 +336,23 @@ bool MDDriverConnector::getData(void) {
         return false;
 
     } else if (this->header.type == MDD_COORDS) {
-        // server is sending coordinate data - allocate space and take the data
-        this->atomCoordinates.Lock(); // lock the data array for data transfer
-
-        this->atomCount = header.length; // save the input data size
-        this->atomCoordinates.AssertCapacity( this->header.length * 3); // coordinates should be able to hold x,y,z floats for all atoms
+        // server is sending coordinate data - take the data into the back buffer, which is not shared
+        CoordinateFrame& frame = this->coordinates.Back();
+        frame.atomCount = header.length; // save the input data size
+        frame.positions.resize( this->header.length * 3); // coordinates should be able to hold x,y,z floats for all atoms
         try {
-            this->socket.Receive( const_cast<float*>(this->atomCoordinates.PeekElements()), sizeof(float)*3*this->header.length, TIMEOUT, 0, true);
+            this->socket.Receive( frame.positions.data(), sizeof(float)*3*this->header.length, TIMEOUT, 0, true);
+
+            // make the complete frame available to GetCoordinates
+            Clock::time_point now = Clock::now();
+            smooth(this->receiveTime, std::chrono::duration<float, std::milli>(now - this->lastDataTime).count());
+            smooth(this->frameInterval, std::chrono::duration<float, std::milli>(now - this->lastFrameTime).count());
+            this->lastFrameTime = now;
+            if (this->coordinates.Publish()) {
+                this->framesDropped++;
+            }
+            this->framesReceived++;
+            this->framesSinceForces++;
         } catch( vislib::net::SocketException e) {
             if (this->reset >= RESET_ATTEMPTS) {
                 if (this->terminateRequested == false) {
@@ -319,9 +363,7 @@ bool MDDriverConnector::getData(void) {
                 }
             }
             retval = false; 
-       }
-        
-        this->atomCoordinates.Unlock(); // unlock the data array
+        }
 
     } else if (this->header.type == MDD_ENERGIES) {
         // verify that the energies are coming by checking that the length is 1 (number assigned by MDDriver)
@@ -361,21 +403,18 @@ bool MDDriverConnector::getData(void) {
 /*
  * MDDriverConnector::sendForces
  */
-bool MDDriverConnector::sendForces(void) {
+bool MDDriverConnector::sendForces(const ForceSet& forceSet) {
     using vislib::sys::Log;
 
     bool retval = true;
     this->header.type = MDD_MDCOMM;
-    this->header.length = this->forcesCount; // fill the header with the correct type and the number of forces
+    this->header.length = static_cast<unsigned int>(forceSet.atomIDs.size()); // fill the header with the correct type and the number of forces
 
     retval &= this->sendHeader(); // byteswap the header and send it
-   
-    this->forceIDs.Lock(); // lock the data arrays
-    this->forceList.Lock();
 
     // send the atom indices data first
     try {
-        this->socket.Send( this->forceIDs.PeekElements(), this->forcesCount * sizeof(unsigned int), TIMEOUT, 0, true);
+        this->socket.Send( forceSet.atomIDs.data(), forceSet.atomIDs.size() * sizeof(unsigned int), TIMEOUT, 0, true);
     } catch( vislib::net::SocketException e) {
         Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR, "Socket Exception during forces (atom indices) send: %s", e.GetMsgA() );
         retval = false;
@@ -383,14 +422,13 @@ bool MDDriverConnector::sendForces(void) {
 
     // send the atom forces data next
     try {
-        this->socket.Send( this->forceList.PeekElements(), this->forcesCount * 3 * sizeof(float), TIMEOUT, 0, true);
+        this->socket.Send( forceSet.forces.data(), forceSet.forces.size() * sizeof(float), TIMEOUT, 0, true);
     } catch( vislib::net::SocketException e) {
         Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR, "Socket Exception during forces (force list) send: %s", e.GetMsgA() );
         retval = false;
     }
 
-    this->forceIDs.Unlock();
-    this->forceList.Unlock(); // unlock the data arrays
+    smooth(this->forceLatency, std::chrono::duration<float, std::milli>(Clock::now() - forceSet.requested).count());
     return retval;
 }
 
@@ -431,11 +469,12 @@ bool MDDriverConnector::sendTransferRate(void) {
 /*
  * MDDriverConnector::getHeader
  */
-bool MDDriverConnector::getHeader (void) {
+bool MDDriverConnector::getHeader (int timeout, bool& outTimedOut) {
     using vislib::sys::Log;
+    outTimedOut = false;
     try { 
         int errorlevel;
-        errorlevel = static_cast<int>(this->socket.Receive( &this->header, sizeof(MDDHeader), TIMEOUT, 0, true));
+        errorlevel = static_cast<int>(this->socket.Receive( &this->header, sizeof(MDDHeader), timeout, 0, true));
         if ( errorlevel != sizeof(MDDHeader)) {    
             if ( errorlevel == 0 ) {
                 // no data was received at all - the simulation probably failed catastrophically without warning
@@ -450,13 +489,18 @@ bool MDDriverConnector::getHeader (void) {
         this->header.type = this->byteSwap(this->header.type); // for reasons unknown, MDDriver automatically byteswaps all the headers it sends out
         this->header.length = this->byteSwap(this->header.length);
     } catch( vislib::net::SocketException e) {
+        if (e.IsTimeout()) {
+            // no header arrived yet, nothing has been read from the socket
+            outTimedOut = true;
+            return true;
+        }
         if (this->reset >= RESET_ATTEMPTS) {
             // if MDDriver has already reached its reset attempts this thread, go ahead and print error messages (otherwise attempt a reset)
             if (this->terminateRequested == false) {
                 Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR, "Socket Exception during header receive: %s", e.GetMsgA() );
-                return false;
             }
         }
+        return false;
     }
     return true;
 }
@@ -500,3 +544,11 @@ int MDDriverConnector::byteSwap (int input) {
     output[3] = ((char *) &input)[0];
     return *((int*) output);
 }
+
+/*
+ * MDDriverConnector::smooth
+ */
+void MDDriverConnector::smooth(std::atomic<float>& counter, float sample) {
+    float old = counter;
+    counter = (old == 0.0f) ? sample : (0.9f * old + 0.1f * sample);
+}
@@ -17,6 +17,9 @@
 #include "vislib/sys/Runnable.h"
 #include "vislib/RawStorage.h"
 #include "vislib/Array.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
 
 #define MDD_VERSION 2 // this value corresponds to MDDriver ver 1.2 2008-06-25
 
@@ -27,6 +30,12 @@ namespace protein {
      * Data source for atom position arrays from real-time simulations.
      * Obtains data via TCP connection to MDDriver.
      *
+     * All network I/O happens on the connector thread. Coordinates and
+     * forces are exchanged with the caller through lock-free triple buffers,
+     * such that neither side ever waits for the other: the caller always gets
+     * the latest complete coordinate frame, and the thread always sends the
+     * latest force set.
+     *
      * TODO: Suggested code from MDDriver has client-side checks for endianness.
      * Current implementation assumes the same endian on both machines. Future versions could check for endianness.
      */
@@ -61,6 +70,21 @@ namespace protein {
             unsigned int length; // the length (in number of atoms) of the coordinates list being transferred, or other special values
         };
 
+        /**
+         * Counters describing the data flow between MDDriver and the caller.
+         */
+        struct Statistics {
+            unsigned int framesReceived;  //!< coordinate frames received from MDDriver
+            unsigned int framesConsumed;  //!< coordinate frames taken by GetCoordinates
+            unsigned int framesDropped;   //!< frames replaced by a newer one before being taken
+            unsigned int forcesRequested; //!< force sets passed to RequestForces
+            unsigned int forcesSent;      //!< force sets sent to MDDriver
+            unsigned int forcesCoalesced; //!< force sets replaced by a newer one before being sent
+            float frameInterval;          //!< smoothed time between two coordinate frames in ms
+            float receiveTime;            //!< smoothed time for receiving the coordinates of a frame in ms
+            float forceLatency;           //!< smoothed time from RequestForces until the forces are sent in ms
+        };
+
         /** Ctor */
         MDDriverConnector(void);
 
@@ -154,7 +178,9 @@ namespace protein {
 
         /**
          * Requests that the thread send the forces specified in the parameters to
-         * MDDriver to be used in the simulation.
+         * MDDriver to be used in the simulation. The forces are sent at most once
+         * per coordinate frame; if several sets are requested meanwhile, only the
+         * latest one is sent.
          *
          * @param count The number of forces to be sent (i.e. the number of atoms on
          * which forces are being applied).
@@ -170,12 +196,22 @@ namespace protein {
          * pointed to by atomPos. The array should expect count * 3 floats of coordinates
          * in x,y,z,x,y,z form. If the array size expected does not match the array size
          * received from MDDriver, this method prints an error and does not copy data.
+         * This method never blocks.
          *
          * @param count The number of atoms for which coordinate data is expected.
          * @param atomPos Pointer to array of at least 3*count float space into which
          * atom coordinate data will be copied.
+         *
+         * @return 'true' if a frame not seen before was copied, 'false' otherwise.
          */
-        void GetCoordinates(int count, float* atomPos);
+        bool GetCoordinates(int count, float* atomPos);
+
+        /**
+         * Answers the current data flow counters.
+         *
+         * @return The statistics.
+         */
+        Statistics GetStatistics(void) const;
 
         /**
          * Releases socket resources.
@@ -184,6 +220,102 @@ namespace protein {
 
     private:
 
+        /** The clock used for the latency counters */
+        typedef std::chrono::steady_clock Clock;
+
+        /**
+         * Three buffers shared by one producer and one consumer thread. The
+         * producer fills its back buffer and publishes it; the consumer takes
+         * the latest published buffer. Publishing and taking swap buffer
+         * indices atomically, thus neither thread waits.
+         */
+        template<class T> class TripleBuffer {
+        public:
+
+            /** Ctor */
+            TripleBuffer(void) : back(0), front(1), middle(2) {
+            }
+
+            /**
+             * Answers the buffer owned by the producer.
+             *
+             * @return The back buffer.
+             */
+            inline T& Back(void) {
+                return this->buffers[this->back];
+            }
+
+            /**
+             * Answers the buffer owned by the consumer.
+             *
+             * @return The front buffer.
+             */
+            inline const T& Front(void) const {
+                return this->buffers[this->front];
+            }
+
+            /**
+             * Publishes the back buffer. Called by the producer.
+             *
+             * @return 'true' if the previously published buffer has not been
+             *         taken, i.e. it was dropped.
+             */
+            inline bool Publish(void) {
+                int old = this->middle.exchange(this->back | FRESH);
+                this->back = old & INDEX;
+                return (old & FRESH) != 0;
+            }
+
+            /**
+             * Makes the latest published buffer the front buffer. Called by
+             * the consumer.
+             *
+             * @return 'true' if a buffer was published since the last call.
+             */
+            inline bool Take(void) {
+                if ((this->middle.load() & FRESH) == 0) {
+                    return false;
+                }
+                this->front = this->middle.exchange(this->front) & INDEX;
+                return true;
+            }
+
+        private:
+
+            /** Marks a published buffer not taken yet */
+            static const int FRESH = 4;
+
+            /** Masks the buffer index */
+            static const int INDEX = 3;
+
+            /** The buffers */
+            T buffers[3];
+
+            /** The index of the buffer of the producer */
+            int back;
+
+            /** The index of the buffer of the consumer */
+            int front;
+
+            /** The index of the exchanged buffer, possibly marked FRESH */
+            std::atomic<int> middle;
+        };
+
+        /** A set of atom coordinates received from MDDriver */
+        struct CoordinateFrame {
+            CoordinateFrame(void) : atomCount(0) {
+            }
+            int atomCount;
+            std::vector<float> positions;
+        };
+
+        /** A set of forces to be sent to MDDriver */
+        struct ForceSet {
+            std::vector<unsigned int> atomIDs;
+            std::vector<float> forces;
+            Clock::time_point requested;
+        };
+
         /*
          * This list was taken from the MDDriver code ("imd.h" version 1.2 2008-06-25)
          * The list corresponds to the header value transferred by MDDriver, and specifies
@@ -226,11 +358,11 @@ namespace protein {
          * Sends atom indices list and forces list to MDDriver. Note that not all atoms must be send - the atom numbers
          * in the atomIndices array will correspond to the forces in the forceList array.
          *
-         * @param numForces Number of forces being sent by caller.
+         * @param forceSet The forces to be sent.
          *
          * @return True on success.
          */
-        bool sendForces(void);
+        bool sendForces(const ForceSet& forceSet);
 
 
         /**
@@ -262,9 +394,20 @@ namespace protein {
         /**
          * Receives header data from MDDriver and byteswaps it
          *
-         * @return True on success.
+         * @param timeout The time in ms to wait for a header to arrive.
+         * @param outTimedOut Set 'true' if no header arrived in time.
+         *
+         * @return True on success, including a time out.
+         */
+        bool getHeader(int timeout, bool& outTimedOut);
+
+        /**
+         * Updates a smoothed counter by a new sample.
+         *
+         * @param counter The counter.
+         * @param sample The new sample.
          */
-        bool getHeader(void);
+        static void smooth(std::atomic<float>& counter, float sample);
 
         /**
          * Sends header data to MDDriver after byteswapping it.
@@ -284,7 +427,7 @@ namespace protein {
         vislib::net::Socket socket;
 
         /** The socket status */
-        bool socketValidity;
+        std::atomic<bool> socketValidity;
 
         /** The energies table */
         MDDEnergies energies;
@@ -295,20 +438,11 @@ namespace protein {
         /** Flag set if MDDriver is currently paused (prevents get data) */
         bool paused;
 
-        /** Number of atom coordinates received from MDDriver */
-        int atomCount;
-
-        /** The atom coordinates */
-        vislib::Array<float, vislib::sys::CriticalSection> atomCoordinates;
+        /** The atom coordinates, produced by the thread */
+        TripleBuffer<CoordinateFrame> coordinates;
 
-        /** Number of forces to be sent */
-        int forcesCount;
-
-        /** The atom id list for forces */
-        vislib::Array<int, vislib::sys::CriticalSection> forceIDs;
-
-        /** The list of actual forces */
-        vislib::Array<float, vislib::sys::CriticalSection> forceList;
+        /** The forces, produced by the caller */
+        TripleBuffer<ForceSet> forceSets;
 
         /** Flag if the forces have been zeroed out since the last time forces were applied and removed */
         bool zeroForce;
@@ -320,20 +454,40 @@ namespace protein {
         int port;
 
         /** Flag requesting that the thread pause MDDriver */
-        bool pauseRequested;
+        std::atomic<bool> pauseRequested;
 
         /** Flag requesting that the thread start MDDriver */
-        bool goRequested;
+        std::atomic<bool> goRequested;
 
         /** Flag requesting that the thread terminate the socket and then itself */
-        bool terminateRequested;
+        std::atomic<bool> terminateRequested;
 
         /** Flag requesting that the thread change the transfer rate (0 means no change) */
-        int rateRequested;
+        std::atomic<int> rateRequested;
 
         /** Number of times MDDriver has been reset (paused and unpaused) in this thread */
         int reset;
 
+        /** The time the last data arrived from MDDriver */
+        Clock::time_point lastDataTime;
+
+        /** The time the last coordinate frame arrived from MDDriver */
+        Clock::time_point lastFrameTime;
+
+        /** Number of coordinate frames received since forces were sent last */
+        unsigned int framesSinceForces;
+
+        /** The data flow counters */
+        std::atomic<unsigned int> framesReceived;
+        std::atomic<unsigned int> framesConsumed;
+        std::atomic<unsigned int> framesDropped;
+        std::atomic<unsigned int> forcesRequested;
+        std::atomic<unsigned int> forcesSent;
+        std::atomic<unsigned int> forcesCoalesced;
+        std::atomic<float> frameInterval;
+        std::atomic<float> receiveTime;
+        std::atomic<float> forceLatency;
+
     };
 
 } // end namespace protein
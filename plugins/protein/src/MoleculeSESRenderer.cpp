@@ -69,6 +69,8 @@ MoleculeSESRenderer::MoleculeSESRenderer( void ) : Renderer3DModuleDS (),
         colorTableFileParam( "color::colorTableFilename", "The filename of the color table."),
         offscreenRenderingParam( "offscreenRendering", "Toggle offscreen rendering."),
 		probeRadiusSlot("probeRadius", "The probe radius for the surface computation"),
+        rsUpdateLowerSlot( "rsUpdate::lowerThreshold", "Atom movement above which the RS is updated locally"),
+        rsUpdateUpperSlot( "rsUpdate::upperThreshold", "Atom movement above which the RS is recomputed completely"),
 	    puxelSizeBuffer(512 << 20),
         computeSesPerMolecule(false)
 {
@@ -87,6 +89,11 @@ MoleculeSESRenderer::MoleculeSESRenderer( void ) : Renderer3DModuleDS (),
 	this->probeRadiusSlot.SetParameter(new param::FloatParam(1.4f, 0.1f));
 	this->MakeSlotAvailable(&this->probeRadiusSlot);
 
+    this->rsUpdateLowerSlot.SetParameter( new param::FloatParam( 1.0f, 0.0f));
+    this->MakeSlotAvailable( &this->rsUpdateLowerSlot);
+    this->rsUpdateUpperSlot.SetParameter( new param::FloatParam( 5.0f, 0.0f));
+    this->MakeSlotAvailable( &this->rsUpdateUpperSlot);
+
     // ----- en-/disable postprocessing -----
     this->postprocessing = NONE;
     //this->postprocessing = AMBIENT_OCCLUSION;
@@ -953,31 +960,44 @@ bool MoleculeSESRenderer::Render( Call& call ) {
             unsigned int chainIds;
             if( !this->computeSesPerMolecule ) {
                 this->reducedSurface.push_back( new ReducedSurface(mol, this->probeRadius));
-                this->reducedSurface.back()->ComputeReducedSurface();
             } else {
                 // if no molecule indices are given, compute the SES for all molecules
                 if( this->molIdxList.IsEmpty()) {
                     for( chainIds = 0; chainIds < mol->MoleculeCount(); ++chainIds ) {
                         this->reducedSurface.push_back(
                             new ReducedSurface(chainIds, mol, this->probeRadius) );
-                        this->reducedSurface.back()->ComputeReducedSurface();
                     }
                 } else {
                     // else compute the SES for all selected molecules
                     for( chainIds = 0; chainIds < this->molIdxList.Count(); ++chainIds ) {
                         this->reducedSurface.push_back(
                             new ReducedSurface( atoi( this->molIdxList[chainIds]), mol, this->probeRadius) );
-                        this->reducedSurface.back()->ComputeReducedSurface();
                     }
                 }
             }
+            // the reduced surfaces only share the (read-only) molecular data
+            const int rsCount = static_cast<int>( this->reducedSurface.size());
+#pragma omp parallel for schedule(dynamic)
+            for( int rsIdx = 0; rsIdx < rsCount; ++rsIdx ) {
+                this->reducedSurface[rsIdx]->ComputeReducedSurface();
+            }
             vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_INFO,
                 "%s: RS computed in: %f s\n", this->ClassName(), 
                 ( double( clock() - t) / double( CLOCKS_PER_SEC)));
         }
         // update the data / the RS
+        const float lowerThreshold = this->rsUpdateLowerSlot.Param<param::FloatParam>()->Value();
+        const float upperThreshold = std::max( lowerThreshold,
+            this->rsUpdateUpperSlot.Param<param::FloatParam>()->Value());
+        const int rsCount = static_cast<int>( this->reducedSurface.size());
+        std::vector<char> rsChanged( rsCount, 0);
+#pragma omp parallel for schedule(dynamic)
+        for( int rsIdx = 0; rsIdx < rsCount; ++rsIdx ) {
+            rsChanged[rsIdx] = this->reducedSurface[rsIdx]->UpdateData( lowerThreshold, upperThreshold) ? 1 : 0;
+        }
+        // the raycasting arrays are shared, so they are filled sequentially
         for( cntRS = 0; cntRS < this->reducedSurface.size(); ++cntRS ) {
-            if( this->reducedSurface[cntRS]->UpdateData( 1.0f, 5.0f) ) {
+            if( rsChanged[cntRS] ) {
                 this->ComputeRaycastingArrays( cntRS);
             }
         }
@@ -308,6 +308,10 @@ namespace protein {
         /** Parameter to toggle offscreen rendering */
         megamol::core::param::ParamSlot offscreenRenderingParam;
 		megamol::core::param::ParamSlot probeRadiusSlot;
+        /** atom movement above which the RS is updated locally */
+        megamol::core::param::ParamSlot rsUpdateLowerSlot;
+        /** atom movement above which the RS is recomputed completely */
+        megamol::core::param::ParamSlot rsUpdateUpperSlot;
 
         bool usePuxels;
         bool allowPuxels;
@@ -10,11 +10,13 @@
 #include "PDBLoader.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/StringParam.h"
 #include "vislib/ArrayAllocator.h"
 #include "vislib/sys/Log.h"
 #include "vislib/math/mathfunctions.h"
+#include "vislib/sys/File.h"
 #include "vislib/sys/MemmappedFile.h"
 #include "vislib/SmartPtr.h"
 #include "vislib/types.h"
@@ -22,6 +24,7 @@
 #include "vislib/StringConverter.h"
 #include "vislib/StringTokeniser.h"
 #include "vislib/sys/ASCIIFileBuffer.h"
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include <fstream>
@@ -761,9 +764,11 @@ PDBLoader::PDBLoader(void) : AnimDataModule(),
         calcBBoxPerFrameSlot("calcBBoxPerFrame", "Calculate the bounding box for each frame separately"),
         calcBondsSlot("calculateBonds", "Calculate covalent bonds when loading the file"),
 		recomputeStridePerFrameSlot( "recomputeSTRIDEeachFrame", "If STRIDE is used, should it be recomputed each frame?"),
+        strideToleranceSlot( "strideTolerance", "Recompute STRIDE only if a backbone atom moved further (0 = always)"),
+        binaryCacheSlot( "binaryCache", "Cache the parsed PDB file in a binary file next to it (*.mmcache)"),
         bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
         datahash(0),
-        stride( 0), secStructAvailable( false), numXTCFrames( 0),
+        secStruct(), secStructFrame( 0), secStructAvailable( false), numXTCFrames( 0),
         XTCFrameOffset( 0), xtcFileValid(false) {
 
     this->pdbFilenameSlot << new param::FilePathParam("");
@@ -800,6 +805,12 @@ PDBLoader::PDBLoader(void) : AnimDataModule(),
 	this->recomputeStridePerFrameSlot << new param::BoolParam(false);
 	this->MakeSlotAvailable(&this->recomputeStridePerFrameSlot);
 
+    this->strideToleranceSlot << new param::FloatParam(0.0f, 0.0f);
+    this->MakeSlotAvailable(&this->strideToleranceSlot);
+
+    this->binaryCacheSlot << new param::BoolParam(true);
+    this->MakeSlotAvailable(&this->binaryCacheSlot);
+
     mdd = NULL; // no mdd object
 }
 
@@ -970,15 +981,13 @@ bool PDBLoader::getData( core::Call& call) {
     dc->SetChains( static_cast<unsigned int>(this->chain.Count()),
         (MolecularDataCall::Chain*)this->chain.PeekElements());
 
-    if( (!this->secStructAvailable || this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value() )  && this->strideFlagSlot.Param<param::BoolParam>()->Value() ) {
-        time_t t = clock(); // DEBUG
-        if( this->stride ) delete this->stride;
-        this->stride = new Stride( dc );
-        this->stride->WriteToInterface( dc);
-        this->secStructAvailable = true;
-        Log::DefaultLog.WriteMsg( Log::LEVEL_INFO, "Secondary Structure computed via STRIDE in %f seconds.", ( double( clock() - t) / double( CLOCKS_PER_SEC))); // DEBUG
-    } else if( this->strideFlagSlot.Param<param::BoolParam>()->Value() ) {
-        this->stride->WriteToInterface( dc);
+    if( this->strideFlagSlot.Param<param::BoolParam>()->Value() ) {
+        if( !this->secStructAvailable ||
+                ( this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value() &&
+                  this->secStructFrame != dc->FrameID() ) ) {
+            this->updateSecondaryStructure( dc);
+        }
+        this->writeSecondaryStructure( dc);
     }
 
     // Set the filter array for the molecular data call
@@ -1051,8 +1060,6 @@ void PDBLoader::release(void) {
 	for (int i = 0; i < (int)this->residue.Count(); i++)
         delete residue[i];
     this->residue.Clear();
-
-    delete stride;
 }
 
 
@@ -1093,7 +1100,7 @@ void PDBLoader::loadFrame( view::AnimDataModule::Frame *frame,
           Param<core::param::FilePathParam>()->Value(),
           std::ios::in | std::ios::binary);
 
-        xtcFile.seekg( this->XTCFrameOffset[idx]);
+        xtcFile.seekg( static_cast<std::streamoff>(this->XTCFrameOffset[idx]));
 
         fr->readFrame(&xtcFile);
 
@@ -1105,6 +1112,117 @@ void PDBLoader::loadFrame( view::AnimDataModule::Frame *frame,
     //( double( clock() - t) / double( CLOCKS_PER_SEC) )); // DEBUG
 }
 
+static const char PDBCacheMagic[8] = { 'M', 'M', 'P', 'D', 'B', 'C', 'A', 'C' };
+static const UINT32 PDBCacheVersion = 1;
+
+/*
+ * Continue the FNV-1a hash of a byte range.
+ */
+static UINT64 hashBytes( const void *buf, SIZE_T size,
+        UINT64 hash = 14695981039346656037ULL) {
+    const unsigned char *bytes = static_cast<const unsigned char*>( buf);
+    for( SIZE_T i = 0; i < size; ++i ) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * Compute the size and the hash of the contents of a file.
+ */
+static bool hashFile( const vislib::TString& filename, UINT64& outSize,
+        UINT64& outHash) {
+    vislib::sys::File file;
+    if( !file.Open( filename.PeekBuffer(), vislib::sys::File::READ_ONLY,
+            vislib::sys::File::SHARE_READ, vislib::sys::File::OPEN_ONLY) ) {
+        return false;
+    }
+    std::vector<char> buf( 1 << 20);
+    vislib::sys::File::FileSize cnt;
+    outSize = 0;
+    outHash = hashBytes( NULL, 0);
+    while( ( cnt = file.Read( buf.data(), buf.size())) > 0 ) {
+        outHash = hashBytes( buf.data(), static_cast<SIZE_T>( cnt), outHash);
+        outSize += cnt;
+    }
+    file.Close();
+    return true;
+}
+
+/*
+ * Write values and arrays of plain values to the PDB cache.
+ */
+template<class T>
+static void putCache( std::fstream& file, const T& val) {
+    file.write( reinterpret_cast<const char*>( &val), sizeof(T));
+}
+
+template<class T>
+static void putCache( std::fstream& file, const vislib::Array<T>& arr) {
+    const UINT64 cnt = arr.Count();
+    putCache( file, cnt);
+    if( cnt > 0 ) {
+        file.write( reinterpret_cast<const char*>( arr.PeekElements()),
+            cnt * sizeof(T));
+    }
+}
+
+static void putCache( std::fstream& file, const vislib::StringA& str) {
+    putCache( file, static_cast<UINT32>( str.Length()));
+    file.write( str.PeekBuffer(), str.Length());
+}
+
+static void putCache( std::fstream& file,
+        const vislib::math::Cuboid<float>& box) {
+    const float b[6] = { box.Left(), box.Bottom(), box.Back(),
+        box.Right(), box.Top(), box.Front() };
+    putCache( file, b);
+}
+
+/*
+ * Read values and arrays of plain values from the PDB cache.
+ */
+template<class T>
+static bool getCache( vislib::sys::File& file, T& val) {
+    return file.Read( &val, sizeof(T)) == sizeof(T);
+}
+
+template<class T>
+static bool getCache( vislib::sys::File& file, vislib::Array<T>& arr) {
+    UINT64 cnt = 0;
+    if( !getCache( file, cnt)
+            || cnt * sizeof(T) > file.GetSize() - file.Tell() ) {
+        return false;
+    }
+    arr.SetCount( static_cast<SIZE_T>( cnt));
+    return ( cnt == 0 )
+        || ( file.Read( &arr.First(), cnt * sizeof(T)) == cnt * sizeof(T));
+}
+
+static bool getCache( vislib::sys::File& file, vislib::StringA& str) {
+    UINT32 len = 0;
+    if( !getCache( file, len) || len > file.GetSize() - file.Tell() ) {
+        return false;
+    }
+    std::vector<char> buf( len + 1, 0);
+    if( len > 0 && file.Read( buf.data(), len) != len ) {
+        return false;
+    }
+    str = buf.data();
+    return true;
+}
+
+static bool getCache( vislib::sys::File& file,
+        vislib::math::Cuboid<float>& box) {
+    float b[6];
+    if( !getCache( file, b) ) {
+        return false;
+    }
+    box.Set( b[0], b[1], b[2], b[3], b[4], b[5]);
+    return true;
+}
+
 /*
  * PDBLoader::loadFile
  */
@@ -1128,6 +1246,20 @@ void PDBLoader::loadFile( const vislib::TString& filename) {
 
     time_t t = clock(); // DEBUG
 
+    // the cache is keyed by the contents of the file, not by its name
+    UINT64 pdbSize = 0;
+    UINT64 pdbHash = 0;
+    bool useCache = this->binaryCacheSlot.Param<param::BoolParam>()->Value()
+        && hashFile( filename, pdbSize, pdbHash);
+    if( useCache && this->readPDBCache( filename, pdbSize, pdbHash) ) {
+        Log::DefaultLog.WriteMsg( Log::LEVEL_INFO, "Loaded PDB cache for %s (%f s)",
+            T2A( filename.PeekBuffer()), ( double( clock() - t) / double( CLOCKS_PER_SEC) ));
+        if( !this->xtcFilenameSlot.Param<core::param::FilePathParam>()->Value().IsEmpty() ) {
+            this->openXTCFile( static_cast<unsigned int>( this->atomTypeIdx.Count()));
+        }
+        return;
+    }
+
     vislib::StringA line;
     unsigned int idx, atomCnt, lineCnt, frameCnt, resCnt, chainCnt;
 
@@ -1421,69 +1553,84 @@ void PDBLoader::loadFile( const vislib::TString& filename) {
             // DEBUG
             writeToXtcFile(vislib::TString("data.xtc"));
 
+            if( useCache ) {
+                this->writePDBCache( filename, pdbSize, pdbHash);
+            }
         }
         else {
-            // try to get the total number of frames and calculate the
-            // bounding box
-            this->readNumXTCFrames();
-
-            Log::DefaultLog.WriteMsg( Log::LEVEL_INFO,
-                "Number of XTC-frames: %u", this->numXTCFrames); // DEBUG
-
-            //float box[3][3];
-            char tmpByte;
-            std::fstream xtcFile;
-            char *num;
-            unsigned int nAtoms;
-
-            // try to open the xtc-file
-            xtcFile.open(this->xtcFilenameSlot.
-                           Param<core::param::FilePathParam>()->Value(),
-                           std::ios::in | std::ios::binary);
-
-            if( !xtcFile) {
-                Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
-                  "Could not load XTC-file."); // DEBUG
-                xtcFileValid = false;
+            if( useCache ) {
+                this->writePDBCache( filename, pdbSize, pdbHash);
             }
-            else {
+            this->openXTCFile( static_cast<unsigned int>( atomEntries.Count()));
+        }
+}
 
+/*
+ * Open the XTC file and start loading its frames.
+ */
+void PDBLoader::openXTCFile( unsigned int atomCnt) {
+    using vislib::sys::Log;
 
-                xtcFile.seekg(4, std::ios_base::cur);
-                // read number of atoms
-                xtcFile.read((char*)&nAtoms, 4);
-                // change byte order
-                num = (char*)&nAtoms;
-                tmpByte = num[0]; num[0] = num[3]; num[3] = tmpByte;
-                tmpByte = num[1]; num[1] = num[2]; num[2] = tmpByte;
-
-                // check whether the pdb-file and the xtc-file contain the
-                // same number of atoms
-                if( nAtoms != atomEntries.Count() ) {
-                    Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
-                      "XTC-File and given PDB-file not matching (XTC-file has"
-                      "%i atom entries, PDB-file has %i atom entries).",
-                         nAtoms, atomEntries.Count()); // DEBUG
-                    xtcFileValid = false;
-                    xtcFile.close();
-                }
-                else {
-                    xtcFile.close();
+    // try to get the total number of frames and calculate the
+    // bounding box
+    this->readNumXTCFrames();
 
-                    xtcFileValid = true;
+    Log::DefaultLog.WriteMsg( Log::LEVEL_INFO,
+        "Number of XTC-frames: %u", this->numXTCFrames); // DEBUG
 
-                    int maxFrames = vislib::math::Min<int>(
-                        this->maxFramesSlot.Param<core::param::IntParam>()->Value(),
-                        static_cast<int>(this->numXTCFrames));
+    //float box[3][3];
+    char tmpByte;
+    std::fstream xtcFile;
+    char *num;
+    unsigned int nAtoms;
 
-                    // frames in xtc-file - 1 (without the last frame)
-                    this->setFrameCount( this->numXTCFrames);
+    // try to open the xtc-file
+    xtcFile.open(this->xtcFilenameSlot.
+                   Param<core::param::FilePathParam>()->Value(),
+                   std::ios::in | std::ios::binary);
 
-                    // start the loading thread
-                    this->initFrameCache( maxFrames);
-                }
-            }
+    if( !xtcFile) {
+        Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
+          "Could not load XTC-file."); // DEBUG
+        xtcFileValid = false;
+    }
+    else {
+
+
+        xtcFile.seekg(4, std::ios_base::cur);
+        // read number of atoms
+        xtcFile.read((char*)&nAtoms, 4);
+        // change byte order
+        num = (char*)&nAtoms;
+        tmpByte = num[0]; num[0] = num[3]; num[3] = tmpByte;
+        tmpByte = num[1]; num[1] = num[2]; num[2] = tmpByte;
+
+        // check whether the pdb-file and the xtc-file contain the
+        // same number of atoms
+        if( nAtoms != atomCnt ) {
+            Log::DefaultLog.WriteMsg( Log::LEVEL_ERROR,
+              "XTC-File and given PDB-file not matching (XTC-file has"
+              "%i atom entries, PDB-file has %i atom entries).",
+                 nAtoms, atomCnt); // DEBUG
+            xtcFileValid = false;
+            xtcFile.close();
         }
+        else {
+            xtcFile.close();
+
+            xtcFileValid = true;
+
+            int maxFrames = vislib::math::Min<int>(
+                this->maxFramesSlot.Param<core::param::IntParam>()->Value(),
+                static_cast<int>(this->numXTCFrames));
+
+            // frames in xtc-file - 1 (without the last frame)
+            this->setFrameCount( this->numXTCFrames);
+
+            // start the loading thread
+            this->initFrameCache( maxFrames);
+        }
+    }
 }
 
 /*
@@ -2071,8 +2218,9 @@ void PDBLoader::resetAllData() {
     this->molecule.Clear();
     this->chain.Clear();
     this->connectivity.Clear();
-    delete stride;
-    this->stride = 0;
+    this->secStruct.reset();
+    this->backboneAtoms.clear();
+    this->backbonePos.clear();
     secStructAvailable = false;
     this->chainFirstRes.Clear();
     this->chainResCount.Clear();
@@ -2125,6 +2273,20 @@ bool PDBLoader::readNumXTCFrames() {
     this->numXTCFrames = 0;
     this->XTCFrameOffset.Clear();
 
+    // the bounding box of all frames, without the one of the PDB-file
+    vislib::math::Cuboid<float> xtcBBox;
+    bool xtcBBoxValid = false;
+
+    // scanning all frame headers of a long trajectory takes a while, so
+    // the result is kept next to the xtc file
+    if( this->readXTCIndex( xtcBBox) ) {
+        if( this->numXTCFrames > 0 ) this->bbox.Union( xtcBBox);
+        vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_INFO,
+            "Time for reading the XTC index: %f",
+            ( double( clock() - t) / double( CLOCKS_PER_SEC) )); // DEBUG
+        return true;
+    }
+
     // try to open xtc file
     std::fstream xtcFile;
     xtcFile.open(this->xtcFilenameSlot.
@@ -2148,19 +2310,19 @@ bool PDBLoader::readNumXTCFrames() {
 
     xtcFile.seekg(0, std::ios_base::beg);
 
-    vislib::math::Cuboid<float> tmpBBox( this->bbox);
+    vislib::math::Cuboid<float> tmpBBox;
 
     //std::fstream::iostate st = 0;
 
     // get length of file:
     xtcFile.seekg(0, xtcFile.end);
-    int xtcFileLength = (int)xtcFile.tellg();
+    std::streamoff xtcFileLength = xtcFile.tellg();
     xtcFile.seekg (0, xtcFile.beg);
 
     // read until eof
     while( !xtcFile.eof() && xtcFile.tellg() < xtcFileLength ) {
         // add the offset to the offset array
-        this->XTCFrameOffset.Add( (unsigned int)xtcFile.tellg());
+        this->XTCFrameOffset.Add( static_cast<UINT64>(xtcFile.tellg()));
 
         // skip some header data
         xtcFile.seekg(56, std::ios_base::cur);
@@ -2187,7 +2349,14 @@ bool PDBLoader::readNumXTCFrames() {
         }
 
         // update the bounding box by uniting it with the last frames box
-        this->bbox.Union(tmpBBox);
+        if( this->numXTCFrames > 0 ) {
+            if( xtcBBoxValid ) {
+                xtcBBox.Union(tmpBBox);
+            } else {
+                xtcBBox = tmpBBox;
+                xtcBBoxValid = true;
+            }
+        }
         // get the current frames bounding box including the atom radius
         // note: atom radius is divided by 10
         tmpBBox = vislib::math::Cuboid<float>(
@@ -2226,13 +2395,536 @@ bool PDBLoader::readNumXTCFrames() {
     this->XTCFrameOffset.RemoveLast();
     this->numXTCFrames--;
 
+    if( xtcBBoxValid ) this->bbox.Union(xtcBBox);
+
     vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_INFO,
     "Time for parsing the XTC-file: %f",
     ( double( clock() - t) / double( CLOCKS_PER_SEC) )); // DEBUG
 
+    this->writeXTCIndex( xtcBBox);
+
+    return true;
+}
+
+/*
+ * Layout of the index file: magic, version, size of the xtc file, number of
+ * frames, bounding box (left, bottom, back, right, top, front) and the byte
+ * offset of each frame, all in native byte order.
+ */
+static const char XTCIndexMagic[8] = { 'M', 'M', 'X', 'T', 'C', 'I', 'D', 'X' };
+static const UINT32 XTCIndexVersion = 1;
+
+/*
+ * Read the frame offsets and the bounding box from the index file.
+ */
+bool PDBLoader::readXTCIndex( vislib::math::Cuboid<float>& xtcBBox) {
+    const vislib::TString& xtcName =
+        this->xtcFilenameSlot.Param<core::param::FilePathParam>()->Value();
+    vislib::TString idxName( xtcName);
+    idxName.Append( _T(".mmidx"));
+
+    std::fstream idxFile;
+    idxFile.open( idxName, std::ios::in | std::ios::binary);
+    if( !idxFile ) return false;
+
+    char magic[8];
+    UINT32 version = 0;
+    UINT64 xtcSize = 0;
+    UINT32 frames = 0;
+    float box[6];
+    idxFile.read( magic, sizeof(magic));
+    idxFile.read( (char*)&version, sizeof(version));
+    idxFile.read( (char*)&xtcSize, sizeof(xtcSize));
+    idxFile.read( (char*)&frames, sizeof(frames));
+    idxFile.read( (char*)box, sizeof(box));
+    if( !idxFile || memcmp( magic, XTCIndexMagic, sizeof(magic)) != 0
+            || version != XTCIndexVersion
+            || xtcSize != vislib::sys::File::GetSize( xtcName) ) {
+        return false;
+    }
+
+    this->XTCFrameOffset.SetCount( frames);
+    if( frames > 0 ) {
+        idxFile.read( (char*)&this->XTCFrameOffset.First(),
+            frames * sizeof(UINT64));
+        if( !idxFile ) {
+            this->XTCFrameOffset.Clear();
+            return false;
+        }
+    }
+    idxFile.close();
+
+    // a rewritten trajectory of the same size still needs a rescan, check
+    // that the last frame starts where the index says (magic number 1995)
+    if( frames > 0 ) {
+        std::fstream xtcFile;
+        xtcFile.open( xtcName, std::ios::in | std::ios::binary);
+        unsigned char xtcMagic[4] = { 0, 0, 0, 0 };
+        xtcFile.seekg( static_cast<std::streamoff>(
+            this->XTCFrameOffset[frames - 1]));
+        xtcFile.read( (char*)xtcMagic, 4);
+        if( !xtcFile || xtcMagic[0] != 0 || xtcMagic[1] != 0
+                || xtcMagic[2] != 0x07 || xtcMagic[3] != 0xcb ) {
+            this->XTCFrameOffset.Clear();
+            return false;
+        }
+    }
+
+    this->numXTCFrames = frames;
+    xtcBBox.Set( box[0], box[1], box[2], box[3], box[4], box[5]);
+    return true;
+}
+
+/*
+ * Write the frame offsets and the bounding box to the index file.
+ */
+void PDBLoader::writeXTCIndex( const vislib::math::Cuboid<float>& xtcBBox) {
+    const vislib::TString& xtcName =
+        this->xtcFilenameSlot.Param<core::param::FilePathParam>()->Value();
+    vislib::TString idxName( xtcName);
+    idxName.Append( _T(".mmidx"));
+
+    std::fstream idxFile;
+    idxFile.open( idxName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !idxFile ) {
+        // directory not writable, the trajectory is scanned next time again
+        vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_INFO,
+            "Could not write XTC index file.");
+        return;
+    }
+
+    const UINT64 xtcSize = vislib::sys::File::GetSize( xtcName);
+    const UINT32 frames = this->numXTCFrames;
+    const float box[6] = { xtcBBox.Left(), xtcBBox.Bottom(), xtcBBox.Back(),
+        xtcBBox.Right(), xtcBBox.Top(), xtcBBox.Front() };
+    idxFile.write( XTCIndexMagic, sizeof(XTCIndexMagic));
+    idxFile.write( (const char*)&XTCIndexVersion, sizeof(XTCIndexVersion));
+    idxFile.write( (const char*)&xtcSize, sizeof(xtcSize));
+    idxFile.write( (const char*)&frames, sizeof(frames));
+    idxFile.write( (const char*)box, sizeof(box));
+    if( frames > 0 ) {
+        idxFile.write( (const char*)this->XTCFrameOffset.PeekElements(),
+            frames * sizeof(UINT64));
+    }
+    if( !idxFile ) {
+        idxFile.close();
+        vislib::sys::File::Delete( idxName);
+    }
+}
+
+/*
+ * Answer the hash of all loading options that change the parsed data.
+ */
+UINT64 PDBLoader::pdbCacheOptions( bool allFrames) {
+    vislib::StringA solvent( T2A(
+        this->solventResidues.Param<core::param::StringParam>()->Value()));
+    const UINT32 opts[4] = {
+        static_cast<UINT32>( solvent.Length()),
+        this->calcBondsSlot.Param<param::BoolParam>()->Value() ? 1u : 0u,
+        allFrames ? 1u : 0u,
+        allFrames ? static_cast<UINT32>(
+            this->maxFramesSlot.Param<param::IntParam>()->Value()) : 0u };
+    UINT64 hash = hashBytes( opts, sizeof(opts));
+    hash = hashBytes( solvent.PeekBuffer(), solvent.Length(), hash);
+    for( SIZE_T i = 0; i < this->cap_chain.Count(); ++i ) {
+        const INT32 cap[2] = { this->cap_chain[i].first,
+            this->cap_chain[i].second };
+        hash = hashBytes( cap, sizeof(cap), hash);
+    }
+    return hash;
+}
+
+/*
+ * Load the parsed data from the binary cache next to the PDB file.
+ */
+bool PDBLoader::readPDBCache( const vislib::TString& filename,
+        UINT64 pdbSize, UINT64 pdbHash) {
+    vislib::TString cacheName( filename);
+    cacheName.Append( _T(".mmcache"));
+
+    vislib::sys::MemmappedFile file;
+    if( !file.Open( cacheName.PeekBuffer(), vislib::sys::File::READ_ONLY,
+            vislib::sys::File::SHARE_READ, vislib::sys::File::OPEN_ONLY) ) {
+        return false;
+    }
+
+    // a cache written for other options or without all PDB frames is useless
+    const bool allFrames = this->xtcFilenameSlot.
+        Param<core::param::FilePathParam>()->Value().IsEmpty();
+    char magic[8];
+    UINT32 version = 0;
+    UINT64 size = 0, hash = 0, options = 0;
+    bool ok = ( file.Read( magic, sizeof(magic)) == sizeof(magic) )
+        && ( memcmp( magic, PDBCacheMagic, sizeof(magic)) == 0 )
+        && getCache( file, version) && ( version == PDBCacheVersion )
+        && getCache( file, size) && ( size == pdbSize )
+        && getCache( file, hash) && ( hash == pdbHash )
+        && getCache( file, options)
+        && ( options == this->pdbCacheOptions( allFrames) );
+    if( !ok ) {
+        file.Close();
+        return false;
+    }
+
+    // atoms
+    UINT32 typeCnt = 0;
+    ok = getCache( file, typeCnt);
+    for( UINT32 i = 0; ok && i < typeCnt; ++i ) {
+        vislib::StringA name, element;
+        float rad = 0.0f;
+        unsigned char col[3];
+        ok = getCache( file, name) && getCache( file, rad)
+            && getCache( file, col) && getCache( file, element);
+        if( ok ) {
+            this->atomType.Add( MolecularDataCall::AtomType( name, rad,
+                col[0], col[1], col[2], element));
+        }
+    }
+    ok = ok && getCache( file, this->atomTypeIdx)
+        && getCache( file, this->atomFormerIdx)
+        && getCache( file, this->atomResidueIdx);
+    const unsigned int atomCnt =
+        static_cast<unsigned int>( this->atomTypeIdx.Count());
+    ok = ok && ( this->atomFormerIdx.Count() == atomCnt )
+        && ( this->atomResidueIdx.Count() == atomCnt );
+
+    // residues: amino acid flag, first atom, atom count, type, molecule,
+    // original index and for amino acids the CA, C, N and O atoms
+    UINT32 resCnt = 0;
+    ok = ok && getCache( file, resCnt);
+    for( UINT32 i = 0; ok && i < resCnt; ++i ) {
+        UINT32 res[10];
+        vislib::math::Cuboid<float> resBBox;
+        ok = getCache( file, res) && getCache( file, resBBox);
+        if( !ok ) break;
+        if( res[0] != 0 ) {
+            this->residue.Add( new MolecularDataCall::AminoAcid( res[1], res[2],
+                res[6], res[7], res[8], res[9], resBBox, res[3],
+                static_cast<int>( res[4]), res[5]));
+        } else {
+            this->residue.Add( new MolecularDataCall::Residue( res[1], res[2],
+                resBBox, res[3], static_cast<int>( res[4]), res[5]));
+        }
+    }
+    UINT32 nameCnt = 0;
+    ok = ok && getCache( file, nameCnt);
+    if( ok ) {
+        this->residueTypeName.Clear();
+    }
+    for( UINT32 i = 0; ok && i < nameCnt; ++i ) {
+        vislib::StringA name;
+        ok = getCache( file, name);
+        this->residueTypeName.Add( name);
+    }
+    ok = ok && getCache( file, this->solventResidueIdx);
+
+    // molecules: first residue, residue count, chain, first connection and
+    // connection count; chains: first molecule, molecule count and type
+    UINT32 molCnt = 0;
+    ok = ok && getCache( file, molCnt);
+    for( UINT32 i = 0; ok && i < molCnt; ++i ) {
+        UINT32 mol[5];
+        ok = getCache( file, mol);
+        if( !ok ) break;
+        this->molecule.Add( MolecularDataCall::Molecule( mol[0], mol[1],
+            static_cast<int>( mol[2])));
+        this->molecule.Last().SetConnectionRange( mol[3], mol[4]);
+    }
+    UINT32 chainCnt = 0;
+    ok = ok && getCache( file, chainCnt);
+    for( UINT32 i = 0; ok && i < chainCnt; ++i ) {
+        UINT32 ch[3];
+        char name = ' ';
+        ok = getCache( file, ch) && getCache( file, name);
+        if( !ok ) break;
+        this->chain.Add( MolecularDataCall::Chain( ch[0], ch[1], name,
+            static_cast<MolecularDataCall::Chain::ChainType>( ch[2])));
+    }
+    ok = ok && getCache( file, this->connectivity);
+
+    // frames
+    UINT32 frameCnt = 0;
+    ok = ok && getCache( file, this->bbox)
+        && getCache( file, this->bboxPerFrame)
+        && getCache( file, frameCnt) && ( frameCnt > 0 );
+    vislib::Array<float> pos, bfactor, charge, occupancy;
+    for( UINT32 f = 0; ok && f < frameCnt; ++f ) {
+        float range[6];
+        ok = getCache( file, pos) && getCache( file, bfactor)
+            && getCache( file, charge) && getCache( file, occupancy)
+            && getCache( file, range) && ( pos.Count() == 3 * atomCnt )
+            && ( bfactor.Count() == atomCnt ) && ( charge.Count() == atomCnt )
+            && ( occupancy.Count() == atomCnt );
+        if( !ok ) break;
+        Frame *frame = new Frame( *const_cast<PDBLoader*>( this));
+        frame->SetAtomCount( atomCnt);
+        frame->setFrameIdx( static_cast<int>( f));
+        for( unsigned int a = 0; a < atomCnt; ++a ) {
+            frame->SetAtomPosition( a, pos[3 * a], pos[3 * a + 1], pos[3 * a + 2]);
+            frame->SetAtomBFactor( a, bfactor[a]);
+            frame->SetAtomCharge( a, charge[a]);
+            frame->SetAtomOccupancy( a, occupancy[a]);
+        }
+        frame->SetBFactorRange( range[0], range[1]);
+        frame->SetChargeRange( range[2], range[3]);
+        frame->SetOccupancyRange( range[4], range[5]);
+        this->data.Add( frame);
+    }
+    file.Close();
+
+    if( !ok ) {
+        // discard what was read, the PDB file is parsed instead
+        vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_WARN,
+            "PDB cache file %s is corrupt.", T2A( cacheName.PeekBuffer()));
+        for( SIZE_T i = 0; i < this->data.Count(); ++i ) {
+            delete this->data[i];
+        }
+        this->data.Clear();
+        this->bboxPerFrame.Clear();
+        this->resetAllData();
+        return false;
+    }
+
+    this->atomVisibility.SetCount( atomCnt);
+    for( unsigned int a = 0; a < atomCnt; ++a ) {
+        this->atomVisibility[a] = 1;
+    }
     return true;
 }
 
+/*
+ * Write the parsed data to the binary cache next to the PDB file.
+ */
+void PDBLoader::writePDBCache( const vislib::TString& filename,
+        UINT64 pdbSize, UINT64 pdbHash) {
+    vislib::TString cacheName( filename);
+    cacheName.Append( _T(".mmcache"));
+
+    std::fstream file;
+    file.open( cacheName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !file ) {
+        // directory not writable, the PDB file is parsed next time again
+        vislib::sys::Log::DefaultLog.WriteMsg( vislib::sys::Log::LEVEL_INFO,
+            "Could not write PDB cache file.");
+        return;
+    }
+
+    const bool allFrames = this->xtcFilenameSlot.
+        Param<core::param::FilePathParam>()->Value().IsEmpty();
+    file.write( PDBCacheMagic, sizeof(PDBCacheMagic));
+    putCache( file, PDBCacheVersion);
+    putCache( file, pdbSize);
+    putCache( file, pdbHash);
+    putCache( file, this->pdbCacheOptions( allFrames));
+
+    // atoms
+    putCache( file, static_cast<UINT32>( this->atomType.Count()));
+    for( SIZE_T i = 0; i < this->atomType.Count(); ++i ) {
+        putCache( file, this->atomType[i].Name());
+        putCache( file, this->atomType[i].Radius());
+        file.write( reinterpret_cast<const char*>(
+            this->atomType[i].Colour()), 3);
+        putCache( file, this->atomType[i].Element());
+    }
+    putCache( file, this->atomTypeIdx);
+    putCache( file, this->atomFormerIdx);
+    putCache( file, this->atomResidueIdx);
+
+    // residues
+    putCache( file, static_cast<UINT32>( this->residue.Count()));
+    for( SIZE_T i = 0; i < this->residue.Count(); ++i ) {
+        const MolecularDataCall::Residue *r = this->residue[i];
+        UINT32 res[10] = { 0, r->FirstAtomIndex(), r->AtomCount(), r->Type(),
+            static_cast<UINT32>( r->MoleculeIndex()), r->OriginalResIndex(),
+            0, 0, 0, 0 };
+        if( r->Identifier() == MolecularDataCall::Residue::AMINOACID ) {
+            const MolecularDataCall::AminoAcid *aa =
+                static_cast<const MolecularDataCall::AminoAcid*>( r);
+            res[0] = 1;
+            res[6] = aa->CAlphaIndex();
+            res[7] = aa->CCarbIndex();
+            res[8] = aa->NIndex();
+            res[9] = aa->OIndex();
+        }
+        putCache( file, res);
+        putCache( file, r->BoundingBox());
+    }
+    putCache( file, static_cast<UINT32>( this->residueTypeName.Count()));
+    for( SIZE_T i = 0; i < this->residueTypeName.Count(); ++i ) {
+        putCache( file, this->residueTypeName[i]);
+    }
+    putCache( file, this->solventResidueIdx);
+
+    // molecules and chains
+    putCache( file, static_cast<UINT32>( this->molecule.Count()));
+    for( SIZE_T i = 0; i < this->molecule.Count(); ++i ) {
+        const MolecularDataCall::Molecule& m = this->molecule[i];
+        const UINT32 mol[5] = { m.FirstResidueIndex(), m.ResidueCount(),
+            static_cast<UINT32>( m.ChainIndex()), m.FirstConnectionIndex(),
+            m.ConnectionCount() };
+        putCache( file, mol);
+    }
+    putCache( file, static_cast<UINT32>( this->chain.Count()));
+    for( SIZE_T i = 0; i < this->chain.Count(); ++i ) {
+        const MolecularDataCall::Chain& c = this->chain[i];
+        const UINT32 ch[3] = { c.FirstMoleculeIndex(), c.MoleculeCount(),
+            static_cast<UINT32>( c.Type()) };
+        putCache( file, ch);
+        putCache( file, c.Name());
+    }
+    putCache( file, this->connectivity);
+
+    // frames
+    putCache( file, this->bbox);
+    putCache( file, this->bboxPerFrame);
+    putCache( file, static_cast<UINT32>( this->data.Count()));
+    vislib::Array<float> values;
+    for( SIZE_T f = 0; f < this->data.Count(); ++f ) {
+        Frame *frame = this->data[f];
+        const SIZE_T atomCnt = frame->AtomCount();
+        values.SetCount( 3 * atomCnt);
+        if( atomCnt > 0 ) {
+            memcpy( &values.First(), frame->AtomPositions(),
+                3 * atomCnt * sizeof(float));
+        }
+        putCache( file, values);
+        values.SetCount( atomCnt);
+        const float *src[3] = { frame->AtomBFactor(), frame->AtomCharge(),
+            frame->AtomOccupancy() };
+        for( unsigned int j = 0; j < 3; ++j ) {
+            if( atomCnt > 0 ) {
+                memcpy( &values.First(), src[j], atomCnt * sizeof(float));
+            }
+            putCache( file, values);
+        }
+        const float range[6] = { frame->MinBFactor(), frame->MaxBFactor(),
+            frame->MinCharge(), frame->MaxCharge(),
+            frame->MinOccupancy(), frame->MaxOccupancy() };
+        putCache( file, range);
+    }
+
+    if( !file ) {
+        file.close();
+        vislib::sys::File::Delete( cacheName);
+    }
+}
+
+/*
+ * Compute the secondary structure of the current frame.
+ */
+void PDBLoader::updateSecondaryStructure( MolecularDataCall *dc) {
+    using vislib::sys::Log;
+    using core::utility::ResultCache;
+
+    const unsigned int frameID = dc->FrameID();
+    const float *pos = dc->AtomPositions();
+    this->secStructFrame = frameID;
+
+    if( this->backboneAtoms.empty() ) {
+        for( unsigned int i = 0; i < dc->AtomCount(); ++i ) {
+            const vislib::StringA& name = dc->AtomTypes()[dc->AtomTypeIndices()[i]].Name();
+            if( name.Equals( "N") || name.Equals( "CA") || name.Equals( "C") || name.Equals( "O") ) {
+                this->backboneAtoms.push_back( i);
+            }
+        }
+    }
+
+    // thermal motion rarely changes the assignment, so keep the last one
+    // as long as no backbone atom moved further than the tolerance
+    const float tolerance = this->strideToleranceSlot.Param<param::FloatParam>()->Value();
+    if( this->secStructAvailable && tolerance > 0.0f &&
+            this->backbonePos.size() == 3 * this->backboneAtoms.size() ) {
+        const float sqTolerance = tolerance * tolerance;
+        bool moved = false;
+        for( size_t i = 0; i < this->backboneAtoms.size() && !moved; ++i ) {
+            const float *p = pos + 3 * this->backboneAtoms[i];
+            const float *q = this->backbonePos.data() + 3 * i;
+            const float dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+            moved = ( dx * dx + dy * dy + dz * dz > sqTolerance );
+        }
+        if( !moved ) return;
+    }
+
+    this->backbonePos.resize( 3 * this->backboneAtoms.size());
+    for( size_t i = 0; i < this->backboneAtoms.size(); ++i ) {
+        memcpy( this->backbonePos.data() + 3 * i, pos + 3 * this->backboneAtoms[i], 3 * sizeof(float));
+    }
+    this->secStructAvailable = true;
+
+    // scrubbing back and forth in a trajectory revisits frames
+    auto& cache = ResultCache::Instance();
+    const bool cached = ( this->datahash != 0 ) &&
+        this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value();
+    const ResultCache::key_type key = ResultCache::MakeKey( this->FullName(), this->datahash, frameID, {});
+    if( cached ) {
+        ResultCache::value_type hit = cache.Find( key);
+        if( hit ) {
+            this->secStruct = hit;
+            return;
+        }
+    }
+
+    time_t t = clock(); // DEBUG
+    std::vector<UINT32> words;
+    {
+        Stride stride( dc);
+        if( stride.WriteToInterface( dc) ) {
+            words.push_back( 1);
+            words.push_back( dc->SecondaryStructureCount());
+            for( unsigned int i = 0; i < dc->SecondaryStructureCount(); ++i ) {
+                const MolecularDataCall::SecStructure& sec = dc->SecondaryStructures()[i];
+                words.push_back( sec.FirstAminoAcidIndex());
+                words.push_back( sec.AminoAcidCount());
+                words.push_back( static_cast<UINT32>(sec.Type()));
+            }
+            words.push_back( dc->MoleculeCount());
+            for( unsigned int i = 0; i < dc->MoleculeCount(); ++i ) {
+                words.push_back( dc->Molecules()[i].FirstSecStructIndex());
+                words.push_back( dc->Molecules()[i].SecStructCount());
+            }
+            // the bonds belong to the Stride object, so they are copied
+            words.push_back( dc->HydrogenBondCount());
+            words.insert( words.end(), dc->GetHydrogenBonds(),
+                dc->GetHydrogenBonds() + 2 * dc->HydrogenBondCount());
+        } else {
+            words.push_back( 0);
+        }
+        dc->SetHydrogenBonds( NULL, 0);
+    }
+    Log::DefaultLog.WriteMsg( Log::LEVEL_INFO, "Secondary Structure computed via STRIDE in %f seconds.", ( double( clock() - t) / double( CLOCKS_PER_SEC))); // DEBUG
+
+    std::vector<unsigned char> bytes( reinterpret_cast<const unsigned char*>(words.data()),
+        reinterpret_cast<const unsigned char*>(words.data() + words.size()));
+    this->secStruct = std::make_shared<const std::vector<unsigned char>>( bytes);
+    if( cached ) cache.Store( key, std::move( bytes));
+}
+
+/*
+ * Set the current secondary structure to the call.
+ */
+void PDBLoader::writeSecondaryStructure( MolecularDataCall *dc) {
+    if( !this->secStruct || this->secStruct->empty() ) return;
+
+    const UINT32 *w = reinterpret_cast<const UINT32*>(this->secStruct->data());
+    size_t i = 0;
+    if( w[i++] == 0 ) return; // STRIDE found no secondary structure
+
+    const UINT32 secCnt = w[i++];
+    dc->SetSecondaryStructureCount( secCnt);
+    for( UINT32 s = 0; s < secCnt; ++s, i += 3 ) {
+        MolecularDataCall::SecStructure sec;
+        sec.SetPosition( w[i], w[i + 1]);
+        sec.SetType( static_cast<MolecularDataCall::SecStructure::ElementType>(w[i + 2]));
+        dc->SetSecondaryStructure( s, sec);
+    }
+    const UINT32 molCnt = w[i++];
+    for( UINT32 m = 0; m < molCnt; ++m, i += 2 ) {
+        dc->SetMoleculeSecondaryStructure( m, w[i], w[i + 1]);
+    }
+    const UINT32 hbCnt = w[i++];
+    dc->SetHydrogenBonds( ( hbCnt > 0 ) ? w + i : NULL, hbCnt);
+}
+
 /*
  * Write all frames except for the first one from the currently loaded PDB-file
  * into a new XTC-file.
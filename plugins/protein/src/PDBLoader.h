@@ -22,6 +22,7 @@
 #include "ForceDataCall.h"
 #include "Stride.h"
 #include "mmcore/view/AnimDataModule.h"
+#include "mmcore/utility/ResultCache.h"
 #include "MDDriverConnector.h"
 #include <fstream>
 #include "MultiPDBLoader.h"
@@ -616,6 +617,82 @@ namespace protein {
          */
         bool readNumXTCFrames();
 
+        /**
+         * Read the frame offsets and the bounding box of the XTC file from
+         * the index file next to it, if it belongs to the current XTC file.
+         *
+         * @param xtcBBox Receives the bounding box of all frames
+         *
+         * @return 'true' if the index could be used, otherwise 'false'
+         */
+        bool readXTCIndex(vislib::math::Cuboid<float>& xtcBBox);
+
+        /**
+         * Write the frame offsets and the bounding box of the XTC file to
+         * the index file next to it.
+         *
+         * @param xtcBBox The bounding box of all frames
+         */
+        void writeXTCIndex(const vislib::math::Cuboid<float>& xtcBBox);
+
+        /**
+         * Open the XTC file, check it against the loaded PDB data and start
+         * loading its frames.
+         *
+         * @param atomCnt The number of atoms of the PDB data
+         */
+        void openXTCFile( unsigned int atomCnt);
+
+        /**
+         * Answer the hash of all loading options that change the parsed data.
+         *
+         * @param allFrames Flag whether all frames of the PDB file are parsed
+         *
+         * @return The hash
+         */
+        UINT64 pdbCacheOptions( bool allFrames);
+
+        /**
+         * Load the parsed data from the binary cache next to the PDB file.
+         *
+         * @param filename The path to the PDB file
+         * @param pdbSize  The size of the PDB file
+         * @param pdbHash  The hash of the contents of the PDB file
+         *
+         * @return 'true' if the cache belongs to the PDB file and the current
+         *         options and could be loaded, otherwise 'false'
+         */
+        bool readPDBCache( const vislib::TString& filename, UINT64 pdbSize,
+            UINT64 pdbHash);
+
+        /**
+         * Write the parsed data to the binary cache next to the PDB file.
+         *
+         * @param filename The path to the PDB file
+         * @param pdbSize  The size of the PDB file
+         * @param pdbHash  The hash of the contents of the PDB file
+         */
+        void writePDBCache( const vislib::TString& filename, UINT64 pdbSize,
+            UINT64 pdbHash);
+
+        /**
+         * Compute the secondary structure of the current frame of the call
+         * via STRIDE, unless it is cached or the backbone did not move
+         * beyond the tolerance since the last computation.
+         *
+         * @param dc The call holding the atoms of the frame
+         */
+        void updateSecondaryStructure(
+            megamol::protein_calls::MolecularDataCall *dc);
+
+        /**
+         * Set the current secondary structure to the call.
+         *
+         * @param dc The call
+         */
+        void writeSecondaryStructure(
+            megamol::protein_calls::MolecularDataCall *dc);
+
         /**
          * Writes the frames of the current PDB-file (beginning with second
          * frame) into a new compressed XTC-file.
@@ -653,6 +730,10 @@ namespace protein {
         core::param::ParamSlot calcBondsSlot;
 		/** Determine whether to recompute STRIDE each frame */
 		core::param::ParamSlot recomputeStridePerFrameSlot;
+        /** The backbone movement below which STRIDE is not recomputed */
+        core::param::ParamSlot strideToleranceSlot;
+        /** Flag whether the parsed PDB file is cached in a binary file next to it */
+        core::param::ParamSlot binaryCacheSlot;
 
         /** The data */
         vislib::Array<Frame*> data;
@@ -706,8 +787,18 @@ namespace protein {
         /** Stores the current molecule count while loading */
         unsigned int molIdx;
 
-        /** Stride secondary structure computation */
-        Stride *stride;
+        /**
+         * The result of the last secondary structure computation: a valid
+         * flag, the elements (first residue, residue count, type), the
+         * elements of each molecule (first element, count) and the hydrogen
+         * bonds (donor, acceptor), each prefixed by its count.
+         */
+        core::utility::ResultCache::value_type secStruct;
+        /** The frame the secondary structure was last requested for */
+        unsigned int secStructFrame;
+        /** The backbone atoms and their positions when STRIDE last ran */
+        std::vector<unsigned int> backboneAtoms;
+        std::vector<float> backbonePos;
         /** Flag whether secondary structure is available */
         bool secStructAvailable;
 
@@ -721,7 +812,7 @@ namespace protein {
         /** the number of frames */
         unsigned int numXTCFrames;
         /** the byte offset of all frames */
-        vislib::Array<unsigned int> XTCFrameOffset;
+        vislib::Array<UINT64> XTCFrameOffset;
         /** Flag whether the current xtc-filename is valid */
         bool xtcFileValid;
 
@@ -26,7 +26,11 @@ ProteinAligner::ProteinAligner(void)
     , dataOutSlot("dataOut", "Output protein slot")
     , inputProteinSlot("inputProtein", "Input protein that will be moved and rotated to match the reference")
     , referenceProteinSlot("referenceProtein", "Reference protein slot")
-    , isActiveSlot("isActive", "Activates and deactivates the effect of this module") {
+    , isActiveSlot("isActive", "Activates and deactivates the effect of this module")
+    , inputHash(0)
+    , refHash(0)
+    , inputFrame(0)
+    , refFrame(0) {
 
     // callee slot
     this->dataOutSlot.SetCallback(
@@ -121,57 +125,49 @@ bool ProteinAligner::getExtents(core::Call& call) {
  * ProteinAligner::alignPositions
  */
 bool ProteinAligner::alignPositions(const MolecularDataCall& input, const MolecularDataCall& ref) {
+    // the alignment only has to be recomputed if one of the proteins changed
+    if (input.DataHash() != 0 && ref.DataHash() != 0 && input.DataHash() == this->inputHash &&
+        ref.DataHash() == this->refHash && input.FrameID() == this->inputFrame && ref.FrameID() == this->refFrame &&
+        this->alignedPositions.size() == static_cast<size_t>(input.AtomCount()) * 3) {
+        return true;
+    }
+
     std::vector<float> inputCAlphas, refCAlphas;
     this->getCAlphaPosList(input, inputCAlphas);
     this->getCAlphaPosList(ref, refCAlphas);
     auto atomCount = std::min(inputCAlphas.size() / 3, refCAlphas.size() / 3);
 
-    std::vector<float> mass(atomCount, 1.0f);
-    std::vector<int> mask(atomCount, 1);
-    float rotation[3][3], translation[3];
-    auto result = CalculateRMS(static_cast<unsigned int>(atomCount), true, 2, mass.data(), mask.data(),
-        inputCAlphas.data(), refCAlphas.data(), rotation, translation);
-
-    this->alignedPositions.resize(static_cast<size_t>(input.AtomCount()) * 3);
-    std::memcpy(this->alignedPositions.data(), input.AtomPositions(), this->alignedPositions.size() * sizeof(float));
-
-    glm::mat3 rotmat = glm::mat3(glm::make_vec3(rotation[0]), glm::make_vec3(rotation[1]), glm::make_vec3(rotation[2]));
-    glm::vec3 trans = glm::make_vec3(translation);
-
-    // the rotation and translation has to be performed in a two step process as there are some problems with the values
-    // we have now
+    float rotation[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    CalculateRMSQCP(static_cast<unsigned int>(atomCount), nullptr, inputCAlphas.data(), refCAlphas.data(), rotation);
 
-    // the rotation matrix is fixed by transposing it:
-    rotmat = glm::transpose(rotmat);
-
-    for (size_t i = 0; i < input.AtomCount(); ++i) {
-        glm::vec3 pos = glm::make_vec3(&this->alignedPositions[3 * i]);
-        pos = rotmat * pos;
-        std::memcpy(&this->alignedPositions[3 * i], &pos.x, sizeof(float) * 3);
-    }
-
-    // as the resulting transpose vector of the CalculateRMS-method is complete and utter bullcrap, we calculate the
-    // midpoint of each of the two proteins and move the onto each other
+    // the rotation superimposes the c alpha atoms after moving both to their centroids
     glm::vec3 inputCenter(0.0f, 0.0f, 0.0f), refCenter(0.0f, 0.0f, 0.0f);
-    for (size_t i = 0; i < input.AtomCount(); ++i) {
-        glm::vec3 pos = glm::make_vec3(&alignedPositions[3 * i]);
-        inputCenter += pos;
+    for (size_t i = 0; i < atomCount; ++i) {
+        inputCenter += glm::make_vec3(&inputCAlphas[3 * i]);
+        refCenter += glm::make_vec3(&refCAlphas[3 * i]);
     }
-    for (size_t i = 0; i < ref.AtomCount(); ++i) {
-        glm::vec3 pos = glm::make_vec3(&ref.AtomPositions()[3 * i]);
-        refCenter += pos;
+    if (atomCount > 0) {
+        inputCenter /= static_cast<float>(atomCount);
+        refCenter /= static_cast<float>(atomCount);
     }
-    inputCenter /= static_cast<float>(input.AtomCount());
-    refCenter /= static_cast<float>(ref.AtomCount());
+    // the rotation is row major, glm expects column major
+    glm::mat3 rotmat = glm::transpose(glm::make_mat3(&rotation[0][0]));
+
+    this->alignedPositions.resize(static_cast<size_t>(input.AtomCount()) * 3);
     this->boundingBox.Set(refCenter.x, refCenter.y, refCenter.z, refCenter.x, refCenter.y, refCenter.z);
     for (size_t i = 0; i < input.AtomCount(); ++i) {
-        glm::vec3 pos = glm::make_vec3(&this->alignedPositions[3 * i]);
-        pos += refCenter - inputCenter;
+        glm::vec3 pos = glm::make_vec3(&input.AtomPositions()[3 * i]);
+        pos = rotmat * (pos - inputCenter) + refCenter;
         std::memcpy(&this->alignedPositions[3 * i], &pos.x, sizeof(float) * 3);
         this->boundingBox.GrowToPoint(vislib::math::Point<float, 3>(pos.x, pos.y, pos.z));
     }
     this->boundingBox.Grow(3.0f);
 
+    this->inputHash = input.DataHash();
+    this->refHash = ref.DataHash();
+    this->inputFrame = input.FrameID();
+    this->refFrame = ref.FrameID();
+
     return true;
 }
 
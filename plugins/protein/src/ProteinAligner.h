@@ -111,6 +111,12 @@ private:
 
     /** the new bounding box of the data */
     vislib::math::Cuboid<float> boundingBox;
+
+    /** the data hashes of the proteins the alignment was computed for */
+    SIZE_T inputHash, refHash;
+
+    /** the frames of the proteins the alignment was computed for */
+    unsigned int inputFrame, refFrame;
 };
 
 } // namespace protein
@@ -46,10 +46,222 @@
 #include "stdafx.h"
 #include "RMS.h"
 #include <cmath>
+#include <vector>
 #include "vislib/sys/Log.h"
 
 using namespace megamol;
 
+namespace {
+
+/**
+ * A frame with its positions centred on their weighted centroid, stored as
+ * separate coordinate arrays such that the inner products vectorise. Double
+ * precision is needed, because QCP derives the deviation from the difference
+ * of two large sums.
+ */
+struct CentredFrame {
+    std::vector<double> x, y, z;
+    double g; // Sum(wn*|xn|^2)
+};
+
+/*
+ * centreFrame
+ */
+void centreFrame(unsigned int n, const float *pos, const float *mass, double totalMass, CentredFrame& frame) {
+    double c[3] = {0.0, 0.0, 0.0};
+    for (unsigned int k = 0; k < n; k++) {
+        double w = (mass != NULL) ? mass[k] : 1.0;
+        c[0] += w * pos[3*k];
+        c[1] += w * pos[3*k+1];
+        c[2] += w * pos[3*k+2];
+    }
+    frame.x.resize(n);
+    frame.y.resize(n);
+    frame.z.resize(n);
+    frame.g = 0.0;
+    for (unsigned int k = 0; k < n; k++) {
+        double w = (mass != NULL) ? mass[k] : 1.0;
+        frame.x[k] = pos[3*k] - c[0] / totalMass;
+        frame.y[k] = pos[3*k+1] - c[1] / totalMass;
+        frame.z[k] = pos[3*k+2] - c[2] / totalMass;
+        frame.g += w * (frame.x[k]*frame.x[k] + frame.y[k]*frame.y[k] + frame.z[k]*frame.z[k]);
+    }
+}
+
+/*
+ * innerProduct: S = (sij) = Sum(wn*ani*bnj)
+ */
+void innerProduct(unsigned int n, const float *mass, const CentredFrame& a, const CentredFrame& b, double S[9]) {
+    double sxx = 0.0, sxy = 0.0, sxz = 0.0, syx = 0.0, syy = 0.0, syz = 0.0, szx = 0.0, szy = 0.0, szz = 0.0;
+    const double *ax = a.x.data(), *ay = a.y.data(), *az = a.z.data();
+    const double *bx = b.x.data(), *by = b.y.data(), *bz = b.z.data();
+    if (mass == NULL) {
+        for (unsigned int k = 0; k < n; k++) {
+            sxx += ax[k] * bx[k]; sxy += ax[k] * by[k]; sxz += ax[k] * bz[k];
+            syx += ay[k] * bx[k]; syy += ay[k] * by[k]; syz += ay[k] * bz[k];
+            szx += az[k] * bx[k]; szy += az[k] * by[k]; szz += az[k] * bz[k];
+        }
+    } else {
+        for (unsigned int k = 0; k < n; k++) {
+            double wx = mass[k] * ax[k], wy = mass[k] * ay[k], wz = mass[k] * az[k];
+            sxx += wx * bx[k]; sxy += wx * by[k]; sxz += wx * bz[k];
+            syx += wy * bx[k]; syy += wy * by[k]; syz += wy * bz[k];
+            szx += wz * bx[k]; szy += wz * by[k]; szz += wz * bz[k];
+        }
+    }
+    S[0] = sxx; S[1] = sxy; S[2] = sxz;
+    S[3] = syx; S[4] = syy; S[5] = syz;
+    S[6] = szx; S[7] = szy; S[8] = szz;
+}
+
+/*
+ * keyMatrix: The symmetric 4x4 matrix whose largest eigenvalue is the
+ * maximum of Sum(wn*bn.R(q)an) and whose eigenvector is the quaternion q.
+ */
+void keyMatrix(const double S[9], double K[4][4]) {
+    const double sxx = S[0], sxy = S[1], sxz = S[2];
+    const double syx = S[3], syy = S[4], syz = S[5];
+    const double szx = S[6], szy = S[7], szz = S[8];
+    K[0][0] = sxx + syy + szz;
+    K[0][1] = K[1][0] = syz - szy;
+    K[0][2] = K[2][0] = szx - sxz;
+    K[0][3] = K[3][0] = sxy - syx;
+    K[1][1] = sxx - syy - szz;
+    K[1][2] = K[2][1] = sxy + syx;
+    K[1][3] = K[3][1] = szx + sxz;
+    K[2][2] = -sxx + syy - szz;
+    K[2][3] = K[3][2] = syz + szy;
+    K[3][3] = -sxx - syy + szz;
+}
+
+/*
+ * det3
+ */
+inline double det3(double a, double b, double c, double d, double e, double f, double g, double h, double i) {
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+/*
+ * qcpLambdaMax: Finds the largest eigenvalue of the key matrix by Newton
+ * iterations on its characteristic polynomial, starting at the upper bound
+ * E0 = 0.5*(GA + GB).
+ */
+double qcpLambdaMax(const double S[9], double e0) {
+    double K[4][4];
+    keyMatrix(S, K);
+
+    // P(l) = l^4 + c2*l^2 + c1*l + c0
+    double c2 = 0.0;
+    for (int i = 0; i < 9; i++) {
+        c2 += S[i] * S[i];
+    }
+    c2 *= -2.0;
+    const double c1 = -8.0 * det3(S[0], S[1], S[2], S[3], S[4], S[5], S[6], S[7], S[8]);
+    const double c0 =
+        K[0][0] * det3(K[1][1], K[1][2], K[1][3], K[2][1], K[2][2], K[2][3], K[3][1], K[3][2], K[3][3]) -
+        K[0][1] * det3(K[1][0], K[1][2], K[1][3], K[2][0], K[2][2], K[2][3], K[3][0], K[3][2], K[3][3]) +
+        K[0][2] * det3(K[1][0], K[1][1], K[1][3], K[2][0], K[2][1], K[2][3], K[3][0], K[3][1], K[3][3]) -
+        K[0][3] * det3(K[1][0], K[1][1], K[1][2], K[2][0], K[2][1], K[2][2], K[3][0], K[3][1], K[3][2]);
+
+    double l = e0;
+    for (int it = 0; it < 50; it++) {
+        const double l2 = l * l;
+        const double p = (l2 + c2) * l2 + c1 * l + c0;
+        const double dp = 4.0 * l2 * l + 2.0 * c2 * l + c1;
+        if (dp == 0.0) break;
+        const double step = p / dp;
+        l -= step;
+        if (fabs(step) < fabs(1e-11 * l)) break;
+    }
+    return l;
+}
+
+/*
+ * qcpRotation: The eigenvector of the key matrix for lambda is any non-zero
+ * column of the adjugate of (K - lambda*I). The column with the largest norm
+ * is the most accurate one.
+ */
+void qcpRotation(const double S[9], double lambda, float rotation[3][3]) {
+    double K[4][4];
+    keyMatrix(S, K);
+    for (int i = 0; i < 4; i++) {
+        K[i][i] -= lambda;
+    }
+
+    double q[4] = {1.0, 0.0, 0.0, 0.0};
+    double best = 0.0;
+    for (int r = 0; r < 4; r++) {
+        // Cofactors of row r
+        double c[4];
+        for (int j = 0; j < 4; j++) {
+            double m[9];
+            int idx = 0;
+            for (int a = 0; a < 4; a++) {
+                if (a == r) continue;
+                for (int b = 0; b < 4; b++) {
+                    if (b == j) continue;
+                    m[idx++] = K[a][b];
+                }
+            }
+            c[j] = (((r + j) % 2) ? -1.0 : 1.0) * det3(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+        }
+        const double norm = c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + c[3] * c[3];
+        if (norm > best) {
+            best = norm;
+            for (int j = 0; j < 4; j++) {
+                q[j] = c[j];
+            }
+        }
+    }
+    if (best > 0.0) {
+        best = 1.0 / sqrt(best);
+        for (int j = 0; j < 4; j++) {
+            q[j] *= best;
+        }
+    } // else: identical structures, any rotation is optimal
+
+    const double a = q[0], b = q[1], c = q[2], d = q[3];
+    rotation[0][0] = static_cast<float>(a*a + b*b - c*c - d*d);
+    rotation[0][1] = static_cast<float>(2.0 * (b*c - a*d));
+    rotation[0][2] = static_cast<float>(2.0 * (b*d + a*c));
+    rotation[1][0] = static_cast<float>(2.0 * (b*c + a*d));
+    rotation[1][1] = static_cast<float>(a*a - b*b + c*c - d*d);
+    rotation[1][2] = static_cast<float>(2.0 * (c*d - a*b));
+    rotation[2][0] = static_cast<float>(2.0 * (b*d - a*c));
+    rotation[2][1] = static_cast<float>(2.0 * (c*d + a*b));
+    rotation[2][2] = static_cast<float>(a*a - b*b - c*c + d*d);
+}
+
+/*
+ * qcpRMS
+ */
+float qcpRMS(unsigned int n, const float *mass, double totalMass, const CentredFrame& a, const CentredFrame& b,
+        float rotation[3][3]) {
+    double S[9];
+    innerProduct(n, mass, a, b, S);
+    const double e0 = 0.5 * (a.g + b.g);
+    const double lambda = qcpLambdaMax(S, e0);
+    if (rotation != NULL) {
+        qcpRotation(S, lambda, rotation);
+    }
+    const double msd = 2.0 * (e0 - lambda) / totalMass;
+    return (msd > 0.0) ? static_cast<float>(sqrt(msd)) : 0.0f;
+}
+
+/*
+ * totalMassOf
+ */
+double totalMassOf(unsigned int n, const float *mass) {
+    if (mass == NULL) return static_cast<double>(n);
+    double total = 0.0;
+    for (unsigned int k = 0; k < n; k++) {
+        total += mass[k];
+    }
+    return total;
+}
+
+} // namespace
+
 /*
  *  protein::Normalize
  */
@@ -569,3 +781,91 @@ float protein::CalculateRMS(unsigned int n, bool fit, unsigned int mode, float *
     delete []weights;
     return (float) rms_return;
 }
+
+
+/*
+ *  protein::CalculateRMSQCP
+ */
+float protein::CalculateRMSQCP(unsigned int n, const float *mass, const float *toFitVec, const float *Vec,
+        float rotation[3][3])
+{
+    if (n < 2)
+    {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+            "RMS: CalculateRMSQCP - error: Number of atoms less than 2\n");
+        return 0.0f;
+    }
+
+    const double totalMass = totalMassOf(n, mass);
+    CentredFrame toFit, ref;
+    centreFrame(n, toFitVec, mass, totalMass, toFit);
+    centreFrame(n, Vec, mass, totalMass, ref);
+    return qcpRMS(n, mass, totalMass, toFit, ref, rotation);
+}
+
+
+/*
+ *  protein::CalculateRMSBatch
+ */
+void protein::CalculateRMSBatch(unsigned int n, unsigned int frameCnt, const float *frames, const float *Vec,
+        const float *mass, float *rms)
+{
+    if (n < 2)
+    {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+            "RMS: CalculateRMSBatch - error: Number of atoms less than 2\n");
+        return;
+    }
+
+    const double totalMass = totalMassOf(n, mass);
+    CentredFrame ref;
+    centreFrame(n, Vec, mass, totalMass, ref);
+
+#pragma omp parallel
+    {
+        CentredFrame frame;
+#pragma omp for schedule(dynamic, 16)
+        for (int f = 0; f < static_cast<int>(frameCnt); f++)
+        {
+            centreFrame(n, frames + 3 * static_cast<size_t>(n) * f, mass, totalMass, frame);
+            rms[f] = qcpRMS(n, mass, totalMass, frame, ref, NULL);
+        }
+    }
+}
+
+
+/*
+ *  protein::CalculateRMSMatrix
+ */
+void protein::CalculateRMSMatrix(unsigned int n, unsigned int frameCnt, const float *frames, const float *mass,
+        float *rms)
+{
+    if (n < 2)
+    {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+            "RMS: CalculateRMSMatrix - error: Number of atoms less than 2\n");
+        return;
+    }
+
+    // Centre every frame once instead of once per pair
+    const double totalMass = totalMassOf(n, mass);
+    std::vector<CentredFrame> centred(frameCnt);
+#pragma omp parallel for
+    for (int f = 0; f < static_cast<int>(frameCnt); f++)
+    {
+        centreFrame(n, frames + 3 * static_cast<size_t>(n) * f, mass, totalMass, centred[f]);
+    }
+
+    // The rows of the upper triangle get shorter, hence the dynamic schedule
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(frameCnt); i++)
+    {
+        rms[static_cast<size_t>(frameCnt) * i + i] = 0.0f;
+        for (unsigned int j = i + 1; j < frameCnt; j++)
+        {
+            const float value = qcpRMS(n, mass, totalMass, centred[i], centred[j], NULL);
+            rms[static_cast<size_t>(frameCnt) * i + j] = value;
+            rms[static_cast<size_t>(frameCnt) * j + i] = value;
+        }
+    }
+}
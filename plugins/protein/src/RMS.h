@@ -125,6 +125,53 @@ int Jacobi3(double *a, double *d, double *v, int *nrot);
 float CalculateRMS(unsigned int n, bool fit, unsigned int mode, float *mass, int *mask, 
                    float *toFitVec, float *Vec, float rotation[3][3], float translation[3]);
 
+/**
+* Calculate the RMS value of two given position vectors after the optimal
+* superposition with the quaternion characteristic polynomial (QCP) method
+* (http://dx.doi.org/10.1107/S0108767305015266). In contrast to CalculateRMS,
+* no eigen decomposition is necessary and the input vectors are not modified.
+*
+* @param n        Number of Positions (xyz) of each Vector.
+* @param mass     n weights for positions or NULL for equal weights.
+* @param toFitVec Vector which is fit against Vec.
+* @param Vec      Reference input Vector.
+* @param rotation Receives the rotation which superimposes toFitVec onto Vec
+*                 after both have been moved to their centroids, or NULL.
+*
+* @return Return the calculated RMS value
+*/
+float CalculateRMSQCP(unsigned int n, const float *mass, const float *toFitVec, const float *Vec,
+                      float rotation[3][3]);
+
+/**
+* Calculate the RMS values of a series of frames against a reference after
+* the optimal superposition with the QCP method. The frames are processed in
+* parallel.
+*
+* @param n        Number of Positions (xyz) of each frame.
+* @param frameCnt Number of frames.
+* @param frames   frameCnt * n positions (xyz), one frame after another.
+* @param Vec      Reference input Vector.
+* @param mass     n weights for positions or NULL for equal weights.
+* @param rms      Receives the frameCnt RMS values.
+*/
+void CalculateRMSBatch(unsigned int n, unsigned int frameCnt, const float *frames, const float *Vec,
+                       const float *mass, float *rms);
+
+/**
+* Calculate the symmetric matrix of the RMS values of all pairs of frames
+* after the optimal superposition with the QCP method. Every frame is
+* centred only once and the pairs are processed in parallel.
+*
+* @param n        Number of Positions (xyz) of each frame.
+* @param frameCnt Number of frames.
+* @param frames   frameCnt * n positions (xyz), one frame after another.
+* @param mass     n weights for positions or NULL for equal weights.
+* @param rms      Receives the frameCnt * frameCnt RMS values.
+*/
+void CalculateRMSMatrix(unsigned int n, unsigned int frameCnt, const float *frames, const float *mass,
+                        float *rms);
+
 
 } /* end namespace protein */
 } /* end namespace megamol */
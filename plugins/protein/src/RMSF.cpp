@@ -7,7 +7,7 @@
 #include <fstream>
 #include <cfloat>
 #include <climits>
-#include <cfloat>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::protein;
@@ -29,61 +29,49 @@ PROTEIN_API bool megamol::protein::computeRMSF(protein_calls::MolecularDataCall
 	// no frames available -> false
 	if (mol->FrameCount() < 2) return false;
 	
-	// allocate mem
-	vislib::Array<float> meanPos;
-	meanPos.SetCount(mol->AtomCount() * 3);
+	// The positions are accumulated relative to the first frame in a single
+	// pass over the trajectory, RMSF^2 = E[|d|^2] - |E[d]|^2. The offset keeps
+	// the difference well-conditioned.
+	const unsigned int atomCount = mol->AtomCount();
+	std::vector<float> firstPos(mol->AtomPositions(), mol->AtomPositions() + atomCount * 3);
+	std::vector<double> sumDev(atomCount * 3, 0.0);
+	std::vector<double> sumSqDev(atomCount, 0.0);
 	float *rmsf;
-	rmsf = new float[mol->AtomCount()];
-	// initialize rmsf to zero
-	for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-		rmsf[i] = 0;
-	}
+	rmsf = new float[atomCount];
 
-	// get atom pos of first frame
-	for (unsigned int atomIdx = 0; atomIdx < mol->AtomCount(); atomIdx++) {
-		meanPos[atomIdx * 3 + 0] = mol->AtomPositions()[atomIdx * 3 + 0];
-		meanPos[atomIdx * 3 + 1] = mol->AtomPositions()[atomIdx * 3 + 1];
-		meanPos[atomIdx * 3 + 2] = mol->AtomPositions()[atomIdx * 3 + 2];
-	}
-
-	// sum up all atom positions
 	for (unsigned int i = 1; i < mol->FrameCount(); i++) {
 		// load frame
 		mol->SetFrameID(i, true);
-		if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
-		// add atom pos
-		for (unsigned int atomIdx = 0; atomIdx < mol->AtomCount(); atomIdx++) {
-			meanPos[atomIdx*3+0] += mol->AtomPositions()[atomIdx*3+0];
-			meanPos[atomIdx*3+1] += mol->AtomPositions()[atomIdx*3+1];
-			meanPos[atomIdx*3+2] += mol->AtomPositions()[atomIdx*3+2];
+		if (!(*mol)(MolecularDataCall::CallForGetData) || (mol->AtomCount() != atomCount)) {
+			delete[] rmsf;
+			return false;
+		}
+		const float *pos = mol->AtomPositions();
+		// add deviation from the first frame
+		for (unsigned int atomIdx = 0; atomIdx < atomCount; atomIdx++) {
+			double dx = pos[atomIdx * 3 + 0] - firstPos[atomIdx * 3 + 0];
+			double dy = pos[atomIdx * 3 + 1] - firstPos[atomIdx * 3 + 1];
+			double dz = pos[atomIdx * 3 + 2] - firstPos[atomIdx * 3 + 2];
+			sumDev[atomIdx * 3 + 0] += dx;
+			sumDev[atomIdx * 3 + 1] += dy;
+			sumDev[atomIdx * 3 + 2] += dz;
+			sumSqDev[atomIdx] += dx * dx + dy * dy + dz * dz;
 		}
-	}
-	// compute average pos
-	for (unsigned int i = 0; i < meanPos.Count(); i++) {
-		meanPos[i] /= static_cast<float>(mol->FrameCount());
 	}
 
 	// compute RMSF
-	vislib::math::Vector<float, 3> tmpVec;
-	float len;
-	for (unsigned int i = 0; i < mol->FrameCount(); i++) {
-		// load frame
-		mol->SetFrameID(i, true);
-		if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
-		// get deviation from mean pos for current atom pos
-		for (unsigned int atomIdx = 0; atomIdx < mol->AtomCount(); atomIdx++) {
-			 tmpVec.SetX( mol->AtomPositions()[atomIdx * 3 + 0] - meanPos[atomIdx * 3 + 0]);
-			 tmpVec.SetY( mol->AtomPositions()[atomIdx * 3 + 1] - meanPos[atomIdx * 3 + 1]);
-			 tmpVec.SetZ( mol->AtomPositions()[atomIdx * 3 + 2] - meanPos[atomIdx * 3 + 2]);
-			 len = tmpVec.Length();
-			 rmsf[atomIdx] += len * len;
-		}
+	const double frameCount = static_cast<double>(mol->FrameCount());
+	for (unsigned int i = 0; i < atomCount; i++) {
+		double mx = sumDev[i * 3 + 0] / frameCount;
+		double my = sumDev[i * 3 + 1] / frameCount;
+		double mz = sumDev[i * 3 + 2] / frameCount;
+		double var = sumSqDev[i] / frameCount - (mx * mx + my * my + mz * mz);
+		rmsf[i] = static_cast<float>(sqrt(var > 0.0 ? var : 0.0));
 	}
 
-	// compute average pos
+	// find the range of the values
 	float minRMSF = FLT_MAX, maxRMSF = 0.0f;
-	for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-		rmsf[i] = sqrtf( rmsf[i] / static_cast<float>(mol->FrameCount()));
+	for (unsigned int i = 0; i < atomCount; i++) {
 		minRMSF = rmsf[i] < minRMSF ? rmsf[i] : minRMSF;
 		maxRMSF = rmsf[i] > maxRMSF ? rmsf[i] : maxRMSF;
 	}
@@ -12,8 +12,11 @@
 #include "mmcore/param/FloatParam.h"
 #include "protein_calls/PerAtomFloatCall.h"
 #include <omp.h>
+#include <algorithm>
 #include <cfloat>
 #include <climits>
+#include <cmath>
+#include <future>
 
 
 using namespace megamol;
@@ -30,7 +33,8 @@ getDataSlot("getdata", "The slot publishing the loaded data"),
 molDataSlot("moldata", "The slot requesting molecular data"),
 solDataSlot("soldata", "The slot requesting solvent data"),
 radiusParam("radius", "The search radius for solvent molecules"),
-minValue(0.0f), midValue(0.0f), maxValue(0.0f) {
+minValue(0.0f), midValue(0.0f), maxValue(0.0f), datahash(0), frameCount(0), searchRadius(0.0f),
+countedRadius(-1.0f) {
     // the data out slot
     this->getDataSlot.SetCallback(PerAtomFloatCall::ClassName(), PerAtomFloatCall::FunctionName(PerAtomFloatCall::CallForGetFloat), &SolventCounter::getDataCallback);
     this->MakeSlotAvailable(&this->getDataSlot);
@@ -119,57 +123,37 @@ bool SolventCounter::getDataCallback(core::Call& call) {
 #else
     // sol and mol must have the same number of frames
     if (sol->FrameCount() != mol->FrameCount()) return false;
-    unsigned int frameCount = mol->FrameCount();
-    // only recompute everything if this is necessary
-    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
-        // load data once...
-        mol->SetFrameID(0);
-        if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
-        sol->SetFrameID(0);
-        if (!(*sol)(MolecularDataCall::CallForGetData)) return false;
-        vislib::sys::Log::DefaultLog.WriteInfo("Start recomputing solvent neighborhood information per atom...");
-        this->solvent.Clear();
-        this->solvent.SetCount(mol->AtomCount());
-        // set all values to zero
-        for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            this->solvent[i] = 0.0f;
-        }
-        this->minValue = FLT_MAX;
-        this->maxValue = FLT_MIN;
-        // loop over all frames
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
-        for (unsigned int fID = 0; fID < frameCount; fID++) {
-            if ( fID % 100 == 0 )
-                vislib::sys::Log::DefaultLog.WriteInfo("Computing Frame %i", fID);
-            mol->SetFrameID(fID);
-            if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
-            sol->SetFrameID(fID);
-            if (!(*sol)(MolecularDataCall::CallForGetData)) return false;
-            // loop over all molecule atoms and check for neighboring solvent atoms
-            for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-                molAtomPos.Set(mol->AtomPositions()[3 * i],
-                    mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
-                for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                    solAtomPos.Set(sol->AtomPositions()[3 * j],
-                        sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                    // increase counter if the current solvent atom is within the given radius
-                    if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                        this->solvent[i] += 1.0f;
-                        break;
-                    }
-                }
+    float radius = this->radiusParam.Param<param::FloatParam>()->Value();
+    // only rescan the trajectory if the data changed or if the radius exceeds
+    // the one the neighbourhood was cached for
+    bool rescan = this->solventDistances.size() != mol->AtomCount() || this->datahash != mol->DataHash() ||
+                  radius > this->searchRadius;
+    if (rescan) {
+        // cache with some head room, such that increasing the radius a bit
+        // does not need another scan
+        if (!this->scanTrajectory(mol, sol, 2.0f * radius)) return false;
+    }
+    // the counts for a new radius are answered from the cached distances
+    if (rescan || radius != this->countedRadius) {
+        int atomCount = static_cast<int>(this->solventDistances.size());
+        this->solvent.SetCount(atomCount);
+#pragma omp parallel for
+        for (int i = 0; i < atomCount; i++) {
+            unsigned int cnt = 0;
+            for (float d : this->solventDistances[i]) {
+                if (d <= radius) cnt++;
             }
-            this->datahash = mol->DataHash();
-            mol->Unlock();
-            sol->Unlock();
+            this->solvent[i] = static_cast<float>(cnt) / static_cast<float>(this->frameCount);
         }
         // normalize values
-        for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            this->solvent[i] /= static_cast<float>(frameCount);
+        this->minValue = FLT_MAX;
+        this->maxValue = FLT_MIN;
+        for (int i = 0; i < atomCount; i++) {
             this->minValue = vislib::math::Min(this->minValue, this->solvent[i]);
             this->maxValue = vislib::math::Max(this->maxValue, this->solvent[i]);
         }
         this->midValue = (this->maxValue - this->minValue) * 0.8f + this->minValue;
+        this->countedRadius = radius;
         vislib::sys::Log::DefaultLog.WriteInfo("Finished recomputing solvent neighborhood information per atom (%.3f, %.3f, %.3f).", this->minValue, this->midValue, this->maxValue);
     }
 #endif // GET_ONE_TIMESTEP
@@ -181,3 +165,132 @@ bool SolventCounter::getDataCallback(core::Call& call) {
 
     return true;
 }
+
+
+/*
+* SolventCounter::scanTrajectory
+*/
+bool SolventCounter::scanTrajectory(MolecularDataCall *mol, MolecularDataCall *sol, float searchRadius) {
+    unsigned int frameCount = mol->FrameCount();
+    unsigned int atomCount = 0;
+    vislib::sys::Log::DefaultLog.WriteInfo("Start recomputing solvent neighborhood information per atom...");
+
+    // The frames are requested here, while the previous one is scanned in
+    // the background
+    std::vector<float> molPos[2], solPos[2];
+    std::future<void> scan;
+    for (unsigned int fID = 0; fID < frameCount; fID++) {
+        if ( fID % 100 == 0 )
+            vislib::sys::Log::DefaultLog.WriteInfo("Computing Frame %i", fID);
+        mol->SetFrameID(fID);
+        sol->SetFrameID(fID);
+        if (!(*mol)(MolecularDataCall::CallForGetData) || !(*sol)(MolecularDataCall::CallForGetData)) {
+            if (scan.valid()) scan.wait();
+            this->solventDistances.clear();
+            return false;
+        }
+        if (fID == 0) {
+            atomCount = mol->AtomCount();
+            this->solventDistances.assign(atomCount, std::vector<float>());
+        } else if (mol->AtomCount() != atomCount) {
+            vislib::sys::Log::DefaultLog.WriteError("The number of atoms changes in frame %u", fID);
+            if (scan.valid()) scan.wait();
+            this->solventDistances.clear();
+            return false;
+        }
+        std::vector<float> &mp = molPos[fID % 2];
+        std::vector<float> &sp = solPos[fID % 2];
+        mp.assign(mol->AtomPositions(), mol->AtomPositions() + 3 * atomCount);
+        sp.assign(sol->AtomPositions(), sol->AtomPositions() + 3 * sol->AtomCount());
+        this->datahash = mol->DataHash();
+        mol->Unlock();
+        sol->Unlock();
+
+        if (scan.valid()) scan.get();
+        scan = std::async(std::launch::async, [this, &mp, &sp, searchRadius]() {
+            this->scanFrame(mp, sp, searchRadius);
+        });
+    }
+    if (scan.valid()) scan.get();
+
+    this->frameCount = frameCount;
+    this->searchRadius = searchRadius;
+    return true;
+}
+
+
+/*
+* SolventCounter::scanFrame
+*/
+void SolventCounter::scanFrame(const std::vector<float> &molPos, const std::vector<float> &solPos,
+        float searchRadius) {
+    int molCount = static_cast<int>(molPos.size() / 3);
+    int solCount = static_cast<int>(solPos.size() / 3);
+    if (solCount == 0) return;
+
+    // sort the solvent atoms into a grid with cells not smaller than the
+    // search radius, such that only the neighbouring cells need to be tested
+    float minPos[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float maxPos[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int j = 0; j < solCount; j++) {
+        for (int k = 0; k < 3; k++) {
+            minPos[k] = vislib::math::Min(minPos[k], solPos[3 * j + k]);
+            maxPos[k] = vislib::math::Max(maxPos[k], solPos[3 * j + k]);
+        }
+    }
+    float volume = 1.0f;
+    for (int k = 0; k < 3; k++) {
+        volume *= vislib::math::Max(maxPos[k] - minPos[k], searchRadius);
+    }
+    // limit the number of cells to about the number of solvent atoms
+    float cellSize = vislib::math::Max(searchRadius, std::cbrt(volume / static_cast<float>(solCount)));
+    int dim[3];
+    for (int k = 0; k < 3; k++) {
+        dim[k] = static_cast<int>((maxPos[k] - minPos[k]) / cellSize) + 1;
+    }
+    auto cellOf = [&](const float *p, int k) {
+        return vislib::math::Clamp(static_cast<int>((p[k] - minPos[k]) / cellSize), 0, dim[k] - 1);
+    };
+
+    std::vector<int> cellStart(dim[0] * dim[1] * dim[2] + 1, 0);
+    std::vector<int> solCell(solCount);
+    for (int j = 0; j < solCount; j++) {
+        const float *p = &solPos[3 * j];
+        solCell[j] = (cellOf(p, 2) * dim[1] + cellOf(p, 1)) * dim[0] + cellOf(p, 0);
+        cellStart[solCell[j] + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); c++) {
+        cellStart[c] += cellStart[c - 1];
+    }
+    std::vector<float> sorted(3 * solCount);
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int j = 0; j < solCount; j++) {
+        int dst = fill[solCell[j]]++;
+        std::copy(&solPos[3 * j], &solPos[3 * j] + 3, &sorted[3 * dst]);
+    }
+
+    // find the closest solvent atom within the search radius for each atom
+    float maxDistSq = searchRadius * searchRadius;
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < molCount; i++) {
+        const float *p = &molPos[3 * i];
+        int c[3] = { cellOf(p, 0), cellOf(p, 1), cellOf(p, 2) };
+        float minDistSq = FLT_MAX;
+        for (int z = vislib::math::Max(c[2] - 1, 0); z <= vislib::math::Min(c[2] + 1, dim[2] - 1); z++) {
+            for (int y = vislib::math::Max(c[1] - 1, 0); y <= vislib::math::Min(c[1] + 1, dim[1] - 1); y++) {
+                for (int x = vislib::math::Max(c[0] - 1, 0); x <= vislib::math::Min(c[0] + 1, dim[0] - 1); x++) {
+                    int cell = (z * dim[1] + y) * dim[0] + x;
+                    for (int j = cellStart[cell]; j < cellStart[cell + 1]; j++) {
+                        float dx = sorted[3 * j + 0] - p[0];
+                        float dy = sorted[3 * j + 1] - p[1];
+                        float dz = sorted[3 * j + 2] - p[2];
+                        minDistSq = vislib::math::Min(minDistSq, dx * dx + dy * dy + dz * dz);
+                    }
+                }
+            }
+        }
+        if (minDistSq <= maxDistSq) {
+            this->solventDistances[i].push_back(std::sqrt(minDistSq));
+        }
+    }
+}
@@ -19,6 +19,8 @@
 #include "protein_calls/MolecularDataCall.h"
 #include "vislib/Array.h"
 
+#include <vector>
+
 
 namespace megamol {
 namespace protein {
@@ -91,6 +93,30 @@ namespace protein {
         */
         bool getDataCallback(core::Call& caller);
 
+        /**
+        * Requests all frames and caches the distance to the closest solvent
+        * atom for every atom and every frame in which it is within the search
+        * radius.
+        *
+        * @param mol The call for the protein data
+        * @param sol The call for the solvent data
+        * @param searchRadius The largest distance to be cached
+        *
+        * @return 'true' on success, 'false' on failure.
+        */
+        bool scanTrajectory(protein_calls::MolecularDataCall *mol, protein_calls::MolecularDataCall *sol,
+            float searchRadius);
+
+        /**
+        * Adds the distances to the closest solvent atoms of a single frame to
+        * the cache. The atoms are processed in parallel.
+        *
+        * @param molPos The positions of the protein atoms
+        * @param solPos The positions of the solvent atoms
+        * @param searchRadius The largest distance to be cached
+        */
+        void scanFrame(const std::vector<float> &molPos, const std::vector<float> &solPos, float searchRadius);
+
         /** The slot for requesting data */
         core::CalleeSlot getDataSlot;
 
@@ -116,6 +142,18 @@ namespace protein {
         */
         SIZE_T datahash;
 
+        /** The distances to the closest solvent atom per atom and frame */
+        std::vector<std::vector<float>> solventDistances;
+
+        /** The number of frames in the cache */
+        unsigned int frameCount;
+
+        /** The radius up to which the distances are cached */
+        float searchRadius;
+
+        /** The radius of the current solvent counts */
+        float countedRadius;
+
     };
 
 } /* end namespace protein */
@@ -15,14 +15,16 @@
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/EnumParam.h"
-#include "vislib/sys/ASCIIFileBuffer.h"
+#include "vislib/sys/File.h"
 #include "vislib/sys/Log.h"
 #include "vislib/String.h"
 #include "vislib/Exception.h"
 #include <string>
 #include <sstream>
 #include <ctime>
+#include <vector>
 #include "Base64.h"
+#include "FloatTextParser.h"
 #include <ctype.h>
 #include <cmath>
 //#include "vislib_vector_typedefs.h"
@@ -180,10 +182,7 @@ bool VMDDXLoader::loadFile(const vislib::StringA& filename) {
     using namespace vislib::sys;
     using namespace vislib;
 
-    File testFile;
-    ASCIIFileBuffer file(ASCIIFileBuffer::PARSING_WORDS);
-    StringA word;
-    uint lineCnt;
+    File file;
 
     // Test whether the filename is invalid or empty
     if (filename.IsEmpty()) {
@@ -192,13 +191,13 @@ bool VMDDXLoader::loadFile(const vislib::StringA& filename) {
         return true;
     }
 
-    if (!file.LoadFile(filename)) {
+    if (!file.Open(filename, File::READ_ONLY, File::SHARE_READ, File::OPEN_ONLY)) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "%s: Unable to open file '%s'",
                 this->ClassName(), filename.PeekBuffer());
         return false;
     }
 
-    File::FileSize fileSize = File::GetSize(filename);
+    File::FileSize fileSize = file.GetSize();
 
     time_t t = clock(); // DEBUG
 
@@ -207,89 +206,126 @@ bool VMDDXLoader::loadFile(const vislib::StringA& filename) {
             filename.PeekBuffer(),
             fileSize); // DEBUG
 
-    // File successfully loaded, get extent spacing and origin
-    lineCnt = 0;
-    double min = 0.0f;
-    double max = 0.0f;
-    bool readFloatData = false;
-    uint floatDataCounter = 0;
-    while (lineCnt < file.Count()) {
-
-        if (file[lineCnt].Count() >= 4) {
-            if (StringA(file[lineCnt].Word(3)).Equals("gridpositions")) {
-                // Get extent of the data
-                this->imgdata.SetWholeExtent(Cubeu(0, 0, 0,
-                        this->string2int(TString(file[lineCnt].Word(5)))-1,
-                        this->string2int(TString(file[lineCnt].Word(6)))-1,
-                        this->string2int(TString(file[lineCnt].Word(7)))-1));
-            }
+    // Read the whole file at once, the text is terminated for the parser
+    std::vector<char> buffer(static_cast<size_t>(fileSize) + 1, '\0');
+    if (file.Read(buffer.data(), fileSize) != fileSize) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "%s: Unable to read file '%s'",
+                this->ClassName(), filename.PeekBuffer());
+        return false;
+    }
+    file.Close();
+    const char *bufferEnd = buffer.data() + fileSize;
+
+    // Get extent spacing and origin from the header, which ends with the
+    // declaration of the data array
+    const char *pt = buffer.data();
+    const char *dataBegin = NULL;
+    uint deltaCnt = 0;
+    Vec3f spacing(1.0f, 1.0f, 1.0f);
+    std::vector<std::string> words;
+    while ((pt < bufferEnd) && (dataBegin == NULL)) {
+        const char *lineEnd = pt;
+        while ((lineEnd < bufferEnd) && (*lineEnd != '\n')) {
+            lineEnd++;
         }
-
-        if (file[lineCnt].Count() >= 1) {
-            if (StringA(file[lineCnt].Word(0)).Equals("origin")) {
-                // Get origin of the data
-                this->imgdata.SetOrigin(Vec3f(
-                        this->string2float(TString(file[lineCnt].Word(1))),
-                        this->string2float(TString(file[lineCnt].Word(2))),
-                        this->string2float(TString(file[lineCnt].Word(3)))));
-            }
+        words.clear();
+        std::istringstream line(std::string(pt, lineEnd));
+        std::string word;
+        while (line >> word) {
+            words.push_back(word);
         }
-
-        if (file[lineCnt].Count() >= 1) {
-            if (StringA(file[lineCnt].Word(0)).Equals("delta")) {
-                this->imgdata.SetSpacing(Vec3f(
-                        this->string2float(TString(file[lineCnt+0].Word(1))),
-                        this->string2float(TString(file[lineCnt+1].Word(2))),
-                        this->string2float(TString(file[lineCnt+2].Word(3)))));
-                lineCnt += 2;
+        pt = (lineEnd < bufferEnd) ? lineEnd + 1 : bufferEnd;
+
+        if ((words.size() >= 8) && (words[3] == "gridpositions")) {
+            // Get extent of the data
+            this->imgdata.SetWholeExtent(Cubeu(0, 0, 0,
+                    this->string2int(words[5].c_str())-1,
+                    this->string2int(words[6].c_str())-1,
+                    this->string2int(words[7].c_str())-1));
+        } else if ((words.size() >= 4) && (words[0] == "origin")) {
+            // Get origin of the data
+            this->imgdata.SetOrigin(Vec3f(
+                    this->string2float(words[1].c_str()),
+                    this->string2float(words[2].c_str()),
+                    this->string2float(words[3].c_str())));
+        } else if ((words.size() >= 4) && (words[0] == "delta")) {
+            // The i-th delta line holds the spacing of the i-th axis
+            if (deltaCnt < 3) {
+                spacing[deltaCnt] = this->string2float(words[1+deltaCnt].c_str());
+                deltaCnt++;
+                if (deltaCnt == 3) {
+                    this->imgdata.SetSpacing(spacing);
+                }
             }
+        } else if ((words.size() >= 4) && (words[3] == "array")) {
+            // Read data from now on
+            dataBegin = pt;
         }
+    }
 
-        // Stop reading float data
-        if (file[lineCnt].Count() >= 1) {
-            if ((readFloatData) && (StringA(file[lineCnt].Word(0)).Equals("attribute"))) {
-                readFloatData = false;
-            }
-        }
+    if (dataBegin == NULL) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "%s: File '%s' contains no data array",
+                this->ClassName(), filename.PeekBuffer());
+        return false;
+    }
 
-        if (readFloatData) {
-            //printf("Number of words in the current line %s\n", file[lineCnt].Count());
-            for (uint w = 0; w < file[lineCnt].Count(); ++w) { // Loop through all words
-                //printf("Current word %s\n", file[lineCnt].Word(w));
-                this->data.Peek()[floatDataCounter] = this->string2float(file[lineCnt].Word(w));
-                if (min > this->data.Peek()[floatDataCounter]) {
-                    min = this->data.Peek()[floatDataCounter];
-                }
-                if (max < this->data.Peek()[floatDataCounter]) {
-                    max = this->data.Peek()[floatDataCounter];
-                }
-                floatDataCounter++;
-            }
+    // The data array ends with the first line starting with a keyword, i.e.
+    // 'attribute' or 'object'
+    const char *dataEnd = dataBegin;
+    while (dataEnd < bufferEnd) {
+        const char *first = dataEnd;
+        while ((first < bufferEnd) && ((*first == ' ') || (*first == '\t') || (*first == '\r'))) {
+            first++;
         }
-
-        // Start reading float data
-        if ((!readFloatData) && (file[lineCnt].Count() >= 4)) {
-            if (StringA(file[lineCnt].Word(3)).Equals("array")) {
-                // Read data from now on
-                readFloatData = true;
-                this->data.Validate(
-                        (this->imgdata.GetWholeExtent().Width()+1)*
-                        (this->imgdata.GetWholeExtent().Depth()+1)*
-                        (this->imgdata.GetWholeExtent().Height()+1));
-            }
+        if ((first < bufferEnd) && isalpha(static_cast<unsigned char>(*first))) {
+            break;
         }
+        while ((dataEnd < bufferEnd) && (*dataEnd != '\n')) {
+            dataEnd++;
+        }
+        if (dataEnd < bufferEnd) {
+            dataEnd++;
+        }
+    }
+
+    const int width = static_cast<int>(this->imgdata.GetWholeExtent().Width()+1);
+    const int height = static_cast<int>(this->imgdata.GetWholeExtent().Height()+1);
+    const int depth = static_cast<int>(this->imgdata.GetWholeExtent().Depth()+1);
+    this->data.Validate(width*height*depth);
+
+    // Parse the data array in parallel
+    SIZE_T floatDataCounter = this->readDataAscii2Float(dataBegin, dataEnd,
+            this->data.Peek(), this->data.GetCount());
+    if (floatDataCounter < this->data.GetCount()) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_WARN, "%s: Data array contains %u of %u values",
+                this->ClassName(), static_cast<uint>(floatDataCounter),
+                static_cast<uint>(this->data.GetCount()));
+        memset(this->data.Peek() + floatDataCounter, 0,
+                (this->data.GetCount() - floatDataCounter)*sizeof(float));
+    }
 
-        lineCnt++;
+    double min = 0.0;
+    double max = 0.0;
+    if (this->data.GetCount() > 0) {
+        min = max = this->data.Peek()[0];
+    }
+    for (SIZE_T cnt = 1; cnt < this->data.GetCount(); ++cnt) {
+        if (min > this->data.Peek()[cnt]) {
+            min = this->data.Peek()[cnt];
+        }
+        if (max < this->data.Peek()[cnt]) {
+            max = this->data.Peek()[cnt];
+        }
     }
 
     // Change ordering from row major to column major
     this->dataTmp.Validate(this->data.GetCount());
-//#pragma omp parallel for
+#pragma omp parallel for
     for (int cnt = 0; cnt < static_cast<int>(this->data.GetCount()); ++cnt) {
-        int x = cnt%int((this->imgdata.GetWholeExtent().Width()+1));
-        int y = (cnt/int((this->imgdata.GetWholeExtent().Width()+1)))%int((this->imgdata.GetWholeExtent().Height()+1));
-        int z = (cnt/int((this->imgdata.GetWholeExtent().Width()+1)))/int((this->imgdata.GetWholeExtent().Height()+1));
-        this->dataTmp.Peek()[int((this->imgdata.GetWholeExtent().Depth()+1))*(int((this->imgdata.GetWholeExtent().Height()+1))*x+y)+z] = this->data.Peek()[cnt];
+        int x = cnt%width;
+        int y = (cnt/width)%height;
+        int z = (cnt/width)/height;
+        this->dataTmp.Peek()[depth*(height*x+y)+z] = this->data.Peek()[cnt];
     }
     memcpy(this->data.Peek(), this->dataTmp.Peek(), this->data.GetSize()*sizeof(float));
 
@@ -309,28 +345,9 @@ bool VMDDXLoader::loadFile(const vislib::StringA& filename) {
 /*
  * VMDDXLoader::readDataAscii2Float
  */
-void VMDDXLoader::readDataAscii2Float(char *buffIn, float* buffOut,
-        SIZE_T sizeOut) {
-
-    char num[64];
-    char *pt_nums, *pt_end = buffIn;
-    unsigned int numCount=0;
-    while(numCount < sizeOut) {
-        while(isspace(*pt_end)) { // Omit whitespace chars
-            pt_end++;
-        }
-        pt_nums = pt_end;
-        while(!isspace(*pt_end)) { // Get chars containing number
-            pt_end++;
-        }
-        memset(num, 0, 64);
-        memcpy(num, pt_nums, pt_end-pt_nums+1);
-        buffOut[numCount]= static_cast<float>(atof(num));
-        numCount++;
-        while(isspace(*pt_end)) { // Omit whitespace chars
-            pt_end++;
-        }
-    }
+SIZE_T VMDDXLoader::readDataAscii2Float(const char *buffIn, const char *buffEnd,
+        float* buffOut, SIZE_T sizeOut) {
+    return FloatTextParser::Parse(buffIn, buffEnd, buffOut, sizeOut);
 }
 
 
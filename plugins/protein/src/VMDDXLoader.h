@@ -121,10 +121,13 @@ protected:
      * Reads data from an ASCII buffer to a float array.
      *
      * @param buffIn  The input buffer containing the ascii data.
+     * @param buffEnd The end of the ascii data
      * @param buffOut The output buffer containing the floats
      * @param sizeOut The size of the output buffer
+     * @return The number of floats read
      */
-    void readDataAscii2Float(char *buffIn, float* buffOut, SIZE_T sizeOut);
+    SIZE_T readDataAscii2Float(const char *buffIn, const char *buffEnd,
+            float* buffOut, SIZE_T sizeOut);
 
 private:
 
@@ -24,6 +24,7 @@
 #include <sstream>
 #include <ctime>
 #include "Base64.h"
+#include "FloatTextParser.h"
 #include <ctype.h>
 #include <cmath>
 #include <algorithm>
@@ -565,24 +566,18 @@ bool VTILoader::loadFile(const vislib::StringA& filename) {
 void VTILoader::readDataAscii2Float(char *buffIn, float* buffOut,
         SIZE_T sizeOut) {
 
-    char num[64];
-    char *pt_nums, *pt_end = buffIn;
-    unsigned int numCount=0;
-    while(numCount < sizeOut) {
-        while(isspace(*pt_end)) { // Omit whitespace chars
-            pt_end++;
-        }
-        pt_nums = pt_end;
-        while(!isspace(*pt_end)) { // Get chars containing number
-            pt_end++;
-        }
-        memset(num, 0, 64);
-        memcpy(num, pt_nums, pt_end-pt_nums+1);
-        buffOut[numCount]= static_cast<float>(atof(num));
-        numCount++;
-        while(isspace(*pt_end)) { // Omit whitespace chars
-            pt_end++;
-        }
+    // The data array ends with the closing tag
+    const char *pt_end = strchr(buffIn, '<');
+    if (pt_end == NULL) {
+        pt_end = buffIn + strlen(buffIn);
+    }
+    SIZE_T numCount = FloatTextParser::Parse(buffIn, pt_end, buffOut, sizeOut);
+    if (numCount < sizeOut) {
+        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+                "%s: Data array contains %u of %u values",
+                this->ClassName(), static_cast<unsigned int>(numCount),
+                static_cast<unsigned int>(sizeOut));
+        memset(buffOut + numCount, 0, (sizeOut - numCount)*sizeof(float));
     }
 }
 
@@ -598,10 +593,9 @@ void VTILoader::readDataBinary2Float(char *buffIn, float* buffOut, // TODO Other
     while(isspace(*pt_end)) { // Omit whitespace chars
         pt_end++;
     }
-    // TODO Decode first 8 bytes (=size of the data following in bytes)
-    //pt_end +=8;
-    // Decode actual data
-    Base64::Decode(pt_end, (char *)buffOut, sizeOut*sizeof(float));
+    // Decode the size header and the actual data, the header occupies the
+    // first float of the output buffer
+    Base64::Decode(pt_end, (char *)buffOut, (sizeOut+1)*sizeof(float));
 }
 
 
@@ -654,10 +648,11 @@ void VTILoader::loadFrame(view::AnimDataModule::Frame *frame, unsigned int idx)
 #endif // defined(VERBOSE)
 
     // Read data file to char buffer
-	char *buffer = new char[(unsigned int)fileSize];
+	char *buffer = new char[static_cast<SIZE_T>(fileSize)+1];
     file.Open(frameFile, File::READ_ONLY, File::SHARE_EXCLUSIVE, File::OPEN_ONLY);
     file.Read(buffer, fileSize);
     file.Close();
+    buffer[fileSize] = '\0'; // Terminate the text for the data array parsers
 
     uint pieceCounter = 0;
 
@@ -139,8 +139,9 @@ protected:
      * encoded first since it uses base64 encoding.
      *
      * @param buffIn  The input buffer containing the ascii data.
-     * @param buffOut The output buffer containing the floats
-     * @param sizeOut The size of the output buffer
+     * @param buffOut The output buffer receiving the size header followed by
+     *                the floats, it has to hold sizeOut+1 floats
+     * @param sizeOut The number of floats following the size header
      */
     void readDataBinary2Float(char *buffIn, float* buffOut, SIZE_T sizeOut);
 
@@ -2031,6 +2031,13 @@ typedef struct {
   GLuint n3f_vbo;
   GLuint c3f_vbo;
 
+  float4 *xyzr_h;            ///< host staging buffer for coords and radii
+  long int xyzr_h_natoms;    ///< capacity of the staging buffer
+
+  int devpropvalid;          ///< whether devprop holds the properties of devpropdev
+  int devpropdev;
+  cudaDeviceProp devprop;
+
   //cudaGraphicsResource *v3f_res;
   //cudaGraphicsResource *n3f_res;
   //cudaGraphicsResource *c3f_res;
@@ -2038,6 +2045,33 @@ typedef struct {
 } qsurf_gpuhandle;
 
 
+// Answer a host staging buffer for at least natoms atoms, kept across
+// frames so trajectories don't pay for a host allocation per frame
+static float4 *qsurf_host_xyzr(qsurf_gpuhandle *gpuh, long int natoms) {
+  if (gpuh->xyzr_h == NULL || gpuh->xyzr_h_natoms < natoms) {
+    free(gpuh->xyzr_h);
+    gpuh->xyzr_h = (float4 *) malloc(natoms * sizeof(float4));
+    gpuh->xyzr_h_natoms = (gpuh->xyzr_h != NULL) ? natoms : 0;
+  }
+  return gpuh->xyzr_h;
+}
+
+// Querying the device properties takes milliseconds, so they are only
+// queried again if the current device changed
+static cudaError_t qsurf_device_props(qsurf_gpuhandle *gpuh, int dev,
+                                      cudaDeviceProp *prop) {
+  if (!gpuh->devpropvalid || gpuh->devpropdev != dev) {
+    cudaError_t err = cudaGetDeviceProperties(&gpuh->devprop, dev);
+    if (err != cudaSuccess)
+      return err;
+    gpuh->devpropdev = dev;
+    gpuh->devpropvalid = 1;
+  }
+  *prop = gpuh->devprop;
+  return cudaSuccess;
+}
+
+
 CUDAQuickSurf::CUDAQuickSurf() {
   voidgpu = calloc(1, sizeof(qsurf_gpuhandle));
   useGaussKernel = true;
@@ -2055,6 +2089,7 @@ CUDAQuickSurf::~CUDAQuickSurf() {
   // delete marching cubes object
   delete gpuh->mc;
 
+  free(gpuh->xyzr_h);
   free(voidgpu);
 }
 
@@ -2599,7 +2634,9 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
 
   // short-term fix until a new CUDA kernel takes care of this
   int i, i4;
-  float4 *xyzr = (float4 *) malloc(natoms * sizeof(float4));
+  float4 *xyzr = qsurf_host_xyzr(gpuh, natoms);
+  if (xyzr == NULL)
+    return -1;
   for (i=0,i4=0; i<natoms; i++,i4+=4) {
     xyzr[i].x = xyzr_f[i4    ];
     xyzr[i].y = xyzr_f[i4 + 1];
@@ -2632,16 +2669,14 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   int dev;
   if (cudaGetDevice(&dev) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
  
   memset(&deviceProp, 0, sizeof(cudaDeviceProp));
   
-  if (cudaGetDeviceProperties(&deviceProp, dev) != cudaSuccess) {
+  if (qsurf_device_props(gpuh, dev, &deviceProp) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
     err = cudaGetLastError(); // eat error so next CUDA op succeeds
-    free(xyzr);
     return -1;
   }
 
@@ -2657,7 +2692,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   if ((deviceProp.major < 2) &&
       ((deviceProp.major == 1) && (deviceProp.minor < 3))) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
 
@@ -2704,7 +2738,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
                        chunksz.x, chunksz.y, chunksz.z,
                        slabsz.x, slabsz.y, slabsz.z) == -1) {
       wkf_timer_destroy(globaltimer);
-      free(xyzr);
       return -1;
     }
   }
@@ -2727,7 +2760,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   cudaMemcpy(gpuh->xyzr_d, xyzr, natoms * sizeof(float4), cudaMemcpyHostToDevice);
   if (colorperatom)
     cudaMemcpy(gpuh->color_d, colors, natoms * sizeof(float4), cudaMemcpyHostToDevice);
-  free(xyzr);
  
   // build uniform grid acceleration structure
   if (vmd_cuda_build_density_atom_grid(natoms, gpuh->xyzr_d, gpuh->color_d,
@@ -3244,7 +3276,9 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
 
   // short-term fix until a new CUDA kernel takes care of this
   int i, i4;
-  float4 *xyzr = (float4 *) malloc(natoms * sizeof(float4));
+  float4 *xyzr = qsurf_host_xyzr(gpuh, natoms);
+  if (xyzr == NULL)
+    return -1;
   for (i=0,i4=0; i<natoms; i++,i4+=4) {
     xyzr[i].x = xyzr_f[i4    ] - origin[0];
     xyzr[i].y = xyzr_f[i4 + 1] - origin[1];
@@ -3277,16 +3311,14 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   int dev;
   if (cudaGetDevice(&dev) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
  
   memset(&deviceProp, 0, sizeof(cudaDeviceProp));
   
-  if (cudaGetDeviceProperties(&deviceProp, dev) != cudaSuccess) {
+  if (qsurf_device_props(gpuh, dev, &deviceProp) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
     err = cudaGetLastError(); // eat error so next CUDA op succeeds
-    free(xyzr);
     return -1;
   }
 
@@ -3302,7 +3334,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   if ((deviceProp.major < 2) &&
       ((deviceProp.major == 1) && (deviceProp.minor < 3))) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
 
@@ -3354,7 +3385,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
                        chunksz.x, chunksz.y, chunksz.z,
                        slabsz.x, slabsz.y, slabsz.z) == -1) {
       wkf_timer_destroy(globaltimer);
-      free(xyzr);
       return -1;
     }
 
@@ -3381,7 +3411,6 @@ int CUDAQuickSurf::calc_surf(long int natoms, const float *xyzr_f,
   cudaMemcpy(gpuh->xyzr_d, xyzr, natoms * sizeof(float4), cudaMemcpyHostToDevice);
   if (colorperatom)
     cudaMemcpy(gpuh->color_d, colors, natoms * sizeof(float4), cudaMemcpyHostToDevice);
-  free(xyzr);
  
   // build uniform grid acceleration structure
   if (vmd_cuda_build_density_atom_grid(natoms, gpuh->xyzr_d, gpuh->color_d,
@@ -3865,7 +3894,9 @@ int CUDAQuickSurf::calc_map(long int natoms, const float *xyzr_f,
 
   // short-term fix until a new CUDA kernel takes care of this
   int i, i4;
-  float4 *xyzr = (float4 *) malloc(natoms * sizeof(float4));
+  float4 *xyzr = qsurf_host_xyzr(gpuh, natoms);
+  if (xyzr == NULL)
+    return -1;
   for (i=0,i4=0; i<natoms; i++,i4+=4) {
     xyzr[i].x = xyzr_f[i4    ];
     xyzr[i].y = xyzr_f[i4 + 1];
@@ -3887,16 +3918,14 @@ int CUDAQuickSurf::calc_map(long int natoms, const float *xyzr_f,
   int dev;
   if (cudaGetDevice(&dev) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
  
   memset(&deviceProp, 0, sizeof(cudaDeviceProp));
   
-  if (cudaGetDeviceProperties(&deviceProp, dev) != cudaSuccess) {
+  if (qsurf_device_props(gpuh, dev, &deviceProp) != cudaSuccess) {
     wkf_timer_destroy(globaltimer);
     err = cudaGetLastError(); // eat error so next CUDA op succeeds
-    free(xyzr);
     return -1;
   }
 
@@ -3912,7 +3941,6 @@ int CUDAQuickSurf::calc_map(long int natoms, const float *xyzr_f,
   if ((deviceProp.major < 2) &&
       ((deviceProp.major == 1) && (deviceProp.minor < 3))) {
     wkf_timer_destroy(globaltimer);
-    free(xyzr);
     return -1;
   }
 
@@ -3960,7 +3988,6 @@ int CUDAQuickSurf::calc_map(long int natoms, const float *xyzr_f,
                        chunksz.x, chunksz.y, chunksz.z,
                        slabsz.x, slabsz.y, slabsz.z, storeNearestAtom) == -1) {
       wkf_timer_destroy(globaltimer);
-      free(xyzr);
       return -1;
     }
   }
@@ -3996,7 +4023,6 @@ int CUDAQuickSurf::calc_map(long int natoms, const float *xyzr_f,
       setArrayToInt<<<grid, 256>>>( gridDim, gpuh->nearest_atom_d, -1);
   }
   
-  free(xyzr);
  
   // build uniform grid acceleration structure
   if (vmd_cuda_build_density_atom_grid(natoms, gpuh->xyzr_d, gpuh->color_d,
@@ -19,6 +19,8 @@
 #include <cuda_gl_interop.h>
 #include "helper_math.h"
 
+#include <algorithm>
+
 using namespace megamol;
 using namespace megamol::protein_cuda;
 
@@ -52,6 +54,7 @@ inline __device__ uint getThreadIdx() {
  * @param nSegments The number of segments in one line
  * @param step The step size
  * @param the offset for the line strip buffer to get current position
+ * @param firstStreamline The first streamline to be integrated
  */
 __global__ void CUDAStreamlines_IntegrateRK4Step(
         float *lineStrip_D,
@@ -62,9 +65,10 @@ __global__ void CUDAStreamlines_IntegrateRK4Step(
         int offset,
         int vboPosOffs,
         int vboStride,
-        float dir) {
+        float dir,
+        int firstStreamline) {
 
-    const uint idx = ::getThreadIdx();
+    const uint idx = ::getThreadIdx() + firstStreamline;
     if (idx >= nStreamlines) return;
 
     const uint lineBuffSize = (nSegments+1)*vboStride;
@@ -148,9 +152,10 @@ __global__ void CUDAStreamlines_SampleScalarFieldToAlpha_D(
         int nSegments,
         int vboPosOffs,
         int vboColOffs,
-        int vboStride) {
+        int vboStride,
+        int firstVertex) {
 
-    const uint idx = ::getThreadIdx();
+    const uint idx = ::getThreadIdx() + firstVertex;
     const int vertexCnt = nStreamlines*(nSegments+1);
     if (idx >= vertexCnt) return;
 
@@ -174,9 +179,10 @@ __global__ void CUDAStreamlines_SampleVecFieldToRGB_D(
         int nSegments,
         int vboPosOffs,
         int vboColOffs,
-        int vboStride) {
+        int vboStride,
+        int firstVertex) {
 
-    const uint idx = ::getThreadIdx();
+    const uint idx = ::getThreadIdx() + firstVertex;
     const int vertexCnt = nStreamlines*(nSegments+1);
     if (idx >= vertexCnt) return;
 
@@ -220,7 +226,8 @@ __global__ void CUDAStreamlines_SetUniformRGBColor_D(
 /*
  * CUDAStreamlines::CUDAStreamlines
  */
-CUDAStreamlines::CUDAStreamlines() : cudaToken(NULL), lineStripVBO(0) {
+CUDAStreamlines::CUDAStreamlines() : cudaToken(NULL), lineStripVBO(0), vboCapacity(0),
+        nSegments(0), nStreamlines(0), dir(CUDAStreamlines::FORWARD) {
     // EMPTY
 };
 
@@ -233,6 +240,7 @@ CUDAStreamlines::~CUDAStreamlines() {
         this->destroyVBO();
     }
     this->vecField_D.Release();
+    this->sclField_D.Release();
 }
 
 
@@ -240,15 +248,36 @@ CUDAStreamlines::~CUDAStreamlines() {
  * CUDAStreamlines::InitStreamlines
  */
 bool CUDAStreamlines::InitStreamlines(int nSegments, int nStreamlines, Direction dir) {
-    if ((dir == CUDAStreamlines::FORWARD)||(dir == CUDAStreamlines::BACKWARD)) {
-        this->nSegments = nSegments;
-    } else if (dir == CUDAStreamlines::BIDIRECTIONAL) {
-        this->nSegments = nSegments*2;
+    if (dir == CUDAStreamlines::BIDIRECTIONAL) {
+        nSegments *= 2;
+    }
+
+    // The lines in the buffer remain valid as long as their layout does not
+    // change
+    int keepCnt = 0;
+    if ((nSegments == this->nSegments) && (dir == this->dir)) {
+        keepCnt = std::min(nStreamlines, this->nStreamlines);
     }
 
+    this->nSegments = nSegments;
     this->nStreamlines = nStreamlines;
     this->dir = dir;
-    if (!this->initVBO()) {
+
+    // Start and length of all line strips in the buffer
+    this->lineFirst.resize(this->nStreamlines);
+    this->lineCount.resize(this->nStreamlines);
+    for (int cnt = 0; cnt < this->nStreamlines; ++cnt) {
+        this->lineFirst[cnt] = cnt*(this->nSegments+1);
+        this->lineCount[cnt] = this->nSegments+1;
+    }
+
+    // Only grow the buffer, such that adding streamlines step by step does
+    // not reallocate it every time
+    size_t vboSize = size_t(this->nStreamlines)*(this->nSegments+1)*CUDAStreamlines::vboStride;
+    if ((this->lineStripVBO != 0) && (vboSize <= this->vboCapacity)) {
+        return true;
+    }
+    if (!this->initVBO(std::max(vboSize, this->vboCapacity + this->vboCapacity/2), keepCnt)) {
         return false;
     }
     return ::CheckForGLError();
@@ -256,86 +285,95 @@ bool CUDAStreamlines::InitStreamlines(int nSegments, int nStreamlines, Direction
 
 
 /*
- * CUDAStreamlines::IntegrateRK4
+ * CUDAStreamlines::SetVecField
  */
-bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
-        float *vecField, int3 vecFieldDim, float3 vecFieldOrg, float3 vecFieldDelta) {
+bool CUDAStreamlines::SetVecField(const float *vecField, int3 vecFieldDim,
+        float3 vecFieldOrg, float3 vecFieldDelta) {
 
-    // Get pointer to line strip
-    if (!CudaSafeCall(cudaGraphicsMapResources(1, &this->cudaToken, 0))) {
-        return false;
-    }
+    this->vecFieldDim = vecFieldDim;
+    this->vecFieldOrg = vecFieldOrg;
+    this->vecFieldDelta = vecFieldDelta;
 
-    // Get mapped pointers to the vertex data buffers
-    float *lineStrip_D;
-    size_t vboSize;
-    if (!CudaSafeCall(cudaGraphicsResourceGetMappedPointer(
-            reinterpret_cast<void**>(&lineStrip_D), // The mapped pointer
-            &vboSize,                  // The size of the accessible data
-            this->cudaToken))) {                 // The mapped resource
+    size_t latticeSize = vecFieldDim.x*vecFieldDim.y*vecFieldDim.z;
+
+    // Copy vector field to device memory
+    if (!CudaSafeCall(this->vecField_D.Validate(latticeSize*3))) {
         return false;
     }
+    return CudaSafeCall(cudaMemcpy(this->vecField_D.Peek(), vecField,
+            sizeof(float)*3*latticeSize, cudaMemcpyHostToDevice));
+}
 
-    // Init constant grid parameters of the vector field
-    if (!initGridParams(vecFieldDim, vecFieldOrg, vecFieldDelta)) {
+
+/*
+ * CUDAStreamlines::SetScalarField
+ */
+bool CUDAStreamlines::SetScalarField(const float *field, int3 fieldDim,
+        float3 fieldOrg, float3 fieldDelta) {
+
+    this->sclFieldDim = fieldDim;
+    this->sclFieldOrg = fieldOrg;
+    this->sclFieldDelta = fieldDelta;
+
+    size_t latticeSize = fieldDim.x*fieldDim.y*fieldDim.z;
+
+    // Copy scalar field to device memory
+    if (!CudaSafeCall(this->sclField_D.Validate(latticeSize))) {
         return false;
     }
+    return CudaSafeCall(cudaMemcpy(this->sclField_D.Peek(), field,
+            sizeof(float)*latticeSize, cudaMemcpyHostToDevice));
+}
 
-    size_t latticeSize = vecFieldDim.x*vecFieldDim.y*vecFieldDim.z;
 
-    // Copy vector field to device memory
-    if (!CudaSafeCall(this->vecField_D.Validate(latticeSize*3))) {
-        return false;
+/*
+ * CUDAStreamlines::IntegrateRK4
+ */
+bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step, int firstStreamline) {
+
+    if (firstStreamline >= this->nStreamlines) {
+        return true; // Nothing to integrate
     }
-    if (!CudaSafeCall(cudaMemcpy(this->vecField_D.Peek(), vecField,
-            sizeof(float)*3*latticeSize, cudaMemcpyHostToDevice))) {
+    const int cnt = this->nStreamlines - firstStreamline;
+
+    // Get mapped pointer to the line strip
+    float *lineStrip_D;
+    if (!this->mapLineStrip(&lineStrip_D)) {
         return false;
     }
 
-    ::CheckForCudaErrorSync();
-
-//    for (int i = 0; i < this->nStreamlines; ++i) {
-//        printf("seed point #%i %f %f %f\n", i,
-//                seedPoints[3*i+0],
-//                seedPoints[3*i+1],
-//                seedPoints[3*i+2]);
-//    }
-
-    // Init streamlines with starting position
-    if ((this->dir == CUDAStreamlines::BACKWARD)||(this->dir == CUDAStreamlines::FORWARD)) {
-        size_t lineBuffSize = (this->nSegments+1)*CUDAStreamlines::vboStride;
-        for (int cnt = 0; cnt < this->nStreamlines; ++cnt) {
-            if (!CudaSafeCall(cudaMemcpy(
-                    lineStrip_D+lineBuffSize*cnt,
-                    //seedPoints+cnt*sizeof(float)*3,
-                    seedPoints+cnt*3,
-                    sizeof(float)*3,
-                    cudaMemcpyHostToDevice))) {
-                return false;
-            }
-        }
-    } else if (this->dir == CUDAStreamlines::BIDIRECTIONAL) {
-        size_t lineBuffSize = (this->nSegments+1)*CUDAStreamlines::vboStride;
-        for (int cnt = 0; cnt < this->nStreamlines; ++cnt) {
-            if (!CudaSafeCall(cudaMemcpy(
-                    CUDAStreamlines::vboStride*(this->nSegments/2) + lineStrip_D+lineBuffSize*cnt,
-                    //seedPoints+cnt*sizeof(float)*3,
-                    seedPoints+cnt*3,
-                    sizeof(float)*3,
-                    cudaMemcpyHostToDevice))) {
-                return false;
-            }
-        }
+    // Init constant grid parameters of the vector field
+    if (!initGridParams(this->vecFieldDim, this->vecFieldOrg, this->vecFieldDelta)) {
+        return false;
     }
 
-    ::CheckForCudaErrorSync();
+    // Init streamlines with starting position. The seed point is the first
+    // vertex of the line strip or its center if integrating in both
+    // directions. All seed points are copied at once.
+    size_t lineBuffSize = (this->nSegments+1)*CUDAStreamlines::vboStride;
+    size_t seedOffs = CUDAStreamlines::vboOffsPos;
+    if (this->dir == CUDAStreamlines::BIDIRECTIONAL) {
+        seedOffs += CUDAStreamlines::vboStride*(this->nSegments/2);
+    }
+    if (!CudaSafeCall(cudaMemcpy2D(
+            lineStrip_D + lineBuffSize*firstStreamline + seedOffs,
+            lineBuffSize*sizeof(float),
+            seedPoints + 3*firstStreamline,
+            3*sizeof(float),
+            3*sizeof(float),
+            cnt,
+            cudaMemcpyHostToDevice))) {
+        return false;
+    }
 
+    // The integration steps are queued without synchronizing, the kernels of
+    // the default stream are executed in order anyway
     if (this->dir == CUDAStreamlines::FORWARD) {
 
         // RK4 integration
         for (int it = 0; it < this->nSegments; ++it) {
             // Call cuda kernel for one integration step
-            CUDAStreamlines_IntegrateRK4Step <<< Grid(this->nStreamlines, 256), 256 >>> (
+            CUDAStreamlines_IntegrateRK4Step <<< Grid(cnt, 256), 256 >>> (
                     lineStrip_D,
                     this->vecField_D.Peek(),
                     this->nStreamlines,
@@ -344,9 +382,10 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
                     it, // Offset for line strip buffer to get current position
                     CUDAStreamlines::vboOffsPos,
                     CUDAStreamlines::vboStride,
-                    1.0 // Direction
+                    1.0, // Direction
+                    firstStreamline
             );
-            if (!::CheckForCudaErrorSync()) {
+            if (!::CheckForCudaError()) {
                 return false;
             }
         }
@@ -354,7 +393,7 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
         // RK4 integration
         for (int it = 0; it < this->nSegments; ++it) {
             // Call cuda kernel for one integration step
-            CUDAStreamlines_IntegrateRK4Step <<< Grid(this->nStreamlines, 256), 256 >>> (
+            CUDAStreamlines_IntegrateRK4Step <<< Grid(cnt, 256), 256 >>> (
                     lineStrip_D,
                     this->vecField_D.Peek(),
                     this->nStreamlines,
@@ -363,18 +402,18 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
                     it, // Offset for line strip buffer to get current position
                     CUDAStreamlines::vboOffsPos,
                     CUDAStreamlines::vboStride,
-                    -1.0 // Direction
+                    -1.0, // Direction
+                    firstStreamline
             );
-            if (!::CheckForCudaErrorSync()) {
+            if (!::CheckForCudaError()) {
                 return false;
             }
         }
     } else {
         // RK4 forward integration
         for (int it = this->nSegments/2; it < this->nSegments; ++it) {
-        //for (int it = this->nSegments; it < 1; ++it) {
             // Call cuda kernel for one integration step
-            CUDAStreamlines_IntegrateRK4Step <<< Grid(this->nStreamlines, 256), 256 >>> (
+            CUDAStreamlines_IntegrateRK4Step <<< Grid(cnt, 256), 256 >>> (
                     lineStrip_D,
                     this->vecField_D.Peek(),
                     this->nStreamlines,
@@ -383,9 +422,10 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
                     it, // Offset for line strip buffer to get current position
                     CUDAStreamlines::vboOffsPos,
                     CUDAStreamlines::vboStride,
-                    1.0 // Direction
+                    1.0, // Direction
+                    firstStreamline
             );
-            if (!::CheckForCudaErrorSync()) {
+            if (!::CheckForCudaError()) {
                 return false;
             }
         }
@@ -393,7 +433,7 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
         // RK4 backward integration
         for (int it = this->nSegments/2; it > 0; --it) {
             // Call cuda kernel for one integration step
-            CUDAStreamlines_IntegrateRK4Step <<< Grid(this->nStreamlines, 256), 256 >>> (
+            CUDAStreamlines_IntegrateRK4Step <<< Grid(cnt, 256), 256 >>> (
                     lineStrip_D,
                     this->vecField_D.Peek(),
                     this->nStreamlines,
@@ -402,34 +442,18 @@ bool CUDAStreamlines::IntegrateRK4(const float *seedPoints, float step,
                     it, // Offset for line strip buffer to get current position
                     CUDAStreamlines::vboOffsPos,
                     CUDAStreamlines::vboStride,
-                    -1.0 // Direction
+                    -1.0, // Direction
+                    firstStreamline
             );
-            if (!::CheckForCudaErrorSync()) {
+            if (!::CheckForCudaError()) {
                 return false;
             }
         }
 
     }
 
-//    HostArr<float> lineStrip;
-//    lineStrip.Validate(this->nStreamlines*(this->nSegments+1)*CUDAStreamlines::vboStride);
-//    if (!CudaSafeCall(cudaMemcpy(lineStrip.Peek(), lineStrip_D,
-//            lineStrip.GetCount()*sizeof(float), cudaMemcpyDeviceToHost))) {
-//        return false;
-//    }
-//    for (int s = 0; s < this->nStreamlines; ++s) {
-//        printf("streamline %i\n", s);
-//        for (int i = 0; i <= this->nSegments; ++i) {
-//            printf("%i: pos: %f %f %f\n", i,
-//                    lineStrip.Peek()[s*((this->nSegments+1)*CUDAStreamlines::vboStride)+CUDAStreamlines::vboStride*i+0],
-//                    lineStrip.Peek()[s*((this->nSegments+1)*CUDAStreamlines::vboStride)+CUDAStreamlines::vboStride*i+1],
-//                    lineStrip.Peek()[s*((this->nSegments+1)*CUDAStreamlines::vboStride)+CUDAStreamlines::vboStride*i+2]);
-//        }
-//        printf("---------------------------\n");
-//    }
-
     // Unmap the device pointer
-    if (!CudaSafeCall(cudaGraphicsUnmapResources(1, &this->cudaToken))) {
+    if (!this->unmapLineStrip()) {
         return false;
     }
 
@@ -447,16 +471,13 @@ bool CUDAStreamlines::RenderLineStrip() {
     glEnableClientState(GL_VERTEX_ARRAY);
     ::CheckForGLError();
 
-    // Draw stream lines using the line strip buffer
-    for (int cnt = 0; cnt < this->nStreamlines; ++cnt) {
-        int offs = cnt*CUDAStreamlines::vboStride*(this->nSegments+1)*sizeof(float);
-        glVertexPointer(3, GL_FLOAT,
-                CUDAStreamlines::vboStride*sizeof(float),
-                (const GLvoid*)((long int)(offs))); // last param is offset, not ptr
-
-        glDrawArrays(GL_LINE_STRIP_ADJACENCY, 0, this->nSegments+1);
-        ::CheckForGLError(); // OpenGL error check
-    }
+    // Draw all stream lines using the line strip buffer at once
+    glVertexPointer(3, GL_FLOAT,
+            CUDAStreamlines::vboStride*sizeof(float),
+            (const GLvoid*)((long int)(CUDAStreamlines::vboOffsPos*sizeof(float))));
+    glMultiDrawArrays(GL_LINE_STRIP_ADJACENCY, this->lineFirst.data(),
+            this->lineCount.data(), this->nStreamlines);
+    ::CheckForGLError(); // OpenGL error check
 
     glDisableClientState(GL_VERTEX_ARRAY);
     glBindBufferARB(GL_ARRAY_BUFFER, 0);
@@ -476,20 +497,16 @@ bool CUDAStreamlines::RenderLineStripWithColor() {
     glEnableClientState(GL_COLOR_ARRAY);
     ::CheckForGLError();
 
-    // Draw stream lines using the line strip buffer
-    for (int cnt = 0; cnt < this->nStreamlines; ++cnt) {
-        int offs = cnt*CUDAStreamlines::vboStride*(this->nSegments+1)*sizeof(float);
-        glVertexPointer(3, GL_FLOAT,
-                CUDAStreamlines::vboStride*sizeof(float),
-                (const GLvoid*)((long int)(offs))); // last param is offset, not ptr
-
-        glColorPointer(4, GL_FLOAT,
-                CUDAStreamlines::vboStride*sizeof(float),
-                (const GLvoid*)((long int)(offs + CUDAStreamlines::vboOffsCol*sizeof(float))));
-
-        glDrawArrays(GL_LINE_STRIP_ADJACENCY, 0, this->nSegments+1);
-        ::CheckForGLError(); // OpenGL error check
-    }
+    // Draw all stream lines using the line strip buffer at once
+    glVertexPointer(3, GL_FLOAT,
+            CUDAStreamlines::vboStride*sizeof(float),
+            (const GLvoid*)((long int)(CUDAStreamlines::vboOffsPos*sizeof(float))));
+    glColorPointer(4, GL_FLOAT,
+            CUDAStreamlines::vboStride*sizeof(float),
+            (const GLvoid*)((long int)(CUDAStreamlines::vboOffsCol*sizeof(float))));
+    glMultiDrawArrays(GL_LINE_STRIP_ADJACENCY, this->lineFirst.data(),
+            this->lineCount.data(), this->nStreamlines);
+    ::CheckForGLError(); // OpenGL error check
 
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_COLOR_ARRAY);
@@ -502,45 +519,25 @@ bool CUDAStreamlines::RenderLineStripWithColor() {
 /*
  * CUDAStreamlines::SampleScalarFieldToAlpha
  */
-bool CUDAStreamlines::SampleScalarFieldToAlpha(
-        float *field,
-        int3 fieldDim,
-        float3 fieldOrg,
-        float3 fieldDelta) {
+bool CUDAStreamlines::SampleScalarFieldToAlpha(int firstStreamline) {
 
-    // Get pointer to line strip
-    if (!CudaSafeCall(cudaGraphicsMapResources(1, &this->cudaToken, 0))) {
-        return false;
+    if (firstStreamline >= this->nStreamlines) {
+        return true; // Nothing to sample
     }
 
-    // Get mapped pointers to the vertex data buffers
+    // Get mapped pointer to the line strip
     float *lineStrip_D;
-    size_t vboSize;
-    if (!CudaSafeCall(cudaGraphicsResourceGetMappedPointer(
-            reinterpret_cast<void**>(&lineStrip_D), // The mapped pointer
-            &vboSize,                  // The size of the accessible data
-            this->cudaToken))) {                 // The mapped resource
+    if (!this->mapLineStrip(&lineStrip_D)) {
         return false;
     }
 
-    // Init constant grid parameters of the vector field
-    if (!initGridParams(fieldDim, fieldOrg, fieldDelta)) {
+    // Init constant grid parameters of the scalar field
+    if (!initGridParams(this->sclFieldDim, this->sclFieldOrg, this->sclFieldDelta)) {
         return false;
     }
 
-    size_t latticeSize = fieldDim.x*fieldDim.y*fieldDim.z;
-
-    // Copy scalar field to device memory
-    if (!CudaSafeCall(this->sclField_D.Validate(latticeSize))) {
-        return false;
-    }
-    if (!CudaSafeCall(cudaMemcpy(this->sclField_D.Peek(), field,
-            sizeof(float)*latticeSize, cudaMemcpyHostToDevice))) {
-        return false;
-    }
-    ::CheckForCudaErrorSync();
-
-    int vertexCnt = this->nStreamlines*(this->nSegments+1);
+    int firstVertex = firstStreamline*(this->nSegments+1);
+    int vertexCnt = this->nStreamlines*(this->nSegments+1) - firstVertex;
     CUDAStreamlines_SampleScalarFieldToAlpha_D <<< Grid(vertexCnt, 256), 256 >>>(
             lineStrip_D,
             this->sclField_D.Peek(),
@@ -548,14 +545,15 @@ bool CUDAStreamlines::SampleScalarFieldToAlpha(
             this->nSegments,
             CUDAStreamlines::vboOffsPos,
             CUDAStreamlines::vboOffsCol,
-            CUDAStreamlines::vboStride);
+            CUDAStreamlines::vboStride,
+            firstVertex);
 
-    if (!::CheckForCudaErrorSync()){
+    if (!::CheckForCudaError()){
         return false;
     }
 
     // Unmap the device pointer
-    if (!CudaSafeCall(cudaGraphicsUnmapResources(1, &this->cudaToken))) {
+    if (!this->unmapLineStrip()) {
         return false;
     }
 
@@ -563,45 +561,28 @@ bool CUDAStreamlines::SampleScalarFieldToAlpha(
 }
 
 
-bool CUDAStreamlines::SampleVecFieldToRGB(
-        float *field,
-        int3 fieldDim,
-        float3 fieldOrg,
-        float3 fieldDelta) {
+/*
+ * CUDAStreamlines::SampleVecFieldToRGB
+ */
+bool CUDAStreamlines::SampleVecFieldToRGB(int firstStreamline) {
 
-    // Get pointer to line strip
-    if (!CudaSafeCall(cudaGraphicsMapResources(1, &this->cudaToken, 0))) {
-        return false;
+    if (firstStreamline >= this->nStreamlines) {
+        return true; // Nothing to sample
     }
 
-    // Get mapped pointers to the vertex data buffers
+    // Get mapped pointer to the line strip
     float *lineStrip_D;
-    size_t vboSize;
-    if (!CudaSafeCall(cudaGraphicsResourceGetMappedPointer(
-            reinterpret_cast<void**>(&lineStrip_D), // The mapped pointer
-            &vboSize,                  // The size of the accessible data
-            this->cudaToken))) {                 // The mapped resource
+    if (!this->mapLineStrip(&lineStrip_D)) {
         return false;
     }
 
     // Init constant grid parameters of the vector field
-    if (!initGridParams(fieldDim, fieldOrg, fieldDelta)) {
+    if (!initGridParams(this->vecFieldDim, this->vecFieldOrg, this->vecFieldDelta)) {
         return false;
     }
 
-    size_t latticeSize = fieldDim.x*fieldDim.y*fieldDim.z;
-
-    // Copy vector field to device memory
-    if (!CudaSafeCall(this->vecField_D.Validate(latticeSize*3))) {
-        return false;
-    }
-    if (!CudaSafeCall(cudaMemcpy(this->vecField_D.Peek(), field,
-            sizeof(float)*latticeSize*3, cudaMemcpyHostToDevice))) {
-        return false;
-    }
-    ::CheckForCudaErrorSync();
-
-    int vertexCnt = this->nStreamlines*(this->nSegments+1);
+    int firstVertex = firstStreamline*(this->nSegments+1);
+    int vertexCnt = this->nStreamlines*(this->nSegments+1) - firstVertex;
     CUDAStreamlines_SampleVecFieldToRGB_D <<< Grid(vertexCnt, 256), 256 >>>(
             lineStrip_D,
             this->vecField_D.Peek(),
@@ -609,20 +590,19 @@ bool CUDAStreamlines::SampleVecFieldToRGB(
             this->nSegments,
             CUDAStreamlines::vboOffsPos,
             CUDAStreamlines::vboOffsCol,
-            CUDAStreamlines::vboStride);
+            CUDAStreamlines::vboStride,
+            firstVertex);
 
-    if (!::CheckForCudaErrorSync()){
+    if (!::CheckForCudaError()){
         return false;
     }
 
-
     // Unmap the device pointer
-    if (!CudaSafeCall(cudaGraphicsUnmapResources(1, &this->cudaToken))) {
+    if (!this->unmapLineStrip()) {
         return false;
     }
 
     return CheckForCudaErrorSync();
-
 }
 
 
@@ -631,18 +611,9 @@ bool CUDAStreamlines::SampleVecFieldToRGB(
  */
 bool CUDAStreamlines::SetUniformRGBColor(float3 col) {
 
-    // Get pointer to line strip
-    if (!CudaSafeCall(cudaGraphicsMapResources(1, &this->cudaToken, 0))) {
-        return false;
-    }
-
-    // Get mapped pointers to the vertex data buffers
+    // Get mapped pointer to the line strip
     float *lineStrip_D;
-    size_t vboSize;
-    if (!CudaSafeCall(cudaGraphicsResourceGetMappedPointer(
-            reinterpret_cast<void**>(&lineStrip_D), // The mapped pointer
-            &vboSize,                  // The size of the accessible data
-            this->cudaToken))) {                 // The mapped resource
+    if (!this->mapLineStrip(&lineStrip_D)) {
         return false;
     }
 
@@ -655,13 +626,12 @@ bool CUDAStreamlines::SetUniformRGBColor(float3 col) {
             CUDAStreamlines::vboStride,
             col);
 
-    if (!::CheckForCudaErrorSync()){
+    if (!::CheckForCudaError()){
         return false;
     }
 
-
     // Unmap the device pointer
-    if (!CudaSafeCall(cudaGraphicsUnmapResources(1, &this->cudaToken))) {
+    if (!this->unmapLineStrip()) {
         return false;
     }
 
@@ -675,11 +645,13 @@ bool CUDAStreamlines::SetUniformRGBColor(float3 col) {
  */
 void CUDAStreamlines::destroyVBO() {
     if (this->lineStripVBO) {
+        CudaSafeCall(cudaGraphicsUnregisterResource(this->cudaToken));
+        this->cudaToken = NULL;
         glBindBufferARB(GL_ARRAY_BUFFER, this->lineStripVBO);
         glDeleteBuffersARB(1, &this->lineStripVBO);
         this->lineStripVBO = 0;
+        this->vboCapacity = 0;
         ::CheckForGLError();
-        CudaSafeCall(cudaGraphicsUnregisterResource(this->cudaToken));
     }
 }
 
@@ -687,22 +659,31 @@ void CUDAStreamlines::destroyVBO() {
 /*
  * CUDAStreamlines::initVBO
  */
-bool CUDAStreamlines::initVBO() {
-    // Destroy if necessary
-    if (this->lineStripVBO != 0) {
-        glBindBufferARB(GL_ARRAY_BUFFER, this->lineStripVBO);
-        glDeleteBuffersARB(1, &this->lineStripVBO);
-        this->lineStripVBO = 0;
-    }
+bool CUDAStreamlines::initVBO(size_t capacity, int keepCnt) {
 
     // Create vertex buffer object for vertex data
-    glGenBuffersARB(1, &this->lineStripVBO);
-    glBindBufferARB(GL_ARRAY_BUFFER, this->lineStripVBO);
-    glBufferDataARB(GL_ARRAY_BUFFER,
-            this->nStreamlines*(this->nSegments+1)*sizeof(float)*CUDAStreamlines::vboStride,
-            0, GL_DYNAMIC_DRAW);
+    GLuint vbo;
+    glGenBuffersARB(1, &vbo);
+    glBindBufferARB(GL_ARRAY_BUFFER, vbo);
+    glBufferDataARB(GL_ARRAY_BUFFER, capacity*sizeof(float), 0, GL_DYNAMIC_DRAW);
     glBindBufferARB(GL_ARRAY_BUFFER, 0);
 
+    // Copy the lines which remain valid on the GPU, such that they do not
+    // need to be integrated again
+    if ((this->lineStripVBO != 0) && (keepCnt > 0)) {
+        glBindBufferARB(GL_COPY_READ_BUFFER, this->lineStripVBO);
+        glBindBufferARB(GL_COPY_WRITE_BUFFER, vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                keepCnt*(this->nSegments+1)*CUDAStreamlines::vboStride*sizeof(float));
+        glBindBufferARB(GL_COPY_WRITE_BUFFER, 0);
+        glBindBufferARB(GL_COPY_READ_BUFFER, 0);
+    }
+
+    // Destroy the old buffer if necessary
+    this->destroyVBO();
+    this->lineStripVBO = vbo;
+    this->vboCapacity = capacity;
+
     // Register buffer with cuda token
     if (!CudaSafeCall(cudaGraphicsGLRegisterBuffer(
             &this->cudaToken,
@@ -713,3 +694,29 @@ bool CUDAStreamlines::initVBO() {
 
     return CheckForGLError();
 }
+
+
+/*
+ * CUDAStreamlines::mapLineStrip
+ */
+bool CUDAStreamlines::mapLineStrip(float **lineStrip_D) {
+
+    if (!CudaSafeCall(cudaGraphicsMapResources(1, &this->cudaToken, 0))) {
+        return false;
+    }
+
+    // Get mapped pointers to the vertex data buffers
+    size_t vboSize;
+    return CudaSafeCall(cudaGraphicsResourceGetMappedPointer(
+            reinterpret_cast<void**>(lineStrip_D), // The mapped pointer
+            &vboSize,                              // The size of the accessible data
+            this->cudaToken));                     // The mapped resource
+}
+
+
+/*
+ * CUDAStreamlines::unmapLineStrip
+ */
+bool CUDAStreamlines::unmapLineStrip() {
+    return CudaSafeCall(cudaGraphicsUnmapResources(1, &this->cudaToken));
+}
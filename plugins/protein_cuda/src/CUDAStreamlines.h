@@ -15,6 +15,8 @@
 #include "vislib/graphics/gl/IncludeAllGL.h"
 #include "CudaDevArr.h"
 
+#include <vector>
+
 namespace megamol {
 namespace protein_cuda {
 
@@ -42,7 +44,10 @@ public:
 
     /**
      * Initializes all the necessary parameters for the streamline integration
-     * and creates the line strip VBO.
+     * and creates the line strip VBO. The VBO is only reallocated if it is
+     * too small. If the number of segments and the direction do not change,
+     * the streamlines already in the VBO are kept, such that only added
+     * streamlines need to be integrated.
      *
      * @param nSegments The number of line segments per streamline
      * @param nStreamlines  The number of streamlines
@@ -52,25 +57,53 @@ public:
     bool InitStreamlines(int nSegments, int nStreamlines, Direction dir);
 
     /**
-     * Execute streamline integration starting at the given seedpoint array
-     * using fourth order Runge-Kutta integration.
+     * Copies the vector field to device memory, where it stays resident for
+     * the integration and the sampling until it is set again.
      *
-     * @param seedPoints    The starting point of the integration
-     * @param step          The step size of the integration
      * @param vecField      The vector field to be integrated
      * @param vecFieldDim   The dimensions of the lattice
      * @param vecFieldOrg   The WS origin of the lattice
      * @param vecFieldDelta The spacing of the lattice
      * @return 'True' on success, 'false' otherwise
      */
-    bool IntegrateRK4(
-            const float *seedPoints,
-            float step,
-            float *vecField,
+    bool SetVecField(
+            const float *vecField,
             int3 vecFieldDim,
             float3 vecFieldOrg,
             float3 vecFieldDelta);
 
+    /**
+     * Copies the scalar field to device memory, where it stays resident for
+     * the sampling until it is set again.
+     *
+     * @param field      The scalar field to be sampled
+     * @param fieldDim   The dimensions of the lattice
+     * @param fieldOrg   The WS origin of the lattice
+     * @param fieldDelta The spacing of the lattice
+     * @return 'True' on success, 'false' otherwise
+     */
+    bool SetScalarField(
+            const float *field,
+            int3 fieldDim,
+            float3 fieldOrg,
+            float3 fieldDelta);
+
+    /**
+     * Execute streamline integration in the resident vector field starting at
+     * the given seedpoint array using fourth order Runge-Kutta integration.
+     * The line vertices are written directly into the VBO.
+     *
+     * @param seedPoints      The starting points of all streamlines
+     * @param step            The step size of the integration
+     * @param firstStreamline The first streamline to be integrated, the
+     *                        ones before are left untouched
+     * @return 'True' on success, 'false' otherwise
+     */
+    bool IntegrateRK4(
+            const float *seedPoints,
+            float step,
+            int firstStreamline = 0);
+
     /**
      * Render the streamlines using GL_Line_Strip.
      *
@@ -87,36 +120,22 @@ public:
     bool RenderLineStripWithColor();
 
     /**
-     * Samples a given scalar field and stores the value in the alpha component
-     * of the RGBA color value in the VBO.
+     * Samples the resident scalar field and stores the value in the alpha
+     * component of the RGBA color value in the VBO.
      *
-     * @param field      The scalar field to be sampled
-     * @param fieldDim   The dimensions of the lattice
-     * @param fieldOrg   The WS origin of the lattice
-     * @param fieldDelta The spacing of the lattice
+     * @param firstStreamline The first streamline to be sampled
      * @return 'True' on success, 'false' otherwise
      */
-    bool SampleScalarFieldToAlpha(
-            float *field,
-            int3 fieldDim,
-            float3 fieldOrg,
-            float3 fieldDelta);
+    bool SampleScalarFieldToAlpha(int firstStreamline = 0);
 
     /**
-     * Samples a given vector field and stores the value in the RGB components
-     * of the RGBA color value in the VBO.
+     * Samples the resident vector field and stores the value in the RGB
+     * components of the RGBA color value in the VBO.
      *
-     * @param vecField   The vector field to be sampled
-     * @param fieldDim   The dimensions of the lattice
-     * @param fieldOrg   The WS origin of the lattice
-     * @param fieldDelta The spacing of the lattice
+     * @param firstStreamline The first streamline to be sampled
      * @return 'True' on success, 'false' otherwise
      */
-    bool SampleVecFieldToRGB(
-            float *vecField,
-            int3 fieldDim,
-            float3 fieldOrg,
-            float3 fieldDelta);
+    bool SampleVecFieldToRGB(int firstStreamline = 0);
 
     /**
      * Initializes the RGB part of the color with a uniform value
@@ -136,11 +155,29 @@ protected:
 
     /**
      * Initializes the vertex buffer object holding the line strip and registers
-     * the cuda resource with it.
+     * the cuda resource with it. The given number of streamlines is copied
+     * from the old buffer.
+     *
+     * @param capacity The size of the buffer in floats
+     * @param keepCnt  The number of streamlines to be kept
+     * @return 'True' on success, 'false' otherwise
+     */
+    bool initVBO(size_t capacity, int keepCnt);
+
+    /**
+     * Maps the vertex buffer object for the use with cuda.
      *
+     * @param lineStrip_D Receives the device pointer to the line strip
      * @return 'True' on success, 'false' otherwise
      */
-    bool initVBO();
+    bool mapLineStrip(float **lineStrip_D);
+
+    /**
+     * Unmaps the vertex buffer object.
+     *
+     * @return 'True' on success, 'false' otherwise
+     */
+    bool unmapLineStrip();
 
 private:
 
@@ -150,6 +187,9 @@ private:
     /// The OpenGL handle for the vertex buffer object holding the line strip
     GLuint lineStripVBO;
 
+    /// The size of the vertex buffer object in floats
+    size_t vboCapacity;
+
     /// The maximum number of line segments
     int nSegments;
 
@@ -159,12 +199,26 @@ private:
     /// The direction of the integration
     Direction dir;
 
-    // Temporary device array for a vector field
+    /// The first vertex of every line strip
+    std::vector<GLint> lineFirst;
+
+    /// The number of vertices of every line strip
+    std::vector<GLsizei> lineCount;
+
+    // Resident device array for the vector field
     CudaDevArr<float> vecField_D;
 
-    // Temporary device array for a scalar field
+    // Resident device array for the scalar field
     CudaDevArr<float> sclField_D;
 
+    /// The lattice of the vector field
+    int3 vecFieldDim;
+    float3 vecFieldOrg, vecFieldDelta;
+
+    /// The lattice of the scalar field
+    int3 sclFieldDim;
+    float3 sclFieldOrg, sclFieldDelta;
+
 };
 
 } // end namespace protein_cuda
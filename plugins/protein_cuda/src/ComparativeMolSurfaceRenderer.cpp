@@ -1881,6 +1881,9 @@ bool ComparativeMolSurfaceRenderer::Render(core::Call& call) {
     using namespace vislib::sys;
     using namespace vislib::math;
 
+    // Attribute the device memory of the surfaces to this module
+    CudaMemoryPool::ScopedOwner poolOwner(ComparativeMolSurfaceRenderer::ClassName());
+
 #ifdef USE_TIMER
     time_t t;
 #endif
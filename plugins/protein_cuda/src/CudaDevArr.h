@@ -13,6 +13,7 @@
 
 #include "cuda_runtime.h"
 #include "cuda_error_check.h"
+#include "CudaMemoryPool.h"
 
 namespace megamol {
 namespace protein_cuda {
@@ -93,7 +94,7 @@ public:
      */
     inline cudaError_t Release() {
         if (this->pt_D != NULL) {
-            CudaSafeCall(cudaFree((void*)(this->pt_D)));
+            CudaSafeCall(CudaMemoryPool::Instance().Free((void*)(this->pt_D)));
         }
         this->size = 0;
         this->count = 0;
@@ -123,7 +124,7 @@ public:
 
         if((this->pt_D == NULL)||(sizeNew > this->size)) {
             this->Release();
-            CudaSafeCall(cudaMalloc((void**)&this->pt_D, sizeof(T)*sizeNew));
+            CudaSafeCall(CudaMemoryPool::Instance().Allocate((void**)&this->pt_D, sizeof(T)*sizeNew));
 //            printf("Allocated at %p\n", &this->pt_D);
             this->size = sizeNew;
         }
@@ -0,0 +1,270 @@
+//
+// CudaMemoryPool.cpp
+//
+// Copyright (C) 2019 by University of Stuttgart (VISUS).
+// All rights reserved.
+//
+
+#include "stdafx.h"
+#include "CudaMemoryPool.h"
+
+#include "vislib/sys/Log.h"
+
+#include <iterator>
+
+using namespace megamol;
+using namespace megamol::protein_cuda;
+
+namespace {
+    /// Owner of the allocations of the current thread
+    thread_local const char *currentOwner = "unnamed";
+
+    /// Size up to which blocks are rounded to powers of two
+    const size_t smallBlockLimit = 1 << 20;
+}
+
+
+/*
+ * CudaMemoryPool::ScopedOwner::ScopedOwner
+ */
+CudaMemoryPool::ScopedOwner::ScopedOwner(const char *owner) : previous(currentOwner) {
+    currentOwner = owner;
+}
+
+
+/*
+ * CudaMemoryPool::ScopedOwner::~ScopedOwner
+ */
+CudaMemoryPool::ScopedOwner::~ScopedOwner() {
+    currentOwner = this->previous;
+}
+
+
+/*
+ * CudaMemoryPool::Instance
+ */
+CudaMemoryPool& CudaMemoryPool::Instance() {
+    static CudaMemoryPool instance;
+    return instance;
+}
+
+
+/*
+ * CudaMemoryPool::Allocate
+ */
+cudaError_t CudaMemoryPool::Allocate(void **ptr, size_t bytes) {
+    *ptr = nullptr;
+    if (bytes == 0) {
+        return cudaSuccess;
+    }
+
+    int device = 0;
+    cudaError_t err = cudaGetDevice(&device);
+    if (err != cudaSuccess) {
+        return err;
+    }
+    const size_t size = roundUp(bytes);
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    Statistics& stats = this->statistics[currentOwner];
+    if ((stats.budget > 0) && (stats.allocatedBytes + size > stats.budget)) {
+        vislib::sys::Log::DefaultLog.WriteWarn("CudaMemoryPool: allocation of %zu bytes by '%s' exceeds its "
+            "budget of %zu bytes (%zu bytes allocated)", size, currentOwner, stats.budget, stats.allocatedBytes);
+        return cudaErrorMemoryAllocation;
+    }
+
+    auto hit = this->cached.find(std::make_pair(device, size));
+    if (hit != this->cached.end()) {
+        *ptr = hit->second;
+        this->cached.erase(hit);
+        this->cachedBytes -= size;
+        stats.numCacheHits++;
+    } else {
+        err = cudaMalloc(ptr, size);
+        if (err == cudaErrorMemoryAllocation) {
+            // Release the cache and try again
+            cudaGetLastError();
+            this->shrinkCache(0);
+            err = cudaMalloc(ptr, size);
+        }
+        if (err != cudaSuccess) {
+            *ptr = nullptr;
+            return err;
+        }
+    }
+
+    Block block;
+    block.device = device;
+    block.bytes = size;
+    block.owner = currentOwner;
+    this->used[*ptr] = block;
+
+    stats.numAllocations++;
+    stats.allocatedBytes += size;
+    if (stats.allocatedBytes > stats.peakBytes) {
+        stats.peakBytes = stats.allocatedBytes;
+    }
+    return cudaSuccess;
+}
+
+
+/*
+ * CudaMemoryPool::Free
+ */
+cudaError_t CudaMemoryPool::Free(void *ptr) {
+    if (ptr == nullptr) {
+        return cudaSuccess;
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto it = this->used.find(ptr);
+    if (it == this->used.end()) {
+        return cudaFree(ptr);
+    }
+
+    Statistics& stats = this->statistics[it->second.owner];
+    stats.allocatedBytes -= it->second.bytes;
+
+    this->cached.insert(std::make_pair(std::make_pair(it->second.device, it->second.bytes), ptr));
+    this->cachedBytes += it->second.bytes;
+    this->used.erase(it);
+
+    return this->shrinkCache(this->maxCachedBytes);
+}
+
+
+/*
+ * CudaMemoryPool::Trim
+ */
+cudaError_t CudaMemoryPool::Trim() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->shrinkCache(0);
+}
+
+
+/*
+ * CudaMemoryPool::SetBudget
+ */
+void CudaMemoryPool::SetBudget(const std::string& owner, size_t bytes) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->statistics[owner].budget = bytes;
+}
+
+
+/*
+ * CudaMemoryPool::SetMaxCachedBytes
+ */
+void CudaMemoryPool::SetMaxCachedBytes(size_t bytes) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->maxCachedBytes = bytes;
+    this->shrinkCache(this->maxCachedBytes);
+}
+
+
+/*
+ * CudaMemoryPool::GetStatistics
+ */
+CudaMemoryPool::Statistics CudaMemoryPool::GetStatistics(const std::string& owner) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto it = this->statistics.find(owner);
+    return (it != this->statistics.end()) ? it->second : Statistics();
+}
+
+
+/*
+ * CudaMemoryPool::GetCachedBytes
+ */
+size_t CudaMemoryPool::GetCachedBytes() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->cachedBytes;
+}
+
+
+/*
+ * CudaMemoryPool::LogStatistics
+ */
+void CudaMemoryPool::LogStatistics() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    vislib::sys::Log::DefaultLog.WriteInfo("CudaMemoryPool: %.2f MB cached in %zu blocks",
+        this->cachedBytes / (1024.0 * 1024.0), this->cached.size());
+    for (auto& s : this->statistics) {
+        vislib::sys::Log::DefaultLog.WriteInfo("CudaMemoryPool: '%s': %zu allocations (%zu from cache), "
+            "%.2f MB allocated, %.2f MB peak, budget %.2f MB", s.first.c_str(), s.second.numAllocations,
+            s.second.numCacheHits, s.second.allocatedBytes / (1024.0 * 1024.0),
+            s.second.peakBytes / (1024.0 * 1024.0), s.second.budget / (1024.0 * 1024.0));
+    }
+}
+
+
+/*
+ * CudaMemoryPool::CudaMemoryPool
+ */
+CudaMemoryPool::CudaMemoryPool() : cachedBytes(0), maxCachedBytes(static_cast<size_t>(512) << 20) {
+    // intentionally empty
+}
+
+
+/*
+ * CudaMemoryPool::~CudaMemoryPool
+ */
+CudaMemoryPool::~CudaMemoryPool() {
+    // The CUDA context may already be gone at static destruction, so the
+    // cached blocks are left to the driver.
+}
+
+
+/*
+ * CudaMemoryPool::roundUp
+ */
+size_t CudaMemoryPool::roundUp(size_t bytes) {
+    size_t size = 256;
+    while (size < bytes && size < smallBlockLimit) {
+        size <<= 1;
+    }
+    if (size >= bytes) {
+        return size;
+    }
+
+    // Above the limit, round to a quarter of the highest power of two
+    size_t highest = smallBlockLimit;
+    while ((highest << 1) <= bytes) {
+        highest <<= 1;
+    }
+    const size_t step = highest / 4;
+    return ((bytes + step - 1) / step) * step;
+}
+
+
+/*
+ * CudaMemoryPool::shrinkCache
+ */
+cudaError_t CudaMemoryPool::shrinkCache(size_t maxBytes) {
+    if (this->cachedBytes <= maxBytes) {
+        return cudaSuccess;
+    }
+
+    int currentDevice = 0;
+    cudaError_t err = cudaGetDevice(&currentDevice);
+    if (err != cudaSuccess) {
+        return err;
+    }
+
+    // Free from the end, i.e. the largest blocks of the last device first
+    while ((this->cachedBytes > maxBytes) && !this->cached.empty()) {
+        auto it = std::prev(this->cached.end());
+        const int device = it->first.first;
+        if (device != currentDevice) {
+            cudaSetDevice(device);
+        }
+        err = cudaFree(it->second);
+        if (device != currentDevice) {
+            cudaSetDevice(currentDevice);
+        }
+        this->cachedBytes -= it->first.second;
+        this->cached.erase(it);
+        if (err != cudaSuccess) {
+            return err;
+        }
+    }
+    return cudaSuccess;
+}
@@ -0,0 +1,172 @@
+//
+// CudaMemoryPool.h
+//
+// Copyright (C) 2019 by University of Stuttgart (VISUS).
+// All rights reserved.
+//
+
+#ifndef MMPROTEINCUDAPLUGIN_CUDAMEMORYPOOL_H_INCLUDED
+#define MMPROTEINCUDAPLUGIN_CUDAMEMORYPOOL_H_INCLUDED
+
+#include "cuda_runtime.h"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace megamol {
+namespace protein_cuda {
+
+/**
+ * Caching allocator for device memory, shared by all modules of the plugin.
+ *
+ * Freed blocks are kept in size classes and handed out again for the next
+ * allocation of the same class, so that temporary arrays reallocated every
+ * frame do not reach cudaMalloc and cudaFree with their implicit device
+ * synchronisation. Blocks are reused in stream order of the legacy default
+ * stream, which all users of the pool operate on.
+ *
+ * Allocations are attributed to the owner set by a ScopedOwner on the
+ * calling thread, with statistics and an optional budget per owner.
+ */
+class CudaMemoryPool {
+
+public:
+
+    /** Statistics of one owner */
+    struct Statistics {
+        size_t numAllocations = 0;
+        size_t numCacheHits = 0;
+        size_t allocatedBytes = 0;
+        size_t peakBytes = 0;
+        size_t budget = 0;
+    };
+
+    /**
+     * Attributes the allocations of the calling thread to the given owner
+     * for the lifetime of this object.
+     */
+    class ScopedOwner {
+    public:
+        /** Ctor */
+        explicit ScopedOwner(const char *owner);
+
+        /** Dtor */
+        ~ScopedOwner();
+
+    private:
+        const char *previous;
+    };
+
+    /**
+     * Answer the pool of the plugin.
+     *
+     * @return The pool
+     */
+    static CudaMemoryPool& Instance();
+
+    /**
+     * Allocates device memory on the current device, reusing a cached block if available.
+     *
+     * @param ptr   Receives the device pointer
+     * @param bytes The number of bytes
+     * @return 'cudaSuccess' on success, the respective error value otherwise
+     */
+    cudaError_t Allocate(void **ptr, size_t bytes);
+
+    /**
+     * Returns device memory to the cache. Pointers not allocated by the pool
+     * are freed directly.
+     *
+     * @param ptr The device pointer
+     * @return 'cudaSuccess' on success, the respective error value otherwise
+     */
+    cudaError_t Free(void *ptr);
+
+    /**
+     * Frees all cached blocks.
+     *
+     * @return 'cudaSuccess' on success, the respective error value otherwise
+     */
+    cudaError_t Trim();
+
+    /**
+     * Sets the device memory budget of an owner.
+     *
+     * @param owner The owner
+     * @param bytes The budget in bytes, 0 for unlimited
+     */
+    void SetBudget(const std::string& owner, size_t bytes);
+
+    /**
+     * Sets the maximum amount of memory kept in the cache.
+     *
+     * @param bytes The number of bytes
+     */
+    void SetMaxCachedBytes(size_t bytes);
+
+    /**
+     * Answer the statistics of an owner.
+     *
+     * @param owner The owner
+     * @return The statistics
+     */
+    Statistics GetStatistics(const std::string& owner) const;
+
+    /**
+     * Answer the amount of memory currently held in the cache.
+     *
+     * @return The number of bytes
+     */
+    size_t GetCachedBytes() const;
+
+    /**
+     * Writes the statistics of all owners to the log.
+     */
+    void LogStatistics() const;
+
+private:
+
+    /** An allocated block */
+    struct Block {
+        int device;
+        size_t bytes;
+        std::string owner;
+    };
+
+    /** Ctor */
+    CudaMemoryPool();
+
+    /** Dtor */
+    ~CudaMemoryPool();
+
+    /**
+     * Rounds a size up to its size class: powers of two up to 1 MB, and a
+     * quarter of the next smaller power of two above.
+     */
+    static size_t roundUp(size_t bytes);
+
+    /** Frees cached blocks until at most the given amount is cached, assumes the lock being held */
+    cudaError_t shrinkCache(size_t maxBytes);
+
+    /// Blocks handed out, by device pointer
+    std::map<void*, Block> used;
+
+    /// Cached blocks by device and size class
+    std::multimap<std::pair<int, size_t>, void*> cached;
+
+    /// Statistics by owner
+    std::map<std::string, Statistics> statistics;
+
+    /// Memory held in the cache and its limit
+    size_t cachedBytes, maxCachedBytes;
+
+    mutable std::mutex lock;
+};
+
+} // namespace protein_cuda
+} // namespace megamol
+
+#endif // MMPROTEINCUDAPLUGIN_CUDAMEMORYPOOL_H_INCLUDED
@@ -20,6 +20,9 @@
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "vislib/sys/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "CUDAQuickSurf.h"
 #include "cuda_error_check.h"
@@ -46,8 +49,13 @@ PotentialCalculator::PotentialCalculator() : Module(),
         bboxTypeSlot("bboxType", "The periodic bounding box of the particle data"),
         chargesGridSpacingSlot("chargesGridSpacing", "Grid resolution for the charge distribution"),
         potentialGridSpacingSlot("potentialGridSpacing", "Grid resolution for the potential map"),
+        cutoffSlot("cutoff", "Cut off radius of the direct Coulomb summation"),
+        kappaSlot("kappa", "Inverse Debye length of the Poisson-Boltzmann equation (0 = Poisson equation)"),
+        maxCyclesSlot("maxCycles", "Maximum number of multigrid cycles"),
+        toleranceSlot("tolerance", "Relative residual at which the multigrid solver stops"),
         cudaqsurf(NULL),
-        maxParticleRad(0.0f), minPotential(0.0f),
+        maxParticleRad(0.0f), potentialValid_D(false),
+        computedFrame(0), computedDataHash(0), minPotential(0.0f),
         maxPotential(0.0f), jobDone(false) {
 
     // Make data caller slot available
@@ -72,7 +80,7 @@ PotentialCalculator::PotentialCalculator() : Module(),
     cm->SetTypePair(DIRECT_COULOMB_SUMMATION, "DCS");
     cm->SetTypePair(EWALD_SUMMATION, "Ewald sum");
     //cm->SetTypePair(PARTICLE_MESH_EWALD, "Particle Mesh Ewald");  // TODO Not supported atm
-    //cm->SetTypePair(CONTINUUM_SOLVATION_POISSON_BOLTZMAN, "Continuum Solvation"); // TODO Not supported atm
+    cm->SetTypePair(CONTINUUM_SOLVATION_POISSON_BOLTZMAN, "Poisson-Boltzmann (multigrid)");
     cm->SetTypePair(GPU_POISSON_SOLVER, "GPU Poisson Solver (by Georg Rempfer)");
     this->computationalMethodSlot << cm;
     this->MakeSlotAvailable(&this->computationalMethodSlot);
@@ -94,6 +102,18 @@ PotentialCalculator::PotentialCalculator() : Module(),
     this->potentialGridSpacing = 2.0f;
     this->potentialGridSpacingSlot << new core::param::FloatParam(this->potentialGridSpacing, 0.0f);
     this->MakeSlotAvailable(&this->potentialGridSpacingSlot);
+
+    // Parameter for the cut off radius of the direct Coulomb summation
+    this->cutoffSlot << new core::param::FloatParam(12.0f, 0.0f);
+    this->MakeSlotAvailable(&this->cutoffSlot);
+
+    // Parameters of the multigrid Poisson-Boltzmann solver
+    this->kappaSlot << new core::param::FloatParam(0.0f, 0.0f);
+    this->MakeSlotAvailable(&this->kappaSlot);
+    this->maxCyclesSlot << new core::param::IntParam(20, 1);
+    this->MakeSlotAvailable(&this->maxCyclesSlot);
+    this->toleranceSlot << new core::param::FloatParam(1e-4f, 0.0f);
+    this->MakeSlotAvailable(&this->toleranceSlot);
 }
 
 
@@ -141,11 +161,17 @@ bool PotentialCalculator::getData(core::Call& call) {
     if (dcOut == NULL) {
         return false;
     }
+    dcOut->SetFrameID(dcIn->FrameID());
     if (!(*dcOut)(MolecularDataCall::CallForGetData)) {
         return false;
     }
 
-    this->updateParams(); // Update parameter slots
+    // Update parameter slots, the potential map of unchanged data is kept
+    bool paramsChanged = this->updateParams();
+    if (!paramsChanged && this->jobDone && (this->computedFrame == dcOut->FrameID())
+            && (this->computedDataHash == dcOut->DataHash())) {
+        return true;
+    }
 
 
     /* Compute charge distribution */
@@ -160,6 +186,9 @@ bool PotentialCalculator::getData(core::Call& call) {
     if (!this->computePotentialMap(dcOut)) {
         return false;
     }
+    this->computedFrame = dcOut->FrameID();
+    this->computedDataHash = dcOut->DataHash();
+    this->jobDone = true;
 
 
     /* Set piece data pointer for potential in incoming data call */
@@ -392,6 +421,9 @@ bool PotentialCalculator::computePotentialMap(const MolecularDataCall *mol) {
 #ifdef _WIN64
     using namespace vislib::sys;
 
+    // Attribute the device memory of the potential map to this module
+    CudaMemoryPool::ScopedOwner poolOwner(PotentialCalculator::ClassName());
+
     size_t volSize = this->potentialGrid.size[0]*
             this->potentialGrid.size[1]*
             this->potentialGrid.size[2];
@@ -402,20 +434,29 @@ bool PotentialCalculator::computePotentialMap(const MolecularDataCall *mol) {
 
     switch (this->computationalMethod) {
     case DIRECT_COULOMB_SUMMATION_NO_PERIODIC_BOUNDARIES:
-        if (!this->computePotentialMapDCS(mol, 100.0f)) {
+        if (!this->computePotentialMapDCS(mol,
+                this->cutoffSlot.Param<core::param::FloatParam>()->Value())) {
             return false;
         }
         Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
-                "Time for computing potential map (Direct Coulomb Summation, CPU): %fs",
+                "Time for computing potential map (Direct Coulomb Summation, GPU): %fs",
                 (double(clock()-t)/double(CLOCKS_PER_SEC) )); // DEBUG
         break;
     case DIRECT_COULOMB_SUMMATION:
-        if (!this->computePotentialMapDCS(mol, 100.0f, true)) {
+        if (!this->computePotentialMapDCS(mol,
+                this->cutoffSlot.Param<core::param::FloatParam>()->Value(), true)) {
+            return false;
+        }
+        break;
+    case PARTICLE_MESH_EWALD: break; // TODO
+    case CONTINUUM_SOLVATION_POISSON_BOLTZMAN:
+        if (!this->computePotentialMapMultigrid()) {
             return false;
         }
-        break; // TODO Parameter for cutoff radius
-    case PARTICLE_MESH_EWALD: // TODO
-    case CONTINUUM_SOLVATION_POISSON_BOLTZMAN: break; // TODO
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
+                "Time for computing potential map (Poisson-Boltzmann, multigrid): %fs",
+                (double(clock()-t)/double(CLOCKS_PER_SEC) )); // DEBUG
+        break;
     case GPU_POISSON_SOLVER:
 
         if (!CudaSafeCall(this->potential_D.Validate(volSize))) {
@@ -468,27 +509,184 @@ bool PotentialCalculator::computePotentialMapDCS(const MolecularDataCall *mol,
         float sphericalCutOff, bool usePeriodicImages) {
 
     // Compute electrostatic potential for all grid points using Direct
-    // Coulomb Summation
+    // Coulomb Summation within the cut off radius, the atoms being sorted by
+    // the cells of a uniform grid
 
 #ifdef _WIN64
-    // Init atom data
-    this->atomData.Validate(mol->AtomCount()*4);
+    using namespace vislib::sys;
+
+    const int atomCnt = static_cast<int>(mol->AtomCount());
+    if ((atomCnt == 0) || (sphericalCutOff <= 0.0f)) {
+        return false;
+    }
+
+    // Cells cover the periodic box, or the atoms without periodic boundaries
+    float org[3], box[3];
+    if (usePeriodicImages) {
+        org[0] = this->particleBBox.Left();
+        org[1] = this->particleBBox.Bottom();
+        org[2] = this->particleBBox.Back();
+        box[0] = this->particleBBox.Width();
+        box[1] = this->particleBBox.Height();
+        box[2] = this->particleBBox.Depth();
+    } else {
+        float maxC[3];
+        for (int i = 0; i < 3; ++i) {
+            org[i] = maxC[i] = mol->AtomPositions()[i];
+        }
+        for (int at = 1; at < atomCnt; ++at) {
+            for (int i = 0; i < 3; ++i) {
+                org[i] = std::min(org[i], mol->AtomPositions()[3*at+i]);
+                maxC[i] = std::max(maxC[i], mol->AtomPositions()[3*at+i]);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            box[i] = maxC[i] - org[i];
+        }
+    }
+    int3 cellDim;
+    int *dims = &cellDim.x;
+    float cellSize[3];
+    for (int i = 0; i < 3; ++i) {
+        if (usePeriodicImages) {
+            // Whole cells tile the box, none of them smaller than the cut off
+            dims[i] = std::max(1, static_cast<int>(box[i]/sphericalCutOff));
+            cellSize[i] = box[i]/dims[i];
+        } else {
+            dims[i] = static_cast<int>(box[i]/sphericalCutOff) + 1;
+            cellSize[i] = sphericalCutOff;
+        }
+    }
+    const size_t cellCnt = static_cast<size_t>(cellDim.x)*cellDim.y*cellDim.z;
+
+    // Counting sort of the atoms by cell
+    std::vector<uint> cellIdx(atomCnt);
 #pragma omp parallel for
-    for (int at = 0; at < static_cast<int>(mol->AtomCount()); ++at) {
-        this->atomData.Peek()[at*4+0] = mol->AtomPositions()[3*at+0];
-        this->atomData.Peek()[at*4+1] = mol->AtomPositions()[3*at+1];
-        this->atomData.Peek()[at*4+2] = mol->AtomPositions()[3*at+2];
-        this->atomData.Peek()[at*4+3] = mol->AtomOccupancies()[at];
+    for (int at = 0; at < atomCnt; ++at) {
+        int c[3];
+        for (int i = 0; i < 3; ++i) {
+            float p = mol->AtomPositions()[3*at+i] - org[i];
+            if (usePeriodicImages && (box[i] > 0.0f)) {
+                p -= box[i]*floorf(p/box[i]);
+            }
+            c[i] = std::min(std::max(static_cast<int>(p/cellSize[i]), 0), dims[i] - 1);
+        }
+        cellIdx[at] = (c[2]*cellDim.y + c[1])*cellDim.x + c[0];
+    }
+    std::vector<uint> cellStart(cellCnt + 1, 0);
+    for (int at = 0; at < atomCnt; ++at) {
+        cellStart[cellIdx[at] + 1]++;
+    }
+    for (size_t c = 0; c < cellCnt; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    std::vector<uint> fill(cellStart.begin(), cellStart.end() - 1);
+    this->atomData.Validate(mol->AtomCount()*4);
+    for (int at = 0; at < atomCnt; ++at) {
+        const uint dst = fill[cellIdx[at]]++;
+        this->atomData.Peek()[dst*4+0] = mol->AtomPositions()[3*at+0];
+        this->atomData.Peek()[dst*4+1] = mol->AtomPositions()[3*at+1];
+        this->atomData.Peek()[dst*4+2] = mol->AtomPositions()[3*at+2];
+        this->atomData.Peek()[dst*4+3] = mol->AtomOccupancies()[at];
     }
 
+    // Upload, the cell ends are the starts of the next cells
+    if (!CudaSafeCall(this->atoms_D.Validate(this->atomData.GetCount()))) return false;
+    if (!CudaSafeCall(this->cellStart_D.Validate(cellCnt))) return false;
+    if (!CudaSafeCall(this->cellEnd_D.Validate(cellCnt))) return false;
+    CudaSafeCall(cudaMemcpy(this->atoms_D.Peek(), this->atomData.Peek(),
+            sizeof(float)*this->atomData.GetCount(), cudaMemcpyHostToDevice));
+    CudaSafeCall(cudaMemcpy(this->cellStart_D.Peek(), cellStart.data(),
+            sizeof(uint)*cellCnt, cudaMemcpyHostToDevice));
+    CudaSafeCall(cudaMemcpy(this->cellEnd_D.Peek(), cellStart.data() + 1,
+            sizeof(uint)*cellCnt, cudaMemcpyHostToDevice));
+
+    const uint3 gridSize = make_uint3(this->potentialGrid.size[0],
+            this->potentialGrid.size[1], this->potentialGrid.size[2]);
+    if (!CudaSafeCall(this->potential_D.Validate(gridSize.x*gridSize.y*gridSize.z))) {
+        return false;
+    }
     if (!CudaSafeCall(DirectCoulombSummation(
-            this->atomData.Peek(),
-            mol->AtomCount(),
-            this->potential.Peek(),
-            make_uint3(this->potentialGrid.size[0],
-                       this->potentialGrid.size[1],
-                       this->potentialGrid.size[2]),
-                       this->potentialGridSpacing))) {
+            this->atoms_D.PeekConst(),
+            this->cellStart_D.PeekConst(),
+            this->cellEnd_D.PeekConst(),
+            cellDim,
+            make_float3(cellSize[0], cellSize[1], cellSize[2]),
+            make_float3(org[0], org[1], org[2]),
+            make_float3(this->potentialGrid.minC[0], this->potentialGrid.minC[1],
+                    this->potentialGrid.minC[2]),
+            gridSize,
+            this->potentialGrid.delta[0],
+            sphericalCutOff,
+            make_float3(box[0], box[1], box[2]),
+            usePeriodicImages,
+            this->potential_D.Peek()))) {
+        return false;
+    }
+    this->potentialValid_D = true;
+
+    // The host copy is the data of the outgoing call
+    if (!CudaSafeCall(this->potential_D.CopyToHost(this->potential.Peek()))) {
+        return false;
+    }
+#endif // _WIN64
+    return true;
+}
+
+
+/*
+ * PotentialCalculator::computePotentialMapMultigrid
+ */
+bool PotentialCalculator::computePotentialMapMultigrid() {
+
+#ifdef _WIN64
+    using namespace vislib::sys;
+
+    // The solver works on the grid of the charge distribution
+    for (int i = 0; i < 3; ++i) {
+        if (this->chargesGrid.size[i] != this->potentialGrid.size[i]) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                    "%s: The multigrid solver needs equal grids for the charges and the potential\n",
+                    this->ClassName());
+            return false;
+        }
+    }
+
+    const uint3 gridSize = make_uint3(this->potentialGrid.size[0],
+            this->potentialGrid.size[1], this->potentialGrid.size[2]);
+    const size_t volSize = gridSize.x*gridSize.y*gridSize.z;
+
+    // Warm start from the previous frame if the grid did not change
+    if (!this->potentialValid_D || (this->potential_D.GetCount() != volSize)) {
+        if (!CudaSafeCall(this->potential_D.Validate(volSize))) return false;
+        if (!CudaSafeCall(this->potential_D.Set(0))) return false;
+    }
+    if (!CudaSafeCall(this->mgWork_D.Validate(MultigridWorkspaceSize(gridSize)))) {
+        return false;
+    }
+
+    uint cycles = 0;
+    float residual = 0.0f;
+    if (!CudaSafeCall(SolvePoissonBoltzmannMultigrid(
+            this->charges.Peek(),
+            gridSize,
+            this->potentialGrid.delta[0],
+            this->kappaSlot.Param<core::param::FloatParam>()->Value(),
+            static_cast<uint>(this->maxCyclesSlot.Param<core::param::IntParam>()->Value()),
+            this->toleranceSlot.Param<core::param::FloatParam>()->Value(),
+            this->mgWork_D.Peek(),
+            this->potential_D.Peek(),
+            &cycles, &residual))) {
+        this->potentialValid_D = false;
+        return false;
+    }
+    this->potentialValid_D = true;
+    Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
+            "%s: Multigrid solver finished after %u cycles, relative residual %e",
+            this->ClassName(), cycles, residual);
+
+    // The host copy is the data of the outgoing call
+    if (!CudaSafeCall(this->potential_D.CopyToHost(this->potential.Peek()))) {
         return false;
     }
 #endif // _WIN64
@@ -614,6 +812,11 @@ void PotentialCalculator::release(void) {
     this->particlePos.Release();
     this->particleCharges.Release();
     this->chargesBuff.Release();
+    this->potential_D.Release();
+    this->atoms_D.Release();
+    this->cellStart_D.Release();
+    this->cellEnd_D.Release();
+    this->mgWork_D.Release();
     if (this->cudaqsurf != NULL) {
         CUDAQuickSurf *cqs = (CUDAQuickSurf *)this->cudaqsurf;
         delete cqs;
@@ -626,24 +829,42 @@ void PotentialCalculator::release(void) {
 /*
  * PotentialCalculator::updateParams()
  */
-void PotentialCalculator::updateParams() {
+bool PotentialCalculator::updateParams() {
+    bool changed = false;
 
     // Parameter to choose the computational method for the potential map
     if (this->computationalMethodSlot.IsDirty()) {
         this->computationalMethodSlot.ResetDirty();
         this->computationalMethod = static_cast<ComputationalMethod>
             (this->computationalMethodSlot.Param<core::param::EnumParam>()->Value());
+        changed = true;
     }
 
     // Parameter for the grid resolution of the charge distribution
     if (this->chargesGridSpacingSlot.IsDirty()) {
         this->chargesGridSpacing = this->chargesGridSpacingSlot.Param<core::param::FloatParam>()->Value();
         this->chargesGridSpacingSlot.ResetDirty();
+        changed = true;
     }
 
-    // Parameter for the grid resolution of the potential map
+    // Parameter for the grid resolution of the potential map, the previous
+    // potential is no starting point on a different grid
     if (this->potentialGridSpacingSlot.IsDirty()) {
         this->potentialGridSpacing = this->potentialGridSpacingSlot.Param<core::param::FloatParam>()->Value();
         this->potentialGridSpacingSlot.ResetDirty();
+        this->potentialValid_D = false;
+        changed = true;
+    }
+
+    // Parameters of the solvers
+    if (this->cutoffSlot.IsDirty() || this->kappaSlot.IsDirty() ||
+            this->maxCyclesSlot.IsDirty() || this->toleranceSlot.IsDirty()) {
+        this->cutoffSlot.ResetDirty();
+        this->kappaSlot.ResetDirty();
+        this->maxCyclesSlot.ResetDirty();
+        this->toleranceSlot.ResetDirty();
+        changed = true;
     }
+
+    return changed;
 }
@@ -230,154 +230,334 @@ cudaError_t SolvePoissonEq(float gridSpacing, uint3 gridSize, float *charges,
     return cudaGetLastError();
 }
 
-extern "C"
-cudaError_t DirectCoulombSummation(float *atomData, uint atomCount,
-        float *potential, uint3 gridSize, float gridspacing) {
-
-    // TODO Why is this so incredibely slow??
-
-    float *doutput = NULL;
-    dim3 volsize, Gsz, Bsz;
-    //float copytotal, runtotal, mastertotal, hostcopytotal;
-    const char *statestr = "|/-\\.";
-    int state=0;
-
-    printf("CUDA accelerated coulombic potential microbenchmark V4.0\n");
-    printf("John E. Stone <johns@ks.uiuc.edu>\n");
-    printf("and Chris Rodrigues\n");
-    printf("http://www.ks.uiuc.edu/Research/gpu/\n");
-    printf("--------------------------------------------------------\n");
-    int deviceCount = 0;
-    cudaGetDeviceCount(&deviceCount);
-    printf("Detected %d CUDA accelerators:\n", deviceCount);
-    int dev;
-    for (dev=0; dev < deviceCount; dev++) {
-        cudaDeviceProp deviceProp;
-        cudaGetDeviceProperties(&deviceProp, dev);
-        printf("  [%d]: '%s'  Clock: %.1f GHz  Mem: %dMB  Rev: %d.%d\n",
-                dev, deviceProp.name,
-                deviceProp.clockRate / 1000000.0f, deviceProp.totalGlobalMem / (1024*1024),
-                deviceProp.major, deviceProp.minor);
+/**
+ * Direct Coulomb summation within a cut off radius, one thread per grid point.
+ * The atoms (xyzq) are sorted by the cells of a uniform grid with cells at
+ * least as large as the cut off radius, such that only the 27 cells around a
+ * grid point have to be visited. With periodic boundaries, the cells cover
+ * the box and distances follow the minimum image convention.
+ */
+__global__ void DirectCoulombSummationCutoff_D(const float4 *atoms,
+        const uint *cellStart, const uint *cellEnd, int3 cellDim,
+        float3 cellSize, float3 cellOrg, float3 gridOrg, uint3 gridSize,
+        float gridSpacing, float cutoffSq, float3 box, bool periodic,
+        float *potential) {
+
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx >= gridSize.x*gridSize.y*gridSize.z) return;
+
+    float3 p = make_float3(gridOrg.x + (idx%gridSize.x)*gridSpacing,
+            gridOrg.y + ((idx/gridSize.x)%gridSize.y)*gridSpacing,
+            gridOrg.z + (idx/(gridSize.x*gridSize.y))*gridSpacing);
+    float3 q = make_float3(p.x - cellOrg.x, p.y - cellOrg.y, p.z - cellOrg.z);
+    if (periodic) {
+        q.x -= box.x*floorf(q.x/box.x);
+        q.y -= box.y*floorf(q.y/box.y);
+        q.z -= box.z*floorf(q.z/box.z);
     }
-
-    int cudadev = 0; // Use first cuda device
-    //      if (argc == 2) {
-    //        sscanf(argv[1], "%d", &cudadev);
-    //        if (cudadev < 0 || cudadev >= deviceCount) {
-    //          cudadev = 0;
-    //        }
-    //      }
-    printf("  Single-threaded single-GPU test run.\n");
-    printf("  Opening CUDA device %d...\n", cudadev);
-    cudaSetDevice(cudadev);
-    CUERR // check and clear any existing errors TODO
-
-    // number of atoms to simulate
-    int atomcount = 100000;
-
-    // setup energy grid size
-    // XXX this is a large test case to clearly illustrate that even while
-    //     the CUDA kernel is running entirely on the GPU, the CUDA runtime
-    //     library is soaking up the entire host CPU for some reason.
-    volsize = gridSize;
-
-    // setup CUDA grid and block sizes
-    // XXX we have to make a trade-off between the number of threads per
-    //     block and the resulting padding size we'll end up with since
-    //     each thread will do several consecutive grid cells in this version,
-    //     we're using up some of our available parallelism to reduce overhead.
-    Bsz.x = BLOCKSIZEX;
-    Bsz.y = BLOCKSIZEY;
-    Bsz.z = 1;
-    Gsz.x = max(1, volsize.x / (Bsz.x * UNROLLX));
-    Gsz.y = max(1, volsize.y / (Bsz.y * UNROLLY));
-    Gsz.z = volsize.z;
-
-//    printf("Run the kernel, gridSize %u %u %u, blockSize %u %u %u\n", (Bsz.x * UNROLLX),
-//            Gsz.y, Gsz.z, Bsz.x, Bsz.y, Bsz.z);
-
-    // allocate and initialize the GPU output array
-    int volmemsz = sizeof(float) * volsize.x * volsize.y * volsize.z;
-    printf("Allocating %.2fMB of memory for output buffer...\n", volmemsz / (1024.0 * 1024.0));
-
-    cudaMalloc((void**)&doutput, volmemsz);
-    CUERR // check and clear any existing errors TODO
-    cudaMemset(doutput, 0, volmemsz);
-    CUERR // check and clear any existing errors TODO
-
-    for (uint z = 0; z < volsize.z; ++z) {
-        printf("starting run for slab %u...\n", z);
-
-        int iterations=0;
-        int atomstart;
-
-        for (atomstart = 0; atomstart < atomcount; atomstart += MAXATOMS) {
-
-            iterations++;
-            int runatoms;
-            int atomsremaining = atomcount - atomstart;
-            if (atomsremaining > MAXATOMS)
-                runatoms = MAXATOMS;
-            else
-                runatoms = atomsremaining;
-
-            printf("%c\r", statestr[state]);
-            fflush(stdout);
-            state = (state+1) & 3;
-
-            // copy the atoms to the GPU
-
-            if (copyatomstoconstbuf(atomData + 4*atomstart, runatoms, z*gridspacing))
-                return cudaGetLastError();
-
-            CUERR // check and clear any existing errors
-
-            // RUN the kernel...
-            cenergy <<< Gsz, Bsz >>> (runatoms, gridspacing, doutput);
-
-            // TODO
-            CUERR // check and clear any existing errors
+    const int3 c = make_int3((int)floorf(q.x/cellSize.x),
+            (int)floorf(q.y/cellSize.y), (int)floorf(q.z/cellSize.z));
+
+    // With periodic boundaries and less than three cells along an axis, all
+    // of them are neighbours and must be visited only once
+    const int3 lo = make_int3(
+            (periodic && cellDim.x < 3) ? -c.x : -1,
+            (periodic && cellDim.y < 3) ? -c.y : -1,
+            (periodic && cellDim.z < 3) ? -c.z : -1);
+    const int3 hi = make_int3(
+            (periodic && cellDim.x < 3) ? cellDim.x - 1 - c.x : 1,
+            (periodic && cellDim.y < 3) ? cellDim.y - 1 - c.y : 1,
+            (periodic && cellDim.z < 3) ? cellDim.z - 1 - c.z : 1);
+
+    float sum = 0.0f;
+    for (int dz = lo.z; dz <= hi.z; ++dz) {
+        for (int dy = lo.y; dy <= hi.y; ++dy) {
+            for (int dx = lo.x; dx <= hi.x; ++dx) {
+                int3 n = make_int3(c.x + dx, c.y + dy, c.z + dz);
+                if (periodic) {
+                    n.x = (n.x + cellDim.x)%cellDim.x;
+                    n.y = (n.y + cellDim.y)%cellDim.y;
+                    n.z = (n.z + cellDim.z)%cellDim.z;
+                } else if ((n.x < 0) || (n.y < 0) || (n.z < 0) ||
+                        (n.x >= cellDim.x) || (n.y >= cellDim.y) || (n.z >= cellDim.z)) {
+                    continue;
+                }
+                const uint cell = (n.z*cellDim.y + n.y)*cellDim.x + n.x;
+                for (uint i = cellStart[cell]; i < cellEnd[cell]; ++i) {
+                    const float4 a = atoms[i];
+                    float3 d = make_float3(p.x - a.x, p.y - a.y, p.z - a.z);
+                    if (periodic) {
+                        d.x -= box.x*rintf(d.x/box.x);
+                        d.y -= box.y*rintf(d.y/box.y);
+                        d.z -= box.z*rintf(d.z/box.z);
+                    }
+                    const float distSq = d.x*d.x + d.y*d.y + d.z*d.z;
+                    if ((distSq < cutoffSq) && (distSq > 0.0f)) {
+                        sum += a.w*rsqrtf(distSq);
+                    }
+                }
+            }
         }
-        cudaThreadSynchronize();
     }
+    potential[idx] = sum;
+}
+
+
+extern "C"
+cudaError_t DirectCoulombSummation(const float *atoms_D, const uint *cellStart_D,
+        const uint *cellEnd_D, int3 cellDim, float3 cellSize, float3 cellOrg,
+        float3 gridOrg, uint3 gridSize, float gridSpacing, float cutoff,
+        float3 box, bool periodic, float *potential_D) {
+
+    const uint cnt = gridSize.x*gridSize.y*gridSize.z;
+    const uint threads = 256;
+    DirectCoulombSummationCutoff_D <<< (cnt + threads - 1)/threads, threads >>> (
+            reinterpret_cast<const float4*>(atoms_D), cellStart_D, cellEnd_D,
+            cellDim, cellSize, cellOrg, gridOrg, gridSize, gridSpacing,
+            cutoff*cutoff, box, periodic, potential_D);
+    return cudaGetLastError();
+}
 
-    // Copy the GPU output data back to the host and use/store it..
-    cudaMemcpy(potential, doutput, volmemsz,  cudaMemcpyDeviceToHost);
 
+/*
+ * Multigrid solver for the linearised Poisson-Boltzmann equation
+ *
+ *     -laplace(phi) + kappa^2 phi = 4 pi rho
+ *
+ * on a vertex grid with phi = 0 on the boundary. Coarse level l+1 has
+ * size/2+1 nodes per axis, its node i coincides with fine node 2i. The
+ * V-cycle uses red-black Gauss-Seidel smoothing, full weighting restriction
+ * and trilinear prolongation.
+ */
+
+/** Answer the grid size of the next coarser level */
+__host__ __device__ inline uint3 CoarseGridSize(uint3 s) {
+    return make_uint3(s.x/2 + 1, s.y/2 + 1, s.z/2 + 1);
+}
 
+/** Answer whether a grid size is too small for a further coarser level */
+__host__ inline bool IsCoarsestGrid(uint3 s, uint level) {
+    return (s.x < 5) || (s.y < 5) || (s.z < 5) || (level >= 16);
+}
 
-    //TODO
-    CUERR // check and clear any existing errors
+__device__ inline bool IsBoundaryNode(uint x, uint y, uint z, uint3 s) {
+    return (x == 0) || (y == 0) || (z == 0) || (x >= s.x - 1) ||
+            (y >= s.y - 1) || (z >= s.z - 1);
+}
 
-#if 1
-    int x, y;
-    for (y=0; y<16; y++) {
-        for (x=0; x<16; x++) {
-            int addr = y * volsize.x + x;
-            printf("out[%d]: %f\n", addr, potential[addr]);
+__global__ void MultigridSmoothRedBlack_D(float *phi, const float *f, uint3 s,
+        float hSq, float kappaSq, uint color) {
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx >= s.x*s.y*s.z) return;
+    const uint x = idx%s.x, y = (idx/s.x)%s.y, z = idx/(s.x*s.y);
+    if (((x + y + z)&1) != color) return;
+    if (IsBoundaryNode(x, y, z, s)) {
+        phi[idx] = 0.0f;
+        return;
+    }
+    const uint sxy = s.x*s.y;
+    const float nb = phi[idx - 1] + phi[idx + 1] + phi[idx - s.x] +
+            phi[idx + s.x] + phi[idx - sxy] + phi[idx + sxy];
+    phi[idx] = (nb + hSq*f[idx])/(6.0f + hSq*kappaSq);
+}
+
+__global__ void MultigridResidual_D(const float *phi, const float *f,
+        float *r, uint3 s, float hSq, float kappaSq) {
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx >= s.x*s.y*s.z) return;
+    const uint x = idx%s.x, y = (idx/s.x)%s.y, z = idx/(s.x*s.y);
+    if (IsBoundaryNode(x, y, z, s)) {
+        r[idx] = 0.0f;
+        return;
+    }
+    const uint sxy = s.x*s.y;
+    const float nb = phi[idx - 1] + phi[idx + 1] + phi[idx - s.x] +
+            phi[idx + s.x] + phi[idx - sxy] + phi[idx + sxy];
+    r[idx] = f[idx] - ((6.0f*phi[idx] - nb)/hSq + kappaSq*phi[idx]);
+}
+
+__global__ void MultigridRestrict_D(const float *fine, uint3 fs, float *coarse,
+        uint3 cs) {
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx >= cs.x*cs.y*cs.z) return;
+    const uint x = idx%cs.x, y = (idx/cs.x)%cs.y, z = idx/(cs.x*cs.y);
+    if (IsBoundaryNode(x, y, z, cs)) {
+        coarse[idx] = 0.0f;
+        return;
+    }
+    float sum = 0.0f;
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int fx = 2*x + dx, fy = 2*y + dy, fz = 2*z + dz;
+                if ((fx >= (int)fs.x) || (fy >= (int)fs.y) || (fz >= (int)fs.z)) continue;
+                const float w = (dx == 0 ? 0.5f : 0.25f)*(dy == 0 ? 0.5f : 0.25f)*
+                        (dz == 0 ? 0.5f : 0.25f);
+                sum += w*fine[(fz*fs.y + fy)*fs.x + fx];
+            }
         }
     }
-#endif
-
-//    printf("Final calculation required %d iterations of %d atoms\n", iterations, MAXATOMS);
-//    printf("Copy time: %f seconds, %f per iteration\n", copytotal, copytotal / (float) iterations);
-//    printf("Kernel time: %f seconds, %f per iteration\n", runtotal, runtotal / (float) iterations);
-//    printf("Total time: %f seconds\n", mastertotal);
-//    printf("Kernel invocation rate: %f iterations per second\n", iterations / mastertotal);
-//    printf("GPU to host copy bandwidth: %gMB/sec, %f seconds total\n",
-//            (volmemsz / (1024.0 * 1024.0)) / hostcopytotal, hostcopytotal);
-
-//    double atomevalssec = ((double) volsize.x * volsize.y * volsize.z * atomcount) / (mastertotal * 1000000000.0);
-//    printf("Efficiency metric, %g billion atom evals per second\n", atomevalssec);
-//
-//    /* 59/8 FLOPS per atom eval */
-//    printf("FP performance: %g GFLOPS\n", atomevalssec * (59.0/8.0));
+    coarse[idx] = sum;
+}
+
+__global__ void MultigridProlongateAdd_D(const float *coarse, uint3 cs,
+        float *fine, uint3 fs) {
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx >= fs.x*fs.y*fs.z) return;
+    const uint x = idx%fs.x, y = (idx/fs.x)%fs.y, z = idx/(fs.x*fs.y);
+    if (IsBoundaryNode(x, y, z, fs)) return;
+    // Odd fine nodes lie between two coarse nodes
+    const uint cx0 = x/2, cy0 = y/2, cz0 = z/2;
+    const uint cx1 = min(cx0 + (x&1), cs.x - 1);
+    const uint cy1 = min(cy0 + (y&1), cs.y - 1);
+    const uint cz1 = min(cz0 + (z&1), cs.z - 1);
+    const uint csxy = cs.x*cs.y;
+    const float v = coarse[cz0*csxy + cy0*cs.x + cx0] + coarse[cz0*csxy + cy0*cs.x + cx1] +
+            coarse[cz0*csxy + cy1*cs.x + cx0] + coarse[cz0*csxy + cy1*cs.x + cx1] +
+            coarse[cz1*csxy + cy0*cs.x + cx0] + coarse[cz1*csxy + cy0*cs.x + cx1] +
+            coarse[cz1*csxy + cy1*cs.x + cx0] + coarse[cz1*csxy + cy1*cs.x + cx1];
+    fine[idx] += 0.125f*v;
+}
 
-    cudaFree(doutput);
+__global__ void ScaleArray_D(float *arr, uint cnt, float factor) {
+    const uint idx = blockIdx.x*blockDim.x + threadIdx.x;
+    if (idx < cnt) arr[idx] *= factor;
+}
 
-    return cudaGetLastError();
+/** Per-block sums of squares, to be summed up on the host */
+__global__ void SumOfSquares_D(const float *arr, uint cnt, float *blockSums) {
+    extern __shared__ float sums[];
+    float s = 0.0f;
+    for (uint i = blockIdx.x*blockDim.x + threadIdx.x; i < cnt; i += gridDim.x*blockDim.x) {
+        s += arr[i]*arr[i];
+    }
+    sums[threadIdx.x] = s;
+    __syncthreads();
+    for (uint stride = blockDim.x/2; stride > 0; stride /= 2) {
+        if (threadIdx.x < stride) sums[threadIdx.x] += sums[threadIdx.x + stride];
+        __syncthreads();
+    }
+    if (threadIdx.x == 0) blockSums[blockIdx.x] = sums[0];
+}
+
+/** The number of blocks of the reduction, their sums follow the levels in the workspace */
+#define MULTIGRID_NORM_BLOCKS 64
+
+/** Answer the euclidean norm of a device array, using 'blockSums_D' as intermediate storage */
+static float Norm(const float *arr_D, uint cnt, float *blockSums_D) {
+    const uint threads = 256;
+    float blockSums[MULTIGRID_NORM_BLOCKS];
+    SumOfSquares_D <<< MULTIGRID_NORM_BLOCKS, threads, threads*sizeof(float) >>> (arr_D, cnt, blockSums_D);
+    cudaMemcpy(blockSums, blockSums_D, sizeof(blockSums), cudaMemcpyDeviceToHost);
+    double sum = 0.0;
+    for (int i = 0; i < MULTIGRID_NORM_BLOCKS; ++i) sum += blockSums[i];
+    return static_cast<float>(sqrt(sum));
 }
 
+extern "C"
+size_t MultigridWorkspaceSize(uint3 gridSize) {
+    // Level 0: right hand side and residual, coarser levels: potential too
+    size_t cnt = 2*gridSize.x*gridSize.y*gridSize.z;
+    uint3 s = gridSize;
+    for (uint level = 0; !IsCoarsestGrid(s, level); ++level) {
+        s = CoarseGridSize(s);
+        cnt += 3*s.x*s.y*s.z;
+    }
+    return cnt + MULTIGRID_NORM_BLOCKS;
+}
 
+/** The arrays of one level of the multigrid hierarchy */
+struct MultigridLevel {
+    uint3 size;
+    uint count;
+    float hSq;
+    float *phi, *f, *r;
+};
+
+static void VCycle(MultigridLevel *levels, uint levelCnt, uint l, float kappaSq) {
+    const uint threads = 256;
+    MultigridLevel &lv = levels[l];
+    const uint blocks = (lv.count + threads - 1)/threads;
+    const uint smoothingSteps = (l == levelCnt - 1) ? 32 : 2;
+
+    for (uint i = 0; i < smoothingSteps; ++i) {
+        MultigridSmoothRedBlack_D <<< blocks, threads >>> (lv.phi, lv.f, lv.size, lv.hSq, kappaSq, 0);
+        MultigridSmoothRedBlack_D <<< blocks, threads >>> (lv.phi, lv.f, lv.size, lv.hSq, kappaSq, 1);
+    }
+    if (l == levelCnt - 1) return;
+
+    MultigridLevel &cl = levels[l + 1];
+    const uint cblocks = (cl.count + threads - 1)/threads;
+    MultigridResidual_D <<< blocks, threads >>> (lv.phi, lv.f, lv.r, lv.size, lv.hSq, kappaSq);
+    MultigridRestrict_D <<< cblocks, threads >>> (lv.r, lv.size, cl.f, cl.size);
+    cudaMemset(cl.phi, 0, sizeof(float)*cl.count);
+    VCycle(levels, levelCnt, l + 1, kappaSq);
+    MultigridProlongateAdd_D <<< blocks, threads >>> (cl.phi, cl.size, lv.phi, lv.size);
+
+    for (uint i = 0; i < smoothingSteps; ++i) {
+        MultigridSmoothRedBlack_D <<< blocks, threads >>> (lv.phi, lv.f, lv.size, lv.hSq, kappaSq, 0);
+        MultigridSmoothRedBlack_D <<< blocks, threads >>> (lv.phi, lv.f, lv.size, lv.hSq, kappaSq, 1);
+    }
+}
+
+extern "C"
+cudaError_t SolvePoissonBoltzmannMultigrid(const float *charges, uint3 gridSize,
+        float gridSpacing, float kappa, uint maxCycles, float tolerance,
+        float *work_D, float *potential_D, uint *cyclesDone, float *residual) {
+
+    // Set up the level hierarchy in the workspace
+    MultigridLevel levels[17];
+    uint levelCnt = 0;
+    float *work = work_D;
+    uint3 s = gridSize;
+    float h = gridSpacing;
+    while (true) {
+        MultigridLevel &lv = levels[levelCnt];
+        lv.size = s;
+        lv.count = s.x*s.y*s.z;
+        lv.hSq = h*h;
+        if (levelCnt == 0) {
+            lv.phi = potential_D; // Warm start from its current content
+        } else {
+            lv.phi = work;
+            work += lv.count;
+        }
+        lv.f = work;
+        work += lv.count;
+        lv.r = work;
+        work += lv.count;
+        if (IsCoarsestGrid(s, levelCnt++)) break;
+        s = CoarseGridSize(s);
+        h *= 2.0f;
+    }
+    float *blockSums_D = work;
+
+    // The right hand side 4 pi rho
+    const uint threads = 256;
+    cudaMemcpy(levels[0].f, charges, sizeof(float)*levels[0].count, cudaMemcpyHostToDevice);
+    ScaleArray_D <<< (levels[0].count + threads - 1)/threads, threads >>> (levels[0].f,
+            levels[0].count, 4.0f*3.14159265358979f);
+    CUERR
+
+    const float fNorm = Norm(levels[0].f, levels[0].count, blockSums_D);
+    const float kappaSq = kappa*kappa;
+    const uint blocks = (levels[0].count + threads - 1)/threads;
+    *cyclesDone = 0;
+    *residual = 0.0f;
+    if (fNorm == 0.0f) {
+        cudaMemset(potential_D, 0, sizeof(float)*levels[0].count);
+        return cudaGetLastError();
+    }
+    while (true) {
+        MultigridResidual_D <<< blocks, threads >>> (levels[0].phi, levels[0].f, levels[0].r,
+                levels[0].size, levels[0].hSq, kappaSq);
+        *residual = Norm(levels[0].r, levels[0].count, blockSums_D)/fNorm;
+        if ((*residual <= tolerance) || (*cyclesDone >= maxCycles)) break;
+        VCycle(levels, levelCnt, 0, kappaSq);
+        ++(*cyclesDone);
+    }
+
+    return cudaGetLastError();
+}
 
 #endif // _WIN64
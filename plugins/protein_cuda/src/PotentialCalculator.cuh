@@ -23,9 +23,32 @@ extern "C"
 cudaError_t SolvePoissonEq(float gridSpacing, uint3 gridSize, float *charges,
         float *potential_D, float *potential);
 
+/**
+ * Direct Coulomb summation within a cut off radius on the device. The atoms
+ * (xyzq) are sorted by the cells of a uniform grid, the cells being at least
+ * as large as the cut off radius.
+ */
 extern "C"
-cudaError_t DirectCoulombSummation(float *atomData, uint atomCount,
-        float *potential, uint3 gridSize, float gridspacing);
+cudaError_t DirectCoulombSummation(const float *atoms_D, const uint *cellStart_D,
+        const uint *cellEnd_D, int3 cellDim, float3 cellSize, float3 cellOrg,
+        float3 gridOrg, uint3 gridSize, float gridSpacing, float cutoff,
+        float3 box, bool periodic, float *potential_D);
+
+/**
+ * Answers the number of floats of the workspace of the multigrid solver
+ */
+extern "C"
+size_t MultigridWorkspaceSize(uint3 gridSize);
+
+/**
+ * Solves the linearised Poisson-Boltzmann equation with multigrid V-cycles
+ * until the relative residual is below 'tolerance'. The potential on the
+ * device is the starting guess, e.g. the one of the previous frame.
+ */
+extern "C"
+cudaError_t SolvePoissonBoltzmannMultigrid(const float *charges, uint3 gridSize,
+        float gridSpacing, float kappa, uint maxCycles, float tolerance,
+        float *work_D, float *potential_D, uint *cyclesDone, float *residual);
 
 #endif // _WIN64
 
@@ -141,6 +141,16 @@ private:
             float sphericalCutOff,
             bool usePeriodicImages=false);
 
+    /**
+     * Computes the potential map by solving the linearised Poisson-Boltzmann
+     * equation for the charge distribution with a multigrid solver on the
+     * device. Starts from the potential of the previous frame if the grid has
+     * not changed.
+     *
+     * @return 'true' on success, 'false' otherwise
+     */
+    bool computePotentialMapMultigrid();
+
     /**
      * TODO
      */
@@ -165,9 +175,11 @@ private:
 	void initGridParams(gridParams &grid, megamol::protein_calls::MolecularDataCall *dcOut);
 
     /**
-     * TODO
+     * Updates the parameter values.
+     *
+     * @return 'true' if any parameter changed
      */
-    void updateParams();
+    bool updateParams();
 
     core::CallerSlot dataCallerSlot;  ///> Data caller slot
     core::CalleeSlot dataCalleeSlot;  ///> Data callee slot
@@ -188,6 +200,18 @@ private:
     core::param::ParamSlot potentialGridSpacingSlot;
     float potentialGridSpacing;
 
+    /// Parameter for the cut off radius of the direct Coulomb summation
+    core::param::ParamSlot cutoffSlot;
+
+    /// Parameter for the inverse Debye length of the Poisson-Boltzmann equation
+    core::param::ParamSlot kappaSlot;
+
+    /// Parameter for the maximum number of multigrid cycles
+    core::param::ParamSlot maxCyclesSlot;
+
+    /// Parameter for the relative residual the multigrid solver stops at
+    core::param::ParamSlot toleranceSlot;
+
 
     void *cudaqsurf;             ///> Pointer to CUDAQuickSurf objects
 
@@ -206,6 +230,15 @@ private:
     HostArr<float> potential;       ///> The potential map (host memory)
 
     CudaDevArr<float> potential_D;  ///> The potential map (device memory)
+    bool potentialValid_D;          ///> Flag whether potential_D holds a solution for the current grid
+
+    CudaDevArr<float> atoms_D;      ///> Atoms (xyzq) sorted by cells (device memory)
+    CudaDevArr<uint> cellStart_D;   ///> First atom of each cell (device memory)
+    CudaDevArr<uint> cellEnd_D;     ///> One past the last atom of each cell (device memory)
+    CudaDevArr<float> mgWork_D;     ///> Workspace of the multigrid solver (device memory)
+
+    unsigned int computedFrame;     ///> The frame of the potential map
+    SIZE_T computedDataHash;        ///> The data hash of the potential map
 
     float minPotential;             ///> Minimum potential value
     float maxPotential;             ///> Maximum potential value
@@ -841,6 +841,9 @@ bool ProteinVariantMatch::computeMatch(param::ParamSlot& p) {
 bool ProteinVariantMatch::computeMatchSurfMapping() {
     using namespace vislib::sys;
 
+    // Attribute the device memory of the surfaces to this module
+    CudaMemoryPool::ScopedOwner poolOwner(ProteinVariantMatch::ClassName());
+
     unsigned int posCnt0, posCnt1;
     this->minMatchSurfacePotentialVal = 1000000.0f;
     this->maxMatchSurfacePotentialVal = 0.0f;
@@ -58,7 +58,9 @@ StreamlineRenderer::StreamlineRenderer(void) : Renderer3DModuleDS(),
         streamtubesThicknessSlot("tubesScl","The scale factor for the streamtubes thickness"),
         minColSlot("minCol","Minimum color value"),
         maxColSlot("maxCol","Maximum color value"),
-        triggerComputeGradientField(true), triggerComputeStreamlines(true) {
+        fieldDataHash(0), fieldFrameId(0),
+        triggerComputeGradientField(true), triggerComputeStreamlines(true),
+        triggerUploadFields(true), triggerReseed(true) {
 
     // Data caller for volume data
     this->fieldDataCallerSlot.SetCompatibleCall<protein_calls::VTIDataCallDescription>();
@@ -270,6 +272,9 @@ bool StreamlineRenderer::GetExtents(core::Call& call) {
  */
 bool StreamlineRenderer::Render(core::Call& call) {
 
+    // Attribute the device memory of the streamlines to this module
+    CudaMemoryPool::ScopedOwner poolOwner(StreamlineRenderer::ClassName());
+
     // Update parameters
     this->updateParams();
 
@@ -291,13 +296,53 @@ bool StreamlineRenderer::Render(core::Call& call) {
 
     float scale;
 
+    int3 gridSize = make_int3(vtiCall->GetGridsize().GetX(),
+            vtiCall->GetGridsize().GetY(),
+            vtiCall->GetGridsize().GetZ());
+    float3 gridOrg = make_float3(vtiCall->GetOrigin().GetX(),
+            vtiCall->GetOrigin().GetY(),
+            vtiCall->GetOrigin().GetZ());
+    float3 gridDelta = make_float3(vtiCall->GetSpacing().GetX(),
+            vtiCall->GetSpacing().GetY(),
+            vtiCall->GetSpacing().GetZ());
+
+    // Upload the fields if the data changed, they stay resident on the GPU
+    // otherwise
+    if (this->triggerUploadFields || (vtiCall->DataHash() != this->fieldDataHash)
+            || (vtiCall->FrameID() != this->fieldFrameId)) {
+
+        if (!this->strLines.SetVecField(
+                (const float*)vtiCall->GetPointDataByIdx(1, 0), // TODO Do not hardcode array
+                gridSize, gridOrg, gridDelta)) {
+            return false;
+        }
+        if (!this->strLines.SetScalarField(
+                (const float*)vtiCall->GetPointDataByIdx(0, 0), // TODO do not hardcode array
+                gridSize, gridOrg, gridDelta)) {
+            return false;
+        }
+
+        this->fieldDataHash = vtiCall->DataHash();
+        this->fieldFrameId = vtiCall->FrameID();
+        this->triggerUploadFields = false;
+        this->triggerReseed = true;
+    }
+
     // (Re)compute streamlines if necessary
-    if (this->triggerComputeStreamlines) {
+    if (this->triggerReseed || this->triggerComputeStreamlines
+            || (this->seedPoints.Count()/3 != this->nStreamlines)) {
+
+        // If neither the seeding nor the integration changed, only the
+        // streamlines which have been added need to be traced
+        int firstStreamline = 0;
+        if (!this->triggerReseed && !this->triggerComputeStreamlines) {
+            firstStreamline = static_cast<int>(vislib::math::Min(
+                    this->seedPoints.Count()/3, static_cast<SIZE_T>(this->nStreamlines)));
+        }
 
         float zHeight = (vtiCall->GetGridsize().GetZ()-1)*vtiCall->GetSpacing().GetZ();
-        this->genSeedPoints(vtiCall, zHeight*this->seedClipZ, this->seedIso); // Isovalues
-
-        //printf("height: %f, clip %f %f %f %f\n", zHeight, zHeight*0.2, zHeight*0.4, zHeight*0.6,zHeight*0.8);
+        this->genSeedPoints(vtiCall, zHeight*this->seedClipZ, this->seedIso, // Isovalues
+                this->triggerReseed ? 0 : this->nStreamlines);
 
         if (!this->strLines.InitStreamlines(this->streamlineMaxSteps,
                 this->nStreamlines, CUDAStreamlines::BIDIRECTIONAL)) {
@@ -305,34 +350,13 @@ bool StreamlineRenderer::Render(core::Call& call) {
         }
 
         // Integrate streamlines
-        if (!this->strLines.IntegrateRK4(
-                this->seedPoints.PeekElements(),
-                this->streamlineStep,
-                (float*)vtiCall->GetPointDataByIdx(1, 0), // TODO Do not hardcode array
-                make_int3(vtiCall->GetGridsize().GetX(),
-                        vtiCall->GetGridsize().GetY(),
-                        vtiCall->GetGridsize().GetZ()),
-                make_float3(vtiCall->GetOrigin().GetX(),
-                        vtiCall->GetOrigin().GetY(),
-                        vtiCall->GetOrigin().GetZ()),
-                make_float3(vtiCall->GetSpacing().GetX(),
-                                vtiCall->GetSpacing().GetY(),
-                                vtiCall->GetSpacing().GetZ()))) {
+        if (!this->strLines.IntegrateRK4(this->seedPoints.PeekElements(),
+                this->streamlineStep, firstStreamline)) {
             return false;
         }
 
         // Sample the density field to the alpha component
-        if (!this->strLines.SampleScalarFieldToAlpha(
-                (float*)vtiCall->GetPointDataByIdx(0, 0), // TODO do not hardcode array
-                make_int3(vtiCall->GetGridsize().GetX(),
-                        vtiCall->GetGridsize().GetY(),
-                        vtiCall->GetGridsize().GetZ()),
-                        make_float3(vtiCall->GetOrigin().GetX(),
-                                vtiCall->GetOrigin().GetY(),
-                                vtiCall->GetOrigin().GetZ()),
-                                make_float3(vtiCall->GetSpacing().GetX(),
-                                        vtiCall->GetSpacing().GetY(),
-                                        vtiCall->GetSpacing().GetZ()))) {
+        if (!this->strLines.SampleScalarFieldToAlpha(firstStreamline)) {
             return false;
         }
 
@@ -341,21 +365,12 @@ bool StreamlineRenderer::Render(core::Call& call) {
 //            return false;
 //        }
 
-        if (!this->strLines.SampleVecFieldToRGB(
-                (float*)vtiCall->GetPointDataByIdx(1, 0), // TODO do not hardcode array
-                make_int3(vtiCall->GetGridsize().GetX(),
-                                        vtiCall->GetGridsize().GetY(),
-                                        vtiCall->GetGridsize().GetZ()),
-                                        make_float3(vtiCall->GetOrigin().GetX(),
-                                                vtiCall->GetOrigin().GetY(),
-                                                vtiCall->GetOrigin().GetZ()),
-                                                make_float3(vtiCall->GetSpacing().GetX(),
-                                                        vtiCall->GetSpacing().GetY(),
-                                                        vtiCall->GetSpacing().GetZ()))) {
+        if (!this->strLines.SampleVecFieldToRGB(firstStreamline)) {
             return false;
         }
 
         this->triggerComputeStreamlines = false;
+        this->triggerReseed = false;
     }
 
 
@@ -409,7 +424,7 @@ bool StreamlineRenderer::Render(core::Call& call) {
  * StreamlineRenderer::genSeedPoints
  */
 void StreamlineRenderer::genSeedPoints(
-		protein_calls::VTIDataCall *vti, float zClip, float isoval) {
+		protein_calls::VTIDataCall *vti, float zClip, float isoval, unsigned int keepCnt) {
 
 
     float posZ= vti->GetOrigin().GetZ() + zClip; // Start above the lower boundary
@@ -422,7 +437,8 @@ void StreamlineRenderer::genSeedPoints(
 
     // Initialize random seed
     srand (static_cast<unsigned int>(time(NULL)));
-    this->seedPoints.SetCount(0);
+    keepCnt = vislib::math::Min(keepCnt, this->nStreamlines);
+    this->seedPoints.SetCount(vislib::math::Min(this->seedPoints.Count(), static_cast<SIZE_T>(3*keepCnt)));
     //for (size_t cnt = 0; cnt < this->nStreamlines; ++cnt) {
     while (this->seedPoints.Count()/3 < this->nStreamlines) {
         Vec3f pos;
@@ -526,7 +542,6 @@ void StreamlineRenderer::updateParams() {
     if (this->nStreamlinesSlot.IsDirty()) {
         this->nStreamlines = this->nStreamlinesSlot.Param<core::param::IntParam>()->Value();
         this->nStreamlinesSlot.ResetDirty();
-        this->triggerComputeStreamlines = true;
     }
 
     // Set the number of steps for streamline integration
@@ -547,14 +562,14 @@ void StreamlineRenderer::updateParams() {
     if (this->seedClipZSlot.IsDirty()) {
         this->seedClipZ = this->seedClipZSlot.Param<core::param::FloatParam>()->Value();
         this->seedClipZSlot.ResetDirty();
-        this->triggerComputeStreamlines = true;
+        this->triggerReseed = true;
     }
 
     // Set the epsilon for the streamline termination
     if (this->seedIsoSlot.IsDirty()) {
         this->seedIso = this->seedIsoSlot.Param<core::param::FloatParam>()->Value();
         this->seedIsoSlot.ResetDirty();
-        this->triggerComputeStreamlines = true;
+        this->triggerReseed = true;
     }
 
 
@@ -123,8 +123,9 @@ private:
      * @param vti     The data call with the density values
      * @param zClip   The clipping plane z values
      * @param isoval  The iso values
+     * @param keepCnt The number of existing seed points to be kept
      */
-	void genSeedPoints(protein_calls::VTIDataCall *vti, float zClip, float isoval);
+	void genSeedPoints(protein_calls::VTIDataCall *vti, float zClip, float isoval, unsigned int keepCnt);
 
     /**
      * Samples the field at a given position using linear interpolation.
@@ -203,6 +204,12 @@ private:
     /// Array with sedd points
     vislib::Array<float> seedPoints;
 
+    /// The data hash of the fields resident on the GPU
+    SIZE_T fieldDataHash;
+
+    /// The frame of the fields resident on the GPU
+    unsigned int fieldFrameId;
+
 
     /* Boolean flags */
 
@@ -212,6 +219,12 @@ private:
     /// Triggers recomputation of the streamlines
     bool triggerComputeStreamlines;
 
+    /// Triggers the upload of the fields to the GPU
+    bool triggerUploadFields;
+
+    /// Triggers the generation of new seed points
+    bool triggerReseed;
+
 
     /* Rendering */
 
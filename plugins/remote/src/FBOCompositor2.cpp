@@ -17,6 +17,8 @@
 
 #include "snappy.h"
 
+#include "TileDelta.h"
+
 #include <exception>
 #include "vislib/Exception.h"
 
@@ -321,16 +323,23 @@ bool megamol::remote::FBOCompositor2::getImageCallback(megamol::core::Call& c) {
         // TODO For now, we only provide FBO 0
         auto const& fbo = (*this->fbo_msg_write_)[0];
 
-        RGBAtoRGB(fbo.color_buf, this->img_data_);
+        if (this->img_data_ == nullptr || this->img_data_.use_count() > 1) {
+            this->img_data_ = std::make_shared<std::vector<unsigned char>>();
+        }
+        RGBAtoRGB(fbo.color_buf, *this->img_data_);
 
         ++hash_;
 
         data_has_changed_.store(false);
     }
 
-    // img_data_ptr_ = std::make_shared<unsigned char[]>(this->img_data_.data());
+    if (this->img_data_ == nullptr) {
+        this->img_data_ = std::make_shared<std::vector<unsigned char>>();
+    }
+
+    // the handle shares ownership of the buffer, so the next image does not overwrite data still in use
     imgc->SetData(megamol::image_calls::Image2DCall::RAW, megamol::image_calls::Image2DCall::RGB, width_, height_,
-        this->img_data_.size(), this->img_data_.data());
+        this->img_data_->size(), std::shared_ptr<const void>(this->img_data_, this->img_data_->data()));
 
     imgc->SetDataHash(hash_);
 
@@ -390,6 +399,10 @@ bool megamol::remote::FBOCompositor2::initThreads() {
 void megamol::remote::FBOCompositor2::receiverJob(
     FBOCommFabric& comm, core::utility::sys::FutureReset<fbo_msg_t>* fbo_msg_future, std::future<bool>&& close) {
     try {
+        // last frame received, to which frames of changed tiles are applied
+        std::vector<char> col_ref;
+        std::vector<char> depth_ref;
+
         while (!shutdown_) {
             auto const status = close.wait_for(std::chrono::milliseconds(1));
             if (status == std::future_status::ready) break;
@@ -460,18 +473,49 @@ void megamol::remote::FBOCompositor2::receiverJob(
                 continue;
             }
 
-            std::vector<char> col_buf(fbo_col_size);
             std::vector<char> col_comp_buf(header.color_buf_size);
             std::copy(buf_ptr, buf_ptr + header.color_buf_size, col_comp_buf.begin());
             buf_ptr += header.color_buf_size;
-            std::vector<char> depth_buf(fbo_depth_size);
             std::vector<char> depth_comp_buf(header.depth_buf_size);
             std::copy(buf_ptr, buf_ptr + header.depth_buf_size, depth_comp_buf.begin());
 
             // snappy uncompress
+            size_t col_size = 0;
+            size_t depth_size = 0;
+            if (!snappy::GetUncompressedLength(col_comp_buf.data(), col_comp_buf.size(), &col_size) ||
+                !snappy::GetUncompressedLength(depth_comp_buf.data(), depth_comp_buf.size(), &depth_size) ||
+                (header.tile_size == 0 && (col_size != fbo_col_size || depth_size != fbo_depth_size))) {
+                vislib::sys::Log::DefaultLog.WriteWarn("FBOCompositor2: Dropping malformed frame\n");
+                continue;
+            }
+            std::vector<char> col_buf(col_size);
+            std::vector<char> depth_buf(depth_size);
             snappy::RawUncompress(col_comp_buf.data(), col_comp_buf.size(), col_buf.data());
             snappy::RawUncompress(depth_comp_buf.data(), depth_comp_buf.size(), depth_buf.data());
 
+            // apply changed tiles to the last frame
+            if (header.tile_size == 0) {
+                col_ref = col_buf;
+                depth_ref = depth_buf;
+            } else {
+                int const width = header.updated_area[2] - header.updated_area[0];
+                int const height = header.updated_area[3] - header.updated_area[1];
+                int const tile_size = static_cast<int>(header.tile_size);
+                if (!DecodeTileDelta(col_buf, col_ref, width, height, col_buf_el_size_, tile_size) ||
+                    !DecodeTileDelta(depth_buf, depth_ref, width, height, depth_buf_el_size_, tile_size)) {
+                    // joined after the last full frame, wait for the next one
+#if _DEBUG
+                    vislib::sys::Log::DefaultLog.WriteWarn(
+                        "FBOCompositor2: Dropping changed tiles without full frame\n");
+#endif
+                    col_ref.clear();
+                    depth_ref.clear();
+                    continue;
+                }
+                col_buf = col_ref;
+                depth_buf = depth_ref;
+            }
+
             /*std::vector<char> col_buf(fbo_col_size);
             std::copy(buf_ptr, buf_ptr + fbo_col_size, col_buf.begin());
             buf_ptr += fbo_col_size;
@@ -196,9 +196,8 @@ private:
 
     std::vector<std::string> addresses_;
 
-    std::vector<unsigned char> img_data_;
-
-    // std::shared_ptr<unsigned char[]> img_data_ptr_;
+    /** The image provided to Image2DCalls, replaced instead of overwritten while consumers still hold it */
+    std::shared_ptr<std::vector<unsigned char>> img_data_;
 
     size_t hash_;
 
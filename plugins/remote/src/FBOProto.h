@@ -99,6 +99,8 @@ struct fbo_msg_header {
     fbo_color_type color_type;
     // fbo depth type
     fbo_depth_type depth_type;
+    // delta tile size
+    unsigned int tile_size; /// 0 for a full frame, otherwise edge length of the tiles changed since the last frame
     // color buf size
     size_t color_buf_size;
     // depth buf size
@@ -7,6 +7,8 @@
 
 #include "snappy.h"
 
+#include "TileDelta.h"
+
 #include "vislib/sys/Log.h"
 
 #include "mmcore/CallerSlot.h"
@@ -42,22 +44,29 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
     , handshake_port_slot_{"handshakePort", "Port for zmq handshake"}
     , reconnect_slot_{"reconnect", "Reconnect comm threads"}
     , tiled_slot_("tiledDisplay", "True if rendering on a tiled display")
+    , async_readback_slot_{"asyncReadback", "Read the FBO through pixel buffers, delaying transmission by one frame"}
+    , delta_tile_slot_{"deltaTileSize", "Edge length of the tiles sent if they changed, 0 always sends full frames"}
+    , key_frame_slot_{"keyFrameInterval", "Number of frames sent as changed tiles between two full frames"}
 #ifdef WITH_MPI
     , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
     , toggle_aggregate_slot_{"aggregate", "Toggle whether to aggregate and composite FBOs prior to transmission"}
     , render_comp_img_slot_("renderCompImage", "Renders the complete composited image on the broadcast master")
+    , composite_strategy_slot_{"compositeStrategy", "The IceT strategy compositing the images of all ranks"}
+    , bounds_culling_slot_{"boundsCulling", "Skip image regions outside the projected bounding box of each rank"}
 #endif // WITH_MPI
     , aggregate_{false}
     , frame_id_{0}
     , thread_stop_{false}
-    , fbo_msg_read_{new fbo_msg_header_t}
-    , fbo_msg_send_{new fbo_msg_header_t}
+    , fbo_msg_read_{new fbo_msg_header_t()}
+    , fbo_msg_send_{new fbo_msg_header_t()}
     , color_buf_read_{new std::vector<char>}
     , depth_buf_read_{new std::vector<char>}
     , color_buf_send_{new std::vector<char>}
     , depth_buf_send_{new std::vector<char>}
     , col_buf_el_size_{4}
     , depth_buf_el_size_{4}
+    , readback_idx_{0}
+    , key_frame_interval_{30}
     , connected_{false}
     , validViewport(false) {
     this->address_slot_ << new megamol::core::param::StringParam{"34242"};
@@ -87,6 +96,15 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
     render_comp_img_slot_ << new megamol::core::param::BoolParam{false};
     this->render_comp_img_slot_.SetUpdateCallback(&FBOTransmitter2::renderCompChanged);
     this->MakeSlotAvailable(&render_comp_img_slot_);
+    auto cs = new megamol::core::param::EnumParam(ICET_SINGLE_IMAGE_STRATEGY_RADIXK);
+    cs->SetTypePair(ICET_SINGLE_IMAGE_STRATEGY_AUTOMATIC, "Automatic");
+    cs->SetTypePair(ICET_SINGLE_IMAGE_STRATEGY_BSWAP, "Binary-Swap");
+    cs->SetTypePair(ICET_SINGLE_IMAGE_STRATEGY_RADIXK, "Radix-k");
+    cs->SetTypePair(ICET_SINGLE_IMAGE_STRATEGY_TREE, "Tree");
+    composite_strategy_slot_ << cs;
+    this->MakeSlotAvailable(&composite_strategy_slot_);
+    bounds_culling_slot_ << new megamol::core::param::BoolParam{true};
+    this->MakeSlotAvailable(&bounds_culling_slot_);
 #endif // WITH_MPI
     reconnect_slot_ << new megamol::core::param::ButtonParam{};
     reconnect_slot_.SetUpdateCallback(&FBOTransmitter2::reconnectCallback);
@@ -94,6 +112,13 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
 
     tiled_slot_ << new megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&tiled_slot_);
+
+    async_readback_slot_ << new megamol::core::param::BoolParam(true);
+    this->MakeSlotAvailable(&async_readback_slot_);
+    delta_tile_slot_ << new megamol::core::param::IntParam(32, 0);
+    this->MakeSlotAvailable(&delta_tile_slot_);
+    key_frame_slot_ << new megamol::core::param::IntParam(30, 1);
+    this->MakeSlotAvailable(&key_frame_slot_);
 }
 
 
@@ -108,7 +133,10 @@ bool megamol::remote::FBOTransmitter2::create() {
 }
 
 
-void megamol::remote::FBOTransmitter2::release() { shutdownThreads(); }
+void megamol::remote::FBOTransmitter2::release() {
+    shutdownThreads();
+    releaseReadback();
+}
 
 
 void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::AbstractView* view) {
@@ -135,30 +163,49 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
             this->viewport[5] = glvp[3];
         }
     }
-    int xoff = this->viewport[0];
-    int yoff = this->viewport[1];
-    int tile_width = this->viewport[2];
-    int tile_height = this->viewport[3];
-    int width = this->viewport[4];
-    int height = this->viewport[5];
-
 #if _DEBUG
     vislib::sys::Log::DefaultLog.WriteInfo("FBOTransmitter2: Extracting Viewport ... Done");
 #endif
 
+#ifdef WITH_MPI
+    if (aggregate_) {
+        composite_bounds bounds;
+        bounds.valid =
+            this->bounds_culling_slot_.Param<core::param::BoolParam>()->Value() && this->extractBounds(bounds);
+        if (this->async_readback_slot_.Param<core::param::BoolParam>()->Value()) {
+            // the readback returns the previous frame, which must be composited with its own camera
+            this->composite_bounds_ = this->pending_bounds_;
+            this->pending_bounds_ = bounds;
+        } else {
+            this->composite_bounds_ = bounds;
+        }
+    }
+#endif // WITH_MPI
+
     // read FBO
-    std::vector<char> col_buf(width * height * col_buf_el_size_);
-    std::vector<char> depth_buf(width * height * depth_buf_el_size_);
+    int tile_vp[6];
+    std::vector<char> col_buf_tile;
+    std::vector<char> depth_buf_tile;
+    if (!this->readFBO(this->viewport, col_buf_tile, depth_buf_tile, tile_vp)) {
+        // the first frame of an asynchronous readback is still in flight
+        return;
+    }
+    int xoff = tile_vp[0];
+    int yoff = tile_vp[1];
+    int tile_width = tile_vp[2];
+    int tile_height = tile_vp[3];
+    int width = tile_vp[4];
+    int height = tile_vp[5];
+
+    std::vector<char> col_buf;
+    std::vector<char> depth_buf;
 
     if ((tile_width == width) && (tile_height == height)) {
-        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, col_buf.data());
-        glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, depth_buf.data());
+        col_buf.swap(col_buf_tile);
+        depth_buf.swap(depth_buf_tile);
     } else {
-        std::vector<char> col_buf_tile(tile_width * tile_height * col_buf_el_size_);
-        std::vector<char> depth_buf_tile(tile_width * tile_height * depth_buf_el_size_);
-
-        glReadPixels(0, 0, tile_width, tile_height, GL_RGBA, GL_UNSIGNED_BYTE, col_buf_tile.data());
-        glReadPixels(0, 0, tile_width, tile_height, GL_DEPTH_COMPONENT, GL_FLOAT, depth_buf_tile.data());
+        col_buf.resize(width * height * col_buf_el_size_);
+        depth_buf.resize(width * height * depth_buf_el_size_);
 
         int row_offset = yoff * width; // y * width = row offset * tile width
         int column_offset = xoff;      // x  = column offset
@@ -198,7 +245,20 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
             "IceT gets image with xoff: %d, yoff: %d, tile_width: %d, tile_height: %d\n", xoff, yoff, tile_width,
             tile_height);
 #    endif
-        auto const icet_comp_image = icetCompositeImage(col_buf.data(), depth_buf.data(), tilevp, nullptr, nullptr,
+
+        // ranks only exchange the part of the image covered by their projected bounds
+        auto const& bounds = this->composite_bounds_;
+        if (bounds.valid) {
+            icetBoundingBoxf(
+                bounds.bbox[0], bounds.bbox[3], bounds.bbox[1], bounds.bbox[4], bounds.bbox[2], bounds.bbox[5]);
+        } else {
+            icetBoundingVertices(0, ICET_FLOAT, 0, 0, nullptr);
+        }
+        icetSingleImageStrategy(static_cast<IceTEnum>(
+            this->composite_strategy_slot_.Param<megamol::core::param::EnumParam>()->Value()));
+
+        auto const icet_comp_image = icetCompositeImage(col_buf.data(), depth_buf.data(), tilevp,
+            bounds.valid ? bounds.projection : nullptr, bounds.valid ? bounds.modelview : nullptr,
             static_cast<const IceTFloat*>(backgroundColor.data()));
 #    if _DEBUG
         vislib::sys::Log::DefaultLog.WriteInfo("FBOTransmitter2: IceT - Composite Image Done\n");
@@ -247,6 +307,8 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
             }
             this->fbo_msg_read_->color_type = fbo_color_type::RGBAu8;
             this->fbo_msg_read_->depth_type = fbo_depth_type::Df;
+            this->fbo_msg_read_->tile_size = this->delta_tile_slot_.Param<core::param::IntParam>()->Value();
+            this->key_frame_interval_.store(this->key_frame_slot_.Param<core::param::IntParam>()->Value());
             for (int i = 0; i < 6; ++i) {
                 this->fbo_msg_read_->os_bbox[i] = this->fbo_msg_read_->cs_bbox[i] = bbox[i];
             }
@@ -286,6 +348,15 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
 
 void megamol::remote::FBOTransmitter2::transmitterJob() {
     try {
+        // last frame sent, which the receiver holds as reference for changed tiles
+        std::vector<char> col_ref;
+        std::vector<char> depth_ref;
+        int ref_width = 0;
+        int ref_height = 0;
+        int frames_since_key = 0;
+        std::vector<char> col_delta;
+        std::vector<char> depth_delta;
+
         while (!this->thread_stop_) {
             // transmit only upon request
             std::vector<char> buf;
@@ -338,9 +409,40 @@ void megamol::remote::FBOTransmitter2::transmitterJob() {
                 //            }
                 //#endif
 
+                // send full frames periodically, so receivers joining later catch up
+                int const width = fbo_msg_send_->updated_area[2] - fbo_msg_send_->updated_area[0];
+                int const height = fbo_msg_send_->updated_area[3] - fbo_msg_send_->updated_area[1];
+                int const tile_size = static_cast<int>(fbo_msg_send_->tile_size);
+                bool const key_frame = (tile_size <= 0) || (width != ref_width) || (height != ref_height) ||
+                                       (frames_since_key + 1 >= this->key_frame_interval_.load());
+
+                std::vector<char> const* col_src = this->color_buf_send_.get();
+                std::vector<char> const* depth_src = this->depth_buf_send_.get();
+                if (key_frame) {
+                    fbo_msg_send_->tile_size = 0;
+                    if (tile_size > 0) {
+                        col_ref = *this->color_buf_send_;
+                        depth_ref = *this->depth_buf_send_;
+                    } else {
+                        col_ref.clear();
+                        depth_ref.clear();
+                    }
+                    ref_width = width;
+                    ref_height = height;
+                    frames_since_key = 0;
+                } else {
+                    EncodeTileDelta(
+                        *this->color_buf_send_, col_ref, width, height, col_buf_el_size_, tile_size, col_delta);
+                    EncodeTileDelta(
+                        *this->depth_buf_send_, depth_ref, width, height, depth_buf_el_size_, tile_size, depth_delta);
+                    col_src = &col_delta;
+                    depth_src = &depth_delta;
+                    ++frames_since_key;
+                }
+
                 // snappy compression
-                std::vector<char> col_comp_buf(snappy::MaxCompressedLength(this->color_buf_send_->size()));
-                std::vector<char> depth_comp_buf(snappy::MaxCompressedLength(this->depth_buf_send_->size()));
+                std::vector<char> col_comp_buf(snappy::MaxCompressedLength(col_src->size()));
+                std::vector<char> depth_comp_buf(snappy::MaxCompressedLength(depth_src->size()));
                 size_t col_comp_size = 0;
                 size_t depth_comp_size = 0;
 
@@ -350,10 +452,8 @@ void megamol::remote::FBOTransmitter2::transmitterJob() {
                 //    snappy::RawCompress(reinterpret_cast<char*>(icet_depth_buf), this->depth_buf_send_->size(),
                 //        depth_comp_buf.data(), &depth_comp_size);
                 //} else {
-                snappy::RawCompress(
-                    this->color_buf_send_->data(), this->color_buf_send_->size(), col_comp_buf.data(), &col_comp_size);
-                snappy::RawCompress(this->depth_buf_send_->data(), this->depth_buf_send_->size(), depth_comp_buf.data(),
-                    &depth_comp_size);
+                snappy::RawCompress(col_src->data(), col_src->size(), col_comp_buf.data(), &col_comp_size);
+                snappy::RawCompress(depth_src->data(), depth_src->size(), depth_comp_buf.data(), &depth_comp_size);
                 //}
 
                 fbo_msg_send_->color_buf_size = col_comp_size;
@@ -525,6 +625,143 @@ bool megamol::remote::FBOTransmitter2::extractViewport(int vvpt[6]) {
 }
 
 
+#ifdef WITH_MPI
+bool megamol::remote::FBOTransmitter2::extractBounds(composite_bounds& bounds) {
+    std::string mvn(view_name_slot_.Param<megamol::core::param::StringParam>()->Value());
+
+    bool valid = false;
+    const auto ret =
+        this->GetCoreInstance()
+            ->EnumerateCallerSlotsNoLock<megamol::core::view::AbstractView, megamol::core::view::CallRender3D_2>(
+                mvn, [&bounds, &valid](megamol::core::view::CallRender3D_2& cr3d) {
+                    auto const& clip = cr3d.AccessBoundingBoxes().ClipBox();
+                    if (clip.IsEmpty()) return;
+                    bounds.bbox[0] = clip.GetLeft();
+                    bounds.bbox[1] = clip.GetBottom();
+                    bounds.bbox[2] = clip.GetBack();
+                    bounds.bbox[3] = clip.GetRight();
+                    bounds.bbox[4] = clip.GetTop();
+                    bounds.bbox[5] = clip.GetFront();
+
+                    core::view::Camera_2 cam;
+                    cr3d.GetCamera(cam);
+                    cam_type::snapshot_type snapshot;
+                    cam_type::matrix_type viewT, projT;
+                    cam.calc_matrices(snapshot, viewT, projT);
+                    glm::mat4 const view = viewT;
+                    glm::mat4 const proj = projT;
+                    for (int c = 0; c < 4; ++c) {
+                        for (int r = 0; r < 4; ++r) {
+                            bounds.modelview[4 * c + r] = view[c][r];
+                            bounds.projection[4 * c + r] = proj[c][r];
+                        }
+                    }
+                    valid = true;
+                });
+
+    return ret && valid;
+}
+#endif // WITH_MPI
+
+
+bool megamol::remote::FBOTransmitter2::readFBO(
+    int const vp[6], std::vector<char>& col_tile, std::vector<char>& depth_tile, int tile_vp[6]) {
+    size_t const pixels = static_cast<size_t>(vp[2]) * static_cast<size_t>(vp[3]);
+
+    if (!this->async_readback_slot_.Param<core::param::BoolParam>()->Value()) {
+        if (this->readback_[0].color_pbo != 0) {
+            this->releaseReadback();
+        }
+        col_tile.resize(pixels * col_buf_el_size_);
+        depth_tile.resize(pixels * depth_buf_el_size_);
+        glReadPixels(0, 0, vp[2], vp[3], GL_RGBA, GL_UNSIGNED_BYTE, col_tile.data());
+        glReadPixels(0, 0, vp[2], vp[3], GL_DEPTH_COMPONENT, GL_FLOAT, depth_tile.data());
+        std::copy(vp, vp + 6, tile_vp);
+        return true;
+    }
+
+    // issue the read of this frame into pixel buffers ...
+    auto& cur = this->readback_[this->readback_idx_];
+    if (cur.color_pbo == 0) {
+        glGenBuffers(1, &cur.color_pbo);
+        glGenBuffers(1, &cur.depth_pbo);
+    }
+    if (cur.pbo_pixels < pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, cur.color_pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, pixels * col_buf_el_size_, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, cur.depth_pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, pixels * depth_buf_el_size_, nullptr, GL_STREAM_READ);
+        cur.pbo_pixels = pixels;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, cur.color_pbo);
+    glReadPixels(0, 0, vp[2], vp[3], GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, cur.depth_pbo);
+    glReadPixels(0, 0, vp[2], vp[3], GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (cur.fence != nullptr) {
+        glDeleteSync(cur.fence);
+    }
+    cur.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    std::copy(vp, vp + 6, cur.viewport);
+    cur.pending = true;
+
+    // ... and map the one issued in the previous frame, which has usually completed by now
+    this->readback_idx_ = 1 - this->readback_idx_;
+    auto& prev = this->readback_[this->readback_idx_];
+    if (!prev.pending) {
+        return false;
+    }
+    if (glClientWaitSync(prev.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_WAIT_FAILED) {
+        vislib::sys::Log::DefaultLog.WriteError("FBOTransmitter2: Waiting for FBO readback failed.\n");
+    }
+    prev.pending = false;
+
+    std::copy(prev.viewport, prev.viewport + 6, tile_vp);
+    size_t const prev_pixels = static_cast<size_t>(tile_vp[2]) * static_cast<size_t>(tile_vp[3]);
+    col_tile.resize(prev_pixels * col_buf_el_size_);
+    depth_tile.resize(prev_pixels * depth_buf_el_size_);
+
+    bool success = true;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, prev.color_pbo);
+    auto ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, col_tile.size(), GL_MAP_READ_BIT);
+    if (ptr != nullptr) {
+        memcpy(col_tile.data(), ptr, col_tile.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        success = false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, prev.depth_pbo);
+    ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_tile.size(), GL_MAP_READ_BIT);
+    if (ptr != nullptr) {
+        memcpy(depth_tile.data(), ptr, depth_tile.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        success = false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!success) {
+        vislib::sys::Log::DefaultLog.WriteError("FBOTransmitter2: Could not map FBO readback buffer.\n");
+    }
+    return success;
+}
+
+
+void megamol::remote::FBOTransmitter2::releaseReadback() {
+    for (auto& slot : this->readback_) {
+        if (slot.color_pbo != 0) {
+            glDeleteBuffers(1, &slot.color_pbo);
+            glDeleteBuffers(1, &slot.depth_pbo);
+        }
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+        }
+        slot = readback_slot{};
+    }
+    this->readback_idx_ = 0;
+}
+
+
 bool megamol::remote::FBOTransmitter2::extractBkgndColor(std::array<float, 4>& bkgnd_color) {
     using vislib::sys::Log;
 
@@ -7,6 +7,8 @@
 #include <thread>
 #include <vector>
 
+#include "glad/glad.h"
+
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/view/AbstractRenderingView.h"
@@ -73,6 +75,26 @@ protected:
     void release() override;
 
 private:
+    /** One slot of the asynchronous FBO readback */
+    struct readback_slot {
+        GLuint color_pbo = 0;
+        GLuint depth_pbo = 0;
+        size_t pbo_pixels = 0;
+        GLsync fence = nullptr;
+        int viewport[6] = {0, 0, 0, 0, 0, 0};
+        bool pending = false;
+    };
+
+#ifdef WITH_MPI
+    /** Camera and bounds IceT uses to skip image regions a rank has not drawn to */
+    struct composite_bounds {
+        IceTDouble modelview[16];
+        IceTDouble projection[16];
+        float bbox[6];
+        bool valid = false;
+    };
+#endif // WITH_MPI
+
     void swapBuffers(void) {
         std::scoped_lock<std::mutex, std::mutex> guard{this->buffer_send_guard_, this->buffer_read_guard_};
         swap(fbo_msg_read_, fbo_msg_send_);
@@ -90,6 +112,26 @@ private:
 
     bool extractViewport(int vvpt[6]);
 
+#ifdef WITH_MPI
+    bool extractBounds(composite_bounds& bounds);
+#endif // WITH_MPI
+
+    /**
+     * Reads the current tile of the FBO.
+     *
+     * With asynchronous readback, the read is only issued, and the tile issued in the previous frame is returned.
+     *
+     * @param vp The viewport of the current frame.
+     * @param col_tile Receives the color of the tile.
+     * @param depth_tile Receives the depth of the tile.
+     * @param tile_vp Receives the viewport of the returned tile.
+     *
+     * @return 'true' if a tile has been returned, 'false' otherwise.
+     */
+    bool readFBO(int const vp[6], std::vector<char>& col_tile, std::vector<char>& depth_tile, int tile_vp[6]);
+
+    void releaseReadback();
+
     bool initMPI();
 
     bool reconnectCallback(megamol::core::param::ParamSlot& p);
@@ -116,6 +158,12 @@ private:
 
     megamol::core::param::ParamSlot tiled_slot_;
 
+    megamol::core::param::ParamSlot async_readback_slot_;
+
+    megamol::core::param::ParamSlot delta_tile_slot_;
+
+    megamol::core::param::ParamSlot key_frame_slot_;
+
     bool aggregate_;
 
 #ifdef WITH_MPI
@@ -126,6 +174,15 @@ private:
 
     megamol::core::param::ParamSlot render_comp_img_slot_;
 
+    megamol::core::param::ParamSlot composite_strategy_slot_;
+
+    megamol::core::param::ParamSlot bounds_culling_slot_;
+
+    /** bounds of the frame composited next */
+    composite_bounds composite_bounds_;
+
+    /** bounds of the frame still in flight in the asynchronous readback */
+    composite_bounds pending_bounds_;
 
 
     bool useMpi = false;
@@ -172,6 +229,12 @@ private:
 
     int depth_buf_el_size_;
 
+    readback_slot readback_[2];
+
+    int readback_idx_;
+
+    std::atomic<int> key_frame_interval_;
+
     bool connected_;
 
     int viewport[6];
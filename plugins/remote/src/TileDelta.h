@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+namespace megamol {
+namespace remote {
+
+/**
+ * Answer the number of tiles covering an image.
+ *
+ * @param width     The width of the image in pixels.
+ * @param height    The height of the image in pixels.
+ * @param tile_size The edge length of a tile in pixels.
+ *
+ * @return The number of tiles.
+ */
+inline size_t TileCount(int width, int height, int tile_size) {
+    return static_cast<size_t>((width + tile_size - 1) / tile_size) * ((height + tile_size - 1) / tile_size);
+}
+
+/**
+ * Encode the tiles of an image that differ from a reference image of the same size.
+ *
+ * The result is one byte per tile, non-zero if the tile changed, followed by the rows of the changed tiles in tile
+ * order. The reference is updated to the image.
+ *
+ * @param img       The image, row major.
+ * @param ref       The reference image, row major.
+ * @param width     The width of both images in pixels.
+ * @param height    The height of both images in pixels.
+ * @param el_size   The size of a pixel in bytes.
+ * @param tile_size The edge length of a tile in pixels.
+ * @param out       Receives the encoded changes.
+ */
+inline void EncodeTileDelta(std::vector<char> const& img, std::vector<char>& ref, int width, int height,
+    int el_size, int tile_size, std::vector<char>& out) {
+    size_t const tiles_x = (width + tile_size - 1) / tile_size;
+    size_t const tiles = TileCount(width, height, tile_size);
+    size_t const pitch = static_cast<size_t>(width) * el_size;
+
+    out.assign(tiles, 0);
+    out.reserve(tiles + img.size());
+
+    for (size_t t = 0; t < tiles; ++t) {
+        int const x0 = static_cast<int>(t % tiles_x) * tile_size;
+        int const y0 = static_cast<int>(t / tiles_x) * tile_size;
+        size_t const row = static_cast<size_t>(std::min(tile_size, width - x0)) * el_size;
+        int const rows = std::min(tile_size, height - y0);
+
+        bool changed = false;
+        for (int y = y0; (y < y0 + rows) && !changed; ++y) {
+            size_t const off = y * pitch + x0 * el_size;
+            changed = (std::memcmp(img.data() + off, ref.data() + off, row) != 0);
+        }
+        if (!changed) continue;
+
+        out[t] = 1;
+        for (int y = y0; y < y0 + rows; ++y) {
+            size_t const off = y * pitch + x0 * el_size;
+            out.insert(out.end(), img.begin() + off, img.begin() + off + row);
+            std::memcpy(ref.data() + off, img.data() + off, row);
+        }
+    }
+}
+
+/**
+ * Apply changes encoded by 'EncodeTileDelta' to a reference image.
+ *
+ * @param delta     The encoded changes.
+ * @param ref       The reference image, row major, which receives the changes.
+ * @param width     The width of the image in pixels.
+ * @param height    The height of the image in pixels.
+ * @param el_size   The size of a pixel in bytes.
+ * @param tile_size The edge length of a tile in pixels.
+ *
+ * @return 'true' on success, 'false' if the changes do not match the image size.
+ */
+inline bool DecodeTileDelta(std::vector<char> const& delta, std::vector<char>& ref, int width, int height,
+    int el_size, int tile_size) {
+    size_t const tiles_x = (width + tile_size - 1) / tile_size;
+    size_t const tiles = TileCount(width, height, tile_size);
+    size_t const pitch = static_cast<size_t>(width) * el_size;
+    if (delta.size() < tiles || ref.size() != pitch * height) return false;
+
+    size_t src = tiles;
+    for (size_t t = 0; t < tiles; ++t) {
+        if (delta[t] == 0) continue;
+
+        int const x0 = static_cast<int>(t % tiles_x) * tile_size;
+        int const y0 = static_cast<int>(t / tiles_x) * tile_size;
+        size_t const row = static_cast<size_t>(std::min(tile_size, width - x0)) * el_size;
+        int const rows = std::min(tile_size, height - y0);
+        if (src + row * rows > delta.size()) return false;
+
+        for (int y = y0; y < y0 + rows; ++y) {
+            std::memcpy(ref.data() + y * pitch + x0 * el_size, delta.data() + src, row);
+            src += row;
+        }
+    }
+    return src == delta.size();
+}
+
+} // end namespace remote
+} // end namespace megamol
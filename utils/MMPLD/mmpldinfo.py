@@ -278,6 +278,19 @@ for filename in parseResult.inputfiles:
                 else:
                     f.seek(listNumParts * stride, os.SEEK_CUR)
 
+            if (f.tell() + 8 <= frameTable[fi + 1]):
+                section = f.read(8)
+                if (section[0:4] == b"MMCI" and struct.unpack("<I", section[4:8])[0] == numLists):
+                    # cell indices of the lists sorted by MMPLDWriter
+                    for li in range(numLists):
+                        level = getByte(f)
+                        f.seek(24, os.SEEK_CUR)
+                        numCells = getUInt(f)
+                        listFramedata(parseResult, fi) and print("    #%u: cell index of level %u, %u non-empty cell%s" % ((li, level) + pluralTuple(numCells)))
+                        f.seek(12 * numCells, os.SEEK_CUR)
+                else:
+                    f.seek(-8, os.SEEK_CUR)
+
             if (f.tell() != frameTable[fi + 1]):
                 print("warning: trailing data after frame %u or frame table corrupted" % (fi))
             if (fi == 0):
@@ -0,0 +1,302 @@
+/*
+ * import.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "import.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using namespace megamol;
+
+namespace {
+
+/** Colours of the lists of the types of xyz files, in order of appearance */
+const uint8_t typeColours[][4] = {{0, 128, 192, 255}, {0, 192, 224, 255}, {224, 96, 0, 255}, {96, 192, 0, 255},
+    {192, 0, 128, 255}, {224, 192, 0, 255}, {128, 128, 128, 255}};
+
+/** A text file read line by line through a large buffer */
+class LineReader {
+public:
+    explicit LineReader(const std::string& path) : buffer(1 << 22), stream(), line(), lineNo(0) {
+        this->stream.rdbuf()->pubsetbuf(this->buffer.data(), this->buffer.size());
+        this->stream.open(path);
+        if (!this->stream) throw std::runtime_error("cannot open \"" + path + "\"");
+    }
+
+    bool Next(void) {
+        ++this->lineNo;
+        return static_cast<bool>(std::getline(this->stream, this->line));
+    }
+
+    /** Reads the next line, failing at the end of the file */
+    const std::string& Expect(void) {
+        if (!this->Next()) throw std::runtime_error("unexpected end of file");
+        return this->line;
+    }
+
+    inline const std::string& Line(void) const {
+        return this->line;
+    }
+
+    inline size_t LineNo(void) const {
+        return this->lineNo;
+    }
+
+private:
+    std::vector<char> buffer;
+    std::ifstream stream;
+    std::string line;
+    size_t lineNo;
+};
+
+/**
+ * Parses up to max whitespace separated numbers.
+ *
+ * @return The number of numbers parsed
+ */
+size_t parseNumbers(const char* str, double* out, size_t max) {
+    size_t cnt = 0;
+    while (cnt < max) {
+        char* end = nullptr;
+        const double v = std::strtod(str, &end);
+        if (end == str) break;
+        out[cnt++] = v;
+        str = end;
+    }
+    return cnt;
+}
+
+uint64_t parseCount(const std::string& line) {
+    double v = 0.0;
+    if (parseNumbers(line.c_str(), &v, 1) != 1) throw std::runtime_error("particle count expected");
+    return static_cast<uint64_t>(v);
+}
+
+template <class T> void append(std::vector<uint8_t>& data, const T* values, size_t cnt) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(values);
+    data.insert(data.end(), p, p + cnt * sizeof(T));
+}
+
+void warnCount(const std::string& path, uint64_t found, uint64_t expected) {
+    if (found != expected) {
+        std::cerr << "Warning: " << path << " contains " << found << " particles instead of " << expected
+                  << std::endl;
+    }
+}
+
+} // namespace
+
+
+/*
+ * mmpldtool::ParseInputFormat
+ */
+bool mmpldtool::ParseInputFormat(const std::string& name, InputFormat& outFormat) {
+    static const std::map<std::string, InputFormat> formats = {{"mmpld", InputFormat::MMPLD},
+        {"xyz", InputFormat::XYZ}, {"pts", InputFormat::PTS}, {"cpe", InputFormat::CPE}, {"imd", InputFormat::IMD}};
+    std::string n(name);
+    std::transform(n.begin(), n.end(), n.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto f = formats.find(n);
+    if (f == formats.end()) return false;
+    outFormat = f->second;
+    return true;
+}
+
+
+/*
+ * mmpldtool::GuessInputFormat
+ */
+mmpldtool::InputFormat mmpldtool::GuessInputFormat(const std::string& path) {
+    InputFormat format = InputFormat::MMPLD;
+    const size_t dot = path.find_last_of('.');
+    if ((dot != std::string::npos) && ParseInputFormat(path.substr(dot + 1), format)) return format;
+    return InputFormat::MMPLD;
+}
+
+
+/*
+ * mmpldtool::ReadXYZ
+ */
+void mmpldtool::ReadXYZ(const std::string& path, float radius, Frame& outFrame) {
+    LineReader reader(path);
+    const uint64_t expected = parseCount(reader.Expect());
+    reader.Expect(); // comment
+
+    outFrame.lists.clear();
+    std::map<std::string, size_t> types;
+    uint64_t found = 0;
+    while (reader.Next()) {
+        const char* s = reader.Line().c_str();
+        while (std::isspace(static_cast<unsigned char>(*s))) ++s;
+        if (*s == 0) continue;
+        const char* typeEnd = s;
+        while ((*typeEnd != 0) && !std::isspace(static_cast<unsigned char>(*typeEnd))) ++typeEnd;
+        double pos[3];
+        if (parseNumbers(typeEnd, pos, 3) != 3) {
+            throw std::runtime_error("malformed particle in line " + std::to_string(reader.LineNo()));
+        }
+
+        const std::string type(s, typeEnd);
+        auto t = types.find(type);
+        if (t == types.end()) {
+            t = types.insert(std::make_pair(type, outFrame.lists.size())).first;
+            ParticleList list;
+            list.header.vertexType = VERTEX_FLOAT_XYZ;
+            list.header.colourType = COLOUR_NONE;
+            list.header.globalRadius = radius;
+            const size_t colourCnt = sizeof(typeColours) / sizeof(typeColours[0]);
+            std::memcpy(list.header.globalColour, typeColours[t->second % colourCnt], 4);
+            outFrame.lists.push_back(std::move(list));
+        }
+        ParticleList& list = outFrame.lists[t->second];
+        const float p[3] = {static_cast<float>(pos[0]), static_cast<float>(pos[1]), static_cast<float>(pos[2])};
+        append(list.data, p, 3);
+        ++list.header.count;
+        ++found;
+    }
+    if (found != expected) {
+        throw std::runtime_error(path + " contains " + std::to_string(found) + " particles instead of " +
+                                 std::to_string(expected));
+    }
+}
+
+
+/*
+ * mmpldtool::ReadPTS
+ */
+void mmpldtool::ReadPTS(const std::string& path, float radius, Frame& outFrame) {
+    LineReader reader(path);
+    const uint64_t expected = parseCount(reader.Expect());
+
+    ParticleList list;
+    list.header.vertexType = VERTEX_FLOAT_XYZ;
+    list.header.colourType = COLOUR_FLOAT_I;
+    list.header.globalRadius = radius;
+    list.header.minIntensity = std::numeric_limits<float>::max();
+    list.header.maxIntensity = std::numeric_limits<float>::lowest();
+    list.data.reserve(static_cast<size_t>(expected) * list.header.Stride());
+    while (reader.Next()) {
+        double v[8];
+        if (parseNumbers(reader.Line().c_str(), v, 8) != 7) continue;
+        const float p[4] = {
+            static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]), static_cast<float>(v[3])};
+        append(list.data, p, 4);
+        list.header.minIntensity = std::min(list.header.minIntensity, p[3]);
+        list.header.maxIntensity = std::max(list.header.maxIntensity, p[3]);
+        ++list.header.count;
+    }
+    warnCount(path, list.header.count, expected);
+    if (list.header.count == 0) {
+        list.header.minIntensity = 0.0f;
+        list.header.maxIntensity = 1.0f;
+    }
+    outFrame.lists.clear();
+    outFrame.lists.push_back(std::move(list));
+}
+
+
+/*
+ * mmpldtool::ReadCPE
+ */
+void mmpldtool::ReadCPE(const std::string& path, Frame& outFrame) {
+    LineReader reader(path);
+    reader.Expect();
+    // tab separated statistics, of which the second field is the radius and the last one the count
+    const std::string stats = reader.Expect();
+    const size_t first = stats.find('\t');
+    const size_t last = stats.find_last_of('\t');
+    if ((first == std::string::npos) || (last == std::string::npos)) {
+        throw std::runtime_error("cpe statistics expected in line 2");
+    }
+    const float radius = static_cast<float>(std::atof(stats.c_str() + first + 1));
+    const uint64_t expected = parseCount(stats.substr(last + 1));
+    reader.Expect();
+
+    ParticleList list;
+    list.header.vertexType = VERTEX_FLOAT_XYZ;
+    list.header.colourType = COLOUR_UINT8_RGBA;
+    list.header.globalRadius = radius;
+    list.data.reserve(static_cast<size_t>(expected) * list.header.Stride());
+    while (reader.Next()) {
+        double v[12];
+        const size_t cnt = parseNumbers(reader.Line().c_str(), v, 12);
+        if ((cnt != 7) && (cnt != 11)) continue;
+        const float p[3] = {static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2])};
+        append(list.data, p, 3);
+        const uint8_t c[4] = {static_cast<uint8_t>(std::min(std::max(v[4], 0.0), 255.0)),
+            static_cast<uint8_t>(std::min(std::max(v[5], 0.0), 255.0)),
+            static_cast<uint8_t>(std::min(std::max(v[6], 0.0), 255.0)), 255};
+        append(list.data, c, 4);
+        ++list.header.count;
+    }
+    warnCount(path, list.header.count, expected);
+    outFrame.lists.clear();
+    outFrame.lists.push_back(std::move(list));
+}
+
+
+/*
+ * mmpldtool::ReadIMD
+ */
+void mmpldtool::ReadIMD(const std::string& path, float radius, Frame& outFrame) {
+    const size_t preambleSize = 1024;
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) throw std::runtime_error("cannot open \"" + path + "\"");
+    std::vector<char> preamble(preambleSize);
+    if (!stream.read(preamble.data(), preambleSize)) throw std::runtime_error("IMD preamble expected");
+
+    // packed: char[3] magic, int16 displacement, int64 atoms, int16 observables, double[9] box, comment
+    int16_t disp = 0, observables = 0;
+    int64_t atoms = 0;
+    std::memcpy(&disp, preamble.data() + 3, sizeof(disp));
+    std::memcpy(&atoms, preamble.data() + 5, sizeof(atoms));
+    std::memcpy(&observables, preamble.data() + 13, sizeof(observables));
+    if (disp != static_cast<int16_t>(preambleSize)) throw std::runtime_error("unexpected IMD preamble size");
+    if ((observables < 4) || (atoms < 0)) throw std::runtime_error("IMD observables mass, x, y, z expected");
+    stream.seekg(0, std::ios::end);
+    const uint64_t size = preambleSize + 8ull * static_cast<uint64_t>(observables) * static_cast<uint64_t>(atoms);
+    if (static_cast<uint64_t>(stream.tellg()) != size) throw std::runtime_error("unexpected IMD file size");
+    stream.seekg(preambleSize);
+
+    ParticleList list;
+    list.header.vertexType = VERTEX_FLOAT_XYZ;
+    list.header.colourType = COLOUR_FLOAT_I;
+    list.header.globalRadius = radius;
+    list.header.count = static_cast<uint64_t>(atoms);
+    list.header.minIntensity = std::numeric_limits<float>::max();
+    list.header.maxIntensity = std::numeric_limits<float>::lowest();
+    list.data.resize(static_cast<size_t>(atoms) * list.header.Stride());
+
+    const size_t chunkSize = 1 << 16;
+    std::vector<double> records;
+    for (int64_t firstAtom = 0; firstAtom < atoms; firstAtom += chunkSize) {
+        const size_t cnt = static_cast<size_t>(std::min<int64_t>(chunkSize, atoms - firstAtom));
+        records.resize(cnt * observables);
+        if (!stream.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(double))) {
+            throw std::runtime_error("unexpected end of IMD file");
+        }
+        for (size_t i = 0; i < cnt; ++i) {
+            const double* r = records.data() + i * observables;
+            const float p[4] = {static_cast<float>(r[1]), static_cast<float>(r[2]), static_cast<float>(r[3]),
+                static_cast<float>(r[0])};
+            std::memcpy(list.data.data() + (firstAtom + i) * sizeof(p), p, sizeof(p));
+            list.header.minIntensity = std::min(list.header.minIntensity, p[3]);
+            list.header.maxIntensity = std::max(list.header.maxIntensity, p[3]);
+        }
+    }
+    if (atoms == 0) {
+        list.header.minIntensity = 0.0f;
+        list.header.maxIntensity = 1.0f;
+    }
+    outFrame.lists.clear();
+    outFrame.lists.push_back(std::move(list));
+}
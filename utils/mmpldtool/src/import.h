@@ -0,0 +1,90 @@
+/*
+ * import.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_MMPLDTOOL_IMPORT_H_INCLUDED
+#define MEGAMOL_MMPLDTOOL_IMPORT_H_INCLUDED
+#pragma once
+
+#include "mmpld.h"
+#include <string>
+
+namespace megamol {
+namespace mmpldtool {
+
+    /** The supported input formats */
+    enum class InputFormat { MMPLD, XYZ, PTS, CPE, IMD };
+
+    /**
+     * Parses the name of an input format.
+     *
+     * @param name The name, i.e. mmpld, xyz, pts, cpe or imd
+     * @param outFormat Receives the format
+     *
+     * @return True on success, false if the name is unknown
+     */
+    bool ParseInputFormat(const std::string& name, InputFormat& outFormat);
+
+    /**
+     * Guesses the format of a file from its extension, defaulting to MMPLD.
+     *
+     * @param path The path of the file
+     *
+     * @return The format
+     */
+    InputFormat GuessInputFormat(const std::string& path);
+
+    /**
+     * Reads an xyz file (count, comment, then one "type x y z" line per
+     * particle) into one list per type.
+     *
+     * @param path The path of the file
+     * @param radius The radius of all particles
+     * @param outFrame Receives the particles
+     *
+     * @throws std::runtime_error on errors
+     */
+    void ReadXYZ(const std::string& path, float radius, Frame& outFrame);
+
+    /**
+     * Reads a pts point cloud (count, then "x y z intensity r g b" lines),
+     * keeping the intensities.
+     *
+     * @param path The path of the file
+     * @param radius The radius of all particles
+     * @param outFrame Receives the particles
+     *
+     * @throws std::runtime_error on errors
+     */
+    void ReadPTS(const std::string& path, float radius, Frame& outFrame);
+
+    /**
+     * Reads the text dump of a cpe point cloud ("cpe stat" followed by "cpe
+     * dec"), keeping the colours.
+     *
+     * @param path The path of the file
+     * @param outFrame Receives the particles
+     *
+     * @throws std::runtime_error on errors
+     */
+    void ReadCPE(const std::string& path, Frame& outFrame);
+
+    /**
+     * Reads an IMD MPI-IO binary, of which the observables are expected to
+     * start with mass, x, y and z. The masses are kept as intensities.
+     *
+     * @param path The path of the file
+     * @param radius The radius of all particles
+     * @param outFrame Receives the particles
+     *
+     * @throws std::runtime_error on errors
+     */
+    void ReadIMD(const std::string& path, float radius, Frame& outFrame);
+
+} /* end namespace mmpldtool */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_MMPLDTOOL_IMPORT_H_INCLUDED */
@@ -0,0 +1,363 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "import.h"
+#include "mmpld.h"
+#include "stats.h"
+#include "transform.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace megamol::mmpldtool;
+
+namespace {
+
+/** The number of particles read at once when streaming frames */
+const uint64_t streamChunkSize = 1 << 20;
+
+void printUsage(void) {
+    std::cout << "Usage:\n"
+                 "  mmpldtool info [options] <file.mmpld>...\n"
+                 "    -v, --verbose      print every frame\n"
+                 "    --stats            compute particle statistics by streaming the frames\n"
+                 "    --threads N        number of frames processed in parallel\n"
+                 "\n"
+                 "  mmpldtool convert [options] <input>... <output.mmpld>\n"
+                 "    --format F         input format mmpld, xyz, pts, cpe or imd (default: by extension)\n"
+                 "    --version V        output file version 100 to 103 (default: 103)\n"
+                 "    --first N          index of the first input frame (default: 0)\n"
+                 "    --last N           index of the last input frame (default: all)\n"
+                 "    --every N          convert every Nth frame only (default: 1)\n"
+                 "    --radius R         global radius of the particles (default: 1 for imported files)\n"
+                 "    --merge            merge lists of equal types, radius and colour\n"
+                 "    --morton           sort the particles of every list along the Morton curve\n"
+                 "    --split N          split lists into lists of at most N particles\n"
+                 "    --threads N        number of frames processed in parallel\n"
+                 "\n"
+                 "  Input files of all formats but mmpld hold one frame each.\n";
+}
+
+/** Answer the value of the option at args[i], advancing i */
+std::string optionValue(const std::vector<std::string>& args, size_t& i) {
+    if (i + 1 >= args.size()) throw std::invalid_argument("missing value of option " + args[i]);
+    return args[++i];
+}
+
+uint64_t parseUInt(const std::string& option, const std::string& value) {
+    char* end = nullptr;
+    const unsigned long long v = std::strtoull(value.c_str(), &end, 10);
+    if ((end == value.c_str()) || (*end != 0)) {
+        throw std::invalid_argument("invalid value \"" + value + "\" of option " + option);
+    }
+    return static_cast<uint64_t>(v);
+}
+
+unsigned int defaultThreads(void) {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Calls func(i) for i in [0, cnt) on up to threadCnt threads. The first
+ * exception thrown is rethrown after all threads have finished.
+ */
+template <class F> void parallelFor(size_t cnt, unsigned int threadCnt, F func) {
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorLock;
+    auto work = [&]() {
+        for (size_t i = next++; i < cnt; i = next++) {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!error) error = std::current_exception();
+                next = cnt;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    const size_t n = std::min<size_t>(std::max(1u, threadCnt), cnt);
+    for (size_t t = 1; t < n; ++t) threads.emplace_back(work);
+    work();
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+void printBox(const char* name, const float* box) {
+    std::cout << "  " << name << ": (" << box[0] << ", " << box[1] << ", " << box[2] << ") - (" << box[3] << ", "
+              << box[4] << ", " << box[5] << ")\n";
+}
+
+void printStatistics(const std::string& indent, const FrameStatistics& stats) {
+    std::cout << indent << stats.lists << " lists, " << stats.particles << " particles, " << stats.bytes
+              << " bytes\n";
+    if (stats.IsEmpty()) return;
+    std::cout << indent << "bounds: (" << stats.bbox[0] << ", " << stats.bbox[1] << ", " << stats.bbox[2] << ") - ("
+              << stats.bbox[3] << ", " << stats.bbox[4] << ", " << stats.bbox[5] << ")\n";
+    std::cout << indent << "radius: " << stats.minRadius << " - " << stats.maxRadius << "\n";
+    if (stats.HasIntensity()) {
+        std::cout << indent << "intensity: " << stats.minIntensity << " - " << stats.maxIntensity << "\n";
+    }
+}
+
+/*
+ * mmpldtool info
+ */
+int info(const std::vector<std::string>& args) {
+    bool verbose = false, stats = false;
+    unsigned int threads = defaultThreads();
+    std::vector<std::string> files;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if ((args[i] == "-v") || (args[i] == "--verbose")) {
+            verbose = true;
+        } else if (args[i] == "--stats") {
+            stats = true;
+        } else if (args[i] == "--threads") {
+            threads = static_cast<unsigned int>(parseUInt(args[i], optionValue(args, i)));
+        } else if (args[i].compare(0, 1, "-") == 0) {
+            throw std::invalid_argument("unknown option " + args[i]);
+        } else {
+            files.push_back(args[i]);
+        }
+    }
+    if (files.empty()) throw std::invalid_argument("no input files");
+
+    for (const std::string& path : files) {
+        InputFile file(path);
+        std::cout << path << ":\n";
+        std::cout << "  version: " << (file.Version() / 100) << "." << std::setw(2) << std::setfill('0')
+                  << (file.Version() % 100) << std::setfill(' ') << "\n";
+        std::cout << "  frames: " << file.FrameCount() << "\n";
+        printBox("bounding box", file.BBox());
+        printBox("clip box", file.ClipBox());
+
+        std::vector<FrameStatistics> frames;
+        if (stats) {
+            frames.resize(file.FrameCount());
+            parallelFor(frames.size(), threads, [&file, &frames](size_t i) {
+                frames[i] = ComputeFrameStatistics(file, static_cast<uint32_t>(i), streamChunkSize);
+            });
+        }
+        if (verbose) {
+            for (uint32_t i = 0; i < file.FrameCount(); ++i) {
+                std::cout << "  frame " << i << ": offset " << file.FrameOffset(i) << ", " << file.FrameSize(i)
+                          << " bytes\n";
+                if (stats) printStatistics("    ", frames[i]);
+            }
+        }
+        if (stats) {
+            FrameStatistics total;
+            for (const auto& f : frames) total.Accumulate(f);
+            std::cout << "  total:\n";
+            printStatistics("    ", total);
+        }
+    }
+    return 0;
+}
+
+/** An input frame of the conversion */
+struct Source {
+    InputFormat format;
+    std::shared_ptr<InputFile> file;
+    std::string path;
+    uint32_t frame;
+};
+
+void loadFrame(const Source& src, float radius, Frame& outFrame) {
+    switch (src.format) {
+    case InputFormat::MMPLD:
+        src.file->ReadFrame(src.frame, outFrame);
+        if (radius > 0.0f) {
+            for (auto& l : outFrame.lists) l.header.globalRadius = radius;
+        }
+        return;
+    case InputFormat::XYZ:
+        ReadXYZ(src.path, radius, outFrame);
+        return;
+    case InputFormat::PTS:
+        ReadPTS(src.path, radius, outFrame);
+        return;
+    case InputFormat::CPE:
+        ReadCPE(src.path, outFrame);
+        if (radius > 0.0f) outFrame.lists[0].header.globalRadius = radius;
+        return;
+    case InputFormat::IMD:
+        ReadIMD(src.path, radius, outFrame);
+        return;
+    }
+}
+
+/** A converted frame waiting to be written */
+struct Converted {
+    std::vector<uint8_t> data;
+    float bbox[6];
+    float maxRadius;
+    bool empty;
+};
+
+/*
+ * mmpldtool convert
+ */
+int convert(const std::vector<std::string>& args) {
+    bool forceFormat = false, merge = false, morton = false;
+    InputFormat format = InputFormat::MMPLD;
+    uint16_t version = 103;
+    uint64_t first = 0, last = std::numeric_limits<uint64_t>::max(), every = 1, split = 0;
+    float radius = 0.0f;
+    unsigned int threads = defaultThreads();
+    std::vector<std::string> files;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        if (a == "--format") {
+            const std::string v = optionValue(args, i);
+            if (!ParseInputFormat(v, format)) throw std::invalid_argument("unknown input format " + v);
+            forceFormat = true;
+        } else if (a == "--version") {
+            version = static_cast<uint16_t>(parseUInt(a, optionValue(args, i)));
+            if ((version < 100) || (version > 103)) throw std::invalid_argument("version 100 to 103 expected");
+        } else if (a == "--first") {
+            first = parseUInt(a, optionValue(args, i));
+        } else if (a == "--last") {
+            last = parseUInt(a, optionValue(args, i));
+        } else if (a == "--every") {
+            every = std::max<uint64_t>(1, parseUInt(a, optionValue(args, i)));
+        } else if (a == "--radius") {
+            radius = std::strtof(optionValue(args, i).c_str(), nullptr);
+        } else if (a == "--merge") {
+            merge = true;
+        } else if (a == "--morton") {
+            morton = true;
+        } else if (a == "--split") {
+            split = parseUInt(a, optionValue(args, i));
+        } else if (a == "--threads") {
+            threads = static_cast<unsigned int>(parseUInt(a, optionValue(args, i)));
+        } else if (a.compare(0, 1, "-") == 0) {
+            throw std::invalid_argument("unknown option " + a);
+        } else {
+            files.push_back(a);
+        }
+    }
+    if (files.size() < 2) throw std::invalid_argument("input and output files expected");
+    const std::string outPath = files.back();
+    files.pop_back();
+
+    std::vector<Source> sources;
+    for (const std::string& path : files) {
+        const InputFormat f = forceFormat ? format : GuessInputFormat(path);
+        if (f == InputFormat::MMPLD) {
+            auto file = std::make_shared<InputFile>(path);
+            for (uint32_t i = 0; i < file->FrameCount(); ++i) sources.push_back(Source{f, file, path, i});
+        } else {
+            sources.push_back(Source{f, nullptr, path, 0});
+        }
+    }
+    std::vector<Source> selected;
+    for (uint64_t i = first; (i < sources.size()) && (i <= last); i += every) selected.push_back(sources[i]);
+    if (selected.empty()) throw std::invalid_argument("no frames selected");
+    const float importRadius = (radius > 0.0f) ? radius : 1.0f;
+
+    OutputFile out(outPath, version, static_cast<uint32_t>(selected.size()));
+    float bbox[6], clipBox[6];
+    bool hasBox = false;
+
+    // batches of frames are converted in parallel and written in order, bounding the memory to one batch
+    threads = std::max(1u, threads);
+    std::vector<Converted> batch;
+    for (size_t begin = 0; begin < selected.size(); begin += threads) {
+        const size_t cnt = std::min<size_t>(threads, selected.size() - begin);
+        batch.assign(cnt, Converted());
+        parallelFor(cnt, threads, [&](size_t i) {
+            const Source& src = selected[begin + i];
+            Frame frame;
+            loadFrame(src, (src.format == InputFormat::MMPLD) ? radius : importRadius, frame);
+            if (src.format != InputFormat::MMPLD) frame.timestamp = static_cast<float>(begin + i);
+            if (merge) MergeLists(frame);
+            if (morton) {
+                for (auto& l : frame.lists) MortonSort(l);
+            }
+            if (split > 0) SplitLists(frame, split);
+
+            Converted& c = batch[i];
+            c.empty = true;
+            c.maxRadius = 0.0f;
+            for (auto& l : frame.lists) {
+                if ((l.header.count == 0) || (l.header.vertexType == VERTEX_NONE)) continue;
+                c.maxRadius = std::max(c.maxRadius, ComputeBounds(l));
+                for (int j = 0; j < 3; ++j) {
+                    c.bbox[j] = c.empty ? l.header.bbox[j] : std::min(c.bbox[j], l.header.bbox[j]);
+                    c.bbox[j + 3] = c.empty ? l.header.bbox[j + 3] : std::max(c.bbox[j + 3], l.header.bbox[j + 3]);
+                }
+                c.empty = false;
+            }
+            SerialiseFrame(frame, version, c.data);
+        });
+
+        for (size_t i = 0; i < cnt; ++i) {
+            const Converted& c = batch[i];
+            out.WriteFrame(c.data);
+            if (c.empty) continue;
+            for (int j = 0; j < 3; ++j) {
+                bbox[j] = hasBox ? std::min(bbox[j], c.bbox[j]) : c.bbox[j];
+                bbox[j + 3] = hasBox ? std::max(bbox[j + 3], c.bbox[j + 3]) : c.bbox[j + 3];
+                clipBox[j] = hasBox ? std::min(clipBox[j], c.bbox[j] - c.maxRadius) : c.bbox[j] - c.maxRadius;
+                clipBox[j + 3] =
+                    hasBox ? std::max(clipBox[j + 3], c.bbox[j + 3] + c.maxRadius) : c.bbox[j + 3] + c.maxRadius;
+            }
+            hasBox = true;
+        }
+        std::cout << "\r" << (begin + cnt) << " / " << selected.size() << " frames" << std::flush;
+    }
+    std::cout << std::endl;
+
+    if (!hasBox) {
+        std::fill(bbox, bbox + 6, 0.0f);
+        std::fill(clipBox, clipBox + 6, 0.0f);
+    }
+    out.Close(bbox, clipBox);
+    return 0;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    const std::string command(argv[1]);
+    const std::vector<std::string> args(argv + 2, argv + argc);
+    try {
+        if (command == "info") return info(args);
+        if (command == "convert") return convert(args);
+        if ((command == "-h") || (command == "--help") || (command == "help")) {
+            printUsage();
+            return 0;
+        }
+        std::cerr << "Unknown command " << command << "\n";
+        printUsage();
+        return 1;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage();
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
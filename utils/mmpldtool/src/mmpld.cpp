@@ -0,0 +1,412 @@
+/*
+ * mmpld.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "mmpld.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace megamol;
+
+namespace {
+
+const size_t vertexSizes[] = {0, 12, 16, 6, 24};
+const size_t colourSizes[] = {0, 3, 4, 4, 12, 16, 8, 8};
+const char* vertexNames[] = {"NONE", "FLOAT_XYZ", "FLOAT_XYZR", "SHORT_XYZ", "DOUBLE_XYZ"};
+const char* colourNames[] = {
+    "NONE", "UINT8_RGB", "UINT8_RGBA", "FLOAT_I", "FLOAT_RGB", "FLOAT_RGBA", "USHORT_RGBA", "DOUBLE_I"};
+
+/** Offset of the seek table in the file, after magic, version, frame count and boxes */
+const uint64_t seekTableOffset = 6 + 2 + 4 + 2 * 6 * 4;
+
+void readBytes(std::istream& stream, void* dst, size_t size) {
+    if (!stream.read(static_cast<char*>(dst), size)) {
+        throw std::runtime_error("unexpected end of MMPLD file");
+    }
+}
+
+template <class T> T readValue(std::istream& stream) {
+    T value;
+    readBytes(stream, &value, sizeof(T));
+    return value;
+}
+
+template <class T> void put(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+void putBytes(std::vector<uint8_t>& out, const void* src, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+    out.insert(out.end(), p, p + size);
+}
+
+/**
+ * Converts the quantised positions of version 104, which are relative to the
+ * bounds of the list, to floats.
+ */
+void dequantise(const mmpldtool::ListHeader& header, const uint8_t* src, uint64_t cnt, std::vector<uint8_t>& dst) {
+    const size_t cs = mmpldtool::ColourSize(header.colourType);
+    const size_t srcStride = 6 + cs;
+    const size_t dstStride = 12 + cs;
+    const float* box = header.bbox;
+    const float edge = std::max(box[3] - box[0], std::max(box[4] - box[1], box[5] - box[2]));
+    const float scale = (edge > 0.0f) ? edge / static_cast<float>(SHRT_MAX) : 0.0f;
+    dst.resize(static_cast<size_t>(cnt) * dstStride);
+    for (uint64_t i = 0; i < cnt; ++i) {
+        const uint8_t* s = src + i * srcStride;
+        uint8_t* d = dst.data() + i * dstStride;
+        int16_t q[3];
+        std::memcpy(q, s, sizeof(q));
+        const float p[3] = {box[0] + q[0] * scale, box[1] + q[1] * scale, box[2] + q[2] * scale};
+        std::memcpy(d, p, sizeof(p));
+        std::memcpy(d + 12, s + 6, cs);
+    }
+}
+
+} // namespace
+
+
+/*
+ * mmpldtool::VertexSize
+ */
+size_t mmpldtool::VertexSize(uint8_t type) {
+    return (type <= VERTEX_DOUBLE_XYZ) ? vertexSizes[type] : 0;
+}
+
+
+/*
+ * mmpldtool::ColourSize
+ */
+size_t mmpldtool::ColourSize(uint8_t type) {
+    return (type <= COLOUR_DOUBLE_I) ? colourSizes[type] : 0;
+}
+
+
+/*
+ * mmpldtool::VertexName
+ */
+const char* mmpldtool::VertexName(uint8_t type) {
+    return (type <= VERTEX_DOUBLE_XYZ) ? vertexNames[type] : "UNKNOWN";
+}
+
+
+/*
+ * mmpldtool::ColourName
+ */
+const char* mmpldtool::ColourName(uint8_t type) {
+    return (type <= COLOUR_DOUBLE_I) ? colourNames[type] : "UNKNOWN";
+}
+
+
+/*
+ * mmpldtool::InputFile::InputFile
+ */
+mmpldtool::InputFile::InputFile(const std::string& path) : path(path), version(0), bbox(), clipBox(), offsets() {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) throw std::runtime_error("cannot open \"" + path + "\"");
+
+    char magic[6];
+    readBytes(stream, magic, 6);
+    if (std::memcmp(magic, "MMPLD", 6) != 0) throw std::runtime_error("\"" + path + "\" is no MMPLD file");
+    this->version = readValue<uint16_t>(stream);
+    if ((this->version < 100) || (this->version > 104)) {
+        throw std::runtime_error("unsupported MMPLD version " + std::to_string(this->version));
+    }
+    const uint32_t frameCnt = readValue<uint32_t>(stream);
+    if (frameCnt == 0) throw std::runtime_error("MMPLD file does not contain any frame");
+    readBytes(stream, this->bbox, sizeof(this->bbox));
+    readBytes(stream, this->clipBox, sizeof(this->clipBox));
+    this->offsets.resize(frameCnt + 1);
+    readBytes(stream, this->offsets.data(), this->offsets.size() * sizeof(uint64_t));
+
+    stream.seekg(0, std::ios::end);
+    if (static_cast<uint64_t>(stream.tellg()) < this->offsets.back()) {
+        throw std::runtime_error("MMPLD file is truncated");
+    }
+}
+
+
+/*
+ * mmpldtool::InputFile::ReadFrame
+ */
+void mmpldtool::InputFile::ReadFrame(uint32_t idx, Frame& outFrame) const {
+    std::ifstream stream;
+    uint32_t listCnt = 0;
+    this->openFrame(idx, stream, outFrame.timestamp, listCnt);
+    outFrame.lists.resize(listCnt);
+    for (ParticleList& list : outFrame.lists) {
+        list.header = this->readListHeader(stream);
+        list.data.resize(static_cast<size_t>(list.header.count) * list.header.Stride());
+        readBytes(stream, list.data.data(), list.data.size());
+        this->skipListTail(stream);
+        if ((this->version == 104) && (list.header.vertexType == VERTEX_SHORT_XYZ)) {
+            std::vector<uint8_t> pos;
+            dequantise(list.header, list.data.data(), list.header.count, pos);
+            list.data.swap(pos);
+            list.header.vertexType = VERTEX_FLOAT_XYZ;
+        }
+    }
+}
+
+
+/*
+ * mmpldtool::InputFile::StreamFrame
+ */
+float mmpldtool::InputFile::StreamFrame(
+    uint32_t idx, uint64_t chunkSize, const ListCallback& onList, const ParticleCallback& onParticles) const {
+    std::ifstream stream;
+    float timestamp = 0.0f;
+    uint32_t listCnt = 0;
+    this->openFrame(idx, stream, timestamp, listCnt);
+    chunkSize = std::max<uint64_t>(chunkSize, 1);
+
+    std::vector<uint8_t> chunk, pos;
+    for (uint32_t li = 0; li < listCnt; ++li) {
+        ListHeader header = this->readListHeader(stream);
+        const bool quantised = (this->version == 104) && (header.vertexType == VERTEX_SHORT_XYZ);
+        ListHeader reported = header;
+        if (quantised) reported.vertexType = VERTEX_FLOAT_XYZ;
+        onList(reported);
+
+        const size_t stride = header.Stride();
+        for (uint64_t first = 0; first < header.count; first += chunkSize) {
+            const uint64_t cnt = std::min(chunkSize, header.count - first);
+            chunk.resize(static_cast<size_t>(cnt) * stride);
+            readBytes(stream, chunk.data(), chunk.size());
+            if (quantised) {
+                dequantise(header, chunk.data(), cnt, pos);
+                onParticles(reported, pos.data(), cnt);
+            } else {
+                onParticles(reported, chunk.data(), cnt);
+            }
+        }
+        this->skipListTail(stream);
+    }
+    return timestamp;
+}
+
+
+/*
+ * mmpldtool::InputFile::openFrame
+ */
+void mmpldtool::InputFile::openFrame(
+    uint32_t idx, std::ifstream& stream, float& outTimestamp, uint32_t& outListCnt) const {
+    if (idx >= this->FrameCount()) throw std::runtime_error("frame " + std::to_string(idx) + " does not exist");
+    stream.open(this->path, std::ios::binary);
+    if (!stream) throw std::runtime_error("cannot open \"" + this->path + "\"");
+    stream.seekg(static_cast<std::streamoff>(this->offsets[idx]));
+    outTimestamp = (this->version == 102) ? readValue<float>(stream) : static_cast<float>(idx);
+    outListCnt = readValue<uint32_t>(stream);
+}
+
+
+/*
+ * mmpldtool::InputFile::readListHeader
+ */
+mmpldtool::ListHeader mmpldtool::InputFile::readListHeader(std::ifstream& stream) const {
+    ListHeader header;
+    header.vertexType = readValue<uint8_t>(stream);
+    const uint8_t colourType = readValue<uint8_t>(stream);
+    if ((header.vertexType > VERTEX_DOUBLE_XYZ) || (colourType > COLOUR_DOUBLE_I)) {
+        throw std::runtime_error("unknown particle list type");
+    }
+    // lists without positions have no colours, but the stored type still defines the header layout
+    header.colourType = (header.vertexType == VERTEX_NONE) ? static_cast<uint8_t>(COLOUR_NONE) : colourType;
+
+    if ((header.vertexType == VERTEX_FLOAT_XYZ) || (header.vertexType == VERTEX_SHORT_XYZ) ||
+        (header.vertexType == VERTEX_DOUBLE_XYZ)) {
+        header.globalRadius = readValue<float>(stream);
+    }
+    if (colourType == COLOUR_NONE) {
+        readBytes(stream, header.globalColour, 4);
+    } else if ((colourType == COLOUR_FLOAT_I) || (colourType == COLOUR_DOUBLE_I)) {
+        header.minIntensity = readValue<float>(stream);
+        header.maxIntensity = readValue<float>(stream);
+    }
+    header.count = readValue<uint64_t>(stream);
+    if (this->version >= 103) {
+        readBytes(stream, header.bbox, sizeof(header.bbox));
+        header.hasBBox = true;
+    }
+    return header;
+}
+
+
+/*
+ * mmpldtool::InputFile::skipListTail
+ */
+void mmpldtool::InputFile::skipListTail(std::ifstream& stream) const {
+    if (this->version == 101) {
+        // cluster infos
+        readValue<uint32_t>(stream);
+        const uint64_t size = readValue<uint64_t>(stream);
+        stream.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+    }
+}
+
+
+/*
+ * mmpldtool::OutputFile::OutputFile
+ */
+mmpldtool::OutputFile::OutputFile(const std::string& path, uint16_t version, uint32_t frameCount)
+    : stream(path, std::ios::binary | std::ios::trunc), version(version), offsets(), frameCount(frameCount) {
+    if (!this->stream) throw std::runtime_error("cannot create \"" + path + "\"");
+    if ((version < 100) || (version > 103)) {
+        throw std::runtime_error("cannot write MMPLD version " + std::to_string(version));
+    }
+    if (frameCount == 0) throw std::runtime_error("no frames to write");
+
+    // version zero marks the file as incomplete until it is closed
+    std::vector<uint8_t> header;
+    putBytes(header, "MMPLD", 6);
+    put(header, static_cast<uint16_t>(0));
+    put(header, frameCount);
+    header.resize(static_cast<size_t>(seekTableOffset + (frameCount + 1) * sizeof(uint64_t)), 0);
+    this->stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+    this->offsets.push_back(header.size());
+}
+
+
+/*
+ * mmpldtool::OutputFile::WriteFrame
+ */
+void mmpldtool::OutputFile::WriteFrame(const std::vector<uint8_t>& data) {
+    if (this->offsets.size() > this->frameCount) throw std::runtime_error("too many frames written");
+    if (!this->stream.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+        throw std::runtime_error("write error");
+    }
+    this->offsets.push_back(this->offsets.back() + data.size());
+}
+
+
+/*
+ * mmpldtool::OutputFile::Close
+ */
+void mmpldtool::OutputFile::Close(const float bbox[6], const float clipBox[6]) {
+    if (this->offsets.size() != this->frameCount + 1) throw std::runtime_error("not all frames written");
+    this->stream.seekp(6);
+    this->stream.write(reinterpret_cast<const char*>(&this->version), sizeof(this->version));
+    this->stream.seekp(12);
+    this->stream.write(reinterpret_cast<const char*>(bbox), 6 * sizeof(float));
+    this->stream.write(reinterpret_cast<const char*>(clipBox), 6 * sizeof(float));
+    this->stream.write(reinterpret_cast<const char*>(this->offsets.data()), this->offsets.size() * sizeof(uint64_t));
+    this->stream.close();
+    if (!this->stream) throw std::runtime_error("write error");
+}
+
+
+/*
+ * mmpldtool::SerialiseFrame
+ */
+void mmpldtool::SerialiseFrame(Frame& frame, uint16_t version, std::vector<uint8_t>& outData) {
+    outData.clear();
+    if (version == 102) put(outData, frame.timestamp);
+    put(outData, static_cast<uint32_t>(frame.lists.size()));
+
+    for (ParticleList& list : frame.lists) {
+        const ListHeader& h = list.header;
+        const uint64_t cnt = (h.vertexType == VERTEX_NONE) ? 0 : h.count;
+        // UINT8_RGB is unaligned and thus written as RGBA, as core's MMPLDWriter does
+        const uint8_t ct = (h.colourType == COLOUR_UINT8_RGB) ? static_cast<uint8_t>(COLOUR_UINT8_RGBA) : h.colourType;
+        put(outData, h.vertexType);
+        put(outData, ct);
+        if ((h.vertexType == VERTEX_FLOAT_XYZ) || (h.vertexType == VERTEX_SHORT_XYZ) ||
+            (h.vertexType == VERTEX_DOUBLE_XYZ)) {
+            put(outData, h.globalRadius);
+        }
+        if (ct == COLOUR_NONE) {
+            putBytes(outData, h.globalColour, 4);
+        } else if ((ct == COLOUR_FLOAT_I) || (ct == COLOUR_DOUBLE_I)) {
+            put(outData, h.minIntensity);
+            put(outData, h.maxIntensity);
+        }
+        put(outData, cnt);
+        if (version >= 103) {
+            if (!h.hasBBox) ComputeBounds(list);
+            putBytes(outData, h.bbox, sizeof(h.bbox));
+        }
+
+        if (h.colourType == COLOUR_UINT8_RGB) {
+            const size_t vs = VertexSize(h.vertexType);
+            const uint8_t alpha = 255;
+            outData.reserve(outData.size() + static_cast<size_t>(cnt) * (vs + 4));
+            for (uint64_t i = 0; i < cnt; ++i) {
+                putBytes(outData, list.data.data() + i * (vs + 3), vs + 3);
+                put(outData, alpha);
+            }
+        } else {
+            putBytes(outData, list.data.data(), static_cast<size_t>(cnt) * h.Stride());
+        }
+
+        if (version == 101) {
+            // no cluster infos
+            put(outData, static_cast<uint32_t>(0));
+            put(outData, static_cast<uint64_t>(0));
+        }
+    }
+}
+
+
+/*
+ * mmpldtool::GetPosition
+ */
+void mmpldtool::GetPosition(const ListHeader& header, const uint8_t* particle, double outPos[3]) {
+    switch (header.vertexType) {
+    case VERTEX_FLOAT_XYZ:
+    case VERTEX_FLOAT_XYZR: {
+        float p[3];
+        std::memcpy(p, particle, sizeof(p));
+        for (int c = 0; c < 3; ++c) outPos[c] = p[c];
+    } break;
+    case VERTEX_SHORT_XYZ: {
+        int16_t p[3];
+        std::memcpy(p, particle, sizeof(p));
+        for (int c = 0; c < 3; ++c) outPos[c] = p[c];
+    } break;
+    case VERTEX_DOUBLE_XYZ:
+        std::memcpy(outPos, particle, 3 * sizeof(double));
+        break;
+    default:
+        outPos[0] = outPos[1] = outPos[2] = 0.0;
+        break;
+    }
+}
+
+
+/*
+ * mmpldtool::ComputeBounds
+ */
+float mmpldtool::ComputeBounds(ParticleList& list) {
+    ListHeader& h = list.header;
+    const size_t stride = h.Stride();
+    const uint64_t cnt = (h.vertexType == VERTEX_NONE) ? 0 : h.count;
+    double lo[3] = {0.0, 0.0, 0.0}, hi[3] = {0.0, 0.0, 0.0};
+    float maxRadius = (h.vertexType == VERTEX_FLOAT_XYZR) ? 0.0f : h.globalRadius;
+    for (uint64_t i = 0; i < cnt; ++i) {
+        const uint8_t* particle = list.data.data() + i * stride;
+        double p[3];
+        GetPosition(h, particle, p);
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = (i == 0) ? p[c] : std::min(lo[c], p[c]);
+            hi[c] = (i == 0) ? p[c] : std::max(hi[c], p[c]);
+        }
+        if (h.vertexType == VERTEX_FLOAT_XYZR) {
+            float r;
+            std::memcpy(&r, particle + 12, sizeof(float));
+            maxRadius = std::max(maxRadius, r);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        h.bbox[c] = static_cast<float>(lo[c]);
+        h.bbox[c + 3] = static_cast<float>(hi[c]);
+    }
+    h.hasBBox = true;
+    return maxRadius;
+}
@@ -0,0 +1,267 @@
+/*
+ * mmpld.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_MMPLDTOOL_MMPLD_H_INCLUDED
+#define MEGAMOL_MMPLDTOOL_MMPLD_H_INCLUDED
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace megamol {
+namespace mmpldtool {
+
+    /*
+     * The layout follows core's MMPLDDataSource and MMPLDWriter. Files of the
+     * versions 100 to 104 are read, the versions 100 to 103 are written.
+     */
+
+    /** The vertex types, as stored in the file */
+    enum VertexType : uint8_t {
+        VERTEX_NONE = 0,
+        VERTEX_FLOAT_XYZ = 1,
+        VERTEX_FLOAT_XYZR = 2,
+        VERTEX_SHORT_XYZ = 3,
+        VERTEX_DOUBLE_XYZ = 4
+    };
+
+    /** The colour types, as stored in the file */
+    enum ColourType : uint8_t {
+        COLOUR_NONE = 0,
+        COLOUR_UINT8_RGB = 1,
+        COLOUR_UINT8_RGBA = 2,
+        COLOUR_FLOAT_I = 3,
+        COLOUR_FLOAT_RGB = 4,
+        COLOUR_FLOAT_RGBA = 5,
+        COLOUR_USHORT_RGBA = 6,
+        COLOUR_DOUBLE_I = 7
+    };
+
+    /** Answer the size of a position of the given type in bytes */
+    size_t VertexSize(uint8_t type);
+
+    /** Answer the size of a colour of the given type in bytes */
+    size_t ColourSize(uint8_t type);
+
+    /** Answer the name of the vertex type */
+    const char* VertexName(uint8_t type);
+
+    /** Answer the name of the colour type */
+    const char* ColourName(uint8_t type);
+
+    /** The header of a particle list */
+    struct ListHeader {
+        uint8_t vertexType = VERTEX_NONE;
+        uint8_t colourType = COLOUR_NONE;
+        float globalRadius = 0.05f;
+        uint8_t globalColour[4] = {192, 192, 192, 255};
+        float minIntensity = 0.0f;
+        float maxIntensity = 1.0f;
+        uint64_t count = 0;
+
+        /** The bounds of the positions, stored from version 103 on */
+        float bbox[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        bool hasBBox = false;
+
+        /** Answer the size of one particle in bytes */
+        inline size_t Stride(void) const {
+            return VertexSize(this->vertexType) + ColourSize(this->colourType);
+        }
+    };
+
+    /** A particle list with interleaved positions and colours */
+    struct ParticleList {
+        ListHeader header;
+        std::vector<uint8_t> data;
+    };
+
+    /** A frame held in memory */
+    struct Frame {
+        float timestamp = 0.0f;
+        std::vector<ParticleList> lists;
+    };
+
+    /**
+     * An MMPLD file opened for reading. Frames are read through streams of
+     * their own, thus different frames can be read from several threads.
+     */
+    class InputFile {
+    public:
+
+        /**
+         * Receives the header of a list in StreamFrame.
+         */
+        typedef std::function<void(const ListHeader&)> ListCallback;
+
+        /**
+         * Receives a chunk of particles of the current list in StreamFrame.
+         */
+        typedef std::function<void(const ListHeader&, const uint8_t*, uint64_t)> ParticleCallback;
+
+        /**
+         * Opens the file and reads its header.
+         *
+         * @param path The path of the file
+         *
+         * @throws std::runtime_error if the file is no valid MMPLD file
+         */
+        explicit InputFile(const std::string& path);
+
+        inline uint16_t Version(void) const {
+            return this->version;
+        }
+
+        inline uint32_t FrameCount(void) const {
+            return static_cast<uint32_t>(this->offsets.size() - 1);
+        }
+
+        inline const float* BBox(void) const {
+            return this->bbox;
+        }
+
+        inline const float* ClipBox(void) const {
+            return this->clipBox;
+        }
+
+        inline uint64_t FrameOffset(uint32_t idx) const {
+            return this->offsets[idx];
+        }
+
+        inline uint64_t FrameSize(uint32_t idx) const {
+            return this->offsets[idx + 1] - this->offsets[idx];
+        }
+
+        /**
+         * Reads a frame completely. Quantised positions of version 104 are
+         * converted to floats.
+         *
+         * @param idx The index of the frame
+         * @param outFrame Receives the frame
+         *
+         * @throws std::runtime_error on read errors
+         */
+        void ReadFrame(uint32_t idx, Frame& outFrame) const;
+
+        /**
+         * Reads a frame in chunks of at most chunkSize particles, such that
+         * frames larger than the memory can be processed. Quantised positions
+         * of version 104 are converted to floats.
+         *
+         * @param idx The index of the frame
+         * @param chunkSize The maximum number of particles per chunk
+         * @param onList Called for the header of each list
+         * @param onParticles Called for each chunk of particles
+         *
+         * @return The time stamp of the frame
+         *
+         * @throws std::runtime_error on read errors
+         */
+        float StreamFrame(uint32_t idx, uint64_t chunkSize, const ListCallback& onList,
+            const ParticleCallback& onParticles) const;
+
+    private:
+
+        /** Opens a stream positioned at the start of the frame */
+        void openFrame(uint32_t idx, std::ifstream& stream, float& outTimestamp, uint32_t& outListCnt) const;
+
+        /** Reads the header of a list */
+        ListHeader readListHeader(std::ifstream& stream) const;
+
+        /** Skips the data following the particles of a list */
+        void skipListTail(std::ifstream& stream) const;
+
+        std::string path;
+        uint16_t version;
+        float bbox[6];
+        float clipBox[6];
+        std::vector<uint64_t> offsets;
+    };
+
+    /**
+     * An MMPLD file being written. The boxes and the seek table are written
+     * on Close, when all frames are known.
+     */
+    class OutputFile {
+    public:
+
+        /**
+         * Creates the file and writes the placeholder header.
+         *
+         * @param path The path of the file
+         * @param version The file version, 100 to 103
+         * @param frameCount The number of frames to be written
+         *
+         * @throws std::runtime_error if the file cannot be written
+         */
+        OutputFile(const std::string& path, uint16_t version, uint32_t frameCount);
+
+        inline uint16_t Version(void) const {
+            return this->version;
+        }
+
+        /**
+         * Appends a frame serialised by SerialiseFrame.
+         *
+         * @param data The frame data
+         *
+         * @throws std::runtime_error on write errors
+         */
+        void WriteFrame(const std::vector<uint8_t>& data);
+
+        /**
+         * Writes the boxes and the seek table and closes the file.
+         *
+         * @param bbox The bounding box of all positions
+         * @param clipBox The clip box, i.e. the bounding box grown by the radii
+         *
+         * @throws std::runtime_error if not all frames have been written
+         */
+        void Close(const float bbox[6], const float clipBox[6]);
+
+    private:
+        std::ofstream stream;
+        uint16_t version;
+        std::vector<uint64_t> offsets;
+        uint32_t frameCount;
+    };
+
+    /**
+     * Serialises a frame. Lists without bounds get them computed if the
+     * version stores them, and UINT8_RGB colours are written as RGBA.
+     *
+     * @param frame The frame
+     * @param version The file version, 100 to 103
+     * @param outData Receives the frame data
+     */
+    void SerialiseFrame(Frame& frame, uint16_t version, std::vector<uint8_t>& outData);
+
+    /**
+     * Answers the position of a particle.
+     *
+     * @param header The header of the list
+     * @param particle The particle data
+     * @param outPos Receives the position
+     */
+    void GetPosition(const ListHeader& header, const uint8_t* particle, double outPos[3]);
+
+    /**
+     * Computes the bounds of the positions of a list and stores them in the
+     * header.
+     *
+     * @param list The list
+     *
+     * @return The largest radius of the list
+     */
+    float ComputeBounds(ParticleList& list);
+
+} /* end namespace mmpldtool */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_MMPLDTOOL_MMPLD_H_INCLUDED */
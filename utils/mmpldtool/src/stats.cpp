@@ -0,0 +1,94 @@
+/*
+ * stats.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stats.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace megamol;
+
+
+/*
+ * mmpldtool::FrameStatistics::FrameStatistics
+ */
+mmpldtool::FrameStatistics::FrameStatistics(void)
+    : minRadius(std::numeric_limits<float>::max())
+    , maxRadius(std::numeric_limits<float>::lowest())
+    , minIntensity(std::numeric_limits<float>::max())
+    , maxIntensity(std::numeric_limits<float>::lowest()) {
+    for (int i = 0; i < 3; ++i) {
+        this->bbox[i] = std::numeric_limits<double>::max();
+        this->bbox[i + 3] = std::numeric_limits<double>::lowest();
+    }
+}
+
+
+/*
+ * mmpldtool::FrameStatistics::Accumulate
+ */
+void mmpldtool::FrameStatistics::Accumulate(const FrameStatistics& other) {
+    this->lists += other.lists;
+    this->particles += other.particles;
+    this->bytes += other.bytes;
+    for (int i = 0; i < 3; ++i) {
+        this->bbox[i] = std::min(this->bbox[i], other.bbox[i]);
+        this->bbox[i + 3] = std::max(this->bbox[i + 3], other.bbox[i + 3]);
+    }
+    this->minRadius = std::min(this->minRadius, other.minRadius);
+    this->maxRadius = std::max(this->maxRadius, other.maxRadius);
+    this->minIntensity = std::min(this->minIntensity, other.minIntensity);
+    this->maxIntensity = std::max(this->maxIntensity, other.maxIntensity);
+}
+
+
+/*
+ * mmpldtool::ComputeFrameStatistics
+ */
+mmpldtool::FrameStatistics mmpldtool::ComputeFrameStatistics(
+    const InputFile& file, uint32_t idx, uint64_t chunkSize) {
+    FrameStatistics stats;
+    stats.bytes = file.FrameSize(idx);
+
+    auto onList = [&stats](const ListHeader& header) {
+        ++stats.lists;
+        if ((header.count == 0) || (header.vertexType == VERTEX_NONE)) return;
+        if (header.vertexType != VERTEX_FLOAT_XYZR) {
+            stats.minRadius = std::min(stats.minRadius, header.globalRadius);
+            stats.maxRadius = std::max(stats.maxRadius, header.globalRadius);
+        }
+        if ((header.colourType == COLOUR_FLOAT_I) || (header.colourType == COLOUR_DOUBLE_I)) {
+            // the range stored in the header, as the colour values are not scanned
+            stats.minIntensity = std::min(stats.minIntensity, header.minIntensity);
+            stats.maxIntensity = std::max(stats.maxIntensity, header.maxIntensity);
+        }
+    };
+
+    auto onParticles = [&stats](const ListHeader& header, const uint8_t* data, uint64_t cnt) {
+        if (header.vertexType == VERTEX_NONE) return;
+        const size_t stride = header.Stride();
+        stats.particles += cnt;
+        for (uint64_t i = 0; i < cnt; ++i) {
+            const uint8_t* particle = data + i * stride;
+            double pos[3];
+            GetPosition(header, particle, pos);
+            for (int j = 0; j < 3; ++j) {
+                stats.bbox[j] = std::min(stats.bbox[j], pos[j]);
+                stats.bbox[j + 3] = std::max(stats.bbox[j + 3], pos[j]);
+            }
+            if (header.vertexType == VERTEX_FLOAT_XYZR) {
+                float r;
+                std::memcpy(&r, particle + 3 * sizeof(float), sizeof(float));
+                stats.minRadius = std::min(stats.minRadius, r);
+                stats.maxRadius = std::max(stats.maxRadius, r);
+            }
+        }
+    };
+
+    file.StreamFrame(idx, chunkSize, onList, onParticles);
+    return stats;
+}
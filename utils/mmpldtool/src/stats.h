@@ -0,0 +1,62 @@
+/*
+ * stats.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_MMPLDTOOL_STATS_H_INCLUDED
+#define MEGAMOL_MMPLDTOOL_STATS_H_INCLUDED
+#pragma once
+
+#include "mmpld.h"
+
+namespace megamol {
+namespace mmpldtool {
+
+    /** Statistics of the particles of one or more frames */
+    struct FrameStatistics {
+        uint64_t lists = 0;
+        uint64_t particles = 0;
+        uint64_t bytes = 0;
+        double bbox[6];
+        float minRadius;
+        float maxRadius;
+        float minIntensity;
+        float maxIntensity;
+
+        /** Resets the ranges to empty ones */
+        FrameStatistics(void);
+
+        /** Merges the statistics of another frame */
+        void Accumulate(const FrameStatistics& other);
+
+        /** Answer whether any particle has been seen */
+        inline bool IsEmpty(void) const {
+            return this->particles == 0;
+        }
+
+        /** Answer whether any intensity has been seen */
+        inline bool HasIntensity(void) const {
+            return this->minIntensity <= this->maxIntensity;
+        }
+    };
+
+    /**
+     * Computes the statistics of a frame, streaming its particles in chunks
+     * instead of loading the whole frame.
+     *
+     * @param file The file
+     * @param idx The index of the frame
+     * @param chunkSize The maximum number of particles read at once
+     *
+     * @return The statistics
+     *
+     * @throws std::runtime_error on read errors
+     */
+    FrameStatistics ComputeFrameStatistics(const InputFile& file, uint32_t idx, uint64_t chunkSize);
+
+} /* end namespace mmpldtool */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_MMPLDTOOL_STATS_H_INCLUDED */
@@ -0,0 +1,126 @@
+/*
+ * transform.cpp
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "transform.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace megamol;
+
+namespace {
+
+/** Spreads the lower 21 bits of v, such that two zero bits follow every bit */
+uint64_t spreadBits(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffffull;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+/** Answer whether the particles of both lists can be stored in one list */
+bool isMergeable(const mmpldtool::ListHeader& a, const mmpldtool::ListHeader& b) {
+    if ((a.vertexType != b.vertexType) || (a.colourType != b.colourType)) return false;
+    if ((a.vertexType != mmpldtool::VERTEX_FLOAT_XYZR) && (a.globalRadius != b.globalRadius)) return false;
+    if ((a.colourType == mmpldtool::COLOUR_NONE) && (std::memcmp(a.globalColour, b.globalColour, 4) != 0)) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+/*
+ * mmpldtool::MortonSort
+ */
+void mmpldtool::MortonSort(ParticleList& list) {
+    ListHeader& h = list.header;
+    if ((h.vertexType == VERTEX_NONE) || (h.count < 2)) return;
+    ComputeBounds(list);
+
+    const double cells = static_cast<double>((1 << 21) - 1);
+    double scale[3];
+    for (int c = 0; c < 3; ++c) {
+        const double extent = static_cast<double>(h.bbox[c + 3]) - static_cast<double>(h.bbox[c]);
+        scale[c] = (extent > 0.0) ? cells / extent : 0.0;
+    }
+
+    const size_t stride = h.Stride();
+    std::vector<std::pair<uint64_t, uint64_t>> keys(static_cast<size_t>(h.count));
+    for (uint64_t i = 0; i < h.count; ++i) {
+        double p[3];
+        GetPosition(h, list.data.data() + i * stride, p);
+        uint64_t code = 0;
+        for (int c = 0; c < 3; ++c) {
+            const double cell = std::min(std::max((p[c] - h.bbox[c]) * scale[c], 0.0), cells);
+            code |= spreadBits(static_cast<uint64_t>(cell)) << c;
+        }
+        keys[static_cast<size_t>(i)] = std::make_pair(code, i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint8_t> sorted(list.data.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::memcpy(sorted.data() + i * stride, list.data.data() + keys[i].second * stride, stride);
+    }
+    list.data.swap(sorted);
+}
+
+
+/*
+ * mmpldtool::MergeLists
+ */
+void mmpldtool::MergeLists(Frame& frame) {
+    std::vector<ParticleList> merged;
+    for (ParticleList& list : frame.lists) {
+        auto target = std::find_if(merged.begin(), merged.end(),
+            [&list](const ParticleList& m) { return isMergeable(m.header, list.header); });
+        if (target == merged.end()) {
+            merged.push_back(std::move(list));
+            continue;
+        }
+        ListHeader& h = target->header;
+        if ((h.colourType == COLOUR_FLOAT_I) || (h.colourType == COLOUR_DOUBLE_I)) {
+            h.minIntensity = std::min(h.minIntensity, list.header.minIntensity);
+            h.maxIntensity = std::max(h.maxIntensity, list.header.maxIntensity);
+        }
+        h.count += list.header.count;
+        h.hasBBox = false;
+        target->data.insert(target->data.end(), list.data.begin(), list.data.end());
+    }
+    frame.lists.swap(merged);
+}
+
+
+/*
+ * mmpldtool::SplitLists
+ */
+void mmpldtool::SplitLists(Frame& frame, uint64_t maxCount) {
+    if (maxCount == 0) return;
+    std::vector<ParticleList> split;
+    for (ParticleList& list : frame.lists) {
+        if (list.header.count <= maxCount) {
+            split.push_back(std::move(list));
+            continue;
+        }
+        const size_t stride = list.header.Stride();
+        for (uint64_t first = 0; first < list.header.count; first += maxCount) {
+            ParticleList part;
+            part.header = list.header;
+            part.header.count = std::min(maxCount, list.header.count - first);
+            part.header.hasBBox = false;
+            auto begin = list.data.begin() + static_cast<ptrdiff_t>(first * stride);
+            part.data.assign(begin, begin + static_cast<ptrdiff_t>(part.header.count * stride));
+            split.push_back(std::move(part));
+        }
+    }
+    frame.lists.swap(split);
+}
@@ -0,0 +1,44 @@
+/*
+ * transform.h
+ *
+ * Copyright (C) 2019 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_MMPLDTOOL_TRANSFORM_H_INCLUDED
+#define MEGAMOL_MMPLDTOOL_TRANSFORM_H_INCLUDED
+#pragma once
+
+#include "mmpld.h"
+
+namespace megamol {
+namespace mmpldtool {
+
+    /**
+     * Sorts the particles of a list along the Morton curve through the bounds
+     * of the list, such that particles close in space are close in memory.
+     *
+     * @param list The list
+     */
+    void MortonSort(ParticleList& list);
+
+    /**
+     * Merges the lists of a frame which have the same types and global
+     * radius and colour.
+     *
+     * @param frame The frame
+     */
+    void MergeLists(Frame& frame);
+
+    /**
+     * Splits the lists of a frame into lists of at most maxCount particles.
+     *
+     * @param frame The frame
+     * @param maxCount The maximum number of particles per list
+     */
+    void SplitLists(Frame& frame, uint64_t maxCount);
+
+} /* end namespace mmpldtool */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_MMPLDTOOL_TRANSFORM_H_INCLUDED */
@@ -14,6 +14,8 @@
 #endif /* defined(_WIN32) && defined(_MANAGED) */
 
 
+#include "vislib/Array.h"
+#include "vislib/String.h"
 #include "vislib/graphics/gl/AbstractOpenGLShader.h"
 #include "vislib/graphics/gl/ExtensionsDependent.h"
 #include "vislib/graphics/gl/glverify.h"
@@ -60,6 +62,29 @@ namespace gl {
         /** Vertex shader source for fixed function transformation. */
         static const char *FTRANSFORM_VERTEX_SHADER_SRC;
 
+        /**
+         * Answer the directory in which linked programs are cached.
+         *
+         * @return The cache directory, empty if the cache is disabled.
+         */
+        static const StringA& GetProgramCacheDirectory(void);
+
+        /**
+         * Sets the directory in which linked programs are cached as program
+         * binaries, so creating the same program again neither compiles nor
+         * links it. Programs are identified by their assembled sources, the
+         * attribute bindings and program parameters set before linking, and
+         * the vendor, renderer and version of the OpenGL implementation.
+         *
+         * While the cache is enabled, shaders are only compiled if the program
+         * is not found in the cache when it is linked. Compilation errors are
+         * therefore reported by 'Link' (and 'Create') instead of 'Compile'.
+         *
+         * @param dir The cache directory, which must exist. An empty string
+         *            disables the cache.
+         */
+        static void SetProgramCacheDirectory(const StringA& dir);
+
         /** Ctor. */
         GLSLShader(void);
 
@@ -883,6 +908,26 @@ namespace gl {
         GLhandleARB compileNewShader(GLenum type, const char **src, 
             GLsizei cnt, bool insertLineDirective); 
 
+        /**
+         * Adds state that influences the linked program, like attribute
+         * bindings, to the identification of the program in the cache.
+         *
+         * @param data The state.
+         * @param size The size of 'data' in bytes.
+         */
+        void hashProgramState(const void *data, SIZE_T size);
+
+        /**
+         * Links the program, loading it from the program cache if possible.
+         * On a cache miss, the deferred shaders are compiled and the linked
+         * program is stored in the cache.
+         *
+         * @return true, if the program is linked, false otherwise.
+         *
+         * @throw CompileException if a deferred shader fails to compile.
+         */
+        bool linkProgram(void);
+
         /**
          * Answer the shader error string for the specified program object.
          *
@@ -942,6 +987,39 @@ namespace gl {
 
         /** Handle of the program object. */
         GLhandleARB hProgObj;
+
+    private:
+
+        /**
+         * Compiles a shader object.
+         *
+         * @param shader The shader object, with its source already set.
+         *
+         * @throw CompileException if there was a compilation error.
+         */
+        static void compileShader(GLhandleARB shader);
+
+        /**
+         * Tries to load the program from a cache file.
+         *
+         * @param filename The cache file.
+         *
+         * @return true, if the program is linked from the cache file.
+         */
+        bool loadProgramBinary(const StringA& filename);
+
+        /**
+         * Stores the linked program in a cache file.
+         *
+         * @param filename The cache file.
+         */
+        void storeProgramBinary(const StringA& filename);
+
+        /** Hash of everything the linked program depends on. */
+        UINT64 programHash;
+
+        /** Shaders attached to the program, but not yet compiled. */
+        Array<GLhandleARB> deferredShaders;
     };
 
     
@@ -18,6 +18,7 @@
 #include "vislib/SmartPtr.h"
 #include "vislib/String.h"
 #include "vislib/StringConverter.h"
+#include <atomic>
 #include <cstdio>
 #include <ctime>
 
@@ -28,6 +29,12 @@ namespace sys {
 
     /**
      * This is a utility class for managing a log file.
+     *
+     * Messages above the levels of all targets are dropped before they are
+     * formatted. In asynchronous mode, the writing threads only format the
+     * messages and hand them over to a dedicated sink thread without taking
+     * any lock; the sink thread writes them to the targets and suppresses
+     * consecutive repetitions of the same message.
      */
     class Log {
     public:
@@ -96,6 +103,15 @@ namespace sys {
             /** Dtor */
             virtual ~Target(void);
 
+            /**
+             * Answer the highest level of messages this target will write
+             * anywhere. Messages above this level may be dropped before they
+             * are passed to the target.
+             *
+             * @return The effective log level of this target
+             */
+            virtual UINT EffectiveLevel(void) const;
+
             /** Flushes any buffer */
             virtual void Flush(void);
 
@@ -263,6 +279,14 @@ namespace sys {
                 return this->bufSize;
             }
 
+            /**
+             * Answer the effective log level, which is LEVEL_ALL, because all
+             * messages are stored to be echoed to the final target later.
+             *
+             * @return LEVEL_ALL
+             */
+            virtual UINT EffectiveLevel(void) const;
+
             /**
              * Writes a message to the log target
              *
@@ -352,6 +376,14 @@ namespace sys {
             /** Dtor */
             virtual ~RedirectTarget(void);
 
+            /**
+             * Answer the highest level of messages the targetted log will
+             * write anywhere.
+             *
+             * @return The effective log level of the targetted log
+             */
+            virtual UINT EffectiveLevel(void) const;
+
             /**
              * Writes a message to the log target
              *
@@ -591,6 +623,26 @@ namespace sys {
          */
         unsigned int GetOfflineMessageBufferSize(void) const;
 
+        /**
+         * Answer whether the messages are written by a dedicated sink thread.
+         *
+         * @return True if the log is asynchronous.
+         */
+        inline bool IsAsynchronous(void) const {
+            return this->sink.load(std::memory_order_acquire) != NULL;
+        }
+
+        /**
+         * Answer whether messages of the specified level reach any target.
+         * Use this to avoid assembling expensive messages which are dropped
+         * anyway.
+         *
+         * @param level The log level of the message.
+         *
+         * @return True if messages of this level are written.
+         */
+        bool IsLevelEnabled(UINT level) const;
+
         /**
          * Answer the state of the autoflush flag.
          *
@@ -611,6 +663,20 @@ namespace sys {
             this->autoflush = enable;
         }
 
+        /**
+         * Enables or disables the asynchronous mode. In asynchronous mode the
+         * messages are written to the targets by a dedicated sink thread,
+         * repeated messages are collapsed, and autoflush happens once per
+         * batch of messages. Disabling the asynchronous mode writes all
+         * pending messages before it returns.
+         *
+         * The mode must not be changed while other threads write messages
+         * to this log.
+         *
+         * @param enable True to enable the asynchronous mode.
+         */
+        void SetAsynchronous(bool enable);
+
         /**
          * Set a new echo level. Messages above this level will be ignored, 
          * while the other messages will be echoed to the echo output stream.
@@ -872,6 +938,21 @@ namespace sys {
 
     private:
 
+        /** The sink thread of the asynchronous mode */
+        class AsyncSink;
+
+        /**
+         * Writes a message to the targets.
+         *
+         * @param level The level of the message
+         * @param time The time stamp of the message
+         * @param sid The object id of the source of the message
+         * @param msg The message text itself, ending with a new line
+         * @param flush Flag whether to flush the targets afterwards
+         */
+        void dispatch(UINT level, TimeStamp time, SourceID sid,
+            const char *msg, bool flush);
+
         /**
          * Answer a file name suffix for log files
          *
@@ -888,6 +969,9 @@ namespace sys {
         /** Flag whether or not to flush any targets after each message */
         bool autoflush;
 
+        /** The sink thread in asynchronous mode, or NULL */
+        std::atomic<AsyncSink*> sink;
+
     };
     
 } /* end namespace sys */
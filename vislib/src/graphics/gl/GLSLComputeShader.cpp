@@ -83,7 +83,7 @@ bool vislib::graphics::gl::GLSLComputeShader::Compile(
     /* Assemble program object. */
     GL_VERIFY_THROW(this->hProgObj = ::glCreateProgram());
     GL_VERIFY_THROW(::glAttachShader(this->hProgObj, computeShader));
-    GL_VERIFY_THROW(glLinkProgram(this->hProgObj));
+    this->linkProgram();
 
     return true;
 }
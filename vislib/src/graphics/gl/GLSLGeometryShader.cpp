@@ -229,4 +229,6 @@ void vislib::graphics::gl::GLSLGeometryShader::SetProgramParameter(GLenum name,
     ASSERT(GLSLShader::IsValidHandle(this->hProgObj));
 
     glProgramParameteriEXT(this->hProgObj, name, value);
+    this->hashProgramState(&name, sizeof(name));
+    this->hashProgramState(&value, sizeof(value));
 }
@@ -15,9 +15,42 @@
 #include "vislib/IllegalStateException.h"
 #include "vislib/memutils.h"
 #include "vislib/RawStorage.h"
+#include "vislib/sys/File.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/UnsupportedOperationException.h"
 
+#include <cstring>
+
+
+/** Offset basis of the 64 bit FNV-1a hash identifying programs in the cache. */
+static const UINT64 PROGRAM_HASH_BASIS = 0xcbf29ce484222325ull;
+
+
+/** Magic number of program cache files. */
+static const char PROGRAM_CACHE_MAGIC[4] = { 'V', 'L', 'P', 'B' };
+
+
+/**
+ * Continues the 64 bit FNV-1a hash 'hash' with 'size' bytes of 'data'.
+ */
+static UINT64 programHashBytes(UINT64 hash, const void *data, SIZE_T size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (SIZE_T i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+
+/**
+ * Answer the program cache directory.
+ */
+static vislib::StringA& programCacheDirectory(void) {
+    static vislib::StringA dir;
+    return dir;
+}
+
 
 /*
  * vislib::graphics::gl::GLSLShader::IsValidHandle
@@ -53,11 +86,30 @@ const char *vislib::graphics::gl::GLSLShader::FTRANSFORM_VERTEX_SHADER_SRC =
     "}";
 
 
+/*
+ * vislib::graphics::gl::GLSLShader::GetProgramCacheDirectory
+ */
+const vislib::StringA&
+vislib::graphics::gl::GLSLShader::GetProgramCacheDirectory(void) {
+    return programCacheDirectory();
+}
+
+
+/*
+ * vislib::graphics::gl::GLSLShader::SetProgramCacheDirectory
+ */
+void vislib::graphics::gl::GLSLShader::SetProgramCacheDirectory(
+        const StringA& dir) {
+    programCacheDirectory() = dir;
+}
+
+
 /*
  * vislib::graphics::gl::GLSLShader::GLSLShader
  */
 vislib::graphics::gl::GLSLShader::GLSLShader(void) 
-        : AbstractOpenGLShader(), hProgObj(0) {
+        : AbstractOpenGLShader(), hProgObj(0),
+        programHash(PROGRAM_HASH_BASIS), deferredShaders() {
 }
 
 
@@ -78,6 +130,8 @@ GLenum vislib::graphics::gl::GLSLShader::BindAttribute(GLint index,
     ASSERT(GLSLShader::IsValidHandle(this->hProgObj));
 
     GL_VERIFY_RETURN(::glBindAttribLocationARB(this->hProgObj, index, name));
+    this->hashProgramState(&index, sizeof(index));
+    this->hashProgramState(name, ::strlen(name) + 1);
     return GL_NO_ERROR;
 }
 
@@ -307,8 +361,7 @@ bool vislib::graphics::gl::GLSLShader::Link() {
     USES_GL_VERIFY;
     ASSERT(GLSLShader::IsValidHandle(this->hProgObj));
     
-    GL_VERIFY_THROW(::glLinkProgram(this->hProgObj));
-    if (!this->isLinked(this->hProgObj)) {
+    if (!this->linkProgram()) {
         throw CompileException(this->getProgramInfoLog(this->hProgObj), 
             CompileException::ACTION_LINK, __FILE__, __LINE__);
     }
@@ -355,6 +408,9 @@ GLenum vislib::graphics::gl::GLSLShader::Release(void) {
         GL_VERIFY_RETURN(::glDeleteProgram(this->hProgObj));
     }
 
+    this->programHash = PROGRAM_HASH_BASIS;
+    this->deferredShaders.Clear();
+
     return GL_NO_ERROR;
 }
 
@@ -653,24 +709,172 @@ GLhandleARB vislib::graphics::gl::GLSLShader::compileNewShader(GLenum type,
 
     GL_VERIFY_THROW(shader = ::glCreateShader(type));
     GL_VERIFY_THROW(::glShaderSource(shader, cnt, src, NULL));
-    GL_VERIFY_THROW(::glCompileShader(shader));
 
+    this->hashProgramState(&type, sizeof(type));
+    for (GLsizei i = 0; i < cnt; i++) {
+        this->hashProgramState(src[i], ::strlen(src[i]) + 1);
+    }
+
+    if (!GLSLShader::GetProgramCacheDirectory().IsEmpty()) {
+        // only compiled if the program is not in the cache, see linkProgram
+        this->deferredShaders.Add(shader);
+        return shader;
+    }
+
+    GLSLShader::compileShader(shader);
+    return shader;
+}
+
+
+/*
+ * vislib::graphics::gl::GLSLShader::hashProgramState
+ */
+void vislib::graphics::gl::GLSLShader::hashProgramState(const void *data,
+        SIZE_T size) {
+    this->programHash = programHashBytes(this->programHash, data, size);
+}
+
+
+/*
+ * vislib::graphics::gl::GLSLShader::linkProgram
+ */
+bool vislib::graphics::gl::GLSLShader::linkProgram(void) {
+    USES_GL_VERIFY;
+    StringA cacheFile;
+
+    if (!GLSLShader::GetProgramCacheDirectory().IsEmpty()
+            && (::glProgramBinary != NULL) && (::glGetProgramBinary != NULL)) {
+        // binaries are only valid for the very same driver
+        UINT64 key = this->programHash;
+        const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (SIZE_T i = 0; i < 3; i++) {
+            const char *str = reinterpret_cast<const char *>(
+                ::glGetString(driverStrings[i]));
+            if (str != NULL) {
+                key = programHashBytes(key, str, ::strlen(str) + 1);
+            }
+        }
+        cacheFile.Format("%s/%08x%08x.glbin",
+            GLSLShader::GetProgramCacheDirectory().PeekBuffer(),
+            static_cast<unsigned int>(key >> 32),
+            static_cast<unsigned int>(key & 0xffffffffu));
+
+        if (this->loadProgramBinary(cacheFile)) {
+            return true;
+        }
+        GL_VERIFY_THROW(::glProgramParameteri(this->hProgObj,
+            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+
+    for (SIZE_T i = 0; i < this->deferredShaders.Count(); i++) {
+        GLSLShader::compileShader(this->deferredShaders[i]);
+    }
+    this->deferredShaders.Clear();
+
+    GL_VERIFY_THROW(::glLinkProgram(this->hProgObj));
+    if (!this->isLinked(this->hProgObj)) {
+        return false;
+    }
+
+    if (!cacheFile.IsEmpty()) {
+        this->storeProgramBinary(cacheFile);
+    }
+    return true;
+}
+
+
+/*
+ * vislib::graphics::gl::GLSLShader::compileShader
+ */
+void vislib::graphics::gl::GLSLShader::compileShader(GLhandleARB shader) {
+    USES_GL_VERIFY;
+    GLint type;
     GLint status;
+
+    GL_VERIFY_THROW(::glCompileShader(shader));
     GL_VERIFY_THROW(glGetShaderiv(shader, GL_COMPILE_STATUS, &status));
     if (status != GL_TRUE) {
-#if 0
-        printf("full shader:\n");
-        for (int x = 0; x < cnt; x++) {
-            printf("%s\n//snippet end\n", src[x]);
-        }
-        printf("\n\n");
-#endif
+        GL_VERIFY_THROW(glGetShaderiv(shader, GL_SHADER_TYPE, &type));
         throw CompileException(getShaderInfoLog(shader),
-            CompileException::CompilationFailedAction(type),
-            __FILE__, __LINE__);
+            CompileException::CompilationFailedAction(
+            static_cast<GLenum>(type)), __FILE__, __LINE__);
     }
+}
 
-    return shader;
+
+/*
+ * vislib::graphics::gl::GLSLShader::loadProgramBinary
+ */
+bool vislib::graphics::gl::GLSLShader::loadProgramBinary(
+        const StringA& filename) {
+    sys::File file;
+    if (!file.Open(filename.PeekBuffer(), sys::File::READ_ONLY,
+            sys::File::SHARE_READ, sys::File::OPEN_ONLY)) {
+        return false;
+    }
+
+    const sys::File::FileSize size = file.GetSize();
+    const SIZE_T headerSize = sizeof(PROGRAM_CACHE_MAGIC) + sizeof(GLenum);
+    if (size <= headerSize) {
+        return false;
+    }
+    RawStorage data(static_cast<SIZE_T>(size));
+    const bool complete = (file.Read(data, size) == size);
+    file.Close();
+    if (!complete || (::memcmp(data.As<char>(), PROGRAM_CACHE_MAGIC,
+            sizeof(PROGRAM_CACHE_MAGIC)) != 0)) {
+        return false;
+    }
+
+    ::glGetError(); // an outdated binary is not an error of the caller
+    ::glProgramBinary(this->hProgObj,
+        *data.AsAt<GLenum>(sizeof(PROGRAM_CACHE_MAGIC)),
+        data.At(headerSize), static_cast<GLsizei>(size - headerSize));
+    if (::glGetError() != GL_NO_ERROR) {
+        return false;
+    }
+
+    if (!this->isLinked(this->hProgObj)) {
+        // e.g. after a driver update, the shaders are compiled and linked instead
+        return false;
+    }
+
+    // the deferred shaders are not needed anymore
+    this->deferredShaders.Clear();
+    return true;
+}
+
+
+/*
+ * vislib::graphics::gl::GLSLShader::storeProgramBinary
+ */
+void vislib::graphics::gl::GLSLShader::storeProgramBinary(
+        const StringA& filename) {
+    GLint len = 0;
+    ::glGetProgramiv(this->hProgObj, GL_PROGRAM_BINARY_LENGTH, &len);
+    if (len <= 0) {
+        return;
+    }
+
+    const SIZE_T headerSize = sizeof(PROGRAM_CACHE_MAGIC) + sizeof(GLenum);
+    RawStorage data(headerSize + static_cast<SIZE_T>(len));
+    GLsizei written = 0;
+    GLenum format = 0;
+    ::glGetProgramBinary(this->hProgObj, len, &written, &format,
+        data.At(headerSize));
+    if ((::glGetError() != GL_NO_ERROR) || (written <= 0)) {
+        return;
+    }
+    ::memcpy(data.As<char>(), PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+    *data.AsAt<GLenum>(sizeof(PROGRAM_CACHE_MAGIC)) = format;
+
+    // a broken file is detected when loading it, so no harm is done on failure
+    sys::File file;
+    if (file.Open(filename.PeekBuffer(), sys::File::WRITE_ONLY,
+            sys::File::SHARE_EXCLUSIVE, sys::File::CREATE_OVERWRITE)) {
+        file.Write(data, headerSize + static_cast<SIZE_T>(written));
+        file.Close();
+    }
 }
 
 
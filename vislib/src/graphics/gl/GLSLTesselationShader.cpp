@@ -321,4 +321,6 @@ void vislib::graphics::gl::GLSLTesselationShader::SetProgramParameter(GLenum nam
     ASSERT(GLSLShader::IsValidHandle(this->hProgObj));
 
     glProgramParameteriEXT(this->hProgObj, name, value);
+    this->hashProgramState(&name, sizeof(name));
+    this->hashProgramState(&value, sizeof(value));
 }
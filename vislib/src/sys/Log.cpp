@@ -17,9 +17,13 @@
 #include "vislib/sys/SystemInformation.h"
 #include "vislib/sys/Thread.h"
 #include "vislib/Trace.h"
+#include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
+#include <mutex>
+#include <thread>
 #include <fcntl.h>
 #ifdef _WIN32
 #include <io.h>
@@ -49,6 +53,14 @@ vislib::sys::Log::Target::Target(UINT level) : level(level) {
 }
 
 
+/*
+ * vislib::sys::Log::Target::EffectiveLevel
+ */
+UINT vislib::sys::Log::Target::EffectiveLevel(void) const {
+    return this->level;
+}
+
+
 /*
  * vislib::sys::Log::Target::Flush
  */
@@ -241,6 +253,15 @@ vislib::sys::Log::OfflineTarget::~OfflineTarget(void) {
 }
 
 
+/*
+ * vislib::sys::Log::OfflineTarget::EffectiveLevel
+ */
+UINT vislib::sys::Log::OfflineTarget::EffectiveLevel(void) const {
+    // Do not check the level. We store ALL messages
+    return Log::LEVEL_ALL;
+}
+
+
 /*
  * vislib::sys::Log::OfflineTarget::Msg
  */
@@ -318,6 +339,26 @@ vislib::sys::Log::RedirectTarget::~RedirectTarget(void) {
 }
 
 
+/*
+ * vislib::sys::Log::RedirectTarget::EffectiveLevel
+ */
+UINT vislib::sys::Log::RedirectTarget::EffectiveLevel(void) const {
+    // We redirect ALL messages, so the targetted log decides
+    if (this->log == NULL) return Log::LEVEL_NONE;
+    UINT lvl = 0;
+    if (!this->log->AccessMainTarget().IsNull()
+            && !this->log->AccessMainTarget()->IsNull()) {
+        lvl = (*this->log->AccessMainTarget())->EffectiveLevel();
+    }
+    if (!this->log->AccessEchoTarget().IsNull()
+            && !this->log->AccessEchoTarget()->IsNull()) {
+        lvl = vislib::math::Max(lvl,
+            (*this->log->AccessEchoTarget())->EffectiveLevel());
+    }
+    return lvl;
+}
+
+
 /*
  * vislib::sys::Log::RedirectTarget::Msg
  */
@@ -386,6 +427,304 @@ void vislib::sys::Log::StreamTarget::Msg(UINT level,
 
 /*****************************************************************************/
 
+/*
+ * vislib::sys::Log::AsyncSink
+ */
+class vislib::sys::Log::AsyncSink {
+public:
+
+    /** Ctor, starts the sink thread */
+    AsyncSink(Log& owner);
+
+    /** Dtor, writes all pending messages and stops the sink thread */
+    ~AsyncSink(void);
+
+    /**
+     * Waits until all messages pushed so far have been written and the
+     * targets have been flushed.
+     */
+    void Drain(void);
+
+    /**
+     * Queues a message. This never blocks.
+     *
+     * @param level The level of the message
+     * @param time The time stamp of the message
+     * @param sid The object id of the source of the message
+     * @param msg The message text itself, ending with a new line
+     */
+    void Push(UINT level, TimeStamp time, SourceID sid,
+        const vislib::StringA& msg);
+
+private:
+
+    /** A queued message */
+    struct Entry {
+        Entry *next;
+        UINT level;
+        TimeStamp time;
+        SourceID sid;
+        vislib::StringA msg;
+    };
+
+    /** The maximum number of queued messages, any others are dropped */
+    static const unsigned int maxPending = 64 * 1024;
+
+    /** The interval in which collapsed repetitions are reported */
+    static const int repeatInterval = 1000;
+
+    /** The interval in which the sink thread polls the queue */
+    static const int pollInterval = 5;
+
+    /**
+     * Writes the queued messages, oldest first.
+     *
+     * @param list The messages as pushed, i. e. newest first
+     */
+    void process(Entry *list);
+
+    /** Reports collapsed repetitions of the last message */
+    void reportRepeats(void);
+
+    /** The body of the sink thread */
+    void run(void);
+
+    /** The owning log */
+    Log& owner;
+
+    /** The most recently pushed message */
+    std::atomic<Entry*> head;
+
+    /** The number of queued messages */
+    std::atomic<unsigned int> pending;
+
+    /** The number of dropped messages not yet reported */
+    std::atomic<unsigned int> dropped;
+
+    /** The number of pushed and of written messages */
+    std::atomic<UINT64> pushed, written;
+
+    /** The number of requested and of performed drains */
+    std::atomic<UINT64> drainsRequested, drainsDone;
+
+    /** Flag whether the sink thread should keep running */
+    std::atomic<bool> running;
+
+    /** Wakes the sink thread for draining and stopping */
+    std::mutex wakeLock;
+    std::condition_variable wake;
+
+    /** The last message written, for collapsing repetitions */
+    UINT lastLevel;
+    SourceID lastSid;
+    vislib::StringA lastMsg;
+
+    /** The number of collapsed repetitions of the last message */
+    unsigned int repeats;
+
+    /** The time the current repetitions were last reported */
+    std::chrono::steady_clock::time_point repeatsReported;
+
+    /** The sink thread */
+    std::thread thread;
+};
+
+
+/*
+ * vislib::sys::Log::AsyncSink::maxPending
+ */
+const unsigned int vislib::sys::Log::AsyncSink::maxPending;
+
+
+/*
+ * vislib::sys::Log::AsyncSink::repeatInterval
+ */
+const int vislib::sys::Log::AsyncSink::repeatInterval;
+
+
+/*
+ * vislib::sys::Log::AsyncSink::pollInterval
+ */
+const int vislib::sys::Log::AsyncSink::pollInterval;
+
+
+/*
+ * vislib::sys::Log::AsyncSink::AsyncSink
+ */
+vislib::sys::Log::AsyncSink::AsyncSink(Log& owner) : owner(owner),
+        head(NULL), pending(0), dropped(0), pushed(0), written(0),
+        drainsRequested(0), drainsDone(0), running(true), lastLevel(0),
+        lastSid(0), lastMsg(), repeats(0),
+        repeatsReported(std::chrono::steady_clock::now()) {
+    this->thread = std::thread(&AsyncSink::run, this);
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::~AsyncSink
+ */
+vislib::sys::Log::AsyncSink::~AsyncSink(void) {
+    {
+        std::lock_guard<std::mutex> lock(this->wakeLock);
+        this->running.store(false);
+    }
+    this->wake.notify_one();
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::Drain
+ */
+void vislib::sys::Log::AsyncSink::Drain(void) {
+    if (std::this_thread::get_id() == this->thread.get_id()) return;
+    UINT64 target = this->pushed.load();
+    UINT64 ticket;
+    {
+        std::lock_guard<std::mutex> lock(this->wakeLock);
+        ticket = ++this->drainsRequested;
+    }
+    this->wake.notify_one();
+    std::unique_lock<std::mutex> lock(this->wakeLock);
+    this->wake.wait(lock, [this, target, ticket]() {
+        return ((this->written.load() >= target) && (this->drainsDone.load() >= ticket))
+            || !this->running.load();
+    });
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::Push
+ */
+void vislib::sys::Log::AsyncSink::Push(UINT level,
+        TimeStamp time, SourceID sid, const vislib::StringA& msg) {
+    if (this->pending.fetch_add(1) >= maxPending) {
+        this->pending.fetch_sub(1);
+        this->dropped.fetch_add(1);
+        return;
+    }
+    Entry *e = new Entry();
+    e->level = level;
+    e->time = time;
+    e->sid = sid;
+    e->msg = msg;
+    e->next = this->head.load(std::memory_order_relaxed);
+    while (!this->head.compare_exchange_weak(e->next, e,
+            std::memory_order_release, std::memory_order_relaxed));
+    this->pushed.fetch_add(1);
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::process
+ */
+void vislib::sys::Log::AsyncSink::process(Entry *list) {
+    // restore the order in which the messages have been pushed
+    Entry *ordered = NULL;
+    UINT64 cnt = 0;
+    while (list != NULL) {
+        Entry *n = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = n;
+        cnt++;
+    }
+    this->pending.fetch_sub(static_cast<unsigned int>(cnt));
+
+    while (ordered != NULL) {
+        Entry *e = ordered;
+        ordered = e->next;
+        if ((e->level == this->lastLevel) && (e->sid == this->lastSid)
+                && e->msg.Equals(this->lastMsg)) {
+            this->repeats++;
+        } else {
+            this->reportRepeats();
+            this->owner.dispatch(e->level, e->time, e->sid, e->msg, false);
+            this->lastLevel = e->level;
+            this->lastSid = e->sid;
+            this->lastMsg = e->msg;
+            this->repeatsReported = std::chrono::steady_clock::now();
+        }
+        delete e;
+    }
+
+    if ((this->repeats > 0) && (std::chrono::steady_clock::now()
+            - this->repeatsReported >= std::chrono::milliseconds(repeatInterval))) {
+        this->reportRepeats();
+        this->repeatsReported = std::chrono::steady_clock::now();
+    }
+
+    unsigned int drp = this->dropped.exchange(0);
+    if (drp > 0) {
+        vislib::StringA omg;
+        omg.Format("%u log message%s dropped because the log sink could not "
+            "keep up\n", drp, (drp == 1) ? "" : "s");
+        this->owner.dispatch(Log::LEVEL_WARN, Log::CurrentTimeStamp(),
+            Log::CurrentSourceID(), omg, false);
+    }
+
+    if ((cnt > 0) && this->owner.autoflush) {
+        this->owner.dispatch(0, 0, 0, NULL, true);
+    }
+    this->written.fetch_add(cnt);
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::reportRepeats
+ */
+void vislib::sys::Log::AsyncSink::reportRepeats(void) {
+    if (this->repeats == 0) return;
+    vislib::StringA omg;
+    omg.Format("(last message repeated %u time%s)\n", this->repeats,
+        (this->repeats == 1) ? "" : "s");
+    this->owner.dispatch(this->lastLevel, Log::CurrentTimeStamp(),
+        this->lastSid, omg, false);
+    this->repeats = 0;
+}
+
+
+/*
+ * vislib::sys::Log::AsyncSink::run
+ */
+void vislib::sys::Log::AsyncSink::run(void) {
+    UINT64 drains = 0;
+    while (true) {
+        bool stop;
+        UINT64 requested;
+        {
+            std::unique_lock<std::mutex> lock(this->wakeLock);
+            if ((this->head.load(std::memory_order_relaxed) == NULL)
+                    && this->running.load()
+                    && (this->drainsRequested.load() == drains)) {
+                this->wake.wait_for(lock, std::chrono::milliseconds(pollInterval));
+            }
+            stop = !this->running.load();
+            requested = this->drainsRequested.load();
+        }
+
+        this->process(this->head.exchange(NULL, std::memory_order_acquire));
+
+        if ((requested != drains) || stop) {
+            // on explicit request, nothing pending is held back
+            this->process(this->head.exchange(NULL, std::memory_order_acquire));
+            this->reportRepeats();
+            this->owner.dispatch(0, 0, 0, NULL, true);
+            drains = requested;
+            {
+                std::lock_guard<std::mutex> lock(this->wakeLock);
+                this->drainsDone.store(drains);
+            }
+            this->wake.notify_all();
+        }
+        if (stop) break;
+    }
+}
+
+/*****************************************************************************/
+
 /*
  * vislib::sys::Log::LEVEL_ALL
  */
@@ -451,7 +790,8 @@ vislib::sys::Log::Log(UINT level, unsigned int msgbufsize)
         : mainTarget(new vislib::SmartPtr<Target>(
             new OfflineTarget(msgbufsize, level))),
         echoTarget(new vislib::SmartPtr<Target>(
-            new OfflineTarget(msgbufsize, level))), autoflush(true) {
+            new OfflineTarget(msgbufsize, level))), autoflush(true),
+        sink(NULL) {
     VLTRACE(TRACE_LVL, "Log[%lu]::Log[%d]()\n",
         reinterpret_cast<unsigned long>(this), __LINE__);
     // Intentionally empty
@@ -461,7 +801,7 @@ vislib::sys::Log::Log(UINT level, unsigned int msgbufsize)
  * vislib::sys::Log::Log
  */
 vislib::sys::Log::Log(UINT level, const char *filename, bool addSuffix)
-        : mainTarget(NULL), echoTarget(NULL), autoflush(true) {
+        : mainTarget(NULL), echoTarget(NULL), autoflush(true), sink(NULL) {
     VLTRACE(TRACE_LVL, "Log[%lu]::Log[%d]()\n",
         reinterpret_cast<unsigned long>(this), __LINE__);
     this->SetLogFileName(filename, addSuffix);
@@ -472,7 +812,7 @@ vislib::sys::Log::Log(UINT level, const char *filename, bool addSuffix)
  * vislib::sys::Log::Log
  */
 vislib::sys::Log::Log(UINT level, const wchar_t *filename, bool addSuffix)
-        : mainTarget(NULL), echoTarget(NULL), autoflush(true) {
+        : mainTarget(NULL), echoTarget(NULL), autoflush(true), sink(NULL) {
     VLTRACE(TRACE_LVL, "Log[%lu]::Log[%d]()\n",
         reinterpret_cast<unsigned long>(this), __LINE__);
     this->SetLogFileName(filename, addSuffix);
@@ -483,7 +823,7 @@ vislib::sys::Log::Log(UINT level, const wchar_t *filename, bool addSuffix)
  * vislib::sys::Log::Log
  */
 vislib::sys::Log::Log(const Log& source) : mainTarget(NULL),
-        echoTarget(NULL), autoflush(true) {
+        echoTarget(NULL), autoflush(true), sink(NULL) {
     VLTRACE(TRACE_LVL, "Log[%lu]::Log[%d]()\n",
         reinterpret_cast<unsigned long>(this), __LINE__);
     *this = source;
@@ -496,7 +836,7 @@ vislib::sys::Log::Log(const Log& source) : mainTarget(NULL),
 vislib::sys::Log::~Log(void) {
     VLTRACE(TRACE_LVL, "Log[%lu]::~Log()\n",
         reinterpret_cast<unsigned long>(this));
-    // Intentionally empty
+    this->SetAsynchronous(false);
 }
 
 
@@ -519,6 +859,12 @@ void vislib::sys::Log::EchoOfflineMessages(bool remove) {
  * vislib::sys::Log::FlushLog
  */
 void vislib::sys::Log::FlushLog(void) {
+    AsyncSink *s = this->sink.load(std::memory_order_acquire);
+    if (s != NULL) {
+        // the sink thread flushes the targets after the pending messages
+        s->Drain();
+        return;
+    }
     if (!this->mainTarget.IsNull() && !this->mainTarget->IsNull()) {
         this->mainTarget->operator->()->Flush();
     }
@@ -585,6 +931,37 @@ unsigned int vislib::sys::Log::GetOfflineMessageBufferSize(void) const {
 }
 
 
+/*
+ * vislib::sys::Log::IsLevelEnabled
+ */
+bool vislib::sys::Log::IsLevelEnabled(UINT level) const {
+    if (!this->mainTarget.IsNull() && !this->mainTarget->IsNull()
+            && (level <= (*this->mainTarget)->EffectiveLevel())) {
+        return true;
+    }
+    if (!this->echoTarget.IsNull() && !this->echoTarget->IsNull()
+            && (level <= (*this->echoTarget)->EffectiveLevel())) {
+        return true;
+    }
+    return false;
+}
+
+
+/*
+ * vislib::sys::Log::SetAsynchronous
+ */
+void vislib::sys::Log::SetAsynchronous(bool enable) {
+    if (enable) {
+        if (this->sink.load() == NULL) {
+            this->sink.store(new AsyncSink(*this), std::memory_order_release);
+        }
+    } else {
+        AsyncSink *s = this->sink.exchange(NULL);
+        delete s; // writes all pending messages
+    }
+}
+
+
 /*
  * vislib::sys::Log::SetEchoLevel
  */
@@ -826,21 +1203,16 @@ void vislib::sys::Log::WriteInfo(int lvlOff, const wchar_t *fmt, ...) {
 void vislib::sys::Log::WriteMessage(UINT level,
         vislib::sys::Log::TimeStamp time, vislib::sys::Log::SourceID sid,
         const vislib::StringA& msg) {
+    if (!this->IsLevelEnabled(level)) return;
     if (!msg.EndsWith('\n')) {
         this->WriteMessage(level, time, sid, msg + "\n");
         return;
     }
-    if (!this->mainTarget.IsNull() && !this->mainTarget->IsNull()) {
-        (*this->mainTarget)->Msg(level, time, sid, msg);
-        if (this->autoflush) {
-            (*this->mainTarget)->Flush();
-        }
-    }
-    if (!this->echoTarget.IsNull() && !this->echoTarget->IsNull()) {
-        (*this->echoTarget)->Msg(level, time, sid, msg);
-        if (this->autoflush) {
-            (*this->echoTarget)->Flush();
-        }
+    AsyncSink *s = this->sink.load(std::memory_order_acquire);
+    if (s != NULL) {
+        s->Push(level, time, sid, msg);
+    } else {
+        this->dispatch(level, time, sid, msg, this->autoflush);
     }
 }
 
@@ -851,6 +1223,7 @@ void vislib::sys::Log::WriteMessage(UINT level,
 void vislib::sys::Log::WriteMessageVaA(UINT level,
         vislib::sys::Log::TimeStamp time, vislib::sys::Log::SourceID sid,
         const char *fmt, va_list argptr) {
+    if (!this->IsLevelEnabled(level)) return;
     vislib::StringA msg;
     if (fmt != NULL) {
         msg.FormatVa(fmt, argptr);
@@ -867,6 +1240,7 @@ void vislib::sys::Log::WriteMessageVaA(UINT level,
 void vislib::sys::Log::WriteMessageVaW(UINT level,
         vislib::sys::Log::TimeStamp time, vislib::sys::Log::SourceID sid,
         const wchar_t *fmt, va_list argptr) {
+    if (!this->IsLevelEnabled(level)) return;
     vislib::StringW msg;
     if (fmt != NULL) {
         msg.FormatVa(fmt, argptr);
@@ -964,6 +1338,26 @@ vislib::sys::Log& vislib::sys::Log::operator=(const Log& rhs) {
 }
 
 
+/*
+ * vislib::sys::Log::dispatch
+ */
+void vislib::sys::Log::dispatch(UINT level, vislib::sys::Log::TimeStamp time,
+        vislib::sys::Log::SourceID sid, const char *msg, bool flush) {
+    if (!this->mainTarget.IsNull() && !this->mainTarget->IsNull()) {
+        if (msg != NULL) (*this->mainTarget)->Msg(level, time, sid, msg);
+        if (flush) {
+            (*this->mainTarget)->Flush();
+        }
+    }
+    if (!this->echoTarget.IsNull() && !this->echoTarget->IsNull()) {
+        if (msg != NULL) (*this->echoTarget)->Msg(level, time, sid, msg);
+        if (flush) {
+            (*this->echoTarget)->Flush();
+        }
+    }
+}
+
+
 /*
  * vislib::sys::Log::getFileNameSuffix
  */